@@ -0,0 +1,6 @@
+# aruw Python build tools
+__all__ = [
+    "parse_args"
+]
+
+from . import parse_args
@@ -0,0 +1,68 @@
+# Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+from SCons.Script import *
+
+
+CMD_LINE_ARGS                       = 1
+HARDWARE_BUILD_TARGET_ACCEPTED_ARGS = ["build", "run", "size", "gdb"]
+VALID_BUILD_PROFILES                = ["debug", "release", "fast"]
+VALID_PROFILING_TYPES               = ["true", "false"]
+VALID_TRACING_TYPES                 = ["true", "false"]
+USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|false>] [tracing=<true|false>]\n\
+    \"<target>\" is one of:\n\
+        - \"build\": build the benchmark firmware for the hardware target.\n\
+        - \"run\": build the benchmark firmware and program the board. Benchmarks start on boot and\n\
+          print their results to the terminal serial UART.\n\
+        - \"size\": build the benchmark firmware and print its size.\n\
+        - \"gdb\": build the benchmark firmware and start a gdb session on the board."
+
+
+def parse_args():
+    args = {
+        "TARGET_ENV": "hardware",
+        "BUILD_PROFILE": "",
+        "PROFILING": "",
+        "TRACING": ""
+    }
+    if len(COMMAND_LINE_TARGETS) > CMD_LINE_ARGS:
+        raise Exception("You did not enter the correct number of arguments.\n" + USAGE)
+
+    # Benchmarks only make sense on the hardware, hosted benchmarks live in test-project
+    if len(COMMAND_LINE_TARGETS) != 0:
+        build_target = COMMAND_LINE_TARGETS[0]
+        if build_target == "help":
+            print(USAGE)
+            exit(0)
+        elif build_target not in HARDWARE_BUILD_TARGET_ACCEPTED_ARGS:
+            raise Exception("You did not select a valid target.\n" + USAGE)
+
+    # Extract and validate the build profile, benchmarks measure release builds by default
+    args["BUILD_PROFILE"] = ARGUMENTS.get("profile", "release")
+    ARGUMENTS["profile"] = args["BUILD_PROFILE"]
+    if args["BUILD_PROFILE"] not in VALID_BUILD_PROFILES:
+        raise Exception("You specified an invalid build profile.\n" + USAGE)
+
+    args["PROFILING"] = ARGUMENTS.get("profiling", "false")
+    if args["PROFILING"] not in VALID_PROFILING_TYPES:
+        raise Exception("You specified an invalid profiling type.\n" + USAGE)
+
+    args["TRACING"] = ARGUMENTS.get("tracing", "false")
+    if args["TRACING"] not in VALID_TRACING_TYPES:
+        raise Exception("You specified an invalid tracing type.\n" + USAGE)
+
+    return args
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tap/architecture/clock.hpp"
+#include "tap/board/board.hpp"
+#include "tap/communication/serial/uart_terminal_device.hpp"
+#include "tap/drivers.hpp"
+
+#include "modm/architecture/interface/delay.hpp"
+#include "modm/io/iostream.hpp"
+
+#include "benchmark.hpp"
+
+namespace tap
+{
+/// Owns the `Drivers`, which only this class may construct.
+class DriversSingleton
+{
+public:
+    static Drivers drivers;
+};
+
+Drivers DriversSingleton::drivers;
+}  // namespace tap
+
+/// Time given to open a serial console after the board resets, before benchmarks start.
+static constexpr uint32_t STARTUP_DELAY_MS = 2'000;
+
+int main()
+{
+    Board::initialize();
+    tap::arch::clock::enableCycleCounter();
+
+    tap::communication::serial::UartTerminalDevice terminal(&tap::DriversSingleton::drivers);
+    terminal.initialize();
+    modm::IOStream stream(terminal);
+
+    modm::delay_ms(STARTUP_DELAY_MS);
+
+    tap::benchmark::runBenchmarks(tap::benchmark::Options(), stream);
+
+    while (true)
+    {
+    }
+    return 0;
+}
@@ -26,7 +26,9 @@ A dictionary storing data about each driver that has
 been defined in code. This data is used to construct
 a drivers object. The module-dependencies specified
 will determine if the driver defined below will be
-added to the main drivers object.
+added to the main drivers object. Drivers that are "optional"
+aren't used by the rest of Taproot, so they can be left out
+of the drivers object with the :core:excluded_drivers option.
 """
 DRIVERS_AND_MODULE_DEPENDENCIES = [
     {
@@ -37,6 +39,14 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "constructor": "this",
         "module-dependencies": [":communication:gpio:analog"],
     },
+    {
+        "object-name": "arch::MemoryMonitor",
+        "mock-object-name": "arch::MemoryMonitor",
+        "src-file": "tap/architecture/memory_monitor.hpp",
+        "mock-header": "tap/architecture/memory_monitor.hpp",
+        "constructor": "this",
+        "module-dependencies": "",
+    },
     {
         "object-name": "gpio::Analog",
         "mock-object-name": nice_mock("mock::AnalogMock"),
@@ -61,6 +71,15 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "constructor": "this",
         "module-dependencies": [":communication:can"],
     },
+    {
+        "object-name": "can::CanTerminalSerialHandler",
+        "mock-object-name": nice_mock("mock::CanTerminalSerialHandlerMock"),
+        "src-file": "tap/communication/can/can_terminal_serial_handler.hpp",
+        "mock-header": "tap/mock/can_terminal_serial_handler_mock.hpp",
+        "constructor": "this",
+        "module-dependencies": [":communication:can"],
+        "optional": True,
+    },
     {
         "object-name": "gpio::Digital",
         "mock-object-name": nice_mock("mock::DigitalMock"),
@@ -68,6 +87,16 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/digital_mock.hpp",
         "constructor": "",
         "module-dependencies": [":communication:gpio:digital"],
+        "optional": True,
+    },
+    {
+        "object-name": "gpio::InputCapture",
+        "mock-object-name": nice_mock("mock::InputCaptureMock"),
+        "src-file": "tap/communication/gpio/input_capture.hpp",
+        "mock-header": "tap/mock/input_capture_mock.hpp",
+        "constructor": "",
+        "module-dependencies": [":communication:gpio:input_capture"],
+        "optional": True,
     },
     {
         "object-name": "gpio::Leds",
@@ -76,6 +105,7 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/leds_mock.hpp",
         "constructor": "",
         "module-dependencies": [":communication:gpio:leds"],
+        "optional": True,
     },
     {
         "object-name": "gpio::Pwm",
@@ -92,6 +122,7 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/mpu6500_mock.hpp",
         "constructor": "this",
         "module-dependencies": [":communication:sensors:imu:mpu6500"],
+        "optional": True,
     },
     {
         "object-name": "communication::serial::RefSerial",
@@ -108,6 +139,7 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/remote_mock.hpp",
         "constructor": "this",
         "module-dependencies": [":communication:serial:remote"],
+        "optional": True,
     },
     {
         "object-name": "communication::serial::Uart",
@@ -117,6 +149,14 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "constructor": "",
         "module-dependencies": [":communication:serial"],
     },
+    {
+        "object-name": "communication::serial::Usb",
+        "mock-object-name": nice_mock("mock::UsbMock"),
+        "src-file": "tap/communication/serial/usb.hpp",
+        "mock-header": "tap/mock/usb_mock.hpp",
+        "constructor": "",
+        "module-dependencies": [":communication:serial:usb"],
+    },
     {
         "object-name": "communication::serial::TerminalSerial",
         "mock-object-name": nice_mock("mock::TerminalSerialMock"),
@@ -140,6 +180,7 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/scheduler_terminal_handler_mock.hpp",
         "constructor": "this",
         "module-dependencies": "",
+        "optional": True,
     },
     {
         "object-name": "errors::ErrorController",
@@ -149,6 +190,14 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "constructor": "this",
         "module-dependencies": "",
     },
+    {
+        "object-name": "errors::CrashRecorder",
+        "mock-object-name": "errors::CrashRecorder",
+        "src-file": "tap/errors/crash_recorder.hpp",
+        "mock-header": "tap/errors/crash_recorder.hpp",
+        "constructor": "this",
+        "module-dependencies": "",
+    },
     {
         "object-name": "motor::DjiMotorTerminalSerialHandler",
         "mock-object-name": nice_mock("mock::DjiMotorTerminalSerialHandlerMock"),
@@ -156,6 +205,7 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/dji_motor_terminal_serial_handler_mock.hpp",
         "constructor": "this",
         "module-dependencies": [":communication:serial:terminal_serial"],
+        "optional": True,
     },
     {
         "object-name": "motor::DjiMotorTxHandler",
@@ -172,11 +222,29 @@ DRIVERS_AND_MODULE_DEPENDENCIES = [
         "mock-header": "tap/mock/bmi088_mock.hpp",
         "constructor": "this",
         "module-dependencies": [":communication:sensors:imu:bmi088"],
+        "optional": True,
     }
 ]
 
+def get_instance_name(driver):
+    object_instance_name_pascal = driver["object-name"].split("::")[-1]
+    return object_instance_name_pascal[0].lower() + object_instance_name_pascal[1:]
+
+def get_excluded_instance_names(env):
+    return [name.strip() for name in env[":core:excluded_drivers"].split(",") if name.strip()]
+
+def check_excluded_drivers(env):
+    optional_names = [get_instance_name(driver) for driver in DRIVERS_AND_MODULE_DEPENDENCIES if driver.get("optional", False)]
+    for name in get_excluded_instance_names(env):
+        if name not in optional_names:
+            raise ValueError(f"Driver \"{name}\" can't be excluded, optional drivers are: {', '.join(optional_names)}")
+
+def is_driver_excluded(env, driver):
+    return get_instance_name(driver) in get_excluded_instance_names(env)
+
 def should_driver_be_generated(env, driver):
-    return all(env.has_module(dependency) for dependency in driver["module-dependencies"])
+    return (all(env.has_module(dependency) for dependency in driver["module-dependencies"])
+            and not is_driver_excluded(env, driver))
 
 def get_names_sorted(env, name):
     return sorted([driver[name] for driver in DRIVERS_AND_MODULE_DEPENDENCIES if should_driver_be_generated(env, driver)])
@@ -191,12 +259,17 @@ def get_object_and_mock_names(env):
     objects_and_mocks = []
     for driver in DRIVERS_AND_MODULE_DEPENDENCIES:
         if should_driver_be_generated(env, driver):
-            object_instance_name_pascal = driver["object-name"].split("::")[-1]
-            object_instance_name_camel = object_instance_name_pascal[0].lower() + object_instance_name_pascal[1:]
             objects_and_mocks.append({
                 "object-name": driver["object-name"],
                 "mock-object-name": driver["mock-object-name"],
-                "object-instance-name": object_instance_name_camel,
+                "object-instance-name": get_instance_name(driver),
                 "constructor": driver["constructor"]
             })
     return objects_and_mocks
+
+def get_excluded_drivers(env):
+    return [{
+        "object-name": driver["object-name"],
+        "object-instance-name": get_instance_name(driver),
+        "src-file": driver["src-file"]
+    } for driver in DRIVERS_AND_MODULE_DEPENDENCIES if is_driver_excluded(env, driver)]
@@ -13,6 +13,9 @@
 // 29/09/2011    SOH Madgwick    Initial release
 // 02/10/2011    SOH Madgwick    Optimised for reduced CPU load
 // 09/06/2020    Matthew Arnold  Update style, use safer casting
+//                               Cache sample frequency constants, normalise with the FPU
+//                               square root, expose the quaternion and rotation matrix
+//                               Implement tap::algorithms::AttitudeEstimator
 //
 // Algorithm paper:
 // http://ieeexplore.ieee.org/xpl/login.jsp?tp=&arnumber=4608934&url=http%3A%2F%2Fieeexplore.ieee.org%2Fstamp%2Fstamp.jsp%3Ftp%3D%26arnumber%3D4608934
@@ -24,9 +27,9 @@
 
 #include "MahonyAHRS.h"
 
-#include <cinttypes>
 #include <cmath>
-#include <cstring>
+
+#include "arm_math.h"
 
 //-------------------------------------------------------------------------------------------
 // Definitions
@@ -34,12 +37,12 @@
 #define DEFAULT_SAMPLE_FREQ 500.0f  // sample frequency in Hz
 #define twoKpDef (2.0f * 0.5f)      // 2 * proportional gain
 #define twoKiDef (2.0f * 0.0f)      // 2 * integral gain
+#define DEG_TO_RAD 0.0174533f
+#define RAD_TO_DEG 57.29578f
 
 //============================================================================================
 // Functions
 
-static float fastInvSqrt(float x);
-
 //-------------------------------------------------------------------------------------------
 // AHRS algorithm update
 
@@ -56,9 +59,14 @@ Mahony::Mahony()
     integralFBz = 0.0f;
     anglesComputed = 0;
     invSampleFreq = 1.0f / DEFAULT_SAMPLE_FREQ;
+    halfInvSampleFreq = 0.5f * invSampleFreq;
+    twoKiInvSampleFreq = twoKi * invSampleFreq;
     roll = 0.0f;
     pitch = 0.0f;
     yaw = 0.0f;
+    rollDegrees = 0.0f;
+    pitchDegrees = 0.0f;
+    yawDegrees = 0.0f;
 }
 
 void Mahony::update(
@@ -84,22 +92,22 @@ void Mahony::update(
     }
 
     // Convert gyroscope degrees/sec to radians/sec
-    gx *= 0.0174533f;
-    gy *= 0.0174533f;
-    gz *= 0.0174533f;
+    gx *= DEG_TO_RAD;
+    gy *= DEG_TO_RAD;
+    gz *= DEG_TO_RAD;
 
     // Compute feedback only if accelerometer measurement valid
     // (avoids NaN in accelerometer normalisation)
     if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
     {
         // Normalise accelerometer measurement
-        recipNorm = fastInvSqrt(ax * ax + ay * ay + az * az);
+        recipNorm = invSqrt(ax * ax + ay * ay + az * az);
         ax *= recipNorm;
         ay *= recipNorm;
         az *= recipNorm;
 
         // Normalise magnetometer measurement
-        recipNorm = fastInvSqrt(mx * mx + my * my + mz * mz);
+        recipNorm = invSqrt(mx * mx + my * my + mz * mz);
         mx *= recipNorm;
         my *= recipNorm;
         mz *= recipNorm;
@@ -147,9 +155,9 @@ void Mahony::update(
         if (twoKi > 0.0f)
         {
             // integral error scaled by Ki
-            integralFBx += twoKi * halfex * invSampleFreq;
-            integralFBy += twoKi * halfey * invSampleFreq;
-            integralFBz += twoKi * halfez * invSampleFreq;
+            integralFBx += twoKiInvSampleFreq * halfex;
+            integralFBy += twoKiInvSampleFreq * halfey;
+            integralFBz += twoKiInvSampleFreq * halfez;
             gx += integralFBx;  // apply integral feedback
             gy += integralFBy;
             gz += integralFBz;
@@ -168,9 +176,9 @@ void Mahony::update(
     }
 
     // Integrate rate of change of quaternion
-    gx *= (0.5f * invSampleFreq);  // pre-multiply common factors
-    gy *= (0.5f * invSampleFreq);
-    gz *= (0.5f * invSampleFreq);
+    gx *= halfInvSampleFreq;  // pre-multiply common factors
+    gy *= halfInvSampleFreq;
+    gz *= halfInvSampleFreq;
     qa = q0;
     qb = q1;
     qc = q2;
@@ -179,13 +187,7 @@ void Mahony::update(
     q2 += (qa * gy - qb * gz + q3 * gx);
     q3 += (qa * gz + qb * gy - qc * gx);
 
-    // Normalise quaternion
-    recipNorm = fastInvSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-    q0 *= recipNorm;
-    q1 *= recipNorm;
-    q2 *= recipNorm;
-    q3 *= recipNorm;
-    anglesComputed = 0;
+    normalizeQuaternion();
 }
 
 //-------------------------------------------------------------------------------------------
@@ -197,16 +199,16 @@ void Mahony::updateIMU(float gx, float gy, float gz, float ax, float ay, float a
     float qa, qb, qc;
 
     // Convert gyroscope degrees/sec to radians/sec
-    gx *= 0.0174533f;
-    gy *= 0.0174533f;
-    gz *= 0.0174533f;
+    gx *= DEG_TO_RAD;
+    gy *= DEG_TO_RAD;
+    gz *= DEG_TO_RAD;
 
     // Compute feedback only if accelerometer measurement valid
     // (avoids NaN in accelerometer normalisation)
     if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
     {
         // Normalise accelerometer measurement
-        recipNorm = fastInvSqrt(ax * ax + ay * ay + az * az);
+        recipNorm = invSqrt(ax * ax + ay * ay + az * az);
         ax *= recipNorm;
         ay *= recipNorm;
         az *= recipNorm;
@@ -229,9 +231,9 @@ void Mahony::updateIMU(float gx, float gy, float gz, float ax, float ay, float a
         if (twoKi > 0.0f)
         {
             // integral error scaled by Ki
-            integralFBx += twoKi * halfex * invSampleFreq;
-            integralFBy += twoKi * halfey * invSampleFreq;
-            integralFBz += twoKi * halfez * invSampleFreq;
+            integralFBx += twoKiInvSampleFreq * halfex;
+            integralFBy += twoKiInvSampleFreq * halfey;
+            integralFBz += twoKiInvSampleFreq * halfez;
             gx += integralFBx;  // apply integral feedback
             gy += integralFBy;
             gz += integralFBz;
@@ -250,9 +252,9 @@ void Mahony::updateIMU(float gx, float gy, float gz, float ax, float ay, float a
     }
 
     // Integrate rate of change of quaternion
-    gx *= (0.5f * invSampleFreq);  // pre-multiply common factors
-    gy *= (0.5f * invSampleFreq);
-    gz *= (0.5f * invSampleFreq);
+    gx *= halfInvSampleFreq;  // pre-multiply common factors
+    gy *= halfInvSampleFreq;
+    gz *= halfInvSampleFreq;
     qa = q0;
     qb = q1;
     qc = q2;
@@ -261,8 +263,14 @@ void Mahony::updateIMU(float gx, float gy, float gz, float ax, float ay, float a
     q2 += (qa * gy - qb * gz + q3 * gx);
     q3 += (qa * gz + qb * gy - qc * gx);
 
-    // Normalise quaternion
-    recipNorm = fastInvSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    normalizeQuaternion();
+}
+
+//-------------------------------------------------------------------------------------------
+
+void Mahony::normalizeQuaternion()
+{
+    float recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
     q0 *= recipNorm;
     q1 *= recipNorm;
     q2 *= recipNorm;
@@ -270,35 +278,29 @@ void Mahony::updateIMU(float gx, float gy, float gz, float ax, float ay, float a
     anglesComputed = 0;
 }
 
-//-------------------------------------------------------------------------------------------
-
 void Mahony::computeAngles()
 {
     roll = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2);
     pitch = asinf(-2.0f * (q1 * q3 - q0 * q2));
     yaw = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3);
+    rollDegrees = roll * RAD_TO_DEG;
+    pitchDegrees = pitch * RAD_TO_DEG;
+    yawDegrees = yaw * RAD_TO_DEG;
+    if (yawDegrees < 0.0f)
+    {
+        yawDegrees += 360.0f;
+    }
     anglesComputed = 1;
 }
 
-template <typename From, typename To>
-To reinterpretCopy(From from)
-{
-    static_assert(sizeof(From) == sizeof(To), "can only reinterpret-copy types of the same size");
-    To result;
-    memcpy(static_cast<void*>(&result), static_cast<void*>(&from), sizeof(To));
-    return result;
-}
-
-float fastInvSqrt(float x)
+// Uses the FPU's square root instruction when there is one. It costs a few more cycles than the
+// bit hack approximation this used to use, but is exact, so normalising doesn't bias the
+// quaternion's norm.
+float Mahony::invSqrt(float x)
 {
-    static_assert(sizeof(float) == 4, "fast inverse sqrt requires 32-bit float");
-    float halfx = 0.5f * x;
-    float y = x;
-    int32_t i = reinterpretCopy<float, int32_t>(y);
-    i = 0x5f3759df - (i >> 1);
-    y = reinterpretCopy<int32_t, float>(i);
-    y = y * (1.5f - (halfx * y * y));
-    return y;
+    float root;
+    arm_sqrt_f32(x, &root);
+    return 1.0f / root;
 }
 
 //============================================================================================
@@ -20,10 +20,12 @@
 
 #include <cmath>
 
+#include "tap/algorithms/attitude_estimator.hpp"
+
 //--------------------------------------------------------------------------------------------
 // Variable declaration
 
-class Mahony
+class Mahony : public tap::algorithms::AttitudeEstimator
 {
 private:
     float twoKp;           // 2 * proportional gain (Kp)
@@ -31,10 +33,17 @@ class Mahony
     float q0, q1, q2, q3;  // quaternion of sensor frame relative to auxiliary frame
     float integralFBx, integralFBy, integralFBz;  // integral error terms scaled by Ki
     float invSampleFreq;
+    // Constants derived from the sample frequency, cached by begin() so each update only
+    // multiplies
+    float halfInvSampleFreq;   // 0.5 * sample period, scales the quaternion derivative
+    float twoKiInvSampleFreq;  // 2 * Ki * sample period, scales the integral feedback
+    // Euler angles, computed at most once per update and only when requested
     float roll, pitch, yaw;
+    float rollDegrees, pitchDegrees, yawDegrees;
     char anglesComputed;
     static float invSqrt(float x);
     void computeAngles();
+    void normalizeQuaternion();
 
     //-------------------------------------------------------------------------------------------
     // Function declarations
@@ -46,8 +55,16 @@ class Mahony
         invSampleFreq = 1.0f / sampleFrequency;
         twoKp = 2.0f * kp;
         twoKi = 2.0f * ki;
+        halfInvSampleFreq = 0.5f * invSampleFreq;
+        twoKiInvSampleFreq = twoKi * invSampleFreq;
+    }
+    void setSampleFrequency(float sampleFrequency) override
+    {
+        invSampleFreq = 1.0f / sampleFrequency;
+        halfInvSampleFreq = 0.5f * invSampleFreq;
+        twoKiInvSampleFreq = twoKi * invSampleFreq;
     }
-    void reset()
+    void reset() override
     {
         q0 = 1.0f;
         q1 = 0.0f;
@@ -60,6 +77,9 @@ class Mahony
         roll = 0.0f;
         pitch = 0.0f;
         yaw = 0.0f;
+        rollDegrees = 0.0f;
+        pitchDegrees = 0.0f;
+        yawDegrees = 0.0f;
     }
     void update(
         float gx,
@@ -71,38 +91,46 @@ class Mahony
         float mx,
         float my,
         float mz);
-    void updateIMU(float gx, float gy, float gz, float ax, float ay, float az);
-    float getRoll()
+    void updateIMU(float gx, float gy, float gz, float ax, float ay, float az) override;
+    float getRoll() override
     {
         if (!anglesComputed) computeAngles();
-        return roll * 57.29578f;
+        return rollDegrees;
     }
-    float getPitch()
+    float getPitch() override
     {
         if (!anglesComputed) computeAngles();
-        return pitch * 57.29578f;
+        return pitchDegrees;
     }
-    float getYaw()
+    // Yaw in degrees, wrapped to [0, 360)
+    float getYaw() override
     {
         if (!anglesComputed) computeAngles();
-        float yawDegrees = yaw * 57.29578f;
-        return fmod(yawDegrees + 360.0f, 360.0f);
+        return yawDegrees;
     }
-    float getRollRadians()
+    float getRollRadians() override
     {
         if (!anglesComputed) computeAngles();
         return roll;
     }
-    float getPitchRadians()
+    float getPitchRadians() override
     {
         if (!anglesComputed) computeAngles();
         return pitch;
     }
-    float getYawRadians()
+    float getYawRadians() override
     {
         if (!anglesComputed) computeAngles();
         return yaw;
     }
+    // Unit quaternion (w, x, y, z) of the sensor frame relative to the earth frame
+    void getQuaternion(float (&q)[4]) const override
+    {
+        q[0] = q0;
+        q[1] = q1;
+        q[2] = q2;
+        q[3] = q3;
+    }
 };
 
 #endif  // MAHONY_AHRS_H_
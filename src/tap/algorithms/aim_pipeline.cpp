@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "aim_pipeline.hpp"
+
+namespace tap::algorithms::ballistics
+{
+void AimPipeline::AxisFilter::init(float position, const AimPipelineConfig &config)
+{
+    x[0] = position;
+    x[1] = 0;
+    x[2] = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            P[i][j] = 0;
+        }
+    }
+    P[0][0] = config.measurementNoise * config.measurementNoise;
+    P[1][1] = config.initialVelocityVariance;
+    P[2][2] = config.initialAccelerationVariance;
+}
+
+void AimPipeline::AxisFilter::predict(float dt, float jerkNoise)
+{
+    const float dt2 = dt * dt / 2;
+    const float F[3][3] = {{1, dt, dt2}, {0, 1, dt}, {0, 0, 1}};
+
+    x[0] += x[1] * dt + x[2] * dt2;
+    x[1] += x[2] * dt;
+
+    // P = F * P * F^T + Q, where Q is the covariance white noise jerk adds over dt
+    float FP[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            FP[i][j] = 0;
+            for (int k = i; k < 3; k++)
+            {
+                FP[i][j] += F[i][k] * P[k][j];
+            }
+        }
+    }
+    const float t[6] = {1, dt, dt * dt, dt * dt * dt, dt * dt * dt * dt, dt * dt * dt * dt * dt};
+    const float Q[3][3] = {
+        {t[5] / 20, t[4] / 8, t[3] / 6},
+        {t[4] / 8, t[3] / 3, t[2] / 2},
+        {t[3] / 6, t[2] / 2, t[1]}};
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            float sum = 0;
+            for (int k = j; k < 3; k++)
+            {
+                sum += FP[i][k] * F[j][k];
+            }
+            P[i][j] = sum + jerkNoise * Q[i][j];
+        }
+    }
+}
+
+void AimPipeline::AxisFilter::correct(float position, float measurementVariance)
+{
+    // The measurement is the position, so the innovation covariance and gain only need the
+    // first column of P
+    const float S = P[0][0] + measurementVariance;
+    const float K[3] = {P[0][0] / S, P[1][0] / S, P[2][0] / S};
+    const float innovation = position - x[0];
+    const float P0[3] = {P[0][0], P[0][1], P[0][2]};
+    for (int i = 0; i < 3; i++)
+    {
+        x[i] += K[i] * innovation;
+        for (int j = 0; j < 3; j++)
+        {
+            P[i][j] -= K[i] * P0[j];
+        }
+    }
+}
+
+AimPipeline::AimPipeline(const AimPipelineConfig &config)
+    : config(config),
+      solver(config.dragModel, config.maxSolverIterations)
+{
+}
+
+void AimPipeline::reset()
+{
+    tracking = false;
+    solver.resetWarmStart();
+}
+
+bool AimPipeline::addMeasurement(uint32_t timeUs, const modm::Vector3f &position)
+{
+    const float measured[3] = {position.x, position.y, position.z};
+    if (!tracking || !hasTarget(timeUs))
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            axes[i].init(measured[i], config);
+        }
+        tracking = true;
+        filterTimeUs = timeUs;
+        solver.resetWarmStart();
+        return true;
+    }
+
+    const float dt = secondsSinceFilter(timeUs);
+    if (dt < 0)
+    {
+        return false;
+    }
+    const float measurementVariance = config.measurementNoise * config.measurementNoise;
+    for (int i = 0; i < 3; i++)
+    {
+        axes[i].predict(dt, config.jerkNoise);
+        axes[i].correct(measured[i], measurementVariance);
+    }
+    filterTimeUs = timeUs;
+    return true;
+}
+
+bool AimPipeline::hasTarget(uint32_t timeUs) const
+{
+    const int32_t sinceMeasurementUs = static_cast<int32_t>(timeUs - filterTimeUs);
+    return tracking && sinceMeasurementUs <= static_cast<int32_t>(config.targetTimeoutUs);
+}
+
+SecondOrderKinematicState AimPipeline::getTargetState(uint32_t timeUs) const
+{
+    const float dt = secondsSinceFilter(timeUs);
+    float position[3], velocity[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const float *x = axes[i].x;
+        position[i] = AbstractKinematicState::quadraticKinematicProjection(dt, x[0], x[1], x[2]);
+        velocity[i] = x[1] + x[2] * dt;
+    }
+    return SecondOrderKinematicState(
+        modm::Vector3f(position[0], position[1], position[2]),
+        modm::Vector3f(velocity[0], velocity[1], velocity[2]),
+        modm::Vector3f(axes[0].x[2], axes[1].x[2], axes[2].x[2]));
+}
+
+bool AimPipeline::update(uint32_t timeUs, AimSetpoint *setpoint)
+{
+    if (!hasTarget(timeUs))
+    {
+        solver.resetWarmStart();
+        return false;
+    }
+
+    const SecondOrderKinematicState target =
+        getTargetState(timeUs + static_cast<uint32_t>(config.shotLatency * 1E6f));
+    if (!solver.solve(target, config.bulletVelocity, &lastSolution, config.pitchAxisOffset))
+    {
+        return false;
+    }
+
+    // The setpoints follow the impact point, whose rate of change is the target's velocity at
+    // impact, neglecting the change in travel time. Yaw is its azimuth and pitch follows its
+    // elevation, negated to match the pitch convention.
+    const float t = lastSolution.travelTime;
+    const modm::Vector3f impact = target.projectForward(t);
+    const modm::Vector3f velocity = target.velocity + target.acceleration * t;
+    const float horizontalSquared = impact.x * impact.x + impact.y * impact.y;
+    const float horizontal = sqrtf(horizontalSquared);
+    float yawVelocity = 0;
+    float horizontalVelocity = 0;
+    if (horizontal > 0)
+    {
+        yawVelocity = (impact.x * velocity.y - impact.y * velocity.x) / horizontalSquared;
+        horizontalVelocity = (impact.x * velocity.x + impact.y * velocity.y) / horizontal;
+    }
+
+    setpoint->yaw = lastSolution.turretYaw;
+    setpoint->pitch = lastSolution.turretPitch;
+    setpoint->yawVelocity = yawVelocity;
+    setpoint->pitchVelocity = -(horizontal * velocity.z - impact.z * horizontalVelocity) /
+                              (horizontalSquared + impact.z * impact.z);
+    setpoint->travelTime = t;
+    return true;
+}
+}  // namespace tap::algorithms::ballistics
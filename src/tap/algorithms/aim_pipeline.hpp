@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_AIM_PIPELINE_HPP_
+#define TAPROOT_AIM_PIPELINE_HPP_
+
+#include <cstdint>
+
+#include "tap/architecture/clock_sync.hpp"
+
+#include "modm/math/geometry/vector.hpp"
+
+#include "attitude_history.hpp"
+#include "ballistics.hpp"
+#include "transforms/quaternion.hpp"
+
+namespace tap::algorithms::ballistics
+{
+/// Configuration of an `AimPipeline`.
+struct AimPipelineConfig
+{
+    /// The velocity of projectiles out of the barrel, in m/s.
+    float bulletVelocity = 25;
+    /// The distance between the pitch and yaw axes, as in `findTargetProjectileIntersection`.
+    float pitchAxisOffset = 0;
+    /**
+     * The time from a setpoint being output to the projectile leaving the barrel, in seconds,
+     * such as the turret's response time plus the feeder's delay. The target is aimed at where
+     * it will be this much later.
+     */
+    float shotLatency = 0;
+    /**
+     * The spectral density of the target's jerk, in m^2/s^5, which is how quickly the target's
+     * acceleration is expected to change. Larger values follow dodging targets more closely but
+     * let more measurement noise through.
+     */
+    float jerkNoise = 50;
+    /// The standard deviation of measured target positions, in m.
+    float measurementNoise = 0.02f;
+    /// The variance of the velocity of a newly seen target, in m^2/s^2.
+    float initialVelocityVariance = 4;
+    /// The variance of the acceleration of a newly seen target, in m^2/s^4.
+    float initialAccelerationVariance = 25;
+    /// Time without a measurement after which the target is lost, in microseconds.
+    uint32_t targetTimeoutUs = 250'000;
+    /// The drag acting on projectiles.
+    DragModel dragModel;
+    /// The most Newton iterations the ballistics solver runs per update.
+    uint8_t maxSolverIterations = 4;
+};
+
+/// The output of an `AimPipeline`.
+struct AimSetpoint
+{
+    /// The turret yaw, in radians, as in `BallisticsSolution`.
+    float yaw = 0;
+    /// The turret pitch, in radians, in the same convention as `findTargetProjectileIntersection`.
+    float pitch = 0;
+    /// The rate the yaw setpoint is changing at, in rad/s, for velocity feed-forward.
+    float yawVelocity = 0;
+    /// The rate the pitch setpoint is changing at, in rad/s, for velocity feed-forward.
+    float pitchVelocity = 0;
+    /// The time between projectile launch and impact with the target, in seconds.
+    float travelTime = 0;
+};
+
+/**
+ * Turns timestamped target position measurements, such as from a vision coprocessor, into
+ * turret setpoints each control loop, combining a target tracking kalman filter, a warm started
+ * `BallisticsSolver` and latency compensation.
+ *
+ * Positions are in a world-aligned frame centered on the projectile release position with z
+ * opposite to gravity, as `findTargetProjectileIntersection` requires. Times are microseconds of
+ * `tap::arch::clock::getTimeMicroseconds` and may wrap.
+ *
+ * Each axis of the target's position is tracked by a constant acceleration kalman filter driven
+ * by white noise jerk. The filter is kept at the time of the latest measurement, so a measurement
+ * is applied at the time it was taken however late it arrives, and `update` projects the target
+ * forward to the current time plus `AimPipelineConfig::shotLatency` without changing the filter.
+ * `addCameraMeasurement` compensates for the camera's latency, converting the time of a frame
+ * from the coprocessor's clock with a `ClockSync` and rotating the position out of the camera's
+ * frame with the attitude from an `AttitudeHistory` at that time, rather than the attitude when
+ * the measurement arrived.
+ *
+ * An update predicts three 3x3 filters and runs at most two solves of
+ * `AimPipelineConfig::maxSolverIterations` iterations, usually one or two iterations since the
+ * solver is warm started from the previous update, so its cost per control loop is fixed.
+ */
+class AimPipeline
+{
+public:
+    explicit AimPipeline(const AimPipelineConfig &config = AimPipelineConfig());
+
+    /// Sets the velocity of projectiles, which may change with the referee system's limits.
+    void setBulletVelocity(float bulletVelocity) { config.bulletVelocity = bulletVelocity; }
+
+    /// Forgets the target.
+    void reset();
+
+    /**
+     * Adds a measured target position.
+     *
+     * @param[in] timeUs When the position was measured.
+     * @param[in] position The target position, in the frame described above.
+     * @return `false` if the measurement is older than the latest one, in which case it is
+     *      discarded.
+     */
+    bool addMeasurement(uint32_t timeUs, const modm::Vector3f &position);
+
+    /**
+     * Adds a target position measured by a camera whose attitude is tracked in `history`, for
+     * example a camera mounted on the turret next to the IMU.
+     *
+     * @param[in] hostTimeUs The exposure time of the frame, in the coprocessor's clock.
+     * @param[in] clockSync Converts `hostTimeUs` to local time.
+     * @param[in] history The attitudes of the camera, rotations from the camera's frame to the
+     *      world-aligned frame.
+     * @param[in] cameraPosition The target position in the camera's frame, relative to the
+     *      projectile release position.
+     * @return `false` if the clocks aren't synced, the attitude at the exposure time isn't in
+     *      `history` or the measurement is older than the latest one.
+     */
+    template <int CAPACITY>
+    bool addCameraMeasurement(
+        uint64_t hostTimeUs,
+        const tap::arch::ClockSync &clockSync,
+        const AttitudeHistory<CAPACITY> &history,
+        const float (&cameraPosition)[3])
+    {
+        if (!clockSync.isSynced())
+        {
+            return false;
+        }
+        const uint32_t timeUs = static_cast<uint32_t>(clockSync.hostToLocalUs(hostTimeUs));
+        float q[4];
+        if (!history.getAttitudeAt(timeUs, q))
+        {
+            return false;
+        }
+        float position[3];
+        transforms::Quaternion(q).rotate(cameraPosition, position);
+        return addMeasurement(timeUs, modm::Vector3f(position[0], position[1], position[2]));
+    }
+
+    /**
+     * @return `true` if the target was measured within the last
+     *      `AimPipelineConfig::targetTimeoutUs`.
+     */
+    bool hasTarget(uint32_t timeUs) const;
+
+    /// @return The estimated state of the target at `timeUs`.
+    SecondOrderKinematicState getTargetState(uint32_t timeUs) const;
+
+    /**
+     * Computes the setpoints to hit the target with a projectile fired
+     * `AimPipelineConfig::shotLatency` after `timeUs`.
+     *
+     * @return `false` if there is no target or no aiming solution, in which case `setpoint` is
+     *      unchanged.
+     */
+    bool update(uint32_t timeUs, AimSetpoint *setpoint);
+
+    /// @return The ballistics solution of the last update.
+    const BallisticsSolution &getLastSolution() const { return lastSolution; }
+
+private:
+    /**
+     * A constant acceleration kalman filter of one axis, with state (position, velocity,
+     * acceleration).
+     */
+    struct AxisFilter
+    {
+        float x[3];
+        float P[3][3];
+
+        void init(float position, const AimPipelineConfig &config);
+        void predict(float dt, float jerkNoise);
+        void correct(float position, float measurementVariance);
+    };
+
+    AimPipelineConfig config;
+    BallisticsSolver solver;
+    BallisticsSolution lastSolution;
+
+    AxisFilter axes[3];
+    bool tracking = false;
+    /// The time of the latest measurement, which the filters are at.
+    uint32_t filterTimeUs = 0;
+
+    /// @return The time from the filters' time to `timeUs`, in seconds.
+    float secondsSinceFilter(uint32_t timeUs) const
+    {
+        return static_cast<int32_t>(timeUs - filterTimeUs) * 1E-6f;
+    }
+};  // class AimPipeline
+}  // namespace tap::algorithms::ballistics
+
+#endif  // TAPROOT_AIM_PIPELINE_HPP_
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "attitude_eskf.hpp"
+
+#include <cmath>
+
+#include "math_user_utils.hpp"
+
+namespace tap::algorithms
+{
+static constexpr float DEFAULT_SAMPLE_FREQUENCY = 500.0f;
+static constexpr float DEGREES_TO_RADIANS = M_PI / 180.0f;
+static constexpr float RADIANS_TO_DEGREES = 180.0f / M_PI;
+
+AttitudeEskf::AttitudeEskf() : AttitudeEskf(Config()) {}
+
+AttitudeEskf::AttitudeEskf(const Config &config)
+    : config(config),
+      dt(1.0f / DEFAULT_SAMPLE_FREQUENCY)
+{
+    zeroRateH.data.fill(0.0f);
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        zeroRateH.data[i * ERROR_STATES + 3 + i] = 1.0f;
+    }
+    F.constructIdentityMatrix();
+    updateProcessNoise();
+    reset();
+}
+
+void AttitudeEskf::setSampleFrequency(float sampleFrequency)
+{
+    dt = 1.0f / sampleFrequency;
+    updateProcessNoise();
+}
+
+void AttitudeEskf::reset()
+{
+    q[0] = 1.0f;
+    q[1] = 0.0f;
+    q[2] = 0.0f;
+    q[3] = 0.0f;
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        bias[i] = 0.0f;
+        filteredRate[i] = 0.0f;
+    }
+
+    const float attitudeVariance = config.initialAttitudeStd * config.initialAttitudeStd;
+    const float biasVariance = config.initialBiasStd * config.initialBiasStd;
+    P.data.fill(0.0f);
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        P.data[i * ERROR_STATES + i] = attitudeVariance;
+        P.data[(i + 3) * ERROR_STATES + i + 3] = biasVariance;
+    }
+
+    leveled = false;
+    stationaryTimer = 0.0f;
+    stationary = false;
+
+    roll = 0.0f;
+    pitch = 0.0f;
+    yaw = 0.0f;
+    rollDegrees = 0.0f;
+    pitchDegrees = 0.0f;
+    yawDegrees = 0.0f;
+    anglesComputed = true;
+}
+
+void AttitudeEskf::updateProcessNoise()
+{
+    const float attitudeVariance = config.gyroNoiseDensity * config.gyroNoiseDensity * dt;
+    const float biasVariance = config.gyroBiasRandomWalk * config.gyroBiasRandomWalk * dt;
+    Q.data.fill(0.0f);
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        Q.data[i * ERROR_STATES + i] = attitudeVariance;
+        Q.data[(i + 3) * ERROR_STATES + i + 3] = biasVariance;
+    }
+
+    // The attitude error is driven by minus the bias error.
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        F.data[i * ERROR_STATES + 3 + i] = -dt;
+    }
+}
+
+void AttitudeEskf::updateIMU(float gx, float gy, float gz, float ax, float ay, float az)
+{
+    const float accNorm = sqrtf(ax * ax + ay * ay + az * az);
+    const bool accValid = accNorm > 0.0f;
+
+    if (!leveled && accValid)
+    {
+        level(ax / accNorm, ay / accNorm, az / accNorm);
+        leveled = true;
+    }
+
+    float w[3] = {
+        gx * DEGREES_TO_RADIANS - bias[0],
+        gy * DEGREES_TO_RADIANS - bias[1],
+        gz * DEGREES_TO_RADIANS - bias[2],
+    };
+    predict(w);
+
+    if (accValid && fabsf(accNorm / ACCELERATION_GRAVITY - 1.0f) <= config.accelGate)
+    {
+        correctWithAccelerometer(ax / accNorm, ay / accNorm, az / accNorm);
+    }
+
+    stationary = false;
+    if (config.stationaryRate > 0.0f)
+    {
+        const float alpha = dt / (config.stationaryTime * 0.25f + dt);
+        float filteredNormSquared = 0.0f;
+        for (uint16_t i = 0; i < 3; i++)
+        {
+            filteredRate[i] += alpha * (w[i] - filteredRate[i]);
+            filteredNormSquared += filteredRate[i] * filteredRate[i];
+        }
+
+        const float stationaryRate = config.stationaryRate * DEGREES_TO_RADIANS;
+        if (filteredNormSquared < stationaryRate * stationaryRate)
+        {
+            stationaryTimer += dt;
+        }
+        else
+        {
+            stationaryTimer = 0.0f;
+        }
+
+        if (stationaryTimer >= config.stationaryTime)
+        {
+            // The accelerometer correction may have changed the bias since w was computed.
+            w[0] = gx * DEGREES_TO_RADIANS - bias[0];
+            w[1] = gy * DEGREES_TO_RADIANS - bias[1];
+            w[2] = gz * DEGREES_TO_RADIANS - bias[2];
+            correctWithZeroRate(w);
+            stationary = true;
+        }
+    }
+
+    anglesComputed = false;
+}
+
+void AttitudeEskf::level(float ax, float ay, float az)
+{
+    const float halfRoll = 0.5f * atan2f(ay, az);
+    const float halfPitch = 0.5f * atan2f(-ax, sqrtf(ay * ay + az * az));
+    const float cr = cosf(halfRoll);
+    const float sr = sinf(halfRoll);
+    const float cp = cosf(halfPitch);
+    const float sp = sinf(halfPitch);
+
+    q[0] = cr * cp;
+    q[1] = sr * cp;
+    q[2] = cr * sp;
+    q[3] = -sr * sp;
+}
+
+void AttitudeEskf::predict(const float (&w)[3])
+{
+    const float theta[3] = {w[0] * dt, w[1] * dt, w[2] * dt};
+
+    // Second order approximation of the quaternion exponential of the rotation this sample.
+    const float thetaNormSquared =
+        theta[0] * theta[0] + theta[1] * theta[1] + theta[2] * theta[2];
+    const float dqw = 1.0f - thetaNormSquared / 8.0f;
+    const float dqScale = 0.5f - thetaNormSquared / 48.0f;
+    const float dqx = theta[0] * dqScale;
+    const float dqy = theta[1] * dqScale;
+    const float dqz = theta[2] * dqScale;
+
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] = q0 * dqw - q1 * dqx - q2 * dqy - q3 * dqz;
+    q[1] = q0 * dqx + q1 * dqw + q2 * dqz - q3 * dqy;
+    q[2] = q0 * dqy - q1 * dqz + q2 * dqw + q3 * dqx;
+    q[3] = q0 * dqz + q1 * dqy - q2 * dqx + q3 * dqw;
+    normalizeQuaternion();
+
+    // The attitude block of F is I - [theta]x, the rest doesn't change.
+    F.data[0 * ERROR_STATES + 1] = theta[2];
+    F.data[0 * ERROR_STATES + 2] = -theta[1];
+    F.data[1 * ERROR_STATES + 0] = -theta[2];
+    F.data[1 * ERROR_STATES + 2] = theta[0];
+    F.data[2 * ERROR_STATES + 0] = theta[1];
+    F.data[2 * ERROR_STATES + 1] = -theta[0];
+
+    // P = F * P * Ft + Q
+    CMSISMat<ERROR_STATES, ERROR_STATES> FP;
+    multiply(F, P, FP);
+    mulTransposedAdd(FP, F, Q, P);
+}
+
+void AttitudeEskf::correctWithAccelerometer(float ax, float ay, float az)
+{
+    // Gravity in the sensor frame as predicted by the nominal attitude.
+    const float gx = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    const float gy = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+    const float gz = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+
+    // A small rotation dtheta of the sensor frame changes the predicted gravity by g x dtheta.
+    // clang-format off
+    CMSISMat<3, ERROR_STATES> H({
+        0.0f, -gz,  gy,   0.0f, 0.0f, 0.0f,
+        gz,   0.0f, -gx,  0.0f, 0.0f, 0.0f,
+        -gy,  gx,   0.0f, 0.0f, 0.0f, 0.0f,
+    });
+    // clang-format on
+    CMSISMat<3, 1> residual({ax - gx, ay - gy, az - gz});
+
+    correct(H, residual, config.accelNoise * config.accelNoise);
+}
+
+void AttitudeEskf::correctWithZeroRate(const float (&w)[3])
+{
+    // While stationary the gyroscope measures only its bias, so the bias-corrected angular
+    // velocity is the bias error.
+    CMSISMat<3, 1> residual({w[0], w[1], w[2]});
+
+    correct(zeroRateH, residual, config.zeroRateNoise * config.zeroRateNoise);
+}
+
+template <uint16_t MEASUREMENTS>
+void AttitudeEskf::correct(
+    const CMSISMat<MEASUREMENTS, ERROR_STATES> &H,
+    const CMSISMat<MEASUREMENTS, 1> &residual,
+    float variance)
+{
+    CMSISMat<ERROR_STATES, MEASUREMENTS> PHt;
+    mulTransposed(P, H, PHt);
+    CMSISMat<MEASUREMENTS, MEASUREMENTS> S;
+    multiply(H, PHt, S);
+    for (uint16_t i = 0; i < MEASUREMENTS; i++)
+    {
+        S.data[i * MEASUREMENTS + i] += variance;
+    }
+
+    CMSISMat<MEASUREMENTS, MEASUREMENTS> SInverse;
+    inverse(S, SInverse);
+    CMSISMat<ERROR_STATES, MEASUREMENTS> K;
+    multiply(PHt, SInverse, K);
+    CMSISMat<ERROR_STATES, 1> dx;
+    multiply(K, residual, dx);
+    // P = P - K * PHt^T
+    mulTransposedAdd(K, PHt, P, P, -1.0f);
+
+    // Keep P symmetric despite rounding.
+    for (uint16_t i = 0; i < ERROR_STATES; i++)
+    {
+        for (uint16_t j = i + 1; j < ERROR_STATES; j++)
+        {
+            const float mean =
+                0.5f * (P.data[i * ERROR_STATES + j] + P.data[j * ERROR_STATES + i]);
+            P.data[i * ERROR_STATES + j] = mean;
+            P.data[j * ERROR_STATES + i] = mean;
+        }
+    }
+
+    // Inject the error state, q = q * [1, dtheta / 2]. The covariance of the error after the
+    // injection is treated as unchanged, which holds for the small errors left after each update.
+    const float dqx = 0.5f * dx.data[0];
+    const float dqy = 0.5f * dx.data[1];
+    const float dqz = 0.5f * dx.data[2];
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] = q0 - q1 * dqx - q2 * dqy - q3 * dqz;
+    q[1] = q0 * dqx + q1 + q2 * dqz - q3 * dqy;
+    q[2] = q0 * dqy - q1 * dqz + q2 + q3 * dqx;
+    q[3] = q0 * dqz + q1 * dqy - q2 * dqx + q3;
+    normalizeQuaternion();
+
+    bias[0] += dx.data[3];
+    bias[1] += dx.data[4];
+    bias[2] += dx.data[5];
+}
+
+void AttitudeEskf::normalizeQuaternion()
+{
+    const float invNorm = 1.0f / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    q[0] *= invNorm;
+    q[1] *= invNorm;
+    q[2] *= invNorm;
+    q[3] *= invNorm;
+}
+
+void AttitudeEskf::computeAngles()
+{
+    roll = atan2f(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]);
+    pitch = asinf(limitVal(-2.0f * (q[1] * q[3] - q[0] * q[2]), -1.0f, 1.0f));
+    yaw = atan2f(q[1] * q[2] + q[0] * q[3], 0.5f - q[2] * q[2] - q[3] * q[3]);
+    rollDegrees = roll * RADIANS_TO_DEGREES;
+    pitchDegrees = pitch * RADIANS_TO_DEGREES;
+    yawDegrees = yaw * RADIANS_TO_DEGREES;
+    if (yawDegrees < 0.0f)
+    {
+        yawDegrees += 360.0f;
+    }
+    anglesComputed = true;
+}
+
+float AttitudeEskf::getRoll()
+{
+    if (!anglesComputed) computeAngles();
+    return rollDegrees;
+}
+
+float AttitudeEskf::getPitch()
+{
+    if (!anglesComputed) computeAngles();
+    return pitchDegrees;
+}
+
+float AttitudeEskf::getYaw()
+{
+    if (!anglesComputed) computeAngles();
+    return yawDegrees;
+}
+
+float AttitudeEskf::getRollRadians()
+{
+    if (!anglesComputed) computeAngles();
+    return roll;
+}
+
+float AttitudeEskf::getPitchRadians()
+{
+    if (!anglesComputed) computeAngles();
+    return pitch;
+}
+
+float AttitudeEskf::getYawRadians()
+{
+    if (!anglesComputed) computeAngles();
+    return yaw;
+}
+
+void AttitudeEskf::getQuaternion(float (&q)[4]) const
+{
+    q[0] = this->q[0];
+    q[1] = this->q[1];
+    q[2] = this->q[2];
+    q[3] = this->q[3];
+}
+
+void AttitudeEskf::getGyroBias(float (&bias)[3]) const
+{
+    bias[0] = this->bias[0] * RADIANS_TO_DEGREES;
+    bias[1] = this->bias[1] * RADIANS_TO_DEGREES;
+    bias[2] = this->bias[2] * RADIANS_TO_DEGREES;
+}
+
+}  // namespace tap::algorithms
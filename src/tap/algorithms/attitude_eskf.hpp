@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ATTITUDE_ESKF_HPP_
+#define TAPROOT_ATTITUDE_ESKF_HPP_
+
+#include <cstdint>
+
+#include "attitude_estimator.hpp"
+#include "cmsis_mat.hpp"
+
+namespace tap::algorithms
+{
+/**
+ * An error-state Kalman filter (ESKF) that estimates attitude and gyroscope bias.
+ *
+ * The nominal state is a unit quaternion and a gyroscope bias, integrated from each gyroscope
+ * sample. The filter tracks the covariance of a 6 element error state, a small rotation of the
+ * sensor frame and an error in the bias, and corrects the nominal state with:
+ *  - The direction of gravity measured by the accelerometer, skipped whenever the magnitude of
+ *    the acceleration differs from gravity by more than `Config::accelGate`, for example while
+ *    the robot accelerates or is hit.
+ *  - A zero angular rate measurement whenever the bias-corrected gyroscope has been still for
+ *    `Config::stationaryTime`. Gravity says nothing about rotation around the vertical axis, so
+ *    this is what lets the filter learn the bias of a yaw axis gyroscope, and is the main reason
+ *    to use it over `Mahony` on a robot that spends time stationary, such as a sentry.
+ *
+ * All matrices are fixed size `CMSISMat`s, so updates don't allocate. An update costs a few
+ * 6x6 matrix products, roughly ten times the CPU time of `Mahony::updateIMU`.
+ */
+class AttitudeEskf : public AttitudeEstimator
+{
+public:
+    static constexpr uint16_t ERROR_STATES = 6;
+
+    struct Config
+    {
+        /// Gyroscope white noise density, in rad/s/sqrt(Hz).
+        float gyroNoiseDensity = 1.0e-3f;
+        /// Gyroscope bias random walk, in rad/s^2/sqrt(Hz).
+        float gyroBiasRandomWalk = 2.0e-5f;
+        /**
+         * Standard deviation of each component of the normalized acceleration, unitless. Covers
+         * accelerometer noise, vibration, and acceleration that isn't gravity.
+         */
+        float accelNoise = 0.05f;
+        /**
+         * The largest relative difference between the magnitude of the acceleration and gravity
+         * for which the accelerometer is used.
+         */
+        float accelGate = 0.1f;
+        /**
+         * The bias-corrected angular velocity, low pass filtered, must stay below this for the
+         * sensor to be considered stationary, in degrees / second. 0 disables zero angular rate
+         * updates.
+         */
+        float stationaryRate = 0.5f;
+        /// Time the sensor must be still before it is considered stationary, in seconds.
+        float stationaryTime = 0.25f;
+        /// Standard deviation of the gyroscope while stationary, in rad/s.
+        float zeroRateNoise = 5.0e-3f;
+        /// Initial standard deviation of the roll, pitch, and yaw error, in radians.
+        float initialAttitudeStd = 0.05f;
+        /// Initial standard deviation of the gyroscope bias, in rad/s.
+        float initialBiasStd = 0.01f;
+    };
+
+    AttitudeEskf();
+
+    explicit AttitudeEskf(const Config &config);
+
+    void setSampleFrequency(float sampleFrequency) override;
+
+    /// Also levels the estimate with the first acceleration sample after the reset.
+    void reset() override;
+
+    void updateIMU(float gx, float gy, float gz, float ax, float ay, float az) override;
+
+    float getRoll() override;
+    float getPitch() override;
+    float getYaw() override;
+    float getRollRadians() override;
+    float getPitchRadians() override;
+    float getYawRadians() override;
+
+    void getQuaternion(float (&q)[4]) const override;
+
+    /// Copies the estimated gyroscope bias into `bias`, in degrees / second.
+    void getGyroBias(float (&bias)[3]) const;
+
+    /// @return `true` if the last update applied a zero angular rate measurement.
+    bool isStationary() const { return stationary; }
+
+    /// @return The error state covariance, attitude error (rad) followed by bias error (rad/s).
+    const CMSISMat<ERROR_STATES, ERROR_STATES> &getCovariance() const { return P; }
+
+private:
+    Config config;
+
+    float dt;
+
+    /// Quaternion (w, x, y, z) of the sensor frame relative to the earth frame.
+    float q[4];
+    /// Gyroscope bias, in rad/s.
+    float bias[3];
+
+    /// Error state covariance.
+    CMSISMat<ERROR_STATES, ERROR_STATES> P;
+    /// Error state transition matrix, only the attitude block changes between updates.
+    CMSISMat<ERROR_STATES, ERROR_STATES> F;
+    /// Process noise per update, diagonal.
+    CMSISMat<ERROR_STATES, ERROR_STATES> Q;
+    /// Observation matrix of the zero angular rate measurement, constant.
+    CMSISMat<3, ERROR_STATES> zeroRateH;
+
+    bool leveled;
+
+    /// Low pass filtered bias-corrected angular velocity, in rad/s.
+    float filteredRate[3];
+    float stationaryTimer;
+    bool stationary;
+
+    float roll, pitch, yaw;
+    float rollDegrees, pitchDegrees, yawDegrees;
+    bool anglesComputed;
+
+    void updateProcessNoise();
+
+    /// Rotates the estimate so the sensor's z axis points along the unit vector `a`.
+    void level(float ax, float ay, float az);
+
+    /// Integrates the bias-corrected angular velocity `w` (rad/s) and propagates `P`.
+    void predict(const float (&w)[3]);
+
+    void correctWithAccelerometer(float ax, float ay, float az);
+
+    void correctWithZeroRate(const float (&w)[3]);
+
+    /**
+     * Applies a measurement with residual `residual`, observation matrix `H`, and independent
+     * errors of variance `variance`, then injects the error state into the nominal state.
+     */
+    template <uint16_t MEASUREMENTS>
+    void correct(
+        const CMSISMat<MEASUREMENTS, ERROR_STATES> &H,
+        const CMSISMat<MEASUREMENTS, 1> &residual,
+        float variance);
+
+    void normalizeQuaternion();
+
+    void computeAngles();
+};  // class AttitudeEskf
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_ATTITUDE_ESKF_HPP_
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ATTITUDE_ESTIMATOR_HPP_
+#define TAPROOT_ATTITUDE_ESTIMATOR_HPP_
+
+#include "cmsis_mat.hpp"
+
+namespace tap::algorithms
+{
+/**
+ * An interface for algorithms that estimate the orientation of a 6 axis IMU from its gyroscope
+ * and accelerometer readings. IMU drivers that implement `ImuInterface` own a default estimator
+ * and accept any other one, so each robot can choose how much CPU time to spend on its attitude
+ * estimate.
+ *
+ * The estimate is the orientation of the sensor frame relative to an earth frame whose z axis
+ * points up and whose yaw is 0 wherever the estimator started or was last reset.
+ */
+class AttitudeEstimator
+{
+public:
+    virtual ~AttitudeEstimator() = default;
+
+    /**
+     * Sets the rate at which `updateIMU` is called, in Hz. Does not reset the estimate.
+     */
+    virtual void setSampleFrequency(float sampleFrequency) = 0;
+
+    /**
+     * Resets the estimate to level with a yaw of 0 and forgets anything learned about the
+     * sensor, such as gyroscope bias.
+     */
+    virtual void reset() = 0;
+
+    /**
+     * Updates the estimate with one sample.
+     *
+     * @param[in] gx, gy, gz The angular velocity, in degrees / second.
+     * @param[in] ax, ay, az The acceleration, in m/s^2.
+     */
+    virtual void updateIMU(float gx, float gy, float gz, float ax, float ay, float az) = 0;
+
+    /// @return The roll angle, in degrees.
+    virtual float getRoll() = 0;
+    /// @return The pitch angle, in degrees.
+    virtual float getPitch() = 0;
+    /// @return The yaw angle, in degrees, wrapped to [0, 360).
+    virtual float getYaw() = 0;
+
+    /// @return The roll angle, in radians.
+    virtual float getRollRadians() = 0;
+    /// @return The pitch angle, in radians.
+    virtual float getPitchRadians() = 0;
+    /// @return The yaw angle, in radians, wrapped to (-pi, pi].
+    virtual float getYawRadians() = 0;
+
+    /**
+     * Copies the unit quaternion (w, x, y, z) of the sensor frame relative to the earth frame
+     * into `q`.
+     */
+    virtual void getQuaternion(float (&q)[4]) const = 0;
+
+    /**
+     * @return The rotation matrix from the sensor frame to the earth frame, in the same row major
+     *      layout `tap::algorithms::transforms::Orientation` uses. Computed without any trig.
+     */
+    CMSISMat<3, 3> getRotationMatrix() const
+    {
+        float q[4];
+        getQuaternion(q);
+
+        const float q0q0 = q[0] * q[0];
+        const float q0q1 = q[0] * q[1];
+        const float q0q2 = q[0] * q[2];
+        const float q0q3 = q[0] * q[3];
+        const float q1q1 = q[1] * q[1];
+        const float q1q2 = q[1] * q[2];
+        const float q1q3 = q[1] * q[3];
+        const float q2q2 = q[2] * q[2];
+        const float q2q3 = q[2] * q[3];
+        const float q3q3 = q[3] * q[3];
+
+        // clang-format off
+        return CMSISMat<3, 3>({
+            2.0f * (q0q0 + q1q1) - 1.0f, 2.0f * (q1q2 - q0q3),        2.0f * (q1q3 + q0q2),
+            2.0f * (q1q2 + q0q3),        2.0f * (q0q0 + q2q2) - 1.0f, 2.0f * (q2q3 - q0q1),
+            2.0f * (q1q3 - q0q2),        2.0f * (q2q3 + q0q1),        2.0f * (q0q0 + q3q3) - 1.0f,
+        });
+        // clang-format on
+    }
+};  // class AttitudeEstimator
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_ATTITUDE_ESTIMATOR_HPP_
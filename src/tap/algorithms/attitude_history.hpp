@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ATTITUDE_HISTORY_HPP_
+#define TAPROOT_ATTITUDE_HISTORY_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+#include "timestamped_history.hpp"
+
+namespace tap::algorithms
+{
+/**
+ * A fixed size ring of timestamped attitudes and angular velocities, for looking up the attitude
+ * at a past time, such as the exposure time of a camera frame, to compensate for latency.
+ *
+ * Entries must be pushed in order of time. Lookups between two entries interpolate them, and
+ * lookups of times after the newest entry return the newest entry. Not safe to push from an
+ * interrupt while reading from the main loop. See `TimestampedHistory`.
+ *
+ * @tparam CAPACITY The number of entries kept, must be a power of two. At 1 kHz, 128 entries
+ *      cover 128 ms.
+ */
+template <int CAPACITY>
+class AttitudeHistory
+{
+public:
+    /**
+     * Adds an entry. An entry whose time isn't after the newest entry's, such as another sample
+     * of the same FIFO read, replaces the newest entry instead.
+     *
+     * @param[in] time The time of the sample, in microseconds.
+     * @param[in] q The attitude quaternion (w, x, y, z).
+     * @param[in] gyro The angular velocity, in degrees / second.
+     */
+    void push(uint32_t time, const float (&q)[4], const float (&gyro)[3])
+    {
+        Entry &entry = history.push(time);
+        for (int i = 0; i < 4; i++)
+        {
+            entry.q[i] = q[i];
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            entry.gyro[i] = gyro[i];
+        }
+    }
+
+    void clear() { history.clear(); }
+
+    /// @return The number of entries.
+    int size() const { return history.size(); }
+
+    /// @return The time of the oldest entry, in microseconds, or 0 if there are none.
+    uint32_t getOldestTime() const { return history.getOldestTime(); }
+
+    /// @return The time of the newest entry, in microseconds, or 0 if there are none.
+    uint32_t getNewestTime() const { return history.getNewestTime(); }
+
+    /**
+     * Computes the attitude at `time`, normalized linear interpolation between the entries on
+     * either side of it.
+     *
+     * @return `false` if there are no entries or `time` is before the oldest entry, in which
+     *      case `q` is unchanged.
+     */
+    bool getAttitudeAt(uint32_t time, float (&q)[4]) const
+    {
+        int older;
+        float t;
+        if (!history.find(time, older, t))
+        {
+            return false;
+        }
+
+        const Entry &a = history.at(older);
+        if (older == 0)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                q[i] = a.q[i];
+            }
+            return true;
+        }
+
+        // q and -q are the same rotation, interpolate towards whichever is closer.
+        const Entry &b = history.at(older - 1);
+        const float dot = a.q[0] * b.q[0] + a.q[1] * b.q[1] + a.q[2] * b.q[2] + a.q[3] * b.q[3];
+        const float sign = dot < 0 ? -1.0f : 1.0f;
+        float norm = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            q[i] = a.q[i] + t * (sign * b.q[i] - a.q[i]);
+            norm += q[i] * q[i];
+        }
+        norm = sqrtf(norm);
+        for (int i = 0; i < 4; i++)
+        {
+            q[i] /= norm;
+        }
+        return true;
+    }
+
+    /**
+     * Computes the angular velocity at `time`, interpolating between the entries on either side
+     * of it, in degrees / second.
+     *
+     * @return `false` if there are no entries or `time` is before the oldest entry, in which
+     *      case `gyro` is unchanged.
+     */
+    bool getGyroAt(uint32_t time, float (&gyro)[3]) const
+    {
+        int older;
+        float t;
+        if (!history.find(time, older, t))
+        {
+            return false;
+        }
+
+        const Entry &a = history.at(older);
+        const Entry &b = older == 0 ? a : history.at(older - 1);
+        for (int i = 0; i < 3; i++)
+        {
+            gyro[i] = a.gyro[i] + t * (b.gyro[i] - a.gyro[i]);
+        }
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        uint32_t time;
+        float q[4];
+        float gyro[3];
+    };
+
+    TimestampedHistory<Entry, CAPACITY> history;
+};  // class AttitudeHistory
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_ATTITUDE_HISTORY_HPP_
@@ -23,16 +23,35 @@
 
 namespace tap::algorithms::ballistics
 {
-bool computeTravelTime(
+/**
+ * The terms of `computeTravelTime` that depend only on the bullet velocity, so they can be
+ * shared by many targets.
+ */
+struct ShotTerms
+{
+    explicit ShotTerms(float bulletVelocity)
+        : bulletVelocity(bulletVelocity),
+          bulletVelocitySquared(powf(bulletVelocity, 2)),
+          bulletVelocityFourth(powf(bulletVelocitySquared, 2))
+    {
+    }
+
+    float bulletVelocity;
+    float bulletVelocitySquared;
+    float bulletVelocityFourth;
+};
+
+static bool computeTravelTime(
+    const ShotTerms &shot,
     const modm::Vector3f &targetPosition,
-    float bulletVelocity,
     float *travelTime,
     float *turretPitch,
     const float pitchAxisOffset)
 {
+    const float bulletVelocity = shot.bulletVelocity;
+    const float bulletVelocitySquared = shot.bulletVelocitySquared;
     float horizontalDist = hypot(targetPosition.x, targetPosition.y) + pitchAxisOffset;
-    float bulletVelocitySquared = powf(bulletVelocity, 2);
-    float sqrtTerm = powf(bulletVelocitySquared, 2) -
+    float sqrtTerm = shot.bulletVelocityFourth -
                      ACCELERATION_GRAVITY * (ACCELERATION_GRAVITY * powf(horizontalDist, 2) +
                                              2 * targetPosition.z * bulletVelocitySquared);
 
@@ -69,6 +88,50 @@ bool computeTravelTime(
     return !isnan(*turretPitch) && !isnan(*travelTime);
 }
 
+bool computeTravelTime(
+    const modm::Vector3f &targetPosition,
+    float bulletVelocity,
+    float *travelTime,
+    float *turretPitch,
+    const float pitchAxisOffset)
+{
+    return computeTravelTime(
+        ShotTerms(bulletVelocity),
+        targetPosition,
+        travelTime,
+        turretPitch,
+        pitchAxisOffset);
+}
+
+/**
+ * Computes the launch velocity for a projectile under quadratic drag with coefficient `c` to be at
+ * horizontal distance `x` and height `z` after `t`.
+ *
+ * With |v| taken as the horizontal speed u(t) = u / (1 + c * u * t), the horizontal distance is
+ * x(t) = ln(1 + c * u * t) / c and the vertical velocity has a closed form integral. Solving both
+ * for the launch velocity, with cx = c * x, r = (e^cx - 1) / cx, and D = 1 / cx - 1 / (e^cx - 1),
+ * gives u = x * r / t and w = z * r / t + g * t * (D / 2 + r / 4).
+ */
+static void flatFireLaunchVelocity(float c, float x, float z, float t, float *u, float *w)
+{
+    // Series expansions avoid cancellation when cx is small.
+    const float cx = c * x;
+    float r, d;
+    if (fabsf(cx) < 1E-3f)
+    {
+        r = 1 + cx / 2 + cx * cx / 6;
+        d = 0.5f - cx / 12;
+    }
+    else
+    {
+        const float e = expm1f(cx);
+        r = e / cx;
+        d = 1 / cx - 1 / e;
+    }
+    *u = x * r / t;
+    *w = z * r / t + ACCELERATION_GRAVITY * t * (d / 2 + r / 4);
+}
+
 bool findTargetProjectileIntersection(
     const AbstractKinematicState &targetInitialState,
     float bulletVelocity,
@@ -105,4 +168,245 @@ bool findTargetProjectileIntersection(
     return !isnan(*turretPitch) && !isnan(*turretYaw);
 }
 
+int findTargetProjectileIntersections(
+    const SecondOrderKinematicState *candidates,
+    int numCandidates,
+    float bulletVelocity,
+    uint8_t numIterations,
+    CandidateRanking ranking,
+    float currentTurretPitch,
+    float currentTurretYaw,
+    CandidateSolution *solutions,
+    const float pitchAxisOffset)
+{
+    const ShotTerms shot(bulletVelocity);
+    int numSolutions = 0;
+    for (int i = 0; i < numCandidates && i <= UINT8_MAX; i++)
+    {
+        // Qualified calls aren't virtual, so they can be inlined
+        const SecondOrderKinematicState &candidate = candidates[i];
+        modm::Vector3f position = candidate.SecondOrderKinematicState::projectForward(0);
+        if (position.x == 0 && position.y == 0 && position.z == 0)
+        {
+            continue;
+        }
+
+        CandidateSolution solution;
+        bool feasible = true;
+        for (int iteration = 0; iteration < numIterations && feasible; iteration++)
+        {
+            feasible = computeTravelTime(
+                shot,
+                position,
+                &solution.travelTime,
+                &solution.turretPitch,
+                pitchAxisOffset);
+            position = candidate.SecondOrderKinematicState::projectForward(solution.travelTime);
+        }
+        solution.turretYaw = atan2f(position.y, position.x);
+        if (!feasible || isnan(solution.turretPitch) || isnan(solution.turretYaw))
+        {
+            continue;
+        }
+
+        solution.candidate = i;
+        solution.turretMotion = fmaxf(
+            fabsf(remainderf(solution.turretYaw - currentTurretYaw, M_TWOPI)),
+            fabsf(solution.turretPitch - currentTurretPitch));
+
+        // Insertion sort, there are only a handful of candidates
+        const float key =
+            ranking == CandidateRanking::TRAVEL_TIME ? solution.travelTime : solution.turretMotion;
+        int j = numSolutions;
+        for (; j > 0; j--)
+        {
+            const CandidateSolution &previous = solutions[j - 1];
+            const float previousKey = ranking == CandidateRanking::TRAVEL_TIME
+                                          ? previous.travelTime
+                                          : previous.turretMotion;
+            if (previousKey <= key)
+            {
+                break;
+            }
+            solutions[j] = previous;
+        }
+        solutions[j] = solution;
+        numSolutions++;
+    }
+    return numSolutions;
+}
+
+void BallisticsSolver::computeLaunchVelocity(
+    float horizontalDist,
+    float height,
+    float travelTime,
+    float *horizontalVelocity,
+    float *verticalVelocity) const
+{
+    const float g = ACCELERATION_GRAVITY;
+    const float t = travelTime;
+
+    switch (dragModel.type)
+    {
+        case DragModel::Type::LINEAR:
+        {
+            // x(t) = u * q * t, z(t) = (w - G) * q * t, where q = (1 - e^(-kt)) / kt and
+            // G = g / k * (1 / q - 1). Series expansions avoid cancellation when kt is small.
+            const float kt = dragModel.coefficient * t;
+            float q, gravityTerm;
+            if (fabsf(kt) < 1E-3f)
+            {
+                q = 1 - kt / 2 + kt * kt / 6;
+                gravityTerm = g * t * (0.5f + kt / 12);
+            }
+            else
+            {
+                q = -expm1f(-kt) / kt;
+                gravityTerm = g / dragModel.coefficient * (1 / q - 1);
+            }
+            *horizontalVelocity = horizontalDist / (q * t);
+            *verticalVelocity = height / (q * t) + gravityTerm;
+            break;
+        }
+        case DragModel::Type::QUADRATIC:
+        {
+            // The flat-fire model takes |v| as the horizontal speed, which underestimates the
+            // drag on a shot fired at an angle. Solving again with the drag coefficient scaled by
+            // the mean of the secant of the launch angle and 1, about its average over the
+            // trajectory, corrects most of the difference.
+            flatFireLaunchVelocity(
+                dragModel.coefficient,
+                horizontalDist,
+                height,
+                t,
+                horizontalVelocity,
+                verticalVelocity);
+            if (*horizontalVelocity > 0)
+            {
+                const float secant =
+                    hypotf(*horizontalVelocity, *verticalVelocity) / *horizontalVelocity;
+                flatFireLaunchVelocity(
+                    dragModel.coefficient * (1 + secant) / 2,
+                    horizontalDist,
+                    height,
+                    t,
+                    horizontalVelocity,
+                    verticalVelocity);
+            }
+            break;
+        }
+        default:
+            *horizontalVelocity = horizontalDist / t;
+            *verticalVelocity = height / t + g * t / 2;
+            break;
+    }
+}
+
+float BallisticsSolver::speedError(
+    const AbstractKinematicState &targetState,
+    float bulletVelocity,
+    float pitchAxisOffset,
+    float travelTime) const
+{
+    const modm::Vector3f target = targetState.projectForward(travelTime);
+    float horizontalVelocity, verticalVelocity;
+    computeLaunchVelocity(
+        hypotf(target.x, target.y) + pitchAxisOffset,
+        target.z,
+        travelTime,
+        &horizontalVelocity,
+        &verticalVelocity);
+    return hypotf(horizontalVelocity, verticalVelocity) - bulletVelocity;
+}
+
+bool BallisticsSolver::solveFrom(
+    float initialTravelTime,
+    const AbstractKinematicState &targetState,
+    float bulletVelocity,
+    BallisticsSolution *solution,
+    float pitchAxisOffset) const
+{
+    // The launch speed needed falls as travel time increases up to the travel time of the
+    // slowest shot that reaches the target, then rises again for lobbed shots. Newton's method
+    // from the left of the direct shot's root converges to it; a rising speed means the iterate
+    // passed onto the lobbed side or the target is out of range.
+    float t = initialTravelTime;
+    bool converged = false;
+    for (uint8_t i = 0; i < maxIterations && !converged; i++)
+    {
+        solution->iterations++;
+
+        const float error = speedError(targetState, bulletVelocity, pitchAxisOffset, t);
+        const float dt = fmaxf(1E-4f * t, 1E-6f);
+        const float slope =
+            (speedError(targetState, bulletVelocity, pitchAxisOffset, t + dt) - error) / dt;
+        if (!(slope < 0))
+        {
+            return false;
+        }
+
+        const float step = error / slope;
+        t = t - step > 0 ? t - step : t / 2;
+        converged = fabsf(step) < tolerance;
+    }
+
+    const modm::Vector3f target = targetState.projectForward(t);
+    float horizontalVelocity, verticalVelocity;
+    computeLaunchVelocity(
+        hypotf(target.x, target.y) + pitchAxisOffset,
+        target.z,
+        t,
+        &horizontalVelocity,
+        &verticalVelocity);
+
+    solution->travelTime = t;
+    solution->turretPitch = -atan2f(verticalVelocity, horizontalVelocity);
+    solution->turretYaw = atan2f(target.y, target.x);
+    solution->converged = converged && !isnan(solution->turretPitch) && !isnan(t);
+    return solution->converged;
+}
+
+bool BallisticsSolver::solve(
+    const AbstractKinematicState &targetState,
+    float bulletVelocity,
+    BallisticsSolution *solution,
+    float pitchAxisOffset)
+{
+    *solution = BallisticsSolution();
+
+    const modm::Vector3f initialPosition = targetState.projectForward(0);
+    if (bulletVelocity <= 0 ||
+        (initialPosition.x == 0 && initialPosition.y == 0 && initialPosition.z == 0))
+    {
+        previousTravelTime = 0;
+        return false;
+    }
+
+    bool converged = previousTravelTime > 0 &&
+                     solveFrom(
+                         previousTravelTime,
+                         targetState,
+                         bulletVelocity,
+                         solution,
+                         pitchAxisOffset);
+
+    if (!converged)
+    {
+        // The straight line travel time is always shorter than the direct shot's, so it is to
+        // the left of the root.
+        const float distance = hypotf(
+            hypotf(initialPosition.x, initialPosition.y) + pitchAxisOffset,
+            initialPosition.z);
+        converged = solveFrom(
+            fmaxf(distance / bulletVelocity, 1E-3f),
+            targetState,
+            bulletVelocity,
+            solution,
+            pitchAxisOffset);
+    }
+
+    previousTravelTime = converged ? solution->travelTime : 0;
+    return converged;
+}
+
 }  // namespace tap::algorithms::ballistics
@@ -20,6 +20,7 @@
 #ifndef TAPROOT_BALLISTICS_HPP_
 #define TAPROOT_BALLISTICS_HPP_
 
+#include <cinttypes>
 #include <cmath>
 
 #include "modm/math/geometry/vector.hpp"
@@ -137,6 +138,198 @@ bool findTargetProjectileIntersection(
     float *projectedTravelTime,
     const float pitchAxisOffset = 0);
 
+/**
+ * How `findTargetProjectileIntersections` orders the aiming solutions it finds.
+ */
+enum class CandidateRanking : uint8_t
+{
+    /// Shortest travel time first, the shot the target has the least time to dodge.
+    TRAVEL_TIME,
+    /// Least turret motion from the current turret orientation first.
+    TURRET_MOTION,
+};
+
+/**
+ * An aiming solution for one of the candidates passed to `findTargetProjectileIntersections`.
+ */
+struct CandidateSolution
+{
+    /// The index of the candidate the solution is for.
+    uint8_t candidate = 0;
+    /// The turret pitch, in the same convention as `findTargetProjectileIntersection`.
+    float turretPitch = 0;
+    float turretYaw = 0;
+    /// The time between projectile launch and impact with the target, in seconds.
+    float travelTime = 0;
+    /**
+     * The larger of the yaw and pitch rotations from the current turret orientation to the
+     * solution, in radians, since the axes rotate at the same time.
+     */
+    float turretMotion = 0;
+};
+
+/**
+ * Finds aiming solutions for several candidate targets at once, such as each armor plate of
+ * each enemy robot, for choosing which to shoot. Each candidate is solved as by
+ * `findTargetProjectileIntersection`, but the terms that depend only on the bullet velocity are
+ * computed once for all candidates and the candidates' kinematics are projected without virtual
+ * calls.
+ *
+ * @param[in] candidates: The kinematic states of the candidate targets. Frame requirements as in
+ * `findTargetProjectileIntersection`.
+ * @param[in] numCandidates: The number of candidates, at most 255.
+ * @param[in] bulletVelocity: The velocity of the projectile to be fired in m/s.
+ * @param[in] numIterations: The number of times to project the kinematics forward, as in
+ * `findTargetProjectileIntersection`.
+ * @param[in] ranking: The order to sort the solutions in.
+ * @param[in] currentTurretPitch: The current turret pitch, in the same convention as the
+ * solutions, used to compute each solution's `turretMotion`.
+ * @param[in] currentTurretYaw: The current turret yaw.
+ * @param[out] solutions: Array of at least `numCandidates` solutions, filled in with a solution
+ * for each candidate that can be hit, best first by `ranking`.
+ * @param[in] pitchAxisOffset: The distance between the pitch and yaw axes (in meters), as in
+ * `findTargetProjectileIntersection`.
+ * @return The number of candidates that can be hit, the number of solutions filled in.
+ */
+int findTargetProjectileIntersections(
+    const SecondOrderKinematicState *candidates,
+    int numCandidates,
+    float bulletVelocity,
+    uint8_t numIterations,
+    CandidateRanking ranking,
+    float currentTurretPitch,
+    float currentTurretYaw,
+    CandidateSolution *solutions,
+    const float pitchAxisOffset = 0);
+
+/**
+ * Air drag acting on a projectile, in addition to gravity.
+ */
+struct DragModel
+{
+    enum class Type : uint8_t
+    {
+        /// Gravity only, the model `findTargetProjectileIntersection` uses.
+        NONE,
+        /// Drag proportional to velocity, a = -k * v.
+        LINEAR,
+        /**
+         * Drag proportional to the square of velocity, a = -c * |v| * v, the physically accurate
+         * model at projectile speeds. Solved with a corrected flat-fire approximation, which is
+         * accurate to 5 mm over 8 m for shots within about 20 degrees of level, and to about 1 cm
+         * for steeper shots.
+         */
+        QUADRATIC,
+    };
+
+    Type type = Type::NONE;
+
+    /**
+     * k for `LINEAR`, in 1/s. c for `QUADRATIC`, in 1/m, which is rho * Cd * A / (2 * m) for air
+     * density rho, drag coefficient Cd, cross-sectional area A, and projectile mass m. Around 0.02
+     * for 17 mm and 0.01 for 42 mm projectiles.
+     */
+    float coefficient = 0;
+};
+
+/**
+ * An aiming solution found by `BallisticsSolver`.
+ */
+struct BallisticsSolution
+{
+    /// The turret pitch, in the same convention as `findTargetProjectileIntersection`.
+    float turretPitch = 0;
+    float turretYaw = 0;
+    /// The time between projectile launch and impact with the target, in seconds.
+    float travelTime = 0;
+    /// The number of Newton iterations the solution took.
+    uint8_t iterations = 0;
+    /// Whether the travel time converged to within the solver's tolerance.
+    bool converged = false;
+};
+
+/**
+ * Finds the pitch, yaw, and travel time to hit a moving target, like
+ * `findTargetProjectileIntersection`, optionally with air drag.
+ *
+ * For a travel time t, the launch velocity that puts the projectile at the target's position at t
+ * has a closed form under each drag model. The solver finds the shortest t at which the speed of
+ * that launch velocity is the muzzle speed by Newton's method, starting from the previous
+ * solution's travel time. Since targets move little between control loops, a solver that is kept
+ * across calls usually converges in one or two iterations.
+ */
+class BallisticsSolver
+{
+public:
+    /**
+     * @param[in] dragModel: The drag acting on projectiles.
+     * @param[in] maxIterations: The most Newton iterations to run per solve.
+     * @param[in] tolerance: The change in travel time between iterations below which the travel
+     * time is considered converged, in seconds.
+     */
+    BallisticsSolver(
+        const DragModel &dragModel = DragModel(),
+        uint8_t maxIterations = 8,
+        float tolerance = 1E-5f)
+        : dragModel(dragModel),
+          maxIterations(maxIterations),
+          tolerance(tolerance)
+    {
+    }
+
+    void setDragModel(const DragModel &model) { dragModel = model; }
+
+    /**
+     * @param[in] targetState: The 3D kinematic state of a target. Frame requirements: RELATIVE TO
+     * PROJECTILE RELEASE POSITION, Z IS OPPOSITE TO GRAVITY.
+     * @param[in] bulletVelocity: The velocity of the projectile to be fired in m/s.
+     * @param[out] solution: The aiming solution. Filled in whether or not it converged.
+     * @param[in] pitchAxisOffset: The distance between the pitch and yaw axes (in meters), as in
+     * `findTargetProjectileIntersection`.
+     * @return Whether a converged aiming solution was found.
+     */
+    bool solve(
+        const AbstractKinematicState &targetState,
+        float bulletVelocity,
+        BallisticsSolution *solution,
+        float pitchAxisOffset = 0);
+
+    /// Forgets the previous solution, so the next solve starts from scratch.
+    void resetWarmStart() { previousTravelTime = 0; }
+
+private:
+    DragModel dragModel;
+    uint8_t maxIterations;
+    float tolerance;
+    /// The travel time of the previous converged solution, or 0 if there is none.
+    float previousTravelTime = 0;
+
+    /**
+     * Computes the horizontal and vertical launch velocity for the projectile to be at `target`
+     * after `travelTime`.
+     */
+    void computeLaunchVelocity(
+        float horizontalDist,
+        float height,
+        float travelTime,
+        float *horizontalVelocity,
+        float *verticalVelocity) const;
+
+    /// The launch speed needed to hit the target at `travelTime` less `bulletVelocity`.
+    float speedError(
+        const AbstractKinematicState &targetState,
+        float bulletVelocity,
+        float pitchAxisOffset,
+        float travelTime) const;
+
+    bool solveFrom(
+        float initialTravelTime,
+        const AbstractKinematicState &targetState,
+        float bulletVelocity,
+        BallisticsSolution *solution,
+        float pitchAxisOffset) const;
+};
+
 }  // namespace tap::algorithms::ballistics
 
 #endif  // TAPROOT_BALLISTICS_HPP_
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BALLISTICS_TABLE_HPP_
+#define TAPROOT_BALLISTICS_TABLE_HPP_
+
+#include <cmath>
+
+#include "ballistics.hpp"
+
+namespace tap::algorithms::ballistics
+{
+/**
+ * A grid of turret pitches and travel times to hit stationary targets at evenly spaced horizontal
+ * distances and heights, for one bullet velocity, so aiming costs a bilinear interpolation rather
+ * than an iterative solve. Targets outside the grid, or next to grid points that have no
+ * solution, are solved exactly by a `BallisticsSolver` with the same drag model.
+ *
+ * The table is filled at startup by `initialize`, which solves every grid point and takes on the
+ * order of a microsecond per point. Use one table per bullet velocity.
+ *
+ * @tparam DISTANCE_POINTS The number of grid points along the horizontal distance.
+ * @tparam HEIGHT_POINTS The number of grid points along the height. The table takes 8 bytes per
+ *      grid point.
+ */
+template <int DISTANCE_POINTS, int HEIGHT_POINTS>
+class BallisticsTable
+{
+public:
+    static_assert(
+        DISTANCE_POINTS >= 2 && HEIGHT_POINTS >= 2,
+        "BallisticsTable needs at least two points along each axis");
+
+    /**
+     * Solves every grid point.
+     *
+     * @param[in] velocity: The velocity of the projectile to be fired in m/s.
+     * @param[in] minDistance: The horizontal distance of the first grid column, in m.
+     * @param[in] maxDistance: The horizontal distance of the last grid column, in m.
+     * @param[in] minHeight: The height of the first grid row, in m.
+     * @param[in] maxHeight: The height of the last grid row, in m.
+     * @param[in] dragModel: The drag acting on projectiles.
+     */
+    void initialize(
+        float velocity,
+        float minDistance,
+        float maxDistance,
+        float minHeight,
+        float maxHeight,
+        const DragModel &dragModel = DragModel())
+    {
+        bulletVelocity = velocity;
+        this->minDistance = minDistance;
+        this->minHeight = minHeight;
+        distanceStep = (maxDistance - minDistance) / (DISTANCE_POINTS - 1);
+        heightStep = (maxHeight - minHeight) / (HEIGHT_POINTS - 1);
+        solver.setDragModel(dragModel);
+
+        for (int i = 0; i < DISTANCE_POINTS; i++)
+        {
+            // Neighbouring points have close solutions, so each warm starts the next.
+            for (int j = 0; j < HEIGHT_POINTS; j++)
+            {
+                const float distance = minDistance + i * distanceStep;
+                const float height = minHeight + j * heightStep;
+                SecondOrderKinematicState target(
+                    modm::Vector3f(distance, 0, height),
+                    modm::Vector3f(0, 0, 0),
+                    modm::Vector3f(0, 0, 0));
+                BallisticsSolution solution;
+                Entry &entry = entries[i][j];
+                if (solver.solve(target, bulletVelocity, &solution))
+                {
+                    entry.pitchOffset = solution.turretPitch + atan2f(height, distance);
+                    entry.travelTimePerRange = solution.travelTime / hypotf(distance, height);
+                }
+                else
+                {
+                    entry.pitchOffset = NAN;
+                    entry.travelTimePerRange = NAN;
+                }
+            }
+        }
+    }
+
+    /**
+     * Looks up the pitch angle and travel time to hit a stationary target, like the free
+     * function `computeTravelTime` but with the table's bullet velocity and drag model.
+     *
+     * @param[in] targetPosition: The 3D position of a target in m. Frame requirements: RELATIVE
+     * TO PROJECTILE RELEASE POSITION, Z IS OPPOSITE TO GRAVITY.
+     * @param[out] travelTime: The expected travel time of a turret shot to hit the target.
+     * @param[out] turretPitch: The pitch angle of the turret to hit the target, in the same
+     * convention as `computeTravelTime`.
+     * @param[in] pitchAxisOffset: The distance between the pitch and yaw axes (in meters), as in
+     * `computeTravelTime`.
+     * @return Whether or not a valid travel time was found. Always false before `initialize`.
+     */
+    bool computeTravelTime(
+        const modm::Vector3f &targetPosition,
+        float *travelTime,
+        float *turretPitch,
+        float pitchAxisOffset = 0)
+    {
+        if (bulletVelocity <= 0)
+        {
+            return false;
+        }
+
+        const float distance = hypotf(targetPosition.x, targetPosition.y) + pitchAxisOffset;
+        const float u = (distance - minDistance) / distanceStep;
+        const float v = (targetPosition.z - minHeight) / heightStep;
+        if (u >= 0 && u <= DISTANCE_POINTS - 1 && v >= 0 && v <= HEIGHT_POINTS - 1)
+        {
+            const int i = u < DISTANCE_POINTS - 1 ? static_cast<int>(u) : DISTANCE_POINTS - 2;
+            const int j = v < HEIGHT_POINTS - 1 ? static_cast<int>(v) : HEIGHT_POINTS - 2;
+            const float s = u - i;
+            const float t = v - j;
+            const Entry &e00 = entries[i][j];
+            const Entry &e01 = entries[i][j + 1];
+            const Entry &e10 = entries[i + 1][j];
+            const Entry &e11 = entries[i + 1][j + 1];
+
+            // NaN marks a grid point without a solution and propagates through the interpolation.
+            const float pitchOffset =
+                (1 - s) * ((1 - t) * e00.pitchOffset + t * e01.pitchOffset) +
+                s * ((1 - t) * e10.pitchOffset + t * e11.pitchOffset);
+            const float travelTimePerRange =
+                (1 - s) * ((1 - t) * e00.travelTimePerRange + t * e01.travelTimePerRange) +
+                s * ((1 - t) * e10.travelTimePerRange + t * e11.travelTimePerRange);
+            if (!std::isnan(pitchOffset) && !std::isnan(travelTimePerRange))
+            {
+                *turretPitch = pitchOffset - atan2f(targetPosition.z, distance);
+                *travelTime = travelTimePerRange * hypotf(distance, targetPosition.z);
+                return true;
+            }
+        }
+
+        SecondOrderKinematicState target(
+            targetPosition,
+            modm::Vector3f(0, 0, 0),
+            modm::Vector3f(0, 0, 0));
+        BallisticsSolution solution;
+        if (!solver.solve(target, bulletVelocity, &solution, pitchAxisOffset))
+        {
+            return false;
+        }
+        *turretPitch = solution.turretPitch;
+        *travelTime = solution.travelTime;
+        return true;
+    }
+
+    /**
+     * Finds the pitch, yaw, and travel time to hit a moving target, like the free function
+     * `findTargetProjectileIntersection` but looking up each iteration's travel time in the table.
+     *
+     * @see tap::algorithms::ballistics::findTargetProjectileIntersection
+     */
+    bool findTargetProjectileIntersection(
+        const AbstractKinematicState &targetInitialState,
+        uint8_t numIterations,
+        float *turretPitch,
+        float *turretYaw,
+        float *projectedTravelTime,
+        float pitchAxisOffset = 0)
+    {
+        modm::Vector3f projectedTargetPosition = targetInitialState.projectForward(0);
+
+        if (projectedTargetPosition.x == 0 && projectedTargetPosition.y == 0 &&
+            projectedTargetPosition.z == 0)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < numIterations; i++)
+        {
+            if (!computeTravelTime(
+                    projectedTargetPosition,
+                    projectedTravelTime,
+                    turretPitch,
+                    pitchAxisOffset))
+            {
+                return false;
+            }
+            projectedTargetPosition = targetInitialState.projectForward(*projectedTravelTime);
+        }
+
+        *turretYaw = atan2f(projectedTargetPosition.y, projectedTargetPosition.x);
+
+        return !std::isnan(*turretPitch) && !std::isnan(*turretYaw);
+    }
+
+private:
+    /**
+     * The pitch and travel time vary steeply with position close to the turret, so the table
+     * stores them relative to the line of sight to the grid point, which interpolate closely.
+     */
+    struct Entry
+    {
+        /// The turret pitch less the pitch of the line of sight.
+        float pitchOffset;
+        /// The travel time divided by the straight line distance.
+        float travelTimePerRange;
+    };
+
+    Entry entries[DISTANCE_POINTS][HEIGHT_POINTS] = {};
+    float bulletVelocity = 0;
+    float minDistance = 0;
+    float minHeight = 0;
+    float distanceStep = 1;
+    float heightStep = 1;
+
+    /// Used to fill the table and for targets outside it.
+    BallisticsSolver solver;
+};  // class BallisticsTable
+
+}  // namespace tap::algorithms::ballistics
+
+#endif  // TAPROOT_BALLISTICS_TABLE_HPP_
@@ -23,6 +23,7 @@
 #include <array>
 #include <cassert>
 #include <cinttypes>
+#include <cmath>
 #include <iostream>
 
 #include "modm/architecture/utils.hpp"
@@ -206,6 +207,236 @@ inline CMSISMat<ROWS, COLS> operator/(const CMSISMat<ROWS, COLS> &a, float b)
     return c;
 }
 
+/*
+ * In-place and fused operations. The operators above return a new CMSISMat for each intermediate
+ * result, so an expression like `A * P * At + Q` builds several temporaries on the stack. These
+ * write into a destination the caller allocated once instead, and fuse the multiply-add and
+ * transpose patterns common in Kalman filters so the transposes are never built.
+ */
+
+/**
+ * out = a * b
+ *
+ * @note `out` must not be `a` or `b`.
+ */
+template <uint16_t ROWS, uint16_t INNER, uint16_t COLS>
+inline void multiply(
+    const CMSISMat<ROWS, INNER> &a,
+    const CMSISMat<INNER, COLS> &b,
+    CMSISMat<ROWS, COLS> &out)
+{
+    const arm_status status = arm_mat_mult_f32(&a.matrix, &b.matrix, &out.matrix);
+    assert(ARM_MATH_SUCCESS == status);
+    (void)status;
+}
+
+/**
+ * out = c + scale * a * b
+ *
+ * @note `out` may be `c`, but must not be `a` or `b`.
+ */
+template <uint16_t ROWS, uint16_t INNER, uint16_t COLS>
+inline void mulAdd(
+    const CMSISMat<ROWS, INNER> &a,
+    const CMSISMat<INNER, COLS> &b,
+    const CMSISMat<ROWS, COLS> &c,
+    CMSISMat<ROWS, COLS> &out,
+    float scale = 1.0f)
+{
+    for (uint16_t i = 0; i < ROWS; i++)
+    {
+        for (uint16_t j = 0; j < COLS; j++)
+        {
+            float sum = 0.0f;
+            for (uint16_t k = 0; k < INNER; k++)
+            {
+                sum += a.data[i * INNER + k] * b.data[k * COLS + j];
+            }
+            out.data[i * COLS + j] = c.data[i * COLS + j] + scale * sum;
+        }
+    }
+}
+
+/**
+ * out = a * b^T, without computing the transpose of `b`.
+ *
+ * @note `out` must not be `a` or `b`.
+ */
+template <uint16_t ROWS, uint16_t INNER, uint16_t COLS>
+inline void mulTransposed(
+    const CMSISMat<ROWS, INNER> &a,
+    const CMSISMat<COLS, INNER> &b,
+    CMSISMat<ROWS, COLS> &out)
+{
+    for (uint16_t i = 0; i < ROWS; i++)
+    {
+        for (uint16_t j = 0; j < COLS; j++)
+        {
+            float sum = 0.0f;
+            for (uint16_t k = 0; k < INNER; k++)
+            {
+                sum += a.data[i * INNER + k] * b.data[j * INNER + k];
+            }
+            out.data[i * COLS + j] = sum;
+        }
+    }
+}
+
+/**
+ * out = c + scale * a * b^T, without computing the transpose of `b`.
+ *
+ * @note `out` may be `c`, but must not be `a` or `b`.
+ */
+template <uint16_t ROWS, uint16_t INNER, uint16_t COLS>
+inline void mulTransposedAdd(
+    const CMSISMat<ROWS, INNER> &a,
+    const CMSISMat<COLS, INNER> &b,
+    const CMSISMat<ROWS, COLS> &c,
+    CMSISMat<ROWS, COLS> &out,
+    float scale = 1.0f)
+{
+    for (uint16_t i = 0; i < ROWS; i++)
+    {
+        for (uint16_t j = 0; j < COLS; j++)
+        {
+            float sum = 0.0f;
+            for (uint16_t k = 0; k < INNER; k++)
+            {
+                sum += a.data[i * INNER + k] * b.data[j * INNER + k];
+            }
+            out.data[i * COLS + j] = c.data[i * COLS + j] + scale * sum;
+        }
+    }
+}
+
+/**
+ * y = alpha * x + y
+ */
+template <uint16_t ROWS, uint16_t COLS>
+inline void axpy(float alpha, const CMSISMat<ROWS, COLS> &x, CMSISMat<ROWS, COLS> &y)
+{
+    for (size_t i = 0; i < y.data.size(); i++)
+    {
+        y.data[i] += alpha * x.data[i];
+    }
+}
+
+/**
+ * out = a^-1
+ *
+ * @note The inversion is done in place by Gauss-Jordan elimination, so `a` is left undefined.
+ *      `out` must not be `a`.
+ */
+template <uint16_t SIZE>
+inline void inverse(CMSISMat<SIZE, SIZE> &a, CMSISMat<SIZE, SIZE> &out)
+{
+    const arm_status status = arm_mat_inverse_f32(&a.matrix, &out.matrix);
+    assert(ARM_MATH_SUCCESS == status);
+    (void)status;
+}
+
+/**
+ * Sets `a` to (a + a^T) / 2, removing the asymmetry rounding introduces into a matrix that should
+ * be symmetric, such as a covariance.
+ */
+template <uint16_t SIZE>
+inline void symmetrize(CMSISMat<SIZE, SIZE> &a)
+{
+    for (uint16_t i = 0; i < SIZE; i++)
+    {
+        for (uint16_t j = i + 1; j < SIZE; j++)
+        {
+            const float mean = 0.5f * (a.data[i * SIZE + j] + a.data[j * SIZE + i]);
+            a.data[i * SIZE + j] = mean;
+            a.data[j * SIZE + i] = mean;
+        }
+    }
+}
+
+/**
+ * Factors the symmetric positive definite `a` into l * l^T, where `l` is lower triangular. Only
+ * the lower triangle of `a` is read, and the upper triangle of `l` is set to 0.
+ *
+ * Solving a system through the factor with `choleskySolve` takes about a third of the operations
+ * of inverting `a` and doesn't lose the precision an explicit inverse does when `a` is poorly
+ * conditioned.
+ *
+ * @return `false` if `a` isn't positive definite, in which case `l` is undefined.
+ * @note `l` may be `a`.
+ */
+template <uint16_t SIZE>
+inline bool choleskyDecompose(const CMSISMat<SIZE, SIZE> &a, CMSISMat<SIZE, SIZE> &l)
+{
+    for (uint16_t j = 0; j < SIZE; j++)
+    {
+        float diagonal = a.data[j * SIZE + j];
+        for (uint16_t k = 0; k < j; k++)
+        {
+            diagonal -= l.data[j * SIZE + k] * l.data[j * SIZE + k];
+        }
+        // Also rejects NaN
+        if (!(diagonal > 0.0f))
+        {
+            return false;
+        }
+        const float ljj = sqrtf(diagonal);
+        l.data[j * SIZE + j] = ljj;
+
+        for (uint16_t i = j + 1; i < SIZE; i++)
+        {
+            float sum = a.data[i * SIZE + j];
+            for (uint16_t k = 0; k < j; k++)
+            {
+                sum -= l.data[i * SIZE + k] * l.data[j * SIZE + k];
+            }
+            l.data[i * SIZE + j] = sum / ljj;
+            l.data[j * SIZE + i] = 0.0f;
+        }
+    }
+    return true;
+}
+
+/**
+ * out = b * (l * l^T)^-1, where `l` is a factor from `choleskyDecompose`. Each row of `b` is
+ * solved by forward and back substitution, without forming the inverse.
+ *
+ * @note `out` may be `b`.
+ */
+template <uint16_t ROWS, uint16_t SIZE>
+inline void choleskySolve(
+    const CMSISMat<SIZE, SIZE> &l,
+    const CMSISMat<ROWS, SIZE> &b,
+    CMSISMat<ROWS, SIZE> &out)
+{
+    for (uint16_t row = 0; row < ROWS; row++)
+    {
+        const float *bRow = &b.data[row * SIZE];
+        float *x = &out.data[row * SIZE];
+
+        // l * z = b^T
+        for (uint16_t i = 0; i < SIZE; i++)
+        {
+            float sum = bRow[i];
+            for (uint16_t k = 0; k < i; k++)
+            {
+                sum -= l.data[i * SIZE + k] * x[k];
+            }
+            x[i] = sum / l.data[i * SIZE + i];
+        }
+
+        // l^T * x = z
+        for (int i = SIZE - 1; i >= 0; i--)
+        {
+            float sum = x[i];
+            for (uint16_t k = i + 1; k < SIZE; k++)
+            {
+                sum -= l.data[k * SIZE + i] * x[k];
+            }
+            x[i] = sum / l.data[i * SIZE + i];
+        }
+    }
+}
+
 }  // namespace tap::algorithms
 
 #endif  // TAPROOT_CMSIS_MAT_HPP_
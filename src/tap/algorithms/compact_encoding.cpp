@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "compact_encoding.hpp"
+
+#include <cstring>
+
+namespace tap
+{
+namespace algorithms
+{
+uint32_t encodeVarint(uint32_t value, uint8_t *out, uint32_t capacity)
+{
+    uint32_t length = 0;
+    while (value >= 0x80)
+    {
+        if (length == capacity)
+        {
+            return 0;
+        }
+        out[length++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    if (length == capacity)
+    {
+        return 0;
+    }
+    out[length++] = static_cast<uint8_t>(value);
+    return length;
+}
+
+uint32_t decodeVarint(const uint8_t *in, uint32_t length, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < length && i < MAX_VARINT_LENGTH; i++)
+    {
+        const uint8_t byte = in[i];
+        // The fifth byte holds the top 4 bits
+        if (i == MAX_VARINT_LENGTH - 1 && byte > 0x0f)
+        {
+            return 0;
+        }
+        result |= static_cast<uint32_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t encodeDeltas(
+    const int32_t *values,
+    const int32_t *previous,
+    uint32_t count,
+    uint8_t *out,
+    uint32_t capacity)
+{
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // Subtract as unsigned so the difference wraps rather than overflows
+        const int32_t delta =
+            static_cast<int32_t>(static_cast<uint32_t>(values[i]) - previous[i]);
+        const uint32_t written = encodeVarint(encodeZigZag(delta), out + length, capacity - length);
+        if (written == 0)
+        {
+            return 0;
+        }
+        length += written;
+    }
+    return length;
+}
+
+uint32_t decodeDeltas(
+    const uint8_t *in,
+    uint32_t length,
+    const int32_t *previous,
+    int32_t *values,
+    uint32_t count)
+{
+    uint32_t position = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t zigZag;
+        const uint32_t read = decodeVarint(in + position, length - position, &zigZag);
+        if (read == 0)
+        {
+            return 0;
+        }
+        position += read;
+        values[i] = static_cast<int32_t>(previous[i] + static_cast<uint32_t>(decodeZigZag(zigZag)));
+    }
+    return position;
+}
+
+bool BitWriter::write(uint32_t value, int bits)
+{
+    if (bits < 0 || bits > 32 || getBitsWritten() + bits > 8 * capacity)
+    {
+        return false;
+    }
+    const uint64_t mask = (1ull << bits) - 1;
+    pending |= (value & mask) << pendingBits;
+    pendingBits += bits;
+    while (pendingBits >= 8)
+    {
+        buffer[length++] = static_cast<uint8_t>(pending);
+        pending >>= 8;
+        pendingBits -= 8;
+    }
+    return true;
+}
+
+uint32_t BitWriter::finish()
+{
+    if (pendingBits > 0)
+    {
+        buffer[length++] = static_cast<uint8_t>(pending);
+        pending = 0;
+        pendingBits = 0;
+    }
+    return length;
+}
+
+bool BitReader::read(int bits, uint32_t *value)
+{
+    if (bits < 0 || bits > 32 || static_cast<uint32_t>(bits) > getBitsRemaining())
+    {
+        return false;
+    }
+    while (availableBits < bits)
+    {
+        available |= static_cast<uint64_t>(buffer[position++]) << availableBits;
+        availableBits += 8;
+    }
+    *value = static_cast<uint32_t>(available & ((1ull << bits) - 1));
+    available >>= bits;
+    availableBits -= bits;
+    return true;
+}
+
+// LZ4 block format constants, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static constexpr uint32_t LZ4_MIN_MATCH = 4;
+/// The last match must start at least this many bytes before the end of the block.
+static constexpr uint32_t LZ4_MATCH_START_LIMIT = 12;
+/// The last bytes of a block are always literals.
+static constexpr uint32_t LZ4_LAST_LITERALS = 5;
+static constexpr uint32_t LZ4_MAX_OFFSET = UINT16_MAX;
+/// Literal and match lengths of at least this are continued in extra bytes.
+static constexpr uint32_t LZ4_RUN_MASK = 15;
+
+static inline uint32_t read32(const uint8_t *data)
+{
+    // Compiles to a single unaligned load on the Cortex-M4
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hashLz4(uint32_t sequence)
+{
+    // Fibonacci hashing, the multiplier is 2^32 divided by the golden ratio
+    return (sequence * 2654435761u) >> (32 - Lz4BlockCompressor::HASH_BITS);
+}
+
+/**
+ * Writes the remainder of a literal or match length of at least `LZ4_RUN_MASK`.
+ *
+ * @return `false` if it doesn't fit.
+ */
+static bool writeLz4Length(uint32_t length, uint8_t *out, uint32_t capacity, uint32_t *position)
+{
+    length -= LZ4_RUN_MASK;
+    const uint32_t extraBytes = length / 255 + 1;
+    if (capacity - *position < extraBytes)
+    {
+        return false;
+    }
+    for (; length >= 255; length -= 255)
+    {
+        out[(*position)++] = 255;
+    }
+    out[(*position)++] = static_cast<uint8_t>(length);
+    return true;
+}
+
+/**
+ * Writes a sequence of literals followed by a match, or only literals if `matchLength` is 0.
+ *
+ * @return `false` if it doesn't fit.
+ */
+static bool writeLz4Sequence(
+    const uint8_t *literals,
+    uint32_t literalLength,
+    uint32_t offset,
+    uint32_t matchLength,
+    uint8_t *out,
+    uint32_t capacity,
+    uint32_t *position)
+{
+    if (*position == capacity)
+    {
+        return false;
+    }
+    const uint32_t matchCode = matchLength == 0 ? 0 : matchLength - LZ4_MIN_MATCH;
+    uint8_t &token = out[(*position)++];
+    token = (literalLength < LZ4_RUN_MASK ? literalLength : LZ4_RUN_MASK) << 4 |
+            (matchCode < LZ4_RUN_MASK ? matchCode : LZ4_RUN_MASK);
+
+    if (literalLength >= LZ4_RUN_MASK && !writeLz4Length(literalLength, out, capacity, position))
+    {
+        return false;
+    }
+    if (capacity - *position < literalLength)
+    {
+        return false;
+    }
+    memcpy(out + *position, literals, literalLength);
+    *position += literalLength;
+
+    if (matchLength == 0)
+    {
+        return true;
+    }
+    if (capacity - *position < 2)
+    {
+        return false;
+    }
+    out[(*position)++] = static_cast<uint8_t>(offset);
+    out[(*position)++] = static_cast<uint8_t>(offset >> 8);
+    return matchCode < LZ4_RUN_MASK || writeLz4Length(matchCode, out, capacity, position);
+}
+
+uint32_t Lz4BlockCompressor::compress(
+    const uint8_t *in,
+    uint32_t length,
+    uint8_t *out,
+    uint32_t capacity)
+{
+    if (length > MAX_BLOCK_LENGTH)
+    {
+        return 0;
+    }
+
+    uint32_t outPosition = 0;
+    uint32_t anchor = 0;
+    if (length > LZ4_MATCH_START_LIMIT)
+    {
+        memset(hashTable, 0, sizeof(hashTable));
+        const uint32_t matchStartLimit = length - LZ4_MATCH_START_LIMIT;
+        const uint32_t matchEndLimit = length - LZ4_LAST_LITERALS;
+
+        uint32_t position = 0;
+        // Like LZ4, step further the longer no match is found, so incompressible data is fast
+        uint32_t misses = 0;
+        while (position <= matchStartLimit)
+        {
+            const uint32_t sequence = read32(in + position);
+            uint16_t &entry = hashTable[hashLz4(sequence)];
+            const uint32_t candidate = entry;
+            entry = position + 1;
+
+            if (candidate == 0 || position - (candidate - 1) > LZ4_MAX_OFFSET ||
+                read32(in + candidate - 1) != sequence)
+            {
+                position += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            uint32_t match = candidate - 1;
+            uint32_t matchLength = LZ4_MIN_MATCH;
+            while (position + matchLength < matchEndLimit &&
+                   in[match + matchLength] == in[position + matchLength])
+            {
+                matchLength++;
+            }
+            // Extend the match back over literals that also match
+            while (position > anchor && match > 0 && in[position - 1] == in[match - 1])
+            {
+                position--;
+                match--;
+                matchLength++;
+            }
+
+            if (!writeLz4Sequence(
+                    in + anchor,
+                    position - anchor,
+                    position - match,
+                    matchLength,
+                    out,
+                    capacity,
+                    &outPosition))
+            {
+                return 0;
+            }
+            position += matchLength;
+            anchor = position;
+        }
+    }
+
+    if (!writeLz4Sequence(in + anchor, length - anchor, 0, 0, out, capacity, &outPosition))
+    {
+        return 0;
+    }
+    return outPosition;
+}
+
+/**
+ * Reads the remainder of a literal or match length of at least `LZ4_RUN_MASK`.
+ *
+ * @return `false` if the input ends first.
+ */
+static bool readLz4Length(const uint8_t *in, uint32_t length, uint32_t *position, uint32_t *value)
+{
+    uint8_t byte;
+    do
+    {
+        if (*position == length)
+        {
+            return false;
+        }
+        byte = in[(*position)++];
+        *value += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool decompressLz4Block(
+    const uint8_t *in,
+    uint32_t length,
+    uint8_t *out,
+    uint32_t capacity,
+    uint32_t *decompressedLength)
+{
+    uint32_t inPosition = 0;
+    uint32_t outPosition = 0;
+    while (inPosition < length)
+    {
+        const uint8_t token = in[inPosition++];
+
+        uint32_t literalLength = token >> 4;
+        if (literalLength == LZ4_RUN_MASK &&
+            !readLz4Length(in, length, &inPosition, &literalLength))
+        {
+            return false;
+        }
+        if (length - inPosition < literalLength || capacity - outPosition < literalLength)
+        {
+            return false;
+        }
+        memcpy(out + outPosition, in + inPosition, literalLength);
+        inPosition += literalLength;
+        outPosition += literalLength;
+
+        // The last sequence has only literals
+        if (inPosition == length)
+        {
+            break;
+        }
+
+        if (length - inPosition < 2)
+        {
+            return false;
+        }
+        const uint32_t offset = in[inPosition] | in[inPosition + 1] << 8;
+        inPosition += 2;
+        if (offset == 0 || offset > outPosition)
+        {
+            return false;
+        }
+
+        uint32_t matchLength = token & LZ4_RUN_MASK;
+        if (matchLength == LZ4_RUN_MASK && !readLz4Length(in, length, &inPosition, &matchLength))
+        {
+            return false;
+        }
+        matchLength += LZ4_MIN_MATCH;
+        if (capacity - outPosition < matchLength)
+        {
+            return false;
+        }
+        // The match may overlap the bytes it produces, so it is copied a byte at a time
+        const uint8_t *match = out + outPosition - offset;
+        for (uint32_t i = 0; i < matchLength; i++)
+        {
+            out[outPosition + i] = match[i];
+        }
+        outPosition += matchLength;
+    }
+
+    *decompressedLength = outPosition;
+    return true;
+}
+}  // namespace algorithms
+
+}  // namespace tap
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_COMPACT_ENCODING_HPP_
+#define TAPROOT_COMPACT_ENCODING_HPP_
+
+#include <cstdint>
+
+/*
+ * Compact encodings for streams sent over links with little bandwidth, such as binary telemetry,
+ * capture logs, and ref serial robot to robot messages, where raw fields copied with
+ * `tap::arch::convertToLittleEndian` waste most of their bytes on values that barely change.
+ *
+ * - Zig-zag varints store small magnitudes of either sign in few bytes.
+ * - Delta encoding stores each field as a varint of its change from the previous record.
+ * - `BitWriter` and `BitReader` pack fields into exactly as many bits as their range needs.
+ * - `Lz4BlockCompressor` and `decompressLz4Block` compress whole blocks, such as a page of log
+ *   records, in the LZ4 block format, so blocks can be decompressed on a computer by any LZ4
+ *   library (e.g. `lz4.block.decompress` in Python).
+ *
+ * Nothing allocates, and every encoder and decoder is bounds checked against its buffer, so
+ * malformed input is rejected rather than read or written past the end of a buffer.
+ */
+
+namespace tap
+{
+namespace algorithms
+{
+/// Maximum number of bytes `encodeVarint` writes.
+static constexpr uint32_t MAX_VARINT_LENGTH = 5;
+
+/**
+ * Maps signed values to unsigned values so that values of small magnitude map to small values:
+ * 0, -1, 1, -2, 2, ... map to 0, 1, 2, 3, 4, ...
+ */
+constexpr uint32_t encodeZigZag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+/// Inverse of `encodeZigZag`.
+constexpr int32_t decodeZigZag(uint32_t value)
+{
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/**
+ * Writes a value as a little endian base 128 varint, 7 bits per byte with the top bit of each
+ * byte set if another byte follows, so values under 128 take one byte.
+ *
+ * @param[out] out buffer the varint is written to, with room for at least `capacity` bytes.
+ * @return the number of bytes written, or 0 if the varint doesn't fit in `capacity` bytes.
+ */
+uint32_t encodeVarint(uint32_t value, uint8_t *out, uint32_t capacity);
+
+/**
+ * Reads a varint written by `encodeVarint`.
+ *
+ * @param[out] value the value read.
+ * @return the number of bytes read, or 0 if the varint is truncated or doesn't fit in 32 bits.
+ */
+uint32_t decodeVarint(const uint8_t *in, uint32_t length, uint32_t *value);
+
+/**
+ * Writes each of `count` values as the zig-zag varint of its difference from the corresponding
+ * value in `previous`, so a record whose fields changed little since the previous record takes
+ * about a byte per field. Differences wrap around, so any values round trip.
+ *
+ * @return the number of bytes written, or 0 if they don't fit in `capacity` bytes.
+ */
+uint32_t encodeDeltas(
+    const int32_t *values,
+    const int32_t *previous,
+    uint32_t count,
+    uint8_t *out,
+    uint32_t capacity);
+
+/**
+ * Reads `count` values written by `encodeDeltas` with the same `previous` values.
+ *
+ * @return the number of bytes read, or 0 if the input is malformed or truncated.
+ */
+uint32_t decodeDeltas(
+    const uint8_t *in,
+    uint32_t length,
+    const int32_t *previous,
+    int32_t *values,
+    uint32_t count);
+
+/**
+ * Packs values of arbitrary bit widths into a buffer, least significant bit first.
+ */
+class BitWriter
+{
+public:
+    BitWriter(uint8_t *buffer, uint32_t capacity) : buffer(buffer), capacity(capacity) {}
+
+    /**
+     * Appends the low `bits` bits of `value`.
+     *
+     * @param[in] bits number of bits to write, at most 32.
+     * @return `false`, writing nothing, if the bits don't fit in the buffer.
+     */
+    bool write(uint32_t value, int bits);
+
+    /**
+     * Writes any bits of a partially filled byte, padded with zeros. Call once all values are
+     * written.
+     *
+     * @return the number of bytes written to the buffer.
+     */
+    uint32_t finish();
+
+    uint32_t getBitsWritten() const { return 8 * length + pendingBits; }
+
+private:
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t length = 0;
+    /// Bits written that don't fill a byte yet, least significant first.
+    uint64_t pending = 0;
+    int pendingBits = 0;
+};
+
+/**
+ * Reads values packed by `BitWriter`.
+ */
+class BitReader
+{
+public:
+    BitReader(const uint8_t *buffer, uint32_t length) : buffer(buffer), length(length) {}
+
+    /**
+     * Reads the next `bits` bits.
+     *
+     * @param[in] bits number of bits to read, at most 32.
+     * @param[out] value the bits read, in the low `bits` bits.
+     * @return `false`, reading nothing, if fewer than `bits` bits remain.
+     */
+    bool read(int bits, uint32_t *value);
+
+    uint32_t getBitsRemaining() const { return 8 * (length - position) + availableBits; }
+
+private:
+    const uint8_t *buffer;
+    uint32_t length;
+    uint32_t position = 0;
+    /// Bits read from the buffer that haven't been returned yet, least significant first.
+    uint64_t available = 0;
+    int availableBits = 0;
+};
+
+/**
+ * Compresses blocks in the LZ4 block format with a greedy single pass match finder, which on a
+ * Cortex-M4 compresses several MB/s. Compression is fastest on data that repeats exactly, like
+ * log records whose fields are mostly unchanged; for slowly varying values, delta encode the
+ * records first.
+ *
+ * The match finder's hash table is a member, so a compressor is `HASH_TABLE_SIZE * 2` bytes and
+ * is best kept as a static or member rather than on the stack.
+ */
+class Lz4BlockCompressor
+{
+public:
+    /// Largest block that can be compressed, so positions fit in the 16 bit hash table.
+    static constexpr uint32_t MAX_BLOCK_LENGTH = UINT16_MAX;
+
+    static constexpr int HASH_BITS = 10;
+    static constexpr uint32_t HASH_TABLE_SIZE = 1ul << HASH_BITS;
+
+    /// @return The most bytes compressing `length` bytes can produce, for sizing buffers.
+    static constexpr uint32_t getMaxCompressedLength(uint32_t length)
+    {
+        return length + length / 255 + 16;
+    }
+
+    /**
+     * Compresses a block. Blocks are compressed independently, with no references to earlier
+     * blocks.
+     *
+     * @param[out] out buffer the compressed block is written to.
+     * @param[in] capacity size of `out`. A capacity of `getMaxCompressedLength(length)` always
+     *      fits the compressed block.
+     * @return the length of the compressed block, or 0 if `length` is more than
+     *      `MAX_BLOCK_LENGTH` or the compressed block doesn't fit in `capacity` bytes.
+     */
+    uint32_t compress(const uint8_t *in, uint32_t length, uint8_t *out, uint32_t capacity);
+
+private:
+    /// Position + 1 of the most recent 4 bytes with each hash, 0 if none.
+    uint16_t hashTable[HASH_TABLE_SIZE];
+};
+
+/**
+ * Decompresses a block in the LZ4 block format, such as one compressed by `Lz4BlockCompressor`.
+ *
+ * @param[out] out buffer the block is decompressed into.
+ * @param[out] decompressedLength the length of the decompressed block.
+ * @return `false` if the block is malformed or doesn't fit in `capacity` bytes.
+ */
+bool decompressLz4Block(
+    const uint8_t *in,
+    uint32_t length,
+    uint8_t *out,
+    uint32_t capacity,
+    uint32_t *decompressedLength);
+}  // namespace algorithms
+
+}  // namespace tap
+
+#endif  // TAPROOT_COMPACT_ENCODING_HPP_
@@ -19,6 +19,8 @@
 
 #include "crc.hpp"
 
+#include "tap/architecture/memory_placement.hpp"
+
 namespace tap
 {
 namespace algorithms
@@ -42,7 +44,7 @@ const uint8_t CRC8Table[256] = {
     0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7, 0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35,
 };
 
-const uint16_t CRC16Table[256] = {
+constexpr uint16_t CRC16Table[256] = {
     0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf, 0x8c48, 0x9dc1, 0xaf5a, 0xbed3,
     0xca6c, 0xdbe5, 0xe97e, 0xf8f7, 0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
     0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876, 0x2102, 0x308b, 0x0210, 0x1399,
@@ -66,7 +68,7 @@ const uint16_t CRC16Table[256] = {
     0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330, 0x7bc7, 0x6a4e, 0x58d5, 0x495c,
     0x3de3, 0x2c6a, 0x1ef1, 0x0f78};
 
-uint8_t calculateCRC8(const uint8_t *message, uint32_t messageLength, uint8_t initCRC8)
+TAP_RAM_CODE uint8_t calculateCRC8(const uint8_t *message, uint32_t messageLength, uint8_t initCRC8)
 {
     if (message == nullptr)
     {
@@ -80,7 +82,40 @@ uint8_t calculateCRC8(const uint8_t *message, uint32_t messageLength, uint8_t in
     return initCRC8;
 }
 
-uint16_t calculateCRC16(const uint8_t *message, uint32_t messageLength, uint16_t initCRC16)
+/**
+ * Lookup tables for slice-by-N CRC16. `table[0]` is `CRC16Table`, and `table[k][i]` is the CRC16
+ * register after byte `i` is followed by `k` zero bytes, so that N bytes can be folded into the
+ * register with one lookup each.
+ */
+template <int SLICES>
+struct CRC16SliceTables
+{
+    uint16_t table[SLICES][256];
+};
+
+template <int SLICES>
+static constexpr CRC16SliceTables<SLICES> makeCRC16SliceTables()
+{
+    CRC16SliceTables<SLICES> tables{};
+    for (int i = 0; i < 256; i++)
+    {
+        tables.table[0][i] = CRC16Table[i];
+    }
+    for (int k = 1; k < SLICES; k++)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            const uint16_t prev = tables.table[k - 1][i];
+            tables.table[k][i] = (prev >> 8) ^ CRC16Table[prev & 0x00ff];
+        }
+    }
+    return tables;
+}
+
+template <int SLICES>
+static constexpr CRC16SliceTables<SLICES> CRC16_SLICE_TABLES = makeCRC16SliceTables<SLICES>();
+
+TAP_RAM_CODE uint16_t calculateCRC16Bytewise(const uint8_t *message, uint32_t messageLength, uint16_t initCRC16)
 {
     if (message == nullptr)
     {
@@ -95,6 +130,52 @@ uint16_t calculateCRC16(const uint8_t *message, uint32_t messageLength, uint16_t
     return initCRC16;
 }
 
+template <int SLICES>
+TAP_RAM_CODE uint16_t calculateCRC16Sliced(const uint8_t *message, uint32_t messageLength, uint16_t initCRC16)
+{
+    static_assert(SLICES >= 2, "the CRC16 register must fit within a slice");
+
+    if (message == nullptr)
+    {
+        return initCRC16;
+    }
+
+    const auto &tables = CRC16_SLICE_TABLES<SLICES>.table;
+
+    while (messageLength >= SLICES)
+    {
+        // the register overlaps the first two bytes of the slice, and each byte is followed by
+        // the rest of the slice, so byte i is looked up in table SLICES - 1 - i
+        uint16_t crc = tables[SLICES - 1][(message[0] ^ initCRC16) & 0x00ff] ^
+                       tables[SLICES - 2][(message[1] ^ (initCRC16 >> 8)) & 0x00ff];
+        for (int i = 2; i < SLICES; i++)
+        {
+            crc ^= tables[SLICES - 1 - i][message[i]];
+        }
+
+        initCRC16 = crc;
+        message += SLICES;
+        messageLength -= SLICES;
+    }
+
+    return calculateCRC16Bytewise(message, messageLength, initCRC16);
+}
+
+template uint16_t calculateCRC16Sliced<4>(const uint8_t *, uint32_t, uint16_t);
+template uint16_t calculateCRC16Sliced<8>(const uint8_t *, uint32_t, uint16_t);
+
+TAP_RAM_CODE uint16_t calculateCRC16(const uint8_t *message, uint32_t messageLength, uint16_t initCRC16)
+{
+    if constexpr (CRC16_SLICES > 1)
+    {
+        return calculateCRC16Sliced<CRC16_SLICES>(message, messageLength, initCRC16);
+    }
+    else
+    {
+        return calculateCRC16Bytewise(message, messageLength, initCRC16);
+    }
+}
+
 }  // namespace algorithms
 
 }  // namespace tap
@@ -22,6 +22,8 @@
 
 #include <cstdint>
 
+#include "crc_constants.hpp"
+
 namespace tap
 {
 namespace algorithms
@@ -41,7 +43,8 @@ namespace algorithms
 uint8_t calculateCRC8(const uint8_t *message, uint32_t messageLength, uint8_t initCRC8 = CRC8_INIT);
 
 /**
- * Fast crc16 calculation using a lookup table.
+ * Fast crc16 calculation. Uses `calculateCRC16Sliced<CRC16_SLICES>`, or
+ * `calculateCRC16Bytewise` if `CRC16_SLICES` is 1.
  *
  * @see calculateCRC8
  *
@@ -55,6 +58,29 @@ uint16_t calculateCRC16(
     uint32_t messageLength,
     uint16_t initCRC16 = CRC16_INIT);
 
+/**
+ * Reference crc16 calculation using a lookup table, one byte at a time.
+ *
+ * @see calculateCRC16
+ */
+uint16_t calculateCRC16Bytewise(
+    const uint8_t *message,
+    uint32_t messageLength,
+    uint16_t initCRC16 = CRC16_INIT);
+
+/**
+ * crc16 calculation that processes `SLICES` bytes at a time using `SLICES` lookup tables
+ * (512 bytes each), with the same result as `calculateCRC16Bytewise`. Instantiated for `SLICES`
+ * of 4 and 8.
+ *
+ * @see calculateCRC16
+ */
+template <int SLICES>
+uint16_t calculateCRC16Sliced(
+    const uint8_t *message,
+    uint32_t messageLength,
+    uint16_t initCRC16 = CRC16_INIT);
+
 }  // namespace algorithms
 
 }  // namespace tap
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_EXTENDED_KALMAN_BANK_HPP_
+#define TAPROOT_EXTENDED_KALMAN_BANK_HPP_
+
+namespace tap::algorithms
+{
+/**
+ * `N` independent scalar kalman filters, each equivalent to an `ExtendedKalman`, updated together
+ * in one call. Useful for filtering many signals each control loop, such as every wheel speed.
+ *
+ * The state of all channels is stored as one array per variable rather than one object per
+ * channel, and only the estimate and covariance are kept between updates, so an update is a
+ * single pass over contiguous arrays that the compiler can keep in registers and pipeline,
+ * rather than `N` calls each reloading an object's twelve fields.
+ *
+ * Example source:
+ *
+ * \code
+ * float wheelSpeeds[4];
+ * ExtendedKalmanBank<4> kalman(1.0f, 0.0f);
+ *
+ * while(1)
+ * {
+ *     kalman.filterData(wheelSpeeds);
+ *     float filtered = kalman.getLastFiltered(0);
+ * }
+ * \endcode
+ *
+ * @tparam N The number of channels.
+ */
+template <int N>
+class ExtendedKalmanBank
+{
+public:
+    static_assert(N > 0, "ExtendedKalmanBank must have at least one channel");
+
+    /**
+     * Initializes every channel with the given covariances.
+     *
+     * @param[in] tQ the system noise covariance.
+     * @param[in] tR the measurement noise covariance.
+     * @see ExtendedKalman::ExtendedKalman
+     */
+    ExtendedKalmanBank(float tQ, float tR)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            Q[i] = tQ;
+            R[i] = tR;
+        }
+        reset();
+    }
+
+    /// Sets the covariances of one channel. Does nothing if `channel` is out of range.
+    void setCovariances(int channel, float tQ, float tR)
+    {
+        if (channel < 0 || channel >= N)
+        {
+            return;
+        }
+        Q[channel] = tQ;
+        R[channel] = tR;
+    }
+
+    /**
+     * Runs every channel's filter on its next data point, identical to calling
+     * `ExtendedKalman::filterData` on each channel.
+     *
+     * @param[in] data the value to be filtered of each channel.
+     */
+    void filterData(const float (&data)[N])
+    {
+        for (int i = 0; i < N; i++)
+        {
+            const float pMid = p[i] + Q[i];
+            const float kg = pMid / (pMid + R[i]);
+            x[i] += kg * (data[i] - x[i]);
+            p[i] = (1 - kg) * pMid;
+        }
+    }
+
+    /// Returns the last filtered data point of `channel`.
+    float getLastFiltered(int channel) const { return x[channel]; }
+
+    /// Returns the last filtered data point of every channel.
+    const float (&getLastFiltered() const)[N] { return x; }
+
+    /// Resets the covariances and predictions of every channel.
+    void reset()
+    {
+        for (int i = 0; i < N; i++)
+        {
+            x[i] = 0.0f;
+            p[i] = 0.0f;
+        }
+    }
+
+private:
+    float x[N];  ///< current optimal prediction.
+    float p[N];  ///< current covariance.
+    float Q[N];  ///< system noise covariance.
+    float R[N];  ///< measurement noise covariance.
+};  // class ExtendedKalmanBank
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_EXTENDED_KALMAN_BANK_HPP_
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_FAST_MATH_HPP_
+#define TAPROOT_FAST_MATH_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Approximations of the libm trig functions for control loops, where `sinf`, `cosf`, `atan2f` and
+ * `asinf` are slow on the Cortex-M4F because they handle every input to within an ulp and set
+ * `errno`. Each function documents its max absolute error, measured against libm by
+ * `fast_math_tests.cpp`, so call sites can choose between these and libm by the accuracy they
+ * need. Nothing in taproot uses them implicitly.
+ *
+ * - `sin`, `cos` and `sincos` reduce the angle to [-pi/4, pi/4] and evaluate the polynomials of
+ *   Cephes' `sinf` and `cosf`. `sincos` shares the reduction between both.
+ * - `sinTable` and `cosTable` linearly interpolate a table of one period, which is cheaper still
+ *   but less accurate.
+ * - `atan2` evaluates Abramowitz and Stegun 4.4.47 on the ratio of the smaller to the larger
+ *   argument, and `asin` evaluates Abramowitz and Stegun 4.4.46.
+ *
+ * None of the functions check for NaN or infinite arguments.
+ */
+namespace tap::algorithms::fastmath
+{
+static constexpr float PI = 3.14159265358979f;
+static constexpr float HALF_PI = PI / 2;
+static constexpr float TWO_PI = 2 * PI;
+
+namespace detail
+{
+/// pi / 2 split in three, so that the angle reduction `x - j * pi / 2` is exact for small `j`.
+static constexpr float HALF_PI_1 = 1.5703125f;
+static constexpr float HALF_PI_2 = 4.837512969970703125e-4f;
+static constexpr float HALF_PI_3 = 7.54978995489188216e-8f;
+
+/// @return `x` rounded to the nearest integer, without calling `roundf`.
+constexpr int32_t roundToInt(float x)
+{
+    return static_cast<int32_t>(x >= 0 ? x + 0.5f : x - 0.5f);
+}
+
+/// Cephes' `sinf` polynomial, for `r` in [-pi/4, pi/4].
+constexpr float sinPoly(float r)
+{
+    const float r2 = r * r;
+    return r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+}
+
+/// Cephes' `cosf` polynomial, for `r` in [-pi/4, pi/4].
+constexpr float cosPoly(float r)
+{
+    const float r2 = r * r;
+    return 1.0f - 0.5f * r2 +
+           r2 * r2 *
+               (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+}
+}  // namespace detail
+
+struct SinCos
+{
+    float sin;
+    float cos;
+};
+
+/**
+ * Computes the sine and cosine of an angle with a single angle reduction.
+ *
+ * Max absolute error: 1e-7 for |x| <= 1e4. The reduction loses precision for larger angles, so
+ * wrap angles that grow without bound (i.e. integrated yaw) first.
+ *
+ * @param[in] x The angle, in radians.
+ */
+constexpr SinCos sincos(float x)
+{
+    const int32_t j = detail::roundToInt(x * (2 / PI));
+    const float r = ((x - j * detail::HALF_PI_1) - j * detail::HALF_PI_2) - j * detail::HALF_PI_3;
+    const float s = detail::sinPoly(r);
+    const float c = detail::cosPoly(r);
+    switch (j & 3)
+    {
+        case 0:
+            return {s, c};
+        case 1:
+            return {c, -s};
+        case 2:
+            return {-s, -c};
+        default:
+            return {-c, s};
+    }
+}
+
+/// Sine of `x`, in radians. Has the error of `sincos`.
+constexpr float sin(float x) { return sincos(x).sin; }
+
+/// Cosine of `x`, in radians. Has the error of `sincos`.
+constexpr float cos(float x) { return sincos(x).cos; }
+
+/// Number of intervals the sine table divides a period into. Must be a power of two.
+static constexpr int SIN_TABLE_SIZE = 256;
+
+namespace detail
+{
+constexpr std::array<float, SIN_TABLE_SIZE + 1> makeSinTable()
+{
+    std::array<float, SIN_TABLE_SIZE + 1> table = {};
+    for (int i = 0; i <= SIN_TABLE_SIZE; i++)
+    {
+        table[i] = fastmath::sin(i * (TWO_PI / SIN_TABLE_SIZE));
+    }
+    return table;
+}
+
+/// One period of sine, with the first entry repeated at the end so interpolation needn't wrap.
+inline constexpr std::array<float, SIN_TABLE_SIZE + 1> SIN_TABLE = makeSinTable();
+
+/// Interpolates `SIN_TABLE` at `x`, in table intervals.
+inline float interpolateSinTable(float x)
+{
+    // Floor without calling floorf, which the M4F has no instruction for
+    int32_t whole = static_cast<int32_t>(x);
+    whole -= whole > x;
+    const float t = x - whole;
+    // The table size is a power of two, so masking wraps negative intervals too
+    const int32_t i = whole & (SIN_TABLE_SIZE - 1);
+    return SIN_TABLE[i] + t * (SIN_TABLE[i + 1] - SIN_TABLE[i]);
+}
+}  // namespace detail
+
+/**
+ * Sine of `x`, in radians, by linear interpolation of a table of `SIN_TABLE_SIZE` entries.
+ *
+ * Max absolute error: 8e-5 for |x| <= 100. Scaling `x` to table intervals loses precision for
+ * larger angles, so wrap angles that grow without bound first.
+ */
+inline float sinTable(float x)
+{
+    return detail::interpolateSinTable(x * (SIN_TABLE_SIZE / TWO_PI));
+}
+
+/// Cosine of `x`, in radians, see `sinTable`.
+inline float cosTable(float x)
+{
+    return detail::interpolateSinTable(x * (SIN_TABLE_SIZE / TWO_PI) + SIN_TABLE_SIZE / 4);
+}
+
+/**
+ * The angle of the vector (x, y) from the x axis, in radians in [-pi, pi], like `atan2f`.
+ * Returns 0 if both arguments are 0.
+ *
+ * Max absolute error: 1.2e-5 rad.
+ */
+inline float atan2(float y, float x)
+{
+    const float absX = fabsf(x);
+    const float absY = fabsf(y);
+    const float maxXY = absX > absY ? absX : absY;
+    if (maxXY == 0)
+    {
+        return 0;
+    }
+    // atan on [0, 1], then mirrored into the octant of (x, y)
+    const float z = (absX > absY ? absY : absX) / maxXY;
+    const float z2 = z * z;
+    float angle =
+        z * (0.9998660f +
+             z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+    if (absY > absX)
+    {
+        angle = HALF_PI - angle;
+    }
+    if (x < 0)
+    {
+        angle = PI - angle;
+    }
+    return y < 0 ? -angle : angle;
+}
+
+/**
+ * Arcsine of `x`, in radians. `x` is clamped to [-1, 1].
+ *
+ * Max absolute error: 4e-7 rad.
+ */
+inline float asin(float x)
+{
+    float a = fabsf(x);
+    a = a < 1 ? a : 1;
+    const float poly =
+        1.5707963050f +
+        a * (-0.2145988016f +
+             a * (0.0889789874f +
+                  a * (-0.0501743046f +
+                       a * (0.0308918810f +
+                            a * (-0.0170881256f + a * (0.0066700901f + a * -0.0012624911f))))));
+    const float angle = HALF_PI - sqrtf(1 - a) * poly;
+    return x < 0 ? -angle : angle;
+}
+}  // namespace tap::algorithms::fastmath
+
+#endif  // TAPROOT_FAST_MATH_HPP_
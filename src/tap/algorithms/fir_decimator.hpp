@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_FIR_DECIMATOR_HPP_
+#define TAPROOT_FIR_DECIMATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tap
+{
+namespace algorithms
+{
+/**
+ * Low pass filters and downsamples several channels of samples that arrive at a high, fixed rate,
+ * such as a burst of IMU samples read from a sensor's hardware FIFO. Every `decimationFactor`
+ * input samples, one output sample is computed by convolving the most recent input samples of
+ * each channel with the filter's taps.
+ *
+ * By default the taps are those of a cascaded integrator-comb (CIC) filter, see `configureCic`.
+ * A first order CIC filter averages every block of `decimationFactor` samples, so integrating
+ * its output over time gives exactly the integral of the input, and no sample is skipped. Higher
+ * orders attenuate frequencies that would alias into the output more strongly, at the cost of
+ * delay. The filter is computed directly in floating point, so unlike a recursive CIC
+ * implementation its integrators can't overflow.
+ *
+ * @tparam CHANNELS The number of channels filtered, for example 6 for an accelerometer and
+ *      gyroscope.
+ * @tparam MAX_TAPS The maximum number of filter taps.
+ */
+template <std::size_t CHANNELS, std::size_t MAX_TAPS = 32>
+class FirDecimator
+{
+public:
+    FirDecimator() { configureCic(1, 1); }
+
+    /**
+     * Uses a CIC filter, with a differential delay of 1, as the filter. It has
+     * `order * (decimationFactor - 1) + 1` taps, each the coefficient of
+     * `(1 + z^-1 + ... + z^-(decimationFactor - 1))^order`, scaled so the filter has unity gain
+     * at DC. Resets the filter.
+     *
+     * @return `false` if the filter would have more than `MAX_TAPS` taps or either parameter is
+     *      0, in which case the configuration is unchanged.
+     */
+    bool configureCic(uint8_t decimationFactor, uint8_t order)
+    {
+        if (decimationFactor == 0 || order == 0 ||
+            static_cast<std::size_t>(order) * (decimationFactor - 1) + 1 > MAX_TAPS)
+        {
+            return false;
+        }
+
+        float cicTaps[MAX_TAPS] = {1.0f};
+        std::size_t cicNumTaps = 1;
+        for (uint8_t i = 0; i < order; i++)
+        {
+            // convolve with a boxcar of length decimationFactor, from the back so that each tap
+            // is only read before it is overwritten
+            cicNumTaps += decimationFactor - 1;
+            for (std::size_t tap = cicNumTaps; tap-- > 0;)
+            {
+                float sum = 0.0f;
+                for (std::size_t k = 0; k < decimationFactor && k <= tap; k++)
+                {
+                    sum += cicTaps[tap - k];
+                }
+                cicTaps[tap] = sum;
+            }
+        }
+
+        float dcGain = 0.0f;
+        for (std::size_t tap = 0; tap < cicNumTaps; tap++)
+        {
+            dcGain += cicTaps[tap];
+        }
+        for (std::size_t tap = 0; tap < cicNumTaps; tap++)
+        {
+            cicTaps[tap] /= dcGain;
+        }
+
+        return configure(decimationFactor, cicTaps, cicNumTaps);
+    }
+
+    /**
+     * Uses arbitrary FIR taps as the filter. Resets the filter.
+     *
+     * @param[in] taps The impulse response of the filter, `taps[0]` applied to the newest sample.
+     *      The taps should sum to 1 for unity gain at DC.
+     * @return `false` if there are more than `MAX_TAPS` or no taps, or `decimationFactor` is 0,
+     *      in which case the configuration is unchanged.
+     */
+    bool configure(uint8_t decimationFactor, const float *taps, std::size_t numTaps)
+    {
+        if (decimationFactor == 0 || numTaps == 0 || numTaps > MAX_TAPS)
+        {
+            return false;
+        }
+
+        this->decimationFactor = decimationFactor;
+        this->numTaps = numTaps;
+        for (std::size_t tap = 0; tap < numTaps; tap++)
+        {
+            this->taps[tap] = taps[tap];
+        }
+        reset();
+        return true;
+    }
+
+    /// Clears the filter's history so the next output only depends on samples added after this.
+    void reset()
+    {
+        for (auto &sample : history)
+        {
+            for (auto &value : sample)
+            {
+                value = 0.0f;
+            }
+        }
+        for (auto &value : output)
+        {
+            value = 0.0f;
+        }
+        newest = 0;
+        numSamples = 0;
+        samplesUntilOutput = decimationFactor;
+    }
+
+    /**
+     * Adds one input sample.
+     *
+     * @return `true` if a new output sample was computed, which can be read with `getOutput`.
+     */
+    bool update(const float (&sample)[CHANNELS])
+    {
+        newest = (newest + 1) % MAX_TAPS;
+        for (std::size_t channel = 0; channel < CHANNELS; channel++)
+        {
+            history[newest][channel] = sample[channel];
+        }
+        if (numSamples < numTaps)
+        {
+            numSamples++;
+        }
+
+        if (--samplesUntilOutput > 0)
+        {
+            return false;
+        }
+        samplesUntilOutput = decimationFactor;
+
+        // Until the history is full, the missing samples are treated as repeats of the oldest
+        // sample rather than zeros, so the first outputs aren't biased towards 0.
+        for (std::size_t channel = 0; channel < CHANNELS; channel++)
+        {
+            float sum = 0.0f;
+            for (std::size_t tap = 0; tap < numTaps; tap++)
+            {
+                std::size_t age = tap < numSamples ? tap : numSamples - 1;
+                sum += taps[tap] * history[(newest + MAX_TAPS - age) % MAX_TAPS][channel];
+            }
+            output[channel] = sum;
+        }
+        return true;
+    }
+
+    /// @return The most recent output sample of `channel`.
+    float getOutput(std::size_t channel) const { return output[channel]; }
+
+    uint8_t getDecimationFactor() const { return decimationFactor; }
+
+    std::size_t getNumTaps() const { return numTaps; }
+
+    float getTap(std::size_t tap) const { return taps[tap]; }
+
+private:
+    uint8_t decimationFactor = 1;
+
+    float taps[MAX_TAPS] = {};
+    std::size_t numTaps = 0;
+
+    /// Circular buffer of the most recent input samples, `history[newest]` being the newest.
+    float history[MAX_TAPS][CHANNELS] = {};
+    std::size_t newest = 0;
+    /// The number of valid samples in `history`, at most `numTaps`.
+    std::size_t numSamples = 0;
+
+    uint8_t samplesUntilOutput = 1;
+
+    float output[CHANNELS] = {};
+};  // class FirDecimator
+
+}  // namespace algorithms
+
+}  // namespace tap
+
+#endif  // TAPROOT_FIR_DECIMATOR_HPP_
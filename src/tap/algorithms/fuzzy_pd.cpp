@@ -29,6 +29,10 @@ FuzzyPD::FuzzyPD(const FuzzyPDConfig &pidConfig, const SmoothPidConfig &smoothPi
     : SmoothPid(smoothPidConfig),
       config(pidConfig)
 {
+    if (config.precomputeGainSurface)
+    {
+        precomputeGainSurface();
+    }
 }
 
 float FuzzyPD::runController(float error, float errorDerivative, float dt)
@@ -39,8 +43,29 @@ float FuzzyPD::runController(float error, float errorDerivative, float dt)
     return SmoothPid::runController(error, errorDerivative, dt);
 }
 
+void FuzzyPD::precomputeGainSurface()
+{
+    for (size_t i = 0; i < GAIN_SURFACE_SIZE; i++)
+    {
+        for (size_t j = 0; j < GAIN_SURFACE_SIZE; j++)
+        {
+            modm::Matrix<float, 2, 1> gains =
+                config.fuzzyTable.performFuzzyUpdate(kpSurface.getX(i), kpSurface.getY(j));
+            kpSurface.getValues()[i][j] = gains[0][0];
+            kdSurface.getValues()[i][j] = gains[1][0];
+        }
+    }
+}
+
 void FuzzyPD::udpatePidGains(float error, float errorDerivative)
 {
+    if (config.precomputeGainSurface)
+    {
+        setP(kpSurface.interpolate(error, errorDerivative));
+        setD(kdSurface.interpolate(error, errorDerivative));
+        return;
+    }
+
     config.fuzzyTable.performFuzzyUpdate(error, errorDerivative);
 
     setP(config.fuzzyTable.getFuzzyGains()[0][0]);
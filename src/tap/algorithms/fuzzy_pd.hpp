@@ -20,11 +20,14 @@
 #ifndef TAPROOT_FUZZY_PD_HPP_
 #define TAPROOT_FUZZY_PD_HPP_
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 #include "tap/algorithms/extended_kalman.hpp"
 
 #include "fuzzy_pd_rule_table.hpp"
+#include "lookup_grid.hpp"
 #include "smooth_pid.hpp"
 
 namespace tap::algorithms
@@ -35,6 +38,15 @@ struct FuzzyPDConfig
     float maxError = 0.0f;
     float maxErrorDerivative = 0.0f;
     FuzzyPDRuleTable fuzzyTable;
+    /**
+     * If `true`, the gains of the fuzzy table are computed once, at construction, on a grid of
+     * `FuzzyPD::GAIN_SURFACE_SIZE` by `FuzzyPD::GAIN_SURFACE_SIZE` normalized errors and error
+     * derivatives. Each update then bilinearly interpolates the grid rather than running the
+     * fuzzy table. Since the rule table is fixed, only the interpolation error changes the gains:
+     * each interpolated gain is within 1/16, and in practice about 1/32, of the difference between
+     * the table's largest and smallest parameters of the exact gain.
+     */
+    bool precomputeGainSurface = false;
 };
 
 /**
@@ -57,6 +69,9 @@ struct FuzzyPDConfig
 class FuzzyPD : public SmoothPid
 {
 public:
+    /// Number of grid points along each axis of the precomputed gain surface.
+    static constexpr size_t GAIN_SURFACE_SIZE = 17;
+
     /**
      * @param[in] pdConfig Fuzzy-specific configuration.
      * @param[in] smoothPidConfig PID-specific configuration.
@@ -70,8 +85,19 @@ class FuzzyPD : public SmoothPid
     float runController(float error, float errorDerivative, float dt) override;
 
 private:
+    using GainSurface = LookupGrid2D<float, GAIN_SURFACE_SIZE, GAIN_SURFACE_SIZE>;
+
     FuzzyPDConfig config;
 
+    /**
+     * P and D gains indexed by normalized error then error derivative, which span [-1, 1], see
+     * `FuzzyPDConfig`.
+     */
+    GainSurface kpSurface{-1.0f, 1.0f, -1.0f, 1.0f};
+    GainSurface kdSurface{-1.0f, 1.0f, -1.0f, 1.0f};
+
+    void precomputeGainSurface();
+
     void udpatePidGains(float error, float errorDerivative);
 };
 
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "gyro_bias_estimator.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+#include "crc.hpp"
+
+namespace tap::algorithms
+{
+void GyroCalibration::seal()
+{
+    crc = calculateCRC16(reinterpret_cast<const uint8_t *>(this), offsetof(GyroCalibration, crc));
+}
+
+bool GyroCalibration::isValid() const
+{
+    return version == CURRENT_VERSION &&
+           crc == calculateCRC16(
+                      reinterpret_cast<const uint8_t *>(this),
+                      offsetof(GyroCalibration, crc));
+}
+
+int GyroCalibration::getTableBin(float temperature)
+{
+    const float bin = floorf((temperature - TABLE_MIN_TEMPERATURE) / TABLE_BIN_WIDTH);
+    return bin >= 0 && bin < TABLE_SIZE ? static_cast<int>(bin) : -1;
+}
+
+void GyroCalibration::getFitBias(float temperature, float (&out)[3]) const
+{
+    const float temperatureDifference = temperature - referenceTemperature;
+    for (int i = 0; i < 3; i++)
+    {
+        out[i] = bias[i] + temperatureCoefficient[i] * temperatureDifference;
+    }
+}
+
+void GyroCalibration::getBias(float temperature, float (&out)[3]) const
+{
+    // The closest valid entries at or below and at or above the temperature.
+    int below = -1;
+    int above = -1;
+    for (int bin = 0; bin < TABLE_SIZE; bin++)
+    {
+        if (!(tableValid & (1u << bin)))
+        {
+            continue;
+        }
+        if (tableTemperature[bin] <= temperature)
+        {
+            below = bin;
+        }
+        else if (above < 0)
+        {
+            above = bin;
+        }
+    }
+
+    if (below < 0 && above < 0)
+    {
+        getFitBias(temperature, out);
+        return;
+    }
+
+    if (below >= 0 && above >= 0)
+    {
+        const float t = (temperature - tableTemperature[below]) /
+                        (tableTemperature[above] - tableTemperature[below]);
+        for (int i = 0; i < 3; i++)
+        {
+            out[i] = tableBias[below][i] + t * (tableBias[above][i] - tableBias[below][i]);
+        }
+        return;
+    }
+
+    // Past the end of the table, continue from the last entry with the fit's slope.
+    const int nearest = below >= 0 ? below : above;
+    const float temperatureDifference = temperature - tableTemperature[nearest];
+    for (int i = 0; i < 3; i++)
+    {
+        out[i] = tableBias[nearest][i] + temperatureCoefficient[i] * temperatureDifference;
+    }
+}
+
+GyroBiasEstimator::GyroBiasEstimator() : GyroBiasEstimator(Config()) {}
+
+GyroBiasEstimator::GyroBiasEstimator(const Config &config) : config(config) { reset(); }
+
+void GyroBiasEstimator::reset()
+{
+    calibration = GyroCalibration();
+    calibration.seal();
+
+    measurementWeight = 0.0f;
+    temperatureOrigin = 0.0f;
+    temperatureWeightedSum = 0.0f;
+    temperatureSquaredWeightedSum = 0.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        biasWeightedSum[i] = 0.0f;
+        temperatureBiasWeightedSum[i] = 0.0f;
+    }
+    numMeasurements = 0;
+    for (int bin = 0; bin < GyroCalibration::TABLE_SIZE; bin++)
+    {
+        tableCount[bin] = 0;
+    }
+    stationary = false;
+    numUpdates = 0;
+    numRejectedWindows = 0;
+
+    resetWindow();
+}
+
+void GyroBiasEstimator::resetWindow()
+{
+    windowCount = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        gyroSum[i] = 0.0f;
+        gyroSquaredSum[i] = 0.0f;
+    }
+    accNormSum = 0.0f;
+    accNormSquaredSum = 0.0f;
+    temperatureSum = 0.0f;
+}
+
+void GyroBiasEstimator::setCalibration(const GyroCalibration &calibration)
+{
+    // Copied first since `calibration` may be this estimator's own.
+    const GyroCalibration stored = calibration;
+    reset();
+    this->calibration = stored;
+    for (int bin = 0; bin < GyroCalibration::TABLE_SIZE; bin++)
+    {
+        tableCount[bin] = (stored.tableValid & (1u << bin)) ? 1 : 0;
+    }
+    addMeasurement(stored.bias, stored.referenceTemperature);
+    numUpdates = 0;
+}
+
+void GyroBiasEstimator::setBias(const float (&bias)[3], float temperature)
+{
+    GyroCalibration measured = calibration;
+    const int bin = GyroCalibration::getTableBin(temperature);
+    for (int i = 0; i < 3; i++)
+    {
+        measured.bias[i] = bias[i];
+        if (bin >= 0)
+        {
+            measured.tableBias[bin][i] = bias[i];
+        }
+    }
+    measured.referenceTemperature = temperature;
+    if (bin >= 0)
+    {
+        measured.tableTemperature[bin] = temperature;
+        measured.tableValid |= 1u << bin;
+    }
+    measured.seal();
+    setCalibration(measured);
+}
+
+bool GyroBiasEstimator::update(const float (&gyro)[3], const float (&acc)[3], float temperature)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        gyroSum[i] += gyro[i];
+        gyroSquaredSum[i] += gyro[i] * gyro[i];
+    }
+    const float accNorm = sqrtf(acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2]);
+    accNormSum += accNorm;
+    accNormSquaredSum += accNorm * accNorm;
+    temperatureSum += temperature;
+
+    if (++windowCount < config.windowSamples)
+    {
+        return false;
+    }
+
+    const float n = windowCount;
+    const float windowTemperature = temperatureSum / n;
+    float mean[3];
+    float expectedBias[3];
+    calibration.getBias(windowTemperature, expectedBias);
+
+    stationary = true;
+    for (int i = 0; i < 3; i++)
+    {
+        mean[i] = gyroSum[i] / n;
+        const float variance = gyroSquaredSum[i] / n - mean[i] * mean[i];
+        stationary = stationary && variance <= config.maxGyroStdDev * config.maxGyroStdDev;
+    }
+    const float accMean = accNormSum / n;
+    const float accVariance = accNormSquaredSum / n - accMean * accMean;
+    stationary = stationary && accVariance <= config.maxAccStdDev * config.maxAccStdDev;
+
+    bool plausible = true;
+    bool agrees = true;
+    for (int i = 0; i < 3; i++)
+    {
+        plausible = plausible && fabsf(mean[i]) <= config.maxBias;
+        agrees = agrees && fabsf(mean[i] - expectedBias[i]) <= config.maxBiasStep;
+    }
+
+    resetWindow();
+
+    if (!stationary || !plausible)
+    {
+        return false;
+    }
+
+    if (hasCalibration() && !agrees)
+    {
+        if (++numRejectedWindows < config.windowsBeforeRelearning)
+        {
+            return false;
+        }
+        const uint32_t updates = numUpdates;
+        reset();
+        numUpdates = updates;
+        stationary = true;
+    }
+    numRejectedWindows = 0;
+
+    addTableMeasurement(mean, windowTemperature);
+    addMeasurement(mean, windowTemperature);
+    return true;
+}
+
+void GyroBiasEstimator::addTableMeasurement(const float (&bias)[3], float temperature)
+{
+    const int bin = GyroCalibration::getTableBin(temperature);
+    if (bin < 0)
+    {
+        return;
+    }
+
+    if (tableCount[bin] < config.windowsAveraged)
+    {
+        tableCount[bin]++;
+    }
+    // A running mean that becomes an exponential moving average once the bin is full.
+    const float weight = 1.0f / tableCount[bin];
+    calibration.tableTemperature[bin] += weight * (temperature - calibration.tableTemperature[bin]);
+    for (int i = 0; i < 3; i++)
+    {
+        calibration.tableBias[bin][i] += weight * (bias[i] - calibration.tableBias[bin][i]);
+    }
+    calibration.tableValid |= 1u << bin;
+}
+
+void GyroBiasEstimator::addMeasurement(const float (&bias)[3], float temperature)
+{
+    if (numMeasurements >= config.windowsAveraged)
+    {
+        const float decay = 1.0f - 1.0f / config.windowsAveraged;
+        measurementWeight *= decay;
+        temperatureWeightedSum *= decay;
+        temperatureSquaredWeightedSum *= decay;
+        for (int i = 0; i < 3; i++)
+        {
+            biasWeightedSum[i] *= decay;
+            temperatureBiasWeightedSum[i] *= decay;
+        }
+    }
+    else
+    {
+        numMeasurements++;
+    }
+
+    if (measurementWeight == 0.0f)
+    {
+        temperatureOrigin = temperature;
+    }
+
+    // Temperatures are summed relative to the first one so the sums of squares don't lose the
+    // small differences the fit depends on.
+    const float relativeTemperature = temperature - temperatureOrigin;
+    measurementWeight += 1.0f;
+    temperatureWeightedSum += relativeTemperature;
+    temperatureSquaredWeightedSum += relativeTemperature * relativeTemperature;
+    for (int i = 0; i < 3; i++)
+    {
+        biasWeightedSum[i] += bias[i];
+        temperatureBiasWeightedSum[i] += relativeTemperature * bias[i];
+    }
+
+    const float meanTemperature = temperatureWeightedSum / measurementWeight;
+    const float temperatureVariance =
+        temperatureSquaredWeightedSum / measurementWeight - meanTemperature * meanTemperature;
+    const bool fitCoefficients =
+        temperatureVariance >= config.minTemperatureStdDev * config.minTemperatureStdDev;
+
+    calibration.version = GyroCalibration::CURRENT_VERSION;
+    calibration.referenceTemperature = temperatureOrigin + meanTemperature;
+    for (int i = 0; i < 3; i++)
+    {
+        const float meanBias = biasWeightedSum[i] / measurementWeight;
+        if (fitCoefficients)
+        {
+            calibration.temperatureCoefficient[i] =
+                (temperatureBiasWeightedSum[i] / measurementWeight -
+                 meanTemperature * meanBias) /
+                temperatureVariance;
+        }
+        calibration.bias[i] = meanBias;
+    }
+    calibration.seal();
+    numUpdates++;
+}
+
+}  // namespace tap::algorithms
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_GYRO_BIAS_ESTIMATOR_HPP_
+#define TAPROOT_GYRO_BIAS_ESTIMATOR_HPP_
+
+#include <cstdint>
+
+namespace tap::algorithms
+{
+/**
+ * A gyroscope calibration that can be stored in non-volatile memory, for example with
+ * `tap::storage::LittleFSInternal::writeFile`, and restored on the next boot.
+ *
+ * The bias is modeled two ways. A linear fit, `bias` at `referenceTemperature` changing by
+ * `temperatureCoefficient` per degree, and a table of the bias measured in each
+ * `TABLE_BIN_WIDTH` wide temperature bin. Bias is rarely linear in temperature over the whole
+ * warm-up of the IMU, so wherever the table has entries on both sides of a temperature the bias
+ * is interpolated from them, and the fit only extrapolates past the table's ends.
+ */
+struct GyroCalibration
+{
+    /// Changes whenever the layout of this struct changes, so stale files are rejected.
+    static constexpr uint32_t CURRENT_VERSION = 2;
+
+    static constexpr int TABLE_SIZE = 16;
+    /// Lower edge of the table's first bin, in degrees C.
+    static constexpr float TABLE_MIN_TEMPERATURE = 10.0f;
+    /// Width of each of the table's bins, in degrees C.
+    static constexpr float TABLE_BIN_WIDTH = 3.0f;
+
+    uint32_t version = CURRENT_VERSION;
+    /// Gyroscope bias at `referenceTemperature`, in degrees / second.
+    float bias[3] = {};
+    /// Temperature the bias was measured at, in degrees C.
+    float referenceTemperature = 0.0f;
+    /// Change in bias per degree C, in degrees / second / degree C.
+    float temperatureCoefficient[3] = {};
+    /// Bit `i` is set if the table's bin `i` holds a measurement.
+    uint16_t tableValid = 0;
+    /// Mean temperature of the measurements in each bin, in degrees C.
+    float tableTemperature[TABLE_SIZE] = {};
+    /// Mean bias measured in each bin, in degrees / second.
+    float tableBias[TABLE_SIZE][3] = {};
+    /// CRC16 of all the fields above, see `seal`.
+    uint16_t crc = 0;
+
+    /// Computes `crc`, call before storing the calibration.
+    void seal();
+
+    /// @return `true` if the version is current and the crc matches.
+    bool isValid() const;
+
+    /// Computes the bias at `temperature` into `out`, in degrees / second.
+    void getBias(float temperature, float (&out)[3]) const;
+
+    /// @return The table bin `temperature` falls in, or -1 if it is outside the table.
+    static int getTableBin(float temperature);
+
+private:
+    /// Bias of the linear fit at `temperature`.
+    void getFitBias(float temperature, float (&out)[3]) const;
+};
+
+/**
+ * Estimates gyroscope bias while the IMU is in use, without the IMU having to sit through a
+ * blocking calibration.
+ *
+ * Samples are collected in windows of `Config::windowSamples`. A window in which the gyroscope
+ * and accelerometer barely change is considered stationary, and the mean of its gyroscope samples
+ * is a measurement of the bias. Windows whose mean is implausible as a bias, such as those of a
+ * robot spinning at a constant rate, are rejected. Measurements are averaged, the oldest
+ * fading out once there are `Config::windowsAveraged` of them, and a linear fit of bias against
+ * temperature gives the temperature coefficients once the measurements span enough temperature.
+ *
+ * Each measurement is also averaged into the table bin of its temperature. While the robot sits
+ * still as the `ImuHeater` warms the IMU up, this fills the table across the warm-up, so with
+ * the calibration stored, the robot can start moving on the next boot before the IMU reaches
+ * its setpoint.
+ */
+class GyroBiasEstimator
+{
+public:
+    struct Config
+    {
+        /// Samples per stationary detection window.
+        uint16_t windowSamples = 200;
+        /// Largest standard deviation of each gyroscope axis in a stationary window, in deg/s.
+        float maxGyroStdDev = 0.3f;
+        /// Largest standard deviation of the acceleration's magnitude in a stationary window.
+        float maxAccStdDev = 0.05f;
+        /// Largest plausible bias, in degrees / second. Windows with a larger mean are rejected.
+        float maxBias = 2.0f;
+        /**
+         * Once there is an estimate, windows whose mean differs from it by more than this are
+         * rejected, in degrees / second.
+         */
+        float maxBiasStep = 0.3f;
+        /**
+         * After this many consecutive stationary windows rejected for differing from the
+         * estimate, the estimate is assumed stale, for example restored from another board's
+         * calibration, and is replaced by new measurements.
+         */
+        uint16_t windowsBeforeRelearning = 20;
+        /// The number of windows after which older windows start to fade out of the estimate.
+        uint16_t windowsAveraged = 50;
+        /// Temperature spread (standard deviation, degrees C) needed to fit the coefficients.
+        float minTemperatureStdDev = 1.0f;
+    };
+
+    GyroBiasEstimator();
+
+    explicit GyroBiasEstimator(const Config &config);
+
+    /// Forgets every measurement and the calibration.
+    void reset();
+
+    /**
+     * Starts from a stored, valid calibration, which counts as one measurement and keeps its
+     * temperature coefficients until the measurements span enough temperature to fit new ones.
+     */
+    void setCalibration(const GyroCalibration &calibration);
+
+    /**
+     * Restarts from a bias measured by other means, such as a blocking calibration, at
+     * `temperature`. The table entry at that temperature is replaced and the rest of the
+     * calibration is kept.
+     */
+    void setBias(const float (&bias)[3], float temperature);
+
+    /**
+     * Adds one sample.
+     *
+     * @param[in] gyro Angular velocity without any bias removed, in degrees / second.
+     * @param[in] acc Acceleration, in any unit.
+     * @param[in] temperature The gyroscope's temperature, in degrees C.
+     * @return `true` if the sample completed a stationary window that updated the calibration.
+     */
+    bool update(const float (&gyro)[3], const float (&acc)[3], float temperature);
+
+    /// @return `true` if there is a calibration, measured or set.
+    bool hasCalibration() const { return measurementWeight > 0.0f; }
+
+    /// @return The current calibration, sealed so it can be stored directly.
+    const GyroCalibration &getCalibration() const { return calibration; }
+
+    /// Computes the bias at `temperature` into `bias`, in degrees / second.
+    void getBias(float temperature, float (&bias)[3]) const
+    {
+        calibration.getBias(temperature, bias);
+    }
+
+    /// @return `true` if the last complete window was stationary.
+    bool isStationary() const { return stationary; }
+
+    /// @return The number of times the calibration has changed, to tell when to store it again.
+    uint32_t getNumUpdates() const { return numUpdates; }
+
+private:
+    Config config;
+
+    GyroCalibration calibration;
+
+    /// Sums over the current window.
+    uint16_t windowCount;
+    float gyroSum[3];
+    float gyroSquaredSum[3];
+    float accNormSum;
+    float accNormSquaredSum;
+    float temperatureSum;
+
+    /// Weighted sums over stationary windows, for the fit of bias against temperature.
+    float measurementWeight;
+    float temperatureOrigin;
+    float temperatureWeightedSum;
+    float temperatureSquaredWeightedSum;
+    float biasWeightedSum[3];
+    float temperatureBiasWeightedSum[3];
+    uint32_t numMeasurements;
+    /// Measurements averaged into each table bin, capped at `Config::windowsAveraged`.
+    uint16_t tableCount[GyroCalibration::TABLE_SIZE];
+
+    bool stationary;
+    uint32_t numUpdates;
+    /// Consecutive stationary windows rejected for differing from the estimate.
+    uint16_t numRejectedWindows;
+
+    void resetWindow();
+
+    /// Adds a measurement to the linear fit.
+    void addMeasurement(const float (&bias)[3], float temperature);
+
+    /// Averages a measurement into the table bin of its temperature.
+    void addTableMeasurement(const float (&bias)[3], float temperature);
+};  // class GyroBiasEstimator
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_GYRO_BIAS_ESTIMATOR_HPP_
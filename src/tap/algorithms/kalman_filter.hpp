@@ -20,7 +20,9 @@
 #ifndef TAPROOT_KALMAN_FILTER_HPP_
 #define TAPROOT_KALMAN_FILTER_HPP_
 
+#include <algorithm>
 #include <cinttypes>
+#include <cmath>
 
 #include "modm/architecture/interface/assert.h"
 #include "modm/math/matrix.hpp"
@@ -35,15 +37,28 @@ namespace tap::algorithms
  *
  * @note Below, let \f$Y_{i - 1}\f$ be the set of all previous
  *      measurements, \f${y_1, y_2, ..., y_i\f$.
+ *
+ * If `A`, `C`, `Q`, and `R` are constant, the error covariance and gain converge to fixed values
+ * after enough updates, after which propagating the covariance every update is wasted work. In
+ * steady state mode, entered with `computeSteadyStateGain` or automatically once the gain
+ * converges (see `setSteadyStateTolerance`), the filter keeps the converged gain and only
+ * updates the state, \f$\hat{x} = A\hat{x} + K(y - CA\hat{x})\f$.
  */
 template <uint16_t STATES, uint16_t INPUTS>
 class KalmanFilter
 {
 public:
     /**
-     * @param[in] A State transition matrix (also called F).
+     * Fills in the state transition matrix `A` and process noise covariance `Q` for a time step
+     * of `dt` seconds. Only the elements that depend on `dt` need to be written.
+     */
+    using ModelGenerator =
+        void (*)(float dt, CMSISMat<STATES, STATES> &A, CMSISMat<STATES, STATES> &Q);
+
+    /**
+     * @param[in] A State transition matrix (also called F), for the nominal time step.
      * @param[in] C Observation matrix (also called H).
-     * @param[in] Q Process noise covariance.
+     * @param[in] Q Process noise covariance, for the nominal time step.
      * @param[in] R Measurement error covariance.
      * @param[in] P0 Initial prediction error covariance estimate.
      */
@@ -54,20 +69,14 @@ class KalmanFilter
         const float (&R)[INPUTS * INPUTS],
         const float (&P0)[STATES * STATES])
         : A(A),
-          At(),
           C(C),
-          Ct(),
           Q(Q),
           R(R),
           xHat(),
           P(P0),
           P0(P0),
-          K(),
-          I()
+          K()
     {
-        arm_mat_trans_f32(&this->A.matrix, &At.matrix);
-        arm_mat_trans_f32(&this->C.matrix, &Ct.matrix);
-        I.constructIdentityMatrix();
     }
 
     void init(const float (&initialX)[STATES * 1])
@@ -77,29 +86,267 @@ class KalmanFilter
         initialized = true;
     }
 
+    /**
+     * Sets a function that fills in the state transition and process noise covariance for a time
+     * step of `dt` seconds, evaluated in place by `predict(float)` so a filter whose measurements
+     * arrive at irregular intervals doesn't have to be reconstructed.
+     */
+    void setModelGenerator(ModelGenerator generator)
+    {
+        modelGenerator = generator;
+        if (generator != nullptr)
+        {
+            // The gain depends on the time step, so it no longer has a steady state
+            steadyState = false;
+        }
+    }
+
+    /**
+     * Iterates the covariance prediction and correction from the initial error covariance until
+     * no element of the gain changes by more than `tolerance` between iterations, then enters
+     * steady state mode with the converged gain. Each iteration costs about as much as a full
+     * update, and a weakly observed model can take thousands of iterations to converge, so call
+     * this once at startup, such as alongside `init`, rather than from the control loop.
+     *
+     * @return `false` if the gain didn't converge within `maxIterations`, the innovation
+     *      covariance isn't positive definite, or a model generator is set, in which case the
+     *      filter is left as it was.
+     */
+    bool computeSteadyStateGain(int maxIterations = 10'000, float tolerance = 1E-7f)
+    {
+        if (modelGenerator != nullptr)
+        {
+            return false;
+        }
+
+        const std::array<float, STATES * STATES> initialP = P.data;
+        const std::array<float, STATES * INPUTS> initialK = K.data;
+        P.data = P0.data;
+        for (int i = 0; i < maxIterations; i++)
+        {
+            const std::array<float, STATES * INPUTS> previousK = K.data;
+            predictCovariance();
+            if (!computeGain())
+            {
+                break;
+            }
+            correctCovariance();
+            if (i > 0 && maxDifference(previousK, K.data) <= tolerance)
+            {
+                steadyState = true;
+                return true;
+            }
+        }
+
+        P.data = initialP;
+        K.data = initialK;
+        return false;
+    }
+
+    /**
+     * Enters steady state mode automatically once no element of the gain computed by `correct`
+     * changes by more than `tolerance` between updates. 0, the default, disables this. Only
+     * applies when no model generator is set.
+     */
+    void setSteadyStateTolerance(float tolerance) { steadyStateTolerance = tolerance; }
+
+    /// @return `true` if the filter is using a fixed gain rather than propagating the covariance.
+    bool isSteadyState() const { return steadyState; }
+
+    /**
+     * Leaves steady state mode, so the covariance is propagated and the gain recomputed every
+     * update again. Call after changing the measurement covariance of a filter in steady state.
+     */
+    void exitSteadyState() { steadyState = false; }
+
+    /**
+     * Predicts the state one step forward with the current state transition and process noise
+     * covariance.
+     */
+    void predict()
+    {
+        if (!initialized)
+        {
+            return;
+        }
+
+        multiply(A, xHat, xPredicted);
+        xHat.data = xPredicted.data;
+        if (!steadyState)
+        {
+            predictCovariance();
+        }
+    }
+
+    /**
+     * Predicts the state `dt` seconds forward, first evaluating the model generator if one is set.
+     */
+    void predict(float dt)
+    {
+        evaluateModel(dt);
+        predict();
+    }
+
+    /**
+     * Predicts the state `dt` seconds forward with the control input `u`, xHat = A * xHat + B * u,
+     * first evaluating the model generator if one is set.
+     *
+     * @param[in] B Control matrix for a step of `dt`.
+     */
+    template <uint16_t CONTROLS>
+    void predict(float dt, const CMSISMat<STATES, CONTROLS> &B, const CMSISMat<CONTROLS, 1> &u)
+    {
+        if (!initialized)
+        {
+            return;
+        }
+
+        evaluateModel(dt);
+        multiply(A, xHat, xPredicted);
+        mulAdd(B, u, xPredicted, xHat);
+        if (!steadyState)
+        {
+            predictCovariance();
+        }
+    }
+
+    /// Predicts the state one step forward and corrects it with the measurement `y`.
     void performUpdate(const CMSISMat<INPUTS, 1> &y)
+    {
+        predict();
+        correct(y);
+    }
+
+    /// Like `performUpdate`, but corrects with `correctSequential`.
+    void performSequentialUpdate(const CMSISMat<INPUTS, 1> &y)
+    {
+        predict();
+        correctSequential(y);
+    }
+
+    /**
+     * Corrects the predicted state with the measurement `y`.
+     *
+     * The gain is found through a Cholesky factorization of the innovation covariance instead of
+     * its inverse, and the error covariance is updated in Joseph form, which keeps it symmetric
+     * and positive definite under float rounding where the shorter \f$(I - KC)P\f$ form drifts.
+     * If the innovation covariance isn't positive definite, the correction is skipped and only
+     * the prediction is kept. In steady state mode, only the state is corrected, with the fixed
+     * gain.
+     */
+    void correct(const CMSISMat<INPUTS, 1> &y)
     {
         if (!initialized)
         {
             return;
         }
 
-        // Predict state
-        // TODO add control vector if necessary in the future
-        xHat = A * xHat;
-        P = A * P * At + Q;
+        if (steadyState)
+        {
+            correctState(y);
+            return;
+        }
+
+        const bool checkConvergence = steadyStateTolerance > 0 && modelGenerator == nullptr;
+        std::array<float, STATES * INPUTS> previousK;
+        if (checkConvergence)
+        {
+            previousK = K.data;
+        }
+
+        if (!computeGain())
+        {
+            return;
+        }
+        correctState(y);
+        correctCovariance();
 
-        // Update step
-        K = P * Ct * (C * P * Ct + R).inverse();
-        xHat = xHat + K * (y - C * xHat);
-        P = (I - K * C) * P;
+        if (checkConvergence && gainComputed &&
+            maxDifference(previousK, K.data) <= steadyStateTolerance)
+        {
+            steadyState = true;
+        }
+        gainComputed = true;
+    }
+
+    /**
+     * Like `correct`, but applies the measurements one at a time as independent scalar
+     * measurements, so no matrix has to be factored or inverted and each correction is
+     * \f$O(STATES^2)\f$. Gives the same result as `correct` only if the measurement noise
+     * covariance is diagonal; its off-diagonal elements are ignored. In steady state mode, the
+     * same as `correct`.
+     */
+    void correctSequential(const CMSISMat<INPUTS, 1> &y)
+    {
+        if (!initialized)
+        {
+            return;
+        }
+
+        if (steadyState)
+        {
+            // With a diagonal measurement covariance, the scalar corrections add up to the
+            // batch gain
+            correctState(y);
+            return;
+        }
+
+        for (uint16_t m = 0; m < INPUTS; m++)
+        {
+            const float *c = &C.data[m * STATES];
+
+            // pc = P * ct, s = c * P * ct + r
+            float pc[STATES];
+            float s = R.data[m * INPUTS + m];
+            float residual = y.data[m];
+            for (uint16_t i = 0; i < STATES; i++)
+            {
+                pc[i] = 0.0f;
+                for (uint16_t j = 0; j < STATES; j++)
+                {
+                    pc[i] += P.data[i * STATES + j] * c[j];
+                }
+            }
+            for (uint16_t i = 0; i < STATES; i++)
+            {
+                s += c[i] * pc[i];
+                residual -= c[i] * xHat.data[i];
+            }
+            if (!(s > 0.0f))
+            {
+                continue;
+            }
+
+            float k[STATES];
+            for (uint16_t i = 0; i < STATES; i++)
+            {
+                k[i] = pc[i] / s;
+                xHat.data[i] += k[i] * residual;
+            }
+
+            // Joseph form expanded for a scalar measurement,
+            // P = P - k * pct - pc * kt + s * k * kt, on the upper triangle and mirrored
+            for (uint16_t i = 0; i < STATES; i++)
+            {
+                for (uint16_t j = i; j < STATES; j++)
+                {
+                    const float value = P.data[i * STATES + j] - k[i] * pc[j] - pc[i] * k[j] +
+                                        s * k[i] * k[j];
+                    P.data[i * STATES + j] = value;
+                    P.data[j * STATES + i] = value;
+                }
+            }
+        }
     }
 
     const std::array<float, STATES> &getStateVectorAsMatrix() const { return xHat.data; }
 
+    const std::array<float, STATES * STATES> &getErrorCovariance() const { return P.data; }
+
     /**
      * @return Modifiable pointer to measurement covariance array so the covariance can be modified
-     * at runtime if need be.
+     * at runtime if need be. A filter in steady state mode keeps its gain until
+     * `exitSteadyState` is called.
      */
     inline std::array<float, INPUTS * INPUTS> &getMeasurementCovariance() { return R.data; }
 
@@ -109,13 +356,7 @@ class KalmanFilter
      *
      * @note Also referred to as "F" in literature.
      */
-    const CMSISMat<STATES, STATES> A;
-
-    /**
-     * Transpose of A, computed at the beginning and stored
-     * to speed up update step.
-     */
-    CMSISMat<STATES, STATES> At;
+    CMSISMat<STATES, STATES> A;
 
     /**
      * Observation matrix. How we transform the state vector into a measurement vector.
@@ -124,13 +365,8 @@ class KalmanFilter
      */
     const CMSISMat<INPUTS, STATES> C;
 
-    /**
-     * Transpose of C.
-     */
-    CMSISMat<STATES, INPUTS> Ct;
-
     /// System noise covariance
-    const CMSISMat<STATES, STATES> Q;
+    CMSISMat<STATES, STATES> Q;
     /// Measurement noise covariance
     CMSISMat<INPUTS, INPUTS> R;
 
@@ -158,13 +394,97 @@ class KalmanFilter
      */
     CMSISMat<STATES, INPUTS> K;
 
-    /**
-     * Identity matrix created upon construction and stored to avoid
-     * having to compute it each update step.
+    /*
+     * Workspace for the intermediate results of the predict and correct steps, allocated once with
+     * the filter rather than as temporaries on the stack each update.
      */
-    CMSISMat<STATES, STATES> I;
+    CMSISMat<STATES, 1> xPredicted;
+    CMSISMat<STATES, STATES> scratch;
+    CMSISMat<STATES, INPUTS> PCt;
+    /// Innovation covariance, C * P * Ct + R, then its Cholesky factor.
+    CMSISMat<INPUTS, INPUTS> S;
+    CMSISMat<INPUTS, 1> innovation;
+    /// I - K * C
+    CMSISMat<STATES, STATES> IKC;
+    CMSISMat<STATES, INPUTS> KR;
+
+    ModelGenerator modelGenerator = nullptr;
 
     bool initialized = false;
+
+    /// `true` if `K` is a converged gain and the covariance is no longer propagated.
+    bool steadyState = false;
+    /// `true` once `correct` has computed a gain to compare the next one to.
+    bool gainComputed = false;
+    float steadyStateTolerance = 0;
+
+    void evaluateModel(float dt)
+    {
+        if (modelGenerator != nullptr)
+        {
+            modelGenerator(dt, A, Q);
+        }
+    }
+
+    /// P = A * P * At + Q
+    void predictCovariance()
+    {
+        multiply(A, P, scratch);
+        mulTransposedAdd(scratch, A, Q, P);
+        symmetrize(P);
+    }
+
+    /**
+     * K = P * Ct * S^-1, where S = C * P * Ct + R, found through a Cholesky factorization of S.
+     *
+     * @return `false` if S isn't positive definite, in which case `K` is unchanged.
+     */
+    bool computeGain()
+    {
+        mulTransposed(P, C, PCt);
+        mulAdd(C, PCt, R, S);
+        if (!choleskyDecompose(S, S))
+        {
+            return false;
+        }
+        choleskySolve(S, PCt, K);
+        return true;
+    }
+
+    /// xHat = xHat + K * (y - C * xHat)
+    void correctState(const CMSISMat<INPUTS, 1> &y)
+    {
+        mulAdd(C, xHat, y, innovation, -1.0f);
+        mulAdd(K, innovation, xHat, xHat);
+    }
+
+    /// P = (I - K * C) * P * (I - K * C)^T + K * R * Kt
+    void correctCovariance()
+    {
+        multiply(K, C, IKC);
+        for (uint16_t i = 0; i < STATES * STATES; i++)
+        {
+            IKC.data[i] = (i % (STATES + 1) == 0 ? 1.0f : 0.0f) - IKC.data[i];
+        }
+        multiply(IKC, P, scratch);
+        mulTransposed(scratch, IKC, P);
+        multiply(K, R, KR);
+        mulTransposedAdd(KR, K, P, P);
+        symmetrize(P);
+    }
+
+    /// @return The largest absolute difference between elements of `a` and `b`.
+    static float maxDifference(
+        const std::array<float, STATES * INPUTS> &a,
+        const std::array<float, STATES * INPUTS> &b)
+    {
+        float difference = 0;
+        for (uint16_t i = 0; i < STATES * INPUTS; i++)
+        {
+            difference = std::max(difference, std::abs(a[i] - b[i]));
+        }
+        return difference;
+    }
 };
 
 }  // namespace tap::algorithms
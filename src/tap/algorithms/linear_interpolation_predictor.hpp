@@ -73,7 +73,7 @@ class LinearInterpolationPredictor
      * @param[in] currTime the current clock time, in ms.
      * @return the interpolated value.
      */
-    inline float getInterpolatedValue(uint32_t currTime)
+    inline float getInterpolatedValue(uint32_t currTime) const
     {
         return slope * static_cast<float>(currTime - lastUpdateCallTime) + previousValue;
     }
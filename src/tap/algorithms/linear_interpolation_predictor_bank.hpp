@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_LINEAR_INTERPOLATION_PREDICTOR_BANK_HPP_
+#define TAPROOT_LINEAR_INTERPOLATION_PREDICTOR_BANK_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+namespace tap::algorithms
+{
+/**
+ * `N` linear interpolation predictors, such as the values received from the referee system or
+ * the target positions received from a vision coprocessor, upsampled to the control loop rate
+ * together. Each channel behaves like a `LinearInterpolationPredictor`, or a
+ * `LinearInterpolationPredictorWrapped` if it is given bounds with `setWrapped`.
+ *
+ * The state of all channels is stored as one array per variable, and wrapped and unwrapped
+ * channels are handled by the same arithmetic (an unwrapped channel wraps over an interval of
+ * 0), so `getInterpolatedValues` is a single branchless pass over contiguous arrays.
+ *
+ * Unlike the single predictors, each channel can limit how long it extrapolates past its last
+ * update, so a channel whose data stops arriving holds its last prediction rather than running
+ * away along its last slope.
+ *
+ * ```cpp
+ * LinearInterpolationPredictorBank<2> predictors(100);
+ * predictors.setWrapped(YAW, -M_PI, M_PI);
+ *
+ * if (new target received)
+ * {
+ *     predictors.update(YAW, target.yaw, target.time);
+ *     predictors.update(DISTANCE, target.distance, target.time);
+ * }
+ * float predicted[2];
+ * predictors.getInterpolatedValues(tap::arch::clock::getTimeMilliseconds(), predicted);
+ * ```
+ *
+ * @tparam N The number of channels.
+ */
+template <int N>
+class LinearInterpolationPredictorBank
+{
+public:
+    static_assert(N > 0, "LinearInterpolationPredictorBank must have at least one channel");
+
+    /**
+     * @param[in] maxExtrapolationTime The longest time, in ms, each channel extrapolates past its
+     *      last update, see `setMaxExtrapolationTime`. Unlimited by default.
+     */
+    explicit LinearInterpolationPredictorBank(uint32_t maxExtrapolationTime = UINT32_MAX)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            this->maxExtrapolationTime[i] = maxExtrapolationTime;
+            lowerBound[i] = 0.0f;
+            interval[i] = 0.0f;
+            inverseInterval[i] = 0.0f;
+            reset(i, 0.0f, 0);
+        }
+    }
+
+    /**
+     * Sets the longest time, in ms, that the channel extrapolates past its last update. Later
+     * predictions hold the value predicted at that time.
+     */
+    void setMaxExtrapolationTime(int channel, uint32_t maxExtrapolationTime)
+    {
+        this->maxExtrapolationTime[channel] = maxExtrapolationTime;
+    }
+
+    /**
+     * Makes the channel wrap like a `WrappedFloat` with the given bounds. Its slope then follows
+     * the shortest way around, see `WrappedFloat::minDifference`. The channel's current value is
+     * wrapped into the bounds.
+     */
+    void setWrapped(int channel, float lowerBound, float upperBound)
+    {
+        this->lowerBound[channel] = lowerBound;
+        interval[channel] = upperBound - lowerBound;
+        inverseInterval[channel] = 1.0f / interval[channel];
+        previousValue[channel] = wrap(channel, previousValue[channel]);
+    }
+
+    /**
+     * Updates the channel with a newly received value, like
+     * `LinearInterpolationPredictor::update`.
+     *
+     * @param[in] channel The channel to update.
+     * @param[in] newValue The new data used in the interpolation.
+     * @param[in] currTime The time the value was received, in ms. Should increase between calls.
+     */
+    void update(int channel, float newValue, uint32_t currTime)
+    {
+        if (currTime <= lastUpdateCallTime[channel])
+        {
+            slope[channel] = 0.0f;
+            return;
+        }
+        // For wrapped channels, the difference the shortest way around
+        float difference = newValue - previousValue[channel];
+        difference -= interval[channel] * roundf(difference * inverseInterval[channel]);
+        slope[channel] = difference / (currTime - lastUpdateCallTime[channel]);
+        previousValue[channel] = wrap(channel, newValue);
+        lastUpdateCallTime[channel] = currTime;
+    }
+
+    /// Resets the channel to `initialValue` at `initialTime` with a slope of 0.
+    void reset(int channel, float initialValue, uint32_t initialTime)
+    {
+        previousValue[channel] = wrap(channel, initialValue);
+        lastUpdateCallTime[channel] = initialTime;
+        slope[channel] = 0.0f;
+    }
+
+    /**
+     * Interpolates every channel, the same as calling `getInterpolatedValue` on each.
+     *
+     * @param[in] currTime The current time, in ms.
+     * @param[out] values The interpolated value of each channel.
+     */
+    void getInterpolatedValues(uint32_t currTime, float (&values)[N]) const
+    {
+        for (int i = 0; i < N; i++)
+        {
+            values[i] = interpolate(i, currTime);
+        }
+    }
+
+    /**
+     * @return The channel's value at `currTime`, in ms, extrapolated along the slope between its
+     *      last two updates for at most its maximum extrapolation time.
+     */
+    float getInterpolatedValue(int channel, uint32_t currTime) const
+    {
+        return interpolate(channel, currTime);
+    }
+
+private:
+    uint32_t lastUpdateCallTime[N];
+    float previousValue[N];
+    float slope[N];
+    uint32_t maxExtrapolationTime[N];
+
+    float lowerBound[N];
+    /// The width of a wrapped channel's bounds, 0 for unwrapped channels.
+    float interval[N];
+    /// The reciprocal of `interval`, 0 for unwrapped channels.
+    float inverseInterval[N];
+
+    /// @return `value` wrapped into the channel's bounds, or `value` if it is unwrapped.
+    float wrap(int channel, float value) const
+    {
+        return value - interval[channel] *
+                           floorf((value - lowerBound[channel]) * inverseInterval[channel]);
+    }
+
+    float interpolate(int channel, uint32_t currTime) const
+    {
+        // Times before the last update wrap to large elapsed times, which are limited as well
+        const uint32_t elapsed = currTime - lastUpdateCallTime[channel];
+        const uint32_t limited = elapsed < maxExtrapolationTime[channel]
+                                     ? elapsed
+                                     : maxExtrapolationTime[channel];
+        return wrap(channel, slope[channel] * static_cast<float>(limited) + previousValue[channel]);
+    }
+};  // class LinearInterpolationPredictorBank
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_LINEAR_INTERPOLATION_PREDICTOR_BANK_HPP_
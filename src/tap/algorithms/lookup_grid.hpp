@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_LOOKUP_GRID_HPP_
+#define TAPROOT_LOOKUP_GRID_HPP_
+
+#include <array>
+#include <cstddef>
+
+namespace tap::algorithms
+{
+namespace detail
+{
+/// The grid cell a coordinate falls in and how far along the cell it is, in [0, 1].
+struct GridPosition
+{
+    size_t index;
+    float t;
+};
+
+/**
+ * Finds the cell of a grid of `size` points that `value` falls in, clamping values outside the
+ * grid to its edges. `scale` is the reciprocal of the grid spacing.
+ */
+constexpr GridPosition locateInGrid(float value, float min, float scale, size_t size)
+{
+    const float position = (value - min) * scale;
+    // Also catches NaN, which is clamped to the first point
+    if (!(position > 0))
+    {
+        return {0, 0};
+    }
+    if (position >= size - 1)
+    {
+        return {size - 2, 1};
+    }
+    const size_t index = static_cast<size_t>(position);
+    return {index, position - index};
+}
+
+constexpr float lerp(float a, float b, float t) { return a + t * (b - a); }
+}  // namespace detail
+
+/**
+ * A table of values at evenly spaced points between `xMin` and `xMax`, linearly interpolated by
+ * `interpolate`. Coordinates outside the grid are clamped to its edges.
+ *
+ * Unlike `interpolateLinear2D`, the reciprocal of the grid spacing is computed once, when the grid
+ * is constructed, so a lookup only multiplies, and grid points are indexed without bounds checks
+ * since the clamped indices are always in bounds. The constructor is `constexpr`, so a grid of
+ * constant values can be built at compile time and placed in flash:
+ *
+ * ```cpp
+ * static constexpr LookupGrid1D<float, 5> TORQUE_CURVE(0, 8'000, {3.0f, 2.9f, 2.6f, 2.0f, 1.1f});
+ * float torque = TORQUE_CURVE.interpolate(rpm);
+ * ```
+ *
+ * @see LookupGrid2D and LookupGrid3D for grids of more dimensions.
+ *
+ * @tparam T The type of the values, which must convert to float.
+ * @tparam X The number of grid points, at least 2.
+ */
+template <typename T, size_t X>
+class LookupGrid1D
+{
+public:
+    static_assert(X >= 2, "a grid needs at least two points along each axis");
+
+    using Values = std::array<T, X>;
+
+    /**
+     * @param[in] xMin The coordinate of the first grid point.
+     * @param[in] xMax The coordinate of the last grid point, greater than `xMin`.
+     * @param[in] values The values at each grid point, zero if not given.
+     */
+    constexpr LookupGrid1D(float xMin, float xMax, const Values &values = {})
+        : values(values),
+          xMin(xMin),
+          xScale((X - 1) / (xMax - xMin))
+    {
+    }
+
+    /// @return The value at `x`, linearly interpolated between the two nearest grid points.
+    constexpr float interpolate(float x) const
+    {
+        const detail::GridPosition px = detail::locateInGrid(x, xMin, xScale, X);
+        return detail::lerp(values[px.index], values[px.index + 1], px.t);
+    }
+
+    /// @return The coordinate of grid point `i`.
+    constexpr float getX(size_t i) const { return xMin + i / xScale; }
+
+    constexpr Values &getValues() { return values; }
+    constexpr const Values &getValues() const { return values; }
+
+private:
+    Values values;
+    float xMin;
+    /// The reciprocal of the grid spacing.
+    float xScale;
+};
+
+/**
+ * A grid of values at evenly spaced x and y coordinates, bilinearly interpolated by
+ * `interpolate`. Values are indexed by x then y, like `interpolateLinear2D`. See `LookupGrid1D`.
+ */
+template <typename T, size_t X, size_t Y>
+class LookupGrid2D
+{
+public:
+    static_assert(X >= 2 && Y >= 2, "a grid needs at least two points along each axis");
+
+    using Values = std::array<std::array<T, Y>, X>;
+
+    constexpr LookupGrid2D(
+        float xMin,
+        float xMax,
+        float yMin,
+        float yMax,
+        const Values &values = {})
+        : values(values),
+          xMin(xMin),
+          xScale((X - 1) / (xMax - xMin)),
+          yMin(yMin),
+          yScale((Y - 1) / (yMax - yMin))
+    {
+    }
+
+    /// @return The value at (`x`, `y`), bilinearly interpolated between the four nearest points.
+    constexpr float interpolate(float x, float y) const
+    {
+        const detail::GridPosition px = detail::locateInGrid(x, xMin, xScale, X);
+        const detail::GridPosition py = detail::locateInGrid(y, yMin, yScale, Y);
+        const std::array<T, Y> &row0 = values[px.index];
+        const std::array<T, Y> &row1 = values[px.index + 1];
+        return detail::lerp(
+            detail::lerp(row0[py.index], row0[py.index + 1], py.t),
+            detail::lerp(row1[py.index], row1[py.index + 1], py.t),
+            px.t);
+    }
+
+    constexpr float getX(size_t i) const { return xMin + i / xScale; }
+    constexpr float getY(size_t j) const { return yMin + j / yScale; }
+
+    constexpr Values &getValues() { return values; }
+    constexpr const Values &getValues() const { return values; }
+
+private:
+    Values values;
+    float xMin;
+    float xScale;
+    float yMin;
+    float yScale;
+};
+
+/**
+ * A grid of values at evenly spaced x, y and z coordinates, trilinearly interpolated by
+ * `interpolate`. Values are indexed by x, then y, then z. See `LookupGrid1D`.
+ */
+template <typename T, size_t X, size_t Y, size_t Z>
+class LookupGrid3D
+{
+public:
+    static_assert(X >= 2 && Y >= 2 && Z >= 2, "a grid needs at least two points along each axis");
+
+    using Values = std::array<std::array<std::array<T, Z>, Y>, X>;
+
+    constexpr LookupGrid3D(
+        float xMin,
+        float xMax,
+        float yMin,
+        float yMax,
+        float zMin,
+        float zMax,
+        const Values &values = {})
+        : values(values),
+          xMin(xMin),
+          xScale((X - 1) / (xMax - xMin)),
+          yMin(yMin),
+          yScale((Y - 1) / (yMax - yMin)),
+          zMin(zMin),
+          zScale((Z - 1) / (zMax - zMin))
+    {
+    }
+
+    /// @return The value at (`x`, `y`, `z`), trilinearly interpolated between the eight nearest
+    ///     points.
+    constexpr float interpolate(float x, float y, float z) const
+    {
+        const detail::GridPosition px = detail::locateInGrid(x, xMin, xScale, X);
+        const detail::GridPosition py = detail::locateInGrid(y, yMin, yScale, Y);
+        const detail::GridPosition pz = detail::locateInGrid(z, zMin, zScale, Z);
+        float planes[2] = {};
+        for (size_t i = 0; i < 2; i++)
+        {
+            const std::array<T, Z> &row0 = values[px.index + i][py.index];
+            const std::array<T, Z> &row1 = values[px.index + i][py.index + 1];
+            planes[i] = detail::lerp(
+                detail::lerp(row0[pz.index], row0[pz.index + 1], pz.t),
+                detail::lerp(row1[pz.index], row1[pz.index + 1], pz.t),
+                py.t);
+        }
+        return detail::lerp(planes[0], planes[1], px.t);
+    }
+
+    constexpr float getX(size_t i) const { return xMin + i / xScale; }
+    constexpr float getY(size_t j) const { return yMin + j / yScale; }
+    constexpr float getZ(size_t k) const { return zMin + k / zScale; }
+
+    constexpr Values &getValues() { return values; }
+    constexpr const Values &getValues() const { return values; }
+
+private:
+    Values values;
+    float xMin;
+    float xScale;
+    float yMin;
+    float yScale;
+    float zMin;
+    float zScale;
+};
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_LOOKUP_GRID_HPP_
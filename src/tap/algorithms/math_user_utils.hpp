@@ -183,6 +183,7 @@ int getSign(T val)
  * Let x = dimension 1 and y = dimension 2 of the 2D array of values
  * @param values 2D-array pointer of f(x,y) values
  * @return approximation of values at (xdes,ydes)
+ * @see LookupGrid2D, which is faster when the same grid is interpolated repeatedly.
  */
 template <typename T, size_t xSize, size_t ySize>
 float interpolateLinear2D(
@@ -214,10 +215,11 @@ float interpolateLinear2D(
     float y2 = yMin + (yIndex + 1) * dy;
 
     float q11, q12, q21, q22;  // values of x1y1, x1y2, x2y1, x2y2
-    q11 = static_cast<float>(values.at(xIndex).at(yIndex));
-    q12 = static_cast<float>(values.at(xIndex).at(yIndex + 1));
-    q21 = static_cast<float>(values.at(xIndex + 1).at(yIndex));
-    q22 = static_cast<float>(values.at(xIndex + 1).at(yIndex + 1));
+    // The indices were clamped above, so skip at()'s bounds checks
+    q11 = static_cast<float>(values[xIndex][yIndex]);
+    q12 = static_cast<float>(values[xIndex][yIndex + 1]);
+    q21 = static_cast<float>(values[xIndex + 1][yIndex]);
+    q22 = static_cast<float>(values[xIndex + 1][yIndex + 1]);
 
     float x2x, y2y, yy1, xx1;  // deltas from each pt to sample pt
     x2x = x2 - xDesBounded;
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "motion_profile.hpp"
+
+#include <cassert>
+#include <cmath>
+
+namespace tap::algorithms
+{
+MotionProfile::MotionProfile() { generate(0.0f, 0.0f, {1.0f, 1.0f}); }
+
+void MotionProfile::generate(float start, float end, const Constraints &constraints)
+{
+    assert(constraints.maxVelocity > 0.0f);
+    assert(constraints.maxAcceleration > 0.0f);
+    assert(constraints.maxJerk >= 0.0f);
+
+    this->start = start;
+    this->end = end;
+
+    const float distance = fabsf(end - start);
+    const float direction = end < start ? -1.0f : 1.0f;
+    const float a = constraints.maxAcceleration;
+    const float j = constraints.maxJerk;
+    float v = constraints.maxVelocity;
+
+    // Time spent changing the acceleration at each end of the acceleration phase, and the length
+    // of the whole acceleration phase, to reach v from rest
+    float jerkTime = 0.0f;
+    float accelTime = v / a;
+    if (j > 0.0f)
+    {
+        if (v * j >= a * a)
+        {
+            jerkTime = a / j;
+            accelTime = jerkTime + v / a;
+        }
+        else
+        {
+            // v is reached before the acceleration limit is
+            jerkTime = sqrtf(v / j);
+            accelTime = 2.0f * jerkTime;
+        }
+    }
+
+    float cruiseTime = 0.0f;
+    if (v * accelTime > distance)
+    {
+        // Accelerating to v and back takes more than the distance, so find the peak velocity
+        // at which it takes exactly the distance
+        if (j > 0.0f)
+        {
+            const float b = a * a / j;
+            v = 0.5f * (-b + sqrtf(b * b + 4.0f * a * distance));
+            if (v >= b)
+            {
+                jerkTime = a / j;
+                accelTime = jerkTime + v / a;
+            }
+            else
+            {
+                v = cbrtf(0.25f * distance * distance * j);
+                jerkTime = sqrtf(v / j);
+                accelTime = 2.0f * jerkTime;
+            }
+        }
+        else
+        {
+            v = sqrtf(a * distance);
+            accelTime = v / a;
+        }
+    }
+    else
+    {
+        cruiseTime = (distance - v * accelTime) / v;
+    }
+
+    const float peakAcceleration = j > 0.0f ? j * jerkTime : a;
+    const float constantAccelTime = accelTime - 2.0f * jerkTime;
+
+    const float phaseDuration[NUM_PHASES] =
+        {jerkTime, constantAccelTime, jerkTime, cruiseTime, jerkTime, constantAccelTime, jerkTime};
+    const float jerk[NUM_PHASES] = {j, 0.0f, -j, 0.0f, -j, 0.0f, j};
+    // The acceleration of a trapezoidal profile steps at the start of phases 1, 3, 5 and the end
+    const float acceleration[NUM_PHASES] = {
+        0.0f,
+        peakAcceleration,
+        peakAcceleration,
+        0.0f,
+        0.0f,
+        -peakAcceleration,
+        -peakAcceleration,
+    };
+
+    float time = 0.0f;
+    float position = start;
+    float velocity = 0.0f;
+    for (int i = 0; i < NUM_PHASES; i++)
+    {
+        const float t = phaseDuration[i];
+        const float a0 = direction * acceleration[i];
+        const float j0 = direction * jerk[i];
+
+        phaseStartTime[i] = time;
+        phaseJerk[i] = j0;
+        phaseStart[i] = {position, velocity, a0};
+
+        time += t;
+        position += t * (velocity + t * (a0 / 2.0f + t * j0 / 6.0f));
+        velocity += t * (a0 + t * j0 / 2.0f);
+    }
+    duration = time;
+}
+
+MotionProfile::State MotionProfile::sample(float time) const
+{
+    if (time <= 0.0f)
+    {
+        return {start, 0.0f, 0.0f};
+    }
+    if (time >= duration)
+    {
+        return {end, 0.0f, 0.0f};
+    }
+
+    int i = NUM_PHASES - 1;
+    while (i > 0 && time < phaseStartTime[i])
+    {
+        i--;
+    }
+
+    const State &s = phaseStart[i];
+    const float t = time - phaseStartTime[i];
+    const float j = phaseJerk[i];
+    return {
+        s.position + t * (s.velocity + t * (s.acceleration / 2.0f + t * j / 6.0f)),
+        s.velocity + t * (s.acceleration + t * j / 2.0f),
+        s.acceleration + t * j,
+    };
+}
+
+}  // namespace tap::algorithms
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTION_PROFILE_HPP_
+#define TAPROOT_MOTION_PROFILE_HPP_
+
+#include <cstdint>
+
+namespace tap::algorithms
+{
+/**
+ * A time-optimal, rest-to-rest motion profile between two positions that respects velocity,
+ * acceleration, and optionally jerk limits.
+ *
+ * With a jerk limit the profile is an S-curve of up to seven phases: jerk up, constant
+ * acceleration, jerk down, cruise, and the same mirrored to decelerate. Without one it is a
+ * trapezoid of up to three. Phases that the limits or distance make unnecessary have zero
+ * length, for example the cruise phase of a move too short to reach the velocity limit.
+ *
+ * The phases are computed once by `generate`, after which `sample` evaluates the position,
+ * velocity, and acceleration at any time in constant time, so a command can generate the profile
+ * in `initialize()` and sample it every `execute()`.
+ *
+ * "Position" is whatever quantity is being controlled, in any units, with velocity in units / s,
+ * acceleration in units / s^2, and jerk in units / s^3.
+ */
+class MotionProfile
+{
+public:
+    struct Constraints
+    {
+        /// Largest magnitude of the velocity. Must be > 0.
+        float maxVelocity;
+        /// Largest magnitude of the acceleration. Must be > 0.
+        float maxAcceleration;
+        /// Largest magnitude of the jerk. 0 generates a trapezoidal profile.
+        float maxJerk = 0.0f;
+    };
+
+    struct State
+    {
+        float position;
+        float velocity;
+        float acceleration;
+    };
+
+    /// Generates a profile that stays at 0.
+    MotionProfile();
+
+    /**
+     * Computes the profile from `start` to `end` at rest under `constraints`, replacing any
+     * previous profile.
+     */
+    void generate(float start, float end, const Constraints &constraints);
+
+    /**
+     * @param[in] time Time since the start of the profile, in seconds.
+     * @return The state of the profile at `time`. The start state before 0 and the end state
+     *      after `getDuration()`.
+     */
+    State sample(float time) const;
+
+    /// @return The time the profile takes to reach the end, in seconds.
+    float getDuration() const { return duration; }
+
+    float getStart() const { return start; }
+
+    float getEnd() const { return end; }
+
+private:
+    static constexpr int NUM_PHASES = 7;
+
+    float start;
+    float end;
+    float duration;
+
+    /// Start time of each phase, in seconds.
+    float phaseStartTime[NUM_PHASES];
+    /// Constant jerk through each phase.
+    float phaseJerk[NUM_PHASES];
+    /// State at the start of each phase.
+    State phaseStart[NUM_PHASES];
+};  // class MotionProfile
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_MOTION_PROFILE_HPP_
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CHASSIS_IMU_OBSERVER_INTERFACE_HPP_
+#define TAPROOT_CHASSIS_IMU_OBSERVER_INTERFACE_HPP_
+
+#include "modm/math/geometry/vector.hpp"
+
+namespace tap::algorithms::odometry
+{
+/**
+ * Object used to get the yaw rate and planar acceleration of the chassis, as measured by an IMU.
+ *
+ * Values are in the chassis frame as defined by `ChassisDisplacementObserverInterface`: positive
+ * x-axis forward, positive y-axis left, positive z-axis up. Implementations are responsible for
+ * rotating the IMU's axes into this frame if the IMU is not mounted aligned with the chassis, and
+ * for removing gravity from the acceleration.
+ *
+ * Getting IMU data may fail as implementor chooses by returning `false` to indicate either values
+ * are too stale or sensor went offline etc.
+ */
+class ChassisImuObserverInterface
+{
+public:
+    /**
+     * @param[out] yawRate destination for the angular velocity of the chassis around the
+     *      positive z-axis, in radians / second.
+     * @param[out] acceleration destination for the linear acceleration of the chassis in the
+     *      chassis frame's x and y directions, in m/s^2.
+     * @return `true` if valid IMU data was available, `false` otherwise.
+     */
+    virtual bool getChassisImu(float* yawRate, modm::Vector2f* acceleration) const = 0;
+};
+
+}  // namespace tap::algorithms::odometry
+
+#endif  // TAPROOT_CHASSIS_IMU_OBSERVER_INTERFACE_HPP_
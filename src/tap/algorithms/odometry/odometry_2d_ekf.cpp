@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "odometry_2d_ekf.hpp"
+
+#include <cmath>
+
+#include "tap/architecture/clock.hpp"
+
+#include "modm/math/geometry/angle.hpp"
+#include "modm/math/geometry/vector.hpp"
+
+#include "chassis_displacement_observer_interface.hpp"
+#include "chassis_imu_observer_interface.hpp"
+
+namespace tap::algorithms::odometry
+{
+Odometry2DEkf::Odometry2DEkf(
+    ChassisImuObserverInterface* chassisImuObserver,
+    ChassisDisplacementObserverInterface* chassisDisplacementObserver)
+    : Odometry2DEkf(chassisImuObserver, chassisDisplacementObserver, Config())
+{
+}
+
+Odometry2DEkf::Odometry2DEkf(
+    ChassisImuObserverInterface* chassisImuObserver,
+    ChassisDisplacementObserverInterface* chassisDisplacementObserver,
+    const Config& config)
+    : chassisImuObserver(chassisImuObserver),
+      chassisDisplacementObserver(chassisDisplacementObserver),
+      config(config)
+{
+    F.constructIdentityMatrix();
+    Q.data.fill(0.0f);
+    reset();
+}
+
+void Odometry2DEkf::reset(const modm::Location2D<float>& location)
+{
+    x.data.fill(0.0f);
+    x.data[X] = location.getX();
+    x.data[Y] = location.getY();
+    x.data[YAW] = location.getOrientation();
+
+    P.data.fill(0.0f);
+    P.data[VX * STATES + VX] = config.initialVelocityStd * config.initialVelocityStd;
+    P.data[VY * STATES + VY] = config.initialVelocityStd * config.initialVelocityStd;
+    P.data[YAW * STATES + YAW] = config.initialYawStd * config.initialYawStd;
+    P.data[GYRO_BIAS * STATES + GYRO_BIAS] = config.initialBiasStd * config.initialBiasStd;
+
+    primed = false;
+    wheelSlipping = false;
+    wheelSlipTime = 0;
+    wheelSlipCount = 0;
+}
+
+void Odometry2DEkf::update()
+{
+    float yawRate;
+    modm::Vector2f acceleration;
+    modm::Vector3f chassisVelocity;
+    modm::Vector3f chassisAbsoluteDisplacement;
+
+    const bool validImuAvailable = chassisImuObserver->getChassisImu(&yawRate, &acceleration);
+    const bool validDisplacementAvailable =
+        chassisDisplacementObserver->getVelocityChassisDisplacement(
+            &chassisVelocity,
+            &chassisAbsoluteDisplacement);
+
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+    if (!primed)
+    {
+        // The first update only marks the start of the first time step
+        primed = true;
+        lastComputedOdometryTime = time;
+        return;
+    }
+
+    const float dt = (time - lastComputedOdometryTime) / 1'000'000.0f;
+    if (dt <= 0.0f)
+    {
+        return;
+    }
+
+    if (!validImuAvailable)
+    {
+        // Hold yaw and velocity, the process noise still grows the covariance
+        yawRate = x.data[GYRO_BIAS];
+        acceleration = modm::Vector2f(0, 0);
+    }
+    predict(dt, yawRate, acceleration);
+
+    if (validDisplacementAvailable)
+    {
+        correctWithWheelVelocity(modm::Vector2f(chassisVelocity.x, chassisVelocity.y), dt);
+    }
+
+    lastComputedOdometryTime = time;
+}
+
+void Odometry2DEkf::predict(float dt, float yawRate, const modm::Vector2f& acceleration)
+{
+    const float c = cosf(x.data[YAW]);
+    const float s = sinf(x.data[YAW]);
+    const float ax = c * acceleration.x - s * acceleration.y;
+    const float ay = s * acceleration.x + c * acceleration.y;
+    const float halfDtSquared = 0.5f * dt * dt;
+
+    x.data[X] += x.data[VX] * dt + ax * halfDtSquared;
+    x.data[Y] += x.data[VY] * dt + ay * halfDtSquared;
+    x.data[VX] += ax * dt;
+    x.data[VY] += ay * dt;
+    x.data[YAW] = modm::Angle::normalize(x.data[YAW] + (yawRate - x.data[GYRO_BIAS]) * dt);
+
+    // Rotating the acceleration into the reference frame couples the yaw into the velocity and
+    // position. The rest of F is the identity.
+    F.data[X * STATES + VX] = dt;
+    F.data[Y * STATES + VY] = dt;
+    F.data[X * STATES + YAW] = -ay * halfDtSquared;
+    F.data[Y * STATES + YAW] = ax * halfDtSquared;
+    F.data[VX * STATES + YAW] = -ay * dt;
+    F.data[VY * STATES + YAW] = ax * dt;
+    F.data[YAW * STATES + GYRO_BIAS] = -dt;
+
+    // White acceleration noise integrated into velocity and position
+    const float accelVariance = config.accelNoise * config.accelNoise;
+    const float positionVariance = accelVariance * dt * dt * dt / 3.0f;
+    const float positionVelocityCovariance = accelVariance * halfDtSquared;
+    const float velocityVariance = accelVariance * dt;
+    for (uint16_t i = 0; i < 2; i++)
+    {
+        Q.data[(X + i) * STATES + X + i] = positionVariance;
+        Q.data[(X + i) * STATES + VX + i] = positionVelocityCovariance;
+        Q.data[(VX + i) * STATES + X + i] = positionVelocityCovariance;
+        Q.data[(VX + i) * STATES + VX + i] = velocityVariance;
+    }
+    Q.data[YAW * STATES + YAW] = config.gyroNoise * config.gyroNoise * dt;
+    Q.data[GYRO_BIAS * STATES + GYRO_BIAS] =
+        config.gyroBiasRandomWalk * config.gyroBiasRandomWalk * dt;
+
+    // P = F * P * Ft + Q
+    multiply(F, P, FP);
+    mulTransposedAdd(FP, F, Q, P);
+    symmetrize(P);
+}
+
+void Odometry2DEkf::correctWithWheelVelocity(const modm::Vector2f& velocity, float dt)
+{
+    const float c = cosf(x.data[YAW]);
+    const float s = sinf(x.data[YAW]);
+    // Velocity in the chassis frame as predicted by the state
+    const float vx = c * x.data[VX] + s * x.data[VY];
+    const float vy = -s * x.data[VX] + c * x.data[VY];
+
+    // clang-format off
+    CMSISMat<2, STATES> H({
+        0.0f, 0.0f, c,    s,    vy,  0.0f,
+        0.0f, 0.0f, -s,   c,    -vx, 0.0f,
+    });
+    // clang-format on
+    CMSISMat<2, 1> residual({velocity.x - vx, velocity.y - vy});
+
+    // Once slip has lasted longer than it plausibly could, trust the wheels over the IMU again
+    const float gate = wheelSlipTime < config.maxSlipTime ? config.slipGate : 0.0f;
+    const float variance = config.wheelVelocityNoise * config.wheelVelocityNoise;
+    if (correct(H, residual, variance, gate))
+    {
+        wheelSlipping = false;
+        wheelSlipTime = 0;
+    }
+    else
+    {
+        if (!wheelSlipping)
+        {
+            wheelSlipCount++;
+        }
+        wheelSlipping = true;
+        wheelSlipTime += dt;
+    }
+}
+
+bool Odometry2DEkf::correctWithAbsolutePosition(const modm::Vector2f& position, float std)
+{
+    // clang-format off
+    CMSISMat<2, STATES> H({
+        1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    });
+    // clang-format on
+    CMSISMat<2, 1> residual({position.x - x.data[X], position.y - x.data[Y]});
+
+    return correct(H, residual, std * std, config.absoluteFixGate);
+}
+
+bool Odometry2DEkf::correctWithAbsoluteYaw(float yaw, float std)
+{
+    CMSISMat<1, STATES> H({0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f});
+    CMSISMat<1, 1> residual({modm::Angle::normalize(yaw - x.data[YAW])});
+
+    return correct(H, residual, std * std, config.absoluteFixGate);
+}
+
+modm::Location2D<float> Odometry2DEkf::getCurrentLocation2D() const
+{
+    return modm::Location2D<float>(x.data[X], x.data[Y], x.data[YAW]);
+}
+
+modm::Vector2f Odometry2DEkf::getCurrentVelocity2D() const
+{
+    return modm::Vector2f(x.data[VX], x.data[VY]);
+}
+
+template <uint16_t MEASUREMENTS>
+bool Odometry2DEkf::correct(
+    const CMSISMat<MEASUREMENTS, STATES>& H,
+    const CMSISMat<MEASUREMENTS, 1>& residual,
+    float variance,
+    float gate)
+{
+    // S = H * P * Ht + R, factored in place
+    CMSISMat<STATES, MEASUREMENTS> PHt;
+    mulTransposed(P, H, PHt);
+    CMSISMat<MEASUREMENTS, MEASUREMENTS> S;
+    multiply(H, PHt, S);
+    for (uint16_t i = 0; i < MEASUREMENTS; i++)
+    {
+        S.data[i * MEASUREMENTS + i] += variance;
+    }
+    if (!choleskyDecompose(S, S))
+    {
+        return false;
+    }
+
+    if (gate > 0.0f)
+    {
+        // Normalized innovation squared, residual^T * S^-1 * residual
+        CMSISMat<1, MEASUREMENTS> weighted;
+        weighted.data = residual.data;
+        choleskySolve(S, weighted, weighted);
+        float nis = 0.0f;
+        for (uint16_t i = 0; i < MEASUREMENTS; i++)
+        {
+            nis += weighted.data[i] * residual.data[i];
+        }
+        if (nis > gate)
+        {
+            return false;
+        }
+    }
+
+    // K = P * Ht * S^-1
+    CMSISMat<STATES, MEASUREMENTS> K;
+    choleskySolve(S, PHt, K);
+
+    mulAdd(K, residual, x, x);
+    x.data[YAW] = modm::Angle::normalize(x.data[YAW]);
+
+    // P = P - K * (P * Ht)^T
+    mulTransposedAdd(K, PHt, P, P, -1.0f);
+    symmetrize(P);
+    return true;
+}
+
+}  // namespace tap::algorithms::odometry
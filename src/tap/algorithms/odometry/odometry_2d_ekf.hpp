@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ODOMETRY_2D_EKF_HPP_
+#define TAPROOT_ODOMETRY_2D_EKF_HPP_
+
+#include <cstdint>
+
+#include "tap/algorithms/cmsis_mat.hpp"
+
+#include "modm/math/geometry/location_2d.hpp"
+
+#include "odometry_2d_interface.hpp"
+
+namespace tap::algorithms::odometry
+{
+// Forward declarations
+class ChassisImuObserverInterface;
+class ChassisDisplacementObserverInterface;
+
+/**
+ * Tracks the 2D position of a chassis with an extended Kalman filter (EKF) that fuses wheel
+ * odometry, an IMU, and optional absolute position and yaw fixes.
+ *
+ * The state is the position and velocity of the chassis in the reference frame, its yaw, and the
+ * bias of the yaw rate gyroscope. Each `update()` integrates the IMU's yaw rate and acceleration
+ * and corrects the velocity with the chassis velocity measured by the wheels.
+ *
+ * Unlike `Odometry2DTracker`, wheel measurements are checked against the prediction before they
+ * are used. A wheel velocity whose normalized innovation squared exceeds `Config::slipGate` is
+ * treated as wheel slip, for example when the robot is pushed or its wheels spin after a
+ * collision, and is skipped so position is carried by the IMU until the wheels agree again. If
+ * the wheels disagree for longer than `Config::maxSlipTime`, the IMU is assumed to have drifted
+ * instead and the wheels are used again.
+ *
+ * Absolute fixes, such as from vision or UWB, may be applied at any time with
+ * `correctWithAbsolutePosition` and `correctWithAbsoluteYaw`.
+ *
+ * All matrices are fixed size `CMSISMat`s, so updates don't allocate.
+ */
+class Odometry2DEkf : public Odometry2DInterface
+{
+public:
+    /// x, y, x velocity, y velocity, yaw, gyroscope bias
+    static constexpr uint16_t STATES = 6;
+
+    struct Config
+    {
+        /// Accelerometer white noise density, in m/s^2/sqrt(Hz).
+        float accelNoise = 0.5f;
+        /// Gyroscope white noise density, in rad/s/sqrt(Hz).
+        float gyroNoise = 0.01f;
+        /// Gyroscope bias random walk, in rad/s^2/sqrt(Hz).
+        float gyroBiasRandomWalk = 1.0e-4f;
+        /// Standard deviation of each component of the wheel velocity, in m/s.
+        float wheelVelocityNoise = 0.05f;
+        /**
+         * Largest normalized innovation squared of a wheel velocity that is not treated as slip.
+         * The default rejects 1% of wheel velocities that agree with the prediction, the 99th
+         * percentile of a chi-squared distribution with 2 degrees of freedom.
+         */
+        float slipGate = 9.21f;
+        /// Longest time wheel velocities are skipped as slip, in seconds.
+        float maxSlipTime = 0.5f;
+        /// Like `slipGate` for absolute fixes. 0 applies every fix.
+        float absoluteFixGate = 0.0f;
+        /// Initial standard deviation of each component of the velocity, in m/s.
+        float initialVelocityStd = 1.0f;
+        /// Initial standard deviation of the yaw, in radians.
+        float initialYawStd = 0.01f;
+        /// Initial standard deviation of the gyroscope bias, in rad/s.
+        float initialBiasStd = 0.01f;
+    };
+
+    /**
+     * @param[in] chassisImuObserver Used for getting the chassis yaw rate and acceleration.
+     * @param[in] chassisDisplacementObserver Used for getting the chassis velocity, in m/s.
+     */
+    Odometry2DEkf(
+        ChassisImuObserverInterface* chassisImuObserver,
+        ChassisDisplacementObserverInterface* chassisDisplacementObserver);
+
+    Odometry2DEkf(
+        ChassisImuObserverInterface* chassisImuObserver,
+        ChassisDisplacementObserverInterface* chassisDisplacementObserver,
+        const Config& config);
+
+    /**
+     * Resets the estimate to `location`, known with certainty, at rest, and the gyroscope bias to
+     * 0.
+     */
+    void reset(const modm::Location2D<float>& location = modm::Location2D<float>());
+
+    /**
+     * Run logic and update tracked chassis position. Call frequently for better
+     * results.
+     */
+    void update();
+
+    /**
+     * Corrects the estimate with a measurement of the chassis position in the reference frame.
+     *
+     * @param[in] std The standard deviation of each component of the measurement, in m.
+     * @return `true` if the fix was applied, `false` if it was rejected by
+     *      `Config::absoluteFixGate`.
+     */
+    bool correctWithAbsolutePosition(const modm::Vector2f& position, float std);
+
+    /**
+     * Corrects the estimate with a measurement of the chassis yaw in the reference frame.
+     *
+     * @param[in] std The standard deviation of the measurement, in radians.
+     * @return `true` if the fix was applied, `false` if it was rejected by
+     *      `Config::absoluteFixGate`.
+     */
+    bool correctWithAbsoluteYaw(float yaw, float std);
+
+    modm::Location2D<float> getCurrentLocation2D() const final;
+
+    modm::Vector2f getCurrentVelocity2D() const final;
+
+    float getYaw() const final { return x.data[YAW]; }
+
+    uint32_t getLastComputedOdometryTime() const final { return lastComputedOdometryTime; }
+
+    /// @return The estimated gyroscope bias, in rad/s.
+    float getGyroBias() const { return x.data[GYRO_BIAS]; }
+
+    /// @return `true` if the last wheel velocity was skipped as slip.
+    bool isWheelSlipping() const { return wheelSlipping; }
+
+    /// @return The number of times wheel slip was detected since the last reset.
+    uint32_t getWheelSlipCount() const { return wheelSlipCount; }
+
+    /// @return The state covariance, in the order of `STATES`.
+    const CMSISMat<STATES, STATES>& getCovariance() const { return P; }
+
+private:
+    enum StateIndex : uint16_t
+    {
+        X = 0,
+        Y,
+        VX,
+        VY,
+        YAW,
+        GYRO_BIAS,
+    };
+
+    ChassisImuObserverInterface* chassisImuObserver;
+    ChassisDisplacementObserverInterface* chassisDisplacementObserver;
+    Config config;
+
+    CMSISMat<STATES, 1> x;
+    CMSISMat<STATES, STATES> P;
+    /// State transition matrix, only the elements that depend on the time step change.
+    CMSISMat<STATES, STATES> F;
+    CMSISMat<STATES, STATES> Q;
+    CMSISMat<STATES, STATES> FP;
+
+    // last time (in microseconds) that the odometry was computed
+    uint32_t lastComputedOdometryTime = 0;
+    bool primed = false;
+
+    bool wheelSlipping = false;
+    float wheelSlipTime = 0;
+    uint32_t wheelSlipCount = 0;
+
+    void predict(float dt, float yawRate, const modm::Vector2f& acceleration);
+
+    void correctWithWheelVelocity(const modm::Vector2f& velocity, float dt);
+
+    /**
+     * Applies a measurement with residual `residual`, observation matrix `H`, and independent
+     * errors of variance `variance`.
+     *
+     * @return `false` if the normalized innovation squared exceeds `gate` and the measurement
+     *      was skipped. A `gate` of 0 applies every measurement.
+     */
+    template <uint16_t MEASUREMENTS>
+    bool correct(
+        const CMSISMat<MEASUREMENTS, STATES>& H,
+        const CMSISMat<MEASUREMENTS, 1>& residual,
+        float variance,
+        float gate);
+};
+
+}  // namespace tap::algorithms::odometry
+
+#endif  // TAPROOT_ODOMETRY_2D_EKF_HPP_
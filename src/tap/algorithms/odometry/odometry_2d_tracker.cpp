@@ -42,6 +42,8 @@ void Odometry2DTracker::update()
 
     if (validDisplacementAvailable)
     {
+        const uint32_t now = tap::arch::clock::getTimeMicroseconds();
+
         if (!displacementPrimed)
         {
             // if this is first time valid displacement data was available we skip main logic
@@ -68,12 +70,28 @@ void Odometry2DTracker::update()
                 chassisYaw);
             velocity.setX(vel[0][0]);
             velocity.setY(vel[1][0]);
+
+            poseHistory.push(now, location);
         }
 
         prevChassisAbsoluteDisplacement = chassisAbsoluteDisplacement;
 
-        lastComputedOdometryTime = tap::arch::clock::getTimeMicroseconds();
+        lastComputedOdometryTime = now;
+    }
+}
+
+bool Odometry2DTracker::correctPositionAt(uint32_t time, const modm::Vector2f &position)
+{
+    modm::Location2D<float> past;
+    if (!poseHistory.getLocationAt(time, &past))
+    {
+        return false;
     }
+
+    const modm::Vector2f correction = position - past.getPosition();
+    poseHistory.translateFrom(time, correction.x, correction.y);
+    location.setPosition(location.getPosition() + correction);
+    return true;
 }
 
 }  // namespace tap::algorithms::odometry
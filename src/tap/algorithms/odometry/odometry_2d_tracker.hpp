@@ -23,6 +23,7 @@
 #include "modm/math/geometry/location_2d.hpp"
 
 #include "odometry_2d_interface.hpp"
+#include "pose_history.hpp"
 
 namespace tap::algorithms::odometry
 {
@@ -34,10 +35,17 @@ class ChassisDisplacementObserverInterface;
  * Class for tracking the 2D position of an object over time.
  *
  * The faster update() is called the better.
+ *
+ * Each update is also recorded in a pose history, so the pose at a past time (such as the
+ * exposure time of a camera frame) can be looked up with getLocationAt(), and an absolute
+ * position measured at a past time can be applied with correctPositionAt().
  */
 class Odometry2DTracker : public Odometry2DInterface
 {
 public:
+    /// The number of poses kept in the history. At 500 Hz, 64 poses cover 128 ms.
+    static constexpr int POSE_HISTORY_SIZE = 64;
+
     /**
      * @param[in] chassisYawObserver pointer to an object which implements the
      *      ChassisWorldYawObserverInterface. Should return the angle of the chassis
@@ -75,6 +83,36 @@ class Odometry2DTracker : public Odometry2DInterface
 
     inline uint32_t getLastComputedOdometryTime() const final { return lastComputedOdometryTime; }
 
+    /**
+     * Computes the odometry frame at a past time, interpolated between the poses computed by
+     * update() on either side of it.
+     *
+     * @param[in] time The time to look up, in microseconds.
+     * @param[out] location The location at `time`.
+     * @return `false` if `time` is older than the history, in which case `location` is
+     *      unchanged.
+     */
+    inline bool getLocationAt(uint32_t time, modm::Location2D<float> *location) const
+    {
+        return poseHistory.getLocationAt(time, location);
+    }
+
+    /**
+     * Applies an absolute position measured at a past time, such as by vision-based
+     * relocalization. The difference between `position` and the tracked position at `time` is
+     * added to the current location and to every pose in the history since `time`, so later
+     * poses keep their relative motion without being recomputed. Orientation isn't corrected
+     * since it always comes from the chassis yaw observer.
+     *
+     * @param[in] time The time `position` was measured at, in microseconds.
+     * @param[in] position The measured position in the reference frame.
+     * @return `false` if `time` is older than the history, in which case nothing is changed.
+     */
+    bool correctPositionAt(uint32_t time, const modm::Vector2f &position);
+
+    /// @return The pose history, for looking up poses at past times.
+    inline const PoseHistory<POSE_HISTORY_SIZE> &getPoseHistory() const { return poseHistory; }
+
 private:
     ChassisWorldYawObserverInterface* chassisYawObserver;
     ChassisDisplacementObserverInterface* chassisDisplacementObserver;
@@ -90,6 +128,8 @@ class Odometry2DTracker : public Odometry2DInterface
     uint32_t lastComputedOdometryTime = 0;
     // `true` iff `this` has been updated with valid chassis data at least once.
     bool displacementPrimed = false;
+    // Poses computed by update(), for looking up and correcting past poses
+    PoseHistory<POSE_HISTORY_SIZE> poseHistory;
 };
 
 }  // namespace tap::algorithms::odometry
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_POSE_HISTORY_HPP_
+#define TAPROOT_POSE_HISTORY_HPP_
+
+#include <cstdint>
+
+#include "tap/algorithms/timestamped_history.hpp"
+
+#include "modm/math/geometry/angle.hpp"
+#include "modm/math/geometry/location_2d.hpp"
+
+namespace tap::algorithms::odometry
+{
+/**
+ * A fixed size ring of timestamped 2D poses, for looking up where the chassis was at a past
+ * time, such as the exposure time of a camera frame, to compensate for latency. The pose
+ * counterpart of `AttitudeHistory`.
+ *
+ * Entries must be pushed in order of time. Lookups between two entries interpolate them, and
+ * lookups of times after the newest entry return the newest entry. Not safe to push from an
+ * interrupt while reading from the main loop. See `TimestampedHistory`.
+ *
+ * @tparam CAPACITY The number of entries kept, must be a power of two. At 500 Hz, 64 entries
+ *      cover 128 ms.
+ */
+template <int CAPACITY>
+class PoseHistory
+{
+public:
+    /**
+     * Adds an entry. An entry whose time isn't after the newest entry's replaces the newest
+     * entry instead.
+     *
+     * @param[in] time The time of the pose, in microseconds.
+     * @param[in] location The pose, orientation in radians.
+     */
+    void push(uint32_t time, const modm::Location2D<float> &location)
+    {
+        Entry &entry = history.push(time);
+        entry.x = location.getX();
+        entry.y = location.getY();
+        entry.yaw = location.getOrientation();
+    }
+
+    void clear() { history.clear(); }
+
+    /// @return The number of entries.
+    int size() const { return history.size(); }
+
+    /// @return The time of the oldest entry, in microseconds, or 0 if there are none.
+    uint32_t getOldestTime() const { return history.getOldestTime(); }
+
+    /// @return The time of the newest entry, in microseconds, or 0 if there are none.
+    uint32_t getNewestTime() const { return history.getNewestTime(); }
+
+    /**
+     * Computes the pose at `time`, linearly interpolating the position and the orientation
+     * (along the shorter way around) between the entries on either side of it.
+     *
+     * @return `false` if there are no entries or `time` is before the oldest entry, in which
+     *      case `location` is unchanged.
+     */
+    bool getLocationAt(uint32_t time, modm::Location2D<float> *location) const
+    {
+        int older;
+        float t;
+        if (!history.find(time, older, t))
+        {
+            return false;
+        }
+
+        const Entry &a = history.at(older);
+        const Entry &b = older == 0 ? a : history.at(older - 1);
+        const float dYaw = modm::Angle::normalize(b.yaw - a.yaw);
+        location->setPosition(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+        location->setOrientation(modm::Angle::normalize(a.yaw + t * dYaw));
+        return true;
+    }
+
+    /**
+     * Translates every entry from the one at or before `time` up to the newest by
+     * `(dx, dy)`, which applies a position correction measured at `time` to the rest of the
+     * history without recomputing it. Costs one addition per entry newer than `time`.
+     *
+     * @return `false` if there are no entries or `time` is before the oldest entry, in which
+     *      case nothing is changed.
+     */
+    bool translateFrom(uint32_t time, float dx, float dy)
+    {
+        int older;
+        float t;
+        if (!history.find(time, older, t))
+        {
+            return false;
+        }
+
+        for (int age = 0; age <= older; age++)
+        {
+            Entry &entry = history.at(age);
+            entry.x += dx;
+            entry.y += dy;
+        }
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        uint32_t time;
+        float x;
+        float y;
+        float yaw;
+    };
+
+    TimestampedHistory<Entry, CAPACITY> history;
+};  // class PoseHistory
+
+}  // namespace tap::algorithms::odometry
+
+#endif  // TAPROOT_POSE_HISTORY_HPP_
@@ -34,6 +34,8 @@ namespace algorithms
  * setting the increment at the beginning, you set the increment each time,
  * which allows you to take into account systems where time increment is not
  * constant.
+ *
+ * @see SmoothRamp, which takes a rate per second and can limit acceleration and jerk.
  */
 class Ramp
 {
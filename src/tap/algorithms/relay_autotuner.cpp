@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "relay_autotuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tap::algorithms
+{
+void RelayAutotuner::start(float setpoint, uint32_t time)
+{
+    this->setpoint = setpoint;
+    state = State::RUNNING;
+    startTime = time;
+    // If the measurement starts above the setpoint, the first update switches the relay low
+    relayHigh = true;
+    cycles = -1;
+    amplitudeSum = 0;
+    periodSum = 0;
+    ultimateGain = 0;
+    ultimatePeriod = 0;
+    numSamples = 0;
+    nextRecordTime = time;
+}
+
+float RelayAutotuner::update(float measurement, uint32_t time)
+{
+    if (state != State::RUNNING)
+    {
+        return config.outputBias;
+    }
+
+    if (time - startTime > config.timeout)
+    {
+        state = State::FAILED;
+        return config.outputBias;
+    }
+
+    cycleMax = std::max(cycleMax, measurement);
+    cycleMin = std::min(cycleMin, measurement);
+
+    const float error = setpoint - measurement;
+    if (relayHigh && error < -config.hysteresis)
+    {
+        relayHigh = false;
+    }
+    else if (!relayHigh && error > config.hysteresis)
+    {
+        relayHigh = true;
+        completeCycle(time);
+        cycleMax = measurement;
+        cycleMin = measurement;
+    }
+
+    const float output =
+        config.outputBias + (relayHigh ? config.relayAmplitude : -config.relayAmplitude);
+
+    if (numSamples < MAX_SAMPLES && static_cast<int32_t>(time - nextRecordTime) >= 0)
+    {
+        samples[numSamples++] = {time - startTime, measurement, output};
+        nextRecordTime = time + config.recordPeriod;
+    }
+
+    return state == State::RUNNING ? output : config.outputBias;
+}
+
+void RelayAutotuner::completeCycle(uint32_t time)
+{
+    // The first switch high starts the first cycle
+    if (cycles >= config.settlingCycles)
+    {
+        amplitudeSum += (cycleMax - cycleMin) / 2;
+        periodSum += (time - cycleStartTime) / 1e6f;
+    }
+    cycles++;
+    cycleStartTime = time;
+
+    if (cycles == config.settlingCycles + config.measuredCycles)
+    {
+        finish();
+    }
+}
+
+void RelayAutotuner::finish()
+{
+    const float amplitude = amplitudeSum / std::max(config.measuredCycles, 1);
+    if (amplitude <= config.hysteresis)
+    {
+        state = State::FAILED;
+        return;
+    }
+
+    ultimateGain = 4 * config.relayAmplitude /
+                   (M_PI * sqrtf(amplitude * amplitude - config.hysteresis * config.hysteresis));
+    ultimatePeriod = periodSum / std::max(config.measuredCycles, 1);
+    state = State::DONE;
+}
+
+PidGains RelayAutotuner::computeGains(TuningRule rule) const
+{
+    if (state != State::DONE)
+    {
+        return {};
+    }
+
+    const float ku = ultimateGain;
+    const float tu = ultimatePeriod;
+    float kc, ti, td;
+    switch (rule)
+    {
+        case TuningRule::ZIEGLER_NICHOLS:
+            kc = 0.6f * ku;
+            ti = tu / 2;
+            td = tu / 8;
+            break;
+        case TuningRule::TYREUS_LUYBEN:
+            kc = ku / 2.2f;
+            ti = 2.2f * tu;
+            td = tu / 6.3f;
+            break;
+        case TuningRule::NO_OVERSHOOT:
+            kc = 0.2f * ku;
+            ti = tu / 2;
+            td = tu / 3;
+            break;
+        case TuningRule::SIMC_PI:
+        default:
+            kc = ku / static_cast<float>(M_PI);
+            ti = 2 * tu;
+            td = 0;
+            break;
+    }
+    return {kc, kc / ti, kc * td};
+}
+}  // namespace tap::algorithms
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_RELAY_AUTOTUNER_HPP_
+#define TAPROOT_RELAY_AUTOTUNER_HPP_
+
+#include <cstdint>
+
+namespace tap::algorithms
+{
+struct RelayAutotunerConfig
+{
+    /// Output that holds the process near the setpoint, which the relay switches around.
+    float outputBias = 0.0f;
+    /// The relay switches between `outputBias + relayAmplitude` and `outputBias - relayAmplitude`.
+    float relayAmplitude = 0.0f;
+    /// The relay only switches once the error crosses +/- this, so noise doesn't chatter it.
+    float hysteresis = 0.0f;
+    /// Oscillation cycles ignored while the oscillation settles.
+    int settlingCycles = 2;
+    /// Oscillation cycles averaged into the result after settling.
+    int measuredCycles = 4;
+    /// The identification fails if it hasn't finished after this long, in microseconds.
+    uint32_t timeout = 10'000'000;
+    /// Period at which the response is recorded, in microseconds.
+    uint32_t recordPeriod = 10'000;
+};
+
+/// Continuous PID gains, for a controller whose `dt` is in seconds, such as `SmoothPid`.
+struct PidGains
+{
+    float kp = 0.0f;
+    float ki = 0.0f;
+    float kd = 0.0f;
+};
+
+/**
+ * Rules that turn the ultimate gain `Ku` and period `Tu` measured by a `RelayAutotuner` into PID
+ * gains. Each sets `kp = Kc`, `ki = Kc / Ti` and `kd = Kc * Td`.
+ */
+enum class TuningRule
+{
+    /// `Kc = 0.6 Ku`, `Ti = Tu / 2`, `Td = Tu / 8`. Fast, with about 25% overshoot.
+    ZIEGLER_NICHOLS,
+    /// `Kc = Ku / 2.2`, `Ti = 2.2 Tu`, `Td = Tu / 6.3`. Slower and far more robust.
+    TYREUS_LUYBEN,
+    /// `Kc = 0.2 Ku`, `Ti = Tu / 2`, `Td = Tu / 3`. Ziegler-Nichols tuned for no overshoot.
+    NO_OVERSHOOT,
+    /**
+     * SIMC PI tuning with the closed loop time constant equal to the delay, `Kc = Ku / pi`,
+     * `Ti = 2 Tu`. Treats the process as an integrator with delay, which fits motor position
+     * loops and lag-dominant loops such as flywheel velocity, where the relay oscillates with
+     * `Tu = 4 * delay`.
+     */
+    SIMC_PI,
+};
+
+/**
+ * Identifies a process with the relay feedback experiment of Astrom and Hagglund, to tune its
+ * PID controller. While running, `update` returns a relay's output, which switches between two
+ * levels whenever the measurement crosses the setpoint. For most processes, this drives the
+ * measurement into a steady oscillation at the ultimate period `Tu`, the period at which the
+ * loop's phase lag is 180 degrees. From the amplitude `a` of the oscillation and the relay
+ * amplitude `d`, the describing function of the relay gives the ultimate gain, the proportional
+ * gain at which the closed loop would oscillate, `Ku = 4 d / (pi * sqrt(a^2 - e^2))`, with `e`
+ * the hysteresis. `computeGains` then applies a tuning rule.
+ *
+ * The response is recorded into a fixed size buffer, `getSamples`, for inspection. Unlike a
+ * step response test, the relay keeps the process near the setpoint, with an amplitude set by
+ * the relay amplitude, so it is safe to run on a mechanism with limited travel.
+ */
+class RelayAutotuner
+{
+public:
+    static constexpr int MAX_SAMPLES = 512;
+
+    enum class State : uint8_t
+    {
+        IDLE,
+        RUNNING,
+        /// The ultimate gain and period are measured.
+        DONE,
+        /// Timed out before the oscillation settled.
+        FAILED,
+    };
+
+    struct Sample
+    {
+        /// Microseconds since `start`.
+        uint32_t time;
+        float measurement;
+        float output;
+    };
+
+    explicit RelayAutotuner(const RelayAutotunerConfig &config) : config(config) {}
+
+    void setConfig(const RelayAutotunerConfig &config) { this->config = config; }
+
+    /**
+     * Starts the experiment, clearing the previous result and recording.
+     *
+     * @param[in] setpoint The measurement to oscillate around.
+     * @param[in] time The current time, in microseconds.
+     */
+    void start(float setpoint, uint32_t time);
+
+    /**
+     * @param[in] measurement The process' current measurement.
+     * @param[in] time The current time, in microseconds.
+     * @return The output to apply, `outputBias` once the experiment is done or failed.
+     */
+    float update(float measurement, uint32_t time);
+
+    State getState() const { return state; }
+
+    /// @return The ultimate gain, valid once the state is `DONE`.
+    float getUltimateGain() const { return ultimateGain; }
+
+    /// @return The ultimate period in seconds, valid once the state is `DONE`.
+    float getUltimatePeriod() const { return ultimatePeriod; }
+
+    /// @return Gains for the measured process, all 0 unless the state is `DONE`.
+    PidGains computeGains(TuningRule rule) const;
+
+    const Sample *getSamples() const { return samples; }
+
+    int getNumSamples() const { return numSamples; }
+
+private:
+    RelayAutotunerConfig config;
+
+    State state = State::IDLE;
+    float setpoint = 0;
+    uint32_t startTime = 0;
+    bool relayHigh = true;
+
+    /// Extremes of the measurement since the relay last switched high.
+    float cycleMax = 0;
+    float cycleMin = 0;
+    uint32_t cycleStartTime = 0;
+    /// Cycles completed, including the settling cycles. Negative until the first switch high.
+    int cycles = -1;
+
+    float amplitudeSum = 0;
+    float periodSum = 0;
+
+    float ultimateGain = 0;
+    float ultimatePeriod = 0;
+
+    Sample samples[MAX_SAMPLES];
+    int numSamples = 0;
+    uint32_t nextRecordTime = 0;
+
+    /// Ends a cycle at the relay switching high.
+    void completeCycle(uint32_t time);
+
+    void finish();
+};
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_RELAY_AUTOTUNER_HPP_
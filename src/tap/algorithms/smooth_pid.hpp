@@ -78,6 +78,10 @@ class SmoothPid
     inline void setMaxOutput(float maxOutput) { config.maxOutput = maxOutput; }
     inline void setErrDeadzone(float errDeadzone) { config.errDeadzone = errDeadzone; }
 
+    inline float getP() const { return config.kp; }
+    inline float getI() const { return config.ki; }
+    inline float getD() const { return config.kd; }
+
 private:
     // gains and constants, to be set by the user
     SmoothPidConfig config;
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SMOOTH_PID_BANK_HPP_
+#define TAPROOT_SMOOTH_PID_BANK_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+#include "smooth_pid.hpp"
+
+namespace tap
+{
+namespace algorithms
+{
+struct SmoothPidBankConfig
+{
+    /// How the derivative of the error is smoothed.
+    enum class DerivativeFilter : uint8_t
+    {
+        /// The scalar kalman filter `SmoothPid` uses, with `tQDerivativeKalman` and
+        /// `tRDerivativeKalman`.
+        KALMAN,
+        /// Two cascaded first order low pass filters with a cutoff of
+        /// `derivativeCutoffFrequency`, which roll off noise at 40 dB per decade.
+        SECOND_ORDER,
+    };
+
+    SmoothPidConfig pid;
+    float kf = 0.0f;                /**< Feed-forward gain, applied to the setpoint. */
+    float setpointWeightP = 1.0f;   /**< The fraction of the setpoint the proportional term acts
+                                     * on. Below 1, a setpoint step kicks the output less. */
+    float setpointWeightD = 1.0f;   /**< The fraction of the setpoint the derivative term acts on.
+                                     * At 0, the derivative term ignores setpoint steps. */
+    DerivativeFilter derivativeFilter = DerivativeFilter::KALMAN;
+    float derivativeCutoffFrequency = 0.0f; /**< In Hz, for `DerivativeFilter::SECOND_ORDER`. */
+};
+
+/**
+ * `N` identically configured `SmoothPid` controllers, such as the four wheel speed controllers
+ * of a mecanum chassis, run together in one call.
+ *
+ * The state of all controllers is stored as one array per variable, so a control loop is a single
+ * pass over contiguous arrays rather than `N` virtual calls into separately allocated objects.
+ * Since every controller shares the same kalman filter covariances, the covariances evolve
+ * identically, so the filter gains are computed once per call rather than once per controller.
+ *
+ * `runControllers` is identical to calling `SmoothPid::runController` on each controller.
+ * `runControllersToSetpoint` adds feed-forward and setpoint weighting, and with the default
+ * weights and no feed-forward is identical to `SmoothPid::runControllerDerivateError`.
+ *
+ * @tparam N The number of controllers.
+ */
+template <int N>
+class SmoothPidBank
+{
+public:
+    static_assert(N > 0, "SmoothPidBank must have at least one controller");
+
+    SmoothPidBank(const SmoothPidBankConfig &config) : config(config) { reset(); }
+
+    /**
+     * Runs each controller on its error, like `SmoothPid::runController`.
+     *
+     * @param[in] error The error of each controller.
+     * @param[in] errorDerivative The derivative of each error.
+     * @param[in] dt The time since the controllers were last run.
+     */
+    void runControllers(const float (&error)[N], const float (&errorDerivative)[N], float dt)
+    {
+        run(error, errorDerivative, error, nullptr, dt);
+    }
+
+    /**
+     * Runs each controller on the error between its setpoint and measurement, differentiating
+     * the error itself like `SmoothPid::runControllerDerivateError`. The proportional and
+     * derivative terms act on the setpoint scaled by `setpointWeightP` and `setpointWeightD`,
+     * and `kf` times the setpoint is added to the output.
+     *
+     * @param[in] setpoint The setpoint of each controller.
+     * @param[in] measurement The measured value of each controller.
+     * @param[in] dt The time since the controllers were last run.
+     */
+    void runControllersToSetpoint(
+        const float (&setpoint)[N],
+        const float (&measurement)[N],
+        float dt)
+    {
+        runWeighted(setpoint, measurement, nullptr, dt);
+    }
+
+    /**
+     * Like `runControllersToSetpoint(setpoint, measurement, dt)`, with a further feed-forward term
+     * added to each output, such as gravity compensation.
+     */
+    void runControllersToSetpoint(
+        const float (&setpoint)[N],
+        const float (&measurement)[N],
+        const float (&feedForward)[N],
+        float dt)
+    {
+        runWeighted(setpoint, measurement, feedForward, dt);
+    }
+
+    float getOutput(int controller) const { return output[controller]; }
+
+    const float (&getOutputs() const)[N] { return output; }
+
+    /// Resets every controller. The controllers share filter covariances, so reset together.
+    void reset()
+    {
+        for (int i = 0; i < N; i++)
+        {
+            output[i] = 0.0f;
+            integral[i] = 0.0f;
+            prevError[i] = 0.0f;
+            filteredError[i] = 0.0f;
+            filteredDerivative[i] = 0.0f;
+            derivativeStage[i] = 0.0f;
+        }
+        proportionalCovariance = 0.0f;
+        derivativeCovariance = 0.0f;
+    }
+
+    inline void setP(float p) { config.pid.kp = p; }
+    inline void setI(float i) { config.pid.ki = i; }
+    inline void setD(float d) { config.pid.kd = d; }
+    inline void setF(float f) { config.kf = f; }
+    inline void setMaxICumulative(float maxICumulative)
+    {
+        config.pid.maxICumulative = maxICumulative;
+    }
+    inline void setMaxOutput(float maxOutput) { config.pid.maxOutput = maxOutput; }
+    inline void setErrDeadzone(float errDeadzone) { config.pid.errDeadzone = errDeadzone; }
+
+private:
+    SmoothPidBankConfig config;
+
+    float output[N];
+    float integral[N];
+    float prevError[N];
+    /// The kalman filtered error.
+    float filteredError[N];
+    /// The filtered error derivative, the output of either derivative filter.
+    float filteredDerivative[N];
+    /// The first stage of the second order derivative filter.
+    float derivativeStage[N];
+
+    /// The kalman covariances, shared by every controller.
+    float proportionalCovariance;
+    float derivativeCovariance;
+
+    void runWeighted(
+        const float (&setpoint)[N],
+        const float (&measurement)[N],
+        const float *feedForward,
+        float dt)
+    {
+        if (compareFloatClose(dt, 0.0f, 1E-5))
+        {
+            dt = 1.0f;
+        }
+
+        float error[N];
+        float weightedError[N];
+        float weightedDerivative[N];
+        float feedForwardTerm[N];
+        for (int i = 0; i < N; i++)
+        {
+            error[i] = setpoint[i] - measurement[i];
+            weightedError[i] = config.setpointWeightP * setpoint[i] - measurement[i];
+            const float derivativeError = config.setpointWeightD * setpoint[i] - measurement[i];
+            weightedDerivative[i] = (derivativeError - prevError[i]) / dt;
+            prevError[i] = derivativeError;
+            feedForwardTerm[i] =
+                config.kf * setpoint[i] + (feedForward != nullptr ? feedForward[i] : 0.0f);
+        }
+
+        run(weightedError, weightedDerivative, error, feedForwardTerm, dt);
+    }
+
+    /**
+     * @param[in] proportionalError The error the proportional and integral terms act on.
+     * @param[in] errorDerivative The derivative the derivative term acts on.
+     * @param[in] error The unweighted error, compared to the deadzone and derivative floor.
+     * @param[in] feedForward Added to each output, or `nullptr` for none.
+     */
+    void run(
+        const float (&proportionalError)[N],
+        const float (&errorDerivative)[N],
+        const float (&error)[N],
+        const float *feedForward,
+        float dt)
+    {
+        const SmoothPidConfig &pid = config.pid;
+
+        // The covariance and gain of a kalman filter don't depend on the data
+        const float pMid = proportionalCovariance + pid.tQProportionalKalman;
+        const float proportionalGain = pMid / (pMid + pid.tRProportionalKalman);
+        proportionalCovariance = (1 - proportionalGain) * pMid;
+
+        const bool kalmanDerivative =
+            config.derivativeFilter == SmoothPidBankConfig::DerivativeFilter::KALMAN;
+        float derivativeGain;
+        if (kalmanDerivative)
+        {
+            const float dMid = derivativeCovariance + pid.tQDerivativeKalman;
+            derivativeGain = dMid / (dMid + pid.tRDerivativeKalman);
+            derivativeCovariance = (1 - derivativeGain) * dMid;
+        }
+        else
+        {
+            const float timeConstant =
+                1.0f / (static_cast<float>(M_TWOPI) * config.derivativeCutoffFrequency);
+            derivativeGain = dt / (dt + timeConstant);
+        }
+
+        for (int i = 0; i < N; i++)
+        {
+            const bool inDeadzone = fabsf(error[i]) < pid.errDeadzone;
+            const float p = inDeadzone ? 0.0f : proportionalError[i];
+
+            filteredError[i] += proportionalGain * (p - filteredError[i]);
+            const float currErrorP = pid.kp * filteredError[i];
+            integral[i] = limitVal<float>(
+                integral[i] + pid.ki * filteredError[i] * dt,
+                -pid.maxICumulative,
+                pid.maxICumulative);
+
+            // Both filters are first order stages, the second order filter being two of them
+            float &d = filteredDerivative[i];
+            if (kalmanDerivative)
+            {
+                d += derivativeGain * (errorDerivative[i] - d);
+            }
+            else
+            {
+                derivativeStage[i] += derivativeGain * (errorDerivative[i] - derivativeStage[i]);
+                d += derivativeGain * (derivativeStage[i] - d);
+            }
+            // The derivative floor compares the error after the deadzone, as `SmoothPid` does
+            const float flooredError = inDeadzone ? 0.0f : error[i];
+            const float currErrorD =
+                fabsf(flooredError) < pid.errorDerivativeFloor ? 0.0f : -pid.kd * d;
+
+            const float total = currErrorP + integral[i] + currErrorD;
+            output[i] = limitVal<float>(
+                feedForward != nullptr ? total + feedForward[i] : total,
+                -pid.maxOutput,
+                pid.maxOutput);
+        }
+    }
+};  // class SmoothPidBank
+
+}  // namespace algorithms
+
+}  // namespace tap
+
+#endif  // TAPROOT_SMOOTH_PID_BANK_HPP_
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SMOOTH_RAMP_HPP_
+#define TAPROOT_SMOOTH_RAMP_HPP_
+
+#include <algorithm>
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+namespace tap::algorithms
+{
+struct SmoothRampConfig
+{
+    /// Largest magnitude of the rate the value changes at, in units / s. Must be > 0.
+    float maxRate;
+    /// Largest magnitude of the rate's rate of change, in units / s^2. 0 for no limit.
+    float maxAcceleration = 0.0f;
+    /**
+     * Largest magnitude of the acceleration's rate of change, in units / s^3. 0 for no limit.
+     * Only used with an acceleration limit.
+     */
+    float maxJerk = 0.0f;
+};
+
+namespace detail
+{
+/// @return The largest rate from which the value can stop within `distance`.
+inline float smoothRampStoppingRate(float distance, const SmoothRampConfig &config, float dt)
+{
+    const float a = config.maxAcceleration;
+    const float j = config.maxJerk;
+    if (j <= 0.0f)
+    {
+        // Slowing by a * dt each update stops within v^2 / (2 a) + v dt / 2
+        const float step = a * dt;
+        return step * (sqrtf(0.25f + 2.0f * distance / (step * dt)) - 0.5f);
+    }
+    // The inverse of the S-curve stopping distance, see MotionProfile
+    const float b = a * a / j;
+    const float rate = 0.5f * (-b + sqrtf(b * b + 8.0f * a * distance));
+    return rate >= b ? rate : cbrtf(distance * distance * j);
+}
+
+/// Moves `value` towards `target` for `dt` seconds under the limits of `config`.
+inline void stepSmoothRamp(
+    const SmoothRampConfig &config,
+    float target,
+    float dt,
+    float &value,
+    float &rate,
+    float &acceleration)
+{
+    const float error = target - value;
+    const float previousAcceleration = acceleration;
+    const float maxRate = config.maxRate;
+    const float a = config.maxAcceleration;
+    const float j = config.maxJerk;
+
+    if (a <= 0.0f)
+    {
+        const float step = limitVal(error, -maxRate * dt, maxRate * dt);
+        value += step;
+        rate = step / dt;
+        return;
+    }
+
+    if (j <= 0.0f)
+    {
+        const float desiredRate =
+            copysignf(std::min(maxRate, smoothRampStoppingRate(fabsf(error), config, dt)), error);
+        const float change = limitVal(desiredRate - rate, -a * dt, a * dt);
+        rate += change;
+        acceleration = change / dt;
+    }
+    else
+    {
+        // Aim from where the value and rate will be once the acceleration is brought back to 0,
+        // since that takes time with a jerk limit
+        const float settleTime = fabsf(acceleration) / j;
+        const float predictedRate = rate + 0.5f * acceleration * settleTime;
+        const float settleJerk = -copysignf(j, acceleration);
+        const float predictedError =
+            error - settleTime * (rate + settleTime * (0.5f * acceleration +
+                                                       settleJerk * settleTime / 6.0f));
+        const float desiredRate = copysignf(
+            std::min(maxRate, smoothRampStoppingRate(fabsf(predictedError), config, dt)),
+            predictedError);
+        // The peak acceleration that changes the rate by rateError with the acceleration ramping
+        // up and back down at the jerk limit
+        const float rateError = desiredRate - predictedRate;
+        const float desiredAcceleration =
+            copysignf(std::min(a, sqrtf(j * fabsf(rateError))), rateError);
+        acceleration += limitVal(desiredAcceleration - acceleration, -j * dt, j * dt);
+        rate = limitVal(rate + acceleration * dt, -maxRate, maxRate);
+    }
+
+    // Land on the target once the value reaches it slowly enough to stop within an update
+    const float step = rate * dt;
+    const bool canStop =
+        fabsf(rate) <= a * dt && (j <= 0.0f || fabsf(previousAcceleration) <= j * dt);
+    if (canStop && (error - step) * error <= 0.0f)
+    {
+        value = target;
+        rate = 0.0f;
+        acceleration = 0.0f;
+    }
+    else
+    {
+        value += step;
+    }
+}
+}  // namespace detail
+
+/**
+ * Moves a value towards a target at a limited rate, like `Ramp`, but with the rate given in units
+ * per second and the time since the last update passed to `update`, so the value moves the same
+ * way however often it is updated. The rate of change can also be limited in acceleration and
+ * jerk, which shapes setpoints (e.g. of a chassis or turret) to be smooth to follow.
+ *
+ * With an acceleration limit, the value speeds up and slows down to stop at the target, and
+ * with a jerk limit, it does so along an S-curve, like a `MotionProfile` but recomputed every
+ * update so the target can change at any time. With a jerk limit the value can overshoot a
+ * target slightly, by well under 1% of the distance moved.
+ */
+class SmoothRamp
+{
+public:
+    explicit SmoothRamp(const SmoothRampConfig &config, float initialValue = 0.0f)
+        : config(config)
+    {
+        reset(initialValue);
+    }
+
+    /// Sets the value and target to `value`, at rest.
+    void reset(float value)
+    {
+        this->value = value;
+        target = value;
+        rate = 0.0f;
+        acceleration = 0.0f;
+    }
+
+    void setTarget(float target) { this->target = target; }
+
+    /**
+     * Moves the value towards the target.
+     *
+     * @param[in] dt The time since the last update, in seconds. Nothing happens if it is not > 0.
+     */
+    void update(float dt)
+    {
+        if (dt > 0.0f)
+        {
+            detail::stepSmoothRamp(config, target, dt, value, rate, acceleration);
+        }
+    }
+
+    float getValue() const { return value; }
+    float getTarget() const { return target; }
+    /// @return The rate the value is changing at, in units / s.
+    float getRate() const { return rate; }
+    /// @return The rate of change of the rate, in units / s^2.
+    float getAcceleration() const { return acceleration; }
+
+    /// @return `true` if the value has reached the target.
+    bool isTargetReached() const { return value == target; }
+
+    void setConfig(const SmoothRampConfig &config) { this->config = config; }
+
+private:
+    SmoothRampConfig config;
+    float value;
+    float target;
+    float rate;
+    float acceleration;
+};  // class SmoothRamp
+
+/**
+ * `N` identically configured `SmoothRamp`s, such as the setpoints of a chassis' axes, updated
+ * together in one pass over arrays of their state. Each ramp behaves exactly like a `SmoothRamp`.
+ *
+ * @tparam N The number of ramps.
+ */
+template <int N>
+class SmoothRampBank
+{
+public:
+    static_assert(N > 0, "SmoothRampBank must have at least one ramp");
+
+    explicit SmoothRampBank(const SmoothRampConfig &config) : config(config)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            reset(i, 0.0f);
+        }
+    }
+
+    /// Sets the ramp's value and target to `value`, at rest.
+    void reset(int ramp, float value)
+    {
+        this->value[ramp] = value;
+        target[ramp] = value;
+        rate[ramp] = 0.0f;
+        acceleration[ramp] = 0.0f;
+    }
+
+    void setTarget(int ramp, float target) { this->target[ramp] = target; }
+
+    void setTargets(const float (&targets)[N])
+    {
+        for (int i = 0; i < N; i++)
+        {
+            target[i] = targets[i];
+        }
+    }
+
+    /// Moves every ramp towards its target, see `SmoothRamp::update`.
+    void update(float dt)
+    {
+        if (dt <= 0.0f)
+        {
+            return;
+        }
+        for (int i = 0; i < N; i++)
+        {
+            detail::stepSmoothRamp(config, target[i], dt, value[i], rate[i], acceleration[i]);
+        }
+    }
+
+    float getValue(int ramp) const { return value[ramp]; }
+    const float (&getValues() const)[N] { return value; }
+    float getTarget(int ramp) const { return target[ramp]; }
+    float getRate(int ramp) const { return rate[ramp]; }
+    float getAcceleration(int ramp) const { return acceleration[ramp]; }
+
+    bool isTargetReached(int ramp) const { return value[ramp] == target[ramp]; }
+
+    void setConfig(const SmoothRampConfig &config) { this->config = config; }
+
+private:
+    SmoothRampConfig config;
+    float value[N];
+    float target[N];
+    float rate[N];
+    float acceleration[N];
+};  // class SmoothRampBank
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_SMOOTH_RAMP_HPP_
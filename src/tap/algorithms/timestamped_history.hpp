@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TIMESTAMPED_HISTORY_HPP_
+#define TAPROOT_TIMESTAMPED_HISTORY_HPP_
+
+#include <cstdint>
+
+namespace tap::algorithms
+{
+/**
+ * A fixed size ring of timestamped entries, the storage and time lookup shared by histories such
+ * as `AttitudeHistory` and `odometry::PoseHistory`, which interpolate their own entries.
+ *
+ * Entries must be pushed in order of time. Times are compared as signed differences so the
+ * microsecond clock may wrap. Not safe to push from an interrupt while reading from the main
+ * loop.
+ *
+ * @tparam Entry The type of the entries, which must have a `uint32_t time` member.
+ * @tparam CAPACITY The number of entries kept, must be a power of two.
+ */
+template <typename Entry, int CAPACITY>
+class TimestampedHistory
+{
+public:
+    static_assert(
+        CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0,
+        "TimestampedHistory capacity must be a power of two");
+
+    /**
+     * Adds an entry with the given time, overwriting the oldest entry once full. An entry whose
+     * time isn't after the newest entry's, such as another sample of the same FIFO read, replaces
+     * the newest entry instead.
+     *
+     * @param[in] time The time of the entry, in microseconds.
+     * @return The entry, with its time set, for the caller to fill in.
+     */
+    Entry &push(uint32_t time)
+    {
+        if (count == 0 || static_cast<int32_t>(time - newest().time) > 0)
+        {
+            head = (head + 1) & MASK;
+            if (count < CAPACITY)
+            {
+                count++;
+            }
+        }
+
+        Entry &entry = entries[head];
+        entry.time = time;
+        return entry;
+    }
+
+    void clear() { count = 0; }
+
+    /// @return The number of entries.
+    int size() const { return count; }
+
+    /// @return The time of the oldest entry, in microseconds, or 0 if there are none.
+    uint32_t getOldestTime() const { return count == 0 ? 0 : at(count - 1).time; }
+
+    /// @return The time of the newest entry, in microseconds, or 0 if there are none.
+    uint32_t getNewestTime() const { return count == 0 ? 0 : newest().time; }
+
+    /// @return The entry `age` entries older than the newest, `age` must be less than `size()`.
+    const Entry &at(int age) const { return entries[(head - age) & MASK]; }
+
+    Entry &at(int age) { return entries[(head - age) & MASK]; }
+
+    /**
+     * Finds the entries on either side of `time` by binary search.
+     *
+     * @param[out] older The age of the entry at or before `time`. 0 if `time` is after the newest.
+     * @param[out] t How far `time` is from entry `older` to the next newer one, from 0 to 1. 0 if
+     *      `older` is 0.
+     * @return `false` if there are no entries or `time` is before the oldest entry, in which case
+     *      `older` and `t` are unchanged.
+     */
+    bool find(uint32_t time, int &older, float &t) const
+    {
+        if (count == 0)
+        {
+            return false;
+        }
+
+        const uint32_t newestTime = newest().time;
+        const int32_t target = static_cast<int32_t>(time - newestTime);
+        if (target >= 0)
+        {
+            older = 0;
+            t = 0;
+            return true;
+        }
+        if (static_cast<int32_t>(at(count - 1).time - newestTime) > target)
+        {
+            return false;
+        }
+
+        // Invariant: entry `low` is at or before `time`, entry `high` is after it.
+        int low = count - 1;
+        int high = 0;
+        while (low - high > 1)
+        {
+            const int mid = (low + high) / 2;
+            if (static_cast<int32_t>(at(mid).time - newestTime) <= target)
+            {
+                low = mid;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        older = low;
+        const float span = static_cast<int32_t>(at(high).time - at(low).time);
+        t = static_cast<float>(static_cast<int32_t>(time - at(low).time)) / span;
+        return true;
+    }
+
+private:
+    static constexpr int MASK = CAPACITY - 1;
+
+    Entry entries[CAPACITY];
+    /// Index of the newest entry.
+    int head = MASK;
+    int count = 0;
+
+    const Entry &newest() const { return entries[head]; }
+};  // class TimestampedHistory
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_TIMESTAMPED_HISTORY_HPP_
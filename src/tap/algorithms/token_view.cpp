@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "token_view.hpp"
+
+#include <cstdlib>
+
+namespace tap
+{
+namespace algorithms
+{
+const char *TokenView::next()
+{
+    char *token = rest();
+    if (*token == '\0')
+    {
+        lastToken = "";
+        return nullptr;
+    }
+
+    cursor = token;
+    while (*cursor != '\0' && !isDelimiter(*cursor))
+    {
+        cursor++;
+    }
+    if (*cursor != '\0')
+    {
+        *cursor++ = '\0';
+    }
+    lastToken = token;
+    return token;
+}
+
+bool TokenView::nextIs(const char *token)
+{
+    char *start = rest();
+    size_t length = strlen(token);
+    if (length == 0 || strncmp(start, token, length) != 0 ||
+        (start[length] != '\0' && !isDelimiter(start[length])))
+    {
+        return false;
+    }
+    next();
+    return true;
+}
+
+bool TokenView::nextInt(int32_t &value)
+{
+    const char *token = next();
+    if (token == nullptr)
+    {
+        return false;
+    }
+    char *end;
+    long parsed = strtol(token, &end, 10);
+    if (end == token || *end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX)
+    {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool TokenView::nextFloat(float &value)
+{
+    const char *token = next();
+    if (token == nullptr)
+    {
+        return false;
+    }
+    char *end;
+    float parsed = strtof(token, &end);
+    if (end == token || *end != '\0')
+    {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool TokenView::empty() { return *rest() == '\0'; }
+
+char *TokenView::rest()
+{
+    while (isDelimiter(*cursor))
+    {
+        cursor++;
+    }
+    return cursor;
+}
+}  // namespace algorithms
+}  // namespace tap
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TOKEN_VIEW_HPP_
+#define TAPROOT_TOKEN_VIEW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace tap
+{
+namespace algorithms
+{
+/**
+ * An entry of a table mapping a token to a value, for example a terminal handler's subcommands.
+ * Tables are `constexpr` arrays, so they live in flash, and are searched by `TokenView::nextIn`.
+ */
+template <typename T>
+struct TokenTableEntry
+{
+    const char *token;
+    T value;
+};
+
+/**
+ * Splits a line into tokens separated by spaces and tabs, in place. Each token is null
+ * terminated where it is in the line, so nothing is copied, and it is a replacement for chains
+ * of `strtokR` and `strcmp`. Tokens are either taken as strings with `next`, or matched and
+ * converted with `nextIs`, `nextInt`, `nextFloat` and `nextIn`, each of which consumes one token
+ * and returns `false` if it is missing or doesn't convert. For example:
+ *
+ * ```cpp
+ * enum class Action { START, STOP };
+ * static constexpr TokenTableEntry<Action> ACTIONS[] = {{"start", Action::START},
+ *                                                       {"stop", Action::STOP}};
+ *
+ * TokenView tokens(inputLine);
+ * Action action;
+ * int32_t rate;
+ * if (!tokens.nextIn(ACTIONS, action) || (action == Action::START && !tokens.nextInt(rate)) ||
+ *     !tokens.empty())
+ * {
+ *     outputStream << "invalid argument: " << tokens.last() << modm::endl;
+ * }
+ * ```
+ *
+ * @note The line is modified, so it may not be tokenized again.
+ */
+class TokenView
+{
+public:
+    explicit TokenView(char *line) : cursor(line) {}
+
+    /// @return The next token, or `nullptr` if there are no tokens left.
+    const char *next();
+
+    /// Consumes the next token if it is `token`. @return `true` if it was consumed.
+    bool nextIs(const char *token);
+
+    /// Consumes the next token and parses it as a base 10 integer.
+    bool nextInt(int32_t &value);
+
+    /// Consumes the next token and parses it as a float.
+    bool nextFloat(float &value);
+
+    /// Consumes the next token and looks it up in `table`.
+    template <typename T, std::size_t N>
+    bool nextIn(const TokenTableEntry<T> (&table)[N], T &value)
+    {
+        const char *token = next();
+        if (token == nullptr)
+        {
+            return false;
+        }
+        for (const TokenTableEntry<T> &entry : table)
+        {
+            if (strcmp(entry.token, token) == 0)
+            {
+                value = entry.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @return `true` if there are no tokens left.
+    bool empty();
+
+    /**
+     * @return The untokenized rest of the line without leading delimiters, for passing on to
+     *      another parser.
+     */
+    char *rest();
+
+    /**
+     * @return The last token consumed, for error messages, or an empty string if none has been
+     *      consumed or the line had no token left.
+     */
+    const char *last() const { return lastToken; }
+
+private:
+    static bool isDelimiter(char c) { return c == ' ' || c == '\t'; }
+
+    char *cursor;
+    const char *lastToken = "";
+};  // class TokenView
+}  // namespace algorithms
+}  // namespace tap
+
+#endif  // TAPROOT_TOKEN_VIEW_HPP_
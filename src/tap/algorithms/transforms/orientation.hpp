@@ -22,6 +22,8 @@
 
 #include "tap/algorithms/cmsis_mat.hpp"
 #include "tap/algorithms/math_user_utils.hpp"
+
+#include "quaternion.hpp"
 // #include "tap/algorithms/euler_angles.hpp"
 
 namespace tap::algorithms::transforms
@@ -45,6 +47,9 @@ class Orientation
 
     inline Orientation(CMSISMat<3, 3>&& matrix) : matrix_(std::move(matrix)) {}
 
+    /* No trig; use to construct from an attitude estimator's quaternion */
+    inline explicit Orientation(const Quaternion& quaternion) : matrix_(quaternion.toMatrix()) {}
+
     /**
      * Returns roll as values between [-pi, +pi].
      *
@@ -59,6 +64,8 @@ class Orientation
 
     const inline CMSISMat<3, 3>& matrix() const { return matrix_; }
 
+    inline Quaternion quaternion() const { return Quaternion::fromMatrix(matrix_); }
+
     friend class Transform;
 
 private:
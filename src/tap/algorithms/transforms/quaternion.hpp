@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_QUATERNION_HPP_
+#define TAPROOT_QUATERNION_HPP_
+
+#include <cmath>
+
+#include "tap/algorithms/cmsis_mat.hpp"
+
+namespace tap::algorithms::transforms
+{
+/**
+ * A unit quaternion (w, x, y, z) representing a rotation, in the same convention as
+ * `Orientation`: the rotation of a target frame relative to a source frame, built from roll,
+ * pitch, then yaw about the source frame's x, y, and z axes.
+ *
+ * Composing two quaternions costs 16 multiplies against 27 for two rotation matrices, rotating a
+ * vector needs no matrix at all, and the quaternions the attitude estimators produce can be used
+ * directly, so chains of rotations that change every control loop are cheaper to keep as
+ * quaternions and convert to a matrix with `toMatrix` only where a matrix is needed.
+ */
+struct Quaternion
+{
+    float w = 1;
+    float x = 0;
+    float y = 0;
+    float z = 0;
+
+    constexpr Quaternion() = default;
+
+    constexpr Quaternion(float w, float x, float y, float z) : w(w), x(x), y(y), z(z) {}
+
+    /**
+     * @param[in] q A quaternion ordered (w, x, y, z), as returned by
+     *      `AttitudeEstimator::getQuaternion`.
+     */
+    explicit constexpr Quaternion(const float (&q)[4]) : w(q[0]), x(q[1]), y(q[2]), z(q[3]) {}
+
+    static constexpr Quaternion identity() { return Quaternion(); }
+
+    /**
+     * Constructs the rotation from roll, pitch, then yaw, equal to `fromEulerAngles` but with
+     * six trig calls on half angles rather than twelve.
+     */
+    static Quaternion fromEulerAngles(float roll, float pitch, float yaw)
+    {
+        const float cr = cosf(roll / 2), sr = sinf(roll / 2);
+        const float cp = cosf(pitch / 2), sp = sinf(pitch / 2);
+        const float cy = cosf(yaw / 2), sy = sinf(yaw / 2);
+        return Quaternion(
+            cr * cp * cy + sr * sp * sy,
+            sr * cp * cy - cr * sp * sy,
+            cr * sp * cy + sr * cp * sy,
+            cr * cp * sy - sr * sp * cy);
+    }
+
+    /**
+     * Converts a rotation matrix to a quaternion, branching on the largest diagonal term so the
+     * square root is never taken of a number close to zero.
+     */
+    static Quaternion fromMatrix(const CMSISMat<3, 3> &matrix)
+    {
+        const auto &m = matrix.data;
+        const float trace = m[0] + m[4] + m[8];
+        if (trace > 0)
+        {
+            const float s = 0.5f / sqrtf(trace + 1);
+            return Quaternion(0.25f / s, (m[7] - m[5]) * s, (m[2] - m[6]) * s, (m[3] - m[1]) * s);
+        }
+        if (m[0] > m[4] && m[0] > m[8])
+        {
+            const float s = 0.5f / sqrtf(1 + m[0] - m[4] - m[8]);
+            return Quaternion((m[7] - m[5]) * s, 0.25f / s, (m[1] + m[3]) * s, (m[2] + m[6]) * s);
+        }
+        if (m[4] > m[8])
+        {
+            const float s = 0.5f / sqrtf(1 + m[4] - m[0] - m[8]);
+            return Quaternion((m[2] - m[6]) * s, (m[1] + m[3]) * s, 0.25f / s, (m[5] + m[7]) * s);
+        }
+        const float s = 0.5f / sqrtf(1 + m[8] - m[0] - m[4]);
+        return Quaternion((m[3] - m[1]) * s, (m[2] + m[6]) * s, (m[5] + m[7]) * s, 0.25f / s);
+    }
+
+    /// @return The row major rotation matrix of this quaternion, computed without any trig.
+    CMSISMat<3, 3> toMatrix() const
+    {
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+
+        // clang-format off
+        return CMSISMat<3, 3>({
+            1 - 2 * (yy + zz), 2 * (xy - wz),     2 * (xz + wy),
+            2 * (xy + wz),     1 - 2 * (xx + zz), 2 * (yz - wx),
+            2 * (xz - wy),     2 * (yz + wx),     1 - 2 * (xx + yy),
+        });
+        // clang-format on
+    }
+
+    /**
+     * Returns the rotation of frame C relative to frame A, given this as the rotation of B
+     * relative to A and `second` as the rotation of C relative to B, like multiplying their
+     * rotation matrices in the same order.
+     */
+    Quaternion compose(const Quaternion &second) const
+    {
+        const Quaternion &q = second;
+        return Quaternion(
+            w * q.w - x * q.x - y * q.y - z * q.z,
+            w * q.x + x * q.w + y * q.z - z * q.y,
+            w * q.y - x * q.z + y * q.w + z * q.x,
+            w * q.z + x * q.y - y * q.x + z * q.w);
+    }
+
+    /// @return The inverse rotation, assuming this quaternion is of unit length.
+    constexpr Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); }
+
+    /**
+     * Multiplies `v` by this quaternion's rotation matrix, without forming it, as
+     * v + w * t + (x, y, z) cross t, where t = 2 * (x, y, z) cross v.
+     */
+    void rotate(const float (&v)[3], float (&out)[3]) const
+    {
+        const float tx = 2 * (y * v[2] - z * v[1]);
+        const float ty = 2 * (z * v[0] - x * v[2]);
+        const float tz = 2 * (x * v[1] - y * v[0]);
+        out[0] = v[0] + w * tx + y * tz - z * ty;
+        out[1] = v[1] + w * ty + z * tx - x * tz;
+        out[2] = v[2] + w * tz + x * ty - y * tx;
+    }
+
+    /// Multiplies `v` by the transpose of this quaternion's rotation matrix.
+    void inverseRotate(const float (&v)[3], float (&out)[3]) const { conjugate().rotate(v, out); }
+
+    float squaredNorm() const { return w * w + x * x + y * y + z * z; }
+
+    /// Scales this quaternion to unit length.
+    void normalize() { scale(1 / sqrtf(squaredNorm())); }
+
+    /**
+     * Scales a quaternion that has drifted slightly from unit length, such as after many
+     * compositions, back to unit length with a first order approximation of the inverse square
+     * root, (3 - |q|^2) / 2, which needs neither a square root nor a division. Its error is of the
+     * order of the square of the drift, so call it every few compositions rather than letting
+     * the drift grow; use `normalize` for quaternions that may be far from unit length.
+     */
+    void renormalize() { scale(0.5f * (3 - squaredNorm())); }
+
+    /**
+     * Returns roll as values between [-pi, +pi], equal to `Orientation::roll` of the same
+     * rotation but without building the rotation matrix.
+     */
+    float roll() const { return atan2f(2 * (w * x + y * z), 1 - 2 * (x * x + y * y)); }
+
+    /// Returns pitch as values between [-pi / 2, +pi / 2].
+    float pitch() const
+    {
+        const float sinPitch = 2 * (w * y - x * z);
+        return asinf(sinPitch > 1 ? 1 : (sinPitch < -1 ? -1 : sinPitch));
+    }
+
+    /// Returns yaw as values between [-pi, +pi].
+    float yaw() const { return atan2f(2 * (w * z + x * y), 1 - 2 * (y * y + z * z)); }
+
+private:
+    void scale(float s)
+    {
+        w *= s;
+        x *= s;
+        y *= s;
+        z *= s;
+    }
+};  // struct Quaternion
+}  // namespace tap::algorithms::transforms
+
+#endif  // TAPROOT_QUATERNION_HPP_
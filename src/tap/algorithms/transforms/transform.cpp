@@ -71,6 +71,57 @@ Orientation Transform::apply(const Orientation& orientation) const
     return Orientation(tRotation * orientation.matrix());
 }
 
+void Transform::apply(const Position* positions, Position* out, size_t n) const
+{
+    const float* r = tRotation.data.data();
+    const float* t = translation.data.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        const float x = positions[i].x() - t[0];
+        const float y = positions[i].y() - t[1];
+        const float z = positions[i].z() - t[2];
+        out[i] = Position(
+            r[0] * x + r[1] * y + r[2] * z,
+            r[3] * x + r[4] * y + r[5] * z,
+            r[6] * x + r[7] * y + r[8] * z);
+    }
+}
+
+void Transform::apply(const Vector* vectors, Vector* out, size_t n) const
+{
+    const float* r = tRotation.data.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        const float x = vectors[i].x();
+        const float y = vectors[i].y();
+        const float z = vectors[i].z();
+        out[i] = Vector(
+            r[0] * x + r[1] * y + r[2] * z,
+            r[3] * x + r[4] * y + r[5] * z,
+            r[6] * x + r[7] * y + r[8] * z);
+    }
+}
+
+void Transform::applyToPositions(const float* positions, float* out, uint16_t n) const
+{
+    // R^T * (p - t) = R^T * p - R^T * t, so rotate first and then offset each row in place
+    applyToVectors(positions, out, n);
+
+    const CMSISMat<3, 1> offset = tRotation * translation;
+    for (int row = 0; row < 3; row++)
+    {
+        arm_offset_f32(out + row * n, -offset.data[row], out + row * n, n);
+    }
+}
+
+void Transform::applyToVectors(const float* vectors, float* out, uint16_t n) const
+{
+    // The input is only read, arm_matrix_instance_f32 just doesn't have a const variant
+    const arm_matrix_instance_f32 in{3, n, const_cast<float*>(vectors)};
+    arm_matrix_instance_f32 result{3, n, out};
+    arm_mat_mult_f32(&tRotation.matrix, &in, &result);
+}
+
 Transform Transform::getInverse() const
 {
     // negative transposed rotation matrix times original position = new position
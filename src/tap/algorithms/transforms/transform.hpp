@@ -110,6 +110,46 @@ class Transform
      */
     Orientation apply(const Orientation& orientation) const;
 
+    /**
+     * Applies this transform to `n` positions, the same as calling `apply` on each but without
+     * the `CMSISMat` temporaries of the single position overload.
+     *
+     * @param[in] positions Positions in source frame.
+     * @param[out] out Positions in target frame. May be the same array as `positions`.
+     */
+    void apply(const Position* positions, Position* out, size_t n) const;
+
+    /**
+     * Rotates `n` vectors, the same as calling `apply` on each.
+     *
+     * @param[in] vectors Vectors as read by source frame.
+     * @param[out] out Vectors in target frame's basis. May be the same array as `vectors`.
+     */
+    void apply(const Vector* vectors, Vector* out, size_t n) const;
+
+    /**
+     * Applies this transform to `n` positions stored as a 3 x `n` row-major matrix, i.e. the `n`
+     * x-components, followed by the `n` y-components, followed by the `n` z-components. All of
+     * the positions are rotated with a single CMSIS matrix multiply rather than one per position,
+     * for transforming many points at once, such as the corners of every armor plate in a camera
+     * frame.
+     *
+     * @param[in] positions Positions in source frame.
+     * @param[out] out Positions in target frame, in the same layout. Must not overlap
+     *      `positions`.
+     * @param[in] n Number of positions.
+     */
+    void applyToPositions(const float* positions, float* out, uint16_t n) const;
+
+    /**
+     * Rotates `n` vectors stored in the same layout as the positions of `applyToPositions`.
+     *
+     * @param[in] vectors Vectors as read by source frame.
+     * @param[out] out Vectors in target frame's basis. Must not overlap `vectors`.
+     * @param[in] n Number of vectors.
+     */
+    void applyToVectors(const float* vectors, float* out, uint16_t n) const;
+
     /**
      * Updates the translation of the current transformation matrix.
      *
@@ -168,6 +208,18 @@ class Transform
         this->tRotation = this->rotation.transpose();
     }
 
+    /**
+     * Updates the rotation of the current transformation matrix from a unit quaternion, such as
+     * one from an attitude estimator, without any trig.
+     *
+     * @param newRotation updated orientation of target frame in source frame.
+     */
+    void updateRotation(const Quaternion& newRotation)
+    {
+        this->rotation = newRotation.toMatrix();
+        this->tRotation = this->rotation.transpose();
+    }
+
     /**
      * @return Inverse of this Transform.
      */
@@ -184,6 +236,8 @@ class Transform
 
     inline Orientation getRotation() const { return Orientation(rotation); }
 
+    inline Quaternion getRotationQuaternion() const { return Quaternion::fromMatrix(rotation); }
+
     /**
      * Get the roll of this transformation
      */
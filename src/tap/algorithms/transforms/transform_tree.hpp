@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TRANSFORM_TREE_HPP_
+#define TAPROOT_TRANSFORM_TREE_HPP_
+
+#include <cinttypes>
+#include <cstring>
+
+#include "transform.hpp"
+
+namespace tap::algorithms::transforms
+{
+/**
+ * A tree of named coordinate frames, such as world -> chassis -> turret yaw -> turret pitch ->
+ * camera, where each frame is defined by a `Transform` from its parent. Each edge is updated
+ * once per control loop, and transforms between frames are composed when first asked for and
+ * cached until an edge above them changes.
+ *
+ * Every edge and every cached transform from the root carries a version number. A cached
+ * transform is recomposed only if its own edge or its parent's cached transform has a newer
+ * version than the one it was composed from, so updating the camera mount doesn't recompose the
+ * chassis. Once the tree has been checked since the last update, queries of transforms to or from
+ * the root return the cached transform without walking the tree.
+ *
+ * Frames are identified by the index `addFrame` returns. Not safe to update from an interrupt
+ * while querying from the main loop.
+ *
+ * @tparam MAX_FRAMES The most frames the tree holds, including the root.
+ */
+template <int MAX_FRAMES>
+class TransformTree
+{
+public:
+    static_assert(MAX_FRAMES >= 1, "TransformTree needs room for its root frame");
+
+    /// The index of the root frame.
+    static constexpr int ROOT = 0;
+
+    /**
+     * @param[in] rootName The name of the root frame, such as "world". Not copied, so it must
+     *      outlive the tree.
+     */
+    explicit TransformTree(const char *rootName) { frames[ROOT].name = rootName; }
+
+    /**
+     * Adds a frame below `parent`.
+     *
+     * @param[in] name The name of the frame. Not copied, so it must outlive the tree.
+     * @param[in] parent The index of the frame this frame is defined relative to.
+     * @param[in] parentToFrame The initial transform from `parent` to the new frame.
+     * @return The index of the new frame, or -1 if the tree is full or `parent` doesn't exist.
+     */
+    int addFrame(const char *name, int parent, const Transform &parentToFrame)
+    {
+        if (numFrames >= MAX_FRAMES || !isValid(parent))
+        {
+            return -1;
+        }
+
+        Frame &frame = frames[numFrames];
+        frame.name = name;
+        frame.parent = parent;
+        frame.edge = parentToFrame;
+        frame.edgeVersion = 1;
+        generation++;
+        return numFrames++;
+    }
+
+    /// @return The index of the frame named `name`, or -1 if there is none.
+    int findFrame(const char *name) const
+    {
+        for (int i = 0; i < numFrames; i++)
+        {
+            if (strcmp(frames[i].name, name) == 0)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /// @return The name of `frame`, or `nullptr` if it doesn't exist.
+    const char *getName(int frame) const { return isValid(frame) ? frames[frame].name : nullptr; }
+
+    int size() const { return numFrames; }
+
+    /// Replaces the transform from `frame`'s parent to `frame`. Does nothing for the root.
+    void updateTransform(int frame, const Transform &parentToFrame)
+    {
+        if (isValid(frame) && frame != ROOT)
+        {
+            frames[frame].edge = parentToFrame;
+            markUpdated(frame);
+        }
+    }
+
+    /// Updates the rotation of `frame` relative to its parent. Does nothing for the root.
+    void updateRotation(int frame, float roll, float pitch, float yaw)
+    {
+        if (isValid(frame) && frame != ROOT)
+        {
+            frames[frame].edge.updateRotation(roll, pitch, yaw);
+            markUpdated(frame);
+        }
+    }
+
+    /// Updates the rotation of `frame` relative to its parent. Does nothing for the root.
+    void updateRotation(int frame, const Quaternion &rotation)
+    {
+        if (isValid(frame) && frame != ROOT)
+        {
+            frames[frame].edge.updateRotation(rotation);
+            markUpdated(frame);
+        }
+    }
+
+    /// Updates the origin of `frame` in its parent. Does nothing for the root.
+    void updateTranslation(int frame, float x, float y, float z)
+    {
+        if (isValid(frame) && frame != ROOT)
+        {
+            frames[frame].edge.updateTranslation(x, y, z);
+            markUpdated(frame);
+        }
+    }
+
+    /// @return The transform from `frame`'s parent to `frame`.
+    const Transform &getParentTransform(int frame) const { return frames[frame].edge; }
+
+    /**
+     * @return The transform from the root to `frame`, composed if an edge above `frame` changed
+     *      since it was last asked for. `frame` must exist.
+     */
+    const Transform &getTransformFromRoot(int frame)
+    {
+        refresh(frame);
+        return frames[frame].fromRoot;
+    }
+
+    /**
+     * @return The transform from `frame` to the root, inverted if an edge above `frame` changed
+     *      since it was last asked for. `frame` must exist.
+     */
+    const Transform &getTransformToRoot(int frame)
+    {
+        refresh(frame);
+        Frame &f = frames[frame];
+        if (f.toRootVersion != f.fromRootVersion)
+        {
+            f.toRoot = f.fromRoot.getInverse();
+            f.toRootVersion = f.fromRootVersion;
+        }
+        return f.toRoot;
+    }
+
+    /**
+     * @return The transform from frame `source` to frame `target`. Composed from the cached
+     *      transforms from the root, so costs one inverse and one composition unless either
+     *      frame is the root.
+     */
+    Transform getTransform(int source, int target)
+    {
+        if (source == ROOT)
+        {
+            return getTransformFromRoot(target);
+        }
+        if (target == ROOT)
+        {
+            return getTransformToRoot(source);
+        }
+        return getTransformToRoot(source).compose(getTransformFromRoot(target));
+    }
+
+private:
+    struct Frame
+    {
+        const char *name = nullptr;
+        int parent = -1;
+        /// The transform from the parent to this frame.
+        Transform edge = Transform::identity();
+        uint32_t edgeVersion = 0;
+
+        /// The transform from the root to this frame, and the versions it was composed from.
+        Transform fromRoot = Transform::identity();
+        uint32_t fromRootVersion = 0;
+        uint32_t composedEdgeVersion = 0;
+        uint32_t composedParentVersion = 0;
+
+        /// The inverse of `fromRoot`, and the version of `fromRoot` it was inverted from.
+        Transform toRoot = Transform::identity();
+        uint32_t toRootVersion = 0;
+
+        /// The value of `generation` when this frame's transforms were last brought up to date.
+        uint32_t refreshedGeneration = 0;
+    };
+
+    Frame frames[MAX_FRAMES];
+    int numFrames = 1;
+    /// Incremented by every change to the tree.
+    uint32_t generation = 1;
+
+    bool isValid(int frame) const { return frame >= 0 && frame < numFrames; }
+
+    void markUpdated(int frame)
+    {
+        frames[frame].edgeVersion++;
+        generation++;
+    }
+
+    /// Brings the transform from the root to `frame`, and those of its ancestors, up to date.
+    void refresh(int frame)
+    {
+        Frame &f = frames[frame];
+        if (f.refreshedGeneration == generation)
+        {
+            return;
+        }
+        f.refreshedGeneration = generation;
+        if (frame == ROOT)
+        {
+            return;
+        }
+
+        refresh(f.parent);
+        const Frame &parent = frames[f.parent];
+        if (f.composedEdgeVersion != f.edgeVersion ||
+            f.composedParentVersion != parent.fromRootVersion)
+        {
+            f.fromRoot = f.parent == ROOT ? f.edge : parent.fromRoot.compose(f.edge);
+            f.composedEdgeVersion = f.edgeVersion;
+            f.composedParentVersion = parent.fromRootVersion;
+            f.fromRootVersion++;
+        }
+    }
+};  // class TransformTree
+
+}  // namespace tap::algorithms::transforms
+
+#endif  // TAPROOT_TRANSFORM_TREE_HPP_
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_UNSCENTED_KALMAN_FILTER_HPP_
+#define TAPROOT_UNSCENTED_KALMAN_FILTER_HPP_
+
+#include <cinttypes>
+#include <cmath>
+
+#include "cmsis_mat.hpp"
+
+namespace tap::algorithms
+{
+/**
+ * Unscented kalman filter for nonlinear process and measurement models, such as the constant
+ * turn rate and spinning armor models used for aim prediction, without deriving or evaluating
+ * their Jacobians.
+ *
+ * Each predict, the state distribution is represented by `2 * STATES + 1` sigma points spread
+ * along the columns of the Cholesky factor of the error covariance, which are passed through the
+ * process model, and the predicted state and covariance are their weighted mean and covariance.
+ * Each correction draws sigma points from the predicted estimate and passes them through the
+ * measurement model the same way.
+ * The sigma points use the scaled unscented transform with parameters alpha, beta, and kappa.
+ *
+ * The models are function pointers rather than virtual or `std::function` objects, and the sigma
+ * points and all intermediate results are members allocated with the filter, so an update
+ * doesn't allocate. An update costs `2 * STATES + 1` evaluations of each model plus
+ * \f$O(STATES^3)\f$ work.
+ *
+ * States and measurements that are angles can be marked with `setAngularStates` and
+ * `setAngularMeasurements`, so their means and residuals are taken the short way around the
+ * circle rather than through 0.
+ *
+ * @tparam STATES The number of states.
+ * @tparam INPUTS The number of measurements.
+ */
+template <uint16_t STATES, uint16_t INPUTS>
+class UnscentedKalmanFilter
+{
+public:
+    static_assert(STATES <= 32, "Angular state mask only holds 32 states");
+    static_assert(INPUTS <= 32, "Angular measurement mask only holds 32 measurements");
+
+    static constexpr uint16_t NUM_SIGMA_POINTS = 2 * STATES + 1;
+
+    /// Writes the state `dt` seconds after state `x` to `out`. `out` is never `x`.
+    using ProcessModel = void (*)(const float (&x)[STATES], float dt, float (&out)[STATES]);
+
+    /// Writes the measurement expected in state `x` to `out`.
+    using MeasurementModel = void (*)(const float (&x)[STATES], float (&out)[INPUTS]);
+
+    /**
+     * @param[in] f The process model.
+     * @param[in] h The measurement model.
+     * @param[in] Q Process noise covariance, added every predict.
+     * @param[in] R Measurement error covariance.
+     * @param[in] P0 Initial error covariance estimate.
+     * @param[in] alpha Spread of the sigma points around the mean, from 0 to 1.
+     * @param[in] beta Prior knowledge of the distribution, 2 is optimal for a gaussian.
+     * @param[in] kappa Secondary spread of the sigma points, usually 0.
+     */
+    UnscentedKalmanFilter(
+        ProcessModel f,
+        MeasurementModel h,
+        const float (&Q)[STATES * STATES],
+        const float (&R)[INPUTS * INPUTS],
+        const float (&P0)[STATES * STATES],
+        float alpha = 1.0f,
+        float beta = 2.0f,
+        float kappa = 0.0f)
+        : f(f),
+          h(h),
+          Q(Q),
+          R(R),
+          xHat(),
+          P(P0),
+          P0(P0)
+    {
+        const float lambda = alpha * alpha * (STATES + kappa) - STATES;
+        gamma = sqrtf(STATES + lambda);
+        meanWeight0 = lambda / (STATES + lambda);
+        covarianceWeight0 = meanWeight0 + 1 - alpha * alpha + beta;
+        weight = 1 / (2 * (STATES + lambda));
+    }
+
+    void init(const float (&initialX)[STATES])
+    {
+        xHat.copyData(initialX);
+        P.data = P0.data;
+        initialized = true;
+    }
+
+    /**
+     * Marks the states that are angles in radians, bit `i` set for state `i`. Their means and
+     * residuals are wrapped to [-pi, pi).
+     */
+    void setAngularStates(uint32_t mask) { angularStates = mask; }
+
+    /// Marks the measurements that are angles in radians, bit `i` set for measurement `i`.
+    void setAngularMeasurements(uint32_t mask) { angularMeasurements = mask; }
+
+    /**
+     * Predicts the state `dt` seconds forward through the process model.
+     *
+     * If the error covariance isn't positive definite, the prediction is skipped.
+     */
+    void predict(float dt)
+    {
+        if (!initialized || !computeSigmaSpread())
+        {
+            return;
+        }
+
+        // Pass each sigma point through the process model as it is generated, so only the
+        // predicted points are stored
+        float point[STATES];
+        for (uint16_t j = 0; j < NUM_SIGMA_POINTS; j++)
+        {
+            getSigmaPoint(j, point);
+            f(point, dt, sigmaPoints[j]);
+        }
+
+        weightedMean<STATES>(sigmaPoints, angularStates, xHat.data.data());
+
+        // P = sum(w * dx * dxt) + Q
+        P.data = Q.data;
+        for (uint16_t j = 0; j < NUM_SIGMA_POINTS; j++)
+        {
+            float dx[STATES];
+            residual<STATES>(sigmaPoints[j], xHat.data.data(), angularStates, dx);
+            addWeightedOuterProduct<STATES, STATES>(covarianceWeight(j), dx, dx, P.data.data());
+        }
+        symmetrize(P);
+    }
+
+    /**
+     * Corrects the predicted state with the measurement `y`. The sigma points are drawn again
+     * from the predicted estimate rather than reusing the predicted points, which don't include
+     * the process noise.
+     *
+     * If the error or innovation covariance isn't positive definite, the correction is skipped.
+     */
+    void correct(const CMSISMat<INPUTS, 1> &y)
+    {
+        if (!initialized)
+        {
+            return;
+        }
+
+        if (!computeSigmaSpread())
+        {
+            return;
+        }
+        for (uint16_t j = 0; j < NUM_SIGMA_POINTS; j++)
+        {
+            getSigmaPoint(j, sigmaPoints[j]);
+            h(sigmaPoints[j], measurementPoints[j]);
+        }
+        float yPredicted[INPUTS];
+        weightedMean<INPUTS>(measurementPoints, angularMeasurements, yPredicted);
+
+        // S = sum(w * dy * dyt) + R, Pxy = sum(w * dx * dyt)
+        S.data = R.data;
+        Pxy.data.fill(0.0f);
+        for (uint16_t j = 0; j < NUM_SIGMA_POINTS; j++)
+        {
+            float dx[STATES];
+            float dy[INPUTS];
+            residual<STATES>(sigmaPoints[j], xHat.data.data(), angularStates, dx);
+            residual<INPUTS>(measurementPoints[j], yPredicted, angularMeasurements, dy);
+            const float w = covarianceWeight(j);
+            addWeightedOuterProduct<INPUTS, INPUTS>(w, dy, dy, S.data.data());
+            addWeightedOuterProduct<STATES, INPUTS>(w, dx, dy, Pxy.data.data());
+        }
+
+        // K = Pxy * S^-1
+        if (!choleskyDecompose(S, S))
+        {
+            return;
+        }
+        choleskySolve(S, Pxy, K);
+
+        // xHat = xHat + K * (y - yPredicted)
+        float innovation[INPUTS];
+        residual<INPUTS>(y.data.data(), yPredicted, angularMeasurements, innovation);
+        for (uint16_t i = 0; i < STATES; i++)
+        {
+            for (uint16_t m = 0; m < INPUTS; m++)
+            {
+                xHat.data[i] += K.data[i * INPUTS + m] * innovation[m];
+            }
+            if (angularStates & (1ul << i))
+            {
+                xHat.data[i] = wrapAngle(xHat.data[i]);
+            }
+        }
+
+        // P = P - K * S * Kt = P - Pxy * Kt
+        mulTransposedAdd(Pxy, K, P, P, -1.0f);
+        symmetrize(P);
+    }
+
+    /// Predicts the state `dt` seconds forward and corrects it with the measurement `y`.
+    void performUpdate(float dt, const CMSISMat<INPUTS, 1> &y)
+    {
+        predict(dt);
+        correct(y);
+    }
+
+    const std::array<float, STATES> &getStateVectorAsMatrix() const { return xHat.data; }
+
+    const std::array<float, STATES * STATES> &getErrorCovariance() const { return P.data; }
+
+    /**
+     * @return Modifiable process noise covariance, so it can be scaled with the time step or
+     *      tuned at runtime.
+     */
+    inline std::array<float, STATES * STATES> &getProcessCovariance() { return Q.data; }
+
+    /// @return Modifiable measurement covariance, so it can be modified at runtime.
+    inline std::array<float, INPUTS * INPUTS> &getMeasurementCovariance() { return R.data; }
+
+private:
+    ProcessModel f;
+    MeasurementModel h;
+
+    /// Process noise covariance
+    CMSISMat<STATES, STATES> Q;
+    /// Measurement noise covariance
+    CMSISMat<INPUTS, INPUTS> R;
+
+    /// Estimated state.
+    CMSISMat<STATES, 1> xHat;
+
+    /// Estimated error covariance.
+    CMSISMat<STATES, STATES> P;
+
+    /// Initial error covariance.
+    CMSISMat<STATES, STATES> P0;
+
+    /// Kalman filter gain matrix.
+    CMSISMat<STATES, INPUTS> K;
+
+    /*
+     * Workspace for the sigma points and intermediate results, allocated once with the filter
+     * rather than on the stack each update.
+     */
+    /// The sigma points of the last predict or correct.
+    float sigmaPoints[NUM_SIGMA_POINTS][STATES];
+    /// The sigma points passed through the measurement model.
+    float measurementPoints[NUM_SIGMA_POINTS][INPUTS];
+    /// Cholesky factor of P scaled by gamma, its columns are the sigma point offsets.
+    CMSISMat<STATES, STATES> spread;
+    /// Innovation covariance, then its Cholesky factor.
+    CMSISMat<INPUTS, INPUTS> S;
+    /// Cross covariance of the state and measurement.
+    CMSISMat<STATES, INPUTS> Pxy;
+
+    float gamma;
+    float meanWeight0;
+    float covarianceWeight0;
+    /// Mean and covariance weight of every sigma point but the first.
+    float weight;
+
+    uint32_t angularStates = 0;
+    uint32_t angularMeasurements = 0;
+
+    bool initialized = false;
+
+    static float wrapAngle(float angle)
+    {
+        return angle - 2.0f * static_cast<float>(M_PI) *
+                           roundf(angle / (2.0f * static_cast<float>(M_PI)));
+    }
+
+    float meanWeight(uint16_t j) const { return j == 0 ? meanWeight0 : weight; }
+
+    float covarianceWeight(uint16_t j) const { return j == 0 ? covarianceWeight0 : weight; }
+
+    /**
+     * spread = gamma * chol(P)
+     *
+     * @return `false` if P isn't positive definite.
+     */
+    bool computeSigmaSpread()
+    {
+        if (!choleskyDecompose(P, spread))
+        {
+            return false;
+        }
+        for (float &value : spread.data)
+        {
+            value *= gamma;
+        }
+        return true;
+    }
+
+    /// Sigma point `j`: xHat, then xHat plus and minus each column of `spread`.
+    void getSigmaPoint(uint16_t j, float (&point)[STATES]) const
+    {
+        for (uint16_t i = 0; i < STATES; i++)
+        {
+            point[i] = xHat.data[i];
+        }
+        if (j == 0)
+        {
+            return;
+        }
+        const uint16_t column = (j - 1) % STATES;
+        const float sign = j <= STATES ? 1.0f : -1.0f;
+        for (uint16_t i = 0; i < STATES; i++)
+        {
+            point[i] += sign * spread.data[i * STATES + column];
+        }
+    }
+
+    /**
+     * Weighted mean of the sigma points in `points`. Angular elements are averaged as residuals
+     * from the first point, so points on either side of pi average to pi rather than 0.
+     */
+    template <uint16_t SIZE>
+    void weightedMean(
+        const float (&points)[NUM_SIGMA_POINTS][SIZE],
+        uint32_t angular,
+        float *mean) const
+    {
+        for (uint16_t i = 0; i < SIZE; i++)
+        {
+            const bool isAngle = angular & (1ul << i);
+            float sum = 0.0f;
+            for (uint16_t j = 0; j < NUM_SIGMA_POINTS; j++)
+            {
+                const float value = points[j][i];
+                sum += meanWeight(j) * (isAngle ? wrapAngle(value - points[0][i]) : value);
+            }
+            mean[i] = isAngle ? wrapAngle(points[0][i] + sum) : sum;
+        }
+    }
+
+    /// out = a - b, with angular elements wrapped.
+    template <uint16_t SIZE>
+    static void residual(const float *a, const float *b, uint32_t angular, float (&out)[SIZE])
+    {
+        for (uint16_t i = 0; i < SIZE; i++)
+        {
+            out[i] = a[i] - b[i];
+            if (angular & (1ul << i))
+            {
+                out[i] = wrapAngle(out[i]);
+            }
+        }
+    }
+
+    /// out = out + w * a * bt
+    template <uint16_t ROWS, uint16_t COLS>
+    static void addWeightedOuterProduct(
+        float w,
+        const float (&a)[ROWS],
+        const float (&b)[COLS],
+        float *out)
+    {
+        for (uint16_t i = 0; i < ROWS; i++)
+        {
+            const float wa = w * a[i];
+            for (uint16_t j = 0; j < COLS; j++)
+            {
+                out[i * COLS + j] += wa * b[j];
+            }
+        }
+    }
+};  // class UnscentedKalmanFilter
+
+}  // namespace tap::algorithms
+
+#endif  // TAPROOT_UNSCENTED_KALMAN_FILTER_HPP_
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_WINDOWED_SUM_HPP_
+#define TAPROOT_WINDOWED_SUM_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tap
+{
+namespace algorithms
+{
+/**
+ * The sum of the values added over a sliding window of time, for example the damage received
+ * over the last second (damage per second), shots fired per second, or energy used over a power
+ * limiting window.
+ *
+ * Values are stored with the time they were added in a ring of `SIZE` samples, and a running sum
+ * is kept, so adding a value and reading the sum are O(1). Samples older than the window are
+ * removed from the sum by `update` (which `add` also calls), each sample once, so expiring
+ * samples is O(1) amortized.
+ *
+ * When the ring is full, a new value is added to the newest sample instead of replacing the
+ * oldest one, so the sum stays exact but the merged value expires a little later than it would
+ * have. Size the ring for the most values expected within a window to avoid this.
+ *
+ * Times are in milliseconds, like `tap::arch::clock::getTimeMilliseconds`, and may wrap.
+ *
+ * @tparam T The type of the values summed.
+ * @tparam SIZE The maximum number of samples stored.
+ */
+template <typename T, std::size_t SIZE>
+class WindowedSum
+{
+    static_assert(SIZE > 0, "SIZE must be positive");
+
+public:
+    /**
+     * @param[in] windowMs The length of the window. A value added at time `t` is part of the sum
+     *      until `t + windowMs`, inclusive.
+     */
+    explicit WindowedSum(uint32_t windowMs) : windowMs(windowMs) {}
+
+    /// Expires samples older than the window at `time`, then adds `value` at `time`.
+    void add(T value, uint32_t time)
+    {
+        update(time);
+        if (size == SIZE)
+        {
+            Sample &newest = samples[(head + size - 1) % SIZE];
+            newest.value += value;
+            newest.time = time;
+        }
+        else
+        {
+            samples[(head + size) % SIZE] = {value, time};
+            size++;
+        }
+        sum += value;
+    }
+
+    /**
+     * Removes samples older than the window at `time` from the sum.
+     *
+     * @return `true` if any sample was removed.
+     */
+    bool update(uint32_t time)
+    {
+        bool removed = false;
+        while (size > 0 && time - samples[head].time > windowMs)
+        {
+            sum -= samples[head].value;
+            head = (head + 1) % SIZE;
+            size--;
+            removed = true;
+        }
+        return removed;
+    }
+
+    /// @return The sum of the values in the window as of the last `add` or `update`.
+    T getSum() const { return sum; }
+
+    /// @return The sum scaled to a rate per second.
+    float getRatePerSecond() const
+    {
+        return windowMs == 0 ? 0.0f : static_cast<float>(sum) * 1000.0f / windowMs;
+    }
+
+    uint32_t getWindow() const { return windowMs; }
+
+    std::size_t getSize() const { return size; }
+
+    bool isEmpty() const { return size == 0; }
+
+    void clear()
+    {
+        head = 0;
+        size = 0;
+        sum = T();
+    }
+
+private:
+    struct Sample
+    {
+        T value;
+        uint32_t time;
+    };
+
+    const uint32_t windowMs;
+
+    Sample samples[SIZE] = {};
+
+    /// Index of the oldest sample.
+    std::size_t head = 0;
+
+    std::size_t size = 0;
+
+    T sum = T();
+};  // class WindowedSum
+}  // namespace algorithms
+}  // namespace tap
+
+#endif  // TAPROOT_WINDOWED_SUM_HPP_
@@ -123,16 +123,34 @@ void WrappedFloat::shiftBounds(const float shiftMagnitude)
 
 void WrappedFloat::wrapValue()
 {
-    float oldValue = wrapped;
+    const float oldValue = wrapped;
+    const float interval = upperBound - lowerBound;
+    const float offset = oldValue - lowerBound;
+
+    // Values already in bounds, the usual case after adding small deltas, need no division.
+    // Rounding can make `offset` equal `interval` for a value just below the upper bound, where
+    // the floor below counts a revolution, so that case is counted the same way here.
+    if (oldValue >= lowerBound && oldValue < upperBound)
+    {
+        this->revolutions += (offset == interval) ? 1 : 0;
+        return;
+    }
+
+    // Within one interval of the bounds, fmodf reduces to a single exact addition or
+    // subtraction of the interval, which is much cheaper than the library call.
     if (oldValue < lowerBound)
     {
-        this->wrapped = upperBound + fmodf(oldValue - upperBound, upperBound - lowerBound);
+        const float fromUpper = oldValue - upperBound;
+        this->wrapped = upperBound + (fromUpper > -2 * interval
+                                          ? fromUpper + interval
+                                          : fmodf(fromUpper, interval));
     }
-    else if (oldValue >= upperBound)
+    else
     {
-        this->wrapped = lowerBound + fmodf(oldValue - lowerBound, upperBound - lowerBound);
+        this->wrapped =
+            lowerBound + (offset < 2 * interval ? offset - interval : fmodf(offset, interval));
     }
-    this->revolutions += floor((oldValue - lowerBound) / (upperBound - lowerBound));
+    this->revolutions += floor(offset / interval);
 }
 
 float WrappedFloat::limitValue(
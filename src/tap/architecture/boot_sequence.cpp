@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "boot_sequence.hpp"
+
+#include "clock.hpp"
+
+namespace tap::arch
+{
+int BootSequence::addStep(
+    const char *name,
+    ResumableStepFunction function,
+    void *context,
+    std::initializer_list<int> dependencies)
+{
+    return addStepEntry(name, function, nullptr, context, dependencies);
+}
+
+int BootSequence::addBlockingStep(
+    const char *name,
+    BlockingStepFunction function,
+    void *context,
+    std::initializer_list<int> dependencies)
+{
+    return addStepEntry(name, nullptr, function, context, dependencies);
+}
+
+int BootSequence::addStepEntry(
+    const char *name,
+    ResumableStepFunction resumable,
+    BlockingStepFunction blocking,
+    void *context,
+    std::initializer_list<int> dependencies)
+{
+    if (numSteps == MAX_STEPS || started)
+    {
+        return INVALID_STEP_ID;
+    }
+
+    uint32_t dependencyMask = 0;
+    for (int dependency : dependencies)
+    {
+        if (dependency < 0 || dependency >= numSteps)
+        {
+            return INVALID_STEP_ID;
+        }
+        dependencyMask |= 1ul << dependency;
+    }
+
+    Step &step = steps[numSteps];
+    step.resumable = resumable;
+    step.blocking = blocking;
+    step.context = context;
+    step.dependencies = dependencyMask;
+    step.stats = StepStats();
+    step.stats.name = name;
+    return numSteps++;
+}
+
+bool BootSequence::update()
+{
+    if (!started)
+    {
+        started = true;
+        startTime = clock::getTimeMilliseconds();
+    }
+
+    for (int i = 0; i < numSteps; i++)
+    {
+        Step &step = steps[i];
+        if (step.stats.done || (step.dependencies & doneSteps) != step.dependencies)
+        {
+            continue;
+        }
+
+        if (!step.stats.started)
+        {
+            step.stats.started = true;
+            step.stats.startTime = clock::getTimeMilliseconds() - startTime;
+        }
+
+        const uint32_t callStart = clock::getTimeMicroseconds();
+        bool done = true;
+        if (step.blocking != nullptr)
+        {
+            step.blocking(step.context);
+        }
+        else
+        {
+            done = step.resumable(step.context);
+        }
+        step.stats.busyTime += clock::getTimeMicroseconds() - callStart;
+        step.stats.calls++;
+
+        if (done)
+        {
+            step.stats.done = true;
+            step.stats.endTime = clock::getTimeMilliseconds() - startTime;
+            doneSteps |= 1ul << i;
+            endTime = step.stats.endTime;
+        }
+    }
+
+    return isDone();
+}
+
+bool BootSequence::run(uint32_t timeout)
+{
+    while (!update())
+    {
+        if (clock::getTimeMilliseconds() - startTime >= timeout)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+BootSequence::StepStats BootSequence::getStepStats(int id) const
+{
+    if (id < 0 || id >= numSteps)
+    {
+        return StepStats();
+    }
+    return steps[id].stats;
+}
+
+uint32_t BootSequence::getElapsedTime() const
+{
+    if (!started)
+    {
+        return 0;
+    }
+    return isDone() ? endTime : clock::getTimeMilliseconds() - startTime;
+}
+
+void BootSequence::printReport(modm::IOStream &outputStream) const
+{
+    outputStream.printf(
+        "Boot %s in %lu ms\n",
+        isDone() ? "done" : "not done",
+        static_cast<unsigned long>(getElapsedTime()));
+    outputStream.printf(" step: start-end ms, busy us, calls\n");
+    for (int i = 0; i < numSteps; i++)
+    {
+        const StepStats &stats = steps[i].stats;
+        if (!stats.started)
+        {
+            outputStream.printf(" %s: not started\n", stats.name);
+            continue;
+        }
+        outputStream.printf(
+            " %s: %lu-",
+            stats.name,
+            static_cast<unsigned long>(stats.startTime));
+        if (stats.done)
+        {
+            outputStream.printf("%lu", static_cast<unsigned long>(stats.endTime));
+        }
+        else
+        {
+            outputStream.printf("?");
+        }
+        outputStream.printf(
+            ", %lu, %lu\n",
+            static_cast<unsigned long>(stats.busyTime),
+            static_cast<unsigned long>(stats.calls));
+    }
+}
+}  // namespace tap::arch
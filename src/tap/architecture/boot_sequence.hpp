@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BOOT_SEQUENCE_HPP_
+#define TAPROOT_BOOT_SEQUENCE_HPP_
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iostream.hpp"
+
+namespace tap::arch
+{
+/**
+ * Runs the steps that bring up a robot's peripherals at startup, interleaving the steps that
+ * don't depend on each other instead of running each to completion one after another, and
+ * records how long each step took.
+ *
+ * A resumable step is a function that does a bit of work each time it is called and returns
+ * `true` once it is done. Rather than blocking in `modm::delay_ms` while a peripheral resets, it
+ * returns `false` until a `Timeout` expires, so other steps run in the meantime. Initialization
+ * functions that block can still be added with `addBlockingStep`, and are run once all of their
+ * dependencies are done. A step only starts once every step it depends on is done. For example:
+ *
+ * ```cpp
+ * tap::arch::BootSequence boot;
+ * int can = boot.addBlockingStep("can", initializeCan, drivers);
+ * int imu = boot.addStep("imu", imuInitStep, &imuInitState);
+ * int fs = boot.addStep("littlefs", mountStep, &mountState);
+ * boot.addBlockingStep("motors", initializeMotors, drivers, {can});
+ * boot.addBlockingStep("crash log", storeCrashLog, drivers, {fs});
+ *
+ * if (!boot.run(5'000))
+ * {
+ *     // A step is stuck, printReport shows which
+ * }
+ * ```
+ *
+ * Steps are run in a round robin from the thread calling `run` or `update`, so steps never run
+ * at the same time and need no locking. Since a step can only depend on steps added before it,
+ * the dependencies can't form a cycle.
+ */
+class BootSequence
+{
+public:
+    static constexpr int MAX_STEPS = 16;
+
+    /// Value returned by `addStep` and `addBlockingStep` when the step could not be added.
+    static constexpr int INVALID_STEP_ID = -1;
+
+    /// Does part of a step, returning `true` once the step is done.
+    using ResumableStepFunction = bool (*)(void *context);
+
+    /// Does a whole step.
+    using BlockingStepFunction = void (*)(void *context);
+
+    /**
+     * Timing of a single step.
+     */
+    struct StepStats
+    {
+        const char *name = nullptr;
+        /// Time the step was first run, in milliseconds since the sequence started.
+        uint32_t startTime = 0;
+        /// Time the step finished, in milliseconds since the sequence started.
+        uint32_t endTime = 0;
+        /// Total time spent in the step's function, in microseconds.
+        uint32_t busyTime = 0;
+        /// Number of times the step's function was called.
+        uint32_t calls = 0;
+        bool started = false;
+        bool done = false;
+    };
+
+    BootSequence() = default;
+    DISALLOW_COPY_AND_ASSIGN(BootSequence)
+
+    /**
+     * Adds a resumable step.
+     *
+     * @param[in] name The name of the step, used in the report. Must outlive the sequence.
+     * @param[in] function Called with `context` until it returns `true`.
+     * @param[in] dependencies Ids of previously added steps that must be done before this step
+     *      starts.
+     * @return The id of the step, or `INVALID_STEP_ID` if `MAX_STEPS` steps were already added,
+     *      a dependency is invalid, or the sequence has started.
+     */
+    int addStep(
+        const char *name,
+        ResumableStepFunction function,
+        void *context,
+        std::initializer_list<int> dependencies = {});
+
+    /**
+     * Adds a step that is done after a single call to `function`.
+     *
+     * @see addStep
+     */
+    int addBlockingStep(
+        const char *name,
+        BlockingStepFunction function,
+        void *context,
+        std::initializer_list<int> dependencies = {});
+
+    /**
+     * Runs every step whose dependencies are done once. Call repeatedly, for example from the
+     * main loop, to run the sequence without blocking.
+     *
+     * @return `true` once every step is done.
+     */
+    bool update();
+
+    /**
+     * Calls `update` until every step is done or `timeout` milliseconds have passed since the
+     * sequence started.
+     *
+     * @return `true` if every step is done, `false` if the sequence timed out.
+     */
+    bool run(uint32_t timeout);
+
+    /// @return `true` once every step is done.
+    bool isDone() const { return doneSteps == allSteps(); }
+
+    int getNumSteps() const { return numSteps; }
+
+    /// @return The timing of the step with the given id, or empty stats if the id is invalid.
+    StepStats getStepStats(int id) const;
+
+    /**
+     * @return The time from the first `update` to the last step finishing, or to now if steps
+     *      remain, in milliseconds.
+     */
+    uint32_t getElapsedTime() const;
+
+    /// Prints the total boot time and the timing of each step, marking unfinished steps.
+    void printReport(modm::IOStream &outputStream) const;
+
+private:
+    struct Step
+    {
+        ResumableStepFunction resumable;
+        BlockingStepFunction blocking;
+        void *context;
+        /// Bit `i` is set if the step depends on step `i`.
+        uint32_t dependencies;
+        StepStats stats;
+    };
+
+    Step steps[MAX_STEPS] = {};
+
+    int numSteps = 0;
+
+    /// Bit `i` is set once step `i` is done.
+    uint32_t doneSteps = 0;
+
+    bool started = false;
+
+    uint32_t startTime = 0;
+
+    /// Time the last step finished, relative to `startTime`.
+    uint32_t endTime = 0;
+
+    uint32_t allSteps() const { return (1ul << numSteps) - 1; }
+
+    int addStepEntry(
+        const char *name,
+        ResumableStepFunction resumable,
+        BlockingStepFunction blocking,
+        void *context,
+        std::initializer_list<int> dependencies);
+};  // class BootSequence
+}  // namespace tap::arch
+
+#endif  // TAPROOT_BOOT_SEQUENCE_HPP_
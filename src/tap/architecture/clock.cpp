@@ -17,14 +17,68 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
+#ifdef PLATFORM_HOSTED
 
 #include "clock.hpp"
 
+#include <atomic>
+
 #include "modm/architecture/interface/assert.h"
 
 namespace tap::arch::clock
 {
+static std::atomic<bool> virtualTimeEnabled = false;
+static std::atomic<uint64_t> virtualTime = 0;
+
+void enableVirtualTime(uint64_t startTime)
+{
+    virtualTime = startTime;
+    virtualTimeEnabled = true;
+}
+
+void disableVirtualTime()
+{
+    virtualTimeEnabled = false;
+    virtualTime = 0;
+}
+
+bool isVirtualTimeEnabled() { return virtualTimeEnabled; }
+
+void advance(uint32_t us)
+{
+    if (virtualTimeEnabled)
+    {
+        virtualTime += us;
+    }
+}
+
+uint64_t getVirtualTimeMicroseconds() { return virtualTime; }
+
+uint64_t runAsFastAsPossible(
+    void (*function)(void *context),
+    void *context,
+    uint32_t period,
+    uint64_t duration)
+{
+    modm_assert(function != nullptr && period != 0, "clock", "invalid runAsFastAsPossible args");
+
+    if (!virtualTimeEnabled)
+    {
+        enableVirtualTime(virtualTime);
+    }
+
+    uint64_t runs = 0;
+    for (uint64_t elapsed = 0; elapsed < duration; elapsed += period)
+    {
+        function(context);
+        advance(period);
+        runs++;
+    }
+
+    return runs;
+}
+
+#ifdef ENV_UNIT_TESTS
 static ClockStub *globalStubInstance = nullptr;
 
 ClockStub::ClockStub()
@@ -39,13 +93,70 @@ ClockStub::~ClockStub() { globalStubInstance = nullptr; }
 
 uint32_t getTimeMilliseconds()
 {
-    return globalStubInstance == nullptr ? 0 : globalStubInstance->time;
+    if (globalStubInstance != nullptr)
+    {
+        return globalStubInstance->time;
+    }
+    return virtualTimeEnabled ? static_cast<uint32_t>(virtualTime / 1'000) : 0;
 }
 
 uint32_t getTimeMicroseconds()
 {
-    return globalStubInstance == nullptr ? 0 : 1000 * globalStubInstance->time;
+    if (globalStubInstance != nullptr)
+    {
+        return 1000 * globalStubInstance->time;
+    }
+    return virtualTimeEnabled ? static_cast<uint32_t>(virtualTime) : 0;
 }
+
+uint64_t getTimeMicroseconds64()
+{
+    if (globalStubInstance != nullptr)
+    {
+        return static_cast<uint64_t>(globalStubInstance->time) * 1'000;
+    }
+    return virtualTimeEnabled ? virtualTime.load() : 0;
+}
+
+uint32_t getCycleCount()
+{
+    return getTimeMicroseconds() * (Board::SystemClock::Frequency / 1'000'000);
+}
+
+uint64_t getCycleCount64()
+{
+    return getTimeMicroseconds64() * (Board::SystemClock::Frequency / 1'000'000);
+}
+#else
+uint32_t getTimeMilliseconds()
+{
+    if (virtualTimeEnabled)
+    {
+        return static_cast<uint32_t>(virtualTime / 1'000);
+    }
+    return modm::Clock().now().time_since_epoch().count();
+}
+
+uint32_t getTimeMicroseconds()
+{
+    if (virtualTimeEnabled)
+    {
+        return static_cast<uint32_t>(virtualTime);
+    }
+    return modm::PreciseClock().now().time_since_epoch().count();
+}
+
+uint64_t getTimeMicroseconds64()
+{
+    if (virtualTimeEnabled)
+    {
+        return virtualTime;
+    }
+    // Same as on the MCU, so the host's clocks wrap like the MCU's
+    uint64_t estimate = static_cast<uint64_t>(getTimeMilliseconds()) * 1'000;
+    return extendTime(estimate, getTimeMicroseconds());
+}
+#endif
 }  // namespace tap::arch::clock
 
 #endif
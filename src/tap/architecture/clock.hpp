@@ -25,11 +25,93 @@
 #ifndef PLATFORM_HOSTED
 #include "modm/platform.hpp"
 #else
+#include "tap/board/board.hpp"
+
 #include "modm/architecture/interface/clock.hpp"
 #endif
 
 namespace tap::arch::clock
 {
+/**
+ * Extends a 32-bit time that wraps to 64 bits, given a coarser 64-bit reading of the same time,
+ * such as a millisecond clock scaled to microseconds. Used by `getTimeMicroseconds64` and
+ * `getCycleCount64`, which are cheap enough to call from interrupts since they keep no state
+ * that has to be updated before the 32-bit time wraps.
+ *
+ * @param[in] estimate The time in the same units as `time`. Must be within 2^31 units of the
+ *      true time.
+ * @param[in] time The true time modulo 2^32.
+ * @return The 64-bit time whose low 32 bits are `time` that is closest to `estimate`.
+ */
+inline uint64_t extendTime(uint64_t estimate, uint32_t time)
+{
+    return estimate + static_cast<int32_t>(time - static_cast<uint32_t>(estimate));
+}
+
+#ifdef PLATFORM_HOSTED
+/**
+ * Virtual time support for hosted builds. While virtual time is enabled the `getTime*()`
+ * functions return a virtual time that only moves forward when `advance()` is called, instead
+ * of the host's real time. Since everything in taproot that measures time (`Timeout`,
+ * `PeriodicTimer`, `ConditionalTimer`, the `CommandScheduler`, motorsim, etc.) does so through
+ * the `getTime*()` functions, a simulation driven by virtual time runs as fast as the host can
+ * execute it and is independent of host scheduling, for example:
+ *
+ * ```cpp
+ * tap::arch::clock::enableVirtualTime();
+ * // Simulate a 3 minute match with a 1 kHz main loop
+ * tap::arch::clock::runAsFastAsPossible(mainLoop, drivers, 1'000, 180'000'000);
+ * ```
+ *
+ * In unit tests a `ClockStub`, if one exists, takes precedence over virtual time.
+ *
+ * Virtual time is stored in microseconds as a 64-bit value and may be read and advanced from
+ * multiple threads.
+ */
+
+/**
+ * Switches the `getTime*()` functions to virtual time.
+ *
+ * @param[in] startTime The virtual time to start at, in microseconds.
+ */
+void enableVirtualTime(uint64_t startTime = 0);
+
+/// Switches the `getTime*()` functions back to the host's real time and resets virtual time to 0.
+void disableVirtualTime();
+
+/// @return `true` if the `getTime*()` functions are currently returning virtual time.
+bool isVirtualTimeEnabled();
+
+/**
+ * Moves virtual time forward. Has no effect if virtual time is not enabled.
+ *
+ * @param[in] us The amount of time to advance by, in microseconds.
+ */
+void advance(uint32_t us);
+
+/// @return The current virtual time in microseconds. Unlike `getTimeMicroseconds()` this does
+///     not wrap.
+uint64_t getVirtualTimeMicroseconds();
+
+/**
+ * Repeatedly calls `function(context)` and then advances virtual time by `period` until
+ * `duration` microseconds of virtual time have elapsed, without waiting for real time to pass.
+ * Virtual time is enabled (starting at the current virtual time) if it is not already.
+ *
+ * @param[in] function The function to run each period, for example one iteration of a main loop.
+ * @param[in] context Passed to `function` each time it is called.
+ * @param[in] period The amount of virtual time between calls, in microseconds. Must be nonzero.
+ * @param[in] duration The total amount of virtual time to run for, in microseconds.
+ *
+ * @return The number of times `function` was called.
+ */
+uint64_t runAsFastAsPossible(
+    void (*function)(void *context),
+    void *context,
+    uint32_t period,
+    uint64_t duration);
+#endif
+
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
 /**
  * Object that allows you to control the global time returned by the `getTime*()` functions. Only a
@@ -41,7 +123,8 @@ namespace tap::arch::clock
  * If multiple `ClockStub` instances are declared in the same scope, the program will assert and
  * crash.
  *
- * If no `ClockStub` is declared in the test's scope, the `getTime*()` functions will return 0.
+ * If no `ClockStub` is declared in the test's scope, the `getTime*()` functions will return the
+ * virtual time if it is enabled and 0 otherwise.
  */
 class ClockStub final
 {
@@ -53,6 +136,48 @@ class ClockStub final
 
 uint32_t getTimeMilliseconds();
 uint32_t getTimeMicroseconds();
+uint64_t getTimeMicroseconds64();
+
+/**
+ * In unit tests the cycle count is derived from the `ClockStub`'s time so that code timed using
+ * cycles behaves deterministically.
+ */
+uint32_t getCycleCount();
+uint64_t getCycleCount64();
+
+inline void enableCycleCounter() {}
+#elif defined(PLATFORM_HOSTED)
+/// @return Virtual time if it is enabled, otherwise the host's real time, in milliseconds.
+uint32_t getTimeMilliseconds();
+
+/**
+ * @return Virtual time if it is enabled, otherwise the host's real time, in microseconds.
+ *
+ * @warning This clock time will wrap every 72 minutes. Do not use unless absolutely necessary.
+ */
+uint32_t getTimeMicroseconds();
+
+/**
+ * @return Virtual time if it is enabled, otherwise the host's real time, in microseconds. Does
+ *      not wrap.
+ */
+uint64_t getTimeMicroseconds64();
+
+inline void enableCycleCounter() {}
+
+/**
+ * @return A cycle count emulated from the microsecond clock and the board's core clock frequency.
+ */
+inline uint32_t getCycleCount()
+{
+    return getTimeMicroseconds() * (Board::SystemClock::Frequency / 1'000'000);
+}
+
+/// @return A 64-bit cycle count emulated like `getCycleCount`.
+inline uint64_t getCycleCount64()
+{
+    return getTimeMicroseconds64() * (Board::SystemClock::Frequency / 1'000'000);
+}
 #else
 inline uint32_t getTimeMilliseconds() { return modm::Clock().now().time_since_epoch().count(); }
 
@@ -63,6 +188,62 @@ inline uint32_t getTimeMicroseconds()
 {
     return modm::PreciseClock().now().time_since_epoch().count();
 }
+
+/**
+ * @return The time since boot in microseconds, as a 64-bit value that is monotonic for the 49
+ *      days it takes the millisecond clock to wrap. Safe to call from interrupts.
+ */
+inline uint64_t getTimeMicroseconds64()
+{
+    // The millisecond clock is within a millisecond of the microsecond clock, far less than the
+    // 2^31 us extendTime tolerates
+    uint64_t estimate = static_cast<uint64_t>(getTimeMilliseconds()) * 1'000;
+    return extendTime(estimate, getTimeMicroseconds());
+}
+
+/// Difference between the cycle counter and the millisecond clock in cycles, modulo 2^32.
+inline uint32_t cycleCountOffset = 0;
+inline bool cycleCountOffsetSet = false;
+
+/**
+ * Enables the DWT cycle counter if it is not already running. Must be called before
+ * `getCycleCount` and `getCycleCount64` return meaningful values. It is safe to call this
+ * function multiple times.
+ */
+inline void enableCycleCounter()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if (!cycleCountOffsetSet)
+    {
+        // Align the cycle counter with the millisecond clock, so getCycleCount64 can use the
+        // millisecond clock as its estimate
+        uint32_t estimate = getTimeMilliseconds() * (SystemCoreClock / 1'000);
+        cycleCountOffset = estimate - DWT->CYCCNT;
+        cycleCountOffsetSet = true;
+    }
+}
+
+/**
+ * @return The current value of the DWT cycle counter (i.e. the number of core clock cycles that
+ * have elapsed, modulo 2^32). The counter wraps every ~24 seconds at 180 MHz, so only use this
+ * for measuring short durations.
+ */
+inline uint32_t getCycleCount() { return DWT->CYCCNT; }
+
+/**
+ * @return The number of core clock cycles since boot (to within a millisecond) as a 64-bit value
+ *      that is monotonic for the 49 days it takes the millisecond clock to wrap. Unlike
+ *      `getCycleCount`, the difference of two values is meaningful however far apart they are
+ *      read, so it may be used to timestamp events. Costs a few more cycles than `getCycleCount`
+ *      and is safe to call from interrupts. `enableCycleCounter` must have been called.
+ */
+inline uint64_t getCycleCount64()
+{
+    uint64_t estimate = static_cast<uint64_t>(getTimeMilliseconds()) * (SystemCoreClock / 1'000);
+    return extendTime(estimate, getCycleCount() + cycleCountOffset);
+}
 #endif
 }  // namespace tap::arch::clock
 
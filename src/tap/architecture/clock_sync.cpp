@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "clock_sync.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "clock.hpp"
+
+namespace tap::arch
+{
+bool ClockSync::addExchange(
+    uint64_t localSendUs,
+    uint64_t hostReceiveUs,
+    uint64_t hostSendUs,
+    uint64_t localReceiveUs)
+{
+    const int64_t roundTrip = static_cast<int64_t>(localReceiveUs - localSendUs) -
+                              static_cast<int64_t>(hostSendUs - hostReceiveUs);
+    if (roundTrip > static_cast<int64_t>(config.maxRoundTripUs))
+    {
+        numRejectedExchanges++;
+        return false;
+    }
+    roundTripUs = std::max<int64_t>(roundTrip, 0);
+
+    // Assuming the request and reply took equally long, the host received the request half a
+    // round trip after it was sent, so half of this is the offset at the midpoint of the round
+    // trip
+    const int64_t twiceOffset = static_cast<int64_t>(hostReceiveUs - localSendUs) +
+                                static_cast<int64_t>(hostSendUs - localReceiveUs);
+    addSample(localSendUs + (localReceiveUs - localSendUs) / 2, twiceOffset);
+    return true;
+}
+
+void ClockSync::reset()
+{
+    numSamples = 0;
+    offsetUs = 0;
+    offsetFractionUs = 0;
+    drift = 0;
+    roundTripUs = 0;
+}
+
+bool ClockSync::isSynced() const
+{
+    return numSamples >= 2 &&
+           clock::getTimeMilliseconds() - lastSampleTimeMs <= config.syncTimeoutMs;
+}
+
+uint64_t ClockSync::localToHostUs(uint64_t localTimeUs) const
+{
+    return localTimeUs + predictOffsetUs(localTimeUs);
+}
+
+uint64_t ClockSync::hostToLocalUs(uint64_t hostTimeUs) const
+{
+    // The offset changes slowly enough that evaluating it at an estimate of the local time is
+    // as good as at the exact local time
+    const uint64_t estimate = hostTimeUs - offsetUs;
+    return hostTimeUs - predictOffsetUs(estimate);
+}
+
+void ClockSync::addSample(uint64_t localTimeUs, int64_t twiceOffsetUs)
+{
+    if (numSamples == 0)
+    {
+        offsetUs = twiceOffsetUs / 2;
+        offsetFractionUs = 0.5f * static_cast<float>(twiceOffsetUs - 2 * offsetUs);
+        drift = 0;
+    }
+    else
+    {
+        // A second order loop: the offset is corrected by part of the error between the sample
+        // and the predicted offset, and the drift by part of the error per time since the last
+        // sample, so a constant drift is tracked without a steady offset error. The fraction of
+        // a microsecond is kept so rounding doesn't bias the drift.
+        const float dt = static_cast<float>(localTimeUs - sampleLocalTimeUs);
+        const float predicted = offsetFractionUs + drift * dt;
+        const float error = 0.5f * static_cast<float>(twiceOffsetUs - 2 * offsetUs) - predicted;
+
+        const float offset = predicted + OFFSET_GAIN * error;
+        const float wholeOffset = std::floor(offset);
+        offsetUs += static_cast<int64_t>(wholeOffset);
+        offsetFractionUs = offset - wholeOffset;
+        if (dt > 0)
+        {
+            drift = std::clamp(drift + DRIFT_GAIN * error / dt, -MAX_DRIFT, MAX_DRIFT);
+        }
+    }
+
+    sampleLocalTimeUs = localTimeUs;
+    lastSampleTimeMs = clock::getTimeMilliseconds();
+    numSamples = std::min(numSamples + 1, 2);
+}
+
+int64_t ClockSync::predictOffsetUs(uint64_t localTimeUs) const
+{
+    const float dt = static_cast<float>(static_cast<int64_t>(localTimeUs - sampleLocalTimeUs));
+    return offsetUs + std::lround(offsetFractionUs + drift * dt);
+}
+}  // namespace tap::arch
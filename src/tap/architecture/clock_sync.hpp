@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CLOCK_SYNC_HPP_
+#define TAPROOT_CLOCK_SYNC_HPP_
+
+#include <cstdint>
+
+namespace tap::arch
+{
+/// Configuration of a `ClockSync`.
+struct ClockSyncConfig
+{
+    /// Exchanges with a longer round trip than this are discarded.
+    uint32_t maxRoundTripUs = 2'000;
+    /// Time without an accepted exchange after which the clocks are no longer synced.
+    uint32_t syncTimeoutMs = 1'000;
+};
+
+/**
+ * Tracks the offset and drift of a host's clock (such as a vision computer's) relative to
+ * `tap::arch::clock::getTimeMicroseconds64`, to convert timestamps between the two clocks to
+ * well under a millisecond, for example to look up the turret attitude in an
+ * `AttitudeHistory` at the exposure time of a camera frame.
+ *
+ * The clocks are compared NTP style by exchanges of four timestamps: the local time a request
+ * was sent, the host time it was received, the host time the reply was sent and the local time
+ * the reply was received. The transport is up to the caller, `CoprocessorLink` runs the
+ * exchange over any `DJISerial` port or `ByteTransport`. Assuming the request and reply took
+ * equally long, each exchange measures the offset at the midpoint of its round trip, with an
+ * error of up to half of the round trip, so exchanges with a round trip longer than
+ * `ClockSyncConfig::maxRoundTripUs` are discarded.
+ *
+ * The offset and drift are tracked by a second order loop, so a constant drift is followed
+ * without a steady offset error, and conversions between exchanges extrapolate with the drift.
+ */
+class ClockSync
+{
+public:
+    explicit ClockSync(const ClockSyncConfig &config = ClockSyncConfig()) : config(config) {}
+
+    /**
+     * Adds an exchange, all times in microseconds.
+     *
+     * @return `false` if the exchange's round trip was too long, in which case it is discarded.
+     */
+    bool addExchange(
+        uint64_t localSendUs,
+        uint64_t hostReceiveUs,
+        uint64_t hostSendUs,
+        uint64_t localReceiveUs);
+
+    /// Forgets all exchanges, for example when the host restarts.
+    void reset();
+
+    /**
+     * @return `true` if at least two exchanges have been accepted, so the drift is estimated,
+     *      and one was accepted in the last `ClockSyncConfig::syncTimeoutMs`.
+     */
+    bool isSynced() const;
+
+    /// @return The host's time at the given local time, both in microseconds.
+    uint64_t localToHostUs(uint64_t localTimeUs) const;
+
+    /// @return The local time at the given host time, both in microseconds.
+    uint64_t hostToLocalUs(uint64_t hostTimeUs) const;
+
+    /// @return The host's clock minus the local clock at the last accepted exchange.
+    int64_t getOffsetUs() const { return offsetUs; }
+
+    /// @return How much faster the host's clock runs than the local clock, in ppm.
+    float getDriftPpm() const { return drift * 1e6f; }
+
+    /// @return The round trip time of the last accepted exchange.
+    uint32_t getRoundTripTimeUs() const { return roundTripUs; }
+
+    /// @return The number of exchanges discarded for too long a round trip.
+    uint32_t getNumRejectedExchanges() const { return numRejectedExchanges; }
+
+private:
+    /// Fraction of the error between a sample and the predicted offset the offset is corrected by.
+    static constexpr float OFFSET_GAIN = 0.5f;
+    /// Fraction of the error rate the drift is corrected by.
+    static constexpr float DRIFT_GAIN = 0.25f;
+    /// Drift is clamped to this, crystals are specified to much less.
+    static constexpr float MAX_DRIFT = 1e-3f;
+
+    ClockSyncConfig config;
+
+    int numSamples = 0;
+    uint32_t lastSampleTimeMs = 0;
+    /// Local time of the last accepted sample, the midpoint of its round trip.
+    uint64_t sampleLocalTimeUs = 0;
+    /// Host minus local time at `sampleLocalTimeUs`, split into whole and fractional parts.
+    int64_t offsetUs = 0;
+    float offsetFractionUs = 0;
+    /// (host rate - local rate) / local rate.
+    float drift = 0;
+    uint32_t roundTripUs = 0;
+    uint32_t numRejectedExchanges = 0;
+
+    /// Adds a sample of twice the offset, which keeps the half microsecond.
+    void addSample(uint64_t localTimeUs, int64_t twiceOffsetUs);
+
+    /// @return The host minus local time at the given local time.
+    int64_t predictOffsetUs(uint64_t localTimeUs) const;
+};  // class ClockSync
+}  // namespace tap::arch
+
+#endif  // TAPROOT_CLOCK_SYNC_HPP_
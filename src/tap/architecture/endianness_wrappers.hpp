@@ -20,8 +20,11 @@
 #ifndef TAPROOT_ENDIANNESS_WRAPPERS_HPP_
 #define TAPROOT_ENDIANNESS_WRAPPERS_HPP_
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 
 #include "modm/architecture/detect.hpp"
 
@@ -29,6 +32,121 @@ namespace tap
 {
 namespace arch
 {
+/// Byte order of a value stored in a byte array.
+enum class Endianness
+{
+    LITTLE,
+    BIG,
+};
+
+namespace detail
+{
+template <size_t N>
+struct UnsignedOfSize;
+template <>
+struct UnsignedOfSize<1>
+{
+    using type = uint8_t;
+};
+template <>
+struct UnsignedOfSize<2>
+{
+    using type = uint16_t;
+};
+template <>
+struct UnsignedOfSize<4>
+{
+    using type = uint32_t;
+};
+template <>
+struct UnsignedOfSize<8>
+{
+    using type = uint64_t;
+};
+
+/// Position of byte `i` of an `N` byte value stored in byte order `E`, from the least significant.
+template <Endianness E, size_t N>
+constexpr size_t significance(size_t i)
+{
+    return E == Endianness::LITTLE ? i : N - 1 - i;
+}
+
+// Written as fold expressions rather than loops, which the compiler reliably merges into one load
+template <typename Bits, Endianness E, size_t... I>
+constexpr Bits loadBits(const uint8_t *bytesIn, std::index_sequence<I...>)
+{
+    return static_cast<Bits>(
+        ((static_cast<Bits>(bytesIn[I]) << (8 * significance<E, sizeof...(I)>(I))) | ...));
+}
+
+template <typename Bits, Endianness E, size_t... I>
+constexpr void storeBits(Bits bits, uint8_t *bytesOut, std::index_sequence<I...>)
+{
+    ((bytesOut[I] = static_cast<uint8_t>(bits >> (8 * significance<E, sizeof...(I)>(I)))), ...);
+}
+}  // namespace detail
+
+/**
+ * Reads a value stored in the given byte order, independent of the byte order of the current
+ * architecture. `bytesIn` needn't be aligned.
+ *
+ * The byte order is a template parameter and the bytes are combined with shifts, which the
+ * compiler merges into a single (unaligned) load, plus a byte reverse if the byte order differs
+ * from the architecture's. For integer and enum types this is `constexpr`.
+ *
+ * @tparam T the type to be read, an integer, enum or floating point type.
+ * @tparam E the byte order the value is stored in.
+ * @param[in] bytesIn the `sizeof(T)` bytes to be read.
+ * @return the value stored in `bytesIn`.
+ */
+template <typename T, Endianness E>
+constexpr T loadFromBytes(const uint8_t *bytesIn)
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "T must be a number or enum");
+    using Bits = typename detail::UnsignedOfSize<sizeof(T)>::type;
+
+    Bits bits = detail::loadBits<Bits, E>(bytesIn, std::make_index_sequence<sizeof(T)>());
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        T data = 0;
+        memcpy(&data, &bits, sizeof(T));
+        return data;
+    }
+    else
+    {
+        return static_cast<T>(bits);
+    }
+}
+
+/**
+ * Writes a value in the given byte order, independent of the byte order of the current
+ * architecture. `bytesOut` needn't be aligned. See `loadFromBytes`.
+ *
+ * @tparam T the type to be written, an integer, enum or floating point type.
+ * @tparam E the byte order to write the value in.
+ * @param[in] data the value to be written.
+ * @param[out] bytesOut the `sizeof(T)` bytes to write to.
+ */
+template <typename T, Endianness E>
+constexpr void storeToBytes(T data, uint8_t *bytesOut)
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "T must be a number or enum");
+    using Bits = typename detail::UnsignedOfSize<sizeof(T)>::type;
+
+    Bits bits = 0;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        memcpy(&bits, &data, sizeof(T));
+    }
+    else
+    {
+        bits = static_cast<Bits>(data);
+    }
+
+    detail::storeBits<Bits, E>(bits, bytesOut, std::make_index_sequence<sizeof(T)>());
+}
+
 /**
  * Reads a number and stores its byte array representation in
  * the given array reference.
@@ -136,7 +254,8 @@ template <typename T>
 void convertFromLittleEndian(T *data, const uint8_t *bytesIn)
 {
 #if MODM_IS_LITTLE_ENDIAN
-    *data = *reinterpret_cast<const T *>(bytesIn);
+    // bytesIn may not be aligned for T, memcpy compiles to a load that allows that
+    memcpy(data, bytesIn, sizeof(T));
 #else
     byteArrayToData(data, bytesIn, false);
 #endif
@@ -161,7 +280,7 @@ void convertFromBigEndian(T *data, const uint8_t *bytesIn)
 #if MODM_IS_LITTLE_ENDIAN
     byteArrayToData(data, bytesIn, false);
 #else
-    *data = *reinterpret_cast<const T *>(bytesIn);
+    memcpy(data, bytesIn, sizeof(T));
 #endif
 }
 
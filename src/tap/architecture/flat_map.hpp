@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_FLAT_MAP_HPP_
+#define TAPROOT_FLAT_MAP_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+#include "static_vector.hpp"
+
+namespace tap::arch
+{
+/**
+ * A map with a fixed capacity, stored as a `StaticVector` of entries sorted by key. Use it
+ * instead of `std::map` or `std::unordered_map` for small maps that are filled at startup: it
+ * never allocates, lookups are a binary search over contiguous memory, and iterating visits
+ * entries in key order. Inserting and erasing move the entries after the key, so they are O(n).
+ *
+ * @tparam Key The key type, ordered by `Compare`.
+ * @tparam Value The value type, which must be default constructible and copy assignable.
+ * @tparam N The maximum number of entries.
+ */
+template <typename Key, typename Value, std::size_t N, typename Compare = std::less<Key>>
+class FlatMap
+{
+public:
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    using iterator = Entry *;
+    using const_iterator = const Entry *;
+
+    constexpr FlatMap() = default;
+
+    static constexpr std::size_t capacity() { return N; }
+    constexpr std::size_t size() const { return entries.size(); }
+    constexpr bool empty() const { return entries.empty(); }
+    constexpr bool full() const { return entries.full(); }
+
+    /// @return The value for `key`, or `nullptr` if the map doesn't contain `key`.
+    Value *find(const Key &key)
+    {
+        iterator entry = lowerBound(key);
+        return entry != entries.end() && !Compare()(key, entry->key) ? &entry->value : nullptr;
+    }
+
+    const Value *find(const Key &key) const
+    {
+        return const_cast<FlatMap *>(this)->find(key);
+    }
+
+    bool contains(const Key &key) const { return find(key) != nullptr; }
+
+    /**
+     * Adds `key` with `value`.
+     *
+     * @return `false` if the map already contains `key` or is full, in which case it is
+     *      unchanged.
+     */
+    bool insert(const Key &key, const Value &value)
+    {
+        iterator entry = lowerBound(key);
+        if (full() || (entry != entries.end() && !Compare()(key, entry->key)))
+        {
+            return false;
+        }
+        entries.insert(entry, Entry{key, value});
+        return true;
+    }
+
+    /// @return `false` if the map doesn't contain `key`.
+    bool erase(const Key &key)
+    {
+        iterator entry = lowerBound(key);
+        if (entry == entries.end() || Compare()(key, entry->key))
+        {
+            return false;
+        }
+        entries.erase(entry);
+        return true;
+    }
+
+    void clear() { entries.clear(); }
+
+    constexpr iterator begin() { return entries.begin(); }
+    constexpr const_iterator begin() const { return entries.begin(); }
+    constexpr iterator end() { return entries.end(); }
+    constexpr const_iterator end() const { return entries.end(); }
+
+private:
+    StaticVector<Entry, N> entries;
+
+    /// @return The first entry whose key is not less than `key`, or `end()`.
+    iterator lowerBound(const Key &key)
+    {
+        return std::lower_bound(
+            entries.begin(),
+            entries.end(),
+            key,
+            [](const Entry &entry, const Key &k) { return Compare()(entry.key, k); });
+    }
+};
+}  // namespace tap::arch
+
+#endif  // TAPROOT_FLAT_MAP_HPP_
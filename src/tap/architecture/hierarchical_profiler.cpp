@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hierarchical_profiler.hpp"
+
+#include <algorithm>
+
+#include "clock.hpp"
+
+namespace tap::arch
+{
+HierarchicalProfiler::HierarchicalProfiler() { clock::enableCycleCounter(); }
+
+void HierarchicalProfiler::beginTick() { tickStartCycles = clock::getCycleCount(); }
+
+void HierarchicalProfiler::endTick()
+{
+    lastTickCycles = clock::getCycleCount() - tickStartCycles;
+    tickCount++;
+
+    for (int i = 0; i < numNodes; i++)
+    {
+        nodes[i].lastTickCycles = nodes[i].tickCycles;
+        nodes[i].tickCycles = 0;
+    }
+
+    currentTrace = 1 - currentTrace;
+    traceSize[currentTrace] = 0;
+}
+
+void HierarchicalProfiler::enter(const char* name)
+{
+    int16_t parent = stackSize > 0 ? stack[stackSize - 1].node : NO_NODE;
+    int16_t node = NO_NODE;
+    if (droppedDepth == 0 && stackSize < MAX_DEPTH)
+    {
+        node = findOrAddNode(name, parent);
+    }
+
+    if (node == NO_NODE)
+    {
+        // Nested scopes of a scope that isn't recorded aren't recorded either
+        droppedDepth++;
+        droppedScopes++;
+        return;
+    }
+
+    stack[stackSize++] = {node, clock::getCycleCount(), 0};
+}
+
+void HierarchicalProfiler::exit()
+{
+    uint32_t now = clock::getCycleCount();
+
+    if (droppedDepth > 0)
+    {
+        droppedDepth--;
+        return;
+    }
+    if (stackSize == 0)
+    {
+        return;
+    }
+
+    const StackEntry& entry = stack[--stackSize];
+    uint32_t inclusive = now - entry.startCycles;
+
+    Node& node = nodes[entry.node];
+    node.calls++;
+    node.inclusiveCycles += inclusive;
+    node.selfCycles += inclusive - std::min(entry.childCycles, inclusive);
+    node.maxInclusiveCycles = std::max(node.maxInclusiveCycles, inclusive);
+    node.tickCycles += inclusive;
+
+    if (stackSize > 0)
+    {
+        stack[stackSize - 1].childCycles += inclusive;
+    }
+
+    if (traceSize[currentTrace] < MAX_TRACE_EVENTS)
+    {
+        traces[currentTrace][traceSize[currentTrace]++] =
+            {entry.node, entry.startCycles - tickStartCycles, inclusive};
+    }
+    else
+    {
+        droppedTraceEvents++;
+    }
+}
+
+void HierarchicalProfiler::reset()
+{
+    numNodes = 0;
+    stackSize = 0;
+    droppedDepth = 0;
+    traceSize[0] = 0;
+    traceSize[1] = 0;
+    lastTickCycles = 0;
+    tickCount = 0;
+    droppedScopes = 0;
+    droppedTraceEvents = 0;
+}
+
+int16_t HierarchicalProfiler::findNode(const char* name, int16_t parent) const
+{
+    if (parent == NO_NODE)
+    {
+        // Top level scopes are not linked to each other
+        for (int16_t i = 0; i < numNodes; i++)
+        {
+            if (nodes[i].parent == NO_NODE && nodes[i].name == name)
+            {
+                return i;
+            }
+        }
+        return NO_NODE;
+    }
+
+    int16_t child = nodes[parent].firstChild;
+    while (child != NO_NODE && nodes[child].name != name)
+    {
+        child = nodes[child].nextSibling;
+    }
+    return child;
+}
+
+int16_t HierarchicalProfiler::findOrAddNode(const char* name, int16_t parent)
+{
+    int16_t node = findNode(name, parent);
+    if (node != NO_NODE || numNodes >= MAX_NODES)
+    {
+        return node;
+    }
+
+    node = numNodes++;
+    nodes[node] = Node();
+    nodes[node].name = name;
+    nodes[node].parent = parent;
+    if (parent != NO_NODE)
+    {
+        nodes[node].depth = nodes[parent].depth + 1;
+        nodes[node].nextSibling = nodes[parent].firstChild;
+        nodes[parent].firstChild = node;
+    }
+    return node;
+}
+
+void HierarchicalProfiler::printTree(modm::IOStream& outputStream) const
+{
+    outputStream << "calls\tself\tincl\tmax\tlast\tname (avg cycles per call)" << modm::endl;
+    for (int i = 0; i < numNodes; i++)
+    {
+        const Node& node = nodes[i];
+        uint32_t calls = std::max<uint32_t>(node.calls, 1);
+        outputStream.printf(
+            "%lu\t%lu\t%lu\t%lu\t%lu\t",
+            static_cast<unsigned long>(node.calls),
+            static_cast<unsigned long>(node.selfCycles / calls),
+            static_cast<unsigned long>(node.inclusiveCycles / calls),
+            static_cast<unsigned long>(node.maxInclusiveCycles),
+            static_cast<unsigned long>(node.lastTickCycles));
+        for (int d = 0; d < node.depth; d++)
+        {
+            outputStream << "  ";
+        }
+        outputStream << node.name << modm::endl;
+    }
+}
+
+void HierarchicalProfiler::printFolded(modm::IOStream& outputStream) const
+{
+    for (int16_t i = 0; i < numNodes; i++)
+    {
+        printPath(outputStream, i);
+        outputStream << " " << nodes[i].selfCycles << modm::endl;
+    }
+}
+
+void HierarchicalProfiler::printTrace(modm::IOStream& outputStream) const
+{
+    // Ticks are numbered from 0
+    uint32_t tick = tickCount > 0 ? tickCount - 1 : 0;
+    outputStream.printf(
+        "tick %lu %lu\n",
+        static_cast<unsigned long>(tick),
+        static_cast<unsigned long>(lastTickCycles));
+    for (int i = 0; i < getLastTickNumEvents(); i++)
+    {
+        const TraceEvent& event = getLastTickEvent(i);
+        outputStream.printf(
+            "%d %s %lu %lu\n",
+            nodes[event.node].depth,
+            nodes[event.node].name,
+            static_cast<unsigned long>(event.startCycles),
+            static_cast<unsigned long>(event.durationCycles));
+    }
+    outputStream << "end" << modm::endl;
+}
+
+void HierarchicalProfiler::printPath(modm::IOStream& outputStream, int16_t node) const
+{
+    if (nodes[node].parent != NO_NODE)
+    {
+        printPath(outputStream, nodes[node].parent);
+        outputStream << ";";
+    }
+    outputStream << nodes[node].name;
+}
+}  // namespace tap::arch
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_HIERARCHICAL_PROFILER_HPP_
+#define TAPROOT_HIERARCHICAL_PROFILER_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iostream.hpp"
+
+#ifdef RUN_WITH_PROFILING
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profiler, name)                                                    \
+    tap::arch::HierarchicalProfiler::Scope PROFILE_SCOPE_CONCAT(profileScope, __LINE__)( \
+        profiler,                                                                        \
+        name)
+#else
+#define PROFILE_SCOPE(profiler, name)
+#endif
+
+namespace tap::arch
+{
+/**
+ * A profiler that records how the time spent in a tick (typically one iteration of the main loop)
+ * is split between nested scopes. Unlike `Profiler`, which keeps flat statistics per name, each
+ * scope is a node in a call tree identified by its name and its parent scope, so the same name
+ * entered from two different scopes is two nodes. For example:
+ *
+ * ```cpp
+ * void mainLoop()
+ * {
+ *     profiler.beginTick();
+ *     {
+ *         PROFILE_SCOPE(profiler, "scheduler");
+ *         drivers->commandScheduler.run();
+ *     }
+ *     {
+ *         PROFILE_SCOPE(profiler, "can");
+ *         drivers->canRxHandler.pollCanData();
+ *     }
+ *     profiler.endTick();
+ * }
+ * ```
+ *
+ * Scopes may also be entered and exited directly with `enter` and `exit`.
+ *
+ * Each node accumulates the number of calls, its inclusive time (including nested scopes) and
+ * its self time (excluding nested scopes), and the inclusive time of the most recent tick. The
+ * latter may be added as `uint32_t` signals to a `TelemetryStream` to plot the tick breakdown
+ * live. In addition, every scope that exits during a tick is recorded in a trace of that tick,
+ * and the trace of the most recently completed tick is kept for printing.
+ *
+ * `printFolded` prints the call tree in the folded stack format used by flame graph tools, and
+ * `printTrace` prints the trace of the last tick, which `tools/profile_trace_converter.py`
+ * converts to Chrome trace JSON. `ProfilerTerminalSerialHandler` prints both over the terminal.
+ *
+ * All time is measured in core clock cycles using `tap::arch::clock::getCycleCount()`. The
+ * profiler is not reentrant, so only profile code run from a single context (i.e. not from both
+ * the main loop and an interrupt).
+ */
+class HierarchicalProfiler
+{
+public:
+    /// Max number of distinct scopes (nodes in the call tree).
+    static constexpr int MAX_NODES = 64;
+    /// Max depth of nested scopes. Scopes nested deeper are not recorded.
+    static constexpr int MAX_DEPTH = 16;
+    /// Max number of scopes recorded in the trace of a single tick.
+    static constexpr int MAX_TRACE_EVENTS = 128;
+    /// Index used by `Node` when there is no such node.
+    static constexpr int16_t NO_NODE = -1;
+
+    /**
+     * A scope in the call tree.
+     */
+    struct Node
+    {
+        const char* name = nullptr;
+        /// Index of the scope this scope was entered from, or `NO_NODE` for a top level scope.
+        int16_t parent = NO_NODE;
+        int16_t firstChild = NO_NODE;
+        int16_t nextSibling = NO_NODE;
+        /// Depth of the scope, 0 for a top level scope.
+        uint8_t depth = 0;
+        /// Number of times the scope exited.
+        uint32_t calls = 0;
+        /// Total time spent in the scope, including nested scopes.
+        uint64_t inclusiveCycles = 0;
+        /// Total time spent in the scope, excluding nested scopes.
+        uint64_t selfCycles = 0;
+        /// Largest time spent in a single call of the scope, including nested scopes.
+        uint32_t maxInclusiveCycles = 0;
+        /// Time spent in the scope during the most recently completed tick.
+        uint32_t lastTickCycles = 0;
+        /// Time spent in the scope so far during the current tick.
+        uint32_t tickCycles = 0;
+    };
+
+    /**
+     * A scope that exited during a tick.
+     */
+    struct TraceEvent
+    {
+        int16_t node;
+        /// Time the scope was entered, relative to the start of the tick.
+        uint32_t startCycles;
+        uint32_t durationCycles;
+    };
+
+    /**
+     * Enters a scope on construction and exits it on destruction.
+     */
+    class Scope
+    {
+    public:
+        Scope(HierarchicalProfiler& profiler, const char* name) : profiler(profiler)
+        {
+            profiler.enter(name);
+        }
+        DISALLOW_COPY_AND_ASSIGN(Scope)
+        ~Scope() { profiler.exit(); }
+
+    private:
+        HierarchicalProfiler& profiler;
+    };
+
+    HierarchicalProfiler();
+    DISALLOW_COPY_AND_ASSIGN(HierarchicalProfiler)
+
+    /// Starts a tick. Scopes entered before the first tick are in the trace of the first tick.
+    void beginTick();
+
+    /**
+     * Ends the tick, making the trace of the tick and each node's `lastTickCycles` available
+     * and starting a new trace.
+     */
+    void endTick();
+
+    /**
+     * Enters a scope nested in the current scope, adding it to the call tree if the current scope
+     * hasn't entered a scope with the same name before.
+     *
+     * @param[in] name The name of the scope. Compared by pointer, like `Profiler::push`, so
+     *      should be a string literal. Must remain valid for the lifetime of the profiler.
+     */
+    void enter(const char* name);
+
+    /// Exits the current scope. Must be paired with `enter`.
+    void exit();
+
+    /// Clears the call tree and traces.
+    void reset();
+
+    int getNumNodes() const { return numNodes; }
+
+    const Node& getNode(int index) const { return nodes[index]; }
+
+    /// @return The index of the node for `name` entered from `parent`, or `NO_NODE`.
+    int16_t findNode(const char* name, int16_t parent = NO_NODE) const;
+
+    /// @return The number of ticks completed since the profiler was reset.
+    uint32_t getTickCount() const { return tickCount; }
+
+    /// @return The length of the most recently completed tick.
+    uint32_t getLastTickCycles() const { return lastTickCycles; }
+
+    int getLastTickNumEvents() const { return traceSize[1 - currentTrace]; }
+
+    const TraceEvent& getLastTickEvent(int index) const { return traces[1 - currentTrace][index]; }
+
+    /**
+     * @return The number of scopes that weren't recorded since the profiler was reset because
+     *      there were too many nodes or they were nested too deeply.
+     */
+    uint32_t getDroppedScopes() const { return droppedScopes; }
+
+    /**
+     * @return The number of scopes that weren't recorded in a trace since the profiler was reset
+     *      because the trace was full.
+     */
+    uint32_t getDroppedTraceEvents() const { return droppedTraceEvents; }
+
+    /**
+     * Prints a line per node, indented by depth, with the number of calls, the average self and
+     * inclusive time per call, the max inclusive time, and the time in the last tick.
+     */
+    void printTree(modm::IOStream& outputStream) const;
+
+    /**
+     * Prints a line per node with the names of the node and its parents separated by ';',
+     * followed by the node's total self time, i.e. the folded stack format read by flame graph
+     * tools.
+     */
+    void printFolded(modm::IOStream& outputStream) const;
+
+    /**
+     * Prints the trace of the most recently completed tick as a `tick <tick count> <cycles>` line,
+     * a `<depth> <name> <start cycles> <duration cycles>` line per event, and an `end` line.
+     */
+    void printTrace(modm::IOStream& outputStream) const;
+
+private:
+    struct StackEntry
+    {
+        int16_t node;
+        uint32_t startCycles;
+        /// Inclusive time of the scopes nested in this scope that have exited.
+        uint32_t childCycles;
+    };
+
+    Node nodes[MAX_NODES];
+    int numNodes = 0;
+
+    StackEntry stack[MAX_DEPTH];
+    int stackSize = 0;
+    /// Number of scopes entered but not recorded that haven't exited yet.
+    int droppedDepth = 0;
+
+    TraceEvent traces[2][MAX_TRACE_EVENTS];
+    int traceSize[2] = {0, 0};
+    int currentTrace = 0;
+
+    uint32_t tickStartCycles = 0;
+    uint32_t lastTickCycles = 0;
+    uint32_t tickCount = 0;
+
+    uint32_t droppedScopes = 0;
+    uint32_t droppedTraceEvents = 0;
+
+    /// @return The index of the node for `name` entered from `parent`, adding it if necessary.
+    int16_t findOrAddNode(const char* name, int16_t parent);
+
+    void printPath(modm::IOStream& outputStream, int16_t node) const;
+};  // class HierarchicalProfiler
+}  // namespace tap::arch
+
+#endif  // TAPROOT_HIERARCHICAL_PROFILER_HPP_
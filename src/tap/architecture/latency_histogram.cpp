@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tap::arch
+{
+void LatencyHistogram::clear()
+{
+    std::fill(counts, counts + NUM_BUCKETS, 0);
+    count = 0;
+    max = 0;
+}
+
+uint32_t LatencyHistogram::getPercentile(float percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint32_t target = std::max<uint32_t>(ceilf(percentile * count), 1);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        cumulative += counts[i];
+        if (cumulative >= target)
+        {
+            return std::min(bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+LatencyHistogram::Summary LatencyHistogram::getSummary() const
+{
+    Summary summary;
+    summary.count = count;
+    summary.p50 = getPercentile(0.5f);
+    summary.p99 = getPercentile(0.99f);
+    summary.p999 = getPercentile(0.999f);
+    summary.max = max;
+    return summary;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    if (bucket == NUM_BUCKETS - 1)
+    {
+        return UINT32_MAX;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint32_t lowerBound = static_cast<uint32_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lowerBound + (1U << shift) - 1;
+}
+}  // namespace tap::arch
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_LATENCY_HISTOGRAM_HPP_
+#define TAPROOT_LATENCY_HISTOGRAM_HPP_
+
+#include <cstdint>
+
+namespace tap::arch
+{
+/**
+ * A constant memory histogram of latencies with logarithmically sized buckets, in the style of an
+ * HDR histogram, used to find tail latencies that a min/max/average hides.
+ *
+ * Values below `SUB_BUCKETS` each have their own bucket. Above that, each power of two is split
+ * into `SUB_BUCKETS` equally sized buckets, so a percentile is accurate to within
+ * 1 / `SUB_BUCKETS` (12.5%) of its value. Values of `2^MAX_VALUE_BITS` or more are counted in an
+ * overflow bucket, the last bucket.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_VALUE_BITS = 24;
+    static constexpr int NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + 1;
+
+    /**
+     * Percentiles of the values recorded in a histogram. Each percentile is the largest value
+     * that may be in the bucket the percentile falls in, but no more than `max`.
+     */
+    struct Summary
+    {
+        uint32_t count = 0;
+        uint32_t p50 = 0;
+        uint32_t p99 = 0;
+        uint32_t p999 = 0;
+        uint32_t max = 0;
+    };
+
+    void record(uint32_t value)
+    {
+        int bucket = bucketOf(value);
+        // Saturate rather than wrap so that percentiles stay sensible
+        if (counts[bucket] != UINT32_MAX)
+        {
+            counts[bucket]++;
+            count++;
+        }
+        if (value > max)
+        {
+            max = value;
+        }
+    }
+
+    void clear();
+
+    uint32_t getCount() const { return count; }
+
+    uint32_t getMax() const { return max; }
+
+    uint32_t getBucketCount(int bucket) const { return counts[bucket]; }
+
+    /**
+     * @param[in] percentile The fraction of values, between 0 and 1.
+     * @return The largest value that may be in the bucket `percentile` of the recorded values
+     *      are at or below, limited to the max recorded value. 0 if no values were recorded.
+     */
+    uint32_t getPercentile(float percentile) const;
+
+    Summary getSummary() const;
+
+    /// @return The index of the bucket `value` is counted in.
+    static int bucketOf(uint32_t value)
+    {
+        if (value < static_cast<uint32_t>(SUB_BUCKETS))
+        {
+            return value;
+        }
+        int msb = 31 - __builtin_clz(value);
+        if (msb >= MAX_VALUE_BITS)
+        {
+            return NUM_BUCKETS - 1;
+        }
+        int shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+    }
+
+    /// @return The largest value counted in `bucket`.
+    static uint32_t bucketUpperBound(int bucket);
+
+private:
+    uint32_t counts[NUM_BUCKETS] = {};
+    uint32_t count = 0;
+    uint32_t max = 0;
+};  // class LatencyHistogram
+}  // namespace tap::arch
+
+#endif  // TAPROOT_LATENCY_HISTOGRAM_HPP_
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "memory_monitor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tap/algorithms/token_view.hpp"
+#include "tap/drivers.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#include "modm/platform.hpp"
+#endif
+
+#ifndef PLATFORM_HOSTED
+#include <reent.h>
+
+#include "modm/architecture/interface/assert.hpp"
+#endif
+
+#ifndef PLATFORM_HOSTED
+extern "C" uint32_t __main_stack_bottom[];
+extern "C" uint32_t __main_stack_top[];
+#endif
+
+/// Set by `MemoryMonitor::lockHeap`, global since the allocation wrappers below check it.
+static bool heapLocked = false;
+
+#ifndef PLATFORM_HOSTED
+// Newlib's allocation functions are wrapped by the --wrap linker flags added for hardware builds
+// in build-tools/SConscript. The wrappers are in this file since every program links the
+// `MemoryMonitor` driver.
+extern "C"
+{
+    void *__real__malloc_r(struct _reent *reent, size_t size);
+    void *__real__calloc_r(struct _reent *reent, size_t count, size_t size);
+    void *__real__realloc_r(struct _reent *reent, void *ptr, size_t size);
+
+    void *__wrap__malloc_r(struct _reent *reent, size_t size)
+    {
+        modm_assert(!heapLocked, "malloc", "heap allocation after lockHeap");
+        return __real__malloc_r(reent, size);
+    }
+
+    void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size)
+    {
+        modm_assert(!heapLocked, "calloc", "heap allocation after lockHeap");
+        return __real__calloc_r(reent, count, size);
+    }
+
+    void *__wrap__realloc_r(struct _reent *reent, void *ptr, size_t size)
+    {
+        modm_assert(!heapLocked, "realloc", "heap allocation after lockHeap");
+        return __real__realloc_r(reent, ptr, size);
+    }
+}
+#endif
+
+namespace tap::arch
+{
+constexpr char MemoryMonitor::HEADER[];
+constexpr char MemoryMonitor::USAGE[];
+
+MemoryMonitor::MemoryMonitor(Drivers *drivers) : drivers(drivers) { addMainStack(); }
+
+void MemoryMonitor::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+int MemoryMonitor::addStack(const char *name, uint32_t *bottom, uint32_t size)
+{
+    if (numStacks == MAX_STACKS)
+    {
+        return INVALID_STACK_ID;
+    }
+    size -= size % sizeof(uint32_t);
+    std::fill(bottom, bottom + size / sizeof(uint32_t), STACK_PAINT);
+    return addStackEntry(name, size, bottom, nullptr, nullptr);
+}
+
+void MemoryMonitor::lockHeap() { heapLocked = true; }
+
+bool MemoryMonitor::isHeapLocked() const { return heapLocked; }
+
+MemoryMonitor::StackUsage MemoryMonitor::getStackUsage(int id) const
+{
+    StackUsage usage;
+    if (id < 0 || id >= numStacks)
+    {
+        return usage;
+    }
+
+    const Stack &stack = stacks[id];
+    usage.name = stack.name;
+    usage.size = stack.size;
+    if (stack.bottom != nullptr)
+    {
+        // The stack grows down, so the painted words left at the bottom were never used
+        const uint32_t *word = stack.bottom;
+        const uint32_t *top = stack.bottom + stack.size / sizeof(uint32_t);
+        while (word < top && *word == STACK_PAINT)
+        {
+            word++;
+        }
+        usage.maxUsed = (top - word) * sizeof(uint32_t);
+        usage.overflowed = stack.size > 0 && *stack.bottom != STACK_PAINT;
+    }
+    else if (stack.getFiberUsage != nullptr)
+    {
+        usage.maxUsed = stack.getFiberUsage(stack.fiber, usage.overflowed);
+    }
+    return usage;
+}
+
+void MemoryMonitor::printStacks(modm::IOStream &outputStream) const
+{
+    outputStream << "Stacks (used/size bytes):" << modm::endl;
+    for (int i = 0; i < numStacks; i++)
+    {
+        StackUsage usage = getStackUsage(i);
+        outputStream.printf(
+            " %s: %lu/%lu, %lu%%%s\n",
+            usage.name,
+            static_cast<unsigned long>(usage.maxUsed),
+            static_cast<unsigned long>(usage.size),
+            static_cast<unsigned long>(usage.size == 0 ? 0 : usage.maxUsed * 100 / usage.size),
+            usage.overflowed ? " OVERFLOWED" : "");
+    }
+}
+
+void MemoryMonitor::printDrivers(modm::IOStream &outputStream) const
+{
+    static constexpr int NUM_DRIVERS = sizeof(DRIVER_SIZES) / sizeof(DRIVER_SIZES[0]);
+
+    const DriverSize *sorted[NUM_DRIVERS];
+    std::size_t total = 0;
+    for (int i = 0; i < NUM_DRIVERS; i++)
+    {
+        sorted[i] = &DRIVER_SIZES[i];
+        total += DRIVER_SIZES[i].size;
+    }
+    std::stable_sort(sorted, sorted + NUM_DRIVERS, [](const DriverSize *a, const DriverSize *b) {
+        return a->size > b->size;
+    });
+
+    outputStream.printf(
+        "Drivers (%lu bytes total, %lu with padding):\n",
+        static_cast<unsigned long>(total),
+        static_cast<unsigned long>(sizeof(Drivers)));
+    for (const DriverSize *driver : sorted)
+    {
+        outputStream.printf(" %s: %lu\n", driver->name, static_cast<unsigned long>(driver->size));
+    }
+
+    if (EXCLUDED_DRIVER_SIZES.empty())
+    {
+        return;
+    }
+    std::size_t saved = 0;
+    for (const DriverSize &driver : EXCLUDED_DRIVER_SIZES)
+    {
+        saved += driver.size;
+    }
+    outputStream.printf("Excluded drivers (%lu bytes saved):\n", static_cast<unsigned long>(saved));
+    for (const DriverSize &driver : EXCLUDED_DRIVER_SIZES)
+    {
+        outputStream.printf(" %s: -%lu\n", driver.name, static_cast<unsigned long>(driver.size));
+    }
+}
+
+bool MemoryMonitor::terminalSerialCallback(
+    char *inputLine,
+    modm::IOStream &outputStream,
+    bool streamingEnabled)
+{
+    algorithms::TokenView tokens(inputLine);
+
+    if (tokens.empty())
+    {
+        printStacks(outputStream);
+        printDrivers(outputStream);
+        return true;
+    }
+    else if (tokens.nextIs("stacks"))
+    {
+        printStacks(outputStream);
+        return true;
+    }
+    else if (tokens.nextIs("drivers"))
+    {
+        printDrivers(outputStream);
+        return true;
+    }
+    else
+    {
+        outputStream << USAGE;
+        return !streamingEnabled && tokens.nextIs("-H");
+    }
+}
+
+void MemoryMonitor::terminalSerialStreamCallback(modm::IOStream &outputStream)
+{
+    printStacks(outputStream);
+}
+
+int MemoryMonitor::addStackEntry(
+    const char *name,
+    uint32_t size,
+    const uint32_t *bottom,
+    const void *fiber,
+    FiberUsageFunction getFiberUsage)
+{
+    if (numStacks == MAX_STACKS)
+    {
+        return INVALID_STACK_ID;
+    }
+    stacks[numStacks] = {name, size, bottom, fiber, getFiberUsage};
+    return numStacks++;
+}
+
+void MemoryMonitor::addMainStack()
+{
+#ifndef PLATFORM_HOSTED
+    {
+        // Interrupts use the main stack too, and must not push onto it while it is painted
+        modm::atomic::Lock lock;
+        uint32_t *end = reinterpret_cast<uint32_t *>(__get_MSP()) - STACK_PAINT_MARGIN_WORDS;
+        std::fill(__main_stack_bottom, end, STACK_PAINT);
+    }
+    addStackEntry(
+        "main",
+        (__main_stack_top - __main_stack_bottom) * sizeof(uint32_t),
+        __main_stack_bottom,
+        nullptr,
+        nullptr);
+#endif
+}
+}  // namespace tap::arch
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MEMORY_MONITOR_HPP_
+#define TAPROOT_MEMORY_MONITOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iostream.hpp"
+#include "modm/processing/fiber.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::arch
+{
+/**
+ * Tracks how deep each stack has ever grown and how much static RAM each driver takes up, so
+ * stacks and buffers can be sized from measurements rather than guesses.
+ *
+ * Stacks are tracked by painting: their unused memory is filled with `STACK_PAINT`, and the
+ * deepest point a stack has grown to (its high-water mark) is the lowest word no longer holding
+ * the pattern. On the hardware the main stack is painted when the monitor is constructed, along
+ * with the drivers. Fibers are painted by `addFiber`, which the taproot fibers (the `Mpu6500` and
+ * `PeriodicJobExecutor`) call themselves. Any other region of memory used as a stack can be
+ * added with `addStack`.
+ *
+ * Typing `memory` in the terminal prints the usage of every stack and the size of every driver.
+ * For the static RAM used by everything else, see `tools/ram_report.py`, which reports it per
+ * module from the firmware's symbols at build time.
+ *
+ * `lockHeap` checks that nothing allocates on the heap once startup is done. Objects constructed
+ * once at startup can be placed in a `StaticArena` instead of on the heap.
+ */
+class MemoryMonitor : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "memory";
+
+    static constexpr int MAX_STACKS = 8;
+
+    /// Value returned by `addStack` and `addFiber` when the stack could not be added.
+    static constexpr int INVALID_STACK_ID = -1;
+
+    /// Id of the main stack. Only added on the hardware.
+    static constexpr int MAIN_STACK_ID = 0;
+
+    /// Pattern unused stack memory is filled with.
+    static constexpr uint32_t STACK_PAINT = 0xcdcdcdcd;
+
+    /// Words just below the stack pointer left unpainted when painting the main stack.
+    static constexpr int STACK_PAINT_MARGIN_WORDS = 64;
+
+    struct StackUsage
+    {
+        const char *name = nullptr;
+        /// Size of the stack, in bytes.
+        uint32_t size = 0;
+        /// Most bytes of the stack that have ever been used.
+        uint32_t maxUsed = 0;
+        /// `true` if the bottom of the stack was overwritten, so the stack may have overflowed.
+        bool overflowed = false;
+    };
+
+    MemoryMonitor(Drivers *drivers);
+    DISALLOW_COPY_AND_ASSIGN(MemoryMonitor)
+    mockable ~MemoryMonitor() = default;
+
+    /// Adds the `memory` command to the terminal.
+    mockable void init();
+
+    /**
+     * Paints a region of memory used as a stack that grows down and starts tracking its usage.
+     * The region must not be in use yet, since all of it is painted.
+     *
+     * @param[in] name The name of the stack, used when printing usage. Must outlive the monitor.
+     * @param[in] bottom The lowest address of the stack.
+     * @param[in] size The size of the stack in bytes, rounded down to a whole number of words.
+     *
+     * @return The id of the stack, or `INVALID_STACK_ID` if `MAX_STACKS` stacks were already
+     *      added.
+     */
+    int addStack(const char *name, uint32_t *bottom, uint32_t size);
+
+    /**
+     * Paints the stack of a fiber using modm's stack watermarking and starts tracking its usage.
+     * Must be called before the fiber first runs, i.e. before `modm::fiber::Scheduler::run`. On
+     * the hosted platform the fiber's stack is not painted and its usage reads as 0.
+     *
+     * @return The id of the stack, or `INVALID_STACK_ID` if `MAX_STACKS` stacks were already
+     *      added.
+     */
+    template <std::size_t STACK_SIZE>
+    int addFiber(const char *name, ::modm::Fiber<STACK_SIZE> &fiber)
+    {
+#ifdef PLATFORM_HOSTED
+        return addStackEntry(name, STACK_SIZE, nullptr, &fiber, nullptr);
+#else
+        fiber.watermark_stack();
+        return addStackEntry(name, STACK_SIZE, nullptr, &fiber, &getFiberUsage<STACK_SIZE>);
+#endif
+    }
+
+    /**
+     * Makes every later heap allocation (`malloc`, `calloc`, `realloc` and so `new`) fail a
+     * `modm_assert`. Call once at the end of startup, after everything that allocates on the heap
+     * (`std::vector`, `std::unordered_map`, etc.) has been constructed and reserved its memory,
+     * so that an allocation in the main loop, which may stall for a varying time or fail once the
+     * heap is fragmented, is caught during testing. Freeing memory is still allowed.
+     *
+     * On the hardware, allocations are checked by wrapping newlib's `_malloc_r`, `_calloc_r` and
+     * `_realloc_r` with the `--wrap` linker flags taproot's build adds. On the hosted platform
+     * allocations aren't checked.
+     */
+    mockable void lockHeap();
+
+    /// @return `true` if `lockHeap` has been called.
+    bool isHeapLocked() const;
+
+    /// @return The number of stacks added.
+    int getNumStacks() const { return numStacks; }
+
+    /// @return The usage of the stack with the given id, or empty usage if the id is invalid.
+    StackUsage getStackUsage(int id) const;
+
+    /// Prints the size, high-water mark and free space of each stack.
+    void printStacks(modm::IOStream &outputStream) const;
+
+    /**
+     * Prints the size of each driver, largest first, then the size of each driver left out by the
+     * `:core:excluded_drivers` lbuild option.
+     */
+    void printDrivers(modm::IOStream &outputStream) const;
+
+    bool terminalSerialCallback(
+        char *inputLine,
+        modm::IOStream &outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream &outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: memory [stacks|drivers]\n"
+        "  Prints the high-water mark of each stack and the size of each driver, or only one\n"
+        "  of the two.\n";
+
+    /// Measures a fiber's stack, returning its usage in bytes and setting `overflowed`.
+    using FiberUsageFunction = uint32_t (*)(const void *fiber, bool &overflowed);
+
+    struct Stack
+    {
+        const char *name;
+        uint32_t size;
+        /// The painted region, or `nullptr` if the stack belongs to a fiber.
+        const uint32_t *bottom;
+        const void *fiber;
+        FiberUsageFunction getFiberUsage;
+    };
+
+    Drivers *drivers;
+
+    Stack stacks[MAX_STACKS] = {};
+
+    int numStacks = 0;
+
+    int addStackEntry(
+        const char *name,
+        uint32_t size,
+        const uint32_t *bottom,
+        const void *fiber,
+        FiberUsageFunction getFiberUsage);
+
+    /// Paints the main stack below the stack pointer and adds it as `MAIN_STACK_ID`.
+    void addMainStack();
+
+#ifndef PLATFORM_HOSTED
+    template <std::size_t STACK_SIZE>
+    static uint32_t getFiberUsage(const void *fiber, bool &overflowed)
+    {
+        const auto *f = static_cast<const ::modm::Fiber<STACK_SIZE> *>(fiber);
+        overflowed = f->stack_overflow();
+        return f->stack_usage();
+    }
+#endif
+};  // class MemoryMonitor
+}  // namespace tap::arch
+
+#endif  // TAPROOT_MEMORY_MONITOR_HPP_
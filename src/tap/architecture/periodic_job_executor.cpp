@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "periodic_job_executor.hpp"
+
+#include <algorithm>
+
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+#include "clock.hpp"
+
+namespace tap::arch
+{
+PeriodicJobExecutor::PeriodicJobExecutor(Drivers *drivers)
+    : Fiber([this] { run(); }),
+      drivers(drivers)
+{
+    drivers->memoryMonitor.addFiber("job executor", *this);
+}
+
+int PeriodicJobExecutor::addJob(
+    const char *name,
+    JobFunction function,
+    void *context,
+    uint32_t period,
+    uint32_t deadline,
+    int priority)
+{
+    if (jobCount >= MAX_JOBS)
+    {
+        RAISE_ERROR(drivers, "periodic job executor full");
+        return INVALID_JOB_ID;
+    }
+    else if (function == nullptr)
+    {
+        RAISE_ERROR(drivers, "attempting to add periodic job with nullptr function");
+        return INVALID_JOB_ID;
+    }
+    else if (priority < 0 && priority != AUTO_PRIORITY)
+    {
+        RAISE_ERROR(drivers, "invalid periodic job priority");
+        return INVALID_JOB_ID;
+    }
+
+    Job &job = jobs[jobCount];
+    job = Job();
+    job.name = name;
+    job.function = function;
+    job.context = context;
+    job.period = period;
+    job.deadline = deadline == 0 ? period : deadline;
+    job.priority = priority;
+    job.autoPriority = priority == AUTO_PRIORITY;
+
+    jobCount++;
+
+    if (job.autoPriority)
+    {
+        assignRateMonotonicPriorities();
+    }
+
+    return jobCount - 1;
+}
+
+void PeriodicJobExecutor::update()
+{
+    releaseJobs(clock::getTimeMicroseconds(), true);
+
+    for (int i = 0; i < MAX_JOBS; i++)
+    {
+        int jobIndex = highestPriorityReleasedJob();
+        if (jobIndex < 0)
+        {
+            break;
+        }
+
+        runJob(jobs[jobIndex]);
+
+        // Jobs may have been released while the previous job was running
+        releaseJobs(clock::getTimeMicroseconds(), false);
+    }
+}
+
+const char *PeriodicJobExecutor::getJobName(int id) const
+{
+    return id >= 0 && id < jobCount ? jobs[id].name : nullptr;
+}
+
+int PeriodicJobExecutor::getJobPriority(int id) const
+{
+    return id >= 0 && id < jobCount ? jobs[id].priority : AUTO_PRIORITY;
+}
+
+PeriodicJobExecutor::JobStats PeriodicJobExecutor::getJobStats(int id) const
+{
+    return id >= 0 && id < jobCount ? jobs[id].stats : JobStats();
+}
+
+void PeriodicJobExecutor::resetJobStats()
+{
+    for (int i = 0; i < jobCount; i++)
+    {
+        jobs[i].stats.reset();
+    }
+}
+
+int PeriodicJobExecutor::jitterToBucket(uint32_t jitter)
+{
+    if (jitter == 0)
+    {
+        return 0;
+    }
+
+    // Number of bits required to represent the jitter
+    int bits = 32 - __builtin_clz(jitter);
+    return std::min(bits, JITTER_HISTOGRAM_BUCKETS - 1);
+}
+
+void PeriodicJobExecutor::releaseJobs(uint32_t now, bool startOfUpdate)
+{
+    for (int i = 0; i < jobCount; i++)
+    {
+        Job &job = jobs[i];
+
+        if (job.firstRelease)
+        {
+            if (!startOfUpdate)
+            {
+                continue;
+            }
+            job.firstRelease = false;
+            job.releaseTime = now;
+        }
+        else if (job.period == 0)
+        {
+            // Jobs with no period are released once per update
+            if (!startOfUpdate || job.released)
+            {
+                continue;
+            }
+            job.releaseTime = now;
+        }
+        else
+        {
+            // Use signed difference to handle the clock wrapping
+            int32_t elapsed = static_cast<int32_t>(now - job.releaseTime);
+            if (elapsed < static_cast<int32_t>(job.period))
+            {
+                continue;
+            }
+
+            uint32_t periodsElapsed = static_cast<uint32_t>(elapsed) / job.period;
+
+            // If the job hasn't run since it was last released, that release missed its
+            // deadline. Any entire periods skipped over are missed as well.
+            job.stats.deadlineMisses += (job.released ? 1 : 0) + periodsElapsed - 1;
+            job.stats.releases += periodsElapsed - 1;
+
+            // Keep releases aligned with the job's period
+            job.releaseTime += periodsElapsed * job.period;
+        }
+
+        job.released = true;
+        job.stats.releases++;
+    }
+}
+
+int PeriodicJobExecutor::highestPriorityReleasedJob() const
+{
+    int best = -1;
+    for (int i = 0; i < jobCount; i++)
+    {
+        if (jobs[i].released && (best < 0 || jobs[i].priority > jobs[best].priority))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void PeriodicJobExecutor::runJob(Job &job)
+{
+    uint32_t start = clock::getTimeMicroseconds();
+
+    job.function(job.context);
+
+    uint32_t end = clock::getTimeMicroseconds();
+
+    uint32_t jitter = start - job.releaseTime;
+    uint32_t responseTime = end - job.releaseTime;
+
+    job.released = false;
+    job.stats.runs++;
+    job.stats.maxJitter = std::max(job.stats.maxJitter, jitter);
+    job.stats.maxResponseTime = std::max(job.stats.maxResponseTime, responseTime);
+    job.stats.jitterHistogram[jitterToBucket(jitter)]++;
+
+    // Jobs with no deadline (no period and no deadline specified) can't miss their deadline
+    if (job.deadline != 0 && responseTime > job.deadline)
+    {
+        job.stats.deadlineMisses++;
+    }
+}
+
+void PeriodicJobExecutor::assignRateMonotonicPriorities()
+{
+    for (int i = 0; i < jobCount; i++)
+    {
+        if (!jobs[i].autoPriority)
+        {
+            continue;
+        }
+
+        // Priority is the number of auto prioritized jobs with a longer period. Jobs with equal
+        // periods keep the order they were added in.
+        int priority = 0;
+        for (int j = 0; j < jobCount; j++)
+        {
+            if (i != j && jobs[j].autoPriority &&
+                (jobs[j].period > jobs[i].period || (jobs[j].period == jobs[i].period && j > i)))
+            {
+                priority++;
+            }
+        }
+        jobs[i].priority = priority;
+    }
+}
+
+void PeriodicJobExecutor::run()
+{
+    while (true)
+    {
+        update();
+        modm::fiber::yield();
+    }
+}
+}  // namespace tap::arch
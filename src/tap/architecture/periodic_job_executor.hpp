@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PERIODIC_JOB_EXECUTOR_HPP_
+#define TAPROOT_PERIODIC_JOB_EXECUTOR_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/processing/fiber.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::arch
+{
+#ifdef ENV_UNIT_TESTS
+#define PERIODIC_JOB_EXECUTOR_FIBER_STACK_SIZE 4096
+#else
+#define PERIODIC_JOB_EXECUTOR_FIBER_STACK_SIZE 1024
+#endif
+
+/**
+ * A non-preemptive rate monotonic executor for periodic jobs. Instead of checking a
+ * `PeriodicMilliTimer` for each periodic task in `main.cpp`, register each task as a job with a
+ * period, relative deadline, and priority. Each time the executor is updated, every job whose
+ * release time has passed is run, highest priority first. By default priorities are assigned
+ * rate monotonically, i.e. jobs with shorter periods run first.
+ *
+ * For example, a typical main loop can be replaced with the following:
+ *
+ * ```cpp
+ * void pollCan(void *d) { static_cast<Drivers *>(d)->canRxHandler.pollCanData(); }
+ * void updateImu(void *d) { static_cast<Drivers *>(d)->mpu6500.periodicIMUUpdate(); }
+ * void runScheduler(void *d) { static_cast<Drivers *>(d)->commandScheduler.run(); }
+ *
+ * tap::arch::PeriodicJobExecutor executor(drivers);
+ * executor.addJob("can rx", pollCan, drivers, 0);
+ * executor.addJob("imu", updateImu, drivers, 2000);
+ * executor.addJob("scheduler", runScheduler, drivers, 2000);
+ *
+ * modm::fiber::Scheduler::run();
+ * ```
+ *
+ * The executor is a `modm::Fiber` that calls `update()` and yields forever, so it runs alongside
+ * other fibers (such as the `Mpu6500`'s read fiber) in the modm fiber scheduler. Alternatively,
+ * `update()` may be called directly from a loop.
+ *
+ * For each job the executor records the number of releases, deadline misses, the max response
+ * time, and a histogram of release jitter (the time between when a job was released and when it
+ * started running). A deadline is missed if a job finishes more than its deadline after it was
+ * released, or if the job is released again before it was able to run.
+ *
+ * All time is measured in microseconds using `tap::arch::clock::getTimeMicroseconds()`.
+ */
+class PeriodicJobExecutor : public ::modm::Fiber<PERIODIC_JOB_EXECUTOR_FIBER_STACK_SIZE>
+{
+public:
+    /// Max number of jobs that may be added to the executor.
+    static constexpr int MAX_JOBS = 16;
+
+    /**
+     * Number of buckets in each job's jitter histogram. Bucket 0 counts jitter of 0 us and
+     * bucket `i` counts jitter in [2^(i - 1), 2^i) us, with the last bucket counting all larger
+     * jitter.
+     */
+    static constexpr int JITTER_HISTOGRAM_BUCKETS = 12;
+
+    /// Priority value that tells the executor to assign a priority based on the job's period.
+    static constexpr int AUTO_PRIORITY = -1;
+
+    /// Value returned by `addJob` when the job could not be added.
+    static constexpr int INVALID_JOB_ID = -1;
+
+    using JobFunction = void (*)(void *context);
+
+    /**
+     * Timing statistics for a single job.
+     */
+    struct JobStats
+    {
+        /// Number of times the job has been released.
+        uint32_t releases = 0;
+        /// Number of times the job has run.
+        uint32_t runs = 0;
+        /// Number of releases that finished after their deadline or never ran.
+        uint32_t deadlineMisses = 0;
+        /// Largest time between a release and the job finishing, in microseconds.
+        uint32_t maxResponseTime = 0;
+        /// Largest time between a release and the job starting, in microseconds.
+        uint32_t maxJitter = 0;
+        /// Histogram of release jitter, see `JITTER_HISTOGRAM_BUCKETS`.
+        uint32_t jitterHistogram[JITTER_HISTOGRAM_BUCKETS] = {};
+
+        void reset() { *this = JobStats(); }
+    };
+
+    PeriodicJobExecutor(Drivers *drivers);
+    DISALLOW_COPY_AND_ASSIGN(PeriodicJobExecutor)
+    mockable ~PeriodicJobExecutor() = default;
+
+    /**
+     * Adds a job to the executor. The job is first released when the executor is next updated.
+     *
+     * @param[in] name The name of the job, used when reporting timing information.
+     * @param[in] function The function to call each time the job is run. Must not be `nullptr`.
+     * @param[in] context Passed to `function` each time it is called.
+     * @param[in] period The period of the job, in microseconds. A period of 0 means the job is
+     *      released every time the executor is updated.
+     * @param[in] deadline The deadline of the job relative to its release, in microseconds. If 0,
+     *      the deadline is the job's period.
+     * @param[in] priority The priority of the job, higher priority jobs run first. Must be
+     *      `AUTO_PRIORITY` or nonnegative. If `AUTO_PRIORITY`, a priority in [0, MAX_JOBS) is
+     *      assigned such that jobs with shorter periods have higher priority than jobs with longer
+     *      periods. Use priorities >= MAX_JOBS to run a job before all automatically prioritized
+     *      jobs.
+     *
+     * @return The id of the job, used to query job statistics, or `INVALID_JOB_ID` if the job
+     *      could not be added (in which case an error is added to the error handler).
+     */
+    mockable int addJob(
+        const char *name,
+        JobFunction function,
+        void *context,
+        uint32_t period,
+        uint32_t deadline = 0,
+        int priority = AUTO_PRIORITY);
+
+    /**
+     * Runs each job whose release time has passed, highest priority first. After each job runs
+     * the set of released jobs is reevaluated, so a higher priority job released while a lower
+     * priority job was running runs next. At most `MAX_JOBS` jobs are run per call so that jobs
+     * that overrun their period cannot starve the rest of the system.
+     */
+    mockable void update();
+
+    /// @return The number of jobs added to the executor.
+    int getJobCount() const { return jobCount; }
+
+    /// @return The name of the job with the given id, or `nullptr` if the id is invalid.
+    const char *getJobName(int id) const;
+
+    /// @return The priority of the job with the given id, or `AUTO_PRIORITY` if it is invalid.
+    int getJobPriority(int id) const;
+
+    /// @return Timing statistics of the job with the given id, or empty stats if it is invalid.
+    JobStats getJobStats(int id) const;
+
+    /// Resets the timing statistics of all jobs.
+    void resetJobStats();
+
+    /**
+     * @return The index of the jitter histogram bucket that the given jitter, in microseconds,
+     *      falls in.
+     */
+    static int jitterToBucket(uint32_t jitter);
+
+private:
+    struct Job
+    {
+        const char *name = nullptr;
+        JobFunction function = nullptr;
+        void *context = nullptr;
+        uint32_t period = 0;
+        uint32_t deadline = 0;
+        int priority = AUTO_PRIORITY;
+        /// `true` if the priority was assigned by the executor.
+        bool autoPriority = true;
+        /// `true` if the job has been released but has not run yet.
+        bool released = false;
+        /// `true` until the job is released for the first time.
+        bool firstRelease = true;
+        /// Time at which the job was most recently released.
+        uint32_t releaseTime = 0;
+        JobStats stats;
+    };
+
+    Drivers *drivers;
+
+    Job jobs[MAX_JOBS];
+
+    int jobCount = 0;
+
+    /**
+     * Releases every job whose next release time has passed. Jobs with no period and newly
+     * added jobs are only released at the start of an update.
+     */
+    void releaseJobs(uint32_t now, bool startOfUpdate);
+
+    /// @return The index of the highest priority released job, or -1 if none are released.
+    int highestPriorityReleasedJob() const;
+
+    void runJob(Job &job);
+
+    /**
+     * Reassigns priorities of all jobs added with `AUTO_PRIORITY` in rate monotonic order. The
+     * job with the longest period is assigned priority 0, the next longest 1, and so on.
+     */
+    void assignRateMonotonicPriorities();
+
+    /// Fiber entry point, updates the executor then yields forever.
+    void run();
+};
+}  // namespace tap::arch
+
+#endif  // TAPROOT_PERIODIC_JOB_EXECUTOR_HPP_
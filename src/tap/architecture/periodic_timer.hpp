@@ -81,7 +81,7 @@ class PeriodicTimer
             do
             {
                 timeout.expireTime += period;
-            } while (timeout.expireTime <= now);
+            } while (static_cast<int32_t>(timeout.expireTime - now) <= 0);
 
             timeout.isRunning = true;
             timeout.isExecuted = false;
@@ -22,29 +22,22 @@
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
-#include "../algorithms/math_user_utils.hpp"
-
-#include "clock.hpp"
-
 namespace tap::arch
 {
 Profiler::Profiler(tap::Drivers *drivers) : drivers(drivers) {}
 
-std::size_t Profiler::push(const char *profile)
+std::size_t Profiler::findOrAdd(const char *profile)
 {
-    auto index = elementNameToIndexMap.find(profile);
-    if (index != elementNameToIndexMap.end())
+    const std::size_t *index = elementNameToIndexMap.find(profile);
+    if (index != nullptr)
     {
-        ProfilerData *data = &profiledElements[index->second];
-        data->prevPushedTime = clock::getTimeMicroseconds();
-        return index->second;
+        return *index;
     }
     else if (!profiledElements.isFull())
     {
         profiledElements.append(ProfilerData(profile));
         std::size_t key = profiledElements.getSize() - 1;
-        elementNameToIndexMap[profile] = key;
-        profiledElements[key].prevPushedTime = clock::getTimeMicroseconds();
+        elementNameToIndexMap.insert(profile, key);
         return key;
     }
     else
@@ -54,6 +47,28 @@ std::size_t Profiler::push(const char *profile)
     }
 }
 
+std::size_t Profiler::push(const char *profile)
+{
+    std::size_t key = findOrAdd(profile);
+    if (key < profiledElements.getSize())
+    {
+        profiledElements[key].prevPushedTime = clock::getTimeMicroseconds();
+    }
+    return key;
+}
+
+std::size_t Profiler::registerProfile(const char *profile)
+{
+    clock::enableCycleCounter();
+
+    std::size_t key = findOrAdd(profile);
+    if (key < profiledElements.getSize())
+    {
+        profiledElements[key].cycles = true;
+    }
+    return key;
+}
+
 void Profiler::pop(std::size_t key)
 {
     if (key >= profiledElements.getSize())
@@ -67,7 +82,72 @@ void Profiler::pop(std::size_t key)
         data->max = std::max(dt, data->max);
         data->min = std::min(dt, data->min);
         data->avg = algorithms::lowPassFilter(data->avg, dt, AVG_LOW_PASS_ALPHA);
+        if (data->histogram != NO_HISTOGRAM)
+        {
+            recordHistogram(data->histogram, dt);
+        }
+    }
+}
+
+bool Profiler::enableHistogram(std::size_t key, uint32_t windowMs)
+{
+    if (key >= profiledElements.getSize())
+    {
+        return false;
+    }
+
+    ProfilerData *data = &profiledElements[key];
+    if (data->histogram == NO_HISTOGRAM)
+    {
+        if (numHistograms >= MAX_HISTOGRAMS)
+        {
+            return false;
+        }
+        data->histogram = numHistograms++;
+    }
+
+    HistogramWindow *window = &histograms[data->histogram];
+    window->length = windowMs;
+    window->clear();
+    return true;
+}
+
+bool Profiler::getHistogramSummary(std::size_t key, LatencyHistogram::Summary *summary) const
+{
+    const LatencyHistogram *histogram = getHistogram(key);
+    if (histogram == nullptr)
+    {
+        return false;
+    }
+
+    const HistogramWindow &window = histograms[profiledElements.get(key).histogram];
+    *summary = window.length > 0 ? window.lastWindow : histogram->getSummary();
+    return true;
+}
+
+const LatencyHistogram *Profiler::getHistogram(std::size_t key) const
+{
+    if (key >= profiledElements.getSize() || profiledElements.get(key).histogram == NO_HISTOGRAM)
+    {
+        return nullptr;
+    }
+    return &histograms[profiledElements.get(key).histogram].histogram;
+}
+
+void Profiler::recordHistogram(int8_t histogram, uint32_t value)
+{
+    HistogramWindow *window = &histograms[histogram];
+    if (window->length > 0)
+    {
+        uint32_t now = clock::getTimeMilliseconds();
+        if (now - window->start >= window->length)
+        {
+            window->lastWindow = window->histogram.getSummary();
+            window->histogram.clear();
+            window->start = now;
+        }
     }
+    window->histogram.record(value);
 }
 
 }  // namespace tap::arch
@@ -20,10 +20,15 @@
 #ifndef TAPROOT_PROFILER_HPP_
 #define TAPROOT_PROFILER_HPP_
 
-#include <unordered_map>
+
+#include "tap/algorithms/math_user_utils.hpp"
 
 #include "modm/container.hpp"
 
+#include "clock.hpp"
+#include "flat_map.hpp"
+#include "latency_histogram.hpp"
+
 #ifdef RUN_WITH_PROFILING
 #define PROFILE(profiler, func, params) \
     do                                  \
@@ -32,8 +37,17 @@
         func params;                    \
         profiler.pop(key);              \
     } while (0);
+#define PROFILE_CYCLES(profiler, func, params)                                 \
+    do                                                                         \
+    {                                                                          \
+        static const std::size_t profileKey = profiler.registerProfile(#func); \
+        profiler.pushCycles(profileKey);                                       \
+        func params;                                                           \
+        profiler.popCycles(profileKey);                                        \
+    } while (0);
 #else
 #define PROFILE(profiler, func, params) func params
+#define PROFILE_CYCLES(profiler, func, params) func params
 #endif
 
 namespace tap
@@ -90,6 +104,19 @@ namespace tap::arch
  * In this example, the `PROFILE` macro will overwrite the entry in the profiler in a way that makes
  * the profiler information not useful for the `foo` function, so it is recommended that you do not
  * use the `PROFILE` macro for a recursive call.
+ *
+ * Looking up the profile by name on each `push` can cost more than very short code being profiled
+ * and microsecond resolution is too coarse to measure it. For such code, use `PROFILE_CYCLES`
+ * instead, which takes the same arguments. Each `PROFILE_CYCLES` call site registers its profile
+ * once, storing the key in a function-local static, and times the code using the DWT cycle counter
+ * (see `clock::getCycleCount`), so the min, max, and average of these profiles are in core clock
+ * cycles. Since the key is stored per call site, a `PROFILE_CYCLES` call site should only ever be
+ * used with a single profiler, and a profile should not be used with both macros.
+ *
+ * The min, max, and average hide tail latency, such as a rare outlier that delays a control loop.
+ * Up to `MAX_HISTOGRAMS` profiles may also record each measurement in a `LatencyHistogram` (see
+ * `enableHistogram`), from which the p50, p99, and p999 are found. A histogram either accumulates
+ * every measurement or is restarted every window, keeping a summary of the last complete window.
  */
 class Profiler
 {
@@ -98,6 +125,10 @@ class Profiler
     static constexpr std::size_t MAX_PROFILED_ELEMENTS = 128;
     /// Low pass alpha to be used when averaging time it takes for some code to run.
     static constexpr float AVG_LOW_PASS_ALPHA = 0.01f;
+    /// Max number of profiles that may record a histogram.
+    static constexpr int MAX_HISTOGRAMS = 8;
+    /// `ProfilerData::histogram` of a profile that doesn't record a histogram.
+    static constexpr int8_t NO_HISTOGRAM = -1;
 
     /**
      * Stores profile information.
@@ -116,6 +147,10 @@ class Profiler
          * Value used to measure a "dt" between pushing and popping the profile from the profiler.
          */
         uint32_t prevPushedTime = 0;
+        /// `true` if min, max, and avg are in core clock cycles rather than microseconds.
+        bool cycles = false;
+        /// Index of the profile's histogram, or `NO_HISTOGRAM`.
+        int8_t histogram = NO_HISTOGRAM;
 
         ProfilerData() {}
         explicit ProfilerData(const char* name) : name(name) {}
@@ -151,6 +186,78 @@ class Profiler
      */
     void pop(std::size_t key);
 
+    /**
+     * Finds or adds a profile without starting its stopwatch, for use with `pushCycles` and
+     * `popCycles`. Marks the profile as measured in cycles and enables the cycle counter.
+     *
+     * @param[in] profile The name of the profile, compared by pointer as in `push`.
+     * @return The key of the profile, or an invalid key that `pushCycles` and `popCycles`
+     * ignore if the profiler is full.
+     */
+    std::size_t registerProfile(const char* profile);
+
+    /**
+     * Starts the stopwatch of a profile registered with `registerProfile`, using the cycle
+     * counter. Unlike `push`, no lookup is done.
+     *
+     * @param[in] key The key returned by `registerProfile`.
+     */
+    inline void pushCycles(std::size_t key)
+    {
+        if (key < profiledElements.getSize())
+        {
+            profiledElements[key].prevPushedTime = clock::getCycleCount();
+        }
+    }
+
+    /**
+     * Stops the stopwatch of a profile started with `pushCycles` and updates its data, in cycles.
+     *
+     * @param[in] key The key returned by `registerProfile`.
+     */
+    inline void popCycles(std::size_t key)
+    {
+        uint32_t now = clock::getCycleCount();
+        if (key < profiledElements.getSize())
+        {
+            ProfilerData* data = &profiledElements[key];
+            uint32_t dt = now - data->prevPushedTime;
+            data->max = std::max(dt, data->max);
+            data->min = std::min(dt, data->min);
+            data->avg = algorithms::lowPassFilter(data->avg, dt, AVG_LOW_PASS_ALPHA);
+            if (data->histogram != NO_HISTOGRAM)
+            {
+                recordHistogram(data->histogram, dt);
+            }
+        }
+    }
+
+    /**
+     * Starts recording each measurement of a profile in a histogram, in the same units as the
+     * profile's min, max, and avg.
+     *
+     * @param[in] key The key of the profile.
+     * @param[in] windowMs If nonzero, the histogram is summarized and cleared every `windowMs`
+     *      milliseconds, otherwise it accumulates until `reset`.
+     * @return `false` if `key` is invalid or `MAX_HISTOGRAMS` profiles already record a
+     *      histogram, `true` otherwise.
+     */
+    bool enableHistogram(std::size_t key, uint32_t windowMs = 0);
+
+    /**
+     * @param[in] key The key of a profile that records a histogram.
+     * @param[out] summary The summary of the profile's last complete window if it has a window,
+     *      otherwise of every measurement since it was reset.
+     * @return `false` if the profile doesn't record a histogram, `true` otherwise.
+     */
+    bool getHistogramSummary(std::size_t key, LatencyHistogram::Summary* summary) const;
+
+    /// @return The histogram of the profile, or `nullptr` if it doesn't record a histogram.
+    const LatencyHistogram* getHistogram(std::size_t key) const;
+
+    /// @return The number of profiles, which have keys from 0 to the number of profiles - 1.
+    inline std::size_t getNumProfiles() const { return profiledElements.getSize(); }
+
     /// @return The data associated with some particular key.
     inline ProfilerData getData(std::size_t key)
     {
@@ -170,19 +277,50 @@ class Profiler
         if (key < profiledElements.getSize())
         {
             profiledElements[key].reset();
+            if (profiledElements[key].histogram != NO_HISTOGRAM)
+            {
+                histograms[profiledElements[key].histogram].clear();
+            }
         }
     }
 
 private:
     tap::Drivers* drivers;
 
+    /**
+     * Finds the key of a profile, adding it if it has not been seen before.
+     *
+     * @return The key of the profile, or `profiledElements.getSize()` if the profiler is full.
+     */
+    std::size_t findOrAdd(const char* profile);
+
+    struct HistogramWindow
+    {
+        LatencyHistogram histogram;
+        /// Length of the window in milliseconds, 0 if the histogram has no window.
+        uint32_t length = 0;
+        uint32_t start = 0;
+        LatencyHistogram::Summary lastWindow;
+
+        void clear()
+        {
+            histogram.clear();
+            start = clock::getTimeMilliseconds();
+            lastWindow = LatencyHistogram::Summary();
+        }
+    };
+
+    HistogramWindow histograms[MAX_HISTOGRAMS];
+    int numHistograms = 0;
+
+    void recordHistogram(int8_t histogram, uint32_t value);
+
     /**
      * Map element names (function names) to index in profiledElements. Don't directly store
      * ProfilerData's in this map to allow for easier accessability of the elements during
-     * debugging. std::map on the embedded system is scuffed and doesn't allow for easy access to
-     * internal elements.
+     * debugging. Names are compared by address, they are expected to be string literals.
      */
-    std::unordered_map<const char*, std::size_t> elementNameToIndexMap;
+    FlatMap<const char*, std::size_t, MAX_PROFILED_ELEMENTS> elementNameToIndexMap;
 
     /**
      * Array of profiling data information
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiler_terminal_serial_handler.hpp"
+
+#include "tap/drivers.hpp"
+
+namespace tap::arch
+{
+constexpr char ProfilerTerminalSerialHandler::HEADER[];
+constexpr char ProfilerTerminalSerialHandler::USAGE[];
+constexpr algorithms::TokenTableEntry<ProfilerTerminalSerialHandler::Subcommand>
+    ProfilerTerminalSerialHandler::SUBCOMMANDS[];
+
+void ProfilerTerminalSerialHandler::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+bool ProfilerTerminalSerialHandler::terminalSerialCallback(
+    char* inputLine,
+    modm::IOStream& outputStream,
+    bool streamingEnabled)
+{
+    algorithms::TokenView tokens(inputLine);
+    Subcommand subcommand;
+    if (!tokens.nextIn(SUBCOMMANDS, subcommand) || !tokens.empty())
+    {
+        outputStream << USAGE;
+        return false;
+    }
+
+    switch (subcommand)
+    {
+        case Subcommand::TREE:
+            streamMode = StreamMode::TREE;
+            profiler->printTree(outputStream);
+            return true;
+        case Subcommand::TRACE:
+            streamMode = StreamMode::TRACE;
+            printTrace(outputStream);
+            return true;
+        case Subcommand::HIST:
+            streamMode = StreamMode::HISTOGRAMS;
+            printHistograms(outputStream);
+            return true;
+        case Subcommand::FOLDED:
+            profiler->printFolded(outputStream);
+            return !streamingEnabled;
+        case Subcommand::TELEMETRY:
+            addTelemetrySignals(outputStream);
+            return !streamingEnabled;
+        case Subcommand::RESET:
+            profiler->reset();
+            outputStream << "Profile reset" << modm::endl;
+            return !streamingEnabled;
+        case Subcommand::HELP:
+            outputStream << USAGE;
+            return !streamingEnabled;
+    }
+    return false;
+}
+
+void ProfilerTerminalSerialHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
+{
+    switch (streamMode)
+    {
+        case StreamMode::TREE:
+            profiler->printTree(outputStream);
+            break;
+        case StreamMode::TRACE:
+            if (profiler->getTickCount() != lastPrintedTick)
+            {
+                printTrace(outputStream);
+            }
+            break;
+        case StreamMode::HISTOGRAMS:
+            printHistograms(outputStream);
+            break;
+    }
+}
+
+void ProfilerTerminalSerialHandler::printTrace(modm::IOStream& outputStream)
+{
+    lastPrintedTick = profiler->getTickCount();
+    profiler->printTrace(outputStream);
+}
+
+void ProfilerTerminalSerialHandler::printHistograms(modm::IOStream& outputStream)
+{
+    outputStream << "count\tp50\tp99\tp999\tmax\tname (us or cycles)" << modm::endl;
+    for (std::size_t key = 0; key < drivers->profiler.getNumProfiles(); key++)
+    {
+        LatencyHistogram::Summary summary;
+        if (!drivers->profiler.getHistogramSummary(key, &summary))
+        {
+            continue;
+        }
+        outputStream.printf(
+            "%lu\t%lu\t%lu\t%lu\t%lu\t%s\n",
+            static_cast<unsigned long>(summary.count),
+            static_cast<unsigned long>(summary.p50),
+            static_cast<unsigned long>(summary.p99),
+            static_cast<unsigned long>(summary.p999),
+            static_cast<unsigned long>(summary.max),
+            drivers->profiler.getData(key).name);
+    }
+}
+
+void ProfilerTerminalSerialHandler::addTelemetrySignals(modm::IOStream& outputStream)
+{
+    communication::serial::TelemetryStream& telemetry =
+        drivers->terminalSerial.getTelemetryStream();
+
+    int added = 0;
+    for (int i = 0; i < profiler->getNumNodes(); i++)
+    {
+        const HierarchicalProfiler::Node& node = profiler->getNode(i);
+        if (!telemetry.addSignal(node.name, &node.lastTickCycles))
+        {
+            break;
+        }
+        added++;
+    }
+
+    outputStream << "Added " << added << " of " << profiler->getNumNodes()
+                 << " scopes to telemetry" << modm::endl;
+}
+}  // namespace tap::arch
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PROFILER_TERMINAL_SERIAL_HANDLER_HPP_
+#define TAPROOT_PROFILER_TERMINAL_SERIAL_HANDLER_HPP_
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+#include "hierarchical_profiler.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::arch
+{
+/**
+ * Terminal serial handler that prints the call tree and tick traces recorded by a
+ * `HierarchicalProfiler`, and the latency percentiles of the profiles in `Drivers::profiler` that
+ * record a histogram. Streaming "trace" prints the trace of each new tick, which can be captured
+ * on the host and converted with `tools/profile_trace_converter.py`.
+ */
+class ProfilerTerminalSerialHandler : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "profile";
+
+    ProfilerTerminalSerialHandler(Drivers* drivers, HierarchicalProfiler* profiler)
+        : drivers(drivers),
+          profiler(profiler)
+    {
+    }
+    DISALLOW_COPY_AND_ASSIGN(ProfilerTerminalSerialHandler)
+    mockable ~ProfilerTerminalSerialHandler() = default;
+
+    mockable void init();
+
+    bool terminalSerialCallback(
+        char* inputLine,
+        modm::IOStream& outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream& outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: profile <[-H] | [tree] | [folded] | [trace] | [hist] | [telemetry] | [reset]>\n"
+        "  Where:\n"
+        "    - [-H]        prints usage\n"
+        "    - [tree]      prints calls and avg self/inclusive cycles of each scope\n"
+        "    - [folded]    prints total self cycles of each scope as folded stacks\n"
+        "    - [trace]     prints the scopes of the last tick, streams every new tick\n"
+        "    - [hist]      prints count, p50, p99, p999, and max of profiles with a histogram\n"
+        "    - [telemetry] adds the last tick cycles of each scope to the telemetry stream\n"
+        "    - [reset]     clears all scopes\n";
+
+    enum class Subcommand
+    {
+        TREE,
+        TRACE,
+        HIST,
+        FOLDED,
+        TELEMETRY,
+        RESET,
+        HELP,
+    };
+    static constexpr algorithms::TokenTableEntry<Subcommand> SUBCOMMANDS[] = {
+        {"tree", Subcommand::TREE},
+        {"trace", Subcommand::TRACE},
+        {"hist", Subcommand::HIST},
+        {"folded", Subcommand::FOLDED},
+        {"telemetry", Subcommand::TELEMETRY},
+        {"reset", Subcommand::RESET},
+        {"-H", Subcommand::HELP},
+    };
+
+    Drivers* drivers;
+
+    HierarchicalProfiler* profiler;
+
+    enum class StreamMode
+    {
+        TREE,
+        TRACE,
+        HISTOGRAMS,
+    };
+
+    StreamMode streamMode = StreamMode::TREE;
+
+    /// The tick count when a trace was last printed, so that each trace is streamed once.
+    uint32_t lastPrintedTick = 0;
+
+    void printTrace(modm::IOStream& outputStream);
+
+    void printHistograms(modm::IOStream& outputStream);
+
+    void addTelemetrySignals(modm::IOStream& outputStream);
+};  // class ProfilerTerminalSerialHandler
+}  // namespace tap::arch
+
+#endif  // TAPROOT_PROFILER_TERMINAL_SERIAL_HANDLER_HPP_
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_STATIC_ARENA_HPP_
+#define TAPROOT_STATIC_ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/architecture/interface/assert.hpp"
+
+namespace tap::arch
+{
+/**
+ * A fixed size block of statically allocated memory that the objects a robot constructs once at
+ * startup (commands, subsystems, governors, mappings, etc.) are placed in, rather than being
+ * global variables or allocated on the heap.
+ *
+ * The arena's constructor is `constexpr`, so a global arena is initialized before any global
+ * constructor runs and objects can be placed in it in any order. Objects are constructed when
+ * `create` is called, for example from a robot's `initSubsystemCommands` after the `Drivers`
+ * have been initialized, so unlike global objects their construction order is explicit. For
+ * example:
+ *
+ * ```cpp
+ * tap::arch::StaticArena<4096> arena;
+ *
+ * void initializeSubsystemCommands(Drivers *drivers)
+ * {
+ *     auto *chassis = arena.create<ChassisSubsystem>(drivers);
+ *     auto *drive = arena.create<ChassisDriveCommand>(chassis, &drivers->controlOperatorInterface);
+ *     ...
+ * }
+ * ```
+ *
+ * Allocating from the arena moves an offset forward and never fails unpredictably like a heap
+ * allocation can. Objects are never freed or destroyed, so only place objects that live until
+ * the robot is reset in the arena. Use `getUsed` (i.e. print it once at startup) to size the
+ * arena.
+ *
+ * Not thread safe, only create objects from a single context.
+ *
+ * @see `MemoryMonitor::lockHeap` to check that nothing uses the heap after startup.
+ *
+ * @tparam SIZE The size of the arena, in bytes.
+ */
+template <std::size_t SIZE>
+class StaticArena
+{
+public:
+    constexpr StaticArena() : buffer(), used(0) {}
+    DISALLOW_COPY_AND_ASSIGN(StaticArena)
+
+    /**
+     * Allocates uninitialized memory from the arena.
+     *
+     * @param[in] size The number of bytes to allocate.
+     * @param[in] alignment The alignment of the allocated memory, a power of 2.
+     * @return The allocated memory, or `nullptr` if the arena doesn't have room for it.
+     */
+    void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        const uintptr_t start = reinterpret_cast<uintptr_t>(buffer);
+        const std::size_t offset = ((start + used + alignment - 1) & ~(alignment - 1)) - start;
+        if (offset > SIZE || size > SIZE - offset)
+        {
+            return nullptr;
+        }
+        used = offset + size;
+        return buffer + offset;
+    }
+
+    /**
+     * Constructs an object in the arena. Asserts if the arena is full.
+     *
+     * @param[in] args The arguments passed to `T`'s constructor.
+     * @return The constructed object, which is never destroyed.
+     */
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        void *memory = allocate(sizeof(T), alignof(T));
+        modm_assert(memory != nullptr, "StaticArena::create", "arena full");
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Constructs an array of `count` default constructed objects in the arena. Asserts if the
+     * arena is full.
+     *
+     * @return The first object of the array.
+     */
+    template <typename T>
+    T *createArray(std::size_t count)
+    {
+        void *memory = allocate(sizeof(T) * count, alignof(T));
+        modm_assert(memory != nullptr, "StaticArena::createArray", "arena full");
+        T *array = static_cast<T *>(memory);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            new (array + i) T();
+        }
+        return array;
+    }
+
+    /// @return The number of bytes allocated, including padding for alignment.
+    std::size_t getUsed() const { return used; }
+
+    /// @return The number of bytes left, not accounting for the padding the next allocation needs.
+    std::size_t getRemaining() const { return SIZE - used; }
+
+    static constexpr std::size_t getSize() { return SIZE; }
+
+private:
+    alignas(std::max_align_t) uint8_t buffer[SIZE];
+    std::size_t used;
+};  // class StaticArena
+}  // namespace tap::arch
+
+#endif  // TAPROOT_STATIC_ARENA_HPP_
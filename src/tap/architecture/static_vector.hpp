@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_STATIC_VECTOR_HPP_
+#define TAPROOT_STATIC_VECTOR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+
+namespace tap::arch
+{
+/**
+ * A vector with a fixed capacity whose elements are stored inline, so it never allocates. Use it
+ * instead of `std::vector` for lists that are filled at startup (or otherwise bounded), so the
+ * memory they use is known at compile time and their elements are contiguous with the object
+ * that owns them.
+ *
+ * Operations that would exceed the capacity fail and return `false` rather than asserting, so
+ * the owner can raise an error that says what filled up.
+ *
+ * @tparam T The element type, which must be default constructible and copy assignable. All `N`
+ *      elements are default constructed with the vector.
+ * @tparam N The maximum number of elements.
+ */
+template <typename T, std::size_t N>
+class StaticVector
+{
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    constexpr StaticVector() = default;
+
+    /// Holds the first `N` of `values`.
+    constexpr StaticVector(std::initializer_list<T> values)
+    {
+        for (const T &value : values)
+        {
+            if (!push_back(value))
+            {
+                break;
+            }
+        }
+    }
+
+    static constexpr std::size_t capacity() { return N; }
+    constexpr std::size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr bool full() const { return count == N; }
+
+    /// @return `false` if the vector is full, in which case it is unchanged.
+    constexpr bool push_back(const T &value)
+    {
+        if (full())
+        {
+            return false;
+        }
+        values[count++] = value;
+        return true;
+    }
+
+    /// Removes the last element. The vector must not be empty.
+    constexpr void pop_back() { values[--count] = T(); }
+
+    /**
+     * Inserts `value` before `position`, moving the elements after it back one.
+     *
+     * @return The inserted element, or `nullptr` if the vector is full.
+     */
+    iterator insert(const_iterator position, const T &value)
+    {
+        if (full())
+        {
+            return nullptr;
+        }
+        iterator target = begin() + (position - begin());
+        std::move_backward(target, end(), end() + 1);
+        *target = value;
+        count++;
+        return target;
+    }
+
+    /**
+     * Removes the element at `position`, moving the elements after it forward one.
+     *
+     * @return The element that followed the removed one.
+     */
+    iterator erase(const_iterator position)
+    {
+        iterator target = begin() + (position - begin());
+        std::move(target + 1, end(), target);
+        pop_back();
+        return target;
+    }
+
+    /**
+     * Resizes the vector to `newSize` elements, appending copies of `value` if it grows.
+     *
+     * @return `false` if `newSize` is greater than the capacity, in which case the vector is
+     *      unchanged.
+     */
+    constexpr bool resize(std::size_t newSize, const T &value = T())
+    {
+        if (newSize > N)
+        {
+            return false;
+        }
+        while (count > newSize)
+        {
+            pop_back();
+        }
+        while (count < newSize)
+        {
+            values[count++] = value;
+        }
+        return true;
+    }
+
+    constexpr void clear() { resize(0); }
+
+    /// Index without bounds checking. `i` must be less than `size()`.
+    constexpr T &operator[](std::size_t i) { return values[i]; }
+    constexpr const T &operator[](std::size_t i) const { return values[i]; }
+
+    constexpr T &front() { return values[0]; }
+    constexpr const T &front() const { return values[0]; }
+    constexpr T &back() { return values[count - 1]; }
+    constexpr const T &back() const { return values[count - 1]; }
+
+    constexpr T *data() { return values; }
+    constexpr const T *data() const { return values; }
+
+    constexpr iterator begin() { return values; }
+    constexpr const_iterator begin() const { return values; }
+    constexpr iterator end() { return values + count; }
+    constexpr const_iterator end() const { return values + count; }
+
+private:
+    T values[N] = {};
+    std::size_t count = 0;
+};
+}  // namespace tap::arch
+
+#endif  // TAPROOT_STATIC_VECTOR_HPP_
@@ -34,6 +34,10 @@ namespace arch
  * measure of time.
  *
  * Doesn't start until `restart()` is called
+ *
+ * Times are compared by their signed difference, so the timer keeps working when the time
+ * wraps, as long as timeouts are shorter than 2^31 units of time and an expired timer is checked
+ * within 2^31 units of expiring (~36 minutes for `MicroTimeout`).
  */
 template <uint32_t (*T)()>
 class Timeout
@@ -46,6 +50,12 @@ class Timeout
     bool isExecuted;
     uint32_t expireTime;
 
+    /// @return The time until `expireTime`, negative once it has passed, even if time wrapped.
+    inline int32_t timeUntilExpired() const
+    {
+        return static_cast<int32_t>(this->expireTime - TimeFunc());
+    }
+
 public:
     static constexpr auto TimeFunc = T;
 
@@ -88,15 +98,16 @@ class Timeout
      * @return `true` if the timer has expired (timeout has been reached) and is NOT
      * stopped.
      */
-    inline bool isExpired() const { return this->isRunning && TimeFunc() >= this->expireTime; }
+    inline bool isExpired() const { return this->isRunning && timeUntilExpired() <= 0; }
 
     /**
      * @return time left in timer if still running and not yet expired
      */
     inline uint32_t timeRemaining() const
     {
-        if (this->isRunning && TimeFunc() < this->expireTime)
-            return this->expireTime - TimeFunc();
+        const int32_t remaining = timeUntilExpired();
+        if (this->isRunning && remaining > 0)
+            return remaining;
         else
             return 0;
     }
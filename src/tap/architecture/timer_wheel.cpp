@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "timer_wheel.hpp"
+
+#include "clock.hpp"
+
+namespace tap::arch
+{
+TimerWheel::Timer::~Timer()
+{
+    if (wheel != nullptr)
+    {
+        wheel->cancel(*this);
+    }
+}
+
+TimerWheel::TimerWheel() : TimerWheel(clock::getTimeMilliseconds()) {}
+
+TimerWheel::TimerWheel(uint32_t startTime) : currentTime(startTime + 1), updateTime(startTime) {}
+
+TimerWheel::~TimerWheel()
+{
+    for (int level = 0; level < NUM_LEVELS; level++)
+    {
+        for (int slot = 0; slot < SLOTS_PER_LEVEL; slot++)
+        {
+            while (slots[level][slot] != nullptr)
+            {
+                remove(*slots[level][slot]);
+            }
+        }
+    }
+}
+
+void TimerWheel::schedule(Timer &timer, uint32_t timeout)
+{
+    cancel(timer);
+    // The last processed tick is currentTime - 1, so a timeout of 1 expires on the next update
+    timer.expireTime = currentTime - 1 + timeout;
+    timer.period = 0;
+    timer.expired = false;
+    insert(timer);
+}
+
+void TimerWheel::schedulePeriodic(Timer &timer, uint32_t period)
+{
+    schedule(timer, period);
+    timer.period = period;
+}
+
+void TimerWheel::cancel(Timer &timer)
+{
+    if (timer.wheel == this)
+    {
+        remove(timer);
+    }
+}
+
+uint32_t TimerWheel::timeRemaining(const Timer &timer) const
+{
+    if (timer.wheel != this)
+    {
+        return 0;
+    }
+    int32_t remaining = static_cast<int32_t>(timer.expireTime - (currentTime - 1));
+    return remaining > 0 ? remaining : 0;
+}
+
+void TimerWheel::update() { update(clock::getTimeMilliseconds()); }
+
+void TimerWheel::update(uint32_t now)
+{
+    updateTime = now;
+    while (static_cast<int32_t>(now - currentTime) >= 0)
+    {
+        if (numScheduled == 0)
+        {
+            // Nothing to expire, skip the ticks in between
+            currentTime = now + 1;
+            return;
+        }
+
+        const uint32_t tick = currentTime;
+        // Move timers down from each level whose slot changes this tick, starting from the top,
+        // so timers from above that land in a lower level's current slot are moved down too
+        for (int level = NUM_LEVELS - 1; level > 0; level--)
+        {
+            const int shift = BITS_PER_LEVEL * level;
+            if ((tick & ((1ul << shift) - 1)) == 0)
+            {
+                cascade(level, (tick >> shift) & (SLOTS_PER_LEVEL - 1));
+            }
+        }
+
+        // Move the slot to the expiring list, so timers scheduled by callbacks go in the slot
+        // for the next tick, and timers cancelled by callbacks are removed from the list
+        Timer *&slot = slots[0][tick & (SLOTS_PER_LEVEL - 1)];
+        expiring = slot;
+        slot = nullptr;
+        for (Timer *timer = expiring; timer != nullptr; timer = timer->next)
+        {
+            timer->level = EXPIRING_LEVEL;
+        }
+        currentTime = tick + 1;
+
+        while (expiring != nullptr)
+        {
+            Timer &timer = *expiring;
+            remove(timer);
+            expire(timer);
+        }
+    }
+}
+
+void TimerWheel::insert(Timer &timer)
+{
+    // Timers that are already due expire on the next tick
+    int32_t delta = static_cast<int32_t>(timer.expireTime - currentTime);
+    uint32_t time = delta < 0 ? currentTime : timer.expireTime;
+    uint32_t ticks = delta < 0 ? 0 : delta;
+
+    int level = 0;
+    while (level < NUM_LEVELS - 1 && ticks >= (1ul << (BITS_PER_LEVEL * (level + 1))))
+    {
+        level++;
+    }
+    if (ticks >= RANGE)
+    {
+        // Park the timer in the top level slot furthest away, it is moved down from there
+        time = currentTime + RANGE - 1;
+    }
+
+    int slot = (time >> (BITS_PER_LEVEL * level)) & (SLOTS_PER_LEVEL - 1);
+
+    timer.wheel = this;
+    timer.level = level;
+    timer.slot = slot;
+    timer.prev = nullptr;
+    timer.next = slots[level][slot];
+    if (timer.next != nullptr)
+    {
+        timer.next->prev = &timer;
+    }
+    slots[level][slot] = &timer;
+    numScheduled++;
+}
+
+void TimerWheel::remove(Timer &timer)
+{
+    if (timer.prev != nullptr)
+    {
+        timer.prev->next = timer.next;
+    }
+    else if (timer.level == EXPIRING_LEVEL)
+    {
+        expiring = timer.next;
+    }
+    else
+    {
+        slots[timer.level][timer.slot] = timer.next;
+    }
+    if (timer.next != nullptr)
+    {
+        timer.next->prev = timer.prev;
+    }
+    timer.prev = nullptr;
+    timer.next = nullptr;
+    timer.wheel = nullptr;
+    numScheduled--;
+}
+
+void TimerWheel::cascade(int level, int slot)
+{
+    Timer *timer = slots[level][slot];
+    slots[level][slot] = nullptr;
+    while (timer != nullptr)
+    {
+        Timer *next = timer->next;
+        numScheduled--;
+        insert(*timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::expire(Timer &timer)
+{
+    timer.expired = true;
+    if (timer.period != 0)
+    {
+        // Like PeriodicTimer, skip the periods missed by a late update
+        do
+        {
+            timer.expireTime += timer.period;
+        } while (static_cast<int32_t>(timer.expireTime - updateTime) <= 0);
+        insert(timer);
+    }
+    if (timer.callback != nullptr)
+    {
+        timer.callback(timer.context);
+    }
+}
+}  // namespace tap::arch
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TIMER_WHEEL_HPP_
+#define TAPROOT_TIMER_WHEEL_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+namespace tap::arch
+{
+/**
+ * A hierarchical timer wheel that expires many timers for the cost of a single `update` per
+ * tick, an alternative to each object polling its own `Timeout`. A tick is a millisecond.
+ *
+ * Each `Timer` is owned by the object that uses it and linked into a slot of the wheel by
+ * `schedule`, so the wheel allocates nothing and holds any number of timers. The wheel has
+ * `NUM_LEVELS` levels of `SLOTS_PER_LEVEL` slots. Level 0 holds timers expiring in the next
+ * `SLOTS_PER_LEVEL` ticks, one slot per tick, and each higher level covers `SLOTS_PER_LEVEL`
+ * times as much time per slot. Each tick, `update` expires the timers in one slot of level 0,
+ * and every `SLOTS_PER_LEVEL` ticks it moves the timers in the next slot of the level above
+ * down a level. Scheduling and cancelling a timer is O(1), and since a timer moves down at most
+ * `NUM_LEVELS - 1` times, expiring it is O(1) amortized.
+ *
+ * An expired timer sets its flag, which `Timer::execute` returns and clears like
+ * `Timeout::execute`, and calls its callback, if it has one. For example:
+ *
+ * ```cpp
+ * TimerWheel wheel;
+ * TimerWheel::Timer disconnectTimer;
+ * TimerWheel::Timer blinkTimer(toggleLed, &leds);
+ *
+ * wheel.schedulePeriodic(blinkTimer, 500);
+ *
+ * void onMessageReceived() { wheel.schedule(disconnectTimer, 100); }
+ *
+ * void mainLoop()
+ * {
+ *     wheel.update();
+ *     if (disconnectTimer.execute())
+ *     {
+ *         // No message for 100 ms
+ *     }
+ * }
+ * ```
+ *
+ * The wheel is not reentrant, so only use it from a single context (i.e. not from both the main
+ * loop and an interrupt). Callbacks may schedule and cancel timers.
+ */
+class TimerWheel
+{
+public:
+    static constexpr int BITS_PER_LEVEL = 6;
+    static constexpr int SLOTS_PER_LEVEL = 1 << BITS_PER_LEVEL;
+    static constexpr int NUM_LEVELS = 4;
+    /**
+     * Timers further in the future than this many ticks are parked in the top level and moved
+     * back down once they are within range, so any timeout less than 2^31 ticks works.
+     */
+    static constexpr uint32_t RANGE = 1ul << (BITS_PER_LEVEL * NUM_LEVELS);
+
+    using Callback = void (*)(void *context);
+
+    /**
+     * A timer that can be scheduled in a `TimerWheel`. Cancels itself when destroyed.
+     */
+    class Timer
+    {
+    public:
+        Timer() = default;
+
+        /// @param[in] callback Called with `context` when the timer expires.
+        explicit Timer(Callback callback, void *context = nullptr)
+            : callback(callback),
+              context(context)
+        {
+        }
+        DISALLOW_COPY_AND_ASSIGN(Timer)
+        ~Timer();
+
+        /// @return `true` if the timer is scheduled to expire.
+        bool isScheduled() const { return wheel != nullptr; }
+
+        /// @return `true` if the timer has expired since `execute` was last called.
+        bool isExpired() const { return expired; }
+
+        /**
+         * @return `true` the first time this is called after the timer expired, like
+         *      `Timeout::execute`.
+         */
+        bool execute()
+        {
+            bool wasExpired = expired;
+            expired = false;
+            return wasExpired;
+        }
+
+    private:
+        friend class TimerWheel;
+
+        Callback callback = nullptr;
+        void *context = nullptr;
+
+        TimerWheel *wheel = nullptr;
+        Timer *prev = nullptr;
+        Timer *next = nullptr;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+
+        uint32_t expireTime = 0;
+        /// If nonzero, the timer is rescheduled `period` ticks after it expires.
+        uint32_t period = 0;
+        bool expired = false;
+    };
+
+    /// Starts the wheel at the current time, see `tap::arch::clock::getTimeMilliseconds`.
+    TimerWheel();
+
+    /// @param[in] startTime The tick to start the wheel at.
+    explicit TimerWheel(uint32_t startTime);
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel)
+    ~TimerWheel();
+
+    /**
+     * Schedules the timer to expire `timeout` ticks from now, rescheduling it if it is already
+     * scheduled. Clears the timer's expired flag. A timeout of 0 expires on the next `update`.
+     */
+    void schedule(Timer &timer, uint32_t timeout);
+
+    /**
+     * Schedules the timer to expire every `period` ticks, the first time `period` ticks from now.
+     * Like `PeriodicTimer`, expirations stay aligned to the period even if `update` is late.
+     */
+    void schedulePeriodic(Timer &timer, uint32_t period);
+
+    /// Cancels the timer if it is scheduled. Doesn't clear its expired flag.
+    void cancel(Timer &timer);
+
+    /// @return The number of ticks until the timer expires, or 0 if it isn't scheduled.
+    uint32_t timeRemaining(const Timer &timer) const;
+
+    /// Expires all timers due by the current time.
+    void update();
+
+    /// Expires all timers due by tick `now`.
+    void update(uint32_t now);
+
+    /// @return The number of scheduled timers.
+    int getNumScheduled() const { return numScheduled; }
+
+private:
+    /// `Timer::level` of the timers in `expiring`.
+    static constexpr uint8_t EXPIRING_LEVEL = NUM_LEVELS;
+
+    Timer *slots[NUM_LEVELS][SLOTS_PER_LEVEL] = {};
+
+    /// The timers of the tick being processed that haven't expired yet.
+    Timer *expiring = nullptr;
+
+    /// The next tick `update` will process.
+    uint32_t currentTime;
+
+    /// The tick passed to the most recent `update`.
+    uint32_t updateTime;
+
+    int numScheduled = 0;
+
+    /// Links the timer into the slot for its `expireTime`.
+    void insert(Timer &timer);
+
+    /// Unlinks the timer from its slot.
+    void remove(Timer &timer);
+
+    /// Reinserts the timers in a slot, which moves them down a level once they are in range.
+    void cascade(int level, int slot);
+
+    void expire(Timer &timer);
+};  // class TimerWheel
+}  // namespace tap::arch
+
+#endif  // TAPROOT_TIMER_WHEEL_HPP_
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trace_ring.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "tap/board/board.hpp"
+#endif
+
+namespace tap::arch
+{
+TraceRing *TraceRing::activeRing = nullptr;
+
+TraceRing::~TraceRing()
+{
+    if (activeRing == this)
+    {
+        activeRing = nullptr;
+    }
+}
+
+bool TraceRing::pop(TraceEvent &event)
+{
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+    if (head == tail)
+    {
+        return false;
+    }
+    event = events[head & (CAPACITY - 1)];
+    head++;
+    return true;
+}
+
+void TraceRing::clear()
+{
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+    head = tail;
+    numDropped = 0;
+}
+
+#ifndef PLATFORM_HOSTED
+/// Reading a stimulus port returns 1 when it can accept another write.
+static inline void waitForItmPort()
+{
+    while (ITM->PORT[TraceRing::ITM_PORT].u32 == 0)
+    {
+    }
+}
+
+void TraceRing::initializeItm(uint32_t swoBaudRate)
+{
+    clock::enableCycleCounter();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    // Output the trace on the SWO pin in asynchronous mode
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+    // NRZ (UART) encoding, the TPIU is clocked by the core clock
+    TPI->SPPR = 2;
+    TPI->ACPR = Board::SystemClock::Frequency / swoBaudRate - 1;
+    // Bypass the formatter, so the stream only contains ITM packets
+    TPI->FFCR = 0x100;
+
+    ITM->LAR = 0xC5AC'CE55;
+    ITM->TCR = ITM_TCR_ITMENA_Msk | ITM_TCR_SYNCENA_Msk | (1 << ITM_TCR_TraceBusID_Pos);
+    ITM->TPR = 0;
+    ITM->TER |= 1ul << ITM_PORT;
+}
+
+int TraceRing::drainToItm(int maxEvents)
+{
+    if ((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0 || (ITM->TER & (1ul << ITM_PORT)) == 0)
+    {
+        return 0;
+    }
+
+    int numDrained = 0;
+    TraceEvent event;
+    while (numDrained < maxEvents && ITM->PORT[ITM_PORT].u32 != 0 && pop(event))
+    {
+        ITM->PORT[ITM_PORT].u16 = event.id;
+        waitForItmPort();
+        ITM->PORT[ITM_PORT].u32 = event.timestamp;
+        waitForItmPort();
+        ITM->PORT[ITM_PORT].u32 = event.arg;
+        numDrained++;
+    }
+    return numDrained;
+}
+#endif
+}  // namespace tap::arch
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TRACE_RING_HPP_
+#define TAPROOT_TRACE_RING_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "clock.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#endif
+
+#ifdef RUN_WITH_TRACING
+#define TRACE_EVENT(id, arg) \
+    ::tap::arch::TraceRing::recordToActive(static_cast<uint16_t>(id), static_cast<uint32_t>(arg))
+#else
+#define TRACE_EVENT(id, arg)
+#endif
+
+namespace tap::arch
+{
+/**
+ * Ids of the events recorded by taproot. Robot code may record its own events with ids from
+ * `USER` up. Keep `tools/trace_decoder.py` in sync when adding ids.
+ */
+enum class TraceEventId : uint16_t
+{
+    /// A command was added to the scheduler, arg is its global id.
+    COMMAND_INITIALIZE = 1,
+    /// The scheduler executed a command, arg is its global id.
+    COMMAND_EXECUTE = 2,
+    /// A command was removed from the scheduler, arg is its global id.
+    COMMAND_END = 3,
+    /// A CAN frame was received, arg is its identifier, with bit 31 set for CAN2.
+    CAN_RX = 4,
+    /// An IMU sample was read, arg is the number of samples read since the previous event.
+    IMU_SAMPLE = 5,
+    /// A complete, valid `DJISerial` frame was received, arg is `(port << 16) | messageType`.
+    UART_FRAME = 6,
+    USER = 0x100,
+};
+
+struct TraceEvent
+{
+    uint16_t id;
+    /// The cycle count the event was recorded at, see `tap::arch::clock::getCycleCount`.
+    uint32_t timestamp;
+    uint32_t arg;
+};
+
+/**
+ * A fixed-size ring of timestamped trace events, cheap enough to record from interrupts and the
+ * scheduler's inner loop. Where the profiler measures how long code takes, the trace shows the
+ * order and spacing of events, e.g. whether CAN frames arrive between a command reading motor
+ * feedback and the scheduler sending it.
+ *
+ * Code records events with the `TRACE_EVENT` macro, which records to the active ring (see
+ * `setActive`) and compiles to nothing unless the program is built with `tracing=true`. On the
+ * hardware, the main loop drains the ring to the ITM, which streams it over the SWO pin to the
+ * debugger, and `tools/trace_decoder.py` decodes the captured stream. For example:
+ *
+ * ```cpp
+ * TraceRing traceRing;
+ *
+ * int main()
+ * {
+ *     TraceRing::setActive(&traceRing);
+ *     traceRing.initializeItm(2'000'000);
+ *     while (true)
+ *     {
+ *         TRACE_EVENT(TraceEventId::USER, loopCount++);
+ *         ...
+ *         traceRing.drainToItm(16);
+ *     }
+ * }
+ * ```
+ *
+ * Recording is safe from any context. When the ring is full, new events are dropped and counted.
+ */
+class TraceRing
+{
+public:
+    /// Must be a power of 2.
+    static constexpr uint32_t CAPACITY = 256;
+
+    /// The ITM stimulus port events are written to.
+    static constexpr uint32_t ITM_PORT = 1;
+
+    TraceRing() = default;
+    DISALLOW_COPY_AND_ASSIGN(TraceRing)
+    ~TraceRing();
+
+    /// Sets the ring `TRACE_EVENT` records to, or `nullptr` for none.
+    static void setActive(TraceRing *ring) { activeRing = ring; }
+
+    static TraceRing *getActive() { return activeRing; }
+
+    /// Records an event to the active ring, if there is one.
+    static inline void recordToActive(uint16_t id, uint32_t arg)
+    {
+        if (activeRing != nullptr)
+        {
+            activeRing->record(id, arg);
+        }
+    }
+
+    /// Records an event timestamped with the current cycle count, or drops it if the ring is full.
+    inline void record(uint16_t id, uint32_t arg)
+    {
+        const uint32_t timestamp = clock::getCycleCount();
+#ifndef PLATFORM_HOSTED
+        modm::atomic::Lock lock;
+#endif
+        if (tail - head >= CAPACITY)
+        {
+            numDropped++;
+            return;
+        }
+        events[tail & (CAPACITY - 1)] = {id, timestamp, arg};
+        tail++;
+    }
+
+    /// Removes the oldest event. @return `false` if the ring is empty.
+    bool pop(TraceEvent &event);
+
+    /// @return The number of events in the ring.
+    uint32_t size() const { return tail - head; }
+
+    /// @return The number of events dropped because the ring was full.
+    uint32_t getNumDropped() const { return numDropped; }
+
+    /// Removes all events and resets the drop count.
+    void clear();
+
+#ifndef PLATFORM_HOSTED
+    /**
+     * Enables the ITM and routes it to the SWO pin as an asynchronous (UART) stream at
+     * `swoBaudRate`, which the debugger must be configured to receive at. Also enables the cycle
+     * counter events are timestamped with.
+     */
+    void initializeItm(uint32_t swoBaudRate);
+
+    /**
+     * Writes up to `maxEvents` events to `ITM_PORT`, each as a 2-byte id, a 4-byte timestamp and
+     * a 4-byte arg. Stops early if the ITM is busy, so it never blocks the main loop for more
+     * than an event, and does nothing if no debugger enabled the ITM.
+     *
+     * @return The number of events written.
+     */
+    int drainToItm(int maxEvents);
+#endif
+
+private:
+    static TraceRing *activeRing;
+
+    TraceEvent events[CAPACITY] = {};
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t numDropped = 0;
+};  // class TraceRing
+}  // namespace tap::arch
+
+#endif  // TAPROOT_TRACE_RING_HPP_
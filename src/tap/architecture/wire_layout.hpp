@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_WIRE_LAYOUT_HPP_
+#define TAPROOT_WIRE_LAYOUT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "endianness_wrappers.hpp"
+
+namespace tap::arch
+{
+/**
+ * A field of a wire format (e.g. a CAN frame or serial message): a value of type `T` stored at
+ * byte `Offset` in byte order `E`. See `WireLayout`.
+ */
+template <typename T, size_t Offset, Endianness E = Endianness::LITTLE>
+struct WireField
+{
+    using Type = T;
+    static constexpr size_t OFFSET = Offset;
+    static constexpr size_t SIZE = sizeof(T);
+
+    /// @return the field's value in the message `bytes`.
+    static constexpr T read(const uint8_t *bytes) { return loadFromBytes<T, E>(bytes + OFFSET); }
+
+    /// Writes the field's value into the message `bytes`.
+    static constexpr void write(uint8_t *bytes, T value)
+    {
+        storeToBytes<T, E>(value, bytes + OFFSET);
+    }
+};
+
+namespace detail
+{
+template <typename... Fields>
+constexpr bool fieldsOverlap()
+{
+    constexpr size_t offsets[] = {Fields::OFFSET...};
+    constexpr size_t sizes[] = {Fields::SIZE...};
+    for (size_t i = 0; i < sizeof...(Fields); i++)
+    {
+        for (size_t j = i + 1; j < sizeof...(Fields); j++)
+        {
+            if (offsets[i] < offsets[j] + sizes[j] && offsets[j] < offsets[i] + sizes[i])
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+}  // namespace detail
+
+/**
+ * Describes the layout of a wire format once, as a list of `WireField`s, and decodes or encodes
+ * a whole message at a time. Since offsets, sizes and byte orders are all template parameters,
+ * each field compiles to a single load or store (plus a byte reverse for fields stored in the
+ * other byte order), with no runtime branches. For example, a DJI motor's feedback frame:
+ *
+ * ```cpp
+ * using Feedback = WireLayout<
+ *     WireField<uint16_t, 0, Endianness::BIG>,  // encoder
+ *     WireField<int16_t, 2, Endianness::BIG>,   // rpm
+ *     WireField<int16_t, 4, Endianness::BIG>,   // torque
+ *     WireField<int8_t, 6>>;                    // temperature
+ *
+ * auto [encoder, rpm, torque, temperature] = Feedback::decode(message.data);
+ * ```
+ *
+ * Fields are checked at compile time not to overlap. They needn't be in order or cover every
+ * byte of the message.
+ */
+template <typename... Fields>
+class WireLayout
+{
+public:
+    static_assert(sizeof...(Fields) > 0, "a layout needs at least one field");
+
+    /// The values of every field, in the order the fields are listed.
+    using Values = std::tuple<typename Fields::Type...>;
+
+    /// Number of bytes spanned by the fields, from the start of the message.
+    static constexpr size_t SIZE = std::max({(Fields::OFFSET + Fields::SIZE)...});
+
+    /// The `I`th field.
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    /// @return the values of every field in the `SIZE` bytes of `bytes`.
+    static constexpr Values decode(const uint8_t *bytes) { return Values(Fields::read(bytes)...); }
+
+    /// Writes `values` to their fields in the `SIZE` bytes of `bytes`, leaving other bytes as is.
+    static constexpr void encode(uint8_t *bytes, const typename Fields::Type &...values)
+    {
+        (Fields::write(bytes, values), ...);
+    }
+
+    static_assert(!detail::fieldsOverlap<Fields...>(), "fields of a WireLayout must not overlap");
+};
+}  // namespace tap::arch
+
+#endif  // TAPROOT_WIRE_LAYOUT_HPP_
@@ -19,10 +19,22 @@
 
 #include "board.hpp"
 
+#include "tap/errors/crash_recorder.hpp"
+
 // In simulation, we'll let modm's default implementation handle this.
 #ifndef PLATFORM_HOSTED
-modm_extern_c void modm_abandon(const modm::AssertionInfo &)
+modm_extern_c void modm_abandon(const modm::AssertionInfo &info)
 {
+    tap::errors::CrashRecorder *recorder = tap::errors::CrashRecorder::getActiveRecorder();
+    if (recorder != nullptr)
+    {
+#if MODM_ASSERTION_INFO_HAS_DESCRIPTION
+        recorder->captureAssertion(info.name, info.description, info.context);
+#else
+        recorder->captureAssertion(info.name, nullptr, info.context);
+#endif
+    }
+
     Board::LedsPort::setOutput();
     for (int times = 10; times >= 0; times--)
     {
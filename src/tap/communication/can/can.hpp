@@ -20,9 +20,12 @@
 #ifndef TAPROOT_CAN_HPP_
 #define TAPROOT_CAN_HPP_
 
+#include <cstdint>
+
 #include "tap/util_macros.hpp"
 
 #include "can_bus.hpp"
+#include "can_rx_filter.hpp"
 
 namespace modm::can
 {
@@ -35,10 +38,59 @@ namespace can
 {
 /**
  * A simple CAN wrapper class that handles I/O from both CAN bus 1 and 2.
+ *
+ * Received frames are read by the CAN RX interrupt directly into a lock-free ring per bus (see
+ * `CanRxRing`), whose size is set by the `taproot:communication:can:rx_ring_size` lbuild option.
+ * Frames may be read in place with `peekMessage` and `popMessage`, or copied out with
+ * `getMessage`.
+ *
+ * Each bus's hardware acceptance filters may be set with `setRxFilters`. The `CanRxHandler`
+ * does so whenever its set of listeners changes, so only frames that a listener is attached to
+ * cause an interrupt.
+ *
+ * Per bus statistics (frame counts, dropped frames, error events, and bus load) are recorded
+ * for frames read and sent through this class and may be queried with `getBusStats`.
  */
 class Can
 {
 public:
+    /// Bit rate of both CAN buses, in bits per second.
+    static constexpr uint32_t BIT_RATE = 1'000'000;
+
+    /// Period over which bus load is measured, in microseconds.
+    static constexpr uint32_t BUS_LOAD_SAMPLE_PERIOD_US = 100'000;
+
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    /**
+     * Statistics for a single CAN bus.
+     */
+    struct BusStats
+    {
+        /// Number of frames received and read from the bus's RX ring.
+        uint32_t rxFrames = 0;
+        /// Number of frames successfully queued for transmission.
+        uint32_t txFrames = 0;
+        /// Number of frames that failed to be queued for transmission by `sendMessage`.
+        uint32_t txFailures = 0;
+        /// Number of frames that were not sent because `isReadyToSend` returned false.
+        uint32_t txDrops = 0;
+        /// Number of received frames dropped because the bus's RX ring was full.
+        uint32_t rxOverflows = 0;
+        /// Number of received frames with an identifier no `CanRxListener` was attached to.
+        uint32_t unmatchedRxFrames = 0;
+        /// Number of times the CAN peripheral entered the error passive state.
+        uint32_t errorPassiveEvents = 0;
+        /// Number of times the CAN peripheral entered the bus off state.
+        uint32_t busOffEvents = 0;
+        /**
+         * Percent of the bus's bandwidth used by frames received and sent over the most recent
+         * `BUS_LOAD_SAMPLE_PERIOD_US`, assuming worst case bit stuffing. Frames on the bus that
+         * are not accepted by the CAN filters are not included.
+         */
+        float busLoad = 0;
+    };
+
     Can() = default;
     DISALLOW_COPY_AND_ASSIGN(Can)
     mockable ~Can() = default;
@@ -51,6 +103,8 @@ class Can
      * @note CAN 1 is connected to pins D0 (RX) and D1 (TX) and
      *      CAN 2 is connected to pins B12 (RX) and B12 (TX).
      * @note The CAN filters are set up to receive NOT extended identifier IDs.
+     * @note Accepted frames are routed to each CAN peripheral's FIFO 1, which is drained into
+     *      the bus's RX ring by the CAN RX1 interrupt.
      */
     mockable void initialize();
 
@@ -76,6 +130,30 @@ class Can
      */
     mockable bool getMessage(CanBus bus, modm::can::Message *message);
 
+    /**
+     * @param[in] bus the CanBus to read a message from.
+     * @return A pointer to the oldest received message on the given bus, stored in place in the
+     *      bus's RX ring, or `nullptr` if no message is available. The message remains valid
+     *      until `popMessage` is called for the bus.
+     */
+    mockable const modm::can::Message *peekMessage(CanBus bus);
+
+    /**
+     * Removes the message returned by the last call to `peekMessage` on the given bus.
+     *
+     * @param[in] bus the CanBus to remove a message from.
+     */
+    mockable void popMessage(CanBus bus);
+
+    /**
+     * @param[in] bus the CanBus to read a timestamp from.
+     * @return The time at which the message returned by `peekMessage` was received, in
+     *      microseconds (see `tap::arch::clock::getTimeMicroseconds`), or 0 if no message is
+     *      available. Messages are timestamped by the CAN RX interrupt, so the timestamp does not
+     *      depend on how long the message waited in the RX ring.
+     */
+    mockable uint32_t getMessageTimestamp(CanBus bus);
+
     /**
      * Checks the given CanBus to see if the CanBus is idle.
      *
@@ -94,11 +172,103 @@ class Can
      * when instantiating a message object and setting extended to
      * false.
      *
+     * Safe to call from interrupts, the message is queued and recorded with interrupts disabled.
+     *
      * @param[in] bus the `CanBus` for which the message should be sent across.
      * @param[in] message the message to send
      * @return true if the message was successfully sent, false otherwise.
      */
     mockable bool sendMessage(CanBus bus, const modm::can::Message &message);
+
+    /**
+     * Sets the hardware acceptance filters of the given bus so that only frames with standard
+     * identifiers accepted by at least one of the filters are received. If the CAN hardware has
+     * not been initialized, the filters are programmed when `initialize` is called.
+     *
+     * @param[in] bus the CanBus to set the filters of.
+     * @param[in] filters the filters to program. If `count` is 0, all frames are accepted.
+     * @param[in] count the number of filters, at most `CanRxFilterBuilder::MAX_FILTERS`.
+     */
+    mockable void setRxFilters(CanBus bus, const CanRxFilter *filters, int count);
+
+    /// @return The number of acceptance filters set for the given bus, 0 if all are accepted.
+    int getRxFilterCount(CanBus bus) const { return rxFilterCounts[busIndex(bus)]; }
+
+    /// @return The acceptance filters set for the given bus.
+    const CanRxFilter *getRxFilters(CanBus bus) const { return rxFilters[busIndex(bus)]; }
+
+    /**
+     * Updates the bus load of the given bus if a bus load sample period has elapsed and
+     * returns the bus's statistics.
+     *
+     * @param[in] bus the CanBus to get statistics for.
+     */
+    const BusStats &getBusStats(CanBus bus);
+
+    /// Resets the statistics of both buses.
+    void resetBusStats();
+
+    /// Records that the given frame was read from the given bus.
+    void recordRxFrame(CanBus bus, const modm::can::Message &message);
+
+    /**
+     * Records an attempt to send the given frame on the given bus.
+     *
+     * @param[in] sent `true` if the frame was successfully queued for transmission.
+     */
+    void recordTxFrame(CanBus bus, const modm::can::Message &message, bool sent);
+
+    /**
+     * Records that `frames` frames were not sent on the given bus because it was not ready. Safe
+     * to call from interrupts.
+     */
+    void recordTxDrops(CanBus bus, uint32_t frames);
+
+    /// Records that a frame with no attached `CanRxListener` was received on the given bus.
+    void recordUnmatchedRxFrame(CanBus bus);
+
+    /**
+     * Records the error state of the CAN peripheral of the given bus, counting each time the
+     * peripheral enters the error passive or bus off state.
+     */
+    void recordErrorState(CanBus bus, bool errorPassive, bool busOff);
+
+    /**
+     * @return The number of bits on the bus used to transmit the given frame, including worst
+     *      case bit stuffing and the interframe space.
+     */
+    static uint32_t getFrameBits(const modm::can::Message &message);
+
+private:
+    /// Bookkeeping used to compute a bus's statistics.
+    struct BusState
+    {
+        /// Bits received and sent in the current sample period.
+        uint32_t bits = 0;
+        /// Start of the current sample period, in microseconds.
+        uint32_t startTime = 0;
+        bool started = false;
+        /// State of the peripheral when `recordErrorState` was last called.
+        bool errorPassive = false;
+        bool busOff = false;
+        /// RX ring overflow count when the statistics were last reset.
+        uint32_t rxOverflowBaseline = 0;
+    };
+
+    BusStats busStats[NUM_CAN_BUSES];
+
+    BusState busStates[NUM_CAN_BUSES];
+
+    CanRxFilter rxFilters[NUM_CAN_BUSES][CanRxFilterBuilder::MAX_FILTERS];
+
+    int rxFilterCounts[NUM_CAN_BUSES] = {};
+
+    bool initialized = false;
+
+    /// Writes the stored acceptance filters of the given bus to the CAN filter banks.
+    void programRxFilters(CanBus bus);
+
+    static inline int busIndex(CanBus bus) { return bus == CanBus::CAN_BUS1 ? 0 : 1; }
 };  // class Can
 
 }  // namespace can
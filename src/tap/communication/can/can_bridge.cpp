@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_bridge.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+namespace tap::can
+{
+CanBridgeTxChannel::CanBridgeTxChannel(uint32_t canId, uint8_t length, uint8_t period)
+    : message(canId, std::min(length, MAX_LENGTH)),
+      period(period)
+{
+    message.setExtended(false);
+}
+
+void CanBridgeTxChannel::publish(const void *data)
+{
+    memcpy(message.data, data, message.getLength());
+    published = true;
+}
+
+CanBridgeRxChannel::CanBridgeRxChannel(
+    Drivers *drivers,
+    uint32_t canId,
+    CanBus bus,
+    uint8_t length,
+    uint32_t timeoutUs)
+    : CanRxListener(drivers, canId, bus),
+      length(std::min(length, CanBridgeTxChannel::MAX_LENGTH)),
+      timeoutUs(timeoutUs)
+{
+}
+
+void CanBridgeRxChannel::processMessage(const modm::can::Message &message)
+{
+    if (message.getLength() != length)
+    {
+        numLengthErrors++;
+        return;
+    }
+    memcpy(data, message.data, length);
+    lastReceiveTimeUs = drivers->canRxHandler.getRxTimestamp();
+    numReceived++;
+}
+
+bool CanBridgeRxChannel::isFresh() const { return getAgeUs() < timeoutUs; }
+
+uint32_t CanBridgeRxChannel::getAgeUs() const
+{
+    if (numReceived == 0)
+    {
+        return UINT32_MAX;
+    }
+    return arch::clock::getTimeMicroseconds() - lastReceiveTimeUs;
+}
+
+static int16_t packQ15(float value)
+{
+    return static_cast<int16_t>(lroundf(std::clamp(value, -1.0f, 1.0f) * INT16_MAX));
+}
+
+CanBridgeQuaternion CanBridgeQuaternion::pack(const algorithms::transforms::Quaternion &q)
+{
+    CanBridgeQuaternion packed;
+    packed.w = packQ15(q.w);
+    packed.x = packQ15(q.x);
+    packed.y = packQ15(q.y);
+    packed.z = packQ15(q.z);
+    return packed;
+}
+
+algorithms::transforms::Quaternion CanBridgeQuaternion::unpack() const
+{
+    algorithms::transforms::Quaternion q(w, x, y, z);
+    q.normalize();
+    return q;
+}
+
+CanBridge::CanBridge(Drivers *drivers, CanBus bus) : drivers(drivers), bus(bus) {}
+
+bool CanBridge::addTxChannel(CanBridgeTxChannel *channel)
+{
+    if (channel == nullptr || txChannelCount >= MAX_TX_CHANNELS)
+    {
+        return false;
+    }
+    const uint8_t period = channel->period;
+    if (period == 0 || period > MAX_PERIOD || (period & (period - 1)) != 0)
+    {
+        return false;
+    }
+    for (int i = 0; i < txChannelCount; i++)
+    {
+        if (txChannels[i] == channel)
+        {
+            return false;
+        }
+    }
+
+    // Pick the phase whose busiest tick is least busy, so the peak frames per tick stays as low
+    // as possible. Ties go to the earliest phase.
+    int bestPhase = 0;
+    int bestPeak = INT32_MAX;
+    for (int phase = 0; phase < period; phase++)
+    {
+        int peak = 0;
+        for (int t = phase; t < MAX_PERIOD; t += period)
+        {
+            peak = std::max(peak, static_cast<int>(framesPerTick[t]));
+        }
+        if (peak < bestPeak)
+        {
+            bestPeak = peak;
+            bestPhase = phase;
+        }
+    }
+
+    for (int t = bestPhase; t < MAX_PERIOD; t += period)
+    {
+        framesPerTick[t]++;
+    }
+    channel->phase = bestPhase;
+    txChannels[txChannelCount++] = channel;
+    return true;
+}
+
+void CanBridge::update()
+{
+    bool messageSuccess = true;
+    uint32_t droppedFrames = 0;
+
+    for (int i = 0; i < txChannelCount; i++)
+    {
+        CanBridgeTxChannel &channel = *txChannels[i];
+        if ((tick & (channel.period - 1)) != channel.phase || !channel.published)
+        {
+            continue;
+        }
+
+        if (!drivers->can.isReadyToSend(bus))
+        {
+            channel.numDropped++;
+            droppedFrames++;
+        }
+        else if (drivers->can.sendMessage(bus, channel.message))
+        {
+            channel.numSent++;
+        }
+        else
+        {
+            messageSuccess = false;
+        }
+    }
+
+    tick = (tick + 1) & (MAX_PERIOD - 1);
+
+    if (droppedFrames > 0)
+    {
+        drivers->can.recordTxDrops(bus, droppedFrames);
+    }
+    if (!messageSuccess)
+    {
+        RAISE_ERROR(drivers, "sendMessage failure");
+    }
+}
+
+int CanBridge::getMaxFramesPerTick() const
+{
+    return *std::max_element(framesPerTick, framesPerTick + MAX_PERIOD);
+}
+}  // namespace tap::can
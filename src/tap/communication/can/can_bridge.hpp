@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAN_BRIDGE_HPP_
+#define TAPROOT_CAN_BRIDGE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "tap/algorithms/transforms/quaternion.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+#include "can_bus.hpp"
+#include "can_rx_listener.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::can
+{
+/**
+ * One CAN frame of state that a `CanBridge` sends to another board every `period` control ticks.
+ * A channel holds at most 8 bytes, the payload of a single frame, so state that is larger should
+ * be split across several channels, each of which may be sent at its own rate. Use `CanBridgeTx`
+ * to publish a typed value.
+ */
+class CanBridgeTxChannel
+{
+public:
+    static constexpr uint8_t MAX_LENGTH = 8;
+
+    /**
+     * @param[in] canId The identifier of the frame, which the receiving board's
+     *      `CanBridgeRxChannel` listens to. Must not collide with any other device on the bus.
+     * @param[in] length The number of bytes published, at most `MAX_LENGTH`.
+     * @param[in] period The channel is sent every `period` calls to `CanBridge::update`. Must be
+     *      a power of two no larger than `CanBridge::MAX_PERIOD`.
+     */
+    CanBridgeTxChannel(uint32_t canId, uint8_t length, uint8_t period = 1);
+    DISALLOW_COPY_AND_ASSIGN(CanBridgeTxChannel)
+
+    /**
+     * Copies `getLength()` bytes of data into the channel's frame, which is sent on the channel's
+     * next scheduled tick. Nothing is sent until the first call.
+     */
+    void publish(const void *data);
+
+    /// @return `true` if data has been published to the channel.
+    bool isPublished() const { return published; }
+
+    uint32_t getCanId() const { return message.getIdentifier(); }
+
+    uint8_t getLength() const { return message.getLength(); }
+
+    uint8_t getPeriod() const { return period; }
+
+    /// @return The tick within each period the channel is sent on, assigned by `CanBridge`.
+    uint8_t getPhase() const { return phase; }
+
+    /// @return The number of frames the channel has queued for transmission.
+    uint32_t getNumSent() const { return numSent; }
+
+    /// @return The number of scheduled frames skipped because no transmit mailbox was free.
+    uint32_t getNumDropped() const { return numDropped; }
+
+private:
+    friend class CanBridge;
+
+    modm::can::Message message;
+    const uint8_t period;
+    uint8_t phase = 0;
+    bool published = false;
+    uint32_t numSent = 0;
+    uint32_t numDropped = 0;
+};  // class CanBridgeTxChannel
+
+/**
+ * A `CanBridgeTxChannel` that publishes a value of type `T`, which must be trivially copyable
+ * and no larger than a frame. The value is sent in the sender's byte order, which is the same on
+ * every board, and should be declared `modm_packed` so padding doesn't waste bytes of the frame.
+ */
+template <typename T>
+class CanBridgeTx : public CanBridgeTxChannel
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(sizeof(T) <= MAX_LENGTH, "T must fit in a single CAN frame");
+
+    explicit CanBridgeTx(uint32_t canId, uint8_t period = 1)
+        : CanBridgeTxChannel(canId, sizeof(T), period)
+    {
+    }
+
+    void publish(const T &value) { CanBridgeTxChannel::publish(&value); }
+};
+
+/**
+ * Receives the frames of a `CanBridgeTxChannel` sent by another board and records when they were
+ * received, so users can check the data is fresh before acting on it. Use `CanBridgeRx` to read
+ * a typed value. `attachSelfToRxHandler` must be called before frames are received.
+ */
+class CanBridgeRxChannel : public CanRxListener
+{
+public:
+    /**
+     * @param[in] canId The identifier of the sending board's `CanBridgeTxChannel`.
+     * @param[in] length The number of bytes expected in each frame. Frames of any other length
+     *      are counted by `getNumLengthErrors` and otherwise ignored.
+     * @param[in] timeoutUs Received data is fresh for this many microseconds. Should be a few
+     *      times the sending channel's period so that a single lost frame is tolerated.
+     */
+    CanBridgeRxChannel(
+        Drivers *drivers,
+        uint32_t canId,
+        CanBus bus,
+        uint8_t length,
+        uint32_t timeoutUs);
+
+    void processMessage(const modm::can::Message &message) override;
+
+    /// @return `true` if a frame has been received within the last `timeoutUs` microseconds.
+    bool isFresh() const;
+
+    /**
+     * @return The number of microseconds since the last frame was received, or `UINT32_MAX` if
+     *      no frame has been received.
+     */
+    uint32_t getAgeUs() const;
+
+    /// @return The number of frames received, not counting frames with the wrong length.
+    uint32_t getNumReceived() const { return numReceived; }
+
+    uint32_t getNumLengthErrors() const { return numLengthErrors; }
+
+    uint8_t getLength() const { return length; }
+
+    /// @return The data of the last frame received, all zeros if none has been received.
+    const uint8_t *getData() const { return data; }
+
+private:
+    uint8_t data[CanBridgeTxChannel::MAX_LENGTH] = {};
+    const uint8_t length;
+    const uint32_t timeoutUs;
+    uint32_t lastReceiveTimeUs = 0;
+    uint32_t numReceived = 0;
+    uint32_t numLengthErrors = 0;
+};  // class CanBridgeRxChannel
+
+/**
+ * A `CanBridgeRxChannel` that receives a value of type `T` published by a `CanBridgeTx<T>`.
+ */
+template <typename T>
+class CanBridgeRx : public CanBridgeRxChannel
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(sizeof(T) <= CanBridgeTxChannel::MAX_LENGTH, "T must fit in a CAN frame");
+
+    CanBridgeRx(Drivers *drivers, uint32_t canId, CanBus bus, uint32_t timeoutUs)
+        : CanBridgeRxChannel(drivers, canId, bus, sizeof(T), timeoutUs)
+    {
+    }
+
+    /// @return The last value received, or a zeroed value if none has been received.
+    T get() const
+    {
+        T value;
+        memcpy(&value, getData(), sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * A unit quaternion packed into a single frame as four Q15 fixed point components, which is
+ * accurate to about 0.01 degrees. An attitude estimate's four floats would need two frames.
+ */
+struct CanBridgeQuaternion
+{
+    int16_t w = INT16_MAX;
+    int16_t x = 0;
+    int16_t y = 0;
+    int16_t z = 0;
+
+    static CanBridgeQuaternion pack(const algorithms::transforms::Quaternion &q);
+
+    /// @return The quaternion, renormalized to remove the rounding error of the packing.
+    algorithms::transforms::Quaternion unpack() const;
+} modm_packed;
+
+/**
+ * Shares state between boards connected by a CAN bus, such as the chassis and turret boards of a
+ * robot, replacing `CanRxListener`s hand written for each packet.
+ *
+ * The sending board adds `CanBridgeTx` channels to a bridge and calls `update` once per control
+ * tick, which sends each channel whose data has been published on its scheduled ticks. The
+ * receiving board creates a `CanBridgeRx` for each channel and checks `isFresh` before using the
+ * data. For example:
+ *
+ * ```cpp
+ * // turret board
+ * CanBridge bridge(drivers, CanBus::CAN_BUS2);
+ * CanBridgeTx<CanBridgeQuaternion> attitudeTx(0x300);
+ * CanBridgeTx<TurretSetpoint> setpointTx(0x301, 4);
+ * bridge.addTxChannel(&attitudeTx);
+ * bridge.addTxChannel(&setpointTx);
+ *
+ * attitudeTx.publish(CanBridgeQuaternion::pack(imu.getQuaternion()));
+ * bridge.update();
+ *
+ * // chassis board
+ * CanBridgeRx<CanBridgeQuaternion> attitudeRx(drivers, 0x300, CanBus::CAN_BUS2, 3'000);
+ * attitudeRx.attachSelfToRxHandler();
+ *
+ * if (attitudeRx.isFresh())
+ * {
+ *     turretAttitude = attitudeRx.get().unpack();
+ * }
+ * ```
+ *
+ * Channels are sent every 1, 2, 4, 8 or 16 ticks, and each channel is given the phase within its
+ * period that sends it on the least loaded ticks, so the number of frames the bridge sends each
+ * tick repeats every `MAX_PERIOD` ticks and its peak, `getMaxFramesPerTick`, is known once all
+ * channels are added. A frame of 8 bytes takes at most 135 bits, 0.135 ms at 1 Mbps, so with a
+ * 1 kHz control loop a bridge sending no more than a few frames each tick leaves the bus mostly
+ * free for motors. Frames are queued when `update` is called, so the latency from publishing to
+ * receiving is the time to send the frames queued before it plus the time before the receiving
+ * board polls its CAN RX handler, well under 1 ms for a channel sent every tick.
+ *
+ * If no transmit mailbox is free when a channel is scheduled, its frame is skipped and counted as
+ * a dropped frame in the channel and the bus's `Can::BusStats`, so a backed up bus never delays
+ * the data of later ticks.
+ */
+class CanBridge
+{
+public:
+    /// The max number of channels that may be added to a bridge.
+    static constexpr int MAX_TX_CHANNELS = 16;
+
+    /// The longest period a channel may be sent at, in ticks.
+    static constexpr uint8_t MAX_PERIOD = 16;
+
+    CanBridge(Drivers *drivers, CanBus bus);
+    DISALLOW_COPY_AND_ASSIGN(CanBridge)
+    mockable ~CanBridge() = default;
+
+    /**
+     * Adds a channel to the bridge and assigns its phase.
+     *
+     * @return `false` if the channel is `nullptr`, was already added, has an invalid period, or
+     *      `MAX_TX_CHANNELS` channels have already been added.
+     */
+    mockable bool addTxChannel(CanBridgeTxChannel *channel);
+
+    /**
+     * Sends the channels scheduled for this tick. Should be called once per control tick.
+     */
+    mockable void update();
+
+    /// @return The most frames the bridge sends in a single tick.
+    int getMaxFramesPerTick() const;
+
+    int getTxChannelCount() const { return txChannelCount; }
+
+    CanBus getBus() const { return bus; }
+
+private:
+    Drivers *drivers;
+
+    const CanBus bus;
+
+    CanBridgeTxChannel *txChannels[MAX_TX_CHANNELS] = {};
+
+    int txChannelCount = 0;
+
+    /// Number of frames sent on each tick of the schedule.
+    uint8_t framesPerTick[MAX_PERIOD] = {};
+
+    /// The tick of the schedule the next `update` sends.
+    uint8_t tick = 0;
+};  // class CanBridge
+}  // namespace tap::can
+
+#endif  // TAPROOT_CAN_BRIDGE_HPP_
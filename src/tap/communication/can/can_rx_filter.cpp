@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_rx_filter.hpp"
+
+namespace tap::can
+{
+void CanRxFilterBuilder::addId(uint16_t canId)
+{
+    if (canId > CanRxFilter::STANDARD_ID_MASK)
+    {
+        return;
+    }
+
+    if (filterCount > 0 && filters[filterCount - 1].accepts(canId))
+    {
+        return;
+    }
+
+    filters[filterCount].id = canId;
+    filters[filterCount].mask = CanRxFilter::STANDARD_ID_MASK;
+    filterCount++;
+
+    // merge the newest filters while doing so accepts no additional ids
+    while (filterCount > 1 && mergeCost(filterCount - 2) == 0)
+    {
+        mergeWithNext(filterCount - 2);
+    }
+
+    if (filterCount > MAX_FILTERS)
+    {
+        int cheapest = 0;
+        for (int i = 1; i < filterCount - 1; i++)
+        {
+            if (mergeCost(i) < mergeCost(cheapest))
+            {
+                cheapest = i;
+            }
+        }
+        mergeWithNext(cheapest);
+    }
+}
+
+CanRxFilter CanRxFilterBuilder::merge(const CanRxFilter &a, const CanRxFilter &b)
+{
+    CanRxFilter merged;
+    merged.mask = a.mask & b.mask & ~(a.id ^ b.id) & CanRxFilter::STANDARD_ID_MASK;
+    merged.id = a.id & merged.mask;
+    return merged;
+}
+
+int CanRxFilterBuilder::mergeCost(int i) const
+{
+    const CanRxFilter &a = filters[i];
+    const CanRxFilter &b = filters[i + 1];
+
+    int unionCount = a.getAcceptedIdCount() + b.getAcceptedIdCount();
+
+    // the filters overlap if they agree on every bit both care about
+    if (((a.id ^ b.id) & a.mask & b.mask) == 0)
+    {
+        CanRxFilter intersection;
+        intersection.mask = a.mask | b.mask;
+        unionCount -= intersection.getAcceptedIdCount();
+    }
+
+    return merge(a, b).getAcceptedIdCount() - unionCount;
+}
+
+void CanRxFilterBuilder::mergeWithNext(int i)
+{
+    filters[i] = merge(filters[i], filters[i + 1]);
+
+    for (int j = i + 1; j < filterCount - 1; j++)
+    {
+        filters[j] = filters[j + 1];
+    }
+
+    filterCount--;
+}
+}  // namespace tap::can
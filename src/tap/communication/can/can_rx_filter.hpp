@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAN_RX_FILTER_HPP_
+#define TAPROOT_CAN_RX_FILTER_HPP_
+
+#include <cstdint>
+
+namespace tap::can
+{
+/**
+ * An acceptance filter for standard (11-bit) CAN identifiers. A CAN id is accepted if it matches
+ * `id` in every bit that is set in `mask`.
+ */
+struct CanRxFilter
+{
+    static constexpr uint16_t STANDARD_ID_MASK = 0x7FF;
+
+    uint16_t id = 0;
+    uint16_t mask = STANDARD_ID_MASK;
+
+    bool accepts(uint16_t canId) const { return (canId & mask) == (id & mask); }
+
+    /// @return The number of standard CAN ids accepted by the filter.
+    uint16_t getAcceptedIdCount() const
+    {
+        return 1 << (11 - __builtin_popcount(mask & STANDARD_ID_MASK));
+    }
+
+    bool operator==(const CanRxFilter &other) const
+    {
+        return mask == other.mask && (id & mask) == (other.id & other.mask);
+    }
+};
+
+/**
+ * Builds a set of at most `MAX_FILTERS` acceptance filters that accept every CAN id added to the
+ * builder. Each id starts as its own exact match filter. Neighboring filters are merged into a
+ * single mask filter whenever the merged filter accepts no ids that the two filters did not
+ * already accept (for example, ids `0x202` and `0x203` merge into id `0x202` with mask `0x7FE`).
+ * If there are still more than `MAX_FILTERS` filters, the neighboring pair whose merged filter
+ * accepts the fewest extra ids is merged, so the filters may accept some ids that were never
+ * added.
+ *
+ * Ids must be added in increasing order.
+ */
+class CanRxFilterBuilder
+{
+public:
+    /**
+     * The max number of filters per bus. The bxCAN peripheral has 14 filter banks per bus, each
+     * of which holds two 16-bit id/mask filters.
+     */
+    static constexpr int MAX_FILTERS = 28;
+
+    /// Adds a CAN id that the filters must accept. Ids above `0x7FF` are ignored.
+    void addId(uint16_t canId);
+
+    const CanRxFilter *getFilters() const { return filters; }
+
+    int getFilterCount() const { return filterCount; }
+
+private:
+    /// One extra filter so an id can be added before filters are merged.
+    CanRxFilter filters[MAX_FILTERS + 1];
+
+    int filterCount = 0;
+
+    static CanRxFilter merge(const CanRxFilter &a, const CanRxFilter &b);
+
+    /// @return The number of ids accepted by merging filters `i` and `i + 1` that neither accepts.
+    int mergeCost(int i) const;
+
+    /// Replaces filters `i` and `i + 1` with their merged filter.
+    void mergeWithNext(int i);
+};
+}  // namespace tap::can
+
+#endif  // TAPROOT_CAN_RX_FILTER_HPP_
@@ -25,101 +25,215 @@
 #include "modm/architecture/interface/assert.h"
 #include "modm/architecture/interface/can.hpp"
 
+#include "can_rx_filter.hpp"
 #include "can_rx_listener.hpp"
 
 namespace tap::can
 {
 CanRxHandler::CanRxHandler(Drivers* drivers)
     : drivers(drivers),
-      messageHandlerStoreCan1(),
-      messageHandlerStoreCan2()
+      messageHandlerStore(),
+      sparsePageDirectory(),
+      sparsePages(),
+      sparsePageListenerCount()
 {
+    for (int bus = 0; bus < NUM_CAN_BUSES; bus++)
+    {
+        for (int slot = 0; slot < NUM_SPARSE_PAGE_SLOTS; slot++)
+        {
+            sparsePageDirectory[bus][slot] = NO_SPARSE_PAGE;
+        }
+    }
 }
 
 void CanRxHandler::attachReceiveHandler(CanRxListener* const listener)
 {
-    if (listener->canBus == can::CanBus::CAN_BUS1)
+    uint32_t id = listener->canIdentifier;
+
+    modm_assert(id <= MAX_STANDARD_CAN_ID, "CAN", "RX listener id out of bounds", 1);
+
+    CanRxListener** slot = findListenerSlot(listener->canBus, id, true);
+
+    if (slot == nullptr)
     {
-        attachReceiveHandler(listener, messageHandlerStoreCan1);
+        RAISE_ERROR(drivers, "no free sparse pages for RX listener");
+        return;
     }
-    else
+
+    modm_assert(*slot == nullptr, "CAN", "overloading", 1);
+
+    *slot = listener;
+
+    if (lookupTableIndexForCanId(id) >= NUM_CAN_IDS)
     {
-        attachReceiveHandler(listener, messageHandlerStoreCan2);
+        const int busIndex = static_cast<int>(listener->canBus);
+        sparsePageListenerCount[sparsePageDirectory[busIndex][id / SPARSE_PAGE_SIZE]]++;
     }
+
+    updateRxFilters(listener->canBus);
 }
 
-void CanRxHandler::attachReceiveHandler(
-    CanRxListener* const canRxListener,
-    CanRxListener** messageHandlerStore)
+void CanRxHandler::pollCanData() { CanRxHandler::pollCanData(1); }
+
+void CanRxHandler::pollCanData(int maxFrames)
 {
-    uint16_t id = lookupTableIndexForCanId(canRxListener->canIdentifier);
+    // handle incoming CAN 1 messages
+    pollCanData(CanBus::CAN_BUS1, maxFrames);
 
-    modm_assert(id < NUM_CAN_IDS, "CAN", "RX listener id out of bounds", 1);
-    modm_assert(messageHandlerStore[id] == nullptr, "CAN", "overloading", 1);
+    // handle incoming CAN 2 messages
+    pollCanData(CanBus::CAN_BUS2, maxFrames);
+}
 
-    messageHandlerStore[id] = canRxListener;
+void CanRxHandler::pollCanData(CanBus bus, int maxFrames)
+{
+    for (int i = 0; i < maxFrames; i++)
+    {
+        const modm::can::Message* rxMessage = drivers->can.peekMessage(bus);
+
+        if (rxMessage == nullptr)
+        {
+            return;
+        }
+
+        rxTimestamp = drivers->can.getMessageTimestamp(bus);
+        processReceivedCanData(bus, *rxMessage);
+        drivers->can.popMessage(bus);
+    }
 }
 
-void CanRxHandler::pollCanData()
+void CanRxHandler::processReceivedCanData(CanBus bus, const modm::can::Message& rxMessage)
 {
-    modm::can::Message rxMessage;
+    uint32_t id = rxMessage.getIdentifier();
 
-    // handle incoming CAN 1 messages
-    if (drivers->can.getMessage(CanBus::CAN_BUS1, &rxMessage))
+    if (id > MAX_STANDARD_CAN_ID)
     {
-        processReceivedCanData(rxMessage, messageHandlerStoreCan1);
+        drivers->can.recordUnmatchedRxFrame(bus);
+        RAISE_ERROR(drivers, "Invalid can id received");
+        return;
     }
 
-    // handle incoming CAN 2 messages
-    if (drivers->can.getMessage(CanBus::CAN_BUS2, &rxMessage))
+    CanRxListener* listener = getListener(bus, id);
+
+    if (listener != nullptr)
+    {
+        listener->processMessage(rxMessage);
+    }
+    else
     {
-        processReceivedCanData(rxMessage, messageHandlerStoreCan2);
+        drivers->can.recordUnmatchedRxFrame(bus);
     }
 }
 
-void CanRxHandler::processReceivedCanData(
-    const modm::can::Message& rxMessage,
-    CanRxListener* const* messageHandlerStore)
+void CanRxHandler::removeReceiveHandler(const CanRxListener& canRxListener)
 {
-    uint16_t id = lookupTableIndexForCanId(rxMessage.getIdentifier());
+    uint32_t id = canRxListener.canIdentifier;
 
-    if (id >= NUM_CAN_IDS)
+    if (id > MAX_STANDARD_CAN_ID)
     {
-        RAISE_ERROR(drivers, "Invalid can id received");
+        RAISE_ERROR(drivers, "index out of bounds");
         return;
     }
 
-    if (messageHandlerStore[id] != nullptr)
+    CanRxListener** slot = findListenerSlot(canRxListener.canBus, id, false);
+
+    if (slot == nullptr || *slot == nullptr)
+    {
+        return;
+    }
+
+    *slot = nullptr;
+
+    if (lookupTableIndexForCanId(id) >= NUM_CAN_IDS)
     {
-        messageHandlerStore[id]->processMessage(rxMessage);
+        releaseSparsePage(canRxListener.canBus, id);
     }
+
+    updateRxFilters(canRxListener.canBus);
 }
 
-void CanRxHandler::removeReceiveHandler(const CanRxListener& canRxListener)
+void CanRxHandler::updateRxFilters(CanBus bus)
 {
-    if (canRxListener.canBus == CanBus::CAN_BUS1)
+    CanRxFilterBuilder builder;
+
+    for (uint16_t id = 0; id <= MAX_STANDARD_CAN_ID; id++)
     {
-        removeReceiveHandler(canRxListener, messageHandlerStoreCan1);
+        if (getListener(bus, id) != nullptr)
+        {
+            builder.addId(id);
+        }
     }
-    else
+
+    drivers->can.setRxFilters(bus, builder.getFilters(), builder.getFilterCount());
+}
+
+int CanRxHandler::getFreeSparsePageCount() const
+{
+    int freePages = 0;
+
+    for (int i = 0; i < NUM_SPARSE_PAGES; i++)
     {
-        removeReceiveHandler(canRxListener, messageHandlerStoreCan2);
+        if (sparsePageListenerCount[i] == 0)
+        {
+            freePages++;
+        }
     }
+
+    return freePages;
 }
 
-void CanRxHandler::removeReceiveHandler(
-    const CanRxListener& canRxListener,
-    CanRxListener** messageHandlerStore)
+CanRxListener** CanRxHandler::findListenerSlot(CanBus bus, uint16_t canId, bool allocate)
 {
-    int id = lookupTableIndexForCanId(canRxListener.canIdentifier);
+    const int busIndex = static_cast<int>(bus);
+    const uint16_t denseIndex = lookupTableIndexForCanId(canId);
 
-    if (id >= NUM_CAN_IDS)
+    if (denseIndex < NUM_CAN_IDS)
+    {
+        return &messageHandlerStore[busIndex][denseIndex];
+    }
+
+    uint8_t& page = sparsePageDirectory[busIndex][canId / SPARSE_PAGE_SIZE];
+
+    if (page == NO_SPARSE_PAGE)
+    {
+        if (!allocate)
+        {
+            return nullptr;
+        }
+
+        // A page is unassigned once its last listener is removed
+        for (int i = 0; i < NUM_SPARSE_PAGES; i++)
+        {
+            if (sparsePageListenerCount[i] == 0)
+            {
+                page = i;
+                break;
+            }
+        }
+
+        if (page == NO_SPARSE_PAGE)
+        {
+            return nullptr;
+        }
+    }
+
+    return &sparsePages[page][canId % SPARSE_PAGE_SIZE];
+}
+
+void CanRxHandler::releaseSparsePage(CanBus bus, uint16_t canId)
+{
+    uint8_t& page = sparsePageDirectory[static_cast<int>(bus)][canId / SPARSE_PAGE_SIZE];
+
+    if (page == NO_SPARSE_PAGE)
     {
-        RAISE_ERROR(drivers, "index out of bounds");
         return;
     }
 
-    messageHandlerStore[id] = nullptr;
+    sparsePageListenerCount[page]--;
+
+    if (sparsePageListenerCount[page] == 0)
+    {
+        page = NO_SPARSE_PAGE;
+    }
 }
 
 }  // namespace tap::can
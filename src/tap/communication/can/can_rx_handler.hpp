@@ -24,6 +24,8 @@
 
 #include "tap/util_macros.hpp"
 
+#include "tap/communication/can/can_rx_handler_constants.hpp"
+
 #include "can_bus.hpp"
 
 namespace modm::can
@@ -57,14 +59,31 @@ class CanRxListener;
  * every time there is a message available that has the CAN identifier
  * matching the identifier specified in the CanRxListener constructor.
  *
- * For proper closed loop motor control, it is necessary to have the
- * pollCanData function be called at a very high frequency,
- * so call this in a high frequency thread.
+ * Received messages are buffered by the CAN RX interrupt in a ring per bus, so
+ * pollCanData only needs to be called often enough to keep up with the bus. Use
+ * `pollCanData(maxFrames)` to dispatch a batch of messages at once.
+ *
+ * Listeners are stored in a two level table indexed directly by CAN bus and CAN id, so finding
+ * the listener for a received message takes constant time for any standard (11-bit) CAN id:
+ * - A dense array per bus holds listeners for the 64 CAN ids in [`0x1E4`, `0x224`). In the middle
+ *   of this range, CAN ids [`0x201`, `0x20B`] are used by the `DjiMotor` objects to receive data
+ *   from DJI branded motors.
+ * - Listeners for all other CAN ids in [`0x000`, `0x7FF`] are stored in sparse pages of
+ *   `SPARSE_PAGE_SIZE` consecutive ids. Each bus has a page directory that maps each block of
+ *   ids to a page, and pages are taken from a pool shared by both buses the first time a listener
+ *   in the block is attached. The size of the pool is set by the
+ *   `taproot:communication:can:rx_handler_sparse_pages` lbuild option, so the RAM used by the
+ *   handler is fixed at compile time.
+ *
+ * If you would like to define your own protocol, it is recommended to use CAN ids in the same
+ * block of `SPARSE_PAGE_SIZE` ids so that few sparse pages are used.
+ *
+ * Whenever a listener is attached or removed, the bus's hardware acceptance filters are
+ * reprogrammed to accept only the ids that listeners are attached to, so frames nobody listens
+ * to are rejected before they cause an interrupt. Consecutive ids (such as DJI motor feedback
+ * ids) are combined into mask filters. If no listeners are attached to a bus, every frame on
+ * that bus is accepted.
  *
- * @note The CAN handler can handle 64 CAN ids between [`0x1E4`, `0x224`). In the middle of this
- *      range, CAN ids [`0x201`, `0x20B`] are used by the `DjiMotor` objects to receive data from
- *      DJI branded motors. If you would like to define your own protocol, it is recommended to
- *      avoid avoid using CAN ids in this range.
  * @note the DjiMotor driver reserves `0x1FF` and `0x200` for commanding motors,
  *      and thus you should not attach listeners for these ids.
  *
@@ -79,13 +98,27 @@ class CanRxHandler
     static constexpr uint16_t NUM_CAN_IDS = 64;
     static constexpr uint16_t MAX_CAN_ID = MIN_CAN_ID + NUM_CAN_IDS;
 
+    /// The largest standard (11-bit) CAN identifier.
+    static constexpr uint16_t MAX_STANDARD_CAN_ID = 0x7FF;
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    /// Number of consecutive CAN ids stored in each sparse page.
+    static constexpr uint16_t SPARSE_PAGE_SIZE = 16;
+    /// Number of sparse page directory entries per bus, one per block of `SPARSE_PAGE_SIZE` ids.
+    static constexpr uint16_t NUM_SPARSE_PAGE_SLOTS = (MAX_STANDARD_CAN_ID + 1) / SPARSE_PAGE_SIZE;
+    static constexpr int NUM_SPARSE_PAGES = CAN_RX_HANDLER_SPARSE_PAGES;
+    /// Page directory value indicating no page is assigned to a block of ids.
+    static constexpr uint8_t NO_SPARSE_PAGE = UINT8_MAX;
+
+    static_assert(NUM_SPARSE_PAGES < NO_SPARSE_PAGE, "too many sparse pages");
+
     CanRxHandler(Drivers* drivers);
     mockable ~CanRxHandler() = default;
     DISALLOW_COPY_AND_ASSIGN(CanRxHandler)
 
     /**
-     * Given a CAN identifier, returns the "normalized" id between [0, NUM_CAN_IDS), or a
-     * value >= NUM_CAN_IDS if the canId is outside the range specified.
+     * Given a CAN identifier, returns the "normalized" id between [0, NUM_CAN_IDS) in the dense
+     * listener array, or a value >= NUM_CAN_IDS if the canId is outside the dense range.
      */
     static inline uint16_t lookupTableIndexForCanId(uint16_t canId)
     {
@@ -97,6 +130,33 @@ class CanRxHandler
         return canId - MIN_CAN_ID;
     }
 
+    /**
+     * @return The listener attached to the given bus and CAN id, or `nullptr` if no listener
+     *      is attached or the id is not a standard CAN id.
+     */
+    inline CanRxListener* getListener(CanBus bus, uint32_t canId) const
+    {
+        if (canId > MAX_STANDARD_CAN_ID)
+        {
+            return nullptr;
+        }
+
+        const int busIndex = static_cast<int>(bus);
+        const uint16_t denseIndex = lookupTableIndexForCanId(canId);
+
+        if (denseIndex < NUM_CAN_IDS)
+        {
+            return messageHandlerStore[busIndex][denseIndex];
+        }
+
+        const uint8_t page = sparsePageDirectory[busIndex][canId / SPARSE_PAGE_SIZE];
+
+        return page == NO_SPARSE_PAGE ? nullptr : sparsePages[page][canId % SPARSE_PAGE_SIZE];
+    }
+
+    /// @return The number of sparse pages not assigned to a block of CAN ids.
+    int getFreeSparsePageCount() const;
+
     /**
      * Call this function to add a CanRxListener to the list of CanRxListener's
      * that are referenced when a new CAN message is received.
@@ -118,14 +178,23 @@ class CanRxHandler
     /**
      * Function handles receiving messages and calling the appropriate
      * processMessage function given the CAN bus and can identifier.
-     *
-     * @attention you should call this function as frequently as you receive
-     *      messages if you want to receive the most up to date messages.
-     *      modm's IQR puts CAN messages in a queue, and this function
-     *      clears out the queue once it is called.
+     * Dispatches at most one message from each bus, equivalent to `pollCanData(1)`.
      */
     mockable void pollCanData();
 
+    /**
+     * Dispatches up to `maxFrames` received messages from each bus to their listeners. Messages
+     * are passed to listeners in place from the bus's RX ring (see `Can::peekMessage`), so no
+     * message is copied after it is received.
+     *
+     * @attention The CAN RX interrupt buffers up to `CAN_RX_RING_SIZE` messages per bus, so
+     *      this function only needs to be called often enough that the ring does not fill up.
+     *      Frames received while the ring is full are dropped.
+     *
+     * @param[in] maxFrames The max number of messages to dispatch from each bus.
+     */
+    mockable void pollCanData(int maxFrames);
+
     /**
      * Removes the passed in `CanRxListener` from the `CanRxHandler`. If the
      * listener isn't in the handler, an error will be added to the `ErrorController`
@@ -135,41 +204,67 @@ class CanRxHandler
      */
     mockable void removeReceiveHandler(const CanRxListener& rxListener);
 
+    /**
+     * @return The time at which the message most recently dispatched by `pollCanData` was
+     *      received, in microseconds (see `Can::getMessageTimestamp`). Listeners may call this
+     *      from `CanRxListener::processMessage` to timestamp the message being processed.
+     */
+    mockable uint32_t getRxTimestamp() const { return rxTimestamp; }
+
 protected:
     Drivers* drivers;
 
     /**
-     * Stores pointers to the `CanRxListeners` for CAN 1, referenced when
-     * a new message is received.
+     * Stores pointers to the `CanRxListeners` in the dense id range for each bus, referenced
+     * when a new message is received.
      */
-    CanRxListener* messageHandlerStoreCan1[NUM_CAN_IDS];
+    CanRxListener* messageHandlerStore[NUM_CAN_BUSES][NUM_CAN_IDS];
 
     /**
-     * Stores pointers to the `CanRxListeners` for CAN 2, referenced when
-     * a new message is received.
+     * For each bus and each block of `SPARSE_PAGE_SIZE` CAN ids, the index in `sparsePages` of
+     * the page storing listeners for the block, or `NO_SPARSE_PAGE`.
      */
-    CanRxListener* messageHandlerStoreCan2[NUM_CAN_IDS];
+    uint8_t sparsePageDirectory[NUM_CAN_BUSES][NUM_SPARSE_PAGE_SLOTS];
+
+    /// Pool of pages storing pointers to `CanRxListeners` outside of the dense id range.
+    CanRxListener* sparsePages[NUM_SPARSE_PAGES][SPARSE_PAGE_SIZE];
+
+    /// Number of listeners in each sparse page, a page is freed when its count reaches 0.
+    uint8_t sparsePageListenerCount[NUM_SPARSE_PAGES];
+
+    /// RX timestamp of the message most recently dispatched, see `getRxTimestamp`.
+    uint32_t rxTimestamp = 0;
 
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
 public:
 #endif
 
-    void attachReceiveHandler(
-        CanRxListener* const canRxListener,
-        CanRxListener** messageHandlerStore);
-
-    void processReceivedCanData(
-        const modm::can::Message& rxMessage,
-        CanRxListener* const* messageHandlerStore);
-
-    void removeReceiveHandler(
-        const CanRxListener& canRxListener,
-        CanRxListener** messageHandlerStore);
+    void processReceivedCanData(CanBus bus, const modm::can::Message& rxMessage);
 
     inline CanRxListener** getHandlerStore(CanBus bus)
     {
-        return bus == CanBus::CAN_BUS1 ? messageHandlerStoreCan1 : messageHandlerStoreCan2;
+        return messageHandlerStore[static_cast<int>(bus)];
     }
+
+private:
+    /// Dispatches up to `maxFrames` received messages from the given bus.
+    void pollCanData(CanBus bus, int maxFrames);
+
+    /**
+     * @return A pointer to the slot that stores the listener for the given id on the given bus,
+     *      assigning a sparse page to the id's block if `allocate` is `true`. Returns `nullptr`
+     *      if the id is not stored in the dense range and no sparse page could be assigned.
+     */
+    CanRxListener** findListenerSlot(CanBus bus, uint16_t canId, bool allocate);
+
+    /// Unassigns the sparse page storing the given id if no listeners remain in the page.
+    void releaseSparsePage(CanBus bus, uint16_t canId);
+
+    /**
+     * Sets the given bus's hardware acceptance filters so that only frames with an identifier
+     * that a listener is attached to are received (see `CanRxFilterBuilder`).
+     */
+    void updateRxFilters(CanBus bus);
 };  // class CanRxHandler
 
 }  // namespace tap::can
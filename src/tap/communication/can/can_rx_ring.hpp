@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAN_RX_RING_HPP_
+#define TAPROOT_CAN_RX_RING_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::can
+{
+/**
+ * A lock-free single producer, single consumer ring buffer of CAN frames. The producer (the CAN
+ * RX interrupt) decodes each frame directly into a slot in the ring, and the consumer (the
+ * `CanRxHandler`) reads frames in place, so no frame is copied after it is received.
+ *
+ * The producer must only call `beginPush` and `endPush`, and the consumer must only call `front`,
+ * `frontTimestamp`, and `pop`. Both may call the size and overflow accessors.
+ *
+ * @tparam CAPACITY The number of frames in the ring, must be a power of two.
+ */
+template <int CAPACITY>
+class CanRxRing
+{
+public:
+    static_assert(
+        CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+        "CanRxRing capacity must be a power of two");
+
+    /**
+     * @return The slot the next frame should be written into, or `nullptr` if the ring is full,
+     *      in which case the overflow count is incremented and the frame should be dropped. The
+     *      frame is not visible to the consumer until `endPush` is called.
+     */
+    modm::can::Message *beginPush()
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+
+        if (t - head.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            overflowCount.store(
+                overflowCount.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        return &frames[t & MASK];
+    }
+
+    /**
+     * Publishes the frame written into the slot returned by the last call to `beginPush`.
+     *
+     * @param[in] rxTimestamp The time at which the frame was received, in microseconds.
+     */
+    void endPush(uint32_t rxTimestamp = 0)
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        timestamps[t & MASK] = rxTimestamp;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    /// @return The oldest frame in the ring, or `nullptr` if the ring is empty.
+    const modm::can::Message *front() const
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &frames[h & MASK];
+    }
+
+    /// @return The time the oldest frame in the ring was received, or 0 if the ring is empty.
+    uint32_t frontTimestamp() const
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return 0;
+        }
+
+        return timestamps[h & MASK];
+    }
+
+    /// Removes the oldest frame from the ring, freeing its slot for the producer.
+    void pop()
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+
+        if (h != tail.load(std::memory_order_acquire))
+        {
+            head.store(h + 1, std::memory_order_release);
+        }
+    }
+
+    /// @return The number of frames in the ring.
+    int size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+    /// @return The number of frames dropped because the ring was full.
+    uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    modm::can::Message frames[CAPACITY];
+
+    /// RX timestamp of each frame in `frames`, in microseconds.
+    uint32_t timestamps[CAPACITY] = {};
+
+    /// Free running index of the next frame to be read, only written by the consumer.
+    std::atomic<uint32_t> head{0};
+
+    /// Free running index of the next slot to be written, only written by the producer.
+    std::atomic<uint32_t> tail{0};
+
+    std::atomic<uint32_t> overflowCount{0};
+};
+}  // namespace tap::can
+
+#endif  // TAPROOT_CAN_RX_RING_HPP_
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_terminal_serial_handler.hpp"
+
+#include "tap/drivers.hpp"
+
+namespace tap::can
+{
+constexpr char CanTerminalSerialHandler::HEADER[];
+constexpr char CanTerminalSerialHandler::USAGE[];
+constexpr algorithms::TokenTableEntry<CanTerminalSerialHandler::Subcommand>
+    CanTerminalSerialHandler::SUBCOMMANDS[];
+
+void CanTerminalSerialHandler::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+bool CanTerminalSerialHandler::terminalSerialCallback(
+    char* inputLine,
+    modm::IOStream& outputStream,
+    bool streamingEnabled)
+{
+    algorithms::TokenView tokens(inputLine);
+    Subcommand subcommand;
+    if (!tokens.nextIn(SUBCOMMANDS, subcommand) || !tokens.empty())
+    {
+        outputStream << USAGE;
+        return false;
+    }
+
+    switch (subcommand)
+    {
+        case Subcommand::STATS:
+            printHeader(outputStream);
+            terminalSerialStreamCallback(outputStream);
+            return true;
+        case Subcommand::RESET:
+            drivers->can.resetBusStats();
+            outputStream << "CAN statistics reset" << modm::endl;
+            return !streamingEnabled;
+        case Subcommand::HELP:
+            outputStream << USAGE;
+            return !streamingEnabled;
+    }
+    return false;
+}
+
+void CanTerminalSerialHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
+{
+    printBusStats(outputStream, CanBus::CAN_BUS1);
+    printBusStats(outputStream, CanBus::CAN_BUS2);
+}
+
+void CanTerminalSerialHandler::printHeader(modm::IOStream& outputStream)
+{
+    outputStream << "bus\trx\ttx\ttxfail\ttxdrop\trxovf\tnolisten\terrpass\tbusoff\tload%"
+                 << modm::endl;
+}
+
+void CanTerminalSerialHandler::printBusStats(modm::IOStream& outputStream, CanBus bus)
+{
+    const Can::BusStats& stats = drivers->can.getBusStats(bus);
+
+    outputStream.printf(
+        "%d\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%.1f\n",
+        bus == CanBus::CAN_BUS1 ? 1 : 2,
+        static_cast<unsigned long>(stats.rxFrames),
+        static_cast<unsigned long>(stats.txFrames),
+        static_cast<unsigned long>(stats.txFailures),
+        static_cast<unsigned long>(stats.txDrops),
+        static_cast<unsigned long>(stats.rxOverflows),
+        static_cast<unsigned long>(stats.unmatchedRxFrames),
+        static_cast<unsigned long>(stats.errorPassiveEvents),
+        static_cast<unsigned long>(stats.busOffEvents),
+        static_cast<double>(stats.busLoad));
+}
+}  // namespace tap::can
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAN_TERMINAL_SERIAL_HANDLER_HPP_
+#define TAPROOT_CAN_TERMINAL_SERIAL_HANDLER_HPP_
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+#include "can.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::can
+{
+/**
+ * Terminal serial handler that prints the statistics recorded by `Can` for each CAN bus,
+ * including the bus load. Supports streaming, which is useful for watching the bus load while
+ * motors are added or removed.
+ */
+class CanTerminalSerialHandler : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "can";
+
+    CanTerminalSerialHandler(Drivers* drivers) : drivers(drivers) {}
+    DISALLOW_COPY_AND_ASSIGN(CanTerminalSerialHandler)
+    mockable ~CanTerminalSerialHandler() = default;
+
+    mockable void init();
+
+    bool terminalSerialCallback(
+        char* inputLine,
+        modm::IOStream& outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream& outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: can <[-H] | [stats] | [reset]>\n"
+        "  Where:\n"
+        "    - [-H]    prints usage\n"
+        "    - [stats] prints frame counts, error counts, and bus load of each CAN bus\n"
+        "    - [reset] resets the statistics of each CAN bus\n";
+
+    enum class Subcommand
+    {
+        STATS,
+        RESET,
+        HELP,
+    };
+    static constexpr algorithms::TokenTableEntry<Subcommand> SUBCOMMANDS[] = {
+        {"stats", Subcommand::STATS},
+        {"reset", Subcommand::RESET},
+        {"-H", Subcommand::HELP},
+    };
+
+    Drivers* drivers;
+
+    void printHeader(modm::IOStream& outputStream);
+
+    void printBusStats(modm::IOStream& outputStream, CanBus bus);
+};  // class CanTerminalSerialHandler
+}  // namespace tap::can
+
+#endif  // TAPROOT_CAN_TERMINAL_SERIAL_HANDLER_HPP_
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "can_tx_planner.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "modm/architecture/interface/can_message.hpp"
+
+#include "can.hpp"
+
+namespace tap::can
+{
+CanTxPlanner::CanTxPlanner(uint32_t bitrate, uint32_t resolution)
+    : bitrate(bitrate),
+      resolution(resolution > 0 ? resolution : 1)
+{
+}
+
+bool CanTxPlanner::addFixedFrame(uint16_t id, uint8_t length, uint32_t period, uint32_t offset)
+{
+    return offset < period && addFrame(id, length, period, offset, false);
+}
+
+bool CanTxPlanner::addTxFrame(uint16_t id, uint8_t length, uint32_t period)
+{
+    return addFrame(id, length, period, INVALID_TIME, true);
+}
+
+void CanTxPlanner::clear()
+{
+    frameCount = 0;
+    hyperperiod = 0;
+}
+
+bool CanTxPlanner::plan()
+{
+    for (int i = 0; i < frameCount; i++)
+    {
+        frames[i].placed = !frames[i].tx;
+    }
+
+    for (int i = 0; i < frameCount; i++)
+    {
+        Frame &frame = frames[i];
+        if (!frame.tx)
+        {
+            continue;
+        }
+
+        frame.placed = true;
+        uint64_t bestCost = UINT64_MAX;
+        uint32_t bestOffset = 0;
+        for (uint32_t offset = 0; offset < frame.period; offset += resolution)
+        {
+            frame.offset = offset;
+            const uint64_t cost = simulate();
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestOffset = offset;
+            }
+        }
+        frame.offset = bestOffset;
+    }
+
+    simulate();
+
+    bool schedulable = true;
+    uint32_t blocking = 0;
+    // Going from lowest to highest priority, the longest frame seen so far may block the next
+    for (int i = frameCount - 1; i >= 0; i--)
+    {
+        Frame &frame = frames[i];
+        if (frame.worstCaseLatency != INVALID_TIME)
+        {
+            frame.worstCaseLatency += blocking;
+        }
+        if (frame.worstCaseLatency > frame.period)
+        {
+            schedulable = false;
+        }
+        blocking = std::max(blocking, frame.transmitTime);
+    }
+
+    return schedulable;
+}
+
+uint32_t CanTxPlanner::getOffset(uint16_t id) const
+{
+    const Frame *frame = findFrame(id);
+    return frame == nullptr ? INVALID_TIME : frame->offset;
+}
+
+bool CanTxPlanner::isReleased(uint16_t id, uint32_t elapsed) const
+{
+    const uint32_t offset = getOffset(id);
+    return offset == INVALID_TIME || elapsed >= offset;
+}
+
+uint32_t CanTxPlanner::getWorstCaseLatency(uint16_t id) const
+{
+    const Frame *frame = findFrame(id);
+    return frame == nullptr ? INVALID_TIME : frame->worstCaseLatency;
+}
+
+uint32_t CanTxPlanner::getTransmitTime(uint8_t length) const
+{
+    const uint64_t bits = Can::getFrameBits(modm::can::Message(0, length));
+    return (bits * 1'000'000 + bitrate - 1) / bitrate;
+}
+
+float CanTxPlanner::getBusLoad() const
+{
+    float load = 0;
+    for (int i = 0; i < frameCount; i++)
+    {
+        load += 100.0f * frames[i].transmitTime / frames[i].period;
+    }
+    return load;
+}
+
+bool CanTxPlanner::addFrame(
+    uint16_t id,
+    uint8_t length,
+    uint32_t period,
+    uint32_t offset,
+    bool tx)
+{
+    if (id > 0x7FF || length > 8 || period == 0 || frameCount >= MAX_FRAMES ||
+        findFrame(id) != nullptr)
+    {
+        return false;
+    }
+
+    uint64_t newHyperperiod = period;
+    if (hyperperiod != 0)
+    {
+        newHyperperiod = static_cast<uint64_t>(hyperperiod / std::gcd(hyperperiod, period)) *
+                         period;
+    }
+    if (newHyperperiod > MAX_HYPERPERIOD)
+    {
+        return false;
+    }
+    hyperperiod = newHyperperiod;
+
+    // Keep the frames sorted by id
+    int index = frameCount;
+    while (index > 0 && frames[index - 1].id > id)
+    {
+        frames[index] = frames[index - 1];
+        index--;
+    }
+    frames[index] = {id, length, tx, period, offset, getTransmitTime(length), INVALID_TIME, false};
+    frameCount++;
+
+    // The new frame changes the latency of every other frame
+    for (int i = 0; i < frameCount; i++)
+    {
+        frames[i].worstCaseLatency = INVALID_TIME;
+    }
+
+    return true;
+}
+
+const CanTxPlanner::Frame *CanTxPlanner::findFrame(uint16_t id) const
+{
+    for (int i = 0; i < frameCount; i++)
+    {
+        if (frames[i].id == id)
+        {
+            return &frames[i];
+        }
+    }
+    return nullptr;
+}
+
+uint64_t CanTxPlanner::simulate()
+{
+    // The bus starts idle, so latencies are only measured over the second hyperperiod, once
+    // frames delayed past the end of the first have been accounted for
+    const uint32_t end = 2 * hyperperiod;
+    uint32_t nextRelease[MAX_FRAMES];
+    uint32_t pendingRelease[MAX_FRAMES] = {};
+    bool pending[MAX_FRAMES] = {};
+
+    for (int i = 0; i < frameCount; i++)
+    {
+        nextRelease[i] = frames[i].placed ? frames[i].offset : end;
+        frames[i].worstCaseLatency = 0;
+    }
+
+    uint32_t time = 0;
+    while (true)
+    {
+        int next = -1;
+        uint32_t nextEvent = end;
+        for (int i = 0; i < frameCount; i++)
+        {
+            while (nextRelease[i] <= time && nextRelease[i] < end)
+            {
+                if (pending[i])
+                {
+                    // Superseded by its next release before being sent
+                    frames[i].worstCaseLatency = INVALID_TIME;
+                }
+                pending[i] = true;
+                pendingRelease[i] = nextRelease[i];
+                nextRelease[i] += frames[i].period;
+            }
+            if (pending[i] && next < 0)
+            {
+                next = i;
+            }
+            nextEvent = std::min(nextEvent, nextRelease[i]);
+        }
+
+        if (next < 0)
+        {
+            if (nextEvent >= end)
+            {
+                break;
+            }
+            time = nextEvent;
+            continue;
+        }
+
+        // The bus is idle, so the pending frame with the lowest id wins arbitration
+        Frame &frame = frames[next];
+        time += frame.transmitTime;
+        pending[next] = false;
+        if (pendingRelease[next] >= hyperperiod && frame.worstCaseLatency != INVALID_TIME)
+        {
+            frame.worstCaseLatency =
+                std::max(frame.worstCaseLatency, time - pendingRelease[next]);
+        }
+    }
+
+    uint64_t totalLatency = 0;
+    for (int i = 0; i < frameCount; i++)
+    {
+        if (frames[i].placed)
+        {
+            if (frames[i].worstCaseLatency == INVALID_TIME)
+            {
+                return UINT64_MAX;
+            }
+            totalLatency += frames[i].worstCaseLatency;
+        }
+    }
+    return totalLatency;
+}
+}  // namespace tap::can
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAN_TX_PLANNER_HPP_
+#define TAPROOT_CAN_TX_PLANNER_HPP_
+
+#include <cstdint>
+
+namespace tap::can
+{
+/**
+ * Plans when in each period the frames this node sends on a CAN bus should be released, so they
+ * don't arbitrate against each other or against bursts of frames sent by other nodes, and
+ * reports the worst case latency of every frame on the bus.
+ *
+ * The planner is given the bus's recurring frame set: fixed frames, which are sent at a known
+ * offset within their period that the planner can't change (such as the feedback burst of DJI
+ * motors, at the phase measured by a `FeedbackPhaseAligner`), and TX frames, whose offset the
+ * planner picks (such as the command frames of each DJI motor group, bridge traffic, or supercap
+ * polls). `plan` places the TX frames one at a time, highest priority (lowest id) first. Each
+ * frame is tried at every multiple of the resolution within its period, and placed at the offset
+ * that gives the smallest total worst case latency over every frame placed so far, the earliest
+ * such offset if there are several. For example, with DJI motor feedback ending 540 us into the
+ * period, a command frame is placed at 540 us rather than at 0, where it would delay every
+ * feedback frame.
+ *
+ * Latencies are measured by simulating arbitration on the bus over two hyperperiods (the least
+ * common multiple of the frame periods): whenever the bus is idle, the pending frame with the
+ * lowest id is sent. Since releases jitter in practice, the reported worst case latency of a
+ * frame also includes the time to send the longest lower priority frame, which may have started
+ * just before it was released. Frames on the bus that were not added to the planner are not
+ * accounted for.
+ *
+ * Offsets are relative to the start of the period. To have frames sent at their planned offsets,
+ * give the plan to the `DjiMotorTxHandler` or `MotorTxScheduler` that sends them with
+ * `setTxPlan`. The period then starts each time their `encodeAndSendCanData` is called, so fixed
+ * frames are added at their offset from the control tick. For example, with a 1 kHz control tick
+ * that starts at phase `tickPhase` of the microsecond clock:
+ *
+ * ```cpp
+ * const uint32_t burstOffset =
+ *     (aligner.getBurstPhase(CanBus::CAN_BUS1) + 1'000 - tickPhase) % 1'000;
+ *
+ * static CanTxPlanner planner;
+ * for (uint16_t id = 0x201; id <= 0x204; id++)
+ * {
+ *     planner.addFixedFrame(id, 8, 1'000, burstOffset);
+ * }
+ * planner.addTxFrame(0x200, 8, 1'000);
+ *
+ * if (planner.plan())
+ * {
+ *     drivers->djiMotorTxHandler.setTxPlan(CanBus::CAN_BUS1, &planner);
+ * }
+ * ```
+ *
+ * Planning simulates the bus once per candidate offset of each TX frame, so it is meant to be
+ * done once at startup. Only standard (11-bit) ids are supported. All times are in microseconds.
+ */
+class CanTxPlanner
+{
+public:
+    /// The max number of frames that may be added to the planner.
+    static constexpr int MAX_FRAMES = 32;
+
+    /// The max least common multiple of the periods of the frames added to the planner.
+    static constexpr uint32_t MAX_HYPERPERIOD = 100'000;
+
+    static constexpr uint32_t DEFAULT_BITRATE = 1'000'000;
+
+    /// Default spacing of the offsets tried for each TX frame.
+    static constexpr uint32_t DEFAULT_RESOLUTION = 10;
+
+    /// Returned for the offset and latency of ids that were not added, and unschedulable frames.
+    static constexpr uint32_t INVALID_TIME = UINT32_MAX;
+
+    /**
+     * @param[in] bitrate The bitrate of the bus, in bits per second.
+     * @param[in] resolution See `DEFAULT_RESOLUTION`.
+     */
+    explicit CanTxPlanner(
+        uint32_t bitrate = DEFAULT_BITRATE,
+        uint32_t resolution = DEFAULT_RESOLUTION);
+
+    /**
+     * Adds a frame sent `offset` into every `period`, whose offset is not changed by `plan`.
+     *
+     * @return `false` if the id is above `0x7FF` or was already added, the length is above 8,
+     *      the period is 0, the offset is not less than the period, `MAX_FRAMES` frames have
+     *      already been added, or the hyperperiod would be above `MAX_HYPERPERIOD`.
+     */
+    bool addFixedFrame(uint16_t id, uint8_t length, uint32_t period, uint32_t offset);
+
+    /**
+     * Adds a frame sent every `period`, whose offset is picked by `plan`.
+     *
+     * @return `false` under the same conditions as `addFixedFrame`.
+     */
+    bool addTxFrame(uint16_t id, uint8_t length, uint32_t period);
+
+    /// Removes every frame.
+    void clear();
+
+    /**
+     * Picks the offset of every TX frame and computes the worst case latency of every frame.
+     *
+     * @return `true` if every frame is sent within its period, `false` if the bus is overloaded
+     *      or some frame may be superseded by its next release before it is sent.
+     */
+    bool plan();
+
+    /// @return The number of frames added to the planner.
+    int getFrameCount() const { return frameCount; }
+
+    /**
+     * @return The offset within its period that the frame is released at, or `INVALID_TIME` if
+     *      no frame with the id was added or the frame is a TX frame and `plan` hasn't been
+     *      called since it was added.
+     */
+    uint32_t getOffset(uint16_t id) const;
+
+    /**
+     * @return `true` if a frame with the id is due, `elapsed` after the start of its period,
+     *      that is if `elapsed` has reached its offset or the id has no offset (see
+     *      `getOffset`). Used by `DjiMotorTxHandler::setTxPlan` and `MotorTxScheduler::setTxPlan`
+     *      to hold frames until their planned offset.
+     */
+    bool isReleased(uint16_t id, uint32_t elapsed) const;
+
+    /**
+     * @return The longest time from the frame's release until it has been sent, as of the most
+     *      recent `plan`, or `INVALID_TIME` if no frame with the id was added, a frame has been
+     *      added since the most recent `plan`, or the frame may not be sent before its next
+     *      release.
+     */
+    uint32_t getWorstCaseLatency(uint16_t id) const;
+
+    /**
+     * @return The time to send a frame with the given data length on the bus, including worst
+     *      case bit stuffing and the interframe space.
+     */
+    uint32_t getTransmitTime(uint8_t length) const;
+
+    /// @return The least common multiple of the periods of every frame, or 0 if there are none.
+    uint32_t getHyperperiod() const { return hyperperiod; }
+
+    /// @return The percent of the bus's bandwidth used by every frame, see `Can::BusStats`.
+    float getBusLoad() const;
+
+private:
+    struct Frame
+    {
+        uint16_t id;
+        uint8_t length;
+        /// `true` if the offset is picked by `plan`.
+        bool tx;
+        uint32_t period;
+        uint32_t offset;
+        uint32_t transmitTime;
+        uint32_t worstCaseLatency;
+        /// `true` if the frame is included in the simulation.
+        bool placed;
+    };
+
+    const uint32_t bitrate;
+    const uint32_t resolution;
+
+    /// Frames sorted by id, so that lower indices win arbitration.
+    Frame frames[MAX_FRAMES] = {};
+    int frameCount = 0;
+
+    uint32_t hyperperiod = 0;
+
+    bool addFrame(uint16_t id, uint8_t length, uint32_t period, uint32_t offset, bool tx);
+
+    const Frame *findFrame(uint16_t id) const;
+
+    /**
+     * Simulates arbitration of the placed frames, setting the worst case latency of each one
+     * (without blocking by lower priority frames).
+     *
+     * @return The sum of the worst case latencies, or `UINT64_MAX` if some frame may be
+     *      superseded by its next release before it is sent.
+     */
+    uint64_t simulate();
+};
+}  // namespace tap::can
+
+#endif  // TAPROOT_CAN_TX_PLANNER_HPP_
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAPTURE_FORMAT_HPP_
+#define TAPROOT_CAPTURE_FORMAT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The capture stream format, written by `CaptureRecorder` and read by `CaptureReplayer`. All
+ * fields are little endian.
+ *
+ * A stream is a header followed by records. The header is:
+ * - `uint32_t` `CAPTURE_MAGIC`
+ * - `uint16_t` `CAPTURE_VERSION`
+ * - `uint16_t` reserved, 0
+ *
+ * Each record is a record header followed by `length` bytes of payload:
+ * - `uint32_t` time the data was received, in microseconds (see
+ *   `tap::arch::clock::getTimeMicroseconds`)
+ * - `uint8_t` `CaptureSource`
+ * - `uint8_t` channel: the CAN bus index, the `UartPort`, or the IMU index
+ * - `uint16_t` length
+ *
+ * The payload depends on the source:
+ * - `CAN_RX`, `CAN_TX`: `uint32_t` identifier, with `CAPTURE_CAN_EXTENDED_FLAG` set if it is
+ *   extended, followed by the frame's data bytes
+ * - `UART_RX`: the bytes received
+ * - `IMU`: the accelerometer's X, Y, Z then the gyroscope's X, Y, Z registers, as read from the
+ *   sensor
+ */
+namespace tap::communication::capture
+{
+enum class CaptureSource : uint8_t
+{
+    CAN_RX = 1,
+    CAN_TX = 2,
+    UART_RX = 3,
+    IMU = 4,
+};
+
+static constexpr uint32_t CAPTURE_MAGIC = 0x43504154;  // "TAPC"
+static constexpr uint16_t CAPTURE_VERSION = 1;
+static constexpr size_t CAPTURE_HEADER_SIZE = 8;
+static constexpr size_t CAPTURE_RECORD_HEADER_SIZE = 8;
+static constexpr uint32_t CAPTURE_CAN_EXTENDED_FLAG = 1ul << 31;
+/// Size of the payload of an `IMU` record.
+static constexpr size_t CAPTURE_IMU_SAMPLE_SIZE = 12;
+}  // namespace tap::communication::capture
+
+#endif  // TAPROOT_CAPTURE_FORMAT_HPP_
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "capture_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+
+#include "modm/architecture/interface/atomic_lock.hpp"
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::communication::capture
+{
+static_assert((CaptureRecorder::BUFFER_SIZE & (CaptureRecorder::BUFFER_SIZE - 1)) == 0);
+
+CaptureRecorder *CaptureRecorder::activeRecorder = nullptr;
+
+CaptureRecorder::~CaptureRecorder()
+{
+    if (activeRecorder == this)
+    {
+        activeRecorder = nullptr;
+    }
+}
+
+void CaptureRecorder::start()
+{
+    readPosition = 0;
+    writePosition = 0;
+    hasOpenRecord = false;
+    numDropped = 0;
+
+    uint8_t header[CAPTURE_HEADER_SIZE] = {};
+    tap::arch::convertToLittleEndian(CAPTURE_MAGIC, header);
+    tap::arch::convertToLittleEndian(CAPTURE_VERSION, header + 4);
+    write(header, sizeof(header));
+    recording = true;
+}
+
+void CaptureRecorder::record(
+    CaptureSource source,
+    uint8_t channel,
+    const uint8_t *data,
+    std::size_t length)
+{
+    if (!recording)
+    {
+        return;
+    }
+
+#ifndef PLATFORM_HOSTED
+    // CAN frames sent from interrupts are recorded too
+    modm::atomic::Lock lock;
+#endif
+
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+
+    if (source == CaptureSource::UART_RX && hasOpenRecord && openRecordChannel == channel &&
+        openRecordTime == time && openRecordLength + length <= UINT16_MAX)
+    {
+        if (length > BUFFER_SIZE - getNumBuffered())
+        {
+            numDropped++;
+            return;
+        }
+        openRecordLength += length;
+        uint8_t lengthBytes[2];
+        tap::arch::convertToLittleEndian(openRecordLength, lengthBytes);
+        writeAt(openRecordPosition + 6, lengthBytes, sizeof(lengthBytes));
+        write(data, length);
+        return;
+    }
+
+    if (!beginRecord(source, channel, time, length))
+    {
+        return;
+    }
+    write(data, length);
+    if (source == CaptureSource::UART_RX)
+    {
+        openRecordChannel = channel;
+        openRecordTime = time;
+        openRecordLength = length;
+    }
+    else
+    {
+        hasOpenRecord = false;
+    }
+}
+
+void CaptureRecorder::recordCan(
+    CaptureSource source,
+    tap::can::CanBus bus,
+    const modm::can::Message &message)
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    uint8_t payload[4 + 8];
+    const uint8_t length = std::min<uint8_t>(message.getLength(), 8);
+    uint32_t identifier = message.getIdentifier();
+    if (message.isExtended())
+    {
+        identifier |= CAPTURE_CAN_EXTENDED_FLAG;
+    }
+    tap::arch::convertToLittleEndian(identifier, payload);
+    memcpy(payload + 4, message.data, length);
+
+    record(source, bus == tap::can::CanBus::CAN_BUS1 ? 0 : 1, payload, 4 + length);
+}
+
+std::size_t CaptureRecorder::read(uint8_t *data, std::size_t length)
+{
+    length = std::min(length, getNumBuffered());
+    const uint32_t start = readPosition & (BUFFER_SIZE - 1);
+    const std::size_t first = std::min<std::size_t>(length, BUFFER_SIZE - start);
+    memcpy(data, buffer + start, first);
+    memcpy(data + first, buffer, length - first);
+    readPosition += length;
+
+    if (hasOpenRecord && static_cast<int32_t>(readPosition - openRecordPosition) > 0)
+    {
+        // The record's length has been read, so nothing more can be appended to it
+        hasOpenRecord = false;
+    }
+    return length;
+}
+
+bool CaptureRecorder::beginRecord(
+    CaptureSource source,
+    uint8_t channel,
+    uint32_t time,
+    std::size_t length)
+{
+    if (length > UINT16_MAX ||
+        CAPTURE_RECORD_HEADER_SIZE + length > BUFFER_SIZE - getNumBuffered())
+    {
+        numDropped++;
+        return false;
+    }
+
+    uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+    tap::arch::convertToLittleEndian(time, header);
+    header[4] = static_cast<uint8_t>(source);
+    header[5] = channel;
+    tap::arch::convertToLittleEndian(static_cast<uint16_t>(length), header + 6);
+
+    hasOpenRecord = true;
+    openRecordPosition = writePosition;
+    write(header, sizeof(header));
+    return true;
+}
+
+void CaptureRecorder::writeAt(uint32_t position, const uint8_t *data, std::size_t length)
+{
+    for (std::size_t i = 0; i < length; i++)
+    {
+        buffer[(position + i) & (BUFFER_SIZE - 1)] = data[i];
+    }
+}
+
+void CaptureRecorder::write(const uint8_t *data, std::size_t length)
+{
+    const uint32_t start = writePosition & (BUFFER_SIZE - 1);
+    const std::size_t first = std::min<std::size_t>(length, BUFFER_SIZE - start);
+    memcpy(buffer + start, data, first);
+    memcpy(buffer, data + first, length - first);
+    writePosition += length;
+}
+}  // namespace tap::communication::capture
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAPTURE_RECORDER_HPP_
+#define TAPROOT_CAPTURE_RECORDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+#include "capture_format.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::communication::capture
+{
+/**
+ * Records the data the robot receives to a compact binary stream (see `capture_format.hpp`),
+ * which `CaptureReplayer` feeds back into a hosted build. While a recorder is active (see
+ * `setActive`), `tap::can::Can` records the CAN frames it reads and sends, `Uart` the bytes it
+ * reads, and `Bmi088` its samples, except in FIFO read mode.
+ *
+ * Records are written to a buffer of `BUFFER_SIZE` bytes, which the main loop drains with `read`
+ * and writes wherever it likes, for example a file or a spare UART:
+ *
+ * ```cpp
+ * CaptureRecorder recorder;
+ * CaptureRecorder::setActive(&recorder);
+ * recorder.start();
+ *
+ * void mainLoop()
+ * {
+ *     // ...
+ *     uint8_t chunk[256];
+ *     std::size_t length = recorder.read(chunk, sizeof(chunk));
+ *     drivers->uart.write(Uart::UartPort::Uart1, chunk, length);
+ * }
+ * ```
+ *
+ * A record that doesn't fit in the buffer is dropped whole, so the stream stays readable. UART
+ * bytes received from the same port at the same time are appended to a single record, so bytes
+ * read one at a time don't each cost a record header.
+ *
+ * Not reentrant, so only record from the main loop.
+ */
+class CaptureRecorder
+{
+public:
+    /// Size of the buffer, in bytes. Must be a power of two.
+    static constexpr uint32_t BUFFER_SIZE = 8192;
+
+    CaptureRecorder() = default;
+    DISALLOW_COPY_AND_ASSIGN(CaptureRecorder)
+    ~CaptureRecorder();
+
+    /// Sets the recorder drivers record to, or `nullptr` to stop them recording.
+    static void setActive(CaptureRecorder *recorder) { activeRecorder = recorder; }
+
+    static CaptureRecorder *getActive() { return activeRecorder; }
+
+    /// Clears the buffer and starts a new stream, beginning with the stream header.
+    void start();
+
+    /// Stops recording. Data already recorded may still be read.
+    void stop() { recording = false; }
+
+    bool isRecording() const { return recording; }
+
+    /**
+     * Records data received from the given source at the current time. Safe to call from
+     * interrupts.
+     *
+     * @param[in] length The number of bytes of `data`, at most `UINT16_MAX`.
+     */
+    void record(CaptureSource source, uint8_t channel, const uint8_t *data, std::size_t length);
+
+    /**
+     * Records a CAN frame.
+     *
+     * @param[in] source `CAN_RX` or `CAN_TX`.
+     */
+    void recordCan(CaptureSource source, tap::can::CanBus bus, const modm::can::Message &message);
+
+    /**
+     * Reads recorded data out of the buffer.
+     *
+     * @return The number of bytes read, at most `length`.
+     */
+    std::size_t read(uint8_t *data, std::size_t length);
+
+    /// @return The number of recorded bytes in the buffer.
+    std::size_t getNumBuffered() const { return writePosition - readPosition; }
+
+    /// @return The number of records dropped because the buffer was full.
+    uint32_t getNumDropped() const { return numDropped; }
+
+private:
+    static CaptureRecorder *activeRecorder;
+
+    uint8_t buffer[BUFFER_SIZE];
+
+    /// Positions are counts of bytes written since `start`, taken modulo `BUFFER_SIZE`.
+    uint32_t readPosition = 0;
+    uint32_t writePosition = 0;
+
+    /**
+     * The last record written, which UART bytes from the same port and time are appended to
+     * until any of it is read.
+     */
+    bool hasOpenRecord = false;
+    uint32_t openRecordPosition = 0;
+    uint32_t openRecordTime = 0;
+    uint8_t openRecordChannel = 0;
+    uint16_t openRecordLength = 0;
+
+    uint32_t numDropped = 0;
+    bool recording = false;
+
+    /// Writes a record header, or returns `false` if the record doesn't fit.
+    bool beginRecord(CaptureSource source, uint8_t channel, uint32_t time, std::size_t length);
+
+    void writeAt(uint32_t position, const uint8_t *data, std::size_t length);
+
+    void write(const uint8_t *data, std::size_t length);
+};
+}  // namespace tap::communication::capture
+
+#endif  // TAPROOT_CAPTURE_RECORDER_HPP_
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "capture_replayer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::communication::capture
+{
+CaptureReplayer *CaptureReplayer::activeReplayer = nullptr;
+
+CaptureReplayer::~CaptureReplayer()
+{
+    if (activeReplayer == this)
+    {
+        activeReplayer = nullptr;
+    }
+}
+
+bool CaptureReplayer::load(const uint8_t *data, std::size_t length)
+{
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    if (length < CAPTURE_HEADER_SIZE)
+    {
+        return false;
+    }
+    tap::arch::convertFromLittleEndian(&magic, data);
+    tap::arch::convertFromLittleEndian(&version, data + 4);
+    if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION)
+    {
+        return false;
+    }
+
+    stream.assign(data, data + length);
+    position = CAPTURE_HEADER_SIZE;
+    started = false;
+    numSkipped = 0;
+    for (auto &frames : canFrames)
+    {
+        frames.clear();
+    }
+    for (auto &bytes : uartBytes)
+    {
+        bytes.clear();
+    }
+    std::fill(std::begin(imuSampleReady), std::end(imuSampleReady), false);
+    return true;
+}
+
+bool CaptureReplayer::loadFile(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), {}};
+    return load(data.data(), data.size());
+}
+
+void CaptureReplayer::update() { update(tap::arch::clock::getTimeMicroseconds()); }
+
+void CaptureReplayer::update(uint32_t now)
+{
+    while (stream.size() - position >= CAPTURE_RECORD_HEADER_SIZE)
+    {
+        const uint8_t *header = stream.data() + position;
+        uint32_t time;
+        uint16_t length;
+        tap::arch::convertFromLittleEndian(&time, header);
+        tap::arch::convertFromLittleEndian(&length, header + 6);
+
+        if (!started)
+        {
+            timeOffset = now - time;
+            started = true;
+        }
+        if (static_cast<int32_t>(now - (time + timeOffset)) < 0)
+        {
+            return;
+        }
+
+        if (stream.size() - position - CAPTURE_RECORD_HEADER_SIZE < length)
+        {
+            // Truncated, which happens if recording stopped mid record
+            numSkipped++;
+            break;
+        }
+        deliver(
+            static_cast<CaptureSource>(header[4]),
+            header[5],
+            header + CAPTURE_RECORD_HEADER_SIZE,
+            length);
+        position += CAPTURE_RECORD_HEADER_SIZE + length;
+    }
+    position = stream.size();
+}
+
+bool CaptureReplayer::receiveCan(tap::can::CanBus bus, modm::can::Message &message)
+{
+    auto &frames = canFrames[bus == tap::can::CanBus::CAN_BUS1 ? 0 : 1];
+    if (frames.empty())
+    {
+        return false;
+    }
+    const CanFrame &frame = frames.front();
+    message.setIdentifier(frame.identifier & ~CAPTURE_CAN_EXTENDED_FLAG);
+    message.setExtended((frame.identifier & CAPTURE_CAN_EXTENDED_FLAG) != 0);
+    message.setLength(frame.length);
+    memcpy(message.data, frame.data, frame.length);
+    frames.pop_front();
+    return true;
+}
+
+std::size_t CaptureReplayer::readUart(uint8_t port, uint8_t *data, std::size_t length)
+{
+    if (port >= MAX_UART_PORTS)
+    {
+        return 0;
+    }
+    auto &bytes = uartBytes[port];
+    length = std::min(length, bytes.size());
+    std::copy_n(bytes.begin(), length, data);
+    bytes.erase(bytes.begin(), bytes.begin() + length);
+    return length;
+}
+
+bool CaptureReplayer::readImu(uint8_t imu, uint8_t (&sample)[CAPTURE_IMU_SAMPLE_SIZE])
+{
+    if (imu >= MAX_IMUS || !imuSampleReady[imu])
+    {
+        return false;
+    }
+    memcpy(sample, imuSamples[imu], CAPTURE_IMU_SAMPLE_SIZE);
+    imuSampleReady[imu] = false;
+    return true;
+}
+
+void CaptureReplayer::deliver(
+    CaptureSource source,
+    uint8_t channel,
+    const uint8_t *payload,
+    uint16_t length)
+{
+    switch (source)
+    {
+        case CaptureSource::CAN_RX:
+        {
+            if (channel >= 2 || length < 4 || length > 4 + 8)
+            {
+                break;
+            }
+            CanFrame frame = {};
+            tap::arch::convertFromLittleEndian(&frame.identifier, payload);
+            frame.length = length - 4;
+            memcpy(frame.data, payload + 4, frame.length);
+            if (canFrames[channel].size() >= MAX_BUFFERED)
+            {
+                canFrames[channel].pop_front();
+            }
+            canFrames[channel].push_back(frame);
+            return;
+        }
+        case CaptureSource::CAN_TX:
+            // What the recorded code sent, not input to the code being replayed
+            return;
+        case CaptureSource::UART_RX:
+        {
+            if (channel >= MAX_UART_PORTS)
+            {
+                break;
+            }
+            auto &bytes = uartBytes[channel];
+            bytes.insert(bytes.end(), payload, payload + length);
+            if (bytes.size() > MAX_BUFFERED)
+            {
+                bytes.erase(bytes.begin(), bytes.end() - MAX_BUFFERED);
+            }
+            return;
+        }
+        case CaptureSource::IMU:
+        {
+            if (channel >= MAX_IMUS || length != CAPTURE_IMU_SAMPLE_SIZE)
+            {
+                break;
+            }
+            memcpy(imuSamples[channel], payload, CAPTURE_IMU_SAMPLE_SIZE);
+            imuSampleReady[channel] = true;
+            return;
+        }
+    }
+    numSkipped++;
+}
+}  // namespace tap::communication::capture
+
+#endif  // PLATFORM_HOSTED
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CAPTURE_REPLAYER_HPP_
+#define TAPROOT_CAPTURE_REPLAYER_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+#include "capture_format.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::communication::capture
+{
+/**
+ * Replays a stream recorded by `CaptureRecorder` in a hosted build. While a replayer is active
+ * (see `setActive`), `tap::can::Can` receives the recorded CAN frames, `Uart` the recorded bytes,
+ * and `Bmi088` the recorded samples, in place of the simulator.
+ *
+ * Each record is delivered once the time is at least as far past the first call to `update` as
+ * the record was past the start of the recording. Driven by virtual time (see
+ * `tap::arch::clock::enableVirtualTime`), a replay is deterministic and runs at any speed, so a
+ * recorded match can be re-run against new control code and the `CAN_TX` records compared with
+ * what it sends:
+ *
+ * ```cpp
+ * CaptureReplayer replayer;
+ * replayer.loadFile("match.cap");
+ * CaptureReplayer::setActive(&replayer);
+ * tap::arch::clock::enableVirtualTime();
+ * while (!replayer.isFinished())
+ * {
+ *     replayer.update();
+ *     mainLoop();
+ *     tap::arch::clock::advance(1'000);
+ * }
+ * ```
+ */
+class CaptureReplayer
+{
+public:
+    /// The most data buffered per channel, beyond which the oldest is dropped.
+    static constexpr std::size_t MAX_BUFFERED = 4096;
+    static constexpr int MAX_UART_PORTS = 16;
+    static constexpr int MAX_IMUS = 2;
+
+    CaptureReplayer() = default;
+    DISALLOW_COPY_AND_ASSIGN(CaptureReplayer)
+    ~CaptureReplayer();
+
+    /// Sets the replayer drivers receive from, or `nullptr` for none.
+    static void setActive(CaptureReplayer *replayer) { activeReplayer = replayer; }
+
+    static CaptureReplayer *getActive() { return activeReplayer; }
+
+    /**
+     * Loads a stream to replay from the start.
+     *
+     * @return `false` if the stream doesn't start with a header of a supported version.
+     */
+    bool load(const uint8_t *data, std::size_t length);
+
+    /// Loads a stream from a file. @return `false` if it can't be read or loaded.
+    bool loadFile(const char *path);
+
+    /// Delivers the records due by the current time, see `tap::arch::clock::getTimeMicroseconds`.
+    void update();
+
+    /// Delivers the records due by time `now`, in microseconds.
+    void update(uint32_t now);
+
+    /// @return `true` once every record has been delivered.
+    bool isFinished() const { return position >= stream.size(); }
+
+    /// Receives a delivered CAN frame. @return `false` if there is none.
+    bool receiveCan(tap::can::CanBus bus, modm::can::Message &message);
+
+    /**
+     * Receives delivered UART bytes.
+     *
+     * @return The number of bytes read, at most `length`.
+     */
+    std::size_t readUart(uint8_t port, uint8_t *data, std::size_t length);
+
+    /**
+     * Receives the most recently delivered IMU sample, if it hasn't been received already.
+     *
+     * @param[out] sample The sample, in the layout of an `IMU` record's payload.
+     */
+    bool readImu(uint8_t imu, uint8_t (&sample)[CAPTURE_IMU_SAMPLE_SIZE]);
+
+    /// @return The number of records that were malformed or for a channel that isn't supported.
+    uint32_t getNumSkipped() const { return numSkipped; }
+
+private:
+    struct CanFrame
+    {
+        uint32_t identifier;
+        uint8_t length;
+        uint8_t data[8];
+    };
+
+    static CaptureReplayer *activeReplayer;
+
+    std::vector<uint8_t> stream;
+    std::size_t position = 0;
+
+    /// The current time minus the time in the recording, set by the first `update`.
+    uint32_t timeOffset = 0;
+    bool started = false;
+
+    std::deque<CanFrame> canFrames[2];
+    std::deque<uint8_t> uartBytes[MAX_UART_PORTS];
+    uint8_t imuSamples[MAX_IMUS][CAPTURE_IMU_SAMPLE_SIZE] = {};
+    bool imuSampleReady[MAX_IMUS] = {};
+
+    uint32_t numSkipped = 0;
+
+    void deliver(CaptureSource source, uint8_t channel, const uint8_t *payload, uint16_t length);
+};
+}  // namespace tap::communication::capture
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_CAPTURE_REPLAYER_HPP_
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "encoded_graphic.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/communication/serial/ref_serial.hpp"
+#include "tap/communication/serial/ref_serial_transmitter.hpp"
+
+using namespace tap::communication::serial;
+using namespace tap::algorithms;
+
+namespace tap::communication::referee
+{
+using Tx = RefSerialData::Tx;
+
+static_assert(sizeof(Tx::GraphicData) == 15, "GraphicData must be packed");
+
+static constexpr size_t NUMBER_GRAPHIC_OFFSET = offsetof(Tx::Graphic1Message, graphicData);
+/// The value is the last 4 bytes of the graphic data.
+static constexpr size_t NUMBER_VALUE_OFFSET =
+    NUMBER_GRAPHIC_OFFSET + sizeof(Tx::GraphicData) - sizeof(int32_t);
+static constexpr size_t NUMBER_CRC_OFFSET = offsetof(Tx::Graphic1Message, crc16);
+
+static constexpr size_t TEXT_GRAPHIC_OFFSET = offsetof(Tx::GraphicCharacterMessage, graphicData);
+static constexpr size_t TEXT_OFFSET = offsetof(Tx::GraphicCharacterMessage, msg);
+static constexpr size_t TEXT_CRC_OFFSET = offsetof(Tx::GraphicCharacterMessage, crc16);
+static constexpr size_t MAX_TEXT_LENGTH = sizeof(Tx::GraphicCharacterMessage::msg) - 1;
+
+/**
+ * Configures the headers of a graphic message like `RefSerialTransmitter::sendGraphic`.
+ *
+ * @return The CRC16 of the headers.
+ */
+template <typename MESSAGE>
+static uint16_t encodeHeaders(
+    MESSAGE &message,
+    uint16_t messageId,
+    RefSerialData::RobotId robotId,
+    uint16_t extraDataLength)
+{
+    RefSerialTransmitter::configFrameHeader(
+        &message.frameHeader,
+        sizeof(message.graphicData) + sizeof(message.interactiveHeader) + extraDataLength);
+    message.cmdId = RefSerial::REF_MESSAGE_TYPE_CUSTOM_DATA;
+    // The client of a robot has ID 0x100 + the robot's ID
+    RefSerialTransmitter::configInteractiveHeader(
+        &message.interactiveHeader,
+        messageId,
+        robotId,
+        0x100 + static_cast<uint16_t>(robotId));
+    return calculateCRC16(
+        reinterpret_cast<const uint8_t *>(&message),
+        offsetof(MESSAGE, graphicData));
+}
+
+EncodedNumberGraphic::EncodedNumberGraphic(const Tx::GraphicData &graphic) : message()
+{
+    message.graphicData = graphic;
+}
+
+void EncodedNumberGraphic::encode(RefSerialData::RobotId robotId)
+{
+    if (robotId == this->robotId)
+    {
+        return;
+    }
+    this->robotId = robotId;
+    graphicCrc = encodeHeaders(message, 0x101, robotId, 0);
+    updateGraphicCrc();
+}
+
+void EncodedNumberGraphic::setOperation(Tx::GraphicOperation operation)
+{
+    if (message.graphicData.operation == operation)
+    {
+        return;
+    }
+    message.graphicData.operation = operation;
+    if (isEncoded())
+    {
+        updateGraphicCrc();
+    }
+}
+
+bool EncodedNumberGraphic::setInteger(int32_t value)
+{
+    if (message.graphicData.value == value)
+    {
+        return false;
+    }
+    message.graphicData.value = value;
+    if (isEncoded())
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&message);
+        message.crc16 = calculateCRC16(
+            bytes + NUMBER_VALUE_OFFSET,
+            NUMBER_CRC_OFFSET - NUMBER_VALUE_OFFSET,
+            valueCrc);
+    }
+    return true;
+}
+
+bool EncodedNumberGraphic::setFloat(float value)
+{
+    return setInteger(static_cast<int32_t>(1000 * value));
+}
+
+void EncodedNumberGraphic::updateGraphicCrc()
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&message);
+    valueCrc = calculateCRC16(
+        bytes + NUMBER_GRAPHIC_OFFSET,
+        NUMBER_VALUE_OFFSET - NUMBER_GRAPHIC_OFFSET,
+        graphicCrc);
+    message.crc16 = calculateCRC16(
+        bytes + NUMBER_VALUE_OFFSET,
+        NUMBER_CRC_OFFSET - NUMBER_VALUE_OFFSET,
+        valueCrc);
+}
+
+EncodedTextGraphic::EncodedTextGraphic(
+    const Tx::GraphicData &graphic,
+    uint16_t fontSize,
+    uint16_t width,
+    uint16_t startX,
+    uint16_t startY)
+    : message()
+{
+    message.graphicData = graphic;
+    RefSerialTransmitter::configCharacterMsg(fontSize, width, startX, startY, "", &message);
+}
+
+void EncodedTextGraphic::encode(RefSerialData::RobotId robotId)
+{
+    if (robotId == this->robotId)
+    {
+        return;
+    }
+    this->robotId = robotId;
+    graphicCrc = encodeHeaders(message, 0x110, robotId, sizeof(message.msg));
+    updateGraphicCrc();
+}
+
+void EncodedTextGraphic::setOperation(Tx::GraphicOperation operation)
+{
+    if (message.graphicData.operation == operation)
+    {
+        return;
+    }
+    message.graphicData.operation = operation;
+    if (isEncoded())
+    {
+        updateGraphicCrc();
+    }
+}
+
+bool EncodedTextGraphic::setText(const char *text)
+{
+    const size_t length = strnlen(text, MAX_TEXT_LENGTH);
+    if (length == message.graphicData.endAngle && memcmp(message.msg, text, length) == 0)
+    {
+        return false;
+    }
+
+    // Unused bytes are zeroed so the encoded message only depends on the text
+    memset(message.msg, 0, sizeof(message.msg));
+    memcpy(message.msg, text, length);
+
+    if (length != message.graphicData.endAngle)
+    {
+        // The length is part of the graphic data
+        message.graphicData.endAngle = length;
+        if (isEncoded())
+        {
+            updateGraphicCrc();
+        }
+    }
+    else if (isEncoded())
+    {
+        message.crc16 = calculateCRC16(
+            reinterpret_cast<const uint8_t *>(&message) + TEXT_OFFSET,
+            TEXT_CRC_OFFSET - TEXT_OFFSET,
+            textCrc);
+    }
+    return true;
+}
+
+void EncodedTextGraphic::updateGraphicCrc()
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&message);
+    textCrc =
+        calculateCRC16(bytes + TEXT_GRAPHIC_OFFSET, TEXT_OFFSET - TEXT_GRAPHIC_OFFSET, graphicCrc);
+    message.crc16 = calculateCRC16(bytes + TEXT_OFFSET, TEXT_CRC_OFFSET - TEXT_OFFSET, textCrc);
+}
+}  // namespace tap::communication::referee
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ENCODED_GRAPHIC_HPP_
+#define TAPROOT_ENCODED_GRAPHIC_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/serial/ref_serial_data.hpp"
+
+namespace tap::communication::referee
+{
+/**
+ * A `Graphic1Message` holding a number (see `RefSerialTransmitter::configInteger` and
+ * `configFloatingNumber`) whose headers and CRC are encoded once, so that changing the number
+ * only writes its 4 value bytes and updates the CRC over those bytes, rather than reconfiguring
+ * and re-encoding the whole message.
+ *
+ * The CRC16 of the message bytes before the value is computed by `encode` and kept, and each
+ * change of the value resumes the CRC from there. The message is sent without reconfiguring its
+ * headers.
+ *
+ * Usage:
+ *
+ * ```
+ * Tx::GraphicData graphic;
+ * RefSerialTransmitter::configGraphicGenerics(&graphic, "\x00\x00\x02", GRAPHIC_ADD, 1, GREEN);
+ * RefSerialTransmitter::configInteger(20, 2, 100, 700, 0, &graphic);
+ * EncodedNumberGraphic ammo(graphic);
+ *
+ * // In a protothread:
+ * ammo.encode(drivers->refSerial.getRobotData().robotId);
+ * if (ammo.setInteger(remainingAmmo))
+ * {
+ *     PT_CALL(refSerialTransmitter.sendGraphic(ammo.getMessage(), false));
+ *     ammo.setOperation(Tx::GRAPHIC_MODIFY);
+ * }
+ * ```
+ */
+class EncodedNumberGraphic
+{
+public:
+    /**
+     * @param[in] graphic The number graphic, configured with `configGraphicGenerics` and
+     *      `configInteger` or `configFloatingNumber`.
+     */
+    explicit EncodedNumberGraphic(const serial::RefSerialData::Tx::GraphicData &graphic);
+
+    /**
+     * Encodes the message's headers to be sent by `robotId`. Does nothing if the message is
+     * already encoded for `robotId`, so may be called before every send.
+     */
+    void encode(serial::RefSerialData::RobotId robotId);
+
+    /// Sets the graphic operation, updating the CRC from the graphic data on.
+    void setOperation(serial::RefSerialData::Tx::GraphicOperation operation);
+
+    /// Sets the value of an integer graphic. @return `true` if the value changed.
+    bool setInteger(int32_t value);
+
+    /**
+     * Sets the value of a floating point graphic, stored with 3 decimal places like
+     * `configFloatingNumber`. @return `true` if the value changed.
+     */
+    bool setFloat(float value);
+
+    int32_t getValue() const { return message.graphicData.value; }
+
+    /// @return `true` if `encode` has been called.
+    bool isEncoded() const { return robotId != serial::RefSerialData::RobotId::INVALID; }
+
+    /**
+     * @return The encoded message, to be sent with `RefSerialTransmitter::sendGraphic` with
+     *      `configMsgHeader` set to `false`.
+     */
+    serial::RefSerialData::Tx::Graphic1Message *getMessage() { return &message; }
+
+private:
+    serial::RefSerialData::Tx::Graphic1Message message;
+
+    serial::RefSerialData::RobotId robotId = serial::RefSerialData::RobotId::INVALID;
+
+    /// The CRC16 of the message bytes before the graphic data.
+    uint16_t graphicCrc = 0;
+
+    /// The CRC16 of the message bytes before the value.
+    uint16_t valueCrc = 0;
+
+    void updateGraphicCrc();
+};
+
+/**
+ * A `GraphicCharacterMessage` whose headers and CRC are encoded once, so that changing the text
+ * only rewrites the text and updates the CRC over it, see `EncodedNumberGraphic`.
+ */
+class EncodedTextGraphic
+{
+public:
+    /**
+     * @param[in] graphic The text graphic, configured with `configGraphicGenerics`. Its font size,
+     *      line width and position are set by `configCharacterMsg` like parameters.
+     */
+    EncodedTextGraphic(
+        const serial::RefSerialData::Tx::GraphicData &graphic,
+        uint16_t fontSize,
+        uint16_t width,
+        uint16_t startX,
+        uint16_t startY);
+
+    /// @see EncodedNumberGraphic::encode
+    void encode(serial::RefSerialData::RobotId robotId);
+
+    /// Sets the graphic operation, updating the CRC from the graphic data on.
+    void setOperation(serial::RefSerialData::Tx::GraphicOperation operation);
+
+    /**
+     * Sets the text, truncated to 29 characters. The CRC is only updated from the text on,
+     * unless the length of the text changed.
+     *
+     * @return `true` if the text changed.
+     */
+    bool setText(const char *text);
+
+    const char *getText() const { return message.msg; }
+
+    bool isEncoded() const { return robotId != serial::RefSerialData::RobotId::INVALID; }
+
+    /// @see EncodedNumberGraphic::getMessage
+    serial::RefSerialData::Tx::GraphicCharacterMessage *getMessage() { return &message; }
+
+private:
+    serial::RefSerialData::Tx::GraphicCharacterMessage message;
+
+    serial::RefSerialData::RobotId robotId = serial::RefSerialData::RobotId::INVALID;
+
+    /// The CRC16 of the message bytes before the graphic data.
+    uint16_t graphicCrc = 0;
+
+    /// The CRC16 of the message bytes before the text.
+    uint16_t textCrc = 0;
+
+    void updateGraphicCrc();
+};
+}  // namespace tap::communication::referee
+
+#endif  // TAPROOT_ENCODED_GRAPHIC_HPP_
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hud_compositor.hpp"
+
+#include <cstring>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+using namespace tap::communication::serial;
+
+namespace tap::communication::referee
+{
+HudCompositor::HudCompositor(
+    Drivers *drivers,
+    RefSerialTransmitter &refSerialTransmitter,
+    uint32_t restoreIntervalMs)
+    : drivers(drivers),
+      refSerialTransmitter(refSerialTransmitter),
+      restoreIntervalMs(restoreIntervalMs),
+      entries(),
+      graphic1Message(),
+      graphic2Message(),
+      graphic5Message(),
+      graphic7Message()
+{
+}
+
+bool HudCompositor::addGraphic(const RefSerialData::Tx::GraphicData *graphic, uint8_t priority)
+{
+    if (numEntries >= MAX_GRAPHICS)
+    {
+        RAISE_ERROR(drivers, "hud compositor full");
+        return false;
+    }
+
+    for (int i = 0; i < numEntries; i++)
+    {
+        if (memcmp(entries[i].graphic->name, graphic->name, sizeof(graphic->name)) == 0)
+        {
+            RAISE_ERROR(drivers, "graphic name already in hud compositor");
+            return false;
+        }
+    }
+
+    Entry &entry = entries[numEntries++];
+    entry.graphic = graphic;
+    entry.lastSent = RefSerialData::Tx::GraphicData();
+    entry.lastSentTime = 0;
+    entry.priority = priority;
+    entry.added = false;
+    entry.restoring = false;
+    return true;
+}
+
+void HudCompositor::resendAll()
+{
+    for (int i = 0; i < numEntries; i++)
+    {
+        restore(entries[i]);
+    }
+}
+
+void HudCompositor::markLayerDeleted(uint8_t layer)
+{
+    for (int i = 0; i < numEntries; i++)
+    {
+        if (entries[i].graphic->layer == layer)
+        {
+            restore(entries[i]);
+        }
+    }
+}
+
+bool HudCompositor::detectReconnect()
+{
+    const bool receivingData = drivers->refSerial.getRefSerialReceivingData();
+    const RefSerialData::RobotId robotId = drivers->refSerial.getRobotData().robotId;
+
+    const bool reconnected = (receivingData && !wasReceivingData) || robotId != lastRobotId;
+    wasReceivingData = receivingData;
+    lastRobotId = robotId;
+
+    if (reconnected)
+    {
+        resendAll();
+    }
+    return reconnected;
+}
+
+int HudCompositor::getNumChangedGraphics() const
+{
+    int numChanged = 0;
+    for (int i = 0; i < numEntries; i++)
+    {
+        if (hasChanged(entries[i]))
+        {
+            numChanged++;
+        }
+    }
+    return numChanged;
+}
+
+int HudCompositor::getNumRestoringGraphics() const
+{
+    int numRestoring = 0;
+    for (int i = 0; i < numEntries; i++)
+    {
+        if (entries[i].restoring)
+        {
+            numRestoring++;
+        }
+    }
+    return numRestoring;
+}
+
+int HudCompositor::packNextBatch(RefSerialData::Tx::GraphicData *batch)
+{
+    const uint32_t currTime = tap::arch::clock::getTimeMilliseconds();
+    const bool restoreDue = !restoreSent || currTime - lastRestoreTime >= restoreIntervalMs;
+
+    bool changed[MAX_GRAPHICS];
+    int numChanged = 0;
+    for (int i = 0; i < numEntries; i++)
+    {
+        changed[i] = hasChanged(entries[i]) && (!entries[i].restoring || restoreDue);
+        if (changed[i])
+        {
+            numChanged++;
+        }
+    }
+
+    if (numChanged == 0)
+    {
+        return 0;
+    }
+
+    // the smallest message all changed graphics fit in
+    int messageSize;
+    if (numChanged <= 1)
+    {
+        messageSize = 1;
+    }
+    else if (numChanged <= 2)
+    {
+        messageSize = 2;
+    }
+    else if (numChanged <= 5)
+    {
+        messageSize = 5;
+    }
+    else
+    {
+        messageSize = MAX_GRAPHICS_PER_MESSAGE;
+    }
+
+    bool selected[MAX_GRAPHICS] = {};
+    int numPacked = 0;
+
+    // Selection sort is used since at most MAX_GRAPHICS_PER_MESSAGE graphics are selected out of
+    // a small number of graphics. Slots left over after the changed graphics are filled with the
+    // least recently sent unchanged graphics.
+    for (; numPacked < messageSize && numPacked < numEntries; numPacked++)
+    {
+        int next = -1;
+        for (int i = 0; i < numEntries; i++)
+        {
+            if (!selected[i] &&
+                (next < 0 || sendsBefore(entries[i], changed[i], entries[next], changed[next])))
+            {
+                next = i;
+            }
+        }
+        selected[next] = true;
+
+        Entry &entry = entries[next];
+        batch[numPacked] = *entry.graphic;
+        // Unchanged graphics are resent with GRAPHIC_ADD, which replaces the graphic if it exists
+        // and draws it if it was dropped.
+        batch[numPacked].operation = (entry.added && changed[next])
+                                         ? RefSerialData::Tx::GRAPHIC_MODIFY
+                                         : RefSerialData::Tx::GRAPHIC_ADD;
+
+        if (entry.restoring)
+        {
+            lastRestoreTime = currTime;
+            restoreSent = true;
+        }
+        entry.lastSent = batch[numPacked];
+        entry.lastSentTime = currTime;
+        entry.added = true;
+        entry.restoring = false;
+    }
+
+    for (; numPacked < messageSize; numPacked++)
+    {
+        batch[numPacked] = RefSerialData::Tx::GraphicData();
+        batch[numPacked].operation = RefSerialData::Tx::GRAPHIC_NO_OP;
+    }
+
+    return messageSize;
+}
+
+modm::ResumableResult<bool> HudCompositor::update()
+{
+    RF_BEGIN(0);
+
+    detectReconnect();
+
+    if (drivers->refSerial.getRobotData().robotId == RefSerialData::RobotId::INVALID)
+    {
+        RF_RETURN(false);
+    }
+
+    batchSize = packNextBatch(graphic7Message.graphicData);
+
+    if (batchSize == 1)
+    {
+        graphic1Message.graphicData = graphic7Message.graphicData[0];
+        RF_CALL(refSerialTransmitter.sendGraphic(&graphic1Message));
+    }
+    else if (batchSize == 2)
+    {
+        memcpy(
+            graphic2Message.graphicData,
+            graphic7Message.graphicData,
+            sizeof(graphic2Message.graphicData));
+        RF_CALL(refSerialTransmitter.sendGraphic(&graphic2Message));
+    }
+    else if (batchSize == 5)
+    {
+        memcpy(
+            graphic5Message.graphicData,
+            graphic7Message.graphicData,
+            sizeof(graphic5Message.graphicData));
+        RF_CALL(refSerialTransmitter.sendGraphic(&graphic5Message));
+    }
+    else if (batchSize == MAX_GRAPHICS_PER_MESSAGE)
+    {
+        RF_CALL(refSerialTransmitter.sendGraphic(&graphic7Message));
+    }
+    else
+    {
+        RF_RETURN(false);
+    }
+
+    RF_END_RETURN(true);
+}
+
+void HudCompositor::restore(Entry &entry)
+{
+    entry.added = false;
+    entry.restoring = true;
+}
+
+bool HudCompositor::hasChanged(const Entry &entry)
+{
+    if (!entry.added)
+    {
+        return true;
+    }
+
+    // the owner of the graphic doesn't set the operation, so don't compare it
+    RefSerialData::Tx::GraphicData current = *entry.graphic;
+    current.operation = entry.lastSent.operation;
+    return memcmp(&current, &entry.lastSent, sizeof(current)) != 0;
+}
+
+bool HudCompositor::sendsBefore(const Entry &a, bool aChanged, const Entry &b, bool bChanged)
+{
+    if (aChanged != bChanged)
+    {
+        return aChanged;
+    }
+    if (a.restoring != b.restoring)
+    {
+        // Owner changes are more urgent than restores, and restores than resends
+        return aChanged ? !a.restoring : a.restoring;
+    }
+    if (a.priority != b.priority)
+    {
+        return a.priority > b.priority;
+    }
+    return a.lastSentTime < b.lastSentTime;
+}
+}  // namespace tap::communication::referee
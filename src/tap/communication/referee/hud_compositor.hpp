@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_HUD_COMPOSITOR_HPP_
+#define TAPROOT_HUD_COMPOSITOR_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/serial/ref_serial_data.hpp"
+#include "tap/communication/serial/ref_serial_transmitter.hpp"
+
+#include "modm/processing/resumable.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::communication::referee
+{
+/**
+ * Batches graphics drawn on the RoboMaster client into as few referee system messages as
+ * possible. The referee system limits how many bytes of interactive data may be sent per second,
+ * and sending each graphic in its own `Graphic1Message` spends most of that bandwidth on message
+ * headers. Instead, graphics are added to the compositor once and then modified in place by their
+ * owner (for example by a `StateHUDIndicator`'s update function). Each call to `update` compares
+ * every graphic to the version that was last sent and packs the graphics that have changed into
+ * a single `Graphic2Message`, `Graphic5Message`, or `Graphic7Message`.
+ *
+ * When more graphics have changed than fit in one message, higher priority graphics are sent
+ * first, and among graphics of equal priority the ones that have gone the longest without being
+ * sent are sent first. Slots in a message that no changed graphic needs are filled by resending
+ * the graphics that have gone the longest without being sent, which recovers graphics dropped by
+ * the referee system at no extra bandwidth cost.
+ *
+ * The compositor keeps the last sent copy of every graphic, so it knows what the client shows.
+ * When the client loses its graphics, because the referee system reconnected, the robot ID
+ * changed, or a layer was deleted (see `markLayerDeleted`), only the graphics that were lost are
+ * restored, and at most one message of restored graphics is sent per restore interval. This keeps
+ * the restore from using all of the bandwidth, which is shared with changes made by owners and
+ * other interactive data. Changes made by owners are sent before restored graphics, and are not
+ * rate limited.
+ *
+ * @note Character graphics are sent using a `GraphicCharacterMessage` that cannot hold more than
+ *      one graphic, so they can't be added to a compositor.
+ *
+ * Usage:
+ *
+ * ```
+ * Tx::GraphicData crosshair;
+ * RefSerialTransmitter::configGraphicGenerics(&crosshair, "\x00\x00\x01", GRAPHIC_ADD, 1, GREEN);
+ * RefSerialTransmitter::configLine(2, 960, 500, 960, 580, &crosshair);
+ * compositor.addGraphic(&crosshair, 1);
+ *
+ * // In a protothread:
+ * PT_CALL(refSerialTransmitter.deleteGraphicLayer(DELETE_ALL, 0));
+ * compositor.resendAll();
+ * while (true)
+ * {
+ *     PT_CALL(compositor.update());
+ *     PT_YIELD();
+ * }
+ * ```
+ */
+class HudCompositor : public modm::Resumable<1>
+{
+public:
+    /// The maximum number of graphics that may be added to a compositor.
+    static constexpr int MAX_GRAPHICS = 32;
+
+    /// The maximum number of graphics that fit in a single message (a `Graphic7Message`).
+    static constexpr int MAX_GRAPHICS_PER_MESSAGE = 7;
+
+    /**
+     * The default minimum time between messages of restored graphics, in milliseconds. A
+     * `Graphic7Message` is 120 bytes, so this restores graphics at about 60% of the referee
+     * system's interactive data bandwidth.
+     */
+    static constexpr uint32_t DEFAULT_RESTORE_INTERVAL_MS = 200;
+
+    /**
+     * @param[in] restoreIntervalMs The minimum time between messages that restore graphics the
+     *      client lost, in milliseconds.
+     */
+    HudCompositor(
+        Drivers *drivers,
+        serial::RefSerialTransmitter &refSerialTransmitter,
+        uint32_t restoreIntervalMs = DEFAULT_RESTORE_INTERVAL_MS);
+
+    /**
+     * Adds a graphic to the compositor. The graphic must remain valid for the lifetime of the
+     * compositor, and should be modified in place to change what is drawn. The compositor sets
+     * the graphic operation of each graphic it sends, so the `operation` field of `graphic` is
+     * ignored.
+     *
+     * @param[in] graphic The graphic to draw, whose name must be unique among graphics added.
+     * @param[in] priority The priority of the graphic. Changes to higher priority graphics are
+     *      sent before changes to lower priority graphics.
+     * @return `false` (and raises an error) if the compositor is full or already contains a
+     *      graphic with the same name, `true` otherwise.
+     */
+    bool addGraphic(const serial::RefSerialData::Tx::GraphicData *graphic, uint8_t priority = 0);
+
+    /**
+     * Restores every graphic, as if it had never been sent, for example after the RoboMaster
+     * client has been restarted or all graphic layers have been deleted.
+     */
+    void resendAll();
+
+    /**
+     * Restores the graphics on a layer after it has been deleted with
+     * `RefSerialTransmitter::deleteGraphicLayer`. Graphics on other layers are not resent.
+     */
+    void markLayerDeleted(uint8_t layer);
+
+    /**
+     * Restores every graphic if the referee system started receiving data again or the robot's
+     * ID changed since the last call, since the client's graphics are lost in both cases.
+     * Called by `update`.
+     *
+     * @return `true` if the graphics are being restored.
+     */
+    bool detectReconnect();
+
+    /**
+     * @return The number of graphics whose current state has not been sent.
+     */
+    int getNumChangedGraphics() const;
+
+    /**
+     * @return The number of graphics the client lost that have not been restored yet.
+     */
+    int getNumRestoringGraphics() const;
+
+    /**
+     * Packs the graphics that should be sent next into `batch`, marking them as sent.
+     *
+     * Graphics being restored only count as changed once the restore interval has elapsed since
+     * a restored graphic was last sent, but take free slots in any message.
+     *
+     * @param[out] batch Storage for up to `MAX_GRAPHICS_PER_MESSAGE` graphics. Every entry up to
+     *      the returned message size is written, with the graphic operation set.
+     * @return The number of graphics in the message that should be sent (0, 1, 2, 5, or 7). This
+     *      is 0 if no graphic has changed.
+     */
+    int packNextBatch(serial::RefSerialData::Tx::GraphicData *batch);
+
+    /**
+     * Sends a single message containing the graphics that have changed the most urgently (see
+     * `packNextBatch`). The message is sent at `TransmissionPriority::LOW` as soon as the referee
+     * system's bandwidth limit allows. Does nothing if no graphic has changed or the robot's ID is
+     * not yet known. Checks for a reconnect first, see `detectReconnect`.
+     *
+     * Should be called repeatedly in a protothread.
+     */
+    modm::ResumableResult<bool> update();
+
+private:
+    struct Entry
+    {
+        /// The graphic as currently drawn by its owner.
+        const serial::RefSerialData::Tx::GraphicData *graphic;
+        /// The graphic as it was last sent, with the operation it was last sent with.
+        serial::RefSerialData::Tx::GraphicData lastSent;
+        /// Time the graphic was last sent, in milliseconds.
+        uint32_t lastSentTime;
+        uint8_t priority;
+        /// `true` if the graphic has been added to the client (and must be modified instead).
+        bool added;
+        /// `true` if the client lost the graphic and it hasn't been restored yet.
+        bool restoring;
+    };
+
+    Drivers *drivers;
+
+    serial::RefSerialTransmitter &refSerialTransmitter;
+
+    const uint32_t restoreIntervalMs;
+
+    Entry entries[MAX_GRAPHICS];
+
+    int numEntries = 0;
+
+    serial::RefSerialData::Tx::Graphic1Message graphic1Message;
+    serial::RefSerialData::Tx::Graphic2Message graphic2Message;
+    serial::RefSerialData::Tx::Graphic5Message graphic5Message;
+    serial::RefSerialData::Tx::Graphic7Message graphic7Message;
+
+    int batchSize = 0;
+
+    /// Time a restored graphic was last sent, in milliseconds.
+    uint32_t lastRestoreTime = 0;
+
+    bool restoreSent = false;
+
+    bool wasReceivingData = false;
+
+    serial::RefSerialData::RobotId lastRobotId = serial::RefSerialData::RobotId::INVALID;
+
+    /// Marks the graphic as lost by the client.
+    static void restore(Entry &entry);
+
+    /// @return `true` if the graphic has changed or has never been added.
+    static bool hasChanged(const Entry &entry);
+
+    /**
+     * @return `true` if `a` should be sent before `b`, with changed graphics before unchanged
+     *      graphics, then owner changes before restores among changed graphics and restores
+     *      before resends among unchanged graphics, then higher priorities first, then least
+     *      recently sent first.
+     */
+    static bool sendsBefore(const Entry &a, bool aChanged, const Entry &b, bool bChanged);
+};
+}  // namespace tap::communication::referee
+
+#endif  // TAPROOT_HUD_COMPOSITOR_HPP_
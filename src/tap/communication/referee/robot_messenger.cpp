@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "robot_messenger.hpp"
+
+#include <algorithm>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+using namespace tap::communication::serial;
+
+namespace tap::communication::referee
+{
+static constexpr uint8_t TOPIC_ID_MASK = 0x3f;
+
+static uint8_t numFragments(uint16_t size)
+{
+    return (size + RobotMessenger::FRAGMENT_DATA_SIZE - 1) / RobotMessenger::FRAGMENT_DATA_SIZE;
+}
+
+RobotMessenger::RobotMessenger(
+    Drivers *drivers,
+    RefSerialTransmitter &refSerialTransmitter,
+    uint16_t messageId)
+    : drivers(drivers),
+      refSerialTransmitter(refSerialTransmitter),
+      messageId(messageId),
+      txTopics(),
+      rxTopics(),
+      message()
+{
+}
+
+void RobotMessenger::initialize()
+{
+    drivers->refSerial.attachRobotToRobotMessageHandler(messageId, this);
+}
+
+bool RobotMessenger::addTopic(
+    uint8_t topicId,
+    uint16_t size,
+    const RobotMessengerTopicConfig &config)
+{
+    if (topicId >= MAX_TOPIC_ID || size == 0 || size > MAX_TOPIC_SIZE)
+    {
+        RAISE_ERROR(drivers, "invalid robot messenger topic");
+        return false;
+    }
+    if (numTxTopics >= MAX_TOPICS || findTxTopic(topicId) != nullptr)
+    {
+        RAISE_ERROR(drivers, "robot messenger topic already added or too many topics");
+        return false;
+    }
+
+    TxTopic &topic = txTopics[numTxTopics++];
+    topic = TxTopic();
+    topic.id = topicId;
+    topic.size = size;
+    topic.config = config;
+    return true;
+}
+
+bool RobotMessenger::publish(uint8_t topicId, const uint8_t *data, uint16_t length)
+{
+    TxTopic *topic = findTxTopic(topicId);
+    if (topic == nullptr || length != topic->size)
+    {
+        return false;
+    }
+
+    if (topic->pending)
+    {
+        numSupersededValues++;
+    }
+    memcpy(topic->value, data, length);
+    topic->sequence++;
+    topic->pending = true;
+    topic->nextFragment = 0;
+    topic->publishTime = tap::arch::clock::getTimeMilliseconds();
+    return true;
+}
+
+bool RobotMessenger::subscribe(uint8_t topicId, uint16_t size, TopicHandler *handler)
+{
+    if (topicId >= MAX_TOPIC_ID || size == 0 || size > MAX_TOPIC_SIZE || handler == nullptr)
+    {
+        RAISE_ERROR(drivers, "invalid robot messenger subscription");
+        return false;
+    }
+    if (numRxTopics >= MAX_TOPICS || findRxTopic(topicId) != nullptr)
+    {
+        RAISE_ERROR(drivers, "robot messenger topic already subscribed or too many topics");
+        return false;
+    }
+
+    RxTopic &topic = rxTopics[numRxTopics++];
+    topic = RxTopic();
+    topic.id = topicId;
+    topic.size = size;
+    topic.handler = handler;
+    return true;
+}
+
+void RobotMessenger::resendAll()
+{
+    for (int i = 0; i < numTxTopics; i++)
+    {
+        TxTopic &topic = txTopics[i];
+        if (topic.hasLastSent && !topic.pending)
+        {
+            // Keeps the publish time, so a value that has gone stale isn't resent
+            topic.pending = true;
+            topic.nextFragment = 0;
+        }
+        topic.hasLastSent = false;
+    }
+}
+
+int RobotMessenger::getNumPendingTopics() const
+{
+    return std::count_if(
+        txTopics,
+        txTopics + numTxTopics,
+        [](const TxTopic &topic) { return topic.pending; });
+}
+
+uint16_t RobotMessenger::packNextMessage(
+    uint8_t *payload,
+    RobotId &receiver,
+    Tx::TransmissionPriority &priority)
+{
+    const uint32_t now = tap::arch::clock::getTimeMilliseconds();
+    dropStaleValues(now);
+
+    bool tried[MAX_TOPICS] = {};
+    uint16_t length = 0;
+    while (length + sizeof(ChunkHeader) < MAX_PAYLOAD_SIZE)
+    {
+        int best = -1;
+        for (int i = 0; i < numTxTopics; i++)
+        {
+            const TxTopic &topic = txTopics[i];
+            // Every chunk of a message goes to the receiver of the most urgent one
+            if (!topic.pending || tried[i] || (length != 0 && topic.config.receiver != receiver))
+            {
+                continue;
+            }
+            if (best < 0 || sendsBefore(topic, txTopics[best]))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+
+        tried[best] = true;
+        TxTopic &topic = txTopics[best];
+        const uint16_t chunkLength =
+            packChunk(topic, payload + length, MAX_PAYLOAD_SIZE - length, now);
+        if (length == 0)
+        {
+            receiver = topic.config.receiver;
+            priority = topic.config.priority;
+        }
+        length += chunkLength;
+    }
+    return length;
+}
+
+modm::ResumableResult<bool> RobotMessenger::update()
+{
+    RF_BEGIN(0);
+
+    updateBandwidth(tap::arch::clock::getTimeMilliseconds());
+
+    if (drivers->refSerial.getRobotData().robotId == RobotId::INVALID)
+    {
+        RF_RETURN(false);
+    }
+
+    messageLength = packNextMessage(message.dataAndCRC16, messageReceiver, messagePriority);
+    if (messageLength == 0)
+    {
+        RF_RETURN(false);
+    }
+
+    RF_CALL(refSerialTransmitter.sendRobotToRobotMsg(
+        &message,
+        messageId,
+        messageReceiver,
+        messageLength,
+        messagePriority));
+    bytesSent += messageLength + MESSAGE_OVERHEAD;
+
+    RF_END_RETURN(true);
+}
+
+void RobotMessenger::operator()(const DJISerial::ReceivedSerialMessage &message)
+{
+    const uint16_t length = message.header.dataLength;
+    if (length < sizeof(Tx::InteractiveHeader))
+    {
+        numRxDrops++;
+        return;
+    }
+    Tx::InteractiveHeader interactiveHeader;
+    memcpy(&interactiveHeader, message.data, sizeof(interactiveHeader));
+    const RobotId sender = static_cast<RobotId>(interactiveHeader.senderId);
+
+    uint16_t offset = sizeof(Tx::InteractiveHeader);
+    while (offset + sizeof(ChunkHeader) <= length)
+    {
+        ChunkHeader header;
+        memcpy(&header, message.data + offset, sizeof(header));
+        offset += sizeof(header);
+        if (offset + header.length > length)
+        {
+            numRxDrops++;
+            return;
+        }
+        if (!receiveChunk(header, message.data + offset, sender))
+        {
+            numRxDrops++;
+        }
+        offset += header.length;
+    }
+}
+
+RobotMessenger::TxTopic *RobotMessenger::findTxTopic(uint8_t topicId)
+{
+    for (int i = 0; i < numTxTopics; i++)
+    {
+        if (txTopics[i].id == topicId)
+        {
+            return &txTopics[i];
+        }
+    }
+    return nullptr;
+}
+
+RobotMessenger::RxTopic *RobotMessenger::findRxTopic(uint8_t topicId)
+{
+    for (int i = 0; i < numRxTopics; i++)
+    {
+        if (rxTopics[i].id == topicId)
+        {
+            return &rxTopics[i];
+        }
+    }
+    return nullptr;
+}
+
+bool RobotMessenger::sendsBefore(const TxTopic &a, const TxTopic &b)
+{
+    // A lower TransmissionPriority value is more urgent
+    if (a.config.priority != b.config.priority)
+    {
+        return a.config.priority < b.config.priority;
+    }
+    return static_cast<int32_t>(a.lastSentTime - b.lastSentTime) < 0;
+}
+
+void RobotMessenger::dropStaleValues(uint32_t now)
+{
+    for (int i = 0; i < numTxTopics; i++)
+    {
+        TxTopic &topic = txTopics[i];
+        if (topic.pending && topic.config.maxAgeMs != 0 &&
+            now - topic.publishTime > topic.config.maxAgeMs)
+        {
+            topic.pending = false;
+            topic.nextFragment = 0;
+            numStaleDrops++;
+        }
+    }
+}
+
+uint16_t RobotMessenger::packChunk(TxTopic &topic, uint8_t *payload, uint16_t space, uint32_t now)
+{
+    const uint8_t fragments = numFragments(topic.size);
+    ChunkHeader header{topic.id, topic.sequence, 0, 0};
+
+    if (fragments == 1 && topic.config.keyframeInterval != 0 && topic.hasLastSent &&
+        topic.sendsSinceKeyframe + 1 < topic.config.keyframeInterval)
+    {
+        uint8_t delta[1 + MAX_TOPIC_SIZE / 8 + MAX_TOPIC_SIZE];
+        const uint16_t deltaLength = encodeDelta(topic, delta);
+        if (deltaLength < topic.size && sizeof(header) + deltaLength <= space)
+        {
+            header.topic |= DELTA_FLAG;
+            header.length = deltaLength;
+            memcpy(payload, &header, sizeof(header));
+            memcpy(payload + sizeof(header), delta, deltaLength);
+            topic.sendsSinceKeyframe++;
+            numDeltasSent++;
+            finishSend(topic, now);
+            return sizeof(header) + deltaLength;
+        }
+    }
+
+    const uint16_t offset = topic.nextFragment * FRAGMENT_DATA_SIZE;
+    const uint16_t length = std::min<uint16_t>(FRAGMENT_DATA_SIZE, topic.size - offset);
+    if (sizeof(header) + length > space)
+    {
+        return 0;
+    }
+
+    header.fragment = (topic.nextFragment << 4) | (fragments - 1);
+    header.length = length;
+    memcpy(payload, &header, sizeof(header));
+    memcpy(payload + sizeof(header), topic.value + offset, length);
+
+    topic.nextFragment++;
+    if (topic.nextFragment == fragments)
+    {
+        topic.sendsSinceKeyframe = 0;
+        finishSend(topic, now);
+    }
+    else
+    {
+        topic.lastSentTime = now;
+    }
+    return sizeof(header) + length;
+}
+
+uint16_t RobotMessenger::encodeDelta(const TxTopic &topic, uint8_t *delta)
+{
+    const uint16_t maskBytes = (topic.size + 7) / 8;
+    delta[0] = topic.lastSentSequence;
+    memset(delta + 1, 0, maskBytes);
+    uint16_t length = 1 + maskBytes;
+    for (uint16_t i = 0; i < topic.size; i++)
+    {
+        if (topic.value[i] != topic.lastSent[i])
+        {
+            delta[1 + i / 8] |= 1 << (i % 8);
+            delta[length++] = topic.value[i];
+        }
+    }
+    return length;
+}
+
+void RobotMessenger::finishSend(TxTopic &topic, uint32_t now)
+{
+    topic.pending = false;
+    topic.nextFragment = 0;
+    memcpy(topic.lastSent, topic.value, topic.size);
+    topic.lastSentSequence = topic.sequence;
+    topic.hasLastSent = true;
+    topic.lastSentTime = now;
+}
+
+bool RobotMessenger::receiveChunk(const ChunkHeader &header, const uint8_t *data, RobotId sender)
+{
+    RxTopic *topic = findRxTopic(header.topic & TOPIC_ID_MASK);
+    if (topic == nullptr)
+    {
+        return false;
+    }
+
+    if (header.topic & DELTA_FLAG)
+    {
+        const uint16_t maskBytes = (topic->size + 7) / 8;
+        if (header.length < 1 + maskBytes || !topic->hasValue || topic->valueSender != sender ||
+            data[0] != topic->valueSequence)
+        {
+            return false;
+        }
+        const uint8_t *mask = data + 1;
+        int numChanged = 0;
+        for (uint16_t i = 0; i < maskBytes; i++)
+        {
+            numChanged += __builtin_popcount(mask[i]);
+        }
+        if (numChanged != header.length - 1 - maskBytes)
+        {
+            return false;
+        }
+
+        const uint8_t *changed = mask + maskBytes;
+        for (uint16_t i = 0; i < topic->size; i++)
+        {
+            if (mask[i / 8] & (1 << (i % 8)))
+            {
+                topic->value[i] = *changed++;
+            }
+        }
+    }
+    else
+    {
+        const uint8_t fragments = numFragments(topic->size);
+        const uint8_t index = header.fragment >> 4;
+        const uint16_t offset = index * FRAGMENT_DATA_SIZE;
+        if ((header.fragment & 0x0f) + 1 != fragments || index >= fragments ||
+            header.length != std::min<uint16_t>(FRAGMENT_DATA_SIZE, topic->size - offset))
+        {
+            return false;
+        }
+
+        if (fragments == 1)
+        {
+            memcpy(topic->value, data, header.length);
+        }
+        else
+        {
+            // Fragments of a newer value replace the one being assembled
+            if (topic->receivedFragments == 0 || topic->assemblySequence != header.sequence ||
+                topic->assemblySender != sender)
+            {
+                topic->receivedFragments = 0;
+                topic->assemblySequence = header.sequence;
+                topic->assemblySender = sender;
+            }
+            memcpy(topic->assembly + offset, data, header.length);
+            topic->receivedFragments |= 1 << index;
+            if (topic->receivedFragments != (1 << fragments) - 1)
+            {
+                return true;
+            }
+            memcpy(topic->value, topic->assembly, topic->size);
+            topic->receivedFragments = 0;
+        }
+    }
+
+    topic->hasValue = true;
+    topic->valueSequence = header.sequence;
+    topic->valueSender = sender;
+    (*topic->handler)(topic->value, topic->size, sender);
+    return true;
+}
+
+void RobotMessenger::updateBandwidth(uint32_t now)
+{
+    if (bandwidthWindowStarted && now - bandwidthWindowStart < BANDWIDTH_WINDOW_MS)
+    {
+        return;
+    }
+
+    uint32_t refBytesSent = 0;
+    for (int i = 0; i < Tx::NUM_TRANSMISSION_PRIORITIES; i++)
+    {
+        refBytesSent += drivers->refSerial
+                            .getTransmissionQueueStats(static_cast<Tx::TransmissionPriority>(i))
+                            .bytesSent;
+    }
+
+    if (bandwidthWindowStarted)
+    {
+        const uint32_t elapsed = now - bandwidthWindowStart;
+        const uint32_t used = (refBytesSent - windowRefBytesSent) * 1'000 / elapsed;
+        headroomBytesPerSecond = used >= Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S
+                                     ? 0
+                                     : Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S - used;
+        bytesPerSecond = (bytesSent - windowBytesSent) * 1'000 / elapsed;
+    }
+
+    bandwidthWindowStarted = true;
+    bandwidthWindowStart = now;
+    windowRefBytesSent = refBytesSent;
+    windowBytesSent = bytesSent;
+}
+}  // namespace tap::communication::referee
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_ROBOT_MESSENGER_HPP_
+#define TAPROOT_ROBOT_MESSENGER_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "tap/communication/serial/ref_serial_data.hpp"
+#include "tap/communication/serial/ref_serial_transmitter.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/processing/resumable.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::communication::referee
+{
+/// Configuration of a topic published by a `RobotMessenger`, see `RobotMessenger::addTopic`.
+struct RobotMessengerTopicConfig
+{
+    /// The robot the topic is sent to.
+    serial::RefSerialData::RobotId receiver = serial::RefSerialData::RobotId::INVALID;
+    /// Topics of a higher priority are sent first, and messages are sent at this priority.
+    serial::RefSerialData::Tx::TransmissionPriority priority =
+        serial::RefSerialData::Tx::TransmissionPriority::NORMAL;
+    /// A published value not sent within this many ms is dropped, or 0 to never drop it.
+    uint32_t maxAgeMs = 0;
+    /**
+     * If nonzero, values are sent as the bytes that changed since the previously sent value,
+     * with the whole value sent every `keyframeInterval` sends so that a receiver that missed a
+     * message recovers. Best for values that change a few bytes at a time, like positions or a
+     * target list. 0 always sends whole values.
+     */
+    uint8_t keyframeInterval = 0;
+};
+
+/**
+ * A messaging layer over the referee system's robot to robot messages. Robots publish values on
+ * topics, which other robots subscribe to, instead of each team packing and unpacking raw
+ * `sendRobotToRobotMsg` payloads.
+ *
+ * The referee system only passes `Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S` of interactive data
+ * (shared with UI graphics) in messages of at most 113 bytes, each with a 15 byte overhead, so:
+ *
+ * - Only the latest published value of a topic is kept: publishing again before a value is
+ *   sent replaces it, and a value older than its topic's `maxAgeMs` is dropped rather than sent
+ *   late. When bandwidth is short, lower priority topics wait, and go stale first.
+ * - Each message is packed with as many pending topics for the same receiver as fit, most urgent
+ *   first (higher priority, then longest waiting), sharing one message overhead.
+ * - Values larger than a message are split into fragments of `FRAGMENT_DATA_SIZE` bytes that
+ *   are sent in consecutive messages and reassembled by the receiver. A value is only passed to
+ *   subscribers once all of its fragments have been received.
+ * - Topics with a `keyframeInterval` send only the bytes that changed, see
+ *   `RobotMessengerTopicConfig`.
+ *
+ * Each value is sent as a chunk of a message, a `ChunkHeader` followed by either the value (or a
+ * fragment of it) or, for a delta, the sequence number of the value it is relative to, a bitmask
+ * of the changed bytes and the changed bytes. All messages of a messenger use one interactive
+ * data ID, `messageId`, so the robots on a team must agree on it and on the topic IDs and sizes.
+ *
+ * Usage:
+ *
+ * ```
+ * // Sentry, publishing its target to the hero
+ * RobotMessengerTopicConfig config;
+ * config.receiver = RobotId::RED_HERO;
+ * config.maxAgeMs = 200;
+ * config.keyframeInterval = 5;
+ * messenger.addTopic(TARGET_TOPIC, sizeof(Target), config);
+ * messenger.publish(TARGET_TOPIC, target);
+ *
+ * // In a protothread:
+ * PT_CALL(messenger.update());
+ *
+ * // Hero, subscribing with a `TypedTopicHandler<Target>`
+ * messenger.subscribe(TARGET_TOPIC, sizeof(Target), &targetHandler);
+ * messenger.initialize();
+ * ```
+ *
+ * `getHeadroomBytesPerSecond` reports how much of the referee system's bandwidth is left over
+ * by everything sent to it, and `getBytesPerSecond` how much the messenger uses.
+ */
+class RobotMessenger : public serial::RefSerialData::RobotToRobotMessageHandler,
+                       public modm::Resumable<1>
+{
+public:
+    using RobotId = serial::RefSerialData::RobotId;
+    using Tx = serial::RefSerialData::Tx;
+
+    /// The maximum number of topics that may be published, and subscribed to.
+    static constexpr int MAX_TOPICS = 8;
+    /// Topic IDs are less than this.
+    static constexpr uint8_t MAX_TOPIC_ID = 64;
+    /// The largest value a topic may hold, in bytes.
+    static constexpr uint16_t MAX_TOPIC_SIZE = 128;
+    /// The largest payload of a robot to robot message.
+    static constexpr uint16_t MAX_PAYLOAD_SIZE = 113;
+
+    struct ChunkHeader
+    {
+        /// Bits 0-5 are the topic ID, bit 6 is set for deltas.
+        uint8_t topic;
+        /// Incremented each time a value of the topic is published.
+        uint8_t sequence;
+        /// Bits 4-7 are the index of the fragment, bits 0-3 the number of fragments minus one.
+        uint8_t fragment;
+        /// Number of bytes following the header.
+        uint8_t length;
+    } modm_packed;
+
+    static constexpr uint8_t DELTA_FLAG = 0x40;
+    /// Bytes of a value in each fragment but the last.
+    static constexpr uint16_t FRAGMENT_DATA_SIZE = MAX_PAYLOAD_SIZE - sizeof(ChunkHeader);
+
+    /**
+     * Receives the values of a topic, see `subscribe`. The data is only valid for the duration of
+     * the call.
+     */
+    class TopicHandler
+    {
+    public:
+        virtual ~TopicHandler() = default;
+        virtual void operator()(const uint8_t *data, uint16_t length, RobotId sender) = 0;
+    };
+
+    /**
+     * A `TopicHandler` that decodes the value of a topic into a `T`. Values of the wrong size are
+     * counted and dropped.
+     */
+    template <typename T>
+    class TypedTopicHandler : public TopicHandler
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    public:
+        void operator()(const uint8_t *data, uint16_t length, RobotId sender) final
+        {
+            if (length != sizeof(T))
+            {
+                numWrongSizeValues++;
+                return;
+            }
+            T value;
+            memcpy(&value, data, sizeof(T));
+            onValue(value, sender);
+        }
+
+        uint32_t getNumWrongSizeValues() const { return numWrongSizeValues; }
+
+    protected:
+        virtual void onValue(const T &value, RobotId sender) = 0;
+
+    private:
+        uint32_t numWrongSizeValues = 0;
+    };
+
+    /**
+     * @param[in] messageId The interactive data ID of the messenger's messages, between 0x200
+     *      and 0x2ff.
+     */
+    RobotMessenger(
+        Drivers *drivers,
+        serial::RefSerialTransmitter &refSerialTransmitter,
+        uint16_t messageId = 0x200);
+    DISALLOW_COPY_AND_ASSIGN(RobotMessenger)
+
+    /// Attaches the messenger to `RefSerial` to receive the topics subscribed to.
+    void initialize();
+
+    /**
+     * Adds a topic to publish.
+     *
+     * @param[in] size The size of the topic's values, at most `MAX_TOPIC_SIZE`.
+     * @return `false` (and raises an error) if the topic ID is invalid or already added, the size
+     *      is invalid, or `MAX_TOPICS` topics have been added.
+     */
+    bool addTopic(uint8_t topicId, uint16_t size, const RobotMessengerTopicConfig &config);
+
+    /**
+     * Publishes a value of the topic, replacing the value waiting to be sent if there is one.
+     *
+     * @return `false` if the topic wasn't added or `length` isn't its size.
+     */
+    bool publish(uint8_t topicId, const uint8_t *data, uint16_t length);
+
+    template <typename T>
+    bool publish(uint8_t topicId, const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        return publish(topicId, reinterpret_cast<const uint8_t *>(&value), sizeof(T));
+    }
+
+    /**
+     * Subscribes the handler to a topic. The handler must outlive the messenger.
+     *
+     * @param[in] size The size of the topic's values, at most `MAX_TOPIC_SIZE`.
+     * @return `false` (and raises an error) if the topic ID is invalid or already subscribed to,
+     *      or `MAX_TOPICS` topics have been subscribed to.
+     */
+    bool subscribe(uint8_t topicId, uint16_t size, TopicHandler *handler);
+
+    /**
+     * Forgets which values were sent, so that every topic with a value is sent again whole, for
+     * example when a robot it is sent to was restarted.
+     */
+    void resendAll();
+
+    /// @return The number of topics with a value waiting to be sent.
+    int getNumPendingTopics() const;
+
+    /**
+     * Packs the chunks that should be sent next into a payload, marking them as sent.
+     *
+     * @param[out] payload Storage for `MAX_PAYLOAD_SIZE` bytes.
+     * @param[out] receiver The robot to send the payload to.
+     * @param[out] priority The priority to send the payload at.
+     * @return The length of the payload, 0 if nothing should be sent.
+     */
+    uint16_t packNextMessage(
+        uint8_t *payload,
+        RobotId &receiver,
+        Tx::TransmissionPriority &priority);
+
+    /**
+     * Sends a single message with the most urgent pending values (see `packNextMessage`) as soon
+     * as the referee system's bandwidth limit allows. Does nothing if no value is pending or the
+     * robot's ID is not yet known.
+     *
+     * Should be called repeatedly in a protothread.
+     */
+    modm::ResumableResult<bool> update();
+
+    void operator()(const serial::DJISerial::ReceivedSerialMessage &message) override;
+
+    /**
+     * @return The bytes per second of the referee system's interactive data bandwidth that were
+     *      unused over the last second, by the messenger and anything else (such as UI
+     *      graphics), or 0 if the bandwidth was exceeded.
+     */
+    uint32_t getHeadroomBytesPerSecond() const { return headroomBytesPerSecond; }
+
+    /// @return The bytes sent by the messenger over the last second, including overhead.
+    uint32_t getBytesPerSecond() const { return bytesPerSecond; }
+
+    /// @return The number of published values dropped for being older than their `maxAgeMs`.
+    uint32_t getNumStaleDrops() const { return numStaleDrops; }
+
+    /// @return The number of published values replaced by a newer value before being sent.
+    uint32_t getNumSupersededValues() const { return numSupersededValues; }
+
+    /// @return The number of chunks sent as deltas.
+    uint32_t getNumDeltasSent() const { return numDeltasSent; }
+
+    /**
+     * @return The number of received chunks dropped, because they were malformed, their topic
+     *      wasn't subscribed to, or they were deltas of a value that wasn't received.
+     */
+    uint32_t getNumRxDrops() const { return numRxDrops; }
+
+private:
+    /// Bytes each message sent takes besides the payload: frame header, command ID, interactive
+    /// header and CRC16.
+    static constexpr uint16_t MESSAGE_OVERHEAD = sizeof(serial::DJISerial::FrameHeader) + 2 +
+                                                 sizeof(Tx::InteractiveHeader) + 2;
+    static constexpr uint32_t BANDWIDTH_WINDOW_MS = 1'000;
+
+    struct TxTopic
+    {
+        uint8_t id;
+        uint16_t size;
+        RobotMessengerTopicConfig config;
+        uint8_t value[MAX_TOPIC_SIZE];
+        /// The last value sent, that deltas are relative to.
+        uint8_t lastSent[MAX_TOPIC_SIZE];
+        uint8_t sequence;
+        uint8_t lastSentSequence;
+        bool pending;
+        /// `true` if `lastSent` holds the value sent with sequence `lastSentSequence`.
+        bool hasLastSent;
+        uint8_t sendsSinceKeyframe;
+        /// The next fragment of the pending value to send, nonzero while fragmenting.
+        uint8_t nextFragment;
+        uint32_t publishTime;
+        uint32_t lastSentTime;
+    };
+
+    struct RxTopic
+    {
+        uint8_t id;
+        uint16_t size;
+        TopicHandler *handler;
+        /// The last complete value received, that deltas are applied to.
+        uint8_t value[MAX_TOPIC_SIZE];
+        uint8_t assembly[MAX_TOPIC_SIZE];
+        bool hasValue;
+        uint8_t valueSequence;
+        RobotId valueSender;
+        uint8_t assemblySequence;
+        RobotId assemblySender;
+        /// Bit i is set if fragment i of the value being assembled was received.
+        uint16_t receivedFragments;
+    };
+
+    Drivers *drivers;
+    serial::RefSerialTransmitter &refSerialTransmitter;
+    const uint16_t messageId;
+
+    TxTopic txTopics[MAX_TOPICS];
+    int numTxTopics = 0;
+    RxTopic rxTopics[MAX_TOPICS];
+    int numRxTopics = 0;
+
+    Tx::RobotToRobotMessage message;
+    uint16_t messageLength = 0;
+    RobotId messageReceiver = RobotId::INVALID;
+    Tx::TransmissionPriority messagePriority = Tx::TransmissionPriority::NORMAL;
+
+    bool bandwidthWindowStarted = false;
+    uint32_t bandwidthWindowStart = 0;
+    uint32_t windowRefBytesSent = 0;
+    uint32_t windowBytesSent = 0;
+    uint32_t bytesSent = 0;
+    uint32_t headroomBytesPerSecond = Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S;
+    uint32_t bytesPerSecond = 0;
+
+    uint32_t numStaleDrops = 0;
+    uint32_t numSupersededValues = 0;
+    uint32_t numDeltasSent = 0;
+    uint32_t numRxDrops = 0;
+
+    TxTopic *findTxTopic(uint8_t topicId);
+    RxTopic *findRxTopic(uint8_t topicId);
+
+    /// @return `true` if `a` should be sent before `b`.
+    static bool sendsBefore(const TxTopic &a, const TxTopic &b);
+
+    /// Drops pending values older than their topic's `maxAgeMs`.
+    void dropStaleValues(uint32_t now);
+
+    /**
+     * Appends the next chunk of the topic's pending value to `payload` if it fits in the
+     * `space` bytes left.
+     *
+     * @return The number of bytes appended, 0 if the chunk doesn't fit.
+     */
+    uint16_t packChunk(TxTopic &topic, uint8_t *payload, uint16_t space, uint32_t now);
+
+    /// Encodes the delta of the topic's value from `lastSent`. @return Its length.
+    static uint16_t encodeDelta(const TxTopic &topic, uint8_t *delta);
+
+    /// Handles a chunk of a received payload. @return `false` if it was malformed.
+    bool receiveChunk(const ChunkHeader &header, const uint8_t *data, RobotId sender);
+
+    /// Marks the topic's pending value as sent whole.
+    static void finishSend(TxTopic &topic, uint32_t now);
+
+    /// Updates the bandwidth statistics once per `BANDWIDTH_WINDOW_MS`.
+    void updateBandwidth(uint32_t now);
+};
+}  // namespace tap::communication::referee
+
+#endif  // TAPROOT_ROBOT_MESSENGER_HPP_
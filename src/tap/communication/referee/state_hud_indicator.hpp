@@ -74,6 +74,10 @@ namespace tap::communication::referee
  * // Initialize the declare a drawer
  * ```
  *
+ * Alternatively, the indicator's graphic can be batched with other graphics by adding
+ * `&graphic.graphicData` to a `HudCompositor`, in which case only `setIndicatorState` is called
+ * and `initialize` and `draw` are not.
+ *
  * @tparam T Type of the state associated with the HUD indicator.
  */
 template <typename T>
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "buzzer_sequencer.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#include "buzzer.hpp"
+
+namespace tap::buzzer
+{
+bool BuzzerSequencer::queue(const Note *notes, int numNotes)
+{
+    if (numNotes < 0 || numNotes > MAX_NOTES - numQueued)
+    {
+        return false;
+    }
+    for (int i = 0; i < numNotes; i++)
+    {
+        this->notes[(head + numQueued) % MAX_NOTES] = notes[i];
+        numQueued++;
+    }
+    return true;
+}
+
+void BuzzerSequencer::stop()
+{
+    head = 0;
+    numQueued = 0;
+    playing = false;
+    silenceBuzzer(pwmController);
+}
+
+void BuzzerSequencer::update() { update(tap::arch::clock::getTimeMilliseconds()); }
+
+void BuzzerSequencer::update(uint32_t now)
+{
+    if (playing && static_cast<int32_t>(now - noteEndTime) < 0)
+    {
+        return;
+    }
+
+    if (numQueued == 0)
+    {
+        if (playing)
+        {
+            playing = false;
+            silenceBuzzer(pwmController);
+        }
+        return;
+    }
+
+    // Start the next note when the previous one ended so the rhythm doesn't drift with late
+    // updates, unless the update is so late that the note would already be over
+    const Note &note = notes[head];
+    uint32_t startTime = playing ? noteEndTime : now;
+    if (static_cast<int32_t>(now - (startTime + note.duration)) >= 0)
+    {
+        startTime = now;
+    }
+    noteEndTime = startTime + note.duration;
+    playing = true;
+    playNote(pwmController, note.frequency);
+
+    head = (head + 1) % MAX_NOTES;
+    numQueued--;
+}
+}  // namespace tap::buzzer
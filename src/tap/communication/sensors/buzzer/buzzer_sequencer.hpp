@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BUZZER_SEQUENCER_HPP_
+#define TAPROOT_BUZZER_SEQUENCER_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+namespace tap
+{
+namespace gpio
+{
+class Pwm;
+}
+
+namespace buzzer
+{
+/**
+ * Plays a queue of notes on the buzzer without blocking, so that melodies and alert patterns
+ * don't need delays or state machines of their own. Queue notes with `queue`, then call `update`
+ * regularly, for example every main loop iteration or from a timer interrupt:
+ *
+ * ```cpp
+ * static constexpr BuzzerSequencer::Note ALERT[] = {{2000, 100}, {0, 100}, {2000, 100}};
+ * sequencer.queue(ALERT);
+ * ...
+ * sequencer.update();
+ * ```
+ *
+ * `update` only compares the time with the end of the current note, and only changes the PWM
+ * output when the next note starts.
+ */
+class BuzzerSequencer
+{
+public:
+    static constexpr int MAX_NOTES = 32;
+
+    struct Note
+    {
+        /// The pitch of the note, in Hz. A frequency of 0 is a rest.
+        uint16_t frequency;
+        /// How long the note plays for, in milliseconds.
+        uint16_t duration;
+    };
+
+    /// @param[in] pwmController The PWM object that has access to the buzzer.
+    explicit BuzzerSequencer(gpio::Pwm *pwmController) : pwmController(pwmController) {}
+    DISALLOW_COPY_AND_ASSIGN(BuzzerSequencer)
+
+    /**
+     * Queues notes to play after the notes already queued.
+     *
+     * @return `false` if the notes don't all fit in the queue, in which case none are queued.
+     */
+    bool queue(const Note *notes, int numNotes);
+
+    template <int N>
+    bool queue(const Note (&notes)[N])
+    {
+        return queue(notes, N);
+    }
+
+    /// Queues a single note, see `queue`.
+    bool queueNote(uint16_t frequency, uint16_t duration)
+    {
+        const Note note{frequency, duration};
+        return queue(&note, 1);
+    }
+
+    /// Clears the queue and silences the buzzer.
+    void stop();
+
+    /// @return `true` if a note is playing or queued.
+    bool isPlaying() const { return playing || numQueued > 0; }
+
+    /// @return The number of notes queued, not counting the note playing.
+    int getNumQueued() const { return numQueued; }
+
+    /// Starts the next note once the current one ends, see `tap::arch::clock::getTimeMilliseconds`.
+    void update();
+
+    /// Starts the next note once the current one ends at time `now`, in milliseconds.
+    void update(uint32_t now);
+
+private:
+    gpio::Pwm *pwmController;
+
+    Note notes[MAX_NOTES] = {};
+    int head = 0;
+    int numQueued = 0;
+
+    bool playing = false;
+    /// The time the playing note ends at.
+    uint32_t noteEndTime = 0;
+};  // class BuzzerSequencer
+}  // namespace buzzer
+}  // namespace tap
+
+#endif  // TAPROOT_BUZZER_SEQUENCER_HPP_
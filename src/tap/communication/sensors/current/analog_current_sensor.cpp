@@ -19,24 +19,21 @@
 
 #include "analog_current_sensor.hpp"
 
-#include "tap/algorithms/math_user_utils.hpp"
-
-using namespace tap::algorithms;
-
 namespace tap::communication::sensors::current
 {
-AnalogCurrentSensor::AnalogCurrentSensor(const Config &config) : config(config) {}
-
-float AnalogCurrentSensor::getCurrentMa() const { return prevCurrent; }
+AnalogCurrentSensor::AnalogCurrentSensor(const Config &config)
+    : config(config),
+      pipeline(
+          LinearCalibration(1.0f, -config.currentSensorZeroMv),
+          AbsoluteValue(),
+          LinearCalibration(config.currentSensorMaPerMv, 0.0f),
+          ExponentialFilter(config.currentSensorLowPassAlpha))
+{
+}
 
 void AnalogCurrentSensor::update()
 {
-    prevCurrent = lowPassFilter(
-        prevCurrent,
-        abs(static_cast<float>(config.analogDriver->read(config.analogSensorPin)) -
-            config.currentSensorZeroMv) *
-            config.currentSensorMaPerMv,
-        config.currentSensorLowPassAlpha);
+    pipeline.update(config.analogDriver->read(config.analogSensorPin));
 }
 
 }  // namespace tap::communication::sensors::current
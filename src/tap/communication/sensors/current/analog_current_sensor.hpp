@@ -21,6 +21,8 @@
 #define TAPROOT_ANALOG_CURRENT_SENSOR_HPP_
 
 #include "tap/communication/gpio/analog.hpp"
+#include "tap/communication/sensors/sensor_pipeline.hpp"
+#include "tap/util_macros.hpp"
 
 #include "current_sensor_interface.hpp"
 
@@ -31,7 +33,7 @@ namespace tap::communication::sensors::current
  * applying a moving average to data read each time `getCurrentMa` is called. As such, for optimal
  * performance, call `getCurrentMa()` periodically at some consistent rate.
  */
-class AnalogCurrentSensor : public CurrentSensorInterface
+class AnalogCurrentSensor final_mockable : public CurrentSensorInterface
 {
 public:
     /**
@@ -62,14 +64,18 @@ class AnalogCurrentSensor : public CurrentSensorInterface
 
     AnalogCurrentSensor(const Config &config);
 
-    float getCurrentMa() const override;
+    float getCurrentMa() const override { return pipeline.getValue(); }
 
     void update() override;
 
 private:
+    /// Removes the zero offset, rectifies, converts to mA, then low pass filters.
+    using Pipeline =
+        SensorPipeline<LinearCalibration, AbsoluteValue, LinearCalibration, ExponentialFilter>;
+
     const Config config;
 
-    float prevCurrent = 0.0f;
+    Pipeline pipeline;
 };
 
 }  // namespace tap::communication::sensors::current
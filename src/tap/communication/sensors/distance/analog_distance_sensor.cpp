@@ -35,23 +35,17 @@ AnalogDistanceSensor::AnalogDistanceSensor(
     gpio::Analog::Pin pin)
     : DistanceSensor(minDistance, maxDistance),
       drivers(drivers),
-      m(m),
-      b(b),
-      offset(offset),
+      pipeline(
+          communication::sensors::LinearCalibration(m / 1000.0f, b),
+          communication::sensors::Reciprocal(offset)),
       pin(pin)
 {
 }
 
 float AnalogDistanceSensor::read()
 {
-    // Read analog pin and convert to volts
-    float reading = drivers->analog.read(pin);
-
-    // Linear model
-    float linear = m * reading / 1000.0f + b;
-
-    // Convert to cm distance
-    distance = 1.0f / linear + offset;
+    // Read analog pin in mV and convert to cm distance
+    distance = pipeline.update(drivers->analog.read(pin));
 
     return validReading() ? distance : -1.0f;
 }
@@ -21,6 +21,7 @@
 #define TAPROOT_ANALOG_DISTANCE_SENSOR_HPP_
 
 #include "tap/communication/gpio/analog.hpp"
+#include "tap/communication/sensors/sensor_pipeline.hpp"
 
 #include "distance_sensor.hpp"
 
@@ -85,12 +86,14 @@ class AnalogDistanceSensor : public DistanceSensor
     bool validReading() const override;
 
 private:
-    Drivers *drivers;
+    /// Applies the linear model to the reading in volts, then the inverse model.
+    using Pipeline = communication::sensors::SensorPipeline<
+        communication::sensors::LinearCalibration,
+        communication::sensors::Reciprocal>;
 
-    float m;  ///< Slope of linear model that converts raw analog values to distance values.
-    float b;  ///< Y-intercept of linear model taht converts raw analog values to distance values.
+    Drivers *drivers;
 
-    float offset;  ///< Offset value of inverse of the model.
+    Pipeline pipeline;
 
     gpio::Analog::Pin pin;  ///< The analog pin which the sensor is connected to.
 };
@@ -19,8 +19,12 @@
 
 #include "bmi088.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tap/architecture/endianness_wrappers.hpp"
 #include "tap/board/board.hpp"
+#include "tap/communication/capture/capture_recorder.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
@@ -28,8 +32,13 @@
 #include "modm/math/units.hpp"
 
 #include "bmi088_data.hpp"
+#include "bmi088_data_ready_dma.hpp"
 #include "bmi088_hal.hpp"
 
+#ifdef PLATFORM_HOSTED
+#include "tap/communication/capture/capture_replayer.hpp"
+#endif
+
 using namespace modm::literals;
 using namespace tap::arch;
 using namespace Board;
@@ -85,12 +94,64 @@ void Bmi088::initialize(float sampleFrequency, float mahonyKp, float mahonyKi)
 
     imuState = ImuState::IMU_NOT_CALIBRATED;
 
+    if (adaptiveRate)
+    {
+        moving = true;
+        stillTimeout.stop();
+        accOversampling = movingProfile.accOversampling;
+        accOutputRate = movingProfile.accOutputRate;
+        gyroOutputRate = movingProfile.gyroOutputRate;
+        mahonyKp = movingProfile.mahonyKp;
+        mahonyKi = movingProfile.mahonyKi;
+    }
+
     initializeAcc();
     initializeGyro();
 
+    if (readMode == ReadMode::DATA_READY_DMA && imuState != ImuState::IMU_NOT_CONNECTED)
+    {
+        initializeDataReadyInterrupts();
+        Bmi088DataReadyDma::initialize();
+    }
+
+    if (readMode == ReadMode::FIFO)
+    {
+        if (imuState != ImuState::IMU_NOT_CONNECTED)
+        {
+            initializeFifos();
+        }
+        sampleFrequency =
+            getGyroOutputRateHz(gyroOutputRate) / gyroDecimator.getDecimationFactor();
+    }
+
     imuHeater.initialize();
 
+    // FIFO reads return a varying number of samples, so gaps between them don't mean much.
+    diagnostics.setExpectedSampleFrequency(readMode == ReadMode::FIFO ? 0 : sampleFrequency);
+
+    this->sampleFrequency = sampleFrequency;
     mahonyAlgorithm.begin(sampleFrequency, mahonyKp, mahonyKi);
+    attitudeEstimator->setSampleFrequency(sampleFrequency);
+
+    if (imuState == ImuState::IMU_NOT_CALIBRATED && gyroBiasEstimator.hasCalibration())
+    {
+        imuState = ImuState::IMU_CALIBRATED;
+    }
+}
+
+bool Bmi088::setGyroCalibration(const tap::algorithms::GyroCalibration &calibration)
+{
+    if (!calibration.isValid())
+    {
+        return false;
+    }
+
+    gyroBiasEstimator.setCalibration(calibration);
+    if (imuState == ImuState::IMU_NOT_CALIBRATED)
+    {
+        imuState = ImuState::IMU_CALIBRATED;
+    }
+    return true;
 }
 
 void Bmi088::initializeAcc()
@@ -166,6 +227,181 @@ void Bmi088::initializeGyro()
     setAndCheckGyroRegister(Gyro::GYRO_LPM1, Gyro::GyroLpm1::PWRMODE_NORMAL);
 }
 
+void Bmi088::initializeDataReadyInterrupts()
+{
+    setAndCheckAccRegister(
+        Acc::INT1_IO_CTRL,
+        Acc::Int1IoConf::INT1_OUT | Acc::Int1Od_t(Acc::Int1Od::PUSH_PULL) |
+            Acc::Int1Lvl_t(Acc::Int1Lvl::ACTIVE_HIGH));
+    setAndCheckAccRegister(Acc::INT_MAP_DATA, Acc::IntMapData::INT1_DRDY);
+
+    setAndCheckGyroRegister(
+        Gyro::INT3_INT4_IO_CONF,
+        Gyro::Int3Od_t(Gyro::Int3Od::PUSH_PULL) | Gyro::Int3Lvl_t(Gyro::Int3Lvl::ACTIVE_HIGH));
+    setAndCheckGyroRegister(Gyro::INT3_INT4_IO_MAP, Gyro::Int3Int4IoMap::DATA_READY_INT3);
+    setAndCheckGyroRegister(
+        Gyro::GYRO_INT_CTRL,
+        Gyro::EnableNewDataInt_t(Gyro::EnableNewDataInt::ENABLED));
+}
+
+bool Bmi088::configureFifoFilters(
+    uint8_t gyroDecimationFactor,
+    uint8_t accDecimationFactor,
+    uint8_t cicOrder)
+{
+    tap::algorithms::FirDecimator<3, MAX_FIFO_FILTER_TAPS> newGyroDecimator;
+    tap::algorithms::FirDecimator<3, MAX_FIFO_FILTER_TAPS> newAccDecimator;
+    if (!newGyroDecimator.configureCic(gyroDecimationFactor, cicOrder) ||
+        !newAccDecimator.configureCic(accDecimationFactor, cicOrder))
+    {
+        return false;
+    }
+    gyroDecimator.configureCic(gyroDecimationFactor, cicOrder);
+    accDecimator.configureCic(accDecimationFactor, cicOrder);
+    return true;
+}
+
+void Bmi088::initializeFifos()
+{
+    // Writing FIFO_CONFIG_0 clears the gyroscope's FIFO
+    setAndCheckGyroRegister(Gyro::FIFO_CONFIG_0, Gyro::FifoConfig0_t(0));
+    setAndCheckGyroRegister(Gyro::FIFO_CONFIG_1, Gyro::FifoConfig1::STREAM);
+
+    setAndCheckAccRegister(Acc::FIFO_CONFIG_0, Acc::FifoConfig0::STREAM_MODE);
+    setAndCheckAccRegister(Acc::FIFO_CONFIG_1, Acc::FifoConfig1::ACC_EN);
+}
+
+void Bmi088::setAdaptiveRate(
+    const RateProfile &still,
+    const RateProfile &moving,
+    float movingThresholdDps,
+    float stillThresholdDps,
+    uint32_t stillTimeMs)
+{
+    stillProfile = still;
+    movingProfile = moving;
+    this->movingThresholdDps = movingThresholdDps;
+    this->stillThresholdDps = std::min(stillThresholdDps, movingThresholdDps);
+    this->stillTimeMs = stillTimeMs;
+    adaptiveRate = true;
+
+    this->moving = true;
+    stillTimeout.stop();
+    if (imuState != ImuState::IMU_NOT_CONNECTED)
+    {
+        applyRateProfile(movingProfile);
+    }
+}
+
+void Bmi088::disableAdaptiveRate()
+{
+    if (adaptiveRate && !moving && imuState != ImuState::IMU_NOT_CONNECTED)
+    {
+        applyRateProfile(movingProfile);
+    }
+    adaptiveRate = false;
+    moving = true;
+}
+
+void Bmi088::updateMotionProfile()
+{
+    if (!adaptiveRate || imuState == ImuState::IMU_CALIBRATING)
+    {
+        return;
+    }
+
+    const float speedSquared = data.gyroDegPerSec[ImuData::X] * data.gyroDegPerSec[ImuData::X] +
+                               data.gyroDegPerSec[ImuData::Y] * data.gyroDegPerSec[ImuData::Y] +
+                               data.gyroDegPerSec[ImuData::Z] * data.gyroDegPerSec[ImuData::Z];
+
+    if (speedSquared > movingThresholdDps * movingThresholdDps)
+    {
+        stillTimeout.stop();
+        if (!moving)
+        {
+            moving = true;
+            applyRateProfile(movingProfile);
+        }
+    }
+    else if (moving)
+    {
+        if (speedSquared > stillThresholdDps * stillThresholdDps)
+        {
+            stillTimeout.stop();
+        }
+        else if (stillTimeout.isStopped())
+        {
+            stillTimeout.restart(stillTimeMs);
+        }
+        else if (stillTimeout.isExpired())
+        {
+            stillTimeout.stop();
+            moving = false;
+            applyRateProfile(stillProfile);
+        }
+    }
+}
+
+void Bmi088::applyRateProfile(const RateProfile &profile)
+{
+    if (readMode == ReadMode::DATA_READY_DMA && !Bmi088DataReadyDma::pauseTransfers())
+    {
+        RAISE_ERROR(drivers, "bmi088 dma transfer stalled, rate profile not applied");
+        return;
+    }
+
+    accOversampling = profile.accOversampling;
+    accOutputRate = profile.accOutputRate;
+    gyroOutputRate = profile.gyroOutputRate;
+
+    // Unlike initialize, the sensors are already running, so only the rate registers are
+    // written, without the delays and read back checks needed while they start up
+    Bmi088Hal::bmi088AccWriteSingleReg(
+        Acc::ACC_CONF,
+        Acc::AccBandwidth_t(accOversampling) | Acc::AccOutputRate_t(accOutputRate));
+    Bmi088Hal::bmi088GyroWriteSingleReg(
+        Gyro::GYRO_BANDWIDTH,
+        gyroOutputRate | Gyro::GyroBandwidth_t(0x80));
+    if (readMode == ReadMode::DATA_READY_DMA)
+    {
+        Bmi088DataReadyDma::resumeTransfers();
+    }
+
+    if (readMode == ReadMode::FIFO)
+    {
+        // The CIC taps only depend on the decimation factor and order, so they suit any output
+        // rate, but the decimators' history holds samples taken at the old rate
+        gyroDecimator.reset();
+        accDecimator.reset();
+        sampleFrequency =
+            getGyroOutputRateHz(gyroOutputRate) / gyroDecimator.getDecimationFactor();
+        attitudeEstimator->setSampleFrequency(sampleFrequency);
+    }
+    // begin only sets the gains and sample frequency, it doesn't reset the attitude
+    mahonyAlgorithm.begin(sampleFrequency, profile.mahonyKp, profile.mahonyKi);
+}
+
+float Bmi088::getGyroOutputRateHz(Gyro::GyroBandwidth outputRate)
+{
+    switch (outputRate)
+    {
+        case Gyro::GyroBandwidth::ODR2000_BANDWIDTH532:
+        case Gyro::GyroBandwidth::ODR2000_BANDWIDTH230:
+            return 2000.0f;
+        case Gyro::GyroBandwidth::ODR1000_BANDWIDTH116:
+            return 1000.0f;
+        case Gyro::GyroBandwidth::ODR400_BANDWIDTH47:
+            return 400.0f;
+        case Gyro::GyroBandwidth::ODR200_BANDWIDTH23:
+        case Gyro::GyroBandwidth::ODR200_BANDWIDTH64:
+            return 200.0f;
+        case Gyro::GyroBandwidth::ODR100_BANDWIDTH12:
+        case Gyro::GyroBandwidth::ODR100_BANDWIDTH32:
+        default:
+            return 100.0f;
+    }
+}
+
 void Bmi088::periodicIMUUpdate()
 {
     if (imuState == ImuState::IMU_NOT_CONNECTED)
@@ -174,26 +410,64 @@ void Bmi088::periodicIMUUpdate()
         return;
     }
 
+    if (readMode != ReadMode::FIFO)
+    {
+        updateAttitude();
+    }
+
+    updateMotionProfile();
+
+    imuHeater.runTemperatureController(data.temperature);
+}
+
+void Bmi088::updateAttitude()
+{
     if (imuState == ImuState::IMU_CALIBRATING)
     {
         computeOffsets();
     }
     else
     {
-        mahonyAlgorithm.updateIMU(
+        if (onlineGyroCalibration)
+        {
+            const float gyroDegPerSec[3] = {
+                data.gyroRaw[ImuData::X] * GYRO_DS_PER_GYRO_COUNT,
+                data.gyroRaw[ImuData::Y] * GYRO_DS_PER_GYRO_COUNT,
+                data.gyroRaw[ImuData::Z] * GYRO_DS_PER_GYRO_COUNT,
+            };
+            if (gyroBiasEstimator.update(gyroDegPerSec, data.accG, data.temperature) &&
+                imuState == ImuState::IMU_NOT_CALIBRATED)
+            {
+                imuState = ImuState::IMU_CALIBRATED;
+            }
+        }
+
+        if (gyroBiasEstimator.hasCalibration())
+        {
+            applyGyroBias();
+        }
+
+        attitudeEstimator->updateIMU(
             data.gyroDegPerSec[ImuData::X],
             data.gyroDegPerSec[ImuData::Y],
             data.gyroDegPerSec[ImuData::Z],
             data.accG[ImuData::X],
             data.accG[ImuData::Y],
             data.accG[ImuData::Z]);
-    }
 
-    imuHeater.runTemperatureController(data.temperature);
+        float q[4];
+        attitudeEstimator->getQuaternion(q);
+        attitudeHistory.push(prevIMUDataReceivedTime, q, data.gyroDegPerSec);
+    }
 }
 
 void Bmi088::computeOffsets()
 {
+    if (calibrationWaitsForTemperature && !imuHeater.isTemperatureStable())
+    {
+        return;
+    }
+
     calibrationSample++;
 
     data.gyroOffsetRaw[ImuData::X] += data.gyroRaw[ImuData::X];
@@ -214,29 +488,239 @@ void Bmi088::computeOffsets()
         data.accOffsetRaw[ImuData::Y] /= BMI088_OFFSET_SAMPLES;
         data.accOffsetRaw[ImuData::Z] /= BMI088_OFFSET_SAMPLES;
         imuState = ImuState::IMU_CALIBRATED;
-        mahonyAlgorithm.reset();
+        attitudeEstimator->reset();
+        attitudeHistory.clear();
+
+        const float bias[3] = {
+            data.gyroOffsetRaw[ImuData::X] * GYRO_DS_PER_GYRO_COUNT,
+            data.gyroOffsetRaw[ImuData::Y] * GYRO_DS_PER_GYRO_COUNT,
+            data.gyroOffsetRaw[ImuData::Z] * GYRO_DS_PER_GYRO_COUNT,
+        };
+        gyroBiasEstimator.setBias(bias, data.temperature);
     }
 }
 
+void Bmi088::applyGyroBias()
+{
+    float bias[3];
+    gyroBiasEstimator.getBias(data.temperature, bias);
+    data.gyroOffsetRaw[ImuData::X] = bias[ImuData::X] / GYRO_DS_PER_GYRO_COUNT;
+    data.gyroOffsetRaw[ImuData::Y] = bias[ImuData::Y] / GYRO_DS_PER_GYRO_COUNT;
+    data.gyroOffsetRaw[ImuData::Z] = bias[ImuData::Z] / GYRO_DS_PER_GYRO_COUNT;
+    setGyroRaw(data.gyroRaw[ImuData::X], data.gyroRaw[ImuData::Y], data.gyroRaw[ImuData::Z]);
+}
+
 void Bmi088::read()
 {
-    uint8_t rxBuff[6] = {};
+#ifdef PLATFORM_HOSTED
+    if (auto replayer = capture::CaptureReplayer::getActive(); replayer != nullptr)
+    {
+        replayer->update();
+        uint8_t sample[capture::CAPTURE_IMU_SAMPLE_SIZE];
+        if (replayer->readImu(0, sample))
+        {
+            prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+            parseAccGyroData(sample, sample + 6);
+            diagnostics.recordSamples(prevIMUDataReceivedTime);
+        }
+        return;
+    }
+#endif
 
-    Bmi088Hal::bmi088AccReadMultiReg(Acc::ACC_X_LSB, rxBuff, 6);
+    if (readMode == ReadMode::DATA_READY_DMA)
+    {
+        Bmi088DataReadyDma::Sample sample;
+        if (!Bmi088DataReadyDma::getLatestSample(&sample))
+        {
+            return;
+        }
+
+        prevIMUDataReceivedTime = sample.gyroTime;
+        parseAccGyroData(sample.accData, sample.gyroData);
+
+        constexpr int TEMP_MSB_INDEX = Acc::TEMP_MSB - Acc::ACC_X_LSB;
+        data.temperature =
+            parseTemp(sample.accData[TEMP_MSB_INDEX], sample.accData[TEMP_MSB_INDEX + 1]);
+
+        if (ImuDiagnostics::looksLikeBusFault(sample.accData, 6))
+        {
+            diagnostics.recordSpiError();
+        }
+        diagnostics.recordSamples(sample.gyroTime);
+        // The transfers happen in the background, so the read time is the latency from the data
+        // ready interrupt to the sample being parsed.
+        diagnostics.recordReadTime(tap::arch::clock::getTimeMicroseconds() - sample.gyroTime);
+        return;
+    }
 
-    prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+    const uint32_t readStartTime = tap::arch::clock::getTimeMicroseconds();
 
-    data.accRaw[ImuData::X] = bigEndianInt16ToFloat(rxBuff);
-    data.accRaw[ImuData::Y] = bigEndianInt16ToFloat(rxBuff + 2);
-    data.accRaw[ImuData::Z] = bigEndianInt16ToFloat(rxBuff + 4);
+    if (readMode == ReadMode::FIFO)
+    {
+        prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+        // The accelerometer is read first so that each gyroscope sample is paired with an
+        // acceleration at least as new as it.
+        readAccFifo();
+        readGyroFifo();
+    }
+    else
+    {
+        uint8_t accBuff[6] = {};
+        uint8_t gyroBuff[6] = {};
 
-    Bmi088Hal::bmi088GyroReadMultiReg(Gyro::RATE_X_LSB, rxBuff, 6);
-    data.gyroRaw[ImuData::X] = bigEndianInt16ToFloat(rxBuff);
-    data.gyroRaw[ImuData::Y] = bigEndianInt16ToFloat(rxBuff + 2);
-    data.gyroRaw[ImuData::Z] = bigEndianInt16ToFloat(rxBuff + 4);
+        Bmi088Hal::bmi088AccReadMultiReg(Acc::ACC_X_LSB, accBuff, 6);
 
-    Bmi088Hal::bmi088AccReadMultiReg(Acc::TEMP_MSB, rxBuff, 2);
-    data.temperature = parseTemp(rxBuff[0], rxBuff[1]);
+        prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+
+        Bmi088Hal::bmi088GyroReadMultiReg(Gyro::RATE_X_LSB, gyroBuff, 6);
+
+        parseAccGyroData(accBuff, gyroBuff);
+
+        if (ImuDiagnostics::looksLikeBusFault(accBuff, sizeof(accBuff)))
+        {
+            diagnostics.recordSpiError();
+        }
+        diagnostics.recordSamples(prevIMUDataReceivedTime);
+    }
+
+    uint8_t tempBuff[2] = {};
+    Bmi088Hal::bmi088AccReadMultiReg(Acc::TEMP_MSB, tempBuff, 2);
+    data.temperature = parseTemp(tempBuff[0], tempBuff[1]);
+
+    diagnostics.recordReadTime(tap::arch::clock::getTimeMicroseconds() - readStartTime);
+}
+
+void Bmi088::readAccFifo()
+{
+    uint8_t lengthBuff[2] = {};
+    Bmi088Hal::bmi088AccReadMultiReg(Acc::FIFO_LENGTH_0, lengthBuff, 2);
+    uint16_t length = lengthBuff[0] | ((lengthBuff[1] & 0x3f) << 8);
+    if (length == 0)
+    {
+        return;
+    }
+    length = std::min<uint16_t>(length, MAX_FIFO_READ_LENGTH);
+
+    Bmi088Hal::bmi088AccReadMultiReg(Acc::FIFO_DATA, fifoBuffer, length);
+
+    // A frame cut off at the end of the read is sent again, header included, by the next read.
+    uint16_t i = 0;
+    while (i < length)
+    {
+        uint8_t header = fifoBuffer[i] & Acc::FIFO_HEADER_MASK;
+        uint8_t payloadLength;
+        switch (header)
+        {
+            case Acc::FifoHeader::ACC_FRAME:
+                payloadLength = Acc::FIFO_ACC_FRAME_DATA_LENGTH;
+                break;
+            case Acc::FifoHeader::SENSOR_TIME_FRAME:
+                payloadLength = 3;
+                break;
+            case Acc::FifoHeader::SKIP_FRAME:
+            case Acc::FifoHeader::INPUT_CONFIG_FRAME:
+            case Acc::FifoHeader::SAMPLE_DROP_FRAME:
+                payloadLength = 1;
+                break;
+            default:
+                // EMPTY_FRAME, or garbage that can't be parsed further
+                return;
+        }
+
+        if (i + 1 + payloadLength > length)
+        {
+            return;
+        }
+
+        if (header == Acc::FifoHeader::SAMPLE_DROP_FRAME)
+        {
+            diagnostics.recordDroppedSamples(1);
+        }
+        else if (header == Acc::FifoHeader::ACC_FRAME)
+        {
+            const uint8_t *frame = fifoBuffer + i + 1;
+            float sample[3] = {
+                bigEndianInt16ToFloat(frame),
+                bigEndianInt16ToFloat(frame + 2),
+                bigEndianInt16ToFloat(frame + 4)};
+            if (accDecimator.update(sample))
+            {
+                setAccRaw(
+                    accDecimator.getOutput(ImuData::X),
+                    accDecimator.getOutput(ImuData::Y),
+                    accDecimator.getOutput(ImuData::Z));
+            }
+        }
+
+        i += 1 + payloadLength;
+    }
+}
+
+void Bmi088::readGyroFifo()
+{
+    const uint8_t status = Bmi088Hal::bmi088GyroReadSingleReg(Gyro::FIFO_STATUS);
+    if (status & static_cast<uint8_t>(Gyro::FifoStatus::FIFO_OVERRUN))
+    {
+        // The number of samples lost isn't reported.
+        diagnostics.recordDroppedSamples(1);
+    }
+
+    uint8_t numFrames = status & static_cast<uint8_t>(Gyro::FifoStatus::FIFO_FRAME_COUNTER);
+    numFrames = std::min<uint8_t>(numFrames, MAX_FIFO_READ_LENGTH / Gyro::FIFO_FRAME_LENGTH);
+    if (numFrames == 0)
+    {
+        return;
+    }
+    diagnostics.recordSamples(prevIMUDataReceivedTime, numFrames);
+
+    Bmi088Hal::bmi088GyroReadMultiReg(
+        Gyro::FIFO_DATA,
+        fifoBuffer,
+        numFrames * Gyro::FIFO_FRAME_LENGTH);
+
+    for (uint8_t i = 0; i < numFrames; i++)
+    {
+        const uint8_t *frame = fifoBuffer + i * Gyro::FIFO_FRAME_LENGTH;
+        float sample[3] = {
+            bigEndianInt16ToFloat(frame),
+            bigEndianInt16ToFloat(frame + 2),
+            bigEndianInt16ToFloat(frame + 4)};
+        if (gyroDecimator.update(sample))
+        {
+            setGyroRaw(
+                gyroDecimator.getOutput(ImuData::X),
+                gyroDecimator.getOutput(ImuData::Y),
+                gyroDecimator.getOutput(ImuData::Z));
+            updateAttitude();
+        }
+    }
+}
+
+void Bmi088::parseAccGyroData(const uint8_t *accData, const uint8_t *gyroData)
+{
+    if (auto recorder = capture::CaptureRecorder::getActive(); recorder != nullptr)
+    {
+        uint8_t sample[capture::CAPTURE_IMU_SAMPLE_SIZE];
+        memcpy(sample, accData, 6);
+        memcpy(sample + 6, gyroData, 6);
+        recorder->record(capture::CaptureSource::IMU, 0, sample, sizeof(sample));
+    }
+
+    setAccRaw(
+        bigEndianInt16ToFloat(accData),
+        bigEndianInt16ToFloat(accData + 2),
+        bigEndianInt16ToFloat(accData + 4));
+    setGyroRaw(
+        bigEndianInt16ToFloat(gyroData),
+        bigEndianInt16ToFloat(gyroData + 2),
+        bigEndianInt16ToFloat(gyroData + 4));
+}
+
+void Bmi088::setGyroRaw(float x, float y, float z)
+{
+    data.gyroRaw[ImuData::X] = x;
+    data.gyroRaw[ImuData::Y] = y;
+    data.gyroRaw[ImuData::Z] = z;
 
     data.gyroDegPerSec[ImuData::X] =
         GYRO_DS_PER_GYRO_COUNT * (data.gyroRaw[ImuData::X] - data.gyroOffsetRaw[ImuData::X]);
@@ -244,6 +728,13 @@ void Bmi088::read()
         GYRO_DS_PER_GYRO_COUNT * (data.gyroRaw[ImuData::Y] - data.gyroOffsetRaw[ImuData::Y]);
     data.gyroDegPerSec[ImuData::Z] =
         GYRO_DS_PER_GYRO_COUNT * (data.gyroRaw[ImuData::Z] - data.gyroOffsetRaw[ImuData::Z]);
+}
+
+void Bmi088::setAccRaw(float x, float y, float z)
+{
+    data.accRaw[ImuData::X] = x;
+    data.accRaw[ImuData::Y] = y;
+    data.accRaw[ImuData::Z] = z;
 
     data.accG[ImuData::X] =
         ACC_G_PER_ACC_COUNT * (data.accRaw[ImuData::X] - data.accOffsetRaw[ImuData::X]);
@@ -264,6 +755,7 @@ void Bmi088::setAndCheckAccRegister(Acc::Register reg, Acc::Registers_t value)
     if (val != value.value)
     {
         RAISE_ERROR(drivers, "bmi088 acc config failed");
+        diagnostics.recordSpiError();
         imuState = ImuState::IMU_NOT_CONNECTED;
     }
 }
@@ -279,6 +771,7 @@ void Bmi088::setAndCheckGyroRegister(Gyro::Register reg, Gyro::Registers_t value
     if (val != value.value)
     {
         RAISE_ERROR(drivers, "bmi088 gyro config failed");
+        diagnostics.recordSpiError();
         imuState = ImuState::IMU_NOT_CONNECTED;
     }
 }
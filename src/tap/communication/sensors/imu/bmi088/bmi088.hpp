@@ -20,8 +20,16 @@
 #ifndef TAPROOT_BMI088_HPP_
 #define TAPROOT_BMI088_HPP_
 
+#include <cstddef>
+
 #include "tap/algorithms/MahonyAHRS.h"
+#include "tap/algorithms/attitude_estimator.hpp"
+#include "tap/algorithms/attitude_history.hpp"
+#include "tap/algorithms/fir_decimator.hpp"
+#include "tap/algorithms/gyro_bias_estimator.hpp"
 #include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/timeout.hpp"
+#include "tap/communication/sensors/imu/imu_diagnostics.hpp"
 #include "tap/communication/sensors/imu/imu_interface.hpp"
 #include "tap/communication/sensors/imu_heater/imu_heater.hpp"
 #include "tap/util_macros.hpp"
@@ -61,6 +69,56 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
      */
     static constexpr float GYRO_RANGE_MAX_DS = 2000.0f;
 
+    /// How `read` gets data from the bmi088.
+    enum class ReadMode : uint8_t
+    {
+        /// `read` performs blocking SPI transfers.
+        BLOCKING,
+        /**
+         * The bmi088's data ready interrupts start SPI DMA transfers in the background, and
+         * `read` only copies the newest sample. See `Bmi088DataReadyDma`.
+         */
+        DATA_READY_DMA,
+        /**
+         * The accelerometer and gyroscope buffer every sample in their hardware FIFOs. `read`
+         * drains both FIFOs in one SPI burst each and passes every sample through a decimating
+         * filter, see `configureFifoFilters`. Each filtered gyroscope sample updates the
+         * attitude estimator, so it runs at the gyroscope's output rate divided by the decimation
+         * factor no matter how often `read` is called.
+         */
+        FIFO,
+    };
+
+    /**
+     * Output rates, filter bandwidths and mahony gains used for one level of motion, see
+     * `setAdaptiveRate`.
+     */
+    struct RateProfile
+    {
+        Acc::AccBandwidth accOversampling;
+        Acc::AccOutputRate accOutputRate;
+        /// Sets both the gyroscope's output rate and its filter bandwidth.
+        Gyro::GyroBandwidth gyroOutputRate;
+        float mahonyKp;
+        float mahonyKi;
+    };
+
+    /// Default angular speed above which the bmi088 is moving, in degrees / second.
+    static constexpr float DEFAULT_MOVING_THRESHOLD_DPS = 30.0f;
+    /// Default angular speed below which the bmi088 may be still, in degrees / second.
+    static constexpr float DEFAULT_STILL_THRESHOLD_DPS = 5.0f;
+    /// Default time the bmi088 must stay below the still threshold to be still, in ms.
+    static constexpr uint32_t DEFAULT_STILL_TIME_MS = 2000;
+
+    /**
+     * The most bytes read from either FIFO by a single `read`. Samples that don't fit are read
+     * next time.
+     */
+    static constexpr uint8_t MAX_FIFO_READ_LENGTH = 240;
+
+    /// The most taps of the FIFO decimation filters.
+    static constexpr std::size_t MAX_FIFO_FILTER_TAPS = 32;
+
     static constexpr float BMI088_TEMP_FACTOR = 0.125f;
     static constexpr float BMI088_TEMP_OFFSET = 23.0f;
 
@@ -91,14 +149,22 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     /**
      * Call this function at same rate as intialized sample frequency.
-     * Performs the mahony AHRS algorithm to compute pitch/roll/yaw.
+     * Runs the attitude estimator, the mahony AHRS algorithm unless replaced with
+     * `setAttitudeEstimator`, to compute pitch/roll/yaw.
+     *
+     * @note In `ReadMode::FIFO` the attitude estimator is updated by `read` instead, at the
+     *      decimated gyroscope output rate, and this only runs the temperature controller.
      */
     mockable void periodicIMUUpdate();
 
     /**
      * This function reads the IMU data from SPI
      *
-     * @note This function blocks for 129 microseconds to read registers from the BMI088.
+     * @note In `ReadMode::BLOCKING` this function blocks for 129 microseconds to read registers
+     *      from the BMI088. In `ReadMode::DATA_READY_DMA` it only copies the newest sample
+     *      transferred in the background, and does nothing if no new sample has arrived. In
+     *      `ReadMode::FIFO` it reads every sample buffered since the last call, and should be
+     *      called often enough that the gyroscope's FIFO doesn't overflow (100 samples).
      */
     mockable void read();
 
@@ -116,7 +182,7 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     /**
      * When this function is called, the bmi088 enters a calibration state during which time,
-     * gyro/accel calibration offsets will be computed and the mahony algorithm reset. When
+     * gyro/accel calibration offsets will be computed and the attitude estimator reset. When
      * calibrating, angle, accelerometer, and gyroscope values will return 0. When calibrating
      * the BMI088 should be level, otherwise the IMU will be calibrated incorrectly.
      */
@@ -124,9 +190,9 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     inline const char *getName() const final_mockable { return "bmi088"; }
 
-    mockable inline float getYaw() final_mockable { return mahonyAlgorithm.getYaw(); }
-    mockable inline float getPitch() final_mockable { return mahonyAlgorithm.getPitch(); }
-    mockable inline float getRoll() final_mockable { return mahonyAlgorithm.getRoll(); }
+    mockable inline float getYaw() final_mockable { return attitudeEstimator->getYaw(); }
+    mockable inline float getPitch() final_mockable { return attitudeEstimator->getPitch(); }
+    mockable inline float getRoll() final_mockable { return attitudeEstimator->getRoll(); }
 
     mockable inline float getGx() final_mockable { return data.gyroDegPerSec[ImuData::X]; }
     mockable inline float getGy() final_mockable { return data.gyroDegPerSec[ImuData::Y]; }
@@ -138,7 +204,15 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     mockable inline float getTemp() final_mockable { return data.temperature; }
 
-    mockable inline uint32_t getPrevIMUDataReceivedTime() const { return prevIMUDataReceivedTime; }
+    mockable inline uint32_t getPrevIMUDataReceivedTime() const final_mockable
+    {
+        return prevIMUDataReceivedTime;
+    }
+
+    mockable inline const ImuDiagnostics *getDiagnostics() const final_mockable
+    {
+        return &diagnostics;
+    }
 
     inline void setOffsetSamples(float samples) { BMI088_OFFSET_SAMPLES = samples; }
 
@@ -150,11 +224,149 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     inline void setGyroOutputRate(Gyro::GyroBandwidth outputRate) { gyroOutputRate = outputRate; }
 
+    /**
+     * Sets how the bmi088 is read. Must be called before `initialize`. `ReadMode::DATA_READY_DMA`
+     * removes the SPI busy-wait from the main loop, which makes running the gyroscope at 2 kHz
+     * (`Gyro::GyroBandwidth::ODR2000_BANDWIDTH230`) practical.
+     */
+    inline void setReadMode(ReadMode mode) { readMode = mode; }
+
+    /**
+     * Configures the filters used in `ReadMode::FIFO`. Both are CIC filters, see
+     * `tap::algorithms::FirDecimator::configureCic`. When calling `initialize` in FIFO mode, the
+     * `sampleFrequency` is ignored, and the attitude estimator's sample frequency is the
+     * gyroscope's output rate divided by `gyroDecimationFactor`.
+     *
+     * @param[in] gyroDecimationFactor The number of gyroscope samples per attitude update.
+     * @param[in] accDecimationFactor The number of accelerometer samples averaged into each
+     *      acceleration reading.
+     * @param[in] cicOrder The order of both CIC filters. 1 averages each block of samples, higher
+     *      orders reject more of the vibration that would alias into the decimated output.
+     * @return `false` if the filters would have more than `MAX_FIFO_FILTER_TAPS` taps, in which
+     *      case the filters are unchanged.
+     */
+    bool configureFifoFilters(
+        uint8_t gyroDecimationFactor,
+        uint8_t accDecimationFactor,
+        uint8_t cicOrder = 1);
+
+    /**
+     * Enables switching between a low rate profile while the bmi088 is still, e.g. while the
+     * robot is disabled in the pit, and a high rate profile while it is moving, e.g. spinning or
+     * slewing the gimbal. The bmi088 is moving as soon as its angular speed exceeds
+     * `movingThresholdDps`, and still once its angular speed has stayed below
+     * `stillThresholdDps` for `stillTimeMs`.
+     *
+     * Switching only rewrites the rate registers rather than running `initialize` again, and
+     * `mahonyKp` and `mahonyKi` are applied without resetting the attitude. In `ReadMode::FIFO`
+     * the filters from `configureFifoFilters` are kept, since their taps are defined per sample,
+     * but their history is cleared, and the attitude estimator's sample frequency follows the
+     * gyroscope's output rate, so the decimation factors should suit both profiles. In
+     * `ReadMode::DATA_READY_DMA` a lower output rate means fewer interrupts and SPI transfers,
+     * and in `ReadMode::FIFO` fewer samples to read and filter. In `ReadMode::BLOCKING`, `read`
+     * costs the same at any output rate.
+     *
+     * If called before `initialize`, the bmi088 starts in the moving profile and `initialize`'s
+     * gains are replaced by the profile's. Otherwise the moving profile is applied immediately.
+     */
+    void setAdaptiveRate(
+        const RateProfile &still,
+        const RateProfile &moving,
+        float movingThresholdDps = DEFAULT_MOVING_THRESHOLD_DPS,
+        float stillThresholdDps = DEFAULT_STILL_THRESHOLD_DPS,
+        uint32_t stillTimeMs = DEFAULT_STILL_TIME_MS);
+
+    /// Disables `setAdaptiveRate`, leaving the bmi088 in its moving profile.
+    void disableAdaptiveRate();
+
+    /// @return `false` while `setAdaptiveRate` has the bmi088 in its still profile.
+    inline bool isMoving() const { return moving; }
+
     inline void setTargetTemperature(float temperatureC)
     {
         imuHeater.setDesiredTemperature(temperatureC);
     }
 
+    /**
+     * @return `true` once the IMU heater has held the target temperature long enough for the
+     *      gyroscope bias to settle, see `ImuHeater::isTemperatureStable`.
+     */
+    inline bool isTemperatureStable() const { return imuHeater.isTemperatureStable(); }
+
+    /**
+     * Makes `requestRecalibration` wait until the temperature is stable before it starts collecting
+     * samples, instead of calibrating at whatever temperature the bmi088 is at. Disabled by
+     * default.
+     */
+    inline void setCalibrationWaitsForTemperature(bool enabled)
+    {
+        calibrationWaitsForTemperature = enabled;
+    }
+
+    /**
+     * Replaces the mahony algorithm with another attitude estimator, for example a
+     * `tap::algorithms::AttitudeEskf`. Must be called before `initialize`, which sets the
+     * estimator's sample frequency. The estimator must outlive the bmi088. `nullptr` restores
+     * the mahony algorithm.
+     */
+    inline void setAttitudeEstimator(tap::algorithms::AttitudeEstimator *estimator)
+    {
+        attitudeEstimator = estimator != nullptr ? estimator : &mahonyAlgorithm;
+    }
+
+    inline tap::algorithms::AttitudeEstimator &getAttitudeEstimator() { return *attitudeEstimator; }
+
+    /**
+     * Enables estimating the gyroscope bias whenever the bmi088 is stationary, see
+     * `tap::algorithms::GyroBiasEstimator`. The first estimate marks the IMU calibrated, so the
+     * robot doesn't have to sit still through `requestRecalibration` at startup, and later
+     * estimates keep refining the bias, so being bumped doesn't require a recalibration.
+     * Disabled by default.
+     */
+    inline void setOnlineGyroCalibration(bool enabled) { onlineGyroCalibration = enabled; }
+
+    /**
+     * Restores a gyroscope calibration, such as one stored in flash from a previous boot. The
+     * IMU is calibrated as soon as it is initialized, and with online calibration enabled the
+     * calibration keeps being refined. Accelerometer offsets are not restored.
+     *
+     * @return `false` if the calibration isn't valid, in which case nothing changes.
+     */
+    bool setGyroCalibration(const tap::algorithms::GyroCalibration &calibration);
+
+    /**
+     * @return The gyroscope calibration from `setGyroCalibration`, `requestRecalibration`, or
+     *      online estimation, to be stored when its number of updates changes.
+     */
+    inline const tap::algorithms::GyroBiasEstimator &getGyroBiasEstimator() const
+    {
+        return gyroBiasEstimator;
+    }
+
+    /// Entries of attitude history kept, 128 ms at a 1 kHz sample rate.
+    static constexpr int ATTITUDE_HISTORY_LENGTH = 128;
+
+    /**
+     * Computes the attitude at a past time, for example the exposure time of a camera frame, so
+     * latency can be compensated for with the pose the robot had rather than its current one.
+     *
+     * @param[in] timeUs The time, in microseconds as returned by
+     *      `tap::arch::clock::getTimeMicroseconds`.
+     * @param[out] q The attitude quaternion (w, x, y, z) at `timeUs`.
+     * @return `false` if `timeUs` is older than the history, in which case `q` is unchanged.
+     */
+    inline bool getAttitudeAt(uint32_t timeUs, float (&q)[4]) const
+    {
+        return attitudeHistory.getAttitudeAt(timeUs, q);
+    }
+
+    /// @return The timestamped attitudes and bias corrected angular velocities of past samples.
+    inline const tap::algorithms::AttitudeHistory<ATTITUDE_HISTORY_LENGTH> &getAttitudeHistory()
+        const
+    {
+        return attitudeHistory;
+    }
+
 private:
     static constexpr uint16_t RAW_TEMPERATURE_TO_APPLY_OFFSET = 1023;
     /// Offset parsed temperature reading by this amount if > RAW_TEMPERATURE_TO_APPLY_OFFSET.
@@ -185,12 +397,25 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
 
     Mahony mahonyAlgorithm;
 
+    /// The estimator that computes the angles, `mahonyAlgorithm` unless replaced.
+    tap::algorithms::AttitudeEstimator *attitudeEstimator = &mahonyAlgorithm;
+
     imu_heater::ImuHeater imuHeater;
 
     int calibrationSample = 0;
 
+    bool onlineGyroCalibration = false;
+
+    bool calibrationWaitsForTemperature = false;
+
+    tap::algorithms::GyroBiasEstimator gyroBiasEstimator;
+
+    tap::algorithms::AttitudeHistory<ATTITUDE_HISTORY_LENGTH> attitudeHistory;
+
     uint32_t prevIMUDataReceivedTime = 0;
 
+    ImuDiagnostics diagnostics;
+
     Acc::AccBandwidth accOversampling = Acc::AccBandwidth::NORMAL;
     Acc::AccOutputRate accOutputRate = Acc::AccOutputRate::Hz800;
 
@@ -199,6 +424,57 @@ class Bmi088 final_mockable : public Bmi088Data, public ImuInterface
     Gyro::GyroBandwidth gyroOutputRate = Gyro::GyroBandwidth::ODR1000_BANDWIDTH116;
     void initializeGyro();
 
+    ReadMode readMode = ReadMode::BLOCKING;
+
+    /// Configures the data ready interrupt pins of the accelerometer and gyroscope.
+    void initializeDataReadyInterrupts();
+
+    /// Converts raw accelerometer and gyroscope data, starting at ACC_X_LSB and RATE_X_LSB.
+    void parseAccGyroData(const uint8_t *accData, const uint8_t *gyroData);
+
+    void setAccRaw(float x, float y, float z);
+
+    void setGyroRaw(float x, float y, float z);
+
+    /// Runs the attitude estimator, or collects a calibration sample when calibrating.
+    void updateAttitude();
+
+    /// Sets the gyroscope offsets to the bias estimated at the current temperature.
+    void applyGyroBias();
+
+    /// The frequency the attitude estimator is updated at, see `initialize`.
+    float sampleFrequency = 0;
+
+    bool adaptiveRate = false;
+    RateProfile stillProfile = {};
+    RateProfile movingProfile = {};
+    float movingThresholdDps = DEFAULT_MOVING_THRESHOLD_DPS;
+    float stillThresholdDps = DEFAULT_STILL_THRESHOLD_DPS;
+    uint32_t stillTimeMs = DEFAULT_STILL_TIME_MS;
+    bool moving = true;
+    /// Running while the angular speed is below stillThresholdDps in the moving profile.
+    tap::arch::MilliTimeout stillTimeout;
+
+    /// Switches profiles when the angular speed crosses the thresholds of `setAdaptiveRate`.
+    void updateMotionProfile();
+
+    /// Applies the profile's rates and gains, writing the rate registers if connected.
+    void applyRateProfile(const RateProfile &profile);
+
+    tap::algorithms::FirDecimator<3, MAX_FIFO_FILTER_TAPS> accDecimator;
+    tap::algorithms::FirDecimator<3, MAX_FIFO_FILTER_TAPS> gyroDecimator;
+
+    uint8_t fifoBuffer[MAX_FIFO_READ_LENGTH] = {};
+
+    void initializeFifos();
+
+    void readAccFifo();
+
+    void readGyroFifo();
+
+    /// @return The gyroscope's output data rate in Hz.
+    static float getGyroOutputRateHz(Gyro::GyroBandwidth outputRate);
+
     void computeOffsets();
 
     void setAndCheckAccRegister(Acc::Register reg, Acc::Registers_t value);
@@ -68,6 +68,11 @@ class Bmi088Data
         /// The id of the gyroscope that will is stored in address `GYRO_CHIP_ID`.
         static constexpr uint8_t GYRO_CHIP_ID_VALUE = 0x0f;
 
+        /// The number of frames the gyroscope's FIFO holds.
+        static constexpr uint8_t FIFO_CAPACITY_FRAMES = 100;
+        /// The length of a FIFO frame, containing x, y, and z rates.
+        static constexpr uint8_t FIFO_FRAME_LENGTH = 6;
+
         enum class GyroIntStat1 : uint8_t
         {
             GYRO_DRDY = modm::Bit7,
@@ -269,6 +274,11 @@ class Bmi088Data
             FIFO_DATA = 0x26,
             ACC_CONF = 0x40,
             ACC_RANGE = 0x41,
+            FIFO_DOWNS = 0x45,
+            FIFO_WTM_0 = 0x46,
+            FIFO_WTM_1 = 0x47,
+            FIFO_CONFIG_0 = 0x48,
+            FIFO_CONFIG_1 = 0x49,
             INT1_IO_CTRL = 0x53,
             INT2_IO_CTRL = 0x54,
             INT_MAP_DATA = 0x58,
@@ -417,6 +427,47 @@ class Bmi088Data
         };
         MODM_FLAGS8(AccPwrCtrl);
 
+        /// @see section 5.3.18 of the bmi088 datasheet. Bit 1 must always be set.
+        enum class FifoConfig0 : uint8_t
+        {
+            /// When full, the FIFO discards its oldest frames.
+            STREAM_MODE = 0x02,
+            /// When full, the FIFO stops collecting frames.
+            FIFO_MODE = 0x03,
+        };
+        MODM_FLAGS8(FifoConfig0);
+
+        /// @see section 5.3.19 of the bmi088 datasheet. Bit 4 must always be set.
+        enum class FifoConfig1 : uint8_t
+        {
+            ACC_EN = 0x50,
+        };
+        MODM_FLAGS8(FifoConfig1);
+
+        /**
+         * Headers of the frames stored in the accelerometer's FIFO. The lower two bits of an
+         * `ACC_FRAME` header are interrupt tags and should be masked off. @see section 4.9.1 of
+         * the bmi088 datasheet.
+         */
+        enum FifoHeader : uint8_t
+        {
+            /// Followed by 6 bytes of acceleration data.
+            ACC_FRAME = 0x84,
+            /// Followed by the number of frames skipped.
+            SKIP_FRAME = 0x40,
+            /// Followed by 3 bytes of sensor time.
+            SENSOR_TIME_FRAME = 0x44,
+            /// Followed by 1 byte indicating which configuration changed.
+            INPUT_CONFIG_FRAME = 0x48,
+            /// Followed by 1 byte indicating which data was dropped.
+            SAMPLE_DROP_FRAME = 0x50,
+            /// Returned when reading past the end of the FIFO's contents.
+            EMPTY_FRAME = 0x80,
+        };
+
+        static constexpr uint8_t FIFO_HEADER_MASK = 0xfc;
+        static constexpr uint8_t FIFO_ACC_FRAME_DATA_LENGTH = 6;
+
         /// Writing this to the AccSoftreset register will perform a soft reset of the IMU
         enum class AccSoftreset : uint8_t
         {
@@ -436,7 +487,9 @@ class Bmi088Data
             AccPwrConf_t,
             AccPwrCtrl_t,
             AccSoftreset_t,
-            IntMapData_t>;
+            IntMapData_t,
+            FifoConfig0_t,
+            FifoConfig1_t>;
     };
 };
 
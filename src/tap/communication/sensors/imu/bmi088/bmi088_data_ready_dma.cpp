@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bmi088_data_ready_dma.hpp"
+
+#include <cstring>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/board/board.hpp"
+
+#include "bmi088_hal.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#include "modm/architecture/interface/interrupt.hpp"
+#include "modm/platform.hpp"
+#endif
+
+#ifndef PLATFORM_HOSTED
+using tap::communication::sensors::imu::bmi088::Bmi088DataReadyDma;
+
+namespace
+{
+/// SPI1 receive, DMA2 stream 0 channel 3.
+DMA_Stream_TypeDef *const RX_STREAM = DMA2_Stream0;
+/// SPI1 transmit, DMA2 stream 3 channel 3.
+DMA_Stream_TypeDef *const TX_STREAM = DMA2_Stream3;
+constexpr uint32_t SPI_DMA_CHANNEL = 3;
+/// FEIF, DMEIF, TEIF, HTIF, and TCIF of streams 0 and 3.
+constexpr uint32_t RX_STREAM_FLAGS = 0x3du << 0;
+constexpr uint32_t TX_STREAM_FLAGS = 0x3du << 22;
+
+/// Read commands followed by dummy bytes, clocked out while the data registers are read.
+uint8_t accTxBuffer[Bmi088DataReadyDma::ACC_TRANSFER_LENGTH];
+uint8_t gyroTxBuffer[Bmi088DataReadyDma::GYRO_TRANSFER_LENGTH];
+}  // namespace
+
+MODM_ISR(EXTI4)
+{
+    Board::ImuInt1Accel::acknowledgeExternalInterruptFlag();
+    Bmi088DataReadyDma::onAccDataReady(tap::arch::clock::getTimeMicroseconds());
+}
+
+MODM_ISR(EXTI9_5)
+{
+    if (Board::ImuInt1Gyro::getExternalInterruptFlag())
+    {
+        Board::ImuInt1Gyro::acknowledgeExternalInterruptFlag();
+        Bmi088DataReadyDma::onGyroDataReady(tap::arch::clock::getTimeMicroseconds());
+    }
+}
+
+MODM_ISR(DMA2_Stream0)
+{
+    DMA2->LIFCR = RX_STREAM_FLAGS;
+    Bmi088DataReadyDma::onTransferComplete();
+}
+
+#endif
+
+namespace tap::communication::sensors::imu::bmi088
+{
+Bmi088DataReadyDma::SensorBuffers Bmi088DataReadyDma::acc = {};
+Bmi088DataReadyDma::SensorBuffers Bmi088DataReadyDma::gyro = {};
+Bmi088DataReadyDma::Transfer Bmi088DataReadyDma::currentTransfer =
+    Bmi088DataReadyDma::Transfer::NONE;
+bool Bmi088DataReadyDma::paused = false;
+Bmi088DataReadyDma::SampleCallback Bmi088DataReadyDma::gyroSampleCallback = nullptr;
+void *Bmi088DataReadyDma::gyroSampleCallbackContext = nullptr;
+
+#ifndef PLATFORM_HOSTED
+void Bmi088DataReadyDma::initialize()
+{
+    memset(accTxBuffer, 0x55, sizeof(accTxBuffer));
+    accTxBuffer[0] = Bmi088Data::Acc::ACC_X_LSB | Bmi088Data::BMI088_READ_BIT;
+    memset(gyroTxBuffer, 0x55, sizeof(gyroTxBuffer));
+    gyroTxBuffer[0] = Bmi088Data::Gyro::RATE_X_LSB | Bmi088Data::BMI088_READ_BIT;
+
+    Rcc::enable<Peripheral::Dma2>();
+
+    RX_STREAM->CR = 0;
+    TX_STREAM->CR = 0;
+    while ((RX_STREAM->CR & DMA_SxCR_EN) != 0 || (TX_STREAM->CR & DMA_SxCR_EN) != 0)
+    {
+    }
+    DMA2->LIFCR = RX_STREAM_FLAGS | TX_STREAM_FLAGS;
+    RX_STREAM->PAR = reinterpret_cast<uint32_t>(&SPI1->DR);
+    TX_STREAM->PAR = reinterpret_cast<uint32_t>(&SPI1->DR);
+    RX_STREAM->FCR = 0;
+    TX_STREAM->FCR = 0;
+    SPI1->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+    NVIC_SetPriority(DMA2_Stream0_IRQn, INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    Board::ImuInt1Accel::setInput(Gpio::InputType::PullDown);
+    Board::ImuInt1Accel::setInputTrigger(Gpio::InputTrigger::RisingEdge);
+    Board::ImuInt1Accel::enableExternalInterrupt();
+    Board::ImuInt1Accel::enableExternalInterruptVector(INTERRUPT_PRIORITY);
+
+    Board::ImuInt1Gyro::setInput(Gpio::InputType::PullDown);
+    Board::ImuInt1Gyro::setInputTrigger(Gpio::InputTrigger::RisingEdge);
+    Board::ImuInt1Gyro::enableExternalInterrupt();
+    Board::ImuInt1Gyro::enableExternalInterruptVector(INTERRUPT_PRIORITY);
+}
+#else
+void Bmi088DataReadyDma::initialize() {}
+#endif
+
+bool Bmi088DataReadyDma::getLatestSample(Sample *sample)
+{
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+    peekLatestSample(sample);
+
+    bool fresh = acc.fresh || gyro.fresh;
+    acc.fresh = false;
+    gyro.fresh = false;
+    return fresh;
+}
+
+void Bmi088DataReadyDma::peekLatestSample(Sample *sample)
+{
+#ifndef PLATFORM_HOSTED
+    // The interrupts only swap buffers, so while they are disabled the front buffers aren't
+    // written to by DMA.
+    modm::atomic::Lock lock;
+#endif
+    memcpy(sample->accData, acc.buffers[acc.front] + ACC_DATA_OFFSET, ACC_DATA_LENGTH);
+    memcpy(sample->gyroData, gyro.buffers[gyro.front] + GYRO_DATA_OFFSET, GYRO_DATA_LENGTH);
+    sample->accTime = acc.times[acc.front];
+    sample->gyroTime = gyro.times[gyro.front];
+}
+
+void Bmi088DataReadyDma::setGyroSampleCallback(SampleCallback callback, void *context)
+{
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+    gyroSampleCallback = callback;
+    gyroSampleCallbackContext = context;
+}
+
+bool Bmi088DataReadyDma::pauseTransfers()
+{
+    {
+#ifndef PLATFORM_HOSTED
+        modm::atomic::Lock lock;
+#endif
+        paused = true;
+    }
+
+    // currentTransfer is written by the DMA interrupt, so read it through a volatile reference
+    const volatile Transfer &transfer = currentTransfer;
+    const uint32_t start = tap::arch::clock::getTimeMicroseconds();
+    while (transfer != Transfer::NONE)
+    {
+        if (tap::arch::clock::getTimeMicroseconds() - start > PAUSE_TIMEOUT_US)
+        {
+            resumeTransfers();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Bmi088DataReadyDma::resumeTransfers()
+{
+#ifndef PLATFORM_HOSTED
+    // Interrupts are disabled, so starting a transfer here can't race the interrupts
+    modm::atomic::Lock lock;
+#endif
+    paused = false;
+    if (currentTransfer == Transfer::NONE)
+    {
+        startNextTransfer();
+    }
+}
+
+void Bmi088DataReadyDma::onAccDataReady(uint32_t time)
+{
+    acc.pendingTime = time;
+    acc.pending = true;
+    if (currentTransfer == Transfer::NONE)
+    {
+        startNextTransfer();
+    }
+}
+
+void Bmi088DataReadyDma::onGyroDataReady(uint32_t time)
+{
+    gyro.pendingTime = time;
+    gyro.pending = true;
+    if (currentTransfer == Transfer::NONE)
+    {
+        startNextTransfer();
+    }
+}
+
+void Bmi088DataReadyDma::onTransferComplete()
+{
+    SensorBuffers &sensor = currentTransfer == Transfer::ACC ? acc : gyro;
+
+#ifndef PLATFORM_HOSTED
+    RX_STREAM->CR = 0;
+    TX_STREAM->CR = 0;
+    DMA2->LIFCR = TX_STREAM_FLAGS;
+    if (currentTransfer == Transfer::ACC)
+    {
+        Board::ImuCS1Accel::setOutput(modm::GpioOutput::High);
+    }
+    else
+    {
+        Board::ImuCS1Gyro::setOutput(modm::GpioOutput::High);
+    }
+#endif
+
+    const uint8_t back = 1 - sensor.front;
+    sensor.times[back] = sensor.transferTime;
+    sensor.front = back;
+    sensor.fresh = true;
+
+    const bool gyroTransferred = currentTransfer == Transfer::GYRO;
+    currentTransfer = Transfer::NONE;
+    startNextTransfer();
+
+    if (gyroTransferred && gyroSampleCallback != nullptr)
+    {
+        gyroSampleCallback(gyroSampleCallbackContext);
+    }
+}
+
+void Bmi088DataReadyDma::startNextTransfer()
+{
+    if (paused)
+    {
+        return;
+    }
+
+    // The gyroscope samples faster, and its data is what the attitude estimate integrates.
+    if (gyro.pending)
+    {
+        startTransfer(Transfer::GYRO);
+    }
+    else if (acc.pending)
+    {
+        startTransfer(Transfer::ACC);
+    }
+}
+
+void Bmi088DataReadyDma::startTransfer(Transfer transfer)
+{
+    SensorBuffers &sensor = transfer == Transfer::ACC ? acc : gyro;
+    sensor.transferTime = sensor.pendingTime;
+    sensor.pending = false;
+    currentTransfer = transfer;
+
+    uint8_t *rxBuffer = sensor.buffers[1 - sensor.front];
+
+#ifndef PLATFORM_HOSTED
+    const uint8_t *txBuffer = transfer == Transfer::ACC ? accTxBuffer : gyroTxBuffer;
+    const uint32_t length =
+        transfer == Transfer::ACC ? ACC_TRANSFER_LENGTH : GYRO_TRANSFER_LENGTH;
+
+    if (transfer == Transfer::ACC)
+    {
+        Board::ImuCS1Accel::setOutput(modm::GpioOutput::Low);
+    }
+    else
+    {
+        Board::ImuCS1Gyro::setOutput(modm::GpioOutput::Low);
+    }
+
+    // The receive stream is enabled first so that no received byte is missed.
+    RX_STREAM->M0AR = reinterpret_cast<uint32_t>(rxBuffer);
+    RX_STREAM->NDTR = length;
+    RX_STREAM->CR = (SPI_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_MINC |
+                    DMA_SxCR_TCIE | DMA_SxCR_EN;
+    TX_STREAM->M0AR = reinterpret_cast<uint32_t>(txBuffer);
+    TX_STREAM->NDTR = length;
+    TX_STREAM->CR = (SPI_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_MINC |
+                    DMA_SxCR_DIR_0 | DMA_SxCR_EN;
+#else
+    if (transfer == Transfer::ACC)
+    {
+        Bmi088Hal::bmi088AccReadMultiReg(
+            Bmi088Data::Acc::ACC_X_LSB,
+            rxBuffer + ACC_DATA_OFFSET,
+            ACC_DATA_LENGTH);
+    }
+    else
+    {
+        Bmi088Hal::bmi088GyroReadMultiReg(
+            Bmi088Data::Gyro::RATE_X_LSB,
+            rxBuffer + GYRO_DATA_OFFSET,
+            GYRO_DATA_LENGTH);
+    }
+    onTransferComplete();
+#endif
+}
+
+#if defined(ENV_UNIT_TESTS)
+void Bmi088DataReadyDma::reset()
+{
+    acc = {};
+    gyro = {};
+    currentTransfer = Transfer::NONE;
+    paused = false;
+    gyroSampleCallback = nullptr;
+    gyroSampleCallbackContext = nullptr;
+}
+#endif
+}  // namespace tap::communication::sensors::imu::bmi088
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BMI088_DATA_READY_DMA_HPP_
+#define TAPROOT_BMI088_DATA_READY_DMA_HPP_
+
+#include <cstdint>
+
+#include "bmi088_data.hpp"
+
+namespace tap::communication::sensors::imu::bmi088
+{
+/**
+ * Reads the bmi088 without blocking the main loop. The accelerometer's INT1 and the gyroscope's
+ * INT3 pins are configured to pulse when a new sample is ready. Each pulse triggers an external
+ * interrupt that timestamps the sample and starts an SPI DMA transfer of the sensor's data
+ * registers into the back half of a double buffer. When the transfer completes, the halves are
+ * swapped so that `getLatestSample` always copies the newest complete sample. If both sensors
+ * have data ready at once, the transfers are chained, the second starting from the DMA transfer
+ * complete interrupt of the first.
+ *
+ * Uses SPI1 with DMA2 stream 0 (receive) and stream 3 (transmit), which don't conflict with the
+ * streams used by UART ports that receive using DMA.
+ *
+ * On hosted builds there is no DMA, so transfers are performed immediately through `Bmi088Hal`.
+ */
+class Bmi088DataReadyDma
+{
+public:
+    /// The accelerometer burst read, from ACC_X_LSB to TEMP_LSB so the temperature is included.
+    static constexpr uint8_t ACC_DATA_LENGTH =
+        Bmi088Data::Acc::TEMP_LSB - Bmi088Data::Acc::ACC_X_LSB + 1;
+    /// The address byte and the dummy byte the accelerometer sends before data.
+    static constexpr uint8_t ACC_DATA_OFFSET = 2;
+    static constexpr uint8_t ACC_TRANSFER_LENGTH = ACC_DATA_OFFSET + ACC_DATA_LENGTH;
+
+    /// The gyroscope burst read, RATE_X_LSB to RATE_Z_MSB.
+    static constexpr uint8_t GYRO_DATA_LENGTH = 6;
+    /// The address byte.
+    static constexpr uint8_t GYRO_DATA_OFFSET = 1;
+    static constexpr uint8_t GYRO_TRANSFER_LENGTH = GYRO_DATA_OFFSET + GYRO_DATA_LENGTH;
+
+    /// Priority of the external and DMA interrupts.
+    static constexpr uint32_t INTERRUPT_PRIORITY = 5;
+
+    /**
+     * How long `pauseTransfers` waits for the transfer in progress. A transfer takes tens of
+     * microseconds, so one still in progress after this has stalled.
+     */
+    static constexpr uint32_t PAUSE_TIMEOUT_US = 1'000;
+
+    struct Sample
+    {
+        /// Raw accelerometer registers, starting at ACC_X_LSB.
+        uint8_t accData[ACC_DATA_LENGTH];
+        /// Raw gyroscope registers, starting at RATE_X_LSB.
+        uint8_t gyroData[GYRO_DATA_LENGTH];
+        /// Time the accelerometer signaled its data was ready, in microseconds.
+        uint32_t accTime;
+        /// Time the gyroscope signaled its data was ready, in microseconds.
+        uint32_t gyroTime;
+    };
+
+    /// Called with `context` from the DMA interrupt each time a gyroscope sample is transferred.
+    using SampleCallback = void (*)(void *context);
+
+    /**
+     * Configures the external interrupts of the data ready pins and the SPI DMA streams. The
+     * bmi088's interrupt pins must already be configured and SPI1 initialized.
+     */
+    static void initialize();
+
+    /**
+     * Copies the newest complete sample of each sensor into `sample`.
+     *
+     * @return `true` if either sensor has a sample that has not been returned before.
+     */
+    static bool getLatestSample(Sample *sample);
+
+    /**
+     * Copies the newest complete sample of each sensor into `sample` like `getLatestSample`, but
+     * doesn't mark the samples as returned, so a sample callback can read the sample without
+     * hiding it from `getLatestSample`.
+     */
+    static void peekLatestSample(Sample *sample);
+
+    /**
+     * Sets the function called each time a gyroscope sample has been transferred, or removes it
+     * if `callback` is `nullptr`. The callback is called from the DMA transfer complete
+     * interrupt, at `INTERRUPT_PRIORITY`, after the next transfer has been started, so it may
+     * preempt the main loop but doesn't delay reading the sensors.
+     */
+    static void setGyroSampleCallback(SampleCallback callback, void *context);
+
+    /**
+     * Stops starting transfers and waits for the transfer in progress, if any, to complete, so
+     * the bmi088 can be accessed through `Bmi088Hal` from the main loop. Data ready interrupts
+     * are still timestamped, and the newest sample of each sensor is transferred by
+     * `resumeTransfers`.
+     *
+     * @return `false` if the transfer in progress didn't complete within `PAUSE_TIMEOUT_US`, in
+     *      which case transfers are resumed and the bmi088 must not be accessed.
+     */
+    static bool pauseTransfers();
+
+    /// Undoes `pauseTransfers`, starting the transfers that became pending while paused.
+    static void resumeTransfers();
+
+    /// Called by the accelerometer's data ready interrupt.
+    static void onAccDataReady(uint32_t time);
+
+    /// Called by the gyroscope's data ready interrupt.
+    static void onGyroDataReady(uint32_t time);
+
+    /// Called by the SPI receive DMA stream's transfer complete interrupt.
+    static void onTransferComplete();
+
+#if defined(ENV_UNIT_TESTS)
+    /// Clears all samples, pending transfers, and the sample callback.
+    static void reset();
+#endif
+
+private:
+    enum class Transfer : uint8_t
+    {
+        NONE,
+        ACC,
+        GYRO,
+    };
+
+    struct SensorBuffers
+    {
+        uint8_t buffers[2][ACC_TRANSFER_LENGTH];
+        uint32_t times[2];
+        /// Index of the buffer holding the newest complete sample.
+        uint8_t front;
+        /// Time of the most recent data ready interrupt that has no transfer started for it.
+        uint32_t pendingTime;
+        /// Time of the data ready interrupt that the transfer in progress belongs to.
+        uint32_t transferTime;
+        bool pending;
+        /// `true` if the front buffer has not been returned by `getLatestSample`.
+        bool fresh;
+    };
+
+    static SensorBuffers acc;
+    static SensorBuffers gyro;
+
+    static Transfer currentTransfer;
+    static bool paused;
+
+    static SampleCallback gyroSampleCallback;
+    static void *gyroSampleCallbackContext;
+
+    /**
+     * Starts the pending transfer, with the gyroscope first, unless paused. Must be called from
+     * an interrupt or with interrupts disabled.
+     */
+    static void startNextTransfer();
+
+    static void startTransfer(Transfer transfer);
+};
+
+}  // namespace tap::communication::sensors::imu::bmi088
+
+#endif  // TAPROOT_BMI088_DATA_READY_DMA_HPP_
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bmi088_triggered_loop.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+namespace tap::communication::sensors::imu::bmi088
+{
+Bmi088TriggeredLoop *Bmi088TriggeredLoop::running = nullptr;
+
+Bmi088TriggeredLoop::Bmi088TriggeredLoop(
+    tap::motor::DjiMotorTxHandler &txHandler,
+    can::CanBus bus,
+    tap::motor::DjiMotorTxHandler::TxGroup group,
+    InnerLoop innerLoop,
+    void *context)
+    : txHandler(txHandler),
+      bus(bus),
+      group(group),
+      innerLoop(innerLoop),
+      context(context)
+{
+}
+
+Bmi088TriggeredLoop::~Bmi088TriggeredLoop() { stop(); }
+
+void Bmi088TriggeredLoop::start()
+{
+    if (running != nullptr)
+    {
+        running->stop();
+    }
+    txHandler.setTxGroupReserved(bus, group, true);
+    running = this;
+    Bmi088DataReadyDma::setGyroSampleCallback(onGyroSample, this);
+}
+
+void Bmi088TriggeredLoop::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    // Unregister first so the interrupt can't flush the group once the main loop sends it again
+    Bmi088DataReadyDma::setGyroSampleCallback(nullptr, nullptr);
+    running = nullptr;
+    txHandler.setTxGroupReserved(bus, group, false);
+}
+
+void Bmi088TriggeredLoop::run()
+{
+    Bmi088DataReadyDma::Sample sample;
+    Bmi088DataReadyDma::peekLatestSample(&sample);
+
+    innerLoop(sample, context);
+    runCount++;
+
+    if (!txHandler.flushTxGroup(bus, group))
+    {
+        flushFailures++;
+        return;
+    }
+
+    latency = tap::arch::clock::getTimeMicroseconds() - sample.gyroTime;
+    latencyHistogram.record(latency);
+}
+
+void Bmi088TriggeredLoop::onGyroSample(void *context)
+{
+    static_cast<Bmi088TriggeredLoop *>(context)->run();
+}
+}  // namespace tap::communication::sensors::imu::bmi088
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BMI088_TRIGGERED_LOOP_HPP_
+#define TAPROOT_BMI088_TRIGGERED_LOOP_HPP_
+
+#include <cstdint>
+
+#include "tap/architecture/latency_histogram.hpp"
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/motor/dji_motor_tx_handler.hpp"
+#include "tap/util_macros.hpp"
+
+#include "bmi088_data_ready_dma.hpp"
+
+namespace tap::communication::sensors::imu::bmi088
+{
+/**
+ * Runs a control loop, such as a turret's stabilization loop, on every new gyroscope sample and
+ * sends the commands of its motors right away, rather than waiting for the main loop to read the
+ * IMU, run the scheduler and send motor commands.
+ *
+ * While running, the loop is called from the `Bmi088DataReadyDma` transfer complete interrupt
+ * with the newest sample. It should compute the outputs of its motors and set them with
+ * `DjiMotor::setDesiredOutput`, after which the loop's CAN frame is sent with
+ * `DjiMotorTxHandler::flushTxGroup`. The frame's group is reserved while the loop is running, so
+ * `encodeAndSendCanData` doesn't send it, and the rest of the motors and the scheduler run at
+ * their normal rate. For example:
+ *
+ * ```cpp
+ * void turretInnerLoop(const Bmi088DataReadyDma::Sample &sample, void *context)
+ * {
+ *     static_cast<TurretSubsystem *>(context)->runRateLoop(sample);
+ * }
+ *
+ * Bmi088TriggeredLoop fastPath(
+ *     drivers->djiMotorTxHandler,
+ *     tap::can::CanBus::CAN_BUS1,
+ *     DjiMotorTxHandler::TX_GROUP_HIGH,
+ *     turretInnerLoop,
+ *     &turret);
+ *
+ * fastPath.start();
+ * ```
+ *
+ * The IMU must be read in `Bmi088::ReadMode::DATA_READY_DMA`. The loop runs at
+ * `Bmi088DataReadyDma::INTERRUPT_PRIORITY` and preempts the main loop, so it must be short and
+ * must only share state with the main loop through data that is safe to access from an
+ * interrupt (for a set of subsystems, see `SchedulerPartition`). Only one loop can be running at
+ * a time, starting another one stops the previous one.
+ *
+ * Since the frame is sent from the interrupt, every other sender on the loop's bus must go
+ * through `Can::sendMessage`, which queues frames with interrupts disabled, and must not keep
+ * state across a call to it that assumes the mailboxes didn't change (e.g. a result of
+ * `Can::isReadyToSend`, a busy bus only makes `sendMessage` return false). Code that writes the
+ * CAN peripheral directly, bypassing `Can`, must not run while the loop is running.
+ */
+class Bmi088TriggeredLoop
+{
+public:
+    /// Called with the newest IMU sample and the loop's context.
+    using InnerLoop = void (*)(const Bmi088DataReadyDma::Sample &sample, void *context);
+
+    /**
+     * @param[in] txHandler The handler that sends the frame of the loop's motors.
+     * @param[in] bus The bus the loop's motors are on.
+     * @param[in] group The group whose frame holds the outputs of the loop's motors. Motors of
+     *      the same group that aren't controlled by the loop are sent with the same frame.
+     * @param[in] innerLoop Called on every gyroscope sample while the loop is running.
+     * @param[in] context Passed to `innerLoop`.
+     */
+    Bmi088TriggeredLoop(
+        tap::motor::DjiMotorTxHandler &txHandler,
+        can::CanBus bus,
+        tap::motor::DjiMotorTxHandler::TxGroup group,
+        InnerLoop innerLoop,
+        void *context = nullptr);
+    DISALLOW_COPY_AND_ASSIGN(Bmi088TriggeredLoop)
+    ~Bmi088TriggeredLoop();
+
+    /// Reserves the loop's group and runs the loop on every gyroscope sample from now on.
+    void start();
+
+    /// Stops running the loop and releases its group, so the main loop sends it again.
+    void stop();
+
+    bool isRunning() const { return running == this; }
+
+    /**
+     * Runs the inner loop on the newest sample and sends the loop's frame. Called from the
+     * sample interrupt while the loop is running.
+     */
+    void run();
+
+    /// @return The number of times the inner loop has run.
+    uint32_t getRunCount() const { return runCount; }
+
+    /// @return The number of times the frame couldn't be sent because the bus was busy.
+    uint32_t getFlushFailures() const { return flushFailures; }
+
+    /**
+     * @return The time from when the gyroscope signaled its most recent sample was ready to when
+     *      the frame computed from it was sent, in microseconds.
+     */
+    uint32_t getLatency() const { return latency; }
+
+    /// @return A histogram of every latency measured by `run`.
+    const arch::LatencyHistogram &getLatencyHistogram() const { return latencyHistogram; }
+
+private:
+    /// The loop whose callback is registered with `Bmi088DataReadyDma`.
+    static Bmi088TriggeredLoop *running;
+
+    tap::motor::DjiMotorTxHandler &txHandler;
+    const can::CanBus bus;
+    const tap::motor::DjiMotorTxHandler::TxGroup group;
+    const InnerLoop innerLoop;
+    void *const context;
+
+    uint32_t runCount = 0;
+    uint32_t flushFailures = 0;
+    uint32_t latency = 0;
+    arch::LatencyHistogram latencyHistogram;
+
+    static void onGyroSample(void *context);
+};
+}  // namespace tap::communication::sensors::imu::bmi088
+
+#endif  // TAPROOT_BMI088_TRIGGERED_LOOP_HPP_
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_IMU_DIAGNOSTICS_HPP_
+#define TAPROOT_IMU_DIAGNOSTICS_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+#include "tap/architecture/trace_ring.hpp"
+
+namespace tap::communication::sensors::imu
+{
+/**
+ * Health and timing counters of an IMU driver: how many samples were read, how many were lost,
+ * how many reads returned data that looks like a bus fault, how long reads take, and the rate
+ * samples actually arrive at. Drivers update the counters from their read path, which only adds
+ * a few comparisons per sample.
+ *
+ * All times are in microseconds, as returned by `tap::arch::clock::getTimeMicroseconds`.
+ */
+class ImuDiagnostics
+{
+public:
+    /// The length of the window the sample rate is measured over.
+    static constexpr uint32_t SAMPLE_RATE_WINDOW = 1'000'000;
+
+    /**
+     * Sets the rate single samples are expected at, used to detect dropped samples. 0 disables
+     * the detection, such as when samples are read in batches from a FIFO.
+     */
+    void setExpectedSampleFrequency(float frequency)
+    {
+        expectedPeriod = frequency > 0 ? 1E6f / frequency : 0;
+    }
+
+    /**
+     * Records `count` samples read at `time`. If `count` is 1 and an expected sample frequency
+     * is set, a gap of more than 1.5 periods since the last sample counts the samples that should
+     * have arrived in between as dropped.
+     */
+    void recordSamples(uint32_t time, uint32_t count = 1)
+    {
+        TRACE_EVENT(tap::arch::TraceEventId::IMU_SAMPLE, count);
+        if (sampleCount > 0 && count == 1 && expectedPeriod > 0)
+        {
+            const float gap = static_cast<int32_t>(time - lastSampleTime);
+            if (gap > 1.5f * expectedPeriod)
+            {
+                droppedSampleCount += static_cast<uint32_t>(lroundf(gap / expectedPeriod)) - 1;
+            }
+        }
+
+        if (sampleCount == 0)
+        {
+            windowStart = time;
+        }
+        else
+        {
+            windowSampleCount += count;
+            const uint32_t elapsed = time - windowStart;
+            if (elapsed >= SAMPLE_RATE_WINDOW)
+            {
+                sampleFrequency = windowSampleCount * 1E6f / elapsed;
+                windowStart = time;
+                windowSampleCount = 0;
+            }
+        }
+
+        sampleCount += count;
+        lastSampleTime = time;
+    }
+
+    /// Records `count` samples the sensor reported as lost, such as by a FIFO overrun.
+    void recordDroppedSamples(uint32_t count) { droppedSampleCount += count; }
+
+    /// Records a transfer that failed or returned data that can only come from a bus fault.
+    void recordSpiError() { spiErrorCount++; }
+
+    /// Records how long reading a sample took.
+    void recordReadTime(uint32_t duration)
+    {
+        lastReadTime = duration;
+        if (duration > maxReadTime)
+        {
+            maxReadTime = duration;
+        }
+    }
+
+    /// Clears the maximum read time, to measure it over a new period.
+    void resetMaxReadTime() { maxReadTime = 0; }
+
+    /// Clears every counter. The expected sample frequency is kept.
+    void reset()
+    {
+        const float period = expectedPeriod;
+        *this = ImuDiagnostics();
+        expectedPeriod = period;
+    }
+
+    /**
+     * Checks whether data read from a sensor is all 0x00 or all 0xFF, which a floating or shorted
+     * MISO line or a sensor that reset after a brownout returns. Only meaningful for data that
+     * can't legitimately be constant, such as accelerometer readings, which always see gravity.
+     */
+    static bool looksLikeBusFault(const uint8_t *data, int length)
+    {
+        if (length <= 0 || (data[0] != 0x00 && data[0] != 0xFF))
+        {
+            return false;
+        }
+        for (int i = 1; i < length; i++)
+        {
+            if (data[i] != data[0])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t getSampleCount() const { return sampleCount; }
+
+    uint32_t getDroppedSampleCount() const { return droppedSampleCount; }
+
+    uint32_t getSpiErrorCount() const { return spiErrorCount; }
+
+    uint32_t getMaxReadTime() const { return maxReadTime; }
+
+    uint32_t getLastReadTime() const { return lastReadTime; }
+
+    /// @return The rate samples were read at over the last complete window, in Hz.
+    float getSampleFrequency() const { return sampleFrequency; }
+
+    uint32_t getLastSampleTime() const { return lastSampleTime; }
+
+    /// @return The time since the last sample at `now`, or `UINT32_MAX` if there were none.
+    uint32_t getLastSampleAge(uint32_t now) const
+    {
+        return sampleCount == 0 ? UINT32_MAX : now - lastSampleTime;
+    }
+
+private:
+    float expectedPeriod = 0;
+
+    uint32_t sampleCount = 0;
+    uint32_t droppedSampleCount = 0;
+    uint32_t spiErrorCount = 0;
+    uint32_t maxReadTime = 0;
+    uint32_t lastReadTime = 0;
+    uint32_t lastSampleTime = 0;
+
+    uint32_t windowStart = 0;
+    uint32_t windowSampleCount = 0;
+    float sampleFrequency = 0;
+};  // class ImuDiagnostics
+
+}  // namespace tap::communication::sensors::imu
+
+#endif  // TAPROOT_IMU_DIAGNOSTICS_HPP_
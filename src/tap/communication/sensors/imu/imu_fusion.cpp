@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imu_fusion.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+using namespace tap::algorithms::transforms;
+
+namespace tap::communication::sensors::imu
+{
+int ImuFusion::addSource(ImuInterface *imu, const Transform &mount, float weight)
+{
+    if (numSources >= MAX_SOURCES || imu == nullptr)
+    {
+        return -1;
+    }
+
+    Source &source = sources[numSources];
+    source = Source();
+    source.imu = imu;
+    source.rotation = mount.getRotation().matrix();
+    source.weight = weight;
+    return numSources++;
+}
+
+void ImuFusion::updateMount(int source, const Orientation &rotation, const float (&relativeRate)[3])
+{
+    if (source < 0 || source >= numSources)
+    {
+        return;
+    }
+
+    sources[source].rotation = rotation.matrix();
+    for (int i = 0; i < 3; i++)
+    {
+        sources[source].relativeRate[i] = relativeRate[i];
+    }
+}
+
+void ImuFusion::initialize(float sampleFrequency, float mahonyKp, float mahonyKi)
+{
+    mahonyAlgorithm.begin(sampleFrequency, mahonyKp, mahonyKi);
+    attitudeEstimator->setSampleFrequency(sampleFrequency);
+}
+
+void ImuFusion::readSource(Source &source)
+{
+    const uint32_t time = source.imu->getPrevIMUDataReceivedTime();
+    if (source.numSamples > 0 && time == source.latest.time)
+    {
+        return;
+    }
+
+    const float gyro[3] = {
+        source.imu->getGx() - source.relativeRate[0],
+        source.imu->getGy() - source.relativeRate[1],
+        source.imu->getGz() - source.relativeRate[2],
+    };
+    const float acc[3] = {source.imu->getAx(), source.imu->getAy(), source.imu->getAz()};
+
+    source.previous = source.latest;
+    source.latest.time = time;
+    for (int i = 0; i < 3; i++)
+    {
+        const float *row = &source.rotation.data[i * 3];
+        source.latest.gyro[i] = row[0] * gyro[0] + row[1] * gyro[1] + row[2] * gyro[2];
+        source.latest.acc[i] = row[0] * acc[0] + row[1] * acc[1] + row[2] * acc[2];
+    }
+    if (source.numSamples < 2)
+    {
+        source.numSamples++;
+    }
+}
+
+void ImuFusion::interpolate(const Source &source, uint32_t time, Sample &sample)
+{
+    // Differences of unsigned times are taken as signed so they survive the clock wrapping.
+    const int32_t span = static_cast<int32_t>(source.latest.time - source.previous.time);
+    const int32_t elapsed = static_cast<int32_t>(time - source.previous.time);
+    if (source.numSamples < 2 || span <= 0 || elapsed >= span)
+    {
+        sample = source.latest;
+        return;
+    }
+    if (elapsed <= 0)
+    {
+        sample = source.previous;
+        return;
+    }
+
+    const float t = static_cast<float>(elapsed) / span;
+    const Sample &a = source.previous;
+    const Sample &b = source.latest;
+    sample.time = time;
+    for (int i = 0; i < 3; i++)
+    {
+        sample.gyro[i] = a.gyro[i] + t * (b.gyro[i] - a.gyro[i]);
+        sample.acc[i] = a.acc[i] + t * (b.acc[i] - a.acc[i]);
+    }
+}
+
+bool ImuFusion::update()
+{
+    const uint32_t now = tap::arch::clock::getTimeMicroseconds();
+
+    // The latest time every active source has a sample for.
+    bool active[MAX_SOURCES] = {};
+    bool anyActive = false;
+    uint32_t alignedTime = 0;
+    for (int i = 0; i < numSources; i++)
+    {
+        readSource(sources[i]);
+        active[i] = sources[i].numSamples > 0 &&
+                    static_cast<int32_t>(now - sources[i].latest.time) <=
+                        static_cast<int32_t>(STALE_TIMEOUT_US);
+        if (active[i] &&
+            (!anyActive || static_cast<int32_t>(sources[i].latest.time - alignedTime) < 0))
+        {
+            alignedTime = sources[i].latest.time;
+        }
+        anyActive = anyActive || active[i];
+    }
+
+    numActiveSources = 0;
+    if (!anyActive)
+    {
+        return false;
+    }
+
+    float weightSum = 0;
+    float gyro[3] = {};
+    float acc[3] = {};
+    for (int i = 0; i < numSources; i++)
+    {
+        if (!active[i])
+        {
+            continue;
+        }
+
+        Sample sample;
+        interpolate(sources[i], alignedTime, sample);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            gyro[axis] += sources[i].weight * sample.gyro[axis];
+            acc[axis] += sources[i].weight * sample.acc[axis];
+        }
+        weightSum += sources[i].weight;
+        numActiveSources++;
+    }
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        fusedGyro[axis] = gyro[axis] / weightSum;
+        fusedAcc[axis] = acc[axis] / weightSum;
+    }
+
+    attitudeEstimator->updateIMU(
+        fusedGyro[0],
+        fusedGyro[1],
+        fusedGyro[2],
+        fusedAcc[0],
+        fusedAcc[1],
+        fusedAcc[2]);
+    return true;
+}
+
+Orientation ImuFusion::getOrientation(int source) const
+{
+    tap::algorithms::CMSISMat<3, 3> earthFromFusion = attitudeEstimator->getRotationMatrix();
+    if (source < 0 || source >= numSources)
+    {
+        return Orientation(std::move(earthFromFusion));
+    }
+    return Orientation(earthFromFusion * sources[source].rotation);
+}
+
+}  // namespace tap::communication::sensors::imu
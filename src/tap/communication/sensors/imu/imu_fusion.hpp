@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_IMU_FUSION_HPP_
+#define TAPROOT_IMU_FUSION_HPP_
+
+#include <cstdint>
+
+#include "tap/algorithms/MahonyAHRS.h"
+#include "tap/algorithms/attitude_estimator.hpp"
+#include "tap/algorithms/cmsis_mat.hpp"
+#include "tap/algorithms/transforms/orientation.hpp"
+#include "tap/algorithms/transforms/transform.hpp"
+
+#include "imu_interface.hpp"
+
+namespace tap::communication::sensors::imu
+{
+/**
+ * Runs a single attitude estimator on the samples of several IMUs, for example the board's
+ * `Bmi088` and an external IMU on the turret, so every attitude derived from it is consistent
+ * and the filter only runs once.
+ *
+ * Each source is an `ImuInterface` and a mounting `Transform` from the fusion frame (usually the
+ * chassis) to the IMU's frame. Only the rotation of the mount is used. On each `update`, the
+ * samples of every source are interpolated to a common time, the latest time all sources have
+ * a sample for, using `ImuInterface::getPrevIMUDataReceivedTime`. They are then rotated into the
+ * fusion frame and averaged by weight. Sources without a new sample for `STALE_TIMEOUT_US`
+ * are left out until they produce samples again.
+ *
+ * A source that moves relative to the fusion frame, such as an IMU on a turret, must have its
+ * mount updated with `updateMount` before each `update`. That includes the angular velocity of
+ * the turret relative to the chassis, usually from the yaw motor, which is subtracted from the
+ * source's gyroscope. The acceleration from the lever arm between IMUs is ignored.
+ *
+ * Each source's `ImuInterface` still runs its own estimator. Read attitudes from here instead.
+ */
+class ImuFusion
+{
+public:
+    static constexpr int MAX_SOURCES = 4;
+
+    /// Sources without a new sample for this long are not fused, in microseconds.
+    static constexpr uint32_t STALE_TIMEOUT_US = 20'000;
+
+    ImuFusion() = default;
+
+    /**
+     * Adds a source.
+     *
+     * @param[in] imu The IMU, which must outlive this object.
+     * @param[in] mount The transform from the fusion frame to the IMU's frame.
+     * @param[in] weight Relative weight of the source's samples, for example higher for a
+     *      lower noise IMU.
+     * @return The index of the source, or -1 if there are already `MAX_SOURCES` sources.
+     */
+    int addSource(
+        ImuInterface *imu,
+        const tap::algorithms::transforms::Transform &mount,
+        float weight = 1.0f);
+
+    /**
+     * Updates the mounting rotation of a source that moves relative to the fusion frame.
+     *
+     * @param[in] source The index returned by `addSource`.
+     * @param[in] rotation The IMU frame's orientation relative to the fusion frame.
+     * @param[in] relativeRate The angular velocity of the IMU frame relative to the fusion frame,
+     *      in the IMU frame, in degrees / second.
+     */
+    void updateMount(
+        int source,
+        const tap::algorithms::transforms::Orientation &rotation,
+        const float (&relativeRate)[3]);
+
+    /**
+     * Initializes the attitude estimator.
+     *
+     * @param[in] sampleFrequency The frequency `update` is called at, in Hz.
+     */
+    void initialize(float sampleFrequency, float mahonyKp, float mahonyKi);
+
+    /**
+     * Fuses the latest samples of all sources and runs the attitude estimator. Call at the
+     * frequency passed to `initialize`.
+     *
+     * @return `false` if no source has a recent sample, in which case the estimator isn't run.
+     */
+    bool update();
+
+    /// Replaces the mahony algorithm, with the same rules as `Bmi088::setAttitudeEstimator`.
+    inline void setAttitudeEstimator(tap::algorithms::AttitudeEstimator *estimator)
+    {
+        attitudeEstimator = estimator != nullptr ? estimator : &mahonyAlgorithm;
+    }
+
+    inline tap::algorithms::AttitudeEstimator &getAttitudeEstimator() { return *attitudeEstimator; }
+
+    /// @return Roll of the fusion frame, in degrees.
+    inline float getRoll() { return attitudeEstimator->getRoll(); }
+
+    /// @return Pitch of the fusion frame, in degrees.
+    inline float getPitch() { return attitudeEstimator->getPitch(); }
+
+    /// @return Yaw of the fusion frame, in degrees.
+    inline float getYaw() { return attitudeEstimator->getYaw(); }
+
+    /**
+     * @return The orientation of a source's frame relative to the earth frame, for example the
+     *      turret's attitude when the source is the turret IMU.
+     */
+    tap::algorithms::transforms::Orientation getOrientation(int source) const;
+
+    /// Copies the fused angular velocity in the fusion frame into `gyro`, in degrees / second.
+    inline void getGyro(float (&gyro)[3]) const
+    {
+        gyro[0] = fusedGyro[0];
+        gyro[1] = fusedGyro[1];
+        gyro[2] = fusedGyro[2];
+    }
+
+    /// @return The number of sources fused in the last `update`.
+    inline int getNumActiveSources() const { return numActiveSources; }
+
+    inline int getNumSources() const { return numSources; }
+
+private:
+    struct Sample
+    {
+        uint32_t time = 0;
+        /// Angular velocity in the fusion frame, in degrees / second.
+        float gyro[3] = {};
+        /// Acceleration in the fusion frame, in m/s^2.
+        float acc[3] = {};
+    };
+
+    struct Source
+    {
+        ImuInterface *imu = nullptr;
+        /// Rotation from the IMU frame to the fusion frame.
+        tap::algorithms::CMSISMat<3, 3> rotation;
+        /// Angular velocity of the IMU relative to the fusion frame, in the IMU frame.
+        float relativeRate[3] = {};
+        float weight = 1.0f;
+        Sample previous;
+        Sample latest;
+        /// The number of samples read, capped at 2.
+        uint8_t numSamples = 0;
+    };
+
+    Source sources[MAX_SOURCES];
+    int numSources = 0;
+    int numActiveSources = 0;
+
+    Mahony mahonyAlgorithm;
+
+    tap::algorithms::AttitudeEstimator *attitudeEstimator = &mahonyAlgorithm;
+
+    float fusedGyro[3] = {};
+    float fusedAcc[3] = {};
+
+    /// Reads a new sample from `source` if there is one, rotated into the fusion frame.
+    void readSource(Source &source);
+
+    /// Computes `source`'s sample at `time`, interpolating between its last two samples.
+    static void interpolate(const Source &source, uint32_t time, Sample &sample);
+};  // class ImuFusion
+
+}  // namespace tap::communication::sensors::imu
+
+#endif  // TAPROOT_IMU_FUSION_HPP_
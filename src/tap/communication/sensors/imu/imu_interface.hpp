@@ -20,8 +20,12 @@
 #ifndef TAPROOT_IMU_INTERFACE_HPP_
 #define TAPROOT_IMU_INTERFACE_HPP_
 
+#include <cstdint>
+
 namespace tap::communication::sensors::imu
 {
+class ImuDiagnostics;
+
 /**
  * An interface for interacting with a 6 axis IMU.
  */
@@ -89,6 +93,17 @@ class ImuInterface
      */
     virtual inline float getTemp() = 0;
 
+    /**
+     * Returns the time the latest sample was received, in microseconds, as returned by
+     * `tap::arch::clock::getTimeMicroseconds`.
+     */
+    virtual inline uint32_t getPrevIMUDataReceivedTime() const = 0;
+
+    /**
+     * Returns the driver's health and timing counters, or `nullptr` if it doesn't keep any.
+     */
+    virtual inline const ImuDiagnostics *getDiagnostics() const { return nullptr; }
+
     /**
      * Returns yaw angle. in degrees.
      */
@@ -19,6 +19,10 @@
 
 #include "imu_menu.hpp"
 
+#include "tap/architecture/clock.hpp"
+
+#include "imu_diagnostics.hpp"
+
 namespace tap::communication::sensors::imu
 {
 ImuMenu::ImuMenu(
@@ -45,6 +49,13 @@ void ImuMenu::draw()
     display.clear();
     display.setCursor(0, 2);
     display << getMenuName() << modm::endl;
+    pageChanged = false;
+
+    if (showDiagnostics)
+    {
+        drawDiagnostics(display);
+        return;
+    }
 
     // print row headers and temperature
     display.printf("\nAcc\nGyro\nAng\nTemp:  %.2f", static_cast<double>(imu->getTemp()));
@@ -70,9 +81,21 @@ void ImuMenu::draw()
     }
 }
 
+void ImuMenu::drawDiagnostics(modm::GraphicDisplay &display)
+{
+    const ImuDiagnostics *diagnostics = imu->getDiagnostics();
+    display << "\nSamples: " << diagnostics->getSampleCount();
+    display << "\nDropped: " << diagnostics->getDroppedSampleCount();
+    display << "\nSPI err: " << diagnostics->getSpiErrorCount();
+    display << "\nMax read: " << diagnostics->getMaxReadTime() << " us";
+    display.printf("\nODR: %.1f Hz", static_cast<double>(diagnostics->getSampleFrequency()));
+    display << "\nAge: " << diagnostics->getLastSampleAge(tap::arch::clock::getTimeMicroseconds())
+            << " us";
+}
+
 void ImuMenu::update() {}
 
-bool ImuMenu::hasChanged() { return imuUpdateTimer.execute(); }
+bool ImuMenu::hasChanged() { return imuUpdateTimer.execute() || pageChanged; }
 
 void ImuMenu::shortButtonPress(modm::MenuButtons::Button button)
 {
@@ -81,6 +104,11 @@ void ImuMenu::shortButtonPress(modm::MenuButtons::Button button)
     {
         this->remove();
     }
+    else if (button == modm::MenuButtons::Button::RIGHT && imu->getDiagnostics() != nullptr)
+    {
+        showDiagnostics = !showDiagnostics;
+        pageChanged = true;
+    }
 }
 
 const char *ImuMenu::getMenuName() { return imu->getName(); }
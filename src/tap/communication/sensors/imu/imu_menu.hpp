@@ -30,7 +30,8 @@
 namespace tap::communication::sensors::imu
 {
 /**
- * Menu that displays IMU readings from some particular `ImuInterface`.
+ * Menu that displays IMU readings from some particular `ImuInterface`. If the IMU keeps
+ * diagnostics, pressing right switches between the readings and the diagnostics.
  */
 class ImuMenu : public modm::AbstractMenu<display::DummyAllocator<modm::IAbstractView> >
 {
@@ -73,6 +74,13 @@ class ImuMenu : public modm::AbstractMenu<display::DummyAllocator<modm::IAbstrac
     tap::arch::PeriodicMilliTimer imuUpdateTimer{IMU_UPDATE_TIME};
 
     ImuInterfaceFnPtr imuAccelGyroAngleFnPtrs[3][3];
+
+    bool showDiagnostics = false;
+
+    /// `true` if the page was switched and has not been drawn since.
+    bool pageChanged = false;
+
+    void drawDiagnostics(modm::GraphicDisplay &display);
 };
 }  // namespace tap::communication::sensors::imu
 
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "imu_sim.hpp"
+
+#include <cmath>
+
+#include "tap/architecture/clock.hpp"
+
+using tap::motor::motorsim::RigidBodySim;
+
+namespace tap::communication::sensors::imu
+{
+static constexpr float RAD_TO_DEG = 180.0f / static_cast<float>(M_PI);
+
+ImuSim::ImuSim(const RigidBodySim &body, const Config &config)
+    : body(body),
+      config(config),
+      generator(config.seed)
+{
+}
+
+void ImuSim::update()
+{
+    for (int axis = 0; axis < RigidBodySim::NUM_AXES; axis++)
+    {
+        const RigidBodySim::Axis bodyAxis = static_cast<RigidBodySim::Axis>(axis);
+        gyro[axis] = body.getAngularVelocity(bodyAxis) * RAD_TO_DEG + config.gyroBias[axis] +
+                     config.gyroNoise * normal(generator);
+        accel[axis] = body.getSpecificForce(bodyAxis) + config.accelNoise * normal(generator);
+    }
+
+    yaw = fmodf(body.getYaw() * RAD_TO_DEG, 360.0f);
+    if (yaw < 0)
+    {
+        yaw += 360.0f;
+    }
+    pitch = body.getPitch() * RAD_TO_DEG;
+    roll = body.getRoll() * RAD_TO_DEG;
+
+    prevUpdateTime = tap::arch::clock::getTimeMicroseconds();
+}
+}  // namespace tap::communication::sensors::imu
+
+#endif  // PLATFORM_HOSTED
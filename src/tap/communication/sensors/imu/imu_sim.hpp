@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_IMU_SIM_HPP_
+#define TAPROOT_IMU_SIM_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstdint>
+#include <random>
+
+#include "tap/motor/motorsim/rigid_body_sim.hpp"
+
+#include "imu_interface.hpp"
+
+namespace tap::communication::sensors::imu
+{
+/**
+ * A simulated 6 axis IMU fixed to a `motor::motorsim::RigidBodySim`, to stand in for the `Bmi088`
+ * or `Mpu6500` on hosted builds so that attitude control can be run in closed loop. Each `update`
+ * samples the body's angular velocity and specific force and adds gaussian noise and a constant
+ * gyroscope bias to them. The angles reported are the body's true angles, as if from an ideal
+ * attitude estimator.
+ *
+ * The noise is drawn from a generator seeded by the config, so a simulation gives the same
+ * readings every time it is run.
+ */
+class ImuSim : public ImuInterface
+{
+public:
+    struct Config
+    {
+        float gyroNoise;   ///< Standard deviation of the gyroscope noise, degrees/second
+        float accelNoise;  ///< Standard deviation of the accelerometer noise, m/s^2
+        float gyroBias[motor::motorsim::RigidBodySim::NUM_AXES];  ///< degrees/second
+        float temperature;  ///< Degrees C
+        uint32_t seed;      ///< Seed of the noise generator
+    };
+
+    /// Approximate noise of a BMI088 sampled at 1 kHz.
+    static constexpr Config BMI088_CONFIG = {
+        .gyroNoise = 0.1f,
+        .accelNoise = 0.02f,
+        .gyroBias = {},
+        .temperature = 40,
+        .seed = 0,
+    };
+
+    /// No noise or bias, for tests that need exact readings.
+    static constexpr Config IDEAL_CONFIG = {
+        .gyroNoise = 0,
+        .accelNoise = 0,
+        .gyroBias = {},
+        .temperature = 40,
+        .seed = 0,
+    };
+
+    /**
+     * @param[in] body The body the IMU is fixed to. Must outlive the IMU.
+     */
+    explicit ImuSim(
+        const motor::motorsim::RigidBodySim &body,
+        const Config &config = BMI088_CONFIG);
+
+    /**
+     * Samples the body. Call after stepping the body, at the rate of the IMU being simulated.
+     * Readings are 0 until the first update.
+     */
+    void update();
+
+    inline const char *getName() const override { return "imu sim"; }
+
+    inline float getAx() override { return accel[motor::motorsim::RigidBodySim::X]; }
+    inline float getAy() override { return accel[motor::motorsim::RigidBodySim::Y]; }
+    inline float getAz() override { return accel[motor::motorsim::RigidBodySim::Z]; }
+
+    inline float getGx() override { return gyro[motor::motorsim::RigidBodySim::X]; }
+    inline float getGy() override { return gyro[motor::motorsim::RigidBodySim::Y]; }
+    inline float getGz() override { return gyro[motor::motorsim::RigidBodySim::Z]; }
+
+    inline float getTemp() override { return config.temperature; }
+
+    inline uint32_t getPrevIMUDataReceivedTime() const override { return prevUpdateTime; }
+
+    /// @return The yaw angle of the body, in degrees in [0, 360).
+    inline float getYaw() override { return yaw; }
+    inline float getPitch() override { return pitch; }
+    inline float getRoll() override { return roll; }
+
+private:
+    const motor::motorsim::RigidBodySim &body;
+    const Config config;
+
+    std::mt19937 generator;
+    std::normal_distribution<float> normal;
+
+    float accel[motor::motorsim::RigidBodySim::NUM_AXES] = {};
+    float gyro[motor::motorsim::RigidBodySim::NUM_AXES] = {};
+    float yaw = 0;
+    float pitch = 0;
+    float roll = 0;
+    uint32_t prevUpdateTime = 0;
+};
+}  // namespace tap::communication::sensors::imu
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_IMU_SIM_HPP_
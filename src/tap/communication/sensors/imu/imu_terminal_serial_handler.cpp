@@ -19,9 +19,12 @@
 
 #include "imu_terminal_serial_handler.hpp"
 
-#include "tap/algorithms/strtok.hpp"
+#include "tap/algorithms/token_view.hpp"
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 
+#include "imu_diagnostics.hpp"
+
 namespace tap::communication::sensors::imu
 {
 constexpr char ImuTerminalSerialHandler::USAGE[];
@@ -36,37 +39,42 @@ bool ImuTerminalSerialHandler::terminalSerialCallback(
     modm::IOStream& outputStream,
     bool)
 {
-    char* arg;
+    algorithms::TokenView tokens(inputLine);
     subjectsBeingInspected.reset(
         InspectSubject::ACCEL | InspectSubject::ANGLES | InspectSubject::GYRO |
-        InspectSubject::TEMP);
-    while (
-        (arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine)))
+        InspectSubject::TEMP | InspectSubject::DIAGNOSTICS);
+    while (!tokens.empty())
     {
         if (!SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::ANGLES) &&
-            strcmp(arg, "angle") == 0)
+            tokens.nextIs("angle"))
         {
             subjectsBeingInspected.set(InspectSubject::ANGLES);
         }
         else if (
             !SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::GYRO) &&
-            strcmp(arg, "gyro") == 0)
+            tokens.nextIs("gyro"))
         {
             subjectsBeingInspected.set(InspectSubject::GYRO);
         }
         else if (
             !SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::ACCEL) &&
-            strcmp(arg, "accel") == 0)
+            tokens.nextIs("accel"))
         {
             subjectsBeingInspected.set(InspectSubject::ACCEL);
         }
         else if (
             !SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::TEMP) &&
-            strcmp(arg, "temp") == 0)
+            tokens.nextIs("temp"))
         {
             subjectsBeingInspected.set(InspectSubject::TEMP);
         }
-        else if (strcmp(arg, "-h") == 0)
+        else if (
+            !SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::DIAGNOSTICS) &&
+            imu->getDiagnostics() != nullptr && tokens.nextIs("diag"))
+        {
+            subjectsBeingInspected.set(InspectSubject::DIAGNOSTICS);
+        }
+        else if (tokens.nextIs("-h"))
         {
             outputStream << "Usage: " << imu->getName() << USAGE;
             return true;
@@ -134,6 +142,17 @@ void ImuTerminalSerialHandler::terminalSerialStreamCallback(modm::IOStream& outp
         checkNeedsTab(needsTab, outputStream);
         outputStream.printf("%.2f", static_cast<double>(imu->getTemp()));
     }
+    if (SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::DIAGNOSTICS))
+    {
+        checkNeedsTab(needsTab, outputStream);
+        const ImuDiagnostics* diagnostics = imu->getDiagnostics();
+        outputStream << diagnostics->getSampleCount() << "\t"
+                     << diagnostics->getDroppedSampleCount() << "\t"
+                     << diagnostics->getSpiErrorCount() << "\t" << diagnostics->getMaxReadTime()
+                     << "\t";
+        outputStream.printf("%.1f\t", static_cast<double>(diagnostics->getSampleFrequency()));
+        outputStream << diagnostics->getLastSampleAge(tap::arch::clock::getTimeMicroseconds());
+    }
     outputStream << modm::endl;
 }
 
@@ -160,6 +179,11 @@ void ImuTerminalSerialHandler::printHeader(modm::IOStream& outputStream)
         checkNeedsTab(needsTab, outputStream);
         outputStream << "temp";
     }
+    if (SUBJECT_BEING_INSPECTED(subjectsBeingInspected, InspectSubject::DIAGNOSTICS))
+    {
+        checkNeedsTab(needsTab, outputStream);
+        outputStream << "samples\tdrops\tspiErr\tmaxRead\todr\tage";
+    }
     outputStream << modm::endl;
 }
 }  // namespace tap::communication::sensors::imu
@@ -36,8 +36,8 @@ namespace tap::communication::sensors::imu
 {
 /**
  * Interface for reading IMU data. Connects to the terminal serial driver and allows
- * the user to query gyro, accel, angle, and temperature data. Single query and streaming
- * modes supported.
+ * the user to query gyro, accel, angle, and temperature data, and the driver's diagnostics if it
+ * keeps any. Single query and streaming modes supported.
  */
 class ImuTerminalSerialHandler : public communication::serial::TerminalSerialCallbackInterface
 {
@@ -61,13 +61,15 @@ class ImuTerminalSerialHandler : public communication::serial::TerminalSerialCal
 private:
     /** Usage without the name since this is dependent on the IMU. */
     static constexpr char USAGE[] =
-        " [-h] [angle] [gyro] [accel] [temp]\n"
+        " [-h] [angle] [gyro] [accel] [temp] [diag]\n"
         "  Where:\n"
         "    - [-h] Prints usage\n"
         "    - [angle] Prints angle data\n"
         "    - [gyro] Prints gyro data\n"
         "    - [accel] Prints accel data\n"
-        "    - [temp] Prints temp data\n";
+        "    - [temp] Prints temp data\n"
+        "    - [diag] Prints sample, dropped sample, and SPI error counts, the max read time\n"
+        "      (us), the measured sample rate (Hz), and the last sample's age (us)\n";
 
     Drivers* drivers;
 
@@ -83,7 +85,8 @@ class ImuTerminalSerialHandler : public communication::serial::TerminalSerialCal
         ANGLES = 1,
         GYRO = 1 << 1,
         ACCEL = 1 << 2,
-        TEMP = 1 << 3
+        TEMP = 1 << 3,
+        DIAGNOSTICS = 1 << 4,
     };
 
     MODM_FLAGS8(InspectSubject);
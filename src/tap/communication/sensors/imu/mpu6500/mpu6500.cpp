@@ -19,7 +19,9 @@
 
 #include "mpu6500.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "tap/algorithms/math_user_utils.hpp"
 #include "tap/architecture/endianness_wrappers.hpp"
@@ -28,6 +30,7 @@
 #include "tap/errors/create_errors.hpp"
 
 #include "mpu6500_config.hpp"
+#include "mpu6500_interrupt_spi.hpp"
 #include "mpu6500_reg.hpp"
 
 using namespace modm::literals;
@@ -36,12 +39,18 @@ using namespace tap::arch;
 namespace tap::communication::sensors::imu::mpu6500
 {
 Mpu6500::Mpu6500(Drivers *drivers)
-    : Fiber([this] { run(); }),
+    :
+#if MPU6500_READ_FIBER
+      Fiber([this] { run(); }),
+#endif
       drivers(drivers),
       processRawMpu6500DataFn(Mpu6500::defaultProcessRawMpu6500Data),
       raw(),
       imuHeater(drivers)
 {
+#if MPU6500_READ_FIBER
+    drivers->memoryMonitor.addFiber("mpu6500", *this);
+#endif
 }
 
 void Mpu6500::requestCalibration()
@@ -96,6 +105,7 @@ void Mpu6500::init(float sampleFrequency, float mahonyKp, float mahonyKi)
     if (MPU6500_ID != spiReadRegister(MPU6500_WHO_AM_I))
     {
         RAISE_ERROR(drivers, "Failed to initialize the IMU properly");
+        diagnostics.recordSpiError();
         return;
     }
 
@@ -115,10 +125,34 @@ void Mpu6500::init(float sampleFrequency, float mahonyKp, float mahonyKi)
     modm::delay_ms(1);
     spiWriteRegister(MPU6500_USER_CTRL, MPU6500_USER_CTRL_DATA);
     modm::delay_ms(1);
+
+    if (readMode == ReadMode::FIFO)
+    {
+        spiWriteRegister(MPU6500_FIFO_EN, MPU6500_FIFO_EN_ACCEL_GYRO);
+        modm::delay_ms(1);
+        spiWriteRegister(
+            MPU6500_USER_CTRL,
+            MPU6500_USER_CTRL_DATA | MPU6500_USER_CTRL_FIFO_EN_BIT |
+                MPU6500_USER_CTRL_FIFO_RST_BIT);
+        modm::delay_ms(1);
+    }
+
+#if !MPU6500_READ_FIBER
+    // Only enabled now, the configuration above uses blocking transfers.
+    Mpu6500InterruptSpi::initialize();
 #endif
+#endif
+
+    if (readMode == ReadMode::FIFO)
+    {
+        sampleFrequency = FIFO_SAMPLE_RATE_HZ / fifoDecimator.getDecimationFactor();
+    }
 
     imuHeater.initialize();
 
+    // FIFO reads return a varying number of samples, so gaps between them don't mean much.
+    diagnostics.setExpectedSampleFrequency(readMode == ReadMode::FIFO ? 0 : sampleFrequency);
+
     delayBtwnCalcAndReadReg =
         static_cast<int>(1e6f / sampleFrequency) - NONBLOCKING_TIME_TO_READ_REG;
 
@@ -127,19 +161,75 @@ void Mpu6500::init(float sampleFrequency, float mahonyKp, float mahonyKi)
     readRegistersTimeout.restart(delayBtwnCalcAndReadReg);
 
     mahonyAlgorithm.begin(sampleFrequency, mahonyKp, mahonyKi);
+    attitudeEstimator->setSampleFrequency(sampleFrequency);
+
+    imuState = gyroBiasEstimator.hasCalibration() ? ImuState::IMU_CALIBRATED
+                                                  : ImuState::IMU_NOT_CALIBRATED;
+}
+
+bool Mpu6500::setGyroCalibration(const tap::algorithms::GyroCalibration &calibration)
+{
+    if (!calibration.isValid())
+    {
+        return false;
+    }
 
-    imuState = ImuState::IMU_NOT_CALIBRATED;
+    gyroBiasEstimator.setCalibration(calibration);
+    if (imuState == ImuState::IMU_NOT_CALIBRATED)
+    {
+        imuState = ImuState::IMU_CALIBRATED;
+    }
+    return true;
 }
 
 void Mpu6500::periodicIMUUpdate()
+{
+    if (readMode != ReadMode::FIFO)
+    {
+        updateAttitude();
+    }
+
+    readRegistersTimeout.restart(delayBtwnCalcAndReadReg);
+
+    imuHeater.runTemperatureController(getTemp());
+
+    addValidationErrors();
+}
+
+void Mpu6500::updateAttitude()
 {
     if (imuState == ImuState::IMU_NOT_CALIBRATED || imuState == ImuState::IMU_CALIBRATED)
     {
-        mahonyAlgorithm.updateIMU(getGx(), getGy(), getGz(), getAx(), getAy(), getAz());
+        if (onlineGyroCalibration)
+        {
+            const float gyroDegPerSec[3] = {
+                raw.gyro.x / LSB_D_PER_S_TO_D_PER_S,
+                raw.gyro.y / LSB_D_PER_S_TO_D_PER_S,
+                raw.gyro.z / LSB_D_PER_S_TO_D_PER_S,
+            };
+            const float acc[3] = {getAx(), getAy(), getAz()};
+            if (gyroBiasEstimator.update(gyroDegPerSec, acc, getTemp()) &&
+                imuState == ImuState::IMU_NOT_CALIBRATED)
+            {
+                imuState = ImuState::IMU_CALIBRATED;
+            }
+        }
+
+        if (gyroBiasEstimator.hasCalibration())
+        {
+            applyGyroBias();
+        }
+
+        const float gyro[3] = {getGx(), getGy(), getGz()};
+        attitudeEstimator->updateIMU(gyro[0], gyro[1], gyro[2], getAx(), getAy(), getAz());
+
+        float q[4];
+        attitudeEstimator->getQuaternion(q);
+        attitudeHistory.push(prevIMUDataReceivedTime, q, gyro);
         tiltAngleCalculated = false;
         // Start reading registers in DELAY_BTWN_CALC_AND_READ_REG us
     }
-    else
+    else if (!calibrationWaitsForTemperature || imuHeater.isTemperatureStable())
     {
         calibrationSample++;
 
@@ -160,17 +250,29 @@ void Mpu6500::periodicIMUUpdate()
             raw.accelOffset.y /= MPU6500_OFFSET_SAMPLES;
             raw.accelOffset.z /= MPU6500_OFFSET_SAMPLES;
             imuState = ImuState::IMU_CALIBRATED;
-            mahonyAlgorithm.reset();
+            attitudeEstimator->reset();
+            attitudeHistory.clear();
+
+            const float bias[3] = {
+                raw.gyroOffset.x / LSB_D_PER_S_TO_D_PER_S,
+                raw.gyroOffset.y / LSB_D_PER_S_TO_D_PER_S,
+                raw.gyroOffset.z / LSB_D_PER_S_TO_D_PER_S,
+            };
+            gyroBiasEstimator.setBias(bias, getTemp());
         }
     }
+}
 
-    readRegistersTimeout.restart(delayBtwnCalcAndReadReg);
-
-    imuHeater.runTemperatureController(getTemp());
-
-    addValidationErrors();
+void Mpu6500::applyGyroBias()
+{
+    float bias[3];
+    gyroBiasEstimator.getBias(getTemp(), bias);
+    raw.gyroOffset.x = bias[0] * LSB_D_PER_S_TO_D_PER_S;
+    raw.gyroOffset.y = bias[1] * LSB_D_PER_S_TO_D_PER_S;
+    raw.gyroOffset.z = bias[2] * LSB_D_PER_S_TO_D_PER_S;
 }
 
+#if MPU6500_READ_FIBER
 bool Mpu6500::read()
 {
 #ifndef PLATFORM_HOSTED
@@ -178,6 +280,38 @@ bool Mpu6500::read()
     while (true)
     {
         PT_WAIT_UNTIL(readRegistersTimeout.execute());
+        readStartTime = tap::arch::clock::getTimeMicroseconds();
+
+        if (readMode == ReadMode::FIFO)
+        {
+            mpuNssLow();
+            tx = MPU6500_FIFO_COUNTH | MPU6500_READ_BIT;
+            PT_CALL(Board::ImuSpiMaster::transfer(&tx, &rx, 1));
+            PT_CALL(Board::ImuSpiMaster::transfer(nullptr, rxBuff, 2));
+            mpuNssHigh();
+
+            processFifoCount();
+
+            if (fifoReadLength > 0)
+            {
+                mpuNssLow();
+                tx = MPU6500_FIFO_R_W | MPU6500_READ_BIT;
+                PT_CALL(Board::ImuSpiMaster::transfer(&tx, &rx, 1));
+                PT_CALL(Board::ImuSpiMaster::transfer(nullptr, fifoBuff, fifoReadLength));
+                mpuNssHigh();
+
+                processFifoFrames(fifoReadLength / FIFO_FRAME_LENGTH);
+            }
+
+            mpuNssLow();
+            tx = MPU6500_TEMP_OUT_H | MPU6500_READ_BIT;
+            PT_CALL(Board::ImuSpiMaster::transfer(&tx, &rx, 1));
+            PT_CALL(Board::ImuSpiMaster::transfer(nullptr, rxBuff, 2));
+            mpuNssHigh();
+
+            processFifoTemperature();
+            continue;
+        }
 
         mpuNssLow();
         tx = MPU6500_ACCEL_XOUT_H | MPU6500_READ_BIT;
@@ -187,24 +321,155 @@ bool Mpu6500::read()
         PT_CALL(Board::ImuSpiMaster::transfer(txBuff, rxBuff, ACC_GYRO_TEMPERATURE_BUFF_RX_SIZE));
         mpuNssHigh();
 
-        (*processRawMpu6500DataFn)(rxBuff, raw.accel, raw.gyro);
-
-        raw.temperature = rxBuff[6] << 8 | rxBuff[7];
-
-        prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+        processDataRegisters();
     }
     PT_END();
 #else
     return false;
 #endif
 }
+#else
+bool Mpu6500::read()
+{
+#ifndef PLATFORM_HOSTED
+    if (Mpu6500InterruptSpi::isBusy())
+    {
+        return true;
+    }
+
+    switch (readState)
+    {
+        case ReadState::IDLE:
+            if (!readRegistersTimeout.execute())
+            {
+                return false;
+            }
+            readStartTime = tap::arch::clock::getTimeMicroseconds();
+            if (readMode == ReadMode::FIFO)
+            {
+                Mpu6500InterruptSpi::startRead(MPU6500_FIFO_COUNTH, rxBuff, 2);
+                readState = ReadState::FIFO_COUNT;
+            }
+            else
+            {
+                Mpu6500InterruptSpi::startRead(
+                    MPU6500_ACCEL_XOUT_H,
+                    rxBuff,
+                    ACC_GYRO_TEMPERATURE_BUFF_RX_SIZE);
+                readState = ReadState::DATA_REGISTERS;
+            }
+            return true;
+        case ReadState::DATA_REGISTERS:
+            processDataRegisters();
+            readState = ReadState::IDLE;
+            return false;
+        case ReadState::FIFO_COUNT:
+            processFifoCount();
+            if (fifoReadLength > 0)
+            {
+                Mpu6500InterruptSpi::startRead(MPU6500_FIFO_R_W, fifoBuff, fifoReadLength);
+                readState = ReadState::FIFO_DATA;
+                return true;
+            }
+            Mpu6500InterruptSpi::startRead(MPU6500_TEMP_OUT_H, rxBuff, 2);
+            readState = ReadState::TEMPERATURE;
+            return true;
+        case ReadState::FIFO_DATA:
+            processFifoFrames(fifoReadLength / FIFO_FRAME_LENGTH);
+            Mpu6500InterruptSpi::startRead(MPU6500_TEMP_OUT_H, rxBuff, 2);
+            readState = ReadState::TEMPERATURE;
+            return true;
+        case ReadState::TEMPERATURE:
+            processFifoTemperature();
+            readState = ReadState::IDLE;
+            return false;
+    }
+    return false;
+#else
+    return false;
+#endif
+}
+#endif
+
+void Mpu6500::processDataRegisters()
+{
+    (*processRawMpu6500DataFn)(rxBuff, raw.accel, raw.gyro);
+
+    raw.temperature = rxBuff[6] << 8 | rxBuff[7];
+
+    prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+
+    // The accelerometer registers come first, and always see gravity.
+    if (ImuDiagnostics::looksLikeBusFault(rxBuff, 6))
+    {
+        diagnostics.recordSpiError();
+    }
+    diagnostics.recordSamples(prevIMUDataReceivedTime);
+    diagnostics.recordReadTime(prevIMUDataReceivedTime - readStartTime);
+}
+
+void Mpu6500::processFifoCount()
+{
+    const uint16_t fifoCount = ((rxBuff[0] & 0x1f) << 8) | rxBuff[1];
+    if (fifoCount >= FIFO_SIZE)
+    {
+        // The number of samples lost isn't reported.
+        diagnostics.recordDroppedSamples(1);
+    }
+
+    fifoReadLength = std::min<uint16_t>(
+        fifoCount / FIFO_FRAME_LENGTH * FIFO_FRAME_LENGTH,
+        MAX_FIFO_READ_LENGTH);
+}
+
+void Mpu6500::processFifoTemperature()
+{
+    raw.temperature = rxBuff[0] << 8 | rxBuff[1];
+
+    prevIMUDataReceivedTime = tap::arch::clock::getTimeMicroseconds();
+    if (fifoReadLength > 0)
+    {
+        diagnostics.recordSamples(prevIMUDataReceivedTime, fifoReadLength / FIFO_FRAME_LENGTH);
+    }
+    diagnostics.recordReadTime(prevIMUDataReceivedTime - readStartTime);
+}
+
+void Mpu6500::processFifoFrames(uint8_t numFrames)
+{
+    // Lay each frame out like the data registers so that processRawMpu6500DataFn can be used.
+    uint8_t frameBuff[ACC_GYRO_TEMPERATURE_BUFF_RX_SIZE] = {0};
+    modm::Vector3f accel;
+    modm::Vector3f gyro;
+
+    for (uint8_t i = 0; i < numFrames; i++)
+    {
+        const uint8_t *frame = fifoBuff + i * FIFO_FRAME_LENGTH;
+        memcpy(frameBuff, frame, 6);
+        memcpy(frameBuff + 8, frame + 6, 6);
+
+        (*processRawMpu6500DataFn)(frameBuff, accel, gyro);
+
+        float sample[6] = {accel.x, accel.y, accel.z, gyro.x, gyro.y, gyro.z};
+        if (fifoDecimator.update(sample))
+        {
+            raw.accel.x = fifoDecimator.getOutput(0);
+            raw.accel.y = fifoDecimator.getOutput(1);
+            raw.accel.z = fifoDecimator.getOutput(2);
+            raw.gyro.x = fifoDecimator.getOutput(3);
+            raw.gyro.y = fifoDecimator.getOutput(4);
+            raw.gyro.z = fifoDecimator.getOutput(5);
+            updateAttitude();
+        }
+    }
+}
 
 float Mpu6500::getTiltAngle()
 {
     if (!tiltAngleCalculated)
     {
-        tiltAngle = modm::toDegree(acosf(
-            cosf(mahonyAlgorithm.getPitchRadians()) * cosf(mahonyAlgorithm.getRollRadians())));
+        tiltAngle = modm::toDegree(
+            acosf(cosf(attitudeEstimator->getPitchRadians()) *
+                  cosf(attitudeEstimator->getRollRadians())));
         tiltAngleCalculated = true;
     }
     return validateReading(tiltAngle);
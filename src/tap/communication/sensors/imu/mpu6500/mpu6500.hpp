@@ -20,16 +20,27 @@
 #ifndef TAPROOT_MPU6500_HPP_
 #define TAPROOT_MPU6500_HPP_
 
+#include <cstddef>
 #include <cstdint>
 
 #include "tap/algorithms/MahonyAHRS.h"
+#include "tap/algorithms/attitude_estimator.hpp"
+#include "tap/algorithms/attitude_history.hpp"
+#include "tap/algorithms/fir_decimator.hpp"
+#include "tap/algorithms/gyro_bias_estimator.hpp"
 #include "tap/architecture/timeout.hpp"
+#include "tap/communication/sensors/imu/imu_diagnostics.hpp"
 #include "tap/communication/sensors/imu/imu_interface.hpp"
 #include "tap/communication/sensors/imu_heater/imu_heater.hpp"
 #include "tap/util_macros.hpp"
 
 #include "modm/math/geometry.hpp"
+
+#include "mpu6500_read_config.hpp"
+
+#if MPU6500_READ_FIBER
 #include "modm/processing/fiber.hpp"
+#endif
 
 #define LITTLE_ENDIAN_INT16_TO_FLOAT(buff) \
     (static_cast<float>(static_cast<int16_t>((*(buff) << 8) | *(buff + 1))))
@@ -57,7 +68,11 @@ namespace tap::communication::sensors::imu::mpu6500
 #define MPU_FIBER_STACK_SIZE 512
 #endif
 
+#if MPU6500_READ_FIBER
 class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, public ImuInterface
+#else
+class Mpu6500 final_mockable : public ImuInterface
+#endif
 {
 public:
     /**
@@ -65,6 +80,39 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
      */
     static constexpr uint8_t ACC_GYRO_TEMPERATURE_BUFF_RX_SIZE = 14;
 
+    /// How `read` gets data from the mpu6500.
+    enum class ReadMode : uint8_t
+    {
+        /// `read` reads the newest sample from the data registers.
+        DATA_REGISTERS,
+        /**
+         * The mpu6500 buffers every sample in its hardware FIFO. `read` drains the FIFO in one
+         * SPI burst and passes every sample through a decimating filter, see
+         * `configureFifoFilter`. Each filtered sample updates the attitude estimator, so it runs
+         * at `FIFO_SAMPLE_RATE_HZ` divided by the decimation factor no matter how often `read`
+         * runs.
+         */
+        FIFO,
+    };
+
+    /// The rate samples are written to the FIFO, with the configured low pass filter settings.
+    static constexpr float FIFO_SAMPLE_RATE_HZ = 1000.0f;
+
+    /// Accelerometer and gyroscope data, the temperature isn't written to the FIFO.
+    static constexpr uint8_t FIFO_FRAME_LENGTH = 12;
+
+    /// The size of the hardware FIFO, in bytes. A full FIFO has lost samples.
+    static constexpr uint16_t FIFO_SIZE = 512;
+
+    /**
+     * The most bytes read from the FIFO by a single `read`. Samples that don't fit are read next
+     * time.
+     */
+    static constexpr uint8_t MAX_FIFO_READ_LENGTH = 20 * FIFO_FRAME_LENGTH;
+
+    /// The most taps of the FIFO decimation filter.
+    static constexpr std::size_t MAX_FIFO_FILTER_TAPS = 32;
+
     /**
      * Storage for the raw data we receive from the mpu6500, as well as offsets
      * that are used each time we receive data.
@@ -113,7 +161,8 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
     mockable void init(float sampleFrequency, float mahonyKp, float mahonyKi);
 
     /**
-     * Calculates the IMU's pitch, roll, and yaw angles usign the Mahony AHRS algorithm.
+     * Calculates the IMU's pitch, roll, and yaw angles using the attitude estimator, the Mahony
+     * AHRS algorithm unless replaced with `setAttitudeEstimator`.
      * Also runs a controller to keep the temperature constant.
      * Call at 500 hz for best performance.
      */
@@ -123,11 +172,17 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
      * Read data from the imu. This is a protothread that reads the SPI bus using
      * nonblocking I/O.
      *
+     * If the `read_fiber` lbuild option is disabled, this instead advances a state machine whose
+     * SPI transfers are performed by `Mpu6500InterruptSpi`, and returns right away. Call it
+     * from the main loop at least once per transfer, several times per `periodicIMUUpdate`.
+     *
      * @return `true` if the function is not done, `false` otherwise
      */
     mockable bool read();
 
+#if MPU6500_READ_FIBER
     bool run() { return this->read(); }
+#endif
 
     /**
      * Returns the state of the IMU. Can be not connected, connected but not calibrated, calibrating
@@ -249,19 +304,30 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
     /**
      * Returns yaw angle. in degrees.
      */
-    inline float getYaw() final_mockable { return validateReading(mahonyAlgorithm.getYaw()); }
+    inline float getYaw() final_mockable { return validateReading(attitudeEstimator->getYaw()); }
 
     /**
      * Returns pitch angle in degrees.
      */
-    inline float getPitch() final_mockable { return validateReading(mahonyAlgorithm.getPitch()); }
+    inline float getPitch() final_mockable
+    {
+        return validateReading(attitudeEstimator->getPitch());
+    }
 
     /**
      * Returns roll angle in degrees.
      */
-    inline float getRoll() final_mockable { return validateReading(mahonyAlgorithm.getRoll()); }
+    inline float getRoll() final_mockable { return validateReading(attitudeEstimator->getRoll()); }
+
+    mockable inline uint32_t getPrevIMUDataReceivedTime() const final_mockable
+    {
+        return prevIMUDataReceivedTime;
+    }
 
-    mockable inline uint32_t getPrevIMUDataReceivedTime() const { return prevIMUDataReceivedTime; }
+    mockable inline const ImuDiagnostics *getDiagnostics() const final_mockable
+    {
+        return &diagnostics;
+    }
 
     /**
      * Returns the angle difference between the normal vector of the plane that the
@@ -276,6 +342,23 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
 
     void attachProcessRawMpu6500DataFn(ProcessRawMpu6500DataFn fn) { processRawMpu6500DataFn = fn; }
 
+    /// Sets how the mpu6500 is read. Must be called before `init`.
+    inline void setReadMode(ReadMode mode) { readMode = mode; }
+
+    /**
+     * Configures the CIC filter used in `ReadMode::FIFO`, see
+     * `tap::algorithms::FirDecimator::configureCic`. When calling `init` in FIFO mode, the
+     * `sampleFrequency` is ignored, and the attitude estimator's sample frequency is
+     * `FIFO_SAMPLE_RATE_HZ / decimationFactor`.
+     *
+     * @return `false` if the filter would have more than `MAX_FIFO_FILTER_TAPS` taps, in which
+     *      case the filter is unchanged.
+     */
+    inline bool configureFifoFilter(uint8_t decimationFactor, uint8_t cicOrder = 1)
+    {
+        return fifoDecimator.configureCic(decimationFactor, cicOrder);
+    }
+
     /**
      * Use for converting from gyro values we receive to more conventional degrees / second.
      */
@@ -288,6 +371,83 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
         imuHeater.setDesiredTemperature(temperatureC);
     }
 
+    /**
+     * @return `true` once the IMU heater has held the target temperature long enough for the
+     *      gyroscope bias to settle, see `ImuHeater::isTemperatureStable`.
+     */
+    inline bool isTemperatureStable() const { return imuHeater.isTemperatureStable(); }
+
+    /**
+     * Makes `requestCalibration` wait until the temperature is stable before it starts collecting
+     * samples, instead of calibrating at whatever temperature the mpu6500 is at. Disabled by
+     * default.
+     */
+    inline void setCalibrationWaitsForTemperature(bool enabled)
+    {
+        calibrationWaitsForTemperature = enabled;
+    }
+
+    /**
+     * Replaces the mahony algorithm with another attitude estimator, for example a
+     * `tap::algorithms::AttitudeEskf`. Must be called before `init`, which sets the estimator's
+     * sample frequency. The estimator must outlive the mpu6500. `nullptr` restores the mahony
+     * algorithm.
+     */
+    inline void setAttitudeEstimator(tap::algorithms::AttitudeEstimator *estimator)
+    {
+        attitudeEstimator = estimator != nullptr ? estimator : &mahonyAlgorithm;
+    }
+
+    inline tap::algorithms::AttitudeEstimator &getAttitudeEstimator() { return *attitudeEstimator; }
+
+    /**
+     * Enables estimating the gyroscope bias whenever the mpu6500 is stationary, see
+     * `tap::algorithms::GyroBiasEstimator`. The first estimate marks the IMU calibrated, so the
+     * robot doesn't have to sit still through `requestCalibration`. Disabled by default.
+     */
+    inline void setOnlineGyroCalibration(bool enabled) { onlineGyroCalibration = enabled; }
+
+    /**
+     * Restores a gyroscope calibration, such as one stored in flash from a previous boot.
+     * Accelerometer offsets are not restored.
+     *
+     * @return `false` if the calibration isn't valid, in which case nothing changes.
+     */
+    bool setGyroCalibration(const tap::algorithms::GyroCalibration &calibration);
+
+    /**
+     * @return The gyroscope calibration from `setGyroCalibration`, `requestCalibration`, or
+     *      online estimation, to be stored when its number of updates changes.
+     */
+    inline const tap::algorithms::GyroBiasEstimator &getGyroBiasEstimator() const
+    {
+        return gyroBiasEstimator;
+    }
+
+    /// Entries of attitude history kept, 128 ms at a 1 kHz sample rate.
+    static constexpr int ATTITUDE_HISTORY_LENGTH = 128;
+
+    /**
+     * Computes the attitude at a past time, for example the exposure time of a camera frame, so
+     * latency can be compensated for with the pose the robot had rather than its current one.
+     *
+     * @param[in] timeUs The time, in microseconds as returned by
+     *      `tap::arch::clock::getTimeMicroseconds`.
+     * @param[out] q The attitude quaternion (w, x, y, z) at `timeUs`.
+     * @return `false` if `timeUs` is older than the history, in which case `q` is unchanged.
+     */
+    inline bool getAttitudeAt(uint32_t timeUs, float (&q)[4]) const
+    {
+        return attitudeHistory.getAttitudeAt(timeUs, q);
+    }
+
+    /// @return The timestamped attitudes and bias corrected angular velocities of past samples.
+    inline const tap::algorithms::AttitudeHistory<ATTITUDE_HISTORY_LENGTH> &getAttitudeHistory()
+        const
+    {
+        return attitudeHistory;
+    }
+
 private:
     static constexpr float ACCELERATION_GRAVITY = 9.80665f;
 
@@ -337,6 +497,9 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
 
     Mahony mahonyAlgorithm;
 
+    /// The estimator that computes the angles, `mahonyAlgorithm` unless replaced.
+    tap::algorithms::AttitudeEstimator *attitudeEstimator = &mahonyAlgorithm;
+
     imu_heater::ImuHeater imuHeater;
 
     float tiltAngle = 0.0f;
@@ -348,10 +511,65 @@ class Mpu6500 final_mockable : public ::modm::Fiber<MPU_FIBER_STACK_SIZE>, publi
 
     int calibrationSample = 0;
 
+    bool onlineGyroCalibration = false;
+
+    bool calibrationWaitsForTemperature = false;
+
+    tap::algorithms::GyroBiasEstimator gyroBiasEstimator;
+
+    tap::algorithms::AttitudeHistory<ATTITUDE_HISTORY_LENGTH> attitudeHistory;
+
     uint8_t errorState = 0;
 
     uint32_t prevIMUDataReceivedTime = 0;
 
+    ImuDiagnostics diagnostics;
+
+    /// The time the read protothread started reading the current sample.
+    uint32_t readStartTime = 0;
+
+    ReadMode readMode = ReadMode::DATA_REGISTERS;
+
+    /// Accelerometer x, y, z followed by gyroscope x, y, z.
+    tap::algorithms::FirDecimator<6, MAX_FIFO_FILTER_TAPS> fifoDecimator;
+
+    uint8_t fifoBuff[MAX_FIFO_READ_LENGTH] = {0};
+
+    /// The number of bytes being read from the FIFO in the read protothread.
+    uint8_t fifoReadLength = 0;
+
+#if !MPU6500_READ_FIBER
+    /// The transfer `Mpu6500InterruptSpi` is performing for `read`.
+    enum class ReadState : uint8_t
+    {
+        IDLE,
+        DATA_REGISTERS,
+        FIFO_COUNT,
+        FIFO_DATA,
+        TEMPERATURE,
+    };
+
+    ReadState readState = ReadState::IDLE;
+#endif
+
+    /// Runs the attitude estimator, or collects a calibration sample when calibrating.
+    void updateAttitude();
+
+    /// Sets the gyroscope offsets to the bias estimated at the current temperature.
+    void applyGyroBias();
+
+    /// Filters `numFrames` FIFO frames stored in `fifoBuff`.
+    void processFifoFrames(uint8_t numFrames);
+
+    /// Parses the data registers read into `rxBuff`.
+    void processDataRegisters();
+
+    /// Sets `fifoReadLength` from the FIFO count registers read into `rxBuff`.
+    void processFifoCount();
+
+    /// Parses the temperature registers read into `rxBuff`, which end a FIFO read.
+    void processFifoTemperature();
+
     // Functions for interacting with hardware directly.
 
     /**
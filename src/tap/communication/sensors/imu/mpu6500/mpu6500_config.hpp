@@ -132,6 +132,17 @@
      BIT_MASK(BIT_SHIFT(MPU6500_USER_CTRL_I2C_MST_RST, 6), BIT_SHIFT(1, 6)) | \
      BIT_MASK(BIT_SHIFT(MPU6500_USER_CTRL_SIG_COND_RST, 7), BIT_SHIFT(1, 7)))
 
+// Written to MPU6500_USER_CTRL when reading samples from the FIFO, see Mpu6500::ReadMode::FIFO
+#define MPU6500_USER_CTRL_FIFO_EN_BIT BIT_SHIFT(0b1, 6)
+#define MPU6500_USER_CTRL_FIFO_RST_BIT BIT_SHIFT(0b1, 2)
+
+/////////////// MPU6500_FIFO_EN ///////////////
+
+// [6:3]
+// Write gyro x, y, z, and accel samples to the FIFO, so each FIFO frame holds ACCEL_XOUT_H
+// through ACCEL_ZOUT_L followed by GYRO_XOUT_H through GYRO_ZOUT_L
+#define MPU6500_FIFO_EN_ACCEL_GYRO BIT_SHIFT(0b1111, 3)
+
 ////////////// MPU6500_PWR_MGMT_1 //////////////
 
 // NOTE: formatting slightly different for this register since we would like
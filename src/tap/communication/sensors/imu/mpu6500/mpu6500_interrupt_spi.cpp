@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mpu6500_interrupt_spi.hpp"
+
+#include "tap/architecture/clock.hpp"
+#include "tap/board/board.hpp"
+#include "tap/util_macros.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/interrupt.hpp"
+#include "modm/platform.hpp"
+#endif
+
+#ifndef PLATFORM_HOSTED
+MODM_ISR(SPI5)
+{
+    tap::communication::sensors::imu::mpu6500::Mpu6500InterruptSpi::onByteReceived(SPI5->DR);
+}
+#endif
+
+namespace tap::communication::sensors::imu::mpu6500
+{
+/// Bit set in the address byte to read rather than write.
+static constexpr uint8_t READ_BIT = 0x80;
+
+uint8_t *Mpu6500InterruptSpi::buffer = nullptr;
+uint16_t Mpu6500InterruptSpi::length = 0;
+uint16_t Mpu6500InterruptSpi::received = 0;
+volatile bool Mpu6500InterruptSpi::busy = false;
+uint32_t Mpu6500InterruptSpi::completionTime = 0;
+
+void Mpu6500InterruptSpi::initialize()
+{
+#ifndef PLATFORM_HOSTED
+    NVIC_SetPriority(SPI5_IRQn, INTERRUPT_PRIORITY);
+    NVIC_EnableIRQ(SPI5_IRQn);
+#endif
+}
+
+bool Mpu6500InterruptSpi::startRead(uint8_t reg, uint8_t *buffer, uint16_t length)
+{
+    if (busy || length == 0)
+    {
+        return false;
+    }
+
+    Mpu6500InterruptSpi::buffer = buffer;
+    Mpu6500InterruptSpi::length = length;
+    received = 0;
+    busy = true;
+
+#ifndef PLATFORM_HOSTED
+    Board::ImuNss::setOutput(modm::GpioOutput::Low);
+    // Discard a byte left over from a blocking transfer so the first interrupt is the address's.
+    (void)SPI5->DR;
+    SPI5->CR2 |= SPI_CR2_RXNEIE;
+    SPI5->DR = reg | READ_BIT;
+#else
+    UNUSED(reg);
+#endif
+    return true;
+}
+
+void Mpu6500InterruptSpi::onByteReceived(uint8_t byte)
+{
+    if (!busy)
+    {
+        return;
+    }
+
+    // The byte received while the address is sent is meaningless.
+    if (received > 0)
+    {
+        buffer[received - 1] = byte;
+    }
+    received++;
+
+    if (received > length)
+    {
+        finishRead();
+        return;
+    }
+
+#ifndef PLATFORM_HOSTED
+    SPI5->DR = 0;
+#endif
+}
+
+void Mpu6500InterruptSpi::finishRead()
+{
+#ifndef PLATFORM_HOSTED
+    SPI5->CR2 &= ~SPI_CR2_RXNEIE;
+    Board::ImuNss::setOutput(modm::GpioOutput::High);
+#endif
+    completionTime = tap::arch::clock::getTimeMicroseconds();
+    busy = false;
+}
+
+#if defined(ENV_UNIT_TESTS)
+void Mpu6500InterruptSpi::reset()
+{
+    buffer = nullptr;
+    length = 0;
+    received = 0;
+    busy = false;
+}
+#endif
+}  // namespace tap::communication::sensors::imu::mpu6500
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MPU6500_INTERRUPT_SPI_HPP_
+#define TAPROOT_MPU6500_INTERRUPT_SPI_HPP_
+
+#include <cstdint>
+
+namespace tap::communication::sensors::imu::mpu6500
+{
+/**
+ * Reads mpu6500 registers over SPI5 without blocking and without a fiber. `startRead` pulls the
+ * chip select low and sends the register address. Each time a byte is received, the SPI receive
+ * interrupt stores it and sends the next dummy byte, and once the last byte is received it
+ * releases the chip select. The main loop only has to poll `isBusy`, so reading doesn't need a
+ * fiber stack or context switches.
+ *
+ * SPI5 must be initialized, and not used by anything else while a read is in progress.
+ *
+ * On hosted builds there is no SPI, so received bytes must be passed to `onByteReceived`.
+ */
+class Mpu6500InterruptSpi
+{
+public:
+    /// Priority of the SPI interrupt.
+    static constexpr uint32_t INTERRUPT_PRIORITY = 5;
+
+    /// Enables the SPI5 interrupt.
+    static void initialize();
+
+    /**
+     * Starts reading `length` consecutive registers, starting at `reg`, into `buffer`, which
+     * must stay valid until the read is done.
+     *
+     * @return `false` if a read is already in progress or `length` is 0.
+     */
+    static bool startRead(uint8_t reg, uint8_t *buffer, uint16_t length);
+
+    /// @return `true` if a read is in progress.
+    static bool isBusy() { return busy; }
+
+    /// @return The time the last read finished, in microseconds.
+    static uint32_t getCompletionTime() { return completionTime; }
+
+    /// Called by the SPI receive interrupt with each byte received.
+    static void onByteReceived(uint8_t byte);
+
+#if defined(ENV_UNIT_TESTS)
+    /// Abandons the read in progress.
+    static void reset();
+#endif
+
+private:
+    static uint8_t *buffer;
+    static uint16_t length;
+    /// The bytes received in the read in progress, including the one received with the address.
+    static uint16_t received;
+    static volatile bool busy;
+    static uint32_t completionTime;
+
+    static void finishRead();
+};
+
+}  // namespace tap::communication::sensors::imu::mpu6500
+
+#endif  // TAPROOT_MPU6500_INTERRUPT_SPI_HPP_
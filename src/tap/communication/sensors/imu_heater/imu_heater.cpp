@@ -16,9 +16,12 @@
  * You should have received a copy of the GNU General Public License
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
-
 #include "imu_heater.hpp"
 
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 
 #include "imu_heater_constants.hpp"
@@ -42,20 +45,171 @@ void ImuHeater::initialize()
     drivers->pwm.setTimerFrequency(bound_ports::IMU_HEATER_TIMER, HEATER_PWM_FREQUENCY);
 }
 
+float ImuHeater::getFeedForwardDuty() const
+{
+    return tap::algorithms::limitVal(
+        (imuDesiredTemperature - ambientTemperature) * modelDecayRate / modelHeatingRate,
+        0.0f,
+        1.0f);
+}
+
 void ImuHeater::runTemperatureController(float temperature)
 {
     if (temperature < 0)
     {
         drivers->pwm.write(0.0f, tap::gpio::Pwm::ImuHeater);
+        prevDuty = 0;
+        inTolerance = false;
+        temperatureStable = false;
         return;
     }
 
-    // Run PID controller to find desired output, output units PWM frequency
-    imuTemperatureController.update(imuDesiredTemperature - temperature);
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+    uint32_t dt = 0;
+    if (!hasPrevTemperature)
+    {
+        // The board starts out at ambient temperature
+        ambientTemperature = temperature;
+        windowStartTemperature = temperature;
+        hasPrevTemperature = true;
+    }
+    else
+    {
+        dt = time - prevTime;
+        identifyModel(temperature, dt);
+    }
+
+    float duty;
+    if (modelIdentified && dt > 0 && dt <= MAX_CONTROL_PERIOD)
+    {
+        duty = runPredictiveController(temperature, dt / 1e6f);
+    }
+    else
+    {
+        // Run PID controller to find desired output, output units PWM frequency
+        imuTemperatureController.update(imuDesiredTemperature - temperature);
+        // Limit output so it is not < 0
+        duty = std::max(0.0f, imuTemperatureController.getValue());
+    }
+
+    // Set heater PWM output
+    drivers->pwm.write(duty, tap::gpio::Pwm::ImuHeater);
+
+    updateStability(temperature, time);
+
+    prevDuty = duty;
+    prevTemperature = temperature;
+    prevTime = time;
+}
+
+void ImuHeater::identifyModel(float temperature, uint32_t dt)
+{
+    if (dt == 0 || dt > MAX_CONTROL_PERIOD)
+    {
+        // Missed calls, the duty in between is unknown so start a new window
+        windowDutyIntegral = 0;
+        windowTemperatureIntegral = 0;
+        windowDuration = 0;
+        windowStartTemperature = temperature;
+        return;
+    }
+
+    const float dtSeconds = dt / 1e6f;
+    windowDutyIntegral += prevDuty * dtSeconds;
+    windowTemperatureIntegral += 0.5f * (prevTemperature + temperature) * dtSeconds;
+    windowDuration += dt;
+
+    if (windowDuration >= IDENTIFICATION_WINDOW)
+    {
+        const float duration = windowDuration / 1e6f;
+        updateModel(
+            windowDutyIntegral / duration,
+            windowTemperatureIntegral / duration,
+            (temperature - windowStartTemperature) / duration);
+
+        windowDutyIntegral = 0;
+        windowTemperatureIntegral = 0;
+        windowDuration = 0;
+        windowStartTemperature = temperature;
+    }
+}
+
+void ImuHeater::updateModel(float dutyMean, float temperatureMean, float temperatureRate)
+{
+    // Recursive least squares with regressor [duty, -(T - T_ambient)] and parameters [a, b]
+    const float phi[2] = {dutyMean, ambientTemperature - temperatureMean};
+    float *p = modelCovariance;
+    const float pPhi[2] = {p[0] * phi[0] + p[1] * phi[1], p[2] * phi[0] + p[3] * phi[1]};
+    const float denominator = FORGETTING_FACTOR + phi[0] * pPhi[0] + phi[1] * pPhi[1];
+    const float gain[2] = {pPhi[0] / denominator, pPhi[1] / denominator};
+    const float error = temperatureRate - (phi[0] * modelHeatingRate + phi[1] * modelDecayRate);
+
+    modelHeatingRate += gain[0] * error;
+    modelDecayRate += gain[1] * error;
+
+    // P = (P - k * phi^T * P) / lambda, where phi^T * P = pPhi^T since P is symmetric. Only
+    // forget while the covariance is small, so it doesn't grow without bound while the duty and
+    // temperature hold steady at the setpoint and carry no information.
+    const float forgetting =
+        (p[0] + p[3] < 2 * INITIAL_PARAMETER_VARIANCE) ? FORGETTING_FACTOR : 1.0f;
+    const float p01 = (p[1] - gain[0] * pPhi[1]) / forgetting;
+    p[0] = (p[0] - gain[0] * pPhi[0]) / forgetting;
+    p[1] = p01;
+    p[2] = p01;
+    p[3] = (p[3] - gain[1] * pPhi[1]) / forgetting;
+
+    identificationWindows++;
+
+    // A heater that cools the board or a board that doesn't lose heat is a bad estimate, in
+    // which case the PID controller takes over again until the estimate recovers
+    const bool plausible = modelHeatingRate > 0 && modelDecayRate >= 1.0f / MAX_TIME_CONSTANT &&
+                           modelDecayRate <= 1.0f / MIN_TIME_CONSTANT;
+    const float decayRateVariance = RATE_MEASUREMENT_VARIANCE * p[3];
+    const bool identified = plausible && identificationWindows >= MIN_IDENTIFICATION_WINDOWS &&
+                            decayRateVariance < powf(MAX_RELATIVE_UNCERTAINTY * modelDecayRate, 2);
+    if (identified && !modelIdentified)
+    {
+        trim = 0;
+    }
+    modelIdentified = identified;
+}
+
+float ImuHeater::runPredictiveController(float temperature, float dt)
+{
+    const float error = imuDesiredTemperature - temperature;
+
+    // Reference PREDICTION_HORIZON from now, approaching the setpoint exponentially
+    const float reference =
+        imuDesiredTemperature - error * expf(-PREDICTION_HORIZON / REFERENCE_TIME_CONSTANT);
 
-    // Set heater PWM output, limit output so it is not < 0
-    drivers->pwm.write(
-        std::max(0.0f, imuTemperatureController.getValue()),
-        tap::gpio::Pwm::ImuHeater);
+    // Solve T(H) = T_amb + (T - T_amb) * e^(-bH) + (a / b) * duty * (1 - e^(-bH)) = reference
+    const float decay = expf(-modelDecayRate * PREDICTION_HORIZON);
+    const float fullDutyRise = modelHeatingRate / modelDecayRate;
+    float duty = (reference - ambientTemperature - (temperature - ambientTemperature) * decay) /
+                 (fullDutyRise * (1 - decay));
+
+    if (fabsf(error) < TRIM_ERROR_BAND)
+    {
+        trim = tap::algorithms::limitVal(trim + TRIM_GAIN * error * dt, -MAX_TRIM, MAX_TRIM);
+    }
+
+    return tap::algorithms::limitVal(duty + trim, 0.0f, 1.0f);
+}
+
+void ImuHeater::updateStability(float temperature, uint32_t time)
+{
+    if (fabsf(imuDesiredTemperature - temperature) > STABLE_TEMPERATURE_TOLERANCE)
+    {
+        inTolerance = false;
+        temperatureStable = false;
+        return;
+    }
+
+    if (!inTolerance)
+    {
+        inTolerance = true;
+        toleranceEnterTime = time;
+    }
+    temperatureStable = time - toleranceEnterTime >= STABLE_TEMPERATURE_TIME;
 }
 }  // namespace tap::communication::sensors::imu_heater
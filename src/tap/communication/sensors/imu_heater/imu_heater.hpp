@@ -20,6 +20,8 @@
 #ifndef TAPROOT_IMU_HEATER_HPP_
 #define TAPROOT_IMU_HEATER_HPP_
 
+#include <cstdint>
+
 #include "tap/util_macros.hpp"
 
 #include "modm/math/filter/pid.hpp"
@@ -31,6 +33,26 @@ class Drivers;
 
 namespace tap::communication::sensors::imu_heater
 {
+/**
+ * Regulates the temperature of the IMU with the heater resistor next to it.
+ *
+ * The heater identifies a first order thermal model of the board online,
+ *
+ *     dT/dt = a * duty - b * (T - T_ambient),
+ *
+ * where `1 / b` is the board's thermal time constant and `a / b` is the temperature rise at full
+ * duty, using recursive least squares over the measured temperature and the duty it applied.
+ * `T_ambient` is taken to be the first temperature measured after boot. Until the model is
+ * identified the heater runs a conservatively tuned PID controller. Once it is, it runs a
+ * predictive controller that picks the duty that brings the predicted temperature
+ * `PREDICTION_HORIZON` from now onto a reference that approaches the setpoint exponentially,
+ * which heats at full duty while far from the setpoint and eases off in time to arrive without
+ * overshoot. At the setpoint this reduces to the feed-forward duty that holds it, `(T_set -
+ * T_ambient) * b / a`, plus a slow integral trim for the model's error.
+ *
+ * `isTemperatureStable` reports when the temperature has settled at the setpoint, so IMU
+ * calibration can wait for it instead of a fixed delay.
+ */
 class ImuHeater
 {
 public:
@@ -44,7 +66,8 @@ class ImuHeater
     void initialize();
 
     /**
-     * Runs a PID controller to regulate the temperature of the IMU.
+     * Runs the temperature controller and updates the thermal model, see the class description.
+     * Call at a regular rate, for example with every IMU update.
      *
      * @param[in] temperature The temperature of the imu, units degrees C.
      */
@@ -57,6 +80,24 @@ class ImuHeater
      */
     inline void setDesiredTemperature(float temperature) { imuDesiredTemperature = temperature; }
 
+    /**
+     * @return `true` if the temperature has been within `STABLE_TEMPERATURE_TOLERANCE` of the
+     *      setpoint for the last `STABLE_TEMPERATURE_TIME` microseconds.
+     */
+    inline bool isTemperatureStable() const { return temperatureStable; }
+
+    /// @return `true` if the thermal model is identified and the predictive controller is in use.
+    inline bool isModelIdentified() const { return modelIdentified; }
+
+    /// @return The identified thermal time constant, in seconds.
+    inline float getTimeConstant() const { return 1.0f / modelDecayRate; }
+
+    /// @return The identified steady state temperature rise at full duty, in degrees C.
+    inline float getFullDutyTemperatureRise() const { return modelHeatingRate / modelDecayRate; }
+
+    /// @return The duty that holds the setpoint according to the thermal model.
+    float getFeedForwardDuty() const;
+
 private:
     /**
      * PID constants for temperature control.
@@ -73,6 +114,63 @@ class ImuHeater
      */
     static constexpr float HEATER_PWM_FREQUENCY = 1000.0f;
 
+    /**
+     * Thermal model the identification starts from, seconds and degrees C. Typical of the
+     * development boards, the identification corrects them within the first few windows.
+     */
+    static constexpr float NOMINAL_TIME_CONSTANT = 60.0f;
+    static constexpr float NOMINAL_FULL_DUTY_TEMPERATURE_RISE = 40.0f;
+
+    /// Variance of the initial model parameters, large enough for the measurements to dominate.
+    static constexpr float INITIAL_PARAMETER_VARIANCE = 1.0f;
+
+    /// Forgetting factor of the least squares, per window, so the model tracks slow changes.
+    static constexpr float FORGETTING_FACTOR = 0.995f;
+
+    /**
+     * Measurements are averaged over windows this long, in microseconds, before updating the
+     * model, so the temperature sensor's quantization doesn't dominate the measured slope.
+     */
+    static constexpr uint32_t IDENTIFICATION_WINDOW = 1'000'000;
+
+    /// Windows to measure before the model is trusted.
+    static constexpr int MIN_IDENTIFICATION_WINDOWS = 5;
+
+    /**
+     * Variance of the temperature rate measured over a window, (degrees C/s)^2, mostly from the
+     * sensor's quantization. Scales the least squares covariance into the parameters' variance.
+     */
+    static constexpr float RATE_MEASUREMENT_VARIANCE = 0.01f;
+
+    /// The model is trusted once the standard deviation of `b` is less than this fraction of it.
+    static constexpr float MAX_RELATIVE_UNCERTAINTY = 0.2f;
+
+    /// Identified time constants outside of these bounds, in seconds, are not trusted.
+    static constexpr float MIN_TIME_CONSTANT = 5.0f;
+    static constexpr float MAX_TIME_CONSTANT = 1'000.0f;
+
+    /// Calls further apart than this, in microseconds, don't contribute to the model.
+    static constexpr uint32_t MAX_CONTROL_PERIOD = 100'000;
+
+    /**
+     * How far ahead the predictive controller looks, in seconds. Covers the lag between the
+     * heater and the temperature sensor that the first order model doesn't capture.
+     */
+    static constexpr float PREDICTION_HORIZON = 2.0f;
+
+    /// Time constant, in seconds, with which the reference approaches the setpoint.
+    static constexpr float REFERENCE_TIME_CONSTANT = 1.0f;
+
+    /// Integral gain of the trim on top of the predictive controller, duty per degree C second.
+    static constexpr float TRIM_GAIN = 0.002f;
+    static constexpr float MAX_TRIM = 0.2f;
+    /// The trim only integrates within this many degrees C of the setpoint.
+    static constexpr float TRIM_ERROR_BAND = 1.0f;
+
+    /// Bounds within which the temperature is considered stable, degrees C and microseconds.
+    static constexpr float STABLE_TEMPERATURE_TOLERANCE = 0.5f;
+    static constexpr uint32_t STABLE_TEMPERATURE_TIME = 2'000'000;
+
     /**
      * Normal operating temperature is ~40 degrees C, and RM manual says the optimal operating
      * temperature is ~15-20 degrees C above the normal operating temperature of the board.
@@ -82,6 +180,44 @@ class ImuHeater
     Drivers *drivers;
 
     modm::Pid<float> imuTemperatureController;
+
+    /// Model parameters `a` and `b`, see the class description, in degrees C/s and 1/s.
+    float modelHeatingRate = NOMINAL_FULL_DUTY_TEMPERATURE_RISE / NOMINAL_TIME_CONSTANT;
+    float modelDecayRate = 1.0f / NOMINAL_TIME_CONSTANT;
+    /// Covariance of the model parameters, row major.
+    float modelCovariance[4] = {INITIAL_PARAMETER_VARIANCE, 0, 0, INITIAL_PARAMETER_VARIANCE};
+    float ambientTemperature = 0;
+    bool modelIdentified = false;
+    int identificationWindows = 0;
+
+    /// Time integrals of the duty and temperature over the current window, and its start.
+    float windowDutyIntegral = 0;
+    float windowTemperatureIntegral = 0;
+    float windowStartTemperature = 0;
+    uint32_t windowDuration = 0;
+
+    float trim = 0;
+
+    /// The duty applied since the previous call, and when that call was.
+    float prevDuty = 0;
+    float prevTemperature = 0;
+    uint32_t prevTime = 0;
+    bool hasPrevTemperature = false;
+
+    /// When the temperature last entered the stable tolerance, valid while `inTolerance`.
+    uint32_t toleranceEnterTime = 0;
+    bool inTolerance = false;
+    bool temperatureStable = false;
+
+    /// Accumulates a measurement `dt` seconds long, updating the model when a window is done.
+    void identifyModel(float temperature, uint32_t dt);
+
+    void updateModel(float dutyMean, float temperatureMean, float temperatureRate);
+
+    /// @return The duty computed by the predictive controller, `dt` seconds after the last.
+    float runPredictiveController(float temperature, float dt);
+
+    void updateStability(float temperature, uint32_t time);
 };
 }  // namespace tap::communication::sensors::imu_heater
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "digital_limit_switch.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#endif
+
+namespace tap::communication::sensors::limit_switch
+{
+DigitalLimitSwitch::DigitalLimitSwitch(
+    gpio::Digital *digital,
+    gpio::Digital::InputPin pin,
+    bool activeHigh,
+    uint32_t debounceTime)
+    : digital(digital),
+      pin(pin),
+      activeHigh(activeHigh),
+      debounceTime(debounceTime)
+{
+}
+
+DigitalLimitSwitch::~DigitalLimitSwitch()
+{
+    if (initialized)
+    {
+        digital->disableInputInterrupt(pin);
+    }
+}
+
+bool DigitalLimitSwitch::initialize()
+{
+    depressed = digital->read(pin) == activeHigh;
+    bouncing = false;
+    pressPending = false;
+    numPresses = 0;
+    // So that the first edge is never ignored as bounce
+    lastEdgeTime = arch::clock::getTimeMicroseconds() - debounceTime;
+    initialized =
+        digital->enableInputInterrupt(pin, gpio::Digital::InputTrigger::BothEdges, onEdge, this);
+    return initialized;
+}
+
+bool DigitalLimitSwitch::getLimitSwitchDepressed() const
+{
+    if (bouncing && arch::clock::getTimeMicroseconds() - lastEdgeTime >= debounceTime)
+    {
+        // An edge was ignored, so the state set by the last accepted edge may be stale
+        return digital->read(pin) == activeHigh;
+    }
+    return depressed;
+}
+
+bool DigitalLimitSwitch::getPressEvent(uint32_t *time)
+{
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+    if (!pressPending)
+    {
+        return false;
+    }
+    pressPending = false;
+    if (time != nullptr)
+    {
+        *time = lastPressTime;
+    }
+    return true;
+}
+
+void DigitalLimitSwitch::onEdge(void *context, gpio::Digital::InputPin, bool level, uint32_t time)
+{
+    DigitalLimitSwitch &limitSwitch = *static_cast<DigitalLimitSwitch *>(context);
+
+    if (time - limitSwitch.lastEdgeTime < limitSwitch.debounceTime)
+    {
+        limitSwitch.bouncing = true;
+        return;
+    }
+
+    const bool pressed = level == limitSwitch.activeHigh;
+    limitSwitch.depressed = pressed;
+    limitSwitch.bouncing = false;
+    limitSwitch.lastEdgeTime = time;
+    if (pressed)
+    {
+        limitSwitch.lastPressTime = time;
+        limitSwitch.numPresses = limitSwitch.numPresses + 1;
+        limitSwitch.pressPending = true;
+    }
+}
+}  // namespace tap::communication::sensors::limit_switch
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_DIGITAL_LIMIT_SWITCH_HPP_
+#define TAPROOT_DIGITAL_LIMIT_SWITCH_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/gpio/digital.hpp"
+#include "tap/util_macros.hpp"
+
+#include "limit_switch_interface.hpp"
+
+namespace tap::communication::sensors::limit_switch
+{
+/**
+ * A limit switch or beam break on a digital input pin whose edges are captured by the pin's
+ * EXTI interrupt (see `gpio::Digital::enableInputInterrupt`), rather than polled. Each press is
+ * timestamped when the edge happens, so homing positions and shot times are exact, and presses
+ * shorter than the control loop period are not missed.
+ *
+ * Mechanical switches bounce when they close. An edge less than `debounceTime` after the last
+ * accepted edge is ignored, and `getLimitSwitchDepressed` reads the pin once the switch has
+ * settled. Since a rising edge can only happen if the pin was low, every accepted press edge is
+ * counted as a press, even if the release before it was ignored as bounce.
+ */
+class DigitalLimitSwitch : public LimitSwitchInterface
+{
+public:
+    /// Default minimum time between accepted edges, in microseconds.
+    static constexpr uint32_t DEFAULT_DEBOUNCE_TIME = 1'000;
+
+    /**
+     * @param[in] digital The Digital object that has access to the pin.
+     * @param[in] pin The pin, which must be listed in the `interrupt_pins` lbuild option.
+     * @param[in] activeHigh `true` if the pin is high while the switch is depressed.
+     * @param[in] debounceTime The minimum time between accepted edges, in microseconds. Use 0
+     *      for sensors that don't bounce, such as beam breaks.
+     */
+    DigitalLimitSwitch(
+        gpio::Digital *digital,
+        gpio::Digital::InputPin pin,
+        bool activeHigh = true,
+        uint32_t debounceTime = DEFAULT_DEBOUNCE_TIME);
+    DISALLOW_COPY_AND_ASSIGN(DigitalLimitSwitch)
+    ~DigitalLimitSwitch();
+
+    /**
+     * Reads the switch's initial state and enables the pin's interrupt.
+     *
+     * @return `false` if the pin has no interrupt.
+     */
+    bool initialize();
+
+    bool getLimitSwitchDepressed() const override;
+
+    /**
+     * @param[out] time If not `nullptr`, set to the time of the press, in microseconds (see
+     *      `tap::arch::clock::getTimeMicroseconds`).
+     * @return `true` the first time this is called after the switch was pressed, like
+     *      `Timeout::execute`.
+     */
+    bool getPressEvent(uint32_t *time = nullptr);
+
+    /// @return The time of the most recent press, in microseconds.
+    uint32_t getLastPressTime() const { return lastPressTime; }
+
+    /// @return The number of presses since `initialize`.
+    uint32_t getNumPresses() const { return numPresses; }
+
+private:
+    gpio::Digital *digital;
+    const gpio::Digital::InputPin pin;
+    const bool activeHigh;
+    const uint32_t debounceTime;
+
+    bool initialized = false;
+
+    /// The state set by the last accepted edge.
+    volatile bool depressed = false;
+    /// `true` if an edge was ignored since the last accepted edge, so `depressed` may be stale.
+    volatile bool bouncing = false;
+    volatile bool pressPending = false;
+    volatile uint32_t lastEdgeTime = 0;
+    volatile uint32_t lastPressTime = 0;
+    volatile uint32_t numPresses = 0;
+
+    /// Called from the pin's interrupt with each edge.
+    static void onEdge(void *context, gpio::Digital::InputPin pin, bool level, uint32_t time);
+};  // class DigitalLimitSwitch
+}  // namespace tap::communication::sensors::limit_switch
+
+#endif  // TAPROOT_DIGITAL_LIMIT_SWITCH_HPP_
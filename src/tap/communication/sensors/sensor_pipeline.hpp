@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SENSOR_PIPELINE_HPP_
+#define TAPROOT_SENSOR_PIPELINE_HPP_
+
+#include <cmath>
+#include <tuple>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+namespace tap::communication::sensors
+{
+/**
+ * A sample passing through a `SensorPipeline`. A stage that finds the sample unusable clears
+ * `valid` rather than changing `value`, so later stages still see the value.
+ */
+struct SensorSample
+{
+    float value;
+    bool valid;
+};
+
+/**
+ * Processes raw sensor samples through a fixed sequence of stages, for example calibration,
+ * filtering, unit conversion and validity gating. The stages are composed at compile time, so
+ * calling `update` costs the same as calling each stage's `process` by hand:
+ *
+ * ```cpp
+ * SensorPipeline<LinearCalibration, MedianFilter<5>, ExponentialFilter, RangeGate> pipeline(
+ *     LinearCalibration(0.01f, -1.0f),
+ *     MedianFilter<5>(),
+ *     ExponentialFilter(0.2f),
+ *     RangeGate(0.0f, 10.0f));
+ *
+ * float value = pipeline.update(drivers->analog.read(pin));
+ * bool valid = pipeline.isValid();
+ * ```
+ *
+ * A stage is any type with a `void process(SensorSample &sample)` member function. Stages are
+ * run in the order they are listed.
+ */
+template <typename... Stages>
+class SensorPipeline
+{
+public:
+    explicit SensorPipeline(Stages... stages) : stages(stages...) {}
+
+    /**
+     * Runs a raw sample through all stages.
+     *
+     * @return The output of the last stage.
+     */
+    float update(float raw)
+    {
+        output = {raw, true};
+        std::apply([this](Stages &...stage) { (stage.process(output), ...); }, stages);
+        return output.value;
+    }
+
+    /**
+     * Runs a batch of raw samples through all stages, oldest first, so that filter stages see
+     * every sample.
+     *
+     * @return The output of the last stage for the newest sample.
+     */
+    template <typename T>
+    float update(const T *raw, int numSamples)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            update(static_cast<float>(raw[i]));
+        }
+        return output.value;
+    }
+
+    /// @return The output of the last stage for the most recent sample.
+    float getValue() const { return output.value; }
+
+    /// @return `false` if any stage rejected the most recent sample.
+    bool isValid() const { return output.valid; }
+
+    /// @return The stage at index `I`, for example to change its parameters.
+    template <std::size_t I>
+    auto &getStage()
+    {
+        return std::get<I>(stages);
+    }
+
+private:
+    std::tuple<Stages...> stages;
+
+    SensorSample output = {0.0f, false};
+};
+
+/// Maps a sample linearly, `value = scale * value + offset`.
+class LinearCalibration
+{
+public:
+    LinearCalibration(float scale, float offset) : scale(scale), offset(offset) {}
+
+    void process(SensorSample &sample) { sample.value = scale * sample.value + offset; }
+
+private:
+    float scale;
+    float offset;
+};
+
+/// Replaces a sample with its absolute value.
+class AbsoluteValue
+{
+public:
+    void process(SensorSample &sample) { sample.value = fabsf(sample.value); }
+};
+
+/**
+ * Maps a sample to `1 / value + offset`, the model of sensors such as IR distance sensors whose
+ * output is inversely proportional to the measured quantity.
+ */
+class Reciprocal
+{
+public:
+    explicit Reciprocal(float offset = 0.0f) : offset(offset) {}
+
+    void process(SensorSample &sample) { sample.value = 1.0f / sample.value + offset; }
+
+private:
+    float offset;
+};
+
+/**
+ * Replaces a sample with the median of the last `N` samples, which removes isolated spikes
+ * without the lag a low pass filter needs to reject them. Until `N` samples have been seen, the
+ * median of the samples seen so far.
+ */
+template <int N>
+class MedianFilter
+{
+public:
+    static_assert(N > 0, "N must be positive");
+
+    void process(SensorSample &sample)
+    {
+        window[next] = sample.value;
+        next = (next + 1) % N;
+        if (count < N)
+        {
+            count++;
+        }
+
+        // Insertion sort, N is small
+        float sorted[N];
+        for (int i = 0; i < count; i++)
+        {
+            int j = i;
+            for (; j > 0 && sorted[j - 1] > window[i]; j--)
+            {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = window[i];
+        }
+        sample.value = sorted[count / 2];
+    }
+
+private:
+    float window[N] = {};
+    int next = 0;
+    int count = 0;
+};
+
+/// Low pass filters samples, see `tap::algorithms::lowPassFilter`.
+class ExponentialFilter
+{
+public:
+    /**
+     * @param[in] alpha The amount of smoothing, see `tap::algorithms::lowPassFilter`.
+     * @param[in] initialValue The value the filter starts from.
+     */
+    explicit ExponentialFilter(float alpha, float initialValue = 0.0f)
+        : alpha(alpha),
+          value(initialValue)
+    {
+    }
+
+    void process(SensorSample &sample)
+    {
+        value = tap::algorithms::lowPassFilter(value, sample.value, alpha);
+        sample.value = value;
+    }
+
+    void setAlpha(float alpha) { this->alpha = alpha; }
+
+private:
+    float alpha;
+    float value;
+};
+
+/// Marks samples outside of (`min`, `max`), exclusive, as invalid.
+class RangeGate
+{
+public:
+    RangeGate(float min, float max) : min(min), max(max) {}
+
+    void process(SensorSample &sample)
+    {
+        sample.valid = sample.valid && sample.value > min && sample.value < max;
+    }
+
+private:
+    float min;
+    float max;
+};
+}  // namespace tap::communication::sensors
+
+#endif  // TAPROOT_SENSOR_PIPELINE_HPP_
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BYTE_TRANSPORT_HPP_
+#define TAPROOT_BYTE_TRANSPORT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tap::communication::serial
+{
+/**
+ * A source and sink of bytes that a `DJISerial` can run over instead of a `Uart` port, for
+ * example a USB interface (see `UsbTransport`). Reads and writes must not wait.
+ */
+class ByteTransport
+{
+public:
+    virtual ~ByteTransport() = default;
+
+    /// Called by `DJISerial::initialize`. Does nothing by default.
+    virtual void initialize() {}
+
+    /**
+     * @param[out] data Buffer to read up to `length` bytes into.
+     * @return The number of bytes read, 0 if none are available.
+     */
+    virtual std::size_t read(uint8_t *data, std::size_t length) = 0;
+
+    /**
+     * Writes as many of the `length` bytes of `data` as fit in the transport's buffer.
+     *
+     * @return The number of bytes written.
+     */
+    virtual std::size_t write(const uint8_t *data, std::size_t length) = 0;
+};
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_BYTE_TRANSPORT_HPP_
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "coprocessor_link.hpp"
+
+#include <algorithm>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+using namespace tap::arch;
+
+namespace tap::communication::serial
+{
+CoprocessorLink::CoprocessorLink(
+    Drivers *drivers,
+    Uart::UartPort port,
+    const CoprocessorLinkConfig &config)
+    : DJISerial(drivers, port),
+      config(config),
+      handlers(),
+      pendingAcks(),
+      recentAckedRx(),
+      txFrame(),
+      pingTimer(config.pingPeriodMs),
+      clockSync({config.maxRoundTripUs, config.syncTimeoutMs})
+{
+}
+
+CoprocessorLink::CoprocessorLink(
+    Drivers *drivers,
+    ByteTransport *transport,
+    const CoprocessorLinkConfig &config)
+    : DJISerial(drivers, transport),
+      config(config),
+      handlers(),
+      pendingAcks(),
+      recentAckedRx(),
+      txFrame(),
+      pingTimer(config.pingPeriodMs),
+      clockSync({config.maxRoundTripUs, config.syncTimeoutMs})
+{
+}
+
+bool CoprocessorLink::registerHandler(uint16_t messageType, MessageHandler *handler)
+{
+    const bool alreadyRegistered = std::any_of(
+        handlers.begin(),
+        handlers.begin() + numHandlers,
+        [&](const HandlerEntry &entry) { return entry.messageType == messageType; });
+
+    if (messageType > MAX_USER_MESSAGE_TYPE || handler == nullptr || alreadyRegistered ||
+        numHandlers >= MAX_HANDLERS)
+    {
+        RAISE_ERROR(drivers, "error adding coprocessor msg handler");
+        return false;
+    }
+
+    handlers[numHandlers++] = {messageType, handler};
+    return true;
+}
+
+bool CoprocessorLink::sendBytes(
+    uint16_t messageType,
+    const uint8_t *data,
+    uint16_t length,
+    bool requireAck)
+{
+    if (length > MAX_TX_DATA_SIZE)
+    {
+        return false;
+    }
+
+    if (!requireAck)
+    {
+        return writeFrame(txFrame, buildFrame(txFrame, messageType, data, length));
+    }
+
+    auto slot = std::find_if(
+        pendingAcks.begin(),
+        pendingAcks.end(),
+        [](const PendingAck &pending) { return !pending.used; });
+    if (length > MAX_ACKED_DATA_SIZE || slot == pendingAcks.end())
+    {
+        return false;
+    }
+
+    // The frame is kept so it can be sent again as is, with the same sequence number
+    slot->used = true;
+    slot->seq = txSeq;
+    slot->messageType = messageType;
+    slot->retransmissions = 0;
+    slot->sendTimeUs = clock::getTimeMicroseconds64();
+    slot->frameLength = buildFrame(slot->frame, messageType | ACK_REQUESTED_FLAG, data, length);
+    return writeFrame(slot->frame, slot->frameLength);
+}
+
+void CoprocessorLink::update()
+{
+    updateSerial();
+
+    retransmitPendingAcks(clock::getTimeMicroseconds64());
+
+    if (config.pingPeriodMs != 0 && pingTimer.execute())
+    {
+        lastPingSendTimeUs = clock::getTimeMicroseconds64();
+        pingOutstanding = true;
+        send(MESSAGE_TYPE_PING, PingMessage{lastPingSendTimeUs});
+    }
+}
+
+void CoprocessorLink::messageReceiveCallback(const ReceivedSerialMessage &completeMessage)
+{
+    const uint64_t rxTimeUs = clock::getTimeMicroseconds64();
+    const uint8_t seq = completeMessage.header.seq;
+    const uint16_t messageType = completeMessage.messageType & ~ACK_REQUESTED_FLAG;
+
+    trackRxSeq(seq);
+
+    if ((completeMessage.messageType & ACK_REQUESTED_FLAG) != 0)
+    {
+        // Ack retransmissions too, since the retransmission means the first ack was lost
+        send(MESSAGE_TYPE_ACK, AckMessage{seq, messageType});
+        if (checkRetransmittedRx(seq, messageType))
+        {
+            return;
+        }
+    }
+
+    switch (messageType)
+    {
+        case MESSAGE_TYPE_PING:
+            handlePing(completeMessage, rxTimeUs);
+            return;
+        case MESSAGE_TYPE_PONG:
+            handlePong(completeMessage, rxTimeUs);
+            return;
+        case MESSAGE_TYPE_ACK:
+            handleAck(completeMessage);
+            return;
+        default:
+            break;
+    }
+
+    for (int i = 0; i < numHandlers; i++)
+    {
+        if (handlers[i].messageType == messageType)
+        {
+            (*handlers[i].handler)(completeMessage, rxTimeUs);
+            return;
+        }
+    }
+}
+
+int CoprocessorLink::getNumPendingAcks() const
+{
+    return std::count_if(
+        pendingAcks.begin(),
+        pendingAcks.end(),
+        [](const PendingAck &pending) { return pending.used; });
+}
+
+uint16_t CoprocessorLink::buildFrame(
+    uint8_t *frame,
+    uint16_t messageType,
+    const uint8_t *data,
+    uint16_t length)
+{
+    frame[0] = SERIAL_HEAD_BYTE;
+    convertToLittleEndian(length, frame + 1);
+    frame[3] = txSeq++;
+    frame[4] = algorithms::calculateCRC8(frame, 4);
+    convertToLittleEndian(messageType, frame + 5);
+    memcpy(frame + sizeof(FrameHeader) + 2, data, length);
+
+    const uint16_t crcOffset = sizeof(FrameHeader) + 2 + length;
+    convertToLittleEndian(algorithms::calculateCRC16(frame, crcOffset), frame + crcOffset);
+    return crcOffset + 2;
+}
+
+bool CoprocessorLink::writeFrame(const uint8_t *frame, uint16_t length)
+{
+    // A frame the Uart only took part of is skipped over by the receiver's head byte search
+    if (writeBytes(frame, length) != length)
+    {
+        numTxFailures++;
+        return false;
+    }
+    return true;
+}
+
+void CoprocessorLink::trackRxSeq(uint8_t seq)
+{
+    if (!rxSeqValid)
+    {
+        rxSeqValid = true;
+        expectedRxSeq = seq + 1;
+        return;
+    }
+
+    // Frames from behind the expected sequence number are retransmissions, not gaps
+    const uint8_t gap = seq - expectedRxSeq;
+    if (gap < 0x80)
+    {
+        numDroppedFrames += gap;
+        expectedRxSeq = seq + 1;
+    }
+}
+
+bool CoprocessorLink::checkRetransmittedRx(uint8_t seq, uint16_t messageType)
+{
+    for (const RecentAckedRx &recent : recentAckedRx)
+    {
+        if (recent.used && recent.seq == seq && recent.messageType == messageType)
+        {
+            return true;
+        }
+    }
+
+    recentAckedRx[nextRecentAckedRx] = {true, seq, messageType};
+    nextRecentAckedRx = (nextRecentAckedRx + 1) % RECENT_ACKED_RX_SIZE;
+    return false;
+}
+
+void CoprocessorLink::handleAck(const ReceivedSerialMessage &message)
+{
+    if (message.header.dataLength != sizeof(AckMessage))
+    {
+        return;
+    }
+    AckMessage ack;
+    memcpy(&ack, message.data, sizeof(ack));
+
+    for (PendingAck &pending : pendingAcks)
+    {
+        if (pending.used && pending.seq == ack.seq && pending.messageType == ack.messageType)
+        {
+            pending.used = false;
+        }
+    }
+}
+
+void CoprocessorLink::handlePing(const ReceivedSerialMessage &message, uint64_t rxTimeUs)
+{
+    if (message.header.dataLength != sizeof(PingMessage))
+    {
+        return;
+    }
+    PingMessage ping;
+    memcpy(&ping, message.data, sizeof(ping));
+
+    send(
+        MESSAGE_TYPE_PONG,
+        PongMessage{ping.sendTimeUs, rxTimeUs, clock::getTimeMicroseconds64()});
+}
+
+void CoprocessorLink::handlePong(const ReceivedSerialMessage &message, uint64_t rxTimeUs)
+{
+    if (message.header.dataLength != sizeof(PongMessage))
+    {
+        return;
+    }
+    PongMessage pong;
+    memcpy(&pong, message.data, sizeof(pong));
+
+    // Only the reply to the latest ping is used, a late reply to an earlier ping is stale
+    if (!pingOutstanding || pong.pingSendTimeUs != lastPingSendTimeUs)
+    {
+        return;
+    }
+    pingOutstanding = false;
+
+    clockSync.addExchange(pong.pingSendTimeUs, pong.pingReceiveTimeUs, pong.sendTimeUs, rxTimeUs);
+}
+
+void CoprocessorLink::retransmitPendingAcks(uint64_t nowUs)
+{
+    for (PendingAck &pending : pendingAcks)
+    {
+        if (!pending.used || nowUs - pending.sendTimeUs < config.ackTimeoutUs)
+        {
+            continue;
+        }
+
+        if (pending.retransmissions >= config.maxRetransmissions)
+        {
+            pending.used = false;
+            numAckFailures++;
+            continue;
+        }
+
+        pending.retransmissions++;
+        pending.sendTimeUs = nowUs;
+        numRetransmissions++;
+        writeFrame(pending.frame, pending.frameLength);
+    }
+}
+}  // namespace tap::communication::serial
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_COPROCESSOR_LINK_HPP_
+#define TAPROOT_COPROCESSOR_LINK_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "tap/architecture/clock_sync.hpp"
+#include "tap/architecture/periodic_timer.hpp"
+#include "tap/util_macros.hpp"
+
+#include "dji_serial.hpp"
+
+namespace tap::communication::serial
+{
+/// Configuration of a `CoprocessorLink`.
+struct CoprocessorLinkConfig
+{
+    /// Time between pings, or 0 to never ping (and not sync the clock).
+    uint32_t pingPeriodMs = 100;
+    /// Time to wait for an ack before sending a message again.
+    uint32_t ackTimeoutUs = 5'000;
+    /// Number of times a message is sent again before it is given up on.
+    uint8_t maxRetransmissions = 3;
+    /// Clock sync samples with a longer round trip than this are discarded.
+    uint32_t maxRoundTripUs = 2'000;
+    /// Time without an accepted clock sync sample after which the clock is no longer synced.
+    uint32_t syncTimeoutMs = 1'000;
+};
+
+/**
+ * A link to a coprocessor (such as a Jetson or NUC running vision) built on `DJISerial`'s
+ * framing, so that each team doesn't have to write its own protocol on top of
+ * `messageReceiveCallback`. Adds to the framing, with the timing set by a
+ * `CoprocessorLinkConfig`:
+ *
+ * - Typed messages: handlers are registered per message type with `registerHandler`, and
+ *   `TypedMessageHandler` decodes the message data into a struct. `send` sends a struct.
+ * - Sequence numbers: every frame sent has the next sequence number, and gaps in the sequence
+ *   numbers received are counted as dropped frames.
+ * - Acks: messages sent with `requireAck` (for example commands, as opposed to streamed data)
+ *   have `ACK_REQUESTED_FLAG` set in their message type. The receiver replies with an
+ *   `AckMessage`, and the message is sent again every `ackTimeoutUs` until it is acked or
+ *   `maxRetransmissions` is reached. A retransmitted message that was already received is acked
+ *   again but not passed to its handler again.
+ * - Clock sync: every `pingPeriodMs` a `PingMessage` is sent, which the coprocessor answers
+ *   with a `PongMessage` holding when it received the ping and sent the pong. From the four
+ *   timestamps a `tap::arch::ClockSync` tracks the offset and drift of the coprocessor's clock,
+ *   discarding samples with a round trip longer than `maxRoundTripUs`, so `toLocalTimeUs`
+ *   converts timestamps in aim commands to local time to within a few microseconds between
+ *   pings. Pings from the coprocessor are
+ *   answered the same way so it can sync to this clock.
+ *
+ * Message types `MESSAGE_TYPE_PING` and up are reserved for the link. The bit
+ * `ACK_REQUESTED_FLAG` of the message type is reserved too, so user message types are at most
+ * `MAX_USER_MESSAGE_TYPE`. Multi-byte fields are little endian.
+ *
+ * For high bandwidth, configure the port's `taproot:communication:serial:uart_port_*.baud_rate`
+ * lbuild option to a few Mbps (the coprocessor's USB to serial adapter permitting) and enable
+ * its `rx_dma` option, so bytes are received by DMA instead of an interrupt per byte.
+ * `initialize` initializes the port with the configured baud rate. Received messages are
+ * timestamped when `update` parses them, so call `update` often (every main loop) to keep
+ * receive latency low and known. The link can instead run over a `ByteTransport` such as
+ * `UsbTransport`, which avoids the USB to serial adapter altogether.
+ *
+ * The link is not reentrant, so call all of its functions from the same context.
+ */
+class CoprocessorLink : public DJISerial
+{
+public:
+    /// Set in the message type of messages that should be acked.
+    static constexpr uint16_t ACK_REQUESTED_FLAG = 0x8000;
+    static constexpr uint16_t MESSAGE_TYPE_PING = 0x7ff0;
+    static constexpr uint16_t MESSAGE_TYPE_PONG = 0x7ff1;
+    static constexpr uint16_t MESSAGE_TYPE_ACK = 0x7ff2;
+    static constexpr uint16_t MAX_USER_MESSAGE_TYPE = MESSAGE_TYPE_PING - 1;
+
+    /// Maximum number of message types handlers can be registered for.
+    static constexpr int MAX_HANDLERS = 16;
+    /// Maximum number of messages waiting to be acked at once.
+    static constexpr int MAX_PENDING_ACKS = 4;
+    /// Maximum data size of messages sent, and of messages sent with `requireAck`.
+    static constexpr uint16_t MAX_TX_DATA_SIZE = 256;
+    static constexpr uint16_t MAX_ACKED_DATA_SIZE = 64;
+    /// Bytes in a frame besides the data: the frame header, message type and CRC16.
+    static constexpr uint16_t FRAME_OVERHEAD = sizeof(FrameHeader) + 2 + 2;
+
+    /// Sent every `CoprocessorLinkConfig::pingPeriodMs`.
+    struct PingMessage
+    {
+        uint64_t sendTimeUs;  ///< Sender's time when the ping was sent.
+    } modm_packed;
+
+    /// Sent in reply to a `PingMessage`. All times are in the sender of the pong's clock.
+    struct PongMessage
+    {
+        uint64_t pingSendTimeUs;     ///< `PingMessage::sendTimeUs` of the ping replied to.
+        uint64_t pingReceiveTimeUs;  ///< When the ping was received.
+        uint64_t sendTimeUs;         ///< When the pong was sent.
+    } modm_packed;
+
+    /// Sent in reply to a message with `ACK_REQUESTED_FLAG` set.
+    struct AckMessage
+    {
+        uint8_t seq;           ///< Sequence number of the frame acked.
+        uint16_t messageType;  ///< Message type of the message acked, without the flag.
+    } modm_packed;
+
+    /**
+     * Called with each message received of the type it is registered for. The message references
+     * the receive buffer directly and is only valid until the handler returns.
+     */
+    class MessageHandler
+    {
+    public:
+        virtual ~MessageHandler() = default;
+
+        /**
+         * @param[in] message The message received. Its message type has `ACK_REQUESTED_FLAG`
+         *      set if the sender requested an ack, which the link has already sent.
+         * @param[in] rxTimeUs Local time when the message was parsed, see
+         *      `tap::arch::clock::getTimeMicroseconds64`.
+         */
+        virtual void operator()(const ReceivedSerialMessage &message, uint64_t rxTimeUs) = 0;
+    };
+
+    /**
+     * A `MessageHandler` whose messages hold a `T`. Messages whose data is not the size of `T`
+     * are counted by `getNumWrongSizeMessages` and otherwise ignored.
+     */
+    template <typename T>
+    class TypedMessageHandler : public MessageHandler
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    public:
+        void operator()(const ReceivedSerialMessage &message, uint64_t rxTimeUs) final
+        {
+            if (message.header.dataLength != sizeof(T))
+            {
+                numWrongSizeMessages++;
+                return;
+            }
+            T data;
+            memcpy(&data, message.data, sizeof(T));
+            onMessage(data, rxTimeUs);
+        }
+
+        uint32_t getNumWrongSizeMessages() const { return numWrongSizeMessages; }
+
+    protected:
+        virtual void onMessage(const T &data, uint64_t rxTimeUs) = 0;
+
+    private:
+        uint32_t numWrongSizeMessages = 0;
+    };
+
+    CoprocessorLink(
+        Drivers *drivers,
+        Uart::UartPort port,
+        const CoprocessorLinkConfig &config = CoprocessorLinkConfig());
+
+    /// Constructs a link that runs over `transport` instead of a `Uart` port.
+    CoprocessorLink(
+        Drivers *drivers,
+        ByteTransport *transport,
+        const CoprocessorLinkConfig &config = CoprocessorLinkConfig());
+    DISALLOW_COPY_AND_ASSIGN(CoprocessorLink)
+
+    /**
+     * Registers a handler for messages of the given type. Only one handler may be registered per
+     * type.
+     *
+     * @return `false` (and raises an error) if the type is reserved, already has a handler, or
+     *      `MAX_HANDLERS` handlers are already registered, `true` otherwise.
+     */
+    bool registerHandler(uint16_t messageType, MessageHandler *handler);
+
+    /**
+     * Sends a message. If `requireAck` is `true` the message is sent again until it is acked, see
+     * the class comment.
+     *
+     * @return `false` if `length` is too long, all `MAX_PENDING_ACKS` slots are used, or the
+     *      `Uart` didn't take the whole frame, `true` otherwise.
+     */
+    bool sendBytes(uint16_t messageType, const uint8_t *data, uint16_t length, bool requireAck);
+
+    /// Sends `data` as the data of a message, see `sendBytes`.
+    template <typename T>
+    bool send(uint16_t messageType, const T &data, bool requireAck = false)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        static_assert(sizeof(T) <= MAX_TX_DATA_SIZE, "message is too long");
+        return sendBytes(
+            messageType,
+            reinterpret_cast<const uint8_t *>(&data),
+            sizeof(T),
+            requireAck);
+    }
+
+    /**
+     * Receives and handles all messages, sends messages that weren't acked in time again, and
+     * sends a ping when one is due. Call every main loop.
+     */
+    void update();
+
+    void messageReceiveCallback(const ReceivedSerialMessage &completeMessage) override;
+
+    /**
+     * @return `true` if at least two clock sync samples have been accepted, so the drift is
+     *      estimated, and one was accepted in the last `CoprocessorLinkConfig::syncTimeoutMs`.
+     */
+    bool isClockSynced() const { return clockSync.isSynced(); }
+
+    /// @return The coprocessor's time at the given local time, both in microseconds.
+    uint64_t toRemoteTimeUs(uint64_t localTimeUs) const
+    {
+        return clockSync.localToHostUs(localTimeUs);
+    }
+
+    /// @return The local time at the given coprocessor time, both in microseconds.
+    uint64_t toLocalTimeUs(uint64_t remoteTimeUs) const
+    {
+        return clockSync.hostToLocalUs(remoteTimeUs);
+    }
+
+    /// @return The coprocessor's clock minus the local clock at the last accepted sample.
+    int64_t getClockOffsetUs() const { return clockSync.getOffsetUs(); }
+
+    /// @return How much faster the coprocessor's clock runs than the local clock, in ppm.
+    float getClockDriftPpm() const { return clockSync.getDriftPpm(); }
+
+    /// @return The round trip time of the last accepted clock sync sample.
+    uint32_t getRoundTripTimeUs() const { return clockSync.getRoundTripTimeUs(); }
+
+    /**
+     * @return The sync of the coprocessor's clock, for code that converts timestamps but
+     *      shouldn't depend on the link.
+     */
+    const tap::arch::ClockSync &getClockSync() const { return clockSync; }
+
+    /// @return The number of messages waiting to be acked.
+    int getNumPendingAcks() const;
+
+    /// @return The number of frames missing from the sequence numbers received.
+    uint32_t getNumDroppedFrames() const { return numDroppedFrames; }
+
+    /// @return The number of messages sent again because they weren't acked in time.
+    uint32_t getNumRetransmissions() const { return numRetransmissions; }
+
+    /// @return The number of messages given up on after `maxRetransmissions` retransmissions.
+    uint32_t getNumAckFailures() const { return numAckFailures; }
+
+    /// @return The number of frames the `Uart` didn't take in full.
+    uint32_t getNumTxFailures() const { return numTxFailures; }
+
+    /// @return The number of clock sync samples discarded for too long a round trip.
+    uint32_t getNumRejectedSyncSamples() const { return clockSync.getNumRejectedExchanges(); }
+
+private:
+    /// Number of recently received acked messages remembered to detect retransmissions.
+    static constexpr int RECENT_ACKED_RX_SIZE = 4;
+
+    struct HandlerEntry
+    {
+        uint16_t messageType;
+        MessageHandler *handler;
+    };
+
+    struct PendingAck
+    {
+        bool used = false;
+        uint8_t seq;
+        uint16_t messageType;
+        uint8_t retransmissions;
+        uint64_t sendTimeUs;
+        uint16_t frameLength;
+        uint8_t frame[MAX_ACKED_DATA_SIZE + FRAME_OVERHEAD];
+    };
+
+    struct RecentAckedRx
+    {
+        bool used = false;
+        uint8_t seq;
+        uint16_t messageType;
+    };
+
+    CoprocessorLinkConfig config;
+
+    std::array<HandlerEntry, MAX_HANDLERS> handlers;
+    int numHandlers = 0;
+
+    std::array<PendingAck, MAX_PENDING_ACKS> pendingAcks;
+    std::array<RecentAckedRx, RECENT_ACKED_RX_SIZE> recentAckedRx;
+    int nextRecentAckedRx = 0;
+
+    uint8_t txSeq = 0;
+    uint8_t txFrame[MAX_TX_DATA_SIZE + FRAME_OVERHEAD];
+
+    bool rxSeqValid = false;
+    uint8_t expectedRxSeq = 0;
+
+    tap::arch::PeriodicMilliTimer pingTimer;
+    uint64_t lastPingSendTimeUs = 0;
+    bool pingOutstanding = false;
+
+    tap::arch::ClockSync clockSync;
+
+    uint32_t numDroppedFrames = 0;
+    uint32_t numRetransmissions = 0;
+    uint32_t numAckFailures = 0;
+    uint32_t numTxFailures = 0;
+
+    /// Writes a frame into `frame`. @return The length of the frame.
+    uint16_t buildFrame(uint8_t *frame, uint16_t messageType, const uint8_t *data, uint16_t length);
+
+    bool writeFrame(const uint8_t *frame, uint16_t length);
+
+    void trackRxSeq(uint8_t seq);
+
+    /// @return `true` if the message was already received, `false` and remembers it otherwise.
+    bool checkRetransmittedRx(uint8_t seq, uint16_t messageType);
+
+    void handleAck(const ReceivedSerialMessage &message);
+    void handlePing(const ReceivedSerialMessage &message, uint64_t rxTimeUs);
+    void handlePong(const ReceivedSerialMessage &message, uint64_t rxTimeUs);
+
+    void retransmitPendingAcks(uint64_t nowUs);
+};
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_COPROCESSOR_LINK_HPP_
@@ -26,6 +26,9 @@
 #include "tap/communication/serial/uart.hpp"
 #include "tap/util_macros.hpp"
 
+#include "byte_transport.hpp"
+#include "dji_serial_config.hpp"
+
 namespace tap
 {
 class Drivers;
@@ -124,9 +127,21 @@ class DJISerial
         uint16_t CRC16;
     } modm_packed;
 
-    static const uint16_t SERIAL_RX_BUFF_SIZE = 1024;
+    /**
+     * Size of the data of `ReceivedSerialMessage`. Messages with at least this many bytes of data
+     * are discarded. Set by the `taproot:communication:serial:dji_serial_rx_buffer_size` lbuild
+     * option.
+     */
+    static const uint16_t SERIAL_RX_BUFF_SIZE = DJI_SERIAL_RX_BUFFER_SIZE;
     static const uint16_t SERIAL_HEAD_BYTE = 0xA5;
 
+    /**
+     * Size of the buffer that bytes are read into from the `Uart` before being parsed. Matches
+     * the default size of a `Uart`'s receive buffer so that the whole receive buffer can be
+     * drained with a single read.
+     */
+    static const uint16_t SERIAL_RX_CHUNK_SIZE = 256;
+
     using ReceivedSerialMessage = SerialMessage<SERIAL_RX_BUFF_SIZE>;
 
     /**
@@ -136,12 +151,20 @@ class DJISerial
      * @param[in] isRxCRCEnforcementEnabled `true` to enable Rx CRC Enforcement.
      */
     DJISerial(Drivers *drivers, Uart::UartPort port, bool isRxCRCEnforcementEnabled = true);
+
+    /**
+     * Construct a Serial object that receives from a `ByteTransport` instead of a `Uart` port.
+     *
+     * @param[in] transport the transport to receive from, which must outlive this object.
+     * @param[in] isRxCRCEnforcementEnabled `true` to enable Rx CRC Enforcement.
+     */
+    DJISerial(Drivers *drivers, ByteTransport *transport, bool isRxCRCEnforcementEnabled = true);
     DISALLOW_COPY_AND_ASSIGN(DJISerial)
     mockable ~DJISerial() = default;
 
     /**
      * Initialize serial. In particular, initializes the hardware serial
-     * specified upon construction.
+     * specified upon construction, or the `ByteTransport`.
      *
      * @note currently, only uart ports 1, 2, and 6 are enabled. Be sure
      *      to add a serial port to `uart.hpp` if you want to use the serial.
@@ -155,17 +178,29 @@ class DJISerial
      * Receive messages. Call periodically in order to receive all
      * incoming messages.
      *
+     * Reads all bytes available from the `Uart` in chunks of up to `SERIAL_RX_CHUNK_SIZE` bytes
+     * and parses every complete message among them, calling `messageReceiveCallback` once per
+     * message. When a frame header is rejected only its head byte is discarded, and the bytes
+     * after it are searched for the next head byte.
+     *
      * @note tested with a delay of 10 microseconds with referee system. The
      *      longer the timeout the more likely a message failure may occur.
      */
     mockable void updateSerial();
 
+    /**
+     * @return The number of messages received and passed to `messageReceiveCallback` since
+     *      construction. Messages that fail the CRC check are not counted.
+     */
+    uint32_t getRxMessageCount() const { return rxMessageCount; }
+
     /**
      * Called when a complete message is received. A derived class must
      * implement this in order to handle incoming messages properly.
      *
      * @param[in] completeMessage a reference to the full message that has
-     *      just been received by this class.
+     *      just been received by this class. This references the receive buffer
+     *      directly and is only valid until the callback returns.
      */
     virtual void messageReceiveCallback(const ReceivedSerialMessage &completeMessage) = 0;
 
@@ -180,24 +215,54 @@ class DJISerial
     /// The serial port you are connected to.
     Uart::UartPort port;
 
+    /// The transport received from instead of `port`, if not `nullptr`.
+    ByteTransport *transport = nullptr;
+
     /// stuff for RX, buffers to store parts of the header, state machine.
     SerialRxState djiSerialRxState;
 
     /// Message in middle of being constructed.
     ReceivedSerialMessage newMessage;
 
-    /// Most recent complete message.
-    ReceivedSerialMessage mostRecentMessage;
-
     /**
-     * The current zero indexed byte that is being read from the `Uart` class. An absolute index
-     * into the `newMessage` object. `newMessage` reinterpreted as a uint8_t array and elements read
-     * from serial are placed into the message.
+     * The number of bytes of the message body (the message type, data, and CRC16) that have been
+     * copied into `newMessage`, starting after `newMessage.header`.
      */
     uint16_t frameCurrReadByte;
 
     bool rxCrcEnabled;
 
+    uint32_t rxMessageCount = 0;
+
+    /// Bytes read from the `Uart` that are waiting to be parsed.
+    uint8_t rxChunk[SERIAL_RX_CHUNK_SIZE];
+
+    /// Index of the first byte in `rxChunk` that has not yet been parsed.
+    uint16_t rxChunkStart;
+
+    /// Index one past the last byte read into `rxChunk`.
+    uint16_t rxChunkEnd;
+
+    /**
+     * Parses the bytes in `rxChunk` between `rxChunkStart` and `rxChunkEnd`, advancing
+     * `rxChunkStart` past every byte that has been consumed. Returns once all bytes are consumed
+     * or a frame header has only been partially received, in which case the partial header is
+     * left in `rxChunk`.
+     */
+    void parseRxChunk();
+
+    /**
+     * Called once the entire message body has been copied into `newMessage`. Verifies the CRC16
+     * (if enabled) and passes the message to `messageReceiveCallback`.
+     */
+    void processCompleteMessage();
+
+    /**
+     * @return A pointer to the first `SERIAL_HEAD_BYTE` in [begin, end), or `end` if there is
+     *      none. Compares four bytes at a time.
+     */
+    static const uint8_t *findHeadByte(const uint8_t *begin, const uint8_t *end);
+
     /**
      * Calculate CRC8 of given array and compare against expectedCRC8.
      *
@@ -206,13 +271,20 @@ class DJISerial
      * @param[in] expectedCRC8 expected CRC8.
      * @return if the calculated CRC8 matches CRC8 given.
      */
-    inline bool verifyCRC8(uint8_t *message, uint32_t messageLength, uint8_t expectedCRC8)
+    inline bool verifyCRC8(const uint8_t *message, uint32_t messageLength, uint8_t expectedCRC8)
     {
         return tap::algorithms::calculateCRC8(message, messageLength) == expectedCRC8;
     }
 
 protected:
     Drivers *drivers;
+
+    /**
+     * Writes to the port or transport received from, for derived classes that also send.
+     *
+     * @return The number of bytes written.
+     */
+    std::size_t writeBytes(const uint8_t *data, std::size_t length);
 };
 
 }  // namespace tap::communication::serial
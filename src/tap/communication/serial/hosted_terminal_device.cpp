@@ -71,6 +71,12 @@ bool HostedTerminalDevice::read(char &c)
 
 void HostedTerminalDevice::write(char c) { ::std::cout << c; }
 
+std::size_t HostedTerminalDevice::tryWrite(const uint8_t *data, std::size_t length)
+{
+    ::std::cout.write(reinterpret_cast<const char *>(data), length);
+    return length;
+}
+
 void HostedTerminalDevice::flush() { ::std::cout.flush(); }
 }  // namespace tap::communication::serial
 
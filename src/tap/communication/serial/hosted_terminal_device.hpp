@@ -22,6 +22,8 @@
 
 #ifdef PLATFORM_HOSTED
 
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 
 #include "tap/util_macros.hpp"
@@ -63,6 +65,9 @@ class HostedTerminalDevice : public modm::IODevice
     using IODevice::write;
     void write(char c) override;
 
+    /// Writes all `length` bytes of `data` to stdout, which never fills.
+    std::size_t tryWrite(const uint8_t *data, std::size_t length);
+
     void flush() override;
 
 private:
@@ -19,6 +19,9 @@
 
 #include "ref_serial.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "tap/algorithms/crc.hpp"
 #include "tap/architecture/clock.hpp"
 #include "tap/architecture/endianness_wrappers.hpp"
@@ -30,14 +33,56 @@ using namespace tap::arch;
 
 namespace tap::communication::serial
 {
+/**
+ * @return `false` if decoding the messages of the specified command ID set (the upper byte of the
+ *      command ID) is compiled out by the `decode_*` lbuild options.
+ */
+static constexpr bool isRxDecodingCompiledIn(uint16_t commandIdSet)
+{
+    switch (commandIdSet)
+    {
+        case 0x0:
+            return REF_SERIAL_DECODE_GAME_DATA;
+        case 0x1:
+            return REF_SERIAL_DECODE_FIELD_DATA;
+        case 0x2:
+            return REF_SERIAL_DECODE_ROBOT_DATA;
+        default:
+            return REF_SERIAL_DECODE_ROBOT_TO_ROBOT;
+    }
+}
+
 RefSerial::RefSerial(Drivers* drivers)
     : DJISerial(drivers, bound_ports::REF_SERIAL_UART_PORT),
       robotData(),
       gameData(),
-      receivedDpsTracker(),
-      transmissionSemaphore(1)
+      robotDataSequence(0),
+      gameDataSequence(0),
+      receivedDpsTracker(DPS_TRACKER_WINDOW_MS),
+      rxMessageHandlers(),
+      rxDecodingDisabled(),
+      rxMessageTiming(),
+      gameEventListeners(),
+      gameEventListenerCount(0),
+      pendingGameEvents(0),
+      robotStatusDecoded(false),
+      vtmInput(),
+      vtmInputsReceived(0),
+      robotDataReceiveTime(0),
+      gameDataReceiveTime(0),
+      robotDataReceived(false),
+      gameDataReceived(false),
+      transmissionSemaphore(1),
+      txTokensMilliBytes(TX_TOKEN_BUCKET_CAPACITY_BYTES * 1'000),
+      txTokensLastRefillTime(0),
+      transmissionQueueStats()
 {
     refSerialOfflineTimeout.stop();
+
+    for (uint16_t i = 0; i < RX_COMMAND_TABLE_SIZE; i++)
+    {
+        rxDecodingDisabled[i] = !isRxDecodingCompiledIn(i / RX_COMMAND_IDS_PER_SET);
+    }
 }
 
 bool RefSerial::getRefSerialReceivingData() const
@@ -50,8 +95,137 @@ void RefSerial::messageReceiveCallback(const ReceivedSerialMessage& completeMess
     refSerialOfflineTimeout.restart(TIME_OFFLINE_REF_DATA_MS);
 
     updateReceivedDamage();
+
+    const int tableIndex = getRxCommandTableIndex(completeMessage.messageType);
+    if (tableIndex < 0)
+    {
+        return;
+    }
+
+    updateRxMessageTiming(rxMessageTiming[tableIndex], clock::getTimeMicroseconds());
+
+    if (!rxDecodingDisabled[tableIndex])
+    {
+        decodeRxMessage(completeMessage);
+    }
+
+    RxMessageHandler* handler = rxMessageHandlers[tableIndex];
+    if (handler != nullptr)
+    {
+        (*handler)(completeMessage);
+    }
+}
+
+/// Bits returned by `getRxDataWritten`.
+static constexpr uint8_t ROBOT_DATA_WRITTEN = 0b01;
+static constexpr uint8_t GAME_DATA_WRITTEN = 0b10;
+
+/**
+ * @return Which of the robot data and game data structs messages of the specified type are decoded
+ *      into, as a combination of `ROBOT_DATA_WRITTEN` and `GAME_DATA_WRITTEN`.
+ */
+static uint8_t getRxDataWritten(uint16_t messageType)
+{
+    switch (messageType)
+    {
+        case RefSerial::REF_MESSAGE_TYPE_GAME_STATUS:
+        case RefSerial::REF_MESSAGE_TYPE_GAME_RESULT:
+        case RefSerial::REF_MESSAGE_TYPE_SITE_EVENT_DATA:
+        case RefSerial::REF_MESSAGE_TYPE_PROJECTILE_SUPPPLIER_ACTION:
+        case RefSerial::REF_MESSAGE_TYPE_DART_INFO:
+        case RefSerial::REF_MESSAGE_TYPE_AERIAL_ENERGY_STATUS:
+        case RefSerial::REF_MESSAGE_TYPE_DART_STATION_INFO:
+        case RefSerial::REF_MESSAGE_TYPE_GROUND_ROBOT_POSITION:
+        case RefSerial::REF_MESSAGE_TYPE_RADAR_PROGRESS:
+        case RefSerial::REF_MESSAGE_TYPE_SENTRY_INFO:
+            return GAME_DATA_WRITTEN;
+        case RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP:
+        case RefSerial::REF_MESSAGE_TYPE_WARNING_DATA:
+        case RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS:
+        case RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT:
+        case RefSerial::REF_MESSAGE_TYPE_ROBOT_POSITION:
+        case RefSerial::REF_MESSAGE_TYPE_ROBOT_BUFF_STATUS:
+        case RefSerial::REF_MESSAGE_TYPE_RECEIVE_DAMAGE:
+        case RefSerial::REF_MESSAGE_TYPE_PROJECTILE_LAUNCH:
+        case RefSerial::REF_MESSAGE_TYPE_BULLETS_REMAIN:
+        case RefSerial::REF_MESSAGE_TYPE_RFID_STATUS:
+            return ROBOT_DATA_WRITTEN;
+        case RefSerial::REF_MESSAGE_TYPE_RADAR_INFO:
+            return ROBOT_DATA_WRITTEN | GAME_DATA_WRITTEN;
+        default:
+            return 0;
+    }
+}
+
+void RefSerial::decodeRxMessage(const ReceivedSerialMessage& completeMessage)
+{
+    const uint8_t dataWritten = getRxDataWritten(completeMessage.messageType);
+    if (dataWritten & ROBOT_DATA_WRITTEN)
+    {
+        beginDataWrite(robotDataSequence);
+    }
+    if (dataWritten & GAME_DATA_WRITTEN)
+    {
+        beginDataWrite(gameDataSequence);
+    }
+
+    decodeRxMessageData(completeMessage);
+
+    const uint32_t currTime = clock::getTimeMilliseconds();
+    if (dataWritten & ROBOT_DATA_WRITTEN)
+    {
+        endDataWrite(robotDataSequence);
+        robotDataReceiveTime = currTime;
+        robotDataReceived = true;
+    }
+    if (dataWritten & GAME_DATA_WRITTEN)
+    {
+        endDataWrite(gameDataSequence);
+        gameDataReceiveTime = currTime;
+        gameDataReceived = true;
+    }
+
+    if (pendingGameEvents != 0)
+    {
+        dispatchGameEvents();
+    }
+}
+
+void RefSerial::updateRxMessageTiming(Rx::RxMessageTiming& timing, uint32_t receiveTimeUs)
+{
+    if (timing.numReceived > 0)
+    {
+        const uint32_t interval = receiveTimeUs - timing.lastReceiveTimeUs;
+        timing.lastIntervalUs = interval;
+        if (timing.numIntervals == 0)
+        {
+            timing.minIntervalUs = interval;
+            timing.maxIntervalUs = interval;
+            timing.meanIntervalUs = interval;
+            timing.jitterUs = 0;
+        }
+        else
+        {
+            timing.minIntervalUs = std::min(timing.minIntervalUs, interval);
+            timing.maxIntervalUs = std::max(timing.maxIntervalUs, interval);
+            // Moving averages with gains of 1/8 and 1/16, as for the RTP interarrival jitter
+            const int32_t error =
+                static_cast<int32_t>(interval) - static_cast<int32_t>(timing.meanIntervalUs);
+            timing.meanIntervalUs += error / 8;
+            const int32_t deviation = std::abs(error) - static_cast<int32_t>(timing.jitterUs);
+            timing.jitterUs += deviation / 16;
+        }
+        timing.numIntervals++;
+    }
+    timing.lastReceiveTimeUs = receiveTimeUs;
+    timing.numReceived++;
+}
+
+void RefSerial::decodeRxMessageData(const ReceivedSerialMessage& completeMessage)
+{
     switch (completeMessage.messageType)
     {
+#if REF_SERIAL_DECODE_GAME_DATA
         case REF_MESSAGE_TYPE_GAME_STATUS:
         {
             decodeToGameStatus(completeMessage);
@@ -67,7 +241,9 @@ void RefSerial::messageReceiveCallback(const ReceivedSerialMessage& completeMess
             decodeToAllRobotHP(completeMessage);
             break;
         }
+#endif
 
+#if REF_SERIAL_DECODE_FIELD_DATA
         case REF_MESSAGE_TYPE_SITE_EVENT_DATA:
         {
             decodeToSiteEventData(completeMessage);
@@ -88,7 +264,9 @@ void RefSerial::messageReceiveCallback(const ReceivedSerialMessage& completeMess
             decodeToDartInfo(completeMessage);
             break;
         }
+#endif
 
+#if REF_SERIAL_DECODE_ROBOT_DATA
         case REF_MESSAGE_TYPE_ROBOT_STATUS:
         {
             decodeToRobotStatus(completeMessage);
@@ -159,12 +337,20 @@ void RefSerial::messageReceiveCallback(const ReceivedSerialMessage& completeMess
             decodeToRadarInfo(completeMessage);
             break;
         }
+#endif
 
+#if REF_SERIAL_DECODE_ROBOT_TO_ROBOT
         case REF_MESSAGE_TYPE_CUSTOM_DATA:
         {
             handleRobotToRobotCommunication(completeMessage);
             break;
         }
+        case REF_MESSAGE_TYPE_VTM_INPUT_DATA:
+        {
+            decodeToVtmInput(completeMessage);
+            break;
+        }
+#endif
         // TODO: Other Custom Data stuff
         default:
             break;
@@ -175,14 +361,117 @@ const RefSerialData::Rx::RobotData& RefSerial::getRobotData() const { return rob
 
 const RefSerialData::Rx::GameData& RefSerial::getGameData() const { return gameData; }
 
+template <typename T>
+uint32_t RefSerial::readDataSnapshot(
+    const T& data,
+    const std::atomic<uint32_t>& sequence,
+    T* snapshot)
+{
+    uint32_t sequenceBefore;
+    uint32_t sequenceAfter;
+    do
+    {
+        sequenceBefore = sequence.load(std::memory_order_acquire);
+        *snapshot = data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        sequenceAfter = sequence.load(std::memory_order_relaxed);
+    } while ((sequenceBefore & 1) != 0 || sequenceBefore != sequenceAfter);
+
+    return sequenceBefore / 2;
+}
+
+uint32_t RefSerial::getRobotDataSnapshot(Rx::RobotData* snapshot) const
+{
+    return readDataSnapshot(robotData, robotDataSequence, snapshot);
+}
+
+uint32_t RefSerial::getGameDataSnapshot(Rx::GameData* snapshot) const
+{
+    return readDataSnapshot(gameData, gameDataSequence, snapshot);
+}
+
+uint32_t RefSerial::getRobotDataAge() const
+{
+    return robotDataReceived ? clock::getTimeMilliseconds() - robotDataReceiveTime : UINT32_MAX;
+}
+
+uint32_t RefSerial::getGameDataAge() const
+{
+    return gameDataReceived ? clock::getTimeMilliseconds() - gameDataReceiveTime : UINT32_MAX;
+}
+
+const RefSerial::Rx::RxMessageTiming& RefSerial::getRxMessageTiming(uint16_t commandId) const
+{
+    static const Rx::RxMessageTiming NO_TIMING = {};
+    const int tableIndex = getRxCommandTableIndex(commandId);
+    return tableIndex < 0 ? NO_TIMING : rxMessageTiming[tableIndex];
+}
+
+uint32_t RefSerial::getVtmInput(Rx::VtmInputData* input) const
+{
+    if (vtmInputsReceived > 0)
+    {
+        *input = vtmInput;
+    }
+    return vtmInputsReceived;
+}
+
+void RefSerial::resetRxMessageTiming()
+{
+    for (Rx::RxMessageTiming& timing : rxMessageTiming)
+    {
+        timing.numIntervals = 0;
+        timing.lastIntervalUs = 0;
+        timing.minIntervalUs = 0;
+        timing.maxIntervalUs = 0;
+        timing.meanIntervalUs = 0;
+        timing.jitterUs = 0;
+    }
+}
+
+uint32_t RefSerial::getRobotDataGeneration() const
+{
+    return robotDataSequence.load(std::memory_order_acquire) / 2;
+}
+
+uint32_t RefSerial::getGameDataGeneration() const
+{
+    return gameDataSequence.load(std::memory_order_acquire) / 2;
+}
+
+void RefSerial::beginDataWrite(std::atomic<uint32_t>& sequence)
+{
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void RefSerial::endDataWrite(std::atomic<uint32_t>& sequence)
+{
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+
 bool RefSerial::decodeToGameStatus(const ReceivedSerialMessage& message)
 {
     if (message.header.dataLength != 11)
     {
         return false;
     }
+    const Rx::GameStage previousStage = gameData.gameStage;
     gameData.gameType = static_cast<Rx::GameType>(0xf & message.data[0]);
     gameData.gameStage = static_cast<Rx::GameStage>(0xf & (message.data[0] >> 4));
+    if (gameData.gameStage != previousStage)
+    {
+        pendingGameEvents |= Rx::GAME_STAGE_CHANGED;
+        if (gameData.gameStage == Rx::GameStage::IN_GAME)
+        {
+            pendingGameEvents |= Rx::MATCH_STARTED;
+        }
+        else if (gameData.gameStage == Rx::GameStage::END_GAME)
+        {
+            pendingGameEvents |= Rx::MATCH_ENDED;
+        }
+    }
     convertFromLittleEndian(&gameData.stageTimeRemaining, message.data + 1);
     // reinterpreting as a uint64_t doesn't work, so do this instead
     gameData.unixTime = static_cast<uint64_t>(message.data[10]) << 56 |
@@ -297,9 +586,27 @@ bool RefSerial::decodeToRobotStatus(const ReceivedSerialMessage& message)
     {
         return false;
     }
+    const uint8_t previousLevel = robotData.robotLevel;
+    const uint16_t previousHp = robotData.currentHp;
     robotData.robotId = static_cast<RobotId>(message.data[0]);
     robotData.robotLevel = message.data[1];
     convertFromLittleEndian(&robotData.currentHp, message.data + 2);
+    if (robotStatusDecoded)
+    {
+        if (previousHp != 0 && robotData.currentHp == 0)
+        {
+            pendingGameEvents |= Rx::ROBOT_DIED;
+        }
+        else if (previousHp == 0 && robotData.currentHp != 0)
+        {
+            pendingGameEvents |= Rx::ROBOT_REVIVED;
+        }
+        if (robotData.robotLevel != previousLevel)
+        {
+            pendingGameEvents |= Rx::ROBOT_LEVEL_CHANGED;
+        }
+    }
+    robotStatusDecoded = true;
     convertFromLittleEndian(&robotData.maxHp, message.data + 4);
     convertFromLittleEndian(&robotData.turret.coolingRate, message.data + 6);
     convertFromLittleEndian(&robotData.turret.heatLimit, message.data + 8);
@@ -349,12 +656,23 @@ bool RefSerial::decodeToRobotBuffs(const ReceivedSerialMessage& message)
     {
         return false;
     }
-    robotData.robotBuffStatus.recoveryBuff = message.data[0];
-    robotData.robotBuffStatus.coolingBuff = message.data[1];
-    robotData.robotBuffStatus.defenseBuff = message.data[2];
-    robotData.robotBuffStatus.vulnerabilityBuff = message.data[3];
-
-    convertFromLittleEndian(&robotData.robotBuffStatus.attackBuff, message.data + 4);
+    Rx::RobotBuffStatus& buffs = robotData.robotBuffStatus;
+    const Rx::RobotBuffStatus previousBuffs = buffs;
+    buffs.recoveryBuff = message.data[0];
+    buffs.coolingBuff = message.data[1];
+    buffs.defenseBuff = message.data[2];
+    buffs.vulnerabilityBuff = message.data[3];
+
+    convertFromLittleEndian(&buffs.attackBuff, message.data + 4);
+
+    if (buffs.recoveryBuff != previousBuffs.recoveryBuff ||
+        buffs.coolingBuff != previousBuffs.coolingBuff ||
+        buffs.defenseBuff != previousBuffs.defenseBuff ||
+        buffs.vulnerabilityBuff != previousBuffs.vulnerabilityBuff ||
+        buffs.attackBuff != previousBuffs.attackBuff)
+    {
+        pendingGameEvents |= Rx::BUFFS_CHANGED;
+    }
     return true;
 }
 
@@ -400,9 +718,16 @@ bool RefSerial::decodeToBulletsRemain(const ReceivedSerialMessage& message)
     {
         return false;
     }
+    const uint16_t previousBullets17 = robotData.turret.bulletsRemaining17;
+    const uint16_t previousBullets42 = robotData.turret.bulletsRemaining42;
     convertFromLittleEndian(&robotData.turret.bulletsRemaining17, message.data);
     convertFromLittleEndian(&robotData.turret.bulletsRemaining42, message.data + 2);
     convertFromLittleEndian(&robotData.remainingCoins, message.data + 4);
+    if (robotData.turret.bulletsRemaining17 != previousBullets17 ||
+        robotData.turret.bulletsRemaining42 != previousBullets42)
+    {
+        pendingGameEvents |= Rx::PROJECTILE_ALLOWANCE_CHANGED;
+    }
     return true;
 }
 
@@ -494,6 +819,23 @@ bool RefSerial::decodeToRadarInfo(const ReceivedSerialMessage& message)
     return true;
 }
 
+bool RefSerial::decodeToVtmInput(const ReceivedSerialMessage& message)
+{
+    if (message.header.dataLength != 12)
+    {
+        return false;
+    }
+    convertFromLittleEndian(&vtmInput.mouseX, message.data);
+    convertFromLittleEndian(&vtmInput.mouseY, message.data + 2);
+    convertFromLittleEndian(&vtmInput.mouseZ, message.data + 4);
+    vtmInput.mouseL = message.data[6] != 0;
+    vtmInput.mouseR = message.data[7] != 0;
+    convertFromLittleEndian(&vtmInput.key, message.data + 8);
+    vtmInput.receiveTime = clock::getTimeMilliseconds();
+    vtmInputsReceived++;
+    return true;
+}
+
 bool RefSerial::handleRobotToRobotCommunication(const ReceivedSerialMessage& message)
 {
     if (message.header.dataLength < sizeof(Tx::RobotToRobotMessage::interactiveHeader))
@@ -509,9 +851,11 @@ bool RefSerial::handleRobotToRobotCommunication(const ReceivedSerialMessage& mes
     const Tx::InteractiveHeader* interactiveHeader =
         reinterpret_cast<const Tx::InteractiveHeader*>(message.data);
 
-    if (msgIdToRobotToRobotHandlerMap.count(interactiveHeader->dataCmdId))
+    RobotToRobotMessageHandler** handler =
+        msgIdToRobotToRobotHandlerMap.find(interactiveHeader->dataCmdId);
+    if (handler != nullptr)
     {
-        (*msgIdToRobotToRobotHandlerMap[interactiveHeader->dataCmdId])(message);
+        (**handler)(message);
     }
 
     return true;
@@ -521,29 +865,23 @@ void RefSerial::processReceivedDamage(uint32_t timestamp, int32_t damageTaken)
 {
     if (damageTaken > 0)
     {
-        // create a new DamageEvent with the damage_taken, and current time
-        Rx::DamageEvent damageEvent = {static_cast<uint16_t>(damageTaken), timestamp};
-
-        if (receivedDpsTracker.getSize() == DPS_TRACKER_DEQUE_SIZE)
-        {
-            receivedDpsTracker.removeBack();
-        }
-        robotData.receivedDps += damageTaken;
-
-        receivedDpsTracker.append(damageEvent);
+        receivedDpsTracker.add(damageTaken, timestamp);
+        robotData.receivedDps = receivedDpsTracker.getSum();
     }
 }
 
 void RefSerial::updateReceivedDamage()
 {
-    // if current damage at head of circular array occurred more than a second ago,
-    // decrease receivedDps by that amount of damage and increment head index
-    while (receivedDpsTracker.getSize() > 0 &&
-           clock::getTimeMilliseconds() > receivedDpsTracker.getFront().timestampMs + 1000)
+    // The tracker isn't part of the robot data, so only mark the robot data as being written if
+    // damage expired
+    if (!receivedDpsTracker.update(clock::getTimeMilliseconds()))
     {
-        robotData.receivedDps -= receivedDpsTracker.getFront().damageAmount;
-        receivedDpsTracker.removeFront();
+        return;
     }
+
+    beginDataWrite(robotDataSequence);
+    robotData.receivedDps = receivedDpsTracker.getSum();
+    endDataWrite(robotDataSequence);
 }
 
 RefSerial::RobotId RefSerial::getRobotIdBasedOnCurrentRobotTeam(RobotId id)
@@ -568,13 +906,133 @@ void RefSerial::attachRobotToRobotMessageHandler(
     uint16_t msgId,
     RobotToRobotMessageHandler* handler)
 {
-    if (msgIdToRobotToRobotHandlerMap.count(msgId) != 0 || msgId < 0x0200 || msgId > 0x02FF)
+    if (msgId < 0x0200 || msgId > 0x02FF || !msgIdToRobotToRobotHandlerMap.insert(msgId, handler))
     {
         RAISE_ERROR(drivers, "error adding msg handler");
+    }
+}
+
+bool RefSerial::attachRxMessageHandler(uint16_t commandId, RxMessageHandler* handler)
+{
+    const int tableIndex = getRxCommandTableIndex(commandId);
+    if (tableIndex < 0 || rxMessageHandlers[tableIndex] != nullptr)
+    {
+        RAISE_ERROR(drivers, "error adding rx msg handler");
+        return false;
+    }
+
+    rxMessageHandlers[tableIndex] = handler;
+    return true;
+}
+
+bool RefSerial::attachGameEventListener(GameEventListener* listener, uint16_t events)
+{
+    if (listener == nullptr || gameEventListenerCount >= MAX_GAME_EVENT_LISTENERS)
+    {
+        RAISE_ERROR(drivers, "error adding game event listener");
+        return false;
+    }
+
+    gameEventListeners[gameEventListenerCount++] = {listener, events};
+    return true;
+}
+
+void RefSerial::dispatchGameEvents()
+{
+    uint16_t events = pendingGameEvents;
+    pendingGameEvents = 0;
+
+    while (events != 0)
+    {
+        const uint16_t event = events & -events;
+        events &= events - 1;
+        for (int i = 0; i < gameEventListenerCount; i++)
+        {
+            if (gameEventListeners[i].events & event)
+            {
+                gameEventListeners[i].listener->onGameEvent(static_cast<Rx::GameEvent>(event));
+            }
+        }
+    }
+}
+
+void RefSerial::setRxMessageDecodingEnabled(uint16_t commandId, bool enabled)
+{
+    const int tableIndex = getRxCommandTableIndex(commandId);
+    if (tableIndex < 0)
+    {
+        RAISE_ERROR(drivers, "invalid rx command id");
         return;
     }
 
-    msgIdToRobotToRobotHandlerMap[msgId] = handler;
+    rxDecodingDisabled[tableIndex] = !enabled || !isRxDecodingCompiledIn(commandId >> 8);
+}
+
+void RefSerial::queueTransmission(Tx::TransmissionPriority priority)
+{
+    Tx::TransmissionQueueStats& stats = transmissionQueueStats[static_cast<int>(priority)];
+    stats.queueDepth++;
+    stats.maxQueueDepth = std::max(stats.maxQueueDepth, stats.queueDepth);
+}
+
+bool RefSerial::acquireTransmissionSemaphore(Tx::TransmissionPriority priority, uint32_t msgLen)
+{
+    for (int higher = 0; higher < static_cast<int>(priority); higher++)
+    {
+        if (transmissionQueueStats[higher].queueDepth > 0)
+        {
+            return false;
+        }
+    }
+
+    refillTxTokens();
+
+    // messages larger than the bucket are sent once it is full, leaving it in debt
+    const int32_t tokensRequired =
+        static_cast<int32_t>(std::min(msgLen, TX_TOKEN_BUCKET_CAPACITY_BYTES)) * 1'000;
+    if (txTokensMilliBytes < tokensRequired || !transmissionSemaphore.acquire())
+    {
+        return false;
+    }
+
+    Tx::TransmissionQueueStats& stats = transmissionQueueStats[static_cast<int>(priority)];
+    if (stats.queueDepth > 0)
+    {
+        stats.queueDepth--;
+    }
+    return true;
+}
+
+void RefSerial::releaseTransmissionSemaphore(
+    Tx::TransmissionPriority priority,
+    uint32_t sentMsgLen)
+{
+    transmissionSemaphore.release();
+
+    refillTxTokens();
+    txTokensMilliBytes -= static_cast<int32_t>(sentMsgLen) * 1'000;
+
+    Tx::TransmissionQueueStats& stats = transmissionQueueStats[static_cast<int>(priority)];
+    stats.messagesSent++;
+    stats.bytesSent += sentMsgLen;
+}
+
+const RefSerial::Tx::TransmissionQueueStats& RefSerial::getTransmissionQueueStats(
+    Tx::TransmissionPriority priority) const
+{
+    return transmissionQueueStats[static_cast<int>(priority)];
+}
+
+void RefSerial::refillTxTokens()
+{
+    const uint32_t currTime = clock::getTimeMilliseconds();
+    const uint32_t elapsed = currTime - txTokensLastRefillTime;
+    txTokensLastRefillTime = currTime;
+
+    // bytes per second is equivalent to thousandths of a byte per millisecond
+    const int64_t tokens = static_cast<int64_t>(txTokensMilliBytes) +
+                           static_cast<int64_t>(elapsed) * Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S;
+    txTokensMilliBytes = std::min<int64_t>(tokens, TX_TOKEN_BUCKET_CAPACITY_BYTES * 1'000);
 }
 
 bool RefSerial::operatorBlinded() const
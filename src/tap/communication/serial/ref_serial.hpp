@@ -20,17 +20,21 @@
 #ifndef TAPROOT_REF_SERIAL_HPP_
 #define TAPROOT_REF_SERIAL_HPP_
 
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cmath>
 #include <cstdint>
-#include <unordered_map>
 
+#include "tap/algorithms/windowed_sum.hpp"
+#include "tap/architecture/flat_map.hpp"
 #include "tap/architecture/timeout.hpp"
 #include "tap/util_macros.hpp"
 
-#include "modm/container/deque.hpp"
 #include "modm/processing/protothread/semaphore.hpp"
 
 #include "dji_serial.hpp"
+#include "ref_serial_constants.hpp"
 #include "ref_serial_data.hpp"
 
 namespace tap
@@ -65,12 +69,38 @@ class RefSerial : public DJISerial, public RefSerialData
 
     // RX message constants
     /**
-     * Size of the deque used to determine the current DPS taken by the robot as reported
+     * Number of damage events stored to determine the current DPS taken by the robot as reported
      * by the referee system.
      */
-    static constexpr uint16_t DPS_TRACKER_DEQUE_SIZE = 20;
+    static constexpr uint16_t DPS_TRACKER_DEQUE_SIZE = REF_SERIAL_DPS_TRACKER_SIZE;
+
+    /// Window over which the damage taken is summed to compute the DPS.
+    static constexpr uint32_t DPS_TRACKER_WINDOW_MS = 1000;
+
+    /**
+     * Command IDs are grouped into sets by their upper byte (0x0XX game data, 0x1XX field data,
+     * 0x2XX robot data, 0x3XX interactive data) and no set uses more than 0x20 IDs, so the rx
+     * handler table is indexed directly by the set and the lower bits of the command ID.
+     */
+    static constexpr uint16_t RX_COMMAND_ID_SETS = 4;
+    static constexpr uint16_t RX_COMMAND_IDS_PER_SET = 0x20;
+    static constexpr uint16_t RX_COMMAND_TABLE_SIZE = RX_COMMAND_ID_SETS * RX_COMMAND_IDS_PER_SET;
+
+    /// Maximum number of handlers attached via `attachRobotToRobotMessageHandler`.
+    static constexpr std::size_t MAX_ROBOT_TO_ROBOT_HANDLERS = 16;
+
+    /**
+     * Maximum number of bytes the transmission token bucket holds, the size of the largest
+     * message sent to the referee system. This allows a message to be sent as soon as it is
+     * queued after a period of inactivity without sending faster than
+     * `Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S` on average.
+     */
+    static constexpr uint32_t TX_TOKEN_BUCKET_CAPACITY_BYTES = sizeof(Tx::RobotToRobotMessage);
 
 public:
+    /// Maximum number of listeners attached via `attachGameEventListener`.
+    static constexpr int MAX_GAME_EVENT_LISTENERS = 8;
+
     /**
      * RX message type defines, referred to as "Command ID"s in the RoboMaster Ref System
      * Protocol Appendix. Ignored message types commented out because they are not handled by this
@@ -109,7 +139,7 @@ class RefSerial : public DJISerial, public RefSerialData
         REF_MESSAGE_TYPE_CUSTOM_DATA = 0x301,
         // REF_MESSAGE_TYPE_CUSTOM_CONTROLLER = 0x302,
         // REF_MESSAGE_TYPE_SMALL_MAP = 0x303,
-        // REF_MESSAGE_TYPE_VTM_INPUT_DATA = 0x304
+        REF_MESSAGE_TYPE_VTM_INPUT_DATA = 0x304,
     };
 
     /**
@@ -123,7 +153,9 @@ class RefSerial : public DJISerial, public RefSerialData
     mockable ~RefSerial() = default;
 
     /**
-     * Handles the types of messages defined above in the RX message handlers section.
+     * Handles the types of messages defined above in the RX message handlers section. Messages
+     * whose command ID has neither built-in decoding enabled nor an attached handler are
+     * discarded after a single table lookup.
      */
     void messageReceiveCallback(const ReceivedSerialMessage& completeMessage) override;
 
@@ -139,6 +171,78 @@ class RefSerial : public DJISerial, public RefSerialData
      */
     mockable const Rx::GameData& getGameData() const;
 
+    /**
+     * Copies a consistent snapshot of the robot data struct, one that is not partway through being
+     * updated by a newly received message. Unlike reading through `getRobotData`, this is safe to
+     * call from a thread other than the one calling `updateSerial`. No lock is taken; instead the
+     * copy is retried if a message was decoded while copying.
+     *
+     * @note Must not be called from an interrupt that may preempt `updateSerial`, since the copy
+     *      would be retried forever.
+     *
+     * @param[out] snapshot The robot data is copied here.
+     * @return The generation of the copied robot data (see `getRobotDataGeneration`).
+     */
+    mockable uint32_t getRobotDataSnapshot(Rx::RobotData* snapshot) const;
+
+    /**
+     * Copies a consistent snapshot of the game data struct.
+     *
+     * @see getRobotDataSnapshot
+     *
+     * @param[out] snapshot The game data is copied here.
+     * @return The generation of the copied game data (see `getGameDataGeneration`).
+     */
+    mockable uint32_t getGameDataSnapshot(Rx::GameData* snapshot) const;
+
+    /**
+     * @return A counter that is incremented each time a received message updates the robot data
+     *      struct. Comparing the generation to one previously read detects whether the robot data
+     *      has changed without copying it.
+     */
+    mockable uint32_t getRobotDataGeneration() const;
+
+    /**
+     * @return A counter that is incremented each time a received message updates the game data
+     *      struct.
+     */
+    mockable uint32_t getGameDataGeneration() const;
+
+    /**
+     * @return The time since a received message last updated the robot data struct (in ms), or
+     *      `UINT32_MAX` if none has. Lets users of the data, such as power and heat limiting,
+     *      tell how stale it is.
+     */
+    mockable uint32_t getRobotDataAge() const;
+
+    /**
+     * @return The time since a received message last updated the game data struct (in ms), or
+     *      `UINT32_MAX` if none has.
+     */
+    mockable uint32_t getGameDataAge() const;
+
+    /**
+     * @return Receive timing statistics of messages with the specified command ID, all zero if
+     *      none have been received or the command ID is invalid. Timing is tracked whether or not
+     *      the messages are decoded.
+     */
+    mockable const Rx::RxMessageTiming& getRxMessageTiming(uint16_t commandId) const;
+
+    /**
+     * Copies the most recent keyboard and mouse input received over the video transmitter link.
+     * `Remote` merges this input with the input received by the DR16 receiver.
+     *
+     * @param[out] input The input is copied here, unless none has been received.
+     * @return The number of inputs received, 0 if none have been.
+     */
+    mockable uint32_t getVtmInput(Rx::VtmInputData* input) const;
+
+    /**
+     * Clears the interval statistics of every command ID, for example at the start of a match to
+     * measure the jitter during the match only. Receive counts and times are kept.
+     */
+    mockable void resetRxMessageTiming();
+
     /**
      * Returns a robot id that is of the same color of this robot's
      * ID. This allows you to specify you want to send to one robot
@@ -152,25 +256,97 @@ class RefSerial : public DJISerial, public RefSerialData
         RobotToRobotMessageHandler* handler);
 
     /**
-     * Used by `RefSerialTransmitter`. Attempts to acquire transmission semaphore.
+     * Attaches a handler that is called with every message received with the specified command
+     * ID, after the built-in decoding of the message (if enabled). Only one handler may be
+     * attached per command ID.
+     *
+     * The handler is passed a `const` reference into the receive buffer rather than a copy, so it
+     * must not hold onto the reference after it returns.
+     *
+     * @param[in] commandId The referee system command ID, such as
+     *      `REF_MESSAGE_TYPE_POWER_AND_HEAT`. Need not be a `MessageType` this class decodes.
+     * @param[in] handler The handler to attach.
+     * @return `false` (and raises an error) if the command ID is not a valid referee system
+     *      command ID or already has a handler, `true` otherwise.
+     */
+    mockable bool attachRxMessageHandler(uint16_t commandId, RxMessageHandler* handler);
+
+    /**
+     * Attaches a listener that is called each time a decoded message changes the game state in
+     * one of the ways in `events`, so that commands and subsystems react on the message that
+     * changed the state instead of each polling the robot and game data for changes. For
+     * example, a listener for `Rx::MATCH_STARTED` is called once when the game stage changes to
+     * `GameStage::IN_GAME`, including when the first game status received after boot is in game.
+     * Transitions of this robot's HP and level are detected from the second robot status message
+     * received.
+     *
+     * When a message causes several events, each event is dispatched in the order of its bit in
+     * `Rx::GameEvent`, to listeners in the order they were attached.
+     *
+     * @param[in] listener The listener to attach.
+     * @param[in] events A mask of the `Rx::GameEvent`s the listener is called with.
+     * @return `false` (and raises an error) if the listener is `nullptr` or
+     *      `MAX_GAME_EVENT_LISTENERS` listeners have already been attached, `true` otherwise.
+     */
+    mockable bool attachGameEventListener(
+        GameEventListener* listener,
+        uint16_t events = Rx::ALL_GAME_EVENTS);
+
+    /**
+     * Enables or disables the built-in decoding of messages with the specified command ID into
+     * the structs returned by `getRobotData` and `getGameData`. Decoding is enabled for all
+     * command IDs by default. Disabling decoding of messages a robot never reads (for example
+     * `REF_MESSAGE_TYPE_ALL_ROBOT_HP`) avoids the cost of decoding them, and an attached
+     * `RxMessageHandler` can be used to read only the fields of interest instead.
+     *
+     * @note The fields of `getRobotData` and `getGameData` decoded from disabled messages are no
+     *      longer updated.
+     * @note Decoding of whole groups of command IDs can also be compiled out with the
+     *      `taproot:communication:serial:ref_serial:decode_*` lbuild options, in which case it
+     *      can't be enabled here.
+     */
+    mockable void setRxMessageDecodingEnabled(uint16_t commandId, bool enabled);
+
+    /**
+     * Used by `RefSerialTransmitter`. Adds a message of the specified priority to the queue of
+     * messages waiting for `acquireTransmissionSemaphore` to succeed. Must be called once before
+     * waiting on `acquireTransmissionSemaphore`.
+     */
+    mockable void queueTransmission(Tx::TransmissionPriority priority);
+
+    /**
+     * Used by `RefSerialTransmitter`. Attempts to acquire the transmission semaphore in order to
+     * send a queued message.
+     *
+     * Transmission is rate limited by a token bucket that fills at
+     * `Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S` and holds up to `TX_TOKEN_BUCKET_CAPACITY_BYTES`, so a
+     * message is sent as soon as enough bandwidth is available rather than after a fixed delay.
+     * Messages are only sent when no message of a higher priority is queued.
      *
      * @note should be called only using RF_WAIT_UNTIL to block until acquiring semaphore.
+     *
+     * @param[in] priority The priority the message was queued with.
+     * @param[in] msgLen The length of the entire message to be sent, in bytes.
+     * @return `true` if the semaphore was acquired and the message may be sent.
      */
-    mockable bool acquireTransmissionSemaphore()
-    {
-        if (transmissionDelayTimer.isExpired() || transmissionDelayTimer.isStopped())
-        {
-            return transmissionSemaphore.acquire();
-        }
-        return false;
-    }
+    mockable bool acquireTransmissionSemaphore(Tx::TransmissionPriority priority, uint32_t msgLen);
 
-    mockable void releaseTransmissionSemaphore(uint32_t sentMsgLen)
-    {
-        transmissionSemaphore.release();
-        transmissionDelayTimer.restart(
-            std::ceil(sentMsgLen * 1000.0f / Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S));
-    }
+    /**
+     * Used by `RefSerialTransmitter`. Releases the transmission semaphore after a message has been
+     * sent, consuming bandwidth from the token bucket.
+     *
+     * @param[in] priority The priority of the message sent.
+     * @param[in] sentMsgLen The length of the message sent, in bytes.
+     */
+    mockable void releaseTransmissionSemaphore(
+        Tx::TransmissionPriority priority,
+        uint32_t sentMsgLen);
+
+    /**
+     * @return Statistics about messages of the specified priority sent to the referee system.
+     */
+    mockable const Tx::TransmissionQueueStats& getTransmissionQueueStats(
+        Tx::TransmissionPriority priority) const;
 
     /**
      * @return True if the robot operator is blinded, false otherwise. Also return false if the
@@ -190,12 +366,60 @@ class RefSerial : public DJISerial, public RefSerialData
 private:
     Rx::RobotData robotData;
     Rx::GameData gameData;
-    modm::BoundedDeque<Rx::DamageEvent, DPS_TRACKER_DEQUE_SIZE> receivedDpsTracker;
+    /**
+     * Sequence counters for `robotData` and `gameData`. Each is odd while its struct is being
+     * written and is incremented twice per write, so the generation is half of the sequence.
+     */
+    std::atomic<uint32_t> robotDataSequence;
+    std::atomic<uint32_t> gameDataSequence;
+    algorithms::WindowedSum<uint32_t, DPS_TRACKER_DEQUE_SIZE> receivedDpsTracker;
     arch::MilliTimeout refSerialOfflineTimeout;
-    std::unordered_map<uint16_t, RobotToRobotMessageHandler*> msgIdToRobotToRobotHandlerMap;
+    arch::FlatMap<uint16_t, RobotToRobotMessageHandler*, MAX_ROBOT_TO_ROBOT_HANDLERS>
+        msgIdToRobotToRobotHandlerMap;
+    /// Handlers attached via `attachRxMessageHandler`, indexed by `getRxCommandTableIndex`.
+    std::array<RxMessageHandler*, RX_COMMAND_TABLE_SIZE> rxMessageHandlers;
+    /// Set bits disable built-in decoding, indexed by `getRxCommandTableIndex`.
+    std::bitset<RX_COMMAND_TABLE_SIZE> rxDecodingDisabled;
+    /// Indexed by `getRxCommandTableIndex`.
+    std::array<Rx::RxMessageTiming, RX_COMMAND_TABLE_SIZE> rxMessageTiming;
+    /// Times `robotData` and `gameData` were last decoded into (in ms), valid once decoded into.
+    struct GameEventListenerEntry
+    {
+        GameEventListener* listener;
+        uint16_t events;
+    };
+    GameEventListenerEntry gameEventListeners[MAX_GAME_EVENT_LISTENERS];
+    int gameEventListenerCount;
+    /// Mask of the `Rx::GameEvent`s caused by the message being decoded.
+    uint16_t pendingGameEvents;
+    /// `true` once a robot status message has been decoded, so HP and level changes are known.
+    bool robotStatusDecoded;
+    Rx::VtmInputData vtmInput;
+    uint32_t vtmInputsReceived;
+    uint32_t robotDataReceiveTime;
+    uint32_t gameDataReceiveTime;
+    bool robotDataReceived;
+    bool gameDataReceived;
     modm::pt::Semaphore transmissionSemaphore;
-    tap::arch::MilliTimeout transmissionDelayTimer;
+    /**
+     * Bytes that may currently be sent, in thousandths of a byte so that a whole number of
+     * thousandths is added every millisecond. Negative after a message longer than the capacity
+     * of the bucket is sent.
+     */
+    int32_t txTokensMilliBytes;
+    uint32_t txTokensLastRefillTime;
+    Tx::TransmissionQueueStats transmissionQueueStats[Tx::NUM_TRANSMISSION_PRIORITIES];
+
+    void refillTxTokens();
 
+    /// Calls the listeners of each event in `pendingGameEvents`, then clears it.
+    void dispatchGameEvents();
+
+    /**
+     * Decodes ref serial message containing keyboard and mouse input sent over the video
+     * transmitter link.
+     */
+    bool decodeToVtmInput(const ReceivedSerialMessage& message);
     /**
      * Decodes ref serial message containing the game stage and time remaining
      * in the game.
@@ -292,6 +516,40 @@ class RefSerial : public DJISerial, public RefSerialData
 
     bool handleRobotToRobotCommunication(const ReceivedSerialMessage& message);
 
+    /**
+     * @return The index into the rx command tables of the specified command ID, or -1 if the
+     *      command ID is not a valid referee system command ID.
+     */
+    static inline int getRxCommandTableIndex(uint16_t commandId)
+    {
+        const uint16_t set = commandId >> 8;
+        const uint16_t id = commandId & 0xff;
+        if (set >= RX_COMMAND_ID_SETS || id >= RX_COMMAND_IDS_PER_SET)
+        {
+            return -1;
+        }
+        return set * RX_COMMAND_IDS_PER_SET + id;
+    }
+
+    /**
+     * Decodes the message into `robotData` or `gameData` based on its command ID, marking the
+     * struct(s) written as being updated while decoding.
+     */
+    void decodeRxMessage(const ReceivedSerialMessage& message);
+
+    void decodeRxMessageData(const ReceivedSerialMessage& message);
+
+    static void beginDataWrite(std::atomic<uint32_t>& sequence);
+    static void endDataWrite(std::atomic<uint32_t>& sequence);
+
+    template <typename T>
+    static uint32_t readDataSnapshot(
+        const T& data,
+        const std::atomic<uint32_t>& sequence,
+        T* snapshot);
+
+    static void updateRxMessageTiming(Rx::RxMessageTiming& timing, uint32_t receiveTimeUs);
+
     void updateReceivedDamage();
     void processReceivedDamage(uint32_t timestamp, int32_t damageTaken);
 };
@@ -75,6 +75,18 @@ class RefSerialData
         virtual void operator()(const DJISerial::ReceivedSerialMessage &message) = 0;
     };
 
+    /**
+     * Handler for a single referee system command ID, see `RefSerial::attachRxMessageHandler`.
+     * The message passed to the handler is a view into the serial receive buffer that is only
+     * valid for the duration of the call.
+     */
+    class RxMessageHandler
+    {
+    public:
+        RxMessageHandler() {}
+        virtual void operator()(const DJISerial::ReceivedSerialMessage &message) = 0;
+    };
+
     /**
      * Contains enum and struct definitions specific to receiving data from the referee serial
      * class.
@@ -487,6 +499,74 @@ class RefSerialData
             RefereeWarningData refereeWarningData;  ///< Referee warning information, updated when
                                                     ///< a robot receives a penalty
         };
+
+        /**
+         * Changes to the game state that `RefSerial` detects as it decodes messages, see
+         * `RefSerial::attachGameEventListener`. Each event is a single bit, so events can be
+         * combined into a mask.
+         */
+        enum GameEvent : uint16_t
+        {
+            GAME_STAGE_CHANGED = 1 << 0,  ///< `GameData::gameStage` changed.
+            MATCH_STARTED = 1 << 1,       ///< The game stage changed to `GameStage::IN_GAME`.
+            MATCH_ENDED = 1 << 2,         ///< The game stage changed to `GameStage::END_GAME`.
+            ROBOT_DIED = 1 << 3,          ///< This robot's HP dropped to 0.
+            ROBOT_REVIVED = 1 << 4,       ///< This robot's HP rose from 0.
+            ROBOT_LEVEL_CHANGED = 1 << 5,
+            /// `TurretData::bulletsRemaining17` or `bulletsRemaining42` changed.
+            PROJECTILE_ALLOWANCE_CHANGED = 1 << 6,
+            BUFFS_CHANGED = 1 << 7,  ///< `RobotData::robotBuffStatus` changed.
+        };
+
+        /// A mask of every `GameEvent`.
+        static constexpr uint16_t ALL_GAME_EVENTS = (1 << 8) - 1;
+
+        /**
+         * Receive timing of the messages of a single command ID, see
+         * `RefSerial::getRxMessageTiming`. Intervals are between consecutive messages, measured
+         * when each message is parsed.
+         */
+        struct RxMessageTiming
+        {
+            uint32_t numReceived;        ///< Total number of messages received.
+            uint32_t lastReceiveTimeUs;  ///< Time the last message was received (in us).
+            uint32_t numIntervals;       ///< Number of intervals in the statistics below.
+            uint32_t lastIntervalUs;     ///< Most recent interval (in us).
+            uint32_t minIntervalUs;      ///< Shortest interval (in us).
+            uint32_t maxIntervalUs;      ///< Longest interval (in us).
+            uint32_t meanIntervalUs;     ///< Moving average of the interval (in us).
+            uint32_t jitterUs;           ///< Moving average of the deviation (in us).
+        };
+
+        /**
+         * Keyboard and mouse input from the operator's client, sent over the video transmitter
+         * link (command ID 0x304), see `RefSerial::getVtmInput`.
+         */
+        struct VtmInputData
+        {
+            int16_t mouseX = 0;
+            int16_t mouseY = 0;
+            int16_t mouseZ = 0;
+            bool mouseL = false;
+            bool mouseR = false;
+            uint16_t key = 0;          ///< Pressed keys, in the bit order of `Remote::Key`.
+            uint32_t receiveTime = 0;  ///< Time the input was received (in ms).
+        };
+    };
+
+    /**
+     * Listener for changes to the game state, see `RefSerial::attachGameEventListener`.
+     */
+    class GameEventListener
+    {
+    public:
+        GameEventListener() {}
+
+        /**
+         * Called once the message that changed the game state has been decoded, so the robot
+         * and game data already hold the new state.
+         */
+        virtual void onGameEvent(Rx::GameEvent event) = 0;
     };
 
     /**
@@ -656,6 +736,30 @@ class RefSerialData
          */
         static constexpr uint32_t MAX_TRANSMIT_SPEED_BYTES_PER_S = 1000;
 
+        /**
+         * Priority classes of messages sent to the referee system. When messages of several
+         * priorities are waiting to be sent, the highest priority message is sent first.
+         */
+        enum class TransmissionPriority : uint8_t
+        {
+            HIGH = 0,    ///< Time critical robot to robot messages, such as sentry coordination.
+            NORMAL = 1,  ///< Robot to robot messages (the default).
+            LOW = 2,     ///< UI graphics, which are resent if dropped or delayed.
+        };
+
+        static constexpr int NUM_TRANSMISSION_PRIORITIES = 3;
+
+        /**
+         * Statistics about messages of a single `TransmissionPriority` sent to the referee system.
+         */
+        struct TransmissionQueueStats
+        {
+            uint8_t queueDepth;     ///< Number of messages currently waiting to be sent.
+            uint8_t maxQueueDepth;  ///< Largest `queueDepth` seen.
+            uint32_t messagesSent;  ///< Total number of messages sent.
+            uint32_t bytesSent;     ///< Total number of bytes sent.
+        };
+
         /**
          * Get the min wait time after which you can send more data to the client. Sending faster
          * than this time may cause dropped packets.
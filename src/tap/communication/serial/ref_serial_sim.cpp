@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "ref_serial_sim.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tap/architecture/endianness_wrappers.hpp"
+
+using tap::arch::convertToLittleEndian;
+
+namespace tap::communication::serial
+{
+RefSerialSim::RefSerialSim(
+    RefSerial &refSerial,
+    const motor::motorsim::MotorSimEngine &engine,
+    const Config &config)
+    : refSerial(refSerial),
+      engine(engine),
+      config(config),
+      generator(config.seed)
+{
+    reset();
+}
+
+bool RefSerialSim::addChassisMotor(int motor)
+{
+    if (chassisMotorCount >= MAX_CHASSIS_MOTORS)
+    {
+        return false;
+    }
+
+    chassisMotors[chassisMotorCount++] = motor;
+    return true;
+}
+
+void RefSerialSim::launchProjectile17mm() { heat += HEAT_PER_17MM_PROJECTILE; }
+
+void RefSerialSim::reset()
+{
+    chassisPower = 0;
+    powerBuffer = config.maxPowerBuffer;
+    heat = 0;
+    timeSinceRobotStatus = config.robotStatusPeriod;
+    timeSincePowerAndHeat = config.powerAndHeatPeriod;
+}
+
+void RefSerialSim::step(float dt)
+{
+    if (dt <= 0)
+    {
+        return;
+    }
+
+    chassisPower = 0;
+    for (int i = 0; i < chassisMotorCount; i++)
+    {
+        const int motor = chassisMotors[i];
+        // motors braking put power back into their controller, not the referee system's supply
+        chassisPower += std::max(0.0f, engine.getVoltage(motor) * engine.getCurrent(motor));
+    }
+
+    powerBuffer += (config.chassisPowerLimit - chassisPower) * dt;
+    powerBuffer = std::clamp(powerBuffer, 0.0f, static_cast<float>(config.maxPowerBuffer));
+    heat = std::max(0.0f, heat - config.coolingRate * dt);
+
+    timeSinceRobotStatus += dt;
+    if (timeSinceRobotStatus >= config.robotStatusPeriod)
+    {
+        timeSinceRobotStatus = std::fmod(timeSinceRobotStatus, config.robotStatusPeriod);
+        sendRobotStatus();
+    }
+
+    timeSincePowerAndHeat += dt;
+    if (timeSincePowerAndHeat >= config.powerAndHeatPeriod)
+    {
+        timeSincePowerAndHeat = std::fmod(timeSincePowerAndHeat, config.powerAndHeatPeriod);
+        sendPowerAndHeat();
+    }
+}
+
+void RefSerialSim::sendRobotStatus()
+{
+    DJISerial::ReceivedSerialMessage message;
+    message.messageType = RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS;
+    message.header.dataLength = 13;
+    message.data[0] = static_cast<uint8_t>(config.robotId);
+    message.data[1] = 1;
+    convertToLittleEndian(config.maxHp, message.data + 2);
+    convertToLittleEndian(config.maxHp, message.data + 4);
+    convertToLittleEndian(config.coolingRate, message.data + 6);
+    convertToLittleEndian(config.heatLimit, message.data + 8);
+    convertToLittleEndian(config.chassisPowerLimit, message.data + 10);
+    // gimbal, chassis and shooter outputs powered
+    message.data[12] = 0b111;
+
+    refSerial.messageReceiveCallback(message);
+}
+
+void RefSerialSim::sendPowerAndHeat()
+{
+    const float reportedPower =
+        std::max(0.0f, chassisPower + config.powerNoise * normal(generator));
+
+    DJISerial::ReceivedSerialMessage message;
+    message.messageType = RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT;
+    message.header.dataLength = 16;
+    convertToLittleEndian(static_cast<uint16_t>(config.supplyVoltage * 1000), message.data);
+    convertToLittleEndian(
+        static_cast<uint16_t>(reportedPower / config.supplyVoltage * 1000),
+        message.data + 2);
+    convertToLittleEndian(reportedPower, message.data + 4);
+    convertToLittleEndian(static_cast<uint16_t>(powerBuffer), message.data + 8);
+    convertToLittleEndian(static_cast<uint16_t>(heat), message.data + 10);
+    convertToLittleEndian(static_cast<uint16_t>(0), message.data + 12);
+    convertToLittleEndian(static_cast<uint16_t>(0), message.data + 14);
+
+    refSerial.messageReceiveCallback(message);
+}
+}  // namespace tap::communication::serial
+
+#endif  // PLATFORM_HOSTED
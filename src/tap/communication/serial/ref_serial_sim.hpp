@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_REF_SERIAL_SIM_HPP_
+#define TAPROOT_REF_SERIAL_SIM_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstdint>
+#include <random>
+
+#include "tap/motor/motorsim/motor_sim_engine.hpp"
+
+#include "ref_serial.hpp"
+
+namespace tap::communication::serial
+{
+/**
+ * A simulated referee system for hosted builds, so that power limiting and heat limiting can be
+ * run in closed loop. The sim computes the chassis power drawn by the chassis motors of a
+ * `motor::motorsim::MotorSimEngine` and the turret heat of the projectiles launched, and passes
+ * robot status and power and heat messages to a `RefSerial` as if they were received over serial,
+ * so they are decoded by the same code as on the robot.
+ *
+ * The chassis power is the sum of the electrical power, voltage times current, of each chassis
+ * motor that is drawing power. Like the referee system, the sim drains the power buffer while the
+ * power is above the chassis power limit and refills it while the power is below. Penalties for
+ * emptying the power buffer or exceeding the heat limit aren't simulated.
+ *
+ * @note The messages are robot data, so they are only decoded if the `decode_robot_data` option
+ *      of the `:communication:serial:ref_serial` module is enabled.
+ *
+ * Like the engine, the sim is advanced by an explicit `dt`, so it should be stepped right after
+ * the engine with the same `dt`. The reported power has gaussian noise drawn from a generator
+ * seeded by the config, so a simulation gives the same results every time it is run.
+ */
+class RefSerialSim
+{
+public:
+    /// Max number of chassis motors whose power is summed.
+    static constexpr int MAX_CHASSIS_MOTORS = 8;
+
+    /// Heat added to the turret by each 17 mm projectile launched.
+    static constexpr uint16_t HEAT_PER_17MM_PROJECTILE = 10;
+
+    struct Config
+    {
+        RefSerialData::Rx::RobotId robotId;
+        uint16_t maxHp;
+        uint16_t chassisPowerLimit;  ///< W
+        uint16_t maxPowerBuffer;     ///< J
+        uint16_t heatLimit;
+        uint16_t coolingRate;        ///< Heat cooled per second
+        float supplyVoltage;         ///< V
+        float powerNoise;            ///< Standard deviation of the reported power, W
+        float robotStatusPeriod;     ///< Time between robot status messages, seconds
+        float powerAndHeatPeriod;    ///< Time between power and heat messages, seconds
+        uint32_t seed;               ///< Seed of the noise generator
+    };
+
+    /// A level 1 standard robot, with the message rates of the referee system.
+    static constexpr Config STANDARD_CONFIG = {
+        .robotId = RefSerialData::Rx::RobotId::RED_SOLDIER_1,
+        .maxHp = 200,
+        .chassisPowerLimit = 60,
+        .maxPowerBuffer = 60,
+        .heatLimit = 200,
+        .coolingRate = 10,
+        .supplyVoltage = 24,
+        .powerNoise = 0.5f,
+        .robotStatusPeriod = 0.1f,
+        .powerAndHeatPeriod = 0.02f,
+        .seed = 0,
+    };
+
+    /**
+     * @param[in] refSerial The ref serial the messages are passed to.
+     * @param[in] engine The engine simulating the chassis motors. Both must outlive the sim.
+     */
+    RefSerialSim(
+        RefSerial &refSerial,
+        const motor::motorsim::MotorSimEngine &engine,
+        const Config &config = STANDARD_CONFIG);
+
+    /**
+     * Adds the power drawn by an engine motor to the chassis power.
+     *
+     * @return `false` if `MAX_CHASSIS_MOTORS` have been added.
+     */
+    bool addChassisMotor(int motor);
+
+    /// Adds the heat of a 17 mm projectile to the turret heat.
+    void launchProjectile17mm();
+
+    /// Sets the chassis power limit, for example to simulate the robot leveling up.
+    void setChassisPowerLimit(uint16_t limit) { config.chassisPowerLimit = limit; }
+
+    /// Fills the power buffer, zeroes the heat and sends the next messages on the next step.
+    void reset();
+
+    /**
+     * Advances the sim by `dt` seconds, sending the messages that are due. The first step sends
+     * every message. Does nothing if `dt` is not positive.
+     */
+    void step(float dt);
+
+    /// @return The true chassis power in the last step, without noise, in W.
+    float getChassisPower() const { return chassisPower; }
+
+    /// @return The power buffer, in J.
+    float getPowerBuffer() const { return powerBuffer; }
+
+    /// @return The turret heat.
+    float getHeat() const { return heat; }
+
+private:
+    RefSerial &refSerial;
+    const motor::motorsim::MotorSimEngine &engine;
+    Config config;
+
+    std::mt19937 generator;
+    std::normal_distribution<float> normal;
+
+    int chassisMotorCount = 0;
+    int chassisMotors[MAX_CHASSIS_MOTORS] = {};
+
+    float chassisPower = 0;
+    float powerBuffer = 0;
+    float heat = 0;
+
+    /// Time since each message was last sent, in seconds.
+    float timeSinceRobotStatus = 0;
+    float timeSincePowerAndHeat = 0;
+
+    void sendRobotStatus();
+    void sendPowerAndHeat();
+};
+}  // namespace tap::communication::serial
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_REF_SERIAL_SIM_HPP_
@@ -223,14 +223,19 @@ modm::ResumableResult<void> RefSerialTransmitter::deleteGraphicLayer(
         reinterpret_cast<uint8_t*>(&deleteGraphicLayerMessage),
         sizeof(Tx::DeleteGraphicLayerMessage) - sizeof(deleteGraphicLayerMessage.crc16));
 
-    RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore());
+    drivers->refSerial.queueTransmission(Tx::TransmissionPriority::LOW);
+    RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore(
+        Tx::TransmissionPriority::LOW,
+        sizeof(Tx::DeleteGraphicLayerMessage)));
 
     drivers->uart.write(
         bound_ports::REF_SERIAL_UART_PORT,
         reinterpret_cast<uint8_t*>(&deleteGraphicLayerMessage),
         sizeof(Tx::DeleteGraphicLayerMessage));
 
-    drivers->refSerial.releaseTransmissionSemaphore(sizeof(Tx::DeleteGraphicLayerMessage));
+    drivers->refSerial.releaseTransmissionSemaphore(
+        Tx::TransmissionPriority::LOW,
+        sizeof(Tx::DeleteGraphicLayerMessage));
 
     RF_END();
 }
@@ -274,14 +279,19 @@ modm::ResumableResult<void> RefSerialTransmitter::sendGraphic_(
     }
     if (sendMsg)
     {
-        RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore());
+        drivers->refSerial.queueTransmission(Tx::TransmissionPriority::LOW);
+        RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore(
+            Tx::TransmissionPriority::LOW,
+            sizeof(GRAPHIC)));
 
         drivers->uart.write(
             bound_ports::REF_SERIAL_UART_PORT,
             reinterpret_cast<uint8_t*>(graphicMsg),
             sizeof(*graphicMsg));
 
-        drivers->refSerial.releaseTransmissionSemaphore(sizeof(GRAPHIC));
+        drivers->refSerial.releaseTransmissionSemaphore(
+            Tx::TransmissionPriority::LOW,
+            sizeof(GRAPHIC));
     }
     RF_END();
 }
@@ -375,7 +385,8 @@ modm::ResumableResult<void> RefSerialTransmitter::sendRobotToRobotMsg(
     Tx::RobotToRobotMessage* robotToRobotMsg,
     uint16_t msgId,
     RobotId receiverId,
-    uint16_t msgLen)
+    uint16_t msgLen,
+    Tx::TransmissionPriority priority)
 {
     RF_BEGIN(7);
 
@@ -422,7 +433,10 @@ modm::ResumableResult<void> RefSerialTransmitter::sendRobotToRobotMsg(
             reinterpret_cast<uint8_t*>(robotToRobotMsg),
             FULL_MSG_SIZE_LESS_MSGLEN + msgLen);
 
-    RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore());
+    drivers->refSerial.queueTransmission(priority);
+    RF_WAIT_UNTIL(drivers->refSerial.acquireTransmissionSemaphore(
+        priority,
+        FULL_MSG_SIZE_LESS_MSGLEN + msgLen + sizeof(uint16_t)));
 
     drivers->uart.write(
         bound_ports::REF_SERIAL_UART_PORT,
@@ -430,6 +444,7 @@ modm::ResumableResult<void> RefSerialTransmitter::sendRobotToRobotMsg(
         FULL_MSG_SIZE_LESS_MSGLEN + msgLen + sizeof(uint16_t));
 
     drivers->refSerial.releaseTransmissionSemaphore(
+        priority,
         FULL_MSG_SIZE_LESS_MSGLEN + msgLen + sizeof(uint16_t));
 
     RF_END();
@@ -255,11 +255,19 @@ class RefSerialTransmitter : public RefSerialData, public modm::Resumable<8>
         bool sendMsg = true);
     ///@}
 
+    /**
+     * Sends a robot to robot message to the specified robot.
+     *
+     * @param[in] priority The priority of the message. Messages of a higher priority waiting to be
+     *      sent are sent before this message, and this message is sent before all UI graphics
+     *      waiting to be sent.
+     */
     mockable modm::ResumableResult<void> sendRobotToRobotMsg(
         Tx::RobotToRobotMessage* robotToRobotMsg,
         uint16_t msgId,
         RobotId receiverId,
-        uint16_t msgLen);
+        uint16_t msgLen,
+        Tx::TransmissionPriority priority = Tx::TransmissionPriority::NORMAL);
 
 private:
     tap::Drivers* drivers;
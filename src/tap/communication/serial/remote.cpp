@@ -19,6 +19,9 @@
 
 #include "remote.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "tap/algorithms/math_user_utils.hpp"
 #include "tap/architecture/clock.hpp"
 #include "tap/communication/serial/uart.hpp"
@@ -42,6 +45,15 @@ void Remote::read()
         connected = false;  // Remote no longer connected
         reset();            // Reset current remote values
     }
+
+    readVtmInput();
+
+    if (drivers->uart.isRxDmaEnabled(bound_ports::REMOTE_SERIAL_UART_PORT))
+    {
+        readIdleLineFrame();
+        return;
+    }
+
     uint8_t data;  // Next byte to be read
     // Read next byte if available and more needed for the current packet
     while (drivers->uart.read(bound_ports::REMOTE_SERIAL_UART_PORT, &data) &&
@@ -54,6 +66,10 @@ void Remote::read()
     // Check read timeout
     if (tap::arch::clock::getTimeMilliseconds() - lastRead > REMOTE_READ_TIMEOUT)
     {
+        if (currentBufferIndex > 0)
+        {
+            connectionQuality.badFrames++;
+        }
         clearRxBuffer();
     }
     // Parse buffer if all 18 bytes are read
@@ -65,9 +81,237 @@ void Remote::read()
     }
 }
 
+void Remote::readIdleLineFrame()
+{
+    std::size_t bytesUntilIdle =
+        drivers->uart.getBytesUntilRxIdle(bound_ports::REMOTE_SERIAL_UART_PORT);
+
+    if (bytesUntilIdle == 0)
+    {
+        return;
+    }
+
+    // If several bursts were received since the last read, only the most recent idle line is
+    // known, so the last REMOTE_BUF_LEN bytes before it are the most recent frame
+    while (bytesUntilIdle > REMOTE_BUF_LEN)
+    {
+        const std::size_t bytesSkipped = drivers->uart.read(
+            bound_ports::REMOTE_SERIAL_UART_PORT,
+            rxBuffer,
+            std::min<std::size_t>(bytesUntilIdle - REMOTE_BUF_LEN, REMOTE_BUF_LEN));
+
+        if (bytesSkipped == 0)
+        {
+            return;
+        }
+
+        bytesUntilIdle -= bytesSkipped;
+    }
+
+    currentBufferIndex =
+        drivers->uart.read(bound_ports::REMOTE_SERIAL_UART_PORT, rxBuffer, bytesUntilIdle);
+
+    // a burst shorter than a frame is not a valid frame
+    if (currentBufferIndex == REMOTE_BUF_LEN)
+    {
+        lastRead = tap::arch::clock::getTimeMilliseconds();
+        connected = true;
+        parseBuffer();
+    }
+    else if (currentBufferIndex > 0)
+    {
+        connectionQuality.badFrames++;
+    }
+
+    currentBufferIndex = 0;
+}
+
+void Remote::readVtmInput()
+{
+    RefSerialData::Rx::VtmInputData data;
+    const uint32_t inputsReceived = drivers->refSerial.getVtmInput(&data);
+
+    KeyboardMouseInput input;
+    if (inputsReceived != vtmInputsRead)
+    {
+        vtmInputsRead = inputsReceived;
+        vtmInputConnected = true;
+        input.mouseX = data.mouseX;
+        input.mouseY = data.mouseY;
+        input.mouseZ = data.mouseZ;
+        input.mouseL = data.mouseL;
+        input.mouseR = data.mouseR;
+        input.key = data.key;
+    }
+    else if (
+        vtmInputConnected &&
+        tap::arch::clock::getTimeMilliseconds() - data.receiveTime > VTM_INPUT_TIMEOUT)
+    {
+        // Release everything held over the link, input held on the DR16 stays held
+        vtmInputConnected = false;
+    }
+    else
+    {
+        return;
+    }
+
+    const RemoteInfo previous = remote;
+    mergeKeyboardMouse(vtmInput, input);
+    queueInputEvents(previous);
+
+    drivers->commandMapper.handleKeyStateChange(
+        remote.key,
+        remote.leftSwitch,
+        remote.rightSwitch,
+        remote.mouse.l,
+        remote.mouse.r);
+}
+
+void Remote::mergeKeyboardMouse(KeyboardMouseInput &sourceInput, const KeyboardMouseInput &input)
+{
+    if (input.mouseX != sourceInput.mouseX)
+    {
+        remote.mouse.x = input.mouseX;
+    }
+    if (input.mouseY != sourceInput.mouseY)
+    {
+        remote.mouse.y = input.mouseY;
+    }
+    if (input.mouseZ != sourceInput.mouseZ)
+    {
+        remote.mouse.z = input.mouseZ;
+    }
+    if (input.mouseL != sourceInput.mouseL)
+    {
+        remote.mouse.l = input.mouseL;
+    }
+    if (input.mouseR != sourceInput.mouseR)
+    {
+        remote.mouse.r = input.mouseR;
+    }
+    const uint16_t changedKeys = input.key ^ sourceInput.key;
+    remote.key = (remote.key & ~changedKeys) | (input.key & changedKeys);
+
+    sourceInput = input;
+}
+
 bool Remote::isConnected() const { return connected; }
 
+bool Remote::isVtmInputConnected() const { return vtmInputConnected; }
+
 float Remote::getChannel(Channel ch) const
+{
+    const ChannelSmoothing &smoothing = channelSmoothing[static_cast<int>(ch)];
+    float value;
+    if (smoothing.predict && channelPredictorsStarted)
+    {
+        const uint32_t time = std::min(
+            tap::arch::clock::getTimeMilliseconds(),
+            lastFrameTime + smoothing.maxPredictionTime);
+        value = tap::algorithms::limitVal(
+            channelPredictors[static_cast<int>(ch)].getInterpolatedValue(time),
+            -1.0f,
+            1.0f);
+    }
+    else
+    {
+        value = getRawChannel(ch);
+    }
+
+    if (smoothing.deadband == 0.0f && smoothing.curveExponent == 1.0f)
+    {
+        return value;
+    }
+
+    const float magnitude = fabsf(value);
+    if (magnitude <= smoothing.deadband)
+    {
+        return 0.0f;
+    }
+    const float shaped = powf(
+        (magnitude - smoothing.deadband) / (1.0f - smoothing.deadband),
+        smoothing.curveExponent);
+    return value < 0 ? -shaped : shaped;
+}
+
+void Remote::setChannelSmoothing(Channel ch, const ChannelSmoothing &smoothing)
+{
+    channelSmoothing[static_cast<int>(ch)] = smoothing;
+}
+
+uint32_t Remote::getLastFrameTime() const { return lastFrameTime; }
+
+uint32_t Remote::getMissedFrames() const
+{
+    if (connectionQuality.framesReceived == 0)
+    {
+        return 0;
+    }
+    return countMissedFrames(tap::arch::clock::getTimeMicroseconds() - lastFrameTimeUs);
+}
+
+bool Remote::isMissingFrames() const { return getMissedFrames() >= missedFrameLimit; }
+
+void Remote::setMissedFrameLimit(uint32_t frames) { missedFrameLimit = frames; }
+
+Remote::ConnectionQuality Remote::getConnectionQuality() const { return connectionQuality; }
+
+uint32_t Remote::countMissedFrames(uint32_t elapsedUs) const
+{
+    const uint32_t period = connectionQuality.framePeriodUs;
+    if (cadenceIntervals < CADENCE_LEARNING_FRAMES || period == 0)
+    {
+        return 0;
+    }
+    // A frame is late, not missed, until half a period plus the usual jitter past its due time
+    const uint32_t margin = period / 2 + 2 * connectionQuality.jitterUs;
+    return elapsedUs > margin ? (elapsedUs - margin) / period : 0;
+}
+
+void Remote::updateFrameCadence(uint32_t frameTimeUs)
+{
+    ConnectionQuality &quality = connectionQuality;
+    const bool firstFrame = quality.framesReceived == 0;
+    const uint32_t interval = frameTimeUs - lastFrameTimeUs;
+    lastFrameTimeUs = frameTimeUs;
+    quality.framesReceived++;
+
+    // An interval spanning a disconnect says nothing about the cadence
+    if (firstFrame || interval > static_cast<uint32_t>(REMOTE_DISCONNECT_TIMEOUT) * 1'000)
+    {
+        return;
+    }
+
+    quality.longestGapUs = std::max(quality.longestGapUs, interval);
+
+    const uint32_t missed = countMissedFrames(interval);
+    if (missed > 0)
+    {
+        quality.gaps++;
+        quality.framesMissed += missed;
+        return;
+    }
+
+    if (cadenceIntervals == 0)
+    {
+        quality.framePeriodUs = interval;
+    }
+    else
+    {
+        // Moving averages with gains of 1/8 and 1/4, like RFC 6298 round trip time estimation
+        const int32_t error = static_cast<int32_t>(interval - quality.framePeriodUs);
+        const int32_t jitter = quality.jitterUs;
+        quality.framePeriodUs += error / 8;
+        quality.jitterUs = jitter + (abs(error) - jitter) / 4;
+    }
+    if (cadenceIntervals < CADENCE_LEARNING_FRAMES)
+    {
+        cadenceIntervals++;
+    }
+    quality.frameRate = quality.framePeriodUs > 0 ? 1e6f / quality.framePeriodUs : 0;
+}
+
+float Remote::getRawChannel(Channel ch) const
 {
     switch (ch)
     {
@@ -103,6 +347,8 @@ void Remote::parseBuffer()
     // translated document our team acquired a while back; refer to this document for the protocol
     // encoding: https://drive.google.com/file/d/1a5kaTsDvG89KQwy3fkLVkxKaQJfJCsnu/view?usp=sharing
 
+    const RemoteInfo previous = remote;
+
     // remote joystick information
     remote.rightHorizontal = (rxBuffer[0] | rxBuffer[1] << 8) & 0x07FF;
     remote.rightHorizontal -= 1024;
@@ -116,15 +362,17 @@ void Remote::parseBuffer()
     remote.leftSwitch = static_cast<Remote::SwitchState>((rxBuffer[5] >> 6) & 0x03);
     remote.rightSwitch = static_cast<Remote::SwitchState>((rxBuffer[5] >> 4) & 0x03);
 
+    KeyboardMouseInput input;
     // mouse input
-    remote.mouse.x = rxBuffer[6] | (rxBuffer[7] << 8);    // x axis
-    remote.mouse.y = rxBuffer[8] | (rxBuffer[9] << 8);    // y axis
-    remote.mouse.z = rxBuffer[10] | (rxBuffer[11] << 8);  // z axis
-    remote.mouse.l = static_cast<bool>(rxBuffer[12]);     // left button click
-    remote.mouse.r = static_cast<bool>(rxBuffer[13]);     // right button click
+    input.mouseX = rxBuffer[6] | (rxBuffer[7] << 8);    // x axis
+    input.mouseY = rxBuffer[8] | (rxBuffer[9] << 8);    // y axis
+    input.mouseZ = rxBuffer[10] | (rxBuffer[11] << 8);  // z axis
+    input.mouseL = static_cast<bool>(rxBuffer[12]);     // left button click
+    input.mouseR = static_cast<bool>(rxBuffer[13]);     // right button click
 
     // keyboard capture
-    remote.key = rxBuffer[14] | rxBuffer[15] << 8;
+    input.key = rxBuffer[14] | rxBuffer[15] << 8;
+    mergeKeyboardMouse(dr16Input, input);
     // remote wheel
     remote.wheel = (rxBuffer[16] | rxBuffer[17] << 8) - 1024;
 
@@ -135,8 +383,27 @@ void Remote::parseBuffer()
         (abs(remote.leftVertical) > ANALOG_MAX_VALUE) || (abs(remote.wheel) > ANALOG_MAX_VALUE))
     {
         RAISE_ERROR(drivers, "invalid remote joystick values");
+        connectionQuality.badFrames++;
     }
 
+    lastFrameTime = tap::arch::clock::getTimeMilliseconds();
+    updateFrameCadence(tap::arch::clock::getTimeMicroseconds());
+    for (int i = 0; i < NUM_CHANNELS; i++)
+    {
+        const float value = getRawChannel(static_cast<Channel>(i));
+        if (channelPredictorsStarted)
+        {
+            channelPredictors[i].update(value, lastFrameTime);
+        }
+        else
+        {
+            channelPredictors[i].reset(value, lastFrameTime);
+        }
+    }
+    channelPredictorsStarted = true;
+
+    queueInputEvents(previous);
+
     drivers->commandMapper.handleKeyStateChange(
         remote.key,
         remote.leftSwitch,
@@ -162,28 +429,103 @@ void Remote::clearRxBuffer()
 
 void Remote::reset()
 {
+    const RemoteInfo previous = remote;
+
     remote.rightHorizontal = 0;
     remote.rightVertical = 0;
     remote.leftHorizontal = 0;
     remote.leftVertical = 0;
     remote.leftSwitch = SwitchState::UNKNOWN;
     remote.rightSwitch = SwitchState::UNKNOWN;
-    remote.mouse.x = 0;
-    remote.mouse.y = 0;
-    remote.mouse.z = 0;
-    remote.mouse.l = 0;
-    remote.mouse.r = 0;
-    remote.key = 0;
     remote.wheel = 0;
+    // Release everything held on the DR16, input held over the video transmitter link stays held
+    mergeKeyboardMouse(dr16Input, KeyboardMouseInput());
     clearRxBuffer();
 
-    // Refresh command mapper with all keys deactivated. This prevents bug where
+    // A slope from before the disconnect means nothing once frames resume
+    channelPredictorsStarted = false;
+
+    queueInputEvents(previous);
+
+    // Refresh command mapper with all DR16 inputs deactivated. This prevents bug where
     // command states enter defaults when remote reconnects even if key/switch
     // state should do otherwise
-    drivers->commandMapper
-        .handleKeyStateChange(0, SwitchState::UNKNOWN, SwitchState::UNKNOWN, false, false);
+    drivers->commandMapper.handleKeyStateChange(
+        remote.key,
+        SwitchState::UNKNOWN,
+        SwitchState::UNKNOWN,
+        remote.mouse.l,
+        remote.mouse.r);
 }
 
 uint32_t Remote::getUpdateCounter() const { return remote.updateCounter; }
 
+bool Remote::popInputEvent(InputEvent *event)
+{
+    if (inputEvents.isEmpty())
+    {
+        return false;
+    }
+    *event = inputEvents.getFront();
+    inputEvents.removeFront();
+    return true;
+}
+
+int Remote::getInputEventCount() const { return inputEvents.getSize(); }
+
+uint32_t Remote::getDroppedInputEventCount() const { return droppedInputEvents; }
+
+void Remote::queueInputEvents(const RemoteInfo &previous)
+{
+    if (remote.leftSwitch != previous.leftSwitch)
+    {
+        queueInputEvent(
+            InputEvent::Type::SWITCH_CHANGE,
+            static_cast<uint8_t>(Switch::LEFT_SWITCH),
+            remote.leftSwitch);
+    }
+    if (remote.rightSwitch != previous.rightSwitch)
+    {
+        queueInputEvent(
+            InputEvent::Type::SWITCH_CHANGE,
+            static_cast<uint8_t>(Switch::RIGHT_SWITCH),
+            remote.rightSwitch);
+    }
+    if (remote.mouse.l != previous.mouse.l)
+    {
+        queueInputEvent(
+            remote.mouse.l ? InputEvent::Type::MOUSE_DOWN : InputEvent::Type::MOUSE_UP,
+            0,
+            SwitchState::UNKNOWN);
+    }
+    if (remote.mouse.r != previous.mouse.r)
+    {
+        queueInputEvent(
+            remote.mouse.r ? InputEvent::Type::MOUSE_DOWN : InputEvent::Type::MOUSE_UP,
+            1,
+            SwitchState::UNKNOWN);
+    }
+
+    uint16_t changedKeys = remote.key ^ previous.key;
+    while (changedKeys != 0)
+    {
+        const uint8_t key = __builtin_ctz(changedKeys);
+        changedKeys &= changedKeys - 1;
+        queueInputEvent(
+            (remote.key & (1 << key)) ? InputEvent::Type::KEY_DOWN : InputEvent::Type::KEY_UP,
+            key,
+            SwitchState::UNKNOWN);
+    }
+}
+
+void Remote::queueInputEvent(InputEvent::Type type, uint8_t input, SwitchState switchState)
+{
+    if (inputEvents.isFull())
+    {
+        inputEvents.removeFront();
+        droppedInputEvents++;
+    }
+    inputEvents.append({type, input, switchState, tap::arch::clock::getTimeMicroseconds()});
+}
+
 }  // namespace tap::communication::serial
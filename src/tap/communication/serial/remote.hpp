@@ -26,8 +26,11 @@
 #include "modm/platform.hpp"
 #endif
 
+#include "tap/algorithms/linear_interpolation_predictor.hpp"
 #include "tap/util_macros.hpp"
 
+#include "modm/container/deque.hpp"
+
 namespace tap
 {
 class Drivers;
@@ -42,6 +45,13 @@ namespace tap::communication::serial
  * Information for implementation was translated from a user manual for the DR16 that was
  * only available in Chinese. AI-Translated version of document available here:
  * https://drive.google.com/file/d/1-ZGe4mXVhxP4IEmHccphnzKzYWJyw3C3/view?usp=sharing
+ *
+ * Keyboard and mouse input also arrives over the referee system's video transmitter link, which
+ * `RefSerial` decodes (see `RefSerial::getVtmInput`). `read` merges it with the input from the
+ * DR16 one field at a time: each key, mouse button, and mouse axis takes the value of whichever
+ * source most recently reported a change to it. Input is used as soon as either link delivers it,
+ * a source that always reports a field as released doesn't mask it, and when one link drops out
+ * the other keeps working. The sticks, switches, and wheel are only received by the DR16.
  */
 class Remote
 {
@@ -62,6 +72,24 @@ class Remote
         WHEEL
     };
 
+    /**
+     * How `getChannel` shapes a channel. The default leaves the channel as received.
+     */
+    struct ChannelSmoothing
+    {
+        /**
+         * Frames arrive about every 14 ms, so a channel read by a faster control loop steps.
+         * When `true`, the channel is extrapolated from the slope between the last two frames.
+         */
+        bool predict = false;
+        /// The furthest past the last frame the channel is extrapolated, in milliseconds.
+        uint32_t maxPredictionTime = 14;
+        /// Values of smaller magnitude read as 0. The rest of the range is rescaled to [0, 1].
+        float deadband = 0.0f;
+        /// The magnitude, after the deadband, is raised to this power. Above 1, finer near 0.
+        float curveExponent = 1.0f;
+    };
+
     /**
      * Specifies a particular switch.
      */
@@ -105,6 +133,61 @@ class Remote
         B
     };
 
+    /**
+     * A change in the state of a key, switch, or mouse button between two remote frames.
+     */
+    struct InputEvent
+    {
+        enum class Type : uint8_t
+        {
+            KEY_DOWN,
+            KEY_UP,
+            SWITCH_CHANGE,
+            MOUSE_DOWN,
+            MOUSE_UP,
+        };
+
+        Type type;
+        /// The `Key` or `Switch` that changed, or 0 for the left and 1 for the right mouse button.
+        uint8_t input;
+        /// For `SWITCH_CHANGE`, the state the switch changed to.
+        SwitchState switchState;
+        /// The time the frame with the change was parsed, in microseconds.
+        uint32_t timestamp;
+    };
+
+    /// The most input events queued before the oldest are dropped.
+    static constexpr int INPUT_EVENT_QUEUE_SIZE = 32;
+
+    /**
+     * Statistics about the frames received from the DR16, see `getConnectionQuality`.
+     */
+    struct ConnectionQuality
+    {
+        /// Moving average of the period between frames (in us), 0 until two frames are received.
+        uint32_t framePeriodUs = 0;
+        /// Moving average of the deviation of the interval between frames from the period (in us).
+        uint32_t jitterUs = 0;
+        /// Frames per second at `framePeriodUs`, 0 until two frames are received.
+        float frameRate = 0;
+        uint32_t framesReceived = 0;  ///< Number of frames parsed.
+        /// Number of frames that were incomplete or had out of range joystick values.
+        uint32_t badFrames = 0;
+        /// Number of intervals between two frames in which at least one expected frame was missed.
+        uint32_t gaps = 0;
+        uint32_t framesMissed = 0;  ///< Total number of expected frames missed in `gaps`.
+        uint32_t longestGapUs = 0;  ///< Longest interval between two frames (in us).
+    };
+
+    /**
+     * The number of intervals between frames the frame period is averaged over before
+     * `getMissedFrames` reports missed frames.
+     */
+    static constexpr uint32_t CADENCE_LEARNING_FRAMES = 8;
+
+    /// The default number of missed frames at which `isMissingFrames` returns `true`.
+    static constexpr uint32_t DEFAULT_MISSED_FRAME_LIMIT = 3;
+
     /**
      * Enables and initializes `bound_ports::REMOTE_SERIAL_UART_PORT`.
      */
@@ -113,6 +196,10 @@ class Remote
     /**
      * Reads/parses the current buffer and updates the current remote info state
      * and `CommandMapper` state.
+     *
+     * If the remote's UART port receives using DMA (see `Uart::isRxDmaEnabled`), frames are
+     * delimited by the receive line going idle after each frame. Otherwise, a frame is discarded
+     * if its bytes are not all received within `REMOTE_READ_TIMEOUT` ms.
      */
     mockable void read();
 
@@ -125,10 +212,48 @@ class Remote
     mockable bool isConnected() const;
 
     /**
-     * @return The value of the given channel, between [-1, 1].
+     * @return The number of frames expected from the DR16 that have not arrived since the most
+     *      recent frame, based on the learned frame period. A frame counts as missed once half a
+     *      period plus twice the jitter has passed since it was due. 0 until the period is learned.
+     */
+    mockable uint32_t getMissedFrames() const;
+
+    /**
+     * @return `true` if at least the missed frame limit (see `setMissedFrameLimit`) of expected
+     *      frames have been missed. Since the limit is counted in learned frame periods, this
+     *      detects a transmitter that stopped sending within a few frames, much sooner than
+     *      `isConnected`, which waits for a fixed timeout long enough to never trigger on jitter.
+     *      A `SafeDisconnectFunction` may check both.
+     */
+    mockable bool isMissingFrames() const;
+
+    /// Sets the number of missed frames at which `isMissingFrames` returns `true`.
+    mockable void setMissedFrameLimit(uint32_t frames);
+
+    /// @return Statistics about the frames received from the DR16, for diagnostics.
+    mockable ConnectionQuality getConnectionQuality() const;
+
+    /**
+     * @return `true` if keyboard and mouse input has been received over the video transmitter
+     *      link within the last `VTM_INPUT_TIMEOUT` ms.
+     */
+    mockable bool isVtmInputConnected() const;
+
+    /**
+     * @return The value of the given channel, between [-1, 1], shaped as set by
+     *      `setChannelSmoothing`.
      */
     mockable float getChannel(Channel ch) const;
 
+    /// Sets how `getChannel` shapes the given channel.
+    mockable void setChannelSmoothing(Channel ch, const ChannelSmoothing &smoothing);
+
+    /**
+     * @return The time the most recent frame was received, in milliseconds, from
+     *      `tap::arch::clock::getTimeMilliseconds`.
+     */
+    mockable uint32_t getLastFrameTime() const;
+
     /**
      * @return The state of the given switch.
      */
@@ -168,16 +293,37 @@ class Remote
     }
 
     /**
-     * @return the number of times remote info has been received.
+     * @return the number of times remote info has been received from the DR16.
      */
     mockable uint32_t getUpdateCounter() const;
 
+    /**
+     * Removes the oldest queued input event.
+     *
+     * Every frame is compared to the one before it, and each key, switch, and mouse button that
+     * changed queues an event, so a press and release between two polls of `keyPressed` are
+     * both seen, with the times they were received. When the remote disconnects, release events
+     * are queued for everything still held.
+     *
+     * @param[out] event The oldest input event.
+     * @return `false` if there are no queued events, in which case `event` is unchanged.
+     */
+    mockable bool popInputEvent(InputEvent *event);
+
+    /// @return The number of queued input events.
+    mockable int getInputEventCount() const;
+
+    /// @return The number of input events dropped because the queue was full.
+    mockable uint32_t getDroppedInputEventCount() const;
+
 private:
     static const int REMOTE_BUF_LEN = 18;              ///< Length of the remote recieve buffer.
     static const int REMOTE_READ_TIMEOUT = 6;          ///< Timeout delay between valid packets.
     static const int REMOTE_DISCONNECT_TIMEOUT = 100;  ///< Timeout delay for remote disconnect.
     static const int REMOTE_INT_PRI = 12;              ///< Interrupt priority.
+    static const int VTM_INPUT_TIMEOUT = 100;  ///< Timeout delay for video transmitter input.
     static constexpr float ANALOG_MAX_VALUE = 660.0f;  ///< Max value received by one of the sticks.
+    static constexpr int NUM_CHANNELS = static_cast<int>(Channel::WHEEL) + 1;
 
     /// The current remote information
     struct RemoteInfo
@@ -202,10 +348,33 @@ class Remote
         int16_t wheel = 0;  ///< Remote wheel information
     };
 
+    /// Keyboard and mouse state as reported by a single input source.
+    struct KeyboardMouseInput
+    {
+        int16_t mouseX = 0;
+        int16_t mouseY = 0;
+        int16_t mouseZ = 0;
+        bool mouseL = false;
+        bool mouseR = false;
+        uint16_t key = 0;
+    };
+
     Drivers *drivers;
 
+    /// The current remote information, with keyboard and mouse input merged from both sources.
     RemoteInfo remote;
 
+    /// The keyboard and mouse input most recently reported by the DR16.
+    KeyboardMouseInput dr16Input;
+
+    /// The keyboard and mouse input most recently reported over the video transmitter link.
+    KeyboardMouseInput vtmInput;
+
+    /// The number of video transmitter inputs `RefSerial` had received when last read.
+    uint32_t vtmInputsRead = 0;
+
+    bool vtmInputConnected = false;
+
     /// Remote connection state.
     bool connected = false;
 
@@ -218,14 +387,68 @@ class Remote
     /// Current count of bytes read.
     uint8_t currentBufferIndex = 0;
 
+    modm::BoundedDeque<InputEvent, INPUT_EVENT_QUEUE_SIZE> inputEvents;
+
+    uint32_t droppedInputEvents = 0;
+
+    /// Timestamp when the last frame was parsed (milliseconds).
+    uint32_t lastFrameTime = 0;
+
+    /// Timestamp when the last frame was parsed (microseconds).
+    uint32_t lastFrameTimeUs = 0;
+
+    ConnectionQuality connectionQuality;
+
+    /// Number of intervals between frames the period has been learned from.
+    uint32_t cadenceIntervals = 0;
+
+    uint32_t missedFrameLimit = DEFAULT_MISSED_FRAME_LIMIT;
+
+    ChannelSmoothing channelSmoothing[NUM_CHANNELS];
+
+    /// Follow every channel, whether or not it is predicted, so enabling prediction is seamless.
+    tap::algorithms::LinearInterpolationPredictor channelPredictors[NUM_CHANNELS];
+
+    /// `false` until the first frame since the last reset has been parsed.
+    bool channelPredictorsStarted = false;
+
+    /**
+     * Reads the most recent frame that ended when the receive line went idle into rxBuffer and
+     * parses it. Older frames that have not been read are skipped.
+     */
+    void readIdleLineFrame();
+
+    /// @return The value of the given channel as received, between [-1, 1].
+    float getRawChannel(Channel ch) const;
+
     /// Parses the current rxBuffer.
     void parseBuffer();
 
+    /// Updates the connection quality with a frame parsed at the given time (in us).
+    void updateFrameCadence(uint32_t frameTimeUs);
+
+    /// @return The number of frames missed in the given time since the last frame (in us).
+    uint32_t countMissedFrames(uint32_t elapsedUs) const;
+
+    /// Merges new keyboard and mouse input received over the video transmitter link.
+    void readVtmInput();
+
+    /**
+     * Sets each keyboard and mouse field of `remote` that differs between `input` and
+     * `sourceInput`, the source's previous report, then updates `sourceInput` to `input`.
+     */
+    void mergeKeyboardMouse(KeyboardMouseInput &sourceInput, const KeyboardMouseInput &input);
+
     /// Clears the current rxBuffer.
     void clearRxBuffer();
 
     /// Resets the current remote info.
     void reset();
+
+    /// Queues an input event for every key, switch, and mouse button that differs from `previous`.
+    void queueInputEvents(const RemoteInfo &previous);
+
+    void queueInputEvent(InputEvent::Type type, uint8_t input, SwitchState switchState);
 };  // class Remote
 
 }  // namespace tap::communication::serial
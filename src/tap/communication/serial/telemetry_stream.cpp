@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "telemetry_stream.hpp"
+
+#include <cstring>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+
+namespace tap::communication::serial
+{
+TelemetryStream::TelemetryStream(modm::IODevice &device)
+    : device(device),
+      signals(),
+      dataTimer(),
+      descriptorTimer(DESCRIPTOR_PERIOD_MS),
+      packet(),
+      frame()
+{
+}
+
+bool TelemetryStream::addSignal(const char *name, const void *value, SignalType type, uint8_t size)
+{
+    if (streaming || numSignals >= MAX_SIGNALS || name == nullptr || value == nullptr)
+    {
+        return false;
+    }
+
+    signals[numSignals++] = {name, value, type, size};
+    return true;
+}
+
+bool TelemetryStream::start(uint32_t rateHz)
+{
+    if (rateHz == 0 || numSignals == 0)
+    {
+        return false;
+    }
+
+    if (rateHz > MAX_RATE_HZ)
+    {
+        rateHz = MAX_RATE_HZ;
+    }
+
+    streaming = true;
+    descriptorDue = true;
+    dataTimer.restart(1'000'000 / rateHz);
+    descriptorTimer.restart();
+    return true;
+}
+
+void TelemetryStream::stop()
+{
+    streaming = false;
+    dataTimer.stop();
+}
+
+std::size_t TelemetryStream::getDataPacketLength() const
+{
+    // type, sequence number, timestamp, and crc
+    std::size_t length = 2 + sizeof(uint32_t) + sizeof(uint16_t);
+    for (int i = 0; i < numSignals; i++)
+    {
+        length += signals[i].size;
+    }
+    return length;
+}
+
+void TelemetryStream::update()
+{
+    if (!streaming)
+    {
+        return;
+    }
+
+    if (descriptorTimer.execute())
+    {
+        descriptorDue = true;
+    }
+
+    // The descriptor is sent before any data so the host can decode the data, and afterwards
+    // only in place of a data packet so that it doesn't delay data packets.
+    if (descriptorDue)
+    {
+        descriptorDue = false;
+        sendPacket(packDescriptorPacket());
+    }
+    else if (dataTimer.execute())
+    {
+        sendPacket(packDataPacket());
+    }
+}
+
+bool TelemetryStream::sendBlock(uint8_t blockType, const uint8_t *payload, std::size_t length)
+{
+    if (length > MAX_BLOCK_LENGTH)
+    {
+        return false;
+    }
+
+    packet[0] = BLOCK_PACKET_TYPE;
+    packet[1] = blockType;
+    memcpy(packet + 2, payload, length);
+    sendPacket(2 + length);
+    return true;
+}
+
+std::size_t TelemetryStream::cobsEncode(const uint8_t *data, std::size_t length, uint8_t *encoded)
+{
+    // Each zero is replaced by the distance to the next zero, which is stored at the start of the
+    // block of nonzero bytes before it. Blocks are at most 254 bytes long.
+    std::size_t codeIndex = 0;
+    std::size_t encodedLength = 1;
+    uint8_t code = 1;
+
+    for (std::size_t i = 0; i < length; i++)
+    {
+        if (data[i] == 0)
+        {
+            encoded[codeIndex] = code;
+            codeIndex = encodedLength++;
+            code = 1;
+        }
+        else
+        {
+            encoded[encodedLength++] = data[i];
+            code++;
+            if (code == 0xff)
+            {
+                encoded[codeIndex] = code;
+                codeIndex = encodedLength++;
+                code = 1;
+            }
+        }
+    }
+
+    encoded[codeIndex] = code;
+    return encodedLength;
+}
+
+std::size_t TelemetryStream::packDataPacket()
+{
+    std::size_t length = 0;
+    packet[length++] = DATA_PACKET_TYPE;
+    packet[length++] = sequenceNumber++;
+    arch::convertToLittleEndian(arch::clock::getTimeMicroseconds(), packet + length);
+    length += sizeof(uint32_t);
+
+    // signal values are copied in the native byte order, which is little endian on both the MCB
+    // and hosted targets
+    for (int i = 0; i < numSignals; i++)
+    {
+        memcpy(packet + length, signals[i].value, signals[i].size);
+        length += signals[i].size;
+    }
+    return length;
+}
+
+std::size_t TelemetryStream::packDescriptorPacket()
+{
+    std::size_t length = 0;
+    packet[length++] = DESCRIPTOR_PACKET_TYPE;
+    packet[length++] = numSignals;
+    for (int i = 0; i < numSignals; i++)
+    {
+        uint8_t nameLength = strnlen(signals[i].name, MAX_NAME_LENGTH);
+        packet[length++] = static_cast<uint8_t>(signals[i].type);
+        packet[length++] = nameLength;
+        memcpy(packet + length, signals[i].name, nameLength);
+        length += nameLength;
+    }
+    return length;
+}
+
+void TelemetryStream::sendPacket(std::size_t length)
+{
+    uint16_t crc = algorithms::calculateCRC16(packet, length);
+    arch::convertToLittleEndian(crc, packet + length);
+    length += sizeof(crc);
+
+    std::size_t frameLength = 0;
+    frame[frameLength++] = 0;
+    frameLength += cobsEncode(packet, length, frame + frameLength);
+    frame[frameLength++] = 0;
+
+    for (std::size_t i = 0; i < frameLength; i++)
+    {
+        device.write(static_cast<char>(frame[i]));
+    }
+}
+}  // namespace tap::communication::serial
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TELEMETRY_STREAM_HPP_
+#define TAPROOT_TELEMETRY_STREAM_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "tap/architecture/periodic_timer.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iodevice.hpp"
+
+namespace tap::communication::serial
+{
+/**
+ * Streams the values of registered signals over an IO device as binary packets at a fixed rate,
+ * for plotting fast control loops on a computer in real time. Text streaming through the
+ * `TerminalSerial` is limited to a few lines per second, while a telemetry stream can send
+ * packets at kHz rates if the baud rate of the terminal's UART port is high enough.
+ *
+ * Every packet is CRC16 protected (the same CRC as the referee system, see
+ * `tap::algorithms::calculateCRC16`), COBS encoded so that it contains no zero bytes, and
+ * preceded and followed by a zero byte. A host can therefore resynchronize at the next zero byte
+ * after any corrupted or dropped bytes, and text written to the same device between packets is
+ * discarded by the host since it fails the CRC check. All multi-byte fields are little endian.
+ * Before COBS encoding, packets are:
+ *
+ * - Data packet: `0x01`, `uint8_t` sequence number, `uint32_t` timestamp in microseconds, the
+ *   value of each signal in the order the signals were added, `uint16_t` CRC16.
+ * - Descriptor packet: `0x02`, `uint8_t` number of signals, then for each signal a `uint8_t`
+ *   `SignalType`, a `uint8_t` name length, and the name (not null terminated), `uint16_t` CRC16.
+ * - Block packet: `0x03`, `uint8_t` block type, up to `MAX_BLOCK_LENGTH` bytes of payload,
+ *   `uint16_t` CRC16. Blocks carry buffered data, such as the samples of a
+ *   `tap::control::sysid::SysIdCapture`, whose format depends on the block type. Blocks are
+ *   sent by `sendBlock` whether or not the stream is streaming.
+ *
+ * A descriptor packet is sent when streaming starts and every `DESCRIPTOR_PERIOD_MS` so that a
+ * host may connect at any time. `tools/telemetry_decoder.py` decodes packets on the host.
+ *
+ * Usage:
+ *
+ * ```
+ * TelemetryStream &telemetry = drivers->terminalSerial.getTelemetryStream();
+ * telemetry.addSignal("pitch_setpoint", &pitchSetpoint);
+ * telemetry.addSignal("pitch_angle", &pitchAngle);
+ * telemetry.start(1000);
+ * ```
+ *
+ * @note A data packet with eight `float` signals is 43 bytes long after framing, so streaming it
+ *      at 1 kHz requires a baud rate of at least 430000 (for example 460800).
+ */
+class TelemetryStream
+{
+public:
+    enum class SignalType : uint8_t
+    {
+        FLOAT = 0,
+        INT32 = 1,
+        UINT32 = 2,
+        INT16 = 3,
+        UINT16 = 4,
+        INT8 = 5,
+        UINT8 = 6,
+    };
+
+    /// The maximum number of signals that may be added to a stream.
+    static constexpr int MAX_SIGNALS = 16;
+
+    /// Signal names longer than this are truncated in descriptor packets.
+    static constexpr int MAX_NAME_LENGTH = 16;
+
+    /// The maximum rate data packets may be sent at, in Hz.
+    static constexpr uint32_t MAX_RATE_HZ = 10'000;
+
+    static constexpr uint32_t DESCRIPTOR_PERIOD_MS = 1'000;
+
+    static constexpr uint8_t DATA_PACKET_TYPE = 0x01;
+    static constexpr uint8_t DESCRIPTOR_PACKET_TYPE = 0x02;
+    static constexpr uint8_t BLOCK_PACKET_TYPE = 0x03;
+
+    /// The longest payload of a block packet.
+    static constexpr std::size_t MAX_BLOCK_LENGTH = 256;
+
+    /// The length of the largest packet, before COBS encoding.
+    static constexpr std::size_t MAX_PACKET_LENGTH =
+        std::max<std::size_t>(2 + MAX_SIGNALS * (2 + MAX_NAME_LENGTH), 2 + MAX_BLOCK_LENGTH) +
+        sizeof(uint16_t);
+
+    /// The length of the largest frame, with COBS overhead and both zero delimiters.
+    static constexpr std::size_t MAX_FRAME_LENGTH = MAX_PACKET_LENGTH + MAX_PACKET_LENGTH / 254 + 3;
+
+    explicit TelemetryStream(modm::IODevice &device);
+    DISALLOW_COPY_AND_ASSIGN(TelemetryStream);
+
+    /**
+     * Adds a signal that is sent in every data packet. Signals can't be added while streaming.
+     *
+     * @param[in] name The name of the signal shown by the host. Must remain valid for the
+     *      lifetime of the stream.
+     * @param[in] value The value to send. Must remain valid for the lifetime of the stream.
+     * @tparam T One of `float`, `int32_t`, `uint32_t`, `int16_t`, `uint16_t`, `int8_t`, or
+     *      `uint8_t`.
+     * @return `false` if the stream is full or streaming, `true` otherwise.
+     */
+    template <typename T>
+    bool addSignal(const char *name, const T *value)
+    {
+        return addSignal(name, value, signalTypeOf<T>(), sizeof(T));
+    }
+
+    /**
+     * Starts sending data packets, beginning with a descriptor packet.
+     *
+     * @param[in] rateHz The rate data packets are sent at, limited to `MAX_RATE_HZ`.
+     * @return `false` if `rateHz` is 0 or no signals have been added, `true` otherwise.
+     */
+    bool start(uint32_t rateHz);
+
+    void stop();
+
+    bool isStreaming() const { return streaming; }
+
+    int getNumSignals() const { return numSignals; }
+
+    /// @return The length in bytes of a data packet, before COBS encoding.
+    std::size_t getDataPacketLength() const;
+
+    /**
+     * Sends a data packet if one is due, and a descriptor packet if one is due. At most one
+     * packet is sent per call, so this should be called at least as often as the stream's rate.
+     */
+    void update();
+
+    /**
+     * Sends a block packet immediately, see the class description.
+     *
+     * @return `false` if `length` is greater than `MAX_BLOCK_LENGTH`, `true` otherwise.
+     */
+    bool sendBlock(uint8_t blockType, const uint8_t *payload, std::size_t length);
+
+    /**
+     * COBS encodes `length` bytes of `data` into `encoded`, which must be at least
+     * `length + length / 254 + 1` bytes long.
+     *
+     * @return The length of the encoded data, which contains no zero bytes.
+     */
+    static std::size_t cobsEncode(const uint8_t *data, std::size_t length, uint8_t *encoded);
+
+private:
+    struct Signal
+    {
+        const char *name;
+        const void *value;
+        SignalType type;
+        uint8_t size;
+    };
+
+    template <typename T>
+    static constexpr SignalType signalTypeOf()
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return SignalType::FLOAT;
+        }
+        else if constexpr (std::is_same_v<T, int32_t>)
+        {
+            return SignalType::INT32;
+        }
+        else if constexpr (std::is_same_v<T, uint32_t>)
+        {
+            return SignalType::UINT32;
+        }
+        else if constexpr (std::is_same_v<T, int16_t>)
+        {
+            return SignalType::INT16;
+        }
+        else if constexpr (std::is_same_v<T, uint16_t>)
+        {
+            return SignalType::UINT16;
+        }
+        else if constexpr (std::is_same_v<T, int8_t>)
+        {
+            return SignalType::INT8;
+        }
+        else
+        {
+            static_assert(std::is_same_v<T, uint8_t>, "unsupported telemetry signal type");
+            return SignalType::UINT8;
+        }
+    }
+
+    modm::IODevice &device;
+
+    Signal signals[MAX_SIGNALS];
+
+    int numSignals = 0;
+
+    bool streaming = false;
+
+    bool descriptorDue = false;
+
+    uint8_t sequenceNumber = 0;
+
+    tap::arch::PeriodicMicroTimer dataTimer;
+
+    tap::arch::PeriodicMilliTimer descriptorTimer;
+
+    uint8_t packet[MAX_PACKET_LENGTH];
+
+    uint8_t frame[MAX_FRAME_LENGTH];
+
+    bool addSignal(const char *name, const void *value, SignalType type, uint8_t size);
+
+    std::size_t packDataPacket();
+
+    std::size_t packDescriptorPacket();
+
+    /// Appends a CRC to the `length` byte packet, then frames and writes it to the device.
+    void sendPacket(std::size_t length);
+};  // class TelemetryStream
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_TELEMETRY_STREAM_HPP_
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_TERMINAL_OUTPUT_BUFFER_HPP_
+#define TAPROOT_TERMINAL_OUTPUT_BUFFER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iodevice.hpp"
+
+namespace tap::communication::serial
+{
+/**
+ * A ring buffer that terminal output is formatted into, so that writing to a `modm::IOStream`
+ * never waits on a slow device. The buffer is moved to the device with `drain`, which only
+ * writes as much as the device accepts without blocking. Bytes written while the buffer is full
+ * are dropped, so whoever writes to the buffer should check `getFreeSpace` before writing a
+ * large amount of output.
+ *
+ * @tparam SIZE The capacity of the buffer in bytes.
+ */
+template <std::size_t SIZE>
+class TerminalOutputBuffer : public modm::IODevice
+{
+public:
+    TerminalOutputBuffer() = default;
+    DISALLOW_COPY_AND_ASSIGN(TerminalOutputBuffer);
+
+    using IODevice::write;
+    void write(char c) override
+    {
+        if (size >= SIZE)
+        {
+            numDroppedBytes++;
+            return;
+        }
+        buffer[(head + size) % SIZE] = c;
+        size++;
+    }
+
+    /// Does nothing, since waiting for the device is what this buffer avoids. See `drain`.
+    void flush() override {}
+
+    /// The buffer only holds output, so this always returns `false`.
+    bool read(char &) override { return false; }
+
+    /**
+     * Writes as much of the buffer to `device` as it accepts.
+     *
+     * @param[in] device Any device with a `std::size_t tryWrite(const uint8_t *, std::size_t)`
+     *      function that writes as many bytes as it can without blocking and returns the number
+     *      of bytes written.
+     * @return The number of bytes written.
+     */
+    template <typename Device>
+    std::size_t drain(Device &device)
+    {
+        std::size_t written = 0;
+        // at most two contiguous chunks, before and after the end of the buffer
+        for (int i = 0; i < 2 && size > 0; i++)
+        {
+            std::size_t chunk = (head + size <= SIZE) ? size : SIZE - head;
+            std::size_t chunkWritten = device.tryWrite(buffer + head, chunk);
+            head = (head + chunkWritten) % SIZE;
+            size -= chunkWritten;
+            written += chunkWritten;
+            if (chunkWritten < chunk)
+            {
+                break;
+            }
+        }
+        return written;
+    }
+
+    std::size_t getSize() const { return size; }
+
+    std::size_t getFreeSpace() const { return SIZE - size; }
+
+    /// @return The number of bytes dropped because the buffer was full.
+    uint32_t getNumDroppedBytes() const { return numDroppedBytes; }
+
+private:
+    uint8_t buffer[SIZE] = {};
+
+    std::size_t head = 0;
+
+    std::size_t size = 0;
+
+    uint32_t numDroppedBytes = 0;
+};  // class TerminalOutputBuffer
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_TERMINAL_OUTPUT_BUFFER_HPP_
@@ -19,27 +19,60 @@
 
 #include "terminal_serial.hpp"
 
-#include "tap/algorithms/strtok.hpp"
+#include <cstdlib>
+
+#include "tap/algorithms/token_view.hpp"
 #include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
 
 namespace tap::communication::serial
 {
 constexpr char TerminalSerial::DELIMITERS[];
+constexpr char TerminalSerial::TelemetryTerminalSerialHandler::USAGE[];
+constexpr algorithms::TokenTableEntry<TerminalSerial::TelemetryTerminalSerialHandler::Action>
+    TerminalSerial::TelemetryTerminalSerialHandler::ACTIONS[];
 
 TerminalSerial::TerminalSerial(Drivers *drivers)
     : device(drivers),
-      stream(device),
+      outputBuffer(),
+      stream(outputBuffer),
+      telemetry(outputBuffer),
+      telemetryHandler(telemetry),
       streamingTimer(STREAMING_PERIOD),
+      headers(),
       drivers(drivers)
 {
+    addHeader("telemetry", &telemetryHandler);
 }
 
 void TerminalSerial::initialize() { device.initialize(); }
 
 void TerminalSerial::update()
+{
+    // Telemetry is only sent while there is room for callback output as well, so that a
+    // saturated link can't keep commands such as "telemetry stop" from being processed.
+    if (outputBuffer.getFreeSpace() >= CALLBACK_MAX_OUTPUT + TelemetryStream::MAX_FRAME_LENGTH)
+    {
+        telemetry.update();
+    }
+
+    // Input is left in the device until the output of the previous callback has mostly been
+    // sent, rather than waiting for the device while the callback writes.
+    if (outputBuffer.getFreeSpace() >= CALLBACK_MAX_OUTPUT)
+    {
+        processInput();
+    }
+
+    outputBuffer.drain(device);
+}
+
+void TerminalSerial::processInput()
 {
     char nextC;
-    stream.get(nextC);
+    if (!device.read(nextC))
+    {
+        nextC = modm::IOStream::eof;
+    }
     if (nextC == modm::IOStream::eof)
     {
         if (currStreamer != nullptr && streamingTimer.execute())
@@ -62,27 +95,27 @@ void TerminalSerial::update()
         }
         rxBuff[currLineSize] = '\0';
 
-        char *strtokSavePtr = rxBuff;
-        char *headerStr = strtokR(strtokSavePtr, DELIMITERS, &strtokSavePtr);
+        algorithms::TokenView tokens(rxBuff);
+        const char *headerStr = tokens.next();
 
-        if (headerCallbackMap.count(headerStr) == 0)
+        if (headerStr == nullptr)
+        {
+            // the line only contained whitespace
+        }
+        else if (findHeader(headerStr) == nullptr)
         {
             stream << "Header \'" << headerStr << "\' not found" << modm::endl;
             printUsage();
         }
         else
         {
-            constexpr char STREAMING_ID[] = "-S";
-            // strlen("-S"), but strlen isn't guaranteed to be evaluated at runtime
-            constexpr int STREAMING_ID_LEN = 2;
-            if (strncmp(STREAMING_ID, strtokSavePtr, STREAMING_ID_LEN) == 0)
+            TerminalSerialCallbackInterface *callback = findHeader(headerStr)->callback;
+            if (tokens.nextIs("-S"))
             {
-                currStreamer = headerCallbackMap[headerStr];
-                strtokSavePtr += STREAMING_ID_LEN;
+                currStreamer = callback;
             }
 
-            if (!headerCallbackMap[headerStr]
-                     ->terminalSerialCallback(strtokSavePtr, stream, currStreamer != nullptr))
+            if (!callback->terminalSerialCallback(tokens.rest(), stream, currStreamer != nullptr))
             {
                 stream << "invalid arguments" << modm::endl;
                 currStreamer = nullptr;
@@ -113,11 +146,58 @@ void TerminalSerial::update()
 
 void TerminalSerial::addHeader(const char *header, TerminalSerialCallbackInterface *callback)
 {
-    if (callback == nullptr)
+    if (header == nullptr || callback == nullptr)
     {
         return;
     }
-    headerCallbackMap[header] = callback;
+
+    HeaderEntry *entry = lowerBound(header);
+    if (entry != headers + numHeaders && strcmp(entry->header, header) == 0)
+    {
+        entry->callback = callback;
+        return;
+    }
+
+    if (numHeaders >= MAX_HEADERS)
+    {
+        RAISE_ERROR(drivers, "terminal serial header table full");
+        return;
+    }
+
+    // Entries are only shifted when headers are added during initialization, which keeps
+    // lookups while running a binary search.
+    memmove(entry + 1, entry, (headers + numHeaders - entry) * sizeof(HeaderEntry));
+    *entry = {header, callback};
+    numHeaders++;
+}
+
+TerminalSerial::HeaderEntry *TerminalSerial::lowerBound(const char *header)
+{
+    int low = 0;
+    int high = numHeaders;
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (strcmp(headers[mid].header, header) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return headers + low;
+}
+
+TerminalSerial::HeaderEntry *TerminalSerial::findHeader(const char *header)
+{
+    HeaderEntry *entry = lowerBound(header);
+    if (entry == headers + numHeaders || strcmp(entry->header, header) != 0)
+    {
+        return nullptr;
+    }
+    return entry;
 }
 
 void TerminalSerial::printUsage()
@@ -126,10 +206,62 @@ void TerminalSerial::printUsage()
               "  Where\n"
               "    -S Enable streaming mode\n"
               "  and <header> is one of\n";
-    for (const auto &header : headerCallbackMap)
+    for (int i = 0; i < numHeaders; i++)
     {
-        stream << "    " << header.first << modm::endl;
+        stream << "    " << headers[i].header << modm::endl;
     }
     stream << "  and <args> is specific to <header> (query <header> -H for more help)\n";
 }
+
+bool TerminalSerial::TelemetryTerminalSerialHandler::terminalSerialCallback(
+    char *inputLine,
+    modm::IOStream &outputStream,
+    bool streamingEnabled)
+{
+    if (streamingEnabled)
+    {
+        outputStream << "telemetry: streaming mode not supported" << modm::endl << USAGE;
+        return false;
+    }
+
+    algorithms::TokenView tokens(inputLine);
+    Action action;
+    if (!tokens.nextIn(ACTIONS, action))
+    {
+        outputStream << USAGE;
+        return false;
+    }
+
+    switch (action)
+    {
+        case Action::START:
+        {
+            if (tokens.empty())
+            {
+                outputStream << "telemetry: must specify rate" << modm::endl;
+                return false;
+            }
+            int32_t rateHz;
+            if (!tokens.nextInt(rateHz) || rateHz <= 0)
+            {
+                outputStream << "telemetry: Invalid rate" << modm::endl << USAGE;
+                return false;
+            }
+            if (!telemetry.start(rateHz))
+            {
+                outputStream << "telemetry: no signals added" << modm::endl;
+                return false;
+            }
+            return true;
+        }
+        case Action::STOP:
+            telemetry.stop();
+            outputStream << "telemetry: stopped" << modm::endl;
+            return true;
+        case Action::HELP:
+            outputStream << USAGE;
+            return true;
+    }
+    return false;
+}
 }  // namespace tap::communication::serial
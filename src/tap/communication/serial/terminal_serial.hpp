@@ -21,7 +21,6 @@
 #define TAPROOT_TERMINAL_SERIAL_HPP_
 
 #include <cstring>
-#include <map>
 
 #ifdef PLATFORM_HOSTED
 #ifdef ENV_UNIT_TESTS
@@ -30,14 +29,23 @@
 #include "hosted_terminal_device.hpp"
 #endif  // ENV_UNIT_TESTS
 #else
+#include "terminal_serial_config.hpp"
+#if TERMINAL_SERIAL_USES_USB
+#include "usb_terminal_device.hpp"
+#else
 #include "uart_terminal_device.hpp"
 #endif
+#endif
 
+#include "tap/algorithms/token_view.hpp"
 #include "tap/architecture/periodic_timer.hpp"
 #include "tap/board/board.hpp"
 #include "tap/communication/serial/uart.hpp"
 #include "tap/util_macros.hpp"
 
+#include "telemetry_stream.hpp"
+#include "terminal_output_buffer.hpp"
+
 #include "modm/io.hpp"
 
 namespace tap
@@ -95,6 +103,15 @@ class TerminalSerialCallbackInterface
  *      streaming is not enabled. An example of where you would use streaming
  *      mode is if you would like to have a mode that prints out motor information
  *      constantly without having to retype a command into the terminal.
+ *
+ * @note Output written to the `outputStream` given to callbacks is buffered and sent to the
+ *      device over subsequent calls to `update`, so a callback never waits for a slow UART.
+ *      While the output buffer is more than a quarter full, input isn't processed and streaming
+ *      callbacks aren't called, so each callback may write up to `CALLBACK_MAX_OUTPUT` bytes
+ *      without any being dropped.
+ *
+ * @note The terminal also owns a binary `TelemetryStream` on the same device, which is
+ *      controlled with the "telemetry" header (see `getTelemetryStream`).
  */
 class TerminalSerial
 {
@@ -102,6 +119,12 @@ class TerminalSerial
     static constexpr char DELIMITERS[] = " \t";
     static constexpr int MAX_LINE_LENGTH = 256;
     static constexpr int STREAMING_PERIOD = 500;
+    /// The size of the buffer that output is formatted into before being sent to the device.
+    static constexpr int OUTPUT_BUFFER_SIZE = 2048;
+    /// The number of bytes each call to a callback may write without output being dropped.
+    static constexpr int CALLBACK_MAX_OUTPUT = OUTPUT_BUFFER_SIZE * 3 / 4;
+    /// The maximum number of headers that may be added.
+    static constexpr int MAX_HEADERS = 16;
 
     explicit TerminalSerial(Drivers *drivers);
 
@@ -113,10 +136,64 @@ class TerminalSerial
 
     mockable void update();
 
+    /**
+     * Adds a handler for lines starting with `header`, replacing the handler previously added
+     * with the same header. Raises an error if `MAX_HEADERS` headers have already been added.
+     *
+     * @param[in] header The header, which must remain valid for the lifetime of the terminal.
+     * @param[in] callback The handler for the header.
+     */
     mockable void addHeader(const char *header, TerminalSerialCallbackInterface *callback);
 
+    /**
+     * @return The binary telemetry stream sent over the terminal's device. Signals should be
+     *      added to it during initialization, after which streaming is started and stopped with
+     *      `telemetry start <rate_hz>` and `telemetry stop` or directly through the stream.
+     */
+    TelemetryStream &getTelemetryStream() { return telemetry; }
+
 private:
-    // Use either an IO device that interacts with UART or with stdin/stdout.
+    /**
+     * Handles the "telemetry" header, which controls the terminal's `TelemetryStream`.
+     */
+    class TelemetryTerminalSerialHandler : public TerminalSerialCallbackInterface
+    {
+    public:
+        explicit TelemetryTerminalSerialHandler(TelemetryStream &telemetry) : telemetry(telemetry)
+        {
+        }
+
+        bool terminalSerialCallback(
+            char *inputLine,
+            modm::IOStream &outputStream,
+            bool streamingEnabled) override;
+
+        void terminalSerialStreamCallback(modm::IOStream &) override {}
+
+    private:
+        static constexpr char USAGE[] =
+            "Usage: telemetry <action>\n"
+            "  Where <action> is one of:\n"
+            "    - start <rate_hz>: stream the telemetry signals in binary at the given rate\n"
+            "    - stop: stop streaming\n"
+            "  Decode the stream with tools/telemetry_decoder.py\n";
+
+        enum class Action
+        {
+            START,
+            STOP,
+            HELP,
+        };
+        static constexpr algorithms::TokenTableEntry<Action> ACTIONS[] = {
+            {"start", Action::START},
+            {"stop", Action::STOP},
+            {"-H", Action::HELP},
+        };
+
+        TelemetryStream &telemetry;
+    };  // class TelemetryTerminalSerialHandler
+
+    // Use either an IO device that interacts with UART or USB, or with stdin/stdout.
 #ifdef PLATFORM_HOSTED
 #ifdef ENV_UNIT_TESTS
 public:
@@ -126,15 +203,26 @@ class TerminalSerial
 #else
     HostedTerminalDevice device;
 #endif  // ENV_UNIT_TESTS
+#elif TERMINAL_SERIAL_USES_USB
+    UsbTerminalDevice device;
 #else
     UartTerminalDevice device;
 #endif
 
+    /**
+     * Output written to `stream` is buffered here and drained to `device` without blocking.
+     */
+    TerminalOutputBuffer<OUTPUT_BUFFER_SIZE> outputBuffer;
+
     /**
      * Hardware abstraction of a stream that provides utilities for tx/rx.
      */
     modm::IOStream stream;
 
+    TelemetryStream telemetry;
+
+    TelemetryTerminalSerialHandler telemetryHandler;
+
     /**
      * A single line is parsed into this buffer.
      */
@@ -153,19 +241,34 @@ class TerminalSerial
 
     tap::arch::PeriodicMilliTimer streamingTimer;
 
-    struct cmpByStringEquality
+    struct HeaderEntry
     {
-        bool operator()(const char *c1, const char *c2) const { return strcmp(c1, c2) < 0; }
+        const char *header;
+        TerminalSerialCallbackInterface *callback;
     };
 
-    std::map<const char *, TerminalSerialCallbackInterface *, cmpByStringEquality>
-        headerCallbackMap;
+    /**
+     * Headers added, sorted by `strcmp` so that a header is found with a binary search. Unlike a
+     * `std::map` this doesn't allocate and bounds the time spent looking up a header.
+     */
+    HeaderEntry headers[MAX_HEADERS];
+
+    int numHeaders = 0;
 
     Drivers *drivers;
 
     bool prevCharSpace = false;
 
     void printUsage();
+
+    /// Reads a character from the device and handles it, or calls the streaming callback.
+    void processInput();
+
+    /// @return The first entry whose header is not less than `header`, or one past the last entry.
+    HeaderEntry *lowerBound(const char *header);
+
+    /// @return The entry for `header`, or `nullptr` if it hasn't been added.
+    HeaderEntry *findHeader(const char *header);
 };  // class TerminalSerial
 }  // namespace tap::communication::serial
 
@@ -34,5 +34,10 @@ bool UartTerminalDevice::read(char &c)
 
 void UartTerminalDevice::write(char c) { drivers->uart.write(TERMINAL_UART_PORT, c); }
 
+std::size_t UartTerminalDevice::tryWrite(const uint8_t *data, std::size_t length)
+{
+    return drivers->uart.write(TERMINAL_UART_PORT, data, length);
+}
+
 void UartTerminalDevice::flush() { drivers->uart.flushWriteBuffer(TERMINAL_UART_PORT); }
 }  // namespace tap::communication::serial
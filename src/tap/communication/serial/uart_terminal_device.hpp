@@ -62,13 +62,20 @@ class UartTerminalDevice : public ::modm::IODevice
      */
     void write(char c) override;
 
+    /**
+     * Writes as many of the `length` bytes of `data` as fit in the UART buffer without waiting.
+     *
+     * @return The number of bytes written.
+     */
+    std::size_t tryWrite(const uint8_t *data, std::size_t length);
+
     /**
      * Flushes the UART tx buffer.
      */
     void flush() override;
 
 private:
-    static constexpr uint32_t UART_BAUDE_RATE = 115200;
+    static constexpr uint32_t UART_BAUDE_RATE = bound_ports::TERMINAL_SERIAL_BAUD_RATE;
 
     Drivers *drivers;
 
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_USB_HPP_
+#define TAPROOT_USB_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+namespace tap::communication::serial
+{
+/**
+ * Wraps the dev board's USB port as a USB device with two interfaces the host can open
+ * independently: a CDC-ACM (virtual serial port) interface for the terminal, and one for the
+ * coprocessor link, which is either a second CDC-ACM interface or a vendor bulk interface
+ * depending on the `taproot:communication:serial:usb:coprocessor_interface` lbuild option.
+ * The USB stack is TinyUSB, generated by modm.
+ *
+ * The port is full speed, so all interfaces share 12 Mbps of bus bandwidth, and the USB
+ * peripheral moves packets to and from its own memory, so there is no per-byte interrupt
+ * load. Bytes written are buffered in the interface's FIFO and sent by `update`, which also
+ * processes USB events, so call `update` every main loop.
+ *
+ * Reads and writes never wait: while the host isn't connected, reads return no bytes, and
+ * writes fill the FIFO and then return less than the number of bytes passed in.
+ *
+ * @note Only available on the RoboMaster type C board, since the type A board's 180 MHz
+ *      system clock can't be divided down to the 48 MHz the USB peripheral needs.
+ */
+class Usb
+{
+public:
+    enum class Interface : uint8_t
+    {
+        TERMINAL = 0,
+        COPROCESSOR,
+    };
+
+    Usb() = default;
+    DISALLOW_COPY_AND_ASSIGN(Usb)
+    mockable ~Usb() = default;
+
+    /// Connects the USB pins and starts the USB device stack.
+    mockable void initialize();
+
+    /// Processes USB events and sends the bytes written since the last call.
+    mockable void update();
+
+    /// @return `true` if the host has the interface open.
+    mockable bool isConnected(Interface interface) const;
+
+    /**
+     * @param[out] data Buffer to read up to `length` bytes into.
+     * @return The number of bytes read, 0 if none were received.
+     */
+    mockable std::size_t read(Interface interface, uint8_t *data, std::size_t length);
+
+    /**
+     * Writes as many of the `length` bytes of `data` as fit in the interface's FIFO.
+     *
+     * @return The number of bytes written.
+     */
+    mockable std::size_t write(Interface interface, const uint8_t *data, std::size_t length);
+
+    /// Sends the bytes written to the interface without waiting for `update`.
+    mockable void flush(Interface interface);
+};  // class Usb
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_USB_HPP_
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "usb_terminal_device.hpp"
+
+#include "tap/drivers.hpp"
+
+namespace tap::communication::serial
+{
+UsbTerminalDevice::UsbTerminalDevice(Drivers *drivers) : drivers(drivers) {}
+
+void UsbTerminalDevice::initialize() { drivers->usb.initialize(); }
+
+bool UsbTerminalDevice::read(char &c)
+{
+    return drivers->usb.read(Usb::Interface::TERMINAL, &reinterpret_cast<uint8_t &>(c), 1) == 1;
+}
+
+void UsbTerminalDevice::write(char c) { tryWrite(&reinterpret_cast<const uint8_t &>(c), 1); }
+
+std::size_t UsbTerminalDevice::tryWrite(const uint8_t *data, std::size_t length)
+{
+    return drivers->usb.write(Usb::Interface::TERMINAL, data, length);
+}
+
+void UsbTerminalDevice::flush() { drivers->usb.flush(Usb::Interface::TERMINAL); }
+}  // namespace tap::communication::serial
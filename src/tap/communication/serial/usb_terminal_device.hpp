@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_USB_TERMINAL_DEVICE_HPP_
+#define TAPROOT_USB_TERMINAL_DEVICE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iodevice.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::communication::serial
+{
+/**
+ * The `Usb` driver's terminal interface as a `modm::IODevice`, used by the terminal handler
+ * in place of `UartTerminalDevice` when the `taproot:communication:serial:terminal_serial:device`
+ * lbuild option is `usb`. Bytes written while no terminal has the port open are dropped once
+ * the interface's FIFO is full, so writing never waits.
+ */
+class UsbTerminalDevice : public ::modm::IODevice
+{
+public:
+    UsbTerminalDevice(Drivers *drivers);
+    DISALLOW_COPY_AND_ASSIGN(UsbTerminalDevice);
+    virtual ~UsbTerminalDevice() = default;
+
+    /// Initializes the `Usb` driver.
+    void initialize();
+
+    /**
+     * Reads a received byte and populates `c` with the value.
+     *
+     * @param[out] c The byte that data will be read into.
+     */
+    bool read(char &c) override;
+
+    using IODevice::write;
+    /**
+     * Writes the character `c` into the interface's FIFO.
+     *
+     * @param[out] c The byte to write to the FIFO.
+     */
+    void write(char c) override;
+
+    /**
+     * Writes as many of the `length` bytes of `data` as fit in the interface's FIFO.
+     *
+     * @return The number of bytes written.
+     */
+    std::size_t tryWrite(const uint8_t *data, std::size_t length);
+
+    /**
+     * Sends the bytes in the interface's FIFO.
+     */
+    void flush() override;
+
+private:
+    Drivers *drivers;
+};  // class UsbTerminalDevice
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_USB_TERMINAL_DEVICE_HPP_
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_USB_TRANSPORT_HPP_
+#define TAPROOT_USB_TRANSPORT_HPP_
+
+#include "tap/drivers.hpp"
+
+#include "byte_transport.hpp"
+#include "usb.hpp"
+
+namespace tap::communication::serial
+{
+/**
+ * A `ByteTransport` over an interface of the `Usb` driver, so a `DJISerial` (for example a
+ * `CoprocessorLink`) can run over USB:
+ *
+ * ```cpp
+ * UsbTransport transport(drivers, Usb::Interface::COPROCESSOR);
+ * CoprocessorLink link(drivers, &transport);
+ * ```
+ *
+ * `Usb::initialize` and `Usb::update` must be called separately, since the interfaces share
+ * the driver.
+ */
+class UsbTransport : public ByteTransport
+{
+public:
+    UsbTransport(Drivers *drivers, Usb::Interface interface)
+        : drivers(drivers),
+          interface(interface)
+    {
+    }
+    DISALLOW_COPY_AND_ASSIGN(UsbTransport)
+
+    std::size_t read(uint8_t *data, std::size_t length) override
+    {
+        return drivers->usb.read(interface, data, length);
+    }
+
+    std::size_t write(const uint8_t *data, std::size_t length) override
+    {
+        return drivers->usb.write(interface, data, length);
+    }
+
+private:
+    Drivers *drivers;
+    const Usb::Interface interface;
+};  // class UsbTransport
+}  // namespace tap::communication::serial
+
+#endif  // TAPROOT_USB_TRANSPORT_HPP_
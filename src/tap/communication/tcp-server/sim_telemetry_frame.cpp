@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "sim_telemetry_frame.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/sensors/imu/imu_interface.hpp"
+#include "tap/communication/serial/ref_serial.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+#include "json_messages.hpp"
+#include "tcp_server.hpp"
+
+using tap::arch::convertToLittleEndian;
+
+namespace tap
+{
+namespace communication
+{
+void SimTelemetryFrame::begin(uint32_t time)
+{
+    numRecords = 0;
+    if (format == Format::JSON)
+    {
+        size = 0;
+        return;
+    }
+
+    size = HEADER_SIZE;
+    convertToLittleEndian<uint32_t>(HEADER_SIZE - sizeof(uint32_t), buffer);
+    convertToLittleEndian(SCHEMA_VERSION, buffer + 4);
+    convertToLittleEndian(time, buffer + 6);
+    convertToLittleEndian(numRecords, buffer + 10);
+}
+
+bool SimTelemetryFrame::addMotor(const motor::DjiMotor &motor)
+{
+    if (format == Format::JSON)
+    {
+        return appendJson("%s", json::makeMotorMessage(motor).c_str());
+    }
+
+    uint8_t *payload = beginRecord(RecordType::MOTOR, MOTOR_PAYLOAD_SIZE);
+    if (payload == nullptr)
+    {
+        return false;
+    }
+    payload[0] = static_cast<int>(motor.getCanBus()) + 1;
+    convertToLittleEndian<uint16_t>(motor.getMotorIdentifier(), payload + 1);
+    convertToLittleEndian(motor.getShaftRPM(), payload + 3);
+    convertToLittleEndian(motor.getTorque(), payload + 5);
+    convertToLittleEndian(motor.getEncoderUnwrapped(), payload + 7);
+    return true;
+}
+
+bool SimTelemetryFrame::addImu(sensors::imu::ImuInterface &imu)
+{
+    const float values[] = {
+        imu.getAx(),
+        imu.getAy(),
+        imu.getAz(),
+        imu.getGx(),
+        imu.getGy(),
+        imu.getGz(),
+        imu.getRoll(),
+        imu.getPitch(),
+        imu.getYaw(),
+    };
+
+    if (format == Format::JSON)
+    {
+        return appendJson(
+            "{\"messageType\":\"imu\",\"ax\":%g,\"ay\":%g,\"az\":%g,\"gx\":%g,\"gy\":%g,"
+            "\"gz\":%g,\"roll\":%g,\"pitch\":%g,\"yaw\":%g}",
+            values[0],
+            values[1],
+            values[2],
+            values[3],
+            values[4],
+            values[5],
+            values[6],
+            values[7],
+            values[8]);
+    }
+
+    uint8_t *payload = beginRecord(RecordType::IMU, IMU_PAYLOAD_SIZE);
+    if (payload == nullptr)
+    {
+        return false;
+    }
+    for (float value : values)
+    {
+        convertToLittleEndian(value, payload);
+        payload += sizeof(value);
+    }
+    return true;
+}
+
+bool SimTelemetryFrame::addRefSerial(const serial::RefSerial &refSerial)
+{
+    const serial::RefSerial::Rx::RobotData &robotData = refSerial.getRobotData();
+    const int gameStage = static_cast<int>(refSerial.getGameData().gameStage);
+    const bool receiving = refSerial.getRefSerialReceivingData();
+
+    if (format == Format::JSON)
+    {
+        return appendJson(
+            "{\"messageType\":\"refSerial\",\"robotID\":%d,\"currentHP\":%d,\"maxHP\":%d,"
+            "\"gameStage\":%d,\"receiving\":%d}",
+            static_cast<int>(robotData.robotId),
+            robotData.currentHp,
+            robotData.maxHp,
+            gameStage,
+            receiving);
+    }
+
+    uint8_t *payload = beginRecord(RecordType::REF_SERIAL, REF_SERIAL_PAYLOAD_SIZE);
+    if (payload == nullptr)
+    {
+        return false;
+    }
+    convertToLittleEndian(static_cast<uint16_t>(robotData.robotId), payload);
+    convertToLittleEndian(robotData.currentHp, payload + 2);
+    convertToLittleEndian(robotData.maxHp, payload + 4);
+    payload[6] = gameStage;
+    payload[7] = receiving;
+    return true;
+}
+
+void SimTelemetryFrame::send(TCPServer &server) const
+{
+    server.writeToClient(reinterpret_cast<const char *>(buffer), size);
+}
+
+uint8_t *SimTelemetryFrame::beginRecord(RecordType type, std::size_t payloadSize)
+{
+    if (size + 2 + payloadSize > MAX_FRAME_SIZE)
+    {
+        return nullptr;
+    }
+
+    uint8_t *record = buffer + size;
+    record[0] = static_cast<uint8_t>(type);
+    record[1] = payloadSize;
+    size += 2 + payloadSize;
+    numRecords++;
+
+    convertToLittleEndian<uint32_t>(size - sizeof(uint32_t), buffer);
+    convertToLittleEndian(numRecords, buffer + 10);
+    return record + 2;
+}
+
+bool SimTelemetryFrame::appendJson(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    // Leave room for the newline
+    int length = vsnprintf(
+        reinterpret_cast<char *>(buffer + size),
+        MAX_FRAME_SIZE - size - 1,
+        fmt,
+        args);
+    va_end(args);
+
+    if (length < 0 || size + length + 1 >= MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+    size += length;
+    buffer[size++] = '\n';
+    numRecords++;
+    return true;
+}
+}  // namespace communication
+}  // namespace tap
+
+#endif  // PLATFORM_HOSTED
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SIM_TELEMETRY_FRAME_HPP_
+#define TAPROOT_SIM_TELEMETRY_FRAME_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tap
+{
+namespace motor
+{
+class DjiMotor;
+}
+
+namespace communication
+{
+namespace sensors::imu
+{
+class ImuInterface;
+}
+
+namespace serial
+{
+class RefSerial;
+}
+
+class TCPServer;
+
+/**
+ * Batches the state of the simulated robot for one tick into a single frame, which is sent to the
+ * simulator with a single write. This replaces formatting a JSON string (see
+ * `json::makeMotorMessage`) and writing it for every motor.
+ *
+ * In `Format::BINARY` the frame is little-endian and made of a header:
+ * - `uint32_t` length of the frame after this field, in bytes
+ * - `uint16_t` schema version, `SCHEMA_VERSION`
+ * - `uint32_t` time of the tick, in milliseconds
+ * - `uint16_t` number of records
+ *
+ * followed by the records. Each record is a `RecordType` byte, a byte holding the length of the
+ * payload and the payload, so a reader can skip records of types it doesn't know. Fields may be
+ * appended to a payload without changing `SCHEMA_VERSION`, any other change increments it.
+ * - `MOTOR`: `uint8_t` CAN bus (1 or 2), `uint16_t` motor identifier, `int16_t` shaft RPM,
+ *   `int16_t` torque, `int64_t` unwrapped encoder value
+ * - `IMU`: `float` ax, ay, az, gx, gy, gz, roll, pitch, yaw
+ * - `REF_SERIAL`: `uint16_t` robot ID, `uint16_t` current HP, `uint16_t` max HP, `uint8_t` game
+ *   stage, `uint8_t` 1 if receiving data from the referee system
+ *
+ * In `Format::JSON`, meant for debugging, the frame is instead the JSON object of each record,
+ * one per line, the same as `json::makeMotorMessage` for motors.
+ */
+class SimTelemetryFrame
+{
+public:
+    enum class Format
+    {
+        BINARY,
+        JSON,
+    };
+
+    enum class RecordType : uint8_t
+    {
+        MOTOR = 1,
+        IMU = 2,
+        REF_SERIAL = 3,
+    };
+
+    static constexpr uint16_t SCHEMA_VERSION = 1;
+    static constexpr std::size_t HEADER_SIZE = 12;
+    static constexpr std::size_t MOTOR_PAYLOAD_SIZE = 15;
+    static constexpr std::size_t IMU_PAYLOAD_SIZE = 36;
+    static constexpr std::size_t REF_SERIAL_PAYLOAD_SIZE = 8;
+    /// Fits 16 motors, an IMU and the referee system in either format.
+    static constexpr std::size_t MAX_FRAME_SIZE = 4096;
+
+    explicit SimTelemetryFrame(Format format = Format::BINARY) : format(format) {}
+
+    /// Empties the frame and starts one for the tick at `time`.
+    void begin(uint32_t time);
+
+    /// Each `add` function appends a record, returning `false` if the frame is full.
+    bool addMotor(const motor::DjiMotor &motor);
+    bool addImu(sensors::imu::ImuInterface &imu);
+    bool addRefSerial(const serial::RefSerial &refSerial);
+
+    const uint8_t *getData() const { return buffer; }
+
+    std::size_t getSize() const { return size; }
+
+    int getNumRecords() const { return numRecords; }
+
+    /// Sends the frame to the client connected to `server` with a single write.
+    void send(TCPServer &server) const;
+
+private:
+    Format format;
+    uint8_t buffer[MAX_FRAME_SIZE];
+    std::size_t size = 0;
+    uint16_t numRecords = 0;
+
+    /**
+     * Appends the type and length of a binary record and updates the header.
+     *
+     * @return Where the payload goes, or `nullptr` if the record doesn't fit.
+     */
+    uint8_t *beginRecord(RecordType type, std::size_t payloadSize);
+
+    /// Appends a line of JSON formatted like `printf`. @return `false` if it doesn't fit.
+    bool appendJson(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+}  // namespace communication
+}  // namespace tap
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_SIM_TELEMETRY_FRAME_HPP_
@@ -23,14 +23,17 @@
 
 #ifdef __linux__
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif  // __linux__
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <stdexcept>
@@ -47,25 +50,18 @@ namespace communication
 {
 /**
  * TCPServer constructor. Runs a server on the given portnumber.
- * Also takes a function pointer. This function is left to the implementer
- * of a specific TCP server to define (it should take an int16_t parameter
- * for client file descriptor). Ideally mainLoop should use a non-blocking
- * loop as currently since threads detach its possible that if a client never
- * responds there could be threads that never close.
  */
-
 TCPServer::TCPServer(int targetPortNumber)
 #ifdef __linux__
     : socketOpened(false),
-      clientConnected(false),
-      mainClientDescriptor(-1),
+      epollFileDescriptor(-1),
       serverAddress(),
       portNumber(-1)
 #endif  // __linux__
 {
 #ifdef __linux__
     // Do sockety stuff.
-    listenFileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    listenFileDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (listenFileDescriptor < 0)
     {
         perror("TCPServer failed to open socket");
@@ -104,8 +100,20 @@ TCPServer::TCPServer(int targetPortNumber)
     portNumber = targetPortNumber;
 
     listen(listenFileDescriptor, LISTEN_QUEUE_SIZE);
+
+    epollFileDescriptor = epoll_create1(0);
+    if (epollFileDescriptor < 0)
+    {
+        perror("TCPServer failed to create epoll instance");
+        throw std::runtime_error("EpollError");
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;  // Events of clients point to the client
+    epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, listenFileDescriptor, &event);
+
     std::cout << "TCPServer initialized on port: " << targetPortNumber << std::endl;
-    std::cout << "call getConnection() to accept client" << std::endl;
+    std::cout << "call update() to accept clients" << std::endl;
 #else
     UNUSED(targetPortNumber);
 #endif  // __linux__
@@ -113,14 +121,29 @@ TCPServer::TCPServer(int targetPortNumber)
 
 TCPServer::~TCPServer()
 {
+    if (activeServer == this)
+    {
+        activeServer = nullptr;
+    }
 #ifdef __linux__
+    for (Client& client : clients)
+    {
+        if (client.fd >= 0)
+        {
+            close(client.fd);
+        }
+    }
+    close(epollFileDescriptor);
     close(listenFileDescriptor);
-    close(mainClientDescriptor);
 #endif  // __linux__
 }
 
 TCPServer* TCPServer::MainServer()
 {
+    if (activeServer != nullptr)
+    {
+        return activeServer;
+    }
 #if defined(ENV_UNIT_TESTS) || !defined(__linux__)
     return nullptr;
 #else
@@ -131,23 +154,30 @@ TCPServer* TCPServer::MainServer()
 void TCPServer::getConnection()
 {
 #ifdef __linux__
-    sockaddr_in clientAddress;
-    socklen_t clientAddressLength = sizeof(clientAddress);
-    mainClientDescriptor = accept(
-        listenFileDescriptor,
-        reinterpret_cast<sockaddr*>(&clientAddress),
-        &clientAddressLength);
-    cerr << "TCPServer: connection accepted" << std::endl;
+    pollfd listenPoll = {listenFileDescriptor, POLLIN, 0};
+    while (acceptClients() == 0)
+    {
+        poll(&listenPoll, 1, -1);
+    }
 #endif  // __linux__
 }
 
 void TCPServer::closeConnection()
 {
 #ifdef __linux__
-    close(mainClientDescriptor);
-    mainClientDescriptor = -1;
-    std::cout << "TCPServer: closed connection with client, "
-                 "use getConnection() to connect to a new one";
+    for (Client& client : clients)
+    {
+        if (client.fd >= 0)
+        {
+            flush(client);
+        }
+        if (client.fd >= 0)
+        {
+            closeClient(client);
+        }
+    }
+    std::cout << "TCPServer: closed connection with clients, "
+                 "use update() to accept new ones";
 #endif  // __linux__
 }
 
@@ -163,26 +193,64 @@ uint16_t TCPServer::getPortNumber()
 #endif  // __linux__
 }
 
-/**
- * Writes "messageLength" bytes of "message" to the mainClient
- */
 void TCPServer::writeToClient(const char* message, int32_t messageLength)
 {
 #ifdef __linux__
-    if (mainClientDescriptor < 0)
+    if (messageLength <= 0)
     {
-        // Not necessarily an error if fileDescriptor still hasn't been opened
-        // so we just don't write to anything and early return.
-        cerr << "TCPServer: mainClientDescriptor not connected yet" << std::endl;
         return;
     }
-    try
-    {
-        writeMessage(mainClientDescriptor, message, messageLength);
-    }
-    catch (std::runtime_error& e)
+    const std::size_t length = messageLength;
+
+    for (Client& client : clients)
     {
-        std::cerr << e.what() << std::endl;
+        if (client.fd < 0)
+        {
+            continue;
+        }
+
+        std::size_t sent = 0;
+        if (client.queueSize == 0)
+        {
+            // Nothing is queued, so the message can go straight to the socket
+            ssize_t n = send(client.fd, message, length, MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                closeClient(client);
+                continue;
+            }
+            sent = std::max<ssize_t>(n, 0);
+        }
+
+        const std::size_t remaining = length - sent;
+        if (remaining == 0)
+        {
+            continue;
+        }
+        if (sent == 0 && client.queueSize + remaining > SEND_QUEUE_SIZE)
+        {
+            numDroppedMessages++;
+            continue;
+        }
+        if (client.queueSize + remaining > SEND_QUEUE_SIZE)
+        {
+            // Part of the message was sent, the rest must follow or the stream is corrupted.
+            // The client is too slow to keep up anyway.
+            numDroppedMessages++;
+            closeClient(client);
+            continue;
+        }
+
+        const bool wasEmpty = client.queueSize == 0;
+        const std::size_t queueEnd = (client.queueStart + client.queueSize) % SEND_QUEUE_SIZE;
+        const std::size_t untilWrap = std::min(remaining, SEND_QUEUE_SIZE - queueEnd);
+        memcpy(client.queue + queueEnd, message + sent, untilWrap);
+        memcpy(client.queue, message + sent + untilWrap, remaining - untilWrap);
+        client.queueSize += remaining;
+        if (wasEmpty)
+        {
+            setWaitForWritable(client, true);
+        }
     }
 #else
     UNUSED(message);
@@ -190,6 +258,147 @@ void TCPServer::writeToClient(const char* message, int32_t messageLength)
 #endif  // __linux__
 }
 
+void TCPServer::update(int timeoutMs)
+{
+#ifdef __linux__
+    epoll_event events[MAX_CLIENTS + 1];
+    int numEvents = epoll_wait(epollFileDescriptor, events, MAX_CLIENTS + 1, timeoutMs);
+    for (int i = 0; i < numEvents; i++)
+    {
+        Client* client = static_cast<Client*>(events[i].data.ptr);
+        if (client == nullptr)
+        {
+            acceptClients();
+            continue;
+        }
+        if (client->fd >= 0 && (events[i].events & EPOLLOUT))
+        {
+            flush(*client);
+        }
+        if (client->fd >= 0 && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+        {
+            drain(*client);
+        }
+    }
+#else
+    UNUSED(timeoutMs);
+#endif  // __linux__
+}
+
+int TCPServer::getNumClients() const
+{
+#ifdef __linux__
+    return std::count_if(
+        std::begin(clients),
+        std::end(clients),
+        [](const Client& client) { return client.fd >= 0; });
+#else
+    return 0;
+#endif  // __linux__
+}
+
+#ifdef __linux__
+int TCPServer::acceptClients()
+{
+    int accepted = 0;
+    while (true)
+    {
+        sockaddr_in clientAddress;
+        socklen_t clientAddressLength = sizeof(clientAddress);
+        int fd = accept4(
+            listenFileDescriptor,
+            reinterpret_cast<sockaddr*>(&clientAddress),
+            &clientAddressLength,
+            SOCK_NONBLOCK);
+        if (fd < 0)
+        {
+            return accepted;
+        }
+
+        Client* client = std::find_if(
+            std::begin(clients),
+            std::end(clients),
+            [](const Client& client) { return client.fd < 0; });
+        if (client == std::end(clients))
+        {
+            cerr << "TCPServer: too many clients, connection refused" << std::endl;
+            close(fd);
+            continue;
+        }
+
+        client->fd = fd;
+        client->queueStart = 0;
+        client->queueSize = 0;
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.ptr = client;
+        epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, fd, &event);
+        cerr << "TCPServer: connection accepted" << std::endl;
+        accepted++;
+    }
+}
+
+void TCPServer::flush(Client& client)
+{
+    while (client.queueSize > 0)
+    {
+        // Send the queued bytes up to the end of the ring buffer
+        std::size_t contiguous = std::min(client.queueSize, SEND_QUEUE_SIZE - client.queueStart);
+        ssize_t n = send(client.fd, client.queue + client.queueStart, contiguous, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                closeClient(client);
+            }
+            return;
+        }
+        client.queueStart = (client.queueStart + n) % SEND_QUEUE_SIZE;
+        client.queueSize -= n;
+    }
+    setWaitForWritable(client, false);
+}
+
+void TCPServer::drain(Client& client)
+{
+    char buffer[256];
+    while (true)
+    {
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            closeClient(client);
+            return;
+        }
+        if (n < 0)
+        {
+            return;
+        }
+    }
+}
+
+void TCPServer::closeClient(Client& client)
+{
+    epoll_ctl(epollFileDescriptor, EPOLL_CTL_DEL, client.fd, nullptr);
+    close(client.fd);
+    client.fd = -1;
+    client.queueSize = 0;
+    cerr << "TCPServer: connection closed" << std::endl;
+}
+
+void TCPServer::setWaitForWritable(Client& client, bool wait)
+{
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    if (wait)
+    {
+        event.events |= EPOLLOUT;
+    }
+    event.data.ptr = &client;
+    epoll_ctl(epollFileDescriptor, EPOLL_CTL_MOD, client.fd, &event);
+}
+#endif  // __linux__
+
 #ifdef __linux__
 void readMessage(int16_t fileDescriptor, char* readBuffer, uint16_t messageLength)
 {
@@ -257,6 +466,8 @@ int32_t readInt32(int16_t fileDescriptor)
 }
 #endif  // __linux__
 
+TCPServer* TCPServer::activeServer = nullptr;
+
 // Only construct static singleton in actual sim, not in unit tests.
 #ifndef ENV_UNIT_TESTS
 // Definition of static variable. mainServer never created otherwise.
@@ -27,6 +27,7 @@
 #endif
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace tap
@@ -36,17 +37,20 @@ namespace communication
 /**
  * TCPServer is an singleton class for running a TCPServer using a user
  * defined messaging protocol.
+ *
+ * The server publishes to up to `MAX_CLIENTS` clients at once (e.g. a visualizer, a logger and
+ * a test harness) and never blocks the simulated control loop: its sockets are non-blocking,
+ * and `update`, which should be called every iteration of the main loop, accepts new clients,
+ * sends queued data and closes the connections of clients that disconnected. Each client has a
+ * bounded send queue, so a client that doesn't read fast enough only loses messages itself.
+ * Data received from clients is discarded.
  */
 class TCPServer
 {
-// Make constructor and destructor public if in unit tests environment.
-#ifdef ENV_UNIT_TESTS
 public:
-#endif
     /**
-     * Post: Creates a new TCPServer and binds to the first avaiable port
-     * in the range [portnumber, portnumber+1000]. If it cannot succesfully
-     * bind to any of these ports, throws a std::runtime_error.
+     * Post: Creates a new TCPServer and binds to the port portnumber. If it
+     * cannot succesfully bind to the port, throws a std::runtime_error.
      */
     TCPServer(int portnumber);
 
@@ -55,25 +59,35 @@ class TCPServer
      */
     ~TCPServer();
 
-public:
     /* PortNumber which the server will try to open on. This seems finicky
      * as it's possible that port is in use, but I don't know how to do
      * better (Tenzin)*/
     static const int16_t PORT_NUMBER = 8888;
     static const uint8_t LISTEN_QUEUE_SIZE = 5;  // 5 is max on most systems
+    static constexpr int MAX_CLIENTS = 8;
+    /// Bytes queued for each client that its socket hasn't accepted yet.
+    static constexpr std::size_t SEND_QUEUE_SIZE = 1 << 16;
 
     /**
-     * Return a const reference to the singleton static instance of this class.
+     * Return the active server (see `setActive`), or the singleton static instance of this class
+     * if none is active.
      */
     static TCPServer* MainServer();
 
     /**
-     * Accepts a new connection and stores the file descriptor in mainClientDescriptor
+     * Makes `server` the server returned by `MainServer`, for example to give each robot in a
+     * multi-robot simulation its own server on its own port (see `CommandScheduler::Registry`).
+     * If `nullptr`, `MainServer` returns the singleton again.
+     */
+    static void setActive(TCPServer* server) { activeServer = server; }
+
+    /**
+     * Blocks until a new client connects. `update` accepts clients without blocking.
      */
     void getConnection();
 
     /**
-     * Closes mainClientFile descriptor and then sets its value to -1.
+     * Closes the connection with every client, after trying once to send what is queued for it.
      */
     void closeConnection();
 
@@ -83,23 +97,68 @@ class TCPServer
     uint16_t getPortNumber();
 
     /**
-     * Writes the null-terminated message "message" to the connected TCP client
-     * if there is one.
+     * Sends "messageLength" bytes of "message" to every connected client without blocking. What
+     * a client's socket doesn't accept right away is queued and sent by `update`. If a message
+     * doesn't fit in a client's queue it isn't sent to that client at all, so that clients
+     * never receive part of a message.
      */
     void writeToClient(const char* message, int32_t messageLength);
 
+    /**
+     * Accepts new clients, sends queued data and closes the connections of clients that
+     * disconnected.
+     *
+     * @param[in] timeoutMs The longest time to wait for any of these to happen, in
+     *      milliseconds. If 0, returns immediately.
+     */
+    void update(int timeoutMs = 0);
+
+    /// @return The number of connected clients.
+    int getNumClients() const;
+
+    /// @return The number of messages not sent to some client because its queue was full.
+    uint32_t getNumDroppedMessages() const { return numDroppedMessages; }
+
 private:
 #ifdef __linux__
+    struct Client
+    {
+        int fd = -1;
+        /// Ring buffer of bytes waiting to be sent.
+        uint8_t queue[SEND_QUEUE_SIZE];
+        std::size_t queueStart = 0;
+        std::size_t queueSize = 0;
+    };
+
     bool socketOpened;
-    bool clientConnected;
     int16_t listenFileDescriptor;  // File descriptor which server gets connection requests
-    int16_t mainClientDescriptor;  // File Descriptor which we communciate with
+    int epollFileDescriptor;
+    Client clients[MAX_CLIENTS];
     sockaddr_in serverAddress;
     int16_t portNumber;  // portNumber the server is bound to
-#endif                   // __linux__
+
+    /// Accepts every pending connection. @return The number of clients accepted.
+    int acceptClients();
+
+    /// Sends as much of the client's queue as its socket accepts. Closes it on error.
+    void flush(Client& client);
+
+    /// Reads and discards what the client sent, closing it if it disconnected.
+    void drain(Client& client);
+
+    void closeClient(Client& client);
+
+    /// Sets whether epoll waits for the client's socket to be writable.
+    void setWaitForWritable(Client& client, bool wait);
+#endif  // __linux__
+
+    uint32_t numDroppedMessages = 0;
 
     // Singleton server.
     static TCPServer mainServer;
+
+    /// See `setActive`.
+    static TCPServer* activeServer;
 };  // TCPServer
 
 #ifdef __linux__
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CHASSIS_KINEMATICS_HPP_
+#define TAPROOT_CHASSIS_KINEMATICS_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+#include "tap/algorithms/cmsis_mat.hpp"
+#include "tap/algorithms/odometry/chassis_displacement_observer_interface.hpp"
+
+#include "modm/math/geometry/vector3.hpp"
+
+namespace tap::control::chassis
+{
+/**
+ * Kinematics of a chassis whose wheel speeds are a linear function of the chassis velocity, such
+ * as a mecanum, omni or differential chassis. Build one with `mecanumKinematics`,
+ * `omniKinematics` or `differentialKinematics`, or from the matrix of any other such chassis.
+ *
+ * Chassis velocities are <vx, vy, wz> in the chassis frame, x forward, y left and z up, in m/s
+ * and rad/s, and wheel speeds are in rad/s, positive when the wheel drives its side of the chassis
+ * forward (or counterclockwise, for omni wheels). Both matrices are computed once on construction,
+ * so converting a velocity is a single `WHEELS` by 3 matrix multiply, and all wheels are solved
+ * together.
+ *
+ * @tparam WHEELS The number of wheels.
+ */
+template <uint16_t WHEELS>
+class LinearChassisKinematics
+{
+public:
+    /**
+     * @param[in] inverse The `WHEELS` by 3 matrix, row major, that maps a chassis velocity to
+     *      wheel speeds.
+     * @param[in] forward The 3 by `WHEELS` matrix, row major, that maps wheel speeds to the
+     *      chassis velocity, usually the pseudo-inverse of `inverse`.
+     */
+    LinearChassisKinematics(
+        const float (&inverse)[WHEELS * 3],
+        const float (&forward)[3 * WHEELS])
+        : inverse(inverse),
+          forward(forward)
+    {
+    }
+
+    /**
+     * Constructs the kinematics of a chassis from its inverse kinematics alone, computing the
+     * forward kinematics as the least squares pseudo-inverse. `inverse` must have full column
+     * rank, which any chassis that can move in x, y, and rotate has.
+     */
+    explicit LinearChassisKinematics(const float (&inverse)[WHEELS * 3])
+        : inverse(inverse),
+          forward((this->inverse.transpose() * this->inverse).inverse() * this->inverse.transpose())
+    {
+    }
+
+    /// Computes the wheel speeds that drive the chassis at `chassisVelocity`.
+    void toWheelSpeeds(
+        const algorithms::CMSISMat<3, 1> &chassisVelocity,
+        algorithms::CMSISMat<WHEELS, 1> &wheelSpeeds) const
+    {
+        algorithms::multiply(inverse, chassisVelocity, wheelSpeeds);
+    }
+
+    /**
+     * Computes the wheel speeds that drive the chassis at `chassisVelocity`, scaled down so none
+     * is faster than `maxWheelSpeed`. Rotation is kept over translation: the translation is
+     * scaled down as little as possible to fit the wheel speed, and only if rotating alone is too
+     * fast is the rotation scaled down too, so a spinning chassis keeps spinning at the requested
+     * rate while it translates.
+     *
+     * @return The factor the translation was scaled by, from 0 to 1.
+     */
+    float toWheelSpeedsDesaturated(
+        const algorithms::CMSISMat<3, 1> &chassisVelocity,
+        float maxWheelSpeed,
+        algorithms::CMSISMat<WHEELS, 1> &wheelSpeeds) const
+    {
+        const float vx = chassisVelocity.data[0];
+        const float vy = chassisVelocity.data[1];
+        const float wz = chassisVelocity.data[2];
+
+        float translation[WHEELS];
+        float rotation[WHEELS];
+        float maxRotation = 0;
+        for (uint16_t i = 0; i < WHEELS; i++)
+        {
+            translation[i] = inverse.data[i * 3] * vx + inverse.data[i * 3 + 1] * vy;
+            rotation[i] = inverse.data[i * 3 + 2] * wz;
+            maxRotation = fmaxf(maxRotation, fabsf(rotation[i]));
+        }
+
+        float rotationScale = 1;
+        if (maxRotation > maxWheelSpeed)
+        {
+            rotationScale = maxWheelSpeed / maxRotation;
+        }
+
+        // The largest scale s of the translation such that |s * t + r| <= max for every wheel
+        float translationScale = 1;
+        for (uint16_t i = 0; i < WHEELS; i++)
+        {
+            const float t = translation[i];
+            const float r = rotation[i] * rotationScale;
+            if (t > 0 && t + r > maxWheelSpeed)
+            {
+                translationScale = fminf(translationScale, (maxWheelSpeed - r) / t);
+            }
+            else if (t < 0 && t + r < -maxWheelSpeed)
+            {
+                translationScale = fminf(translationScale, (maxWheelSpeed + r) / -t);
+            }
+        }
+        translationScale = fmaxf(translationScale, 0);
+
+        for (uint16_t i = 0; i < WHEELS; i++)
+        {
+            wheelSpeeds.data[i] = translationScale * translation[i] + rotationScale * rotation[i];
+        }
+        return translationScale;
+    }
+
+    /// Computes the chassis velocity from measured wheel speeds, in the least squares sense.
+    void toChassisVelocity(
+        const algorithms::CMSISMat<WHEELS, 1> &wheelSpeeds,
+        algorithms::CMSISMat<3, 1> &chassisVelocity) const
+    {
+        algorithms::multiply(forward, wheelSpeeds, chassisVelocity);
+    }
+
+    const algorithms::CMSISMat<WHEELS, 3> &getInverseMatrix() const { return inverse; }
+
+    const algorithms::CMSISMat<3, WHEELS> &getForwardMatrix() const { return forward; }
+
+private:
+    algorithms::CMSISMat<WHEELS, 3> inverse;
+    algorithms::CMSISMat<3, WHEELS> forward;
+};  // class LinearChassisKinematics
+
+/**
+ * Scales all wheel speeds by the same factor so none is faster than `maxWheelSpeed`, which keeps
+ * the direction the chassis moves in.
+ *
+ * @return The factor the wheel speeds were scaled by, from 0 to 1.
+ */
+template <uint16_t WHEELS>
+float desaturate(algorithms::CMSISMat<WHEELS, 1> &wheelSpeeds, float maxWheelSpeed)
+{
+    float maxSpeed = 0;
+    for (uint16_t i = 0; i < WHEELS; i++)
+    {
+        maxSpeed = fmaxf(maxSpeed, fabsf(wheelSpeeds.data[i]));
+    }
+    if (maxSpeed <= maxWheelSpeed)
+    {
+        return 1;
+    }
+    const float scale = maxWheelSpeed / maxSpeed;
+    for (uint16_t i = 0; i < WHEELS; i++)
+    {
+        wheelSpeeds.data[i] *= scale;
+    }
+    return scale;
+}
+
+/**
+ * The kinematics of a mecanum chassis with rollers in an X when seen from above, with wheels in
+ * the order front left, front right, back left, back right.
+ *
+ * @param[in] wheelRadius The radius of the wheels, in m.
+ * @param[in] halfWheelbase Half of the distance between the front and back wheels, in m.
+ * @param[in] halfTrack Half of the distance between the left and right wheels, in m.
+ */
+inline LinearChassisKinematics<4> mecanumKinematics(
+    float wheelRadius,
+    float halfWheelbase,
+    float halfTrack)
+{
+    const float r = wheelRadius;
+    const float l = halfWheelbase + halfTrack;
+    // clang-format off
+    const float inverse[4 * 3] = {
+        1 / r, -1 / r, -l / r,
+        1 / r,  1 / r,  l / r,
+        1 / r,  1 / r, -l / r,
+        1 / r, -1 / r,  l / r,
+    };
+    const float forward[3 * 4] = {
+         r / 4,        r / 4,       r / 4,        r / 4,
+        -r / 4,        r / 4,       r / 4,       -r / 4,
+        -r / (4 * l),  r / (4 * l), -r / (4 * l),  r / (4 * l),
+    };
+    // clang-format on
+    return LinearChassisKinematics<4>(inverse, forward);
+}
+
+/**
+ * The kinematics of an omni chassis whose wheels are all `chassisRadius` from its center, each
+ * driving perpendicular to the line from the center to it.
+ *
+ * @param[in] wheelRadius The radius of the wheels, in m.
+ * @param[in] chassisRadius The distance from the center of the chassis to the wheels, in m.
+ * @param[in] wheelAngles The angle of each wheel counterclockwise from the x axis, in radians,
+ *      for example pi / 4, 3 * pi / 4, -3 * pi / 4, -pi / 4 for four wheels at the corners.
+ */
+template <uint16_t WHEELS>
+LinearChassisKinematics<WHEELS> omniKinematics(
+    float wheelRadius,
+    float chassisRadius,
+    const float (&wheelAngles)[WHEELS])
+{
+    static_assert(WHEELS >= 3, "An omni chassis needs at least 3 wheels");
+    float inverse[WHEELS * 3];
+    for (uint16_t i = 0; i < WHEELS; i++)
+    {
+        inverse[i * 3] = -sinf(wheelAngles[i]) / wheelRadius;
+        inverse[i * 3 + 1] = cosf(wheelAngles[i]) / wheelRadius;
+        inverse[i * 3 + 2] = chassisRadius / wheelRadius;
+    }
+    return LinearChassisKinematics<WHEELS>(inverse);
+}
+
+/**
+ * The kinematics of a differential (tank) chassis, with wheels in the order left, right. The
+ * chassis can't move in y, so vy is ignored and always computed as 0.
+ *
+ * @param[in] wheelRadius The radius of the wheels, in m.
+ * @param[in] halfTrack Half of the distance between the left and right wheels, in m.
+ */
+inline LinearChassisKinematics<2> differentialKinematics(float wheelRadius, float halfTrack)
+{
+    const float r = wheelRadius;
+    const float l = halfTrack;
+    // clang-format off
+    const float inverse[2 * 3] = {
+        1 / r, 0, -l / r,
+        1 / r, 0,  l / r,
+    };
+    const float forward[3 * 2] = {
+         r / 2,       r / 2,
+         0,           0,
+        -r / (2 * l), r / (2 * l),
+    };
+    // clang-format on
+    return LinearChassisKinematics<2>(inverse, forward);
+}
+
+/**
+ * Kinematics of a swerve chassis, whose modules each steer to an angle and drive at a speed.
+ *
+ * The velocity of every module's contact point is computed by a single 2 * `MODULES` by 3 matrix
+ * multiply, and then converted to an angle and a speed. Chassis velocities are as in
+ * `LinearChassisKinematics`, angles are counterclockwise from the chassis x axis, in radians,
+ * and speeds are wheel speeds in rad/s.
+ *
+ * @tparam MODULES The number of swerve modules.
+ */
+template <uint16_t MODULES>
+class SwerveKinematics
+{
+public:
+    /// The angle and speed of a module.
+    struct ModuleState
+    {
+        float angle = 0;
+        float speed = 0;
+    };
+
+    /**
+     * @param[in] wheelRadius The radius of the wheels, in m.
+     * @param[in] positions The x and y position of each module relative to the center of the
+     *      chassis, in m.
+     */
+    SwerveKinematics(float wheelRadius, const float (&positions)[MODULES][2])
+        : wheelRadius(wheelRadius),
+          inverse(inverseMatrix(positions)),
+          forward((inverse.transpose() * inverse).inverse() * inverse.transpose())
+    {
+    }
+
+    /**
+     * Computes the module states that drive the chassis at `chassisVelocity`. A module that
+     * isn't moving keeps its angle from `states`, rather than snapping to 0.
+     */
+    void toModuleStates(
+        const algorithms::CMSISMat<3, 1> &chassisVelocity,
+        ModuleState (&states)[MODULES]) const
+    {
+        algorithms::CMSISMat<2 * MODULES, 1> moduleVelocities;
+        algorithms::multiply(inverse, chassisVelocity, moduleVelocities);
+        for (uint16_t i = 0; i < MODULES; i++)
+        {
+            const float vx = moduleVelocities.data[2 * i];
+            const float vy = moduleVelocities.data[2 * i + 1];
+            states[i].speed = sqrtf(vx * vx + vy * vy) / wheelRadius;
+            if (states[i].speed > 0)
+            {
+                states[i].angle = atan2f(vy, vx);
+            }
+        }
+    }
+
+    /**
+     * Computes the chassis velocity from measured module states, in the least squares sense.
+     */
+    void toChassisVelocity(
+        const ModuleState (&states)[MODULES],
+        algorithms::CMSISMat<3, 1> &chassisVelocity) const
+    {
+        algorithms::CMSISMat<2 * MODULES, 1> moduleVelocities;
+        for (uint16_t i = 0; i < MODULES; i++)
+        {
+            const float speed = states[i].speed * wheelRadius;
+            moduleVelocities.data[2 * i] = speed * cosf(states[i].angle);
+            moduleVelocities.data[2 * i + 1] = speed * sinf(states[i].angle);
+        }
+        algorithms::multiply(forward, moduleVelocities, chassisVelocity);
+    }
+
+    /**
+     * Scales all module speeds by the same factor so none is faster than `maxWheelSpeed`, which
+     * keeps the direction the chassis moves in.
+     *
+     * @return The factor the speeds were scaled by, from 0 to 1.
+     */
+    static float desaturate(ModuleState (&states)[MODULES], float maxWheelSpeed)
+    {
+        float maxSpeed = 0;
+        for (const ModuleState &state : states)
+        {
+            maxSpeed = fmaxf(maxSpeed, state.speed);
+        }
+        if (maxSpeed <= maxWheelSpeed)
+        {
+            return 1;
+        }
+        const float scale = maxWheelSpeed / maxSpeed;
+        for (ModuleState &state : states)
+        {
+            state.speed *= scale;
+        }
+        return scale;
+    }
+
+    /**
+     * @return `desired`, or if it is more than a quarter turn from `currentAngle`, the same
+     *      velocity with the module turned around and driving backwards, so a module never steers
+     *      more than a quarter turn.
+     */
+    static ModuleState optimize(const ModuleState &desired, float currentAngle)
+    {
+        const float error = remainderf(desired.angle - currentAngle, 2 * static_cast<float>(M_PI));
+        if (fabsf(error) <= static_cast<float>(M_PI) / 2)
+        {
+            return {currentAngle + error, desired.speed};
+        }
+        const float flipped = error > 0 ? error - static_cast<float>(M_PI)
+                                        : error + static_cast<float>(M_PI);
+        return {currentAngle + flipped, -desired.speed};
+    }
+
+private:
+    float wheelRadius;
+    algorithms::CMSISMat<2 * MODULES, 3> inverse;
+    algorithms::CMSISMat<3, 2 * MODULES> forward;
+
+    static algorithms::CMSISMat<2 * MODULES, 3> inverseMatrix(const float (&positions)[MODULES][2])
+    {
+        // The velocity of a module at (x, y) is (vx - wz * y, vy + wz * x)
+        algorithms::CMSISMat<2 * MODULES, 3> matrix;
+        for (uint16_t i = 0; i < MODULES; i++)
+        {
+            float *row = &matrix.data[2 * i * 3];
+            row[0] = 1;
+            row[1] = 0;
+            row[2] = -positions[i][1];
+            row[3] = 0;
+            row[4] = 1;
+            row[5] = positions[i][0];
+        }
+        return matrix;
+    }
+};  // class SwerveKinematics
+
+/**
+ * A `ChassisDisplacementObserverInterface` that integrates the chassis velocity computed from
+ * measured wheel speeds by a `LinearChassisKinematics`, for use with an `Odometry2DTracker`.
+ * Velocities are in m/s and displacements in m. z is always 0.
+ */
+template <uint16_t WHEELS>
+class KinematicDisplacementObserver
+    : public algorithms::odometry::ChassisDisplacementObserverInterface
+{
+public:
+    /// @param[in] kinematics The chassis' kinematics, which must outlive the observer.
+    explicit KinematicDisplacementObserver(const LinearChassisKinematics<WHEELS> &kinematics)
+        : kinematics(kinematics)
+    {
+    }
+
+    /**
+     * Integrates the chassis velocity from measured wheel speeds.
+     *
+     * @param[in] wheelSpeeds The measured wheel speeds, in rad/s.
+     * @param[in] dt The time since the last update, in seconds.
+     */
+    void update(const algorithms::CMSISMat<WHEELS, 1> &wheelSpeeds, float dt)
+    {
+        algorithms::CMSISMat<3, 1> chassisVelocity;
+        kinematics.toChassisVelocity(wheelSpeeds, chassisVelocity);
+        velocity.x = chassisVelocity.data[0];
+        velocity.y = chassisVelocity.data[1];
+        displacement.x += velocity.x * dt;
+        displacement.y += velocity.y * dt;
+        valid = true;
+    }
+
+    bool getVelocityChassisDisplacement(
+        modm::Vector3f *const velocity,
+        modm::Vector3f *const displacement) const override
+    {
+        if (!valid)
+        {
+            return false;
+        }
+        *velocity = this->velocity;
+        *displacement = this->displacement;
+        return true;
+    }
+
+private:
+    const LinearChassisKinematics<WHEELS> &kinematics;
+    modm::Vector3f velocity;
+    modm::Vector3f displacement;
+    bool valid = false;
+};  // class KinematicDisplacementObserver
+}  // namespace tap::control::chassis
+
+#endif  // TAPROOT_CHASSIS_KINEMATICS_HPP_
@@ -42,7 +42,12 @@ PowerLimiter::PowerLimiter(
       energyBuffer(startingEnergyBuffer),
       consumedPower(0.0f),
       prevTime(0),
-      prevRobotDataReceivedTimestamp(0)
+      prevRobotDataReceivedTimestamp(0),
+      prevRobotDataGeneration(0),
+      chassisVolt(0),
+      powerConsumptionLimit(0),
+      refereePowerBuffer(0),
+      refereePowerBufferUpdated(false)
 {
 }
 
@@ -71,23 +76,45 @@ float PowerLimiter::getPowerLimitRatio()
     }
 }
 
+void PowerLimiter::updateRefereeData()
+{
+    const uint32_t robotDataGeneration = drivers->refSerial.getRobotDataGeneration();
+    if (robotDataGeneration == prevRobotDataGeneration)
+    {
+        return;
+    }
+
+    tap::communication::serial::RefSerialData::Rx::RobotData robotData;
+    prevRobotDataGeneration = drivers->refSerial.getRobotDataSnapshot(&robotData);
+
+    chassisVolt = robotData.chassis.volt;
+    powerConsumptionLimit = robotData.chassis.powerConsumptionLimit;
+
+    if (robotData.robotDataReceivedTimestamp != prevRobotDataReceivedTimestamp)
+    {
+        refereePowerBuffer = robotData.chassis.powerBuffer;
+        refereePowerBufferUpdated = true;
+        prevRobotDataReceivedTimestamp = robotData.robotDataReceivedTimestamp;
+    }
+}
+
 void PowerLimiter::updatePowerAndEnergyBuffer()
 {
-    const auto &robotData = drivers->refSerial.getRobotData();
-    const auto &chassisData = robotData.chassis;
+    updateRefereeData();
+
     const float current = currentSensor->getCurrentMa();
-    const float newChassisPower = chassisData.volt * current / 1'000'000.0f;
+    const float newChassisPower = chassisVolt * current / 1'000'000.0f;
 
     // Manually compute energy buffer using consumedPower read from current sensor.
     // See rules manual for reasoning behind the energy buffer calculation.
     const float dt = tap::arch::clock::getTimeMilliseconds() - prevTime;
     prevTime = tap::arch::clock::getTimeMilliseconds();
-    energyBuffer -= (consumedPower - chassisData.powerConsumptionLimit) * dt / 1000.0f;
+    energyBuffer -= (consumedPower - powerConsumptionLimit) * dt / 1000.0f;
 
-    if (robotData.robotDataReceivedTimestamp != prevRobotDataReceivedTimestamp)
+    if (refereePowerBufferUpdated)
     {
-        energyBuffer = chassisData.powerBuffer;
-        prevRobotDataReceivedTimestamp = robotData.robotDataReceivedTimestamp;
+        energyBuffer = refereePowerBuffer;
+        refereePowerBufferUpdated = false;
     }
 
     consumedPower = newChassisPower;
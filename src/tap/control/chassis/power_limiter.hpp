@@ -106,6 +106,20 @@ class PowerLimiter
     float consumedPower;
     uint32_t prevTime;
     uint32_t prevRobotDataReceivedTimestamp;
+    uint32_t prevRobotDataGeneration;
+
+    /// Referee system data used by the power limiter, cached from the most recent robot data.
+    uint16_t chassisVolt;
+    uint16_t powerConsumptionLimit;
+    uint16_t refereePowerBuffer;
+    /// `true` if `refereePowerBuffer` has been received since the energy buffer was last reset.
+    bool refereePowerBufferUpdated;
+
+    /**
+     * Copies the referee system data used by the power limiter from a consistent snapshot of the
+     * robot data, only if the robot data has changed since it was last copied.
+     */
+    void updateRefereeData();
 
     /**
      * Computes the chassis power and the energy remaining in the energy buffer.
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "predictive_power_limiter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+namespace tap::control::chassis
+{
+PredictivePowerLimiter::PredictivePowerLimiter(const tap::Drivers *drivers, const Config &config)
+    : drivers(drivers),
+      config(config)
+{
+}
+
+bool PredictivePowerLimiter::addMotor(tap::motor::DjiMotor *motor, uint8_t priority)
+{
+    if (numMotors >= MAX_MOTORS)
+    {
+        return false;
+    }
+    motors[numMotors++] = {motor, priority, 0, 0, 1};
+    return true;
+}
+
+float PredictivePowerLimiter::predictMotorPower(float current, float rpm) const
+{
+    const float speed = rpm * static_cast<float>(M_TWOPI) / 60.0f;
+    return current * (config.resistance * current + config.backEmfConstant * speed);
+}
+
+void PredictivePowerLimiter::limitMotorOutputs()
+{
+    if (!drivers->refSerial.getRefSerialReceivingData())
+    {
+        for (int i = 0; i < numMotors; i++)
+        {
+            motors[i].ratio = 1;
+        }
+        initialized = false;
+        return;
+    }
+
+    updateEnergyBuffer();
+    allocatePower();
+
+    for (int i = 0; i < numMotors; i++)
+    {
+        const Motor &m = motors[i];
+        if (m.ratio < 1)
+        {
+            m.motor->setDesiredOutput(static_cast<int32_t>(m.ratio * m.motor->getOutputDesired()));
+        }
+    }
+}
+
+void PredictivePowerLimiter::updateEnergyBuffer()
+{
+    bool refereeBufferUpdated = false;
+    uint16_t refereeBuffer = 0;
+    if (drivers->refSerial.getRobotDataGeneration() != prevRobotDataGeneration)
+    {
+        tap::communication::serial::RefSerialData::Rx::RobotData robotData;
+        prevRobotDataGeneration = drivers->refSerial.getRobotDataSnapshot(&robotData);
+        powerConsumptionLimit = robotData.chassis.powerConsumptionLimit;
+        if (robotData.robotDataReceivedTimestamp != prevRobotDataReceivedTimestamp)
+        {
+            refereeBuffer = robotData.chassis.powerBuffer;
+            refereeBufferUpdated = true;
+            prevRobotDataReceivedTimestamp = robotData.robotDataReceivedTimestamp;
+        }
+    }
+
+    measuredPower = config.staticPower;
+    for (int i = 0; i < numMotors; i++)
+    {
+        const tap::motor::DjiMotor *motor = motors[i].motor;
+        measuredPower +=
+            predictMotorPower(motor->getTorque() * config.currentPerUnit, motor->getShaftRPM());
+    }
+
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+    if (initialized)
+    {
+        const float dt = (time - prevTime) / 1'000'000.0f;
+        const float refereePower = measuredPower - auxiliarySuppliedPower;
+        energyBuffer = std::max(0.0f, energyBuffer - (refereePower - powerConsumptionLimit) * dt);
+    }
+    prevTime = time;
+    initialized = true;
+
+    if (refereeBufferUpdated)
+    {
+        energyBuffer = refereeBuffer;
+    }
+
+    powerBudget = std::max(
+        0.0f,
+        powerConsumptionLimit +
+            (energyBuffer - config.energyBufferReserve) / config.bufferSpendTime +
+            auxiliaryAvailablePower);
+}
+
+void PredictivePowerLimiter::allocatePower()
+{
+    float totalPower = 0;
+    for (int i = 0; i < numMotors; i++)
+    {
+        Motor &m = motors[i];
+        const float current = m.motor->getOutputDesired() * config.currentPerUnit;
+        const float speed = m.motor->getShaftRPM() * static_cast<float>(M_TWOPI) / 60.0f;
+        m.linearPower = config.backEmfConstant * speed * current;
+        m.quadraticPower = config.resistance * current * current;
+        m.ratio = 1;
+        totalPower += m.linearPower + m.quadraticPower;
+    }
+
+    const float availablePower = powerBudget - config.staticPower;
+    if (totalPower <= availablePower)
+    {
+        return;
+    }
+
+    // From the lowest priority up, scale every motor of a priority by the same ratio k, the
+    // largest at which a * k + b * k^2 fits in what the motors of higher priorities leave.
+    int level = -1;
+    while (true)
+    {
+        int nextLevel = INT32_MAX;
+        for (int i = 0; i < numMotors; i++)
+        {
+            if (motors[i].priority > level)
+            {
+                nextLevel = std::min<int>(nextLevel, motors[i].priority);
+            }
+        }
+        if (nextLevel == INT32_MAX)
+        {
+            return;
+        }
+        level = nextLevel;
+
+        float a = 0;
+        float b = 0;
+        float higherPower = 0;
+        for (int i = 0; i < numMotors; i++)
+        {
+            const Motor &m = motors[i];
+            if (m.priority == level)
+            {
+                a += m.linearPower;
+                b += m.quadraticPower;
+            }
+            else if (m.priority > level)
+            {
+                higherPower += m.linearPower + m.quadraticPower;
+            }
+        }
+
+        const float c = availablePower - higherPower;
+        float k = 0;
+        if (b > 0)
+        {
+            const float discriminant = a * a + 4 * b * c;
+            k = discriminant >= 0 ? (sqrtf(discriminant) - a) / (2 * b) : 0;
+        }
+        else if (a > 0)
+        {
+            k = c / a;
+        }
+        k = std::clamp(k, 0.0f, 1.0f);
+
+        for (int i = 0; i < numMotors; i++)
+        {
+            if (motors[i].priority == level)
+            {
+                motors[i].ratio = k;
+            }
+        }
+
+        if (k > 0)
+        {
+            return;
+        }
+    }
+}
+
+}  // namespace tap::control::chassis
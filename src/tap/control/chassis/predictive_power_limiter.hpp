@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PREDICTIVE_POWER_LIMITER_HPP_
+#define TAPROOT_PREDICTIVE_POWER_LIMITER_HPP_
+
+#include <cstdint>
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::motor
+{
+class DjiMotor;
+}
+
+namespace tap::control::chassis
+{
+/**
+ * A power limiter that predicts the power each motor will draw from its current and speed every
+ * control loop, rather than waiting for the referee system's power and energy buffer reports,
+ * which arrive at 10-50 Hz and late.
+ *
+ * Each motor is modeled as a DC motor drawing `I^2 R + k_e * w * I` watts at current `I` and rotor
+ * speed `w`. From the feedback of every motor, the limiter estimates the chassis power and
+ * integrates the energy buffer between referee reports, resetting it to the referee's value when
+ * a new one arrives. Each loop the buffer above `energyBufferReserve` may be spent over
+ * `bufferSpendTime` on top of the referee's power limit; below the reserve, less than the limit
+ * is allowed so the buffer refills.
+ *
+ * When the predicted power of the desired outputs is over that budget, the motors with the lowest
+ * priority are scaled down first, down to zero, before motors of the next priority are touched.
+ * Motors of the same priority are scaled by the same fraction, found by solving the quadratic
+ * power model, so the outputs land on the budget rather than on a conservative guess. For example,
+ * with the drive wheels at a higher priority than a spinning turret base, the turret gives up its
+ * power before the chassis loses traction.
+ *
+ * ```cpp
+ * PredictivePowerLimiter powerLimiter(drivers, PredictivePowerLimiter::M3508_CONFIG);
+ * powerLimiter.addMotor(&leftWheel, 1);
+ * powerLimiter.addMotor(&rightWheel, 1);
+ *
+ * // each control loop, after running the chassis controllers
+ * powerLimiter.limitMotorOutputs();
+ * ```
+ *
+ * If the referee system is not connected, the outputs are not limited.
+ */
+class PredictivePowerLimiter
+{
+public:
+    struct Config
+    {
+        /// Winding resistance, in ohms.
+        float resistance;
+        /// Back EMF per rotor speed, in V/(rad/s).
+        float backEmfConstant;
+        /// Amps per unit of a motor's desired output and of the current in its feedback.
+        float currentPerUnit;
+        /// Power drawn by the chassis other than the modeled motors, in watts.
+        float staticPower;
+        /// Energy in joules the limiter keeps in the buffer as a margin against model error.
+        float energyBufferReserve;
+        /// Time in seconds over which the energy buffer above the reserve may be spent.
+        float bufferSpendTime;
+    };
+
+    /**
+     * Approximate parameters for M3508s driven by C620s, whose output and feedback current range
+     * over [-16384, 16384] for [-20, 20] amps.
+     */
+    static constexpr Config M3508_CONFIG = {
+        .resistance = 0.194f,
+        .backEmfConstant = 0.3f * 187.0f / 3591.0f,
+        .currentPerUnit = 20.0f / 16'384.0f,
+        .staticPower = 2.0f,
+        .energyBufferReserve = 10.0f,
+        .bufferSpendTime = 0.5f,
+    };
+
+    static constexpr int MAX_MOTORS = 8;
+
+    PredictivePowerLimiter(const tap::Drivers *drivers, const Config &config);
+
+    /**
+     * Adds a motor whose desired output will be limited.
+     *
+     * @param[in] motor The motor. Must outlive the limiter.
+     * @param[in] priority Motors with a higher priority are limited only once all motors with a
+     *      lower priority have been scaled to zero.
+     * @return `false` if `MAX_MOTORS` motors have already been added.
+     */
+    bool addMotor(tap::motor::DjiMotor *motor, uint8_t priority = 0);
+
+    /**
+     * Updates the energy buffer estimate from the motors' feedback, then scales down the desired
+     * output of the motors so their predicted power fits in the budget.
+     *
+     * @note Must be called after the motors' desired outputs have been set, every control loop.
+     */
+    void limitMotorOutputs();
+
+    /**
+     * Accounts for an energy store the referee system does not measure, such as a supercapacitor
+     * between the referee's power meter and the chassis (see `SupercapPowerManager`). Holds until
+     * set again, so call it every control loop before `limitMotorOutputs`.
+     *
+     * @param[in] availablePower Power in watts the store can supply, allowed on top of the budget.
+     * @param[in] suppliedPower Power in watts the store is presently supplying to the chassis,
+     *      negative while it charges. Not drawn through the referee's meter, so not integrated
+     *      into the energy buffer.
+     */
+    void setAuxiliarySource(float availablePower, float suppliedPower)
+    {
+        auxiliaryAvailablePower = availablePower;
+        auxiliarySuppliedPower = suppliedPower;
+    }
+
+    /**
+     * @return The power, in watts, the model predicts a motor draws at the given current, in
+     *      amps, and rotor speed, in RPM. Negative while regenerating.
+     */
+    float predictMotorPower(float current, float rpm) const;
+
+    /// @return The estimated energy in the energy buffer, in joules.
+    float getEnergyBuffer() const { return energyBuffer; }
+
+    /// @return The chassis power estimated from the motors' feedback, in watts.
+    float getMeasuredPower() const { return measuredPower; }
+
+    /// @return The power the motors were allowed in the most recent loop, in watts.
+    float getPowerBudget() const { return powerBudget; }
+
+    /// @return The fraction the given motor's desired output was scaled by in the most recent loop.
+    float getOutputRatio(int motor) const { return motors[motor].ratio; }
+
+private:
+    struct Motor
+    {
+        tap::motor::DjiMotor *motor;
+        uint8_t priority;
+        /// The linear and quadratic coefficients of the motor's power in its output ratio.
+        float linearPower;
+        float quadraticPower;
+        float ratio;
+    };
+
+    const tap::Drivers *drivers;
+    const Config config;
+
+    Motor motors[MAX_MOTORS];
+    int numMotors = 0;
+
+    float energyBuffer = 0;
+    float measuredPower = 0;
+    float powerBudget = 0;
+    uint32_t prevTime = 0;
+    bool initialized = false;
+
+    uint32_t prevRobotDataGeneration = 0;
+    uint32_t prevRobotDataReceivedTimestamp = 0;
+    uint16_t powerConsumptionLimit = 0;
+
+    float auxiliaryAvailablePower = 0;
+    float auxiliarySuppliedPower = 0;
+
+    /// Integrates the energy buffer, resetting it when the referee reports a new value.
+    void updateEnergyBuffer();
+
+    /// Sets each motor's `ratio` so their predicted power is at most `powerBudget`.
+    void allocatePower();
+};
+}  // namespace tap::control::chassis
+
+#endif  // TAPROOT_PREDICTIVE_POWER_LIMITER_HPP_
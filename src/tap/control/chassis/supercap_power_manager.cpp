@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "supercap_power_manager.hpp"
+
+#include <algorithm>
+
+#include "tap/drivers.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::control::chassis
+{
+SupercapPowerManager::SupercapPowerManager(tap::Drivers *drivers, const Config &config)
+    : CanRxListener(drivers, config.rxId, config.canBus),
+      config(config)
+{
+}
+
+void SupercapPowerManager::initialize() { attachSelfToRxHandler(); }
+
+void SupercapPowerManager::processMessage(const modm::can::Message &message)
+{
+    if (message.getIdentifier() != config.rxId || message.getLength() < 4)
+    {
+        return;
+    }
+    capacitorVoltage = static_cast<uint16_t>(message.data[0] << 8 | message.data[1]) / 1000.0f;
+    capacitorCurrent = static_cast<int16_t>(message.data[2] << 8 | message.data[3]) / 1000.0f;
+    receivedStatus = true;
+    disconnectTimeout.restart(DISCONNECT_TIME);
+}
+
+void SupercapPowerManager::update(float chassisPower)
+{
+    if (drivers->refSerial.getRobotDataGeneration() != prevRobotDataGeneration)
+    {
+        tap::communication::serial::RefSerialData::Rx::RobotData robotData;
+        prevRobotDataGeneration = drivers->refSerial.getRobotDataSnapshot(&robotData);
+        powerConsumptionLimit = robotData.chassis.powerConsumptionLimit;
+    }
+
+    if (!isOnline() || !drivers->refSerial.getRefSerialReceivingData())
+    {
+        // Without knowing the limit or the charge, draw nothing through the board
+        burstPower = 0;
+        chargePower = 0;
+    }
+    else
+    {
+        burstPower =
+            burstEnabled
+                ? std::min(config.maxDischargePower, getStoredEnergy() / config.dischargeTime)
+                : 0.0f;
+
+        // The chassis draws what it can from the capacitor first, the rest through the meter
+        const float meterPower = chassisPower - std::max(0.0f, getCapacitorPower());
+        chargePower = capacitorVoltage >= config.maxVoltage
+                          ? 0.0f
+                          : std::clamp(
+                                powerConsumptionLimit - config.chargeMargin - meterPower,
+                                0.0f,
+                                config.maxChargePower);
+    }
+
+    if (sendTimer.execute())
+    {
+        sendChargePower();
+    }
+}
+
+float SupercapPowerManager::getStoredEnergy() const
+{
+    const float v = std::max(capacitorVoltage, config.minVoltage);
+    return 0.5f * config.capacitance * (v * v - config.minVoltage * config.minVoltage);
+}
+
+float SupercapPowerManager::getStateOfCharge() const
+{
+    const float minSquared = config.minVoltage * config.minVoltage;
+    const float full =
+        0.5f * config.capacitance * (config.maxVoltage * config.maxVoltage - minSquared);
+    return std::clamp(getStoredEnergy() / full, 0.0f, 1.0f);
+}
+
+void SupercapPowerManager::sendChargePower()
+{
+    const uint16_t power = static_cast<uint16_t>(chargePower * 100);
+    modm::can::Message message(config.txId, 2);
+    message.setExtended(false);
+    message.data[0] = power >> 8;
+    message.data[1] = power & 0xFF;
+    drivers->can.sendMessage(config.canBus, message);
+}
+}  // namespace tap::control::chassis
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SUPERCAP_POWER_MANAGER_HPP_
+#define TAPROOT_SUPERCAP_POWER_MANAGER_HPP_
+
+#include <cstdint>
+
+#include "tap/architecture/periodic_timer.hpp"
+#include "tap/architecture/timeout.hpp"
+#include "tap/communication/can/can_rx_listener.hpp"
+
+namespace tap::control::chassis
+{
+/**
+ * Manages a supercapacitor board connected over CAN between the referee system's power meter and
+ * the chassis, so the chassis can sprint on stored energy without drawing more than the referee's
+ * power limit through the meter.
+ *
+ * Every `update`, the manager compares the chassis power, such as estimated by a
+ * `PredictivePowerLimiter` from the motors' feedback, with the referee's power limit, and commands
+ * the board to charge with what the chassis leaves unused less `chargeMargin`. While bursting is
+ * enabled, the stored energy above `minVoltage` may be spent no faster than over `dischargeTime`,
+ * up to `maxDischargePower`, on top of the referee's limit; pass `getBurstPower` and
+ * `getCapacitorPower` to `PredictivePowerLimiter::setAuxiliarySource` so the limiter allows it.
+ *
+ * The board is expected to report, every few milliseconds with identifier `rxId`, the capacitor
+ * voltage in mV as an unsigned 16-bit integer in bytes 0 and 1, and the current into the
+ * capacitor in mA as a signed 16-bit integer in bytes 2 and 3, both big endian like `DjiMotor`
+ * feedback. The manager sends the board the power to charge at in units of 0.01 W as an unsigned
+ * 16-bit big endian integer with identifier `txId` every `SEND_PERIOD` ms. Boards with another
+ * protocol may override `processMessage`.
+ *
+ * ```cpp
+ * // each control loop, after running the chassis controllers
+ * supercap.update(powerLimiter.getMeasuredPower());
+ * powerLimiter.setAuxiliarySource(supercap.getBurstPower(), supercap.getCapacitorPower());
+ * powerLimiter.limitMotorOutputs();
+ * ```
+ */
+class SupercapPowerManager : public tap::can::CanRxListener
+{
+public:
+    struct Config
+    {
+        tap::can::CanBus canBus;
+        /// Identifier of the board's status messages.
+        uint32_t rxId;
+        /// Identifier of the charge commands sent to the board.
+        uint32_t txId;
+        /// Capacitance of the capacitor bank, in farads.
+        float capacitance;
+        /// Voltage below which the board can no longer supply the chassis, in volts.
+        float minVoltage;
+        /// Voltage the board charges the capacitor bank to, in volts.
+        float maxVoltage;
+        /// The most power the board can charge at, in watts.
+        float maxChargePower;
+        /// The most power the board can supply to the chassis, in watts.
+        float maxDischargePower;
+        /// Time in seconds over which the stored energy may be spent at most.
+        float dischargeTime;
+        /// Power in watts below the referee's limit left unused while charging.
+        float chargeMargin;
+    };
+
+    /// Time in ms between charge commands sent to the board.
+    static constexpr uint32_t SEND_PERIOD = 10;
+
+    /// Time in ms without a status message after which the board is considered offline.
+    static constexpr uint32_t DISCONNECT_TIME = 100;
+
+    SupercapPowerManager(tap::Drivers *drivers, const Config &config);
+
+    /// Attaches the manager to the CAN receive handler.
+    void initialize();
+
+    void processMessage(const modm::can::Message &message) override;
+
+    /**
+     * Updates the charge power and burst power and, every `SEND_PERIOD` ms, sends the charge
+     * power to the board.
+     *
+     * @param[in] chassisPower The power the chassis is drawing, in watts, whether from the referee
+     *      system's power meter or the capacitor.
+     */
+    void update(float chassisPower);
+
+    /// Enables or disables spending stored energy. While disabled, the capacitor only charges.
+    void setBurstEnabled(bool enabled) { burstEnabled = enabled; }
+
+    bool isBurstEnabled() const { return burstEnabled; }
+
+    /// @return `true` if a status message has been received in the last `DISCONNECT_TIME` ms.
+    bool isOnline() const { return receivedStatus && !disconnectTimeout.isExpired(); }
+
+    /// @return The capacitor voltage, in volts.
+    float getCapacitorVoltage() const { return capacitorVoltage; }
+
+    /// @return The current into the capacitor, in amps. Negative while discharging.
+    float getCapacitorCurrent() const { return capacitorCurrent; }
+
+    /**
+     * @return The power in watts the capacitor is supplying to the chassis, negative while it
+     *      charges. 0 while offline.
+     */
+    float getCapacitorPower() const
+    {
+        return isOnline() ? -capacitorVoltage * capacitorCurrent : 0.0f;
+    }
+
+    /// @return The energy stored above `minVoltage`, in joules.
+    float getStoredEnergy() const;
+
+    /// @return The stored energy as a fraction of the energy stored at `maxVoltage`.
+    float getStateOfCharge() const;
+
+    /// @return The power in watts the chassis may draw from the capacitor, 0 if not bursting.
+    float getBurstPower() const { return burstPower; }
+
+    /// @return The power in watts the board was last commanded to charge at.
+    float getChargePower() const { return chargePower; }
+
+private:
+    const Config config;
+
+    float capacitorVoltage = 0;
+    float capacitorCurrent = 0;
+    bool receivedStatus = false;
+    tap::arch::MilliTimeout disconnectTimeout;
+
+    bool burstEnabled = false;
+    float burstPower = 0;
+    float chargePower = 0;
+    tap::arch::PeriodicMilliTimer sendTimer{SEND_PERIOD};
+
+    uint32_t prevRobotDataGeneration = 0;
+    uint16_t powerConsumptionLimit = 0;
+
+    void sendChargePower();
+};
+}  // namespace tap::control::chassis
+
+#endif  // TAPROOT_SUPERCAP_POWER_MANAGER_HPP_
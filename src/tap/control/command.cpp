@@ -28,6 +28,11 @@ namespace control
 {
 Command::Command() : globalIdentifier(CommandScheduler::constructCommand(this)) {}
 
+Command::Command(const subsystem_scheduler_bitmap_t& requirements) : Command()
+{
+    commandRequirementsBitwise = requirements;
+}
+
 Command::~Command() { CommandScheduler::destructCommand(this); }
 
 void Command::addSubsystemRequirement(Subsystem* requirement)
@@ -36,7 +41,20 @@ void Command::addSubsystemRequirement(Subsystem* requirement)
     {
         return;
     }
-    commandRequirementsBitwise |= (1UL << requirement->getGlobalIdentifier());
+    commandRequirementsBitwise.set(requirement->getGlobalIdentifier());
+}
+
+subsystem_scheduler_bitmap_t Command::requirementsOf(std::initializer_list<Subsystem*> subsystems)
+{
+    subsystem_scheduler_bitmap_t requirements;
+    for (Subsystem* subsystem : subsystems)
+    {
+        if (subsystem != nullptr)
+        {
+            requirements.set(subsystem->getGlobalIdentifier());
+        }
+    }
+    return requirements;
 }
 
 bool Command::isReady() { return true; }
@@ -20,15 +20,42 @@
 #ifndef TAPROOT_COMMAND_HPP_
 #define TAPROOT_COMMAND_HPP_
 
+#include <cstdint>
+#include <initializer_list>
+
 #include "tap/util_macros.hpp"
 
 #include "command_scheduler_types.hpp"
+#include "time_budget.hpp"
 
 namespace tap
 {
 namespace control
 {
 class Subsystem;
+class Command;
+
+/**
+ * Describes how a composite command runs its children, see `Command::getComposition`.
+ */
+struct CommandComposition
+{
+    enum class Type : uint8_t
+    {
+        /// The command runs its own logic.
+        NONE,
+        /// The children run one after another, like `SequentialCommand`.
+        SEQUENCE,
+        /// The children run in parallel until all are finished, like `ConcurrentCommand`.
+        CONCURRENT,
+        /// The children run in parallel until one is finished, like `ConcurrentRaceCommand`.
+        RACE,
+    };
+
+    Type type = Type::NONE;
+    Command* const* children = nullptr;
+    int numChildren = 0;
+};
 
 /**
  * A generic extendable class for implementing a command. Each
@@ -41,8 +68,23 @@ class Command
 public:
     Command();
 
+    /**
+     * @param[in] requirements The subsystems the command requires, for example built with
+     *      `requirementsOf`. Stored as is, so no list of subsystems is kept.
+     */
+    explicit Command(const subsystem_scheduler_bitmap_t& requirements);
+
     virtual ~Command();
 
+    /**
+     * @return The set of the given subsystems, as returned by `getRequirementsBitwise`. Null
+     *      subsystems are ignored. Subsystem identifiers are only known at runtime, but when
+     *      identifiers are, `subsystem_scheduler_bitmap_t::oneHot` and `|` build the same set in
+     *      a `constexpr` context.
+     */
+    static subsystem_scheduler_bitmap_t requirementsOf(
+        std::initializer_list<Subsystem*> subsystems);
+
     /**
      * Specifies the encoded set of subsystems used by this command. Two commands cannot
      * use the same subsystem at the same time.  If another command is scheduled
@@ -104,6 +146,13 @@ class Command
      */
     virtual void execute() = 0;
 
+    /**
+     * Called instead of `execute` once the command has been degraded for running over its time
+     * budget, see `getTimeBudget`. Override with a cheaper version of `execute`. Calls `execute`
+     * by default.
+     */
+    virtual void executeDegraded() { execute(); }
+
     /**
      * The action to take when the command ends. Called when either the command
      * finishes normally, or when it interrupted/canceled.
@@ -124,6 +173,50 @@ class Command
      */
     virtual bool isFinished() const = 0;
 
+    /**
+     * Composite commands that only run their children, such as `SequentialCommand` and
+     * `ConcurrentCommand`, describe how they run them, so `FlattenedCommand` can run the children
+     * directly instead of through the composite.
+     *
+     * @return The command's composition, of type `NONE` unless overridden.
+     */
+    virtual CommandComposition getComposition() const { return CommandComposition(); }
+
+    /**
+     * Finishes the command the next time whatever runs it checks whether it is finished, as if
+     * `isFinished` returned `true`. For commands that finish on an event, such as a timeout or a
+     * remote switch, rather than on a condition evaluated each tick. The request is cleared when
+     * the command is initialized.
+     */
+    inline void requestFinish() { finishRequested = true; }
+
+    /// @return `true` if `requestFinish` was called since the command was last initialized.
+    inline bool isFinishRequested() const { return finishRequested; }
+
+    /**
+     * Clears a finish request. Called by whatever runs the command (the scheduler and composite
+     * commands) right before `initialize`.
+     */
+    inline void clearFinishRequest() { finishRequested = false; }
+
+    /// @return `true` if the command only finishes through `requestFinish`.
+    inline bool finishesOnRequest() const { return finishOnRequest; }
+
+    /**
+     * Checks whether the command is finished the way the scheduler does: commands that finish on
+     * request only have their request checked, which saves a virtual call each tick, and other
+     * commands have `isFinished` called.
+     */
+    inline bool checkFinished() const
+    {
+        return finishOnRequest ? finishRequested : (finishRequested || isFinished());
+    }
+
+    /// @return The command's time budget, which is unset unless the command sets it.
+    inline TimeBudget& getTimeBudget() { return timeBudget; }
+
+    inline const TimeBudget& getTimeBudget() const { return timeBudget; }
+
 private:
     /**
      * An identifier unique to a command that will be assigned to it automatically upon
@@ -131,8 +224,20 @@ class Command
      */
     const int globalIdentifier;
 
+    bool finishOnRequest = false;
+    bool finishRequested = false;
+
+    TimeBudget timeBudget;
+
 protected:
-    command_scheduler_bitmap_t commandRequirementsBitwise = 0;
+    subsystem_scheduler_bitmap_t commandRequirementsBitwise;
+
+    /**
+     * Opts the command into finishing only through `requestFinish`, so the scheduler no longer
+     * calls `isFinished` each tick. Call from the constructor. `isFinished` should still return
+     * `isFinishRequested()` for code that calls it directly.
+     */
+    inline void setFinishesOnRequest() { finishOnRequest = true; }
 };  // class Command
 
 }  // namespace control
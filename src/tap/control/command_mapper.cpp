@@ -32,6 +32,36 @@ namespace tap
 {
 namespace control
 {
+static constexpr int BITS_PER_WORD = 32;
+
+uint32_t CommandMapper::getInputsRead(const RemoteMapState &mapState)
+{
+    uint32_t inputs = mapState.getKeys() | mapState.getNegKeys();
+    if (mapState.getLSwitch() != Remote::SwitchState::UNKNOWN)
+    {
+        inputs |= 1u << LEFT_SWITCH_INPUT;
+    }
+    if (mapState.getRSwitch() != Remote::SwitchState::UNKNOWN)
+    {
+        inputs |= 1u << RIGHT_SWITCH_INPUT;
+    }
+    if (mapState.getLMouseButton())
+    {
+        inputs |= 1u << LEFT_MOUSE_INPUT;
+    }
+    if (mapState.getRMouseButton())
+    {
+        inputs |= 1u << RIGHT_MOUSE_INPUT;
+    }
+    return inputs;
+}
+
+template <typename Bitmap>
+static void setBit(Bitmap &bitmap, std::size_t i)
+{
+    bitmap[i / BITS_PER_WORD] |= 1u << (i % BITS_PER_WORD);
+}
+
 void CommandMapper::handleKeyStateChange(
     uint16_t key,
     Remote::SwitchState leftSwitch,
@@ -54,13 +84,89 @@ void CommandMapper::handleKeyStateChange(
         mapstate.initRMouseButton();
     }
 
-    for (CommandMapping *cmdMap : commandsToRun)
+    uint32_t changedInputs = static_cast<uint16_t>(key ^ prevKeys);
+    changedInputs |= static_cast<uint32_t>(leftSwitch != prevLeftSwitch) << LEFT_SWITCH_INPUT;
+    changedInputs |= static_cast<uint32_t>(rightSwitch != prevRightSwitch) << RIGHT_SWITCH_INPUT;
+    changedInputs |= static_cast<uint32_t>(mouseL != prevMouseL) << LEFT_MOUSE_INPUT;
+    changedInputs |= static_cast<uint32_t>(mouseR != prevMouseR) << RIGHT_MOUSE_INPUT;
+    prevKeys = key;
+    prevLeftSwitch = leftSwitch;
+    prevRightSwitch = rightSwitch;
+    prevMouseL = mouseL;
+    prevMouseR = mouseR;
+
+    for (std::size_t w = 0; w < toExecute.size(); w++)
+    {
+        toExecute[w] = alwaysExecuted[w] | addedMappings[w];
+        addedMappings[w] = 0;
+    }
+    while (changedInputs != 0)
+    {
+        const int input = __builtin_ctz(changedInputs);
+        changedInputs &= changedInputs - 1;
+        for (std::size_t w = 0; w < toExecute.size(); w++)
+        {
+            toExecute[w] |= mappingsByInput[input][w];
+        }
+    }
+
+    // Set bits are visited lowest first, so mappings execute in the order they were added
+    for (std::size_t w = 0; w < toExecute.size(); w++)
+    {
+        uint32_t word = toExecute[w];
+        while (word != 0)
+        {
+            commandsToRun[w * BITS_PER_WORD + __builtin_ctz(word)]->executeCommandMapping(mapstate);
+            word &= word - 1;
+        }
+    }
+}
+
+void CommandMapper::update()
+{
+    for (CommandMapping *mapping : updatedMappings)
     {
-        cmdMap->executeCommandMapping(mapstate);
+        mapping->update();
     }
 }
 
-void CommandMapper::addMap(CommandMapping *mapping) { commandsToRun.push_back(mapping); }
+void CommandMapper::addMap(CommandMapping *mapping)
+{
+    const std::size_t index = commandsToRun.size();
+    if (!commandsToRun.push_back(mapping))
+    {
+        RAISE_ERROR(drivers, "command mapper full, increase max_command_mappings");
+        return;
+    }
+
+    const std::size_t words = index / BITS_PER_WORD + 1;
+    if (toExecute.size() < words)
+    {
+        for (MappingBitmap &bitmap : mappingsByInput)
+        {
+            bitmap.resize(words, 0);
+        }
+        alwaysExecuted.resize(words, 0);
+        addedMappings.resize(words, 0);
+        toExecute.resize(words, 0);
+    }
+
+    setBit(addedMappings, index);
+    if (!mapping->reactsOnlyToInputChanges())
+    {
+        setBit(alwaysExecuted, index);
+    }
+    if (mapping->isUpdatedEachTick())
+    {
+        updatedMappings.push_back(mapping);
+    }
+    uint32_t inputs = getInputsRead(mapping->getAssociatedRemoteMapState());
+    while (inputs != 0)
+    {
+        setBit(mappingsByInput[__builtin_ctz(inputs)], index);
+        inputs &= inputs - 1;
+    }
+}
 
 const CommandMapping *CommandMapper::getAtIndex(std::size_t index) const
 {
@@ -20,9 +20,11 @@
 #ifndef TAPROOT_COMMAND_MAPPER_HPP_
 #define TAPROOT_COMMAND_MAPPER_HPP_
 
-#include <vector>
+#include <cstdint>
 
+#include "tap/architecture/static_vector.hpp"
 #include "tap/communication/serial/remote.hpp"
+#include "tap/control/command_scheduler_constants.hpp"
 #include "tap/util_macros.hpp"
 
 namespace tap
@@ -31,6 +33,7 @@ class Drivers;
 namespace control
 {
 class CommandMapping;
+class RemoteMapState;
 
 /**
  * Class that controls mapping remote state to actions. All the remote
@@ -70,9 +73,15 @@ class CommandMapper
     /**
      * The heart of the CommandMapper.
      *
-     * Iterates through all the current mappings to see which buttons are pressed
+     * Iterates through the current mappings to see which buttons are pressed
      * in order to determine which commands should be added to or removed from the scheduler.
      * Call when new remote information has been received.
+     *
+     * Only mappings that read an input that changed since the last call are executed, along
+     * with mappings added since the last call and those whose `reactsOnlyToInputChanges` is
+     * `false`, in the order they were added. Mappings that react only to input changes do
+     * nothing when executed with an unchanged state, so the result is the same as executing
+     * every mapping.
      */
     mockable void handleKeyStateChange(
         uint16_t key,
@@ -81,9 +90,16 @@ class CommandMapper
         bool mouseL,
         bool mouseR);
 
+    /**
+     * Calls `update` on the mappings whose `isUpdatedEachTick` is `true`, in the order they were
+     * added. Call once per tick, before the `CommandScheduler` runs.
+     */
+    mockable void update();
+
     /**
      * Verifies the mapping passed in can be added to `commandsToRun`
-     * and if possible adds the mapping.
+     * and if possible adds the mapping. Raises an error if `MAX_COMMAND_MAPPINGS` mappings have
+     * already been added.
      *
      * @param[in] mapping A pointer to the CommandMapping to be added. The
      *      command mapper is not responsible for memory deallocation of this
@@ -103,6 +119,9 @@ class CommandMapper
     mockable const CommandMapping *getAtIndex(std::size_t index) const;
 
 private:
+    /// Words in each bitmap over the mappings, enough for `MAX_COMMAND_MAPPINGS` mappings.
+    static constexpr std::size_t MAPPING_BITMAP_WORDS = (MAX_COMMAND_MAPPINGS + 31) / 32;
+
     /**
      * We use a vector because it is slightly faster for iteration than an `std::set` or
      * `std::map` (which would facilitate a different structure than a `CommandMapping` class).
@@ -110,9 +129,51 @@ class CommandMapper
      * It ends up being slower to insert, but this is OK since we only insert at the beginning
      * of execution.
      */
-    std::vector<CommandMapping *> commandsToRun;
+    arch::StaticVector<CommandMapping *, MAX_COMMAND_MAPPINGS> commandsToRun;
+
+    /**
+     * The remote inputs, as bit indices of an input mask. The keys take the bits of their
+     * `Remote::Key` values.
+     */
+    enum Input
+    {
+        LEFT_SWITCH_INPUT = 16,
+        RIGHT_SWITCH_INPUT,
+        LEFT_MOUSE_INPUT,
+        RIGHT_MOUSE_INPUT,
+        NUM_INPUTS,
+    };
+
+    using MappingBitmap = arch::StaticVector<uint32_t, MAPPING_BITMAP_WORDS>;
+
+    /*
+     * Bitmaps over the indices of `commandsToRun`, one bit per mapping, grown in `addMap`.
+     */
+    /// For each input, the mappings whose map state reads it.
+    MappingBitmap mappingsByInput[NUM_INPUTS];
+    /// The mappings updated by `update`.
+    arch::StaticVector<CommandMapping *, MAX_COMMAND_MAPPINGS> updatedMappings;
+
+    /// The mappings executed on every call.
+    MappingBitmap alwaysExecuted;
+    /// The mappings added since the last call.
+    MappingBitmap addedMappings;
+    /// The mappings to execute during the current call.
+    MappingBitmap toExecute;
+
+    /// The inputs as of the last call.
+    uint16_t prevKeys = 0;
+    tap::communication::serial::Remote::SwitchState prevLeftSwitch =
+        tap::communication::serial::Remote::SwitchState::UNKNOWN;
+    tap::communication::serial::Remote::SwitchState prevRightSwitch =
+        tap::communication::serial::Remote::SwitchState::UNKNOWN;
+    bool prevMouseL = false;
+    bool prevMouseR = false;
 
     Drivers *drivers;
+
+    /// @return The input mask of the inputs `mapState` reads.
+    static uint32_t getInputsRead(const RemoteMapState &mapState);
 };  // class CommandMapper
 
 }  // namespace control
@@ -19,6 +19,8 @@
 
 #include "command_mapper_format_generator.hpp"
 
+#include <algorithm>
+
 #include "command.hpp"
 #include "command_mapper.hpp"
 #include "command_mapping.hpp"
@@ -30,79 +32,198 @@ namespace tap
 {
 namespace control
 {
+class CommandMapperFormatGenerator::TextWriter
+{
+public:
+    TextWriter(char *buffer, std::size_t size) : buffer(buffer), size(size)
+    {
+        if (size != 0)
+        {
+            buffer[0] = '\0';
+        }
+    }
+
+    TextWriter &operator<<(const char *text)
+    {
+        for (; *text != '\0'; text++)
+        {
+            if (length + 1 < size)
+            {
+                buffer[length] = *text;
+                buffer[length + 1] = '\0';
+            }
+            length++;
+        }
+        return *this;
+    }
+
+    std::size_t getLength() const { return length; }
+
+private:
+    char *buffer;
+    std::size_t size;
+    std::size_t length = 0;
+};
+
+/// Key names in the order they are listed.
+static constexpr struct
+{
+    Remote::Key key;
+    const char *name;
+} KEY_NAMES[] = {
+    {Remote::Key::A, "A"},
+    {Remote::Key::B, "B"},
+    {Remote::Key::C, "C"},
+    {Remote::Key::D, "D"},
+    {Remote::Key::E, "E"},
+    {Remote::Key::F, "F"},
+    {Remote::Key::G, "G"},
+    {Remote::Key::Q, "Q"},
+    {Remote::Key::R, "R"},
+    {Remote::Key::S, "S"},
+    {Remote::Key::V, "V"},
+    {Remote::Key::W, "W"},
+    {Remote::Key::X, "X"},
+    {Remote::Key::Z, "Z"},
+    {Remote::Key::SHIFT, "SHIFT"},
+    {Remote::Key::CTRL, "CTRL"},
+};
+
 const std::vector<std::string> CommandMapperFormatGenerator::generateMappings() const
 {
     std::vector<std::string> out;
 
     for (std::size_t i = 0; i < mapper.getSize(); i++)
     {
-        const CommandMapping *mapping = mapper.getAtIndex(i);
-        out.push_back(
-            formattedRemoteMapState(mapping->getAssociatedRemoteMapState()) + ":\t" +
-            formattedMappedCommands(mapping->getAssociatedCommands()));
+        std::string mapping(formatMapping(i, nullptr, 0), '\0');
+        formatMapping(i, mapping.data(), mapping.size() + 1);
+        out.push_back(std::move(mapping));
     }
     return out;
 }
 
-const std::string CommandMapperFormatGenerator::formattedRemoteMapState(
-    const RemoteMapState &ms) const
+std::size_t CommandMapperFormatGenerator::formatMapping(
+    std::size_t index,
+    char *buffer,
+    std::size_t size) const
+{
+    TextWriter out(buffer, size);
+    if (index >= mapper.getSize())
+    {
+        return 0;
+    }
+
+    const CommandMapping *mapping = mapper.getAtIndex(index);
+    formatRemoteMapState(mapping->getAssociatedRemoteMapState(), out);
+
+    out << ":\t[";
+    const std::vector<Command *> &commands = mapping->getAssociatedCommands();
+    if (commands.empty())
+    {
+        out << "none";
+    }
+    for (std::size_t i = 0; i < commands.size(); i++)
+    {
+        out << (i == 0 ? "" : ", ") << commands[i]->getName();
+    }
+    out << "]";
+
+    return out.getLength();
+}
+
+std::size_t CommandMapperFormatGenerator::encodeMapping(
+    std::size_t index,
+    uint8_t *buffer,
+    std::size_t size) const
+{
+    if (index >= mapper.getSize())
+    {
+        return 0;
+    }
+
+    const CommandMapping *mapping = mapper.getAtIndex(index);
+    const RemoteMapState &ms = mapping->getAssociatedRemoteMapState();
+    const std::vector<Command *> &commands = mapping->getAssociatedCommands();
+    const std::size_t numCommands = std::min<std::size_t>(commands.size(), UINT8_MAX);
+    const std::size_t length = DESCRIPTOR_HEADER_LENGTH + 2 * numCommands;
+    if (buffer == nullptr || size < length)
+    {
+        return 0;
+    }
+
+    buffer[0] = ms.getKeys() & 0xff;
+    buffer[1] = ms.getKeys() >> 8;
+    buffer[2] = ms.getNegKeys() & 0xff;
+    buffer[3] = ms.getNegKeys() >> 8;
+    buffer[4] = (ms.getLMouseButton() ? 0b01 : 0) | (ms.getRMouseButton() ? 0b10 : 0);
+    buffer[5] = static_cast<uint8_t>(ms.getLSwitch());
+    buffer[6] = static_cast<uint8_t>(ms.getRSwitch());
+    buffer[7] = numCommands;
+    for (std::size_t i = 0; i < numCommands; i++)
+    {
+        const int id = commands[i]->getGlobalIdentifier();
+        buffer[DESCRIPTOR_HEADER_LENGTH + 2 * i] = id & 0xff;
+        buffer[DESCRIPTOR_HEADER_LENGTH + 2 * i + 1] = (id >> 8) & 0xff;
+    }
+    return length;
+}
+
+void CommandMapperFormatGenerator::formatRemoteMapState(const RemoteMapState &ms, TextWriter &out)
 {
-    std::string out = "[";
+    out << "[";
+    // Each part is preceded by a separator, except the first
+    const char *separator = "";
     if (ms.getKeys() != 0)
     {
-        out += "keys: ";
-        out += keyMapToString(ms.getKeys());
-        out += ", ";
+        out << separator << "keys: ";
+        formatKeys(ms.getKeys(), out);
+        separator = ", ";
     }
     if (ms.getNegKeys() != 0)
     {
-        out += "neg keys: ";
-        out += keyMapToString(ms.getNegKeys());
-        out += ", ";
+        out << separator << "neg keys: ";
+        formatKeys(ms.getNegKeys(), out);
+        separator = ", ";
     }
     if (ms.getLMouseButton())
     {
-        out += "left mouse pressed, ";
+        out << separator << "left mouse pressed";
+        separator = ", ";
     }
     if (ms.getRMouseButton())
     {
-        out += "right mouse pressed, ";
+        out << separator << "right mouse pressed";
+        separator = ", ";
     }
     if (ms.getLSwitch() != Remote::SwitchState::UNKNOWN)
     {
-        out += "left switch: ";
-        out += switchStateToString(ms.getLSwitch());
-        out += ", ";
+        out << separator << "left switch: " << switchStateToString(ms.getLSwitch());
+        separator = ", ";
     }
     if (ms.getRSwitch() != Remote::SwitchState::UNKNOWN)
     {
-        out += "right switch: ";
-        out += switchStateToString(ms.getRSwitch());
-        out += ", ";
+        out << separator << "right switch: " << switchStateToString(ms.getRSwitch());
+        separator = ", ";
     }
-    out = out.length() == 1 ? "[none" : out.substr(0, out.length() - 2);
-    return out + "]";
+    out << (*separator == '\0' ? "none]" : "]");
 }
 
-const std::string CommandMapperFormatGenerator::formattedMappedCommands(
-    const std::vector<Command *> mc) const
+void CommandMapperFormatGenerator::formatKeys(uint16_t keys, TextWriter &out)
 {
-    if (mc.size() == 0)
+    out << "{";
+    const char *separator = "";
+    for (const auto &keyName : KEY_NAMES)
     {
-        return "[none]";
+        if (keys & (1 << static_cast<int>(keyName.key)))
+        {
+            out << separator << keyName.name;
+            separator = ", ";
+        }
     }
-    std::string out = "[";
-    out += mc[0]->getName();
-    for (std::size_t i = 1; i < mc.size(); i++)
-    {
-        out += ", ";
-        out += mc[i]->getName();
-    }
-    return out + "]";
+    out << "}";
 }
 
-constexpr std::string_view CommandMapperFormatGenerator::switchStateToString(
-    Remote::SwitchState state) const
+const char *CommandMapperFormatGenerator::switchStateToString(Remote::SwitchState state)
 {
     switch (state)
     {
@@ -118,80 +239,5 @@ constexpr std::string_view CommandMapperFormatGenerator::switchStateToString(
             return "";
     }
 }
-
-const std::string CommandMapperFormatGenerator::keyMapToString(uint16_t keys) const
-{
-    if (keys == 0)
-    {
-        return "{ NONE }";
-    }
-    std::string out;
-    out = "{";
-    if (keys & (1 << static_cast<int>(Remote::Key::A)))
-    {
-        out += "A, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::B)))
-    {
-        out += "B, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::C)))
-    {
-        out += "C, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::D)))
-    {
-        out += "D, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::E)))
-    {
-        out += "E, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::F)))
-    {
-        out += "F, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::G)))
-    {
-        out += "G, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::Q)))
-    {
-        out += "Q, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::R)))
-    {
-        out += "R, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::S)))
-    {
-        out += "S, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::V)))
-    {
-        out += "V, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::W)))
-    {
-        out += "W, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::X)))
-    {
-        out += "X, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::Z)))
-    {
-        out += "Z, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::SHIFT)))
-    {
-        out += "SHIFT, ";
-    }
-    if (keys & (1 << static_cast<int>(Remote::Key::CTRL)))
-    {
-        out += "CTRL, ";
-    }
-    return out.substr(0, out.length() - 2) + "}";
-}
 }  // namespace control
 }  // namespace tap
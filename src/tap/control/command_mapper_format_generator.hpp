@@ -20,8 +20,9 @@
 #ifndef TAPROOT_COMMAND_MAPPER_FORMAT_GENERATOR_HPP_
 #define TAPROOT_COMMAND_MAPPER_FORMAT_GENERATOR_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <string_view>
 #include <vector>
 
 #include "tap/communication/serial/remote.hpp"
@@ -32,34 +33,65 @@ namespace control
 {
 class CommandMapper;
 class RemoteMapState;
-class Command;
 
 /**
  * A utility for generating a readable format of the current command mappings in a particular
- * CommandMapper.
+ * CommandMapper, or a compact binary one for host tools.
+ *
+ * `formatMapping` and `encodeMapping` write one mapping at a time into a buffer provided by the
+ * caller and don't allocate, so the terminal and display can inspect mappings at runtime.
  */
 class CommandMapperFormatGenerator
 {
 public:
+    /// Length of a binary descriptor without its command ids, see `encodeMapping`.
+    static constexpr std::size_t DESCRIPTOR_HEADER_LENGTH = 8;
+
     explicit CommandMapperFormatGenerator(const CommandMapper &mapper) : mapper(mapper) {}
     ~CommandMapperFormatGenerator() = default;
 
     /**
      * @return A list of mappings in string format, parsed from the CommandMapper
      *      passed into the class.
-     * @note This is very slow because of the necessary std::string parsing. Never
-     *      call this while performance matters.
+     * @note This allocates each string on the heap. Prefer `formatMapping` at runtime.
      */
     const std::vector<std::string> generateMappings() const;
 
+    /**
+     * Writes the readable format of one mapping into `buffer`, e.g.
+     * `[keys: {A, B}, left switch: down]:\t[command 1, command 2]`. Like `snprintf`, the text is
+     * truncated to fit and always null terminated when `size` isn't 0.
+     *
+     * @param[in] index The index of the mapping in the CommandMapper.
+     * @return The length of the full text, excluding the null terminator, so the text was
+     *      truncated if this is at least `size`. 0 if `index` is out of range.
+     */
+    std::size_t formatMapping(std::size_t index, char *buffer, std::size_t size) const;
+
+    /**
+     * Writes a compact binary descriptor of one mapping into `buffer`. Multi-byte fields are
+     * little endian:
+     *
+     * - `uint16_t` keys, a bit for each `Remote::Key`
+     * - `uint16_t` neg keys
+     * - `uint8_t` flags: bit 0 set if the left mouse button is mapped, bit 1 the right
+     * - `uint8_t` left `Remote::SwitchState`, `uint8_t` right `Remote::SwitchState`
+     * - `uint8_t` number of commands, followed by each command's `uint16_t` global identifier
+     *
+     * @return The length of the descriptor, or 0 if `index` is out of range or the buffer is too
+     *      small.
+     */
+    std::size_t encodeMapping(std::size_t index, uint8_t *buffer, std::size_t size) const;
+
 private:
+    /// Appends text to a fixed buffer, counting what doesn't fit.
+    class TextWriter;
+
     const CommandMapper &mapper;
 
-    const std::string formattedRemoteMapState(const RemoteMapState &ms) const;
-    const std::string formattedMappedCommands(const std::vector<Command *> mc) const;
-    constexpr std::string_view switchStateToString(
-        tap::communication::serial::Remote::SwitchState state) const;
-    const std::string keyMapToString(uint16_t keys) const;
+    static void formatRemoteMapState(const RemoteMapState &ms, TextWriter &out);
+    static void formatKeys(uint16_t keys, TextWriter &out);
+    static const char *switchStateToString(tap::communication::serial::Remote::SwitchState state);
 };  // class CommandMapperFormatGenerator
 }  // namespace control
 }  // namespace tap
@@ -80,6 +80,25 @@ class CommandMapping
      */
     virtual void executeCommandMapping(const RemoteMapState &currState) = 0;
 
+    /**
+     * @return `true` if executing this mapping again with an unchanged remote state does nothing,
+     *      so the CommandMapper may skip it until one of the inputs its `mapState` reads changes.
+     *      `false` by default, for mappings that also act on the scheduler's state or on time.
+     */
+    virtual bool reactsOnlyToInputChanges() const { return false; }
+
+    /**
+     * Called by `CommandMapper::update` every tick for mappings whose `isUpdatedEachTick` is
+     * `true`, so mappings can act on time as well as on remote input. Does nothing by default.
+     */
+    virtual void update() {}
+
+    /**
+     * @return `true` if `update` should be called every tick. Read once when the mapping is
+     *      added to the `CommandMapper`. `false` by default.
+     */
+    virtual bool isUpdatedEachTick() const { return false; }
+
     /**
      * @return `true` if `this`'s `mapState` is a subset of the passed in
      *      `mapState`. Returns `false` otherwise.
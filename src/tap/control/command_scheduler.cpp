@@ -19,13 +19,21 @@
 
 #include "command_scheduler.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+#include "tap/algorithms/math_user_utils.hpp"
 #include "tap/architecture/clock.hpp"
+#include "tap/architecture/memory_placement.hpp"
+#include "tap/architecture/trace_ring.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
 #include "modm/architecture/interface/assert.hpp"
 
 #include "command.hpp"
+#include "scheduler_profile.hpp"
 #include "subsystem.hpp"
 
 using namespace tap::errors;
@@ -34,30 +42,54 @@ namespace tap
 {
 namespace control
 {
-bool CommandScheduler::masterSchedulerExists = false;
-Subsystem *CommandScheduler::globalSubsystemRegistrar[CommandScheduler::MAX_SUBSYSTEM_COUNT];
-Command *CommandScheduler::globalCommandRegistrar[CommandScheduler::MAX_COMMAND_COUNT];
-int CommandScheduler::maxSubsystemIndex = 0;
-int CommandScheduler::maxCommandIndex = 0;
+// Constant initialized, so Commands and Subsystems constructed during static initialization can
+// register themselves. Read every tick, so placed in CCM RAM when enabled.
+TAP_CCM_DATA CommandScheduler::Registry CommandScheduler::defaultRegistry;
+#ifdef PLATFORM_HOSTED
+CommandScheduler::Registry *CommandScheduler::activeRegistry = &CommandScheduler::defaultRegistry;
+#endif
 SafeDisconnectFunction CommandScheduler::defaultSafeDisconnectFunction;
+char CommandScheduler::overrunErrorDescription[64];
+char CommandScheduler::degradedErrorDescription[64];
+
+void CommandScheduler::ExecutionTimeStats::reset()
+{
+    minCycles = UINT32_MAX;
+    maxCycles = 0;
+    lastCycles = 0;
+    avgCycles = 0;
+}
+
+void CommandScheduler::ExecutionTimeStats::update(uint32_t cycles)
+{
+    // Seed the average with the first measurement so it doesn't slowly ramp up from 0
+    avgCycles = isEmpty() ? cycles
+                          : algorithms::lowPassFilter(avgCycles, cycles, AVG_LOW_PASS_ALPHA);
+    minCycles = std::min(minCycles, cycles);
+    maxCycles = std::max(maxCycles, cycles);
+    lastCycles = cycles;
+}
 
 int CommandScheduler::constructCommand(Command *command)
 {
+    Registry &reg = registry();
+
     modm_assert(command != nullptr, "CommandScheduer::constructCommand", "called with nullptr cmd");
 
     modm_assert(
-        maxCommandIndex < MAX_COMMAND_COUNT,
+        reg.maxCommandIndex < MAX_COMMAND_COUNT,
         "CommandScheduler::constructCommand",
         "Too many commands constructed!");
 
     // Loop through the globalCommandRegistrar, find the lowest nullptr index
     for (int i = 0; i < MAX_COMMAND_COUNT; i++)
     {
-        if (globalCommandRegistrar[i] == nullptr)
+        if (reg.globalCommandRegistrar[i] == nullptr)
         {
             // Update max index if need be
-            maxCommandIndex = std::max(maxCommandIndex, i + 1);
-            globalCommandRegistrar[i] = command;
+            reg.maxCommandIndex = std::max(reg.maxCommandIndex, i + 1);
+            reg.globalCommandRegistrar[i] = command;
+            reg.globalCommandExecutionTimeStats[i].reset();
             return i;
         }
     }
@@ -68,24 +100,28 @@ int CommandScheduler::constructCommand(Command *command)
 
 int CommandScheduler::constructSubsystem(Subsystem *subsystem)
 {
+    Registry &reg = registry();
+
     modm_assert(
         subsystem != nullptr,
         "CommandScheduer::constructSubsystem",
         "called with nullptr sub");
 
     modm_assert(
-        maxSubsystemIndex < MAX_SUBSYSTEM_COUNT,
+        reg.maxSubsystemIndex < MAX_SUBSYSTEM_COUNT,
         "CommandScheduler::constructSubsystem",
         "Too many subsystems constructed!");
 
     // Loop through the globalSubsystemRegistrar, find the lowest nullptr index
     for (int i = 0; i < MAX_SUBSYSTEM_COUNT; i++)
     {
-        if (globalSubsystemRegistrar[i] == nullptr)
+        if (reg.globalSubsystemRegistrar[i] == nullptr)
         {
             // Update max index if need be
-            maxSubsystemIndex = std::max(maxSubsystemIndex, i + 1);
-            globalSubsystemRegistrar[i] = subsystem;
+            reg.maxSubsystemIndex = std::max(reg.maxSubsystemIndex, i + 1);
+            reg.globalSubsystemRegistrar[i] = subsystem;
+            reg.globalSubsystemExecutionTimeStats[i].reset();
+            reg.globalSubsystemRefreshPolicy[i] = RefreshPolicy();
             return i;
         }
     }
@@ -96,6 +132,8 @@ int CommandScheduler::constructSubsystem(Subsystem *subsystem)
 
 void CommandScheduler::destructCommand(Command *command)
 {
+    Registry &reg = registry();
+
     modm_assert(command != nullptr, "CommandScheduer::destructCommand", "called with nullptr cmd");
 
     auto cmdId = command->getGlobalIdentifier();
@@ -105,15 +143,17 @@ void CommandScheduler::destructCommand(Command *command)
         "CommandScheduler::destructCommand",
         "Trying to destruct command with invalid identifier");
 
-    globalCommandRegistrar[cmdId] = nullptr;
-    if (cmdId == maxCommandIndex - 1)
+    reg.globalCommandRegistrar[cmdId] = nullptr;
+    if (cmdId == reg.maxCommandIndex - 1)
     {
-        maxCommandIndex--;
+        reg.maxCommandIndex--;
     }
 }
 
 void CommandScheduler::destructSubsystem(Subsystem *subsystem)
 {
+    Registry &reg = registry();
+
     modm_assert(
         subsystem != nullptr,
         "CommandScheduer::destructSubsystem",
@@ -125,10 +165,18 @@ void CommandScheduler::destructSubsystem(Subsystem *subsystem)
         "CommandScheduler::destructSubsystem",
         "Trying to destruct subsystem with invalid identifier");
 
-    globalSubsystemRegistrar[subId] = nullptr;
-    if (subId == maxSubsystemIndex - 1)
+    reg.globalSubsystemRegistrar[subId] = nullptr;
+    if (subId == reg.maxSubsystemIndex - 1)
+    {
+        reg.maxSubsystemIndex--;
+    }
+
+    // The identifier is reused by the next subsystem constructed, which must be registered
+    // before the master scheduler refreshes it
+    if (reg.masterScheduler != nullptr)
     {
-        maxSubsystemIndex--;
+        reg.masterScheduler->registeredSubsystemBitmap.reset(subId);
+        removeFromRefreshTimetable(subId);
     }
 }
 
@@ -139,7 +187,7 @@ CommandScheduler::CommandScheduler(
     : drivers(drivers),
       safeDisconnectFunction(safeDisconnectFunction)
 {
-    if (masterScheduler && masterSchedulerExists)
+    if (masterScheduler && registry().masterScheduler != nullptr)
     {
         RAISE_ERROR(drivers, "master scheduler already exists");
     }
@@ -148,7 +196,8 @@ CommandScheduler::CommandScheduler(
         isMasterScheduler = masterScheduler;
         if (masterScheduler)
         {
-            masterSchedulerExists = true;
+            registry().masterScheduler = this;
+            registry().subsystemRefreshOrderSize = 0;
         }
     }
 }
@@ -157,94 +206,311 @@ CommandScheduler::~CommandScheduler()
 {
     if (isMasterScheduler)
     {
-        masterSchedulerExists = false;
+        registry().masterScheduler = nullptr;
+        registry().subsystemRefreshOrderSize = 0;
     }
 }
 
 void CommandScheduler::run()
 {
-#ifndef PLATFORM_HOSTED
     uint32_t runStart = arch::clock::getTimeMicroseconds();
-#endif
+
+    worstOffenderName = nullptr;
+    worstOffenderCycles = 0;
+
+    // Latch the disconnected state so it is consistent for the whole tick and the function,
+    // which usually checks the remote, is only called once
+    safeDisconnectedThisRun = safeDisconnectFunction->operator()();
+    running = true;
+
+    // Read sensors before commands execute, so commands act on this tick's measurements
+    refreshSubsystems(RefreshStage::SENSORS);
 
     if (safeDisconnected())
     {
         // End all commands running. They were interrupted by the remote disconnecting.
-        for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
-        {
-            removeCommand(*it, true);
-        }
+        pendingRemovals |= addedCommandBitmap;
+        pendingInterruptions |= addedCommandBitmap;
     }
     else
     {
-        // Execute commands in the addedCommandBitmap, remove any that are finished
-        for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
+        // Execute commands in the addedCommandBitmap, queue any that are finished for removal
+        for (auto it = cmdMapBegin(), end = cmdMapEnd(); it != end; ++it)
         {
-            (*it)->execute();
-            if ((*it)->isFinished())
+            if (pendingRemovals.test((*it)->getGlobalIdentifier()))
             {
-                removeCommand(*it, false);
+                // Removed by a command executed earlier this run
+                continue;
             }
-        }
-    }
 
-    // Only refresh subsystems if this is the master scheduler
-    if (isMasterScheduler)
-    {
-        // Refresh subsystems in the registeredSubsystemBitmap
-        for (auto it = subMapBegin(); it != subMapEnd(); it++)
-        {
-            Command *testCommand;
-            if (!safeDisconnected() &&
-                !(subsystemsAssociatedWithCommandBitmap &
-                  (LSB_ONE_HOT_SUBSYSTEM_BITMAP << (*it)->getGlobalIdentifier())) &&
-                (testCommand = (*it)->getTestCommand()) != nullptr)
-            {
-                if (testCommand->isFinished())
-                {
-                    this->subsystemsPassingHardwareTests |=
-                        (LSB_ONE_HOT_SUBSYSTEM_BITMAP << (*it)->getGlobalIdentifier());
-                }
-            }
+            TimeBudget &budget = (*it)->getTimeBudget();
+            const bool measure = executionTimeAccountingEnabled || budget.isSet();
+            uint32_t executeStart = measure ? arch::clock::getCycleCount() : 0;
 
-            // Call appropriate refresh function for each of the subsystems
-            if (safeDisconnected())
+            TRACE_EVENT(arch::TraceEventId::COMMAND_EXECUTE, (*it)->getGlobalIdentifier());
+            if (budget.isDegraded())
             {
-                (*it)->refreshSafeDisconnect();
+                (*it)->executeDegraded();
             }
             else
             {
-                (*it)->refresh();
+                (*it)->execute();
+            }
+            bool finished = (*it)->checkFinished();
+
+            if (measure)
+            {
+                uint32_t cycles = arch::clock::getCycleCount() - executeStart;
+                if (executionTimeAccountingEnabled)
+                {
+                    registry()
+                        .globalCommandExecutionTimeStats[(*it)->getGlobalIdentifier()]
+                        .update(cycles);
+                    updateWorstOffender((*it)->getName(), cycles);
+                }
+                if (budget.update(cycles))
+                {
+                    reportDegraded((*it)->getName(), cycles);
+                }
             }
 
-            Command *defaultCmd;
-            // If the remote is connected given the scheduler is in safe disconnect mode and
-            // the current subsystem does not have an associated command and the current
-            // subsystem has a default command, add it
-            if (!safeDisconnected() &&
-                !(subsystemsAssociatedWithCommandBitmap &
-                  (LSB_ONE_HOT_SUBSYSTEM_BITMAP << (*it)->getGlobalIdentifier())) &&
-                ((defaultCmd = (*it)->getDefaultCommand()) != nullptr))
+            if (finished)
             {
-                addCommand(defaultCmd);
+                removeCommand(*it, false);
             }
         }
     }
 
+    // Apply the removals and additions requested while commands executed in one pass, so ended
+    // commands' outputs are picked up by this tick's refresh
+    commitCommandChanges();
+
+    refreshSubsystems(RefreshStage::CONTROL);
+
+    // Commit anything queued by subsystem refreshes before choosing default commands
+    commitCommandChanges();
+    scheduleDefaultCommands();
+    if (isMasterScheduler)
+    {
+        registry().tickCount++;
+    }
+
+    running = false;
+    lastRunTime = arch::clock::getTimeMicroseconds() - runStart;
+
 #ifndef PLATFORM_HOSTED
     // make sure we are not going over tolerable runtime, otherwise something is really
     // wrong with the code
-    if (arch::clock::getTimeMicroseconds() - runStart > MAX_ALLOWABLE_SCHEDULER_RUNTIME)
+    if (lastRunTime > MAX_ALLOWABLE_SCHEDULER_RUNTIME)
     {
         // shouldn't take more than MAX_ALLOWABLE_SCHEDULER_RUNTIME microseconds
         // to complete all this stuff, if it does something
         // is seriously wrong (i.e. you are adding subsystems unchecked or the scheduler
         // itself is broken).
         RAISE_ERROR(drivers, "scheduler took longer than MAX_ALLOWABLE_SCHEDULER_RUNTIME");
+
+        if (executionTimeAccountingEnabled && worstOffenderName != nullptr)
+        {
+            snprintf(
+                overrunErrorDescription,
+                sizeof(overrunErrorDescription),
+                "scheduler overrun, worst: %s (%lu cycles)",
+                worstOffenderName,
+                static_cast<unsigned long>(worstOffenderCycles));
+            RAISE_ERROR(drivers, overrunErrorDescription);
+        }
     }
 #endif
 }
 
+void CommandScheduler::refreshSubsystems(RefreshStage stage)
+{
+    // Only the master scheduler and partition schedulers refresh subsystems
+    if (isMasterScheduler)
+    {
+        // Refresh subsystems in the order specified by the refresh timetable
+        for (int i = 0; i < registry().subsystemRefreshOrderSize; i++)
+        {
+            const int subId = registry().subsystemRefreshOrder[i];
+            Subsystem *sub = registry().globalSubsystemRegistrar[subId];
+            if (sub == nullptr)
+            {
+                continue;
+            }
+            if (stage == RefreshStage::SENSORS)
+            {
+                refreshSubsystemSensors(sub, subId);
+            }
+            else
+            {
+                refreshSubsystem(sub, subId);
+            }
+        }
+    }
+    else if (refreshesOwnSubsystems)
+    {
+        for (int subId = registeredSubsystemBitmap.findNextSetBit(0); subId >= 0;
+             subId = registeredSubsystemBitmap.findNextSetBit(subId + 1))
+        {
+            Subsystem *sub = registry().globalSubsystemRegistrar[subId];
+            if (sub == nullptr)
+            {
+                continue;
+            }
+            if (stage == RefreshStage::SENSORS)
+            {
+                refreshSubsystemSensors(sub, subId);
+            }
+            else
+            {
+                refreshSubsystem(sub, subId);
+            }
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    if (stage == RefreshStage::CONTROL)
+    {
+        refreshTick++;
+    }
+}
+
+void CommandScheduler::refreshSubsystemSensors(Subsystem *sub, int subId)
+{
+    const RefreshPolicy &policy = registry().globalSubsystemRefreshPolicy[subId];
+    if (refreshTick % policy.divider != policy.phase)
+    {
+        return;
+    }
+
+    const bool measure = executionTimeAccountingEnabled || sub->getTimeBudget().isSet();
+    uint32_t refreshStart = measure ? arch::clock::getCycleCount() : 0;
+
+    sub->refreshSensors();
+
+    sensorRefreshCycles[subId] = measure ? arch::clock::getCycleCount() - refreshStart : 0;
+}
+
+void CommandScheduler::refreshSubsystem(Subsystem *sub, int subId)
+{
+    const RefreshPolicy &policy = registry().globalSubsystemRefreshPolicy[subId];
+
+    // Rate divided subsystems are only refreshed on ticks matching their phase
+    if (refreshTick % policy.divider == policy.phase)
+    {
+        TimeBudget &budget = sub->getTimeBudget();
+        const bool measure = executionTimeAccountingEnabled || budget.isSet();
+        uint32_t refreshStart = measure ? arch::clock::getCycleCount() : 0;
+
+        // Call appropriate refresh function for each of the subsystems
+        if (safeDisconnected())
+        {
+            sub->refreshSafeDisconnect();
+        }
+        else if (budget.isDegraded())
+        {
+            sub->refreshDegraded();
+            sub->refreshActuators();
+        }
+        else
+        {
+            sub->refresh();
+            sub->refreshActuators();
+        }
+
+        if (measure)
+        {
+            uint32_t cycles =
+                arch::clock::getCycleCount() - refreshStart + sensorRefreshCycles[subId];
+            sensorRefreshCycles[subId] = 0;
+            if (executionTimeAccountingEnabled)
+            {
+                registry().globalSubsystemExecutionTimeStats[subId].update(cycles);
+                updateWorstOffender(sub->getName(), cycles);
+            }
+            if (!safeDisconnected() && budget.update(cycles))
+            {
+                reportDegraded(sub->getName(), cycles);
+            }
+        }
+    }
+}
+
+void CommandScheduler::commitCommandChanges()
+{
+    const command_scheduler_bitmap_t removals = pendingRemovals;
+    const command_scheduler_bitmap_t interruptions = pendingInterruptions;
+    pendingRemovals = command_scheduler_bitmap_t();
+    pendingInterruptions = command_scheduler_bitmap_t();
+    for (int id = removals.findNextSetBit(0); id >= 0; id = removals.findNextSetBit(id + 1))
+    {
+        Command *command = registry().globalCommandRegistrar[id];
+        if (command != nullptr && isCommandScheduled(command))
+        {
+            endCommand(command, interruptions.test(id));
+        }
+    }
+
+    // Commands queued by the initialize of the commands added here wait for the next commit
+    const command_scheduler_bitmap_t additions = pendingAdditions;
+    pendingAdditions = command_scheduler_bitmap_t();
+    for (int id = additions.findNextSetBit(0); id >= 0; id = additions.findNextSetBit(id + 1))
+    {
+        Command *command = registry().globalCommandRegistrar[id];
+        if (command != nullptr)
+        {
+            startCommand(command);
+        }
+    }
+}
+
+void CommandScheduler::scheduleDefaultCommands()
+{
+    // Only the master scheduler and partition schedulers manage their subsystems' defaults
+    if ((!isMasterScheduler && !refreshesOwnSubsystems) || safeDisconnected())
+    {
+        return;
+    }
+
+    const subsystem_scheduler_bitmap_t idle =
+        registeredSubsystemBitmap & ~subsystemsAssociatedWithCommandBitmap;
+    for (int subId = idle.findNextSetBit(0); subId >= 0; subId = idle.findNextSetBit(subId + 1))
+    {
+        Subsystem *sub = registry().globalSubsystemRegistrar[subId];
+        // A default command added earlier in this loop may require this subsystem too
+        if (sub == nullptr || subsystemsAssociatedWithCommandBitmap.test(subId))
+        {
+            continue;
+        }
+
+        Command *testCommand = sub->getTestCommand();
+        if (testCommand != nullptr && testCommand->isFinished())
+        {
+            this->subsystemsPassingHardwareTests.set(subId);
+        }
+
+        Command *defaultCmd = sub->getDefaultCommand();
+        if (defaultCmd != nullptr)
+        {
+            startCommand(defaultCmd);
+        }
+    }
+}
+
+void CommandScheduler::reportDegraded(const char *name, uint32_t cycles)
+{
+    snprintf(
+        degradedErrorDescription,
+        sizeof(degradedErrorDescription),
+        "over time budget, degraded: %s (%lu cycles)",
+        name,
+        static_cast<unsigned long>(cycles));
+    RAISE_ERROR(drivers, degradedErrorDescription);
+}
+
 void CommandScheduler::addCommand(Command *commandToAdd)
 {
     if (safeDisconnected())
@@ -256,7 +522,19 @@ void CommandScheduler::addCommand(Command *commandToAdd)
         RAISE_ERROR(drivers, "attempting to add nullptr command");
         return;
     }
-    else if (!commandToAdd->isReady())
+    else if (running)
+    {
+        // Don't change the commands being iterated over, add it once they have all executed
+        pendingAdditions.set(commandToAdd->getGlobalIdentifier());
+        return;
+    }
+
+    startCommand(commandToAdd);
+}
+
+void CommandScheduler::startCommand(Command *commandToAdd)
+{
+    if (!commandToAdd->isReady())
     {
         // Do not add command if it is not ready to be scheduled.
         return;
@@ -266,7 +544,7 @@ void CommandScheduler::addCommand(Command *commandToAdd)
 
     // Check to see if all the requirements are in the subsytemToCommandMap
     if ((requirementsBitwise & registeredSubsystemBitmap) != requirementsBitwise ||
-        requirementsBitwise == static_cast<subsystem_scheduler_bitmap_t>(0))
+        requirementsBitwise.none())
     {
         // the command you are trying to add has a subsystem that is not in the
         // scheduler, so you cannot add it (will lead to undefined control behavior)
@@ -275,27 +553,94 @@ void CommandScheduler::addCommand(Command *commandToAdd)
     }
 
     // End all commands running that used the subsystem requirements. They were interrupted.
-    for (auto it = cmdMapBegin(); it != cmdMapEnd(); it++)
+    // Each conflicting subsystem maps directly to the command that owns it, and removing the
+    // owner clears all of its requirements, so only one lookup per conflicting command is needed.
+    subsystem_scheduler_bitmap_t conflicts;
+    while ((conflicts = requirementsBitwise & subsystemsAssociatedWithCommandBitmap).any())
     {
-        // Does this command's requierments intersect the new command?
-        if (((*it)->getRequirementsBitwise() & requirementsBitwise) !=
-            static_cast<subsystem_scheduler_bitmap_t>(0))
+        const int subId = conflicts.findNextSetBit(0);
+        Command *owner = registry().globalCommandRegistrar[subsystemOwners[subId]];
+        if (owner != nullptr && isCommandScheduled(owner))
         {
-            removeCommand(*it, true);
+            endCommand(owner, true);
         }
+
+        // The owner's requirements may have changed since it was added, so make sure the
+        // subsystem is freed regardless
+        subsystemsAssociatedWithCommandBitmap.reset(subId);
     }
 
-    // Add the subsystem requirements to the subsystems associated with command bitmap
+    // Add the subsystem requirements to the subsystems associated with command bitmap and
+    // record the new command as the owner of each of them
     subsystemsAssociatedWithCommandBitmap |= requirementsBitwise;
+    for (int subId = requirementsBitwise.findNextSetBit(0); subId >= 0;
+         subId = requirementsBitwise.findNextSetBit(subId + 1))
+    {
+        subsystemOwners[subId] = commandToAdd->getGlobalIdentifier();
+    }
+    TRACE_EVENT(arch::TraceEventId::COMMAND_INITIALIZE, commandToAdd->getGlobalIdentifier());
+    commandToAdd->clearFinishRequest();
+    // Give a command degraded during a previous run another chance at its normal mode
+    commandToAdd->getTimeBudget().restore();
     commandToAdd->initialize();
     // Add the command to the command bitmap
-    addedCommandBitmap |= LSB_ONE_HOT_COMMAND_BITMAP << commandToAdd->getGlobalIdentifier();
+    addedCommandBitmap.set(commandToAdd->getGlobalIdentifier());
+}
+
+void CommandScheduler::switchToProfile(const SchedulerProfile &profile)
+{
+    if (safeDisconnected())
+    {
+        return;
+    }
+    activeProfile = &profile;
+
+    const command_scheduler_bitmap_t toEnd = addedCommandBitmap & ~profile.getCommandBitmap();
+    for (int id = toEnd.findNextSetBit(0); id >= 0; id = toEnd.findNextSetBit(id + 1))
+    {
+        Command *command = registry().globalCommandRegistrar[id];
+        if (command == nullptr)
+        {
+            continue;
+        }
+
+        // Keep default commands of subsystems the profile leaves alone running, rather than
+        // ending them only for the next run to add them again
+        const subsystem_scheduler_bitmap_t requirements = command->getRequirementsBitwise();
+        bool isUnaffectedDefault = false;
+        if ((requirements & profile.getRequirementsBitwise()).none())
+        {
+            for (int subId = requirements.findNextSetBit(0); subId >= 0;
+                 subId = requirements.findNextSetBit(subId + 1))
+            {
+                const Subsystem *sub = registry().globalSubsystemRegistrar[subId];
+                if (sub != nullptr && sub->getDefaultCommand() == command)
+                {
+                    isUnaffectedDefault = true;
+                    break;
+                }
+            }
+        }
+
+        if (!isUnaffectedDefault)
+        {
+            removeCommand(command, true);
+        }
+    }
+
+    const command_scheduler_bitmap_t toAdd = profile.getCommandBitmap() & ~addedCommandBitmap;
+    for (int id = toAdd.findNextSetBit(0); id >= 0; id = toAdd.findNextSetBit(id + 1))
+    {
+        if (registry().globalCommandRegistrar[id] != nullptr)
+        {
+            addCommand(registry().globalCommandRegistrar[id]);
+        }
+    }
 }
 
 bool CommandScheduler::isCommandScheduled(const Command *command) const
 {
-    return command != nullptr &&
-           (addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << command->getGlobalIdentifier()));
+    return command != nullptr && addedCommandBitmap.test(command->getGlobalIdentifier());
 }
 
 void CommandScheduler::removeCommand(Command *command, bool interrupted)
@@ -305,18 +650,75 @@ void CommandScheduler::removeCommand(Command *command, bool interrupted)
         RAISE_ERROR(drivers, "trying to remove nullptr command");
         return;
     }
-    else if (!isCommandScheduled(command))
+
+    if (running)
     {
+        // Don't change the commands being iterated over, end it once they have all executed
+        const int id = command->getGlobalIdentifier();
+        pendingAdditions.reset(id);
+        if (isCommandScheduled(command) && !pendingRemovals.test(id))
+        {
+            pendingRemovals.set(id);
+            if (interrupted)
+            {
+                pendingInterruptions.set(id);
+            }
+        }
         return;
     }
+    else if (isCommandScheduled(command))
+    {
+        endCommand(command, interrupted);
+    }
+}
 
+void CommandScheduler::endCommand(Command *command, bool interrupted)
+{
+    TRACE_EVENT(arch::TraceEventId::COMMAND_END, command->getGlobalIdentifier());
     command->end(interrupted);
 
     // Remove all subsystem requirements from the subsystem associated with command bitmap
     subsystemsAssociatedWithCommandBitmap &= ~command->getRequirementsBitwise();
 
     // Remove the command from the command bitmap
-    addedCommandBitmap &= ~(LSB_ONE_HOT_COMMAND_BITMAP << command->getGlobalIdentifier());
+    addedCommandBitmap.reset(command->getGlobalIdentifier());
+}
+
+void CommandScheduler::setExecutionTimeAccountingEnabled(bool enabled)
+{
+    if (enabled)
+    {
+        arch::clock::enableCycleCounter();
+    }
+    executionTimeAccountingEnabled = enabled;
+}
+
+CommandScheduler::ExecutionTimeStats CommandScheduler::getCommandExecutionTimeStats(
+    const Command *command)
+{
+    return command == nullptr
+               ? ExecutionTimeStats()
+               : registry().globalCommandExecutionTimeStats[command->getGlobalIdentifier()];
+}
+
+CommandScheduler::ExecutionTimeStats CommandScheduler::getSubsystemExecutionTimeStats(
+    const Subsystem *subsystem)
+{
+    return subsystem == nullptr
+               ? ExecutionTimeStats()
+               : registry().globalSubsystemExecutionTimeStats[subsystem->getGlobalIdentifier()];
+}
+
+void CommandScheduler::resetExecutionTimeStats()
+{
+    for (int i = 0; i < MAX_COMMAND_COUNT; i++)
+    {
+        registry().globalCommandExecutionTimeStats[i].reset();
+    }
+    for (int i = 0; i < MAX_SUBSYSTEM_COUNT; i++)
+    {
+        registry().globalSubsystemExecutionTimeStats[i].reset();
+    }
 }
 
 void CommandScheduler::setSafeDisconnectFunction(SafeDisconnectFunction *func)
@@ -324,9 +726,17 @@ void CommandScheduler::setSafeDisconnectFunction(SafeDisconnectFunction *func)
     this->safeDisconnectFunction = func;
 }
 
-bool CommandScheduler::safeDisconnected() { return this->safeDisconnectFunction->operator()(); }
+bool CommandScheduler::safeDisconnected()
+{
+    return running ? safeDisconnectedThisRun : this->safeDisconnectFunction->operator()();
+}
 
 void CommandScheduler::registerSubsystem(Subsystem *subsystem)
+{
+    CommandScheduler::registerSubsystem(subsystem, RefreshPolicy());
+}
+
+void CommandScheduler::registerSubsystem(Subsystem *subsystem, RefreshPolicy policy)
 {
     if (subsystem == nullptr)
     {
@@ -336,19 +746,148 @@ void CommandScheduler::registerSubsystem(Subsystem *subsystem)
     {
         RAISE_ERROR(drivers, "subsystem is already added");
     }
+    else if (
+        policy.divider == 0 ||
+        (policy.phase != RefreshPolicy::AUTO_PHASE && policy.phase >= policy.divider))
+    {
+        RAISE_ERROR(drivers, "invalid subsystem refresh policy");
+    }
     else
     {
         // Add the subsystem to the registered subsystem bitmap
-        registeredSubsystemBitmap |=
-            (LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier());
+        registeredSubsystemBitmap.set(subsystem->getGlobalIdentifier());
+
+        if (isMasterScheduler)
+        {
+            registry().globalSubsystemRefreshPolicy[subsystem->getGlobalIdentifier()] = policy;
+            addToRefreshTimetable(subsystem->getGlobalIdentifier());
+        }
+        else if (refreshesOwnSubsystems)
+        {
+            // Partitions have no refresh timetable, so stagger automatic phases by the order
+            // subsystems were registered in
+            if (policy.phase == RefreshPolicy::AUTO_PHASE)
+            {
+                policy.phase = (registeredSubsystemBitmap.count() - 1) % policy.divider;
+            }
+            registry().globalSubsystemRefreshPolicy[subsystem->getGlobalIdentifier()] = policy;
+        }
     }
 }
 
+RefreshPolicy CommandScheduler::getSubsystemRefreshPolicy(const Subsystem *subsystem)
+{
+    return subsystem == nullptr
+               ? RefreshPolicy()
+               : registry().globalSubsystemRefreshPolicy[subsystem->getGlobalIdentifier()];
+}
+
+void CommandScheduler::addToRefreshTimetable(int subsystemId)
+{
+    Registry &reg = registry();
+
+    for (int i = 0; i < reg.subsystemRefreshOrderSize; i++)
+    {
+        if (reg.subsystemRefreshOrder[i] == subsystemId)
+        {
+            return;
+        }
+    }
+
+    RefreshPolicy &policy = reg.globalSubsystemRefreshPolicy[subsystemId];
+
+    if (policy.phase == RefreshPolicy::AUTO_PHASE)
+    {
+        policy.phase = findLeastLoadedPhase(policy.divider);
+    }
+
+    // Insertion sort the subsystem into the timetable, keeping subsystems with equal priority
+    // in order of global identifier
+    int insertIndex = reg.subsystemRefreshOrderSize;
+    while (insertIndex > 0)
+    {
+        const int prevId = reg.subsystemRefreshOrder[insertIndex - 1];
+        const uint8_t prevPriority = reg.globalSubsystemRefreshPolicy[prevId].priority;
+        if (prevPriority > policy.priority ||
+            (prevPriority == policy.priority && prevId < subsystemId))
+        {
+            break;
+        }
+        reg.subsystemRefreshOrder[insertIndex] = reg.subsystemRefreshOrder[insertIndex - 1];
+        insertIndex--;
+    }
+    reg.subsystemRefreshOrder[insertIndex] = subsystemId;
+    reg.subsystemRefreshOrderSize++;
+}
+
+void CommandScheduler::removeFromRefreshTimetable(int subsystemId)
+{
+    Registry &reg = registry();
+
+    int removeIndex = 0;
+    while (removeIndex < reg.subsystemRefreshOrderSize &&
+           reg.subsystemRefreshOrder[removeIndex] != subsystemId)
+    {
+        removeIndex++;
+    }
+    if (removeIndex == reg.subsystemRefreshOrderSize)
+    {
+        return;
+    }
+
+    // Shift the later entries down, keeping the timetable sorted
+    for (int i = removeIndex + 1; i < reg.subsystemRefreshOrderSize; i++)
+    {
+        reg.subsystemRefreshOrder[i - 1] = reg.subsystemRefreshOrder[i];
+    }
+    reg.subsystemRefreshOrderSize--;
+}
+
+uint8_t CommandScheduler::findLeastLoadedPhase(uint8_t divider)
+{
+    Registry &reg = registry();
+
+    if (divider == 1)
+    {
+        return 0;
+    }
+
+    uint8_t bestPhase = 0;
+    float bestLoad = INFINITY;
+    for (int phase = 0; phase < divider; phase++)
+    {
+        // Sum the fraction of ticks that other rate divided subsystems are refreshed on, for
+        // subsystems that will ever be refreshed on the same tick as this phase. Ticks t with
+        // t % divider == phase and t % other.divider == other.phase exist iff phase and
+        // other.phase are congruent modulo gcd(divider, other.divider).
+        float load = 0;
+        for (int i = 0; i < reg.subsystemRefreshOrderSize; i++)
+        {
+            const RefreshPolicy &other =
+                reg.globalSubsystemRefreshPolicy[reg.subsystemRefreshOrder[i]];
+            if (other.divider > 1)
+            {
+                const int g = std::gcd(static_cast<int>(divider), static_cast<int>(other.divider));
+                if (phase % g == other.phase % g)
+                {
+                    load += 1.0f / other.divider;
+                }
+            }
+        }
+
+        if (load < bestLoad)
+        {
+            bestLoad = load;
+            bestPhase = phase;
+        }
+    }
+    return bestPhase;
+}
+
 bool CommandScheduler::isSubsystemRegistered(const Subsystem *subsystem) const
 {
     return subsystem != nullptr &&
-           ((LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier()) &
-            registeredSubsystemBitmap);
+           registeredSubsystemBitmap.test(subsystem->getGlobalIdentifier());
 }
 
 void CommandScheduler::runAllHardwareTests()
@@ -364,8 +903,7 @@ void CommandScheduler::runHardwareTest(const Subsystem *subsystem)
     Command *testCommand = subsystem->getTestCommand();
     if (testCommand != nullptr)
     {
-        this->subsystemsPassingHardwareTests &=
-            ~(LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier());
+        this->subsystemsPassingHardwareTests.reset(subsystem->getGlobalIdentifier());
         this->addCommand(testCommand);
     }
 }
@@ -414,35 +952,15 @@ bool CommandScheduler::isRunningTest(const Subsystem *subsystem)
 
 bool CommandScheduler::hasPassedTest(const Subsystem *subsystem)
 {
-    return (this->subsystemsPassingHardwareTests &
-            (LSB_ONE_HOT_SUBSYSTEM_BITMAP << subsystem->getGlobalIdentifier())) != 0;
+    return this->subsystemsPassingHardwareTests.test(subsystem->getGlobalIdentifier());
 }
 
 int CommandScheduler::subsystemListSize() const
 {
-    int size = 0;
-    for (int i = 0; i < maxSubsystemIndex; i++)
-    {
-        if (registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << i))
-        {
-            size++;
-        }
-    }
-    return size;
+    return registeredSubsystemBitmap.count();
 }
 
-int CommandScheduler::commandListSize() const
-{
-    int size = 0;
-    for (int i = 0; i < maxCommandIndex; i++)
-    {
-        if (addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << i))
-        {
-            size++;
-        }
-    }
-    return size;
-}
+int CommandScheduler::commandListSize() const { return addedCommandBitmap.count(); }
 
 CommandScheduler::CommandIterator CommandScheduler::cmdMapBegin()
 {
@@ -469,47 +987,37 @@ CommandScheduler::CommandIterator::CommandIterator(CommandScheduler *scheduler,
       currIndex(i)
 {
     // Set to invalid iterator if the index passed in is invalid
-    if (i < 0 || i >= maxCommandIndex)
+    if (i < 0 || i >= registry().maxCommandIndex)
     {
         currIndex = INVALID_ITER_INDEX;
     }
     else
     {
-        // If the curr index is pointing somewhere in the valid range of commands but the command
-        // associated with the index is not in the current added commands bitmap, increment the
-        // iterator to find the next valid index
-        if (!(scheduler->addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << currIndex)))
-        {
-            (*this)++;
-        }
+        // Jump to the first added command at or after the index passed in
+        seek(i);
+    }
+}
+
+void CommandScheduler::CommandIterator::seek(int start)
+{
+    currIndex = scheduler->addedCommandBitmap.findNextSetBit(start);
+    if (currIndex < 0 || currIndex >= registry().maxCommandIndex)
+    {
+        currIndex = INVALID_ITER_INDEX;
     }
 }
 
 CommandScheduler::CommandIterator::pointer CommandScheduler::CommandIterator::operator*()
 {
-    return currIndex == INVALID_ITER_INDEX ? nullptr : globalCommandRegistrar[currIndex];
+    return currIndex == INVALID_ITER_INDEX ? nullptr : registry().globalCommandRegistrar[currIndex];
 }
 
 CommandScheduler::CommandIterator &CommandScheduler::CommandIterator::operator++()
 {
-    if (currIndex == INVALID_ITER_INDEX)
+    if (currIndex != INVALID_ITER_INDEX)
     {
-        return *this;
-    }
-
-    currIndex++;
-    while (currIndex < maxCommandIndex)
-    {
-        // Is the current index in the bitmap of added commands?
-        if (scheduler->addedCommandBitmap & (LSB_ONE_HOT_COMMAND_BITMAP << currIndex))
-        {
-            // We found the correct index
-            return *this;
-        }
-        currIndex++;
+        seek(currIndex + 1);
     }
-    // We didn't find the correct index, set currindex to invalid index
-    currIndex = INVALID_ITER_INDEX;
     return *this;
 }
 
@@ -539,47 +1047,38 @@ CommandScheduler::SubsystemIterator::SubsystemIterator(CommandScheduler *schedul
       currIndex(i)
 {
     // Set to invalid iterator if the index passed in is invalid
-    if (currIndex < 0 || currIndex >= maxSubsystemIndex)
+    if (currIndex < 0 || currIndex >= registry().maxSubsystemIndex)
     {
         currIndex = INVALID_ITER_INDEX;
     }
     else
     {
-        // If the curr index is pointing somewhere in the valid range of subsystems but the
-        // subsystem associated with the index is not in the current registered subsystem bitmap,
-        // increment the iterator to find the next valid index
-        if (!(scheduler->registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << currIndex)))
-        {
-            (*this)++;
-        }
+        // Jump to the first registered subsystem at or after the index passed in
+        seek(i);
+    }
+}
+
+void CommandScheduler::SubsystemIterator::seek(int start)
+{
+    currIndex = scheduler->registeredSubsystemBitmap.findNextSetBit(start);
+    if (currIndex < 0 || currIndex >= registry().maxSubsystemIndex)
+    {
+        currIndex = INVALID_ITER_INDEX;
     }
 }
 
 CommandScheduler::SubsystemIterator::pointer CommandScheduler::SubsystemIterator::operator*()
 {
-    return currIndex == INVALID_ITER_INDEX ? nullptr : globalSubsystemRegistrar[currIndex];
+    return currIndex == INVALID_ITER_INDEX ? nullptr
+                                           : registry().globalSubsystemRegistrar[currIndex];
 }
 
 CommandScheduler::SubsystemIterator &CommandScheduler::SubsystemIterator::operator++()
 {
-    if (currIndex == INVALID_ITER_INDEX)
+    if (currIndex != INVALID_ITER_INDEX)
     {
-        return *this;
-    }
-
-    currIndex++;
-    while (currIndex < maxSubsystemIndex)
-    {
-        // Is the current index in the bitmap of added commands?
-        if (scheduler->registeredSubsystemBitmap & (LSB_ONE_HOT_SUBSYSTEM_BITMAP << currIndex))
-        {
-            // We found the correct index
-            return *this;
-        }
-        currIndex++;
+        seek(currIndex + 1);
     }
-    // We didn't find the correct index, set currindex to invalid index
-    currIndex = INVALID_ITER_INDEX;
     return *this;
 }
 
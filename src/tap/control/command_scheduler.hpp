@@ -33,6 +33,7 @@ namespace control
 {
 class Command;
 class Subsystem;
+class SchedulerProfile;
 
 /**
  * Abstract base class for a functor that defines how a robot is considered
@@ -137,12 +138,30 @@ class CommandScheduler
      * the scheduler. The Command's `end()` function is called, passing in
      * `isInterrupted = false`.
      *
+     * The SafeDisconnectFunction is evaluated once at the start of each run, and the result is
+     * used for the rest of the run, including by Commands added while it runs.
+     *
+     * A tick runs in three stages: each Subsystem's `refreshSensors()`, then every Command's
+     * `execute()`, then each Subsystem's `refresh()` followed by `refreshActuators()`. Subsystems
+     * that split their refresh this way give Commands this tick's measurements, and have all
+     * their outputs written together right before the main loop sends them (e.g. with
+     * `DjiMotorTxHandler::encodeAndSendCanData`).
+     *
      * @note checks the run time of the scheduler. An error is added to the
      *      error handler if the time is greater than `MAX_ALLOWABLE_SCHEDULER_RUNTIME`
-     *      (in microseconds).
+     *      (in microseconds). If execution time accounting is enabled, an additional error
+     *      naming the Command or Subsystem that took the longest during the tick is added.
      */
     mockable void run();
 
+    /**
+     * @return The number of times the master scheduler has finished running. Code that evaluates
+     *      something once per tick, like governors cached per tick, can compare it to the value
+     *      it last evaluated at. Everything from one `run` returning to the next, such as commands
+     *      being added by the `CommandMapper` before `run`, is the same tick.
+     */
+    static uint32_t getTickCount() { return registry().tickCount; }
+
     /**
      * Attempts to add a Command to the scheduler. There are a number of ways this
      * function can fail. If failure does occur, an error will be added to the
@@ -160,6 +179,10 @@ class CommandScheduler
      * If a Command is successfully added, the Command's `initialize()` function will
      * be called.
      *
+     * Commands added while this scheduler is running (e.g. by another Command's `execute()`) are
+     * queued and added together once every Command has executed, so they first execute on the
+     * next `run`.
+     *
      * @note If the `commandToAdd` was already scheduled, it will be interrupted (its `end()`
      *      will be called) and then the command will be rescheduled.
      *
@@ -176,9 +199,30 @@ class CommandScheduler
      *      Command is not in the scheduler, nothing is removed.
      * @param[in] interrupted an argument passed in to the Command's `end()`
      *      function when removing the desired Command.
+     *
+     * Like Commands that finish, Commands removed while this scheduler is running are queued,
+     * skipped for the rest of the run and ended together once every Command has executed. A
+     * queued addition of the Command is cancelled.
      */
     mockable void removeCommand(Command* command, bool interrupted);
 
+    /**
+     * Switches to the commands of a profile, e.g. when the robot changes modes. Every scheduled
+     * command that isn't in the profile is ended (with the interrupted flag set to `true`), then
+     * every command in the profile that isn't scheduled is added with `addCommand`. Commands in
+     * the profile that are already scheduled keep running without being ended and initialized
+     * again. The default commands of subsystems the profile doesn't require also keep running,
+     * since they would just be added again by the next `run`.
+     *
+     * Does nothing if the scheduler is safe disconnected.
+     *
+     * @param[in] profile The profile to switch to.
+     */
+    mockable void switchToProfile(const SchedulerProfile& profile);
+
+    /// @return The profile last switched to, or `nullptr` if `switchToProfile` wasn't called.
+    mockable const SchedulerProfile* getActiveProfile() const { return activeProfile; }
+
     /**
      * @return `true` if the CommandScheduler contains the requrested Command.
      *      `false` otherwise.
@@ -195,6 +239,31 @@ class CommandScheduler
      */
     mockable void registerSubsystem(Subsystem* subsystem);
 
+    /**
+     * Adds the given Subsystem to the CommandScheduler with the given RefreshPolicy. If this
+     * is the master scheduler, the Subsystem is refreshed according to the policy, otherwise
+     * the policy is ignored (since only the master scheduler refreshes Subsystems) and this
+     * behaves identically to `registerSubsystem(Subsystem*)`.
+     *
+     * When the policy's phase is `RefreshPolicy::AUTO_PHASE`, the phase that collides with the
+     * fewest other rate divided Subsystems already registered is chosen, so slow Subsystems
+     * are staggered rather than all being refreshed on the same tick.
+     *
+     * @param[in] subsystem the Subsystem to add. Must be not `nullptr` and not registered
+     *      already, otherwise an error is added to the error handler.
+     * @param[in] policy the RefreshPolicy to use. The divider must be nonzero and the phase
+     *      must be less than the divider or `RefreshPolicy::AUTO_PHASE`, otherwise an error is
+     *      added to the error handler and the Subsystem is not registered.
+     */
+    mockable void registerSubsystem(Subsystem* subsystem, RefreshPolicy policy);
+
+    /**
+     * @return The RefreshPolicy the master scheduler uses for the given Subsystem, with the
+     *      phase resolved if it was registered with `RefreshPolicy::AUTO_PHASE`. If the
+     *      Subsystem is `nullptr`, the default RefreshPolicy is returned.
+     */
+    static RefreshPolicy getSubsystemRefreshPolicy(const Subsystem* subsystem);
+
     /**
      * @brief Set the SafeDisconnectFunction to the given function.
      *
@@ -260,6 +329,79 @@ class CommandScheduler
      */
     mockable int commandListSize() const;
 
+    /**
+     * Execution time statistics for a single Command or Subsystem, measured in core clock
+     * cycles. Measurements for a Command include the time spent in `execute()` and
+     * `isFinished()`. Measurements for a Subsystem include the time spent in `refreshSensors()`,
+     * `refresh()` (or `refreshSafeDisconnect()`) and `refreshActuators()`. Time spent in nested
+     * CommandSchedulers (for example those in a ComprisedCommand) is included in the time of the
+     * parent Command.
+     */
+    struct ExecutionTimeStats
+    {
+        /// Low pass alpha used to compute `avgCycles`.
+        static constexpr float AVG_LOW_PASS_ALPHA = 0.01f;
+
+        /// Smallest number of cycles ever recorded.
+        uint32_t minCycles = UINT32_MAX;
+        /// Largest number of cycles ever recorded.
+        uint32_t maxCycles = 0;
+        /// Number of cycles recorded most recently.
+        uint32_t lastCycles = 0;
+        /// Exponentially weighted moving average of the number of cycles recorded.
+        float avgCycles = 0;
+
+        /// @return `true` if no measurements have been recorded since the last reset.
+        inline bool isEmpty() const { return maxCycles == 0 && minCycles == UINT32_MAX; }
+
+        void reset();
+
+        void update(uint32_t cycles);
+    };
+
+    /**
+     * Enables or disables execution time accounting. When enabled, every `execute()` and
+     * `refresh()` call made by this scheduler is timed using the DWT cycle counter and recorded
+     * in per-Command and per-Subsystem `ExecutionTimeStats`, indexed by global identifier.
+     * Disabled by default.
+     */
+    mockable void setExecutionTimeAccountingEnabled(bool enabled);
+
+    mockable bool isExecutionTimeAccountingEnabled() const
+    {
+        return executionTimeAccountingEnabled;
+    }
+
+    /**
+     * @return Execution time statistics for the given command. If the command is `nullptr`,
+     *      empty statistics are returned.
+     */
+    static ExecutionTimeStats getCommandExecutionTimeStats(const Command* command);
+
+    /**
+     * @return Execution time statistics for the given subsystem. If the subsystem is `nullptr`,
+     *      empty statistics are returned.
+     */
+    static ExecutionTimeStats getSubsystemExecutionTimeStats(const Subsystem* subsystem);
+
+    /**
+     * Resets the execution time statistics of all Commands and Subsystems.
+     */
+    static void resetExecutionTimeStats();
+
+    /**
+     * @return The name of the Command or Subsystem that took the most cycles during the most
+     *      recent call to `run()`, or `nullptr` if execution time accounting is disabled or
+     *      nothing ran.
+     */
+    const char* getWorstOffenderName() const { return worstOffenderName; }
+
+    /// @return The number of cycles taken by the worst offender during the most recent `run()`.
+    uint32_t getWorstOffenderCycles() const { return worstOffenderCycles; }
+
+    /// @return The time the most recent call to `run()` took, in microseconds.
+    uint32_t getLastRunTime() const { return lastRunTime; }
+
     /**
      * Iterator used for looking through the commands added to the scheduler
      */
@@ -285,6 +427,12 @@ class CommandScheduler
         friend bool operator!=(const CommandIterator& a, const CommandIterator& b);
 
     private:
+        /**
+         * Moves the iterator to the first set bit in the scheduler's addedCommandBitmap with
+         * index >= start, or to the end iterator if there isn't one.
+         */
+        void seek(int start);
+
         CommandScheduler* scheduler;
         int currIndex;
     };
@@ -314,6 +462,12 @@ class CommandScheduler
         friend bool operator!=(const SubsystemIterator& a, const SubsystemIterator& b);
 
     private:
+        /**
+         * Moves the iterator to the first set bit in the scheduler's registeredSubsystemBitmap
+         * with index >= start, or to the end iterator if there isn't one.
+         */
+        void seek(int start);
+
         CommandScheduler* scheduler;
         int currIndex;
     };
@@ -335,52 +489,183 @@ class CommandScheduler
     static void destructSubsystem(Subsystem* subsystem);
 
 private:
+    friend class SchedulerPartition;
+
     /// Maximum time before we start erroring, in microseconds.
     static constexpr float MAX_ALLOWABLE_SCHEDULER_RUNTIME = 100;
-    static constexpr int MAX_SUBSYSTEM_COUNT = sizeof(subsystem_scheduler_bitmap_t) * 8;
-    static constexpr int MAX_COMMAND_COUNT = sizeof(command_scheduler_bitmap_t) * 8;
-    static constexpr subsystem_scheduler_bitmap_t LSB_ONE_HOT_SUBSYSTEM_BITMAP = 1;
-    static constexpr command_scheduler_bitmap_t LSB_ONE_HOT_COMMAND_BITMAP = 1;
+    static constexpr int MAX_SUBSYSTEM_COUNT = subsystem_scheduler_bitmap_t::SIZE;
+    static constexpr int MAX_COMMAND_COUNT = command_scheduler_bitmap_t::SIZE;
     static constexpr int INVALID_ITER_INDEX = -1;
 
+public:
     /**
-     * The smallest index such that all indices in the globalSubsystemRegistrar >= to them are
-     * nullptr.
+     * The state shared by all of a robot's schedulers: the registrars that give each Command and
+     * Subsystem its global identifier, their execution time statistics, the master scheduler's
+     * refresh timetable and the tick count. On the MCU there is a single registry.
      *
-     * To loop through the globalCommandRegistrar, use this value as the max value, i.e.
-     * for (int i = 0; i < maxSubsystemIndex; i++) {...}
+     * A hosted simulation may give each robot it simulates its own registry, so that several
+     * robots, each with their own `Drivers` and master scheduler, run in a single process. A
+     * robot's registry must be active (see `setActiveRegistry`) whenever its Commands,
+     * Subsystems and schedulers are constructed, run or destroyed. For example, to step robots in
+     * lockstep with virtual time (see `tap::arch::clock::enableVirtualTime`):
+     *
+     * ```cpp
+     * for (Robot& robot : robots)
+     * {
+     *     CommandScheduler::setActiveRegistry(&robot.registry);
+     *     DjiMotorSimHandler::setActive(&robot.motorSims);
+     *     TCPServer::setActive(&robot.server);
+     *     robot.drivers.commandScheduler.run();
+     *     robot.drivers.djiMotorTxHandler.encodeAndSendCanData();
+     * }
+     * tap::arch::clock::advance(1'000);
+     * ```
      */
-    static int maxSubsystemIndex;
+    class Registry
+    {
+    private:
+        friend class CommandScheduler;
+        friend class SchedulerPartition;
+
+        /**
+         * The smallest index such that all indices in the globalSubsystemRegistrar >= to them
+         * are nullptr.
+         *
+         * To loop through the globalCommandRegistrar, use this value as the max value, i.e.
+         * for (int i = 0; i < maxSubsystemIndex; i++) {...}
+         */
+        int maxSubsystemIndex = 0;
+
+        /**
+         * An array of all constructed subsystems. When a subsystem is constructed it is given
+         * an index in the registrar. When a subsystem is destructed it is removed from the
+         * registrar.
+         */
+        Subsystem* globalSubsystemRegistrar[MAX_SUBSYSTEM_COUNT] = {};
+
+        /**
+         * The smallest index such that all indices in the globalCommandRegistrar >= to them are
+         * nullptr.
+         */
+        int maxCommandIndex = 0;
+
+        /**
+         * An array of all constructed commands. When a command is constructed it is given an
+         * index in the registrar. When a command is destructed it is removed from the registrar.
+         */
+        Command* globalCommandRegistrar[MAX_COMMAND_COUNT] = {};
+
+        /**
+         * Execution time statistics of each command in the globalCommandRegistrar, index by the
+         * command's global identifier.
+         */
+        ExecutionTimeStats globalCommandExecutionTimeStats[MAX_COMMAND_COUNT];
+
+        /**
+         * Execution time statistics of each subsystem in the globalSubsystemRegistrar, index by
+         * the subsystem's global identifier.
+         */
+        ExecutionTimeStats globalSubsystemExecutionTimeStats[MAX_SUBSYSTEM_COUNT];
+
+        /**
+         * RefreshPolicy of each subsystem in the globalSubsystemRegistrar, indexed by the
+         * subsystem's global identifier. Only the master scheduler uses and modifies these.
+         */
+        RefreshPolicy globalSubsystemRefreshPolicy[MAX_SUBSYSTEM_COUNT];
+
+        /**
+         * The timetable used by the master scheduler to refresh subsystems. Contains the global
+         * identifiers of all subsystems registered in the master scheduler, sorted by descending
+         * priority then ascending global identifier. Combined with the divider and phase in
+         * globalSubsystemRefreshPolicy, this determines which subsystems are refreshed, and in
+         * what order, during a given tick.
+         */
+        uint8_t subsystemRefreshOrder[MAX_SUBSYSTEM_COUNT] = {};
+        static_assert(
+            MAX_SUBSYSTEM_COUNT <= UINT8_MAX + 1,
+            "subsystemRefreshOrder entries too small");
+
+        /// The number of valid entries in subsystemRefreshOrder.
+        int subsystemRefreshOrderSize = 0;
+
+        /// The "master" scheduler, or nullptr if one hasn't been constructed.
+        CommandScheduler* masterScheduler = nullptr;
+
+        /// See `getTickCount`.
+        uint32_t tickCount = 0;
+    };
 
+#ifdef PLATFORM_HOSTED
     /**
-     * A global array of all constructed subsystems. When a subsystem is constructed it is given an
-     * index in the registrar. When a subsystem is destructed it is removed from the registrar.
+     * Makes `registry` the registry of all schedulers, Commands and Subsystems until another
+     * registry is activated. If `nullptr`, activates the default registry.
      */
-    static Subsystem* globalSubsystemRegistrar[MAX_SUBSYSTEM_COUNT];
+    static void setActiveRegistry(Registry* registry)
+    {
+        activeRegistry = registry != nullptr ? registry : &defaultRegistry;
+    }
 
-    /**
-     * The smallest index such that all indices in the globalCommandRegistrar >= to them are
-     * nullptr.
-     */
-    static int maxCommandIndex;
+    /// @return The active registry, see `setActiveRegistry`.
+    static Registry* getActiveRegistry() { return activeRegistry; }
+#endif
+
+private:
+
+    /// The registry used when no other registry is active, and the only registry on the MCU.
+    static Registry defaultRegistry;
+
+#ifdef PLATFORM_HOSTED
+    /// See `setActiveRegistry`.
+    static Registry* activeRegistry;
+#endif
+
+    /// @return The registry of the robot the scheduler belongs to.
+    static Registry& registry()
+    {
+#ifdef PLATFORM_HOSTED
+        return *activeRegistry;
+#else
+        return defaultRegistry;
+#endif
+    }
 
     /**
-     * A global array of all constructed commands. When a command is constructed it is given an
-     * index in the registrar. When a command is destructed it is removed from the registrar.
+     * Description of the error raised when the scheduler runs over
+     * `MAX_ALLOWABLE_SCHEDULER_RUNTIME` and execution time accounting is enabled. The buffer is
+     * reused for every overrun so that the same error is updated with the most recent worst
+     * offender rather than flooding the error handler.
      */
-    static Command* globalCommandRegistrar[MAX_COMMAND_COUNT];
+    static char overrunErrorDescription[64];
 
     /**
-     * A global flag indicating whether or not a "master" scheduler has been constructed.
+     * Description of the error raised when a command or subsystem is degraded for running over
+     * its `TimeBudget`, reused like `overrunErrorDescription`.
      */
-    static bool masterSchedulerExists;
+    static char degradedErrorDescription[64];
 
     /**
      * Returns true if the remote is disconnected and the safeDisconnectMode flag is
-     * enabled.
+     * enabled. While the scheduler is running, returns the state latched at the start of the
+     * run rather than calling the SafeDisconnectFunction again.
      */
     bool safeDisconnected();
 
+    /**
+     * Inserts the subsystem with the given global identifier into the subsystemRefreshOrder,
+     * resolving its phase if necessary. Does nothing if it is already in the
+     * subsystemRefreshOrder.
+     */
+    static void addToRefreshTimetable(int subsystemId);
+
+    /// Removes the given global identifier from the subsystemRefreshOrder, if present.
+    static void removeFromRefreshTimetable(int subsystemId);
+
+    /**
+     * @return The phase in [0, divider) that is shared with the fewest ticks of other rate
+     *      divided subsystems already in the subsystemRefreshOrder.
+     */
+    static uint8_t findLeastLoadedPhase(uint8_t divider);
+
     Drivers* drivers;
 
     /**
@@ -399,29 +684,140 @@ class CommandScheduler
      * in the codebase. If a subsystem is registered, the associated bit in this bitmap
      * will be set to 1.
      */
-    subsystem_scheduler_bitmap_t registeredSubsystemBitmap = 0;
+    subsystem_scheduler_bitmap_t registeredSubsystemBitmap;
 
     /**
      * Each bit in the bitmap corresponds to an index into the subsystem registrar. If a
      * bit is set, it means that the subsystem in the registrar has a command associated
      * in this scheduler.
      */
-    subsystem_scheduler_bitmap_t subsystemsAssociatedWithCommandBitmap = 0;
+    subsystem_scheduler_bitmap_t subsystemsAssociatedWithCommandBitmap;
 
     /**
      * Each bit in the bitmap corresponds to an index into the subsystem registrar. If a
      * bit is set, it means that the subsystem in the registrar has passed a hardware test
      * in this scheduler.
      */
-    subsystem_scheduler_bitmap_t subsystemsPassingHardwareTests = 0;
+    subsystem_scheduler_bitmap_t subsystemsPassingHardwareTests;
 
     /**
      * If a command has been added and is running, the associated bit in this bitmap will
      * be set to 1.
      */
-    command_scheduler_bitmap_t addedCommandBitmap = 0;
+    command_scheduler_bitmap_t addedCommandBitmap;
+
+    /// See `getActiveProfile`.
+    const SchedulerProfile* activeProfile = nullptr;
+
+    /**
+     * Maps each subsystem's global identifier to the global identifier of the command in this
+     * scheduler that requires it. Only valid for subsystems whose bit is set in the
+     * subsystemsAssociatedWithCommandBitmap. Allows conflicting commands to be found without
+     * searching through every added command.
+     */
+    int16_t subsystemOwners[MAX_SUBSYSTEM_COUNT]{};
+
+    /// Commands to add at the next commit, see `commitCommandChanges`.
+    command_scheduler_bitmap_t pendingAdditions;
+
+    /// Commands that finished or were removed since the last commit, ended at the next commit.
+    command_scheduler_bitmap_t pendingRemovals;
+
+    /// The commands in pendingRemovals that were interrupted rather than finished.
+    command_scheduler_bitmap_t pendingInterruptions;
 
     bool isMasterScheduler = false;
+
+    /**
+     * `true` if this is the scheduler of a `SchedulerPartition`, which refreshes the subsystems
+     * registered with it rather than leaving them to the master scheduler.
+     */
+    bool refreshesOwnSubsystems = false;
+
+    /**
+     * Number of times the scheduler has refreshed its subsystems, used to determine which rate
+     * divided subsystems to refresh.
+     */
+    uint32_t refreshTick = 0;
+
+    /**
+     * Cycles each subsystem spent in `refreshSensors` this tick, indexed by global identifier,
+     * added to the time measured for the rest of its refresh.
+     */
+    uint32_t sensorRefreshCycles[MAX_SUBSYSTEM_COUNT]{};
+
+    bool executionTimeAccountingEnabled = false;
+
+    const char* worstOffenderName = nullptr;
+
+    uint32_t worstOffenderCycles = 0;
+
+    uint32_t lastRunTime = 0;
+
+    /// `true` while `run` is running, in which case `safeDisconnectedThisRun` is valid.
+    bool running = false;
+
+    /// The SafeDisconnectFunction's result at the start of the current run.
+    bool safeDisconnectedThisRun = false;
+
+    /**
+     * Records that `name` took `cycles` to run this tick, updating the worst offender if it took
+     * longer than anything else so far this tick.
+     */
+    inline void updateWorstOffender(const char* name, uint32_t cycles)
+    {
+        if (cycles >= worstOffenderCycles)
+        {
+            worstOffenderCycles = cycles;
+            worstOffenderName = name;
+        }
+    }
+
+    /// The stages of a tick in which `run` refreshes subsystems.
+    enum class RefreshStage : uint8_t
+    {
+        /// Before commands execute, see `Subsystem::refreshSensors`.
+        SENSORS,
+        /// After commands execute, see `Subsystem::refresh` and `Subsystem::refreshActuators`.
+        CONTROL,
+    };
+
+    /**
+     * Refreshes the subsystems this scheduler is responsible for, in the master scheduler's
+     * refresh timetable order or, for a partition, in the order of their global identifiers.
+     */
+    void refreshSubsystems(RefreshStage stage);
+
+    /// Calls the subsystem's `refreshSensors` if its refresh policy says it is due this tick.
+    void refreshSubsystemSensors(Subsystem* sub, int subId);
+
+    /// Refreshes a subsystem if its refresh policy says it is due this tick.
+    void refreshSubsystem(Subsystem* sub, int subId);
+
+    /**
+     * Adds a command, without the checks `addCommand` does before queueing it while the scheduler
+     * is running.
+     */
+    void startCommand(Command* command);
+
+    /// Ends and removes a scheduled command.
+    void endCommand(Command* command, bool interrupted);
+
+    /**
+     * Ends the commands removed since the last commit, then adds the commands queued since then,
+     * in order of global identifier.
+     */
+    void commitCommandChanges();
+
+    /**
+     * Records which subsystems without a command passed their hardware test, and adds the default
+     * commands of subsystems nothing requires. Done once per run from the final
+     * subsystemsAssociatedWithCommandBitmap, after every command change is committed.
+     */
+    void scheduleDefaultCommands();
+
+    /// Raises an error saying that `name` was degraded after taking `cycles` to run.
+    void reportDegraded(const char* name, uint32_t cycles);
 };  // class CommandScheduler
 
 }  // namespace control
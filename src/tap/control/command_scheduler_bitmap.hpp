@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_COMMAND_SCHEDULER_BITMAP_HPP_
+#define TAPROOT_COMMAND_SCHEDULER_BITMAP_HPP_
+
+#include <cinttypes>
+
+namespace tap::control
+{
+/**
+ * A fixed size bitmap made up of `WORDS` 32-bit words, used by the CommandScheduler to keep
+ * track of Commands and Subsystems by global identifier. Supports the same bitwise operators as
+ * an unsigned integer so it may be used in place of one, along with single bit operations and
+ * bit scanning that operate on one word at a time. No heap allocation is performed.
+ *
+ * Implicitly constructible from a `uint64_t`, which sets the lowest 64 bits of the bitmap
+ * (or as many as fit), so integer literals and masks such as `1ull << id` may be used where a
+ * bitmap is expected for identifiers less than 64.
+ */
+template <int WORDS>
+class SchedulerBitmap
+{
+public:
+    static_assert(WORDS > 0, "SchedulerBitmap must have at least one word");
+
+    using word_t = uint32_t;
+
+    static constexpr int BITS_PER_WORD = sizeof(word_t) * 8;
+
+    /// The number of bits in the bitmap.
+    static constexpr int SIZE = WORDS * BITS_PER_WORD;
+
+    constexpr SchedulerBitmap() : words{} {}
+
+    constexpr SchedulerBitmap(uint64_t lowBits) : words{}
+    {
+        words[0] = static_cast<word_t>(lowBits);
+        if constexpr (WORDS > 1)
+        {
+            words[1] = static_cast<word_t>(lowBits >> BITS_PER_WORD);
+        }
+    }
+
+    /// @return A bitmap with only the bit at index `i` set.
+    static constexpr SchedulerBitmap oneHot(int i)
+    {
+        SchedulerBitmap bitmap;
+        bitmap.set(i);
+        return bitmap;
+    }
+
+    constexpr void set(int i) { words[i / BITS_PER_WORD] |= bitInWord(i); }
+
+    constexpr void reset(int i) { words[i / BITS_PER_WORD] &= ~bitInWord(i); }
+
+    constexpr bool test(int i) const { return (words[i / BITS_PER_WORD] & bitInWord(i)) != 0; }
+
+    /// @return `true` if any bit is set.
+    constexpr bool any() const
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            if (words[i] != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr bool none() const { return !any(); }
+
+    /// @return The number of set bits.
+    int count() const
+    {
+        int total = 0;
+        for (int i = 0; i < WORDS; i++)
+        {
+            total += __builtin_popcount(words[i]);
+        }
+        return total;
+    }
+
+    /**
+     * @return The index of the least significant set bit with index `start` or greater, or -1
+     *      if there is no such bit. Uses count trailing zeros, which compiles to RBIT + CLZ
+     *      on Cortex-M4, and skips empty words entirely.
+     */
+    int findNextSetBit(int start) const
+    {
+        if (start < 0)
+        {
+            start = 0;
+        }
+
+        int wordIndex = start / BITS_PER_WORD;
+        if (wordIndex >= WORDS)
+        {
+            return -1;
+        }
+
+        // Mask off bits below start in the first word examined
+        word_t word = words[wordIndex] & (~static_cast<word_t>(0) << (start % BITS_PER_WORD));
+        while (word == 0)
+        {
+            wordIndex++;
+            if (wordIndex >= WORDS)
+            {
+                return -1;
+            }
+            word = words[wordIndex];
+        }
+        return wordIndex * BITS_PER_WORD + __builtin_ctz(word);
+    }
+
+    /// @return The word at the given index, where word 0 holds bits [0, BITS_PER_WORD).
+    constexpr word_t getWord(int i) const { return words[i]; }
+
+    constexpr explicit operator bool() const { return any(); }
+
+    constexpr SchedulerBitmap &operator|=(const SchedulerBitmap &other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr SchedulerBitmap &operator&=(const SchedulerBitmap &other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr SchedulerBitmap &operator^=(const SchedulerBitmap &other)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            words[i] ^= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr SchedulerBitmap &operator<<=(int shift)
+    {
+        const int wordShift = shift / BITS_PER_WORD;
+        const int bitShift = shift % BITS_PER_WORD;
+        for (int i = WORDS - 1; i >= 0; i--)
+        {
+            word_t word = 0;
+            if (i - wordShift >= 0)
+            {
+                word = words[i - wordShift] << bitShift;
+                if (bitShift != 0 && i - wordShift - 1 >= 0)
+                {
+                    word |= words[i - wordShift - 1] >> (BITS_PER_WORD - bitShift);
+                }
+            }
+            words[i] = word;
+        }
+        return *this;
+    }
+
+    constexpr SchedulerBitmap operator~() const
+    {
+        SchedulerBitmap result;
+        for (int i = 0; i < WORDS; i++)
+        {
+            result.words[i] = ~words[i];
+        }
+        return result;
+    }
+
+    friend constexpr SchedulerBitmap operator|(SchedulerBitmap a, const SchedulerBitmap &b)
+    {
+        return a |= b;
+    }
+
+    friend constexpr SchedulerBitmap operator&(SchedulerBitmap a, const SchedulerBitmap &b)
+    {
+        return a &= b;
+    }
+
+    friend constexpr SchedulerBitmap operator^(SchedulerBitmap a, const SchedulerBitmap &b)
+    {
+        return a ^= b;
+    }
+
+    friend constexpr SchedulerBitmap operator<<(SchedulerBitmap a, int shift)
+    {
+        return a <<= shift;
+    }
+
+    friend constexpr bool operator==(const SchedulerBitmap &a, const SchedulerBitmap &b)
+    {
+        for (int i = 0; i < WORDS; i++)
+        {
+            if (a.words[i] != b.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const SchedulerBitmap &a, const SchedulerBitmap &b)
+    {
+        return !(a == b);
+    }
+
+private:
+    word_t words[WORDS];
+
+    static constexpr word_t bitInWord(int i)
+    {
+        return static_cast<word_t>(1) << (i % BITS_PER_WORD);
+    }
+};
+}  // namespace tap::control
+
+#endif  // TAPROOT_COMMAND_SCHEDULER_BITMAP_HPP_
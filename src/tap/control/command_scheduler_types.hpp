@@ -22,10 +22,47 @@
 
 #include <cinttypes>
 
+#include "tap/control/command_scheduler_constants.hpp"
+
+#include "command_scheduler_bitmap.hpp"
+
 namespace tap::control
 {
-typedef uint64_t command_scheduler_bitmap_t;
-typedef uint64_t subsystem_scheduler_bitmap_t;
+typedef SchedulerBitmap<SCHEDULER_BITMAP_WORDS> command_scheduler_bitmap_t;
+typedef SchedulerBitmap<SCHEDULER_BITMAP_WORDS> subsystem_scheduler_bitmap_t;
+
+/**
+ * Describes when and in what order the master CommandScheduler refreshes a Subsystem.
+ * Pass to `CommandScheduler::registerSubsystem` when a Subsystem does not need to be
+ * refreshed every time the scheduler is run.
+ */
+struct RefreshPolicy
+{
+    /**
+     * Phase value that lets the scheduler pick the phase for the Subsystem, such that
+     * Subsystems with a divider > 1 are spread out across ticks as evenly as possible.
+     */
+    static constexpr uint8_t AUTO_PHASE = UINT8_MAX;
+
+    /**
+     * Subsystems with a higher priority are refreshed before Subsystems with a lower
+     * priority during a single call to `run()`. Subsystems with the same priority are
+     * refreshed in order of their global identifier.
+     */
+    uint8_t priority = 0;
+
+    /**
+     * The Subsystem is refreshed once every `divider` calls to the master scheduler's `run()`.
+     * Must be nonzero.
+     */
+    uint8_t divider = 1;
+
+    /**
+     * The tick (modulo `divider`) that the Subsystem is refreshed on. Must either be less than
+     * `divider` or `AUTO_PHASE`.
+     */
+    uint8_t phase = AUTO_PHASE;
+};
 }  // namespace tap::control
 
 #endif  // TAPROOT_COMMAND_SCHEDULER_TYPES_HPP_
@@ -56,11 +56,11 @@ class ConcurrentTemplateCommand : public Command
                 "Null pointer command passed into concurrent command.");
             auto requirements = command->getRequirementsBitwise();
             modm_assert(
-                (this->commandRequirementsBitwise & requirements) == 0,
+                (this->commandRequirementsBitwise & requirements).none(),
                 "ConcurrentCommand::ConcurrentCommand",
                 "Multiple commands to concurrent command have overlapping requirements.");
             this->commandRequirementsBitwise |= requirements;
-            this->allCommands |= (1ull << command->getGlobalIdentifier());
+            this->allCommands.set(command->getGlobalIdentifier());
         }
     }
 
@@ -82,6 +82,7 @@ class ConcurrentTemplateCommand : public Command
     {
         for (Command* command : commands)
         {
+            command->clearFinishRequest();
             command->initialize();
         }
     }
@@ -90,13 +91,13 @@ class ConcurrentTemplateCommand : public Command
     {
         for (Command* command : commands)
         {
-            if (!(this->finishedCommands & (1ull << command->getGlobalIdentifier())))
+            if (!this->finishedCommands.test(command->getGlobalIdentifier()))
             {
                 command->execute();
-                if (command->isFinished())
+                if (command->checkFinished())
                 {
                     command->end(false);
-                    this->finishedCommands |= 1ull << command->getGlobalIdentifier();
+                    this->finishedCommands.set(command->getGlobalIdentifier());
                 }
             }
         }
@@ -106,7 +107,7 @@ class ConcurrentTemplateCommand : public Command
     {
         for (Command* command : commands)
         {
-            if (!(this->finishedCommands & (1ull << command->getGlobalIdentifier())))
+            if (!this->finishedCommands.test(command->getGlobalIdentifier()))
             {
                 if (RACE)
                 {
@@ -120,11 +121,19 @@ class ConcurrentTemplateCommand : public Command
         }
     }
 
+    CommandComposition getComposition() const override
+    {
+        return {
+            RACE ? CommandComposition::Type::RACE : CommandComposition::Type::CONCURRENT,
+            commands.data(),
+            static_cast<int>(COMMANDS)};
+    }
+
     bool isFinished() const override
     {
         if (RACE)
         {
-            return this->finishedCommands != 0;
+            return this->finishedCommands.any();
         }
         return this->finishedCommands == this->allCommands;
     }
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_FLATTENED_COMMAND_HPP_
+#define TAPROOT_FLATTENED_COMMAND_HPP_
+
+#include <cstdint>
+
+#include "modm/architecture/interface/assert.hpp"
+
+#include "command.hpp"
+#include "command_scheduler_bitmap.hpp"
+
+namespace tap
+{
+namespace control
+{
+/**
+ * Runs a tree of `SequentialCommand`s and `Concurrent[Race]Command`s without going through the
+ * composites each tick. Every composite forwards `execute`, `isFinished` and `end` to its
+ * children, so deeply nested composites, for example a sequence of races of governor limited
+ * commands, turn each tick into a long chain of virtual calls. This command instead compiles the
+ * tree into a flat array of nodes in depth-first order when it is constructed, and each tick
+ * only visits the nodes that are doing something: the leaf commands that are running and the
+ * sequences waiting for their next command to be ready.
+ *
+ * Leaf commands are initialized, executed and ended on the same ticks and in the same order as
+ * they would be by the composites, with one exception: when interrupted, a sequence whose next
+ * command hasn't been initialized yet doesn't end it. Commands that run their own logic, like
+ * `ComprisedCommand` and `GovernorLimitedCommand`, are leaves. The composites themselves are only
+ * asked whether they are ready, so their `getName` and `isFinished` are stale while flattened.
+ *
+ * ```cpp
+ * ConcurrentRaceCommand<2> race({&aim, &timeout}, "aim or timeout");
+ * SequentialCommand<2> sequence({&race, &shoot});
+ * FlattenedCommand<8> flattened(&sequence, "aim and shoot");
+ *
+ * drivers->commandScheduler.addCommand(&flattened);
+ * ```
+ *
+ * @tparam MAX_NODES The maximum number of commands in the tree, composites included.
+ */
+template <int MAX_NODES>
+class FlattenedCommand : public Command
+{
+public:
+    static_assert(MAX_NODES > 0 && MAX_NODES < UINT8_MAX, "MAX_NODES must fit in a uint8_t");
+
+    /**
+     * @param[in] root The top of the tree to run. The tree must not be changed afterwards.
+     * @param[in] name The name of the command.
+     */
+    FlattenedCommand(Command* root, const char* name) : Command(), name(name)
+    {
+        modm_assert(
+            root != nullptr,
+            "FlattenedCommand::FlattenedCommand",
+            "Null pointer command passed into flattened command.");
+        this->commandRequirementsBitwise = root->getRequirementsBitwise();
+        addNode(root, NO_PARENT);
+    }
+
+    const char* getName() const override { return this->name; }
+
+    bool isReady() override { return this->nodes[0].command->isReady(); }
+
+    void initialize() override
+    {
+        this->scheduled = NodeBitmap();
+        this->pendingFinish = NodeBitmap();
+        this->finished = false;
+        activate(0);
+    }
+
+    void execute() override
+    {
+        for (int i = this->scheduled.findNextSetBit(0); i >= 0;
+             i = this->scheduled.findNextSetBit(i + 1))
+        {
+            finishCompositesBefore(i);
+
+            Node& node = this->nodes[i];
+            if (node.type == CommandComposition::Type::SEQUENCE)
+            {
+                // Like SequentialCommand, the next command starts as soon as it is ready
+                if (this->nodes[node.current].command->isReady())
+                {
+                    this->scheduled.reset(i);
+                    node.currentInitialized = true;
+                    activate(node.current);
+                }
+                continue;
+            }
+
+            node.command->execute();
+            if (node.command->checkFinished())
+            {
+                node.command->end(false);
+                node.active = false;
+                this->scheduled.reset(i);
+                childFinished(i);
+            }
+        }
+        finishCompositesBefore(this->numNodes);
+    }
+
+    void end(bool interrupted) override
+    {
+        interrupt(0, interrupted);
+        this->scheduled = NodeBitmap();
+        this->pendingFinish = NodeBitmap();
+    }
+
+    bool isFinished() const override { return this->finished; }
+
+    /// @return The number of commands in the tree, composites included.
+    int getNumNodes() const { return this->numNodes; }
+
+private:
+    static constexpr uint8_t NO_PARENT = UINT8_MAX;
+
+    using NodeBitmap = SchedulerBitmap<(MAX_NODES + 31) / 32>;
+
+    struct Node
+    {
+        Command* command = nullptr;
+        CommandComposition::Type type = CommandComposition::Type::NONE;
+        uint8_t parent = NO_PARENT;
+        /// One past the last node in this node's subtree, which is also its next sibling.
+        uint8_t subtreeEnd = 0;
+        uint8_t numChildren = 0;
+        /// Number of children finished since the node was initialized, for concurrent nodes.
+        uint8_t numFinished = 0;
+        /// The running or next child, for sequence nodes.
+        uint8_t current = 0;
+        bool currentInitialized = false;
+        /// Initialized and not yet finished or ended.
+        bool active = false;
+    };
+
+    const char* name;
+    Node nodes[MAX_NODES];
+    int numNodes = 0;
+    /// Nodes visited each tick: running leaves and sequences waiting to start their next child.
+    NodeBitmap scheduled;
+    /// Concurrent nodes with a child that finished this tick, checked once the tick leaves them.
+    NodeBitmap pendingFinish;
+    bool finished = false;
+
+    void addNode(Command* command, uint8_t parent)
+    {
+        modm_assert(
+            command != nullptr && this->numNodes < MAX_NODES,
+            "FlattenedCommand::FlattenedCommand",
+            "Null pointer command or too many commands in flattened command.");
+        if (command == nullptr || this->numNodes >= MAX_NODES)
+        {
+            return;
+        }
+
+        const int index = this->numNodes++;
+        const CommandComposition composition = command->getComposition();
+        Node& node = this->nodes[index];
+        node.command = command;
+        node.parent = parent;
+        // Composites without children are left to run their own logic
+        if (composition.numChildren > 0)
+        {
+            node.type = composition.type;
+            node.numChildren = composition.numChildren;
+            for (int i = 0; i < composition.numChildren; i++)
+            {
+                addNode(composition.children[i], index);
+            }
+        }
+        this->nodes[index].subtreeEnd = this->numNodes;
+    }
+
+    /// Initializes the node, like the composites do when the node's parent starts it.
+    void activate(int i)
+    {
+        Node& node = this->nodes[i];
+        node.active = true;
+        node.numFinished = 0;
+        switch (node.type)
+        {
+            case CommandComposition::Type::NONE:
+                node.command->clearFinishRequest();
+                node.command->initialize();
+                this->scheduled.set(i);
+                break;
+            case CommandComposition::Type::SEQUENCE:
+                node.current = i + 1;
+                node.currentInitialized = false;
+                this->scheduled.set(i);
+                break;
+            case CommandComposition::Type::CONCURRENT:
+            case CommandComposition::Type::RACE:
+                for (int child = i + 1; child < node.subtreeEnd;
+                     child = this->nodes[child].subtreeEnd)
+                {
+                    activate(child);
+                }
+                break;
+        }
+    }
+
+    /// Advances the finished node's sequence, or marks its concurrent parent to be checked.
+    void childFinished(int i)
+    {
+        const uint8_t parentIndex = this->nodes[i].parent;
+        if (parentIndex == NO_PARENT)
+        {
+            this->finished = true;
+            return;
+        }
+
+        Node& parent = this->nodes[parentIndex];
+        parent.numFinished++;
+        if (parent.type != CommandComposition::Type::SEQUENCE)
+        {
+            this->pendingFinish.set(parentIndex);
+            return;
+        }
+
+        // Like SequentialCommand, the next command is started on the next tick at the earliest
+        parent.current = this->nodes[i].subtreeEnd;
+        parent.currentInitialized = false;
+        if (parent.current == parent.subtreeEnd)
+        {
+            parent.active = false;
+            this->scheduled.reset(parentIndex);
+            childFinished(parentIndex);
+        }
+        else
+        {
+            this->scheduled.set(parentIndex);
+        }
+    }
+
+    /**
+     * Finishes the pending concurrent nodes whose subtrees end before node `next`, which the
+     * composites would do once they have executed all of their children.
+     */
+    void finishCompositesBefore(int next)
+    {
+        if (this->pendingFinish.none())
+        {
+            return;
+        }
+
+        // Nested nodes come after their parents, so finishing them first finishes the parents
+        // in the same pass
+        for (int i = next - 1; i >= 0; i--)
+        {
+            if (!this->pendingFinish.test(i) || this->nodes[i].subtreeEnd > next)
+            {
+                continue;
+            }
+            this->pendingFinish.reset(i);
+
+            Node& node = this->nodes[i];
+            const bool done = node.type == CommandComposition::Type::RACE
+                                  ? node.numFinished > 0
+                                  : node.numFinished == node.numChildren;
+            if (node.active && done)
+            {
+                // Children of a race that are still running are interrupted
+                interruptChildren(i, true);
+                node.active = false;
+                childFinished(i);
+            }
+        }
+    }
+
+    /// Ends the node if it is active, like the composites do when the node's parent is ended.
+    void interrupt(int i, bool interrupted)
+    {
+        Node& node = this->nodes[i];
+        if (!node.active)
+        {
+            return;
+        }
+        node.active = false;
+        this->scheduled.reset(i);
+
+        switch (node.type)
+        {
+            case CommandComposition::Type::NONE:
+                node.command->end(interrupted);
+                break;
+            case CommandComposition::Type::SEQUENCE:
+                if (node.currentInitialized)
+                {
+                    interrupt(node.current, interrupted);
+                }
+                break;
+            case CommandComposition::Type::CONCURRENT:
+                interruptChildren(i, interrupted);
+                break;
+            case CommandComposition::Type::RACE:
+                interruptChildren(i, true);
+                break;
+        }
+    }
+
+    void interruptChildren(int i, bool interrupted)
+    {
+        for (int child = i + 1; child < this->nodes[i].subtreeEnd;
+             child = this->nodes[child].subtreeEnd)
+        {
+            interrupt(child, interrupted);
+        }
+    }
+};  // class FlattenedCommand
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // TAPROOT_FLATTENED_COMMAND_HPP_
@@ -20,14 +20,34 @@
 #ifndef TAPROOT_COMMAND_GOVERNOR_INTERFACE_HPP_
 #define TAPROOT_COMMAND_GOVERNOR_INTERFACE_HPP_
 
+#include <cstdint>
+
+#include "../command.hpp"
+#include "../command_scheduler.hpp"
+
 namespace tap::control::governor
 {
+/**
+ * Links a governed command into the list of commands a governor notifies when it wants them to
+ * finish, see `CommandGovernorInterface::notifyFinish`.
+ */
+struct GovernorFinishListener
+{
+    Command *command = nullptr;
+    GovernorFinishListener *next = nullptr;
+};
+
 /**
  * An interface that is used to gate the execution of a Command. Override this interface to gate
  * various commands based on some conditional logic. For example, create a sub-class of this
  * interface and have isReady return true when the ref system indicates you have enough heat to
  * launch a projectile. Then, use a GovernorLimitedCommand to only run a command that launches
  * a projectile when the CommandGovernorInterface sub-object you created is true.
+ *
+ * Governors that decide to finish their commands on an event, such as a match phase changing,
+ * rather than on a condition evaluated each tick can call `setNotifiesFinish` in their
+ * constructor and `notifyFinish` on the event. `GovernorLimitedCommand` then no longer polls
+ * their `isFinished` each tick.
  */
 class CommandGovernorInterface
 {
@@ -38,8 +58,117 @@ class CommandGovernorInterface
     /// Returns true if the Command being governed by the governor may execute.
     virtual bool isReady() = 0;
 
-    /// Returns true if the Command being governed by the governor should stop executing.
+    /**
+     * Returns true if the Command being governed by the governor should stop executing. Still
+     * called by commands other than `GovernorLimitedCommand` if the governor notifies finish.
+     */
     virtual bool isFinished() = 0;
+
+    /// @return `isReady()`, evaluated at most once per tick if the governor is cached per tick.
+    bool isReadyThisTick()
+    {
+        if (!cachedPerTick)
+        {
+            return isReady();
+        }
+        startCacheTick();
+        if (!readyCached)
+        {
+            ready = isReady();
+            readyCached = true;
+        }
+        return ready;
+    }
+
+    /// @return `isFinished()`, evaluated at most once per tick if the governor is cached per tick.
+    bool isFinishedThisTick()
+    {
+        if (!cachedPerTick)
+        {
+            return isFinished();
+        }
+        startCacheTick();
+        if (!finishedCached)
+        {
+            finished = isFinished();
+            finishedCached = true;
+        }
+        return finished;
+    }
+
+    /**
+     * Makes the next `isReadyThisTick` and `isFinishedThisTick` evaluate the governor again.
+     * Called by the governed commands after `onGovernedCommandInitialized`.
+     */
+    void invalidateCache()
+    {
+        readyCached = false;
+        finishedCached = false;
+    }
+
+    /// @return `true` if the governor calls `notifyFinish` instead of being polled.
+    bool notifiesFinish() const { return notifying; }
+
+    /// Adds a command to request to finish on `notifyFinish`. The listener must outlive the link.
+    void addFinishListener(GovernorFinishListener &listener)
+    {
+        listener.next = listeners;
+        listeners = &listener;
+    }
+
+    void removeFinishListener(GovernorFinishListener &listener)
+    {
+        for (GovernorFinishListener **link = &listeners; *link != nullptr; link = &(*link)->next)
+        {
+            if (*link == &listener)
+            {
+                *link = listener.next;
+                listener.next = nullptr;
+                return;
+            }
+        }
+    }
+
+protected:
+    /// Opts the governor into notifying its commands to finish instead of being polled.
+    void setNotifiesFinish() { notifying = true; }
+
+    /// Opts the governor into being evaluated at most once per tick by the governed commands.
+    void setCachedPerTick() { cachedPerTick = true; }
+
+    /**
+     * Requests each governed command to finish, see `Command::requestFinish`. Requests to
+     * commands that aren't running are cleared when they are next initialized.
+     */
+    void notifyFinish()
+    {
+        for (GovernorFinishListener *listener = listeners; listener != nullptr;
+             listener = listener->next)
+        {
+            listener->command->requestFinish();
+        }
+    }
+
+private:
+    bool notifying = false;
+    GovernorFinishListener *listeners = nullptr;
+
+    bool cachedPerTick = false;
+    bool readyCached = false;
+    bool finishedCached = false;
+    bool ready = false;
+    bool finished = false;
+    uint32_t cacheTick = 0;
+
+    void startCacheTick()
+    {
+        const uint32_t tick = CommandScheduler::getTickCount();
+        if (tick != cacheTick)
+        {
+            cacheTick = tick;
+            invalidateCache();
+        }
+    }
 };
 }  // namespace tap::control::governor
 
@@ -22,7 +22,6 @@
 
 #include <array>
 #include <cassert>
-#include <vector>
 
 #include "../command.hpp"
 
@@ -35,24 +34,69 @@ namespace tap::control::governor
  * governors all allow it to. All governors also have control over ending the command. If one of the
  * governors believes the command should be finished, the command will be finished.
  *
+ * Governors that notify finish (see `CommandGovernorInterface::setNotifiesFinish`) request this
+ * command to finish instead of being polled each tick. If the governed command also finishes on
+ * request only and all governors notify finish, so does this command, and the scheduler doesn't
+ * poll it at all.
+ *
  * @tparam NUM_CONDITIONS The number of governors in the governor list.
  */
 template <size_t NUM_CONDITIONS>
 class GovernorLimitedCommand : public Command
 {
 public:
+    /**
+     * @param[in] requirements The subsystems required, which must match `command`'s.
+     */
     GovernorLimitedCommand(
-        const std::vector<Subsystem *> &subRequirements,
+        const subsystem_scheduler_bitmap_t &requirements,
         Command &command,
         const std::array<CommandGovernorInterface *, NUM_CONDITIONS> &commandGovernorList)
-        : command(command),
+        : Command(requirements),
+          command(command),
           commandGovernorList(commandGovernorList)
     {
-        std::for_each(
-            subRequirements.begin(),
-            subRequirements.end(),
-            [&](auto sub) { addSubsystemRequirement(sub); });
         assert(command.getRequirementsBitwise() == this->getRequirementsBitwise());
+
+        bool allGovernorsNotify = true;
+        for (size_t i = 0; i < NUM_CONDITIONS; i++)
+        {
+            if (commandGovernorList[i]->notifiesFinish())
+            {
+                finishListeners[i].command = this;
+                commandGovernorList[i]->addFinishListener(finishListeners[i]);
+            }
+            else
+            {
+                allGovernorsNotify = false;
+            }
+        }
+        if (allGovernorsNotify && command.finishesOnRequest())
+        {
+            setFinishesOnRequest();
+        }
+    }
+
+    GovernorLimitedCommand(
+        std::initializer_list<Subsystem *> subRequirements,
+        Command &command,
+        const std::array<CommandGovernorInterface *, NUM_CONDITIONS> &commandGovernorList)
+        : GovernorLimitedCommand(
+              Command::requirementsOf(subRequirements),
+              command,
+              commandGovernorList)
+    {
+    }
+
+    ~GovernorLimitedCommand()
+    {
+        for (size_t i = 0; i < NUM_CONDITIONS; i++)
+        {
+            if (finishListeners[i].command != nullptr)
+            {
+                commandGovernorList[i]->removeFinishListener(finishListeners[i]);
+            }
+        }
     }
 
     const char *getName() const override { return command.getName(); }
@@ -62,37 +106,51 @@ class GovernorLimitedCommand : public Command
         return std::all_of(
                    commandGovernorList.begin(),
                    commandGovernorList.end(),
-                   [](auto governor) { return governor->isReady(); }) &&
+                   [](auto governor) { return governor->isReadyThisTick(); }) &&
                command.isReady();
     }
 
     void initialize() override
     {
+        command.clearFinishRequest();
         command.initialize();
 
         for (auto governor : commandGovernorList)
         {
             governor->onGovernedCommandInitialized();
+            governor->invalidateCache();
         }
     }
 
-    void execute() override { command.execute(); }
+    void execute() override
+    {
+        command.execute();
+        if (command.isFinishRequested())
+        {
+            requestFinish();
+        }
+    }
 
     void end(bool interrupted) override { command.end(interrupted); }
 
     bool isFinished() const override
     {
-        return std::any_of(
+        // Governors that notify finish have already requested this command to finish
+        return isFinishRequested() ||
+               std::any_of(
                    commandGovernorList.begin(),
                    commandGovernorList.end(),
-                   [](auto governor) { return governor->isFinished(); }) ||
-               command.isFinished();
+                   [](auto governor)
+                   { return !governor->notifiesFinish() && governor->isFinishedThisTick(); }) ||
+               command.checkFinished();
     }
 
 private:
     Command &command;
 
     std::array<CommandGovernorInterface *, NUM_CONDITIONS> commandGovernorList;
+
+    std::array<GovernorFinishListener, NUM_CONDITIONS> finishListeners;
 };
 }  // namespace tap::control::governor
 
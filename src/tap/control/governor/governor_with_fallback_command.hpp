@@ -24,7 +24,6 @@
 #include <array>
 #include <cassert>
 #include <cinttypes>
-#include <vector>
 
 #include "../command.hpp"
 
@@ -43,27 +42,41 @@ template <std::size_t NUM_CONDITIONS>
 class GovernorWithFallbackCommand : public Command
 {
 public:
+    /**
+     * @param[in] requirements The subsystems required, which must match both commands'.
+     */
     GovernorWithFallbackCommand(
-        std::vector<Subsystem *> subRequirements,
+        const subsystem_scheduler_bitmap_t &requirements,
         Command &commandWhenGovernorsReady,
         Command &fallbackCommand,
         const std::array<CommandGovernorInterface *, NUM_CONDITIONS> &commandGovernorList,
         const bool stopFallbackCommandIfGovernorsReady = false)
-        : commandWhenGovernorsReady(commandWhenGovernorsReady),
+        : Command(requirements),
+          commandWhenGovernorsReady(commandWhenGovernorsReady),
           fallbackCommand(fallbackCommand),
           commandGovernorList(commandGovernorList),
           stopFallbackCommandIfGovernorsReady(stopFallbackCommandIfGovernorsReady)
     {
-        std::for_each(
-            subRequirements.begin(),
-            subRequirements.end(),
-            [&](auto sub) { addSubsystemRequirement(sub); });
-
         assert(
             commandWhenGovernorsReady.getRequirementsBitwise() == this->getRequirementsBitwise());
         assert(fallbackCommand.getRequirementsBitwise() == this->getRequirementsBitwise());
     }
 
+    GovernorWithFallbackCommand(
+        std::initializer_list<Subsystem *> subRequirements,
+        Command &commandWhenGovernorsReady,
+        Command &fallbackCommand,
+        const std::array<CommandGovernorInterface *, NUM_CONDITIONS> &commandGovernorList,
+        const bool stopFallbackCommandIfGovernorsReady = false)
+        : GovernorWithFallbackCommand(
+              Command::requirementsOf(subRequirements),
+              commandWhenGovernorsReady,
+              fallbackCommand,
+              commandGovernorList,
+              stopFallbackCommandIfGovernorsReady)
+    {
+    }
+
     const char *getName() const override
     {
         return governedCommandSelected ? commandWhenGovernorsReady.getName()
@@ -137,7 +150,7 @@ class GovernorWithFallbackCommand : public Command
         return std::all_of(
             commandGovernorList.begin(),
             commandGovernorList.end(),
-            [](auto governor) { return governor->isReady(); });
+            [](auto governor) { return governor->isReadyThisTick(); });
     }
 
     bool checkAnyGovernorFinished() const
@@ -145,7 +158,7 @@ class GovernorWithFallbackCommand : public Command
         return std::any_of(
             commandGovernorList.begin(),
             commandGovernorList.end(),
-            [](auto governor) { return governor->isFinished(); });
+            [](auto governor) { return governor->isFinishedThisTick(); });
     }
 };
 }  // namespace tap::control::governor
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "heat_limit_governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+
+using tap::communication::serial::RefSerialData;
+
+namespace tap::control::governor
+{
+HeatLimitGovernor::HeatLimitGovernor(tap::Drivers *drivers, const Config &config)
+    : drivers(drivers),
+      config(config)
+{
+}
+
+bool HeatLimitGovernor::isReady()
+{
+    update();
+    return !drivers->refSerial.getRefSerialReceivingData() ||
+           estimatedHeat + config.heatPerShot <= getAllowedHeat();
+}
+
+bool HeatLimitGovernor::isFinished()
+{
+    update();
+    return drivers->refSerial.getRefSerialReceivingData() && estimatedHeat > getAllowedHeat();
+}
+
+void HeatLimitGovernor::recordShot()
+{
+    update();
+    estimatedHeat += config.heatPerShot;
+
+    if (numRecentShots == MAX_RECENT_SHOTS)
+    {
+        recentShotsStart = (recentShotsStart + 1) % MAX_RECENT_SHOTS;
+        numRecentShots--;
+    }
+    recentShotTimes[(recentShotsStart + numRecentShots) % MAX_RECENT_SHOTS] =
+        tap::arch::clock::getTimeMilliseconds();
+    numRecentShots++;
+}
+
+float HeatLimitGovernor::getEstimatedHeat()
+{
+    update();
+    return estimatedHeat;
+}
+
+int HeatLimitGovernor::getShotsAvailable()
+{
+    update();
+    if (config.heatPerShot == 0)
+    {
+        return INT32_MAX;
+    }
+    return std::max(0, static_cast<int>((getAllowedHeat() - estimatedHeat) / config.heatPerShot));
+}
+
+void HeatLimitGovernor::update()
+{
+    const uint32_t time = tap::arch::clock::getTimeMilliseconds();
+    estimatedHeat = std::max(0.0f, estimatedHeat - coolingRate * (time - prevTime) / 1000.0f);
+    prevTime = time;
+
+    const uint32_t generation = drivers->refSerial.getRobotDataGeneration();
+    if (generation == prevRobotDataGeneration)
+    {
+        return;
+    }
+    RefSerialData::Rx::RobotData robotData;
+    prevRobotDataGeneration = drivers->refSerial.getRobotDataSnapshot(&robotData);
+    heatLimit = robotData.turret.heatLimit;
+    coolingRate = robotData.turret.coolingRate;
+
+    uint16_t heat;
+    switch (config.mechanism)
+    {
+        case RefSerialData::Rx::TURRET_17MM_1:
+            heat = robotData.turret.heat17ID1;
+            break;
+        case RefSerialData::Rx::TURRET_17MM_2:
+            heat = robotData.turret.heat17ID2;
+            break;
+        default:
+            heat = robotData.turret.heat42;
+            break;
+    }
+
+    // Other robot data updates more often than heat, so only a changed heat is a new report
+    if (heat == refereeHeat)
+    {
+        return;
+    }
+    refereeHeat = heat;
+
+    dropOldShots(time);
+    estimatedHeat = refereeHeat + numRecentShots * config.heatPerShot;
+}
+
+void HeatLimitGovernor::dropOldShots(uint32_t time)
+{
+    while (numRecentShots > 0 && time - recentShotTimes[recentShotsStart] > config.refereeLatency)
+    {
+        recentShotsStart = (recentShotsStart + 1) % MAX_RECENT_SHOTS;
+        numRecentShots--;
+    }
+}
+}  // namespace tap::control::governor
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_HEAT_LIMIT_GOVERNOR_HPP_
+#define TAPROOT_HEAT_LIMIT_GOVERNOR_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/serial/ref_serial_data.hpp"
+
+#include "command_governor_interface.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::control::governor
+{
+/**
+ * A governor that allows a launch command to run only while one more shot keeps the barrel's heat
+ * within the referee system's heat limit.
+ *
+ * The referee reports heat a frame or more late, so gating on the reported heat alone either
+ * fires past the limit during a burst or waits for heat that has already cooled. Instead, this
+ * governor counts shots itself and models the barrel's heat every control loop, adding
+ * `heatPerShot` per shot and cooling at the referee's `coolingRate`. Whenever the referee reports
+ * a new heat, the model is reset to it plus the heat of the shots fired in the last
+ * `refereeLatency` ms, which the report cannot include yet, so miscounted shots don't accumulate.
+ *
+ * By default each time the governed command is initialized counts as one shot, which suits
+ * commands that launch a single projectile. Launchers that detect shots otherwise, such as by a
+ * beam break, should clear `countGovernedCommands` and call `recordShot` for each shot.
+ *
+ * If the referee system is not connected, the governor does not limit the command.
+ */
+class HeatLimitGovernor : public CommandGovernorInterface
+{
+public:
+    using MechanismID = tap::communication::serial::RefSerialData::Rx::MechanismID;
+
+    struct Config
+    {
+        /// The barrel whose heat is limited.
+        MechanismID mechanism;
+        /// The heat each shot adds, 10 for 17 mm and 100 for 42 mm projectiles.
+        uint16_t heatPerShot;
+        /// Heat below the referee's limit that is kept unused as a margin.
+        uint16_t heatLimitMargin;
+        /// Time in ms between a shot and the first referee heat report to include it.
+        uint32_t refereeLatency;
+        /// Whether each initialization of the governed command counts as a shot.
+        bool countGovernedCommands = true;
+    };
+
+    /// The most shots within `refereeLatency` of each other that are tracked.
+    static constexpr int MAX_RECENT_SHOTS = 32;
+
+    HeatLimitGovernor(tap::Drivers *drivers, const Config &config);
+
+    void onGovernedCommandInitialized() override
+    {
+        if (config.countGovernedCommands)
+        {
+            recordShot();
+        }
+    }
+
+    /// @return `true` if one more shot keeps the estimated heat within the limit.
+    bool isReady() override;
+
+    /// @return `true` if the estimated heat is already over the limit.
+    bool isFinished() override;
+
+    /// Adds one shot to the heat model.
+    void recordShot();
+
+    /// @return The estimated barrel heat, updated to the present.
+    float getEstimatedHeat();
+
+    /**
+     * @return The number of shots that may be fired right now without exceeding the heat limit,
+     *      not counting cooling between them.
+     */
+    int getShotsAvailable();
+
+private:
+    tap::Drivers *drivers;
+    const Config config;
+
+    float estimatedHeat = 0;
+    uint32_t prevTime = 0;
+
+    uint32_t prevRobotDataGeneration = 0;
+    uint16_t refereeHeat = 0;
+    uint16_t heatLimit = 0;
+    uint16_t coolingRate = 0;
+
+    /// Times of recent shots, oldest first, in a ring of `MAX_RECENT_SHOTS`.
+    uint32_t recentShotTimes[MAX_RECENT_SHOTS] = {};
+    int recentShotsStart = 0;
+    int numRecentShots = 0;
+
+    /// Cools the model to the present and reconciles it with any new referee heat report.
+    void update();
+
+    /// @return The heat allowed, `heatLimit` less `heatLimitMargin`.
+    float getAllowedHeat() const { return static_cast<float>(heatLimit) - config.heatLimitMargin; }
+
+    /// Forgets shots older than `refereeLatency`.
+    void dropOldShots(uint32_t time);
+};
+}  // namespace tap::control::governor
+
+#endif  // TAPROOT_HEAT_LIMIT_GOVERNOR_HPP_
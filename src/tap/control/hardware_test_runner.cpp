@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "hardware_test_runner.hpp"
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+
+#include "command.hpp"
+#include "subsystem.hpp"
+
+namespace tap
+{
+namespace control
+{
+constexpr char HardwareTestRunner::HEADER[];
+constexpr char HardwareTestRunner::USAGE[];
+constexpr algorithms::TokenTableEntry<HardwareTestRunner::Subcommand>
+    HardwareTestRunner::SUBCOMMANDS[];
+
+HardwareTestRunner::HardwareTestRunner(Drivers* drivers) : drivers(drivers) {}
+
+void HardwareTestRunner::init() { drivers->terminalSerial.addHeader(HEADER, this); }
+
+bool HardwareTestRunner::addTest(const Subsystem* subsystem, uint32_t timeoutMs)
+{
+    if (subsystem == nullptr || subsystem->getTestCommand() == nullptr || isRunning())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numTests; i++)
+    {
+        if (results[i].subsystem == subsystem)
+        {
+            results[i].timeoutMs = timeoutMs;
+            return true;
+        }
+    }
+
+    if (numTests >= MAX_TESTS)
+    {
+        return false;
+    }
+
+    results[numTests] = TestResult();
+    results[numTests].subsystem = subsystem;
+    results[numTests].timeoutMs = timeoutMs;
+    numTests++;
+    return true;
+}
+
+int HardwareTestRunner::addAllTests(uint32_t timeoutMs)
+{
+    int added = 0;
+    for (auto it = drivers->commandScheduler.subMapBegin();
+         it != drivers->commandScheduler.subMapEnd();
+         it++)
+    {
+        if ((*it)->getTestCommand() != nullptr && getResult(*it) == nullptr &&
+            addTest(*it, timeoutMs))
+        {
+            added++;
+        }
+    }
+    return added;
+}
+
+void HardwareTestRunner::start()
+{
+    stop();
+
+    for (int i = 0; i < numTests; i++)
+    {
+        results[i].status = Status::PENDING;
+        results[i].durationMs = 0;
+    }
+    numPending = numTests;
+    numRunning = 0;
+    numPassed = 0;
+    numFailed = 0;
+    numTimedOut = 0;
+    runStartTime = arch::clock::getTimeMilliseconds();
+    runDurationMs = 0;
+}
+
+void HardwareTestRunner::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    const uint32_t now = arch::clock::getTimeMilliseconds();
+    for (int i = 0; i < numTests; i++)
+    {
+        TestResult& result = results[i];
+        if (result.status == Status::RUNNING)
+        {
+            drivers->commandScheduler.stopHardwareTest(result.subsystem);
+            result.durationMs = now - result.startTime;
+            result.status = Status::STOPPED;
+        }
+        else if (result.status == Status::PENDING)
+        {
+            result.status = Status::STOPPED;
+        }
+    }
+    numPending = 0;
+    numRunning = 0;
+    runDurationMs = now - runStartTime;
+}
+
+void HardwareTestRunner::update()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    CommandScheduler& scheduler = drivers->commandScheduler;
+    const uint32_t now = arch::clock::getTimeMilliseconds();
+
+    // Check the running tests first so the subsystems of finished tests are free for pending ones
+    subsystem_scheduler_bitmap_t busySubsystems;
+    for (int i = 0; i < numTests; i++)
+    {
+        TestResult& result = results[i];
+        if (result.status != Status::RUNNING)
+        {
+            continue;
+        }
+
+        if (scheduler.hasPassedTest(result.subsystem))
+        {
+            finishTest(result, Status::PASSED, now);
+        }
+        else if (!scheduler.isRunningTest(result.subsystem))
+        {
+            finishTest(result, Status::FAILED, now);
+        }
+        else if (now - result.startTime >= result.timeoutMs)
+        {
+            scheduler.stopHardwareTest(result.subsystem);
+            finishTest(result, Status::TIMED_OUT, now);
+        }
+        else
+        {
+            busySubsystems |= result.subsystem->getTestCommand()->getRequirementsBitwise();
+        }
+    }
+
+    for (int i = 0; i < numTests && numPending > 0; i++)
+    {
+        TestResult& result = results[i];
+        if (result.status != Status::PENDING)
+        {
+            continue;
+        }
+
+        Command* testCommand = result.subsystem->getTestCommand();
+        subsystem_scheduler_bitmap_t requirements;
+        if (testCommand != nullptr)
+        {
+            requirements = testCommand->getRequirementsBitwise();
+            if ((requirements & busySubsystems).any())
+            {
+                continue;
+            }
+            scheduler.runHardwareTest(result.subsystem);
+        }
+
+        numPending--;
+        numRunning++;
+        result.startTime = now;
+        if (testCommand != nullptr && scheduler.isRunningTest(result.subsystem))
+        {
+            result.status = Status::RUNNING;
+            busySubsystems |= requirements;
+        }
+        else
+        {
+            finishTest(result, Status::FAILED, now);
+        }
+    }
+
+    if (!isRunning())
+    {
+        runDurationMs = now - runStartTime;
+    }
+}
+
+const HardwareTestRunner::TestResult* HardwareTestRunner::getResult(
+    const Subsystem* subsystem) const
+{
+    for (int i = 0; i < numTests; i++)
+    {
+        if (results[i].subsystem == subsystem)
+        {
+            return &results[i];
+        }
+    }
+    return nullptr;
+}
+
+const char* HardwareTestRunner::getStatusName(Status status)
+{
+    switch (status)
+    {
+        case Status::NOT_RUN:
+            return "not run";
+        case Status::PENDING:
+            return "pending";
+        case Status::RUNNING:
+            return "running";
+        case Status::PASSED:
+            return "passed";
+        case Status::FAILED:
+            return "failed";
+        case Status::TIMED_OUT:
+            return "timed out";
+        case Status::STOPPED:
+            return "stopped";
+    }
+    return "unknown";
+}
+
+void HardwareTestRunner::finishTest(TestResult& result, Status status, uint32_t now)
+{
+    result.status = status;
+    result.durationMs = now - result.startTime;
+    numRunning--;
+
+    if (status == Status::PASSED)
+    {
+        numPassed++;
+    }
+    else
+    {
+        if (status == Status::TIMED_OUT)
+        {
+            numTimedOut++;
+        }
+        else
+        {
+            numFailed++;
+        }
+        result.numFailures++;
+    }
+}
+
+bool HardwareTestRunner::terminalSerialCallback(
+    char* inputLine,
+    modm::IOStream& outputStream,
+    bool streamingEnabled)
+{
+    algorithms::TokenView tokens(inputLine);
+    Subcommand subcommand;
+    if (!tokens.nextIn(SUBCOMMANDS, subcommand) || !tokens.empty())
+    {
+        outputStream << USAGE;
+        return false;
+    }
+
+    switch (subcommand)
+    {
+        case Subcommand::RUN:
+            addAllTests();
+            start();
+            outputStream << "Running " << numTests << " hardware tests" << modm::endl;
+            return !streamingEnabled;
+        case Subcommand::STOP:
+            stop();
+            outputStream << "Hardware tests stopped" << modm::endl;
+            return !streamingEnabled;
+        case Subcommand::REPORT:
+            printReport(outputStream);
+            return true;
+        case Subcommand::TELEMETRY:
+            addTelemetrySignals(outputStream);
+            return !streamingEnabled;
+        case Subcommand::HELP:
+            outputStream << USAGE;
+            return !streamingEnabled;
+    }
+    return false;
+}
+
+void HardwareTestRunner::terminalSerialStreamCallback(modm::IOStream& outputStream)
+{
+    printReport(outputStream);
+}
+
+void HardwareTestRunner::printReport(modm::IOStream& outputStream)
+{
+    // Counts are cast so they aren't printed as characters
+    outputStream << "Hardware tests: " << static_cast<int>(numPassed) << " passed, "
+                 << static_cast<int>(numFailed) << " failed, " << static_cast<int>(numTimedOut)
+                 << " timed out";
+    if (isRunning())
+    {
+        outputStream << ", " << static_cast<int>(numRunning) << " running, "
+                     << static_cast<int>(numPending) << " pending";
+    }
+    else
+    {
+        outputStream << " in " << runDurationMs << " ms";
+    }
+    outputStream << modm::endl;
+
+    outputStream << "status\tms\tfailures\tname" << modm::endl;
+    for (int i = 0; i < numTests; i++)
+    {
+        const TestResult& result = results[i];
+        outputStream.printf(
+            "%s\t%lu\t%u\t%s\n",
+            getStatusName(result.status),
+            static_cast<unsigned long>(result.durationMs),
+            static_cast<unsigned>(result.numFailures),
+            result.subsystem->getName());
+    }
+}
+
+void HardwareTestRunner::addTelemetrySignals(modm::IOStream& outputStream)
+{
+    communication::serial::TelemetryStream& telemetry =
+        drivers->terminalSerial.getTelemetryStream();
+
+    bool added = telemetry.addSignal("hwtest_passed", &numPassed) &&
+                 telemetry.addSignal("hwtest_failed", &numFailed) &&
+                 telemetry.addSignal("hwtest_timed_out", &numTimedOut) &&
+                 telemetry.addSignal("hwtest_running", &numRunning);
+
+    outputStream << (added ? "Added" : "Couldn't add") << " hardware test counts to telemetry"
+                 << modm::endl;
+}
+}  // namespace control
+
+}  // namespace tap
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_HARDWARE_TEST_RUNNER_HPP_
+#define TAPROOT_HARDWARE_TEST_RUNNER_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/serial/terminal_serial.hpp"
+#include "tap/util_macros.hpp"
+
+#include "command_scheduler_types.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace control
+{
+class Subsystem;
+
+/**
+ * Runs the hardware tests of subsystems (see `Subsystem::setTestCommand`) as fast as their
+ * requirements allow, with a timeout per test, and records how each test went.
+ *
+ * `CommandScheduler::runAllHardwareTests` adds every test command at once, so tests requiring the
+ * same subsystem interrupt each other. The runner instead starts each test as soon as none of
+ * the subsystems its test command requires are used by a running test, so tests of unrelated
+ * subsystems run concurrently and tests that share subsystems run one after another. A test
+ * passes once `CommandScheduler::hasPassedTest` is `true` for its subsystem, fails if its test
+ * command ends without passing or can't be scheduled, and times out if it runs longer than its
+ * timeout, in which case it is stopped.
+ *
+ * Typing `hwtest run` in the terminal runs all tests and `hwtest report` prints each test's
+ * status, duration, and number of failures over all runs. `hwtest telemetry` adds the number of
+ * passed, failed, and timed out tests to the telemetry stream, so a pre-match check can be
+ * watched from the computer.
+ *
+ * Usage:
+ *
+ * ```
+ * HardwareTestRunner testRunner(drivers);
+ * testRunner.init();
+ * testRunner.addTest(&chassis, 2'000);
+ * testRunner.addAllTests();
+ *
+ * // In the main loop, after drivers->commandScheduler.run()
+ * testRunner.update();
+ * ```
+ */
+class HardwareTestRunner : public communication::serial::TerminalSerialCallbackInterface
+{
+public:
+    static constexpr char HEADER[] = "hwtest";
+
+    static constexpr int MAX_TESTS = 16;
+
+    static constexpr uint32_t DEFAULT_TIMEOUT_MS = 5'000;
+
+    enum class Status : uint8_t
+    {
+        NOT_RUN = 0,
+        /// Waiting for the subsystems the test requires to be free.
+        PENDING,
+        RUNNING,
+        PASSED,
+        /// The test command ended without passing or couldn't be scheduled.
+        FAILED,
+        /// The test ran longer than its timeout and was stopped.
+        TIMED_OUT,
+        /// The run was stopped before the test finished.
+        STOPPED,
+    };
+
+    struct TestResult
+    {
+        const Subsystem* subsystem = nullptr;
+        uint32_t timeoutMs = 0;
+        Status status = Status::NOT_RUN;
+        /// Time the test was started at, in milliseconds.
+        uint32_t startTime = 0;
+        /// Time from the test starting to it finishing, in milliseconds.
+        uint32_t durationMs = 0;
+        /// Number of runs the test failed or timed out in.
+        uint16_t numFailures = 0;
+    };
+
+    HardwareTestRunner(Drivers* drivers);
+    DISALLOW_COPY_AND_ASSIGN(HardwareTestRunner)
+    mockable ~HardwareTestRunner() = default;
+
+    /// Adds the `hwtest` command to the terminal.
+    mockable void init();
+
+    /**
+     * Adds the test of a subsystem to the tests that are run, or updates its timeout if it was
+     * already added. Tests are started in the order they were added when their requirements
+     * allow.
+     *
+     * @return `false` if the subsystem has no test command, tests are running, or `MAX_TESTS`
+     *      tests were already added, `true` otherwise.
+     */
+    bool addTest(const Subsystem* subsystem, uint32_t timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    /**
+     * Adds the tests of all registered subsystems with a test command that weren't added yet.
+     *
+     * @return The number of tests added.
+     */
+    int addAllTests(uint32_t timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    /// Starts running all tests, clearing the results of the last run.
+    mockable void start();
+
+    /// Stops all running tests, marking unfinished tests `STOPPED`.
+    mockable void stop();
+
+    /**
+     * Checks the running tests for completion and timeouts and starts pending tests whose
+     * requirements are free. Call each main loop after the command scheduler runs.
+     */
+    mockable void update();
+
+    /// @return `true` if any test is pending or running.
+    bool isRunning() const { return numRunning > 0 || numPending > 0; }
+
+    int getNumTests() const { return numTests; }
+
+    const TestResult& getResult(int index) const { return results[index]; }
+
+    /// @return The result of the subsystem's test, or `nullptr` if it wasn't added.
+    const TestResult* getResult(const Subsystem* subsystem) const;
+
+    uint8_t getNumPassed() const { return numPassed; }
+
+    uint8_t getNumFailed() const { return numFailed; }
+
+    uint8_t getNumTimedOut() const { return numTimedOut; }
+
+    /// @return The time from the start of the last run to its last test finishing, in ms.
+    uint32_t getRunDurationMs() const { return runDurationMs; }
+
+    static const char* getStatusName(Status status);
+
+    bool terminalSerialCallback(
+        char* inputLine,
+        modm::IOStream& outputStream,
+        bool streamingEnabled) override;
+
+    void terminalSerialStreamCallback(modm::IOStream& outputStream) override;
+
+private:
+    static constexpr char USAGE[] =
+        "Usage: hwtest <[-H] | [run] | [stop] | [report] | [telemetry]>\n"
+        "  Where:\n"
+        "    - [-H]        prints usage\n"
+        "    - [run]       runs the tests of all registered subsystems\n"
+        "    - [stop]      stops all running tests\n"
+        "    - [report]    prints the result of each test, streams the report\n"
+        "    - [telemetry] adds the number of passed/failed/timed out tests to the telemetry\n"
+        "                  stream\n";
+
+    enum class Subcommand
+    {
+        RUN,
+        STOP,
+        REPORT,
+        TELEMETRY,
+        HELP,
+    };
+    static constexpr algorithms::TokenTableEntry<Subcommand> SUBCOMMANDS[] = {
+        {"run", Subcommand::RUN},
+        {"stop", Subcommand::STOP},
+        {"report", Subcommand::REPORT},
+        {"telemetry", Subcommand::TELEMETRY},
+        {"-H", Subcommand::HELP},
+    };
+
+    Drivers* drivers;
+
+    TestResult results[MAX_TESTS];
+
+    int numTests = 0;
+
+    uint32_t runStartTime = 0;
+    uint32_t runDurationMs = 0;
+
+    uint8_t numPending = 0;
+    uint8_t numRunning = 0;
+    uint8_t numPassed = 0;
+    uint8_t numFailed = 0;
+    uint8_t numTimedOut = 0;
+
+    /// Records how a started test finished.
+    void finishTest(TestResult& result, Status status, uint32_t now);
+
+    void printReport(modm::IOStream& outputStream);
+
+    void addTelemetrySignals(modm::IOStream& outputStream);
+};  // class HardwareTestRunner
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // TAPROOT_HARDWARE_TEST_RUNNER_HPP_
@@ -59,6 +59,8 @@ class HoldCommandMapping : public CommandMapping
 
     void executeCommandMapping(const RemoteMapState &currState) override;
 
+    bool reactsOnlyToInputChanges() const override { return true; }
+
 private:
     bool commandScheduled;
 };  // class HoldCommandMapping
@@ -19,6 +19,7 @@
 
 #include "hold_repeat_command_mapping.hpp"
 
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 
 namespace tap
@@ -33,17 +34,11 @@ void HoldRepeatCommandMapping::executeCommandMapping(const RemoteMapState &currS
     if (mappingSubset(currState) &&
         !(mapState.getNegKeysUsed() && negKeysSubset(mapState, currState)))
     {
-        for (std::size_t i = 0; i < mappedCommands.size(); i++)
+        // With a repeat period, commands are only added here when the mapping starts being held
+        if (repeatPeriodMs == 0 || !held)
         {
-            Command *cmd = mappedCommands[i];
-            if (!drivers->commandScheduler.isCommandScheduled(cmd))
-            {
-                if (okToScheduleCommand(i))
-                {
-                    drivers->commandScheduler.addCommand(cmd);
-                    incrementRescheduleCount(i);
-                }
-            }
+            scheduleCommands();
+            nextRepeatTime = arch::clock::getTimeMilliseconds() + repeatPeriodMs;
         }
         held = true;
     }
@@ -67,5 +62,44 @@ void HoldRepeatCommandMapping::executeCommandMapping(const RemoteMapState &currS
         }
     }
 }
+
+void HoldRepeatCommandMapping::update()
+{
+    if (!held || repeatPeriodMs == 0)
+    {
+        return;
+    }
+
+    const uint32_t now = arch::clock::getTimeMilliseconds();
+    if (static_cast<int32_t>(now - nextRepeatTime) < 0)
+    {
+        return;
+    }
+
+    // Like PeriodicTimer, skip the periods missed by a late update so repeats stay aligned to
+    // when the mapping started being held
+    do
+    {
+        nextRepeatTime += repeatPeriodMs;
+    } while (static_cast<int32_t>(now - nextRepeatTime) >= 0);
+
+    scheduleCommands();
+}
+
+void HoldRepeatCommandMapping::scheduleCommands()
+{
+    for (std::size_t i = 0; i < mappedCommands.size(); i++)
+    {
+        Command *cmd = mappedCommands[i];
+        if (!drivers->commandScheduler.isCommandScheduled(cmd))
+        {
+            if (okToScheduleCommand(i))
+            {
+                drivers->commandScheduler.addCommand(cmd);
+                incrementRescheduleCount(i);
+            }
+        }
+    }
+}
 }  // namespace control
 }  // namespace tap
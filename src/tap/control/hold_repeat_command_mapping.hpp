@@ -20,6 +20,8 @@
 #ifndef TAPROOT_HOLD_REPEAT_COMMAND_MAPPING_HPP_
 #define TAPROOT_HOLD_REPEAT_COMMAND_MAPPING_HPP_
 
+#include <cstdint>
+
 #include "command_mapping.hpp"
 
 namespace tap
@@ -39,6 +41,12 @@ class RemoteMapState;
  *
  * Additionally, When neg keys are being used and the mapping's neg keys are a subset of the remote
  * map state, the `Command`s are removed.
+ *
+ * By default, commands are added again when remote information is received, so the rate they
+ * repeat at depends on the rate of remote frames. When a repeat period is given, commands are
+ * added when the mapping starts being held and then every period after that, as checked each
+ * tick by `CommandMapper::update`, for example for a burst fire mode with a precise shot cadence.
+ * A command that is still scheduled when a repeat is due skips that repeat.
  */
 class HoldRepeatCommandMapping : public CommandMapping
 {
@@ -55,18 +63,22 @@ class HoldRepeatCommandMapping : public CommandMapping
      * passed in, the command mapping will continue to reschedule the commands forever. If there are
      * multiple commands that have the potential to end, each command will be scheduled
      * maxTimesToSchedule.
+     * @param[in] repeatPeriodMs If not 0, the commands are added again every `repeatPeriodMs`
+     * milliseconds while held, rather than whenever remote information is received.
      */
     HoldRepeatCommandMapping(
         Drivers *drivers,
         const std::vector<Command *> cmds,
         const RemoteMapState &rms,
         bool endCommandsWhenNotHeld,
-        int maxTimesToSchedule = -1)
+        int maxTimesToSchedule = -1,
+        uint32_t repeatPeriodMs = 0)
         : CommandMapping(drivers, cmds, rms),
           held(false),
           endCommandsWhenNotHeld(endCommandsWhenNotHeld),
           maxTimesToSchedule(maxTimesToSchedule),
-          rescheduleCounts(mappedCommands.size(), 0)
+          rescheduleCounts(mappedCommands.size(), 0),
+          repeatPeriodMs(repeatPeriodMs)
     {
     }
 
@@ -77,6 +89,17 @@ class HoldRepeatCommandMapping : public CommandMapping
 
     void executeCommandMapping(const RemoteMapState &currState) override;
 
+    /// Adds the commands again if a repeat is due. Only called when a repeat period is given.
+    void update() override;
+
+    /**
+     * With a repeat period, commands are only added when the mapping starts being held and by
+     * `update`, so the mapping only needs to be executed when an input it reads changes.
+     */
+    bool reactsOnlyToInputChanges() const override { return repeatPeriodMs != 0; }
+
+    bool isUpdatedEachTick() const override { return repeatPeriodMs != 0; }
+
     /// Set the maximum times each of commands should be re-scheduled.
     inline mockable void setMaxTimesToSchedule(int maxTimes) { maxTimesToSchedule = maxTimes; }
 
@@ -85,6 +108,12 @@ class HoldRepeatCommandMapping : public CommandMapping
     bool endCommandsWhenNotHeld;
     int maxTimesToSchedule;
     std::vector<int> rescheduleCounts;
+    uint32_t repeatPeriodMs;
+    /// Time the next repeat is due at, in milliseconds, when a repeat period is given.
+    uint32_t nextRepeatTime = 0;
+
+    /// Adds each command that isn't scheduled and hasn't been scheduled the maximum times.
+    void scheduleCommands();
 
     inline void incrementRescheduleCount(int cmdIndex)
     {
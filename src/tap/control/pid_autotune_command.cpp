@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "pid_autotune_command.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#include "subsystem.hpp"
+
+using namespace tap::algorithms;
+
+namespace tap::control
+{
+PidAutotuneCommand::PidAutotuneCommand(
+    Subsystem *subsystem,
+    tap::motor::MotorInterface *motor,
+    Measurement measurement,
+    float setpoint,
+    const RelayAutotunerConfig &config,
+    TuningRule rule,
+    GainsCallback callback,
+    void *context)
+    : motor(motor),
+      measurement(measurement),
+      setpoint(setpoint),
+      rule(rule),
+      callback(callback),
+      context(context),
+      autotuner(config)
+{
+    addSubsystemRequirement(subsystem);
+}
+
+bool PidAutotuneCommand::isReady() { return motor->isMotorOnline(); }
+
+void PidAutotuneCommand::initialize()
+{
+    autotuner.start(setpoint, tap::arch::clock::getTimeMicroseconds());
+}
+
+void PidAutotuneCommand::execute()
+{
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+    motor->setDesiredOutput(autotuner.update(getMeasurement(), time));
+}
+
+void PidAutotuneCommand::end(bool)
+{
+    motor->setDesiredOutput(0);
+    if (autotuner.getState() == RelayAutotuner::State::DONE && callback != nullptr)
+    {
+        callback(autotuner.computeGains(rule), context);
+    }
+}
+
+bool PidAutotuneCommand::isFinished() const
+{
+    return autotuner.getState() != RelayAutotuner::State::RUNNING || !motor->isMotorOnline();
+}
+
+float PidAutotuneCommand::getMeasurement() const
+{
+    switch (measurement)
+    {
+        case Measurement::SHAFT_RPM:
+            return motor->getShaftRPM();
+        case Measurement::POSITION_UNWRAPPED:
+        default:
+            return motor->getPositionUnwrapped();
+    }
+}
+}  // namespace tap::control
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_PID_AUTOTUNE_COMMAND_HPP_
+#define TAPROOT_PID_AUTOTUNE_COMMAND_HPP_
+
+#include "tap/algorithms/relay_autotuner.hpp"
+#include "tap/motor/motor_interface.hpp"
+
+#include "command.hpp"
+
+namespace tap::control
+{
+class Subsystem;
+
+/**
+ * Tunes a motor's PID controller in the pit: takes over the motor from the subsystem that owns
+ * it, runs a `tap::algorithms::RelayAutotuner` experiment on it, and hands the resulting gains
+ * to a callback, which typically applies them and saves them to flash, for example:
+ *
+ * ```cpp
+ * void saveFlywheelGains(const PidGains &gains, void *context)
+ * {
+ *     auto *flywheel = static_cast<FlywheelSubsystem *>(context);
+ *     flywheel->getPid().setP(gains.kp);
+ *     flywheel->getPid().setI(gains.ki);
+ *     flywheel->getPid().setD(gains.kd);
+ *     keyValueStore.set("flywheel.pid", gains);
+ * }
+ *
+ * PidAutotuneCommand autotune(
+ *     &flywheel,
+ *     &flywheelMotor,
+ *     PidAutotuneCommand::Measurement::SHAFT_RPM,
+ *     5'000,
+ *     {.outputBias = 3'000, .relayAmplitude = 2'000, .hysteresis = 50},
+ *     TuningRule::SIMC_PI,
+ *     saveFlywheelGains,
+ *     &flywheel);
+ * ```
+ *
+ * The gains are for the motor's raw output units per measurement unit, with `dt` in seconds.
+ * The command finishes when the experiment does, only calling the callback if it succeeded.
+ */
+class PidAutotuneCommand : public Command
+{
+public:
+    enum class Measurement : uint8_t
+    {
+        /// Tunes a velocity loop on `getShaftRPM`.
+        SHAFT_RPM,
+        /// Tunes a position loop on `getPositionUnwrapped`.
+        POSITION_UNWRAPPED,
+    };
+
+    using GainsCallback = void (*)(const tap::algorithms::PidGains &gains, void *context);
+
+    /**
+     * @param[in] subsystem The subsystem that owns the motor, required by the command so its
+     *      own commands don't drive the motor during the experiment.
+     * @param[in] motor The motor to tune.
+     * @param[in] measurement The motor measurement the tuned loop controls.
+     * @param[in] setpoint The measurement to oscillate around.
+     * @param[in] config The relay experiment, see `tap::algorithms::RelayAutotunerConfig`. The
+     *      output bias and relay amplitude are in motor output units.
+     * @param[in] rule How to turn the measured ultimate gain and period into gains.
+     * @param[in] callback Called with the gains when tuning succeeds.
+     * @param[in] context Passed to `callback`.
+     */
+    PidAutotuneCommand(
+        Subsystem *subsystem,
+        tap::motor::MotorInterface *motor,
+        Measurement measurement,
+        float setpoint,
+        const tap::algorithms::RelayAutotunerConfig &config,
+        tap::algorithms::TuningRule rule,
+        GainsCallback callback,
+        void *context = nullptr);
+
+    const char *getName() const override { return "pid autotune"; }
+
+    bool isReady() override;
+
+    void initialize() override;
+
+    void execute() override;
+
+    void end(bool interrupted) override;
+
+    bool isFinished() const override;
+
+    const tap::algorithms::RelayAutotuner &getAutotuner() const { return autotuner; }
+
+private:
+    tap::motor::MotorInterface *motor;
+    Measurement measurement;
+    float setpoint;
+    tap::algorithms::TuningRule rule;
+    GainsCallback callback;
+    void *context;
+
+    tap::algorithms::RelayAutotuner autotuner;
+
+    float getMeasurement() const;
+};  // class PidAutotuneCommand
+}  // namespace tap::control
+
+#endif  // TAPROOT_PID_AUTOTUNE_COMMAND_HPP_
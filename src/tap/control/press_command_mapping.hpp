@@ -57,6 +57,8 @@ class PressCommandMapping : public CommandMapping
 
     void executeCommandMapping(const RemoteMapState &currState) override;
 
+    bool reactsOnlyToInputChanges() const override { return true; }
+
 private:
     bool pressed;
 };  // class PressCommandMapping
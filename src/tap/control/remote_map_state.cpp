@@ -19,8 +19,6 @@
 
 #include "remote_map_state.hpp"
 
-#include <numeric>
-
 #include "tap/errors/create_errors.hpp"
 
 using namespace tap::communication::serial;
@@ -29,152 +27,6 @@ namespace tap
 {
 namespace control
 {
-RemoteMapState::RemoteMapState(
-    tap::communication::serial::Remote::SwitchState leftss,
-    tap::communication::serial::Remote::SwitchState rightss,
-    const std::list<tap::communication::serial::Remote::Key> &keySet,
-    const std::list<tap::communication::serial::Remote::Key> &negKeySet,
-    bool mouseButtonLeftPressed,
-    bool mouseButtonRightPressed)
-{
-    initLSwitch(leftss);
-    initRSwitch(rightss);
-    initKeys(keySet);
-    initNegKeys(negKeySet);
-    if (mouseButtonLeftPressed)
-    {
-        initLMouseButton();
-    }
-    if (mouseButtonRightPressed)
-    {
-        initRMouseButton();
-    }
-}
-
-RemoteMapState::RemoteMapState(Remote::Switch swh, Remote::SwitchState switchState)
-{
-    if (swh == Remote::Switch::LEFT_SWITCH)
-    {
-        initLSwitch(switchState);
-    }
-    else
-    {
-        initRSwitch(switchState);
-    }
-}
-
-RemoteMapState::RemoteMapState(Remote::SwitchState leftss, Remote::SwitchState rightss)
-{
-    initLSwitch(leftss);
-    initRSwitch(rightss);
-}
-
-RemoteMapState::RemoteMapState(
-    const std::list<Remote::Key> &keySet,
-    const std::list<Remote::Key> &negKeySet)
-{
-    initKeys(keySet);
-    initNegKeys(negKeySet);
-}
-
-RemoteMapState::RemoteMapState(
-    RemoteMapState::MouseButton button,
-    const std::list<Remote::Key> &keySet,
-    const std::list<Remote::Key> &negKeySet)
-{
-    if (button == MouseButton::LEFT)
-    {
-        initLMouseButton();
-    }
-    else
-    {
-        initRMouseButton();
-    }
-    initKeys(keySet);
-    initNegKeys(negKeySet);
-}
-
-RemoteMapState::RemoteMapState(MouseButton button)
-{
-    if (button == MouseButton::LEFT)
-    {
-        initLMouseButton();
-    }
-    else
-    {
-        initRMouseButton();
-    }
-}
-
-void RemoteMapState::initLSwitch(Remote::SwitchState ss)
-{
-    if (ss == Remote::SwitchState::UNKNOWN)
-    {
-        return;
-    }
-    lSwitch = ss;
-}
-
-void RemoteMapState::initRSwitch(Remote::SwitchState ss)
-{
-    if (ss == Remote::SwitchState::UNKNOWN)
-    {
-        return;
-    }
-    rSwitch = ss;
-}
-
-void RemoteMapState::initKeys(uint16_t keys)
-{
-    if (keys == 0)
-    {
-        return;
-    }
-    if ((this->negKeys & keys) != 0)
-    {
-        return;
-    }
-    this->keys = keys;
-}
-
-void RemoteMapState::initNegKeys(uint16_t negKeys)
-{
-    if (negKeys == 0)
-    {
-        return;
-    }
-    if ((this->keys & negKeys) != 0)
-    {
-        return;
-    }
-    this->negKeys = negKeys;
-}
-
-void RemoteMapState::initKeys(const std::list<Remote::Key> &keySet)
-{
-    uint16_t keys = std::accumulate(
-        keySet.begin(),
-        keySet.end(),
-        0,
-        [](int acc, Remote::Key key) { return acc |= 1 << static_cast<uint16_t>(key); });
-    initKeys(keys);
-}
-
-void RemoteMapState::initNegKeys(const std::list<Remote::Key> &negKeySet)
-{
-    // extract a bit form of the key set.
-    uint16_t negKeys = std::accumulate(
-        negKeySet.begin(),
-        negKeySet.end(),
-        0,
-        [](int acc, Remote::Key key) { return acc |= 1 << static_cast<uint16_t>(key); });
-    initNegKeys(negKeys);
-}
-
-void RemoteMapState::initLMouseButton() { lMouseButton = true; }
-
-void RemoteMapState::initRMouseButton() { rMouseButton = true; }
-
 bool RemoteMapState::stateSubsetOf(const RemoteMapState &other) const
 {
     if (rSwitch != Remote::SwitchState::UNKNOWN && rSwitch != other.rSwitch)
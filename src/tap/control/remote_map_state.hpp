@@ -21,7 +21,7 @@
 #define TAPROOT_REMOTE_MAP_STATE_HPP_
 
 #include <cstdint>
-#include <list>
+#include <initializer_list>
 
 #include "tap/communication/serial/remote.hpp"
 
@@ -43,6 +43,9 @@ namespace control
  * @see CommandMapper for information about adding a `RemoteMapState` to the
  *      CommandMapper.
  *
+ * All constructors and initialize functions are `constexpr` and allocate nothing, so tables of
+ * map states may be declared `constexpr` and live in flash.
+ *
  * @note <b>What is a "neg key"?</b> I frequently will refer to a `negKeySet`.
  *      This can be thought of a key mapping that when matched, no matter what
  *      the state of the RemoteMapState is, the RemoteMapState is no longer
@@ -61,7 +64,7 @@ class RemoteMapState
         RIGHT  ///< The right mouse button.
     };
 
-    RemoteMapState() = default;
+    constexpr RemoteMapState() = default;
 
     /**
      * Generic constructor that takes all possible remote map state configurations for maximum
@@ -80,13 +83,27 @@ class RemoteMapState
      * @note `keySet` and `negKeySet` must be mutally exclusive sets, otherwise the `negKeySet` will
      * not be properly initialized.
      */
-    RemoteMapState(
+    constexpr RemoteMapState(
         tap::communication::serial::Remote::SwitchState leftss,
         tap::communication::serial::Remote::SwitchState rightss,
-        const std::list<tap::communication::serial::Remote::Key> &keySet,
-        const std::list<tap::communication::serial::Remote::Key> &negKeySet,
+        std::initializer_list<tap::communication::serial::Remote::Key> keySet,
+        std::initializer_list<tap::communication::serial::Remote::Key> negKeySet,
         bool mouseButtonLeftPressed,
-        bool mouseButtonRightPressed);
+        bool mouseButtonRightPressed)
+    {
+        initLSwitch(leftss);
+        initRSwitch(rightss);
+        initKeys(keySet);
+        initNegKeys(negKeySet);
+        if (mouseButtonLeftPressed)
+        {
+            initLMouseButton();
+        }
+        if (mouseButtonRightPressed)
+        {
+            initRMouseButton();
+        }
+    }
 
     /**
      * Initializes a RemoteMapState with a single switch to the given switch state.
@@ -94,9 +111,19 @@ class RemoteMapState
      * @param[in] swh The switch to use in the map state.
      * @param[in] switchState The switch state of the given switch.
      */
-    RemoteMapState(
+    constexpr RemoteMapState(
         tap::communication::serial::Remote::Switch swh,
-        tap::communication::serial::Remote::SwitchState switchState);
+        tap::communication::serial::Remote::SwitchState switchState)
+    {
+        if (swh == tap::communication::serial::Remote::Switch::LEFT_SWITCH)
+        {
+            initLSwitch(switchState);
+        }
+        else
+        {
+            initRSwitch(switchState);
+        }
+    }
 
     /**
      * Initializes a RemoteMapState with particular switch states for both remote
@@ -105,9 +132,13 @@ class RemoteMapState
      * @param[in] leftss The switch state for the left switch.
      * @param[in] rightss The switch state for the right switch.
      */
-    RemoteMapState(
+    constexpr RemoteMapState(
         tap::communication::serial::Remote::SwitchState leftss,
-        tap::communication::serial::Remote::SwitchState rightss);
+        tap::communication::serial::Remote::SwitchState rightss)
+    {
+        initLSwitch(leftss);
+        initRSwitch(rightss);
+    }
 
     /**
      * Initializes a RemoteMapState with a particular set of keys and optionally a
@@ -118,9 +149,13 @@ class RemoteMapState
      * @note `keySet` and `negKeySet` must be mutally exclusive sets, otherwise the
      *      `negKeySet` will not be properly initialized.
      */
-    RemoteMapState(
-        const std::list<tap::communication::serial::Remote::Key> &keySet,
-        const std::list<tap::communication::serial::Remote::Key> &negKeySet = {});
+    constexpr RemoteMapState(
+        std::initializer_list<tap::communication::serial::Remote::Key> keySet,
+        std::initializer_list<tap::communication::serial::Remote::Key> negKeySet = {})
+    {
+        initKeys(keySet);
+        initNegKeys(negKeySet);
+    }
 
     /**
      * Initializes a RemoteMapState with a particular mouse button and set of keys and
@@ -132,10 +167,15 @@ class RemoteMapState
      * @note `keySet` and `negKeySet` must be mutally exclusive sets, otherwise the
      *      `negKeySet` will not be properly initialized.
      */
-    RemoteMapState(
+    constexpr RemoteMapState(
         RemoteMapState::MouseButton button,
-        const std::list<tap::communication::serial::Remote::Key> &keySet,
-        const std::list<tap::communication::serial::Remote::Key> &negKeySet = {});
+        std::initializer_list<tap::communication::serial::Remote::Key> keySet,
+        std::initializer_list<tap::communication::serial::Remote::Key> negKeySet = {})
+        : RemoteMapState(button)
+    {
+        initKeys(keySet);
+        initNegKeys(negKeySet);
+    }
 
     /**
      * Initializes a RemoteMapState that will use the given mouse button (either left or
@@ -143,49 +183,105 @@ class RemoteMapState
      *
      * @param[in] button The MouseButton to use.
      */
-    RemoteMapState(MouseButton button);
+    constexpr RemoteMapState(MouseButton button)
+    {
+        if (button == MouseButton::LEFT)
+        {
+            initLMouseButton();
+        }
+        else
+        {
+            initRMouseButton();
+        }
+    }
+
+    /**
+     * @return The bit mapped set of the given keys, as used by `initKeys` and `initNegKeys` and
+     *      by the remote.
+     */
+    static constexpr uint16_t keysToBitmask(
+        std::initializer_list<tap::communication::serial::Remote::Key> keySet)
+    {
+        uint16_t keys = 0;
+        for (tap::communication::serial::Remote::Key key : keySet)
+        {
+            keys |= 1 << static_cast<uint16_t>(key);
+        }
+        return keys;
+    }
 
     /**
      * Initializes the left switch with the particular `Remote::SwitchState` provided.
      */
-    void initLSwitch(tap::communication::serial::Remote::SwitchState ss);
+    constexpr void initLSwitch(tap::communication::serial::Remote::SwitchState ss)
+    {
+        if (ss != tap::communication::serial::Remote::SwitchState::UNKNOWN)
+        {
+            lSwitch = ss;
+        }
+    }
 
     /**
      * Initializes the right switch with the particular `Remote::SwitchState` provided.
      */
-    void initRSwitch(tap::communication::serial::Remote::SwitchState ss);
+    constexpr void initRSwitch(tap::communication::serial::Remote::SwitchState ss)
+    {
+        if (ss != tap::communication::serial::Remote::SwitchState::UNKNOWN)
+        {
+            rSwitch = ss;
+        }
+    }
 
     /**
      * Initializes the keys to the bit mapped set of keys provided.
      * @note `keys` must be mutally exclusive with any set of `negKeys` already provided.
      */
-    void initKeys(uint16_t keys);
+    constexpr void initKeys(uint16_t keys)
+    {
+        if (keys != 0 && (negKeys & keys) == 0)
+        {
+            this->keys = keys;
+        }
+    }
 
     /**
      * Initializes the neg keys to the bit mapped set of neg keys provided.
      * @note `negKeys` must be mutally exclusive with any set of `keys` already provided.
      */
-    void initNegKeys(uint16_t negKeys);
+    constexpr void initNegKeys(uint16_t negKeys)
+    {
+        if (negKeys != 0 && (keys & negKeys) == 0)
+        {
+            this->negKeys = negKeys;
+        }
+    }
 
     /**
      * @see `initKeys`. Interprets the list and passes that on as a bit mapped set of keys.
      */
-    void initKeys(const std::list<tap::communication::serial::Remote::Key> &keySet);
+    constexpr void initKeys(std::initializer_list<tap::communication::serial::Remote::Key> keySet)
+    {
+        initKeys(keysToBitmask(keySet));
+    }
 
     /**
      * @see `initNegKeys`. Interprets the list and passes that on as a bit mapped set of keys.
      */
-    void initNegKeys(const std::list<tap::communication::serial::Remote::Key> &negKeySet);
+    constexpr void initNegKeys(
+        std::initializer_list<tap::communication::serial::Remote::Key> negKeySet)
+    {
+        initNegKeys(keysToBitmask(negKeySet));
+    }
 
     /**
      * Initializes the left mouse button to be mapped when clicked.
      */
-    void initLMouseButton();
+    constexpr void initLMouseButton() { lMouseButton = true; }
 
     /**
      * Initializes the right mouse button to be mapped when clicked.
      */
-    void initRMouseButton();
+    constexpr void initRMouseButton() { rMouseButton = true; }
 
     /**
      * Checks if `this` is a subset of `other`. `this` is a subset of `other` under the following
@@ -226,25 +322,25 @@ class RemoteMapState
     /**
      * @return The negKeys currently being used.
      */
-    uint16_t getNegKeys() const { return negKeys; }
+    constexpr uint16_t getNegKeys() const { return negKeys; }
 
     /**
      * @return `true` if the neg key set has been initialized, `false` otherwise.
      */
-    bool getNegKeysUsed() const { return negKeys != 0; }
+    constexpr bool getNegKeysUsed() const { return negKeys != 0; }
 
     /**
      * @return the current keys initialized in the `RemoteMapState`.
      */
-    uint16_t getKeys() const { return keys; }
+    constexpr uint16_t getKeys() const { return keys; }
 
-    bool getLMouseButton() const { return lMouseButton; }
+    constexpr bool getLMouseButton() const { return lMouseButton; }
 
-    bool getRMouseButton() const { return rMouseButton; }
+    constexpr bool getRMouseButton() const { return rMouseButton; }
 
-    tap::communication::serial::Remote::SwitchState getLSwitch() const { return lSwitch; }
+    constexpr tap::communication::serial::Remote::SwitchState getLSwitch() const { return lSwitch; }
 
-    tap::communication::serial::Remote::SwitchState getRSwitch() const { return rSwitch; }
+    constexpr tap::communication::serial::Remote::SwitchState getRSwitch() const { return rSwitch; }
 
 private:
     tap::communication::serial::Remote::SwitchState lSwitch =
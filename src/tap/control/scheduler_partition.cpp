@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "scheduler_partition.hpp"
+
+#include "command.hpp"
+
+namespace tap
+{
+namespace control
+{
+SchedulerPartition::SchedulerPartition(
+    Drivers* drivers,
+    const char* name,
+    SafeDisconnectFunction* safeDisconnectFunction)
+    : name(name),
+      scheduler(drivers, false, safeDisconnectFunction)
+{
+    scheduler.refreshesOwnSubsystems = true;
+}
+
+void SchedulerPartition::registerSubsystem(Subsystem* subsystem, RefreshPolicy policy)
+{
+    scheduler.registerSubsystem(subsystem, policy);
+}
+
+void SchedulerPartition::requestAddCommand(const Command* command)
+{
+    setRequest(addRequests, removeRequests, command);
+}
+
+void SchedulerPartition::requestRemoveCommand(const Command* command)
+{
+    setRequest(removeRequests, addRequests, command);
+}
+
+void SchedulerPartition::setRequest(
+    std::atomic<uint32_t>* requests,
+    std::atomic<uint32_t>* cancelledRequests,
+    const Command* command)
+{
+    if (command == nullptr)
+    {
+        return;
+    }
+    const int id = command->getGlobalIdentifier();
+    const uint32_t bit = 1ul << (id % BITS_PER_WORD);
+    // Cancel the opposite request first, so the last request wins even if run takes the
+    // requests in between
+    cancelledRequests[id / BITS_PER_WORD].fetch_and(~bit, std::memory_order_release);
+    requests[id / BITS_PER_WORD].fetch_or(bit, std::memory_order_release);
+}
+
+bool SchedulerPartition::hasPendingRequests() const
+{
+    for (int i = 0; i < WORDS; i++)
+    {
+        if (addRequests[i].load(std::memory_order_relaxed) != 0 ||
+            removeRequests[i].load(std::memory_order_relaxed) != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SchedulerPartition::run()
+{
+    // Take each word of requests at once so requests made while handling them wait for the next
+    // run rather than being lost
+    for (int word = 0; word < WORDS; word++)
+    {
+        uint32_t removals = removeRequests[word].exchange(0, std::memory_order_acquire);
+        for (; removals != 0; removals &= removals - 1)
+        {
+            const int id = word * BITS_PER_WORD + __builtin_ctz(removals);
+            Command* command = CommandScheduler::registry().globalCommandRegistrar[id];
+            if (command != nullptr)
+            {
+                scheduler.removeCommand(command, true);
+            }
+        }
+    }
+
+    for (int word = 0; word < WORDS; word++)
+    {
+        uint32_t additions = addRequests[word].exchange(0, std::memory_order_acquire);
+        for (; additions != 0; additions &= additions - 1)
+        {
+            const int id = word * BITS_PER_WORD + __builtin_ctz(additions);
+            Command* command = CommandScheduler::registry().globalCommandRegistrar[id];
+            if (command != nullptr)
+            {
+                scheduler.addCommand(command);
+            }
+        }
+    }
+
+    scheduler.run();
+}
+}  // namespace control
+
+}  // namespace tap
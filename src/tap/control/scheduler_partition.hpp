@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_SCHEDULER_PARTITION_HPP_
+#define TAPROOT_SCHEDULER_PARTITION_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "command_scheduler.hpp"
+#include "command_scheduler_types.hpp"
+
+namespace tap
+{
+class Drivers;
+namespace control
+{
+class Command;
+class Subsystem;
+
+/**
+ * A set of subsystems and their commands that runs in its own execution context, such as the
+ * second core of a dual-core MCU, a high priority timer interrupt, or a thread of a hosted
+ * simulation. Each partition has its own `CommandScheduler`, which refreshes the subsystems
+ * registered with the partition, executes the commands that require them, and adds their default
+ * commands, so for example the turret's control loop can run independently of the chassis'.
+ *
+ * Code in other contexts (such as the `CommandMapper` in the main loop) asks a partition to add
+ * or remove a command with `requestAddCommand` and `requestRemoveCommand`, which are lock-free
+ * and may be called from any context, including interrupts. Requests are handled at the start
+ * of the partition's next `run`, removals before additions. Repeated requests for the same
+ * command before then are handled once, and if both an addition and a removal of the same
+ * command are requested before then, only the last one is handled.
+ *
+ * Memory model:
+ * - Construct and register every subsystem, command and partition before any partition runs.
+ *   The scheduler's global command and subsystem registrars are only written during
+ *   construction and destruction, and are read-only from then on, so every context may read
+ *   them without synchronization.
+ * - Each subsystem is registered with exactly one scheduler: the master scheduler or one
+ *   partition. Its commands must only require subsystems of that same partition, and are only
+ *   initialized, executed and ended from the partition's context. Per-subsystem and per-command
+ *   statistics (execution time stats, time budgets) are therefore only written by one context.
+ * - A request made with `requestAddCommand` or `requestRemoveCommand` is published with release
+ *   ordering and taken with acquire ordering, so everything the requesting context wrote before
+ *   the request (e.g. a command's setpoint) is visible to the command when the partition
+ *   handles the request. Any other data shared between partitions must be synchronized by the
+ *   user, e.g. with `std::atomic` or a lock-free ring.
+ * - The `ErrorController` and the `Drivers` it reports to are not synchronized. Partitions in
+ *   contexts that may preempt the main loop raise errors at their own risk; keep the partition's
+ *   run time well within its period so the scheduler's overrun checks don't fire.
+ * - `CommandScheduler::getTickCount` counts runs of the master scheduler only.
+ *
+ * Usage:
+ *
+ * ```
+ * SchedulerPartition turretPartition(drivers, "turret");
+ * turretPartition.registerSubsystem(&turret);
+ * turret.setDefaultCommand(&turretAimCommand);
+ *
+ * // In the turret's 1 kHz interrupt or thread
+ * turretPartition.run();
+ *
+ * // From the main loop
+ * turretPartition.requestAddCommand(&turretSpinCommand);
+ * ```
+ */
+class SchedulerPartition
+{
+public:
+    SchedulerPartition(
+        Drivers* drivers,
+        const char* name,
+        SafeDisconnectFunction* safeDisconnectFunction =
+            &CommandScheduler::defaultSafeDisconnectFunction);
+    DISALLOW_COPY_AND_ASSIGN(SchedulerPartition)
+
+    /**
+     * Pins a subsystem to this partition. Call from the partition's context or before the
+     * partition runs. The subsystem must not be registered with any other scheduler.
+     */
+    void registerSubsystem(Subsystem* subsystem, RefreshPolicy policy = RefreshPolicy());
+
+    /**
+     * Requests that the partition add a command at the start of its next `run`. May be called
+     * from any context.
+     */
+    void requestAddCommand(const Command* command);
+
+    /**
+     * Requests that the partition remove (interrupt) a command at the start of its next `run`.
+     * May be called from any context.
+     */
+    void requestRemoveCommand(const Command* command);
+
+    /// @return `true` if any add or remove requests haven't been handled yet.
+    bool hasPendingRequests() const;
+
+    /**
+     * Handles pending requests, then runs the partition's scheduler, executing its commands and
+     * refreshing its subsystems. Call periodically from the partition's context only.
+     */
+    void run();
+
+    /// @return The partition's scheduler, which must only be used from the partition's context.
+    CommandScheduler& getScheduler() { return scheduler; }
+
+    const char* getName() const { return name; }
+
+private:
+    static constexpr int WORDS = SCHEDULER_BITMAP_WORDS;
+    static constexpr int BITS_PER_WORD = 32;
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "requests must be lock-free");
+
+    const char* name;
+
+    CommandScheduler scheduler;
+
+    /// Global identifiers of the commands requested to be added, set from any context.
+    std::atomic<uint32_t> addRequests[WORDS] = {};
+
+    /// Global identifiers of the commands requested to be removed, set from any context.
+    std::atomic<uint32_t> removeRequests[WORDS] = {};
+
+    /**
+     * Sets the command's bit in `requests` after clearing it in `cancelledRequests`, the
+     * opposite kind of request.
+     */
+    static void setRequest(
+        std::atomic<uint32_t>* requests,
+        std::atomic<uint32_t>* cancelledRequests,
+        const Command* command);
+};  // class SchedulerPartition
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // TAPROOT_SCHEDULER_PARTITION_HPP_
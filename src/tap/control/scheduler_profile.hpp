@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_SCHEDULER_PROFILE_HPP_
+#define TAPROOT_SCHEDULER_PROFILE_HPP_
+
+#include "command.hpp"
+#include "command_scheduler_types.hpp"
+
+namespace tap
+{
+namespace control
+{
+/**
+ * A named set of commands that should run together, such as the commands of a robot mode
+ * (match, test, patrol, etc). `CommandScheduler::switchToProfile` switches to a profile in one
+ * call, ending the scheduled commands that aren't in the profile and adding the profile's
+ * commands that aren't scheduled. Commands in both the old and new set keep running without
+ * being ended and initialized again.
+ *
+ * The set is computed as commands are added, so profiles should be built once at startup:
+ *
+ * ```
+ * SchedulerProfile matchProfile("match");
+ * matchProfile.addCommand(&chassisDriveCommand);
+ * matchProfile.addCommand(&turretAimCommand);
+ *
+ * // When the mode changes
+ * drivers->commandScheduler.switchToProfile(matchProfile);
+ * ```
+ *
+ * A command's requirements are read when it is added to the profile, so add all of its
+ * requirements first.
+ */
+class SchedulerProfile
+{
+public:
+    /// @param[in] name The name of the profile. Must outlive the profile.
+    explicit SchedulerProfile(const char* name) : name(name) {}
+
+    /**
+     * Adds a command to the profile.
+     *
+     * @return `false` if the command is `nullptr`, has no requirements, or requires a subsystem
+     *      another command in the profile requires, since both couldn't be scheduled at once.
+     *      `true` otherwise.
+     */
+    bool addCommand(const Command* command)
+    {
+        if (command == nullptr)
+        {
+            return false;
+        }
+        const subsystem_scheduler_bitmap_t commandRequirements = command->getRequirementsBitwise();
+        if (commandRequirements.none() || (commandRequirements & requirements).any())
+        {
+            return false;
+        }
+        commands.set(command->getGlobalIdentifier());
+        requirements |= commandRequirements;
+        return true;
+    }
+
+    const char* getName() const { return name; }
+
+    bool containsCommand(const Command* command) const
+    {
+        return command != nullptr && commands.test(command->getGlobalIdentifier());
+    }
+
+    /// @return The global identifiers of the profile's commands.
+    const command_scheduler_bitmap_t& getCommandBitmap() const { return commands; }
+
+    /// @return The subsystems required by the profile's commands.
+    const subsystem_scheduler_bitmap_t& getRequirementsBitwise() const { return requirements; }
+
+private:
+    const char* name;
+    command_scheduler_bitmap_t commands;
+    subsystem_scheduler_bitmap_t requirements;
+};  // class SchedulerProfile
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // TAPROOT_SCHEDULER_PROFILE_HPP_
@@ -21,7 +21,7 @@
 
 #include <algorithm>
 
-#include "tap/algorithms/strtok.hpp"
+#include "tap/algorithms/token_view.hpp"
 #include "tap/drivers.hpp"
 
 #include "command.hpp"
@@ -40,7 +40,14 @@ void SchedulerTerminalHandler::init() { drivers->terminalSerial.addHeader(HEADER
 
 void SchedulerTerminalHandler::terminalSerialStreamCallback(modm::IOStream& outputStream)
 {
-    printInfo(outputStream);
+    if (streamingTiming)
+    {
+        printTiming(outputStream);
+    }
+    else
+    {
+        printInfo(outputStream);
+    }
 }
 
 bool SchedulerTerminalHandler::terminalSerialCallback(
@@ -48,17 +55,30 @@ bool SchedulerTerminalHandler::terminalSerialCallback(
     modm::IOStream& outputStream,
     bool streamingEnabled)
 {
-    char* arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
+    algorithms::TokenView tokens(inputLine);
 
-    if (arg != nullptr && strcmp(arg, "allsubcmd") == 0)
+    if (tokens.nextIs("allsubcmd"))
     {
+        streamingTiming = false;
         printInfo(outputStream);
         return true;
     }
+    else if (tokens.nextIs("timing"))
+    {
+        streamingTiming = streamingEnabled;
+        printTiming(outputStream);
+        return true;
+    }
+    else if (!streamingEnabled && tokens.nextIs("resettiming"))
+    {
+        CommandScheduler::resetExecutionTimeStats();
+        outputStream << "Execution time statistics reset" << modm::endl;
+        return true;
+    }
     else
     {
         outputStream << USAGE;
-        return (arg != nullptr) && !streamingEnabled && (strcmp(arg, "-H") == 0);
+        return !streamingEnabled && tokens.nextIs("-H");
     }
 }
 
@@ -76,6 +96,62 @@ void SchedulerTerminalHandler::printInfo(modm::IOStream& outputStream)
         drivers->commandScheduler.cmdMapEnd(),
         [&](Command* cmd) { outputStream << " " << cmd->getName() << modm::endl; });
 }
+
+void SchedulerTerminalHandler::printTiming(modm::IOStream& outputStream)
+{
+    if (!drivers->commandScheduler.isExecutionTimeAccountingEnabled())
+    {
+        outputStream << "Execution time accounting disabled" << modm::endl;
+        return;
+    }
+
+    outputStream << "Subsystems (min/avg/max/last cycles):" << modm::endl;
+    std::for_each(
+        drivers->commandScheduler.subMapBegin(),
+        drivers->commandScheduler.subMapEnd(),
+        [&](Subsystem* sub) {
+            printExecutionTimeStats(
+                outputStream,
+                sub->getName(),
+                CommandScheduler::getSubsystemExecutionTimeStats(sub));
+        });
+
+    outputStream << "Commands (min/avg/max/last cycles):" << modm::endl;
+    std::for_each(
+        drivers->commandScheduler.cmdMapBegin(),
+        drivers->commandScheduler.cmdMapEnd(),
+        [&](Command* cmd) {
+            printExecutionTimeStats(
+                outputStream,
+                cmd->getName(),
+                CommandScheduler::getCommandExecutionTimeStats(cmd));
+        });
+
+    const char* worstOffender = drivers->commandScheduler.getWorstOffenderName();
+    if (worstOffender != nullptr)
+    {
+        outputStream << "Worst offender last tick: " << worstOffender << " ("
+                     << drivers->commandScheduler.getWorstOffenderCycles() << " cycles)"
+                     << modm::endl;
+    }
+}
+
+void SchedulerTerminalHandler::printExecutionTimeStats(
+    modm::IOStream& outputStream,
+    const char* name,
+    const CommandScheduler::ExecutionTimeStats& stats)
+{
+    outputStream << " " << name << ": ";
+    if (stats.isEmpty())
+    {
+        outputStream << "no data" << modm::endl;
+    }
+    else
+    {
+        outputStream << stats.minCycles << "/" << static_cast<uint32_t>(stats.avgCycles) << "/"
+                     << stats.maxCycles << "/" << stats.lastCycles << modm::endl;
+    }
+}
 }  // namespace control
 
 }  // namespace tap
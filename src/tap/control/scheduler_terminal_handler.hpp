@@ -23,6 +23,8 @@
 #include "tap/communication/serial/terminal_serial.hpp"
 #include "tap/util_macros.hpp"
 
+#include "command_scheduler.hpp"
+
 namespace tap
 {
 class Drivers;
@@ -49,13 +51,27 @@ class SchedulerTerminalHandler : public communication::serial::TerminalSerialCal
 private:
     Drivers* drivers;
 
+    /// `true` if the stream callback should print timing information rather than `allsubcmd`.
+    bool streamingTiming = false;
+
     static constexpr char USAGE[] =
         "Usage: scheduler <target>\n"
         "  Where \"<target>\" is one of:\n"
         "    - \"-H\": displays possible commands.\n"
-        "    - \"allsubcmd\" prints all running subsystems and.\n";
+        "    - \"allsubcmd\" prints all running subsystems and.\n"
+        "    - \"timing\" prints execution time statistics (min/avg/max/last, in cycles) of all\n"
+        "      registered subsystems and running commands. Requires execution time accounting\n"
+        "      to be enabled in the scheduler.\n"
+        "    - \"resettiming\" resets all execution time statistics.\n";
 
     void printInfo(modm::IOStream& outputStream);
+
+    void printTiming(modm::IOStream& outputStream);
+
+    static void printExecutionTimeStats(
+        modm::IOStream& outputStream,
+        const char* name,
+        const CommandScheduler::ExecutionTimeStats& stats);
 };
 
 }  // namespace control
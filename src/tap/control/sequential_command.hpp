@@ -76,6 +76,7 @@ class SequentialCommand : public Command
         {
             if (this->commands[this->currentCommand]->isReady())
             {
+                this->commands[this->currentCommand]->clearFinishRequest();
                 this->commands[this->currentCommand]->initialize();
                 this->commandInitialized = true;
             }
@@ -85,7 +86,7 @@ class SequentialCommand : public Command
         {
             this->commands[this->currentCommand]->execute();
 
-            if (this->commands[this->currentCommand]->isFinished())
+            if (this->commands[this->currentCommand]->checkFinished())
             {
                 this->commands[this->currentCommand]->end(false);
                 this->commandInitialized = false;
@@ -104,6 +105,11 @@ class SequentialCommand : public Command
 
     bool isFinished() const override { return this->currentCommand == COMMANDS; }
 
+    CommandComposition getComposition() const override
+    {
+        return {CommandComposition::Type::SEQUENCE, commands.data(), static_cast<int>(COMMANDS)};
+    }
+
 private:
     std::array<Command*, COMMANDS> commands;
     size_t currentCommand;
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SETPOINT_SIGNATURE_JAM_CHECKER_HPP_
+#define TAPROOT_SETPOINT_SIGNATURE_JAM_CHECKER_HPP_
+
+#include <cmath>
+
+#include "tap/architecture/conditional_timer.hpp"
+#include "tap/control/setpoint/interfaces/setpoint_subsystem.hpp"
+
+namespace tap::control::setpoint
+{
+/**
+ * A functor (function object) to be used for setpoint subsystem jam detection, a faster
+ * alternative to `SetpointContinuousJamChecker` with the same interface.
+ *
+ * A jammed mechanism has a distinct signature: its actuator pushes hard towards the setpoint,
+ * `SetpointSubsystem::getTorque`, but it has stopped moving, `SetpointSubsystem::getVelocity`.
+ * This checker declares a jam once that signature has lasted `Config::signatureTime`, typically
+ * a few ms, rather than waiting for the position error to persist for a whole timeout.
+ *
+ * A mechanism starting from rest shows the same signature until it speeds up, so
+ * `Config::signatureTime` should be longer than the time the mechanism takes to exceed
+ * `Config::velocityThreshold` unjammed; raising it trades detection time for fewer false
+ * positives. The signature is only considered while the position error is outside
+ * `Config::distanceTolerance`, so holding a position against a load is never a jam.
+ *
+ * Jams the signature misses, such as a slow stall below the torque threshold, are still caught
+ * like `SetpointContinuousJamChecker` would after `Config::temporalTolerance`.
+ */
+class SetpointSignatureJamChecker
+{
+public:
+    struct Config
+    {
+        /// The acceptable distance between the setpoint and current position.
+        float distanceTolerance;
+        /**
+         * The maximum amount of time in milliseconds the distance can be greater than the
+         * distance tolerance before the system is considered jammed regardless of signature.
+         */
+        uint32_t temporalTolerance;
+        /// The smallest torque towards the setpoint, in `getTorque` units, that may be a jam.
+        float torqueThreshold;
+        /// The largest speed, in `getVelocity` units, that may be a jam.
+        float velocityThreshold;
+        /// Time in milliseconds the jam signature must last for the subsystem to be jammed.
+        uint32_t signatureTime;
+    };
+
+    /**
+     * @param[in] setpointSubsystem: the setpoint subsystem to do jam checking
+     *      on.
+     * @param[in] config: jam detection thresholds, @see Config.
+     */
+    SetpointSignatureJamChecker(SetpointSubsystem* setpointSubsystem, const Config& config)
+        : setpointSubsystem(setpointSubsystem),
+          config(config),
+          jamTimeout(config.temporalTolerance),
+          signatureTimeout(config.signatureTime)
+    {
+    }
+
+    /**
+     * Resets the jam timers
+     */
+    void restart()
+    {
+        jamTimeout.restart();
+        signatureTimeout.restart();
+    }
+
+    /**
+     * Update subsystem jam detection and check whether subsystem is jammed.
+     *
+     * @note Should be called once per subsystem refresh (it's like an execute)
+     *
+     * @return `true` if subsystem is jammed, `false` otherwise
+     */
+    inline bool check()
+    {
+        const float error = setpointSubsystem->getSetpoint() - setpointSubsystem->getCurrentValue();
+        const bool withinTolerance = fabsf(error) <= config.distanceTolerance;
+
+        // Only torque towards the setpoint counts, so braking isn't taken for pushing
+        const float torque = setpointSubsystem->getTorque();
+        const bool signature = !withinTolerance && error * torque > 0 &&
+                               fabsf(torque) >= config.torqueThreshold &&
+                               fabsf(setpointSubsystem->getVelocity()) <= config.velocityThreshold;
+
+        // Both timers must be updated every call
+        const bool signatureJam = signatureTimeout.execute(signature);
+        const bool distanceJam = jamTimeout.execute(!withinTolerance);
+        return signatureJam || distanceJam;
+    }
+
+    /**
+     * @return the jamming distance tolerance of this jam checker
+     */
+    inline float getJamSetpointTolerance() const { return config.distanceTolerance; }
+
+private:
+    SetpointSubsystem* setpointSubsystem;
+    Config config;
+    tap::arch::ConditionalMilliTimer jamTimeout;
+    tap::arch::ConditionalMilliTimer signatureTimeout;
+};  // SetpointSignatureJamChecker
+
+}  // namespace tap::control::setpoint
+
+#endif  // TAPROOT_SETPOINT_SIGNATURE_JAM_CHECKER_HPP_
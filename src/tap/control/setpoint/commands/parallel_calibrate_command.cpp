@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "parallel_calibrate_command.hpp"
+
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/control/setpoint/interfaces/calibration_cache.hpp"
+#include "tap/control/setpoint/interfaces/setpoint_subsystem.hpp"
+
+#include "modm/architecture/interface/assert.hpp"
+
+using tap::algorithms::limitVal;
+
+namespace tap::control::setpoint
+{
+ParallelCalibrateCommand::ParallelCalibrateCommand(
+    const Axis *axes,
+    int numAxes,
+    CalibrationCache *cache)
+    : axes(axes),
+      numAxes(numAxes),
+      cache(cache)
+{
+    modm_assert(
+        numAxes <= MAX_AXES,
+        "ParallelCalibrateCommand::ParallelCalibrateCommand",
+        "Too many axes.");
+
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        footprints[axis] = requirementsOf({axes[axis].subsystem}) | axes[axis].conflicts;
+        this->commandRequirementsBitwise |= footprints[axis];
+    }
+}
+
+bool ParallelCalibrateCommand::isReady()
+{
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (!axes[axis].subsystem->isOnline())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParallelCalibrateCommand::initialize()
+{
+    const uint32_t now = tap::arch::clock::getTimeMilliseconds();
+    prevExecuteTime = now;
+
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        states[axis] = tryRestore(axis) ? AxisState::RESTORED : AxisState::WAITING;
+    }
+    startAxes(now);
+}
+
+void ParallelCalibrateCommand::execute()
+{
+    const uint32_t now = tap::arch::clock::getTimeMilliseconds();
+    const float dt = (now - prevExecuteTime) / 1000.0f;
+    prevExecuteTime = now;
+
+    bool axisFinished = false;
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] == AxisState::HOMING)
+        {
+            home(axis, now, dt);
+            axisFinished |= states[axis] != AxisState::HOMING;
+        }
+    }
+
+    if (axisFinished)
+    {
+        startAxes(now);
+    }
+}
+
+void ParallelCalibrateCommand::end(bool)
+{
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] == AxisState::HOMING)
+        {
+            SetpointSubsystem *subsystem = axes[axis].subsystem;
+            subsystem->setSetpoint(subsystem->getCurrentValue());
+        }
+    }
+}
+
+bool ParallelCalibrateCommand::isFinished() const
+{
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] == AxisState::WAITING || states[axis] == AxisState::HOMING)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParallelCalibrateCommand::allCalibrated() const
+{
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] != AxisState::CALIBRATED && states[axis] != AxisState::RESTORED)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParallelCalibrateCommand::startAxes(uint32_t now)
+{
+    subsystem_scheduler_bitmap_t busy;
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] == AxisState::HOMING)
+        {
+            busy |= footprints[axis];
+        }
+    }
+
+    for (int axis = 0; axis < numAxes; axis++)
+    {
+        if (states[axis] != AxisState::WAITING || (busy & footprints[axis]).any())
+        {
+            continue;
+        }
+
+        busy |= footprints[axis];
+        states[axis] = AxisState::HOMING;
+        setpoints[axis] = axes[axis].subsystem->getCurrentValue();
+        homingStartTimes[axis] = now;
+        stallStartTimes[axis] = now;
+        stalling[axis] = true;
+    }
+}
+
+bool ParallelCalibrateCommand::tryRestore(int axis)
+{
+    const Axis &config = axes[axis];
+    float calibration;
+    return cache != nullptr && config.cacheKey != nullptr &&
+           config.subsystem->isAbsolutePositionTrusted() &&
+           cache->load(config.cacheKey, &calibration) &&
+           config.subsystem->restoreCalibration(calibration);
+}
+
+void ParallelCalibrateCommand::home(int axis, uint32_t now, float dt)
+{
+    const Axis &config = axes[axis];
+    SetpointSubsystem *subsystem = config.subsystem;
+    const float currentValue = subsystem->getCurrentValue();
+
+    const bool stalled = fabsf(subsystem->getVelocity()) < config.stallVelocity &&
+                         fabsf(subsystem->getTorque()) >= config.stallTorque;
+    if (!stalled)
+    {
+        stalling[axis] = false;
+    }
+    else if (!stalling[axis])
+    {
+        stalling[axis] = true;
+        stallStartTimes[axis] = now;
+    }
+    else if (now - stallStartTimes[axis] >= config.stallTime && subsystem->calibrateHere())
+    {
+        // Stop pushing into the hard stop
+        subsystem->setSetpoint(subsystem->getCurrentValue());
+
+        float calibration;
+        if (cache != nullptr && config.cacheKey != nullptr &&
+            subsystem->getCalibration(&calibration))
+        {
+            cache->save(config.cacheKey, calibration);
+        }
+        states[axis] = AxisState::CALIBRATED;
+        return;
+    }
+
+    if (now - homingStartTimes[axis] >= config.timeout)
+    {
+        subsystem->setSetpoint(currentValue);
+        states[axis] = AxisState::FAILED;
+        return;
+    }
+
+    setpoints[axis] = limitVal(
+        setpoints[axis] + config.homingVelocity * dt,
+        currentValue - config.maxLead,
+        currentValue + config.maxLead);
+    subsystem->setSetpoint(setpoints[axis]);
+}
+}  // namespace tap::control::setpoint
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PARALLEL_CALIBRATE_COMMAND_HPP_
+#define TAPROOT_PARALLEL_CALIBRATE_COMMAND_HPP_
+
+#include <cstdint>
+
+#include "tap/control/command.hpp"
+#include "tap/control/command_scheduler_types.hpp"
+
+namespace tap::control::setpoint
+{
+class CalibrationCache;
+class SetpointSubsystem;
+
+/**
+ * Homes several setpoint subsystems (axes) at once, unlike `CalibrateCommand`, which calibrates
+ * one subsystem where it is. Each axis is driven towards a hard stop until it stalls, then
+ * calibrated there, so that `getCurrentValue` returns 0 at the stop.
+ *
+ * Axes that can't move at the same time, for example a pitch axis that may hit the chassis
+ * unless the yaw axis is still, conflict. Each axis's footprint is its subsystem plus the
+ * subsystems in `Axis::conflicts`, as a requirement bitmap, and two axes whose footprints
+ * overlap are never homed at once. Every time an axis finishes, the waiting axes, in the order
+ * given, whose footprints don't overlap the footprint of an axis being homed are started.
+ *
+ * While homing, an axis's setpoint moves at `Axis::homingVelocity` but never leads the current
+ * value by more than `Axis::maxLead`, which bounds how hard the axis is pushed into the stop.
+ * The axis has stalled once its speed has stayed below `Axis::stallVelocity`, and its effort
+ * above `Axis::stallTorque`, for `Axis::stallTime`, counted from when homing started, so
+ * `stallTime` must be longer than the axis takes to start moving. An axis that hasn't stalled
+ * within `Axis::timeout` of starting fails and is left uncalibrated.
+ *
+ * If a `CalibrationCache` is given, each axis with a cache key saves its calibration to the
+ * cache once homed. On later runs, an axis whose subsystem trusts its absolute position (see
+ * `SetpointSubsystem::isAbsolutePositionTrusted`) restores the cached calibration instead of
+ * being homed.
+ *
+ * The command finishes once every axis is calibrated or has failed.
+ */
+class ParallelCalibrateCommand : public tap::control::Command
+{
+public:
+    static constexpr int MAX_AXES = 16;
+
+    struct Axis
+    {
+        SetpointSubsystem *subsystem;
+        /// Key the axis's calibration is cached under, or `nullptr` to not cache it.
+        const char *cacheKey;
+        /**
+         * Subsystems, other than the axis's own, that must not move while the axis is homed,
+         * for example built with `Command::requirementsOf`. Also required by the command.
+         */
+        subsystem_scheduler_bitmap_t conflicts;
+        /// Speed and direction towards the hard stop, in subsystem units / second.
+        float homingVelocity;
+        /// Max distance the setpoint leads the current value by, in subsystem units.
+        float maxLead;
+        /// Speed below which the axis may be stalled, in subsystem units / second.
+        float stallVelocity;
+        /// Magnitude of `SetpointSubsystem::getTorque` above which the axis may be stalled.
+        float stallTorque;
+        /// Time the axis must be stalled for before it is calibrated, in milliseconds.
+        uint32_t stallTime;
+        /// Time after which the axis fails if it hasn't stalled, in milliseconds.
+        uint32_t timeout;
+    };
+
+    enum class AxisState : uint8_t
+    {
+        /// Waiting for a conflicting axis to finish homing.
+        WAITING,
+        HOMING,
+        /// Homed and calibrated at the hard stop.
+        CALIBRATED,
+        /// Calibrated from the cache without being homed.
+        RESTORED,
+        /// Didn't stall before its timeout.
+        FAILED,
+    };
+
+    /**
+     * @param[in] axes The axes to home, which must outlive the command. At most `MAX_AXES`.
+     * @param[in] cache Where calibrations are cached, or `nullptr` to always home every axis.
+     */
+    ParallelCalibrateCommand(const Axis *axes, int numAxes, CalibrationCache *cache = nullptr);
+
+    const char *getName() const override { return "parallel calibrate"; }
+
+    /// @return `true` if every axis's subsystem is online.
+    bool isReady() override;
+
+    void initialize() override;
+
+    void execute() override;
+
+    /// Stops every axis being homed where it is.
+    void end(bool interrupted) override;
+
+    bool isFinished() const override;
+
+    AxisState getAxisState(int axis) const { return states[axis]; }
+
+    /// @return `true` if every axis was calibrated or restored.
+    bool allCalibrated() const;
+
+private:
+    const Axis *axes;
+    int numAxes;
+    CalibrationCache *cache;
+
+    /// Each axis's subsystem and conflicts.
+    subsystem_scheduler_bitmap_t footprints[MAX_AXES];
+
+    AxisState states[MAX_AXES] = {};
+    float setpoints[MAX_AXES] = {};
+    uint32_t homingStartTimes[MAX_AXES] = {};
+    /// Time each axis started stalling, valid if `stalling` is set.
+    uint32_t stallStartTimes[MAX_AXES] = {};
+    bool stalling[MAX_AXES] = {};
+
+    uint32_t prevExecuteTime = 0;
+
+    /// Starts homing every waiting axis that doesn't conflict with an axis being homed.
+    void startAxes(uint32_t now);
+
+    /// @return `true` if the axis's calibration was restored from the cache.
+    bool tryRestore(int axis);
+
+    /// Moves a homing axis towards its hard stop and calibrates it once it has stalled.
+    void home(int axis, uint32_t now, float dt);
+};
+}  // namespace tap::control::setpoint
+
+#endif  // TAPROOT_PARALLEL_CALIBRATE_COMMAND_HPP_
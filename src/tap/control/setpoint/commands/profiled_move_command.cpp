@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiled_move_command.hpp"
+
+#include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
+
+namespace tap::control::setpoint
+{
+ProfiledMoveCommand::ProfiledMoveCommand(SetpointSubsystem* setpointSubsystem, const Config& config)
+    : setpointSubsystem(setpointSubsystem),
+      config(config),
+      profileTime(0),
+      prevExecuteTime(0)
+{
+    this->addSubsystemRequirement(setpointSubsystem);
+}
+
+void ProfiledMoveCommand::initialize()
+{
+    const float start = setpointSubsystem->getSetpoint();
+    const float target = config.relative ? start + config.target : config.target;
+    profile.generate(start, target, config.constraints);
+
+    profileTime = 0;
+    prevExecuteTime = tap::arch::clock::getTimeMilliseconds();
+
+    // Stop timeout, doesn't start until target reached
+    pauseAfterMoveTimeout.stop();
+}
+
+void ProfiledMoveCommand::execute()
+{
+    const uint32_t currTime = tap::arch::clock::getTimeMilliseconds();
+
+    // Pause the profile while the subsystem can't follow it so it doesn't run ahead
+    if (setpointSubsystem->isJammed() || !setpointSubsystem->isOnline())
+    {
+        prevExecuteTime = currTime;
+        setpointSubsystem->setSetpoint(setpointSubsystem->getCurrentValue());
+        setpointSubsystem->setSetpointFeedForward(0, 0);
+        return;
+    }
+
+    profileTime += currTime - prevExecuteTime;
+    prevExecuteTime = currTime;
+
+    const tap::algorithms::MotionProfile::State state = profile.sample(profileTime / 1000.0f);
+    setpointSubsystem->setSetpoint(state.position);
+    setpointSubsystem->setSetpointFeedForward(state.velocity, state.acceleration);
+
+    if (pauseAfterMoveTimeout.isStopped() && profileTime / 1000.0f >= profile.getDuration() &&
+        algorithms::compareFloatClose(
+            setpointSubsystem->getCurrentValue(),
+            profile.getEnd(),
+            config.setpointTolerance))
+    {
+        pauseAfterMoveTimeout.restart(config.pauseAfterMoveTime);
+    }
+}
+
+void ProfiledMoveCommand::end(bool interrupted)
+{
+    if (interrupted || setpointSubsystem->isJammed() || !setpointSubsystem->isOnline() ||
+        !config.setSetpointToTargetOnEnd)
+    {
+        setpointSubsystem->setSetpoint(setpointSubsystem->getCurrentValue());
+    }
+    else
+    {
+        setpointSubsystem->setSetpoint(profile.getEnd());
+    }
+    setpointSubsystem->setSetpointFeedForward(0, 0);
+}
+
+bool ProfiledMoveCommand::isFinished() const
+{
+    return setpointSubsystem->isJammed() || !setpointSubsystem->isOnline() ||
+           pauseAfterMoveTimeout.isExpired();
+}
+
+}  // namespace tap::control::setpoint
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PROFILED_MOVE_COMMAND_HPP_
+#define TAPROOT_PROFILED_MOVE_COMMAND_HPP_
+
+#include "tap/algorithms/motion_profile.hpp"
+#include "tap/architecture/timeout.hpp"
+#include "tap/control/command.hpp"
+
+#include "../interfaces/setpoint_subsystem.hpp"
+
+namespace tap::control::setpoint
+{
+/**
+ * Moves the setpoint of a `SetpointSubsystem` along a trapezoidal or S-curve motion profile, a
+ * counterpart to `MoveCommand` and `MoveAbsoluteCommand`, which move it at a constant speed.
+ * Starting and stopping smoothly lets a mechanism use higher speeds without overshooting or
+ * slipping, so moves finish sooner.
+ *
+ * The profile is generated from the subsystem's setpoint in `initialize()`. Each `execute()`
+ * sets the setpoint to the profile's position and passes its velocity and acceleration to
+ * `SetpointSubsystem::setSetpointFeedForward`. While the subsystem is jammed or offline the
+ * profile is paused and the setpoint held at the subsystem's current value.
+ *
+ * Ends if the subsystem is jammed or offline, or once the profile is complete and the
+ * subsystem's value has been within `Config::setpointTolerance` of the target for
+ * `Config::pauseAfterMoveTime`.
+ */
+class ProfiledMoveCommand : public tap::control::Command
+{
+public:
+    struct Config
+    {
+        /**
+         * The displacement of the setpoint from its value when the command is initialized if
+         * `relative`, otherwise the setpoint to move to.
+         */
+        float target;
+        bool relative;
+        tap::algorithms::MotionProfile::Constraints constraints;
+        /**
+         * The difference between current and desired value when the command will be considered
+         * to be completed. Uses the same units as the subsystem's setpoint.
+         */
+        float setpointTolerance;
+        /**
+         * Time in milliseconds that the command will wait after reaching the target before the
+         * command is considered complete.
+         */
+        uint32_t pauseAfterMoveTime;
+        /**
+         * If `true` the command will set the subsystem setpoint to the target on an uninterrupted
+         * `end()` if the subsystem is online and unjammed, otherwise it will set the setpoint to
+         * the subsystem's current value on `end()`.
+         */
+        bool setSetpointToTargetOnEnd;
+    };
+
+    ProfiledMoveCommand(SetpointSubsystem* setpointSubsystem, const Config& config);
+
+    const char* getName() const override { return "profiled move"; }
+
+    bool isReady() override
+    {
+        return !setpointSubsystem->isJammed() && setpointSubsystem->isOnline();
+    }
+
+    void initialize() override;
+
+    void execute() override;
+
+    void end(bool interrupted) override;
+
+    bool isFinished() const override;
+
+    const tap::algorithms::MotionProfile& getProfile() const { return profile; }
+
+private:
+    SetpointSubsystem* setpointSubsystem;
+
+    Config config;
+
+    tap::algorithms::MotionProfile profile;
+
+    /// Time the profile has been followed, in milliseconds, not counting while it was paused.
+    uint32_t profileTime;
+
+    uint32_t prevExecuteTime;
+
+    tap::arch::MilliTimeout pauseAfterMoveTimeout;
+};  // class ProfiledMoveCommand
+
+}  // namespace tap::control::setpoint
+
+#endif  // TAPROOT_PROFILED_MOVE_COMMAND_HPP_
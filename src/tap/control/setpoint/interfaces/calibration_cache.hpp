@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CALIBRATION_CACHE_HPP_
+#define TAPROOT_CALIBRATION_CACHE_HPP_
+
+namespace tap::control::setpoint
+{
+/**
+ * Storage for the calibrations of setpoint subsystems (see `SetpointSubsystem::getCalibration`),
+ * so that subsystems whose absolute position is trusted don't have to be homed again after a
+ * reset. `tap::storage::KeyValueCalibrationCache` stores them in flash.
+ */
+class CalibrationCache
+{
+public:
+    virtual ~CalibrationCache() = default;
+
+    /**
+     * @param[out] calibration Set to the calibration stored under `key`, if there is one.
+     * @return `false` if there is no calibration stored under `key`.
+     */
+    virtual bool load(const char *key, float *calibration) = 0;
+
+    /// Stores a calibration under `key`, replacing any calibration already stored there.
+    virtual void save(const char *key, float calibration) = 0;
+};
+}  // namespace tap::control::setpoint
+
+#endif  // TAPROOT_CALIBRATION_CACHE_HPP_
@@ -58,6 +58,22 @@ class SetpointSubsystem : public virtual tap::control::Subsystem
      */
     virtual inline void setSetpoint(float newAngle) = 0;
 
+    /**
+     * Sets the rate of change of the setpoint commanded along with it, for subsystems whose
+     * controller adds velocity and acceleration feed-forward terms. Commands that follow a
+     * motion profile call this each time they set the setpoint, and with 0s when they end.
+     *
+     * Subsystems that don't use feed-forward may ignore it, which is the default.
+     *
+     * @param[in] velocity the rate of change of the setpoint, in units / second.
+     * @param[in] acceleration the rate of change of `velocity`, in units / second^2.
+     */
+    virtual void setSetpointFeedForward(float velocity, float acceleration)
+    {
+        (void)velocity;
+        (void)acceleration;
+    }
+
     /**
      * @return The current value of the controlled variable.
      */
@@ -107,6 +123,49 @@ class SetpointSubsystem : public virtual tap::control::Subsystem
      */
     virtual inline float getVelocity() = 0;
 
+    /**
+     * @return the effort the subsystem's actuator is currently applying to move the controlled
+     *      variable, such as motor torque or current, in implementation-defined units. Positive
+     *      effort increases the controlled variable. 0 if the subsystem does not measure it,
+     *      which is the default.
+     */
+    virtual float getTorque() { return 0.0f; }
+
+    /**
+     * @return `true` if the subsystem's raw position, the position `calibrateHere` measures from,
+     *      is absolute and can be trusted to be the same as when the subsystem was last
+     *      calibrated, for example because its encoder is absolute over the subsystem's range of
+     *      motion. If so, a calibration saved with `getCalibration` can be restored with
+     *      `restoreCalibration` instead of calibrating again. `false` by default.
+     */
+    virtual bool isAbsolutePositionTrusted() const { return false; }
+
+    /**
+     * Gets the subsystem's calibration, the raw position at which `getCurrentValue` returns 0,
+     * to be restored by `restoreCalibration`. Not supported by default.
+     *
+     * @param[out] calibration Set to the calibration, if the subsystem is calibrated.
+     * @return `false` if the subsystem isn't calibrated or doesn't support restoring
+     *      calibrations.
+     */
+    virtual bool getCalibration(float *calibration) const
+    {
+        (void)calibration;
+        return false;
+    }
+
+    /**
+     * Calibrates the subsystem with a calibration returned by `getCalibration`, without moving
+     * it. Not supported by default.
+     *
+     * @return `true` if the subsystem is now calibrated.
+     */
+    virtual bool restoreCalibration(float calibration)
+    {
+        (void)calibration;
+        return false;
+    }
+
 };  // class SetpointSubsystem
 
 }  // namespace setpoint
@@ -24,6 +24,8 @@
 
 #include "tap/util_macros.hpp"
 
+#include "time_budget.hpp"
+
 namespace tap
 {
 class Drivers;
@@ -99,6 +101,29 @@ class Subsystem
      */
     virtual void refresh() {}
 
+    /**
+     * Called on each tick the subsystem is refreshed, before the scheduler executes any commands,
+     * so commands act on this tick's measurements rather than the previous tick's. Override to
+     * read the subsystem's sensors, and leave control and outputs to `refresh` and
+     * `refreshActuators`. Also called while safe disconnected.
+     */
+    virtual void refreshSensors() {}
+
+    /**
+     * Called right after `refresh` (or `refreshDegraded`), once every command has executed.
+     * Override to write the outputs commands have set, such as motor desired outputs, so they are
+     * all updated just before the main loop sends them. Not called while safe disconnected, when
+     * `refreshSafeDisconnect` is called instead.
+     */
+    virtual void refreshActuators() {}
+
+    /**
+     * Called instead of `refresh` once the subsystem has been degraded for running over its time
+     * budget, see `getTimeBudget`. Override with a cheaper version of `refresh`. Calls `refresh`
+     * by default.
+     */
+    virtual void refreshDegraded() { refresh(); }
+
     /**
      * Called in the scheduler's run function before removing commands
      * when safe disconnecting. This function should contain code that
@@ -109,7 +134,8 @@ class Subsystem
 
     /**
      * Sets the test command of the `Subsystem`. The test command can be run
-     * by calling `CommandScheduler::runHardwareTests`.
+     * by calling `CommandScheduler::runHardwareTests`, or with a timeout by a
+     * `HardwareTestRunner`.
      *
      * Test commands must keep track of their state so that `Command::isFinished`
      * continues to return true after the command has ended.
@@ -130,6 +156,11 @@ class Subsystem
 
     mockable inline int getGlobalIdentifier() const { return globalIdentifier; }
 
+    /// @return The subsystem's time budget, which is unset unless the subsystem sets it.
+    inline TimeBudget& getTimeBudget() { return timeBudget; }
+
+    inline const TimeBudget& getTimeBudget() const { return timeBudget; }
+
 protected:
     Drivers* drivers;
 
@@ -144,6 +175,8 @@ class Subsystem
      */
     const int globalIdentifier;
 
+    TimeBudget timeBudget;
+
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
     //> Testing Related Stuff ---
 public:
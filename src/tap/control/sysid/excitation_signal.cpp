@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "excitation_signal.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tap::control::sysid
+{
+/// Points per period at which a multisine is sampled to find its peak.
+static constexpr int PEAK_SEARCH_POINTS = 2048;
+
+ExcitationSignal::ExcitationSignal(const ExcitationConfig &config) : config(config)
+{
+    if (config.type == ExcitationConfig::Type::MULTISINE)
+    {
+        configureMultisine();
+    }
+}
+
+float ExcitationSignal::sample(float time) const
+{
+    if (config.type == ExcitationConfig::Type::MULTISINE)
+    {
+        return toneAmplitude * sumTones(time);
+    }
+
+    if (time < 0 || time > config.duration)
+    {
+        return 0;
+    }
+    // The phase is the integral of f0 * k^(t / T), with k = f1 / f0
+    const float logRatio = logf(config.maxFrequency / config.minFrequency);
+    if (logRatio < 1E-6f)
+    {
+        return config.amplitude * sinf(2 * static_cast<float>(M_PI) * config.minFrequency * time);
+    }
+    const float phase = 2 * static_cast<float>(M_PI) * config.minFrequency * config.duration /
+                        logRatio * (expf(logRatio * time / config.duration) - 1);
+    return config.amplitude * sinf(phase);
+}
+
+void ExcitationSignal::configureMultisine()
+{
+    const int maxHarmonic =
+        std::max(1, static_cast<int>(config.maxFrequency / config.minFrequency));
+
+    // Every harmonic if they fit, otherwise logarithmically spaced distinct harmonics
+    numTones = 0;
+    for (int i = 0; i < MAX_TONES; i++)
+    {
+        int harmonic = maxHarmonic <= MAX_TONES
+                           ? i + 1
+                           : lroundf(powf(maxHarmonic, static_cast<float>(i) / (MAX_TONES - 1)));
+        if (harmonic > maxHarmonic)
+        {
+            break;
+        }
+        if (numTones > 0 && harmonic <= harmonics[numTones - 1])
+        {
+            continue;
+        }
+        harmonics[numTones++] = harmonic;
+    }
+
+    // Schroeder phases keep the tones from adding up to a large peak
+    for (int i = 0; i < numTones; i++)
+    {
+        phases[i] = -static_cast<float>(M_PI) * i * (i + 1) / numTones;
+    }
+
+    float peak = 0;
+    const float period = 1 / config.minFrequency;
+    for (int i = 0; i < PEAK_SEARCH_POINTS; i++)
+    {
+        peak = std::max(peak, fabsf(sumTones(period * i / PEAK_SEARCH_POINTS)));
+    }
+    toneAmplitude = peak > 0 ? config.amplitude / peak : 0;
+}
+
+float ExcitationSignal::sumTones(float time) const
+{
+    // Wrap to a single period so the phase stays accurate in a float
+    const float period = 1 / config.minFrequency;
+    time -= floorf(time / period) * period;
+
+    float sum = 0;
+    for (int i = 0; i < numTones; i++)
+    {
+        sum += sinf(2 * static_cast<float>(M_PI) * harmonics[i] * time / period + phases[i]);
+    }
+    return sum;
+}
+}  // namespace tap::control::sysid
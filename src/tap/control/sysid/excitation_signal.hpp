@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_EXCITATION_SIGNAL_HPP_
+#define TAPROOT_EXCITATION_SIGNAL_HPP_
+
+#include <cstdint>
+
+namespace tap::control::sysid
+{
+struct ExcitationConfig
+{
+    enum class Type : uint8_t
+    {
+        /**
+         * A sine whose frequency sweeps exponentially from `minFrequency` to `maxFrequency`
+         * over `duration`, so every octave gets the same time. Zero once the sweep is done.
+         */
+        CHIRP,
+        /**
+         * A periodic sum of sines at harmonics of `minFrequency` up to `maxFrequency`, spaced
+         * logarithmically if there are more than `ExcitationSignal::MAX_TONES`, with Schroeder
+         * phases for a low crest factor. Excites every frequency at once, so the frequency
+         * response at the tones can be averaged over periods to reject noise.
+         */
+        MULTISINE,
+    };
+
+    Type type = Type::CHIRP;
+    /// The peak value of the signal.
+    float amplitude = 0.0f;
+    /// In Hz.
+    float minFrequency = 1.0f;
+    /// In Hz.
+    float maxFrequency = 10.0f;
+    /// Length of a chirp's sweep in seconds. Unused by a multisine, whose period is
+    /// `1 / minFrequency`.
+    float duration = 10.0f;
+};
+
+/**
+ * Generates the excitation of a system identification experiment, see `SysIdCommand`.
+ */
+class ExcitationSignal
+{
+public:
+    static constexpr int MAX_TONES = 32;
+
+    explicit ExcitationSignal(const ExcitationConfig &config);
+
+    /// @return The signal `time` seconds after the start of the experiment.
+    float sample(float time) const;
+
+    const ExcitationConfig &getConfig() const { return config; }
+
+    /// @return The number of tones of a multisine, 0 for a chirp.
+    int getNumTones() const { return numTones; }
+
+    /// @return The frequency of multisine tone `i`, in Hz.
+    float getToneFrequency(int i) const { return harmonics[i] * config.minFrequency; }
+
+private:
+    ExcitationConfig config;
+
+    /// Harmonic of `minFrequency` of each multisine tone.
+    uint16_t harmonics[MAX_TONES];
+    float phases[MAX_TONES];
+    /// Amplitude of each tone, such that the peak of the sum is `amplitude`.
+    float toneAmplitude = 0;
+    int numTones = 0;
+
+    void configureMultisine();
+
+    float sumTones(float time) const;
+};
+}  // namespace tap::control::sysid
+
+#endif  // TAPROOT_EXCITATION_SIGNAL_HPP_
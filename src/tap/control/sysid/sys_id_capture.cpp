@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "sys_id_capture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/serial/telemetry_stream.hpp"
+
+using tap::communication::serial::TelemetryStream;
+
+namespace tap::control::sysid
+{
+static_assert(
+    SysIdCapture::BLOCK_HEADER_LENGTH +
+            SysIdCapture::SAMPLES_PER_BLOCK * SysIdCapture::SAMPLE_LENGTH <=
+        TelemetryStream::MAX_BLOCK_LENGTH,
+    "a block of samples must fit in a block packet");
+
+SysIdCapture::SysIdCapture(TelemetryStream *stream) : stream(stream), samples(), block() {}
+
+void SysIdCapture::reset()
+{
+    head = 0;
+    size = 0;
+    nextIndex = 0;
+    numDropped = 0;
+    flushRequested = false;
+}
+
+bool SysIdCapture::push(uint32_t time, float input, float output)
+{
+    // Dropped samples still take an index so the host sees the gap
+    const uint32_t index = nextIndex++;
+    if (size == CAPACITY)
+    {
+        numDropped++;
+        return false;
+    }
+
+    samples[(head + size) % CAPACITY] = {index, time, input, output};
+    size++;
+    return true;
+}
+
+void SysIdCapture::pop(int n)
+{
+    n = std::min(n, size);
+    head = (head + n) % CAPACITY;
+    size -= n;
+}
+
+void SysIdCapture::update()
+{
+    if (stream == nullptr || size == 0 || (size < SAMPLES_PER_BLOCK && !flushRequested))
+    {
+        return;
+    }
+
+    // A block only holds consecutive samples, so it ends at a gap left by dropped samples
+    const uint32_t firstIndex = getSample(0).index;
+    const int maxCount = std::min(size, SAMPLES_PER_BLOCK);
+    int count = 1;
+    while (count < maxCount && getSample(count).index == firstIndex + count)
+    {
+        count++;
+    }
+
+    uint8_t *data = block;
+    tap::arch::convertToLittleEndian(firstIndex, data);
+    data += sizeof(uint32_t);
+    *data++ = count;
+    for (int i = 0; i < count; i++)
+    {
+        // floats are copied in the native byte order, which is little endian on both the MCB
+        // and hosted targets
+        const Sample &sample = getSample(i);
+        tap::arch::convertToLittleEndian(sample.time, data);
+        memcpy(data + sizeof(uint32_t), &sample.input, sizeof(float));
+        memcpy(data + sizeof(uint32_t) + sizeof(float), &sample.output, sizeof(float));
+        data += SAMPLE_LENGTH;
+    }
+
+    stream->sendBlock(BLOCK_TYPE, block, data - block);
+    pop(count);
+    if (size == 0)
+    {
+        flushRequested = false;
+    }
+}
+}  // namespace tap::control::sysid
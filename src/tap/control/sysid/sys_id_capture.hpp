@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_SYS_ID_CAPTURE_HPP_
+#define TAPROOT_SYS_ID_CAPTURE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+namespace tap::communication::serial
+{
+class TelemetryStream;
+}
+
+namespace tap::control::sysid
+{
+/**
+ * A ring buffer of synchronized input, output and timestamp samples of a system
+ * identification experiment, streamed to a computer in the background as `TelemetryStream`
+ * block packets. The control loop only copies each sample into RAM with `push`, and `update`,
+ * called from the main loop, sends at most one block of samples per call, so logging never
+ * blocks the loop.
+ *
+ * Each block packet has block type `BLOCK_TYPE` and a payload of a `uint32_t` index of the
+ * first sample since `reset`, a `uint8_t` number of samples, then for each sample a `uint32_t`
+ * time in microseconds, a `float` input and a `float` output, all little endian. A gap in the
+ * sample indices means samples were dropped because the buffer was full. `tools/sysid_fit.py`
+ * decodes the samples and fits a transfer function to them.
+ *
+ * The link must sustain the sample rate: 12 bytes per sample plus framing, so about 14 KB/s at
+ * 1 kHz, which needs a baud rate of at least 230400.
+ */
+class SysIdCapture
+{
+public:
+    static constexpr int CAPACITY = 1024;
+    static constexpr uint8_t BLOCK_TYPE = 1;
+    /// Bytes in a block before the samples.
+    static constexpr std::size_t BLOCK_HEADER_LENGTH = sizeof(uint32_t) + sizeof(uint8_t);
+    static constexpr std::size_t SAMPLE_LENGTH = sizeof(uint32_t) + 2 * sizeof(float);
+    static constexpr int SAMPLES_PER_BLOCK = 20;
+
+    struct Sample
+    {
+        /// Index since `reset`, counting dropped samples.
+        uint32_t index;
+        uint32_t time;
+        float input;
+        float output;
+    };
+
+    /// @param[in] stream The stream to send blocks over, or `nullptr` to only capture to RAM.
+    explicit SysIdCapture(tap::communication::serial::TelemetryStream *stream);
+    DISALLOW_COPY_AND_ASSIGN(SysIdCapture)
+
+    /// Discards all samples and restarts the sample index at 0.
+    void reset();
+
+    /**
+     * Adds a sample, or drops it if the buffer is full.
+     *
+     * @return `false` if the sample was dropped.
+     */
+    bool push(uint32_t time, float input, float output);
+
+    /**
+     * Sends a block if a full block is buffered, or if a flush was requested and any samples
+     * are. Call every main loop.
+     */
+    void update();
+
+    /// Makes `update` send the remaining samples even if they don't fill a block.
+    void flush() { flushRequested = true; }
+
+    /// @return The number of samples buffered and not yet sent.
+    int getSize() const { return size; }
+
+    /// @return The number of samples dropped since `reset`.
+    uint32_t getNumDropped() const { return numDropped; }
+
+    /**
+     * @return Buffered sample `i`, 0 being the oldest. Lets a robot analyze the samples itself
+     *      when there is no stream.
+     */
+    const Sample &getSample(int i) const { return samples[(head + i) % CAPACITY]; }
+
+    /// Removes the `n` oldest buffered samples.
+    void pop(int n);
+
+private:
+    tap::communication::serial::TelemetryStream *stream;
+
+    Sample samples[CAPACITY];
+    int head = 0;
+    int size = 0;
+    /// Index of the next sample pushed.
+    uint32_t nextIndex = 0;
+    uint32_t numDropped = 0;
+    bool flushRequested = false;
+
+    uint8_t block[BLOCK_HEADER_LENGTH + SAMPLES_PER_BLOCK * SAMPLE_LENGTH];
+};
+}  // namespace tap::control::sysid
+
+#endif  // TAPROOT_SYS_ID_CAPTURE_HPP_
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "sys_id_command.hpp"
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/subsystem.hpp"
+
+namespace tap::control::sysid
+{
+SysIdCommand::SysIdCommand(
+    Subsystem *subsystem,
+    tap::motor::MotorInterface *motor,
+    Measurement measurement,
+    float outputBias,
+    const ExcitationConfig &excitation,
+    float duration,
+    SysIdCapture *capture)
+    : motor(motor),
+      measurement(measurement),
+      outputBias(outputBias),
+      excitation(excitation),
+      duration(duration * 1E6f),
+      capture(capture)
+{
+    addSubsystemRequirement(subsystem);
+}
+
+bool SysIdCommand::isReady() { return motor->isMotorOnline(); }
+
+void SysIdCommand::initialize()
+{
+    capture->reset();
+    startTime = tap::arch::clock::getTimeMicroseconds();
+    elapsed = 0;
+    prevOutput = outputBias;
+}
+
+void SysIdCommand::execute()
+{
+    const uint32_t time = tap::arch::clock::getTimeMicroseconds();
+    elapsed = time - startTime;
+
+    // The measurement is the response to the output applied so far, so it is paired with that
+    // output rather than the one about to be applied
+    capture->push(time, prevOutput, getMeasurement());
+
+    prevOutput = outputBias + excitation.sample(elapsed / 1E6f);
+    motor->setDesiredOutput(prevOutput);
+}
+
+void SysIdCommand::end(bool)
+{
+    motor->setDesiredOutput(0);
+    capture->flush();
+}
+
+bool SysIdCommand::isFinished() const { return elapsed >= duration || !motor->isMotorOnline(); }
+
+float SysIdCommand::getMeasurement() const
+{
+    switch (measurement)
+    {
+        case Measurement::SHAFT_RPM:
+            return motor->getShaftRPM();
+        case Measurement::POSITION_UNWRAPPED:
+        default:
+            return motor->getPositionUnwrapped();
+    }
+}
+}  // namespace tap::control::sysid
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_SYS_ID_COMMAND_HPP_
+#define TAPROOT_SYS_ID_COMMAND_HPP_
+
+#include "tap/control/command.hpp"
+#include "tap/motor/motor_interface.hpp"
+
+#include "excitation_signal.hpp"
+#include "sys_id_capture.hpp"
+
+namespace tap::control
+{
+class Subsystem;
+}
+
+namespace tap::control::sysid
+{
+/**
+ * Measures a motor-driven plant for system identification: takes over the motor from the
+ * subsystem that owns it, drives it with `outputBias` plus an excitation signal, and records
+ * every applied output with the resulting measurement into a `SysIdCapture`, for example:
+ *
+ * ```cpp
+ * SysIdCapture capture(&drivers->terminalSerial.getTelemetryStream());
+ * SysIdCommand sysId(
+ *     &turret,
+ *     &yawMotor,
+ *     SysIdCommand::Measurement::SHAFT_RPM,
+ *     0,
+ *     {.type = ExcitationConfig::Type::CHIRP,
+ *      .amplitude = 4'000,
+ *      .minFrequency = 0.5f,
+ *      .maxFrequency = 40,
+ *      .duration = 20},
+ *     20,
+ *     &capture);
+ *
+ * void mainLoop()
+ * {
+ *     // Streams the samples captured so far
+ *     capture.update();
+ * }
+ * ```
+ *
+ * `tools/sysid_fit.py` then estimates the plant's frequency response from the input (the motor
+ * output) and output (the measurement), and fits a transfer function to it. The command must
+ * run at a fixed loop rate, since it records one sample per `execute`.
+ */
+class SysIdCommand : public Command
+{
+public:
+    enum class Measurement : uint8_t
+    {
+        SHAFT_RPM,
+        POSITION_UNWRAPPED,
+    };
+
+    /**
+     * @param[in] subsystem The subsystem that owns the motor, required by the command so its
+     *      own commands don't drive the motor during the experiment.
+     * @param[in] motor The motor to drive and measure.
+     * @param[in] measurement The output of the identified plant.
+     * @param[in] outputBias Motor output the excitation is added to, for example the output
+     *      holding a flywheel at its operating speed.
+     * @param[in] excitation The excitation, in motor output units.
+     * @param[in] duration Seconds to run the experiment for.
+     * @param[in] capture Records the samples, reset when the command starts.
+     */
+    SysIdCommand(
+        Subsystem *subsystem,
+        tap::motor::MotorInterface *motor,
+        Measurement measurement,
+        float outputBias,
+        const ExcitationConfig &excitation,
+        float duration,
+        SysIdCapture *capture);
+
+    const char *getName() const override { return "sys id"; }
+
+    bool isReady() override;
+
+    void initialize() override;
+
+    void execute() override;
+
+    void end(bool interrupted) override;
+
+    bool isFinished() const override;
+
+private:
+    tap::motor::MotorInterface *motor;
+    Measurement measurement;
+    float outputBias;
+    ExcitationSignal excitation;
+    uint32_t duration;
+    SysIdCapture *capture;
+
+    uint32_t startTime = 0;
+    uint32_t elapsed = 0;
+    /// The output applied by the previous `execute`, whose response is measured now.
+    int32_t prevOutput = 0;
+
+    float getMeasurement() const;
+};  // class SysIdCommand
+}  // namespace tap::control::sysid
+
+#endif  // TAPROOT_SYS_ID_COMMAND_HPP_
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TAPROOT_TIME_BUDGET_HPP_
+#define TAPROOT_TIME_BUDGET_HPP_
+
+#include <cstdint>
+
+#include "tap/architecture/clock.hpp"
+
+namespace tap
+{
+namespace control
+{
+/**
+ * The time a `Command` may take per `execute`, or a `Subsystem` per `refresh`, in CPU cycles.
+ * When a budget is set, the `CommandScheduler` measures each call, and once the element has gone
+ * over its budget `overrunsToDegrade` ticks in a row, degrades it and raises an error naming it.
+ * From then on a degraded command has `Command::executeDegraded` called instead of `execute` and
+ * a degraded subsystem has `Subsystem::refreshDegraded` called instead of `refresh`, which should
+ * be cheaper fallbacks (e.g. aiming without vision), so one element running long doesn't push the
+ * rest of the loop past `MAX_ALLOWABLE_SCHEDULER_RUNTIME`.
+ *
+ * A degraded command is restored when it is added to the scheduler again. A degraded subsystem
+ * stays degraded until `restore` is called.
+ */
+class TimeBudget
+{
+public:
+    static constexpr uint8_t DEFAULT_OVERRUNS_TO_DEGRADE = 3;
+
+    /**
+     * Sets the budget and restores the element. Setting a budget enables the cycle counter the
+     * scheduler measures with, so budgets work without execution time accounting turned on.
+     *
+     * @param[in] budgetCycles The cycles allowed per call, 0 to remove the budget.
+     * @param[in] overrunsToDegrade The number of consecutive calls over budget after which the
+     *      element is degraded.
+     */
+    void set(uint32_t budgetCycles, uint8_t overrunsToDegrade = DEFAULT_OVERRUNS_TO_DEGRADE)
+    {
+        if (budgetCycles != 0)
+        {
+            arch::clock::enableCycleCounter();
+        }
+        this->budgetCycles = budgetCycles;
+        this->overrunsToDegrade = overrunsToDegrade == 0 ? 1 : overrunsToDegrade;
+        restore();
+    }
+
+    /// @return `true` if a budget is set, in which case the scheduler measures the element.
+    bool isSet() const { return budgetCycles != 0; }
+
+    uint32_t getBudgetCycles() const { return budgetCycles; }
+
+    bool isDegraded() const { return degraded; }
+
+    /// Returns the element to its normal mode and clears its count of overruns.
+    void restore()
+    {
+        degraded = false;
+        consecutiveOverruns = 0;
+    }
+
+    /**
+     * Records how long one call took. Calls under budget clear the count of overruns.
+     *
+     * @return `true` if this call degraded the element.
+     */
+    bool update(uint32_t cycles)
+    {
+        if (!isSet() || degraded)
+        {
+            return false;
+        }
+        if (cycles <= budgetCycles)
+        {
+            consecutiveOverruns = 0;
+            return false;
+        }
+        if (++consecutiveOverruns >= overrunsToDegrade)
+        {
+            degraded = true;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    uint32_t budgetCycles = 0;
+    uint8_t overrunsToDegrade = DEFAULT_OVERRUNS_TO_DEGRADE;
+    uint8_t consecutiveOverruns = 0;
+    bool degraded = false;
+};  // class TimeBudget
+
+}  // namespace control
+
+}  // namespace tap
+
+#endif  // TAPROOT_TIME_BUDGET_HPP_
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "performance_menu.hpp"
+
+#include <cstring>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/board/board.hpp"
+#include "tap/communication/sensors/imu/imu_interface.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::can;
+
+namespace tap::display
+{
+PerformanceMenu::PerformanceMenu(
+    modm::ViewStack<DummyAllocator<modm::IAbstractView> >* stack,
+    Drivers* drivers,
+    const communication::sensors::imu::ImuInterface* imu)
+    : modm::AbstractMenu<DummyAllocator<modm::IAbstractView> >(stack, 1),
+      drivers(drivers),
+      imu(imu),
+      prevRefRxMessageCount(drivers->refSerial.getRxMessageCount()),
+      prevDrawTime(arch::clock::getTimeMilliseconds())
+{
+}
+
+void PerformanceMenu::draw()
+{
+    modm::GraphicDisplay& display = getViewStack()->getDisplay();
+    display.clear();
+    display.setCursor(0, 2);
+    display << getMenuName() << modm::endl;
+
+    const control::CommandScheduler& scheduler = drivers->commandScheduler;
+    display << "Sched: " << scheduler.getLastRunTime() << " us" << modm::endl;
+
+    if (scheduler.getWorstOffenderName() != nullptr)
+    {
+        char name[NAME_LENGTH + 1] = {};
+        strncpy(name, scheduler.getWorstOffenderName(), NAME_LENGTH);
+        display << "Worst: " << name << " "
+                << scheduler.getWorstOffenderCycles() /
+                       (Board::SystemClock::Frequency / 1'000'000)
+                << " us" << modm::endl;
+    }
+    else
+    {
+        display << "Worst: -" << modm::endl;
+    }
+
+    display.printf(
+        "CAN1 %d%% CAN2 %d%%\n",
+        static_cast<int>(drivers->can.getBusStats(CanBus::CAN_BUS1).busLoad),
+        static_cast<int>(drivers->can.getBusStats(CanBus::CAN_BUS2).busLoad));
+
+    if (imu != nullptr && imu->getDiagnostics() != nullptr)
+    {
+        display.printf(
+            "IMU ODR: %.0f Hz\n",
+            static_cast<double>(imu->getDiagnostics()->getSampleFrequency()));
+    }
+    else
+    {
+        display << "IMU ODR: -" << modm::endl;
+    }
+
+    uint32_t now = arch::clock::getTimeMilliseconds();
+    uint32_t refRxMessageCount = drivers->refSerial.getRxMessageCount();
+    uint32_t refRxRate = now == prevDrawTime ? 0
+                                             : (refRxMessageCount - prevRefRxMessageCount) *
+                                                   1'000 / (now - prevDrawTime);
+    display << "Ref RX: " << refRxRate << " msg/s" << modm::endl;
+    prevRefRxMessageCount = refRxMessageCount;
+    prevDrawTime = now;
+
+    arch::MemoryMonitor::StackUsage mainStack =
+        drivers->memoryMonitor.getStackUsage(arch::MemoryMonitor::MAIN_STACK_ID);
+    if (mainStack.size > 0)
+    {
+        display << "Stack free: " << mainStack.size - mainStack.maxUsed << " B";
+    }
+    else
+    {
+        display << "Stack free: -";
+    }
+}
+
+void PerformanceMenu::shortButtonPress(modm::MenuButtons::Button button)
+{
+    if (button == modm::MenuButtons::LEFT)
+    {
+        this->remove();
+    }
+}
+
+void PerformanceMenu::update() {}
+
+bool PerformanceMenu::hasChanged() { return updatePeriodicTimer.execute(); }
+
+}  // namespace tap::display
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PERFORMANCE_MENU_HPP_
+#define TAPROOT_PERFORMANCE_MENU_HPP_
+
+#include "tap/architecture/periodic_timer.hpp"
+
+#include "modm/ui/menu/abstract_menu.hpp"
+
+#include "dummy_allocator.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::communication::sensors::imu
+{
+class ImuInterface;
+}
+
+namespace tap::display
+{
+/**
+ * A menu that displays live performance figures, to diagnose a misbehaving robot without a
+ * laptop:
+ * - Time the most recent `CommandScheduler::run` took
+ * - The Command or Subsystem that took the longest during it, if execution time accounting is
+ *   enabled (see `CommandScheduler::setExecutionTimeAccountingEnabled`)
+ * - CAN 1 and CAN 2 bus load
+ * - IMU output data rate, if the IMU keeps diagnostics
+ * - Rate of messages received from the referee system
+ * - Main stack never used since boot, see `arch::MemoryMonitor`
+ *
+ * All figures are read from counters the drivers already keep, and the menu is only redrawn
+ * every `DISPLAY_DRAW_PERIOD` ms.
+ */
+class PerformanceMenu : public modm::AbstractMenu<DummyAllocator<modm::IAbstractView> >
+{
+public:
+    /// Time between calls to `draw`, which will redraw the performance menu.
+    static constexpr uint32_t DISPLAY_DRAW_PERIOD = 500;
+    /// Number of characters of the worst offender's name that are displayed.
+    static constexpr int NAME_LENGTH = 8;
+
+    /**
+     * @param[in] imu The IMU whose output data rate is displayed, or `nullptr` for none.
+     */
+    PerformanceMenu(
+        modm::ViewStack<DummyAllocator<modm::IAbstractView> > *stack,
+        Drivers *drivers,
+        const communication::sensors::imu::ImuInterface *imu = nullptr);
+
+    void draw() override;
+
+    void shortButtonPress(modm::MenuButtons::Button button) override;
+
+    void update() override;
+
+    bool hasChanged() override;
+
+    static const char *getMenuName() { return "Performance Menu"; }
+
+private:
+    Drivers *drivers;
+    const communication::sensors::imu::ImuInterface *imu;
+
+    arch::PeriodicMilliTimer updatePeriodicTimer{DISPLAY_DRAW_PERIOD};
+
+    /// Referee system message count and time at the previous `draw`, to compute the RX rate.
+    uint32_t prevRefRxMessageCount = 0;
+    uint32_t prevDrawTime = 0;
+};
+}  // namespace tap::display
+
+#endif  // TAPROOT_PERFORMANCE_MENU_HPP_
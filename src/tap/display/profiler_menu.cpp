@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiler_menu.hpp"
+
+#include <cstring>
+
+#include "tap/drivers.hpp"
+
+using tap::arch::LatencyHistogram;
+
+namespace tap::display
+{
+ProfilerMenu::ProfilerMenu(
+    modm::ViewStack<DummyAllocator<modm::IAbstractView> >* stack,
+    Drivers* drivers)
+    : modm::AbstractMenu<DummyAllocator<modm::IAbstractView> >(stack, 1),
+      drivers(drivers),
+      verticalScroll(drivers, 0, DISPLAY_MAX_ENTRIES)
+{
+}
+
+void ProfilerMenu::draw()
+{
+    int numHistograms = countHistograms();
+    if (numHistograms != verticalScroll.getSize())
+    {
+        // Histograms may be enabled at any time
+        verticalScroll.setSize(numHistograms);
+    }
+
+    modm::GraphicDisplay& display = getViewStack()->getDisplay();
+    display.clear();
+    display.setCursor(0, 2);
+    display << getMenuName() << modm::endl;
+
+    int index = 0;
+    for (std::size_t key = 0; key < drivers->profiler.getNumProfiles(); key++)
+    {
+        LatencyHistogram::Summary summary;
+        if (!drivers->profiler.getHistogramSummary(key, &summary))
+        {
+            continue;
+        }
+
+        if (index >= verticalScroll.getSmallestIndexDisplayed() &&
+            index <= verticalScroll.getLargestIndexDisplayed())
+        {
+            char name[NAME_LENGTH + 1] = {};
+            strncpy(name, drivers->profiler.getData(key).name, NAME_LENGTH);
+            display << (index == verticalScroll.getCursorIndex() ? ">" : " ") << name << " "
+                    << summary.p50 << "/" << summary.p99 << "/" << summary.p999 << modm::endl;
+        }
+        index++;
+    }
+}
+
+void ProfilerMenu::shortButtonPress(modm::MenuButtons::Button button)
+{
+    if (button == modm::MenuButtons::LEFT)
+    {
+        this->remove();
+    }
+    else
+    {
+        verticalScroll.onShortButtonPress(button);
+    }
+}
+
+void ProfilerMenu::update() {}
+
+bool ProfilerMenu::hasChanged()
+{
+    return verticalScroll.acknowledgeCursorChanged() || updatePeriodicTimer.execute();
+}
+
+int ProfilerMenu::countHistograms() const
+{
+    int count = 0;
+    for (std::size_t key = 0; key < drivers->profiler.getNumProfiles(); key++)
+    {
+        if (drivers->profiler.getHistogram(key) != nullptr)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+}  // namespace tap::display
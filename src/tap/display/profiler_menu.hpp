@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_PROFILER_MENU_HPP_
+#define TAPROOT_PROFILER_MENU_HPP_
+
+#include "tap/architecture/periodic_timer.hpp"
+
+#include "modm/ui/menu/abstract_menu.hpp"
+
+#include "dummy_allocator.hpp"
+#include "vertical_scroll_logic_handler.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::display
+{
+/**
+ * A menu that displays the p50, p99, and p999 latency of each profile in `Drivers::profiler` that
+ * records a histogram (see `arch::Profiler::enableHistogram`), one profile per line, as
+ * "<name> <p50>/<p99>/<p999>". Names are truncated to fit the display.
+ */
+class ProfilerMenu : public modm::AbstractMenu<DummyAllocator<modm::IAbstractView> >
+{
+public:
+    /// Time between calls to `draw`, which will redraw the profiler menu.
+    static constexpr uint32_t DISPLAY_DRAW_PERIOD = 500;
+    static constexpr int DISPLAY_MAX_ENTRIES = 8;
+    /// Number of characters of each profile's name that are displayed.
+    static constexpr int NAME_LENGTH = 7;
+
+    ProfilerMenu(modm::ViewStack<DummyAllocator<modm::IAbstractView> > *stack, Drivers *drivers);
+
+    void draw() override;
+
+    void shortButtonPress(modm::MenuButtons::Button button) override;
+
+    void update() override;
+
+    bool hasChanged() override;
+
+    static const char *getMenuName() { return "Profiler Menu"; }
+
+private:
+    Drivers *drivers;
+    VerticalScrollLogicHandler verticalScroll;
+
+    arch::PeriodicMilliTimer updatePeriodicTimer{DISPLAY_DRAW_PERIOD};
+
+    /// @return The number of profiles that record a histogram.
+    int countHistograms() const;
+};
+}  // namespace tap::display
+
+#endif  // TAPROOT_PROFILER_MENU_HPP_
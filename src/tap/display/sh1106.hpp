@@ -31,6 +31,12 @@ namespace display
 {
 /**
  * Driver for SH1106 based OLED displays
+ *
+ * The driver keeps a copy of what the display currently shows. `updateNonblocking` only sends the
+ * range of columns of each page (row of 8 pixels) that differ from it, so redrawing a menu where
+ * a single number changed sends a few bytes instead of the whole buffer. Each range is sent with
+ * a single `SPI::transfer`, which uses DMA if `SPI` is a DMA SPI master (e.g.
+ * `modm::platform::SpiMaster1_Dma`).
  */
 template <
 #ifndef PLATFORM_HOSTED
@@ -67,6 +73,12 @@ class Sh1106 : public modm::MonochromeGraphicDisplayVertical<Width, Height>, mod
      */
     void setInvert(bool invert);
 
+    /**
+     * Makes the next update send the whole buffer, for example if the display may have been
+     * reset and no longer shows what the driver last sent.
+     */
+    void invalidate() { fullUpdate = true; }
+
 protected:
 #ifndef PLATFORM_HOSTED
     SPI spi;
@@ -82,8 +94,25 @@ class Sh1106 : public modm::MonochromeGraphicDisplayVertical<Width, Height>, mod
      * to have local variables in protothreads these are stored by this class.
      */
     uint8_t x, y;
+    /// Number of columns of page `y`, starting at column `x`, being sent.
+    uint8_t length;
 
     modm::atomic::Flag writeToDisplay;
+
+    /// What the display shows, also the source of transfers so drawing can't change them.
+    uint8_t displayed[Height / 8][Width];
+
+    /// Column of the display RAM that the first column of the buffer is shown in.
+    static constexpr uint8_t COLUMN_OFFSET = Flipped ? 4 : SH1106_COL_OFFSET;
+
+    /// `true` if `displayed` may not match the display.
+    bool fullUpdate = true;
+
+    /**
+     * Sets `x` and `length` to the range of columns of page `y` that differ from `displayed`,
+     * and copies them into `displayed`. `length` is 0 if the page is unchanged.
+     */
+    void findChangedColumns();
 };
 
 }  // namespace display
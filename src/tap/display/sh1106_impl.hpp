@@ -21,6 +21,8 @@
 #error "Don't include this file directly, use 'sh1106.hpp' instead!"
 #endif
 
+#include <cstring>
+
 #include "sh1106_defines.hpp"
 
 template <
@@ -39,29 +41,53 @@ modm::ResumableResult<bool> tap::display::Sh1106<SPI, A0, Reset, Width, Height,
 
     for (y = 0; y < (Height / 8); ++y)
     {
+        findChangedColumns();
+        if (length == 0)
+        {
+            continue;
+        }
+
         // command mode
         a0.reset();
         RF_CALL(spi.transfer(SH1106_PAGE_ADDRESS | y));  // Row select
-        RF_CALL(spi.transfer(SH1106_COL_ADDRESS_MSB));   // Column select high
-
-        if (Flipped)
-        {
-            RF_CALL(spi.transfer(SH1106_COL_ADDRESS_LSB | 4));  // Column select low
-        }
-        else
-        {
-            RF_CALL(spi.transfer(SH1106_COL_ADDRESS_LSB | SH1106_COL_OFFSET));  // Column select low
-        }
+        RF_CALL(spi.transfer(SH1106_COL_ADDRESS_MSB | ((x + COLUMN_OFFSET) >> 4)));  // Column high
+        RF_CALL(spi.transfer(SH1106_COL_ADDRESS_LSB | ((x + COLUMN_OFFSET) & 0x0f)));  // Column low
 
         // switch to data mode
         a0.set();
-        for (x = 0; x < Width; ++x)
+        RF_CALL(spi.transfer(&displayed[y][x], nullptr, length));
+    }
+    fullUpdate = false;
+
+    RF_END_RETURN(true);
+}
+
+template <
+    typename SPI,
+    typename A0,
+    typename Reset,
+    unsigned int Width,
+    unsigned int Height,
+    bool Flipped>
+void tap::display::Sh1106<SPI, A0, Reset, Width, Height, Flipped>::findChangedColumns()
+{
+    int first = 0;
+    int last = Width - 1;
+    if (!fullUpdate)
+    {
+        while (first < static_cast<int>(Width) && this->buffer[y][first] == displayed[y][first])
         {
-            RF_CALL(spi.transfer(this->buffer[y][x]));
+            first++;
+        }
+        while (last > first && this->buffer[y][last] == displayed[y][last])
+        {
+            last--;
         }
     }
 
-    RF_END_RETURN(true);
+    x = first;
+    length = first < static_cast<int>(Width) ? last - first + 1 : 0;
+    memcpy(&displayed[y][x], &this->buffer[y][x], length);
 }
 
 template <
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "static_menu.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tap
+{
+namespace display
+{
+/**
+ * Appends `src` to `text`, which holds `length` chars, truncating it to the length of a row.
+ *
+ * @return The new length of `text`.
+ */
+static int append(char (&text)[StaticMenu::MAX_ROW_LENGTH + 1], int length, const char *src)
+{
+    while (length < StaticMenu::MAX_ROW_LENGTH && *src != '\0')
+    {
+        text[length++] = *src++;
+    }
+    text[length] = '\0';
+    return length;
+}
+
+StaticMenu::StaticMenu(modm::GraphicDisplay &display, const StaticMenuPage &root)
+    : display(display)
+{
+    path[0] = {&root, 0, 0};
+}
+
+void StaticMenu::shortButtonPress(modm::MenuButtons::Button button)
+{
+    Level &level = path[depth - 1];
+    const StaticMenuItem *item =
+        level.page->numItems > 0 ? &level.page->items[level.cursor] : nullptr;
+
+    switch (button)
+    {
+        case modm::MenuButtons::UP:
+            if (level.cursor > 0)
+            {
+                level.cursor--;
+                level.top = std::min(level.top, level.cursor);
+            }
+            break;
+        case modm::MenuButtons::DOWN:
+            if (level.cursor < level.page->numItems - 1)
+            {
+                level.cursor++;
+                // The rows below the title show items top to top + NUM_ROWS - 2
+                level.top = std::max<int8_t>(level.top, level.cursor - (NUM_ROWS - 2));
+            }
+            break;
+        case modm::MenuButtons::LEFT:
+            if (depth > 1)
+            {
+                depth--;
+                pageChanged = true;
+            }
+            break;
+        case modm::MenuButtons::RIGHT:
+            if (item != nullptr && item->child != nullptr)
+            {
+                openPage(*item->child);
+            }
+            break;
+        case modm::MenuButtons::OK:
+            if (item != nullptr && item->select != nullptr)
+            {
+                item->select(item->context);
+            }
+            break;
+    }
+}
+
+bool StaticMenu::update()
+{
+    bool changed = false;
+    if (pageChanged)
+    {
+        // Clearing the display makes every row blank, the text of an empty row
+        display.clear();
+        memset(rows, 0, sizeof(rows));
+        nextRow = 0;
+        pageChanged = false;
+        changed = true;
+    }
+
+    for (int i = 0; i < ROWS_PER_UPDATE; i++)
+    {
+        char text[MAX_ROW_LENGTH + 1];
+        formatRow(nextRow, text);
+        if (strcmp(text, rows[nextRow]) != 0)
+        {
+            drawRow(nextRow, text);
+            strcpy(rows[nextRow], text);
+            changed = true;
+        }
+        nextRow = (nextRow + 1) % NUM_ROWS;
+    }
+
+    return changed;
+}
+
+void StaticMenu::formatRow(int row, char (&text)[MAX_ROW_LENGTH + 1]) const
+{
+    const Level &level = path[depth - 1];
+    text[0] = '\0';
+
+    if (row == 0)
+    {
+        append(text, 0, level.page->title);
+        return;
+    }
+
+    const int index = level.top + row - 1;
+    if (index >= level.page->numItems)
+    {
+        return;
+    }
+
+    const StaticMenuItem &item = level.page->items[index];
+    int length = append(text, 0, index == level.cursor ? ">" : " ");
+    length = append(text, length, item.label);
+    if (item.render != nullptr)
+    {
+        length = append(text, length, ": ");
+        item.render(item.context, &text[length], sizeof(text) - length);
+        text[MAX_ROW_LENGTH] = '\0';
+    }
+}
+
+void StaticMenu::drawRow(int row, const char *text)
+{
+    const int16_t height = display.getFontHeight();
+    const int16_t top = row * height;
+    for (int16_t y = top; y < top + height; y++)
+    {
+        for (int16_t x = 0; x < static_cast<int16_t>(display.getBufferWidth()); x++)
+        {
+            display.clearPixel(x, y);
+        }
+    }
+
+    display.setCursor(0, top);
+    display << text;
+}
+
+void StaticMenu::openPage(const StaticMenuPage &page)
+{
+    if (depth == MAX_DEPTH)
+    {
+        return;
+    }
+    path[depth++] = {&page, 0, 0};
+    pageChanged = true;
+}
+}  // namespace display
+}  // namespace tap
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_STATIC_MENU_HPP_
+#define TAPROOT_STATIC_MENU_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "modm/ui/display/graphic_display.hpp"
+#include "modm/ui/menu/menu_buttons.hpp"
+
+namespace tap
+{
+namespace display
+{
+struct StaticMenuItem;
+
+/**
+ * A page of a `StaticMenu`, a title and a fixed list of items. Pages and items are plain
+ * aggregates meant to be defined as `const` globals, so the whole menu tree is laid out at
+ * compile time and lives in flash:
+ *
+ * ```cpp
+ * void renderRpm(void *context, char *text, size_t size)
+ * {
+ *     snprintf(text, size, "%d", static_cast<DjiMotor *>(context)->getShaftRPM());
+ * }
+ *
+ * const StaticMenuItem MOTOR_ITEMS[] = {
+ *     {"Yaw RPM", renderRpm, &yawMotor},
+ *     {"Pitch RPM", renderRpm, &pitchMotor},
+ * };
+ * const StaticMenuPage MOTOR_PAGE("Motors", MOTOR_ITEMS);
+ *
+ * const StaticMenuItem MAIN_ITEMS[] = {
+ *     {"Motors", nullptr, nullptr, &MOTOR_PAGE},
+ * };
+ * const StaticMenuPage MAIN_PAGE("Main Menu", MAIN_ITEMS);
+ * ```
+ */
+struct StaticMenuPage
+{
+    template <size_t N>
+    constexpr StaticMenuPage(const char *title, const StaticMenuItem (&items)[N])
+        : title(title),
+          items(items),
+          numItems(N)
+    {
+        static_assert(N <= INT8_MAX, "too many items in page");
+    }
+
+    const char *title;
+    const StaticMenuItem *items;
+    int8_t numItems;
+};
+
+/**
+ * A row of a `StaticMenuPage`.
+ */
+struct StaticMenuItem
+{
+    /**
+     * Writes the value shown after the label to `text`, a buffer of `size` chars. Called each
+     * time the row is refreshed, so it should be quick.
+     */
+    using Render = void (*)(void *context, char *text, size_t size);
+
+    /// Called when OK is pressed on the item.
+    using Select = void (*)(void *context);
+
+    const char *label;
+    Render render = nullptr;
+    void *context = nullptr;
+    /// Page opened when RIGHT is pressed on the item, if any.
+    const StaticMenuPage *child = nullptr;
+    Select select = nullptr;
+};
+
+/**
+ * Shows a tree of `StaticMenuPage`s on a display and navigates it with the OLED buttons: UP and
+ * DOWN move the cursor, RIGHT opens the item's child page, LEFT goes back to the parent page
+ * and OK selects the item.
+ *
+ * Unlike menus built on `modm::AbstractMenu`, nothing is allocated when a page is opened. The
+ * pages are in flash and the only state, the path to the open page and the text of the rows on
+ * screen, has a fixed size.
+ *
+ * Each `update` refreshes at most `ROWS_PER_UPDATE` rows: it renders them and only redraws the
+ * rows whose text changed, so the work per call is small and bounded no matter how large the
+ * page is, and unchanged rows (and with `Sh1106`, their bytes) aren't sent to the display again.
+ * Call it every main loop iteration:
+ *
+ * ```cpp
+ * menu.shortButtonPress(button);  // When a button is pressed
+ * if (menu.update())
+ * {
+ *     display.update();
+ * }
+ * ```
+ */
+class StaticMenu
+{
+public:
+    /// The deepest a page may be in the tree, where the root page is at depth 1.
+    static constexpr int MAX_DEPTH = 4;
+
+    /// The number of rows on screen, including the title row.
+    static constexpr int NUM_ROWS = 8;
+
+    /// The most chars in a row, the width of the display in 6 pixel wide characters.
+    static constexpr int MAX_ROW_LENGTH = 21;
+
+    /// The number of rows refreshed by each `update`.
+    static constexpr int ROWS_PER_UPDATE = 2;
+
+    StaticMenu(modm::GraphicDisplay &display, const StaticMenuPage &root);
+    DISALLOW_COPY_AND_ASSIGN(StaticMenu)
+
+    void shortButtonPress(modm::MenuButtons::Button button);
+
+    /**
+     * Refreshes the next `ROWS_PER_UPDATE` rows.
+     *
+     * @return `true` if the display's buffer changed.
+     */
+    bool update();
+
+    /// @return The page currently shown.
+    const StaticMenuPage &getPage() const { return *path[depth - 1].page; }
+
+    /// @return The index of the item of the current page the cursor is on.
+    int8_t getCursorIndex() const { return path[depth - 1].cursor; }
+
+private:
+    struct Level
+    {
+        const StaticMenuPage *page;
+        int8_t cursor;
+        /// Index of the item in the first row below the title.
+        int8_t top;
+    };
+
+    modm::GraphicDisplay &display;
+
+    /// The open pages, from the root to the current page.
+    Level path[MAX_DEPTH];
+    int depth = 1;
+
+    /// The text of each row on screen, row 0 being the title.
+    char rows[NUM_ROWS][MAX_ROW_LENGTH + 1] = {};
+
+    /// The row the next `update` refreshes first.
+    int nextRow = 0;
+
+    /// `true` if the display must be cleared because the page changed.
+    bool pageChanged = true;
+
+    /// Writes the text row `row` should have to `text`.
+    void formatRow(int row, char (&text)[MAX_ROW_LENGTH + 1]) const;
+
+    void drawRow(int row, const char *text);
+
+    void openPage(const StaticMenuPage &page);
+};  // class StaticMenu
+}  // namespace display
+}  // namespace tap
+
+#endif  // TAPROOT_STATIC_MENU_HPP_
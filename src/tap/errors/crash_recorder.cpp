@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "crash_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+
+namespace tap::errors
+{
+/// Copies the start of `src` into `dest`, truncating it if necessary.
+template <std::size_t N>
+static void copyText(char (&dest)[N], const char* src)
+{
+    if (src == nullptr)
+    {
+        dest[0] = '\0';
+        return;
+    }
+    strncpy(dest, src, N - 1);
+    dest[N - 1] = '\0';
+}
+
+/// Copies the end of `src` into `dest`, so that a long file path keeps the file's name.
+template <std::size_t N>
+static void copyTextTail(char (&dest)[N], const char* src)
+{
+    std::size_t length = src == nullptr ? 0 : strlen(src);
+    copyText(dest, length < N ? src : src + length - (N - 1));
+}
+
+bool CrashRecord::isValid() const
+{
+    return magic == MAGIC && version == VERSION && cause != Cause::NONE &&
+           crc == tap::algorithms::calculateCRC16(
+                      reinterpret_cast<const uint8_t*>(this),
+                      offsetof(CrashRecord, crc));
+}
+
+void CrashRecord::seal()
+{
+    crc = tap::algorithms::calculateCRC16(
+        reinterpret_cast<const uint8_t*>(this),
+        offsetof(CrashRecord, crc));
+}
+
+void CrashRecord::invalidate()
+{
+    // Also zeroes padding, so the crc of an identical record is identical
+    memset(this, 0, sizeof(CrashRecord));
+}
+
+void CrashRecord::print(modm::IOStream& outputStream) const
+{
+    static constexpr const char* CAUSE_NAMES[] = {"none", "hard fault", "assertion", "watchdog"};
+
+    outputStream.printf(
+        "crash %lu: %s at %lu ms\n",
+        static_cast<unsigned long>(sequence),
+        CAUSE_NAMES[static_cast<uint8_t>(cause) < 4 ? static_cast<uint8_t>(cause) : 0],
+        static_cast<unsigned long>(time));
+
+    if (cause == Cause::HARD_FAULT)
+    {
+        outputStream.printf(
+            "pc 0x%08lx lr 0x%08lx xpsr 0x%08lx sp 0x%08lx\n",
+            static_cast<unsigned long>(frame.pc),
+            static_cast<unsigned long>(frame.lr),
+            static_cast<unsigned long>(frame.xpsr),
+            static_cast<unsigned long>(stackPointer));
+        outputStream.printf(
+            "r0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx\n",
+            static_cast<unsigned long>(frame.r0),
+            static_cast<unsigned long>(frame.r1),
+            static_cast<unsigned long>(frame.r2),
+            static_cast<unsigned long>(frame.r3),
+            static_cast<unsigned long>(frame.r12));
+        outputStream.printf(
+            "cfsr 0x%08lx hfsr 0x%08lx mmfar 0x%08lx bfar 0x%08lx\n",
+            static_cast<unsigned long>(cfsr),
+            static_cast<unsigned long>(hfsr),
+            static_cast<unsigned long>(mmfar),
+            static_cast<unsigned long>(bfar));
+        outputStream << "stack:";
+        for (uint32_t i = 0; i < numStackWords && i < STACK_WORDS; i++)
+        {
+            outputStream.printf(" %08lx", static_cast<unsigned long>(stack[i]));
+        }
+        outputStream << modm::endl;
+    }
+    else if (cause == Cause::ASSERTION)
+    {
+        outputStream.printf(
+            "assert %s: %s (0x%08lx)\n",
+            assertionName,
+            assertionDescription,
+            static_cast<unsigned long>(assertionContext));
+    }
+
+    for (int i = 0; i < numErrors && i < static_cast<int>(MAX_ERRORS); i++)
+    {
+        outputStream.printf(
+            "error \"%s\" %s:%ld x%lu, last %lu ms\n",
+            errors[i].description,
+            errors[i].filename,
+            static_cast<long>(errors[i].lineNumber),
+            static_cast<unsigned long>(errors[i].count),
+            static_cast<unsigned long>(errors[i].lastSeen));
+    }
+    if (droppedErrors > 0)
+    {
+        outputStream.printf("dropped errors %lu\n", static_cast<unsigned long>(droppedErrors));
+    }
+
+    if (cause != Cause::WATCHDOG)
+    {
+        outputStream << "commands";
+        for (std::size_t i = SCHEDULER_WORDS; i > 0; i--)
+        {
+            outputStream.printf(" %08lx", static_cast<unsigned long>(addedCommands[i - 1]));
+        }
+        outputStream << " subsystems";
+        for (std::size_t i = SCHEDULER_WORDS; i > 0; i--)
+        {
+            outputStream.printf(" %08lx", static_cast<unsigned long>(registeredSubsystems[i - 1]));
+        }
+        outputStream.printf(
+            "\nworst offender %s %lu cycles\n",
+            worstOffenderName,
+            static_cast<unsigned long>(worstOffenderCycles));
+    }
+}
+
+CrashRecorder* CrashRecorder::activeRecorder = nullptr;
+
+CrashRecorder::CrashRecorder(Drivers* drivers, CrashRecord& record)
+    : drivers(drivers),
+      record(record)
+{
+}
+
+CrashRecord& CrashRecorder::getReservedRecord()
+{
+#ifdef PLATFORM_HOSTED
+    static CrashRecord reservedRecord = {};
+#else
+    // Not zeroed on boot, so a record captured before a reset is still there after it
+    __attribute__((section(".noinit"))) static CrashRecord reservedRecord;
+#endif
+    return reservedRecord;
+}
+
+void CrashRecorder::init()
+{
+    activeRecorder = this;
+
+#ifndef PLATFORM_HOSTED
+    if ((RCC->CSR & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)) != 0)
+    {
+        captureWatchdogReset();
+    }
+    // Clear the reset flags so the next reset is not mistaken for a watchdog reset
+    RCC->CSR |= RCC_CSR_RMVF;
+#endif
+}
+
+void CrashRecorder::captureFault(const uint32_t* exceptionFrame, std::size_t stackWords)
+{
+    if (hasRecord())
+    {
+        return;
+    }
+    beginCapture(CrashRecord::Cause::HARD_FAULT);
+
+    memcpy(&record.frame, exceptionFrame, sizeof(CrashRecord::ExceptionFrame));
+    record.stackPointer = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(exceptionFrame));
+    record.numStackWords = std::min(stackWords, CrashRecord::STACK_WORDS);
+    static constexpr std::size_t FRAME_WORDS = sizeof(CrashRecord::ExceptionFrame) / 4;
+    memcpy(record.stack, exceptionFrame + FRAME_WORDS, record.numStackWords * sizeof(uint32_t));
+
+#ifndef PLATFORM_HOSTED
+    record.cfsr = SCB->CFSR;
+    record.hfsr = SCB->HFSR;
+    record.mmfar = SCB->MMFAR;
+    record.bfar = SCB->BFAR;
+#endif
+
+    captureErrors();
+    captureScheduler();
+    record.seal();
+}
+
+void CrashRecorder::captureAssertion(const char* name, const char* description, uintptr_t context)
+{
+    if (hasRecord())
+    {
+        return;
+    }
+    beginCapture(CrashRecord::Cause::ASSERTION);
+
+    copyText(record.assertionName, name);
+    copyText(record.assertionDescription, description);
+    record.assertionContext = static_cast<uint32_t>(context);
+
+    captureErrors();
+    captureScheduler();
+    record.seal();
+}
+
+void CrashRecorder::captureWatchdogReset()
+{
+    if (hasRecord())
+    {
+        return;
+    }
+    beginCapture(CrashRecord::Cause::WATCHDOG);
+    record.seal();
+}
+
+void CrashRecorder::beginCapture(CrashRecord::Cause cause)
+{
+    record.invalidate();
+    record.magic = CrashRecord::MAGIC;
+    record.version = CrashRecord::VERSION;
+    record.cause = cause;
+    record.time = arch::clock::getTimeMilliseconds();
+}
+
+void CrashRecorder::captureErrors()
+{
+    const ErrorController& errorController = drivers->errorController;
+    const uint32_t now = record.time;
+
+    // Selection sort of the most recently seen errors, the list is too short to bother with more
+    const ErrorController::error_index_t numErrors = errorController.getNumErrors();
+    bool copied[ErrorController::ERROR_LIST_MAX_SIZE] = {};
+    while (record.numErrors < CrashRecord::MAX_ERRORS && record.numErrors < numErrors)
+    {
+        ErrorController::error_index_t mostRecent = numErrors;
+        for (ErrorController::error_index_t i = 0; i < numErrors; i++)
+        {
+            if (copied[i])
+            {
+                continue;
+            }
+            if (mostRecent == numErrors || now - errorController.getError(i).lastSeen <
+                                               now - errorController.getError(mostRecent).lastSeen)
+            {
+                mostRecent = i;
+            }
+        }
+        copied[mostRecent] = true;
+
+        const ErrorController::ErrorEntry& entry = errorController.getError(mostRecent);
+        CrashRecord::Error& error = record.errors[record.numErrors++];
+        copyText(error.description, entry.error.getDescription());
+        copyTextTail(error.filename, entry.error.getFilename());
+        error.lineNumber = entry.error.getLineNumber();
+        error.count = entry.count;
+        error.lastSeen = entry.lastSeen;
+    }
+    record.droppedErrors = errorController.getDroppedErrors();
+}
+
+void CrashRecorder::captureScheduler()
+{
+    const control::CommandScheduler& scheduler = drivers->commandScheduler;
+    const control::command_scheduler_bitmap_t commands = scheduler.getAddedCommandBitmap();
+    const control::subsystem_scheduler_bitmap_t subsystems =
+        scheduler.getRegisteredSubsystemBitmap();
+    for (std::size_t i = 0; i < CrashRecord::SCHEDULER_WORDS; i++)
+    {
+        record.addedCommands[i] = commands.getWord(i);
+        record.registeredSubsystems[i] = subsystems.getWord(i);
+    }
+    copyText(record.worstOffenderName, scheduler.getWorstOffenderName());
+    record.worstOffenderCycles = scheduler.getWorstOffenderCycles();
+}
+
+#ifndef PLATFORM_HOSTED
+extern "C" uint32_t __main_stack_top[];
+
+extern "C" void crashRecorderHardFault(const uint32_t* exceptionFrame)
+{
+    CrashRecorder* recorder = CrashRecorder::getActiveRecorder();
+    if (recorder == nullptr)
+    {
+        // Without a recorder, halt like the default handler
+        while (true)
+        {
+        }
+    }
+
+    // Don't read past the top of the main stack, a fiber's stack is in RAM that can be read
+    static constexpr std::size_t FRAME_WORDS = sizeof(CrashRecord::ExceptionFrame) / 4;
+    std::size_t stackWords = CrashRecord::STACK_WORDS;
+    if (exceptionFrame < __main_stack_top)
+    {
+        std::size_t wordsToTop = __main_stack_top - exceptionFrame;
+        stackWords = wordsToTop > FRAME_WORDS ? wordsToTop - FRAME_WORDS : 0;
+    }
+
+    recorder->captureFault(exceptionFrame, stackWords);
+    NVIC_SystemReset();
+}
+
+/**
+ * Passes the exception frame, on the main or process stack depending on which was in use when
+ * the fault was taken, to `crashRecorderHardFault`.
+ */
+extern "C" __attribute__((naked)) void HardFault_Handler()
+{
+    asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b crashRecorderHardFault\n");
+}
+#endif
+}  // namespace tap::errors
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CRASH_RECORDER_HPP_
+#define TAPROOT_CRASH_RECORDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/control/command_scheduler_constants.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iostream.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::errors
+{
+/**
+ * The state of the robot captured when it crashed. Only holds fixed size, fixed width fields, so
+ * it can be written to flash as-is and read back by the same firmware.
+ */
+struct CrashRecord
+{
+    static constexpr uint32_t MAGIC = 0x48535243;  // "CRSH"
+    static constexpr uint16_t VERSION = 1;
+    /// Number of words above the exception frame copied into `stack`.
+    static constexpr std::size_t STACK_WORDS = 32;
+    /// Number of the most recently seen errors in the `ErrorController` copied into `errors`.
+    static constexpr std::size_t MAX_ERRORS = 8;
+    /// Length of each string, including the null terminator. Longer strings are truncated.
+    static constexpr std::size_t TEXT_LENGTH = 32;
+    static constexpr std::size_t SCHEDULER_WORDS = tap::control::SCHEDULER_BITMAP_WORDS;
+
+    enum class Cause : uint8_t
+    {
+        NONE = 0,
+        HARD_FAULT,
+        ASSERTION,
+        WATCHDOG,
+    };
+
+    /// Registers pushed onto the stack by the processor when the fault was taken.
+    struct ExceptionFrame
+    {
+        uint32_t r0;
+        uint32_t r1;
+        uint32_t r2;
+        uint32_t r3;
+        uint32_t r12;
+        uint32_t lr;
+        uint32_t pc;
+        uint32_t xpsr;
+    };
+
+    struct Error
+    {
+        char description[TEXT_LENGTH];
+        char filename[TEXT_LENGTH];
+        int32_t lineNumber;
+        uint32_t count;
+        uint32_t lastSeen;
+    };
+
+    uint32_t magic;
+    uint16_t version;
+    Cause cause;
+    /// Number of valid entries in `errors`.
+    uint8_t numErrors;
+    /// Number assigned by `CrashLog` when the record is stored, increasing with every record.
+    uint32_t sequence;
+    /// Time, in milliseconds since boot, the crash was captured.
+    uint32_t time;
+
+    /// Valid if `cause` is `HARD_FAULT`.
+    ExceptionFrame frame;
+    /// Configurable, hard, memory management and bus fault status and address registers.
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t mmfar;
+    uint32_t bfar;
+    /// Address of the exception frame.
+    uint32_t stackPointer;
+    /// Number of valid words in `stack`.
+    uint32_t numStackWords;
+    /// The words directly above the exception frame, i.e. the stack of the faulting function.
+    uint32_t stack[STACK_WORDS];
+
+    /**
+     * The name, description and context of the failed `modm_assert`, valid if `cause` is
+     * `ASSERTION`.
+     */
+    char assertionName[TEXT_LENGTH];
+    char assertionDescription[TEXT_LENGTH];
+    uint32_t assertionContext;
+
+    /// Errors sorted from most to least recently seen.
+    Error errors[MAX_ERRORS];
+    uint32_t droppedErrors;
+
+    /// The scheduler's `getAddedCommandBitmap` and `getRegisteredSubsystemBitmap`.
+    uint32_t addedCommands[SCHEDULER_WORDS];
+    uint32_t registeredSubsystems[SCHEDULER_WORDS];
+    /// The scheduler's worst offender.
+    char worstOffenderName[TEXT_LENGTH];
+    uint32_t worstOffenderCycles;
+
+    uint16_t crc;
+
+    /// @return `true` if the record was captured by `CrashRecorder` and hasn't been corrupted.
+    bool isValid() const;
+
+    /// Sets `crc`. Must be called after changing the record.
+    void seal();
+
+    /// Clears the record so that it is no longer valid.
+    void invalidate();
+
+    /**
+     * Prints the cause, time, fault registers, stack, errors and scheduler state in the record.
+     */
+    void print(modm::IOStream& outputStream) const;
+};
+
+/**
+ * Captures the state of the robot into a `CrashRecord` when it crashes, so that the state can be
+ * stored after the robot resets. By default, the record is in a section of RAM that isn't
+ * initialized on boot (`.noinit`), so it survives the reset. `CrashLog` then stores the record
+ * into flash on the next boot.
+ *
+ * After `init`, the recorder captures:
+ * - hard faults, recording the exception frame, the fault status registers and a snapshot of the
+ *   stack, then resetting the MCU.
+ * - failed `modm_assert`s, recording the name, description and context of the assertion.
+ * - resets by the independent or window watchdog, which only record their cause, since the state
+ *   of the robot is gone by the time the reset is detected.
+ *
+ * Hard faults and assertions also record the most recently seen errors in the
+ * `ErrorController` and which commands and subsystems the `CommandScheduler` is running. A crash
+ * is only captured if the record doesn't already hold a crash that hasn't been stored, so the
+ * first crash is kept if the robot crashes again before it is stored.
+ */
+class CrashRecorder
+{
+public:
+    /**
+     * @param[in] record The record to capture crashes into. Defaults to the record in the
+     *      `.noinit` section, which is the only record that survives a reset.
+     */
+    CrashRecorder(Drivers* drivers, CrashRecord& record = getReservedRecord());
+    DISALLOW_COPY_AND_ASSIGN(CrashRecorder)
+
+    /**
+     * Makes this the recorder that captures hard faults and failed assertions, and records a
+     * watchdog reset if the last reset was caused by the watchdog.
+     */
+    void init();
+
+    /**
+     * Captures a hard fault, called from the hard fault handler.
+     *
+     * @param[in] exceptionFrame The stack pointer when the fault was taken, which points to the
+     *      exception frame.
+     * @param[in] stackWords The number of words above the exception frame that can be read.
+     */
+    void captureFault(const uint32_t* exceptionFrame, std::size_t stackWords);
+
+    /// Captures a failed `modm_assert`, called from `modm_abandon`.
+    void captureAssertion(const char* name, const char* description, uintptr_t context);
+
+    /// Records a reset by the watchdog.
+    void captureWatchdogReset();
+
+    /// @return `true` if the record holds a crash that hasn't been stored yet.
+    bool hasRecord() const { return record.isValid(); }
+
+    CrashRecord& getRecord() { return record; }
+
+    /// @return The recorder `init` was last called on, or `nullptr`.
+    static CrashRecorder* getActiveRecorder() { return activeRecorder; }
+
+    /// @return The record in the `.noinit` section.
+    static CrashRecord& getReservedRecord();
+
+private:
+    static CrashRecorder* activeRecorder;
+
+    Drivers* drivers;
+
+    CrashRecord& record;
+
+    /// Clears the record and fills in the header.
+    void beginCapture(CrashRecord::Cause cause);
+
+    void captureErrors();
+
+    void captureScheduler();
+};  // class CrashRecorder
+}  // namespace tap::errors
+
+#endif  // TAPROOT_CRASH_RECORDER_HPP_
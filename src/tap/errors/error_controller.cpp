@@ -19,7 +19,7 @@
 
 #include "error_controller.hpp"
 
-#include "tap/algorithms/strtok.hpp"
+#include "tap/algorithms/token_view.hpp"
 #include "tap/communication/gpio/leds.hpp"
 #include "tap/drivers.hpp"
 
@@ -29,23 +29,47 @@ namespace tap::errors
 {
 void ErrorController::addToErrorList(const SystemError& error)
 {
-    // only add error if it is not already added
-    // Note that we are okay with comparing raw char pointers because an error generated
-    // in our codebase use char pointers located in literals.
-    for (SystemError sysErr : errorList)
-    {
-        if (sysErr.getDescription() == error.getDescription() &&
-            sysErr.getFilename() == error.getFilename() &&
-            sysErr.getLineNumber() == error.getLineNumber())
+    uint32_t now = arch::clock::getTimeMilliseconds();
+
+    // An error raised in a loop is usually raised again before any other error
+    if (lastRaisedIndex < errorList.getSize() &&
+        isSameSite(errorList[lastRaisedIndex].error, error))
+    {
+        recordOccurrence(errorList[lastRaisedIndex], now);
+        return;
+    }
+
+    for (error_index_t i = 0; i < errorList.getSize(); i++)
+    {
+        if (isSameSite(errorList[i].error, error))
         {
-            return;  // the error is already added
+            lastRaisedIndex = i;
+            recordOccurrence(errorList[i], now);
+            return;
         }
     }
-    if (errorList.getSize() >= errorList.getMaxSize())
+
+    if (errorList.isFull())
     {
-        errorList.removeFront();  // remove the oldest element in the error list
+        error_index_t leastRecent = 0;
+        for (error_index_t i = 1; i < errorList.getSize(); i++)
+        {
+            if (now - errorList[i].lastSeen > now - errorList[leastRecent].lastSeen)
+            {
+                leastRecent = i;
+            }
+        }
+
+        if (now - errorList[leastRecent].lastSeen < EVICTION_HOLDOFF_MS)
+        {
+            droppedErrors++;
+            return;
+        }
+        removeSystemErrorAtIndex(leastRecent);
     }
-    errorList.append(error);
+
+    errorList.append({error, 1, now, now});
+    lastRaisedIndex = errorList.getSize() - 1;
 }
 
 void ErrorController::init()
@@ -72,11 +96,11 @@ bool ErrorController::removeSystemErrorAtIndex(error_index_t index)
     error_index_t size = errorList.getSize();
     for (error_index_t i = 0; i < size; i++)
     {
-        SystemError se = errorList.get(0);
+        ErrorEntry entry = errorList.get(0);
         errorList.removeFront();
         if (i != index)
         {
-            errorList.append(se);
+            errorList.append(entry);
         }
     }
     return true;
@@ -100,34 +124,36 @@ bool ErrorController::terminalSerialCallback(
         outputStream << "Error Controller: streaming is not supported" << modm::endl;
         return false;
     }
-    char* arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
-    if (arg == nullptr || strcmp(arg, "-H") == 0)
+    algorithms::TokenView tokens(inputLine);
+    if (tokens.empty())
     {
         outputStream << USAGE;
-        return arg != nullptr;
+        return false;
     }
-    else if (strcmp(arg, "printall") == 0)
+    else if (tokens.nextIs("-H"))
+    {
+        outputStream << USAGE;
+    }
+    else if (tokens.nextIs("printall"))
     {
         outputStream << "printing errors" << modm::endl;
         displayAllErrors(outputStream);
     }
-    else if (strcmp(arg, "removeall") == 0)
+    else if (tokens.nextIs("removeall"))
     {
         clearAllTerminalErrors(outputStream);
     }
-    else if (strcmp(arg, "remove") == 0)
+    else if (tokens.nextIs("remove"))
     {
-        arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
-        if (arg == nullptr)
+        int32_t index;
+        if (tokens.empty())
         {
             outputStream << "Error Controller: must specify an index" << modm::endl;
             return false;
         }
-        char* indexEnd;
-        int index = strtol(arg, &indexEnd, 10);
-        if (indexEnd != arg + strlen(arg))
+        else if (!tokens.nextInt(index))
         {
-            outputStream << "Error Controller: invalid index: " << arg << modm::endl;
+            outputStream << "Error Controller: invalid index: " << tokens.last() << modm::endl;
             return false;
         }
         removeTerminalError(index, outputStream);
@@ -149,13 +175,19 @@ void ErrorController::displayAllErrors(modm::IOStream& outputStream)
     }
     else
     {
-        for (SystemError sysErr : errorList)
+        for (const ErrorEntry& entry : errorList)
         {
+            const SystemError& sysErr = entry.error;
             outputStream << index++ << ") " << sysErr.getDescription() << " ["
-                         << sysErr.getFilename() << ':' << sysErr.getLineNumber() << ']'
-                         << modm::endl;
+                         << sysErr.getFilename() << ':' << sysErr.getLineNumber() << "] x"
+                         << entry.count << ", first " << entry.firstSeen << " ms, last "
+                         << entry.lastSeen << " ms" << modm::endl;
         }
     }
+    if (droppedErrors > 0)
+    {
+        outputStream << droppedErrors << " errors dropped, error list full" << modm::endl;
+    }
 }
 
 // Syntax: Error RemoveTerminalError [Index]
@@ -20,6 +20,7 @@
 #ifndef TAPROOT_ERROR_CONTROLLER_HPP_
 #define TAPROOT_ERROR_CONTROLLER_HPP_
 
+#include "tap/architecture/clock.hpp"
 #include "tap/architecture/timeout.hpp"
 #include "tap/communication/serial/terminal_serial.hpp"
 #include "tap/util_macros.hpp"
@@ -40,25 +41,62 @@ namespace tap::errors
  * the user to query errors via the terminal serial interface.
  *
  * Use the `RAISE_ERROR` macro to add errors to the main ErrorController.
+ *
+ * Errors are identified by the site that raised them (their file and line), so an error raised
+ * every tick occupies a single entry that counts its occurrences and records when it was first
+ * and last seen. Raising an error that is already in the list only updates its entry, checking
+ * the most recently raised entry first, so an error raised in a hot loop costs little more than
+ * a counter increment.
+ *
+ * When the list is full, a new error replaces the least recently seen error, but only if that
+ * error hasn't been seen for `EVICTION_HOLDOFF_MS`. Otherwise the new error is counted as dropped,
+ * which limits how often the list can turn over so that a burst of new errors can't push out
+ * errors that are still occurring.
  */
 class ErrorController : public tap::communication::serial::TerminalSerialCallbackInterface
 {
 public:
     static constexpr std::size_t ERROR_LIST_MAX_SIZE = 16;
-    using error_index_t = modm::BoundedDeque<SystemError, ERROR_LIST_MAX_SIZE>::Index;
+    /// Time an error must not have been seen for before a new error may replace it.
+    static constexpr uint32_t EVICTION_HOLDOFF_MS = 1'000;
+
+    /**
+     * An error in the error list.
+     */
+    struct ErrorEntry
+    {
+        /// The first error raised by the site.
+        SystemError error;
+        /// Number of times the error has been raised since it was added.
+        uint32_t count;
+        /// Time, in milliseconds, the error was added.
+        uint32_t firstSeen;
+        /// Time, in milliseconds, the error was last raised.
+        uint32_t lastSeen;
+    };
+
+    using error_index_t = modm::BoundedDeque<ErrorEntry, ERROR_LIST_MAX_SIZE>::Index;
 
     ErrorController(Drivers* drivers) : drivers(drivers) {}
     DISALLOW_COPY_AND_ASSIGN(ErrorController)
     mockable ~ErrorController() = default;
 
     /**
-     * Adds the passed in error to the ErrorController if no identical errors are already in
-     * the ErrorController.
+     * Adds the passed in error to the ErrorController if no error from the same file and line is
+     * already in the ErrorController, otherwise updates that error's count and last seen time.
      *
      * @param[in] error The SystemError to add to the ErrorController.
      */
     mockable void addToErrorList(const SystemError& error);
 
+    error_index_t getNumErrors() const { return errorList.getSize(); }
+
+    /// @return The error at `index`, which must be less than `getNumErrors()`.
+    const ErrorEntry& getError(error_index_t index) const { return errorList.get(index); }
+
+    /// @return The number of new errors that weren't added because the list was full.
+    uint32_t getDroppedErrors() const { return droppedErrors; }
+
     void init();
 
     bool terminalSerialCallback(char* inputLine, modm::IOStream& outputStream, bool) override;
@@ -70,8 +108,8 @@ class ErrorController : public tap::communication::serial::TerminalSerialCallbac
         "Usage: error <target>\n"
         "  Where <target> is one of:\n"
         "    - [-H]: displays possible commands.\n"
-        "    - [printall]: prints all errors in errorList, displaying their"
-        "description, lineNumber, fileName, and index.\n"
+        "    - [printall]: prints all errors in errorList, displaying their "
+        "description, lineNumber, fileName, index, count, and first and last seen time.\n"
         "    - [remove [index]]: removes the error at the given index. Example: error remove 1.\n"
         "    - [removeall]: removes all errors from the errorList.\n";
 
@@ -79,7 +117,24 @@ class ErrorController : public tap::communication::serial::TerminalSerialCallbac
 
     Drivers* drivers;
 
-    modm::BoundedDeque<SystemError, ERROR_LIST_MAX_SIZE> errorList;
+    modm::BoundedDeque<ErrorEntry, ERROR_LIST_MAX_SIZE> errorList;
+
+    /// Index of the most recently raised error, checked first when an error is raised.
+    error_index_t lastRaisedIndex = 0;
+
+    uint32_t droppedErrors = 0;
+
+    static inline bool isSameSite(const SystemError& a, const SystemError& b)
+    {
+        // Comparing raw char pointers is fine since errors use file names located in literals
+        return a.getLineNumber() == b.getLineNumber() && a.getFilename() == b.getFilename();
+    }
+
+    static inline void recordOccurrence(ErrorEntry& entry, uint32_t time)
+    {
+        entry.count++;
+        entry.lastSeen = time;
+    }
 
     bool removeSystemErrorAtIndex(error_index_t index);
 
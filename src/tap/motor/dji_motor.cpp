@@ -31,6 +31,10 @@
 #include "modm/architecture/interface/can_message.hpp"
 #endif
 
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#endif
+
 namespace tap
 {
 namespace motor
@@ -61,7 +65,6 @@ DjiMotor::DjiMotor(
       encoderHomePosition(0),
       currentControl(currentControl)
 {
-    motorDisconnectTimeout.stop();
 }
 
 void DjiMotor::initialize()
@@ -72,20 +75,21 @@ void DjiMotor::initialize()
 
 void DjiMotor::processMessage(const modm::can::Message& message)
 {
-    if (message.getIdentifier() != DjiMotor::getMotorIdentifier())
+    if (message.getIdentifier() != DjiMotor::getMotorIdentifier() ||
+        message.getLength() != FEEDBACK_MESSAGE_LENGTH)
     {
         return;
     }
-    uint16_t encoderActual =
-        static_cast<uint16_t>(message.data[0] << 8 | message.data[1]);        // encoder value
-    shaftRPM = static_cast<int16_t>(message.data[2] << 8 | message.data[3]);  // rpm
-    shaftRPM = motorInverted ? -shaftRPM : shaftRPM;
-    torque = static_cast<int16_t>(message.data[4] << 8 | message.data[5]);  // torque
-    torque = motorInverted ? -torque : torque;
-    temperature = static_cast<int8_t>(message.data[6]);  // temperature
-
-    // restart disconnect timer, since you just received a message from the motor
-    motorDisconnectTimeout.restart(MOTOR_DISCONNECT_TIME);
+    auto [encoderActual, rpm, torqueActual, temperatureActual] =
+        FeedbackFrame::decode(message.data);
+    if (encoderActual >= ENC_RESOLUTION)
+    {
+        // corrupted frame, an encoder value past a full revolution would break the unwrapping
+        return;
+    }
+    shaftRPM = motorInverted ? -rpm : rpm;
+    torque = motorInverted ? -torqueActual : torqueActual;
+    temperature = temperatureActual;
 
     // invert motor if necessary
     encoderActual = motorInverted ? ENC_RESOLUTION - 1 - encoderActual : encoderActual;
@@ -95,6 +99,19 @@ void DjiMotor::processMessage(const modm::can::Message& message)
     updateEncoderValue(
         encoderRelativeToHome < 0 ? (int32_t)ENC_RESOLUTION + encoderRelativeToHome
                                   : encoderRelativeToHome);
+
+    feedbackTimestamp = drivers->canRxHandler.getRxTimestamp();
+
+    // mark the motor online, since you just received a message from the motor
+    drivers->djiMotorTxHandler.recordFeedback(
+        motorCanBus,
+        DJI_MOTOR_TO_NORMALIZED_ID(motorIdentifier),
+        feedbackTimestamp);
+
+    if (velocityEstimatorAlpha > 0)
+    {
+        updateVelocityEstimate();
+    }
 }
 
 void DjiMotor::setDesiredOutput(int32_t desiredOutput)
@@ -102,16 +119,17 @@ void DjiMotor::setDesiredOutput(int32_t desiredOutput)
     int16_t desOutputNotInverted =
         static_cast<int16_t>(tap::algorithms::limitVal<int32_t>(desiredOutput, SHRT_MIN, SHRT_MAX));
     this->desiredOutput = motorInverted ? -desOutputNotInverted : desOutputNotInverted;
+
+    if (txFrame != nullptr)
+    {
+        serializeCanSendData(txFrame);
+    }
 }
 
 bool DjiMotor::isMotorOnline() const
 {
-    /*
-     * motor online if the disconnect timout has not expired (if it received message but
-     * somehow got disconnected) and the timeout hasn't been stopped (initially, the timeout
-     * is stopped)
-     */
-    return !motorDisconnectTimeout.isExpired() && !motorDisconnectTimeout.isStopped();
+    return (drivers->djiMotorTxHandler.getOnlineMotors(motorCanBus) &
+            DjiMotorTxHandler::getMotorMask(static_cast<MotorId>(motorIdentifier))) != 0;
 }
 
 void DjiMotor::serializeCanSendData(modm::can::Message* txMessage) const
@@ -121,52 +139,99 @@ void DjiMotor::serializeCanSendData(modm::can::Message* txMessage) const
     // to send the data in. Is blind to message type and is a private method
     // that I use accordingly.
     id %= 4;
-    txMessage->data[2 * id] = this->getOutputDesired() >> 8;
-    txMessage->data[2 * id + 1] = this->getOutputDesired() & 0xFF;
-}
-
-// getter functions
-int16_t DjiMotor::getOutputDesired() const { return desiredOutput; }
+    const int16_t output = this->getOutputDesired();
 
-uint32_t DjiMotor::getMotorIdentifier() const { return motorIdentifier; }
+#ifndef PLATFORM_HOSTED
+    // The frame may be sent from an interrupt by `DjiMotorTxHandler::flushTxGroup`, which must
+    // not see the high byte of this output with the low byte of the last one
+    modm::atomic::Lock lock;
+#endif
 
-int8_t DjiMotor::getTemperature() const { return temperature; }
+    txMessage->data[2 * id] = output >> 8;
+    txMessage->data[2 * id + 1] = output & 0xFF;
+}
 
-int16_t DjiMotor::getTorque() const { return torque; }
+void DjiMotor::resetEncoderValue()
+{
+    // the unwrapped encoder value jumps, so don't differentiate across the reset
+    estimatorSeeded = false;
+    encoderRevolutions = 0;
+    encoderHomePosition = (encoderWrapped + encoderHomePosition) % ENC_RESOLUTION;
+    encoderWrapped = 0;
+}
 
-int16_t DjiMotor::getShaftRPM() const { return shaftRPM; }
+/// Radians per encoder tick.
+static constexpr float ENCODER_TO_RADIANS = M_TWOPI / DjiMotor::ENC_RESOLUTION;
 
-bool DjiMotor::isMotorInverted() const { return motorInverted; }
+/// Radians per fixed point revolution.
+static constexpr float FIXED_POINT_TO_RADIANS = M_TWOPI / DjiMotor::FIXED_POINT_ONE;
 
-tap::can::CanBus DjiMotor::getCanBus() const { return motorCanBus; }
+/// Converts shaft RPM to fixed point revolutions per second.
+static int32_t shaftRpmToFixedPoint(int16_t shaftRPM)
+{
+    return static_cast<int32_t>(static_cast<int64_t>(shaftRPM) * DjiMotor::FIXED_POINT_ONE / 60);
+}
 
-const char* DjiMotor::getName() const { return motorName; }
+float DjiMotor::getPositionUnwrapped() const
+{
+    return static_cast<float>(getEncoderUnwrapped()) * ENCODER_TO_RADIANS;
+}
 
-bool DjiMotor::isInCurrentControl() const { return currentControl; }
+float DjiMotor::getPositionWrapped() const { return getEncoderWrapped() * ENCODER_TO_RADIANS; }
 
-int64_t DjiMotor::getEncoderUnwrapped() const
+void DjiMotor::setVelocityEstimatorAlpha(float alpha)
 {
-    return static_cast<int64_t>(encoderWrapped) +
-           static_cast<int64_t>(ENC_RESOLUTION) * encoderRevolutions;
+    alpha = tap::algorithms::limitVal(alpha, 0.0f, 1.0f);
+    velocityEstimatorAlpha = static_cast<int32_t>(alpha * FIXED_POINT_ONE + 0.5f);
+    if (alpha > 0 && velocityEstimatorAlpha == 0)
+    {
+        // don't let a tiny alpha round down to disabling the estimator
+        velocityEstimatorAlpha = 1;
+    }
+    estimatorSeeded = false;
 }
 
-uint16_t DjiMotor::getEncoderWrapped() const { return encoderWrapped; }
-
-void DjiMotor::resetEncoderValue()
+float DjiMotor::getEstimatedVelocity() const
 {
-    encoderRevolutions = 0;
-    encoderHomePosition = (encoderWrapped + encoderHomePosition) % ENC_RESOLUTION;
-    encoderWrapped = 0;
+    return getEstimatedVelocityFixed() * FIXED_POINT_TO_RADIANS;
 }
 
-float DjiMotor::getPositionUnwrapped() const
+int32_t DjiMotor::getEstimatedVelocityFixed() const
 {
-    return getEncoderUnwrapped() * M_TWOPI / ENC_RESOLUTION;
+    if (velocityEstimatorAlpha > 0 && estimatorSeeded)
+    {
+        return estimatedVelocity;
+    }
+    return shaftRpmToFixedPoint(shaftRPM);
 }
 
-float DjiMotor::getPositionWrapped() const
+void DjiMotor::updateVelocityEstimate()
 {
-    return getEncoderWrapped() * M_TWOPI / ENC_RESOLUTION;
+    const int64_t encoder = getEncoderUnwrapped();
+    const uint32_t dt = feedbackTimestamp - estimatorTimestamp;
+
+    if (estimatorSeeded && dt == 0)
+    {
+        // can't differentiate, wait for a sample with a newer timestamp
+        return;
+    }
+
+    if (estimatorSeeded && dt <= MOTOR_DISCONNECT_TIME * 1'000)
+    {
+        int64_t sample = (encoder - estimatorEncoder) * ENCODER_TO_FIXED_POINT * 1'000'000 / dt;
+        sample = tap::algorithms::limitVal<int64_t>(sample, INT32_MIN, INT32_MAX);
+        // fixed point low pass filter, the same as tap::algorithms::lowPassFilter
+        estimatedVelocity += ((sample - estimatedVelocity) * velocityEstimatorAlpha) >>
+                             FIXED_POINT_FRACTIONAL_BITS;
+    }
+    else
+    {
+        estimatedVelocity = shaftRpmToFixedPoint(shaftRPM);
+    }
+
+    estimatorEncoder = encoder;
+    estimatorTimestamp = feedbackTimestamp;
+    estimatorSeeded = true;
 }
 
 void DjiMotor::updateEncoderValue(uint16_t newEncWrapped)
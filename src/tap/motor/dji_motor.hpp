@@ -22,8 +22,9 @@
 
 #include <string>
 
-#include "tap/architecture/timeout.hpp"
+#include "tap/architecture/wire_layout.hpp"
 #include "tap/communication/can/can_rx_listener.hpp"
+#include "tap/util_macros.hpp"
 
 #include "modm/math/geometry/angle.hpp"
 
@@ -65,17 +66,52 @@ enum MotorId : uint32_t
  * it is impossible to know the orientation of the shaft given just the encoder value.
  *
  * Extends the CanRxListener class to attach a message handler for feedback data from the
- * motor to the CAN Rx dispatch handler.
+ * motor to the CAN Rx dispatch handler. Each feedback message is stamped with the time at which
+ * it was received by the CAN RX interrupt (see `getFeedbackTimestamp`).
+ *
+ * The shaft RPM reported by DJI motor controllers has a resolution of 1 RPM, which is coarse at
+ * the low speeds a gimbal motor typically runs at. A velocity estimator that differentiates the
+ * encoder position between feedback messages may be enabled per motor (see
+ * `setVelocityEstimatorAlpha`), and its estimate read with `getEstimatedVelocity`.
+ *
+ * The class is final outside of unit tests, and its feedback getters are defined inline, so code
+ * that holds a `DjiMotor` rather than a `MotorInterface` reads feedback without virtual calls.
  *
  * @note Currently there is no error handling for using a motor without having it be properly
  * initialize. You must call the `initialize` function in order for this class to work properly.
  */
-class DjiMotor : public can::CanRxListener, public MotorInterface
+class DjiMotor final_mockable : public can::CanRxListener, public MotorInterface
 {
 public:
     // 0 - 8191 for dji motors
     static constexpr uint16_t ENC_RESOLUTION = 8192;
 
+    /**
+     * One revolution in the fixed point format of `getPositionUnwrappedFixed`,
+     * `getPositionWrappedFixed` and `getEstimatedVelocityFixed`.
+     */
+    static constexpr int FIXED_POINT_FRACTIONAL_BITS = 16;
+    static constexpr int32_t FIXED_POINT_ONE = 1 << FIXED_POINT_FRACTIONAL_BITS;
+
+    /// Fixed point revolutions per encoder tick.
+    static constexpr int32_t ENCODER_TO_FIXED_POINT = FIXED_POINT_ONE / ENC_RESOLUTION;
+
+    // Length of a feedback message sent by dji motor controllers
+    static constexpr uint8_t FEEDBACK_MESSAGE_LENGTH = 8;
+
+    // wait time before the motor is considered disconnected, in milliseconds
+    static constexpr uint32_t MOTOR_DISCONNECT_TIME = 100;
+
+    /**
+     * Layout of a feedback message: the encoder value, shaft rpm, torque and temperature. The
+     * last byte is unused.
+     */
+    using FeedbackFrame = arch::WireLayout<
+        arch::WireField<uint16_t, 0, arch::Endianness::BIG>,
+        arch::WireField<int16_t, 2, arch::Endianness::BIG>,
+        arch::WireField<int16_t, 4, arch::Endianness::BIG>,
+        arch::WireField<int8_t, 6>>;
+
     // Maximum values for following motors
     // Controller for the M2006, in mA output
     static constexpr uint16_t MAX_OUTPUT_C610 = 10000;
@@ -128,9 +164,29 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
 
     float getPositionWrapped() const override;
 
-    int64_t getEncoderUnwrapped() const override;
+    int64_t getEncoderUnwrapped() const override
+    {
+        return static_cast<int64_t>(encoderWrapped) +
+               static_cast<int64_t>(ENC_RESOLUTION) * encoderRevolutions;
+    }
 
-    uint16_t getEncoderWrapped() const override;
+    uint16_t getEncoderWrapped() const override { return encoderWrapped; }
+
+    /**
+     * @return The unwrapped position of the motor's encoder in fixed point revolutions (see
+     *      `FIXED_POINT_ONE`). Unlike `getPositionUnwrapped`, this doesn't lose precision as the
+     *      motor accumulates revolutions, so use it for odometry over long periods of time.
+     */
+    int64_t getPositionUnwrappedFixed() const
+    {
+        return getEncoderUnwrapped() * ENCODER_TO_FIXED_POINT;
+    }
+
+    /**
+     * @return The wrapped position of the motor's encoder in fixed point revolutions. A full
+     *      revolution is 2^16, so the value wraps around with the type.
+     */
+    uint16_t getPositionWrappedFixed() const { return encoderWrapped * ENCODER_TO_FIXED_POINT; }
 
     /**
      * Resets this motor's current encoder home position to the current encoder position reported by
@@ -143,7 +199,9 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
     /**
      * Overrides virtual method in the can class, called every time a message with the
      * CAN message id this class is attached to is received by the can receive handler.
-     * Parses the data in the message and updates this class's fields accordingly.
+     * Parses the data in the message and updates this class's fields accordingly. Messages that
+     * are not `FEEDBACK_MESSAGE_LENGTH` bytes long or hold an encoder value of at least
+     * `ENC_RESOLUTION` are corrupted and ignored.
      *
      * @param[in] message the message to be processed.
      */
@@ -163,40 +221,85 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
 
     /**
      * @return `true` if a CAN message has been received from the motor within the last
-     *      `MOTOR_DISCONNECT_TIME` ms, `false` otherwise.
+     *      `MOTOR_DISCONNECT_TIME` ms, `false` otherwise. Reads the motor's bit in
+     *      `DjiMotorTxHandler::getOnlineMotors`, so a motor that stops sending feedback goes
+     *      offline at the first `DjiMotorTxHandler::updateOnlineMotors` after the timeout.
      */
     bool isMotorOnline() const override;
 
     /**
-     * Serializes send data and deposits it in a message to be sent.
+     * Serializes send data and deposits it in a message to be sent. Both bytes of the output are
+     * written with interrupts disabled on the target, since the frame may be sent from an
+     * interrupt by `DjiMotorTxHandler::flushTxGroup`.
      */
     mockable void serializeCanSendData(modm::can::Message* txMessage) const;
 
+    /**
+     * Sets the CAN frame owned by the `DjiMotorTxHandler` that this motor's desired output is
+     * encoded in. When set, `setDesiredOutput` serializes the new output directly into the frame
+     * so the tx handler does not have to gather motor outputs each time it sends. Called by the
+     * tx handler when the motor is added to or removed from the motor manager.
+     *
+     * @param[in] frame The frame to serialize into, or `nullptr` to stop serializing.
+     */
+    void setTxFrame(modm::can::Message* frame) { txFrame = frame; }
+
     /**
      * @return the raw `desiredOutput` value which will be sent to the motor controller
      *      (specified via `setDesiredOutput()`)
      */
-    int16_t getOutputDesired() const override;
+    int16_t getOutputDesired() const override { return desiredOutput; }
 
-    mockable uint32_t getMotorIdentifier() const;
+    mockable uint32_t getMotorIdentifier() const { return motorIdentifier; }
 
     /**
      * @return the temperature of the motor as reported by the motor in degrees Celsius
      */
-    int8_t getTemperature() const override;
+    int8_t getTemperature() const override { return temperature; }
 
-    int16_t getTorque() const override;
+    int16_t getTorque() const override { return torque; }
 
     /// For interpreting the sign of return value see class comment
-    int16_t getShaftRPM() const override;
+    int16_t getShaftRPM() const override { return shaftRPM; }
 
-    mockable bool isMotorInverted() const;
+    mockable bool isMotorInverted() const { return motorInverted; }
 
-    mockable tap::can::CanBus getCanBus() const;
+    mockable tap::can::CanBus getCanBus() const { return motorCanBus; }
 
-    mockable const char* getName() const;
+    mockable const char* getName() const { return motorName; }
 
-    mockable bool isInCurrentControl() const;
+    mockable bool isInCurrentControl() const { return currentControl; }
+
+    /**
+     * @return The time at which the most recent feedback message from the motor was received, in
+     *      microseconds (see `CanRxHandler::getRxTimestamp`), or 0 if no message has been
+     *      received.
+     */
+    uint32_t getFeedbackTimestamp() const { return feedbackTimestamp; }
+
+    /**
+     * Enables or disables the velocity estimator. When enabled, the velocity is estimated each
+     * time a feedback message is received by differentiating the unwrapped encoder value between
+     * it and the previous feedback message using their RX timestamps. Each new estimate is
+     * smoothed with `tap::algorithms::lowPassFilter`.
+     *
+     * @param[in] alpha The amount of smoothing, between (0, 1]. An alpha of 1 applies no
+     *      smoothing. An alpha of 0 (the default) disables the estimator.
+     */
+    void setVelocityEstimatorAlpha(float alpha);
+
+    /**
+     * @return The estimated velocity of the motor's encoder in radians per second, with the same
+     *      sign convention as `getShaftRPM`. If the estimator is disabled or has not yet received
+     *      feedback, the velocity is computed from `getShaftRPM`.
+     */
+    float getEstimatedVelocity() const;
+
+    /**
+     * @return `getEstimatedVelocity` in fixed point revolutions per second (see
+     *      `FIXED_POINT_ONE`), the format the estimator works in.
+     */
+    int32_t getEstimatedVelocityFixed() const;
 
     template <typename T>
     static void assertEncoderType()
@@ -222,9 +325,6 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
     }
 
 private:
-    // wait time before the motor is considered disconnected, in milliseconds
-    static const uint32_t MOTOR_DISCONNECT_TIME = 100;
-
     const char* motorName;
 
     /**
@@ -233,6 +333,13 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
      */
     void updateEncoderValue(uint16_t newEncWrapped);
 
+    /**
+     * Updates the estimated velocity using the current encoder value and feedback timestamp.
+     * The estimate is reseeded from the shaft RPM after a gap in feedback longer than
+     * `MOTOR_DISCONNECT_TIME`.
+     */
+    void updateVelocityEstimate();
+
     Drivers* drivers;
 
     uint32_t motorIdentifier;
@@ -275,9 +382,30 @@ class DjiMotor : public can::CanRxListener, public MotorInterface
      */
     uint16_t encoderHomePosition;
 
-    tap::arch::MilliTimeout motorDisconnectTimeout;
-
     bool currentControl;
+
+    /// RX timestamp of the most recent feedback message, in microseconds.
+    uint32_t feedbackTimestamp = 0;
+
+    /**
+     * Smoothing factor of the velocity estimator in fixed point (`FIXED_POINT_ONE` is 1), 0 if
+     * the estimator is disabled. The estimator runs on every feedback message, so it uses
+     * integer math only.
+     */
+    int32_t velocityEstimatorAlpha = 0;
+
+    /// Estimated encoder velocity, in fixed point revolutions per second.
+    int32_t estimatedVelocity = 0;
+
+    /// Unwrapped encoder value and RX timestamp of the previous sample used by the estimator.
+    int64_t estimatorEncoder = 0;
+    uint32_t estimatorTimestamp = 0;
+
+    /// `false` until the estimator has a previous sample to differentiate against.
+    bool estimatorSeeded = false;
+
+    /// Frame owned by the tx handler that the desired output is serialized into, may be null.
+    modm::can::Message* txFrame = nullptr;
 };
 
 }  // namespace tap::motor
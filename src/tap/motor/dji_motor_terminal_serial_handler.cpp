@@ -19,7 +19,7 @@
 
 #include "dji_motor_terminal_serial_handler.hpp"
 
-#include "tap/algorithms/strtok.hpp"
+#include "tap/algorithms/token_view.hpp"
 #include "tap/drivers.hpp"
 
 #include "dji_motor_tx_handler.hpp"
@@ -43,65 +43,61 @@ bool DjiMotorTerminalSerialHandler::terminalSerialCallback(
     modm::IOStream& outputStream,
     bool streamingEnabled)
 {
-    char* arg;
+    algorithms::TokenView tokens(inputLine);
     motorId = 0;
     canBusValid = false;
     motorIdValid = false;
     canBus = 0;
     printAll = false;
-    while (
-        (arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine)))
+    while (!tokens.empty())
     {
-        if (strcmp(arg, "motor") == 0)
+        if (tokens.nextIs("motor"))
         {
-            arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
-            if (arg == nullptr)
+            if (tokens.empty())
             {
                 outputStream << "motorinfo: must specify motor id" << modm::endl;
                 return false;
             }
-            char* indexEnd;
-            motorId = strtol(arg, &indexEnd, 10);
-            if (indexEnd != arg + strlen(arg) ||
-                motorId < (DJI_MOTOR_TO_NORMALIZED_ID(MotorId::MOTOR1) + 1) ||
-                motorId > (DJI_MOTOR_TO_NORMALIZED_ID(MotorId::MOTOR8) + 1))
+            int32_t id;
+            if (!tokens.nextInt(id) ||
+                id < static_cast<int32_t>(DJI_MOTOR_TO_NORMALIZED_ID(MotorId::MOTOR1) + 1) ||
+                id > static_cast<int32_t>(DJI_MOTOR_TO_NORMALIZED_ID(MotorId::MOTOR8) + 1))
             {
                 outputStream << "motorinfo: Invalid motorID" << modm::endl << USAGE;
                 return false;
             }
-            motorId--;
+            motorId = id - 1;
             motorIdValid = true;
         }
-        else if (strcmp(arg, "can") == 0)
+        else if (tokens.nextIs("can"))
         {
-            arg = strtokR(inputLine, communication::serial::TerminalSerial::DELIMITERS, &inputLine);
-            if (arg == nullptr)
+            if (tokens.empty())
             {
                 outputStream << "motorinfo: must specify can bus" << modm::endl;
                 return false;
             }
-            char* indexEnd;
-            canBus = strtol(arg, &indexEnd, 10);
-            if (indexEnd != arg + strlen(arg) || (canBus != 1 && canBus != 2))
+            int32_t bus;
+            if (!tokens.nextInt(bus) || (bus != 1 && bus != 2))
             {
                 outputStream << "motorinfo: Invalid can bus ID" << modm::endl << USAGE;
                 return false;
             }
+            canBus = bus;
             canBusValid = true;
         }
-        else if (strcmp(arg, "all") == 0)
+        else if (tokens.nextIs("all"))
         {
             printAll = true;
             break;
         }
-        else if (strcmp(arg, "-H") == 0)
+        else if (tokens.nextIs("-H"))
         {
             outputStream << USAGE;
             // If streamingEnabled == true, we want to return false to indicate we shouldn't start
             // streaming. Also if any of the other inputs have been set, return false since the user
             // shouldn't specify -H and another argument.
             return !streamingEnabled && !canBusValid && !motorIdValid && !printAll &&
-                   (*inputLine == '\0');
+                   tokens.empty();
         }
         else
         {
@@ -110,7 +106,7 @@ bool DjiMotorTerminalSerialHandler::terminalSerialCallback(
         }
     }
 
-    if (((canBusValid || motorIdValid) && printAll) || (*inputLine != '\0'))
+    if (((canBusValid || motorIdValid) && printAll) || !tokens.empty())
     {
         outputStream << USAGE;
         return false;
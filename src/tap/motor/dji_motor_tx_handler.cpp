@@ -20,18 +20,72 @@
 #include "dji_motor_tx_handler.hpp"
 
 #include <cassert>
+#include <cstring>
 
 #include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_tx_planner.hpp"
+#include "tap/control/command_scheduler.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/create_errors.hpp"
 
 #include "modm/architecture/interface/assert.h"
 #include "modm/architecture/interface/can_message.hpp"
 
+#ifndef PLATFORM_HOSTED
+#include "modm/architecture/interface/atomic_lock.hpp"
+#endif
+
 namespace tap::motor
 {
 using modm::can::Message;
 
+DjiMotorTxHandler::DjiMotorTxHandler(Drivers* drivers) : drivers(drivers)
+{
+    static constexpr uint32_t GROUP_IDENTIFIERS[NUM_TX_GROUPS] = {
+        CAN_DJI_LOW_IDENTIFIER,
+        CAN_DJI_HIGH_IDENTIFIER,
+        CAN_DJI_6020_CURRENT_IDENTIFIER};
+
+    for (int bus = 0; bus < NUM_CAN_BUSES; bus++)
+    {
+        for (int group = 0; group < NUM_TX_GROUPS; group++)
+        {
+            Message& frame = txFrames[bus][group];
+            frame.setIdentifier(GROUP_IDENTIFIERS[group]);
+            frame.setLength(CAN_DJI_MESSAGE_SEND_LENGTH);
+            frame.setExtended(false);
+            std::memset(frame.data, 0, CAN_DJI_MESSAGE_SEND_LENGTH);
+        }
+    }
+
+    for (int group = 0; group < NUM_TX_GROUPS; group++)
+    {
+        Message& frame = failsafeFrames[group];
+        frame.setIdentifier(GROUP_IDENTIFIERS[group]);
+        frame.setLength(CAN_DJI_MESSAGE_SEND_LENGTH);
+        frame.setExtended(false);
+        std::memset(frame.data, 0, CAN_DJI_MESSAGE_SEND_LENGTH);
+    }
+}
+
+DjiMotorTxHandler::TxGroup DjiMotorTxHandler::getTxGroup(const DjiMotor& motor)
+{
+    if (DJI_MOTOR_TO_NORMALIZED_ID(motor.getMotorIdentifier()) <=
+        DJI_MOTOR_TO_NORMALIZED_ID(tap::motor::MOTOR4))
+    {
+        return TX_GROUP_LOW;
+    }
+    else if (motor.isInCurrentControl())
+    {
+        return TX_GROUP_6020_CURRENT;
+    }
+    else
+    {
+        return TX_GROUP_HIGH;
+    }
+}
+
 void DjiMotorTxHandler::addMotorToManager(DjiMotor** canMotorStore, DjiMotor* const motor)
 {
     assert(motor != nullptr);
@@ -40,6 +94,15 @@ void DjiMotorTxHandler::addMotorToManager(DjiMotor** canMotorStore, DjiMotor* co
     bool motorOutOfBounds = idIndex >= DJI_MOTORS_PER_CAN;
     modm_assert(!motorOverloaded && !motorOutOfBounds, "DjiMotorTxHandler", "overloading");
     canMotorStore[idIndex] = motor;
+
+    int bus = static_cast<int>(motor->getCanBus());
+    TxGroup group = getTxGroup(*motor);
+    txGroupMembers[bus][group] |= 1 << idIndex;
+
+    // Seed the frame with the motor's current output, after which the motor keeps it up to date
+    Message* frame = &txFrames[bus][group];
+    motor->serializeCanSendData(frame);
+    motor->setTxFrame(frame);
 }
 
 void DjiMotorTxHandler::addMotorToManager(DjiMotor* motor)
@@ -59,116 +122,195 @@ void DjiMotorTxHandler::addMotorToManager(DjiMotor* motor)
 
 void DjiMotorTxHandler::encodeAndSendCanData()
 {
-    // set up new can messages to be sent via CAN bus 1 and 2
-    Message can1MessageLow(CAN_DJI_LOW_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    Message can1MessageHigh(CAN_DJI_HIGH_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    Message can1Message6020Current(CAN_DJI_6020_CURRENT_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    Message can2MessageLow(CAN_DJI_LOW_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    Message can2MessageHigh(CAN_DJI_HIGH_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-    Message can2Message6020Current(CAN_DJI_6020_CURRENT_IDENTIFIER, CAN_DJI_MESSAGE_SEND_LENGTH);
-
-    can1MessageLow.setExtended(false);
-    can1MessageHigh.setExtended(false);
-    can1Message6020Current.setExtended(false);
-    can2MessageLow.setExtended(false);
-    can2MessageHigh.setExtended(false);
-    can2Message6020Current.setExtended(false);
-
-    bool can1ValidMotorMessageLow = false;
-    bool can1ValidMotorMessageHigh = false;
-    bool can1ValidMotorMessage6020Current = false;
-    bool can2ValidMotorMessageLow = false;
-    bool can2ValidMotorMessageHigh = false;
-    bool can2ValidMotorMessage6020Current = false;
-
-    serializeMotorStoreSendData(
-        can1MotorStore,
-        &can1MessageLow,
-        &can1MessageHigh,
-        &can1Message6020Current,
-        &can1ValidMotorMessageLow,
-        &can1ValidMotorMessageHigh,
-        &can1ValidMotorMessage6020Current);
-
-    serializeMotorStoreSendData(
-        can2MotorStore,
-        &can2MessageLow,
-        &can2MessageHigh,
-        &can2Message6020Current,
-        &can2ValidMotorMessageLow,
-        &can2ValidMotorMessageHigh,
-        &can2ValidMotorMessage6020Current);
-
-    bool messageSuccess = true;
-
-    if (drivers->can.isReadyToSend(can::CanBus::CAN_BUS1))
-    {
-        if (can1ValidMotorMessageLow)
-        {
-            messageSuccess &= drivers->can.sendMessage(can::CanBus::CAN_BUS1, can1MessageLow);
-        }
-        if (can1ValidMotorMessageHigh)
-        {
-            messageSuccess &= drivers->can.sendMessage(can::CanBus::CAN_BUS1, can1MessageHigh);
-        }
-        if (can1ValidMotorMessage6020Current)
+    const uint32_t now = tap::arch::clock::getTimeMicroseconds();
+    tickStart = now;
+    updateOnlineMotors(now);
+    updateFailsafe(now);
+
+    queueTxFrames(can::CanBus::CAN_BUS1);
+    queueTxFrames(can::CanBus::CAN_BUS2);
+
+    sendPendingFrames();
+}
+
+void DjiMotorTxHandler::sendPendingFrames()
+{
+    const uint32_t now = tap::arch::clock::getTimeMicroseconds();
+    bool messageSuccess = sendPendingFrames(can::CanBus::CAN_BUS1, now);
+    messageSuccess &= sendPendingFrames(can::CanBus::CAN_BUS2, now);
+
+    if (!messageSuccess)
+    {
+        RAISE_ERROR(drivers, "sendMessage failure");
+    }
+
+    if (failsafeLatencyPending && pendingTxGroups[0] == 0 && pendingTxGroups[1] == 0)
+    {
+        failsafeLatencyPending = false;
+        failsafeLatency = tap::arch::clock::getTimeMicroseconds() - lastFailsafeClearTime;
+        failsafeLatencyHistogram.record(failsafeLatency);
+    }
+}
+
+void DjiMotorTxHandler::updateFailsafe()
+{
+    updateFailsafe(tap::arch::clock::getTimeMicroseconds());
+}
+
+void DjiMotorTxHandler::updateFailsafe(uint32_t now)
+{
+    const bool engage = failsafeFunction != nullptr && failsafeFunction->operator()();
+
+    if (engage && !failsafeEngaged)
+    {
+        failsafeLatencyPending = true;
+    }
+    else if (!engage)
+    {
+        failsafeLatencyPending = false;
+        lastFailsafeClearTime = now;
+    }
+
+    failsafeEngaged = engage;
+}
+
+void DjiMotorTxHandler::queueTxFrames(can::CanBus bus)
+{
+    const int busIndex = static_cast<int>(bus);
+    const uint8_t* groupMembers = txGroupMembers[busIndex];
+
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+
+    uint8_t queuedGroups = 0;
+    for (int group = 0; group < NUM_TX_GROUPS; group++)
+    {
+        if (groupMembers[group] != 0)
         {
-            messageSuccess &=
-                drivers->can.sendMessage(can::CanBus::CAN_BUS1, can1Message6020Current);
+            queuedGroups |= 1 << group;
         }
     }
-    if (drivers->can.isReadyToSend(can::CanBus::CAN_BUS2))
+    if (!failsafeEngaged)
+    {
+        queuedGroups &= ~reservedTxGroups[busIndex];
+    }
+
+    // Pending frames are updated in place, so re-queueing one supersedes its stale setpoint
+    const int supersededFrames = __builtin_popcount(pendingTxGroups[busIndex] & queuedGroups);
+    if (supersededFrames > 0)
+    {
+        drivers->can.recordTxDrops(bus, supersededFrames);
+    }
+
+    pendingTxGroups[busIndex] |= queuedGroups;
+}
+
+bool DjiMotorTxHandler::sendPendingFrames(can::CanBus bus, uint32_t now)
+{
+    const int busIndex = static_cast<int>(bus);
+    // Zero frames go out as soon as possible
+    const can::CanTxPlanner* plan = failsafeEngaged ? nullptr : txPlans[busIndex];
+
+#ifndef PLATFORM_HOSTED
+    // A flush from an interrupt must not send a frame between the check and clear below
+    modm::atomic::Lock lock;
+#endif
+
+    for (int group = 0; group < NUM_TX_GROUPS; group++)
     {
-        if (can2ValidMotorMessageLow)
+        if ((pendingTxGroups[busIndex] & (1 << group)) == 0)
         {
-            messageSuccess &= drivers->can.sendMessage(can::CanBus::CAN_BUS2, can2MessageLow);
+            continue;
         }
-        if (can2ValidMotorMessageHigh)
+
+        const Message& frame = getFrameToSend(busIndex, group);
+        if (plan != nullptr && !plan->isReleased(frame.getIdentifier(), now - tickStart))
         {
-            messageSuccess &= drivers->can.sendMessage(can::CanBus::CAN_BUS2, can2MessageHigh);
+            // Held until its planned offset, later groups may already be due
+            continue;
         }
-        if (can2ValidMotorMessage6020Current)
+
+        if (!drivers->can.isReadyToSend(bus))
+        {
+            // No free mailbox, remaining frames are sent once the bus drains
+            return true;
+        }
+
+        if (!drivers->can.sendMessage(bus, frame))
         {
-            messageSuccess &=
-                drivers->can.sendMessage(can::CanBus::CAN_BUS2, can2Message6020Current);
+            return false;
         }
+
+        pendingTxGroups[busIndex] &= ~(1 << group);
     }
 
-    if (!messageSuccess)
+    return true;
+}
+
+void DjiMotorTxHandler::setTxGroupReserved(can::CanBus bus, TxGroup group, bool reserved)
+{
+    const int busIndex = static_cast<int>(bus);
+    if (reserved)
     {
-        RAISE_ERROR(drivers, "sendMessage failure");
+        reservedTxGroups[busIndex] |= 1 << group;
+    }
+    else
+    {
+        reservedTxGroups[busIndex] &= ~(1 << group);
     }
 }
 
-void DjiMotorTxHandler::serializeMotorStoreSendData(
-    DjiMotor** canMotorStore,
-    Message* messageLow,
-    Message* messageHigh,
-    Message* message6020Current,
-    bool* validMotorMessageLow,
-    bool* validMotorMessageHigh,
-    bool* validMotorMessage6020Current)
+bool DjiMotorTxHandler::flushTxGroup(can::CanBus bus, TxGroup group)
 {
-    for (int i = 0; i < DJI_MOTORS_PER_CAN; i++)
+    const int busIndex = static_cast<int>(bus);
+
+#ifndef PLATFORM_HOSTED
+    modm::atomic::Lock lock;
+#endif
+
+    if (txGroupMembers[busIndex][group] == 0)
+    {
+        return false;
+    }
+
+    if ((pendingTxGroups[busIndex] & (1 << group)) != 0)
+    {
+        drivers->can.recordTxDrops(bus, 1);
+    }
+
+    if (drivers->can.isReadyToSend(bus) &&
+        drivers->can.sendMessage(bus, getFrameToSend(busIndex, group)))
+    {
+        pendingTxGroups[busIndex] &= ~(1 << group);
+        return true;
+    }
+
+    pendingTxGroups[busIndex] |= 1 << group;
+    return false;
+}
+
+void DjiMotorTxHandler::updateOnlineMotors()
+{
+    updateOnlineMotors(tap::arch::clock::getTimeMicroseconds());
+}
+
+void DjiMotorTxHandler::updateOnlineMotors(uint32_t now)
+{
+    static constexpr int32_t DISCONNECT_TIME_US = DjiMotor::MOTOR_DISCONNECT_TIME * 1'000;
+
+    for (int bus = 0; bus < NUM_CAN_BUSES; bus++)
     {
-        const DjiMotor* const motor = canMotorStore[i];
-        if (motor != nullptr)
+        uint8_t online = onlineMotors[bus];
+        while (online != 0)
         {
-            if (DJI_MOTOR_TO_NORMALIZED_ID(motor->getMotorIdentifier()) <=
-                DJI_MOTOR_TO_NORMALIZED_ID(tap::motor::MOTOR4))
-            {
-                motor->serializeCanSendData(messageLow);
-                *validMotorMessageLow = true;
-            }
-            else if (motor->isInCurrentControl())
-            {
-                motor->serializeCanSendData(message6020Current);
-                *validMotorMessage6020Current = true;
-            }
-            else
+            const int id = __builtin_ctz(online);
+            online &= online - 1;
+
+            // Signed so feedback received after `now` was read is not mistaken for stale feedback
+            if (static_cast<int32_t>(now - lastFeedbackTimestamps[bus][id]) >= DISCONNECT_TIME_US)
             {
-                motor->serializeCanSendData(messageHigh);
-                *validMotorMessageHigh = true;
+                onlineMotors[bus] &= ~(1 << id);
             }
         }
     }
@@ -194,9 +336,67 @@ void DjiMotorTxHandler::removeFromMotorManager(const DjiMotor& motor, DjiMotor**
         RAISE_ERROR(drivers, "invalid motor id");
         return;
     }
+
+    int bus = static_cast<int>(motor.getCanBus());
+    TxGroup group = getTxGroup(motor);
+    txGroupMembers[bus][group] &= ~(1 << id);
+    if (txGroupMembers[bus][group] == 0)
+    {
+        pendingTxGroups[bus] &= ~(1 << group);
+    }
+
+    // Clear the motor's output so a stale command is not sent to a motor that is re-added later
+    Message& frame = txFrames[bus][group];
+    frame.data[2 * (id % 4)] = 0;
+    frame.data[2 * (id % 4) + 1] = 0;
+
+    motorStore[id]->setTxFrame(nullptr);
     motorStore[id] = nullptr;
 }
 
+const Message* DjiMotorTxHandler::getTxFrame(can::CanBus bus, int index) const
+{
+    const int busIndex = static_cast<int>(bus);
+
+    if (index < 0 || index >= NUM_TX_GROUPS || txGroupMembers[busIndex][index] == 0 ||
+        ((reservedTxGroups[busIndex] & (1 << index)) != 0 && !failsafeEngaged))
+    {
+        return nullptr;
+    }
+
+    return &getFrameToSend(busIndex, index);
+}
+
+void DjiMotorTxHandler::snapshotAll(can::CanBus bus, MotorStateSnapshot* out) const
+{
+    const DjiMotor* const* motorStore =
+        bus == can::CanBus::CAN_BUS1 ? can1MotorStore : can2MotorStore;
+
+    *out = MotorStateSnapshot();
+
+    for (int i = 0; i < DJI_MOTORS_PER_CAN; i++)
+    {
+        const DjiMotor* const motor = motorStore[i];
+
+        if (motor == nullptr)
+        {
+            continue;
+        }
+
+        // qualified calls so the motor's state is read without virtual dispatch
+        out->motorMask |= 1 << i;
+        out->encoderUnwrapped[i] = motor->DjiMotor::getEncoderUnwrapped();
+        out->encoderWrapped[i] = motor->DjiMotor::getEncoderWrapped();
+        out->shaftRPM[i] = motor->DjiMotor::getShaftRPM();
+        out->torque[i] = motor->DjiMotor::getTorque();
+        out->temperature[i] = motor->DjiMotor::getTemperature();
+        out->outputDesired[i] = motor->DjiMotor::getOutputDesired();
+        out->estimatedVelocity[i] = motor->getEstimatedVelocity();
+        out->feedbackTimestamp[i] = motor->getFeedbackTimestamp();
+        out->online[i] = motor->DjiMotor::isMotorOnline();
+    }
+}
+
 DjiMotor const* DjiMotorTxHandler::getCan1Motor(MotorId motorId)
 {
     uint32_t index = DJI_MOTOR_TO_NORMALIZED_ID(motorId);
@@ -22,15 +22,29 @@
 
 #include <limits.h>
 
+#include "tap/architecture/latency_histogram.hpp"
 #include "tap/util_macros.hpp"
 
+#include "modm/architecture/interface/can_message.hpp"
+
 #include "dji_motor.hpp"
+#include "motor_tx_frame_source.hpp"
 
 namespace tap
 {
 class Drivers;
 }
 
+namespace tap::can
+{
+class CanTxPlanner;
+}
+
+namespace tap::control
+{
+class SafeDisconnectFunction;
+}
+
 namespace tap::motor
 {
 /**
@@ -52,6 +66,43 @@ namespace tap::motor
 #define NORMALIZED_ID_TO_DJI_MOTOR(idx) \
     static_cast<tap::motor::MotorId>(idx + static_cast<int32_t>(tap::motor::MotorId::MOTOR1))
 
+/**
+ * A snapshot of the feedback state of every motor on a CAN bus, stored as a structure of arrays
+ * indexed by normalized motor id (see `DJI_MOTOR_TO_NORMALIZED_ID`) so that a control loop can
+ * read the state of all of its motors from contiguous memory. Filled in by
+ * `DjiMotorTxHandler::snapshotAll`. Entries of motors that are not in the snapshot are zeroed.
+ */
+struct MotorStateSnapshot
+{
+    /// Number of entries in each array, one for each motor id on a CAN bus.
+    static constexpr int NUM_MOTORS = 8;
+
+    /// Bitmask of the normalized ids of the motors in the snapshot.
+    uint8_t motorMask = 0;
+
+    /// See `DjiMotor::getEncoderUnwrapped`.
+    int64_t encoderUnwrapped[NUM_MOTORS] = {};
+    /// See `DjiMotor::getEncoderWrapped`.
+    uint16_t encoderWrapped[NUM_MOTORS] = {};
+    /// See `DjiMotor::getShaftRPM`.
+    int16_t shaftRPM[NUM_MOTORS] = {};
+    /// See `DjiMotor::getTorque`.
+    int16_t torque[NUM_MOTORS] = {};
+    /// See `DjiMotor::getTemperature`.
+    int8_t temperature[NUM_MOTORS] = {};
+    /// See `DjiMotor::getOutputDesired`.
+    int16_t outputDesired[NUM_MOTORS] = {};
+    /// See `DjiMotor::getEstimatedVelocity`.
+    float estimatedVelocity[NUM_MOTORS] = {};
+    /// See `DjiMotor::getFeedbackTimestamp`.
+    uint32_t feedbackTimestamp[NUM_MOTORS] = {};
+    /// See `DjiMotor::isMotorOnline`.
+    bool online[NUM_MOTORS] = {};
+
+    /// @return `true` if the motor with the given normalized id is in the snapshot.
+    bool contains(int index) const { return (motorMask & (1 << index)) != 0; }
+};
+
 /**
  * Uses modm can interface to send CAN packets to `DjiMotor`'s connected to the two CAN buses.
  *
@@ -61,8 +112,46 @@ namespace tap::motor
  * to have its control information sent to the motor on the bus.
  *
  * To send messages, call this class's `encodeAndSendCanData` function.
+ *
+ * The handler owns one pre-initialized CAN frame per bus and control group (low, high, and 6020
+ * current control) along with a mask of which motors are members of each group. Both are updated
+ * when a motor is added to or removed from the manager, and each motor serializes its desired
+ * output directly into its group's frame when `DjiMotor::setDesiredOutput` is called. As a
+ * result, `encodeAndSendCanData` only has to send the frames that have members.
+ *
+ * Frames are not sent directly. Instead, `encodeAndSendCanData` marks the frame of each group
+ * with members as pending and then calls `sendPendingFrames`, which sends pending frames for as
+ * long as the bus has a free transmit mailbox. Frames that could not be sent stay pending and are
+ * retried the next time `sendPendingFrames` is called, which may be done more often than
+ * `encodeAndSendCanData` (for example every main loop iteration) so that frames go out as soon as
+ * mailboxes drain. Since each group has a single frame that motors update in place, a pending
+ * frame always holds the latest setpoint of its group. If a frame is still pending when the
+ * group is queued again, the stale setpoint is superseded and recorded as a dropped frame in the
+ * bus's `Can::BusStats`.
+ *
+ * By default pending frames are sent right away, so every group goes out back to back at the
+ * start of the tick. A plan made by a `can::CanTxPlanner` may be set for each bus with
+ * `setTxPlan`, in which case each group's frame is held until its planned offset after the call
+ * to `encodeAndSendCanData` that queued it, for example so that commands don't arbitrate against
+ * the motors' feedback burst. Held frames are sent by `sendPendingFrames`, which must then be
+ * called often enough to release them on time, such as every main loop iteration.
+ *
+ * A group may be reserved with `setTxGroupReserved` so that its frame is sent by `flushTxGroup`
+ * instead, which lets a fast control loop send its motors' commands as soon as it has computed
+ * them. Pending frames are updated with interrupts disabled on the target, since `flushTxGroup`
+ * may be called from an interrupt.
+ *
+ * A failsafe condition, usually the same `SafeDisconnectFunction` the `CommandScheduler` uses,
+ * may be set with `setFailsafeFunction`. It is checked each time `encodeAndSendCanData` is
+ * called, and while it holds, every group (reserved or not) is sent a frame of zeros instead of
+ * its motors' outputs. Since this doesn't wait for the scheduler to notice the disconnect and
+ * for subsystems to zero their motors, the motors are stopped within one call of
+ * `encodeAndSendCanData` of the condition becoming true, no matter how loaded the scheduler is.
+ *
+ * The handler is also a `MotorTxFrameSource`, so it may instead be added to a
+ * `MotorTxScheduler` to send its frames along with those of motors using other protocols.
  */
-class DjiMotorTxHandler
+class DjiMotorTxHandler : public MotorTxFrameSource
 {
 public:
     /** Number of motors on each CAN bus. */
@@ -76,8 +165,17 @@ class DjiMotorTxHandler
     /** CAN message identifier for 6020s in current mode of control message. */
     static constexpr uint32_t CAN_DJI_6020_CURRENT_IDENTIFIER = 0x1FE;
 
-    DjiMotorTxHandler(Drivers* drivers) : drivers(drivers) {}
-    mockable ~DjiMotorTxHandler() = default;
+    /** The control groups motors are sent in, each group is sent in its own CAN frame. */
+    enum TxGroup : uint8_t
+    {
+        TX_GROUP_LOW = 0,
+        TX_GROUP_HIGH,
+        TX_GROUP_6020_CURRENT,
+        NUM_TX_GROUPS,
+    };
+
+    DjiMotorTxHandler(Drivers* drivers);
+    virtual ~DjiMotorTxHandler() = default;
     DISALLOW_COPY_AND_ASSIGN(DjiMotorTxHandler)
 
     /**
@@ -87,12 +185,20 @@ class DjiMotorTxHandler
     mockable void addMotorToManager(DjiMotor* motor);
 
     /**
-     * Sends motor commands across the CAN bus. Sends up to 4 messages (2 per CAN bus), though it
-     * may send less depending on which motors have been registered with the motor manager. Each
-     * messages encodes motor controller command information for up to 4 motors.
+     * Queues motor commands to be sent across the CAN bus, then sends as many as possible via
+     * `sendPendingFrames`. Queues up to 6 messages (3 per CAN bus), though it may queue less
+     * depending on which motors have been registered with the motor manager. Each message encodes
+     * motor controller command information for up to 4 motors.
      */
     mockable void encodeAndSendCanData();
 
+    /**
+     * Sends pending frames on each bus, in group order, until either no frames are pending or the
+     * bus has no free transmit mailbox. An error is added to the error handler if a frame fails
+     * to send even though the bus reported it was ready; the frame is left pending.
+     */
+    mockable void sendPendingFrames();
+
     /**
      * Removes the motor from the motor manager.
      */
@@ -102,24 +208,266 @@ class DjiMotorTxHandler
 
     mockable DjiMotor const* getCan2Motor(MotorId motorId);
 
+    /**
+     * @return A bitmask of the normalized ids (see `DJI_MOTOR_TO_NORMALIZED_ID`) of the motors on
+     *      the specified bus that are sent in the specified group.
+     */
+    uint8_t getTxGroupMembers(can::CanBus bus, TxGroup group) const
+    {
+        return txGroupMembers[static_cast<int>(bus)][group];
+    }
+
+    /**
+     * @return The group the motor's desired output is sent in, based on its id and whether or not
+     *      it is in current control.
+     */
+    static TxGroup getTxGroup(const DjiMotor& motor);
+
+    /**
+     * Copies the feedback state of every motor on the bus that is in the motor manager into
+     * `out` in a single pass. Each motor's state is read directly rather than through
+     * `MotorInterface`, so taking the snapshot costs no virtual calls.
+     *
+     * Feedback is only updated when `CanRxHandler::pollCanData` dispatches a message, so the
+     * snapshot is consistent as long as it is not taken while messages are being dispatched.
+     *
+     * @param[in] bus The bus to take a snapshot of.
+     * @param[out] out The snapshot to fill in.
+     */
+    mockable void snapshotAll(can::CanBus bus, MotorStateSnapshot* out) const;
+
+    /// @return `NUM_TX_GROUPS`, frame index `i` is the frame of `TxGroup` `i`.
+    int getTxFrameCount(can::CanBus) const override { return NUM_TX_GROUPS; }
+
+    const modm::can::Message* getTxFrame(can::CanBus bus, int index) const override;
+
+    /**
+     * @return A bitmask of the groups on the specified bus whose frames are waiting to be sent,
+     *      where bit `i` corresponds to `TxGroup` `i`.
+     */
+    uint8_t getPendingTxGroups(can::CanBus bus) const
+    {
+        return pendingTxGroups[static_cast<int>(bus)];
+    }
+
+    /**
+     * Sets the plan that holds each group's frame on the bus until its offset, see the class
+     * description, or sends frames as soon as possible if `plan` is `nullptr`. Groups whose
+     * identifier wasn't added to the plan are not held. The plan is not copied and must
+     * outlive the handler. Frames sent by `flushTxGroup` or while the failsafe is engaged are
+     * never held.
+     */
+    void setTxPlan(can::CanBus bus, const can::CanTxPlanner* plan)
+    {
+        txPlans[static_cast<int>(bus)] = plan;
+    }
+
+    /**
+     * Reserves a group for `flushTxGroup`, or releases it. Unless the failsafe is engaged, the
+     * frame of a reserved group is not queued by `encodeAndSendCanData` nor returned by
+     * `getTxFrame`, so it is only sent when `flushTxGroup` is called, for example by a control
+     * loop that runs from an interrupt each time new sensor data arrives (see
+     * `Bmi088TriggeredLoop`).
+     */
+    void setTxGroupReserved(can::CanBus bus, TxGroup group, bool reserved);
+
+    /// @return `true` if the group on the specified bus is reserved, see `setTxGroupReserved`.
+    bool isTxGroupReserved(can::CanBus bus, TxGroup group) const
+    {
+        return (reservedTxGroups[static_cast<int>(bus)] & (1 << group)) != 0;
+    }
+
+    /**
+     * Sends the frame of a single group right away, without sending the other pending frames on
+     * the bus. Safe to call from an interrupt that preempts the main loop.
+     *
+     * @return `true` if the frame was sent. If the bus has no free transmit mailbox, the frame is
+     *      left pending and sent by the next `sendPendingFrames`.
+     */
+    mockable bool flushTxGroup(can::CanBus bus, TxGroup group);
+
+    /**
+     * Sets the condition under which all motors are sent zero output, or removes it if `func` is
+     * `nullptr`. See the class description.
+     */
+    void setFailsafeFunction(control::SafeDisconnectFunction* func) { failsafeFunction = func; }
+
+    /**
+     * Checks the failsafe condition, engaging or releasing the failsafe. Called once per tick by
+     * `encodeAndSendCanData`, call it each tick if the handler's frames are sent by a
+     * `MotorTxScheduler` instead.
+     */
+    void updateFailsafe();
+
+    /// @param[in] now The current time, in microseconds.
+    void updateFailsafe(uint32_t now);
+
+    /// @return `true` if the failsafe condition held at the last `updateFailsafe`.
+    bool isFailsafeEngaged() const { return failsafeEngaged; }
+
+    /**
+     * @return The time the failsafe most recently took to react, from the last check that found
+     *      the condition false to the zero frames of every group having been sent, in
+     *      microseconds. Since the condition became true at some point after that check, this is
+     *      an upper bound on the reaction time.
+     */
+    uint32_t getFailsafeLatency() const { return failsafeLatency; }
+
+    /// @return A histogram of every latency measured by the failsafe.
+    const arch::LatencyHistogram& getFailsafeLatencyHistogram() const
+    {
+        return failsafeLatencyHistogram;
+    }
+
+    /**
+     * Records that a feedback message from the motor with the specified normalized id was
+     * received at `rxTimestamp`, marking the motor online. Called by `DjiMotor::processMessage`,
+     * the motor does not have to be in the motor manager.
+     *
+     * @param[in] rxTimestamp The time at which the message was received, in microseconds (see
+     *      `CanRxHandler::getRxTimestamp`).
+     */
+    void recordFeedback(can::CanBus bus, uint32_t normalizedId, uint32_t rxTimestamp)
+    {
+        if (normalizedId >= DJI_MOTORS_PER_CAN)
+        {
+            return;
+        }
+        const int busIndex = static_cast<int>(bus);
+        lastFeedbackTimestamps[busIndex][normalizedId] = rxTimestamp;
+        onlineMotors[busIndex] |= 1 << normalizedId;
+    }
+
+    /**
+     * @return The RX timestamp of the most recent feedback message from the motor with the
+     *      specified normalized id on the specified bus, see `recordFeedback`. 0 if no feedback
+     *      has been received or the id is invalid.
+     */
+    uint32_t getLastFeedbackTimestamp(can::CanBus bus, uint32_t normalizedId) const
+    {
+        if (normalizedId >= DJI_MOTORS_PER_CAN)
+        {
+            return 0;
+        }
+        return lastFeedbackTimestamps[static_cast<int>(bus)][normalizedId];
+    }
+
+    /**
+     * Marks offline the motors that have not sent feedback in the last
+     * `DjiMotor::MOTOR_DISCONNECT_TIME` ms. Called once per tick by `encodeAndSendCanData`, so
+     * checking whether a motor is online does not read the clock.
+     */
+    void updateOnlineMotors();
+
+    /// @param[in] now The current time, in microseconds.
+    void updateOnlineMotors(uint32_t now);
+
+    /**
+     * @return A bitmask of the normalized ids of the motors on the specified bus that are online,
+     *      as of the last `updateOnlineMotors`. A motor comes online as soon as its feedback is
+     *      received.
+     */
+    uint8_t getOnlineMotors(can::CanBus bus) const { return onlineMotors[static_cast<int>(bus)]; }
+
+    /**
+     * @return `true` if every motor in `motorMask` (see `getMotorMask`) is online on the specified
+     *      bus. For example, to check all four chassis motors:
+     *
+     * ```cpp
+     * static constexpr uint8_t CHASSIS_MOTORS = DjiMotorTxHandler::getMotorMask(MOTOR1) |
+     *     DjiMotorTxHandler::getMotorMask(MOTOR2) | DjiMotorTxHandler::getMotorMask(MOTOR3) |
+     *     DjiMotorTxHandler::getMotorMask(MOTOR4);
+     *
+     * drivers->djiMotorTxHandler.areMotorsOnline(can::CanBus::CAN_BUS1, CHASSIS_MOTORS);
+     * ```
+     */
+    bool areMotorsOnline(can::CanBus bus, uint8_t motorMask) const
+    {
+        return (onlineMotors[static_cast<int>(bus)] & motorMask) == motorMask;
+    }
+
+    /// @return The bit of the motor with the specified id in the masks of this class.
+    static constexpr uint8_t getMotorMask(MotorId motorId)
+    {
+        return static_cast<uint8_t>(1 << DJI_MOTOR_TO_NORMALIZED_ID(motorId));
+    }
+
 protected:
     Drivers* drivers;
 
     DjiMotor* can1MotorStore[DJI_MOTORS_PER_CAN] = {0};
     DjiMotor* can2MotorStore[DJI_MOTORS_PER_CAN] = {0};
 
-    void addMotorToManager(DjiMotor** canMotorStore, DjiMotor* const motor);
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    static_assert(
+        MotorStateSnapshot::NUM_MOTORS == DJI_MOTORS_PER_CAN,
+        "MotorStateSnapshot must have an entry for each motor on a bus");
+
+    /** Frames sent each time `encodeAndSendCanData` is called, indexed by bus and group. */
+    modm::can::Message txFrames[NUM_CAN_BUSES][NUM_TX_GROUPS];
+
+    /** Bitmask of normalized motor ids in each bus and group, indexed the same as `txFrames`. */
+    uint8_t txGroupMembers[NUM_CAN_BUSES][NUM_TX_GROUPS] = {};
+
+    /** Bitmask of groups with frames waiting to be sent, see `getPendingTxGroups`. */
+    uint8_t pendingTxGroups[NUM_CAN_BUSES] = {};
+
+    /** Bitmask of groups reserved for `flushTxGroup`, see `setTxGroupReserved`. */
+    uint8_t reservedTxGroups[NUM_CAN_BUSES] = {};
+
+    /** Plans that hold pending frames until their offset, see `setTxPlan`. */
+    const can::CanTxPlanner* txPlans[NUM_CAN_BUSES] = {};
+
+    /** Time of the most recent `encodeAndSendCanData`, that planned offsets are relative to. */
+    uint32_t tickStart = 0;
+
+    /** Frames of zeros sent to each group while the failsafe is engaged. */
+    modm::can::Message failsafeFrames[NUM_TX_GROUPS];
+
+    control::SafeDisconnectFunction* failsafeFunction = nullptr;
+
+    bool failsafeEngaged = false;
+
+    /** `true` from when the failsafe engages until the zero frames have all been sent. */
+    bool failsafeLatencyPending = false;
+
+    /** Time of the most recent `updateFailsafe` that found the condition false. */
+    uint32_t lastFailsafeClearTime = 0;
 
-    void serializeMotorStoreSendData(
-        DjiMotor** canMotorStore,
-        modm::can::Message* messageLow,
-        modm::can::Message* messageHigh,
-        modm::can::Message* message6020Current,
-        bool* validMotorMessageLow,
-        bool* validMotorMessageHigh,
-        bool* validMotorMessage6020Current);
+    uint32_t failsafeLatency = 0;
+
+    arch::LatencyHistogram failsafeLatencyHistogram;
+
+    /** Bitmask of normalized ids of the motors on each bus that are online. */
+    uint8_t onlineMotors[NUM_CAN_BUSES] = {};
+
+    /** RX timestamp of the latest feedback from each motor, indexed by bus and normalized id. */
+    uint32_t lastFeedbackTimestamps[NUM_CAN_BUSES][DJI_MOTORS_PER_CAN] = {};
+
+    void addMotorToManager(DjiMotor** canMotorStore, DjiMotor* const motor);
 
     void removeFromMotorManager(const DjiMotor& motor, DjiMotor** motorStore);
+
+    /**
+     * Marks the frames of all unreserved groups on the bus that have members as pending, or of
+     * all groups with members while the failsafe is engaged. Frames that were already pending
+     * are recorded as dropped since their previous setpoint was never sent.
+     */
+    void queueTxFrames(can::CanBus bus);
+
+    /** @return The frame sent for the group, which is all zeros while the failsafe is engaged. */
+    const modm::can::Message& getFrameToSend(int busIndex, int group) const
+    {
+        return failsafeEngaged ? failsafeFrames[group] : txFrames[busIndex][group];
+    }
+
+    /**
+     * Sends pending frames on the bus that are due at `now` while the bus is ready to send.
+     *
+     * @return `false` if a frame failed to send, `true` otherwise.
+     */
+    bool sendPendingFrames(can::CanBus bus, uint32_t now);
 };
 
 }  // namespace tap::motor
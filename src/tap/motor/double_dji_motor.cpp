@@ -19,6 +19,10 @@
 
 #include "double_dji_motor.hpp"
 
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
 namespace tap::motor
 {
 DoubleDjiMotor::DoubleDjiMotor(
@@ -74,8 +78,48 @@ float DoubleDjiMotor::getPositionWrapped() const { return motorOne.getPositionWr
 
 void DoubleDjiMotor::setDesiredOutput(int32_t desiredOutput)
 {
-    motorOne.setDesiredOutput(desiredOutput);
-    motorTwo.setDesiredOutput(desiredOutput);
+    int32_t totalOutput = desiredOutput + feedForward;
+
+    if (!loadSharingEnabled)
+    {
+        balance = 0;
+        motorOne.setDesiredOutput(totalOutput);
+        motorTwo.setDesiredOutput(totalOutput);
+        return;
+    }
+
+    balance = computeBalance();
+
+    motorOne.setDesiredOutput(
+        static_cast<int32_t>(totalOutput * (1 - balance) * loadSharingConfig.gainOne));
+    motorTwo.setDesiredOutput(
+        static_cast<int32_t>(totalOutput * (1 + balance) * loadSharingConfig.gainTwo));
+}
+
+void DoubleDjiMotor::setLoadSharingConfig(const LoadSharingConfig& config)
+{
+    loadSharingConfig = config;
+    loadSharingConfig.maxBalance = tap::algorithms::limitVal(config.maxBalance, 0.0f, 1.0f);
+    loadSharingEnabled = true;
+}
+
+void DoubleDjiMotor::disableLoadSharing() { loadSharingEnabled = false; }
+
+float DoubleDjiMotor::computeBalance() const
+{
+    float torqueOne = std::abs(static_cast<float>(motorOne.getTorque()));
+    float torqueTwo = std::abs(static_cast<float>(motorTwo.getTorque()));
+    float torqueSum = torqueOne + torqueTwo;
+
+    float torqueImbalance = torqueSum > 0 ? (torqueOne - torqueTwo) / torqueSum : 0;
+    float temperatureDifference =
+        static_cast<float>(motorOne.getTemperature()) - motorTwo.getTemperature();
+
+    return tap::algorithms::limitVal(
+        loadSharingConfig.torqueBalanceGain * torqueImbalance +
+            loadSharingConfig.temperatureBalanceGain * temperatureDifference,
+        -loadSharingConfig.maxBalance,
+        loadSharingConfig.maxBalance);
 }
 
 bool DoubleDjiMotor::isMotorOnline() const
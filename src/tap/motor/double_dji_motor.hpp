@@ -20,6 +20,8 @@
 #ifndef TAPROOT_DOUBLE_DJI_MOTOR_HPP_
 #define TAPROOT_DOUBLE_DJI_MOTOR_HPP_
 
+#include "tap/util_macros.hpp"
+
 #include "dji_motor.hpp"
 #include "motor_interface.hpp"
 
@@ -36,10 +38,44 @@ namespace tap::motor
  * that the two motors are identical with the same gear ratio and are dji
  * motors with the same communication and control interface (for example,
  * two M3508's, two 6020's, etc.).
+ *
+ * By default the desired output is mirrored onto both motors. Alternatively, load sharing may be
+ * enabled with `setLoadSharingConfig`, in which case the desired output is split between the two
+ * motors based on their measured torque and temperature and scaled by a per-motor gain (for
+ * example, to compensate for mismatched gearboxes). The split is computed once per call to
+ * `setDesiredOutput` and both motors are updated from the same measurements, so the two values
+ * serialized into the shared CAN frame are always consistent with each other.
  */
-class DoubleDjiMotor : public MotorInterface
+class DoubleDjiMotor final_mockable : public MotorInterface
 {
 public:
+    /**
+     * Parameters used to split the desired output between the two motors when load sharing.
+     *
+     * Given a desired output `u`, the motors are commanded `u * (1 - b) * gainOne` and
+     * `u * (1 + b) * gainTwo`, where the balance `b` is
+     *
+     * ```
+     * b = torqueBalanceGain * (|t1| - |t2|) / (|t1| + |t2|) + temperatureBalanceGain * (T1 - T2)
+     * ```
+     *
+     * limited to `[-maxBalance, maxBalance]`, `t` being the measured torque and `T` the measured
+     * temperature of each motor. A positive balance shifts output from motor one to motor two.
+     */
+    struct LoadSharingConfig
+    {
+        /// Scale factor applied to motor one's share of the output.
+        float gainOne = 1;
+        /// Scale factor applied to motor two's share of the output.
+        float gainTwo = 1;
+        /// Balance per unit of normalized torque imbalance between the motors.
+        float torqueBalanceGain = 0;
+        /// Balance per degree C of temperature difference between the motors.
+        float temperatureBalanceGain = 0;
+        /// Maximum magnitude of the balance, in [0, 1].
+        float maxBalance = 0.2f;
+    };
+
     DoubleDjiMotor(
         Drivers* drivers,
         MotorId desMotorIdentifierOne,
@@ -66,6 +102,30 @@ class DoubleDjiMotor : public MotorInterface
     int16_t getTorque() const override;
     int16_t getShaftRPM() const override;
 
+    /**
+     * Enables load sharing with the given parameters. Takes effect on the next call to
+     * `setDesiredOutput`.
+     */
+    void setLoadSharingConfig(const LoadSharingConfig& config);
+
+    /// Disables load sharing, mirroring the desired output onto both motors.
+    void disableLoadSharing();
+
+    bool isLoadSharingEnabled() const { return loadSharingEnabled; }
+
+    /**
+     * Sets an output that is added to the desired output passed to `setDesiredOutput` before it is
+     * split between the motors, for example a gravity compensation current. Takes effect on the
+     * next call to `setDesiredOutput`.
+     */
+    void setFeedForward(int32_t feedForward) { this->feedForward = feedForward; }
+
+    int32_t getFeedForward() const { return feedForward; }
+
+    /// @return The balance used in the most recent call to `setDesiredOutput`, see
+    ///     `LoadSharingConfig`. 0 if load sharing is disabled.
+    float getBalance() const { return balance; }
+
 protected:
 #if defined(PLATFORM_HOSTED) && defined(ENV_UNIT_TESTS)
 public:
@@ -77,6 +137,15 @@ class DoubleDjiMotor : public MotorInterface
     DjiMotor motorOne;
     DjiMotor motorTwo;
 #endif
+
+private:
+    LoadSharingConfig loadSharingConfig;
+    bool loadSharingEnabled = false;
+    int32_t feedForward = 0;
+    float balance = 0;
+
+    /// @return The balance computed from the motors' current torque and temperature.
+    float computeBalance() const;
 };
 }  // namespace tap::motor
 
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "feedback_phase_aligner.hpp"
+
+#include "tap/architecture/clock.hpp"
+
+#include "dji_motor_tx_handler.hpp"
+
+namespace tap::motor
+{
+FeedbackPhaseAligner::FeedbackPhaseAligner(
+    const DjiMotorTxHandler &txHandler,
+    can::CanBus alignedBus,
+    uint32_t period,
+    uint32_t guardTime)
+    : txHandler(txHandler),
+      alignedBus(alignedBus),
+      period(period),
+      guardTime(guardTime)
+{
+}
+
+bool FeedbackPhaseAligner::update() { return update(arch::clock::getTimeMicroseconds()); }
+
+bool FeedbackPhaseAligner::update(uint32_t now)
+{
+    updateBus(can::CanBus::CAN_BUS1);
+    updateBus(can::CanBus::CAN_BUS2);
+
+    Bus &aligned = buses[busIndex(alignedBus)];
+    if (aligned.burstReady)
+    {
+        aligned.burstReady = false;
+        tick(now, aligned.burstEnd);
+        return true;
+    }
+
+    if (!ticked || static_cast<int32_t>(now - tickTime) >= static_cast<int32_t>(period + guardTime))
+    {
+        // don't stop controlling the robot because feedback stopped
+        if (ticked)
+        {
+            missedBursts++;
+        }
+        tick(now, getNewestFeedback(alignedBus, now));
+        return true;
+    }
+
+    return false;
+}
+
+void FeedbackPhaseAligner::markCommandsSent()
+{
+    markCommandsSent(arch::clock::getTimeMicroseconds());
+}
+
+void FeedbackPhaseAligner::markCommandsSent(uint32_t now)
+{
+    if (!latencyPending)
+    {
+        return;
+    }
+    latencyPending = false;
+    latency = now - tickFeedbackTime;
+    latencyHistogram.record(latency);
+}
+
+void FeedbackPhaseAligner::updateBus(can::CanBus bus)
+{
+    Bus &state = buses[busIndex(bus)];
+    const uint8_t online = txHandler.getOnlineMotors(bus);
+    if (online == 0)
+    {
+        state.reported = 0;
+        return;
+    }
+
+    uint32_t burstEnd = state.burstEnd;
+    for (int id = 0; id < DjiMotorTxHandler::DJI_MOTORS_PER_CAN; id++)
+    {
+        if ((online & (1 << id)) == 0)
+        {
+            continue;
+        }
+        const uint32_t timestamp = txHandler.getLastFeedbackTimestamp(bus, id);
+        if (static_cast<int32_t>(timestamp - state.burstEnd) > 0)
+        {
+            state.reported |= 1 << id;
+            if (static_cast<int32_t>(timestamp - burstEnd) > 0)
+            {
+                burstEnd = timestamp;
+            }
+        }
+    }
+
+    // motors that went offline don't hold up the burst
+    state.reported &= online;
+    if (state.reported != online)
+    {
+        return;
+    }
+
+    state.burstEnd = burstEnd;
+    state.reported = 0;
+    state.burstReady = true;
+    state.burstCount++;
+
+    const int32_t periodSigned = static_cast<int32_t>(period);
+    const int32_t sample = static_cast<int32_t>(burstEnd % period);
+    if (!state.phaseValid)
+    {
+        state.phase = sample;
+        state.phaseValid = true;
+        return;
+    }
+
+    // the difference to the estimate, wrapped into [-period / 2, period / 2)
+    int32_t error = sample - state.phase;
+    if (error >= periodSigned / 2)
+    {
+        error -= periodSigned;
+    }
+    else if (error < -periodSigned / 2)
+    {
+        error += periodSigned;
+    }
+
+    state.phase += error / PHASE_FILTER_DIVISOR;
+    if (state.phase < 0)
+    {
+        state.phase += periodSigned;
+    }
+    else if (state.phase >= periodSigned)
+    {
+        state.phase -= periodSigned;
+    }
+}
+
+uint32_t FeedbackPhaseAligner::getNewestFeedback(can::CanBus bus, uint32_t now) const
+{
+    const uint8_t online = txHandler.getOnlineMotors(bus);
+    bool found = false;
+    uint32_t newest = now;
+    for (int id = 0; id < DjiMotorTxHandler::DJI_MOTORS_PER_CAN; id++)
+    {
+        if ((online & (1 << id)) == 0)
+        {
+            continue;
+        }
+        const uint32_t timestamp = txHandler.getLastFeedbackTimestamp(bus, id);
+        if (!found || static_cast<int32_t>(timestamp - newest) > 0)
+        {
+            newest = timestamp;
+            found = true;
+        }
+    }
+    return newest;
+}
+
+void FeedbackPhaseAligner::tick(uint32_t now, uint32_t feedbackTime)
+{
+    ticked = true;
+    tickTime = now;
+    tickFeedbackTime = feedbackTime;
+    latencyPending = true;
+}
+}  // namespace tap::motor
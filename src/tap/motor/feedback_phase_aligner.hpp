@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_FEEDBACK_PHASE_ALIGNER_HPP_
+#define TAPROOT_FEEDBACK_PHASE_ALIGNER_HPP_
+
+#include <cstdint>
+
+#include "tap/architecture/latency_histogram.hpp"
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+namespace tap::motor
+{
+class DjiMotorTxHandler;
+
+/**
+ * Aligns the control tick to the feedback sent by DJI motors, so that the scheduler runs on
+ * feedback that is as fresh as possible.
+ *
+ * Each ESC sends feedback every `FEEDBACK_PERIOD` on its own clock, unrelated to the timer
+ * that usually runs the control loop, so feedback can be almost a full period old by the time
+ * it is used. Instead, the aligner watches the feedback timestamps recorded by the
+ * `DjiMotorTxHandler`. A bus's burst of feedback is complete once every online motor on the bus
+ * has sent feedback since the previous burst, and `update` returns `true` as soon as the burst
+ * on the aligned bus is complete. If no burst completes within the period plus `guardTime` of
+ * the previous tick (for example while a motor is dropping messages), the tick runs anyway.
+ *
+ * For each bus, the aligner also tracks the phase of the end of the burst relative to the
+ * microsecond clock, and the end-to-end latency from the end of the burst a tick ran on to
+ * `markCommandsSent`. For example:
+ *
+ * ```cpp
+ * FeedbackPhaseAligner aligner(drivers->djiMotorTxHandler, tap::can::CanBus::CAN_BUS1);
+ *
+ * while (true)
+ * {
+ *     drivers->canRxHandler.pollCanData();
+ *     if (aligner.update())
+ *     {
+ *         drivers->commandScheduler.run();
+ *         drivers->djiMotorTxHandler.encodeAndSendCanData();
+ *         aligner.markCommandsSent();
+ *     }
+ * }
+ * ```
+ *
+ * All times are in microseconds, see `tap::arch::clock::getTimeMicroseconds`.
+ */
+class FeedbackPhaseAligner
+{
+public:
+    /// Period at which DJI motors send feedback.
+    static constexpr uint32_t FEEDBACK_PERIOD = 1'000;
+
+    /// Default time a tick waits past the period for a late burst.
+    static constexpr uint32_t DEFAULT_GUARD_TIME = 200;
+
+    /**
+     * Each new burst moves a bus's phase estimate by 1 / `PHASE_FILTER_DIVISOR` of its
+     * difference from the estimate, which smooths out jitter in when messages are dispatched.
+     */
+    static constexpr int32_t PHASE_FILTER_DIVISOR = 8;
+
+    /**
+     * @param[in] txHandler The handler that records the feedback of the motors.
+     * @param[in] alignedBus The bus whose feedback the control tick is aligned to, usually the
+     *      bus with the motors that need the most control bandwidth (such as the gimbal).
+     * @param[in] period The period of the control tick, normally `FEEDBACK_PERIOD`.
+     * @param[in] guardTime See `DEFAULT_GUARD_TIME`.
+     */
+    FeedbackPhaseAligner(
+        const DjiMotorTxHandler &txHandler,
+        can::CanBus alignedBus,
+        uint32_t period = FEEDBACK_PERIOD,
+        uint32_t guardTime = DEFAULT_GUARD_TIME);
+    DISALLOW_COPY_AND_ASSIGN(FeedbackPhaseAligner)
+
+    /**
+     * Checks for completed feedback bursts on each bus. Call right after
+     * `CanRxHandler::pollCanData`, as often as possible.
+     *
+     * @return `true` if the control tick should run now.
+     */
+    bool update();
+
+    /// @param[in] now The current time.
+    bool update(uint32_t now);
+
+    /**
+     * Records the end-to-end latency of the tick that most recently ran. Call right after
+     * `DjiMotorTxHandler::encodeAndSendCanData`.
+     */
+    void markCommandsSent();
+
+    /// @param[in] now The current time.
+    void markCommandsSent(uint32_t now);
+
+    /// @return `true` if a feedback burst has completed on the bus.
+    bool isBurstPhaseValid(can::CanBus bus) const { return buses[busIndex(bus)].phaseValid; }
+
+    /**
+     * @return The estimated phase of the end of the bus's feedback burst, in [0, period). A
+     *      burst ending at time `t` has phase `t % period`.
+     */
+    uint32_t getBurstPhase(can::CanBus bus) const { return buses[busIndex(bus)].phase; }
+
+    /// @return The number of feedback bursts completed on the bus.
+    uint32_t getBurstCount(can::CanBus bus) const { return buses[busIndex(bus)].burstCount; }
+
+    /// @return The number of ticks that ran without a completed burst on the aligned bus.
+    uint32_t getMissedBursts() const { return missedBursts; }
+
+    /**
+     * @return The time from the end of the burst the most recent tick ran on (or, if it ran
+     *      without one, the most recent feedback on the aligned bus) to `markCommandsSent`.
+     */
+    uint32_t getLatency() const { return latency; }
+
+    /// @return A histogram of every latency measured by `markCommandsSent`.
+    const arch::LatencyHistogram &getLatencyHistogram() const { return latencyHistogram; }
+
+private:
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    struct Bus
+    {
+        /// Time the most recent burst ended, the newest feedback timestamp in it.
+        uint32_t burstEnd = 0;
+        /// Bitmask of the normalized ids of the motors that have sent feedback since `burstEnd`.
+        uint8_t reported = 0;
+        /// `true` if a burst has completed that no tick has run on yet.
+        bool burstReady = false;
+        bool phaseValid = false;
+        int32_t phase = 0;
+        uint32_t burstCount = 0;
+    };
+
+    const DjiMotorTxHandler &txHandler;
+    const can::CanBus alignedBus;
+    const uint32_t period;
+    const uint32_t guardTime;
+
+    Bus buses[NUM_CAN_BUSES];
+
+    bool ticked = false;
+    uint32_t tickTime = 0;
+    /// Time of the feedback the most recent tick ran on, that its latency is measured from.
+    uint32_t tickFeedbackTime = 0;
+    /// `true` from a tick until `markCommandsSent`.
+    bool latencyPending = false;
+
+    uint32_t missedBursts = 0;
+    uint32_t latency = 0;
+    arch::LatencyHistogram latencyHistogram;
+
+    static int busIndex(can::CanBus bus) { return static_cast<int>(bus); }
+
+    /// Checks whether the burst on the bus has completed, and if so updates its phase.
+    void updateBus(can::CanBus bus);
+
+    /// @return The newest feedback timestamp of the online motors on the bus, or `now` if none.
+    uint32_t getNewestFeedback(can::CanBus bus, uint32_t now) const;
+
+    void tick(uint32_t now, uint32_t feedbackTime);
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_FEEDBACK_PHASE_ALIGNER_HPP_
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "motor_thermal_estimator.hpp"
+
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+#include "dji_motor.hpp"
+
+namespace tap::motor
+{
+MotorThermalEstimator::MotorThermalEstimator(const Config &config) : config(config)
+{
+    reset(config.ambientTemperature);
+}
+
+void MotorThermalEstimator::reset(float temperature)
+{
+    windingRise = 0;
+    caseTemperature = temperature;
+    current = 0;
+    stallDuration = 0;
+    timeToLimit = predictTimeToLimit(0);
+    updateDeratingFactor();
+}
+
+void MotorThermalEstimator::update(float current, float measuredTemperature, float rpm, float dt)
+{
+    this->current = current;
+
+    if (dt > 0)
+    {
+        const float heat = current * current * config.resistance;
+        const float windingToCase = windingRise / config.windingThermalResistance;
+        const float caseToAmbient =
+            (caseTemperature - config.ambientTemperature) / config.caseThermalResistance;
+
+        windingRise += dt * (heat - windingToCase) / config.windingThermalCapacitance;
+        caseTemperature += dt * (windingToCase - caseToAmbient) / config.caseThermalCapacitance;
+
+        const float correction = std::min(1.0f, config.measurementCorrectionRate * dt);
+        caseTemperature += correction * (measuredTemperature - caseTemperature);
+
+        if (fabsf(current) >= config.stallCurrent && fabsf(rpm) <= config.stallRpm)
+        {
+            stallDuration += dt;
+        }
+        else
+        {
+            stallDuration = 0;
+        }
+    }
+
+    timeToLimit = predictTimeToLimit(current);
+    updateDeratingFactor();
+}
+
+void MotorThermalEstimator::update(const DjiMotor &motor)
+{
+    const uint32_t feedbackTimestamp = motor.getFeedbackTimestamp();
+
+    if (!motorUpdateInitialized)
+    {
+        reset(motor.getTemperature());
+        prevFeedbackTimestamp = feedbackTimestamp;
+        motorUpdateInitialized = true;
+        return;
+    }
+
+    if (feedbackTimestamp == prevFeedbackTimestamp)
+    {
+        return;
+    }
+
+    const float dt = (feedbackTimestamp - prevFeedbackTimestamp) / 1'000'000.0f;
+    prevFeedbackTimestamp = feedbackTimestamp;
+
+    update(
+        motor.getTorque() * config.currentPerFeedbackUnit,
+        motor.getTemperature(),
+        motor.getShaftRPM(),
+        dt);
+}
+
+float MotorThermalEstimator::getContinuousCurrent() const
+{
+    const float allowedRise = std::max(0.0f, config.temperatureLimit - caseTemperature);
+    return sqrtf(allowedRise / (config.resistance * config.windingThermalResistance));
+}
+
+float MotorThermalEstimator::predictTimeToLimit(float current) const
+{
+    if (getWindingTemperature() >= config.temperatureLimit)
+    {
+        return 0;
+    }
+
+    const float heat = current * current * config.resistance;
+    const float steadyWindingRise = heat * config.windingThermalResistance;
+
+    if (caseTemperature + steadyWindingRise > config.temperatureLimit)
+    {
+        // The winding reaches the limit before the case heats up appreciably, so hold the case
+        // temperature and solve the winding's first order response for the limit
+        const float tau = config.windingThermalResistance * config.windingThermalCapacitance;
+        return -tau * logf(
+                          (config.temperatureLimit - caseTemperature - steadyWindingRise) /
+                          (windingRise - steadyWindingRise));
+    }
+
+    // Otherwise the winding settles below the limit and the limit is only reached once the case
+    // has heated up by enough
+    const float caseTarget = config.temperatureLimit - steadyWindingRise;
+    const float steadyCaseTemperature =
+        config.ambientTemperature + heat * config.caseThermalResistance;
+
+    if (steadyCaseTemperature <= caseTarget)
+    {
+        return NEVER;
+    }
+
+    const float tau = config.caseThermalResistance * config.caseThermalCapacitance;
+    return -tau * logf(
+                      (caseTarget - steadyCaseTemperature) /
+                      (caseTemperature - steadyCaseTemperature));
+}
+
+void MotorThermalEstimator::updateDeratingFactor()
+{
+    if (timeToLimit == NEVER || timeToLimit >= config.derateStartTime)
+    {
+        deratingFactor = 1;
+        return;
+    }
+
+    const float continuousCurrent = getContinuousCurrent();
+    const float currentMagnitude = fabsf(current);
+
+    float continuousRatio;
+    if (currentMagnitude > continuousCurrent)
+    {
+        continuousRatio = continuousCurrent / currentMagnitude;
+    }
+    else
+    {
+        continuousRatio = continuousCurrent > 0 ? 1 : 0;
+    }
+
+    deratingFactor = tap::algorithms::limitVal(
+        continuousRatio + (1 - continuousRatio) * timeToLimit / config.derateStartTime,
+        0.0f,
+        1.0f);
+}
+}  // namespace tap::motor
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_THERMAL_ESTIMATOR_HPP_
+#define TAPROOT_MOTOR_THERMAL_ESTIMATOR_HPP_
+
+#include <cstdint>
+
+namespace tap::motor
+{
+class DjiMotor;
+
+/**
+ * Estimates the winding temperature of a motor from its current and measured temperature, predicts
+ * how long until the winding reaches its temperature limit, and computes a derating factor that
+ * may be multiplied into the motor's desired output (like the ratio returned by a `PowerLimiter`)
+ * to keep the motor below its limit. Also detects when the motor is stalled (drawing a large
+ * current while not turning).
+ *
+ * The motor is modeled as two lumped thermal masses, the winding and the case. The winding is
+ * heated by `I^2 R` losses and conducts heat to the case, which in turn conducts heat to the
+ * ambient air. The case temperature is corrected towards the measured temperature reported by the
+ * motor each update, so the winding temperature estimate does not drift.
+ *
+ * The derating factor is 1 while the predicted time to the temperature limit (assuming the present
+ * current is held) is at least `derateStartTime`. Below that, the factor decreases linearly with
+ * the predicted time to the ratio of the continuous current (the current that may be held forever
+ * at the present case temperature) to the present current, such that holding the derated output
+ * keeps the winding at or below its limit.
+ *
+ * For example:
+ *
+ * ```cpp
+ * MotorThermalEstimator thermal(MotorThermalEstimator::M3508_CONFIG);
+ *
+ * // each control loop iteration
+ * thermal.update(motor);
+ * motor.setDesiredOutput(thermal.getDeratingFactor() * pidOutput);
+ * ```
+ */
+class MotorThermalEstimator
+{
+public:
+    struct Config
+    {
+        /// Winding resistance, in ohms.
+        float resistance;
+        /// Thermal resistance between the winding and the case, in K/W.
+        float windingThermalResistance;
+        /// Thermal capacitance of the winding, in J/K.
+        float windingThermalCapacitance;
+        /// Thermal resistance between the case and the ambient air, in K/W.
+        float caseThermalResistance;
+        /// Thermal capacitance of the case, in J/K.
+        float caseThermalCapacitance;
+        /// Ambient air temperature, in degrees C.
+        float ambientTemperature;
+        /// Winding temperature that should not be exceeded, in degrees C.
+        float temperatureLimit;
+        /// Predicted time to the temperature limit below which output is derated, in seconds.
+        float derateStartTime;
+        /// Rate at which the case temperature estimate is corrected towards the measured
+        /// temperature, in 1/s.
+        float measurementCorrectionRate;
+        /// Amps per unit of the current (torque) reported in a `DjiMotor`'s feedback.
+        float currentPerFeedbackUnit;
+        /// Magnitude of current above which the motor may be stalled, in amps.
+        float stallCurrent;
+        /// Magnitude of shaft speed below which the motor may be stalled, in RPM.
+        float stallRpm;
+        /// Time the motor must meet both stall conditions to be considered stalled, in seconds.
+        float stallTime;
+    };
+
+    /**
+     * Approximate parameters for an M3508 driven by a C620, whose feedback current ranges over
+     * [-16384, 16384] for [-20, 20] amps. Thermal parameters should be tuned for your hardware.
+     */
+    static constexpr Config M3508_CONFIG = {
+        .resistance = 0.194f,
+        .windingThermalResistance = 1.2f,
+        .windingThermalCapacitance = 25.0f,
+        .caseThermalResistance = 2.5f,
+        .caseThermalCapacitance = 150.0f,
+        .ambientTemperature = 25.0f,
+        .temperatureLimit = 100.0f,
+        .derateStartTime = 10.0f,
+        .measurementCorrectionRate = 0.5f,
+        .currentPerFeedbackUnit = 20.0f / 16'384.0f,
+        .stallCurrent = 10.0f,
+        .stallRpm = 10.0f,
+        .stallTime = 0.5f,
+    };
+
+    /// Value returned by `getTimeToLimit` when the limit will never be reached.
+    static constexpr float NEVER = -1;
+
+    explicit MotorThermalEstimator(const Config &config);
+
+    /// Resets the estimate so that the winding and case are at the given temperature.
+    void reset(float temperature);
+
+    /**
+     * Updates the estimate.
+     *
+     * @param[in] current The current through the motor, in amps.
+     * @param[in] measuredTemperature The temperature reported by the motor, in degrees C.
+     * @param[in] rpm The shaft speed of the motor, in RPM.
+     * @param[in] dt The time since the last update, in seconds. Updates with nonpositive `dt` do
+     *      not advance the thermal or stall state, but do update the prediction for the new
+     *      current.
+     */
+    void update(float current, float measuredTemperature, float rpm, float dt);
+
+    /**
+     * Updates the estimate from the latest feedback of the given motor. The time since the last
+     * update is derived from the motor's feedback timestamp, so the estimate only advances when
+     * new feedback has been received. The first call only initializes the estimate.
+     */
+    void update(const DjiMotor &motor);
+
+    /// @return The estimated winding temperature, in degrees C.
+    float getWindingTemperature() const { return caseTemperature + windingRise; }
+
+    /// @return The estimated case temperature, in degrees C.
+    float getCaseTemperature() const { return caseTemperature; }
+
+    /**
+     * @return The predicted time until the winding reaches the temperature limit if the current
+     *      from the most recent update is held, in seconds. 0 if the limit has been reached and
+     *      `NEVER` if it will not be reached.
+     */
+    float getTimeToLimit() const { return timeToLimit; }
+
+    /**
+     * @return The magnitude of current that may be held indefinitely without the winding
+     *      exceeding the temperature limit at the present case temperature, in amps.
+     */
+    float getContinuousCurrent() const;
+
+    /// @return A factor in [0, 1] to multiply the motor's desired output by. See class comment.
+    float getDeratingFactor() const { return deratingFactor; }
+
+    /// @return `true` if the motor has met the stall conditions for at least `stallTime`.
+    bool isStalled() const { return stallDuration >= config.stallTime; }
+
+private:
+    const Config config;
+
+    float windingRise = 0;
+    float caseTemperature = 0;
+    float current = 0;
+    float timeToLimit = NEVER;
+    float deratingFactor = 1;
+    float stallDuration = 0;
+
+    bool motorUpdateInitialized = false;
+    uint32_t prevFeedbackTimestamp = 0;
+
+    /// @return The predicted time to the temperature limit at the given current, see
+    ///     `getTimeToLimit`.
+    float predictTimeToLimit(float current) const;
+
+    void updateDeratingFactor();
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_MOTOR_THERMAL_ESTIMATOR_HPP_
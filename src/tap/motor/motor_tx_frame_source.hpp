@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_TX_FRAME_SOURCE_HPP_
+#define TAPROOT_MOTOR_TX_FRAME_SOURCE_HPP_
+
+#include "tap/communication/can/can_bus.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::motor
+{
+/**
+ * A set of CAN frames carrying motor commands, indexed per bus, that are sent each control tick by
+ * a `MotorTxScheduler`. Each frame is owned by the source and updated in place as commands change,
+ * so the scheduler never copies or re-encodes a frame before sending it.
+ */
+class MotorTxFrameSource
+{
+public:
+    /// The max number of frames a source may have on each bus.
+    static constexpr int MAX_FRAMES_PER_BUS = 32;
+
+    virtual ~MotorTxFrameSource() = default;
+
+    /**
+     * @return The number of frame indices in use on the bus, at most `MAX_FRAMES_PER_BUS`. Frames
+     *      are indexed [0, count), and some indices may refer to frames without any motors.
+     */
+    virtual int getTxFrameCount(can::CanBus bus) const = 0;
+
+    /**
+     * @return The frame at the given index on the bus, or `nullptr` if the frame has no motors
+     *      and should not be sent.
+     */
+    virtual const modm::can::Message* getTxFrame(can::CanBus bus, int index) const = 0;
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_MOTOR_TX_FRAME_SOURCE_HPP_
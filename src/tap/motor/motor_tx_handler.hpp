@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_TX_HANDLER_HPP_
+#define TAPROOT_MOTOR_TX_HANDLER_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+#include "motor_tx_frame_source.hpp"
+
+namespace tap::motor
+{
+/**
+ * Aggregates commands for motors that share a CAN protocol into as few CAN frames as the protocol
+ * allows. The protocol defines how motors are grouped into frames and how commands are packed,
+ * so the same handler serves protocols that pack several motors into one frame (such as DJI's,
+ * see `DjiMotorTxProtocol`) and protocols that use one frame per motor (such as the MIT
+ * protocol, see `MitMotorTxProtocol`).
+ *
+ * Frames are persistent and each motor's command is packed into its frame as soon as it is set,
+ * so sending a tick's commands is only a matter of sending each frame with motors. Register the
+ * handler with a `MotorTxScheduler` to send its frames, which allows handlers of different
+ * protocols to share a bus with a single flush per tick.
+ *
+ * A `Protocol` must provide the following:
+ * - `Address`, the type identifying a motor on a bus.
+ * - `Command`, the type of command sent to a motor.
+ * - `static uint32_t getFrameIdentifier(const Address&)`, the identifier of the frame the
+ *   motor's command is sent in.
+ * - `static int getSlot(const Address&)`, the motor's slot in the frame, in
+ *   [0, `MOTORS_PER_FRAME`).
+ * - `static constexpr int MOTORS_PER_FRAME`, the number of motors that fit in a frame.
+ * - `static void initFrame(uint32_t identifier, modm::can::Message*)`, which initializes a frame
+ *   without any motors.
+ * - `static void pack(const Command&, int slot, modm::can::Message*)`, which packs a command into
+ *   the given slot of the frame.
+ *
+ * @tparam Protocol The protocol of the motors in the handler.
+ * @tparam MAX_FRAMES The max number of frames on each bus.
+ */
+template <typename Protocol, int MAX_FRAMES>
+class MotorTxHandler : public MotorTxFrameSource
+{
+public:
+    static_assert(
+        MAX_FRAMES > 0 && MAX_FRAMES <= MAX_FRAMES_PER_BUS,
+        "MotorTxHandler must have between 1 and MAX_FRAMES_PER_BUS frames");
+    static_assert(
+        Protocol::MOTORS_PER_FRAME > 0 && Protocol::MOTORS_PER_FRAME <= 8,
+        "Protocol must fit between 1 and 8 motors in a frame");
+
+    using Address = typename Protocol::Address;
+    using Command = typename Protocol::Command;
+
+    /**
+     * Refers to a motor added to the handler. Invalid if the motor could not be added.
+     */
+    struct MotorHandle
+    {
+        int8_t bus = -1;
+        int8_t frame = -1;
+        int8_t slot = -1;
+
+        bool isValid() const { return frame >= 0; }
+    };
+
+    MotorTxHandler() = default;
+    DISALLOW_COPY_AND_ASSIGN(MotorTxHandler)
+
+    /**
+     * Adds a motor to the handler. The motor's slot is initially packed with a default
+     * constructed `Command`.
+     *
+     * @return A handle used to set the motor's command. The handle is invalid if a motor with the
+     *      same frame and slot was already added or if there are no free frames on the bus.
+     */
+    MotorHandle addMotor(can::CanBus bus, const Address& address)
+    {
+        const int busIndex = static_cast<int>(bus);
+        const uint32_t identifier = Protocol::getFrameIdentifier(address);
+        const int slot = Protocol::getSlot(address);
+
+        if (slot < 0 || slot >= Protocol::MOTORS_PER_FRAME)
+        {
+            return MotorHandle();
+        }
+
+        int frame = findFrame(busIndex, identifier);
+
+        if (frame < 0)
+        {
+            frame = allocateFrame(busIndex, identifier);
+        }
+        else if ((slotMasks[busIndex][frame] & (1 << slot)) != 0)
+        {
+            return MotorHandle();
+        }
+
+        if (frame < 0)
+        {
+            return MotorHandle();
+        }
+
+        slotMasks[busIndex][frame] |= 1 << slot;
+
+        MotorHandle handle;
+        handle.bus = busIndex;
+        handle.frame = frame;
+        handle.slot = slot;
+        setCommand(handle, Command());
+        return handle;
+    }
+
+    /**
+     * Removes a motor from the handler, packing a default constructed `Command` into its slot.
+     * Frames without any motors are no longer sent, and may be reused by motors added later.
+     *
+     * @return `false` if the handle does not refer to a motor in the handler.
+     */
+    bool removeMotor(const MotorHandle& handle)
+    {
+        if (!contains(handle))
+        {
+            return false;
+        }
+
+        setCommand(handle, Command());
+        slotMasks[handle.bus][handle.frame] &= ~(1 << handle.slot);
+        return true;
+    }
+
+    /**
+     * Packs a command into the motor's frame, which is sent the next time the motor's frames are
+     * sent by a `MotorTxScheduler`. Does nothing if the handle is invalid.
+     */
+    void setCommand(const MotorHandle& handle, const Command& command)
+    {
+        if (handle.isValid())
+        {
+            Protocol::pack(command, handle.slot, &frames[handle.bus][handle.frame]);
+        }
+    }
+
+    /// @return `true` if the handle refers to a motor in the handler.
+    bool contains(const MotorHandle& handle) const
+    {
+        return handle.isValid() && handle.frame < frameCounts[handle.bus] &&
+               (slotMasks[handle.bus][handle.frame] & (1 << handle.slot)) != 0;
+    }
+
+    int getTxFrameCount(can::CanBus bus) const override
+    {
+        return frameCounts[static_cast<int>(bus)];
+    }
+
+    const modm::can::Message* getTxFrame(can::CanBus bus, int index) const override
+    {
+        const int busIndex = static_cast<int>(bus);
+
+        if (index < 0 || index >= frameCounts[busIndex] || slotMasks[busIndex][index] == 0)
+        {
+            return nullptr;
+        }
+
+        return &frames[busIndex][index];
+    }
+
+private:
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    modm::can::Message frames[NUM_CAN_BUSES][MAX_FRAMES];
+
+    /// Bitmask of the slots in use in each frame, a frame without slots in use is not sent.
+    uint8_t slotMasks[NUM_CAN_BUSES][MAX_FRAMES] = {};
+
+    /// Number of frame indices in use on each bus.
+    int frameCounts[NUM_CAN_BUSES] = {};
+
+    /// @return The index of the frame with motors and the given identifier, or -1 if none.
+    int findFrame(int busIndex, uint32_t identifier) const
+    {
+        for (int i = 0; i < frameCounts[busIndex]; i++)
+        {
+            if (slotMasks[busIndex][i] != 0 && frames[busIndex][i].getIdentifier() == identifier)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Initializes a frame with the given identifier, reusing a frame without motors if there is
+     * one.
+     *
+     * @return The index of the frame, or -1 if there are no free frames.
+     */
+    int allocateFrame(int busIndex, uint32_t identifier)
+    {
+        int frame = -1;
+
+        for (int i = 0; i < frameCounts[busIndex]; i++)
+        {
+            if (slotMasks[busIndex][i] == 0)
+            {
+                frame = i;
+                break;
+            }
+        }
+
+        if (frame < 0)
+        {
+            if (frameCounts[busIndex] >= MAX_FRAMES)
+            {
+                return -1;
+            }
+            frame = frameCounts[busIndex]++;
+        }
+
+        Protocol::initFrame(identifier, &frames[busIndex][frame]);
+        return frame;
+    }
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_MOTOR_TX_HANDLER_HPP_
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_TX_PROTOCOLS_HPP_
+#define TAPROOT_MOTOR_TX_PROTOCOLS_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+#include "dji_motor_tx_handler.hpp"
+
+namespace tap::motor
+{
+/**
+ * `MotorTxHandler` protocol for DJI motor controllers, which pack the commands of up to 4 motors
+ * into each frame. The frame a motor is sent in depends on its id and, for GM6020s, whether it is
+ * in current control, identically to `DjiMotorTxHandler`.
+ */
+struct DjiMotorTxProtocol
+{
+    struct Address
+    {
+        MotorId id;
+        /// `true` if the motor is a GM6020 in current control.
+        bool currentControl = false;
+    };
+
+    /// The raw desired output of the motor, see `DjiMotor::setDesiredOutput`.
+    using Command = int16_t;
+
+    static constexpr int MOTORS_PER_FRAME = 4;
+
+    static uint32_t getFrameIdentifier(const Address& address)
+    {
+        if (DJI_MOTOR_TO_NORMALIZED_ID(address.id) <= DJI_MOTOR_TO_NORMALIZED_ID(MOTOR4))
+        {
+            return DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER;
+        }
+        return address.currentControl ? DjiMotorTxHandler::CAN_DJI_6020_CURRENT_IDENTIFIER
+                                      : DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER;
+    }
+
+    /// @return The motor's slot, or `MOTORS_PER_FRAME` if the motor id is invalid.
+    static int getSlot(const Address& address)
+    {
+        const uint32_t normalizedId = DJI_MOTOR_TO_NORMALIZED_ID(address.id);
+        return normalizedId < DjiMotorTxHandler::DJI_MOTORS_PER_CAN
+                   ? normalizedId % MOTORS_PER_FRAME
+                   : MOTORS_PER_FRAME;
+    }
+
+    static void initFrame(uint32_t identifier, modm::can::Message* frame)
+    {
+        frame->setIdentifier(identifier);
+        frame->setLength(DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH);
+        frame->setExtended(false);
+        std::memset(frame->data, 0, DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH);
+    }
+
+    static void pack(const Command& command, int slot, modm::can::Message* frame)
+    {
+        frame->data[2 * slot] = static_cast<uint16_t>(command) >> 8;
+        frame->data[2 * slot + 1] = static_cast<uint16_t>(command) & 0xff;
+    }
+};
+
+/**
+ * Default command limits of `MitMotorTxProtocol`, which match the default limits of DM-J4310
+ * motors. Motors map the full range of each packed field to [-MAX, MAX] (or [0, MAX] for gains),
+ * so these must match the limits configured on the motor.
+ */
+struct MitMotorLimits
+{
+    /// Position limit, in radians.
+    static constexpr float POSITION_MAX = 12.5f;
+    /// Velocity limit, in radians per second.
+    static constexpr float VELOCITY_MAX = 30.0f;
+    /// Torque limit, in Nm.
+    static constexpr float TORQUE_MAX = 10.0f;
+    /// Position gain limit, in Nm per radian.
+    static constexpr float KP_MAX = 500.0f;
+    /// Velocity gain limit, in Nm per radian per second.
+    static constexpr float KD_MAX = 5.0f;
+};
+
+/**
+ * `MotorTxHandler` protocol for motors that use the MIT mini cheetah command format, such as MIT
+ * actuators and DM series motors in MIT mode. Each motor is sent its own frame with the motor's
+ * CAN id as the identifier. The motor applies a torque of
+ * `kp * (position - actual position) + kd * (velocity - actual velocity) + torque`.
+ *
+ * @tparam Limits The command limits configured on the motor, see `MitMotorLimits`.
+ */
+template <typename Limits = MitMotorLimits>
+struct MitMotorTxProtocol
+{
+    /// The CAN id of the motor.
+    using Address = uint32_t;
+
+    struct Command
+    {
+        /// Desired position, in radians.
+        float position = 0;
+        /// Desired velocity, in radians per second.
+        float velocity = 0;
+        /// Position gain, in Nm per radian.
+        float kp = 0;
+        /// Velocity gain, in Nm per radian per second.
+        float kd = 0;
+        /// Feedforward torque, in Nm.
+        float torque = 0;
+    };
+
+    static constexpr int MOTORS_PER_FRAME = 1;
+
+    static constexpr uint8_t FRAME_LENGTH = 8;
+
+    static uint32_t getFrameIdentifier(const Address& address) { return address; }
+
+    static int getSlot(const Address&) { return 0; }
+
+    static void initFrame(uint32_t identifier, modm::can::Message* frame)
+    {
+        frame->setIdentifier(identifier);
+        frame->setLength(FRAME_LENGTH);
+        frame->setExtended(false);
+        pack(Command(), 0, frame);
+    }
+
+    /**
+     * Packs the command into the frame as a 16 bit position, 12 bit velocity, 12 bit kp, 12 bit
+     * kd, and 12 bit torque, each big endian and linearly mapped from the range set by `Limits`.
+     */
+    static void pack(const Command& command, int, modm::can::Message* frame)
+    {
+        const uint16_t p =
+            floatToUint(command.position, -Limits::POSITION_MAX, Limits::POSITION_MAX, 16);
+        const uint16_t v =
+            floatToUint(command.velocity, -Limits::VELOCITY_MAX, Limits::VELOCITY_MAX, 12);
+        const uint16_t kp = floatToUint(command.kp, 0, Limits::KP_MAX, 12);
+        const uint16_t kd = floatToUint(command.kd, 0, Limits::KD_MAX, 12);
+        const uint16_t t =
+            floatToUint(command.torque, -Limits::TORQUE_MAX, Limits::TORQUE_MAX, 12);
+
+        frame->data[0] = p >> 8;
+        frame->data[1] = p & 0xff;
+        frame->data[2] = v >> 4;
+        frame->data[3] = ((v & 0xf) << 4) | (kp >> 8);
+        frame->data[4] = kp & 0xff;
+        frame->data[5] = kd >> 4;
+        frame->data[6] = ((kd & 0xf) << 4) | (t >> 8);
+        frame->data[7] = t & 0xff;
+    }
+
+    /**
+     * Linearly maps `x` from [min, max] to an unsigned integer with the given number of bits,
+     * limiting `x` to the range.
+     */
+    static uint16_t floatToUint(float x, float min, float max, int bits)
+    {
+        x = tap::algorithms::limitVal(x, min, max);
+        return static_cast<uint16_t>((x - min) * ((1 << bits) - 1) / (max - min));
+    }
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_MOTOR_TX_PROTOCOLS_HPP_
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "motor_tx_scheduler.hpp"
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_tx_planner.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/create_errors.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::motor
+{
+MotorTxScheduler::MotorTxScheduler(Drivers* drivers) : drivers(drivers) {}
+
+bool MotorTxScheduler::addSource(MotorTxFrameSource* source)
+{
+    if (source == nullptr || sourceCount >= MAX_SOURCES)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < sourceCount; i++)
+    {
+        if (sources[i] == source)
+        {
+            return false;
+        }
+    }
+
+    sources[sourceCount++] = source;
+    return true;
+}
+
+void MotorTxScheduler::encodeAndSendCanData()
+{
+    tickStart = arch::clock::getTimeMicroseconds();
+    queueFrames(can::CanBus::CAN_BUS1);
+    queueFrames(can::CanBus::CAN_BUS2);
+
+    sendPendingFrames();
+}
+
+void MotorTxScheduler::sendPendingFrames()
+{
+    const uint32_t now = arch::clock::getTimeMicroseconds();
+    bool messageSuccess = sendPendingFrames(can::CanBus::CAN_BUS1, now);
+    messageSuccess &= sendPendingFrames(can::CanBus::CAN_BUS2, now);
+
+    if (!messageSuccess)
+    {
+        RAISE_ERROR(drivers, "sendMessage failure");
+    }
+}
+
+uint32_t MotorTxScheduler::getPendingFrames(int sourceIndex, can::CanBus bus) const
+{
+    if (sourceIndex < 0 || sourceIndex >= sourceCount)
+    {
+        return 0;
+    }
+    return pendingFrames[sourceIndex][static_cast<int>(bus)];
+}
+
+void MotorTxScheduler::queueFrames(can::CanBus bus)
+{
+    const int busIndex = static_cast<int>(bus);
+    int supersededFrames = 0;
+
+    for (int s = 0; s < sourceCount; s++)
+    {
+        const int frameCount = sources[s]->getTxFrameCount(bus);
+        uint32_t queuedFrames = 0;
+
+        for (int f = 0; f < frameCount && f < MotorTxFrameSource::MAX_FRAMES_PER_BUS; f++)
+        {
+            if (sources[s]->getTxFrame(bus, f) != nullptr)
+            {
+                queuedFrames |= 1u << f;
+            }
+        }
+
+        // Pending frames are updated in place, so re-queueing one supersedes its stale command
+        supersededFrames += __builtin_popcount(pendingFrames[s][busIndex] & queuedFrames);
+        pendingFrames[s][busIndex] |= queuedFrames;
+    }
+
+    if (supersededFrames > 0)
+    {
+        drivers->can.recordTxDrops(bus, supersededFrames);
+    }
+}
+
+bool MotorTxScheduler::sendPendingFrames(can::CanBus bus, uint32_t now)
+{
+    const int busIndex = static_cast<int>(bus);
+    const can::CanTxPlanner* plan = txPlans[busIndex];
+
+    for (int s = 0; s < sourceCount; s++)
+    {
+        uint32_t& pending = pendingFrames[s][busIndex];
+
+        for (uint32_t remaining = pending; remaining != 0; remaining &= remaining - 1)
+        {
+            const int f = __builtin_ctz(remaining);
+            const modm::can::Message* frame = sources[s]->getTxFrame(bus, f);
+
+            if (frame == nullptr)
+            {
+                // the frame's motors were removed after it was queued
+                pending &= ~(1u << f);
+                continue;
+            }
+
+            if (plan != nullptr && !plan->isReleased(frame->getIdentifier(), now - tickStart))
+            {
+                // Held until its planned offset, later frames may already be due
+                continue;
+            }
+
+            if (!drivers->can.isReadyToSend(bus))
+            {
+                // No free mailbox, remaining frames are sent once the bus drains
+                return true;
+            }
+
+            if (!drivers->can.sendMessage(bus, *frame))
+            {
+                return false;
+            }
+
+            pending &= ~(1u << f);
+        }
+    }
+
+    return true;
+}
+}  // namespace tap::motor
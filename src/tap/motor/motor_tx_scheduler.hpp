@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_TX_SCHEDULER_HPP_
+#define TAPROOT_MOTOR_TX_SCHEDULER_HPP_
+
+#include <cstdint>
+
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+#include "motor_tx_frame_source.hpp"
+
+namespace tap
+{
+class Drivers;
+}
+
+namespace tap::can
+{
+class CanTxPlanner;
+}
+
+namespace tap::motor
+{
+/**
+ * Sends the motor command frames of several `MotorTxFrameSource`s, such as `MotorTxHandler`s of
+ * different protocols and the `DjiMotorTxHandler`, with a single flush per control tick.
+ *
+ * Each call to `encodeAndSendCanData` marks every frame with motors as pending and then sends
+ * pending frames, in the order the sources were added, for as long as each bus has a free
+ * transmit mailbox. Frames that could not be sent stay pending and are retried by the next call
+ * to `sendPendingFrames`, which may be called more often than `encodeAndSendCanData` so that
+ * frames go out as soon as mailboxes drain. Since sources update their frames in place, a pending
+ * frame always holds the latest command. If a frame is still pending when it is queued again, its
+ * stale command is superseded and recorded as a dropped frame in the bus's `Can::BusStats`.
+ *
+ * A plan made by a `can::CanTxPlanner` may be set for each bus with `setTxPlan`, in which case
+ * each frame is held until its planned offset after the call to `encodeAndSendCanData` that
+ * queued it, rather than every frame going out back to back at the start of the tick. Held
+ * frames are sent by `sendPendingFrames`, which must then be called often enough to release
+ * them on time.
+ *
+ * @note When the `DjiMotorTxHandler` is added to a scheduler, the scheduler sends its frames and
+ *      `DjiMotorTxHandler::encodeAndSendCanData` should not also be called.
+ */
+class MotorTxScheduler
+{
+public:
+    /// The max number of sources that may be added to the scheduler.
+    static constexpr int MAX_SOURCES = 8;
+
+    MotorTxScheduler(Drivers* drivers);
+    DISALLOW_COPY_AND_ASSIGN(MotorTxScheduler)
+    mockable ~MotorTxScheduler() = default;
+
+    /**
+     * Adds a source whose frames are sent by the scheduler. Sources added first have their frames
+     * sent first.
+     *
+     * @return `false` if the source is `nullptr`, was already added, or `MAX_SOURCES` sources
+     *      have already been added.
+     */
+    mockable bool addSource(MotorTxFrameSource* source);
+
+    /// Queues the frames of every source, then sends as many as possible.
+    mockable void encodeAndSendCanData();
+
+    /**
+     * Sends pending frames on each bus until either no frames are pending or the bus has no free
+     * transmit mailbox. An error is added to the error handler if a frame fails to send even
+     * though the bus reported it was ready; the frame is left pending.
+     */
+    mockable void sendPendingFrames();
+
+    /**
+     * Sets the plan that holds each frame on the bus until its offset, see the class
+     * description, or sends frames as soon as possible if `plan` is `nullptr`. Frames whose
+     * identifier wasn't added to the plan are not held. The plan is not copied and must outlive
+     * the scheduler.
+     */
+    void setTxPlan(can::CanBus bus, const can::CanTxPlanner* plan)
+    {
+        txPlans[static_cast<int>(bus)] = plan;
+    }
+
+    /// @return The number of sources that have been added to the scheduler.
+    int getSourceCount() const { return sourceCount; }
+
+    /**
+     * @return A bitmask of the frames of the source at the given index that are waiting to be
+     *      sent on the bus, where bit `i` corresponds to frame index `i` of the source.
+     */
+    uint32_t getPendingFrames(int sourceIndex, can::CanBus bus) const;
+
+private:
+    static constexpr int NUM_CAN_BUSES = 2;
+
+    Drivers* drivers;
+
+    MotorTxFrameSource* sources[MAX_SOURCES] = {};
+
+    int sourceCount = 0;
+
+    /// Bitmask of pending frames of each source on each bus.
+    uint32_t pendingFrames[MAX_SOURCES][NUM_CAN_BUSES] = {};
+
+    /// Plans that hold pending frames until their offset, see `setTxPlan`.
+    const can::CanTxPlanner* txPlans[NUM_CAN_BUSES] = {};
+
+    /// Time of the most recent `encodeAndSendCanData`, that planned offsets are relative to.
+    uint32_t tickStart = 0;
+
+    void queueFrames(can::CanBus bus);
+
+    /**
+     * Sends the pending frames on the bus that are due at `now`.
+     *
+     * @return `false` if a frame failed to send, `true` otherwise.
+     */
+    bool sendPendingFrames(can::CanBus bus, uint32_t now);
+};
+}  // namespace tap::motor
+
+#endif  // TAPROOT_MOTOR_TX_SCHEDULER_HPP_
@@ -29,15 +29,14 @@ namespace tap::motor::motorsim
 {
 std::array<int16_t, 4> CanSerializer::parseMessage(const modm::can::Message* message)
 {
-    std::array<int16_t, 4> out;
-    const uint8_t* data = message->data;
-
-    // Byte Smashing!
-    out[0] = (static_cast<int16_t>(data[0]) << 8) | (static_cast<int16_t>(data[1]));
-    out[1] = (static_cast<int16_t>(data[2]) << 8) | (static_cast<int16_t>(data[3]));
-    out[2] = (static_cast<int16_t>(data[4]) << 8) | (static_cast<int16_t>(data[5]));
-    out[3] = (static_cast<int16_t>(data[6]) << 8) | (static_cast<int16_t>(data[7]));
-    return out;
+    using CommandFrame = arch::WireLayout<
+        arch::WireField<int16_t, 0, arch::Endianness::BIG>,
+        arch::WireField<int16_t, 2, arch::Endianness::BIG>,
+        arch::WireField<int16_t, 4, arch::Endianness::BIG>,
+        arch::WireField<int16_t, 6, arch::Endianness::BIG>>;
+
+    auto [out0, out1, out2, out3] = CommandFrame::decode(message->data);
+    return {out0, out1, out2, out3};
 }
 
 modm::can::Message CanSerializer::serializeFeedback(
@@ -46,16 +45,9 @@ modm::can::Message CanSerializer::serializeFeedback(
     int16_t current,
     MotorId mid)
 {
-    uint8_t inData[8](
-        angle >> 8,
-        angle & 0xFF,
-        rpm >> 8,
-        rpm & 0xFF,
-        current >> 8,
-        current & 0xFF,
-        0,  // Cannot yet simulate temperature
-        0   // Null Byte
-    );
+    // Cannot yet simulate temperature
+    uint8_t inData[FEEDBACK_MESSAGE_SEND_LENGTH] = {};
+    DjiMotor::FeedbackFrame::encode(inData, angle, rpm, current, 0);
 
     // Construct message, desginate recipient as 0-based index + first motor's ID
     return modm::can::Message{static_cast<uint32_t>(mid), FEEDBACK_MESSAGE_SEND_LENGTH, inData};
@@ -23,6 +23,8 @@
 
 #include <cassert>
 
+#include "tap/architecture/clock.hpp"
+
 #include "modm/architecture/interface/can_message.hpp"
 
 #include "can_serializer.hpp"
@@ -31,47 +33,79 @@ using namespace tap::can;
 
 namespace tap::motor::motorsim
 {
+DjiMotorSimHandler* DjiMotorSimHandler::activeHandler = nullptr;
+
 void DjiMotorSimHandler::resetMotorSims()
 {
-    nextMotorIdToEncode[can::CanBus::CAN_BUS1] = MotorId::MOTOR1;
-    nextMotorIdToEncode[can::CanBus::CAN_BUS2] = MotorId::MOTOR1;
-
-    for (auto& it : motorIDToMotorSimMap)
+    for (auto& busSlots : slots)
     {
-        it.second->reset();
+        for (auto& slot : busSlots)
+        {
+            slot.neverReported = true;
+            if (slot.sim != nullptr)
+            {
+                slot.sim->reset();
+            }
+        }
     }
 }
 
-void DjiMotorSimHandler::registerSim(
-    std::shared_ptr<MotorSim> motorSim,
-    std::tuple<can::CanBus, motor::MotorId> canBusAndMotorId)
+void DjiMotorSimHandler::registerSim(MotorSim* motorSim, can::CanBus bus, motor::MotorId motorId)
 {
-    assert(motorIDToMotorSimMap.find(canBusAndMotorId) == motorIDToMotorSimMap.end());
+    uint32_t normalizedId = DJI_MOTOR_TO_NORMALIZED_ID(motorId);
+    assert(motorSim != nullptr);
+    assert(normalizedId < DjiMotorTxHandler::DJI_MOTORS_PER_CAN);
 
-    motorIDToMotorSimMap[canBusAndMotorId] = motorSim;
+    SimSlot& slot = slots[busIndex(bus)][normalizedId];
+    assert(slot.sim == nullptr);
+
+    slot.sim = motorSim;
+    slot.neverReported = true;
+}
+
+void DjiMotorSimHandler::unregisterSim(can::CanBus bus, motor::MotorId motorId)
+{
+    uint32_t normalizedId = DJI_MOTOR_TO_NORMALIZED_ID(motorId);
+    if (normalizedId < DjiMotorTxHandler::DJI_MOTORS_PER_CAN)
+    {
+        slots[busIndex(bus)][normalizedId] = SimSlot();
+    }
 }
 
-static bool motorIDAssociatedWithCommandID(MotorId mid, uint32_t cmdId)
+MotorSim* DjiMotorSimHandler::getSim(can::CanBus bus, motor::MotorId motorId) const
 {
-    return mid < MotorId::MOTOR5 ? cmdId == DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER
-                                 : cmdId == DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER;
+    uint32_t normalizedId = DJI_MOTOR_TO_NORMALIZED_ID(motorId);
+    return normalizedId < DjiMotorTxHandler::DJI_MOTORS_PER_CAN
+               ? slots[busIndex(bus)][normalizedId].sim
+               : nullptr;
 }
 
 bool DjiMotorSimHandler::parseMotorMessage(CanBus bus, const modm::can::Message& message)
 {
+    int firstId;
+    if (message.identifier == DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER)
+    {
+        firstId = 0;
+    }
+    else if (message.identifier == DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER)
+    {
+        firstId = DjiMotorTxHandler::DJI_MOTORS_PER_CAN / 2;
+    }
+    else
+    {
+        return false;
+    }
+
     std::array<int16_t, 4> newInputs = CanSerializer::parseMessage(&message);
 
     bool found = false;
 
-    for (auto& it : motorIDToMotorSimMap)
+    for (int i = 0; i < 4; i++)
     {
-        auto canBus = std::get<0>(it.first);
-        auto mid = std::get<1>(it.first);
-        auto normalizedID = DJI_MOTOR_TO_NORMALIZED_ID(mid);
-
-        if (canBus == bus && motorIDAssociatedWithCommandID(mid, message.identifier))
+        MotorSim* sim = slots[busIndex(bus)][firstId + i].sim;
+        if (sim != nullptr)
         {
-            it.second->setMotorInput(newInputs[normalizedID % 4]);
+            sim->setMotorInput(newInputs[i]);
             found = true;
         }
     }
@@ -83,50 +117,75 @@ bool DjiMotorSimHandler::encodeMessage(CanBus bus, modm::can::Message* message)
 {
     if (message == nullptr) return false;
 
-    bool foundNext = getNextMotorId(bus);
-
-    if (!foundNext) return false;
-
-    auto id = nextMotorIdToEncode[bus];
-    auto busAndMotorID = std::tuple<can::CanBus, MotorId>(bus, id);
+    return encodePendingFeedback(bus, message, 1) == 1;
+}
 
-    assert(motorIDToMotorSimMap.find(busAndMotorID) != motorIDToMotorSimMap.end());
+int DjiMotorSimHandler::encodePendingFeedback(
+    CanBus bus,
+    modm::can::Message* messages,
+    int maxMessages)
+{
+    if (messages == nullptr) return 0;
 
-    const auto motorsim = motorIDToMotorSimMap[busAndMotorID];
+    uint32_t now = tap::arch::clock::getTimeMicroseconds();
+    int encoded = 0;
 
-    *message = CanSerializer::serializeFeedback(
-        motorsim->getEnc(),
-        motorsim->getRPM(),
-        motorsim->getInput(),
-        id);
+    for (int i = 0; i < DjiMotorTxHandler::DJI_MOTORS_PER_CAN && encoded < maxMessages; i++)
+    {
+        SimSlot& slot = slots[busIndex(bus)][i];
+        if (isFeedbackPending(slot, now))
+        {
+            encodeFeedback(slot, i, now, &messages[encoded]);
+            encoded++;
+        }
+    }
 
-    return true;
+    return encoded;
 }
 
 void DjiMotorSimHandler::updateSims()
 {
-    for (auto& it : motorIDToMotorSimMap)
+    for (auto& busSlots : slots)
     {
-        it.second->update();
+        for (auto& slot : busSlots)
+        {
+            if (slot.sim != nullptr)
+            {
+                slot.sim->update();
+            }
+        }
     }
 }
 
-bool DjiMotorSimHandler::getNextMotorId(can::CanBus bus)
+bool DjiMotorSimHandler::isFeedbackPending(const SimSlot& slot, uint32_t now)
 {
-    for (int i = 0; i < DjiMotorTxHandler::DJI_MOTORS_PER_CAN; i++)
-    {
-        auto nextId = (i + nextMotorIdToEncode[bus]) % DjiMotorTxHandler::DJI_MOTORS_PER_CAN;
-        auto djiMotorId = NORMALIZED_ID_TO_DJI_MOTOR(nextId);
-        auto key = std::tuple<can::CanBus, MotorId>(bus, djiMotorId);
+    return slot.sim != nullptr &&
+           (slot.neverReported || now - slot.lastFeedbackTime >= FEEDBACK_PERIOD);
+}
 
-        if (motorIDToMotorSimMap.find(key) != motorIDToMotorSimMap.end())
-        {
-            nextMotorIdToEncode[bus] = djiMotorId;
-            return true;
-        }
+void DjiMotorSimHandler::encodeFeedback(
+    SimSlot& slot,
+    int normalizedId,
+    uint32_t now,
+    modm::can::Message* message)
+{
+    *message = CanSerializer::serializeFeedback(
+        slot.sim->getEnc(),
+        slot.sim->getRPM(),
+        slot.sim->getInput(),
+        NORMALIZED_ID_TO_DJI_MOTOR(normalizedId));
+
+    // Keep feedback aligned to the feedback period unless the handler has fallen more than a
+    // period behind, in which case skip the missed frames like a real motor would
+    if (!slot.neverReported && now - slot.lastFeedbackTime < 2 * FEEDBACK_PERIOD)
+    {
+        slot.lastFeedbackTime += FEEDBACK_PERIOD;
     }
-
-    return false;
+    else
+    {
+        slot.lastFeedbackTime = now;
+    }
+    slot.neverReported = false;
 }
 
 }  // namespace tap::motor::motorsim
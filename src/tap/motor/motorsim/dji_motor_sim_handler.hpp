@@ -22,8 +22,7 @@
 
 #ifdef PLATFORM_HOSTED
 
-#include <map>
-#include <memory>
+#include <cstdint>
 
 #include "tap/communication/can/can_bus.hpp"
 #include "tap/motor/dji_motor_tx_handler.hpp"
@@ -32,13 +31,46 @@
 
 namespace tap::motor::motorsim
 {
+/**
+ * Connects `MotorSim` objects to the hosted CAN driver. Each sim occupies a fixed slot indexed by
+ * CAN bus and normalized motor id. Like a real DJI motor, each registered sim has a feedback frame
+ * become pending every `FEEDBACK_PERIOD` microseconds, and `encodePendingFeedback` encodes every
+ * pending frame on a bus at once.
+ */
 class DjiMotorSimHandler
 {
 public:
+    /// Number of CAN busses that sims may be registered on.
+    static constexpr int NUM_CAN_BUSSES = 2;
+
+    /// Time between feedback frames sent by each sim, in microseconds. Matches the 1 kHz feedback
+    /// rate of DJI motors.
+    static constexpr uint32_t FEEDBACK_PERIOD = 1'000;
+
+    /**
+     * @return The active handler (see `setActive`), or a handler shared by the whole process if
+     *      none is active. `tap::can::Can` sends motor commands to and receives feedback from
+     *      this handler.
+     */
     static DjiMotorSimHandler* getInstance()
     {
         static DjiMotorSimHandler* handler = new DjiMotorSimHandler;
-        return handler;
+        return activeHandler != nullptr ? activeHandler : handler;
+    }
+
+    /**
+     * Makes `handler` the handler `tap::can::Can` talks to, for example to give each robot in a
+     * multi-robot simulation its own motor sims (see `CommandScheduler::Registry`). If `nullptr`,
+     * the shared handler is used again.
+     */
+    static void setActive(DjiMotorSimHandler* handler) { activeHandler = handler; }
+
+    ~DjiMotorSimHandler()
+    {
+        if (activeHandler == this)
+        {
+            activeHandler = nullptr;
+        }
     }
 
     /**
@@ -47,14 +79,19 @@ class DjiMotorSimHandler
     void resetMotorSims();
 
     /**
-     * Registers a new MotorSim object for the given motor type
-     * that will respond at the given position on the given CAN bus.
+     * Registers a new MotorSim object that will respond at the given position on the given CAN
+     * bus. The handler does not take ownership of the sim, which must outlive the handler or be
+     * unregistered first.
      *
      * Default torque load for this function is 0 N*m.
      */
-    void registerSim(
-        std::shared_ptr<MotorSim> motorSim,
-        std::tuple<can::CanBus, motor::MotorId> canBusAndMotorId);
+    void registerSim(MotorSim* motorSim, can::CanBus bus, motor::MotorId motorId);
+
+    /// Removes the sim at the given position, if any.
+    void unregisterSim(can::CanBus bus, motor::MotorId motorId);
+
+    /// @return The sim at the given position, or `nullptr` if no sim is registered there.
+    MotorSim* getSim(can::CanBus bus, motor::MotorId motorId) const;
 
     /**
      * Allows the DjiMotorSimHandler to receive a given CAN message
@@ -64,20 +101,51 @@ class DjiMotorSimHandler
     bool parseMotorMessage(tap::can::CanBus bus, const modm::can::Message& message);
 
     /**
-     * Fills the given pointer with a new motor sim feedback message.
-     * Returns true if successful (it always should be unless no motor sims have been registers).
+     * Fills the given pointer with the feedback frame of the lowest numbered sim on the bus whose
+     * feedback is pending.
+     *
+     * @return `true` if a frame was encoded, `false` if no feedback is pending on the bus.
      */
     bool encodeMessage(tap::can::CanBus bus, modm::can::Message* message);
 
+    /**
+     * Encodes the feedback frame of every sim on the bus whose feedback is pending, in motor id
+     * order.
+     *
+     * @param[out] messages Array of at least `maxMessages` messages to fill.
+     * @param[in] maxMessages Maximum number of frames to encode. Pending frames that do not fit
+     *      remain pending.
+     *
+     * @return The number of frames encoded.
+     */
+    int encodePendingFeedback(
+        tap::can::CanBus bus,
+        modm::can::Message* messages,
+        int maxMessages);
+
     /// Updates all MotorSim objects (position, RPM, time values).
     void updateSims();
 
 private:
-    std::map<std::tuple<can::CanBus, MotorId>, std::shared_ptr<MotorSim>> motorIDToMotorSimMap;
+    static DjiMotorSimHandler* activeHandler;
+
+    struct SimSlot
+    {
+        MotorSim* sim = nullptr;
+        /// `true` until the sim's first feedback frame has been encoded.
+        bool neverReported = true;
+        /// Time at which the sim's last feedback frame was encoded, in microseconds.
+        uint32_t lastFeedbackTime = 0;
+    };
+
+    SimSlot slots[NUM_CAN_BUSSES][DjiMotorTxHandler::DJI_MOTORS_PER_CAN];
+
+    static int busIndex(can::CanBus bus) { return static_cast<int>(bus); }
 
-    std::map<can::CanBus, MotorId> nextMotorIdToEncode;
+    /// @return `true` if the given slot has a sim whose feedback frame is due at time `now`.
+    static bool isFeedbackPending(const SimSlot& slot, uint32_t now);
 
-    bool getNextMotorId(can::CanBus bus);
+    void encodeFeedback(SimSlot& slot, int normalizedId, uint32_t now, modm::can::Message* message);
 };
 }  // namespace tap::motor::motorsim
 
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "motor_sim_engine.hpp"
+
+#include <cmath>
+#include <climits>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+using namespace tap::algorithms;
+
+namespace tap::motor::motorsim
+{
+int MotorSimEngine::addMotor(const MotorParameters &parameters, float outputInertia)
+{
+    if (motorCount >= MAX_MOTORS)
+    {
+        return INVALID_MOTOR;
+    }
+
+    const int motor = motorCount++;
+    this->parameters[motor] = parameters;
+    this->outputInertia[motor] = outputInertia;
+    resetMotor(motor);
+    return motor;
+}
+
+void MotorSimEngine::reset()
+{
+    time = 0;
+
+    for (int motor = 0; motor < motorCount; motor++)
+    {
+        resetMotor(motor);
+    }
+}
+
+void MotorSimEngine::resetMotor(int motor)
+{
+    input[motor] = 0;
+    load[motor] = 0;
+    voltage[motor] = 0;
+    current[motor] = 0;
+    rotorPosition[motor] = 0;
+    rotorVelocity[motor] = 0;
+    outputPosition[motor] = 0;
+    outputVelocity[motor] = 0;
+    // a gearbox without backlash is always in contact
+    contactSide[motor] = parameters[motor].backlash <= 0 ? 1 : 0;
+}
+
+void MotorSimEngine::setInput(int motor, int16_t input)
+{
+    const int16_t maxInput = parameters[motor].maxInput;
+    this->input[motor] = limitVal<int16_t>(input, -maxInput, maxInput);
+}
+
+void MotorSimEngine::setLoad(int motor, float loadTorque) { load[motor] = loadTorque; }
+
+void MotorSimEngine::step(float dt)
+{
+    if (dt <= 0)
+    {
+        return;
+    }
+
+    for (int motor = 0; motor < motorCount; motor++)
+    {
+        stepElectrical(motor, dt);
+    }
+
+    for (int motor = 0; motor < motorCount; motor++)
+    {
+        stepMechanical(motor, dt);
+    }
+
+    time += dt;
+}
+
+void MotorSimEngine::run(float dt, int steps)
+{
+    for (int i = 0; i < steps; i++)
+    {
+        step(dt);
+    }
+}
+
+uint16_t MotorSimEngine::getEncoder(int motor) const
+{
+    double revolutions = std::fmod(rotorPosition[motor] / (2 * M_PI), 1.0);
+    if (revolutions < 0)
+    {
+        revolutions += 1;
+    }
+    return static_cast<uint16_t>(revolutions * ENC_RESOLUTION) % ENC_RESOLUTION;
+}
+
+int16_t MotorSimEngine::getRPM(int motor) const
+{
+    const float rpm = rotorVelocity[motor] * 60.0f / static_cast<float>(2 * M_PI);
+    return static_cast<int16_t>(limitVal<float>(rpm, SHRT_MIN, SHRT_MAX));
+}
+
+float MotorSimEngine::getOutputTorque(int motor) const
+{
+    return parameters[motor].kt * current[motor] * parameters[motor].gearRatio;
+}
+
+void MotorSimEngine::stepElectrical(int motor, float dt)
+{
+    const MotorParameters &p = parameters[motor];
+    const float inputFraction = static_cast<float>(input[motor]) / p.maxInput;
+    const float backEmf = p.ke * rotorVelocity[motor];
+
+    float v;
+    if (p.currentControlled)
+    {
+        // the controller applies the voltage that holds the desired current at the present speed
+        v = p.resistance * inputFraction * p.maxCurrent + backEmf;
+    }
+    else
+    {
+        v = inputFraction * p.supplyVoltage;
+    }
+    v = limitVal(v, -p.supplyVoltage, p.supplyVoltage);
+
+    // exact solution of L di/dt = v - R i - ke w over the step, holding v and w constant
+    const float steadyStateCurrent = (v - backEmf) / p.resistance;
+    const float decay = std::exp(-p.resistance * dt / p.inductance);
+    const float i = steadyStateCurrent + (current[motor] - steadyStateCurrent) * decay;
+
+    voltage[motor] = v;
+    current[motor] = limitVal(i, -p.maxCurrent, p.maxCurrent);
+}
+
+void MotorSimEngine::stepMechanical(int motor, float dt)
+{
+    // Mechanical quantities are computed in the rotor's frame, before the gearbox
+    const MotorParameters &p = parameters[motor];
+    const float n = p.gearRatio;
+    const float rotorInertia = p.rotorInertia;
+    const float reflectedInertia = outputInertia[motor] / (n * n);
+    const float reflectedLoad = load[motor] / n;
+    const float halfBacklash = p.backlash / 2 * n;
+    const bool rigid = p.backlash <= 0;
+
+    float wr = rotorVelocity[motor];
+    float wo = outputVelocity[motor] * n;
+    double thetaO = outputPosition[motor] * n;
+
+    const float motorTorque = p.kt * current[motor] - p.viscousFriction * wr;
+
+    bool together = false;
+    if (contactSide[motor] != 0)
+    {
+        // the teeth stay in contact as long as the rotor pushes on the output shaft
+        const float acceleration =
+            (motorTorque - reflectedLoad) / (rotorInertia + reflectedInertia);
+        const float contactTorque = reflectedInertia * acceleration + reflectedLoad;
+        together = rigid || contactTorque * contactSide[motor] >= 0;
+    }
+
+    if (together)
+    {
+        wr = integrateWithFriction(
+            wr,
+            motorTorque - reflectedLoad,
+            rotorInertia + reflectedInertia,
+            p.coulombFriction,
+            dt);
+        wo = wr;
+    }
+    else
+    {
+        wr = integrateWithFriction(wr, motorTorque, rotorInertia, p.coulombFriction, dt);
+        // without inertia the output shaft has nothing to carry it through the backlash
+        wo = reflectedInertia > 0 ? wo - reflectedLoad / reflectedInertia * dt : 0;
+    }
+
+    rotorPosition[motor] += wr * dt;
+    thetaO += wo * dt;
+
+    const double gap = rotorPosition[motor] - thetaO;
+
+    if (together)
+    {
+        thetaO = rotorPosition[motor] - contactSide[motor] * halfBacklash;
+    }
+    else if (gap >= halfBacklash || gap <= -halfBacklash)
+    {
+        const int8_t side = gap > 0 ? 1 : -1;
+        thetaO = rotorPosition[motor] - side * halfBacklash;
+
+        // the teeth collide inelastically, conserving momentum
+        const float w =
+            (rotorInertia * wr + reflectedInertia * wo) / (rotorInertia + reflectedInertia);
+        wr = w;
+        wo = w;
+        contactSide[motor] = side;
+    }
+    else
+    {
+        contactSide[motor] = 0;
+    }
+
+    rotorVelocity[motor] = wr;
+    outputVelocity[motor] = wo / n;
+    outputPosition[motor] = thetaO / n;
+}
+
+float MotorSimEngine::integrateWithFriction(
+    float velocity,
+    float driveTorque,
+    float inertia,
+    float coulombFriction,
+    float dt)
+{
+    if (velocity == 0 && std::fabs(driveTorque) <= coulombFriction)
+    {
+        // static friction holds the body
+        return 0;
+    }
+
+    const float frictionDirection = (velocity != 0 ? velocity : driveTorque) > 0 ? 1.0f : -1.0f;
+    const float newVelocity =
+        velocity + (driveTorque - coulombFriction * frictionDirection) / inertia * dt;
+
+    // friction brings the body to a stop rather than reversing it
+    if (velocity != 0 && (newVelocity > 0) != (velocity > 0) &&
+        std::fabs(driveTorque) <= coulombFriction)
+    {
+        return 0;
+    }
+
+    return newVelocity;
+}
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_MOTOR_SIM_ENGINE_HPP_
+#define TAPROOT_MOTOR_SIM_ENGINE_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstdint>
+
+namespace tap::motor::motorsim
+{
+/**
+ * A deterministic, fixed timestep motor physics engine that steps every simulated motor at once.
+ * Unlike `MotorSim`, which advances using the wall clock each time it is updated, the engine is
+ * advanced by an explicit `dt`, so a simulation gives the same results every time it is run and
+ * may be run faster than real time.
+ *
+ * Motor states are stored in flat arrays indexed by the id returned by `addMotor`. Each motor is
+ * modeled as follows:
+ * - Electrical: an RL circuit with back-EMF, `L di/dt = V - R i - ke w`, integrated exactly over
+ *   each step so that it is stable for any `dt`. Current controlled motors (such as an M3508 with
+ *   a C620) have their input mapped to a desired current, and the controller applies the voltage
+ *   needed to reach it, limited by the supply voltage. Voltage controlled motors (such as a
+ *   GM6020 in voltage control) have their input mapped directly to a voltage.
+ * - Mechanical: the rotor is driven by `kt i` against viscous and coulomb friction. Through a
+ *   gearbox with backlash, the rotor drives the output shaft, whose inertia and load torque are
+ *   set per motor. While the gear teeth are in contact the rotor and output shaft move together.
+ *   The teeth separate when the load would need to pull on the rotor, after which the rotor and
+ *   output shaft move independently until the backlash is taken up and the teeth collide
+ *   inelastically.
+ *
+ * All quantities are SI units unless otherwise noted. Rotor quantities are measured before the
+ * gearbox and output quantities after it.
+ */
+class MotorSimEngine
+{
+public:
+    /// Max number of motors that may be added to the engine.
+    static constexpr int MAX_MOTORS = 16;
+
+    /// Value returned by `addMotor` when the motor could not be added.
+    static constexpr int INVALID_MOTOR = -1;
+
+    /// Encoder counts per rotor revolution.
+    static constexpr uint16_t ENC_RESOLUTION = 8192;
+
+    struct MotorParameters
+    {
+        float resistance;        ///< Ohms
+        float inductance;        ///< Henries
+        float kt;                ///< Rotor torque constant, (N*m)/A
+        float ke;                ///< Rotor back-EMF constant, V/(rad/s)
+        float rotorInertia;      ///< kg*m^2
+        float viscousFriction;   ///< Rotor viscous friction, (N*m)/(rad/s)
+        float coulombFriction;   ///< Rotor coulomb friction, N*m
+        float gearRatio;         ///< Rotor revolutions per output revolution
+        float backlash;          ///< Total play of the output shaft, radians
+        float supplyVoltage;     ///< Volts
+        float maxCurrent;        ///< Amps
+        int16_t maxInput;        ///< Magnitude of the motor input that maps to the max output
+        bool currentControlled;  ///< If `true` the input maps to current, otherwise voltage
+    };
+
+    /**
+     * Approximate parameters of an M3508 with a C620 motor controller, derived from the datasheet
+     * torque and speed constants.
+     */
+    static constexpr MotorParameters M3508_PARAMETERS = {
+        .resistance = 0.194f,
+        .inductance = 0.097e-3f,
+        .kt = 0.3f / (3591.0f / 187.0f),
+        .ke = 0.0203f,
+        .rotorInertia = 1.5e-5f,
+        .viscousFriction = 1.0e-6f,
+        .coulombFriction = 1.0e-3f,
+        .gearRatio = 3591.0f / 187.0f,
+        .backlash = 0.0087f,
+        .supplyVoltage = 24,
+        .maxCurrent = 20,
+        .maxInput = 16'384,
+        .currentControlled = true,
+    };
+
+    /// Approximate parameters of a GM6020 in voltage control.
+    static constexpr MotorParameters GM6020_PARAMETERS = {
+        .resistance = 1.8f,
+        .inductance = 2.5e-3f,
+        .kt = 0.741f,
+        .ke = 0.716f,
+        .rotorInertia = 5.0e-4f,
+        .viscousFriction = 1.0e-4f,
+        .coulombFriction = 5.0e-3f,
+        .gearRatio = 1,
+        .backlash = 0,
+        .supplyVoltage = 24,
+        .maxCurrent = 3,
+        .maxInput = 30'000,
+        .currentControlled = false,
+    };
+
+    /**
+     * Adds a motor to the engine, initially at rest with its output shaft centered in the
+     * gearbox's backlash.
+     *
+     * @param[in] parameters The parameters of the motor.
+     * @param[in] outputInertia The inertia attached to the output shaft, in kg*m^2.
+     * @return The id of the motor, or `INVALID_MOTOR` if `MAX_MOTORS` have been added.
+     */
+    int addMotor(const MotorParameters &parameters, float outputInertia = 0);
+
+    /// @return The number of motors added to the engine.
+    int getMotorCount() const { return motorCount; }
+
+    /// Resets the state and inputs of every motor to their initial values.
+    void reset();
+
+    /// Sets the raw input of the motor, limited to [-maxInput, maxInput].
+    void setInput(int motor, int16_t input);
+
+    /// Sets the torque the load applies to the output shaft, opposing positive rotation.
+    void setLoad(int motor, float loadTorque);
+
+    /**
+     * Advances every motor by `dt` seconds. Does nothing if `dt` is not positive.
+     *
+     * @note Smaller timesteps give more accurate mechanical results. A timestep of 1 ms or less
+     *      is recommended.
+     */
+    void step(float dt);
+
+    /// Steps every motor `steps` times by `dt` seconds.
+    void run(float dt, int steps);
+
+    /// @return The simulated time since the engine was constructed or reset, in seconds.
+    double getTime() const { return time; }
+
+    int16_t getInput(int motor) const { return input[motor]; }
+    float getCurrent(int motor) const { return current[motor]; }
+    float getVoltage(int motor) const { return voltage[motor]; }
+    double getRotorPosition(int motor) const { return rotorPosition[motor]; }
+    float getRotorVelocity(int motor) const { return rotorVelocity[motor]; }
+    double getOutputPosition(int motor) const { return outputPosition[motor]; }
+
+    float getOutputVelocity(int motor) const { return outputVelocity[motor]; }
+
+    /// @return `true` if the gear teeth are in contact, i.e. the backlash is taken up.
+    bool isEngaged(int motor) const { return contactSide[motor] != 0; }
+
+    /// @return The rotor position as a wrapped encoder value in [0, `ENC_RESOLUTION`).
+    uint16_t getEncoder(int motor) const;
+
+    /// @return The rotor speed in RPM, as reported by DJI motor controllers.
+    int16_t getRPM(int motor) const;
+
+    /// @return The output torque, equal to `kt i` times the gear ratio.
+    float getOutputTorque(int motor) const;
+
+private:
+    int motorCount = 0;
+
+    double time = 0;
+
+    MotorParameters parameters[MAX_MOTORS] = {};
+    float outputInertia[MAX_MOTORS] = {};
+
+    int16_t input[MAX_MOTORS] = {};
+    float load[MAX_MOTORS] = {};
+
+    float voltage[MAX_MOTORS] = {};
+    float current[MAX_MOTORS] = {};
+    /// Positions are doubles so encoder resolution is kept over long simulations.
+    double rotorPosition[MAX_MOTORS] = {};
+    float rotorVelocity[MAX_MOTORS] = {};
+    double outputPosition[MAX_MOTORS] = {};
+    float outputVelocity[MAX_MOTORS] = {};
+
+    /**
+     * 1 if the rotor is in contact with the output shaft pushing it in the positive direction, -1
+     * if in the negative direction, 0 if the gearbox is within its backlash.
+     */
+    int8_t contactSide[MAX_MOTORS] = {};
+
+    void resetMotor(int motor);
+
+    void stepElectrical(int motor, float dt);
+
+    void stepMechanical(int motor, float dt);
+
+    /**
+     * @return The velocity after one step of a body with the given velocity, inertia, and drive
+     *      torque, subject to coulomb friction which holds the body at rest or slows it to a stop
+     *      without reversing it.
+     */
+    static float integrateWithFriction(
+        float velocity,
+        float driveTorque,
+        float inertia,
+        float coulombFriction,
+        float dt);
+};
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_MOTOR_SIM_ENGINE_HPP_
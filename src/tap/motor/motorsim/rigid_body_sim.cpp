@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "rigid_body_sim.hpp"
+
+#include <cmath>
+
+#include "tap/algorithms/math_user_utils.hpp"
+
+using namespace tap::algorithms;
+
+namespace tap::motor::motorsim
+{
+RigidBodySim::RigidBodySim(const MotorSimEngine &engine, const Config &config)
+    : engine(engine),
+      config(config)
+{
+}
+
+bool RigidBodySim::addActuator(int motor, Axis axis, float ratio)
+{
+    if (actuatorCount >= MAX_ACTUATORS)
+    {
+        return false;
+    }
+
+    actuatorMotor[actuatorCount] = motor;
+    actuatorAxis[actuatorCount] = axis;
+    actuatorRatio[actuatorCount] = ratio;
+    actuatorCount++;
+    return true;
+}
+
+void RigidBodySim::setExternalTorque(Axis axis, float torque) { externalTorque[axis] = torque; }
+
+void RigidBodySim::reset()
+{
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        externalTorque[axis] = 0;
+        angularVelocity[axis] = 0;
+        angularAcceleration[axis] = 0;
+    }
+    roll = 0;
+    pitch = 0;
+    yaw = 0;
+}
+
+void RigidBodySim::step(float dt)
+{
+    if (dt <= 0)
+    {
+        return;
+    }
+
+    float torque[NUM_AXES];
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        torque[axis] = externalTorque[axis];
+    }
+    for (int i = 0; i < actuatorCount; i++)
+    {
+        torque[actuatorAxis[i]] += actuatorRatio[i] * engine.getOutputTorque(actuatorMotor[i]);
+    }
+
+    const float *inertia = config.inertia;
+    const float *w = angularVelocity;
+    // w x (I w) for a body whose axes are its principal axes
+    const float gyroscopic[NUM_AXES] = {
+        (inertia[Z] - inertia[Y]) * w[Y] * w[Z],
+        (inertia[X] - inertia[Z]) * w[Z] * w[X],
+        (inertia[Y] - inertia[X]) * w[X] * w[Y],
+    };
+
+    // semi-implicit Euler: the angles are integrated with the updated angular velocity
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        angularAcceleration[axis] =
+            (torque[axis] - gyroscopic[axis] - config.damping[axis] * w[axis]) / inertia[axis];
+    }
+    for (int axis = 0; axis < NUM_AXES; axis++)
+    {
+        angularVelocity[axis] += angularAcceleration[axis] * dt;
+    }
+
+    const float sinRoll = sinf(roll);
+    const float cosRoll = cosf(roll);
+    const float cosPitch = cosf(pitch);
+    const float yawPitchRate = w[Y] * sinRoll + w[Z] * cosRoll;
+    roll += (w[X] + yawPitchRate * sinf(pitch) / cosPitch) * dt;
+    pitch += (w[Y] * cosRoll - w[Z] * sinRoll) * dt;
+    yaw += yawPitchRate / cosPitch * dt;
+}
+
+float RigidBodySim::getSpecificForce(Axis axis) const
+{
+    switch (axis)
+    {
+        case X:
+            return -ACCELERATION_GRAVITY * sinf(pitch);
+        case Y:
+            return ACCELERATION_GRAVITY * sinf(roll) * cosf(pitch);
+        case Z:
+            return ACCELERATION_GRAVITY * cosf(roll) * cosf(pitch);
+        default:
+            return 0;
+    }
+}
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
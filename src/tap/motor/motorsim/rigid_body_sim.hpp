@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_RIGID_BODY_SIM_HPP_
+#define TAPROOT_RIGID_BODY_SIM_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include "motor_sim_engine.hpp"
+
+namespace tap::motor::motorsim
+{
+/**
+ * A deterministic, fixed timestep simulation of the rotation of a rigid body driven by the motors
+ * of a `MotorSimEngine`, for example a turret driven by its yaw and pitch motors or a chassis
+ * yawed by its wheels. Feeds the simulated IMU (`ImuSim`) so that attitude control can be run in
+ * closed loop on hosted builds.
+ *
+ * The body rotates about its x (roll), y (pitch) and z (yaw) axes, which are its principal axes.
+ * Each step the output torque of every actuator, scaled by the actuator's ratio, is applied about
+ * its axis along with any external torque, and the angular velocity is integrated with
+ * `I dw/dt = tau - w x (I w) - c w`, where `c` is the body's viscous damping. The orientation is
+ * kept as ZYX (yaw, pitch, roll) Euler angles, so the pitch must stay away from +/-90 degrees.
+ * Translation isn't modeled, so the body's only specific force is the reaction to gravity.
+ *
+ * Like the engine, the body is advanced by an explicit `dt`, so it should be stepped right after
+ * the engine with the same `dt`.
+ *
+ * All quantities are SI units.
+ */
+class RigidBodySim
+{
+public:
+    /// Max number of actuators that may be added to the body.
+    static constexpr int MAX_ACTUATORS = MotorSimEngine::MAX_MOTORS;
+
+    enum Axis
+    {
+        X = 0,  ///< Roll axis
+        Y,      ///< Pitch axis
+        Z,      ///< Yaw axis
+        NUM_AXES,
+    };
+
+    struct Config
+    {
+        float inertia[NUM_AXES];  ///< Moment of inertia about each axis, kg*m^2
+        float damping[NUM_AXES];  ///< Viscous damping about each axis, (N*m)/(rad/s)
+    };
+
+    /**
+     * @param[in] engine The engine whose motors drive the body. Must outlive the body.
+     */
+    RigidBodySim(const MotorSimEngine &engine, const Config &config);
+
+    /**
+     * Makes the output torque of an engine motor turn the body about the given axis.
+     *
+     * @param[in] motor The id of the motor in the engine.
+     * @param[in] ratio The torque applied to the body per N*m of output torque. Negative if the
+     *      motor turns the body in the negative direction. For wheels, the ratio is the lever arm
+     *      of the wheel's force about the axis divided by the wheel radius.
+     * @return `false` if `MAX_ACTUATORS` have been added.
+     */
+    bool addActuator(int motor, Axis axis, float ratio);
+
+    /// Sets a torque applied about the given axis, for example by a disturbance, in N*m.
+    void setExternalTorque(Axis axis, float torque);
+
+    /// Puts the body back at rest at zero angles. Keeps its actuators.
+    void reset();
+
+    /// Advances the body by `dt` seconds. Does nothing if `dt` is not positive.
+    void step(float dt);
+
+    /// @return The angular velocity about the given body axis, in rad/s.
+    float getAngularVelocity(Axis axis) const { return angularVelocity[axis]; }
+
+    /// @return The angular acceleration about the given body axis in the last step, in rad/s^2.
+    float getAngularAcceleration(Axis axis) const { return angularAcceleration[axis]; }
+
+    /// @return The roll angle, in radians.
+    float getRoll() const { return roll; }
+
+    /// @return The pitch angle, in radians.
+    float getPitch() const { return pitch; }
+
+    /// @return The yaw angle, unwrapped, in radians.
+    float getYaw() const { return yaw; }
+
+    /**
+     * @return The specific force along the given body axis, what an accelerometer fixed to the
+     *      body reads, in m/s^2. At rest and level this is `ACCELERATION_GRAVITY` along z.
+     */
+    float getSpecificForce(Axis axis) const;
+
+private:
+    const MotorSimEngine &engine;
+    const Config config;
+
+    int actuatorCount = 0;
+    int actuatorMotor[MAX_ACTUATORS] = {};
+    Axis actuatorAxis[MAX_ACTUATORS] = {};
+    float actuatorRatio[MAX_ACTUATORS] = {};
+
+    float externalTorque[NUM_AXES] = {};
+
+    float angularVelocity[NUM_AXES] = {};
+    float angularAcceleration[NUM_AXES] = {};
+    float roll = 0;
+    float pitch = 0;
+    float yaw = 0;
+};
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_RIGID_BODY_SIM_HPP_
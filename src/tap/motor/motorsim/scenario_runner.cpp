@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "scenario_runner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+#include "can_serializer.hpp"
+
+namespace tap::motor::motorsim
+{
+ScenarioRunner::ScenarioRunner(
+    MotorSimEngine &engine,
+    Function controlLoop,
+    void *controlLoopContext,
+    const Config &config)
+    : engine(engine),
+      controlLoop(controlLoop),
+      controlLoopContext(controlLoopContext),
+      config(config)
+{
+}
+
+bool ScenarioRunner::attachMotor(DjiMotor &motor, int engineMotor)
+{
+    if (motorCount >= MAX_MOTORS)
+    {
+        return false;
+    }
+
+    motors[motorCount++] = {&motor, engineMotor};
+    return true;
+}
+
+bool ScenarioRunner::addBackend(StepFunction step, void *context)
+{
+    if (backendCount >= MAX_BACKENDS)
+    {
+        return false;
+    }
+
+    backends[backendCount++] = {step, context};
+    return true;
+}
+
+bool ScenarioRunner::addTrackingMetric(
+    const char *name,
+    Probe setpoint,
+    Probe measured,
+    const void *context,
+    float tolerance)
+{
+    if (trackingCount >= MAX_TRACKING_METRICS)
+    {
+        return false;
+    }
+
+    TrackingMetric &metric = tracking[trackingCount++];
+    metric = {};
+    metric.name = name;
+    metric.setpoint = setpoint;
+    metric.measured = measured;
+    metric.context = context;
+    metric.tolerance = tolerance;
+    return true;
+}
+
+bool ScenarioRunner::addLimitMetric(const char *name, Probe value, Probe limit, const void *context)
+{
+    if (limitCount >= MAX_LIMIT_METRICS)
+    {
+        return false;
+    }
+
+    LimitMetric &metric = limits[limitCount++];
+    metric = {};
+    metric.name = name;
+    metric.value = value;
+    metric.limit = limit;
+    metric.context = context;
+    return true;
+}
+
+void ScenarioRunner::run(const Scenario &scenario)
+{
+    this->scenario = &scenario;
+    scenarioName = scenario.name;
+    nextEvent = 0;
+    tickCount = 0;
+
+    for (int i = 0; i < trackingCount; i++)
+    {
+        TrackingMetric &metric = tracking[i];
+        metric.result = {};
+        metric.sumSquaredError = 0;
+        metric.samples = 0;
+        metric.inStep = false;
+        metric.sumSettlingTime = 0;
+    }
+    for (int i = 0; i < limitCount; i++)
+    {
+        LimitMetric &metric = limits[i];
+        metric.result = {};
+        metric.sumValue = 0;
+        metric.sumLimit = 0;
+        metric.samples = 0;
+    }
+    controlLoopTimes.clear();
+    controlLoopTotalTime = 0;
+
+    const bool virtualTimeWasEnabled = tap::arch::clock::isVirtualTimeEnabled();
+    tap::arch::clock::runAsFastAsPossible(
+        tickCallback,
+        this,
+        config.controlPeriod,
+        static_cast<uint64_t>(scenario.duration) * 1'000);
+    if (!virtualTimeWasEnabled)
+    {
+        tap::arch::clock::disableVirtualTime();
+    }
+
+    scenarioDuration = tickCount * (config.controlPeriod / 1e6f);
+    finish();
+    this->scenario = nullptr;
+}
+
+void ScenarioRunner::tickCallback(void *runner) { static_cast<ScenarioRunner *>(runner)->tick(); }
+
+void ScenarioRunner::tick()
+{
+    const uint64_t now = static_cast<uint64_t>(tickCount) * config.controlPeriod;
+    while (nextEvent < scenario->numEvents &&
+           static_cast<uint64_t>(scenario->events[nextEvent].time) * 1'000 <= now)
+    {
+        const Event &event = scenario->events[nextEvent++];
+        event.action(event.context);
+    }
+
+    // The host's time, since the clock is virtual
+    const auto start = std::chrono::steady_clock::now();
+    controlLoop(controlLoopContext);
+    const auto end = std::chrono::steady_clock::now();
+    const int64_t controlLoopTime =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    controlLoopTimes.record(static_cast<uint32_t>(std::min<int64_t>(controlLoopTime, UINT32_MAX)));
+    controlLoopTotalTime += controlLoopTime;
+
+    for (int i = 0; i < motorCount; i++)
+    {
+        engine.setInput(motors[i].engineMotor, motors[i].motor->getOutputDesired());
+    }
+
+    const float dt = config.controlPeriod / 1e6f / config.physicsSteps;
+    for (int step = 0; step < config.physicsSteps; step++)
+    {
+        engine.step(dt);
+        for (int i = 0; i < backendCount; i++)
+        {
+            backends[i].step(backends[i].context, dt);
+        }
+    }
+
+    for (int i = 0; i < motorCount; i++)
+    {
+        const int engineMotor = motors[i].engineMotor;
+        const modm::can::Message feedback = CanSerializer::serializeFeedback(
+            engine.getEncoder(engineMotor),
+            engine.getRPM(engineMotor),
+            engine.getInput(engineMotor),
+            static_cast<MotorId>(motors[i].motor->getMotorIdentifier()));
+        motors[i].motor->processMessage(feedback);
+    }
+
+    tickCount++;
+
+    const float time = tickCount * (config.controlPeriod / 1e6f);
+    for (int i = 0; i < trackingCount; i++)
+    {
+        sampleTracking(tracking[i], time);
+    }
+    for (int i = 0; i < limitCount; i++)
+    {
+        sampleLimit(limits[i]);
+    }
+}
+
+void ScenarioRunner::sampleTracking(TrackingMetric &metric, float time)
+{
+    const float setpoint = metric.setpoint(metric.context);
+    const float error = fabsf(setpoint - metric.measured(metric.context));
+
+    metric.sumSquaredError += static_cast<double>(error) * error;
+    metric.result.maxError = std::max(metric.result.maxError, error);
+    metric.samples++;
+
+    const bool startsStep = metric.samples == 1
+                                ? error > metric.tolerance
+                                : fabsf(setpoint - metric.previousSetpoint) > metric.tolerance;
+    metric.previousSetpoint = setpoint;
+
+    if (startsStep)
+    {
+        endStep(metric);
+        metric.result.steps++;
+        metric.inStep = true;
+        metric.stepStartTime = time;
+        metric.lastUnsettledTime = -1;
+    }
+
+    metric.settled = error <= metric.tolerance;
+    if (!metric.settled)
+    {
+        metric.lastUnsettledTime = time;
+    }
+}
+
+void ScenarioRunner::endStep(TrackingMetric &metric)
+{
+    if (!metric.inStep)
+    {
+        return;
+    }
+    metric.inStep = false;
+
+    if (!metric.settled)
+    {
+        metric.result.unsettledSteps++;
+        return;
+    }
+
+    // The step settled at the sample after its last one outside of the tolerance
+    const float settlingTime =
+        metric.lastUnsettledTime < 0
+            ? 0
+            : metric.lastUnsettledTime + config.controlPeriod / 1e6f - metric.stepStartTime;
+    metric.sumSettlingTime += settlingTime;
+    metric.result.maxSettlingTime = std::max(metric.result.maxSettlingTime, settlingTime);
+}
+
+void ScenarioRunner::sampleLimit(LimitMetric &metric)
+{
+    const float value = metric.value(metric.context);
+    const float limit = metric.limit(metric.context);
+
+    metric.result.max = metric.samples == 0 ? value : std::max(metric.result.max, value);
+    metric.sumValue += value;
+    metric.sumLimit += limit;
+    metric.samples++;
+
+    if (value > limit)
+    {
+        metric.result.timeOverLimit += config.controlPeriod / 1e6f;
+        metric.result.maxExcess = std::max(metric.result.maxExcess, value - limit);
+    }
+}
+
+void ScenarioRunner::finish()
+{
+    for (int i = 0; i < trackingCount; i++)
+    {
+        TrackingMetric &metric = tracking[i];
+        endStep(metric);
+
+        TrackingResult &result = metric.result;
+        if (metric.samples > 0)
+        {
+            result.rmsError = sqrt(metric.sumSquaredError / metric.samples);
+        }
+        const int settledSteps = result.steps - result.unsettledSteps;
+        if (settledSteps > 0)
+        {
+            result.meanSettlingTime = metric.sumSettlingTime / settledSteps;
+        }
+    }
+
+    for (int i = 0; i < limitCount; i++)
+    {
+        LimitMetric &metric = limits[i];
+        if (metric.samples > 0)
+        {
+            metric.result.mean = metric.sumValue / metric.samples;
+            metric.result.meanLimit = metric.sumLimit / metric.samples;
+        }
+    }
+
+    controlLoopResult = {};
+    controlLoopResult.calls = controlLoopTimes.getCount();
+    if (controlLoopResult.calls > 0)
+    {
+        const tap::arch::LatencyHistogram::Summary summary = controlLoopTimes.getSummary();
+        controlLoopResult.mean = controlLoopTotalTime / controlLoopResult.calls / 1'000;
+        controlLoopResult.p50 = summary.p50 / 1'000.0f;
+        controlLoopResult.p99 = summary.p99 / 1'000.0f;
+        controlLoopResult.max = summary.max / 1'000.0f;
+    }
+}
+
+void ScenarioRunner::printJson(modm::IOStream &outputStream) const
+{
+    outputStream.printf(
+        "{\"scenario\": \"%s\", \"duration\": %.3f,\n",
+        scenarioName,
+        static_cast<double>(scenarioDuration));
+    outputStream.printf(
+        " \"controlLoop\": {\"calls\": %lu, \"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f, "
+        "\"max\": %.3f},\n",
+        static_cast<unsigned long>(controlLoopResult.calls),
+        static_cast<double>(controlLoopResult.mean),
+        static_cast<double>(controlLoopResult.p50),
+        static_cast<double>(controlLoopResult.p99),
+        static_cast<double>(controlLoopResult.max));
+
+    outputStream << " \"tracking\": {";
+    for (int i = 0; i < trackingCount; i++)
+    {
+        const TrackingResult &result = tracking[i].result;
+        outputStream.printf(
+            "%s\n  \"%s\": {\"rmsError\": %.6f, \"maxError\": %.6f, \"steps\": %d, "
+            "\"unsettledSteps\": %d, \"meanSettlingTime\": %.6f, \"maxSettlingTime\": %.6f}",
+            i == 0 ? "" : ",",
+            tracking[i].name,
+            static_cast<double>(result.rmsError),
+            static_cast<double>(result.maxError),
+            result.steps,
+            result.unsettledSteps,
+            static_cast<double>(result.meanSettlingTime),
+            static_cast<double>(result.maxSettlingTime));
+    }
+    outputStream << "},\n";
+
+    outputStream << " \"limits\": {";
+    for (int i = 0; i < limitCount; i++)
+    {
+        const LimitResult &result = limits[i].result;
+        outputStream.printf(
+            "%s\n  \"%s\": {\"mean\": %.6f, \"max\": %.6f, \"meanLimit\": %.6f, "
+            "\"timeOverLimit\": %.6f, \"maxExcess\": %.6f}",
+            i == 0 ? "" : ",",
+            limits[i].name,
+            static_cast<double>(result.mean),
+            static_cast<double>(result.max),
+            static_cast<double>(result.meanLimit),
+            static_cast<double>(result.timeOverLimit),
+            static_cast<double>(result.maxExcess));
+    }
+    outputStream << "}}" << modm::endl;
+}
+
+void ScenarioRunner::printCsv(modm::IOStream &outputStream, bool header) const
+{
+    if (header)
+    {
+        outputStream << "scenario,metric,field,value" << modm::endl;
+    }
+
+    auto printRow = [&](const char *metric, const char *field, float value) {
+        outputStream.printf(
+            "%s,%s,%s,%.6f\n",
+            scenarioName,
+            metric,
+            field,
+            static_cast<double>(value));
+    };
+
+    printRow("controlLoop", "calls", controlLoopResult.calls);
+    printRow("controlLoop", "mean", controlLoopResult.mean);
+    printRow("controlLoop", "p50", controlLoopResult.p50);
+    printRow("controlLoop", "p99", controlLoopResult.p99);
+    printRow("controlLoop", "max", controlLoopResult.max);
+
+    for (int i = 0; i < trackingCount; i++)
+    {
+        const TrackingResult &result = tracking[i].result;
+        printRow(tracking[i].name, "rmsError", result.rmsError);
+        printRow(tracking[i].name, "maxError", result.maxError);
+        printRow(tracking[i].name, "steps", result.steps);
+        printRow(tracking[i].name, "unsettledSteps", result.unsettledSteps);
+        printRow(tracking[i].name, "meanSettlingTime", result.meanSettlingTime);
+        printRow(tracking[i].name, "maxSettlingTime", result.maxSettlingTime);
+    }
+
+    for (int i = 0; i < limitCount; i++)
+    {
+        const LimitResult &result = limits[i].result;
+        printRow(limits[i].name, "mean", result.mean);
+        printRow(limits[i].name, "max", result.max);
+        printRow(limits[i].name, "meanLimit", result.meanLimit);
+        printRow(limits[i].name, "timeOverLimit", result.timeOverLimit);
+        printRow(limits[i].name, "maxExcess", result.maxExcess);
+    }
+}
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SCENARIO_RUNNER_HPP_
+#define TAPROOT_SCENARIO_RUNNER_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <cstdint>
+
+#include "tap/architecture/latency_histogram.hpp"
+
+#include "modm/io/iostream.hpp"
+
+#include "motor_sim_engine.hpp"
+
+namespace tap::motor
+{
+class DjiMotor;
+}
+
+namespace tap::motor::motorsim
+{
+/**
+ * Runs scripted match scenarios through a robot's control loop in closed loop with a
+ * `MotorSimEngine` and the sims stepped with it (`RigidBodySim`, `ImuSim`, `RefSerialSim`), and
+ * measures how well the robot was controlled and how long its control loop took. The report of
+ * each scenario can be printed as JSON or CSV, so that taproot versions can be compared on both
+ * control quality and compute cost (see `tools/scenario_report_compare.py`).
+ *
+ * Each control period the runner:
+ * 1. Calls the actions of the scenario's events that are due.
+ * 2. Calls the control loop, typically one iteration of the robot's main loop running the
+ *    `Drivers` (command scheduler, ref serial, IMU, motor tx handler, etc.), and records how long
+ *    it took on the host.
+ * 3. Sets the input of each attached engine motor to its `DjiMotor`'s desired output and steps
+ *    the engine and the backends `physicsSteps` times.
+ * 4. Passes each attached motor a feedback frame encoded from its engine motor, which the
+ *    `DjiMotor` decodes as if it were received over CAN.
+ * 5. Samples the metrics.
+ *
+ * Time is virtual (see `tap::arch::clock::runAsFastAsPossible`), so a scenario gives the same
+ * control results every time it is run, and runs as fast as the host can execute it. Only the
+ * control loop times depend on the host, so compare them between versions on the same machine.
+ *
+ * ```cpp
+ * ScenarioRunner runner(engine, mainLoop, &drivers);
+ * runner.attachMotor(yawMotor, yawEngineMotor);
+ * runner.addBackend(stepBody, &body);
+ * runner.addTrackingMetric("yaw", getYawSetpoint, getYaw, &robot, 0.02f);
+ * runner.addLimitMetric("chassis power", getChassisPower, getPowerLimit, &refSim);
+ *
+ * static const ScenarioRunner::Event events[] = {
+ *     {1'000, setYawSetpoint90, &robot},
+ *     {3'000, startSpinning, &robot},
+ * };
+ * runner.run({"spin", 5'000, events, 2});
+ * runner.printJson(stream);
+ * ```
+ */
+class ScenarioRunner
+{
+public:
+    static constexpr int MAX_MOTORS = MotorSimEngine::MAX_MOTORS;
+    static constexpr int MAX_BACKENDS = 8;
+    static constexpr int MAX_TRACKING_METRICS = 8;
+    static constexpr int MAX_LIMIT_METRICS = 8;
+
+    using Function = void (*)(void *context);
+
+    /// Steps a sim by `dt` seconds.
+    using StepFunction = void (*)(void *context, float dt);
+
+    /// @return A value a metric is computed from, such as a setpoint or a measurement.
+    using Probe = float (*)(const void *context);
+
+    struct Config
+    {
+        uint32_t controlPeriod;  ///< Time between calls of the control loop, microseconds
+        int physicsSteps;        ///< Number of engine and backend steps per control period
+    };
+
+    /// A 1 kHz control loop with the engine stepped once per period.
+    static constexpr Config DEFAULT_CONFIG = {
+        .controlPeriod = 1'000,
+        .physicsSteps = 1,
+    };
+
+    /// An action scripted to happen during a scenario, e.g. changing a setpoint or remote input.
+    struct Event
+    {
+        uint32_t time;  ///< Time since the scenario started, milliseconds
+        Function action;
+        void *context;
+    };
+
+    struct Scenario
+    {
+        const char *name;
+        uint32_t duration;  ///< Milliseconds
+        /// Events of the scenario, sorted by time. Each is called at the first control period at
+        /// or after its time.
+        const Event *events;
+        int numEvents;
+    };
+
+    /**
+     * How closely a measurement followed its setpoint. A change of the setpoint by more than the
+     * tolerance starts a step, as does the start of the scenario if the error starts outside of
+     * the tolerance. A step settles once the error stays within the tolerance until the next
+     * step or the end of the scenario.
+     */
+    struct TrackingResult
+    {
+        float rmsError = 0;
+        float maxError = 0;  ///< Largest magnitude of the error
+        int steps = 0;
+        int unsettledSteps = 0;
+        float meanSettlingTime = 0;  ///< Of the steps that settled, seconds
+        float maxSettlingTime = 0;   ///< Of the steps that settled, seconds
+    };
+
+    /// How a value, such as the chassis power, compared to its limit.
+    struct LimitResult
+    {
+        float mean = 0;
+        float max = 0;
+        float meanLimit = 0;
+        float timeOverLimit = 0;  ///< Seconds
+        float maxExcess = 0;      ///< Largest amount the value was over its limit by, or 0
+    };
+
+    /// Host time taken by each call of the control loop, microseconds.
+    struct ControlLoopResult
+    {
+        uint32_t calls = 0;
+        float mean = 0;
+        float p50 = 0;
+        float p99 = 0;
+        float max = 0;
+    };
+
+    /**
+     * @param[in] engine The engine the attached motors are simulated by. Must outlive the runner.
+     * @param[in] controlLoop Called each control period with `controlLoopContext`.
+     */
+    ScenarioRunner(
+        MotorSimEngine &engine,
+        Function controlLoop,
+        void *controlLoopContext,
+        const Config &config = DEFAULT_CONFIG);
+
+    /**
+     * Simulates `motor` with the engine motor `engineMotor`. The motor must outlive the runner.
+     *
+     * @return `false` if `MAX_MOTORS` have been attached.
+     */
+    bool attachMotor(DjiMotor &motor, int engineMotor);
+
+    /**
+     * Adds a sim that is stepped right after the engine with the same `dt`, such as a
+     * `RigidBodySim` or `RefSerialSim`. Backends are stepped in the order they are added.
+     *
+     * @return `false` if `MAX_BACKENDS` have been added.
+     */
+    bool addBackend(StepFunction step, void *context);
+
+    /**
+     * Measures how closely `measured` follows `setpoint`, see `TrackingResult`. The name must
+     * outlive the runner, and is printed as is, so it shouldn't contain `"`, `\` or `,`.
+     *
+     * @param[in] tolerance The largest error magnitude at which the measurement is settled.
+     * @return `false` if `MAX_TRACKING_METRICS` have been added.
+     */
+    bool addTrackingMetric(
+        const char *name,
+        Probe setpoint,
+        Probe measured,
+        const void *context,
+        float tolerance);
+
+    /**
+     * Measures how `value` compares to `limit`, see `LimitResult`. Like tracking metric names,
+     * the name must outlive the runner and shouldn't contain `"`, `\` or `,`.
+     *
+     * @return `false` if `MAX_LIMIT_METRICS` have been added.
+     */
+    bool addLimitMetric(const char *name, Probe value, Probe limit, const void *context);
+
+    /**
+     * Runs the scenario, replacing the results of the previous run. Doesn't reset the engine,
+     * the backends or the robot, so reset them between scenarios. Virtual time is enabled for the
+     * run, and disabled after it if it wasn't enabled before.
+     */
+    void run(const Scenario &scenario);
+
+    const TrackingResult &getTrackingResult(int metric) const { return tracking[metric].result; }
+
+    const LimitResult &getLimitResult(int metric) const { return limits[metric].result; }
+
+    const ControlLoopResult &getControlLoopResult() const { return controlLoopResult; }
+
+    /**
+     * Prints the report of the last run as a JSON object. Times are in seconds, except for the
+     * control loop times, which are in microseconds like `ControlLoopResult`.
+     */
+    void printJson(modm::IOStream &outputStream) const;
+
+    /**
+     * Prints the report of the last run as CSV rows of `scenario,metric,field,value`, after a
+     * header row if `header` is `true`. The rows of several scenarios can be printed into the
+     * same table.
+     */
+    void printCsv(modm::IOStream &outputStream, bool header = true) const;
+
+private:
+    struct AttachedMotor
+    {
+        DjiMotor *motor;
+        int engineMotor;
+    };
+
+    struct Backend
+    {
+        StepFunction step;
+        void *context;
+    };
+
+    struct TrackingMetric
+    {
+        const char *name;
+        Probe setpoint;
+        Probe measured;
+        const void *context;
+        float tolerance;
+
+        TrackingResult result;
+        double sumSquaredError;
+        int samples;
+        float previousSetpoint;
+        bool inStep;
+        /// `true` if the error was within the tolerance at the last sample.
+        bool settled;
+        /// Time the current step started, seconds.
+        float stepStartTime;
+        /// Time of the step's last sample outside of the tolerance, or negative if none, seconds.
+        float lastUnsettledTime;
+        double sumSettlingTime;
+    };
+
+    struct LimitMetric
+    {
+        const char *name;
+        Probe value;
+        Probe limit;
+        const void *context;
+
+        LimitResult result;
+        double sumValue;
+        double sumLimit;
+        int samples;
+    };
+
+    MotorSimEngine &engine;
+    const Function controlLoop;
+    void *const controlLoopContext;
+    const Config config;
+
+    AttachedMotor motors[MAX_MOTORS] = {};
+    int motorCount = 0;
+
+    Backend backends[MAX_BACKENDS] = {};
+    int backendCount = 0;
+
+    TrackingMetric tracking[MAX_TRACKING_METRICS] = {};
+    int trackingCount = 0;
+
+    LimitMetric limits[MAX_LIMIT_METRICS] = {};
+    int limitCount = 0;
+
+    const Scenario *scenario = nullptr;
+    const char *scenarioName = "";
+    float scenarioDuration = 0;
+    int nextEvent = 0;
+    uint32_t tickCount = 0;
+
+    /// Control loop times, nanoseconds.
+    tap::arch::LatencyHistogram controlLoopTimes;
+    double controlLoopTotalTime = 0;
+    ControlLoopResult controlLoopResult;
+
+    static void tickCallback(void *runner);
+
+    void tick();
+
+    void sampleTracking(TrackingMetric &metric, float time);
+
+    /// Ends the metric's step in progress, if any.
+    void endStep(TrackingMetric &metric);
+
+    void sampleLimit(LimitMetric &metric);
+
+    /// Computes the results from the samples once the scenario is over.
+    void finish();
+};
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_SCENARIO_RUNNER_HPP_
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_HOSTED
+
+#include "shared_memory_link.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "tap/architecture/clock.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+namespace tap::motor::motorsim
+{
+SharedMemoryLink *SharedMemoryLink::activeLink = nullptr;
+
+SharedMemoryLink::SharedMemoryLink(const char *name, Role role) : role(role)
+{
+    snprintf(this->name, sizeof(this->name), "%s", name);
+#ifdef __linux__
+    const bool create = role == Role::FIRMWARE;
+    int fd = create ? shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0600) : shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        perror("SharedMemoryLink failed to open shared memory");
+        throw std::runtime_error("SharedMemoryOpenError");
+    }
+    if (create && ftruncate(fd, sizeof(SimSharedMemory)) != 0)
+    {
+        perror("SharedMemoryLink failed to size shared memory");
+        close(fd);
+        shm_unlink(name);
+        throw std::runtime_error("SharedMemorySizeError");
+    }
+
+    void *address =
+        mmap(nullptr, sizeof(SimSharedMemory), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping stays valid once the descriptor is closed
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        perror("SharedMemoryLink failed to map shared memory");
+        if (create)
+        {
+            shm_unlink(name);
+        }
+        throw std::runtime_error("SharedMemoryMapError");
+    }
+
+    if (create)
+    {
+        // The new object is zero filled, construct the layout and mark it ready last
+        memory = new (address) SimSharedMemory();
+        memory->version = SimSharedMemory::VERSION;
+        std::atomic_thread_fence(std::memory_order_release);
+        memory->magic = SimSharedMemory::MAGIC;
+    }
+    else
+    {
+        memory = static_cast<SimSharedMemory *>(address);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (memory->magic != SimSharedMemory::MAGIC ||
+            memory->version != SimSharedMemory::VERSION)
+        {
+            munmap(address, sizeof(SimSharedMemory));
+            memory = nullptr;
+            throw std::runtime_error("SharedMemoryVersionError");
+        }
+    }
+#else
+    throw std::runtime_error("SharedMemoryLink is only available on Linux");
+#endif  // __linux__
+}
+
+SharedMemoryLink::~SharedMemoryLink()
+{
+    if (activeLink == this)
+    {
+        activeLink = nullptr;
+    }
+#ifdef __linux__
+    if (memory != nullptr)
+    {
+        munmap(memory, sizeof(SimSharedMemory));
+        if (role == Role::FIRMWARE)
+        {
+            shm_unlink(name);
+        }
+    }
+#endif  // __linux__
+}
+
+bool SharedMemoryLink::sendCan(can::CanBus bus, const modm::can::Message &message)
+{
+    SimCanFrame frame = {};
+    frame.identifier = message.getIdentifier();
+    frame.length = message.getLength();
+    frame.extended = message.isExtended() ? 1 : 0;
+    memcpy(frame.data, message.data, sizeof(frame.data));
+    return txRing(bus).push(frame);
+}
+
+bool SharedMemoryLink::receiveCan(can::CanBus bus, modm::can::Message &message)
+{
+    SimCanFrame frame;
+    if (!rxRing(bus).pop(frame))
+    {
+        return false;
+    }
+    message.setIdentifier(frame.identifier);
+    message.setLength(frame.length <= sizeof(frame.data) ? frame.length : sizeof(frame.data));
+    message.setExtended(frame.extended != 0);
+    memcpy(message.data, frame.data, sizeof(frame.data));
+    return true;
+}
+
+bool SharedMemoryLink::sendSensor(const SimSensorFrame &frame)
+{
+    return memory->sensorsFromSim.push(frame);
+}
+
+bool SharedMemoryLink::receiveSensor(SimSensorFrame &frame)
+{
+    return memory->sensorsFromSim.pop(frame);
+}
+
+/// Spins until `condition` holds or `timeoutMs` of real time passes.
+template <typename Condition>
+static bool waitFor(Condition condition, uint32_t timeoutMs)
+{
+    // Virtual time doesn't move while waiting, so time out on the steady clock
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+bool SharedMemoryLink::waitForSimulator(uint32_t timeoutMs)
+{
+    const uint64_t firmwareTime = memory->firmwareTime.load(std::memory_order_relaxed);
+    uint64_t simTime = 0;
+    bool stepped = waitFor(
+        [&]() {
+            simTime = memory->simTime.load(std::memory_order_acquire);
+            return simTime > firmwareTime;
+        },
+        timeoutMs);
+
+    if (stepped && arch::clock::isVirtualTimeEnabled())
+    {
+        // advance takes at most UINT32_MAX us at a time
+        uint64_t now;
+        while ((now = arch::clock::getVirtualTimeMicroseconds()) < simTime)
+        {
+            arch::clock::advance(std::min<uint64_t>(simTime - now, UINT32_MAX));
+        }
+    }
+    return stepped;
+}
+
+void SharedMemoryLink::finishStep()
+{
+    memory->firmwareTime.store(
+        memory->simTime.load(std::memory_order_acquire),
+        std::memory_order_release);
+}
+
+void SharedMemoryLink::publishStep(uint64_t time)
+{
+    memory->simTime.store(time, std::memory_order_release);
+}
+
+bool SharedMemoryLink::waitForFirmware(uint32_t timeoutMs)
+{
+    const uint64_t simTime = memory->simTime.load(std::memory_order_relaxed);
+    return waitFor(
+        [&]() { return memory->firmwareTime.load(std::memory_order_acquire) >= simTime; },
+        timeoutMs);
+}
+
+ShmRing<SimCanFrame, SimSharedMemory::CAN_RING_SIZE> &SharedMemoryLink::txRing(can::CanBus bus)
+{
+    const int i = bus == can::CanBus::CAN_BUS1 ? 0 : 1;
+    return role == Role::FIRMWARE ? memory->canToSim[i] : memory->canFromSim[i];
+}
+
+ShmRing<SimCanFrame, SimSharedMemory::CAN_RING_SIZE> &SharedMemoryLink::rxRing(can::CanBus bus)
+{
+    const int i = bus == can::CanBus::CAN_BUS1 ? 0 : 1;
+    return role == Role::FIRMWARE ? memory->canFromSim[i] : memory->canToSim[i];
+}
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SHARED_MEMORY_LINK_HPP_
+#define TAPROOT_SHARED_MEMORY_LINK_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "tap/communication/can/can_bus.hpp"
+#include "tap/util_macros.hpp"
+
+#include "shm_ring.hpp"
+
+namespace modm::can
+{
+class Message;
+}
+
+namespace tap::motor::motorsim
+{
+/// A CAN frame as stored in shared memory.
+struct SimCanFrame
+{
+    uint32_t identifier;
+    uint8_t length;
+    /// 1 if the identifier is 29 bits long.
+    uint8_t extended;
+    uint8_t reserved[2];
+    uint8_t data[8];
+};
+
+/// A sensor reading sent by the simulator, interpreted according to `sensorId`.
+struct SimSensorFrame
+{
+    uint32_t sensorId;
+    uint32_t reserved;
+    /// Simulation time of the reading, in microseconds.
+    uint64_t time;
+    float values[12];
+};
+
+/**
+ * The layout of the shared memory object. An external simulator that isn't written in C++ must
+ * match it, so fields are only ever appended, and any other change increments `VERSION`.
+ */
+struct SimSharedMemory
+{
+    static constexpr uint32_t MAGIC = 0x53504154;  // "TAPS"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t CAN_RING_SIZE = 256;
+    static constexpr uint32_t SENSOR_RING_SIZE = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    /// Simulation time the simulator has stepped to and published data for, in microseconds.
+    alignas(64) std::atomic<uint64_t> simTime;
+    /// Simulation time the firmware has finished processing, in microseconds.
+    alignas(64) std::atomic<uint64_t> firmwareTime;
+    ShmRing<SimCanFrame, CAN_RING_SIZE> canToSim[2];
+    ShmRing<SimCanFrame, CAN_RING_SIZE> canFromSim[2];
+    ShmRing<SimSensorFrame, SENSOR_RING_SIZE> sensorsFromSim;
+};
+
+/**
+ * Exchanges CAN frames and sensor readings between the hosted firmware and an external physics
+ * simulator through POSIX shared memory, in place of `DjiMotorSimHandler`. Each direction of
+ * each CAN bus is a lock free ring, so an exchange costs a copy rather than a system call. CAN
+ * frames are the same frames a real robot sends, so the simulator decodes motor commands and
+ * encodes motor feedback the way `CanSerializer` does.
+ *
+ * The two sides run in lockstep on simulation time, so the firmware runs as fast as the
+ * simulator can step, with virtual time (see `tap::arch::clock::enableVirtualTime`) following
+ * the simulator:
+ *
+ * ```cpp
+ * // Firmware
+ * SharedMemoryLink link("/taproot-sim", SharedMemoryLink::Role::FIRMWARE);
+ * SharedMemoryLink::setActive(&link);  // Routes tap::can::Can through the link
+ * tap::arch::clock::enableVirtualTime();
+ * while (link.waitForSimulator(1'000))
+ * {
+ *     mainLoop();
+ *     link.finishStep();
+ * }
+ *
+ * // Simulator, each step
+ * link.publishStep(time);  // After pushing the CAN frames and sensor readings for `time`
+ * link.waitForFirmware(1'000);
+ * // Pop the CAN frames the firmware sent, then step the physics to the next time
+ * ```
+ *
+ * Only available on Linux.
+ */
+class SharedMemoryLink
+{
+public:
+    enum class Role
+    {
+        /// Creates the shared memory object, and removes it when destroyed.
+        FIRMWARE,
+        /// Opens the shared memory object created by the firmware.
+        SIMULATOR,
+    };
+
+    /**
+     * Creates or opens the shared memory object.
+     *
+     * @param[in] name The name of the object, starting with '/', see `shm_open`.
+     * @throws std::runtime_error If the object can't be created or opened, or was created by an
+     *      incompatible version.
+     */
+    SharedMemoryLink(const char *name, Role role);
+    DISALLOW_COPY_AND_ASSIGN(SharedMemoryLink)
+    ~SharedMemoryLink();
+
+    /// Sets the link `tap::can::Can` sends and receives frames through, or `nullptr` for none.
+    static void setActive(SharedMemoryLink *link) { activeLink = link; }
+
+    static SharedMemoryLink *getActive() { return activeLink; }
+
+    /// Sends a frame to the other side. @return `false` if its ring is full.
+    bool sendCan(can::CanBus bus, const modm::can::Message &message);
+
+    /// Receives a frame from the other side. @return `false` if there is none.
+    bool receiveCan(can::CanBus bus, modm::can::Message &message);
+
+    /// Sends a sensor reading to the firmware. Only for the simulator.
+    bool sendSensor(const SimSensorFrame &frame);
+
+    /// Receives a sensor reading from the simulator. Only for the firmware.
+    bool receiveSensor(SimSensorFrame &frame);
+
+    /**
+     * Waits until the simulator publishes a step after the last one the firmware finished, then
+     * advances virtual time to the step's time. Only for the firmware.
+     *
+     * @param[in] timeoutMs How long to wait, in milliseconds of real time.
+     * @return `false` if the simulator didn't publish a step in time.
+     */
+    bool waitForSimulator(uint32_t timeoutMs);
+
+    /// Tells the simulator the firmware has finished the step. Only for the firmware.
+    void finishStep();
+
+    /// Tells the firmware data for the step at `time` is ready. Only for the simulator.
+    void publishStep(uint64_t time);
+
+    /**
+     * Waits until the firmware finishes the last published step. Only for the simulator.
+     *
+     * @param[in] timeoutMs How long to wait, in milliseconds of real time.
+     * @return `false` if the firmware didn't finish the step in time.
+     */
+    bool waitForFirmware(uint32_t timeoutMs);
+
+private:
+    static SharedMemoryLink *activeLink;
+
+    const Role role;
+    char name[64];
+    SimSharedMemory *memory = nullptr;
+
+    /// The ring frames this side sends on the given bus.
+    ShmRing<SimCanFrame, SimSharedMemory::CAN_RING_SIZE> &txRing(can::CanBus bus);
+
+    /// The ring frames this side receives on the given bus.
+    ShmRing<SimCanFrame, SimSharedMemory::CAN_RING_SIZE> &rxRing(can::CanBus bus);
+};
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_SHARED_MEMORY_LINK_HPP_
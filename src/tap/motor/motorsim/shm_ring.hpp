@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_SHM_RING_HPP_
+#define TAPROOT_SHM_RING_HPP_
+
+#ifdef PLATFORM_HOSTED
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace tap::motor::motorsim
+{
+/**
+ * A single producer, single consumer queue of up to `N` items that may be placed in memory
+ * shared between two processes, one pushing and the other popping, without any locks or system
+ * calls. A value initialized ring is empty.
+ *
+ * @tparam T The item type. Copied with plain assignment, so must be trivially copyable.
+ * @tparam N The capacity. Must be a power of two.
+ */
+template <typename T, uint32_t N>
+class ShmRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(
+        std::atomic<uint32_t>::is_always_lock_free,
+        "lock free atomics are required to share a ring between processes");
+
+public:
+    /// @return `false` if the ring is full, in which case `item` is not pushed.
+    bool push(const T &item)
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        items[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @return `false` if the ring is empty, in which case `item` is unchanged.
+    bool pop(T &item)
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+private:
+    // On separate cache lines, since each is written by a different process
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    T items[N];
+};
+}  // namespace tap::motor::motorsim
+
+#endif  // PLATFORM_HOSTED
+
+#endif  // TAPROOT_SHM_RING_HPP_
@@ -57,12 +57,23 @@ void Servo::setTargetPwm(float pwm)
 }
 
 void Servo::updateSendPwmRamp()
+{
+    updatePwmRamp();
+    drivers->pwm.write(currentPwm, servoPin);
+}
+
+void Servo::updateStagePwmRamp()
+{
+    updatePwmRamp();
+    drivers->pwm.stage(currentPwm, servoPin);
+}
+
+void Servo::updatePwmRamp()
 {
     uint32_t currTime = tap::arch::clock::getTimeMilliseconds();
     pwmOutputRamp.update(pwmRampSpeed * (currTime - prevTime));
     prevTime = currTime;
     currentPwm = pwmOutputRamp.getValue();
-    drivers->pwm.write(pwmOutputRamp.getValue(), servoPin);
 }
 
 float Servo::getPWM() const { return currentPwm; }
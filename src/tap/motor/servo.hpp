@@ -69,6 +69,13 @@ class Servo
      */
     void updateSendPwmRamp();
 
+    /**
+     * Like `updateSendPwmRamp`, but stages the output PWM with `Pwm::stage` rather than writing
+     * it, so that it changes together with the other staged outputs on the next `Pwm::commit`.
+     * Use this to move multiple servos in sync.
+     */
+    void updateStagePwmRamp();
+
     /**
      * @return The current PWM output to the servo.
      */
@@ -113,6 +120,9 @@ class Servo
 
     /// The PWM pin that the servo is attached to.
     tap::gpio::Pwm::Pin servoPin;
+
+    /// Updates `pwmOutputRamp` and `currentPwm`.
+    void updatePwmRamp();
 };  // class Servo
 
 }  // namespace motor
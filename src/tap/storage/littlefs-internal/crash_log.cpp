@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "crash_log.hpp"
+
+#include <cstdio>
+
+using tap::errors::CrashRecord;
+
+namespace tap::storage
+{
+bool CrashLog::store(CrashRecord &record)
+{
+    if (!record.isValid())
+    {
+        return false;
+    }
+
+    Slot slots[MAX_RECORDS];
+    int numRecords = findRecords(slots);
+
+    // Use a free slot if there is one, otherwise replace the oldest record
+    int index = 0;
+    if (numRecords < MAX_RECORDS)
+    {
+        bool used[MAX_RECORDS] = {};
+        for (int i = 0; i < numRecords; i++)
+        {
+            used[slots[i].index] = true;
+        }
+        while (used[index])
+        {
+            index++;
+        }
+    }
+    else
+    {
+        index = slots[numRecords - 1].index;
+    }
+
+    record.sequence = numRecords > 0 ? slots[0].sequence + 1 : 0;
+    record.seal();
+
+    char path[8];
+    getSlotPath(index, path);
+    if (!fs.writeFile(path, &record, sizeof(CrashRecord)))
+    {
+        return false;
+    }
+    record.invalidate();
+    return true;
+}
+
+int CrashLog::getNumRecords()
+{
+    Slot slots[MAX_RECORDS];
+    return findRecords(slots);
+}
+
+bool CrashLog::readRecord(int index, CrashRecord &record)
+{
+    Slot slots[MAX_RECORDS];
+    if (index < 0 || index >= findRecords(slots))
+    {
+        return false;
+    }
+
+    char path[8];
+    getSlotPath(slots[index].index, path);
+    return fs.readFile(path, &record, sizeof(CrashRecord)) && record.isValid();
+}
+
+void CrashLog::clear()
+{
+    if (!fs.mount())
+    {
+        return;
+    }
+
+    char path[8];
+    for (int i = 0; i < MAX_RECORDS; i++)
+    {
+        getSlotPath(i, path);
+        lfs_remove(fs.getFS(), path);
+    }
+}
+
+void CrashLog::print(modm::IOStream &outputStream)
+{
+    Slot slots[MAX_RECORDS];
+    int numRecords = findRecords(slots);
+    if (numRecords == 0)
+    {
+        outputStream << "no crashes recorded" << modm::endl;
+        return;
+    }
+
+    char path[8];
+    for (int i = 0; i < numRecords; i++)
+    {
+        getSlotPath(slots[i].index, path);
+        if (fs.readFile(path, &scratch, sizeof(CrashRecord)) && scratch.isValid())
+        {
+            scratch.print(outputStream);
+        }
+    }
+}
+
+int CrashLog::findRecords(Slot (&slots)[MAX_RECORDS])
+{
+    int numRecords = 0;
+    char path[8];
+    for (int i = 0; i < MAX_RECORDS; i++)
+    {
+        getSlotPath(i, path);
+        if (!fs.readFile(path, &scratch, sizeof(CrashRecord)) || !scratch.isValid())
+        {
+            continue;
+        }
+
+        // Insertion sort, most recent first
+        int j = numRecords++;
+        while (j > 0 && slots[j - 1].sequence < scratch.sequence)
+        {
+            slots[j] = slots[j - 1];
+            j--;
+        }
+        slots[j] = {i, scratch.sequence};
+    }
+    return numRecords;
+}
+
+void CrashLog::getSlotPath(int index, char (&path)[8])
+{
+    snprintf(path, sizeof(path), "crash%d", index);
+}
+}  // namespace tap::storage
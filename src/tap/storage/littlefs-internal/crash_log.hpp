@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_CRASH_LOG_HPP_
+#define TAPROOT_CRASH_LOG_HPP_
+
+#include <cstdint>
+
+#include "tap/errors/crash_recorder.hpp"
+#include "tap/util_macros.hpp"
+
+#include "modm/io/iostream.hpp"
+
+#include "littlefs_internal.hpp"
+
+namespace tap::storage
+{
+/**
+ * Stores the `CrashRecord`s captured by `tap::errors::CrashRecorder` in flash, keeping the
+ * `MAX_RECORDS` most recent. Call `store` once on boot, after `CrashRecorder::init`:
+ *
+ * ```cpp
+ * drivers->crashRecorder.init();
+ * littleFs.initialize();
+ * crashLog.store(drivers->crashRecorder.getRecord());
+ * ```
+ *
+ * Each record is a file of its own in one of `MAX_RECORDS` slots, and a new record replaces the
+ * oldest one once all slots are used. Storing a record therefore writes a single file of
+ * `sizeof(CrashRecord)` bytes regardless of how many records are stored, rather than rewriting
+ * a growing log, which bounds the time it adds to boot. If the file system has to erase a sector
+ * to make room, the write still stalls the CPU for up to seconds (see
+ * `LittleFSInternal::writeFile`), but only on the rare boots after a crash.
+ */
+class CrashLog
+{
+public:
+    static constexpr int MAX_RECORDS = 8;
+
+    CrashLog(LittleFSInternal &fs) : fs(fs) {}
+    DISALLOW_COPY_AND_ASSIGN(CrashLog)
+
+    /**
+     * If `record` holds a crash, numbers it, stores it in flash and invalidates it, so that it is
+     * only stored once.
+     *
+     * @return `true` if a record was stored. If storing fails, `record` is left valid, so it is
+     *      stored on the next boot instead.
+     */
+    bool store(tap::errors::CrashRecord &record);
+
+    /// @return The number of records stored in flash.
+    int getNumRecords();
+
+    /**
+     * Reads a stored record.
+     *
+     * @param[in] index The index of the record, where 0 is the most recent record.
+     * @return `true` if the record exists.
+     */
+    bool readRecord(int index, tap::errors::CrashRecord &record);
+
+    /// Deletes all stored records.
+    void clear();
+
+    /// Prints all stored records, most recent first.
+    void print(modm::IOStream &outputStream);
+
+private:
+    struct Slot
+    {
+        int index;
+        uint32_t sequence;
+    };
+
+    LittleFSInternal &fs;
+
+    /// Buffer records are read into, too large to keep on the stack.
+    tap::errors::CrashRecord scratch;
+
+    /**
+     * Fills `slots` with the slots holding valid records, most recent first.
+     *
+     * @return The number of slots filled.
+     */
+    int findRecords(Slot (&slots)[MAX_RECORDS]);
+
+    /// Sets `path` to the path of the file of slot `index`.
+    static void getSlotPath(int index, char (&path)[8]);
+};  // class CrashLog
+}  // namespace tap::storage
+
+#endif  // TAPROOT_CRASH_LOG_HPP_
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "deferred_file_writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace tap::storage
+{
+DeferredFileWriter::~DeferredFileWriter()
+{
+    if (fileOpen)
+    {
+        lfs_file_close(fs.getFS(), &file);
+        lfs_remove(fs.getFS(), tempPath);
+    }
+}
+
+bool DeferredFileWriter::queueWrite(const char *path, const void *data, uint32_t size)
+{
+    if (strlen(path) > MAX_PATH_LENGTH)
+    {
+        return false;
+    }
+
+    // The first write may have started, so only later writes are replaced
+    for (int i = fileOpen ? 1 : 0; i < numWrites; i++)
+    {
+        if (strcmp(writes[i].path, path) == 0 && writes[i].size == size)
+        {
+            memcpy(buffer + writes[i].offset, data, size);
+            return true;
+        }
+    }
+
+    if (numWrites == MAX_QUEUED_WRITES || bufferLength + size > BUFFER_SIZE)
+    {
+        return false;
+    }
+
+    Write &write = writes[numWrites++];
+    strcpy(write.path, path);
+    write.offset = bufferLength;
+    write.size = size;
+    memcpy(buffer + bufferLength, data, size);
+    bufferLength += size;
+    totalQueued += size;
+    return true;
+}
+
+void DeferredFileWriter::update()
+{
+    if (fs.updatePreErase())
+    {
+        return;
+    }
+    if (!fileOpen && fs.getNumPreErasedBlocks() < PRE_ERASED_BLOCKS && fs.startPreErase())
+    {
+        return;
+    }
+    if (numWrites == 0)
+    {
+        return;
+    }
+
+    lfs_t *lfs = fs.getFS();
+    const Write &write = writes[0];
+    if (!fileOpen)
+    {
+        snprintf(tempPath, sizeof(tempPath), "%s~", write.path);
+        if (!fs.mount() ||
+            lfs_file_open(lfs, &file, tempPath, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) !=
+                LFS_ERR_OK)
+        {
+            totalWritten += write.size;
+            finishWrite(false);
+            return;
+        }
+        fileOpen = true;
+        written = 0;
+    }
+
+    const uint32_t length = std::min(CHUNK_SIZE, write.size - written);
+    if (length > 0 &&
+        lfs_file_write(lfs, &file, buffer + write.offset + written, length) !=
+            static_cast<lfs_ssize_t>(length))
+    {
+        totalWritten += write.size - written;
+        finishWrite(false);
+        return;
+    }
+    written += length;
+    totalWritten += length;
+
+    if (written == write.size)
+    {
+        finishWrite(true);
+    }
+}
+
+float DeferredFileWriter::getProgress() const
+{
+    return totalQueued == 0 ? 1.0f : static_cast<float>(totalWritten) / totalQueued;
+}
+
+void DeferredFileWriter::finishWrite(bool success)
+{
+    if (fileOpen)
+    {
+        lfs_t *lfs = fs.getFS();
+        success = lfs_file_close(lfs, &file) == LFS_ERR_OK && success;
+        // The file is written under a temporary name and renamed over the old one once
+        // complete, so a reset or failure mid-write leaves the old contents
+        success = success && lfs_rename(lfs, tempPath, writes[0].path) == LFS_ERR_OK;
+        if (!success)
+        {
+            lfs_remove(lfs, tempPath);
+        }
+        fileOpen = false;
+    }
+    if (!success)
+    {
+        numFailed++;
+    }
+
+    const uint32_t size = writes[0].size;
+    memmove(buffer, buffer + size, bufferLength - size);
+    bufferLength -= size;
+    for (int i = 1; i < numWrites; i++)
+    {
+        writes[i - 1] = writes[i];
+        writes[i - 1].offset -= size;
+    }
+    numWrites--;
+
+    if (numWrites == 0)
+    {
+        totalQueued = 0;
+        totalWritten = 0;
+    }
+}
+}  // namespace tap::storage
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_DEFERRED_FILE_WRITER_HPP_
+#define TAPROOT_DEFERRED_FILE_WRITER_HPP_
+
+#include <cstdint>
+
+#include "tap/util_macros.hpp"
+
+#include "littlefs_internal.hpp"
+
+namespace tap::storage
+{
+/**
+ * Writes files in the background, a chunk per `update`, so that files may be saved while the
+ * robot is enabled. `LittleFSInternal::writeFile` instead writes a whole file at once, which
+ * stalls the control loop for up to seconds if a flash sector has to be erased.
+ *
+ * ```cpp
+ * DeferredFileWriter writer(littleFs);
+ * writer.queueWrite("gains", &gains, sizeof(gains));
+ *
+ * void mainLoop()
+ * {
+ *     // ... control
+ *     writer.update();
+ * }
+ * ```
+ *
+ * Each `update` does one step, taking at most about a millisecond:
+ * - Keeps `PRE_ERASED_BLOCKS` free blocks erased ahead of time with
+ *   `LittleFSInternal::startPreErase`, polling the flash controller until each erase finishes,
+ *   so that littlefs never has to wait for a sector erase while writing a file. This runs even
+ *   with nothing queued.
+ * - Otherwise writes up to `CHUNK_SIZE` bytes of the oldest queued file, which programs at most
+ *   `CHUNK_SIZE / 4` words of flash. A file is written under a temporary name and renamed
+ *   over the old one once complete, so a reset mid-write leaves the old contents.
+ *
+ * littlefs still erases a metadata block itself when it compacts a directory, which stalls the
+ * CPU, but directories only need compacting after many writes.
+ *
+ * Not reentrant, and no other littlefs operation may run while a file is being written, so
+ * only call it from the main loop.
+ */
+class DeferredFileWriter
+{
+public:
+    static constexpr int MAX_QUEUED_WRITES = 4;
+    /// Space for the data of queued writes, which is copied when queued.
+    static constexpr uint32_t BUFFER_SIZE = 4096;
+    static constexpr uint32_t CHUNK_SIZE = 256;
+    static constexpr int PRE_ERASED_BLOCKS = 2;
+    static constexpr int MAX_PATH_LENGTH = 31;
+
+    DeferredFileWriter(LittleFSInternal &fs) : fs(fs) {}
+    DISALLOW_COPY_AND_ASSIGN(DeferredFileWriter)
+    ~DeferredFileWriter();
+
+    /**
+     * Queues the contents of a file to be written by `update`, copying `data`. Replaces a write
+     * to the same file that hasn't started yet.
+     *
+     * @return `false` if the path is too long or there is no room in the queue.
+     */
+    bool queueWrite(const char *path, const void *data, uint32_t size);
+
+    /// Does one step of writing queued files or erasing blocks ahead of time.
+    void update();
+
+    /// @return `true` while files are queued or being written.
+    bool isBusy() const { return numWrites > 0; }
+
+    /**
+     * @return The fraction of the bytes queued since the queue was last empty that have been
+     *      written, from 0 to 1, or 1 if the queue is empty.
+     */
+    float getProgress() const;
+
+    /// @return The number of files that couldn't be written.
+    uint32_t getNumFailed() const { return numFailed; }
+
+private:
+    struct Write
+    {
+        char path[MAX_PATH_LENGTH + 1];
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    LittleFSInternal &fs;
+
+    Write writes[MAX_QUEUED_WRITES];
+    int numWrites = 0;
+    uint8_t buffer[BUFFER_SIZE];
+    uint32_t bufferLength = 0;
+
+    /// The file the first write is being written to, valid if `fileOpen`.
+    lfs_file_t file;
+    /// The temporary name the first write is written under, its path followed by '~'.
+    char tempPath[MAX_PATH_LENGTH + 2];
+    bool fileOpen = false;
+    /// Bytes of the first write written so far.
+    uint32_t written = 0;
+
+    /// Bytes queued and written since the queue was last empty.
+    uint32_t totalQueued = 0;
+    uint32_t totalWritten = 0;
+
+    uint32_t numFailed = 0;
+
+    /// Closes the file and removes the first write from the queue.
+    void finishWrite(bool success);
+};  // class DeferredFileWriter
+}  // namespace tap::storage
+
+#endif  // TAPROOT_DEFERRED_FILE_WRITER_HPP_
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_KEY_VALUE_CALIBRATION_CACHE_HPP_
+#define TAPROOT_KEY_VALUE_CALIBRATION_CACHE_HPP_
+
+#include "tap/control/setpoint/interfaces/calibration_cache.hpp"
+
+#include "key_value_store.hpp"
+
+namespace tap::storage
+{
+/**
+ * Stores calibrations of setpoint subsystems as floats in a `KeyValueStore`, so they are
+ * written to flash by `KeyValueStore::update` while the robot is idle.
+ */
+class KeyValueCalibrationCache : public control::setpoint::CalibrationCache
+{
+public:
+    explicit KeyValueCalibrationCache(KeyValueStore &store) : store(store) {}
+
+    bool load(const char *key, float *calibration) override
+    {
+        return store.get(key, *calibration);
+    }
+
+    void save(const char *key, float calibration) override { store.set(key, calibration); }
+
+private:
+    KeyValueStore &store;
+};
+}  // namespace tap::storage
+
+#endif  // TAPROOT_KEY_VALUE_CALIBRATION_CACHE_HPP_
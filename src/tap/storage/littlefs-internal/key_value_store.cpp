@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "key_value_store.hpp"
+
+#include <cstring>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+
+namespace tap::storage
+{
+bool KeyValueStore::load()
+{
+    numEntries = 0;
+    valuesLength = 0;
+    pendingLength = 0;
+    compactionRequired = false;
+    logSize = -1;
+
+    if (!fs.mount())
+    {
+        return false;
+    }
+
+    lfs_t *lfs = fs.getFS();
+    lfs_file_t file;
+    int err = lfs_file_open(lfs, &file, LOG_PATH, LFS_O_RDONLY);
+    if (err == LFS_ERR_NOENT)
+    {
+        logSize = 0;
+        return true;
+    }
+    if (err != LFS_ERR_OK)
+    {
+        return false;
+    }
+
+    uint8_t magic[4];
+    if (lfs_file_read(lfs, &file, magic, sizeof(magic)) != sizeof(magic) ||
+        memcmp(magic, LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        // Not a log, replace it the next time anything is written
+        lfs_file_close(lfs, &file);
+        logSize = 0;
+        compactionRequired = true;
+        return true;
+    }
+
+    int32_t validSize = sizeof(magic);
+    while (true)
+    {
+        uint8_t *header = entryBuffer;
+        if (lfs_file_read(lfs, &file, header, ENTRY_HEADER_SIZE) != ENTRY_HEADER_SIZE)
+        {
+            break;
+        }
+        const int keyLength = header[0];
+        const Type type = static_cast<Type>(header[1]);
+        uint16_t size;
+        tap::arch::convertFromLittleEndian(&size, header + 2);
+        if (keyLength > MAX_KEY_LENGTH || size > MAX_VALUE_SIZE)
+        {
+            break;
+        }
+
+        const int bodyLength = keyLength + size + ENTRY_CRC_SIZE;
+        if (lfs_file_read(lfs, &file, header + ENTRY_HEADER_SIZE, bodyLength) != bodyLength)
+        {
+            break;
+        }
+        const int crcOffset = ENTRY_HEADER_SIZE + keyLength + size;
+        uint16_t crc;
+        tap::arch::convertFromLittleEndian(&crc, entryBuffer + crcOffset);
+        if (crc != tap::algorithms::calculateCRC16(entryBuffer, crcOffset))
+        {
+            break;
+        }
+
+        char key[MAX_KEY_LENGTH + 1];
+        memcpy(key, entryBuffer + ENTRY_HEADER_SIZE, keyLength);
+        key[keyLength] = '\0';
+        if (!store(key, type, entryBuffer + ENTRY_HEADER_SIZE + keyLength, size))
+        {
+            // Out of RAM, which only happens if the limits shrank since the log was written
+            compactionRequired = true;
+        }
+        validSize += ENTRY_HEADER_SIZE + bodyLength;
+    }
+
+    const bool truncated = validSize != lfs_file_size(lfs, &file);
+    lfs_file_close(lfs, &file);
+    logSize = validSize;
+    if (truncated)
+    {
+        // Entries appended after a torn write would be lost on the next load
+        compactionRequired = true;
+    }
+    return true;
+}
+
+bool KeyValueStore::remove(const char *key)
+{
+    if (find(key) < 0)
+    {
+        return false;
+    }
+    store(key, Type::NONE, nullptr, 0);
+    queueEntry(key, Type::NONE, nullptr, 0);
+    return true;
+}
+
+void KeyValueStore::update(bool idle)
+{
+    if (idle && hasPendingWrites())
+    {
+        flush();
+    }
+}
+
+bool KeyValueStore::flush()
+{
+    if (compactionRequired || logSize < 0 || logSize + pendingLength > MAX_LOG_SIZE)
+    {
+        return compact();
+    }
+    return pendingLength == 0 || appendPending();
+}
+
+bool KeyValueStore::compact()
+{
+    if (!fs.mount())
+    {
+        return false;
+    }
+
+    lfs_t *lfs = fs.getFS();
+    lfs_file_t file;
+    if (lfs_file_open(lfs, &file, COMPACT_PATH, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) !=
+        LFS_ERR_OK)
+    {
+        return false;
+    }
+
+    int32_t size = sizeof(LOG_MAGIC);
+    bool success = lfs_file_write(lfs, &file, LOG_MAGIC, sizeof(LOG_MAGIC)) == size;
+    for (int i = 0; i < numEntries && success; i++)
+    {
+        const Entry &entry = entries[i];
+        int length = encodeEntry(entry.key, entry.type, values + entry.offset, entry.size);
+        success = lfs_file_write(lfs, &file, entryBuffer, length) == length;
+        size += length;
+    }
+    success = lfs_file_close(lfs, &file) == LFS_ERR_OK && success;
+
+    // Renaming replaces the old log atomically, so a reset leaves one log or the other
+    if (!success || lfs_rename(lfs, COMPACT_PATH, LOG_PATH) != LFS_ERR_OK)
+    {
+        lfs_remove(lfs, COMPACT_PATH);
+        return false;
+    }
+
+    logSize = size;
+    pendingLength = 0;
+    compactionRequired = false;
+    return true;
+}
+
+bool KeyValueStore::setValue(const char *key, Type type, const void *value, int size)
+{
+    if (!store(key, type, value, size))
+    {
+        return false;
+    }
+    queueEntry(key, type, value, size);
+    return true;
+}
+
+bool KeyValueStore::getValue(const char *key, Type type, void *value, int size) const
+{
+    int index = find(key);
+    if (index < 0 || entries[index].type != type || entries[index].size != size)
+    {
+        return false;
+    }
+    memcpy(value, values + entries[index].offset, size);
+    return true;
+}
+
+int KeyValueStore::find(const char *key) const
+{
+    for (int i = 0; i < numEntries; i++)
+    {
+        if (strcmp(entries[i].key, key) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool KeyValueStore::store(const char *key, Type type, const void *value, int size)
+{
+    if (strlen(key) > MAX_KEY_LENGTH || size > MAX_VALUE_SIZE)
+    {
+        return false;
+    }
+
+    int index = find(key);
+    if (type == Type::NONE)
+    {
+        if (index >= 0)
+        {
+            resizeValue(index, -entries[index].size);
+            memmove(
+                entries + index,
+                entries + index + 1,
+                (numEntries - index - 1) * sizeof(Entry));
+            numEntries--;
+        }
+        return true;
+    }
+
+    if (index < 0)
+    {
+        if (numEntries == MAX_KEYS || valuesLength + size > VALUE_POOL_SIZE)
+        {
+            return false;
+        }
+        index = numEntries++;
+        Entry &entry = entries[index];
+        strcpy(entry.key, key);
+        entry.size = 0;
+        entry.offset = valuesLength;
+    }
+    else if (valuesLength + size - entries[index].size > VALUE_POOL_SIZE)
+    {
+        return false;
+    }
+
+    Entry &entry = entries[index];
+    resizeValue(index, size - entry.size);
+    entry.type = type;
+    memcpy(values + entry.offset, value, size);
+    return true;
+}
+
+void KeyValueStore::resizeValue(int index, int delta)
+{
+    Entry &entry = entries[index];
+    const int end = entry.offset + entry.size;
+    memmove(values + end + delta, values + end, valuesLength - end);
+    for (int i = index + 1; i < numEntries; i++)
+    {
+        entries[i].offset += delta;
+    }
+    entry.size += delta;
+    valuesLength += delta;
+}
+
+int KeyValueStore::encodeEntry(const char *key, Type type, const void *value, int size)
+{
+    const int keyLength = strlen(key);
+    entryBuffer[0] = keyLength;
+    entryBuffer[1] = static_cast<uint8_t>(type);
+    tap::arch::convertToLittleEndian(static_cast<uint16_t>(size), entryBuffer + 2);
+    memcpy(entryBuffer + ENTRY_HEADER_SIZE, key, keyLength);
+    memcpy(entryBuffer + ENTRY_HEADER_SIZE + keyLength, value, size);
+
+    const int crcOffset = ENTRY_HEADER_SIZE + keyLength + size;
+    tap::arch::convertToLittleEndian(
+        tap::algorithms::calculateCRC16(entryBuffer, crcOffset),
+        entryBuffer + crcOffset);
+    return crcOffset + ENTRY_CRC_SIZE;
+}
+
+void KeyValueStore::queueEntry(const char *key, Type type, const void *value, int size)
+{
+    if (compactionRequired)
+    {
+        // Compaction writes every value anyway
+        return;
+    }
+
+    const int length = encodeEntry(key, type, value, size);
+    if (pendingLength + length > PENDING_SIZE)
+    {
+        // RAM holds every value, so nothing is lost by compacting instead
+        pendingLength = 0;
+        compactionRequired = true;
+        return;
+    }
+    memcpy(pending + pendingLength, entryBuffer, length);
+    pendingLength += length;
+}
+
+bool KeyValueStore::appendPending()
+{
+    if (!fs.mount())
+    {
+        return false;
+    }
+
+    lfs_t *lfs = fs.getFS();
+    lfs_file_t file;
+    if (lfs_file_open(lfs, &file, LOG_PATH, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND) !=
+        LFS_ERR_OK)
+    {
+        return false;
+    }
+
+    int32_t size = logSize;
+    bool success = true;
+    if (size == 0)
+    {
+        size = sizeof(LOG_MAGIC);
+        success = lfs_file_write(lfs, &file, LOG_MAGIC, sizeof(LOG_MAGIC)) == size;
+    }
+    success = success && lfs_file_write(lfs, &file, pending, pendingLength) == pendingLength;
+    success = lfs_file_close(lfs, &file) == LFS_ERR_OK && success;
+    if (!success)
+    {
+        // The log may now end in a partial entry, so start a new one
+        compactionRequired = true;
+        return false;
+    }
+
+    logSize = size + pendingLength;
+    pendingLength = 0;
+    return true;
+}
+}  // namespace tap::storage
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_KEY_VALUE_STORE_HPP_
+#define TAPROOT_KEY_VALUE_STORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "tap/util_macros.hpp"
+
+#include "littlefs_internal.hpp"
+
+namespace tap::storage
+{
+/**
+ * A typed key-value store in flash for values that change rarely and have to survive a reset,
+ * such as calibrations, PID gains and IMU biases:
+ *
+ * ```cpp
+ * KeyValueStore store(littleFs);
+ * store.load();
+ * store.get("pitch.kp", pitchKp);
+ * store.set("imu.bias", imuBias);
+ *
+ * void mainLoop()
+ * {
+ *     // Writes to flash, if there is anything to write, only while the robot is disabled
+ *     store.update(robotDisabled);
+ * }
+ * ```
+ *
+ * Every value is held in RAM, indexed by key, so `get` never touches flash, and `set` only
+ * updates RAM and appends an entry to a buffer of pending writes. Flash is only written by
+ * `update`, and only when the caller says the robot is idle, since writing to flash stalls the
+ * CPU, for hundreds of milliseconds if a 128 KiB sector has to be erased.
+ *
+ * In flash, the store is a log of entries, each holding a key, its type, its value and a CRC,
+ * in the file `LOG_PATH`. Writing pending entries appends them to the log, rather than
+ * rewriting every value. `load` replays the log, so the last entry for a key wins, and stops at
+ * the first entry whose CRC doesn't match, which is where a reset interrupted a write. Once the
+ * log grows past `MAX_LOG_SIZE`, or pending entries overflow their buffer, `update` compacts
+ * it, writing one entry per key to a new log that atomically replaces the old one.
+ *
+ * Values are trivially copyable types, stored as their bytes. Each entry records the value's
+ * type, so `get` fails rather than reinterpreting a value stored as a different type.
+ */
+class KeyValueStore
+{
+public:
+    static constexpr int MAX_KEYS = 32;
+    /// The longest key, not including the null terminator.
+    static constexpr int MAX_KEY_LENGTH = 23;
+    static constexpr int MAX_VALUE_SIZE = 256;
+    /// Size of the RAM holding all values.
+    static constexpr int VALUE_POOL_SIZE = 2048;
+    /// Size of the buffer of entries waiting to be written to flash.
+    static constexpr int PENDING_SIZE = 512;
+    /// Size of the log beyond which it is compacted.
+    static constexpr int32_t MAX_LOG_SIZE = 16 * 1024;
+
+    static constexpr const char *LOG_PATH = "kv.log";
+    static constexpr const char *COMPACT_PATH = "kv.new";
+
+    enum class Type : uint8_t
+    {
+        /// Marks a removed key.
+        NONE = 0,
+        FLOAT = 1,
+        INT32 = 2,
+        UINT32 = 3,
+        BOOL = 4,
+        /// Any other trivially copyable type, such as a struct. Sizes must match to `get`.
+        BLOB = 5,
+    };
+
+    KeyValueStore(LittleFSInternal &fs) : fs(fs) {}
+    DISALLOW_COPY_AND_ASSIGN(KeyValueStore)
+
+    /**
+     * Replaces the values in RAM with those in flash. Only reads flash.
+     *
+     * @return `true` if the log was read, or doesn't exist yet.
+     */
+    bool load();
+
+    /**
+     * Sets a value in RAM and queues it to be written to flash by `update`.
+     *
+     * @return `false` if the key is too long, or there is no room for it or its value.
+     */
+    template <typename T>
+    bool set(const char *key, const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "values must be trivially copyable");
+        return setValue(key, typeOf<T>(), &value, sizeof(T));
+    }
+
+    /**
+     * Gets a value from RAM.
+     *
+     * @return `false` if the key isn't set, or was set with a different type, in which case
+     *      `value` is unchanged.
+     */
+    template <typename T>
+    bool get(const char *key, T &value) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "values must be trivially copyable");
+        return getValue(key, typeOf<T>(), &value, sizeof(T));
+    }
+
+    /// @return `true` if the key is set.
+    bool contains(const char *key) const { return find(key) >= 0; }
+
+    /// Removes a key, queuing its removal to be written to flash by `update`.
+    bool remove(const char *key);
+
+    /// @return The number of keys set.
+    int getNumKeys() const { return numEntries; }
+
+    /**
+     * Writes to flash if the robot is idle and there is anything to write: appends pending
+     * entries to the log, or compacts the log if it is too large or entries were lost from the
+     * pending buffer. Call every main loop.
+     *
+     * @param[in] idle `true` if the robot is disabled, or otherwise able to tolerate the CPU
+     *      stalling for hundreds of milliseconds.
+     */
+    void update(bool idle);
+
+    /// Appends pending entries to the log, or compacts it if needed, regardless of idleness.
+    bool flush();
+
+    /// Rewrites the log with one entry per key.
+    bool compact();
+
+    /// @return `true` if there are changes that haven't been written to flash.
+    bool hasPendingWrites() const { return pendingLength > 0 || compactionRequired; }
+
+private:
+    /// Key length, type and value size.
+    static constexpr int ENTRY_HEADER_SIZE = 4;
+    static constexpr int ENTRY_CRC_SIZE = 2;
+    static constexpr int MAX_ENTRY_SIZE =
+        ENTRY_HEADER_SIZE + MAX_KEY_LENGTH + MAX_VALUE_SIZE + ENTRY_CRC_SIZE;
+    static constexpr uint8_t LOG_MAGIC[4] = {'T', 'K', 'V', '1'};
+
+    struct Entry
+    {
+        char key[MAX_KEY_LENGTH + 1];
+        Type type;
+        uint16_t size;
+        /// Offset of the value in `values`. Values are stored in the same order as entries.
+        uint16_t offset;
+    };
+
+    LittleFSInternal &fs;
+
+    Entry entries[MAX_KEYS];
+    int numEntries = 0;
+    uint8_t values[VALUE_POOL_SIZE];
+    int valuesLength = 0;
+
+    uint8_t pending[PENDING_SIZE];
+    int pendingLength = 0;
+    /// Set if a change was dropped from `pending`, so only compaction writes every value.
+    bool compactionRequired = false;
+
+    /// Size of the log in flash, -1 if unknown.
+    int32_t logSize = -1;
+
+    /// Scratch space for encoding and decoding a single entry.
+    uint8_t entryBuffer[MAX_ENTRY_SIZE];
+
+    template <typename T>
+    static constexpr Type typeOf()
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return Type::FLOAT;
+        }
+        else if constexpr (std::is_same_v<T, int32_t>)
+        {
+            return Type::INT32;
+        }
+        else if constexpr (std::is_same_v<T, uint32_t>)
+        {
+            return Type::UINT32;
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            return Type::BOOL;
+        }
+        else
+        {
+            return Type::BLOB;
+        }
+    }
+
+    bool setValue(const char *key, Type type, const void *value, int size);
+
+    bool getValue(const char *key, Type type, void *value, int size) const;
+
+    /// @return The index of the key's entry, or -1.
+    int find(const char *key) const;
+
+    /// Sets a value in RAM only. Removes the key if `type` is `NONE`.
+    bool store(const char *key, Type type, const void *value, int size);
+
+    /// Grows or shrinks the space for entry `index`'s value by `delta` bytes.
+    void resizeValue(int index, int delta);
+
+    /// Encodes an entry into `entryBuffer`. @return Its length.
+    int encodeEntry(const char *key, Type type, const void *value, int size);
+
+    /// Queues an entry to be appended to the log.
+    void queueEntry(const char *key, Type type, const void *value, int size);
+
+    /// Appends `pending` to the log.
+    bool appendPending();
+};  // class KeyValueStore
+}  // namespace tap::storage
+
+#endif  // TAPROOT_KEY_VALUE_STORE_HPP_
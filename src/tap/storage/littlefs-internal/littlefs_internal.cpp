@@ -32,6 +32,125 @@ void LittleFSInternal::initialize()
     Flash::unlock();
 }
 
+bool LittleFSInternal::mount()
+{
+    if (mounted)
+    {
+        return true;
+    }
+
+    if (lfs_mount(&fs, &fsconfig) != LFS_ERR_OK)
+    {
+        if (lfs_format(&fs, &fsconfig) != LFS_ERR_OK || lfs_mount(&fs, &fsconfig) != LFS_ERR_OK)
+        {
+            return false;
+        }
+    }
+    mounted = true;
+    return true;
+}
+
+bool LittleFSInternal::startPreErase()
+{
+    if (isPreErasing() || freeBlocksErased || !mount())
+    {
+        return false;
+    }
+
+    uint32_t usedBlocks = 0;
+    auto markUsed = [](void *data, lfs_block_t block) {
+        *static_cast<uint32_t *>(data) |= 1ul << block;
+        return 0;
+    };
+    if (lfs_fs_traverse(&fs, markUsed, &usedBlocks) != LFS_ERR_OK)
+    {
+        return false;
+    }
+
+    for (int block = 0; block < BLOCK_COUNT; block++)
+    {
+        if ((usedBlocks & (1ul << block)) == 0 && (preErasedBlocks & (1ul << block)) == 0)
+        {
+            if ((FLASH->SR & FLASH_SR_BSY) != 0)
+            {
+                return false;
+            }
+            // Same sequence as Flash::erase, without waiting for the erase to finish
+            FLASH->SR = FLASH_SR_EOP | FLASH_SR_OPERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR |
+                        FLASH_SR_PGPERR | FLASH_SR_PGSERR;
+            FLASH->CR = (FLASH->CR & ~(FLASH_CR_SNB | FLASH_CR_PSIZE)) | FLASH_CR_SER |
+                        FLASH_CR_PSIZE_1 |
+                        ((SECTOR_ZERO + block + BANK2_INDEX_OFFSET) << FLASH_CR_SNB_Pos);
+            FLASH->CR |= FLASH_CR_STRT;
+            erasingBlock = block;
+            return true;
+        }
+    }
+    freeBlocksErased = true;
+    return false;
+}
+
+bool LittleFSInternal::updatePreErase()
+{
+    if (!isPreErasing() || (FLASH->SR & FLASH_SR_BSY) != 0)
+    {
+        return isPreErasing();
+    }
+
+    FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+    const uint32_t errors =
+        FLASH_SR_OPERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR;
+    if ((FLASH->SR & errors) == 0)
+    {
+        preErasedBlocks |= 1ul << erasingBlock;
+    }
+    erasingBlock = -1;
+    return false;
+}
+
+int LittleFSInternal::getNumPreErasedBlocks() const { return __builtin_popcount(preErasedBlocks); }
+
+void LittleFSInternal::waitForPreErase()
+{
+    while (updatePreErase())
+    {
+    }
+}
+
+bool LittleFSInternal::readFile(const char *path, void *buffer, lfs_size_t size)
+{
+    if (!mount())
+    {
+        return false;
+    }
+
+    lfs_file_t file;
+    if (lfs_file_open(&fs, &file, path, LFS_O_RDONLY) != LFS_ERR_OK)
+    {
+        return false;
+    }
+    bool success = lfs_file_size(&fs, &file) == static_cast<lfs_soff_t>(size) &&
+                   lfs_file_read(&fs, &file, buffer, size) == static_cast<lfs_ssize_t>(size);
+    return lfs_file_close(&fs, &file) == LFS_ERR_OK && success;
+}
+
+bool LittleFSInternal::writeFile(const char *path, const void *data, lfs_size_t size)
+{
+    if (!mount())
+    {
+        return false;
+    }
+
+    lfs_file_t file;
+    if (lfs_file_open(&fs, &file, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) != LFS_ERR_OK)
+    {
+        return false;
+    }
+    // Closing commits the file atomically, so a reset mid-write leaves the old contents.
+    bool success = lfs_file_write(&fs, &file, data, size) == static_cast<lfs_ssize_t>(size);
+    return lfs_file_close(&fs, &file) == LFS_ERR_OK && success;
+}
+
 int LittleFSInternal::lfs_read(
     const struct lfs_config *c,
     lfs_block_t block,
@@ -45,6 +164,8 @@ int LittleFSInternal::lfs_read(
         return LFS_ERR_IO;
     }
 
+    static_cast<LittleFSInternal *>(c->context)->waitForPreErase();
+
     uintptr_t startAddr = OriginAddr + block * c->block_size + off;
 
     for (size_t i = 0; i < size / sizeof(uint32_t); i++)
@@ -68,6 +189,8 @@ int LittleFSInternal::lfs_program(
         return LFS_ERR_IO;
     }
 
+    static_cast<LittleFSInternal *>(c->context)->waitForPreErase();
+
     uintptr_t startAddr = OriginAddr + block * c->block_size + off;
 
     for (size_t i = 0; i < size / sizeof(uint32_t); i++)
@@ -83,11 +206,20 @@ int LittleFSInternal::lfs_program(
 
 int LittleFSInternal::lfs_erase(const struct lfs_config *c, lfs_block_t block)
 {
-    static constexpr int BANK2_INDEX_OFFSET = 4;
     if (block >= c->block_count)
     {
         return LFS_ERR_IO;
     }
+
+    auto self = static_cast<LittleFSInternal *>(c->context);
+    self->waitForPreErase();
+    self->freeBlocksErased = false;
+    if ((self->preErasedBlocks & (1ul << block)) != 0)
+    {
+        // Erased ahead of time, and littlefs only erases a block before programming it
+        self->preErasedBlocks &= ~(1ul << block);
+        return LFS_ERR_OK;
+    }
     return (Flash::erase(SECTOR_ZERO + block + BANK2_INDEX_OFFSET) == 0 ? LFS_ERR_OK : LFS_ERR_IO);
 }
 
@@ -32,11 +32,63 @@ class LittleFSInternal
     lfs_t *getFS() { return &fs; }
     lfs_config *getFSConfig() { return &fsconfig; }
 
+    /**
+     * Mounts the file system, formatting the flash first if it doesn't hold one. `readFile` and
+     * `writeFile` mount the file system if it isn't already.
+     *
+     * @return `true` if the file system is mounted.
+     */
+    bool mount();
+
+    /**
+     * Reads a whole file that holds exactly `size` bytes, such as a struct written by
+     * `writeFile`.
+     *
+     * @return `true` if the file exists and holds exactly `size` bytes, otherwise `buffer` may
+     *      be partially written.
+     */
+    bool readFile(const char *path, void *buffer, lfs_size_t size);
+
+    /**
+     * Replaces the contents of a file with `size` bytes of `data`, creating it if needed.
+     *
+     * @note Writing to flash stalls the CPU, for up to seconds if a sector has to be erased, so
+     *      only write files while the robot is disabled.
+     * @return `true` if the whole file was written.
+     */
+    bool writeFile(const char *path, const void *data, lfs_size_t size);
+
+    /**
+     * Starts erasing a block littlefs isn't using without waiting for the erase to finish, so
+     * that when littlefs next allocates the block its erase callback returns at once instead of
+     * stalling the CPU for the whole erase. littlefs is in flash bank 2 and code runs from bank 1,
+     * so the CPU keeps running while bank 2 is erased. Any littlefs operation started before the
+     * erase finishes waits for it.
+     *
+     * @return `false` if an erase is already in progress, or no free block needs erasing.
+     */
+    bool startPreErase();
+
+    /**
+     * Completes the erase started by `startPreErase` if the flash controller has finished it.
+     *
+     * @return `true` while the erase is in progress.
+     */
+    bool updatePreErase();
+
+    /// @return `true` while an erase started by `startPreErase` is in progress.
+    bool isPreErasing() const { return erasingBlock >= 0; }
+
+    /// @return The number of free blocks erased ahead of time that littlefs hasn't used yet.
+    int getNumPreErasedBlocks() const;
+
 private:
     // See RM0090 Page 77
     static constexpr size_t SECTOR_SIZE = 1ul << 17;  // Use 128kB Sectors
     static constexpr uint8_t SECTOR_ZERO = 17;        // 128kB Sector 17 to 23
     static constexpr uint8_t BLOCK_COUNT = 7;         // 17 to 23, 7 blocks in total
+    /// Sectors 12 to 23 are numbered 16 to 27 by the flash controller.
+    static constexpr int BANK2_INDEX_OFFSET = 4;
 
     static constexpr int LFS_CACHE_SIZE = 256;
     static constexpr int LFS_LOOKAHEAD_BUFFER_SIZE = 256;
@@ -51,9 +103,20 @@ class LittleFSInternal
     static inline uint8_t *const Origin{(uint8_t *)OriginAddr};
 
     lfs_t fs;
+    bool mounted = false;
+
+    /// Bit `n` is set if block `n` was erased by `startPreErase` and littlefs hasn't used it.
+    uint32_t preErasedBlocks = 0;
+    /// The block being erased by `startPreErase`, or -1.
+    int erasingBlock = -1;
+    /**
+     * Set when `startPreErase` finds every free block erased, so it doesn't traverse the file
+     * system again until littlefs erases a block, which is when blocks may have been freed.
+     */
+    bool freeBlocksErased = false;
 
     lfs_config fsconfig = {
-        .context = 0,
+        .context = this,
         .read = lfs_read,
         .prog = lfs_program,
         .erase = lfs_erase,
@@ -93,6 +156,9 @@ class LittleFSInternal
     static int lfs_erase(const struct lfs_config *c, lfs_block_t block);
 
     static int lfs_sync(const struct lfs_config *c);
+
+    /// Waits for an erase started by `startPreErase` to finish, before touching flash bank 2.
+    void waitForPreErase();
 };
 
 }  // namespace tap::storage
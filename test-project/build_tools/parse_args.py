@@ -21,28 +21,34 @@ from SCons.Script import *
 CMD_LINE_ARGS                       = 1
 TEST_BUILD_TARGET_ACCEPTED_ARGS     = ["build-tests", "run-tests", "run-tests-gcov"]
 SIM_BUILD_TARGET_ACCEPTED_ARGS      = ["build-sim", "run-sim"]
-HARDWARE_BUILD_TARGET_ACCEPTED_ARGS = ["build", "run", "size", "gdb"]
+BENCHMARK_BUILD_TARGET_ACCEPTED_ARGS = ["build-benchmarks", "run-benchmarks"]
+HARDWARE_BUILD_TARGET_ACCEPTED_ARGS = ["build", "run", "size", "gdb", "ram-report"]
 VALID_BUILD_PROFILES                = ["debug", "release", "fast"]
 VALID_PROFILING_TYPES               = ["true", "false"]
+VALID_TRACING_TYPES                 = ["true", "false"]
 
-USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|false>]\n\
+USAGE = "Usage: scons <target> [profile=<debug|release|fast>] [profiling=<true|false>] [tracing=<true|false>]\n\
     \"<target>\" is one of:\n\
         - \"build\": build all code for the hardware platform.\n\
         - \"run\": build all code for the hardware platform, and deploy it to the board via a connected ST-Link.\n\
         - \"size\": build all code for the hardware platform, and display build size information.\n\
+        - \"ram-report\": build all code for the hardware platform, and display the static RAM used by each module.\n\
         - \"gdb\": build all code for the hardware platform, opens a gdb session.\n\
         - \"build-tests\": build core code and tests for the current host platform.\n\
         - \"run-tests\": build core code and tests for the current host platform, and execute them locally with the test runner.\n\
         - \"run-tests-gcov\": builds core code and tests, executes them locally, and captures and prints code coverage information\n\
         - \"build-sim\": build all code for the simulated environment, for the current host platform.\n\
-        - \"run-sim\": build all code for the simulated environment, for the current host platform, and execute the simulator locally."
+        - \"run-sim\": build all code for the simulated environment, for the current host platform, and execute the simulator locally.\n\
+        - \"build-benchmarks\": build core code and microbenchmarks for the current host platform.\n\
+        - \"run-benchmarks\": build core code and microbenchmarks for the current host platform, run them, and write the results to benchmark-results.json."
 
 
 def parse_args():
     args = {
         "TARGET_ENV": "",
         "BUILD_PROFILE": "",
-        "PROFILING": ""
+        "PROFILING": "",
+        "TRACING": ""
     }
     if len(COMMAND_LINE_TARGETS) > CMD_LINE_ARGS:
         raise Exception("You did not enter the correct number of arguments.\n" + USAGE)
@@ -58,6 +64,8 @@ def parse_args():
             args["TARGET_ENV"] = "tests"
         elif build_target in SIM_BUILD_TARGET_ACCEPTED_ARGS:
             args["TARGET_ENV"] = "sim"
+        elif build_target in BENCHMARK_BUILD_TARGET_ACCEPTED_ARGS:
+            args["TARGET_ENV"] = "benchmarks"
         elif build_target in HARDWARE_BUILD_TARGET_ACCEPTED_ARGS:
             args["TARGET_ENV"] = "hardware"
         else:
@@ -76,4 +84,8 @@ def parse_args():
     if args["PROFILING"] not in VALID_PROFILING_TYPES:
         raise Exception("You specified an invalid profiling type.\n" + USAGE)
 
+    args["TRACING"] = ARGUMENTS.get("tracing", "false")
+    if args["TRACING"] not in VALID_TRACING_TYPES:
+        raise Exception("You specified an invalid tracing type.\n" + USAGE)
+
     return args
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+
+#ifdef PLATFORM_HOSTED
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#else
+#include "tap/architecture/clock.hpp"
+#include "tap/board/board.hpp"
+#endif
+
+namespace tap::benchmark
+{
+namespace
+{
+struct Benchmark
+{
+    const char *name;
+    BenchmarkFunction function;
+};
+
+/// Times are per iteration, in `TIME_UNIT`s.
+struct Result
+{
+    const char *name;
+    int64_t iterations;
+    double median;
+    double min;
+    double max;
+    int64_t bytesPerIteration;
+    int64_t itemsPerIteration;
+    int64_t bytesProducedPerIteration;
+    /// Longest call timed by `State::timeCall` in any repetition, 0 if none were timed.
+    double maxCall;
+};
+
+/// Function local so that benchmarks registered during static initialization find it constructed.
+std::vector<Benchmark> &getBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+#ifdef PLATFORM_HOSTED
+constexpr double TIME_UNITS_PER_SECOND = 1e9;
+#else
+constexpr double TIME_UNITS_PER_SECOND = Board::SystemClock::Frequency;
+#endif
+
+/// @return The number of iterations that makes one repetition run for about `minTime` seconds.
+int64_t calibrateIterations(const Benchmark &benchmark, double minTime)
+{
+    const double minTimeUnits = minTime * TIME_UNITS_PER_SECOND;
+    int64_t iterations = 1;
+    while (true)
+    {
+        State state(iterations);
+        benchmark.function(state);
+        const double elapsed = state.getElapsedTime();
+        if (elapsed >= minTimeUnits || iterations >= INT64_MAX / 10)
+        {
+            return iterations;
+        }
+        if (elapsed < minTimeUnits / 10)
+        {
+            iterations *= 10;
+        }
+        else
+        {
+            // Close enough to extrapolate, aim slightly past the minimum time
+            return static_cast<int64_t>(iterations * 1.2 * minTimeUnits / elapsed) + 1;
+        }
+    }
+}
+
+Result runBenchmark(const Benchmark &benchmark, const Options &options)
+{
+    const int64_t iterations = calibrateIterations(benchmark, options.minTime);
+
+    std::vector<double> timePerIteration;
+    Result result{benchmark.name, iterations, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < std::max(options.repetitions, 1); i++)
+    {
+        State state(iterations);
+        benchmark.function(state);
+        timePerIteration.push_back(static_cast<double>(state.getElapsedTime()) / iterations);
+        result.bytesPerIteration = state.getBytesProcessed();
+        result.itemsPerIteration = state.getItemsProcessed();
+        result.bytesProducedPerIteration = state.getBytesProduced();
+        result.maxCall = std::max(result.maxCall, static_cast<double>(state.getMaxCallTime()));
+    }
+
+    std::sort(timePerIteration.begin(), timePerIteration.end());
+    result.median = timePerIteration[timePerIteration.size() / 2];
+    result.min = timePerIteration.front();
+    result.max = timePerIteration.back();
+    return result;
+}
+
+/// @return The registered benchmarks whose name contains `filter`, sorted by name.
+std::vector<Benchmark> getMatchingBenchmarks(const std::string &filter)
+{
+    std::vector<Benchmark> benchmarks;
+    for (const Benchmark &benchmark : getBenchmarks())
+    {
+        if (std::string(benchmark.name).find(filter) != std::string::npos)
+        {
+            benchmarks.push_back(benchmark);
+        }
+    }
+    std::sort(
+        benchmarks.begin(),
+        benchmarks.end(),
+        [](const Benchmark &a, const Benchmark &b) { return std::string(a.name) < b.name; });
+    return benchmarks;
+}
+
+#ifdef PLATFORM_HOSTED
+void printResult(const Result &result)
+{
+    printf("%-56s %14.1f ns %14.1f ns %12lld", result.name, result.median, result.min,
+           static_cast<long long>(result.iterations));
+    if (result.bytesPerIteration > 0)
+    {
+        printf("  %10.2f MB/s", result.bytesPerIteration * 1e3 / result.median);
+    }
+    if (result.itemsPerIteration > 0)
+    {
+        printf("  %10.1f ns/item", result.median / result.itemsPerIteration);
+    }
+    if (result.bytesPerIteration > 0 && result.bytesProducedPerIteration > 0)
+    {
+        printf(
+            "  %6.3f ratio",
+            static_cast<double>(result.bytesProducedPerIteration) / result.bytesPerIteration);
+    }
+    if (result.maxCall > 0)
+    {
+        printf("  %10.1f ns/call max", result.maxCall);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+bool writeJson(const std::string &path, const std::vector<Result> &results, const Options &options)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"min_time_s\": %g,\n", options.minTime);
+    fprintf(file, "    \"repetitions\": %d\n", options.repetitions);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &result = results[i];
+        // Benchmark names are C identifiers joined by '/', so they need no escaping
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"name\": \"%s\",\n", result.name);
+        fprintf(file, "      \"iterations\": %lld,\n", static_cast<long long>(result.iterations));
+        fprintf(file, "      \"median_ns\": %.3f,\n", result.median);
+        fprintf(file, "      \"min_ns\": %.3f,\n", result.min);
+        fprintf(file, "      \"max_ns\": %.3f,\n", result.max);
+        fprintf(
+            file,
+            "      \"bytes_per_iteration\": %lld,\n",
+            static_cast<long long>(result.bytesPerIteration));
+        fprintf(
+            file,
+            "      \"items_per_iteration\": %lld,\n",
+            static_cast<long long>(result.itemsPerIteration));
+        fprintf(
+            file,
+            "      \"bytes_produced_per_iteration\": %lld,\n",
+            static_cast<long long>(result.bytesProducedPerIteration));
+        fprintf(file, "      \"max_call_ns\": %.3f\n", result.maxCall);
+        fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    return fclose(file) == 0;
+}
+#else
+/// Prints `value` with one decimal, without relying on the stream's floating point support.
+void printTenths(modm::IOStream &stream, double value)
+{
+    const uint64_t tenths = static_cast<uint64_t>(value * 10 + 0.5);
+    stream.printf(
+        "%lu.%lu",
+        static_cast<unsigned long>(tenths / 10),
+        static_cast<unsigned long>(tenths % 10));
+}
+
+void printResult(modm::IOStream &stream, const Result &result)
+{
+    stream.printf("%-48s ", result.name);
+    printTenths(stream, result.median);
+    stream << " cycles, min ";
+    printTenths(stream, result.min);
+    stream.printf(" cycles, %lu iterations", static_cast<unsigned long>(result.iterations));
+    if (result.bytesPerIteration > 0)
+    {
+        stream << ", ";
+        printTenths(stream, result.median / result.bytesPerIteration);
+        stream << " cycles/byte";
+    }
+    if (result.itemsPerIteration > 0)
+    {
+        stream << ", ";
+        printTenths(stream, result.median / result.itemsPerIteration);
+        stream << " cycles/item";
+    }
+    if (result.bytesPerIteration > 0 && result.bytesProducedPerIteration > 0)
+    {
+        stream << ", output ";
+        printTenths(stream, 100.0 * result.bytesProducedPerIteration / result.bytesPerIteration);
+        stream << "% of input";
+    }
+    if (result.maxCall > 0)
+    {
+        stream << ", max ";
+        printTenths(stream, result.maxCall);
+        stream << " cycles/call";
+    }
+    stream << modm::endl;
+    stream.flush();
+}
+
+void printJson(modm::IOStream &stream, const Result &result)
+{
+    stream.printf(
+        "{\"name\": \"%s\", \"iterations\": %lu, \"median_cycles\": ",
+        result.name,
+        static_cast<unsigned long>(result.iterations));
+    printTenths(stream, result.median);
+    stream << ", \"min_cycles\": ";
+    printTenths(stream, result.min);
+    stream << ", \"max_cycles\": ";
+    printTenths(stream, result.max);
+    stream.printf(
+        ", \"bytes_per_iteration\": %lu, \"items_per_iteration\": %lu, "
+        "\"bytes_produced_per_iteration\": %lu, \"max_call_cycles\": ",
+        static_cast<unsigned long>(result.bytesPerIteration),
+        static_cast<unsigned long>(result.itemsPerIteration),
+        static_cast<unsigned long>(result.bytesProducedPerIteration));
+    printTenths(stream, result.maxCall);
+    stream << "}";
+    stream << modm::endl;
+    stream.flush();
+}
+#endif
+}  // namespace
+
+#ifdef PLATFORM_HOSTED
+int64_t getTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#else
+int64_t getTime() { return tap::arch::clock::getCycleCount64(); }
+#endif
+
+State::Iterator State::begin()
+{
+    startTime = getTime();
+    return Iterator(this, iterations);
+}
+
+void State::stopTimer() { elapsedTime = getTime() - startTime; }
+
+int registerBenchmark(const char *name, BenchmarkFunction function)
+{
+    getBenchmarks().push_back({name, function});
+    return static_cast<int>(getBenchmarks().size());
+}
+
+#ifdef PLATFORM_HOSTED
+int runBenchmarks(const Options &options)
+{
+    printf("%-56s %17s %17s %12s\n", "Benchmark", "Median", "Min", "Iterations");
+    std::vector<Result> results;
+    for (const Benchmark &benchmark : getMatchingBenchmarks(options.filter))
+    {
+        results.push_back(runBenchmark(benchmark, options));
+        printResult(results.back());
+    }
+
+    if (!options.outputPath.empty() && !writeJson(options.outputPath, results, options))
+    {
+        fprintf(stderr, "failed to write benchmark results to %s\n", options.outputPath.c_str());
+        return 1;
+    }
+    return 0;
+}
+#else
+void runBenchmarks(const Options &options, modm::IOStream &stream)
+{
+    stream.printf(
+        "Running benchmarks at %lu Hz, %d repetitions of at least %lu ms each",
+        static_cast<unsigned long>(Board::SystemClock::Frequency),
+        options.repetitions,
+        static_cast<unsigned long>(options.minTime * 1000));
+    stream << modm::endl;
+    stream.flush();
+
+    std::vector<Result> results;
+    for (const Benchmark &benchmark : getMatchingBenchmarks(options.filter))
+    {
+        results.push_back(runBenchmark(benchmark, options));
+        printResult(stream, results.back());
+    }
+
+    stream << "BEGIN RESULTS" << modm::endl;
+    for (const Result &result : results)
+    {
+        printJson(stream, result);
+    }
+    stream << "END RESULTS" << modm::endl;
+    stream.flush();
+}
+#endif
+}  // namespace tap::benchmark
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_BENCHMARK_HPP_
+#define TAPROOT_BENCHMARK_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef PLATFORM_HOSTED
+#include "modm/io/iostream.hpp"
+#endif
+
+namespace tap::benchmark
+{
+#ifdef PLATFORM_HOSTED
+/// The unit benchmarks are timed in, nanoseconds of the host's steady clock.
+inline constexpr const char TIME_UNIT[] = "ns";
+#else
+/// The unit benchmarks are timed in, core clock cycles counted by the DWT cycle counter.
+inline constexpr const char TIME_UNIT[] = "cycles";
+#endif
+
+/// @return The current time in `TIME_UNIT`s.
+int64_t getTime();
+
+/**
+ * Passed to each benchmark, which runs the code being measured once per iteration of a range
+ * based for loop over the state. Code before and after the loop is setup and teardown and isn't
+ * timed:
+ *
+ * ```cpp
+ * TAPROOT_BENCHMARK(CRC16, ref_serial_frame)
+ * {
+ *     uint8_t frame[120] = {};
+ *     for (auto _ : state)
+ *     {
+ *         doNotOptimize(calculateCRC16(frame, sizeof(frame)));
+ *     }
+ *     state.setBytesProcessed(sizeof(frame));
+ * }
+ * ```
+ */
+class State
+{
+public:
+    class Iterator
+    {
+    public:
+        /**
+         * What the loop variable holds. The destructor isn't trivial so that the unused loop
+         * variable isn't warned about.
+         */
+        struct Value
+        {
+            ~Value() {}
+        };
+
+        Iterator(State *state, int64_t remaining) : state(state), remaining(remaining) {}
+
+        Value operator*() const { return Value(); }
+        Iterator &operator++()
+        {
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const Iterator &)
+        {
+            if (remaining > 0)
+            {
+                return true;
+            }
+            state->stopTimer();
+            return false;
+        }
+
+    private:
+        State *state;
+        int64_t remaining;
+    };
+
+    explicit State(int64_t iterations) : iterations(iterations) {}
+
+    /// Starts the timer, the timer stops when the loop ends.
+    Iterator begin();
+    Iterator end() { return Iterator(this, 0); }
+
+    int64_t getIterations() const { return iterations; }
+
+    /// Sets the number of bytes each iteration processes, to report throughput.
+    void setBytesProcessed(int64_t bytes) { bytesPerIteration = bytes; }
+
+    /// Sets the number of items (e.g. frames or messages) each iteration processes.
+    void setItemsProcessed(int64_t items) { itemsPerIteration = items; }
+
+    /**
+     * Sets the number of bytes each iteration produces, e.g. the encoded length of a compression
+     * benchmark, to report the ratio of bytes produced to bytes processed.
+     */
+    void setBytesProduced(int64_t bytes) { bytesProducedPerIteration = bytes; }
+
+    int64_t getBytesProcessed() const { return bytesPerIteration; }
+    int64_t getItemsProcessed() const { return itemsPerIteration; }
+    int64_t getBytesProduced() const { return bytesProducedPerIteration; }
+
+    /// @return The time spent in the loop, in `TIME_UNIT`s.
+    int64_t getElapsedTime() const { return elapsedTime; }
+
+    /**
+     * Calls `function` and times the call, so the longest call is reported alongside the average
+     * time, e.g. the longest a parser takes in any one tick. The time includes the overhead of
+     * reading the clock, and on a host, any time the OS preempts the benchmark, so the longest
+     * call is most meaningful on target.
+     */
+    template <typename Function>
+    void timeCall(Function &&function)
+    {
+        const int64_t start = getTime();
+        function();
+        maxCallTime = std::max(maxCallTime, getTime() - start);
+    }
+
+    /// @return The longest call timed by `timeCall`, in `TIME_UNIT`s, or 0 if none were timed.
+    int64_t getMaxCallTime() const { return maxCallTime; }
+
+private:
+    int64_t iterations;
+    int64_t bytesPerIteration = 0;
+    int64_t itemsPerIteration = 0;
+    int64_t bytesProducedPerIteration = 0;
+    int64_t startTime = 0;
+    int64_t elapsedTime = 0;
+    int64_t maxCallTime = 0;
+
+    void stopTimer();
+};
+
+using BenchmarkFunction = void (*)(State &state);
+
+/// Adds a benchmark to the list run by `runBenchmarks`, see `TAPROOT_BENCHMARK`.
+int registerBenchmark(const char *name, BenchmarkFunction function);
+
+struct Options
+{
+    /// Only benchmarks whose name contains this are run.
+    std::string filter;
+#ifdef PLATFORM_HOSTED
+    /// Path of the JSON results file, or empty to not write one.
+    std::string outputPath = "benchmark-results.json";
+#endif
+    /// Minimum time each repetition of a benchmark runs for, in seconds.
+    double minTime = 0.1;
+    /// Number of times each benchmark is repeated, the reported time is the median.
+    int repetitions = 5;
+};
+
+#ifdef PLATFORM_HOSTED
+/**
+ * Runs all registered benchmarks matching the options, printing a table of the results to stdout
+ * and writing them to a JSON file that can be diffed between releases.
+ *
+ * @return 0 on success, nonzero if the results file couldn't be written.
+ */
+int runBenchmarks(const Options &options);
+#else
+/**
+ * Runs all registered benchmarks matching the options, printing a table of the results in core
+ * clock cycles to `stream`, followed by one JSON object per benchmark between `BEGIN RESULTS` and
+ * `END RESULTS` lines so the results can be captured from a serial console and diffed.
+ *
+ * `tap::arch::clock::enableCycleCounter` must have been called. Interrupts are left enabled, so
+ * keep other work on the board to a minimum while benchmarks run; the median of the repetitions
+ * filters out most of the noise interrupts add.
+ */
+void runBenchmarks(const Options &options, modm::IOStream &stream);
+#endif
+
+/// Prevents the compiler from optimizing away the computation of `value`.
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Prevents the compiler from optimizing away writes to memory.
+inline void clobberMemory() { asm volatile("" : : : "memory"); }
+}  // namespace tap::benchmark
+
+/**
+ * Defines and registers a benchmark named "group/name". The body has access to a
+ * `tap::benchmark::State &state`.
+ */
+#define TAPROOT_BENCHMARK(group, name)                                                   \
+    static void group##_##name##_benchmark(tap::benchmark::State &);                     \
+    static const int group##_##name##_registered =                                       \
+        tap::benchmark::registerBenchmark(#group "/" #name, group##_##name##_benchmark); \
+    static void group##_##name##_benchmark([[maybe_unused]] tap::benchmark::State &state)
+
+#endif  // TAPROOT_BENCHMARK_HPP_
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "benchmark.hpp"
+
+static const char USAGE[] =
+    "Usage: benchmarks [--filter=<substring>] [--output=<path>] [--min-time=<seconds>]\n"
+    "                  [--repetitions=<count>]\n"
+    "    --filter       only run benchmarks whose name contains the substring\n"
+    "    --output       path of the JSON results file, empty to not write one\n"
+    "                   (default benchmark-results.json)\n"
+    "    --min-time     minimum time each repetition runs for (default 0.1)\n"
+    "    --repetitions  number of repetitions, the median is reported (default 5)\n";
+
+/// @return The value of `arg` if it is `--<name>=<value>`, otherwise `nullptr`.
+static const char *getOption(const char *arg, const char *name)
+{
+    const size_t nameLength = strlen(name);
+    if (strncmp(arg, "--", 2) == 0 && strncmp(arg + 2, name, nameLength) == 0 &&
+        arg[2 + nameLength] == '=')
+    {
+        return arg + 3 + nameLength;
+    }
+    return nullptr;
+}
+
+int main(int argc, char **argv)
+{
+    tap::benchmark::Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *value;
+        if ((value = getOption(argv[i], "filter")) != nullptr)
+        {
+            options.filter = value;
+        }
+        else if ((value = getOption(argv[i], "output")) != nullptr)
+        {
+            options.outputPath = value;
+        }
+        else if ((value = getOption(argv[i], "min-time")) != nullptr)
+        {
+            options.minTime = atof(value);
+        }
+        else if ((value = getOption(argv[i], "repetitions")) != nullptr)
+        {
+            options.repetitions = atoi(value);
+        }
+        else
+        {
+            fputs(USAGE, stderr);
+            return 1;
+        }
+    }
+
+    return tap::benchmark::runBenchmarks(options);
+}
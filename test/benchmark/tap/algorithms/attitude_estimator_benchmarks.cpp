@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/MahonyAHRS.h"
+#include "tap/algorithms/attitude_eskf.hpp"
+#include "tap/algorithms/math_user_utils.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * The time per `updateIMU` of `Mahony` and `AttitudeEskf` is benchmarked on a robot turning and
+ * tilting. Their accuracy is compared in attitude_eskf_tests.cpp.
+ */
+
+static constexpr float SAMPLE_FREQUENCY = 1000;
+/// Number of precomputed samples cycled through, so the corpus is the same every run.
+static constexpr int NUM_SAMPLES = 1024;
+
+struct ImuSample
+{
+    float gyro[3];
+    float acc[3];
+};
+
+static void fillSamples(ImuSample (&samples)[NUM_SAMPLES])
+{
+    for (int i = 0; i < NUM_SAMPLES; i++)
+    {
+        const float t = i / SAMPLE_FREQUENCY;
+        const float roll = 0.2f * sinf(2 * M_PI * 0.5f * t);
+        samples[i] = {
+            {20 * sinf(2 * M_PI * 0.5f * t), 25 * sinf(2 * M_PI * 0.3f * t), 90 * cosf(t)},
+            {0, ACCELERATION_GRAVITY * sinf(roll), ACCELERATION_GRAVITY * cosf(roll)}};
+    }
+}
+
+static void benchmarkUpdateIMU(tap::benchmark::State &state, AttitudeEstimator &estimator)
+{
+    static ImuSample samples[NUM_SAMPLES];
+    fillSamples(samples);
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        const ImuSample &s = samples[i];
+        estimator.updateIMU(s.gyro[0], s.gyro[1], s.gyro[2], s.acc[0], s.acc[1], s.acc[2]);
+        doNotOptimize(estimator.getYaw());
+        i = (i + 1) % NUM_SAMPLES;
+    }
+}
+
+TAPROOT_BENCHMARK(AttitudeEstimator, mahony_updateIMU)
+{
+    Mahony mahony;
+    mahony.begin(SAMPLE_FREQUENCY, 0.1f, 0);
+    benchmarkUpdateIMU(state, mahony);
+}
+
+TAPROOT_BENCHMARK(AttitudeEstimator, eskf_updateIMU)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(SAMPLE_FREQUENCY);
+    benchmarkUpdateIMU(state, eskf);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/ballistics.hpp"
+#include "tap/algorithms/ballistics_table.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms::ballistics;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * Aiming at a moving target is benchmarked with `findTargetProjectileIntersection`, with
+ * `BallisticsSolver`, both solving from scratch each call and warm started as in a control loop
+ * where the target moves a little between calls, and with a `BallisticsTable`.
+ */
+
+static constexpr float CONTROL_LOOP_PERIOD = 0.002f;
+static constexpr float BULLET_VELOCITY = 25;
+static constexpr float TARGET_DISTANCE = 5;
+
+/// A target 5 m away strafing at 2 m/s, at control loop `i`.
+static SecondOrderKinematicState strafingTarget(int i)
+{
+    const float t = i * CONTROL_LOOP_PERIOD;
+    return SecondOrderKinematicState(
+        modm::Vector3f(TARGET_DISTANCE, 2 * sinf(t), 0.3f),
+        modm::Vector3f(0, 2 * cosf(t), 0),
+        modm::Vector3f(0, 0, 0));
+}
+
+TAPROOT_BENCHMARK(Ballistics, findTargetProjectileIntersection_strafing_target)
+{
+    float pitch, yaw, travelTime;
+    int i = 0;
+    for (auto _ : state)
+    {
+        findTargetProjectileIntersection(
+            strafingTarget(i++),
+            BULLET_VELOCITY,
+            3,
+            &pitch,
+            &yaw,
+            &travelTime);
+        doNotOptimize(pitch);
+    }
+}
+
+TAPROOT_BENCHMARK(Ballistics, solver_cold_strafing_target)
+{
+    BallisticsSolver solver({DragModel::Type::QUADRATIC, 0.02f});
+    BallisticsSolution solution;
+    int i = 0;
+    for (auto _ : state)
+    {
+        solver.resetWarmStart();
+        solver.solve(strafingTarget(i++), BULLET_VELOCITY, &solution);
+        doNotOptimize(solution.turretPitch);
+    }
+}
+
+TAPROOT_BENCHMARK(Ballistics, solver_warm_strafing_target)
+{
+    BallisticsSolver solver({DragModel::Type::QUADRATIC, 0.02f});
+    BallisticsSolution solution;
+    int i = 0;
+    for (auto _ : state)
+    {
+        solver.solve(strafingTarget(i++), BULLET_VELOCITY, &solution);
+        doNotOptimize(solution.turretPitch);
+    }
+}
+
+TAPROOT_BENCHMARK(Ballistics, table_strafing_target)
+{
+    static BallisticsTable<32, 16> table;
+    table.initialize(
+        BULLET_VELOCITY,
+        0.5f,
+        8.5f,
+        -1.0f,
+        2.0f,
+        {DragModel::Type::QUADRATIC, 0.02f});
+
+    float pitch, yaw, travelTime;
+    int i = 0;
+    for (auto _ : state)
+    {
+        table.findTargetProjectileIntersection(strafingTarget(i++), 3, &pitch, &yaw, &travelTime);
+        doNotOptimize(pitch);
+    }
+}
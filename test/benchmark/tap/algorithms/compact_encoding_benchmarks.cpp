@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/compact_encoding.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/*
+ * The corpus models a log of DJI motor feedback recorded at 1 kHz, the bulk of taproot's
+ * telemetry: for each of 4 motors its encoder position, RPM, torque current and temperature,
+ * which on the CAN bus take 7 bytes per motor.
+ */
+static constexpr int NUM_MOTORS = 4;
+static constexpr int FIELDS_PER_MOTOR = 4;
+static constexpr int FIELDS_PER_RECORD = NUM_MOTORS * FIELDS_PER_MOTOR;
+static constexpr int RAW_RECORD_LENGTH = NUM_MOTORS * 7;
+static constexpr int NUM_RECORDS = 256;
+static constexpr uint32_t RAW_LENGTH = NUM_RECORDS * RAW_RECORD_LENGTH;
+
+struct Corpus
+{
+    int32_t records[NUM_RECORDS][FIELDS_PER_RECORD];
+    /// The records as sent on the CAN bus, big endian like DJI motor feedback.
+    uint8_t raw[RAW_LENGTH];
+};
+
+static const Corpus &getCorpus()
+{
+    static Corpus corpus;
+    static bool generated = false;
+    if (generated)
+    {
+        return corpus;
+    }
+    uint32_t noise = 1;
+    float position[NUM_MOTORS] = {};
+    for (int i = 0; i < NUM_RECORDS; i++)
+    {
+        for (int motor = 0; motor < NUM_MOTORS; motor++)
+        {
+            // Each motor follows a slow speed profile with a little sensor noise
+            noise = noise * 1664525 + 1013904223;
+            const float rpm = 3000 * sinf(0.01f * i + motor) + static_cast<int>(noise >> 29) - 4;
+            position[motor] = fmodf(position[motor] + rpm * 8192 / 60'000 + 8192, 8192);
+            const int32_t fields[FIELDS_PER_MOTOR] = {
+                static_cast<int32_t>(position[motor]),
+                static_cast<int32_t>(rpm),
+                static_cast<int32_t>(rpm * 2) + static_cast<int>(noise >> 27) - 16,
+                40 + motor,
+            };
+            uint8_t *raw = corpus.raw + i * RAW_RECORD_LENGTH + motor * 7;
+            for (int field = 0; field < FIELDS_PER_MOTOR; field++)
+            {
+                corpus.records[i][motor * FIELDS_PER_MOTOR + field] = fields[field];
+            }
+            for (int field = 0; field < 3; field++)
+            {
+                raw[2 * field] = fields[field] >> 8;
+                raw[2 * field + 1] = fields[field];
+            }
+            raw[6] = fields[3];
+        }
+    }
+    generated = true;
+    return corpus;
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, encodeVarint_zigZag_fields)
+{
+    const Corpus &corpus = getCorpus();
+    static uint8_t out[NUM_RECORDS * FIELDS_PER_RECORD * MAX_VARINT_LENGTH];
+
+    uint32_t length = 0;
+    for (auto _ : state)
+    {
+        length = 0;
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            for (int field = 0; field < FIELDS_PER_RECORD; field++)
+            {
+                length += encodeVarint(
+                    encodeZigZag(corpus.records[i][field]),
+                    out + length,
+                    sizeof(out) - length);
+            }
+        }
+        doNotOptimize(length);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setBytesProduced(length);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, encodeDeltas_records)
+{
+    const Corpus &corpus = getCorpus();
+    static uint8_t out[NUM_RECORDS * FIELDS_PER_RECORD * MAX_VARINT_LENGTH];
+    static const int32_t zeros[FIELDS_PER_RECORD] = {};
+
+    uint32_t length = 0;
+    for (auto _ : state)
+    {
+        length = 0;
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            length += encodeDeltas(
+                corpus.records[i],
+                i == 0 ? zeros : corpus.records[i - 1],
+                FIELDS_PER_RECORD,
+                out + length,
+                sizeof(out) - length);
+        }
+        doNotOptimize(length);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setBytesProduced(length);
+    state.setItemsProcessed(NUM_RECORDS);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, decodeDeltas_records)
+{
+    const Corpus &corpus = getCorpus();
+    static uint8_t encoded[NUM_RECORDS * FIELDS_PER_RECORD * MAX_VARINT_LENGTH];
+    static int32_t records[NUM_RECORDS][FIELDS_PER_RECORD];
+    static const int32_t zeros[FIELDS_PER_RECORD] = {};
+
+    uint32_t length = 0;
+    for (int i = 0; i < NUM_RECORDS; i++)
+    {
+        length += encodeDeltas(
+            corpus.records[i],
+            i == 0 ? zeros : corpus.records[i - 1],
+            FIELDS_PER_RECORD,
+            encoded + length,
+            sizeof(encoded) - length);
+    }
+
+    for (auto _ : state)
+    {
+        uint32_t position = 0;
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            position += decodeDeltas(
+                encoded + position,
+                length - position,
+                i == 0 ? zeros : records[i - 1],
+                records[i],
+                FIELDS_PER_RECORD);
+        }
+        doNotOptimize(records);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setItemsProcessed(NUM_RECORDS);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, BitWriter_pack_records)
+{
+    const Corpus &corpus = getCorpus();
+    // Encoder positions fit in 13 bits, speed and current in 16 and temperature in 8
+    static constexpr int FIELD_BITS[FIELDS_PER_MOTOR] = {13, 16, 16, 8};
+    static uint8_t out[RAW_LENGTH];
+
+    uint32_t length = 0;
+    for (auto _ : state)
+    {
+        BitWriter writer(out, sizeof(out));
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            for (int field = 0; field < FIELDS_PER_RECORD; field++)
+            {
+                writer.write(corpus.records[i][field], FIELD_BITS[field % FIELDS_PER_MOTOR]);
+            }
+        }
+        length = writer.finish();
+        doNotOptimize(length);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setBytesProduced(length);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, Lz4BlockCompressor_raw_records)
+{
+    const Corpus &corpus = getCorpus();
+    static Lz4BlockCompressor compressor;
+    static uint8_t out[Lz4BlockCompressor::getMaxCompressedLength(RAW_LENGTH)];
+
+    uint32_t length = 0;
+    for (auto _ : state)
+    {
+        length = compressor.compress(corpus.raw, RAW_LENGTH, out, sizeof(out));
+        doNotOptimize(length);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setBytesProduced(length);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, Lz4BlockCompressor_delta_records)
+{
+    const Corpus &corpus = getCorpus();
+    static Lz4BlockCompressor compressor;
+    static uint8_t encoded[NUM_RECORDS * FIELDS_PER_RECORD * MAX_VARINT_LENGTH];
+    static uint8_t out[Lz4BlockCompressor::getMaxCompressedLength(sizeof(encoded))];
+    static const int32_t zeros[FIELDS_PER_RECORD] = {};
+
+    uint32_t length = 0;
+    for (auto _ : state)
+    {
+        uint32_t encodedLength = 0;
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            encodedLength += encodeDeltas(
+                corpus.records[i],
+                i == 0 ? zeros : corpus.records[i - 1],
+                FIELDS_PER_RECORD,
+                encoded + encodedLength,
+                sizeof(encoded) - encodedLength);
+        }
+        length = compressor.compress(encoded, encodedLength, out, sizeof(out));
+        doNotOptimize(length);
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+    state.setBytesProduced(length);
+}
+
+TAPROOT_BENCHMARK(CompactEncoding, decompressLz4Block_raw_records)
+{
+    const Corpus &corpus = getCorpus();
+    static Lz4BlockCompressor compressor;
+    static uint8_t compressed[Lz4BlockCompressor::getMaxCompressedLength(RAW_LENGTH)];
+    static uint8_t out[RAW_LENGTH];
+    const uint32_t length =
+        compressor.compress(corpus.raw, RAW_LENGTH, compressed, sizeof(compressed));
+
+    for (auto _ : state)
+    {
+        uint32_t decompressedLength;
+        doNotOptimize(
+            decompressLz4Block(compressed, length, out, sizeof(out), &decompressedLength));
+    }
+    state.setBytesProcessed(RAW_LENGTH);
+}
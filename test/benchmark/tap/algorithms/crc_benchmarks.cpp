@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tap/algorithms/crc.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/// The largest ref serial graphic message, the largest frame CRCs are computed over.
+static constexpr uint32_t REF_SERIAL_FRAME_LENGTH = 120;
+static constexpr uint32_t REF_SERIAL_HEADER_LENGTH = 4;
+static constexpr uint32_t LARGE_BLOCK_LENGTH = 4096;
+
+template <uint32_t LENGTH>
+static void fillCorpus(uint8_t (&data)[LENGTH])
+{
+    for (uint32_t i = 0; i < LENGTH; i++)
+    {
+        data[i] = i * 31;
+    }
+}
+
+TAPROOT_BENCHMARK(CRC8, ref_serial_header)
+{
+    uint8_t header[REF_SERIAL_HEADER_LENGTH];
+    fillCorpus(header);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC8(header, sizeof(header)));
+    }
+    state.setBytesProcessed(sizeof(header));
+}
+
+TAPROOT_BENCHMARK(CRC16, ref_serial_frame)
+{
+    uint8_t frame[REF_SERIAL_FRAME_LENGTH];
+    fillCorpus(frame);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC16(frame, sizeof(frame)));
+    }
+    state.setBytesProcessed(sizeof(frame));
+}
+
+TAPROOT_BENCHMARK(CRC16, bytewise_ref_serial_frame)
+{
+    uint8_t frame[REF_SERIAL_FRAME_LENGTH];
+    fillCorpus(frame);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC16Bytewise(frame, sizeof(frame)));
+    }
+    state.setBytesProcessed(sizeof(frame));
+}
+
+TAPROOT_BENCHMARK(CRC16, slice_by_4_ref_serial_frame)
+{
+    uint8_t frame[REF_SERIAL_FRAME_LENGTH];
+    fillCorpus(frame);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC16Sliced<4>(frame, sizeof(frame)));
+    }
+    state.setBytesProcessed(sizeof(frame));
+}
+
+TAPROOT_BENCHMARK(CRC16, slice_by_8_ref_serial_frame)
+{
+    uint8_t frame[REF_SERIAL_FRAME_LENGTH];
+    fillCorpus(frame);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC16Sliced<8>(frame, sizeof(frame)));
+    }
+    state.setBytesProcessed(sizeof(frame));
+}
+
+TAPROOT_BENCHMARK(CRC16, large_block)
+{
+    static uint8_t block[LARGE_BLOCK_LENGTH];
+    fillCorpus(block);
+
+    for (auto _ : state)
+    {
+        doNotOptimize(calculateCRC16(block, sizeof(block)));
+    }
+    state.setBytesProcessed(sizeof(block));
+}
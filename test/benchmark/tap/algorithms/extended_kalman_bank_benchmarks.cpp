@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tap/algorithms/extended_kalman.hpp"
+#include "tap/algorithms/extended_kalman_bank.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * One `ExtendedKalmanBank::filterData` call is benchmarked against a `filterData` call per channel
+ * on individual `ExtendedKalman`s, for as many channels as a robot filters each tick.
+ */
+
+static constexpr int CHANNELS = 24;
+
+TAPROOT_BENCHMARK(ExtendedKalmanBank, individual_filters_24_channels)
+{
+    ExtendedKalman *filters[CHANNELS];
+    for (int i = 0; i < CHANNELS; i++)
+    {
+        // Allocated separately, as filters owned by different subsystems would be
+        filters[i] = new ExtendedKalman(1.0f, 2.0f);
+    }
+
+    int t = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < CHANNELS; i++)
+        {
+            doNotOptimize(filters[i]->filterData(static_cast<float>((t + i) % 17)));
+        }
+        t++;
+    }
+    state.setItemsProcessed(CHANNELS);
+
+    for (ExtendedKalman *filter : filters)
+    {
+        delete filter;
+    }
+}
+
+TAPROOT_BENCHMARK(ExtendedKalmanBank, filterData_24_channels)
+{
+    ExtendedKalmanBank<CHANNELS> bank(1.0f, 2.0f);
+    float data[CHANNELS];
+
+    int t = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < CHANNELS; i++)
+        {
+            data[i] = static_cast<float>((t + i) % 17);
+        }
+        bank.filterData(data);
+        doNotOptimize(bank.getLastFiltered(CHANNELS - 1));
+        t++;
+    }
+    state.setItemsProcessed(CHANNELS);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/fast_math.hpp"
+
+#include "benchmark.hpp"
+
+namespace fastmath = tap::algorithms::fastmath;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * The `fastmath` approximations are benchmarked alongside the libm functions they replace. The
+ * host's libm is much faster relative to these than newlib's is on the Cortex-M4F, so compare
+ * them on target.
+ */
+
+static constexpr int NUM_ANGLES = 256;
+
+/// Angles spread over a few periods, so every quadrant is exercised.
+static void fillAngles(float (&angles)[NUM_ANGLES])
+{
+    for (int i = 0; i < NUM_ANGLES; i++)
+    {
+        angles[i] = i * (20.0f / NUM_ANGLES) - 10.0f;
+    }
+}
+
+TAPROOT_BENCHMARK(FastMath, libm_sincos)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (float angle : angles)
+        {
+            doNotOptimize(sinf(angle) + cosf(angle));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, sincos)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (float angle : angles)
+        {
+            const fastmath::SinCos sc = fastmath::sincos(angle);
+            doNotOptimize(sc.sin + sc.cos);
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, sincos_table)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (float angle : angles)
+        {
+            doNotOptimize(fastmath::sinTable(angle) + fastmath::cosTable(angle));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, libm_atan2)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_ANGLES; i++)
+        {
+            doNotOptimize(atan2f(angles[i], angles[(i + 37) % NUM_ANGLES]));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, atan2)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_ANGLES; i++)
+        {
+            doNotOptimize(fastmath::atan2(angles[i], angles[(i + 37) % NUM_ANGLES]));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, libm_asin)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (float angle : angles)
+        {
+            doNotOptimize(asinf(angle * 0.1f));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
+
+TAPROOT_BENCHMARK(FastMath, asin)
+{
+    float angles[NUM_ANGLES];
+    fillAngles(angles);
+
+    for (auto _ : state)
+    {
+        for (float angle : angles)
+        {
+            doNotOptimize(fastmath::asin(angle * 0.1f));
+        }
+    }
+    state.setItemsProcessed(NUM_ANGLES);
+}
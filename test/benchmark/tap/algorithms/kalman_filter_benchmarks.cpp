@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/kalman_filter.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/// Number of precomputed measurements cycled through, so the corpus is the same every run.
+static constexpr int NUM_MEASUREMENTS = 256;
+
+/**
+ * A chain of integrators, each state the derivative of the one before, where each measurement
+ * observes one state mixed with the next.
+ */
+template <uint16_t STATES, uint16_t INPUTS>
+struct IntegratorChain
+{
+    float A[STATES * STATES] = {};
+    float C[INPUTS * STATES] = {};
+    float Q[STATES * STATES] = {};
+    float R[INPUTS * INPUTS] = {};
+    float P0[STATES * STATES] = {};
+    float x0[STATES] = {};
+    CMSISMat<INPUTS, 1> measurements[NUM_MEASUREMENTS];
+
+    IntegratorChain()
+    {
+        for (int i = 0; i < STATES; i++)
+        {
+            A[i * STATES + i] = 1;
+            if (i + 1 < STATES)
+            {
+                A[i * STATES + i + 1] = 0.01f;
+            }
+            Q[i * STATES + i] = 1E-3f;
+            P0[i * STATES + i] = 1;
+        }
+        for (int m = 0; m < INPUTS; m++)
+        {
+            C[m * STATES + m] = 1;
+            C[m * STATES + (m + 1) % STATES] += 0.5f;
+            R[m * INPUTS + m] = 0.1f * (m + 1);
+        }
+        for (int i = 0; i < NUM_MEASUREMENTS; i++)
+        {
+            for (int m = 0; m < INPUTS; m++)
+            {
+                measurements[i].data[m] = sinf(0.01f * i + m);
+            }
+        }
+    }
+};
+
+template <uint16_t STATES, uint16_t INPUTS>
+static void benchmarkPerformUpdate(tap::benchmark::State &state)
+{
+    IntegratorChain<STATES, INPUTS> model;
+    KalmanFilter<STATES, INPUTS> filter(model.A, model.C, model.Q, model.R, model.P0);
+    filter.init(model.x0);
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        filter.performUpdate(model.measurements[i]);
+        doNotOptimize(filter.getStateVectorAsMatrix());
+        i = (i + 1) % NUM_MEASUREMENTS;
+    }
+}
+
+template <uint16_t STATES, uint16_t INPUTS>
+static void benchmarkPerformSequentialUpdate(tap::benchmark::State &state)
+{
+    IntegratorChain<STATES, INPUTS> model;
+    KalmanFilter<STATES, INPUTS> filter(model.A, model.C, model.Q, model.R, model.P0);
+    filter.init(model.x0);
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        filter.performSequentialUpdate(model.measurements[i]);
+        doNotOptimize(filter.getStateVectorAsMatrix());
+        i = (i + 1) % NUM_MEASUREMENTS;
+    }
+}
+
+template <uint16_t STATES, uint16_t INPUTS>
+static void benchmarkSteadyStateUpdate(tap::benchmark::State &state)
+{
+    IntegratorChain<STATES, INPUTS> model;
+    KalmanFilter<STATES, INPUTS> filter(model.A, model.C, model.Q, model.R, model.P0);
+    filter.init(model.x0);
+    filter.computeSteadyStateGain();
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        filter.performUpdate(model.measurements[i]);
+        doNotOptimize(filter.getStateVectorAsMatrix());
+        i = (i + 1) % NUM_MEASUREMENTS;
+    }
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performUpdate_2_states_1_input)
+{
+    benchmarkPerformUpdate<2, 1>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performUpdate_6_states_3_inputs)
+{
+    benchmarkPerformUpdate<6, 3>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performUpdate_9_states_3_inputs)
+{
+    benchmarkPerformUpdate<9, 3>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performSequentialUpdate_9_states_3_inputs)
+{
+    benchmarkPerformSequentialUpdate<9, 3>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performUpdate_9_states_9_inputs)
+{
+    benchmarkPerformUpdate<9, 9>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, performSequentialUpdate_9_states_9_inputs)
+{
+    benchmarkPerformSequentialUpdate<9, 9>(state);
+}
+
+TAPROOT_BENCHMARK(KalmanFilter, steady_state_performUpdate_9_states_3_inputs)
+{
+    benchmarkSteadyStateUpdate<9, 3>(state);
+}
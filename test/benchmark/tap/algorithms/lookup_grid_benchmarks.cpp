@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tap/algorithms/lookup_grid.hpp"
+#include "tap/algorithms/math_user_utils.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/// `LookupGrid2D` is benchmarked against `interpolateLinear2D` on the same grid.
+
+static constexpr int NUM_POINTS = 256;
+
+using Grid = LookupGrid2D<float, 17, 17>;
+
+static void fillGrid(Grid &grid)
+{
+    for (size_t i = 0; i < 17; i++)
+    {
+        for (size_t j = 0; j < 17; j++)
+        {
+            grid.getValues()[i][j] = grid.getX(i) * grid.getY(j);
+        }
+    }
+}
+
+/// Coordinates covering the grid and a little past its edges, so clamping is exercised.
+static float coordinate(int i) { return (i % NUM_POINTS) * (2.1f / NUM_POINTS) - 1.05f; }
+
+TAPROOT_BENCHMARK(LookupGrid2D, interpolateLinear2D)
+{
+    Grid grid(-1, 1, -1, 1);
+    fillGrid(grid);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_POINTS; i++)
+        {
+            doNotOptimize(interpolateLinear2D(
+                grid.getValues(),
+                -1.0f,
+                1.0f,
+                0.125f,
+                -1.0f,
+                1.0f,
+                0.125f,
+                coordinate(i),
+                coordinate(i + NUM_POINTS / 2)));
+        }
+    }
+    state.setItemsProcessed(NUM_POINTS);
+}
+
+TAPROOT_BENCHMARK(LookupGrid2D, interpolate)
+{
+    Grid grid(-1, 1, -1, 1);
+    fillGrid(grid);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_POINTS; i++)
+        {
+            doNotOptimize(grid.interpolate(coordinate(i), coordinate(i + NUM_POINTS / 2)));
+        }
+    }
+    state.setItemsProcessed(NUM_POINTS);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tap/algorithms/smooth_pid_bank.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * One `SmoothPidBank::runControllers` call is benchmarked against a `runController` call per
+ * controller on individual `SmoothPid`s, for the wheel and rotation controllers of a chassis.
+ */
+
+static constexpr int CONTROLLERS = 5;
+
+static SmoothPidBankConfig chassisConfig()
+{
+    SmoothPidBankConfig config;
+    config.pid.kp = 2.0f;
+    config.pid.ki = 0.5f;
+    config.pid.kd = 0.1f;
+    config.pid.maxICumulative = 1.5f;
+    config.pid.maxOutput = 8.0f;
+    config.pid.tRDerivativeKalman = 3.0f;
+    config.pid.tRProportionalKalman = 0.5f;
+    return config;
+}
+
+TAPROOT_BENCHMARK(SmoothPidBank, individual_controllers_5_controllers)
+{
+    const SmoothPidBankConfig config = chassisConfig();
+    SmoothPid *pids[CONTROLLERS];
+    for (int i = 0; i < CONTROLLERS; i++)
+    {
+        // Allocated separately, as controllers owned by different subsystems would be
+        pids[i] = new SmoothPid(config.pid);
+    }
+
+    int t = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            const float error = static_cast<float>((t + i) % 17);
+            doNotOptimize(pids[i]->runController(error, 0.1f * i, 0.002f));
+        }
+        t++;
+    }
+    state.setItemsProcessed(CONTROLLERS);
+
+    for (SmoothPid *pid : pids)
+    {
+        delete pid;
+    }
+}
+
+TAPROOT_BENCHMARK(SmoothPidBank, runControllers_5_controllers)
+{
+    SmoothPidBank<CONTROLLERS> bank(chassisConfig());
+    float error[CONTROLLERS];
+    float errorDerivative[CONTROLLERS];
+
+    int t = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            error[i] = static_cast<float>((t + i) % 17);
+            errorDerivative[i] = 0.1f * i;
+        }
+        bank.runControllers(error, errorDerivative, 0.002f);
+        doNotOptimize(bank.getOutput(CONTROLLERS - 1));
+        t++;
+    }
+    state.setItemsProcessed(CONTROLLERS);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "tap/algorithms/transforms/transform.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms::transforms;
+using tap::benchmark::doNotOptimize;
+
+/// Roughly the armor plate corners and candidate targets a vision frame has to transform.
+static constexpr uint16_t NUM_POINTS = 64;
+
+/// A camera to world transform, rotated about every axis so no product is trivially zero.
+static Transform cameraToWorld() { return Transform(0.1f, -0.05f, 0.4f, 0.05f, -0.2f, 1.3f); }
+
+static float pointCoordinate(int i, int axis) { return sinf(0.37f * i + axis); }
+
+TAPROOT_BENCHMARK(Transform, apply_position_per_point)
+{
+    const Transform transform = cameraToWorld();
+    std::vector<Position> points;
+    for (int i = 0; i < NUM_POINTS; i++)
+    {
+        points.emplace_back(pointCoordinate(i, 0), pointCoordinate(i, 1), pointCoordinate(i, 2));
+    }
+    std::vector<Position> out(NUM_POINTS, Position(0, 0, 0));
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_POINTS; i++)
+        {
+            out[i] = transform.apply(points[i]);
+        }
+        doNotOptimize(out.data());
+    }
+    state.setItemsProcessed(NUM_POINTS);
+}
+
+TAPROOT_BENCHMARK(Transform, apply_position_array)
+{
+    const Transform transform = cameraToWorld();
+    std::vector<Position> points;
+    for (int i = 0; i < NUM_POINTS; i++)
+    {
+        points.emplace_back(pointCoordinate(i, 0), pointCoordinate(i, 1), pointCoordinate(i, 2));
+    }
+    std::vector<Position> out(NUM_POINTS, Position(0, 0, 0));
+
+    for (auto _ : state)
+    {
+        transform.apply(points.data(), out.data(), NUM_POINTS);
+        doNotOptimize(out.data());
+    }
+    state.setItemsProcessed(NUM_POINTS);
+}
+
+TAPROOT_BENCHMARK(Transform, applyToPositions_matrix)
+{
+    const Transform transform = cameraToWorld();
+    float points[3 * NUM_POINTS];
+    float out[3 * NUM_POINTS];
+    for (int i = 0; i < NUM_POINTS; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            points[axis * NUM_POINTS + i] = pointCoordinate(i, axis);
+        }
+    }
+
+    for (auto _ : state)
+    {
+        transform.applyToPositions(points, out, NUM_POINTS);
+        doNotOptimize(out[0]);
+    }
+    state.setItemsProcessed(NUM_POINTS);
+}
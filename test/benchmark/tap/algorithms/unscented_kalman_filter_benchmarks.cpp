@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/unscented_kalman_filter.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/// Number of precomputed measurements cycled through, so the corpus is the same every run.
+static constexpr int NUM_MEASUREMENTS = 256;
+
+static constexpr float DT = 0.001f;
+
+/// Fills `out` with a diagonal matrix of `value`.
+template <uint16_t SIZE>
+static void diagonal(float value, float (&out)[SIZE * SIZE])
+{
+    for (int i = 0; i < SIZE * SIZE; i++)
+    {
+        out[i] = i % (SIZE + 1) == 0 ? value : 0;
+    }
+}
+
+/*
+ * Constant turn rate model of a target driving in an arc,
+ * x = (x, y, speed, heading, turn rate, z), measuring its position.
+ */
+
+static void constantTurnRate(const float (&x)[6], float dt, float (&out)[6])
+{
+    out[0] = x[0] + dt * x[2] * cosf(x[3]);
+    out[1] = x[1] + dt * x[2] * sinf(x[3]);
+    out[2] = x[2];
+    out[3] = x[3] + dt * x[4];
+    out[4] = x[4];
+    out[5] = x[5];
+}
+
+static void measurePosition(const float (&x)[6], float (&out)[3])
+{
+    out[0] = x[0];
+    out[1] = x[1];
+    out[2] = x[5];
+}
+
+/*
+ * Spinning armor model of a target rotating about its center while translating,
+ * x = (center x, center y, z, vx, vy, vz, yaw, yaw rate, radius), measuring the position and
+ * yaw of the armor plate facing the origin.
+ */
+
+static void spinningArmor(const float (&x)[9], float dt, float (&out)[9])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        out[i] = x[i] + dt * x[i + 3];
+        out[i + 3] = x[i + 3];
+    }
+    out[6] = x[6] + dt * x[7];
+    out[7] = x[7];
+    out[8] = x[8];
+}
+
+static void measureArmor(const float (&x)[9], float (&out)[4])
+{
+    out[0] = x[0] - x[8] * cosf(x[6]);
+    out[1] = x[1] - x[8] * sinf(x[6]);
+    out[2] = x[2];
+    out[3] = x[6];
+}
+
+TAPROOT_BENCHMARK(UnscentedKalmanFilter, constant_turn_rate_6_states_3_inputs)
+{
+    float Q[36], R[9], P0[36];
+    diagonal<6>(1E-4f, Q);
+    diagonal<3>(1E-3f, R);
+    diagonal<6>(1, P0);
+    UnscentedKalmanFilter<6, 3> filter(constantTurnRate, measurePosition, Q, R, P0);
+    filter.init({5, 0, 1, 0, 0.5f, 0.2f});
+
+    CMSISMat<3, 1> measurements[NUM_MEASUREMENTS];
+    for (int i = 0; i < NUM_MEASUREMENTS; i++)
+    {
+        measurements[i] = CMSISMat<3, 1>({5 + cosf(i * DT), sinf(i * DT), 0.2f});
+    }
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        filter.performUpdate(DT, measurements[i]);
+        doNotOptimize(filter.getStateVectorAsMatrix());
+        i = (i + 1) % NUM_MEASUREMENTS;
+    }
+}
+
+TAPROOT_BENCHMARK(UnscentedKalmanFilter, spinning_armor_9_states_4_inputs)
+{
+    float Q[81], R[16], P0[81];
+    diagonal<9>(1E-4f, Q);
+    diagonal<4>(1E-3f, R);
+    diagonal<9>(1, P0);
+    UnscentedKalmanFilter<9, 4> filter(spinningArmor, measureArmor, Q, R, P0);
+    filter.setAngularStates(1 << 6);
+    filter.setAngularMeasurements(1 << 3);
+    filter.init({5, 0, 0.2f, 0, 0, 0, 0, 6, 0.25f});
+
+    CMSISMat<4, 1> measurements[NUM_MEASUREMENTS];
+    for (int i = 0; i < NUM_MEASUREMENTS; i++)
+    {
+        const float yaw = 6 * i * DT;
+        measurements[i] = CMSISMat<4, 1>({5 - 0.25f * cosf(yaw), -0.25f * sinf(yaw), 0.2f, yaw});
+    }
+
+    int i = 0;
+    for (auto _ : state)
+    {
+        filter.performUpdate(DT, measurements[i]);
+        doNotOptimize(filter.getStateVectorAsMatrix());
+        i = (i + 1) % NUM_MEASUREMENTS;
+    }
+}
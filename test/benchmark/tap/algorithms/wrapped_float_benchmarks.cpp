@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/algorithms/wrapped_float.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * The angle arithmetic a turret controller does each control loop, adding small deltas to an
+ * `Angle` and finding its difference to a setpoint, is benchmarked against the same arithmetic
+ * wrapped with `fmodf` every time.
+ */
+
+/// Wraps `value` to [0, 2 pi) the way `WrappedFloat` did before its fast paths.
+static float fmodfWrap(float value, int *revolutions)
+{
+    static constexpr float UPPER = M_TWOPI;
+    float wrapped = value;
+    if (value < 0)
+    {
+        wrapped = UPPER + fmodf(value - UPPER, UPPER);
+    }
+    else if (value >= UPPER)
+    {
+        wrapped = fmodf(value, UPPER);
+    }
+    *revolutions += floor(value / UPPER);
+    return wrapped;
+}
+
+TAPROOT_BENCHMARK(WrappedFloat, fmodf_turret_control_loop)
+{
+    float angle = 0;
+    int revolutions = 0;
+    int i = 0;
+    for (auto _ : state)
+    {
+        // A yaw spinning at about 0.5 rad per loop, compared to a fixed setpoint
+        angle = fmodfWrap(angle + 0.5f + 1E-4f * (i % 7), &revolutions);
+        const float difference = fmodfWrap(1.0f - angle, &revolutions);
+        doNotOptimize(difference > M_PI ? difference - static_cast<float>(M_TWOPI) : difference);
+        i++;
+    }
+}
+
+TAPROOT_BENCHMARK(WrappedFloat, turret_control_loop)
+{
+    Angle angle(0);
+    const Angle setpoint(1.0f);
+    int i = 0;
+    for (auto _ : state)
+    {
+        angle += 0.5f + 1E-4f * (i % 7);
+        doNotOptimize(angle.minDifference(setpoint));
+        i++;
+    }
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/can/can.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/communication/capture/capture_replayer.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::can;
+using namespace tap::communication::capture;
+using namespace tap::motor;
+using tap::arch::convertToLittleEndian;
+using tap::benchmark::doNotOptimize;
+
+static constexpr int NUM_MOTORS = 8;
+/// Frames per bus in each stream, as many as a `CaptureReplayer` buffers.
+static constexpr int FRAMES_PER_BUS = CaptureReplayer::MAX_BUFFERED;
+static constexpr CanBus BUSES[] = {CanBus::CAN_BUS1, CanBus::CAN_BUS2};
+
+/// A frame to replay and the bus it is received on.
+struct BusFrame
+{
+    CanBus bus;
+    modm::can::Message message;
+};
+
+/// @return A capture stream receiving all frames at once, in the order given.
+static std::vector<uint8_t> constructCaptureStream(const std::vector<BusFrame> &frames)
+{
+    std::vector<uint8_t> stream(CAPTURE_HEADER_SIZE);
+    convertToLittleEndian(CAPTURE_MAGIC, stream.data());
+    convertToLittleEndian(CAPTURE_VERSION, stream.data() + 4);
+
+    for (const BusFrame &frame : frames)
+    {
+        const uint8_t length = frame.message.getLength();
+        uint8_t record[CAPTURE_RECORD_HEADER_SIZE + 4 + 8] = {};
+        convertToLittleEndian(static_cast<uint32_t>(0), record);
+        record[4] = static_cast<uint8_t>(CaptureSource::CAN_RX);
+        record[5] = frame.bus == CanBus::CAN_BUS1 ? 0 : 1;
+        convertToLittleEndian(static_cast<uint16_t>(4 + length), record + 6);
+        convertToLittleEndian(
+            frame.message.getIdentifier() |
+                (frame.message.isExtended() ? CAPTURE_CAN_EXTENDED_FLAG : 0),
+            record + CAPTURE_RECORD_HEADER_SIZE);
+        std::copy_n(frame.message.data, length, record + CAPTURE_RECORD_HEADER_SIZE + 4);
+
+        stream.insert(stream.end(), record, record + CAPTURE_RECORD_HEADER_SIZE + 4 + length);
+    }
+
+    return stream;
+}
+
+/**
+ * Replays a capture stream through the hosted `Can` into a `CanRxHandler` with 8 `DjiMotor`s on
+ * each bus, the path feedback takes on a robot. Each iteration replays the whole stream, so the
+ * time per item is the cost of receiving, dispatching and parsing a frame.
+ */
+static void replayThroughMotors(tap::benchmark::State &state, const std::vector<BusFrame> &frames)
+{
+    tap::Drivers drivers;
+    Can can;
+    CanRxHandler handler(&drivers);
+
+    std::vector<std::unique_ptr<DjiMotor>> motors;
+    for (CanBus bus : BUSES)
+    {
+        for (int i = 0; i < NUM_MOTORS; i++)
+        {
+            motors.push_back(std::make_unique<DjiMotor>(
+                &drivers,
+                static_cast<MotorId>(MOTOR1 + i),
+                bus,
+                false,
+                "motor"));
+            handler.attachReceiveHandler(motors.back().get());
+        }
+    }
+
+    const std::vector<uint8_t> stream = constructCaptureStream(frames);
+    CaptureReplayer replayer;
+    CaptureReplayer::setActive(&replayer);
+
+    for (auto _ : state)
+    {
+        replayer.load(stream.data(), stream.size());
+        for (CanBus bus : BUSES)
+        {
+            while (const modm::can::Message *message = can.peekMessage(bus))
+            {
+                handler.processReceivedCanData(bus, *message);
+                can.popMessage(bus);
+            }
+        }
+    }
+    state.setItemsProcessed(frames.size());
+
+    CaptureReplayer::setActive(nullptr);
+    for (auto &motor : motors)
+    {
+        doNotOptimize(motor->getEncoderUnwrapped());
+        handler.removeReceiveHandler(*motor);
+    }
+}
+
+/// Feedback from 8 motors on each bus, each motor turning at a different speed.
+TAPROOT_BENCHMARK(CanBusStress, replay_motor_feedback)
+{
+    std::vector<BusFrame> frames;
+    for (int round = 0; round < FRAMES_PER_BUS / NUM_MOTORS; round++)
+    {
+        for (CanBus bus : BUSES)
+        {
+            for (int i = 0; i < NUM_MOTORS; i++)
+            {
+                uint16_t encoder = (round * 100 * (i + 1)) % DjiMotor::ENC_RESOLUTION;
+                modm::can::Message message(MOTOR1 + i, DjiMotor::FEEDBACK_MESSAGE_LENGTH);
+                message.setExtended(false);
+                message.data[0] = encoder >> 8;
+                message.data[1] = encoder & 0xff;
+                message.data[3] = i;
+                message.data[6] = 40;
+                frames.push_back({bus, message});
+            }
+        }
+    }
+
+    replayThroughMotors(state, frames);
+}
+
+/**
+ * Worst case traffic of random lengths and payloads, half for the motors and half for random
+ * standard ids, most of which have no listener. Most motor frames are rejected by `DjiMotor` as
+ * corrupted. Seeded, so every run replays the same frames.
+ */
+TAPROOT_BENCHMARK(CanBusStress, replay_random_frames)
+{
+    std::mt19937 random(87);
+    std::uniform_int_distribution<uint32_t> standardId(0, 0x7ff);
+    std::uniform_int_distribution<int> length(0, 8);
+    std::uniform_int_distribution<int> byte(0, 0xff);
+
+    std::vector<BusFrame> frames;
+    for (int i = 0; i < FRAMES_PER_BUS; i++)
+    {
+        for (CanBus bus : BUSES)
+        {
+            uint32_t id = byte(random) % 2 == 0 ? MOTOR1 + byte(random) % NUM_MOTORS
+                                                : standardId(random);
+            modm::can::Message message(id, length(random));
+            message.setExtended(false);
+            for (uint8_t &data : message.data)
+            {
+                data = byte(random);
+            }
+            frames.push_back({bus, message});
+        }
+    }
+
+    replayThroughMotors(state, frames);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/communication/can/can_rx_listener.hpp"
+#include "tap/drivers.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::can;
+using tap::benchmark::doNotOptimize;
+
+static constexpr int NUM_MESSAGES = 256;
+static constexpr int NUM_MOTORS = 8;
+static constexpr uint32_t FIRST_MOTOR_ID = 0x201;
+/// A listener outside of the dense id range, stored in a sparse page.
+static constexpr uint32_t SPARSE_ID = 0x100;
+
+/// Listener that does as little as possible, so the benchmark measures the dispatch.
+class CountingListener : public CanRxListener
+{
+public:
+    CountingListener(tap::Drivers *drivers, uint32_t id, CanBus bus)
+        : CanRxListener(drivers, id, bus)
+    {
+    }
+
+    void processMessage(const modm::can::Message &message) override { sum += message.data[0]; }
+
+    uint32_t sum = 0;
+};
+
+/**
+ * Dispatches a fixed corpus of messages for 8 motors on each bus, a sparse id and an id with no
+ * listener, as a robot with two full CAN buses sees them.
+ */
+TAPROOT_BENCHMARK(CanRxHandler, processReceivedCanData_two_full_buses)
+{
+    tap::Drivers drivers;
+    CanRxHandler handler(&drivers);
+
+    std::vector<std::unique_ptr<CountingListener>> listeners;
+    for (int i = 0; i < NUM_MOTORS; i++)
+    {
+        for (CanBus bus : {CanBus::CAN_BUS1, CanBus::CAN_BUS2})
+        {
+            listeners.push_back(
+                std::make_unique<CountingListener>(&drivers, FIRST_MOTOR_ID + i, bus));
+        }
+    }
+    listeners.push_back(std::make_unique<CountingListener>(&drivers, SPARSE_ID, CanBus::CAN_BUS1));
+    for (auto &listener : listeners)
+    {
+        handler.attachReceiveHandler(listener.get());
+    }
+
+    CanBus buses[NUM_MESSAGES];
+    modm::can::Message messages[NUM_MESSAGES];
+    for (int i = 0; i < NUM_MESSAGES; i++)
+    {
+        buses[i] = i % 2 == 0 ? CanBus::CAN_BUS1 : CanBus::CAN_BUS2;
+        uint32_t id = FIRST_MOTOR_ID + (i / 2) % NUM_MOTORS;
+        if (i % 37 == 0)
+        {
+            id = SPARSE_ID;
+        }
+        else if (i % 53 == 0)
+        {
+            id = 0x300;
+        }
+        messages[i] = modm::can::Message(id, 8);
+        messages[i].data[0] = i;
+    }
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < NUM_MESSAGES; i++)
+        {
+            handler.processReceivedCanData(buses[i], messages[i]);
+        }
+    }
+    state.setItemsProcessed(NUM_MESSAGES);
+
+    for (auto &listener : listeners)
+    {
+        doNotOptimize(listener->sum);
+        handler.removeReceiveHandler(*listener);
+    }
+}
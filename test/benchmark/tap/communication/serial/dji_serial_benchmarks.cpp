@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/serial/dji_serial.hpp"
+#include "tap/drivers.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::communication::serial;
+using namespace tap::arch;
+using namespace tap::algorithms;
+using namespace testing;
+
+static constexpr int NUM_FRAMES = 100;
+static constexpr int FRAME_DATA_LENGTH = 100;
+/// Junk bytes between frames that must be skipped by the head byte search.
+static constexpr int BYTES_BETWEEN_FRAMES = 16;
+/// Maximum number of bytes returned by a single uart read, as if a burst had been buffered.
+static constexpr std::size_t UART_BURST_SIZE = 256;
+
+class CountingDJISerial : public DJISerial
+{
+public:
+    explicit CountingDJISerial(tap::Drivers *drivers) : DJISerial(drivers, Uart::Uart1, true) {}
+
+    void messageReceiveCallback(const ReceivedSerialMessage &) override { numMessagesReceived++; }
+
+    int numMessagesReceived = 0;
+};
+
+/// @return A stream of NUM_FRAMES frames, each preceded by BYTES_BETWEEN_FRAMES junk bytes.
+static std::vector<uint8_t> constructRxStream()
+{
+    std::vector<uint8_t> stream;
+
+    for (int frame = 0; frame < NUM_FRAMES; frame++)
+    {
+        for (int i = 0; i < BYTES_BETWEEN_FRAMES; i++)
+        {
+            stream.push_back(i);
+        }
+
+        uint8_t rawMessage[9 + FRAME_DATA_LENGTH];
+        convertToLittleEndian(static_cast<uint8_t>(0xa5), rawMessage);
+        convertToLittleEndian(static_cast<uint16_t>(FRAME_DATA_LENGTH), rawMessage + 1);
+        convertToLittleEndian(static_cast<uint8_t>(frame), rawMessage + 3);
+        convertToLittleEndian(calculateCRC8(rawMessage, 4), rawMessage + 4);
+        convertToLittleEndian(static_cast<uint16_t>(0x201), rawMessage + 5);
+        for (int i = 0; i < FRAME_DATA_LENGTH; i++)
+        {
+            rawMessage[i + 7] = i;
+        }
+        convertToLittleEndian(
+            calculateCRC16(rawMessage, 7 + FRAME_DATA_LENGTH),
+            rawMessage + 7 + FRAME_DATA_LENGTH);
+
+        stream.insert(stream.end(), rawMessage, rawMessage + sizeof(rawMessage));
+    }
+
+    return stream;
+}
+
+/**
+ * Parses a stream of ref serial sized frames made available to the uart one burst at a time.
+ * Reads go through the uart mock, so the time includes the mock's overhead.
+ */
+TAPROOT_BENCHMARK(DJISerial, updateSerial_ref_serial_bursts)
+{
+    const std::vector<uint8_t> stream = constructRxStream();
+    tap::Drivers drivers;
+
+    std::size_t currByte = 0;
+    std::size_t burstEnd = 0;
+    ON_CALL(drivers.uart, read(Uart::Uart1, _, _))
+        .WillByDefault(
+            [&](Uart::UartPort, uint8_t *data, std::size_t length)
+            {
+                std::size_t bytesRead = std::min(length, burstEnd - currByte);
+                memcpy(data, stream.data() + currByte, bytesRead);
+                currByte += bytesRead;
+                return bytesRead;
+            });
+
+    CountingDJISerial serial(&drivers);
+    for (auto _ : state)
+    {
+        currByte = 0;
+        burstEnd = 0;
+        while (currByte < stream.size())
+        {
+            burstEnd = std::min(stream.size(), burstEnd + UART_BURST_SIZE);
+            while (currByte < burstEnd)
+            {
+                serial.updateSerial();
+            }
+        }
+        serial.updateSerial();
+    }
+    state.setBytesProcessed(stream.size());
+    state.setItemsProcessed(NUM_FRAMES);
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/serial/ref_serial.hpp"
+#include "tap/drivers.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::communication::serial;
+using namespace tap::arch;
+using namespace tap::algorithms;
+using namespace testing;
+
+/// The referee system's UART sends 10 bits per byte at 115200 baud.
+static constexpr std::size_t REF_BYTES_PER_SECOND = 115'200 / 10;
+static constexpr int TICKS_PER_SECOND = 1'000;
+static constexpr uint16_t ROBOT_INTERACTION_DATA_CMD_ID = 0x200;
+/// Length of a robot interaction message with the largest content a robot may send.
+static constexpr uint16_t MAX_ROBOT_INTERACTION_LENGTH = 6 + 112;
+/// Every this many frames is corrupted by the benchmarks of a noisy link.
+static constexpr int CORRUPTED_FRAME_INTERVAL = 10;
+
+/// A message the referee system sends periodically.
+struct RefMessageRate
+{
+    uint16_t type;
+    uint16_t length;
+    int hz;
+};
+
+/**
+ * Messages the referee system sends a ground robot, at the highest rate each is sent at. Messages
+ * sent on an event (damage, launches) are sent at the rate of a robot taking damage and firing
+ * continuously.
+ */
+static constexpr RefMessageRate REF_MESSAGE_RATES[] = {
+    {RefSerial::REF_MESSAGE_TYPE_GAME_STATUS, 11, 1},
+    {RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP, 32, 3},
+    {RefSerial::REF_MESSAGE_TYPE_SITE_EVENT_DATA, 4, 1},
+    {RefSerial::REF_MESSAGE_TYPE_WARNING_DATA, 3, 1},
+    {RefSerial::REF_MESSAGE_TYPE_DART_INFO, 3, 1},
+    {RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS, 13, 10},
+    {RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT, 16, 50},
+    {RefSerial::REF_MESSAGE_TYPE_ROBOT_POSITION, 12, 1},
+    {RefSerial::REF_MESSAGE_TYPE_ROBOT_BUFF_STATUS, 6, 3},
+    {RefSerial::REF_MESSAGE_TYPE_RECEIVE_DAMAGE, 1, 10},
+    {RefSerial::REF_MESSAGE_TYPE_PROJECTILE_LAUNCH, 7, 20},
+    {RefSerial::REF_MESSAGE_TYPE_BULLETS_REMAIN, 6, 10},
+    {RefSerial::REF_MESSAGE_TYPE_RFID_STATUS, 4, 3},
+    {RefSerial::REF_MESSAGE_TYPE_GROUND_ROBOT_POSITION, 40, 1},
+    {RefSerial::REF_MESSAGE_TYPE_SENTRY_INFO, 4, 1},
+};
+
+class CountingRobotToRobotHandler : public RefSerialData::RobotToRobotMessageHandler
+{
+public:
+    void operator()(const DJISerial::ReceivedSerialMessage &) override { numMessages++; }
+
+    int numMessages = 0;
+};
+
+/// Appends a frame with `length` bytes of data to `stream`.
+static void appendFrame(std::vector<uint8_t> &stream, uint16_t type, uint16_t length, uint8_t seq)
+{
+    std::vector<uint8_t> frame(9 + length);
+    convertToLittleEndian(static_cast<uint8_t>(0xa5), frame.data());
+    convertToLittleEndian(length, frame.data() + 1);
+    convertToLittleEndian(seq, frame.data() + 3);
+    convertToLittleEndian(calculateCRC8(frame.data(), 4), frame.data() + 4);
+    convertToLittleEndian(type, frame.data() + 5);
+    for (int i = 0; i < length; i++)
+    {
+        frame[7 + i] = seq + i;
+    }
+    if (type == RefSerial::REF_MESSAGE_TYPE_CUSTOM_DATA)
+    {
+        convertToLittleEndian(ROBOT_INTERACTION_DATA_CMD_ID, frame.data() + 7);
+    }
+    convertToLittleEndian(calculateCRC16(frame.data(), 7 + length), frame.data() + 7 + length);
+
+    stream.insert(stream.end(), frame.begin(), frame.end());
+}
+
+/**
+ * @return One second of referee system traffic: each message of `REF_MESSAGE_RATES` at its rate,
+ *      with robot interaction messages of the largest size filling the rest of the UART's
+ *      bandwidth, as if teammates sent them as fast as the link allows. If `corrupt`, every
+ *      `CORRUPTED_FRAME_INTERVAL`th frame has a bad CRC8 or CRC16, alternately.
+ */
+static std::vector<uint8_t> constructRefTraffic(bool corrupt)
+{
+    int periodicBytes = 0;
+    for (const RefMessageRate &rate : REF_MESSAGE_RATES)
+    {
+        periodicBytes += rate.hz * (9 + rate.length);
+    }
+    const int interactionHz =
+        (REF_BYTES_PER_SECOND - periodicBytes) / (9 + MAX_ROBOT_INTERACTION_LENGTH);
+
+    std::vector<uint8_t> stream;
+    int numFrames = 0;
+    auto append = [&](uint16_t type, uint16_t length)
+    {
+        const std::size_t frameStart = stream.size();
+        appendFrame(stream, type, length, numFrames);
+        numFrames++;
+        if (corrupt && numFrames % CORRUPTED_FRAME_INTERVAL == 0)
+        {
+            // Flip a bit in the CRC8, or in the last data byte so the CRC16 fails
+            const bool badCrc8 = numFrames % (2 * CORRUPTED_FRAME_INTERVAL) == 0;
+            stream[badCrc8 ? frameStart + 4 : stream.size() - 3] ^= 0x10;
+        }
+    };
+
+    for (int tick = 0; tick < TICKS_PER_SECOND; tick++)
+    {
+        // A message at `hz` is due on the ticks where tick * hz / TICKS_PER_SECOND increases
+        auto isDue = [tick](int hz)
+        {
+            return tick * hz / TICKS_PER_SECOND != (tick + 1) * hz / TICKS_PER_SECOND;
+        };
+
+        for (const RefMessageRate &rate : REF_MESSAGE_RATES)
+        {
+            if (isDue(rate.hz))
+            {
+                append(rate.type, rate.length);
+            }
+        }
+        if (isDue(interactionHz))
+        {
+            append(RefSerial::REF_MESSAGE_TYPE_CUSTOM_DATA, MAX_ROBOT_INTERACTION_LENGTH);
+        }
+    }
+
+    return stream;
+}
+
+/**
+ * Replays a second of referee traffic through `RefSerial`, calling `updateSerial` once per tick of
+ * `tickMs` milliseconds with the bytes the UART received at 115200 baud since the last tick, so
+ * frames are split across reads. Reports the throughput, the average time per tick (per item) and
+ * the longest tick, which must stay within the main loop's budget for the parser to keep up.
+ * Reads go through the uart mock, so the times include the mock's overhead.
+ */
+static void replayRefTraffic(tap::benchmark::State &state, bool corrupt, int tickMs)
+{
+    const std::vector<uint8_t> stream = constructRefTraffic(corrupt);
+    tap::Drivers drivers;
+
+    std::size_t currByte = 0;
+    std::size_t receivedEnd = 0;
+    ON_CALL(drivers.uart, read(_, _, _))
+        .WillByDefault(
+            [&](Uart::UartPort, uint8_t *data, std::size_t length)
+            {
+                std::size_t bytesRead = std::min(length, receivedEnd - currByte);
+                memcpy(data, stream.data() + currByte, bytesRead);
+                currByte += bytesRead;
+                return bytesRead;
+            });
+
+    RefSerial refSerial(&drivers);
+    CountingRobotToRobotHandler handler;
+    refSerial.attachRobotToRobotMessageHandler(ROBOT_INTERACTION_DATA_CMD_ID, &handler);
+
+    int numTicks = 0;
+    for (auto _ : state)
+    {
+        currByte = 0;
+        numTicks = 0;
+        for (int ms = tickMs; currByte < stream.size(); ms += tickMs)
+        {
+            receivedEnd = std::min(stream.size(), ms * REF_BYTES_PER_SECOND / TICKS_PER_SECOND);
+            state.timeCall([&]() { refSerial.updateSerial(); });
+            numTicks++;
+        }
+    }
+    state.setBytesProcessed(stream.size());
+    state.setItemsProcessed(numTicks);
+
+    tap::benchmark::doNotOptimize(handler.numMessages);
+}
+
+/// Traffic of a match, read every 1 ms main loop tick.
+TAPROOT_BENCHMARK(RefSerial, updateSerial_match_traffic_1ms_ticks)
+{
+    replayRefTraffic(state, false, 1);
+}
+
+/// Traffic of a match over a noisy link, so the parser resynchronizes after bad frames.
+TAPROOT_BENCHMARK(RefSerial, updateSerial_corrupted_match_traffic_1ms_ticks)
+{
+    replayRefTraffic(state, true, 1);
+}
+
+/// Traffic of a match read every 10 ms, as if the main loop stalls, so each tick parses a burst.
+TAPROOT_BENCHMARK(RefSerial, updateSerial_match_traffic_10ms_ticks)
+{
+    replayRefTraffic(state, false, 10);
+}
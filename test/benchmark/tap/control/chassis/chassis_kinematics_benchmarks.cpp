@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "tap/control/chassis/chassis_kinematics.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::algorithms;
+using namespace tap::control::chassis;
+using tap::benchmark::doNotOptimize;
+
+/**
+ * Solving chassis kinematics with the precomputed matrices of `LinearChassisKinematics` and
+ * `SwerveKinematics` is benchmarked against the usual hand written per wheel formulas, and
+ * against computing the pseudo-inverse for forward kinematics on every call.
+ */
+
+static constexpr float WHEEL_RADIUS = 0.076f;
+static constexpr float HALF_WHEELBASE = 0.2f;
+static constexpr float HALF_TRACK = 0.25f;
+static constexpr float MAX_WHEEL_SPEED = 50;
+/// Change in the commanded direction between iterations, so no call is a repeat.
+static constexpr float TIME_STEP = 1E-4f;
+
+static const float SWERVE_POSITIONS[4][2] = {
+    {HALF_WHEELBASE, HALF_TRACK},
+    {HALF_WHEELBASE, -HALF_TRACK},
+    {-HALF_WHEELBASE, HALF_TRACK},
+    {-HALF_WHEELBASE, -HALF_TRACK}};
+
+static LinearChassisKinematics<4> omni()
+{
+    const float angles[4] = {M_PI / 4, 3 * M_PI / 4, -3 * M_PI / 4, -M_PI / 4};
+    return omniKinematics(WHEEL_RADIUS, 0.3f, angles);
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, mecanum_inverse_hand_written)
+{
+    float t = 0;
+    for (auto _ : state)
+    {
+        const float vx = cosf(t), vy = sinf(t), wz = 1;
+        const float rotation = (HALF_WHEELBASE + HALF_TRACK) * wz;
+        float wheelSpeeds[4] = {
+            (vx - vy - rotation) / WHEEL_RADIUS,
+            (vx + vy + rotation) / WHEEL_RADIUS,
+            (vx + vy - rotation) / WHEEL_RADIUS,
+            (vx - vy + rotation) / WHEEL_RADIUS};
+        float maxSpeed = 0;
+        for (float speed : wheelSpeeds)
+        {
+            maxSpeed = fmaxf(maxSpeed, fabsf(speed));
+        }
+        if (maxSpeed > MAX_WHEEL_SPEED)
+        {
+            for (float &speed : wheelSpeeds)
+            {
+                speed *= MAX_WHEEL_SPEED / maxSpeed;
+            }
+        }
+        doNotOptimize(wheelSpeeds);
+        t += TIME_STEP;
+    }
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, mecanum_inverse)
+{
+    const LinearChassisKinematics<4> kinematics =
+        mecanumKinematics(WHEEL_RADIUS, HALF_WHEELBASE, HALF_TRACK);
+    CMSISMat<4, 1> wheelSpeeds;
+
+    float t = 0;
+    for (auto _ : state)
+    {
+        kinematics.toWheelSpeeds(CMSISMat<3, 1>({cosf(t), sinf(t), 1}), wheelSpeeds);
+        desaturate(wheelSpeeds, MAX_WHEEL_SPEED);
+        doNotOptimize(wheelSpeeds.data);
+        t += TIME_STEP;
+    }
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, omni_forward_pseudo_inverse)
+{
+    const LinearChassisKinematics<4> kinematics = omni();
+    const CMSISMat<4, 3> &inverse = kinematics.getInverseMatrix();
+
+    // Solving the least squares problem each call, as forward kinematics without a precomputed
+    // matrix has to
+    float t = 0;
+    for (auto _ : state)
+    {
+        const CMSISMat<4, 1> wheelSpeeds({t, -t, 2 * t, 1});
+        const CMSISMat<3, 1> velocity =
+            (inverse.transpose() * inverse).inverse() * (inverse.transpose() * wheelSpeeds);
+        doNotOptimize(velocity.data);
+        t += TIME_STEP;
+    }
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, omni_forward)
+{
+    const LinearChassisKinematics<4> kinematics = omni();
+    CMSISMat<3, 1> velocity;
+
+    float t = 0;
+    for (auto _ : state)
+    {
+        kinematics.toChassisVelocity(CMSISMat<4, 1>({t, -t, 2 * t, 1}), velocity);
+        doNotOptimize(velocity.data);
+        t += TIME_STEP;
+    }
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, swerve_inverse_hand_written)
+{
+    float t = 0;
+    for (auto _ : state)
+    {
+        const float vx = cosf(t), vy = sinf(t), wz = 1;
+        float angles[4], speeds[4];
+        for (int i = 0; i < 4; i++)
+        {
+            const float moduleVx = vx - wz * SWERVE_POSITIONS[i][1];
+            const float moduleVy = vy + wz * SWERVE_POSITIONS[i][0];
+            angles[i] = atan2f(moduleVy, moduleVx);
+            speeds[i] = hypotf(moduleVx, moduleVy) / WHEEL_RADIUS;
+        }
+        doNotOptimize(angles);
+        doNotOptimize(speeds);
+        t += TIME_STEP;
+    }
+}
+
+TAPROOT_BENCHMARK(ChassisKinematics, swerve_inverse)
+{
+    const SwerveKinematics<4> kinematics(WHEEL_RADIUS, SWERVE_POSITIONS);
+    SwerveKinematics<4>::ModuleState states[4];
+
+    float t = 0;
+    for (auto _ : state)
+    {
+        kinematics.toModuleStates(CMSISMat<3, 1>({cosf(t), sinf(t), 1}), states);
+        doNotOptimize(states);
+        t += TIME_STEP;
+    }
+}
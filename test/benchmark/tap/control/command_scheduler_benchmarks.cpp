@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "tap/control/command.hpp"
+#include "tap/control/command_scheduler.hpp"
+#include "tap/control/comprised_command.hpp"
+#include "tap/control/concurrent_command.hpp"
+#include "tap/control/flattened_command.hpp"
+#include "tap/control/governor/governor_limited_command.hpp"
+#include "tap/control/sequential_command.hpp"
+#include "tap/control/subsystem.hpp"
+#include "tap/drivers.hpp"
+
+#include "benchmark.hpp"
+
+using namespace tap::control;
+using tap::control::governor::CommandGovernorInterface;
+using tap::control::governor::GovernorLimitedCommand;
+using tap::benchmark::doNotOptimize;
+
+/// Subsystem that does as little as possible, so the benchmark measures the scheduler.
+class CountingSubsystem : public Subsystem
+{
+public:
+    explicit CountingSubsystem(tap::Drivers *drivers) : Subsystem(drivers) {}
+
+    void refresh() override { numRefreshes++; }
+
+    int numRefreshes = 0;
+};
+
+/// Command that never finishes and does as little as possible.
+class CountingCommand : public Command
+{
+public:
+    explicit CountingCommand(Subsystem *subsystem) { addSubsystemRequirement(subsystem); }
+
+    const char *getName() const override { return "counting command"; }
+    void initialize() override {}
+    void execute() override { numExecutions++; }
+    void end(bool) override {}
+    bool isFinished() const override { return false; }
+
+    int numExecutions = 0;
+};
+
+/**
+ * Runs a master scheduler with `numSubsystems` registered subsystems, a command running on each
+ * of the first `numScheduled`, and `numConstructed` commands constructed in total, since unused
+ * commands still take slots the scheduler iterates over.
+ */
+static void benchmarkRun(
+    tap::benchmark::State &state,
+    int numSubsystems,
+    int numScheduled,
+    int numConstructed)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+
+    std::vector<std::unique_ptr<CountingSubsystem>> subsystems;
+    std::vector<std::unique_ptr<CountingCommand>> commands;
+    for (int i = 0; i < numSubsystems; i++)
+    {
+        subsystems.push_back(std::make_unique<CountingSubsystem>(&drivers));
+        scheduler.registerSubsystem(subsystems.back().get());
+    }
+    for (int i = 0; i < numConstructed; i++)
+    {
+        commands.push_back(std::make_unique<CountingCommand>(subsystems[i % numSubsystems].get()));
+    }
+    for (int i = 0; i < numScheduled; i++)
+    {
+        scheduler.addCommand(commands[i].get());
+    }
+
+    for (auto _ : state)
+    {
+        scheduler.run();
+    }
+
+    for (auto &command : commands)
+    {
+        doNotOptimize(command->numExecutions);
+    }
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_6_subsystems_6_commands)
+{
+    benchmarkRun(state, 6, 6, 6);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_6_subsystems_40_constructed_commands)
+{
+    benchmarkRun(state, 6, 6, 40);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_24_subsystems_24_commands)
+{
+    benchmarkRun(state, 24, 24, 24);
+}
+
+/**
+ * Iterates over the added commands with 5 of 40 constructed commands scheduled, spread out so the
+ * last one has the highest index and the iterator has to skip over every gap.
+ */
+TAPROOT_BENCHMARK(CommandScheduler, iterate_5_of_40_constructed_commands)
+{
+    static constexpr int NUM_SCHEDULED = 5;
+    static constexpr int NUM_CONSTRUCTED = 40;
+
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+
+    std::vector<std::unique_ptr<CountingSubsystem>> subsystems;
+    std::vector<std::unique_ptr<CountingCommand>> commands;
+    for (int i = 0; i < NUM_SCHEDULED; i++)
+    {
+        subsystems.push_back(std::make_unique<CountingSubsystem>(&drivers));
+        scheduler.registerSubsystem(subsystems.back().get());
+    }
+    for (int i = 0; i < NUM_CONSTRUCTED; i++)
+    {
+        commands.push_back(std::make_unique<CountingCommand>(subsystems[i % NUM_SCHEDULED].get()));
+    }
+    for (int i = 0; i < NUM_SCHEDULED; i++)
+    {
+        scheduler.addCommand(commands[(i + 1) * NUM_CONSTRUCTED / NUM_SCHEDULED - 1].get());
+    }
+
+    for (auto _ : state)
+    {
+        int sum = 0;
+        const auto end = scheduler.cmdMapEnd();
+        for (auto it = scheduler.cmdMapBegin(); it != end; ++it)
+        {
+            sum += (*it)->getGlobalIdentifier();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(NUM_SCHEDULED);
+}
+
+/// Governor that always lets the command run, so the benchmark measures the governor wrapper.
+class OpenGovernor : public CommandGovernorInterface
+{
+public:
+    bool isReady() override { return true; }
+    bool isFinished() override { return false; }
+};
+
+/// Runs a `CountingCommand` on its own scheduler, like `MoveUnjamComprisedCommand`.
+class CountingComprisedCommand : public ComprisedCommand
+{
+public:
+    CountingComprisedCommand(tap::Drivers *drivers, Subsystem *subsystem)
+        : ComprisedCommand(drivers),
+          command(subsystem)
+    {
+        addSubsystemRequirement(subsystem);
+        comprisedCommandScheduler.registerSubsystem(subsystem);
+    }
+
+    const char *getName() const override { return "counting comprised command"; }
+    void initialize() override { comprisedCommandScheduler.addCommand(&command); }
+    void execute() override { comprisedCommandScheduler.run(); }
+    void end(bool interrupted) override
+    {
+        comprisedCommandScheduler.removeCommand(&command, interrupted);
+    }
+    bool isFinished() const override { return false; }
+
+private:
+    CountingCommand command;
+};
+
+/**
+ * A synthetic robot of `numSubsystems` subsystems and `numCommands` top level commands, for
+ * measuring how the scheduler scales. The commands cycle through the kinds robots build their
+ * command graphs from: a plain command, a comprised command, a sequential command of two
+ * commands, a concurrent command of two commands on two subsystems and a governor limited
+ * command. Each command takes the next subsystems in turn, so as long as there are enough
+ * subsystems all commands can be scheduled at once. Each kind but the plain command constructs
+ * inner commands, which take command slots too: the top level commands use 11 slots per 5.
+ */
+class SyntheticRobot
+{
+public:
+    SyntheticRobot(
+        tap::Drivers *drivers,
+        CommandScheduler &scheduler,
+        int numSubsystems,
+        int numCommands)
+        : scheduler(scheduler)
+    {
+        for (int i = 0; i < numSubsystems; i++)
+        {
+            subsystems.push_back(std::make_unique<CountingSubsystem>(drivers));
+            scheduler.registerSubsystem(subsystems.back().get());
+        }
+
+        int nextSubsystem = 0;
+        auto takeSubsystem = [&]()
+        {
+            Subsystem *subsystem = subsystems[nextSubsystem].get();
+            nextSubsystem = (nextSubsystem + 1) % numSubsystems;
+            return subsystem;
+        };
+
+        for (int i = 0; i < numCommands; i++)
+        {
+            switch (i % 5)
+            {
+                case 0:
+                    commands.push_back(std::make_unique<CountingCommand>(takeSubsystem()));
+                    break;
+                case 1:
+                    commands.push_back(
+                        std::make_unique<CountingComprisedCommand>(drivers, takeSubsystem()));
+                    break;
+                case 2:
+                {
+                    Subsystem *subsystem = takeSubsystem();
+                    commands.push_back(std::make_unique<SequentialCommand<2>>(
+                        std::array<Command *, 2>{addInner(subsystem), addInner(subsystem)}));
+                    break;
+                }
+                case 3:
+                {
+                    Subsystem *first = takeSubsystem();
+                    Subsystem *second = takeSubsystem();
+                    commands.push_back(std::make_unique<ConcurrentCommand<2>>(
+                        std::array<Command *, 2>{addInner(first), addInner(second)},
+                        "concurrent command"));
+                    break;
+                }
+                default:
+                {
+                    Subsystem *subsystem = takeSubsystem();
+                    commands.push_back(std::make_unique<GovernorLimitedCommand<1>>(
+                        Command::requirementsOf({subsystem}),
+                        *addInner(subsystem),
+                        std::array<CommandGovernorInterface *, 1>{&governor}));
+                    break;
+                }
+            }
+        }
+    }
+
+    ~SyntheticRobot()
+    {
+        for (auto &subsystem : subsystems)
+        {
+            doNotOptimize(subsystem->numRefreshes);
+        }
+    }
+
+    /// Adds the commands in order, each interrupting earlier commands it shares subsystems with.
+    void addCommands()
+    {
+        for (auto &command : commands)
+        {
+            scheduler.addCommand(command.get());
+        }
+    }
+
+    void removeCommands()
+    {
+        for (auto &command : commands)
+        {
+            scheduler.removeCommand(command.get(), true);
+        }
+    }
+
+    int getNumCommands() const { return commands.size(); }
+
+private:
+    CommandScheduler &scheduler;
+    OpenGovernor governor;
+    std::vector<std::unique_ptr<CountingSubsystem>> subsystems;
+    std::vector<std::unique_ptr<CountingCommand>> innerCommands;
+    /// Declared last so that commands are destroyed before the inner commands they run.
+    std::vector<std::unique_ptr<Command>> commands;
+
+    CountingCommand *addInner(Subsystem *subsystem)
+    {
+        innerCommands.push_back(std::make_unique<CountingCommand>(subsystem));
+        return innerCommands.back().get();
+    }
+};
+
+/// Runs one tick of a master scheduler with every command of a synthetic robot scheduled.
+static void benchmarkSyntheticRobotRun(
+    tap::benchmark::State &state,
+    int numSubsystems,
+    int numCommands)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    SyntheticRobot robot(&drivers, scheduler, numSubsystems, numCommands);
+    robot.addCommands();
+
+    for (auto _ : state)
+    {
+        scheduler.run();
+    }
+}
+
+/**
+ * Adds and then removes every command of a synthetic robot, as a robot does when its command
+ * mappings switch modes. Each item is one `addCommand` or `removeCommand`.
+ */
+static void benchmarkSyntheticRobotAddRemove(
+    tap::benchmark::State &state,
+    int numSubsystems,
+    int numCommands)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    SyntheticRobot robot(&drivers, scheduler, numSubsystems, numCommands);
+
+    for (auto _ : state)
+    {
+        robot.addCommands();
+        robot.removeCommands();
+    }
+    state.setItemsProcessed(2 * robot.getNumCommands());
+}
+
+// Per tick cost as the robot grows, with 6 subsystems per 5 commands so all commands are scheduled
+
+TAPROOT_BENCHMARK(CommandScheduler, run_synthetic_6_subsystems_5_commands)
+{
+    benchmarkSyntheticRobotRun(state, 6, 5);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_synthetic_12_subsystems_10_commands)
+{
+    benchmarkSyntheticRobotRun(state, 12, 10);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_synthetic_24_subsystems_20_commands)
+{
+    benchmarkSyntheticRobotRun(state, 24, 20);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_synthetic_30_subsystems_25_commands)
+{
+    benchmarkSyntheticRobotRun(state, 30, 25);
+}
+
+// Per tick cost as subsystems are added without commands
+
+TAPROOT_BENCHMARK(CommandScheduler, run_synthetic_48_subsystems_10_commands)
+{
+    benchmarkSyntheticRobotRun(state, 48, 10);
+}
+
+// Cost of scheduling as the robot grows
+
+TAPROOT_BENCHMARK(CommandScheduler, schedule_synthetic_6_subsystems_5_commands)
+{
+    benchmarkSyntheticRobotAddRemove(state, 6, 5);
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, schedule_synthetic_24_subsystems_20_commands)
+{
+    benchmarkSyntheticRobotAddRemove(state, 24, 20);
+}
+
+/**
+ * A sequence of two races of two concurrent commands of two governor limited commands, on 8
+ * subsystems. The leaves never finish, so the first race runs 4 leaves at depth 4.
+ */
+class CommandTree
+{
+public:
+    explicit CommandTree(tap::Drivers *drivers)
+    {
+        for (int i = 0; i < NUM_LEAVES; i++)
+        {
+            subsystems.push_back(std::make_unique<CountingSubsystem>(drivers));
+            leaves.push_back(std::make_unique<CountingCommand>(subsystems.back().get()));
+            governed.push_back(std::make_unique<GovernorLimitedCommand<1>>(
+                Command::requirementsOf({subsystems.back().get()}),
+                *leaves.back(),
+                std::array<CommandGovernorInterface *, 1>{&governor}));
+        }
+        for (int i = 0; i < NUM_LEAVES / 2; i++)
+        {
+            concurrents.push_back(std::make_unique<ConcurrentCommand<2>>(
+                std::array<Command *, 2>{governed[2 * i].get(), governed[2 * i + 1].get()},
+                "concurrent command"));
+        }
+        for (int i = 0; i < NUM_LEAVES / 4; i++)
+        {
+            races.push_back(std::make_unique<ConcurrentRaceCommand<2>>(
+                std::array<Command *, 2>{concurrents[2 * i].get(), concurrents[2 * i + 1].get()},
+                "race command"));
+        }
+        sequence = std::make_unique<SequentialCommand<2>>(
+            std::array<Command *, 2>{races[0].get(), races[1].get()});
+    }
+
+    void registerSubsystems(CommandScheduler &scheduler)
+    {
+        for (auto &subsystem : subsystems)
+        {
+            scheduler.registerSubsystem(subsystem.get());
+        }
+    }
+
+    Command *getRoot() { return sequence.get(); }
+
+private:
+    static constexpr int NUM_LEAVES = 8;
+
+    OpenGovernor governor;
+    std::vector<std::unique_ptr<CountingSubsystem>> subsystems;
+    std::vector<std::unique_ptr<CountingCommand>> leaves;
+    std::vector<std::unique_ptr<GovernorLimitedCommand<1>>> governed;
+    std::vector<std::unique_ptr<ConcurrentCommand<2>>> concurrents;
+    std::vector<std::unique_ptr<ConcurrentRaceCommand<2>>> races;
+    std::unique_ptr<SequentialCommand<2>> sequence;
+};
+
+// Per tick cost of a nested command tree run through its composites and flattened
+
+TAPROOT_BENCHMARK(CommandScheduler, run_nested_command_tree)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    CommandTree tree(&drivers);
+    tree.registerSubsystems(scheduler);
+    scheduler.addCommand(tree.getRoot());
+
+    for (auto _ : state)
+    {
+        scheduler.run();
+    }
+}
+
+TAPROOT_BENCHMARK(CommandScheduler, run_flattened_command_tree)
+{
+    tap::Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    CommandTree tree(&drivers);
+    FlattenedCommand<15> flattened(tree.getRoot(), "flattened tree");
+    tree.registerSubsystems(scheduler);
+    scheduler.addCommand(&flattened);
+
+    for (auto _ : state)
+    {
+        scheduler.run();
+    }
+}
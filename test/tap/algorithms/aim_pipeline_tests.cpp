@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/aim_pipeline.hpp"
+#include "tap/architecture/clock.hpp"
+
+using namespace tap::algorithms;
+using namespace tap::algorithms::ballistics;
+using namespace tap::arch;
+
+static constexpr uint32_t MEASUREMENT_PERIOD_US = 10'000;
+
+/// Measures a target at `position + velocity * t` every 10 ms from 0 to `endUs`.
+static void trackTarget(
+    AimPipeline &pipeline,
+    const modm::Vector3f &position,
+    const modm::Vector3f &velocity,
+    uint32_t endUs)
+{
+    for (uint32_t timeUs = 0; timeUs <= endUs; timeUs += MEASUREMENT_PERIOD_US)
+    {
+        pipeline.addMeasurement(timeUs, position + velocity * (timeUs * 1E-6f));
+    }
+}
+
+TEST(AimPipeline, update_without_target_returns_false)
+{
+    AimPipeline pipeline;
+    AimSetpoint setpoint;
+
+    EXPECT_FALSE(pipeline.hasTarget(0));
+    EXPECT_FALSE(pipeline.update(0, &setpoint));
+}
+
+TEST(AimPipeline, stationary_target_matches_solver)
+{
+    AimPipeline pipeline;
+    trackTarget(pipeline, modm::Vector3f(4, 2, 0.5f), modm::Vector3f(0, 0, 0), 500'000);
+
+    AimSetpoint setpoint;
+    ASSERT_TRUE(pipeline.update(510'000, &setpoint));
+
+    BallisticsSolver solver;
+    BallisticsSolution expected;
+    ASSERT_TRUE(solver.solve(
+        SecondOrderKinematicState(
+            modm::Vector3f(4, 2, 0.5f),
+            modm::Vector3f(0, 0, 0),
+            modm::Vector3f(0, 0, 0)),
+        AimPipelineConfig().bulletVelocity,
+        &expected));
+    EXPECT_NEAR(expected.turretYaw, setpoint.yaw, 1E-3f);
+    EXPECT_NEAR(expected.turretPitch, setpoint.pitch, 1E-3f);
+    EXPECT_NEAR(expected.travelTime, setpoint.travelTime, 1E-4f);
+    EXPECT_NEAR(0, setpoint.yawVelocity, 1E-3f);
+    EXPECT_NEAR(0, setpoint.pitchVelocity, 1E-3f);
+}
+
+TEST(AimPipeline, moving_target_estimates_velocity_and_feed_forward)
+{
+    AimPipeline pipeline;
+    const modm::Vector3f velocity(0, 2, 0);
+    trackTarget(pipeline, modm::Vector3f(5, -1, 0), velocity, 1'000'000);
+
+    const SecondOrderKinematicState state = pipeline.getTargetState(1'000'000);
+    EXPECT_NEAR(1, state.position.y, 0.01f);
+    EXPECT_NEAR(2, state.velocity.y, 0.05f);
+    EXPECT_NEAR(0, state.acceleration.y, 0.5f);
+
+    AimSetpoint setpoint;
+    ASSERT_TRUE(pipeline.update(1'000'000, &setpoint));
+    const float impactY = 1 + 2 * setpoint.travelTime;
+    EXPECT_NEAR(atan2f(impactY, 5), setpoint.yaw, 2E-3f);
+    // d/dt atan2(y, x) = x * vy / (x^2 + y^2)
+    EXPECT_NEAR(5 * 2 / (25 + impactY * impactY), setpoint.yawVelocity, 0.01f);
+}
+
+TEST(AimPipeline, shot_latency_leads_target)
+{
+    AimPipelineConfig config;
+    config.shotLatency = 0.1f;
+    AimPipeline pipeline(config);
+    trackTarget(pipeline, modm::Vector3f(5, -1, 0), modm::Vector3f(0, 2, 0), 1'000'000);
+
+    AimSetpoint setpoint;
+    ASSERT_TRUE(pipeline.update(1'000'000, &setpoint));
+    const float impactY = 1 + 2 * (0.1f + setpoint.travelTime);
+    EXPECT_NEAR(atan2f(impactY, 5), setpoint.yaw, 2E-3f);
+}
+
+TEST(AimPipeline, late_measurement_is_discarded)
+{
+    AimPipeline pipeline;
+    EXPECT_TRUE(pipeline.addMeasurement(20'000, modm::Vector3f(3, 0, 0)));
+
+    EXPECT_FALSE(pipeline.addMeasurement(10'000, modm::Vector3f(10, 0, 0)));
+    EXPECT_NEAR(3, pipeline.getTargetState(20'000).position.x, 1E-6f);
+}
+
+TEST(AimPipeline, target_lost_after_timeout)
+{
+    AimPipelineConfig config;
+    config.targetTimeoutUs = 100'000;
+    AimPipeline pipeline(config);
+    pipeline.addMeasurement(0, modm::Vector3f(3, 0, 0));
+
+    AimSetpoint setpoint;
+    EXPECT_TRUE(pipeline.update(100'000, &setpoint));
+    EXPECT_FALSE(pipeline.update(100'001, &setpoint));
+
+    // A new measurement restarts tracking from it
+    pipeline.addMeasurement(200'000, modm::Vector3f(6, 0, 0));
+    EXPECT_NEAR(6, pipeline.getTargetState(200'000).position.x, 1E-6f);
+}
+
+TEST(AimPipeline, camera_measurement_uses_attitude_at_exposure_time)
+{
+    clock::ClockStub clock;
+    ClockSync clockSync;
+    // The host clock is 1 s ahead
+    for (uint64_t localUs : {0, 10'000})
+    {
+        clockSync.addExchange(localUs, localUs + 1'000'000, localUs + 1'000'000, localUs);
+    }
+
+    // Level until 50 ms, then yawed 90 degrees
+    AttitudeHistory<8> history;
+    const float gyro[3] = {};
+    const float level[4] = {1, 0, 0, 0};
+    const float yawed[4] = {sqrtf(0.5f), 0, 0, sqrtf(0.5f)};
+    history.push(40'000, level, gyro);
+    history.push(50'000, level, gyro);
+    history.push(60'000, yawed, gyro);
+
+    AimPipeline pipeline;
+    const float cameraPosition[3] = {4, 0, 0};
+    ASSERT_TRUE(pipeline.addCameraMeasurement(1'045'000, clockSync, history, cameraPosition));
+
+    const SecondOrderKinematicState state = pipeline.getTargetState(45'000);
+    EXPECT_NEAR(4, state.position.x, 1E-4f);
+    EXPECT_NEAR(0, state.position.y, 1E-4f);
+
+    // Not in the history
+    EXPECT_FALSE(pipeline.addCameraMeasurement(1'000'000, clockSync, history, cameraPosition));
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/MahonyAHRS.h"
+#include "tap/algorithms/attitude_eskf.hpp"
+#include "tap/algorithms/math_user_utils.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr float G = ACCELERATION_GRAVITY;
+
+TEST(AttitudeEskf, level_and_stationary_angles_zero)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+
+    for (int i = 0; i < 100; i++)
+    {
+        eskf.updateIMU(0, 0, 0, 0, 0, G);
+    }
+
+    EXPECT_NEAR(0, eskf.getRoll(), 1E-4);
+    EXPECT_NEAR(0, eskf.getPitch(), 1E-4);
+    EXPECT_NEAR(0, eskf.getYaw(), 1E-4);
+}
+
+TEST(AttitudeEskf, first_sample_levels_to_accelerometer)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+
+    // 30 degrees of roll
+    eskf.updateIMU(0, 0, 0, 0, G * sinf(M_PI / 6), G * cosf(M_PI / 6));
+
+    EXPECT_NEAR(30, eskf.getRoll(), 1E-3);
+    EXPECT_NEAR(0, eskf.getPitch(), 1E-3);
+    EXPECT_NEAR(0, eskf.getYaw(), 1E-3);
+}
+
+TEST(AttitudeEskf, constant_yaw_rate_integrates_at_sample_frequency)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(1000);
+
+    // 90 deg/s for 0.5 s
+    for (int i = 0; i < 500; i++)
+    {
+        eskf.updateIMU(0, 0, 90, 0, 0, G);
+    }
+
+    EXPECT_NEAR(45, eskf.getYaw(), 0.05);
+    EXPECT_NEAR(M_PI / 4, eskf.getYawRadians(), 1E-3);
+    EXPECT_FALSE(eskf.isStationary());
+}
+
+TEST(AttitudeEskf, yaw_wrapped_between_0_and_360)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(100);
+
+    for (int i = 0; i < 50; i++)
+    {
+        eskf.updateIMU(0, 0, -90, 0, 0, G);
+    }
+
+    EXPECT_NEAR(315, eskf.getYaw(), 0.05);
+    EXPECT_NEAR(-M_PI / 4, eskf.getYawRadians(), 1E-3);
+}
+
+TEST(AttitudeEskf, learns_yaw_gyro_bias_while_stationary)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+
+    // 20 s with an uncalibrated yaw gyroscope
+    for (int i = 0; i < 10'000; i++)
+    {
+        eskf.updateIMU(0, 0, 0.3f, 0, 0, G);
+    }
+
+    EXPECT_TRUE(eskf.isStationary());
+    float bias[3];
+    eskf.getGyroBias(bias);
+    EXPECT_NEAR(0.3f, bias[2], 0.01f);
+
+    // Without the bias yaw would have drifted 6 degrees, it stops drifting soon after the
+    // stationary time.
+    float yaw = eskf.getYawRadians() * 180 / M_PI;
+    EXPECT_LT(fabsf(yaw), 0.3f);
+}
+
+TEST(AttitudeEskf, accelerometer_corrects_tilt)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+    eskf.updateIMU(0, 0, 0, 0, 0, G);
+
+    for (int i = 0; i < 2'000; i++)
+    {
+        eskf.updateIMU(0, 0, 0, 0, G * sinf(M_PI / 18), G * cosf(M_PI / 18));
+    }
+
+    EXPECT_NEAR(10, eskf.getRoll(), 0.5f);
+}
+
+TEST(AttitudeEskf, accelerometer_ignored_when_not_measuring_gravity)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+    eskf.updateIMU(0, 0, 0, 0, 0, G);
+
+    // Hard acceleration sideways
+    for (int i = 0; i < 500; i++)
+    {
+        eskf.updateIMU(0, 0, 0, 0, 2 * G, G);
+    }
+
+    EXPECT_NEAR(0, eskf.getRoll(), 1E-4);
+}
+
+TEST(AttitudeEskf, reset_forgets_bias_and_attitude)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+    for (int i = 0; i < 5'000; i++)
+    {
+        eskf.updateIMU(0, 0, 0.3f, 0, G * sinf(M_PI / 18), G * cosf(M_PI / 18));
+    }
+
+    eskf.reset();
+
+    float bias[3];
+    eskf.getGyroBias(bias);
+    EXPECT_EQ(0, bias[2]);
+    EXPECT_EQ(0, eskf.getRoll());
+    EXPECT_EQ(0, eskf.getYaw());
+}
+
+TEST(AttitudeEskf, covariance_stays_symmetric_and_quaternion_normalized)
+{
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(500);
+
+    for (int i = 0; i < 5'000; i++)
+    {
+        eskf.updateIMU(100, -50, 200, 0.1f * G, 0.2f * G, 0.97f * G);
+    }
+
+    const auto &P = eskf.getCovariance();
+    for (int i = 0; i < AttitudeEskf::ERROR_STATES; i++)
+    {
+        EXPECT_GT(P.data[i * AttitudeEskf::ERROR_STATES + i], 0);
+        for (int j = 0; j < AttitudeEskf::ERROR_STATES; j++)
+        {
+            EXPECT_EQ(
+                P.data[i * AttitudeEskf::ERROR_STATES + j],
+                P.data[j * AttitudeEskf::ERROR_STATES + i]);
+        }
+    }
+
+    float q[4];
+    eskf.getQuaternion(q);
+    EXPECT_NEAR(1, q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1E-6);
+}
+
+/// An IMU sample and the true roll, pitch, and yaw it was generated from, in degrees.
+struct LogSample
+{
+    float gyro[3];
+    float acc[3];
+    float angles[3];
+};
+
+/**
+ * @return 60 s of samples at 1 kHz of a robot that sits still, turns and tilts, and sits still
+ *      again, read by a gyroscope with an uncalibrated bias and white noise and an accelerometer
+ *      with vibration.
+ */
+static std::vector<LogSample> generateTurningLog()
+{
+    static constexpr float SAMPLE_FREQUENCY = 1000;
+    static constexpr float RAD_TO_DEG = 180.0f / M_PI;
+    std::mt19937 generator(34);
+    std::normal_distribution<float> gyroNoise(0, 0.1f);
+    std::normal_distribution<float> accNoise(0, 0.3f);
+    const float gyroBias[3] = {0.2f, -0.15f, 0.25f};
+    const float dt = 1 / SAMPLE_FREQUENCY;
+
+    std::vector<LogSample> log;
+    float q[4] = {1, 0, 0, 0};
+    for (int i = 0; i < 60 * SAMPLE_FREQUENCY; i++)
+    {
+        const float t = i * dt;
+        float w[3] = {0, 0, 0};
+        if (t > 20 && t < 35)
+        {
+            w[0] = 0.3f * sinf(2 * M_PI * 0.5f * t);
+            w[1] = 0.4f * sinf(2 * M_PI * 0.3f * t);
+            w[2] = 1.5f * sinf(2 * M_PI * 0.2f * t);
+        }
+
+        // Exact integration of a constant angular velocity over the sample
+        float angle = sqrtf(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * dt;
+        float s = angle > 0 ? sinf(angle / 2) / (angle / dt) : 0;
+        float dq[4] = {cosf(angle / 2), w[0] * s, w[1] * s, w[2] * s};
+        float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+        q[0] = q0 * dq[0] - q1 * dq[1] - q2 * dq[2] - q3 * dq[3];
+        q[1] = q0 * dq[1] + q1 * dq[0] + q2 * dq[3] - q3 * dq[2];
+        q[2] = q0 * dq[2] - q1 * dq[3] + q2 * dq[0] + q3 * dq[1];
+        q[3] = q0 * dq[3] + q1 * dq[2] - q2 * dq[1] + q3 * dq[0];
+
+        LogSample sample;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            sample.gyro[axis] = (w[axis] * RAD_TO_DEG + gyroBias[axis]) + gyroNoise(generator);
+        }
+        sample.acc[0] = 2 * (q[1] * q[3] - q[0] * q[2]) * G;
+        sample.acc[1] = 2 * (q[0] * q[1] + q[2] * q[3]) * G;
+        sample.acc[2] = (q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]) * G;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            sample.acc[axis] += accNoise(generator);
+        }
+        sample.angles[0] =
+            atan2f(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]) * RAD_TO_DEG;
+        sample.angles[1] = asinf(-2 * (q[1] * q[3] - q[0] * q[2])) * RAD_TO_DEG;
+        sample.angles[2] =
+            atan2f(q[1] * q[2] + q[0] * q[3], 0.5f - q[2] * q[2] - q[3] * q[3]) * RAD_TO_DEG;
+        log.push_back(sample);
+    }
+    return log;
+}
+
+/// @return `estimate - reference`, wrapped to [-180, 180] degrees.
+static float angleError(float estimate, float reference)
+{
+    float error = fmodf(estimate - reference, 360.0f);
+    if (error > 180)
+    {
+        error -= 360;
+    }
+    else if (error < -180)
+    {
+        error += 360;
+    }
+    return error;
+}
+
+/**
+ * Runs `estimator` over `log`, setting `rmsTiltError` to the RMS of its roll and pitch errors and
+ * `finalYawError` to its yaw error at the end of the log, in degrees.
+ */
+static void runLog(
+    AttitudeEstimator &estimator,
+    const std::vector<LogSample> &log,
+    float *rmsTiltError,
+    float *finalYawError)
+{
+    float tiltSquaredSum = 0;
+    for (const LogSample &s : log)
+    {
+        estimator.updateIMU(s.gyro[0], s.gyro[1], s.gyro[2], s.acc[0], s.acc[1], s.acc[2]);
+        const float rollError = angleError(estimator.getRoll(), s.angles[0]);
+        const float pitchError = angleError(estimator.getPitch(), s.angles[1]);
+        tiltSquaredSum += rollError * rollError + pitchError * pitchError;
+        *finalYawError = angleError(estimator.getYaw(), log.back().angles[2]);
+    }
+    *rmsTiltError = sqrtf(tiltSquaredSum / log.size());
+}
+
+TEST(AttitudeEskf, tracks_turning_log_with_less_yaw_drift_than_mahony)
+{
+    const std::vector<LogSample> log = generateTurningLog();
+
+    Mahony mahony;
+    mahony.begin(1000, 0.1f, 0);
+    AttitudeEskf eskf;
+    eskf.setSampleFrequency(1000);
+
+    float mahonyTiltError, mahonyYawError, eskfTiltError, eskfYawError;
+    runLog(mahony, log, &mahonyTiltError, &mahonyYawError);
+    runLog(eskf, log, &eskfTiltError, &eskfYawError);
+
+    // The yaw gyroscope bias can only be learned while stationary, which Mahony doesn't do
+    EXPECT_LT(fabsf(eskfYawError), fabsf(mahonyYawError));
+    EXPECT_LT(eskfTiltError, 2.0f);
+}
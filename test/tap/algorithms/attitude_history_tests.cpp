@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/attitude_history.hpp"
+
+using namespace tap::algorithms;
+
+/// Pushes a rotation of `angle` radians about z.
+template <int CAPACITY>
+static void pushYaw(AttitudeHistory<CAPACITY> &history, uint32_t time, float angle, float rate = 0)
+{
+    history.push(time, {cosf(angle / 2), 0, 0, sinf(angle / 2)}, {0, 0, rate});
+}
+
+static float yawOf(const float (&q)[4]) { return 2 * atan2f(q[3], q[0]); }
+
+TEST(AttitudeHistory, empty_lookup_fails)
+{
+    AttitudeHistory<8> history;
+    float q[4] = {};
+
+    EXPECT_FALSE(history.getAttitudeAt(0, q));
+    EXPECT_EQ(0, history.size());
+}
+
+TEST(AttitudeHistory, lookup_of_entry_time_returns_entry)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, 1000, 0.1f);
+    pushYaw(history, 2000, 0.2f);
+    pushYaw(history, 3000, 0.3f);
+
+    float q[4];
+    ASSERT_TRUE(history.getAttitudeAt(2000, q));
+    EXPECT_NEAR(0.2f, yawOf(q), 1E-5);
+    ASSERT_TRUE(history.getAttitudeAt(1000, q));
+    EXPECT_NEAR(0.1f, yawOf(q), 1E-5);
+}
+
+TEST(AttitudeHistory, lookup_between_entries_interpolates)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, 1000, 0.1f, 10);
+    pushYaw(history, 2000, 0.3f, 30);
+
+    float q[4];
+    ASSERT_TRUE(history.getAttitudeAt(1250, q));
+    EXPECT_NEAR(0.15f, yawOf(q), 1E-3);
+    EXPECT_NEAR(1, q[0] * q[0] + q[3] * q[3], 1E-6);
+
+    float gyro[3];
+    ASSERT_TRUE(history.getGyroAt(1750, gyro));
+    EXPECT_FLOAT_EQ(25, gyro[2]);
+}
+
+TEST(AttitudeHistory, lookup_after_newest_returns_newest)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, 1000, 0.1f);
+    pushYaw(history, 2000, 0.2f);
+
+    float q[4];
+    ASSERT_TRUE(history.getAttitudeAt(5000, q));
+    EXPECT_NEAR(0.2f, yawOf(q), 1E-5);
+}
+
+TEST(AttitudeHistory, lookup_before_oldest_fails_once_overwritten)
+{
+    AttitudeHistory<4> history;
+    for (uint32_t i = 1; i <= 6; i++)
+    {
+        pushYaw(history, i * 1000, i * 0.1f);
+    }
+
+    float q[4];
+    EXPECT_EQ(4, history.size());
+    EXPECT_EQ(3000u, history.getOldestTime());
+    EXPECT_EQ(6000u, history.getNewestTime());
+    EXPECT_FALSE(history.getAttitudeAt(2500, q));
+    ASSERT_TRUE(history.getAttitudeAt(3500, q));
+    EXPECT_NEAR(0.35f, yawOf(q), 1E-3);
+}
+
+TEST(AttitudeHistory, push_at_same_time_replaces_newest)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, 1000, 0.1f);
+    pushYaw(history, 1000, 0.2f);
+
+    float q[4];
+    EXPECT_EQ(1, history.size());
+    ASSERT_TRUE(history.getAttitudeAt(1000, q));
+    EXPECT_NEAR(0.2f, yawOf(q), 1E-5);
+}
+
+TEST(AttitudeHistory, interpolates_across_quaternion_sign_flip)
+{
+    AttitudeHistory<8> history;
+    history.push(1000, {0, 0, 0, 1}, {});
+    // The same rotation as above, with the opposite sign
+    history.push(2000, {0, 0, 0, -1}, {});
+
+    float q[4];
+    ASSERT_TRUE(history.getAttitudeAt(1500, q));
+    EXPECT_NEAR(1, fabsf(q[3]), 1E-5);
+}
+
+TEST(AttitudeHistory, lookup_across_clock_wrap)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, UINT32_MAX - 499, 0.1f);
+    pushYaw(history, 500, 0.2f);
+
+    float q[4];
+    ASSERT_TRUE(history.getAttitudeAt(0, q));
+    EXPECT_NEAR(0.15f, yawOf(q), 1E-3);
+}
+
+TEST(AttitudeHistory, clear_removes_entries)
+{
+    AttitudeHistory<8> history;
+    pushYaw(history, 1000, 0.1f);
+
+    history.clear();
+
+    float q[4];
+    EXPECT_FALSE(history.getAttitudeAt(1000, q));
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/ballistics_table.hpp"
+
+using namespace tap::algorithms::ballistics;
+
+static constexpr float BULLET_VELOCITY = 25;
+
+/// 0.25 m by 0.2 m grid from 0.5 to 8 m away and 1 m below to 2 m above the turret.
+using Table = BallisticsTable<31, 16>;
+
+static void initialize(Table &table, const DragModel &drag = DragModel())
+{
+    table.initialize(BULLET_VELOCITY, 0.5f, 8.0f, -1.0f, 2.0f, drag);
+}
+
+TEST(BallisticsTable, lookup_before_initialize_fails)
+{
+    Table table;
+    float travelTime, turretPitch;
+
+    EXPECT_FALSE(table.computeTravelTime(modm::Vector3f(3, 0, 0), &travelTime, &turretPitch));
+}
+
+static void expectLookupsMatchSolver(const DragModel &drag)
+{
+    Table table;
+    initialize(table, drag);
+    BallisticsSolver solver(drag);
+
+    // Points between grid points, where interpolation error is largest
+    for (float distance = 0.6f; distance < 8; distance += 0.37f)
+    {
+        for (float height = -0.95f; height < 2; height += 0.29f)
+        {
+            const modm::Vector3f position(distance * 0.6f, distance * 0.8f, height);
+            float travelTime, turretPitch;
+            ASSERT_TRUE(table.computeTravelTime(position, &travelTime, &turretPitch));
+
+            SecondOrderKinematicState target(
+                position,
+                modm::Vector3f(0, 0, 0),
+                modm::Vector3f(0, 0, 0));
+            BallisticsSolution solution;
+            ASSERT_TRUE(solver.solve(target, BULLET_VELOCITY, &solution));
+            EXPECT_NEAR(solution.turretPitch, turretPitch, 5E-4);
+            EXPECT_NEAR(solution.travelTime, travelTime, 5E-4);
+        }
+    }
+}
+
+TEST(BallisticsTable, lookup_inside_grid_matches_solver_without_drag)
+{
+    expectLookupsMatchSolver(DragModel());
+}
+
+TEST(BallisticsTable, lookup_inside_grid_matches_solver_with_drag)
+{
+    expectLookupsMatchSolver({DragModel::Type::QUADRATIC, 0.02f});
+}
+
+TEST(BallisticsTable, lookup_outside_grid_falls_back_to_solver)
+{
+    Table table;
+    initialize(table);
+    BallisticsSolver solver;
+    const modm::Vector3f position(12, 0, 0.5f);
+
+    float travelTime, turretPitch;
+    ASSERT_TRUE(table.computeTravelTime(position, &travelTime, &turretPitch));
+
+    SecondOrderKinematicState target(position, modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0));
+    BallisticsSolution solution;
+    ASSERT_TRUE(solver.solve(target, BULLET_VELOCITY, &solution));
+    EXPECT_FLOAT_EQ(solution.turretPitch, turretPitch);
+    EXPECT_FLOAT_EQ(solution.travelTime, travelTime);
+}
+
+TEST(BallisticsTable, lookup_out_of_range_fails)
+{
+    BallisticsTable<4, 4> table;
+    table.initialize(5, 0.5f, 8.0f, -1.0f, 2.0f);
+
+    float travelTime, turretPitch;
+    EXPECT_FALSE(table.computeTravelTime(modm::Vector3f(8, 0, 0), &travelTime, &turretPitch));
+    EXPECT_FALSE(table.computeTravelTime(modm::Vector3f(20, 0, 0), &travelTime, &turretPitch));
+}
+
+TEST(BallisticsTable, findTargetProjectileIntersection_matches_free_function)
+{
+    Table table;
+    initialize(table);
+    SecondOrderKinematicState target(
+        modm::Vector3f(5, 1, 0.8f),
+        modm::Vector3f(0, 2, 0),
+        modm::Vector3f(0, 0, 0));
+
+    float pitch, yaw, travelTime;
+    ASSERT_TRUE(table.findTargetProjectileIntersection(target, 3, &pitch, &yaw, &travelTime));
+    float expectedPitch, expectedYaw, expectedTravelTime;
+    ASSERT_TRUE(findTargetProjectileIntersection(
+        target,
+        BULLET_VELOCITY,
+        3,
+        &expectedPitch,
+        &expectedYaw,
+        &expectedTravelTime));
+
+    EXPECT_NEAR(expectedPitch, pitch, 2E-3);
+    EXPECT_NEAR(expectedYaw, yaw, 1E-3);
+    EXPECT_NEAR(expectedTravelTime, travelTime, 1E-3);
+}
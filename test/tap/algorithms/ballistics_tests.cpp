@@ -17,9 +17,13 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "tap/algorithms/ballistics.hpp"
+#include "tap/algorithms/math_user_utils.hpp"
 
 using namespace tap::algorithms::ballistics;
 
@@ -335,3 +339,401 @@ TEST(
     EXPECT_GT(0, turretPitch);
     EXPECT_GT(10. / 30., timeOfFlight);
 }
+
+/**
+ * Integrates the trajectory of a projectile launched at `speed` with the given turret pitch and
+ * yaw under gravity and `drag` using RK4, returning its position after `time`.
+ */
+static modm::Vector3f simulateProjectile(
+    const DragModel &drag,
+    float speed,
+    float turretPitch,
+    float turretYaw,
+    float time)
+{
+    const double step = 1E-4;
+    double p[3] = {};
+    double v[3] = {
+        speed * cos(turretPitch) * cos(turretYaw),
+        speed * cos(turretPitch) * sin(turretYaw),
+        -speed * sin(turretPitch)};
+
+    auto acceleration = [&](const double(&vel)[3], double(&a)[3]) {
+        const double magnitude = sqrt(vel[0] * vel[0] + vel[1] * vel[1] + vel[2] * vel[2]);
+        double scale = 0;
+        if (drag.type == DragModel::Type::LINEAR)
+        {
+            scale = drag.coefficient;
+        }
+        else if (drag.type == DragModel::Type::QUADRATIC)
+        {
+            scale = drag.coefficient * magnitude;
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            a[i] = -scale * vel[i];
+        }
+        a[2] -= tap::algorithms::ACCELERATION_GRAVITY;
+    };
+
+    for (double t = 0; t < time; t += step)
+    {
+        const double h = std::min(step, time - t);
+        double k1[3], k2[3], k3[3], k4[3], v2[3], v3[3], v4[3];
+        acceleration(v, k1);
+        for (int i = 0; i < 3; i++)
+        {
+            v2[i] = v[i] + h / 2 * k1[i];
+        }
+        acceleration(v2, k2);
+        for (int i = 0; i < 3; i++)
+        {
+            v3[i] = v[i] + h / 2 * k2[i];
+        }
+        acceleration(v3, k3);
+        for (int i = 0; i < 3; i++)
+        {
+            v4[i] = v[i] + h * k3[i];
+        }
+        acceleration(v4, k4);
+        for (int i = 0; i < 3; i++)
+        {
+            p[i] += h / 6 * (v[i] + 2 * v2[i] + 2 * v3[i] + v4[i]);
+            v[i] += h / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+        }
+    }
+    return modm::Vector3f(p[0], p[1], p[2]);
+}
+
+/// Targets 1 to 8 m away, below and above the turret, stationary and moving.
+static std::vector<SecondOrderKinematicState> targetGrid()
+{
+    std::vector<SecondOrderKinematicState> targets;
+    for (float distance = 1; distance <= 8; distance += 1)
+    {
+        for (float height : {-0.5f, 0.0f, 0.5f, 1.5f})
+        {
+            for (float speed : {0.0f, 2.0f})
+            {
+                targets.emplace_back(
+                    modm::Vector3f(distance * 0.8f, distance * 0.6f, height),
+                    modm::Vector3f(-speed * 0.6f, speed * 0.8f, 0),
+                    modm::Vector3f(0, 0, 0));
+            }
+        }
+    }
+    return targets;
+}
+
+TEST(BallisticsSolver, without_drag_matches_findTargetProjectileIntersection)
+{
+    BallisticsSolver solver;
+
+    for (const auto &target : targetGrid())
+    {
+        // findTargetProjectileIntersection treats shots within 1E-2 radians of level as
+        // vertical shots, so only compare targets that need more elevation than that
+        if (target.position.z < 0.5f)
+        {
+            continue;
+        }
+
+        float turretPitch, turretYaw, travelTime;
+        ASSERT_TRUE(findTargetProjectileIntersection(
+            target,
+            25,
+            20,
+            &turretPitch,
+            &turretYaw,
+            &travelTime));
+
+        BallisticsSolution solution;
+        ASSERT_TRUE(solver.solve(target, 25, &solution));
+        EXPECT_TRUE(solution.converged);
+        EXPECT_NEAR(turretPitch, solution.turretPitch, 1E-4);
+        EXPECT_NEAR(turretYaw, solution.turretYaw, 1E-4);
+        EXPECT_NEAR(travelTime, solution.travelTime, 1E-5);
+    }
+}
+
+/**
+ * Checks that solutions hit every target in the grid within `tolerance`, or `steepTolerance` for
+ * targets more than 20 degrees above level.
+ */
+static void expectSolutionsHitTargets(
+    const DragModel &drag,
+    float speed,
+    float tolerance,
+    float steepTolerance)
+{
+    BallisticsSolver solver(drag);
+
+    for (const auto &target : targetGrid())
+    {
+        BallisticsSolution solution;
+        ASSERT_TRUE(solver.solve(target, speed, &solution));
+
+        const modm::Vector3f hit = simulateProjectile(
+            drag,
+            speed,
+            solution.turretPitch,
+            solution.turretYaw,
+            solution.travelTime);
+        const modm::Vector3f targetPosition = target.projectForward(solution.travelTime);
+        const float elevation =
+            atan2f(target.position.z, hypotf(target.position.x, target.position.y));
+        EXPECT_NEAR(
+            0,
+            (hit - targetPosition).getLength(),
+            elevation > modm::toRadian(20) ? steepTolerance : tolerance)
+            << "target at " << target.position.x << ", " << target.position.y << ", "
+            << target.position.z;
+    }
+}
+
+TEST(BallisticsSolver, without_drag_solutions_hit_targets)
+{
+    expectSolutionsHitTargets({}, 25, 1E-3, 1E-3);
+}
+
+TEST(BallisticsSolver, linear_drag_solutions_hit_targets)
+{
+    expectSolutionsHitTargets({DragModel::Type::LINEAR, 0.3f}, 25, 1E-3, 1E-3);
+}
+
+TEST(BallisticsSolver, quadratic_drag_solutions_hit_targets_17mm)
+{
+    expectSolutionsHitTargets({DragModel::Type::QUADRATIC, 0.02f}, 25, 5E-3, 1E-2);
+}
+
+TEST(BallisticsSolver, quadratic_drag_solutions_hit_targets_42mm)
+{
+    expectSolutionsHitTargets({DragModel::Type::QUADRATIC, 0.01f}, 15, 5E-3, 1E-2);
+}
+
+TEST(BallisticsSolver, drag_free_solution_misses_under_drag)
+{
+    const DragModel drag{DragModel::Type::QUADRATIC, 0.02f};
+    SecondOrderKinematicState target(
+        modm::Vector3f(8, 0, 0),
+        modm::Vector3f(0, 0, 0),
+        modm::Vector3f(0, 0, 0));
+
+    float turretPitch, turretYaw, travelTime;
+    ASSERT_TRUE(
+        findTargetProjectileIntersection(target, 25, 3, &turretPitch, &turretYaw, &travelTime));
+    const modm::Vector3f hit =
+        simulateProjectile(drag, 25, turretPitch, turretYaw, travelTime);
+
+    EXPECT_GT((hit - target.position).getLength(), 0.1f);
+}
+
+TEST(BallisticsSolver, warm_start_converges_in_fewer_iterations)
+{
+    BallisticsSolver solver({DragModel::Type::QUADRATIC, 0.02f});
+    SecondOrderKinematicState target(
+        modm::Vector3f(6, 1, 0.3f),
+        modm::Vector3f(0, 1.5f, 0),
+        modm::Vector3f(0, 0, 0));
+
+    BallisticsSolution cold;
+    ASSERT_TRUE(solver.solve(target, 25, &cold));
+
+    // The target one control loop later
+    target.position = target.projectForward(0.002f);
+    BallisticsSolution warm;
+    ASSERT_TRUE(solver.solve(target, 25, &warm));
+
+    EXPECT_LT(warm.iterations, cold.iterations);
+    EXPECT_LE(warm.iterations, 2);
+}
+
+TEST(BallisticsSolver, warm_start_converges_every_loop_tracking_strafing_target)
+{
+    for (float distance : {2.0f, 5.0f, 8.0f})
+    {
+        BallisticsSolver solver({DragModel::Type::QUADRATIC, 0.02f});
+        BallisticsSolution solution;
+
+        // A target strafing at 2 m/s, solved for every 2 ms control loop
+        for (int i = 0; i < 2'000; i++)
+        {
+            const float t = i * 0.002f;
+            SecondOrderKinematicState target(
+                modm::Vector3f(distance, 2 * sinf(t), 0.3f),
+                modm::Vector3f(0, 2 * cosf(t), 0),
+                modm::Vector3f(0, 0, 0));
+            ASSERT_TRUE(solver.solve(target, 25, &solution)) << distance << " m, loop " << i;
+        }
+    }
+}
+
+TEST(BallisticsSolver, target_out_of_range_not_converged)
+{
+    BallisticsSolver solver;
+    SecondOrderKinematicState target(
+        modm::Vector3f(20, 0, 0),
+        modm::Vector3f(0, 0, 0),
+        modm::Vector3f(0, 0, 0));
+
+    BallisticsSolution solution;
+    EXPECT_FALSE(solver.solve(target, 5, &solution));
+    EXPECT_FALSE(solution.converged);
+}
+
+TEST(BallisticsSolver, target_at_turret_position_fails)
+{
+    BallisticsSolver solver;
+    SecondOrderKinematicState target(
+        modm::Vector3f(0, 0, 0),
+        modm::Vector3f(0, 0, 0),
+        modm::Vector3f(0, 0, 0));
+
+    BallisticsSolution solution;
+    EXPECT_FALSE(solver.solve(target, 25, &solution));
+}
+
+TEST(Ballistics, findTargetProjectileIntersections_matches_findTargetProjectileIntersection)
+{
+    const std::vector<SecondOrderKinematicState> candidates = targetGrid();
+
+    std::vector<CandidateSolution> solutions(candidates.size());
+    int numSolutions = findTargetProjectileIntersections(
+        candidates.data(),
+        candidates.size(),
+        25,
+        3,
+        CandidateRanking::TRAVEL_TIME,
+        0,
+        0,
+        solutions.data());
+
+    for (int i = 0; i < numSolutions; i++)
+    {
+        const CandidateSolution &solution = solutions[i];
+        float turretPitch, turretYaw, travelTime;
+        ASSERT_TRUE(findTargetProjectileIntersection(
+            candidates[solution.candidate],
+            25,
+            3,
+            &turretPitch,
+            &turretYaw,
+            &travelTime));
+        EXPECT_FLOAT_EQ(turretPitch, solution.turretPitch);
+        EXPECT_FLOAT_EQ(turretYaw, solution.turretYaw);
+        EXPECT_FLOAT_EQ(travelTime, solution.travelTime);
+    }
+
+    int numExpected = 0;
+    for (const auto &candidate : candidates)
+    {
+        float turretPitch, turretYaw, travelTime;
+        numExpected += findTargetProjectileIntersection(
+            candidate,
+            25,
+            3,
+            &turretPitch,
+            &turretYaw,
+            &travelTime);
+    }
+    EXPECT_EQ(numExpected, numSolutions);
+}
+
+TEST(Ballistics, findTargetProjectileIntersections_skips_candidates_out_of_range)
+{
+    const SecondOrderKinematicState candidates[] = {
+        {modm::Vector3f(100, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(3, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+    };
+
+    CandidateSolution solutions[3];
+    int numSolutions = findTargetProjectileIntersections(
+        candidates,
+        3,
+        10,
+        3,
+        CandidateRanking::TRAVEL_TIME,
+        0,
+        0,
+        solutions);
+
+    ASSERT_EQ(1, numSolutions);
+    EXPECT_EQ(2, solutions[0].candidate);
+}
+
+TEST(Ballistics, findTargetProjectileIntersections_ranks_by_travel_time)
+{
+    const SecondOrderKinematicState candidates[] = {
+        {modm::Vector3f(6, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(0, 2, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(4, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+    };
+
+    CandidateSolution solutions[3];
+    int numSolutions = findTargetProjectileIntersections(
+        candidates,
+        3,
+        25,
+        3,
+        CandidateRanking::TRAVEL_TIME,
+        0,
+        0,
+        solutions);
+
+    ASSERT_EQ(3, numSolutions);
+    EXPECT_EQ(1, solutions[0].candidate);
+    EXPECT_EQ(2, solutions[1].candidate);
+    EXPECT_EQ(0, solutions[2].candidate);
+    EXPECT_LT(solutions[0].travelTime, solutions[1].travelTime);
+    EXPECT_LT(solutions[1].travelTime, solutions[2].travelTime);
+}
+
+TEST(Ballistics, findTargetProjectileIntersections_ranks_by_turret_motion)
+{
+    // The nearest candidate is behind the turret, the one ahead needs the least motion
+    const SecondOrderKinematicState candidates[] = {
+        {modm::Vector3f(-2, 0, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(0, 5, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+        {modm::Vector3f(5, 0.5, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+    };
+
+    CandidateSolution solutions[3];
+    int numSolutions = findTargetProjectileIntersections(
+        candidates,
+        3,
+        25,
+        3,
+        CandidateRanking::TURRET_MOTION,
+        0,
+        0,
+        solutions);
+
+    ASSERT_EQ(3, numSolutions);
+    EXPECT_EQ(2, solutions[0].candidate);
+    EXPECT_EQ(1, solutions[1].candidate);
+    EXPECT_EQ(0, solutions[2].candidate);
+    EXPECT_NEAR(M_PI, solutions[2].turretMotion, 1E-2);
+}
+
+TEST(Ballistics, findTargetProjectileIntersections_turret_motion_wraps_yaw)
+{
+    const SecondOrderKinematicState candidates[] = {
+        {modm::Vector3f(-5, -0.5, 0), modm::Vector3f(0, 0, 0), modm::Vector3f(0, 0, 0)},
+    };
+
+    CandidateSolution solution;
+    ASSERT_EQ(
+        1,
+        findTargetProjectileIntersections(
+            candidates,
+            1,
+            25,
+            3,
+            CandidateRanking::TURRET_MOTION,
+            0,
+            M_PI - 0.1f,
+            &solution));
+
+    EXPECT_NEAR(0.1f + atan2f(0.5f, 5), solution.turretMotion, 1E-2);
+}
@@ -173,3 +173,122 @@ TEST(CMSISMat, inverse_simple_test)
         EXPECT_FLOAT_EQ(result[i], res.data[i]);
     }
 }
+
+TEST(CMSISMat, multiply_matches_multop)
+{
+    CMSISMat<2, 3> a({1, 2, 3, 4, 5, 6});
+    CMSISMat<3, 2> b({7, 8, 9, 10, 11, 12});
+    CMSISMat<2, 2> c;
+
+    multiply(a, b, c);
+
+    CMSISMat<2, 2> expected = a * b;
+    for (size_t i = 0; i < c.data.size(); i++)
+    {
+        EXPECT_FLOAT_EQ(expected.data[i], c.data[i]);
+    }
+}
+
+TEST(CMSISMat, mulAdd_accumulates_scaled_product_in_place)
+{
+    CMSISMat<2, 2> a({1, 2, 3, 4});
+    CMSISMat<2, 1> b({5, 6});
+    CMSISMat<2, 1> c({1, 1});
+
+    mulAdd(a, b, c, c, -1.0f);
+
+    EXPECT_FLOAT_EQ(1 - 17, c.data[0]);
+    EXPECT_FLOAT_EQ(1 - 39, c.data[1]);
+}
+
+TEST(CMSISMat, mulTransposed_matches_multop_with_transpose)
+{
+    CMSISMat<2, 3> a({1, 2, 3, 4, 5, 6});
+    CMSISMat<2, 3> b({7, 8, 9, 10, 11, 12});
+    CMSISMat<2, 2> c;
+
+    mulTransposed(a, b, c);
+
+    CMSISMat<2, 2> expected = a * b.transpose();
+    for (size_t i = 0; i < c.data.size(); i++)
+    {
+        EXPECT_FLOAT_EQ(expected.data[i], c.data[i]);
+    }
+}
+
+TEST(CMSISMat, mulTransposedAdd_accumulates_in_place)
+{
+    CMSISMat<2, 2> a({1, 2, 3, 4});
+    CMSISMat<2, 2> b({5, 6, 7, 8});
+    CMSISMat<2, 2> c({1, 2, 3, 4});
+
+    CMSISMat<2, 2> expected = c + a * b.transpose() * 2.0f;
+    mulTransposedAdd(a, b, c, c, 2.0f);
+
+    for (size_t i = 0; i < c.data.size(); i++)
+    {
+        EXPECT_FLOAT_EQ(expected.data[i], c.data[i]);
+    }
+}
+
+TEST(CMSISMat, axpy_adds_scaled_matrix)
+{
+    CMSISMat<2, 1> x({1, 2});
+    CMSISMat<2, 1> y({10, 20});
+
+    axpy(3.0f, x, y);
+
+    EXPECT_FLOAT_EQ(13, y.data[0]);
+    EXPECT_FLOAT_EQ(26, y.data[1]);
+}
+
+TEST(CMSISMat, inverse_into_destination)
+{
+    CMSISMat<2, 2> a({1, 2, 3, 4});
+    CMSISMat<2, 2> res;
+
+    inverse(a, res);
+
+    EXPECT_FLOAT_EQ(-2, res.data[0]);
+    EXPECT_FLOAT_EQ(1, res.data[1]);
+    EXPECT_FLOAT_EQ(1.5, res.data[2]);
+    EXPECT_FLOAT_EQ(-0.5, res.data[3]);
+}
+
+TEST(CMSISMat, choleskyDecompose_factors_positive_definite_matrix)
+{
+    CMSISMat<3, 3> a({4, 12, -16, 12, 37, -43, -16, -43, 98});
+    CMSISMat<3, 3> l;
+
+    ASSERT_TRUE(choleskyDecompose(a, l));
+
+    const float expected[] = {2, 0, 0, 6, 1, 0, -8, 5, 3};
+    for (size_t i = 0; i < l.data.size(); i++)
+    {
+        EXPECT_FLOAT_EQ(expected[i], l.data[i]);
+    }
+}
+
+TEST(CMSISMat, choleskyDecompose_fails_on_indefinite_matrix)
+{
+    CMSISMat<2, 2> a({1, 2, 2, 1});
+
+    EXPECT_FALSE(choleskyDecompose(a, a));
+}
+
+TEST(CMSISMat, choleskySolve_matches_multiplying_by_inverse)
+{
+    CMSISMat<2, 2> a({4, 2, 2, 3});
+    CMSISMat<3, 2> b({1, 2, 3, 4, 5, 6});
+    // arm_mat_inverse_f32 overwrites its source, so invert a copy
+    CMSISMat<2, 2> aCopy(a);
+    CMSISMat<3, 2> expected = b * aCopy.inverse();
+
+    ASSERT_TRUE(choleskyDecompose(a, a));
+    choleskySolve(a, b, b);
+
+    for (size_t i = 0; i < b.data.size(); i++)
+    {
+        EXPECT_NEAR(expected.data[i], b.data[i], 1E-5);
+    }
+}
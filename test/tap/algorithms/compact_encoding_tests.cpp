@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/compact_encoding.hpp"
+
+using namespace tap::algorithms;
+
+TEST(CompactEncoding, zigZag_maps_small_magnitudes_to_small_values)
+{
+    EXPECT_EQ(0u, encodeZigZag(0));
+    EXPECT_EQ(1u, encodeZigZag(-1));
+    EXPECT_EQ(2u, encodeZigZag(1));
+    EXPECT_EQ(3u, encodeZigZag(-2));
+    EXPECT_EQ(UINT32_MAX, encodeZigZag(INT32_MIN));
+    for (int32_t value : {0, 1, -1, 1000, -1000, INT32_MAX, INT32_MIN})
+    {
+        EXPECT_EQ(value, decodeZigZag(encodeZigZag(value)));
+    }
+}
+
+TEST(CompactEncoding, varint_round_trips_with_expected_length)
+{
+    const std::pair<uint32_t, uint32_t> cases[] = {
+        {0, 1},
+        {127, 1},
+        {128, 2},
+        {16'383, 2},
+        {16'384, 3},
+        {UINT32_MAX, 5},
+    };
+    for (auto [value, expectedLength] : cases)
+    {
+        uint8_t buffer[MAX_VARINT_LENGTH];
+        EXPECT_EQ(expectedLength, encodeVarint(value, buffer, sizeof(buffer))) << value;
+
+        uint32_t decoded = 0;
+        EXPECT_EQ(expectedLength, decodeVarint(buffer, sizeof(buffer), &decoded));
+        EXPECT_EQ(value, decoded);
+    }
+}
+
+TEST(CompactEncoding, encodeVarint_fails_when_buffer_too_small)
+{
+    uint8_t buffer[2];
+    EXPECT_EQ(0u, encodeVarint(16'384, buffer, sizeof(buffer)));
+    EXPECT_EQ(0u, encodeVarint(0, buffer, 0));
+}
+
+TEST(CompactEncoding, decodeVarint_rejects_truncated_and_overlong_input)
+{
+    const uint8_t truncated[] = {0x80, 0x80};
+    const uint8_t overlong[] = {0xff, 0xff, 0xff, 0xff, 0x1f};
+    const uint8_t tooManyBytes[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x00};
+    uint32_t value;
+
+    EXPECT_EQ(0u, decodeVarint(truncated, sizeof(truncated), &value));
+    EXPECT_EQ(0u, decodeVarint(overlong, sizeof(overlong), &value));
+    EXPECT_EQ(0u, decodeVarint(tooManyBytes, sizeof(tooManyBytes), &value));
+}
+
+TEST(CompactEncoding, deltas_round_trip_and_small_changes_take_one_byte)
+{
+    const int32_t previous[] = {8191, -3000, 100, INT32_MAX};
+    const int32_t values[] = {8185, -2990, 100, INT32_MIN};
+    uint8_t buffer[4 * MAX_VARINT_LENGTH];
+
+    const uint32_t length = encodeDeltas(values, previous, 4, buffer, sizeof(buffer));
+
+    // The wrapped difference from INT32_MAX to INT32_MIN is 1
+    EXPECT_EQ(4u, length);
+    int32_t decoded[4];
+    EXPECT_EQ(length, decodeDeltas(buffer, length, previous, decoded, 4));
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(values[i], decoded[i]);
+    }
+}
+
+TEST(CompactEncoding, deltas_fail_when_buffer_too_small_or_truncated)
+{
+    const int32_t previous[] = {0, 0};
+    const int32_t values[] = {1, 100'000};
+    uint8_t buffer[3];
+
+    EXPECT_EQ(0u, encodeDeltas(values, previous, 2, buffer, sizeof(buffer)));
+
+    uint8_t encoded[2 * MAX_VARINT_LENGTH];
+    const uint32_t length = encodeDeltas(values, previous, 2, encoded, sizeof(encoded));
+    int32_t decoded[2];
+    EXPECT_EQ(0u, decodeDeltas(encoded, length - 1, previous, decoded, 2));
+}
+
+TEST(CompactEncoding, bits_round_trip_packed_without_padding)
+{
+    uint8_t buffer[8] = {};
+    BitWriter writer(buffer, sizeof(buffer));
+
+    EXPECT_TRUE(writer.write(0b101, 3));
+    EXPECT_TRUE(writer.write(0x3ff, 10));
+    EXPECT_TRUE(writer.write(0xdeadbeef, 32));
+    EXPECT_TRUE(writer.write(1, 1));
+    EXPECT_EQ(46u, writer.getBitsWritten());
+    EXPECT_EQ(6u, writer.finish());
+    EXPECT_EQ(0b11111101, buffer[0]);
+
+    BitReader reader(buffer, 6);
+    uint32_t value;
+    EXPECT_TRUE(reader.read(3, &value));
+    EXPECT_EQ(0b101u, value);
+    EXPECT_TRUE(reader.read(10, &value));
+    EXPECT_EQ(0x3ffu, value);
+    EXPECT_TRUE(reader.read(32, &value));
+    EXPECT_EQ(0xdeadbeefu, value);
+    EXPECT_TRUE(reader.read(1, &value));
+    EXPECT_EQ(1u, value);
+    EXPECT_EQ(2u, reader.getBitsRemaining());
+    EXPECT_FALSE(reader.read(3, &value));
+}
+
+TEST(CompactEncoding, BitWriter_write_ignores_high_bits_and_fails_when_full)
+{
+    uint8_t buffer[1] = {};
+    BitWriter writer(buffer, sizeof(buffer));
+
+    EXPECT_TRUE(writer.write(0xff, 4));
+    EXPECT_FALSE(writer.write(0, 5));
+    EXPECT_TRUE(writer.write(0, 4));
+    EXPECT_EQ(1u, writer.finish());
+    EXPECT_EQ(0x0f, buffer[0]);
+}
+
+TEST(CompactEncoding, Lz4BlockCompressor_compresses_run_in_lz4_block_format)
+{
+    static Lz4BlockCompressor compressor;
+    const std::vector<uint8_t> input(20, 'a');
+    uint8_t out[Lz4BlockCompressor::getMaxCompressedLength(20)];
+
+    const uint32_t length = compressor.compress(input.data(), input.size(), out, sizeof(out));
+
+    // One literal and a 14 byte match 1 byte back, then the last 5 bytes as literals
+    const std::vector<uint8_t> expected =
+        {0x1a, 'a', 0x01, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    EXPECT_EQ(expected, std::vector<uint8_t>(out, out + length));
+}
+
+TEST(CompactEncoding, Lz4Block_round_trips_random_and_repetitive_data)
+{
+    static Lz4BlockCompressor compressor;
+    std::mt19937 rng(0);
+    for (uint32_t length : {0u, 1u, 12u, 13u, 100u, 300u, 5'000u})
+    {
+        for (int alphabet : {2, 256})
+        {
+            std::vector<uint8_t> input(length);
+            for (uint8_t &byte : input)
+            {
+                byte = rng() % alphabet;
+            }
+            std::vector<uint8_t> compressed(Lz4BlockCompressor::getMaxCompressedLength(length));
+            std::vector<uint8_t> output(length);
+
+            const uint32_t compressedLength = compressor.compress(
+                input.data(),
+                length,
+                compressed.data(),
+                compressed.size());
+            ASSERT_GT(compressedLength, 0u) << length;
+
+            uint32_t outputLength = 0;
+            ASSERT_TRUE(decompressLz4Block(
+                compressed.data(),
+                compressedLength,
+                output.data(),
+                output.size(),
+                &outputLength));
+            EXPECT_EQ(length, outputLength);
+            EXPECT_EQ(input, output) << length << " " << alphabet;
+        }
+    }
+}
+
+TEST(CompactEncoding, Lz4BlockCompressor_compresses_repeated_records)
+{
+    static Lz4BlockCompressor compressor;
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 100; i++)
+    {
+        // A counter that changes every 10 records
+        const uint8_t counter = i / 10;
+        const uint8_t record[] = {0x55, 0x01, 0x02, 0x03, 0x10, 0x20, 0x30, counter};
+        input.insert(input.end(), record, record + sizeof(record));
+    }
+    std::vector<uint8_t> compressed(Lz4BlockCompressor::getMaxCompressedLength(input.size()));
+
+    const uint32_t length =
+        compressor.compress(input.data(), input.size(), compressed.data(), compressed.size());
+
+    EXPECT_GT(length, 0u);
+    EXPECT_LT(length, input.size() / 4);
+}
+
+TEST(CompactEncoding, Lz4BlockCompressor_fails_when_output_too_small)
+{
+    static Lz4BlockCompressor compressor;
+    uint8_t input[64];
+    for (uint32_t i = 0; i < sizeof(input); i++)
+    {
+        input[i] = i * 37;
+    }
+    uint8_t out[32];
+
+    EXPECT_EQ(0u, compressor.compress(input, sizeof(input), out, sizeof(out)));
+}
+
+TEST(CompactEncoding, decompressLz4Block_rejects_malformed_blocks)
+{
+    uint8_t out[64];
+    uint32_t length;
+
+    // Match offset before the start of the output
+    const uint8_t badOffset[] = {0x10, 'a', 0x02, 0x00, 0x00};
+    EXPECT_FALSE(decompressLz4Block(badOffset, sizeof(badOffset), out, sizeof(out), &length));
+
+    // Literal length longer than the input
+    const uint8_t truncated[] = {0x50, 'a', 'a'};
+    EXPECT_FALSE(decompressLz4Block(truncated, sizeof(truncated), out, sizeof(out), &length));
+
+    // Decompressed block larger than the output
+    const uint8_t run[] = {0x1a, 'a', 0x01, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    EXPECT_FALSE(decompressLz4Block(run, sizeof(run), out, 19, &length));
+    EXPECT_TRUE(decompressLz4Block(run, sizeof(run), out, 20, &length));
+    EXPECT_EQ(20u, length);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/crc.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr uint8_t CHECK_MESSAGE[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+TEST(CRC, calculateCRC8_check_value)
+{
+    EXPECT_EQ(0x0b, calculateCRC8(CHECK_MESSAGE, sizeof(CHECK_MESSAGE)));
+}
+
+TEST(CRC, calculateCRC16_check_value)
+{
+    EXPECT_EQ(0x6f91, calculateCRC16Bytewise(CHECK_MESSAGE, sizeof(CHECK_MESSAGE)));
+    EXPECT_EQ(0x6f91, calculateCRC16Sliced<4>(CHECK_MESSAGE, sizeof(CHECK_MESSAGE)));
+    EXPECT_EQ(0x6f91, calculateCRC16Sliced<8>(CHECK_MESSAGE, sizeof(CHECK_MESSAGE)));
+    EXPECT_EQ(0x6f91, calculateCRC16(CHECK_MESSAGE, sizeof(CHECK_MESSAGE)));
+}
+
+TEST(CRC, calculateCRC16_nullptr_returns_init)
+{
+    EXPECT_EQ(0x1234, calculateCRC16Bytewise(nullptr, 10, 0x1234));
+    EXPECT_EQ(0x1234, calculateCRC16Sliced<4>(nullptr, 10, 0x1234));
+    EXPECT_EQ(0x1234, calculateCRC16Sliced<8>(nullptr, 10, 0x1234));
+    EXPECT_EQ(0x1234, calculateCRC16(nullptr, 10, 0x1234));
+}
+
+TEST(CRC, calculateCRC16_sliced_matches_bytewise_for_all_lengths_and_alignments)
+{
+    std::mt19937 rng(0);
+    uint8_t message[300];
+    for (uint8_t &byte : message)
+    {
+        byte = rng();
+    }
+
+    for (uint32_t offset = 0; offset < 8; offset++)
+    {
+        for (uint32_t length = 0; length <= sizeof(message) - offset; length++)
+        {
+            const uint16_t init = rng();
+            const uint16_t expected = calculateCRC16Bytewise(message + offset, length, init);
+
+            ASSERT_EQ(expected, calculateCRC16Sliced<4>(message + offset, length, init))
+                << "offset " << offset << ", length " << length;
+            ASSERT_EQ(expected, calculateCRC16Sliced<8>(message + offset, length, init))
+                << "offset " << offset << ", length " << length;
+            ASSERT_EQ(expected, calculateCRC16(message + offset, length, init))
+                << "offset " << offset << ", length " << length;
+        }
+    }
+}
+
+TEST(CRC, calculateCRC16_sliced_can_be_continued)
+{
+    uint8_t message[100];
+    for (int i = 0; i < 100; i++)
+    {
+        message[i] = i * 7;
+    }
+
+    const uint16_t whole = calculateCRC16Bytewise(message, sizeof(message));
+    const uint16_t firstPart = calculateCRC16Sliced<8>(message, 37);
+
+    EXPECT_EQ(whole, calculateCRC16Sliced<8>(message + 37, sizeof(message) - 37, firstPart));
+}
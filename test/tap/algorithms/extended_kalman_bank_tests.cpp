@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/extended_kalman.hpp"
+#include "tap/algorithms/extended_kalman_bank.hpp"
+
+using namespace tap::algorithms;
+
+TEST(ExtendedKalmanBank, matches_individual_filters)
+{
+    ExtendedKalmanBank<3> bank(1.0f, 2.0f);
+    bank.setCovariances(1, 0.1f, 5.0f);
+    bank.setCovariances(2, 3.0f, 0.5f);
+    ExtendedKalman filters[] = {{1.0f, 2.0f}, {0.1f, 5.0f}, {3.0f, 0.5f}};
+
+    for (int t = 0; t < 50; t++)
+    {
+        const float data[] = {t * 1.0f, 10.0f - t, (t % 5) * 2.0f};
+        bank.filterData(data);
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_FLOAT_EQ(filters[i].filterData(data[i]), bank.getLastFiltered(i));
+        }
+    }
+}
+
+TEST(ExtendedKalmanBank, reset_clears_every_channel)
+{
+    ExtendedKalmanBank<2> bank(1.0f, 1.0f);
+    bank.filterData({5, 6});
+
+    bank.reset();
+
+    EXPECT_FLOAT_EQ(0, bank.getLastFiltered()[0]);
+    EXPECT_FLOAT_EQ(0, bank.getLastFiltered()[1]);
+}
+
+TEST(ExtendedKalmanBank, setCovariances_out_of_range_ignored)
+{
+    ExtendedKalmanBank<1> bank(1.0f, 1.0f);
+    bank.setCovariances(1, 100.0f, 0.0f);
+    bank.setCovariances(-1, 100.0f, 0.0f);
+    ExtendedKalman filter(1.0f, 1.0f);
+
+    bank.filterData({4});
+
+    EXPECT_FLOAT_EQ(filter.filterData(4), bank.getLastFiltered(0));
+}
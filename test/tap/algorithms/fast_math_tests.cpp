@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/fast_math.hpp"
+
+namespace fastmath = tap::algorithms::fastmath;
+
+static constexpr int SAMPLES = 200'001;
+
+/// @return The largest absolute difference between `f` and `reference` over [min, max].
+template <typename F, typename R>
+static double maxError(F f, R reference, float min, float max)
+{
+    double error = 0;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        const float x = min + (max - min) * i / (SAMPLES - 1);
+        error = std::max(error, std::abs(f(x) - reference(static_cast<double>(x))));
+    }
+    return error;
+}
+
+static double sinReference(double x) { return std::sin(x); }
+static double cosReference(double x) { return std::cos(x); }
+
+TEST(FastMath, sincos_within_error_bound)
+{
+    for (float range : {4.0f, 1e4f})
+    {
+        EXPECT_LE(maxError(fastmath::sin, sinReference, -range, range), 1e-7) << range;
+        EXPECT_LE(maxError(fastmath::cos, cosReference, -range, range), 1e-7) << range;
+    }
+}
+
+TEST(FastMath, sincos_matches_sin_and_cos)
+{
+    for (float x : {-7.0f, -1.0f, 0.0f, 0.5f, 2.0f, 3.0f, 100.0f})
+    {
+        fastmath::SinCos sc = fastmath::sincos(x);
+        EXPECT_EQ(fastmath::sin(x), sc.sin);
+        EXPECT_EQ(fastmath::cos(x), sc.cos);
+    }
+}
+
+TEST(FastMath, sincos_exact_at_quadrant_boundaries)
+{
+    EXPECT_EQ(0, fastmath::sin(0));
+    EXPECT_EQ(1, fastmath::cos(0));
+    EXPECT_NEAR(1, fastmath::sin(fastmath::HALF_PI), 1e-7);
+    EXPECT_NEAR(-1, fastmath::cos(fastmath::PI), 1e-7);
+}
+
+TEST(FastMath, table_within_error_bound)
+{
+    EXPECT_LE(maxError(fastmath::sinTable, sinReference, -100, 100), 8e-5);
+    EXPECT_LE(maxError(fastmath::cosTable, cosReference, -100, 100), 8e-5);
+}
+
+TEST(FastMath, atan2_within_error_bound)
+{
+    double error = 0;
+    for (int i = 0; i < 1'000; i++)
+    {
+        for (int j = 0; j < 1'000; j++)
+        {
+            const float y = -10 + 20.0f * i / 999;
+            const float x = -10 + 20.0f * j / 999;
+            const double reference = std::atan2(static_cast<double>(y), static_cast<double>(x));
+            error = std::max(error, std::abs(fastmath::atan2(y, x) - reference));
+        }
+    }
+    EXPECT_LE(error, 1.2e-5);
+}
+
+TEST(FastMath, atan2_axes_and_origin)
+{
+    EXPECT_EQ(0, fastmath::atan2(0, 0));
+    EXPECT_EQ(0, fastmath::atan2(0, 1));
+    EXPECT_NEAR(fastmath::PI, fastmath::atan2(0, -1), 1e-6);
+    EXPECT_NEAR(fastmath::HALF_PI, fastmath::atan2(1, 0), 1e-6);
+    EXPECT_NEAR(-fastmath::HALF_PI, fastmath::atan2(-1, 0), 1e-6);
+    EXPECT_NEAR(-3 * fastmath::PI / 4, fastmath::atan2(-2, -2), 1.2e-5);
+}
+
+TEST(FastMath, asin_within_error_bound_and_clamped)
+{
+    EXPECT_LE(maxError(fastmath::asin, [](double x) { return std::asin(x); }, -1, 1), 4e-7);
+    EXPECT_NEAR(fastmath::HALF_PI, fastmath::asin(1.5f), 1e-6);
+    EXPECT_NEAR(-fastmath::HALF_PI, fastmath::asin(-1.5f), 1e-6);
+}
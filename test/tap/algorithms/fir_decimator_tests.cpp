@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/fir_decimator.hpp"
+
+using namespace tap::algorithms;
+
+TEST(FirDecimator, configureCic_first_order_averages_each_block)
+{
+    FirDecimator<1> decimator;
+    ASSERT_TRUE(decimator.configureCic(4, 1));
+
+    EXPECT_FALSE(decimator.update({1}));
+    EXPECT_FALSE(decimator.update({2}));
+    EXPECT_FALSE(decimator.update({3}));
+    EXPECT_TRUE(decimator.update({6}));
+    EXPECT_FLOAT_EQ(3, decimator.getOutput(0));
+
+    EXPECT_FALSE(decimator.update({10}));
+    EXPECT_FALSE(decimator.update({10}));
+    EXPECT_FALSE(decimator.update({-10}));
+    EXPECT_TRUE(decimator.update({-10}));
+    EXPECT_FLOAT_EQ(0, decimator.getOutput(0));
+}
+
+TEST(FirDecimator, configureCic_second_order_has_triangular_taps)
+{
+    FirDecimator<1> decimator;
+    ASSERT_TRUE(decimator.configureCic(3, 2));
+
+    ASSERT_EQ(5, decimator.getNumTaps());
+    const float expected[] = {1, 2, 3, 2, 1};
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_FLOAT_EQ(expected[i] / 9, decimator.getTap(i));
+    }
+}
+
+TEST(FirDecimator, configureCic_fails_if_too_many_taps)
+{
+    FirDecimator<1, 8> decimator;
+
+    EXPECT_FALSE(decimator.configureCic(5, 2));
+    EXPECT_FALSE(decimator.configureCic(0, 1));
+    EXPECT_TRUE(decimator.configureCic(8, 1));
+    EXPECT_EQ(8, decimator.getDecimationFactor());
+}
+
+TEST(FirDecimator, constant_input_passes_through_at_all_orders)
+{
+    for (uint8_t order = 1; order <= 3; order++)
+    {
+        FirDecimator<2> decimator;
+        ASSERT_TRUE(decimator.configureCic(4, order));
+
+        for (int i = 0; i < 16; i++)
+        {
+            if (decimator.update({5, -2}))
+            {
+                EXPECT_NEAR(5, decimator.getOutput(0), 1E-5);
+                EXPECT_NEAR(-2, decimator.getOutput(1), 1E-5);
+            }
+        }
+    }
+}
+
+TEST(FirDecimator, third_order_cic_attenuates_frequency_that_aliases_to_dc)
+{
+    FirDecimator<1> first;
+    FirDecimator<1> third;
+    first.configureCic(4, 1);
+    third.configureCic(4, 3);
+
+    // A sine slightly off the output rate, which would alias to a slow wobble in the output.
+    float maxFirst = 0;
+    float maxThird = 0;
+    for (int i = 0; i < 400; i++)
+    {
+        float sample = sinf(2 * M_PI * i * 0.26f);
+        if (first.update({sample}) && i > 40)
+        {
+            maxFirst = std::max(maxFirst, fabsf(first.getOutput(0)));
+        }
+        if (third.update({sample}) && i > 40)
+        {
+            maxThird = std::max(maxThird, fabsf(third.getOutput(0)));
+        }
+    }
+
+    EXPECT_LT(maxThird, maxFirst);
+    EXPECT_LT(maxThird, 0.01f);
+}
+
+TEST(FirDecimator, configure_custom_taps)
+{
+    FirDecimator<1> decimator;
+    const float taps[] = {0.5f, 0.5f};
+    ASSERT_TRUE(decimator.configure(2, taps, 2));
+
+    decimator.update({2});
+    EXPECT_TRUE(decimator.update({4}));
+    EXPECT_FLOAT_EQ(3, decimator.getOutput(0));
+}
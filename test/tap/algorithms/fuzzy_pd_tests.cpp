@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/fuzzy_pd.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr float MAX_ERROR = 4.0f;
+static constexpr float MAX_ERROR_DERIVATIVE = 20.0f;
+
+static FuzzyPDConfig makeConfig(bool precomputeGainSurface)
+{
+    FuzzyPDConfig config;
+    config.maxError = MAX_ERROR;
+    config.maxErrorDerivative = MAX_ERROR_DERIVATIVE;
+    config.fuzzyTable = FuzzyPDRuleTable({10, 20, 40}, {0.5f, 1, 3});
+    config.precomputeGainSurface = precomputeGainSurface;
+    return config;
+}
+
+static SmoothPidConfig makePidConfig()
+{
+    SmoothPidConfig config;
+    config.maxOutput = 1000;
+    return config;
+}
+
+TEST(FuzzyPD, exact_gains_come_from_rule_table)
+{
+    FuzzyPDConfig config = makeConfig(false);
+    FuzzyPD pd(config, makePidConfig());
+
+    pd.runController(1, -5, 0.001f);
+
+    modm::Matrix<float, 2, 1> gains = config.fuzzyTable.performFuzzyUpdate(0.25f, -0.25f);
+    EXPECT_FLOAT_EQ(gains[0][0], pd.getP());
+    EXPECT_FLOAT_EQ(gains[1][0], pd.getD());
+}
+
+TEST(FuzzyPD, precomputed_gains_exact_at_grid_points)
+{
+    FuzzyPD exact(makeConfig(false), makePidConfig());
+    FuzzyPD precomputed(makeConfig(true), makePidConfig());
+
+    for (size_t i = 0; i < FuzzyPD::GAIN_SURFACE_SIZE; i++)
+    {
+        for (size_t j = 0; j < FuzzyPD::GAIN_SURFACE_SIZE; j++)
+        {
+            const float e = MAX_ERROR * (-1.0f + 2.0f * i / (FuzzyPD::GAIN_SURFACE_SIZE - 1));
+            const float d =
+                MAX_ERROR_DERIVATIVE * (-1.0f + 2.0f * j / (FuzzyPD::GAIN_SURFACE_SIZE - 1));
+            exact.runController(e, d, 0.001f);
+            precomputed.runController(e, d, 0.001f);
+
+            EXPECT_NEAR(exact.getP(), precomputed.getP(), 1e-4f) << e << ", " << d;
+            EXPECT_NEAR(exact.getD(), precomputed.getD(), 1e-5f) << e << ", " << d;
+        }
+    }
+}
+
+TEST(FuzzyPD, precomputed_gains_within_error_bound)
+{
+    FuzzyPD exact(makeConfig(false), makePidConfig());
+    FuzzyPD precomputed(makeConfig(true), makePidConfig());
+
+    // See FuzzyPDConfig::precomputeGainSurface, bounds are relative to the parameter ranges
+    const float kpBound = (40 - 10) / 16.0f;
+    const float kdBound = (3 - 0.5f) / 16.0f;
+
+    // Sample between grid points, including past the normalization limits
+    static constexpr int SAMPLES = 301;
+    float maxKpError = 0;
+    float maxKdError = 0;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        for (int j = 0; j < SAMPLES; j++)
+        {
+            const float e = 1.1f * MAX_ERROR * (-1.0f + 2.0f * i / (SAMPLES - 1));
+            const float d = 1.1f * MAX_ERROR_DERIVATIVE * (-1.0f + 2.0f * j / (SAMPLES - 1));
+            exact.runController(e, d, 0.001f);
+            precomputed.runController(e, d, 0.001f);
+
+            maxKpError = std::max(maxKpError, fabsf(exact.getP() - precomputed.getP()));
+            maxKdError = std::max(maxKdError, fabsf(exact.getD() - precomputed.getD()));
+        }
+    }
+
+    EXPECT_LE(maxKpError, kpBound);
+    EXPECT_LE(maxKdError, kdBound);
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/gyro_bias_estimator.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr float G = 9.80665f;
+static const float LEVEL[3] = {0, 0, G};
+
+/// Feeds `windows` full windows of a constant gyroscope reading, returns the last update result.
+static bool feed(
+    GyroBiasEstimator &estimator,
+    const float (&gyro)[3],
+    float temperature,
+    int windows = 1)
+{
+    bool updated = false;
+    for (int i = 0; i < windows * GyroBiasEstimator::Config().windowSamples; i++)
+    {
+        updated = estimator.update(gyro, LEVEL, temperature);
+    }
+    return updated;
+}
+
+TEST(GyroBiasEstimator, no_calibration_before_first_window)
+{
+    GyroBiasEstimator estimator;
+
+    EXPECT_FALSE(estimator.hasCalibration());
+    EXPECT_FALSE(estimator.update({0.1f, 0, 0}, LEVEL, 40));
+    EXPECT_FALSE(estimator.hasCalibration());
+}
+
+TEST(GyroBiasEstimator, stationary_window_measures_bias)
+{
+    GyroBiasEstimator estimator;
+
+    EXPECT_TRUE(feed(estimator, {0.1f, -0.2f, 0.3f}, 40));
+
+    EXPECT_TRUE(estimator.hasCalibration());
+    EXPECT_TRUE(estimator.isStationary());
+    EXPECT_EQ(1u, estimator.getNumUpdates());
+    float bias[3];
+    estimator.getBias(40, bias);
+    EXPECT_NEAR(0.1f, bias[0], 1E-5);
+    EXPECT_NEAR(-0.2f, bias[1], 1E-5);
+    EXPECT_NEAR(0.3f, bias[2], 1E-5);
+}
+
+TEST(GyroBiasEstimator, moving_window_rejected)
+{
+    GyroBiasEstimator estimator;
+
+    bool updated = false;
+    for (int i = 0; i < GyroBiasEstimator::Config().windowSamples; i++)
+    {
+        const float gyro[3] = {0, 0, 20.0f * sinf(i * 0.1f)};
+        updated = estimator.update(gyro, LEVEL, 40);
+    }
+
+    EXPECT_FALSE(updated);
+    EXPECT_FALSE(estimator.isStationary());
+    EXPECT_FALSE(estimator.hasCalibration());
+}
+
+TEST(GyroBiasEstimator, vibrating_window_rejected)
+{
+    GyroBiasEstimator estimator;
+
+    bool updated = false;
+    for (int i = 0; i < GyroBiasEstimator::Config().windowSamples; i++)
+    {
+        const float acc[3] = {0, 0, G + ((i % 2) ? 1.0f : -1.0f)};
+        updated = estimator.update({0.1f, 0, 0}, acc, 40);
+    }
+
+    EXPECT_FALSE(updated);
+    EXPECT_FALSE(estimator.hasCalibration());
+}
+
+TEST(GyroBiasEstimator, constant_spin_rejected)
+{
+    GyroBiasEstimator estimator;
+
+    EXPECT_FALSE(feed(estimator, {0, 0, 90}, 40));
+
+    EXPECT_FALSE(estimator.hasCalibration());
+}
+
+TEST(GyroBiasEstimator, slow_spin_differing_from_estimate_rejected)
+{
+    GyroBiasEstimator estimator;
+    feed(estimator, {0, 0, 0.1f}, 40);
+
+    EXPECT_FALSE(feed(estimator, {0, 0, 1.0f}, 40, 5));
+
+    float bias[3];
+    estimator.getBias(40, bias);
+    EXPECT_NEAR(0.1f, bias[2], 1E-5);
+}
+
+TEST(GyroBiasEstimator, relearns_after_consistently_differing_windows)
+{
+    GyroBiasEstimator estimator;
+    feed(estimator, {0, 0, 0.1f}, 40);
+
+    feed(estimator, {0, 0, 1.0f}, 40, GyroBiasEstimator::Config().windowsBeforeRelearning);
+
+    float bias[3];
+    estimator.getBias(40, bias);
+    EXPECT_NEAR(1.0f, bias[2], 1E-5);
+}
+
+TEST(GyroBiasEstimator, fits_temperature_coefficient)
+{
+    GyroBiasEstimator estimator;
+
+    // Bias of 0.1 deg/s at 30 C rising by 0.02 deg/s/C, as the IMU heats up.
+    for (float temperature = 30; temperature <= 40; temperature += 0.5f)
+    {
+        feed(estimator, {0, 0, 0.1f + 0.02f * (temperature - 30)}, temperature);
+    }
+
+    EXPECT_NEAR(0.02f, estimator.getCalibration().temperatureCoefficient[2], 1E-4);
+    float bias[3];
+    estimator.getBias(45, bias);
+    EXPECT_NEAR(0.4f, bias[2], 1E-3);
+}
+
+TEST(GyroBiasEstimator, no_temperature_coefficient_without_temperature_spread)
+{
+    GyroBiasEstimator estimator;
+
+    feed(estimator, {0, 0, 0.1f}, 40, 5);
+    feed(estimator, {0, 0, 0.12f}, 40.5f, 5);
+
+    EXPECT_EQ(0, estimator.getCalibration().temperatureCoefficient[2]);
+}
+
+TEST(GyroBiasEstimator, calibration_sealed_and_corruption_detected)
+{
+    GyroBiasEstimator estimator;
+    feed(estimator, {0.1f, -0.2f, 0.3f}, 40);
+
+    GyroCalibration calibration = estimator.getCalibration();
+    EXPECT_TRUE(calibration.isValid());
+
+    calibration.bias[1] = 0.2f;
+    EXPECT_FALSE(calibration.isValid());
+
+    calibration.seal();
+    EXPECT_TRUE(calibration.isValid());
+
+    calibration.version++;
+    calibration.seal();
+    EXPECT_FALSE(calibration.isValid());
+}
+
+TEST(GyroBiasEstimator, setCalibration_restores_bias_and_coefficients)
+{
+    GyroCalibration calibration;
+    calibration.bias[2] = 0.3f;
+    calibration.referenceTemperature = 40;
+    calibration.temperatureCoefficient[2] = 0.01f;
+    calibration.seal();
+
+    GyroBiasEstimator estimator;
+    estimator.setCalibration(calibration);
+
+    EXPECT_TRUE(estimator.hasCalibration());
+    EXPECT_EQ(0u, estimator.getNumUpdates());
+    float bias[3];
+    estimator.getBias(50, bias);
+    EXPECT_NEAR(0.4f, bias[2], 1E-5);
+
+    // Measurements refine the restored fit rather than replace it.
+    EXPECT_TRUE(feed(estimator, {0, 0, 0.5f}, 40));
+    EXPECT_NEAR(0.4f, estimator.getCalibration().bias[2], 1E-5);
+    EXPECT_EQ(0.01f, estimator.getCalibration().temperatureCoefficient[2]);
+}
+
+TEST(GyroBiasEstimator, table_interpolates_nonlinear_warm_up)
+{
+    GyroBiasEstimator estimator;
+
+    // Bias that rises quickly and then flattens as the IMU warms from 25 to 50 C.
+    auto warmUpBias = [](float temperature) { return 0.5f - 0.4f * expf(-(temperature - 25) / 5); };
+    for (float temperature = 25; temperature <= 50; temperature += 0.25f)
+    {
+        feed(estimator, {0, 0, warmUpBias(temperature)}, temperature);
+    }
+
+    const GyroCalibration &calibration = estimator.getCalibration();
+    for (float temperature = 26; temperature <= 49; temperature += 1.5f)
+    {
+        float bias[3];
+        calibration.getBias(temperature, bias);
+        EXPECT_NEAR(warmUpBias(temperature), bias[2], 0.02f) << temperature;
+    }
+}
+
+TEST(GyroBiasEstimator, table_extrapolates_with_fit_slope)
+{
+    GyroCalibration calibration;
+    calibration.temperatureCoefficient[2] = 0.01f;
+    calibration.tableValid = 1u << GyroCalibration::getTableBin(40);
+    calibration.tableTemperature[GyroCalibration::getTableBin(40)] = 40;
+    calibration.tableBias[GyroCalibration::getTableBin(40)][2] = 0.3f;
+
+    float bias[3];
+    calibration.getBias(50, bias);
+    EXPECT_NEAR(0.4f, bias[2], 1E-5);
+    calibration.getBias(30, bias);
+    EXPECT_NEAR(0.2f, bias[2], 1E-5);
+}
+
+TEST(GyroBiasEstimator, table_bins_outside_range)
+{
+    EXPECT_EQ(-1, GyroCalibration::getTableBin(GyroCalibration::TABLE_MIN_TEMPERATURE - 1));
+    EXPECT_EQ(0, GyroCalibration::getTableBin(GyroCalibration::TABLE_MIN_TEMPERATURE));
+    EXPECT_EQ(
+        -1,
+        GyroCalibration::getTableBin(
+            GyroCalibration::TABLE_MIN_TEMPERATURE +
+            GyroCalibration::TABLE_SIZE * GyroCalibration::TABLE_BIN_WIDTH));
+}
+
+TEST(GyroBiasEstimator, setBias_replaces_table_entry)
+{
+    GyroBiasEstimator estimator;
+    feed(estimator, {0, 0, 0.1f}, 40);
+
+    estimator.setBias({0, 0, 0.2f}, 40);
+
+    float bias[3];
+    estimator.getBias(40, bias);
+    EXPECT_NEAR(0.2f, bias[2], 1E-5);
+    EXPECT_TRUE(estimator.getCalibration().isValid());
+}
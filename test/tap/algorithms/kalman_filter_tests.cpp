@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/kalman_filter.hpp"
+
+using namespace tap::algorithms;
+
+// Constant velocity model, measuring position and velocity
+static constexpr float A[] = {1, 0.01f, 0, 1};
+static constexpr float C[] = {1, 0, 0, 1};
+static constexpr float Q[] = {1E-4f, 0, 0, 1E-3f};
+static constexpr float R[] = {0.5f, 0, 0, 2};
+static constexpr float P0[] = {1, 0, 0, 1};
+
+TEST(KalmanFilter, update_before_init_does_nothing)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+
+    kf.performUpdate(CMSISMat<2, 1>({10, 10}));
+
+    EXPECT_FLOAT_EQ(0, kf.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(0, kf.getStateVectorAsMatrix()[1]);
+}
+
+TEST(KalmanFilter, update_matches_closed_form_gain)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.init({0, 0});
+
+    kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+
+    // The reference gain and covariance, computed with the explicit inverse
+    CMSISMat<2, 2> a(A), c(C), q(Q), r(R), p(P0);
+    CMSISMat<2, 2> predicted = a * p * a.transpose() + q;
+    CMSISMat<2, 2> k = predicted * c.transpose() * (c * predicted * c.transpose() + r).inverse();
+    CMSISMat<2, 1> x = k * CMSISMat<2, 1>({1, 2});
+    CMSISMat<2, 2> identity;
+    identity.constructIdentityMatrix();
+    CMSISMat<2, 2> expectedP = (identity - k * c) * predicted;
+
+    EXPECT_NEAR(x.data[0], kf.getStateVectorAsMatrix()[0], 1E-5);
+    EXPECT_NEAR(x.data[1], kf.getStateVectorAsMatrix()[1], 1E-5);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(expectedP.data[i], kf.getErrorCovariance()[i], 1E-5);
+    }
+}
+
+TEST(KalmanFilter, sequential_update_matches_batch_update_with_diagonal_R)
+{
+    KalmanFilter<2, 2> batch(A, C, Q, R, P0);
+    KalmanFilter<2, 2> sequential(A, C, Q, R, P0);
+    batch.init({0, 0});
+    sequential.init({0, 0});
+
+    for (int i = 0; i < 100; i++)
+    {
+        CMSISMat<2, 1> y({i * 0.01f, 1.0f + (i % 3) * 0.1f});
+        batch.performUpdate(y);
+        sequential.performSequentialUpdate(y);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_NEAR(
+            batch.getStateVectorAsMatrix()[i],
+            sequential.getStateVectorAsMatrix()[i],
+            1E-4);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(batch.getErrorCovariance()[i], sequential.getErrorCovariance()[i], 1E-5);
+    }
+}
+
+/**
+ * Runs a chain of integrators, each state the derivative of the one before, where each
+ * measurement observes one state mixed with the next, and checks that the batch and sequential
+ * updates track the explicit inverse, (I - K * C) * P update they replace.
+ */
+template <uint16_t STATES, uint16_t INPUTS>
+static void expectUpdatesMatchExplicitInverse()
+{
+    float a[STATES * STATES] = {};
+    float c[INPUTS * STATES] = {};
+    float q[STATES * STATES] = {};
+    float r[INPUTS * INPUTS] = {};
+    float p0[STATES * STATES] = {};
+    for (int i = 0; i < STATES; i++)
+    {
+        a[i * STATES + i] = 1;
+        if (i + 1 < STATES)
+        {
+            a[i * STATES + i + 1] = 0.01f;
+        }
+        q[i * STATES + i] = 1E-3f;
+        p0[i * STATES + i] = 1;
+    }
+    for (int m = 0; m < INPUTS; m++)
+    {
+        c[m * STATES + m] = 1;
+        c[m * STATES + (m + 1) % STATES] += 0.5f;
+        r[m * INPUTS + m] = 0.1f * (m + 1);
+    }
+
+    KalmanFilter<STATES, INPUTS> batch(a, c, q, r, p0);
+    KalmanFilter<STATES, INPUTS> sequential(a, c, q, r, p0);
+    const float x0[STATES] = {};
+    batch.init(x0);
+    sequential.init(x0);
+
+    const CMSISMat<STATES, STATES> aMat(a);
+    const CMSISMat<INPUTS, STATES> cMat(c);
+    const CMSISMat<STATES, STATES> qMat(q);
+    const CMSISMat<INPUTS, INPUTS> rMat(r);
+    CMSISMat<STATES, STATES> identity;
+    identity.constructIdentityMatrix();
+    CMSISMat<STATES, STATES> p(p0);
+    CMSISMat<STATES, 1> x;
+
+    for (int i = 0; i < 200; i++)
+    {
+        CMSISMat<INPUTS, 1> y;
+        for (int m = 0; m < INPUTS; m++)
+        {
+            y.data[m] = sinf(0.01f * i + m);
+        }
+        batch.performUpdate(y);
+        sequential.performSequentialUpdate(y);
+
+        x = aMat * x;
+        p = aMat * p * aMat.transpose() + qMat;
+        const CMSISMat<STATES, INPUTS> k =
+            p * cMat.transpose() * (cMat * p * cMat.transpose() + rMat).inverse();
+        x = x + k * (y - cMat * x);
+        p = (identity - k * cMat) * p;
+    }
+
+    for (int i = 0; i < STATES; i++)
+    {
+        EXPECT_NEAR(x.data[i], batch.getStateVectorAsMatrix()[i], 1E-3);
+        EXPECT_NEAR(x.data[i], sequential.getStateVectorAsMatrix()[i], 1E-3);
+    }
+}
+
+TEST(KalmanFilter, updates_match_explicit_inverse_with_fewer_inputs_than_states)
+{
+    expectUpdatesMatchExplicitInverse<9, 3>();
+}
+
+TEST(KalmanFilter, updates_match_explicit_inverse_with_an_input_per_state)
+{
+    expectUpdatesMatchExplicitInverse<6, 6>();
+}
+
+TEST(KalmanFilter, covariance_stays_symmetric)
+{
+    static constexpr float skewedA[] = {1, 0.3f, -0.2f, 0.9f};
+    KalmanFilter<2, 2> kf(skewedA, C, Q, R, P0);
+    kf.init({0, 0});
+
+    for (int i = 0; i < 1000; i++)
+    {
+        kf.performUpdate(CMSISMat<2, 1>({1, -1}));
+    }
+
+    EXPECT_FLOAT_EQ(kf.getErrorCovariance()[1], kf.getErrorCovariance()[2]);
+    EXPECT_GT(kf.getErrorCovariance()[0], 0);
+    EXPECT_GT(kf.getErrorCovariance()[3], 0);
+}
+
+TEST(KalmanFilter, update_with_indefinite_innovation_covariance_only_predicts)
+{
+    static constexpr float negativeR[] = {-10, 0, 0, -10};
+    static constexpr float x0[] = {1, 2};
+    KalmanFilter<2, 2> kf(A, C, Q, negativeR, P0);
+    kf.init(x0);
+
+    kf.performUpdate(CMSISMat<2, 1>({100, 100}));
+
+    EXPECT_FLOAT_EQ(1.02f, kf.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(2, kf.getStateVectorAsMatrix()[1]);
+}
+
+TEST(KalmanFilter, separate_predict_and_correct_match_performUpdate)
+{
+    KalmanFilter<2, 2> combined(A, C, Q, R, P0);
+    KalmanFilter<2, 2> separate(A, C, Q, R, P0);
+    combined.init({0, 0});
+    separate.init({0, 0});
+
+    CMSISMat<2, 1> y({1, 2});
+    combined.performUpdate(y);
+    separate.predict();
+    separate.correct(y);
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_FLOAT_EQ(combined.getErrorCovariance()[i], separate.getErrorCovariance()[i]);
+    }
+    EXPECT_FLOAT_EQ(combined.getStateVectorAsMatrix()[0], separate.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(combined.getStateVectorAsMatrix()[1], separate.getStateVectorAsMatrix()[1]);
+}
+
+TEST(KalmanFilter, predict_without_correct_grows_covariance)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.init({0, 1});
+
+    for (int i = 0; i < 100; i++)
+    {
+        kf.predict();
+    }
+
+    EXPECT_NEAR(1, kf.getStateVectorAsMatrix()[0], 1E-5);
+    EXPECT_FLOAT_EQ(1, kf.getStateVectorAsMatrix()[1]);
+    EXPECT_GT(kf.getErrorCovariance()[0], P0[0]);
+    EXPECT_GT(kf.getErrorCovariance()[3], P0[3]);
+}
+
+/// Constant velocity model for a step of `dt`, with white acceleration noise.
+static void constantVelocityModel(float dt, CMSISMat<2, 2> &a, CMSISMat<2, 2> &q)
+{
+    a.data[1] = dt;
+    q.data[0] = dt * dt * dt / 3;
+    q.data[1] = dt * dt / 2;
+    q.data[2] = dt * dt / 2;
+    q.data[3] = dt;
+}
+
+TEST(KalmanFilter, predict_with_dt_evaluates_model_generator)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.setModelGenerator(constantVelocityModel);
+    kf.init({0, 2});
+
+    kf.predict(0.5f);
+
+    EXPECT_FLOAT_EQ(1, kf.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(2, kf.getStateVectorAsMatrix()[1]);
+    // P = A * P0 * At + Q with P0 = I
+    EXPECT_FLOAT_EQ(1 + 0.25f + 0.125f / 3, kf.getErrorCovariance()[0]);
+    EXPECT_FLOAT_EQ(0.5f + 0.125f, kf.getErrorCovariance()[1]);
+    EXPECT_FLOAT_EQ(1 + 0.5f, kf.getErrorCovariance()[3]);
+
+    kf.predict(0.25f);
+
+    EXPECT_FLOAT_EQ(1.5f, kf.getStateVectorAsMatrix()[0]);
+}
+
+TEST(KalmanFilter, predict_with_control_input)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.setModelGenerator(constantVelocityModel);
+    kf.init({0, 0});
+
+    // Commanded acceleration of 4 over 0.5 s
+    const float dt = 0.5f;
+    CMSISMat<2, 1> B({dt * dt / 2, dt});
+    kf.predict(dt, B, CMSISMat<1, 1>({4}));
+
+    EXPECT_FLOAT_EQ(0.5f, kf.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(2, kf.getStateVectorAsMatrix()[1]);
+}
+
+TEST(KalmanFilter, steady_state_gain_matches_converged_filter)
+{
+    KalmanFilter<2, 2> full(A, C, Q, R, P0);
+    KalmanFilter<2, 2> steady(A, C, Q, R, P0);
+    full.init({0, 0});
+    steady.init({0, 0});
+
+    ASSERT_TRUE(steady.computeSteadyStateGain());
+    EXPECT_TRUE(steady.isSteadyState());
+
+    // The states differ while the full filter's gain converges, then track identically
+    for (int i = 0; i < 2000; i++)
+    {
+        CMSISMat<2, 1> y({i * 0.01f, 1.0f + (i % 3) * 0.1f});
+        full.performUpdate(y);
+        steady.performUpdate(y);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(full.getErrorCovariance()[i], steady.getErrorCovariance()[i], 1E-5);
+    }
+    EXPECT_NEAR(full.getStateVectorAsMatrix()[0], steady.getStateVectorAsMatrix()[0], 1E-3);
+    EXPECT_NEAR(full.getStateVectorAsMatrix()[1], steady.getStateVectorAsMatrix()[1], 1E-3);
+}
+
+TEST(KalmanFilter, steady_state_update_does_not_propagate_covariance)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.init({0, 0});
+    ASSERT_TRUE(kf.computeSteadyStateGain());
+    const std::array<float, 4> P = kf.getErrorCovariance();
+
+    kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+    kf.performSequentialUpdate(CMSISMat<2, 1>({1, 2}));
+
+    EXPECT_EQ(P, kf.getErrorCovariance());
+    EXPECT_GT(kf.getStateVectorAsMatrix()[0], 0);
+}
+
+TEST(KalmanFilter, switches_to_steady_state_once_gain_converges)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.setSteadyStateTolerance(1E-6f);
+    kf.init({0, 0});
+
+    kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+    kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+    EXPECT_FALSE(kf.isSteadyState());
+
+    for (int i = 0; i < 2000 && !kf.isSteadyState(); i++)
+    {
+        kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+    }
+    EXPECT_TRUE(kf.isSteadyState());
+
+    kf.exitSteadyState();
+    const std::array<float, 4> P = kf.getErrorCovariance();
+    kf.getMeasurementCovariance()[0] = 5;
+    kf.performUpdate(CMSISMat<2, 1>({1, 2}));
+    EXPECT_NE(P, kf.getErrorCovariance());
+}
+
+TEST(KalmanFilter, no_steady_state_with_model_generator)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    kf.setModelGenerator(constantVelocityModel);
+    kf.setSteadyStateTolerance(1);
+    kf.init({0, 0});
+
+    EXPECT_FALSE(kf.computeSteadyStateGain());
+    for (int i = 0; i < 10; i++)
+    {
+        kf.predict(0.01f);
+        kf.correct(CMSISMat<2, 1>({1, 2}));
+    }
+    EXPECT_FALSE(kf.isSteadyState());
+}
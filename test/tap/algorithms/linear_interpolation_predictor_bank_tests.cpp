@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/linear_interpolation_predictor.hpp"
+#include "tap/algorithms/linear_interpolation_predictor_bank.hpp"
+#include "tap/algorithms/linear_interpolation_predictor_wrapped.hpp"
+
+using namespace tap::algorithms;
+
+/// A signal that moves fast enough to wrap around [-pi, pi) between updates.
+static float testSignal(int channel, uint32_t time)
+{
+    return 4.0f * sinf(0.01f * time + channel) + 0.05f * time * (channel - 1);
+}
+
+TEST(LinearInterpolationPredictorBank, matches_single_predictors)
+{
+    LinearInterpolationPredictorBank<3> bank;
+    bank.setWrapped(1, -M_PI, M_PI);
+    bank.setWrapped(2, 0, 10);
+    LinearInterpolationPredictor unwrapped;
+    LinearInterpolationPredictorWrapped wrapped[] = {
+        LinearInterpolationPredictorWrapped(-M_PI, M_PI),
+        LinearInterpolationPredictorWrapped(0, 10)};
+    bank.reset(0, 1, 0);
+    unwrapped.reset(1, 0);
+    bank.reset(1, 1, 0);
+    wrapped[0].reset(1, 0);
+    bank.reset(2, 1, 0);
+    wrapped[1].reset(1, 0);
+
+    for (uint32_t time = 1; time < 2'000; time++)
+    {
+        if (time % 20 == 0)
+        {
+            bank.update(0, testSignal(0, time), time);
+            unwrapped.update(testSignal(0, time), time);
+            for (int i = 0; i < 2; i++)
+            {
+                bank.update(i + 1, testSignal(i + 1, time), time);
+                wrapped[i].update(testSignal(i + 1, time), time);
+            }
+        }
+
+        float values[3];
+        bank.getInterpolatedValues(time, values);
+        EXPECT_NEAR(unwrapped.getInterpolatedValue(time), values[0], 1e-4f) << time;
+        for (int i = 0; i < 2; i++)
+        {
+            EXPECT_NEAR(wrapped[i].getInterpolatedValue(time), values[i + 1], 1e-4f) << time;
+            EXPECT_EQ(values[i + 1], bank.getInterpolatedValue(i + 1, time));
+        }
+    }
+}
+
+TEST(LinearInterpolationPredictorBank, wrapped_channel_takes_shortest_way_around)
+{
+    LinearInterpolationPredictorBank<1> bank;
+    bank.setWrapped(0, 0, 10);
+
+    bank.reset(0, 9, 10);
+    bank.update(0, 1, 11);
+
+    EXPECT_NEAR(3, bank.getInterpolatedValue(0, 12), 1e-4f);
+    EXPECT_NEAR(9, bank.getInterpolatedValue(0, 15), 1e-4f);
+}
+
+TEST(LinearInterpolationPredictorBank, extrapolation_limited_to_max_time)
+{
+    LinearInterpolationPredictorBank<2> bank(50);
+    bank.setMaxExtrapolationTime(1, 10);
+
+    for (int i = 0; i < 2; i++)
+    {
+        bank.reset(i, 0, 0);
+        bank.update(i, 10, 10);
+    }
+
+    EXPECT_NEAR(30, bank.getInterpolatedValue(0, 30), 1e-4f);
+    EXPECT_NEAR(60, bank.getInterpolatedValue(0, 60), 1e-4f);
+    EXPECT_NEAR(60, bank.getInterpolatedValue(0, 1'000), 1e-4f);
+    EXPECT_NEAR(20, bank.getInterpolatedValue(1, 30), 1e-4f);
+}
+
+TEST(LinearInterpolationPredictorBank, update_at_earlier_time_zeroes_slope)
+{
+    LinearInterpolationPredictorBank<1> bank;
+    bank.reset(0, 5, 10);
+    bank.update(0, 7, 12);
+
+    bank.update(0, 100, 11);
+
+    EXPECT_NEAR(7, bank.getInterpolatedValue(0, 20), 1e-4f);
+}
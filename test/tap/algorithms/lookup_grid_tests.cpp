@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/lookup_grid.hpp"
+#include "tap/algorithms/math_user_utils.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr LookupGrid1D<float, 5> TORQUE_CURVE(0, 8'000, {3.0f, 2.9f, 2.6f, 2.0f, 1.1f});
+
+// Lookups of a constexpr grid are evaluated at compile time
+static_assert(TORQUE_CURVE.interpolate(2'000) == 2.9f);
+static_assert(TORQUE_CURVE.interpolate(-1) == 3.0f);
+static_assert(TORQUE_CURVE.interpolate(1e9f) == 1.1f);
+
+TEST(LookupGrid1D, interpolate_exact_at_grid_points)
+{
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_FLOAT_EQ(
+            TORQUE_CURVE.getValues()[i],
+            TORQUE_CURVE.interpolate(TORQUE_CURVE.getX(i)));
+    }
+}
+
+TEST(LookupGrid1D, interpolate_linear_between_grid_points)
+{
+    EXPECT_FLOAT_EQ(2.3f, TORQUE_CURVE.interpolate(5'000));
+    EXPECT_FLOAT_EQ(1.325f, TORQUE_CURVE.interpolate(7'500));
+}
+
+TEST(LookupGrid1D, interpolate_clamps_outside_grid)
+{
+    EXPECT_FLOAT_EQ(3.0f, TORQUE_CURVE.interpolate(-100));
+    EXPECT_FLOAT_EQ(1.1f, TORQUE_CURVE.interpolate(10'000));
+    EXPECT_FLOAT_EQ(3.0f, TORQUE_CURVE.interpolate(NAN));
+}
+
+TEST(LookupGrid1D, descending_axis)
+{
+    LookupGrid1D<int, 3> grid(1, -1, {10, 20, 40});
+
+    EXPECT_FLOAT_EQ(10, grid.interpolate(1));
+    EXPECT_FLOAT_EQ(30, grid.interpolate(-0.5f));
+    EXPECT_FLOAT_EQ(40, grid.interpolate(-2));
+}
+
+TEST(LookupGrid2D, interpolate_matches_interpolateLinear2D)
+{
+    std::array<std::array<float, 4>, 3> values = {{
+        {1, 2, 4, 8},
+        {-3, 0, 3, 6},
+        {5, 1, -2, 7},
+    }};
+    LookupGrid2D<float, 3, 4> grid(-1, 3, 10, 40, values);
+
+    for (float x = -2; x <= 4; x += 0.15f)
+    {
+        for (float y = 5; y <= 45; y += 1.3f)
+        {
+            EXPECT_NEAR(
+                interpolateLinear2D(values, -1, 3, 2, 10, 40, 10, x, y),
+                grid.interpolate(x, y),
+                1e-5f)
+                << x << ", " << y;
+        }
+    }
+}
+
+TEST(LookupGrid2D, values_filled_at_runtime)
+{
+    LookupGrid2D<float, 9, 5> grid(-1, 1, 0, 4);
+    for (size_t i = 0; i < 9; i++)
+    {
+        for (size_t j = 0; j < 5; j++)
+        {
+            grid.getValues()[i][j] = 2 * grid.getX(i) + grid.getY(j);
+        }
+    }
+
+    // A bilinear function is reproduced exactly
+    EXPECT_FLOAT_EQ(2 * 0.3f + 1.7f, grid.interpolate(0.3f, 1.7f));
+    EXPECT_FLOAT_EQ(2 * -0.9f + 3.9f, grid.interpolate(-0.9f, 3.9f));
+}
+
+TEST(LookupGrid3D, interpolate_reproduces_trilinear_function)
+{
+    LookupGrid3D<float, 3, 4, 5> grid(0, 2, -3, 3, 10, 20);
+    auto f = [](float x, float y, float z) { return 1 + x - 2 * y + 0.5f * z + x * y * z; };
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            for (size_t k = 0; k < 5; k++)
+            {
+                grid.getValues()[i][j][k] = f(grid.getX(i), grid.getY(j), grid.getZ(k));
+            }
+        }
+    }
+
+    // Within a cell, trilinear interpolation reproduces f exactly
+    EXPECT_NEAR(f(0.25f, -2.5f, 11), grid.interpolate(0.25f, -2.5f, 11), 1e-4f);
+    EXPECT_NEAR(f(1.5f, 0.5f, 17.5f), grid.interpolate(1.5f, 0.5f, 17.5f), 1e-4f);
+    EXPECT_NEAR(f(2, 3, 20), grid.interpolate(5, 4, 30), 1e-4f);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/MahonyAHRS.h"
+
+TEST(Mahony, level_and_stationary_angles_zero)
+{
+    Mahony mahony;
+    mahony.begin(500, 0.5f, 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        mahony.updateIMU(0, 0, 0, 0, 0, 1);
+    }
+
+    EXPECT_NEAR(0, mahony.getRoll(), 1E-4);
+    EXPECT_NEAR(0, mahony.getPitch(), 1E-4);
+    EXPECT_NEAR(0, mahony.getYaw(), 1E-4);
+}
+
+TEST(Mahony, constant_yaw_rate_integrates_at_sample_frequency)
+{
+    Mahony mahony;
+    mahony.begin(1000, 0.5f, 0);
+
+    // 90 deg/s for 0.5 s
+    for (int i = 0; i < 500; i++)
+    {
+        mahony.updateIMU(0, 0, 90, 0, 0, 1);
+    }
+
+    EXPECT_NEAR(45, mahony.getYaw(), 0.05);
+    EXPECT_NEAR(M_PI / 4, mahony.getYawRadians(), 1E-3);
+}
+
+TEST(Mahony, yaw_wrapped_between_0_and_360)
+{
+    Mahony mahony;
+    mahony.begin(100, 0.5f, 0);
+
+    // -90 deg/s for 0.5 s
+    for (int i = 0; i < 50; i++)
+    {
+        mahony.updateIMU(0, 0, -90, 0, 0, 1);
+    }
+
+    EXPECT_NEAR(315, mahony.getYaw(), 0.05);
+    EXPECT_NEAR(-M_PI / 4, mahony.getYawRadians(), 1E-3);
+}
+
+TEST(Mahony, quaternion_stays_normalized)
+{
+    Mahony mahony;
+    mahony.begin(500, 0.5f, 0.1f);
+
+    for (int i = 0; i < 5000; i++)
+    {
+        mahony.updateIMU(100, -50, 200, 0.1f, 0.2f, 0.9f);
+    }
+
+    float q[4];
+    mahony.getQuaternion(q);
+    EXPECT_NEAR(1, q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1E-6);
+}
+
+TEST(Mahony, rotation_matrix_matches_euler_angles)
+{
+    Mahony mahony;
+    mahony.begin(500, 0, 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        mahony.updateIMU(30, 20, 60, 0, 0, 0);
+    }
+
+    auto r = mahony.getRotationMatrix();
+
+    // Same definitions as tap::algorithms::transforms::Orientation
+    EXPECT_NEAR(mahony.getRollRadians(), atan2f(r.data[7], r.data[8]), 1E-5);
+    EXPECT_NEAR(mahony.getPitchRadians(), asinf(-r.data[6]), 1E-5);
+    EXPECT_NEAR(mahony.getYawRadians(), atan2f(r.data[3], r.data[0]), 1E-5);
+
+    // Orthonormal
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            float dot = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                dot += r.data[i * 3 + k] * r.data[j * 3 + k];
+            }
+            EXPECT_NEAR(i == j ? 1 : 0, dot, 1E-5);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/motion_profile.hpp"
+
+using namespace tap::algorithms;
+
+/**
+ * Samples `profile` every ms, checking the limits and that position, velocity and acceleration
+ * are continuous with each other.
+ */
+static void expectFollowsConstraints(
+    const MotionProfile &profile,
+    const MotionProfile::Constraints &constraints)
+{
+    static constexpr float DT = 0.001f;
+    MotionProfile::State prev = profile.sample(0);
+    for (float t = DT; t < profile.getDuration() + 2 * DT; t += DT)
+    {
+        const MotionProfile::State state = profile.sample(t);
+        EXPECT_LE(fabsf(state.velocity), constraints.maxVelocity * 1.001f) << "t = " << t;
+        EXPECT_LE(fabsf(state.acceleration), constraints.maxAcceleration * 1.001f) << "t = " << t;
+        EXPECT_NEAR(prev.velocity * DT, state.position - prev.position, 1E-4) << "t = " << t;
+        if (constraints.maxJerk > 0)
+        {
+            EXPECT_LE(
+                fabsf(state.acceleration - prev.acceleration),
+                constraints.maxJerk * DT * 1.01f)
+                << "t = " << t;
+        }
+        prev = state;
+    }
+}
+
+TEST(MotionProfile, default_profile_stays_at_0)
+{
+    MotionProfile profile;
+
+    EXPECT_EQ(0, profile.getDuration());
+    EXPECT_EQ(0, profile.sample(1).position);
+}
+
+TEST(MotionProfile, trapezoid_accelerates_cruises_and_decelerates)
+{
+    MotionProfile profile;
+    const MotionProfile::Constraints constraints = {2, 1};
+    profile.generate(1, 11, constraints);
+
+    // 2 s to accelerate over 2 units, 3 s cruising over 6, 2 s to decelerate
+    EXPECT_FLOAT_EQ(7, profile.getDuration());
+    EXPECT_FLOAT_EQ(1 + 0.5f, profile.sample(1).position);
+    EXPECT_FLOAT_EQ(1, profile.sample(1).velocity);
+    EXPECT_FLOAT_EQ(1, profile.sample(1).acceleration);
+    EXPECT_FLOAT_EQ(6, profile.sample(3.5f).position);
+    EXPECT_FLOAT_EQ(2, profile.sample(3.5f).velocity);
+    EXPECT_FLOAT_EQ(0, profile.sample(3.5f).acceleration);
+    EXPECT_FLOAT_EQ(-1, profile.sample(6).acceleration);
+    EXPECT_FLOAT_EQ(11, profile.sample(7).position);
+    EXPECT_FLOAT_EQ(0, profile.sample(7).velocity);
+    expectFollowsConstraints(profile, constraints);
+}
+
+TEST(MotionProfile, short_trapezoid_becomes_triangle)
+{
+    MotionProfile profile;
+    const MotionProfile::Constraints constraints = {2, 1};
+    profile.generate(0, 1, constraints);
+
+    EXPECT_FLOAT_EQ(2, profile.getDuration());
+    EXPECT_FLOAT_EQ(1, profile.sample(1).velocity);
+    EXPECT_FLOAT_EQ(0.5f, profile.sample(1).position);
+    expectFollowsConstraints(profile, constraints);
+}
+
+TEST(MotionProfile, negative_move_mirrors_positive)
+{
+    MotionProfile positive;
+    MotionProfile negative;
+    const MotionProfile::Constraints constraints = {2, 4, 20};
+    positive.generate(0, 3, constraints);
+    negative.generate(0, -3, constraints);
+
+    ASSERT_FLOAT_EQ(positive.getDuration(), negative.getDuration());
+    for (float t = 0; t < positive.getDuration(); t += 0.05f)
+    {
+        EXPECT_FLOAT_EQ(-positive.sample(t).position, negative.sample(t).position);
+        EXPECT_FLOAT_EQ(-positive.sample(t).velocity, negative.sample(t).velocity);
+        EXPECT_FLOAT_EQ(-positive.sample(t).acceleration, negative.sample(t).acceleration);
+    }
+}
+
+TEST(MotionProfile, s_curve_reaches_all_limits_on_long_move)
+{
+    MotionProfile profile;
+    const MotionProfile::Constraints constraints = {2, 4, 20};
+    profile.generate(0, 10, constraints);
+
+    // 0.2 s jerk phases and 0.3 s at constant acceleration cover 0.7 units at each end
+    EXPECT_NEAR(2 * 0.7f + (10 - 2 * 0.7f) / 2, profile.getDuration(), 1E-5);
+    EXPECT_NEAR(4, profile.sample(0.3f).acceleration, 1E-5);
+    EXPECT_NEAR(2, profile.sample(2).velocity, 1E-5);
+    EXPECT_FLOAT_EQ(10, profile.sample(profile.getDuration()).position);
+    expectFollowsConstraints(profile, constraints);
+}
+
+TEST(MotionProfile, s_curve_short_moves_stay_within_limits)
+{
+    const MotionProfile::Constraints constraints = {2, 4, 20};
+    for (float distance : {0.01f, 0.1f, 0.5f, 1.0f, 1.5f})
+    {
+        MotionProfile profile;
+        profile.generate(0, distance, constraints);
+
+        EXPECT_NEAR(distance, profile.sample(profile.getDuration() - 1E-6).position, 1E-4)
+            << "distance = " << distance;
+        expectFollowsConstraints(profile, constraints);
+    }
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/odometry/chassis_displacement_observer_interface.hpp"
+#include "tap/algorithms/odometry/chassis_imu_observer_interface.hpp"
+#include "tap/algorithms/odometry/odometry_2d_ekf.hpp"
+#include "tap/architecture/clock.hpp"
+
+using namespace tap::algorithms::odometry;
+
+class FakeImuObserver : public ChassisImuObserverInterface
+{
+public:
+    bool getChassisImu(float *yawRate, modm::Vector2f *acceleration) const override
+    {
+        *yawRate = this->yawRate;
+        *acceleration = this->acceleration;
+        return true;
+    }
+
+    float yawRate = 0;
+    modm::Vector2f acceleration;
+};
+
+class FakeDisplacementObserver : public ChassisDisplacementObserverInterface
+{
+public:
+    bool getVelocityChassisDisplacement(
+        modm::Vector3f *const velocity,
+        modm::Vector3f *const displacement) const override
+    {
+        *velocity = this->velocity;
+        *displacement = modm::Vector3f();
+        return valid;
+    }
+
+    modm::Vector3f velocity;
+    bool valid = true;
+};
+
+class Odometry2DEkfTest : public testing::Test
+{
+protected:
+    Odometry2DEkfTest() : ekf(&imu, &wheels) {}
+
+    /// Updates `ekf` every ms for `time` ms.
+    void run(uint32_t time)
+    {
+        for (uint32_t i = 0; i < time; i++)
+        {
+            clock.time++;
+            ekf.update();
+        }
+    }
+
+    tap::arch::clock::ClockStub clock;
+    FakeImuObserver imu;
+    FakeDisplacementObserver wheels;
+    Odometry2DEkf ekf;
+};
+
+TEST_F(Odometry2DEkfTest, first_update_only_primes)
+{
+    wheels.velocity = modm::Vector3f(1, 0, 0);
+    clock.time = 100;
+    ekf.update();
+
+    EXPECT_EQ(0, ekf.getCurrentLocation2D().getX());
+    EXPECT_EQ(100'000, ekf.getLastComputedOdometryTime());
+}
+
+TEST_F(Odometry2DEkfTest, wheel_velocity_integrated_in_reference_frame)
+{
+    ekf.reset(modm::Location2D<float>(1, 2, M_PI_2));
+    wheels.velocity = modm::Vector3f(1, 0, 0);
+    ekf.update();
+
+    run(1000);
+
+    EXPECT_NEAR(1, ekf.getCurrentLocation2D().getX(), 0.01);
+    EXPECT_NEAR(3, ekf.getCurrentLocation2D().getY(), 0.01);
+    EXPECT_NEAR(1, ekf.getCurrentVelocity2D().getY(), 0.01);
+    EXPECT_NEAR(M_PI_2, ekf.getYaw(), 1E-4);
+    EXPECT_FALSE(ekf.isWheelSlipping());
+    EXPECT_EQ(0, ekf.getWheelSlipCount());
+}
+
+TEST_F(Odometry2DEkfTest, yaw_integrates_gyro_rate_and_wraps)
+{
+    imu.yawRate = M_PI;
+    ekf.update();
+
+    run(500);
+    EXPECT_NEAR(M_PI_2, ekf.getYaw(), 1E-3);
+
+    run(1000);
+    EXPECT_NEAR(-M_PI_2, ekf.getYaw(), 1E-3);
+}
+
+TEST_F(Odometry2DEkfTest, wheel_spin_detected_and_skipped)
+{
+    wheels.velocity = modm::Vector3f(1, 0, 0);
+    ekf.update();
+    run(1000);
+    const float x = ekf.getCurrentLocation2D().getX();
+
+    // The wheels spin up while the IMU measures no acceleration
+    wheels.velocity = modm::Vector3f(3, 0, 0);
+    run(100);
+
+    EXPECT_TRUE(ekf.isWheelSlipping());
+    EXPECT_EQ(1, ekf.getWheelSlipCount());
+    EXPECT_NEAR(x + 0.1f, ekf.getCurrentLocation2D().getX(), 0.01);
+
+    wheels.velocity = modm::Vector3f(1, 0, 0);
+    run(10);
+
+    EXPECT_FALSE(ekf.isWheelSlipping());
+    EXPECT_EQ(1, ekf.getWheelSlipCount());
+}
+
+TEST_F(Odometry2DEkfTest, wheels_trusted_again_after_max_slip_time)
+{
+    ekf.update();
+    run(100);
+
+    // The wheels disagree with the IMU for longer than slip could plausibly last
+    wheels.velocity = modm::Vector3f(2, 0, 0);
+    run(1000);
+
+    EXPECT_FALSE(ekf.isWheelSlipping());
+    EXPECT_EQ(1, ekf.getWheelSlipCount());
+    EXPECT_NEAR(2, ekf.getCurrentVelocity2D().getX(), 0.05);
+}
+
+TEST_F(Odometry2DEkfTest, acceleration_agreeing_with_wheels_is_not_slip)
+{
+    ekf.update();
+    imu.acceleration = modm::Vector2f(5, 0);
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        wheels.velocity = modm::Vector3f(5 * (i + 1) / 1000.0f, 0, 0);
+        run(1);
+    }
+
+    EXPECT_EQ(0, ekf.getWheelSlipCount());
+    EXPECT_NEAR(1, ekf.getCurrentVelocity2D().getX(), 0.01);
+    EXPECT_NEAR(0.1, ekf.getCurrentLocation2D().getX(), 0.01);
+}
+
+TEST_F(Odometry2DEkfTest, absolute_position_fix_corrects_drift)
+{
+    wheels.valid = false;
+    ekf.update();
+    run(1000);
+
+    EXPECT_TRUE(ekf.correctWithAbsolutePosition(modm::Vector2f(2, -1), 0.01));
+    EXPECT_NEAR(2, ekf.getCurrentLocation2D().getX(), 0.01);
+    EXPECT_NEAR(-1, ekf.getCurrentLocation2D().getY(), 0.01);
+    EXPECT_GT(0.01f * 0.01f * 1.01f, ekf.getCovariance().data[0]);
+}
+
+TEST_F(Odometry2DEkfTest, absolute_fix_outlier_rejected_by_gate)
+{
+    Odometry2DEkf::Config config;
+    config.absoluteFixGate = 9.21f;
+    Odometry2DEkf gatedEkf(&imu, &wheels, config);
+    gatedEkf.update();
+    clock.time += 10;
+    gatedEkf.update();
+
+    EXPECT_FALSE(gatedEkf.correctWithAbsolutePosition(modm::Vector2f(10, 0), 0.05));
+    EXPECT_EQ(0, gatedEkf.getCurrentLocation2D().getX());
+    EXPECT_TRUE(gatedEkf.correctWithAbsolutePosition(modm::Vector2f(0.05, 0), 0.05));
+}
+
+TEST_F(Odometry2DEkfTest, absolute_yaw_fix_across_wrap)
+{
+    ekf.reset(modm::Location2D<float>(0, 0, M_PI - 0.05));
+
+    EXPECT_TRUE(ekf.correctWithAbsoluteYaw(-M_PI + 0.05, 0.001));
+    EXPECT_NEAR(-M_PI + 0.05, ekf.getYaw(), 1E-3);
+}
+
+TEST_F(Odometry2DEkfTest, gyro_bias_learned_from_yaw_fixes)
+{
+    imu.yawRate = 0.02;
+    ekf.update();
+    for (int i = 0; i < 200; i++)
+    {
+        run(50);
+        ekf.correctWithAbsoluteYaw(0, 0.005);
+    }
+
+    EXPECT_NEAR(0.02, ekf.getGyroBias(), 0.002);
+    EXPECT_NEAR(0, ekf.getYaw(), 0.005);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/odometry/chassis_displacement_observer_interface.hpp"
+#include "tap/algorithms/odometry/chassis_world_yaw_observer_interface.hpp"
+#include "tap/algorithms/odometry/odometry_2d_tracker.hpp"
+#include "tap/architecture/clock.hpp"
+
+using namespace tap::algorithms::odometry;
+
+class FakeYawObserver : public ChassisWorldYawObserverInterface
+{
+public:
+    bool getChassisWorldYaw(float *yaw) const override
+    {
+        *yaw = this->yaw;
+        return true;
+    }
+
+    float yaw = 0;
+};
+
+class FakeDisplacementObserver : public ChassisDisplacementObserverInterface
+{
+public:
+    bool getVelocityChassisDisplacement(
+        modm::Vector3f *const velocity,
+        modm::Vector3f *const displacement) const override
+    {
+        *velocity = modm::Vector3f();
+        *displacement = this->displacement;
+        return true;
+    }
+
+    modm::Vector3f displacement;
+};
+
+class Odometry2DTrackerTest : public testing::Test
+{
+protected:
+    Odometry2DTrackerTest() : tracker(&yaw, &wheels) {}
+
+    /// Moves forward `step` m every ms for `time` ms.
+    void run(uint32_t time, float step)
+    {
+        for (uint32_t i = 0; i < time; i++)
+        {
+            clock.time++;
+            wheels.displacement.x += step;
+            tracker.update();
+        }
+    }
+
+    tap::arch::clock::ClockStub clock;
+    FakeYawObserver yaw;
+    FakeDisplacementObserver wheels;
+    Odometry2DTracker tracker;
+};
+
+TEST_F(Odometry2DTrackerTest, getLocationAt_returns_past_pose)
+{
+    tracker.update();
+    run(20, 0.01f);
+
+    modm::Location2D<float> location;
+    ASSERT_TRUE(tracker.getLocationAt(10'500, &location));
+    EXPECT_NEAR(0.105f, location.getX(), 1E-5);
+    EXPECT_NEAR(0.2f, tracker.getCurrentLocation2D().getX(), 1E-5);
+}
+
+TEST_F(Odometry2DTrackerTest, getLocationAt_older_than_history_fails)
+{
+    tracker.update();
+    run(Odometry2DTracker::POSE_HISTORY_SIZE + 10, 0.01f);
+
+    modm::Location2D<float> location;
+    EXPECT_FALSE(tracker.getLocationAt(5'000, &location));
+}
+
+TEST_F(Odometry2DTrackerTest, correctPositionAt_shifts_later_poses_and_current_location)
+{
+    tracker.update();
+    run(20, 0.01f);
+
+    // Relocalization says the robot was at (1, 1) at 10 ms
+    ASSERT_TRUE(tracker.correctPositionAt(10'000, modm::Vector2f(1, 1)));
+
+    modm::Location2D<float> location;
+    tracker.getLocationAt(10'000, &location);
+    EXPECT_NEAR(1, location.getX(), 1E-5);
+    EXPECT_NEAR(1, location.getY(), 1E-5);
+    tracker.getLocationAt(5'000, &location);
+    EXPECT_NEAR(0.05f, location.getX(), 1E-5);
+    EXPECT_NEAR(0, location.getY(), 1E-5);
+
+    // The motion since the correction time is kept, and later updates continue from there
+    EXPECT_NEAR(1.1f, tracker.getCurrentLocation2D().getX(), 1E-5);
+    EXPECT_NEAR(1, tracker.getCurrentLocation2D().getY(), 1E-5);
+    run(10, 0.01f);
+    EXPECT_NEAR(1.2f, tracker.getCurrentLocation2D().getX(), 1E-5);
+}
+
+TEST_F(Odometry2DTrackerTest, correctPositionAt_older_than_history_changes_nothing)
+{
+    tracker.update();
+    run(Odometry2DTracker::POSE_HISTORY_SIZE + 10, 0.01f);
+
+    EXPECT_FALSE(tracker.correctPositionAt(5'000, modm::Vector2f(1, 1)));
+    EXPECT_NEAR(0, tracker.getCurrentLocation2D().getY(), 1E-5);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/odometry/pose_history.hpp"
+
+using namespace tap::algorithms::odometry;
+
+using Location = modm::Location2D<float>;
+
+TEST(PoseHistory, empty_lookup_fails)
+{
+    PoseHistory<8> history;
+    Location location;
+
+    EXPECT_FALSE(history.getLocationAt(0, &location));
+    EXPECT_FALSE(history.translateFrom(0, 1, 1));
+    EXPECT_EQ(0, history.size());
+}
+
+TEST(PoseHistory, lookup_between_entries_interpolates)
+{
+    PoseHistory<8> history;
+    history.push(1000, Location(0, 0, 0.1f));
+    history.push(2000, Location(1, -2, 0.3f));
+
+    Location location;
+    ASSERT_TRUE(history.getLocationAt(1250, &location));
+    EXPECT_NEAR(0.25f, location.getX(), 1E-5);
+    EXPECT_NEAR(-0.5f, location.getY(), 1E-5);
+    EXPECT_NEAR(0.15f, location.getOrientation(), 1E-5);
+}
+
+TEST(PoseHistory, orientation_interpolates_the_short_way_around)
+{
+    PoseHistory<8> history;
+    history.push(1000, Location(0, 0, M_PI - 0.1f));
+    history.push(2000, Location(0, 0, -M_PI + 0.1f));
+
+    Location location;
+    ASSERT_TRUE(history.getLocationAt(1500, &location));
+    EXPECT_NEAR(M_PI, std::abs(location.getOrientation()), 1E-5);
+}
+
+TEST(PoseHistory, lookup_outside_history)
+{
+    PoseHistory<4> history;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        history.push(1000 * i, Location(i, 0, 0));
+    }
+
+    Location location;
+    EXPECT_EQ(4, history.size());
+    EXPECT_FALSE(history.getLocationAt(1999, &location));
+    ASSERT_TRUE(history.getLocationAt(9000, &location));
+    EXPECT_FLOAT_EQ(5, location.getX());
+}
+
+TEST(PoseHistory, lookup_across_time_wrap)
+{
+    PoseHistory<8> history;
+    history.push(UINT32_MAX - 499, Location(0, 0, 0));
+    history.push(500, Location(1, 0, 0));
+
+    Location location;
+    ASSERT_TRUE(history.getLocationAt(0, &location));
+    EXPECT_NEAR(0.5f, location.getX(), 1E-5);
+}
+
+TEST(PoseHistory, translateFrom_moves_poses_since_time_only)
+{
+    PoseHistory<8> history;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        history.push(1000 * i, Location(i, 0, 0));
+    }
+
+    ASSERT_TRUE(history.translateFrom(2500, 0, 1));
+
+    Location location;
+    history.getLocationAt(1000, &location);
+    EXPECT_FLOAT_EQ(0, location.getY());
+    // The entry before the correction time moves too, so the pose at that time is exact
+    history.getLocationAt(2500, &location);
+    EXPECT_FLOAT_EQ(1, location.getY());
+    history.getLocationAt(4000, &location);
+    EXPECT_FLOAT_EQ(4, location.getX());
+    EXPECT_FLOAT_EQ(1, location.getY());
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/transforms/quaternion.hpp"
+#include "tap/algorithms/transforms/transform.hpp"
+
+using namespace tap::algorithms::transforms;
+using tap::algorithms::CMSISMat;
+
+static constexpr float ANGLES[][3] = {
+    {0, 0, 0},
+    {0.3f, -0.2f, 1.1f},
+    {-2.5f, 0.7f, -3.0f},
+    {1.2f, 1.4f, 0.4f},
+    {3.0f, -1.5f, 2.0f},
+};
+
+static void expectMatricesNear(const CMSISMat<3, 3> &expected, const CMSISMat<3, 3> &actual)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        EXPECT_NEAR(expected.data[i], actual.data[i], 1E-5);
+    }
+}
+
+TEST(Quaternion, fromEulerAngles_matches_rotation_matrix)
+{
+    for (const auto &a : ANGLES)
+    {
+        expectMatricesNear(
+            tap::algorithms::fromEulerAngles(a[0], a[1], a[2]),
+            Quaternion::fromEulerAngles(a[0], a[1], a[2]).toMatrix());
+    }
+}
+
+TEST(Quaternion, fromMatrix_round_trips_through_toMatrix)
+{
+    for (const auto &a : ANGLES)
+    {
+        CMSISMat<3, 3> matrix = tap::algorithms::fromEulerAngles(a[0], a[1], a[2]);
+        expectMatricesNear(matrix, Quaternion::fromMatrix(matrix).toMatrix());
+    }
+
+    // Half turns about each axis exercise every branch
+    for (const auto &a : {std::array<float, 3>{M_PI, 0, 0}, {0, 0, M_PI}, {M_PI, 0, M_PI}})
+    {
+        CMSISMat<3, 3> matrix = tap::algorithms::fromEulerAngles(a[0], a[1], a[2]);
+        expectMatricesNear(matrix, Quaternion::fromMatrix(matrix).toMatrix());
+    }
+}
+
+TEST(Quaternion, euler_angles_match_orientation)
+{
+    for (const auto &a : ANGLES)
+    {
+        Orientation orientation(a[0], a[1], a[2]);
+        Quaternion q = Quaternion::fromEulerAngles(a[0], a[1], a[2]);
+        EXPECT_NEAR(orientation.pitch(), q.pitch(), 1E-4);
+        if (std::abs(orientation.pitch()) < 1.5f)
+        {
+            EXPECT_NEAR(orientation.roll(), q.roll(), 1E-4);
+            EXPECT_NEAR(orientation.yaw(), q.yaw(), 1E-4);
+        }
+    }
+}
+
+TEST(Quaternion, compose_matches_transform_compose)
+{
+    for (const auto &a : ANGLES)
+    {
+        for (const auto &b : ANGLES)
+        {
+            Transform first(0, 0, 0, a[0], a[1], a[2]);
+            Transform second(0, 0, 0, b[0], b[1], b[2]);
+            Quaternion composed = Quaternion::fromEulerAngles(a[0], a[1], a[2])
+                                      .compose(Quaternion::fromEulerAngles(b[0], b[1], b[2]));
+            expectMatricesNear(
+                first.compose(second).getRotation().matrix(),
+                composed.toMatrix());
+        }
+    }
+}
+
+TEST(Quaternion, rotate_matches_rotation_matrix)
+{
+    const float v[3] = {1.0f, -2.0f, 0.5f};
+    for (const auto &a : ANGLES)
+    {
+        Quaternion q = Quaternion::fromEulerAngles(a[0], a[1], a[2]);
+        CMSISMat<3, 1> expected = q.toMatrix() * CMSISMat<3, 1>({v[0], v[1], v[2]});
+        float rotated[3];
+        q.rotate(v, rotated);
+        float back[3];
+        q.inverseRotate(rotated, back);
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_NEAR(expected.data[i], rotated[i], 1E-5);
+            EXPECT_NEAR(v[i], back[i], 1E-5);
+        }
+    }
+}
+
+TEST(Quaternion, renormalize_removes_drift)
+{
+    Quaternion q = Quaternion::fromEulerAngles(0.3f, -0.2f, 1.1f);
+    Quaternion drifted(q.w * 1.01f, q.x * 1.01f, q.y * 1.01f, q.z * 1.01f);
+
+    drifted.renormalize();
+
+    EXPECT_NEAR(1, drifted.squaredNorm(), 1E-3);
+    drifted.renormalize();
+    EXPECT_NEAR(1, drifted.squaredNorm(), 1E-6);
+    EXPECT_NEAR(q.w, drifted.w, 1E-6);
+    EXPECT_NEAR(q.z, drifted.z, 1E-6);
+
+    Quaternion far(2, 0, 0, 0);
+    far.normalize();
+    EXPECT_FLOAT_EQ(1, far.w);
+}
+
+TEST(Quaternion, transform_updateRotation_from_estimator_quaternion)
+{
+    Quaternion q = Quaternion::fromEulerAngles(0.1f, 0.2f, -0.7f);
+    const float estimate[4] = {q.w, q.x, q.y, q.z};
+    Transform transform(1, 2, 3, 0, 0, 0);
+
+    transform.updateRotation(Quaternion(estimate));
+
+    EXPECT_NEAR(0.1f, transform.getRoll(), 1E-5);
+    EXPECT_NEAR(0.2f, transform.getPitch(), 1E-5);
+    EXPECT_NEAR(-0.7f, transform.getYaw(), 1E-5);
+    Quaternion back = transform.getRotationQuaternion();
+    EXPECT_NEAR(q.w, back.w, 1E-5);
+    EXPECT_NEAR(q.x, back.x, 1E-5);
+    EXPECT_NEAR(q.y, back.y, 1E-5);
+    EXPECT_NEAR(q.z, back.z, 1E-5);
+    expectMatricesNear(q.toMatrix(), Orientation(q).matrix());
+}
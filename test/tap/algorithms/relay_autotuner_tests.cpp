@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <deque>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/relay_autotuner.hpp"
+
+using namespace tap::algorithms;
+
+/// An integrator with delay, k * e^(-delay s) / s, simulated at 1 kHz.
+class IntegratingPlant
+{
+public:
+    IntegratingPlant(float gain, float delay) : gain(gain), delayed(delay * 1000, 0.0f) {}
+
+    float step(float input)
+    {
+        delayed.push_back(input);
+        output += gain * delayed.front() * 1E-3f;
+        delayed.pop_front();
+        return output;
+    }
+
+    float output = 0;
+
+private:
+    float gain;
+    std::deque<float> delayed;
+};
+
+static void run(RelayAutotuner &autotuner, IntegratingPlant &plant, float seconds)
+{
+    float input = 0;
+    for (uint32_t t = 0; t < seconds * 1E6f; t += 1000)
+    {
+        input = autotuner.update(plant.step(input), t);
+    }
+}
+
+TEST(RelayAutotuner, integrating_plant_oscillates_at_four_times_delay)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 2;
+    RelayAutotuner autotuner(config);
+    IntegratingPlant plant(5, 0.05f);
+
+    autotuner.start(0, 0);
+    run(autotuner, plant, 5);
+
+    ASSERT_EQ(RelayAutotuner::State::DONE, autotuner.getState());
+    EXPECT_NEAR(0.2f, autotuner.getUltimatePeriod(), 0.005f);
+    // The oscillation is a triangle wave of amplitude k * d * delay, so the describing function
+    // gives 4 / (pi * k * delay), 8 / pi^2 of the true ultimate gain pi / (2 * k * delay)
+    EXPECT_NEAR(4 / (M_PI * 5 * 0.05f), autotuner.getUltimateGain(), 0.2f);
+}
+
+TEST(RelayAutotuner, hysteresis_corrects_ultimate_gain)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 2;
+    config.hysteresis = 0.2f;
+    RelayAutotuner autotuner(config);
+    IntegratingPlant plant(5, 0.05f);
+
+    autotuner.start(0, 0);
+    run(autotuner, plant, 5);
+
+    // Hysteresis adds to the amplitude, a = k * d * delay + e
+    ASSERT_EQ(RelayAutotuner::State::DONE, autotuner.getState());
+    float amplitude = 5 * 2 * 0.05f + 0.2f;
+    EXPECT_NEAR(
+        4 * 2 / (M_PI * sqrtf(amplitude * amplitude - 0.2f * 0.2f)),
+        autotuner.getUltimateGain(),
+        0.2f);
+}
+
+TEST(RelayAutotuner, oscillates_around_setpoint_with_output_bias)
+{
+    RelayAutotunerConfig config;
+    config.outputBias = 1;
+    config.relayAmplitude = 2;
+    RelayAutotuner autotuner(config);
+    IntegratingPlant plant(5, 0.05f);
+    plant.output = 10;
+
+    autotuner.start(3, 0);
+    run(autotuner, plant, 5);
+
+    ASSERT_EQ(RelayAutotuner::State::DONE, autotuner.getState());
+    const RelayAutotuner::Sample &last = autotuner.getSamples()[autotuner.getNumSamples() - 1];
+    EXPECT_NEAR(3, last.measurement, 1);
+    EXPECT_FLOAT_EQ(1, autotuner.update(3, 5'000'000));
+}
+
+TEST(RelayAutotuner, fails_without_oscillation)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 1;
+    config.timeout = 1'000'000;
+    RelayAutotuner autotuner(config);
+
+    autotuner.start(10, 0);
+    for (uint32_t t = 0; t <= 2'000'000; t += 1000)
+    {
+        autotuner.update(0, t);
+    }
+
+    EXPECT_EQ(RelayAutotuner::State::FAILED, autotuner.getState());
+    EXPECT_FLOAT_EQ(0, autotuner.computeGains(TuningRule::ZIEGLER_NICHOLS).kp);
+}
+
+TEST(RelayAutotuner, records_response_at_record_period_until_full)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 1;
+    config.recordPeriod = 10'000;
+    RelayAutotuner autotuner(config);
+
+    autotuner.start(10, 0);
+    for (uint32_t t = 0; t < 100'000; t += 1000)
+    {
+        autotuner.update(t / 1E6f, t);
+    }
+
+    ASSERT_EQ(10, autotuner.getNumSamples());
+    EXPECT_EQ(50'000u, autotuner.getSamples()[5].time);
+    EXPECT_FLOAT_EQ(0.05f, autotuner.getSamples()[5].measurement);
+    EXPECT_FLOAT_EQ(1, autotuner.getSamples()[5].output);
+
+    for (uint32_t t = 100'000; t < 10'000'000; t += 1000)
+    {
+        autotuner.update(0, t);
+    }
+    EXPECT_EQ(RelayAutotuner::MAX_SAMPLES, autotuner.getNumSamples());
+}
+
+TEST(RelayAutotuner, tuning_rules_scale_ultimate_gain_and_period)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 2;
+    RelayAutotuner autotuner(config);
+    IntegratingPlant plant(5, 0.05f);
+    autotuner.start(0, 0);
+    run(autotuner, plant, 5);
+    const float ku = autotuner.getUltimateGain();
+    const float tu = autotuner.getUltimatePeriod();
+
+    PidGains zn = autotuner.computeGains(TuningRule::ZIEGLER_NICHOLS);
+    EXPECT_FLOAT_EQ(0.6f * ku, zn.kp);
+    EXPECT_FLOAT_EQ(0.6f * ku / (tu / 2), zn.ki);
+    EXPECT_FLOAT_EQ(0.6f * ku * tu / 8, zn.kd);
+
+    PidGains simc = autotuner.computeGains(TuningRule::SIMC_PI);
+    EXPECT_FLOAT_EQ(ku / M_PI, simc.kp);
+    EXPECT_FLOAT_EQ(ku / M_PI / (2 * tu), simc.ki);
+    EXPECT_FLOAT_EQ(0, simc.kd);
+}
+
+TEST(RelayAutotuner, simc_gains_control_plant_without_oscillation)
+{
+    RelayAutotunerConfig config;
+    config.relayAmplitude = 2;
+    RelayAutotuner autotuner(config);
+    IntegratingPlant plant(5, 0.05f);
+    autotuner.start(0, 0);
+    run(autotuner, plant, 5);
+    PidGains gains = autotuner.computeGains(TuningRule::SIMC_PI);
+
+    // Step the tuned PI loop to 1
+    IntegratingPlant tuned(5, 0.05f);
+    float integral = 0;
+    float input = 0;
+    float maxOutput = 0;
+    for (int i = 0; i < 5'000; i++)
+    {
+        float error = 1 - tuned.step(input);
+        integral += gains.ki * error * 1E-3f;
+        input = gains.kp * error + integral;
+        maxOutput = std::max(maxOutput, tuned.output);
+    }
+
+    EXPECT_NEAR(1, tuned.output, 0.01f);
+    EXPECT_LT(maxOutput, 1.5f);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/smooth_pid_bank.hpp"
+
+using namespace tap::algorithms;
+
+static constexpr int CONTROLLERS = 5;
+
+static SmoothPidConfig wheelPidConfig()
+{
+    SmoothPidConfig config;
+    config.kp = 2.0f;
+    config.ki = 0.5f;
+    config.kd = 0.1f;
+    config.maxICumulative = 1.5f;
+    config.maxOutput = 8.0f;
+    config.tQDerivativeKalman = 1.0f;
+    config.tRDerivativeKalman = 3.0f;
+    config.tQProportionalKalman = 1.0f;
+    config.tRProportionalKalman = 0.5f;
+    config.errDeadzone = 0.05f;
+    config.errorDerivativeFloor = 0.2f;
+    return config;
+}
+
+/// An error for each controller and time step that passes through the deadzone and saturates.
+static float testError(int controller, int t)
+{
+    return 3.0f * sinf(0.05f * t + controller) + 0.3f * controller - 0.5f;
+}
+
+TEST(SmoothPidBank, runControllers_is_identical_to_SmoothPid)
+{
+    SmoothPidBankConfig config;
+    config.pid = wheelPidConfig();
+    SmoothPidBank<CONTROLLERS> bank(config);
+    SmoothPid pids[CONTROLLERS] = {
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+    };
+
+    for (int t = 0; t < 500; t++)
+    {
+        float error[CONTROLLERS];
+        float errorDerivative[CONTROLLERS];
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            error[i] = testError(i, t);
+            errorDerivative[i] = 0.15f * cosf(0.05f * t + i);
+        }
+
+        bank.runControllers(error, errorDerivative, 0.002f);
+
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            EXPECT_EQ(
+                pids[i].runController(error[i], errorDerivative[i], 0.002f),
+                bank.getOutput(i));
+        }
+    }
+}
+
+TEST(SmoothPidBank, runControllersToSetpoint_with_default_weights_is_identical_to_SmoothPid)
+{
+    SmoothPidBankConfig config;
+    config.pid = wheelPidConfig();
+    SmoothPidBank<CONTROLLERS> bank(config);
+    SmoothPid pids[CONTROLLERS] = {
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+        SmoothPid(config.pid),
+    };
+
+    for (int t = 0; t < 500; t++)
+    {
+        float setpoint[CONTROLLERS];
+        float measurement[CONTROLLERS];
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            setpoint[i] = t < 250 ? 1.0f : -2.0f;
+            measurement[i] = setpoint[i] - testError(i, t);
+        }
+
+        bank.runControllersToSetpoint(setpoint, measurement, 0.002f);
+
+        for (int i = 0; i < CONTROLLERS; i++)
+        {
+            EXPECT_EQ(
+                pids[i].runControllerDerivateError(setpoint[i] - measurement[i], 0.002f),
+                bank.getOutput(i));
+        }
+    }
+}
+
+TEST(SmoothPidBank, feed_forward_is_added_to_output)
+{
+    SmoothPidBankConfig config;
+    config.pid.maxOutput = 100.0f;
+    config.kf = 3.0f;
+    SmoothPidBank<2> bank(config);
+
+    bank.runControllersToSetpoint({1.0f, -2.0f}, {0.0f, 0.0f}, {0.5f, 0.0f}, 0.002f);
+
+    EXPECT_FLOAT_EQ(3.5f, bank.getOutput(0));
+    EXPECT_FLOAT_EQ(-6.0f, bank.getOutput(1));
+
+    bank.setMaxOutput(4.0f);
+    bank.runControllersToSetpoint({1.0f, -2.0f}, {0.0f, 0.0f}, 0.002f);
+
+    EXPECT_FLOAT_EQ(3.0f, bank.getOutput(0));
+    EXPECT_FLOAT_EQ(-4.0f, bank.getOutput(1));
+}
+
+TEST(SmoothPidBank, setpoint_weights_remove_kick_from_setpoint_steps)
+{
+    SmoothPidBankConfig config;
+    config.pid.kp = 1.0f;
+    config.pid.kd = -1.0f;
+    config.pid.maxOutput = 100.0f;
+    config.setpointWeightP = 0.0f;
+    config.setpointWeightD = 0.0f;
+    SmoothPidBank<1> weighted(config);
+    config.setpointWeightP = 1.0f;
+    config.setpointWeightD = 1.0f;
+    SmoothPidBank<1> unweighted(config);
+
+    weighted.runControllersToSetpoint({0.0f}, {0.0f}, 0.01f);
+    unweighted.runControllersToSetpoint({0.0f}, {0.0f}, 0.01f);
+    weighted.runControllersToSetpoint({1.0f}, {0.0f}, 0.01f);
+    unweighted.runControllersToSetpoint({1.0f}, {0.0f}, 0.01f);
+
+    // Only the measurement moves the weighted output
+    EXPECT_EQ(0.0f, weighted.getOutput(0));
+    EXPECT_GT(unweighted.getOutput(0), 100.0f - 1E-3f);
+
+    weighted.runControllersToSetpoint({1.0f}, {0.5f}, 0.01f);
+    EXPECT_LT(weighted.getOutput(0), 0.0f);
+}
+
+TEST(SmoothPidBank, second_order_derivative_filter_tracks_with_smooth_start)
+{
+    SmoothPidBankConfig config;
+    config.pid.kd = -1.0f;
+    config.pid.maxOutput = 100.0f;
+    config.derivativeFilter = SmoothPidBankConfig::DerivativeFilter::SECOND_ORDER;
+    config.derivativeCutoffFrequency = 10.0f;
+    SmoothPidBank<1> bank(config);
+
+    const float dt = 0.002f;
+    const float alpha = dt / (dt + 1 / (2 * static_cast<float>(M_PI) * 10.0f));
+
+    bank.runControllers({1.0f}, {2.0f}, dt);
+
+    // A step passes through two stages, so starts with zero slope
+    EXPECT_NEAR(2.0f * alpha * alpha, bank.getOutput(0), 1E-6);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        bank.runControllers({1.0f}, {2.0f}, dt);
+    }
+    EXPECT_NEAR(2.0f, bank.getOutput(0), 1E-4);
+
+    bank.reset();
+    EXPECT_EQ(0.0f, bank.getOutput(0));
+    bank.runControllers({1.0f}, {2.0f}, dt);
+    EXPECT_NEAR(2.0f * alpha * alpha, bank.getOutput(0), 1E-6);
+}
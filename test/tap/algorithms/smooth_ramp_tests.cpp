@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/motion_profile.hpp"
+#include "tap/algorithms/smooth_ramp.hpp"
+
+using namespace tap::algorithms;
+
+struct RampRun
+{
+    /// Time the ramp first reached the target, in seconds, or -1 if it didn't.
+    float settleTime = -1.0f;
+    /// Furthest the value went past the target.
+    float overshoot = 0.0f;
+    float maxRate = 0.0f;
+    float maxAcceleration = 0.0f;
+    /// Largest change of the acceleration in one update, divided by dt.
+    float maxJerk = 0.0f;
+};
+
+/// Ramps from 0 to `target` for `duration` seconds, updating every `dt`.
+static RampRun runRamp(const SmoothRampConfig &config, float target, float dt, float duration)
+{
+    SmoothRamp ramp(config);
+    ramp.setTarget(target);
+    RampRun run;
+    float prevAcceleration = 0.0f;
+    for (int i = 1; i * dt <= duration; i++)
+    {
+        ramp.update(dt);
+        run.overshoot =
+            std::max(run.overshoot, (ramp.getValue() - target) * copysignf(1.0f, target));
+        run.maxRate = std::max(run.maxRate, fabsf(ramp.getRate()));
+        run.maxAcceleration = std::max(run.maxAcceleration, fabsf(ramp.getAcceleration()));
+        run.maxJerk =
+            std::max(run.maxJerk, fabsf(ramp.getAcceleration() - prevAcceleration) / dt);
+        prevAcceleration = ramp.getAcceleration();
+        if (run.settleTime < 0 && ramp.isTargetReached())
+        {
+            run.settleTime = i * dt;
+        }
+    }
+    return run;
+}
+
+TEST(SmoothRamp, rate_limited_value_moves_at_rate_independent_of_dt)
+{
+    for (float dt : {0.001f, 0.002f, 0.01f})
+    {
+        SmoothRamp ramp({2.0f});
+        ramp.setTarget(1.0f);
+
+        for (int i = 0; i < static_cast<int>(0.25f / dt + 0.5f); i++)
+        {
+            ramp.update(dt);
+        }
+        EXPECT_NEAR(0.5f, ramp.getValue(), 1e-4f) << dt;
+        EXPECT_NEAR(2.0f, ramp.getRate(), 1e-4f) << dt;
+
+        EXPECT_NEAR(0.5f, runRamp({2.0f}, 1.0f, dt, 1.0f).settleTime, 1.5f * dt) << dt;
+    }
+}
+
+TEST(SmoothRamp, acceleration_limited_ramp_is_time_optimal_without_overshoot)
+{
+    const SmoothRampConfig config{2.0f, 4.0f};
+    MotionProfile profile;
+
+    for (float dt : {0.001f, 0.002f, 0.01f})
+    {
+        for (float target : {1.0f, -10.0f})
+        {
+            RampRun run = runRamp(config, target, dt, 10.0f);
+            profile.generate(0.0f, target, {config.maxRate, config.maxAcceleration});
+
+            EXPECT_NEAR(profile.getDuration(), run.settleTime, 3 * dt) << dt << " " << target;
+            EXPECT_LT(run.overshoot, 1e-5f * fabsf(target));
+            EXPECT_LE(run.maxRate, config.maxRate);
+            EXPECT_LE(run.maxAcceleration, config.maxAcceleration * 1.0001f);
+        }
+    }
+}
+
+TEST(SmoothRamp, jerk_limited_ramp_respects_limits)
+{
+    MotionProfile profile;
+
+    for (float jerk : {50.0f, 1'000.0f})
+    {
+        const SmoothRampConfig config{2.0f, 4.0f, jerk};
+        for (float dt : {0.001f, 0.01f})
+        {
+            for (float target : {1.0f, -10.0f})
+            {
+                RampRun run = runRamp(config, target, dt, 10.0f);
+                profile.generate(
+                    0.0f,
+                    target,
+                    {config.maxRate, config.maxAcceleration, config.maxJerk});
+
+                ASSERT_GT(run.settleTime, 0.0f);
+                EXPECT_LT(run.settleTime, 1.2f * profile.getDuration());
+                EXPECT_LT(run.overshoot, 0.01f * fabsf(target));
+                EXPECT_LE(run.maxRate, config.maxRate);
+                EXPECT_LE(run.maxAcceleration, config.maxAcceleration * 1.0001f);
+                EXPECT_LE(run.maxJerk, config.maxJerk * 1.0001f);
+            }
+        }
+    }
+}
+
+TEST(SmoothRamp, follows_target_that_reverses_while_moving)
+{
+    SmoothRamp ramp({2.0f, 4.0f, 100.0f});
+    ramp.setTarget(5.0f);
+    for (int i = 0; i < 500; i++)
+    {
+        ramp.update(0.002f);
+    }
+    EXPECT_GT(ramp.getRate(), 1.0f);
+
+    ramp.setTarget(-1.0f);
+    for (int i = 0; i < 5'000; i++)
+    {
+        ramp.update(0.002f);
+    }
+
+    EXPECT_TRUE(ramp.isTargetReached());
+    EXPECT_EQ(-1.0f, ramp.getValue());
+}
+
+TEST(SmoothRamp, update_without_elapsed_time_does_nothing)
+{
+    SmoothRamp ramp({2.0f, 4.0f});
+    ramp.setTarget(1.0f);
+
+    ramp.update(0.0f);
+    ramp.update(-1.0f);
+
+    EXPECT_EQ(0.0f, ramp.getValue());
+    EXPECT_FALSE(ramp.isTargetReached());
+}
+
+TEST(SmoothRampBank, identical_to_SmoothRamp)
+{
+    const SmoothRampConfig config{3.0f, 10.0f, 200.0f};
+    SmoothRampBank<3> bank(config);
+    SmoothRamp ramps[3] = {SmoothRamp(config), SmoothRamp(config), SmoothRamp(config)};
+    const float targets[3] = {1.0f, -2.0f, 0.5f};
+    bank.setTargets(targets);
+    for (int i = 0; i < 3; i++)
+    {
+        ramps[i].setTarget(targets[i]);
+    }
+
+    for (int t = 0; t < 1'000; t++)
+    {
+        bank.update(0.003f);
+        for (int i = 0; i < 3; i++)
+        {
+            ramps[i].update(0.003f);
+            EXPECT_EQ(ramps[i].getValue(), bank.getValues()[i]);
+            EXPECT_EQ(ramps[i].getRate(), bank.getRate(i));
+        }
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(bank.isTargetReached(i));
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/timestamped_history.hpp"
+
+using namespace tap::algorithms;
+
+struct Sample
+{
+    uint32_t time;
+    int value;
+};
+
+template <int CAPACITY>
+static void push(TimestampedHistory<Sample, CAPACITY> &history, uint32_t time, int value)
+{
+    history.push(time).value = value;
+}
+
+TEST(TimestampedHistory, find_on_empty_fails)
+{
+    TimestampedHistory<Sample, 4> history;
+    int older = -1;
+    float t = -1;
+
+    EXPECT_FALSE(history.find(0, older, t));
+    EXPECT_EQ(-1, older);
+    EXPECT_EQ(0, history.getOldestTime());
+    EXPECT_EQ(0, history.getNewestTime());
+}
+
+TEST(TimestampedHistory, find_returns_bracketing_ages)
+{
+    TimestampedHistory<Sample, 8> history;
+    push(history, 1000, 1);
+    push(history, 2000, 2);
+    push(history, 3000, 3);
+    push(history, 4000, 4);
+
+    int older;
+    float t;
+    ASSERT_TRUE(history.find(2500, older, t));
+    EXPECT_EQ(2, older);
+    EXPECT_FLOAT_EQ(0.5f, t);
+    EXPECT_EQ(2, history.at(older).value);
+
+    ASSERT_TRUE(history.find(1000, older, t));
+    EXPECT_EQ(3, older);
+    EXPECT_FLOAT_EQ(0, t);
+
+    ASSERT_TRUE(history.find(5000, older, t));
+    EXPECT_EQ(0, older);
+    EXPECT_FLOAT_EQ(0, t);
+
+    EXPECT_FALSE(history.find(999, older, t));
+}
+
+TEST(TimestampedHistory, push_when_full_overwrites_oldest)
+{
+    TimestampedHistory<Sample, 4> history;
+    for (int i = 1; i <= 6; i++)
+    {
+        push(history, i * 1000, i);
+    }
+
+    EXPECT_EQ(4, history.size());
+    EXPECT_EQ(3000, history.getOldestTime());
+    EXPECT_EQ(6000, history.getNewestTime());
+    EXPECT_EQ(3, history.at(3).value);
+
+    int older;
+    float t;
+    EXPECT_FALSE(history.find(2500, older, t));
+    ASSERT_TRUE(history.find(3500, older, t));
+    EXPECT_EQ(3, older);
+}
+
+TEST(TimestampedHistory, push_not_after_newest_replaces_newest)
+{
+    TimestampedHistory<Sample, 4> history;
+    push(history, 1000, 1);
+    push(history, 2000, 2);
+    push(history, 2000, 3);
+    push(history, 1500, 4);
+
+    EXPECT_EQ(2, history.size());
+    EXPECT_EQ(1500, history.getNewestTime());
+    EXPECT_EQ(4, history.at(0).value);
+}
+
+TEST(TimestampedHistory, find_across_clock_wrap)
+{
+    TimestampedHistory<Sample, 4> history;
+    push(history, UINT32_MAX - 999, 1);
+    push(history, 1000, 2);
+
+    int older;
+    float t;
+    ASSERT_TRUE(history.find(0, older, t));
+    EXPECT_EQ(1, older);
+    EXPECT_NEAR(0.5f, t, 1E-3);
+    EXPECT_FALSE(history.find(UINT32_MAX - 1000, older, t));
+}
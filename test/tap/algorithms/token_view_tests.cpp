@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/token_view.hpp"
+
+using namespace tap::algorithms;
+
+enum class Color
+{
+    RED,
+    GREEN,
+};
+
+static constexpr TokenTableEntry<Color> COLORS[] = {{"red", Color::RED}, {"green", Color::GREEN}};
+
+TEST(TokenView, next_splits_on_spaces_and_tabs_in_place)
+{
+    char line[] = "  foo\tbar  baz ";
+    TokenView tokens(line);
+
+    const char *foo = tokens.next();
+    EXPECT_STREQ("foo", foo);
+    EXPECT_EQ(line + 2, foo);
+    EXPECT_STREQ("bar", tokens.next());
+    EXPECT_STREQ("baz", tokens.next());
+    EXPECT_EQ(nullptr, tokens.next());
+    EXPECT_TRUE(tokens.empty());
+}
+
+TEST(TokenView, empty_line_has_no_tokens)
+{
+    char line[] = " \t ";
+    TokenView tokens(line);
+
+    EXPECT_TRUE(tokens.empty());
+    EXPECT_EQ(nullptr, tokens.next());
+    EXPECT_STREQ("", tokens.last());
+}
+
+TEST(TokenView, nextIs_consumes_only_whole_matching_token)
+{
+    char line[] = "motors motor 1";
+    TokenView tokens(line);
+
+    EXPECT_FALSE(tokens.nextIs("motor"));
+    EXPECT_TRUE(tokens.nextIs("motors"));
+    EXPECT_FALSE(tokens.nextIs("motors"));
+    EXPECT_TRUE(tokens.nextIs("motor"));
+    EXPECT_STREQ("1", tokens.rest());
+}
+
+TEST(TokenView, nextInt_parses_whole_token_only)
+{
+    char line[] = "42 -7 12abc";
+    TokenView tokens(line);
+    int32_t value = 0;
+
+    EXPECT_TRUE(tokens.nextInt(value));
+    EXPECT_EQ(42, value);
+    EXPECT_TRUE(tokens.nextInt(value));
+    EXPECT_EQ(-7, value);
+    EXPECT_FALSE(tokens.nextInt(value));
+    EXPECT_STREQ("12abc", tokens.last());
+    EXPECT_EQ(-7, value);
+    EXPECT_FALSE(tokens.nextInt(value));
+}
+
+TEST(TokenView, nextFloat_parses_whole_token_only)
+{
+    char line[] = "1.5 -2e3 x";
+    TokenView tokens(line);
+    float value = 0;
+
+    EXPECT_TRUE(tokens.nextFloat(value));
+    EXPECT_FLOAT_EQ(1.5f, value);
+    EXPECT_TRUE(tokens.nextFloat(value));
+    EXPECT_FLOAT_EQ(-2000.0f, value);
+    EXPECT_FALSE(tokens.nextFloat(value));
+}
+
+TEST(TokenView, nextIn_looks_up_token_in_table)
+{
+    char line[] = "green blue";
+    TokenView tokens(line);
+    Color color = Color::RED;
+
+    EXPECT_TRUE(tokens.nextIn(COLORS, color));
+    EXPECT_EQ(Color::GREEN, color);
+    EXPECT_FALSE(tokens.nextIn(COLORS, color));
+    EXPECT_STREQ("blue", tokens.last());
+    EXPECT_FALSE(tokens.nextIn(COLORS, color));
+}
+
+TEST(TokenView, rest_returns_untokenized_line)
+{
+    char line[] = "header  -S arg1 arg2";
+    TokenView tokens(line);
+
+    tokens.next();
+    EXPECT_TRUE(tokens.nextIs("-S"));
+    EXPECT_STREQ("arg1 arg2", tokens.rest());
+}
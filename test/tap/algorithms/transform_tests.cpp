@@ -217,3 +217,84 @@ TEST(Transform, transform_compose_with_inverse_yields_identity)
     EXPECT_NEAR(identity.getRotation().pitch(), composed.getRotation().pitch(), 1E-5);
     EXPECT_NEAR(identity.getRotation().yaw(), composed.getRotation().yaw(), 1E-5);
 }
+
+TEST(Transform, apply_position_array_matches_apply_each_position)
+{
+    // Given
+    Transform transform(1.0, -2.0, 0.5, M_SQRT2, -1.0, M_2_PI);
+    Position positions[] = {Position(1.0, 2.0, 3.0), Position(-4.0, 0.5, 0.0)};
+    Position out[] = {Position(0.0, 0.0, 0.0), Position(0.0, 0.0, 0.0)};
+
+    // When
+    transform.apply(positions, out, 2);
+
+    // Then
+    for (int i = 0; i < 2; i++)
+    {
+        Position expected = transform.apply(positions[i]);
+        EXPECT_NEAR(expected.x(), out[i].x(), 1E-5);
+        EXPECT_NEAR(expected.y(), out[i].y(), 1E-5);
+        EXPECT_NEAR(expected.z(), out[i].z(), 1E-5);
+    }
+}
+
+TEST(Transform, apply_vector_array_in_place_matches_apply_each_vector)
+{
+    // Given
+    Transform transform(1.0, -2.0, 0.5, M_SQRT2, -1.0, M_2_PI);
+    Vector vectors[] = {Vector(1.0, 2.0, 3.0), Vector(-4.0, 0.5, 0.0)};
+    Vector expected[] = {transform.apply(vectors[0]), transform.apply(vectors[1])};
+
+    // When
+    transform.apply(vectors, vectors, 2);
+
+    // Then
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_NEAR(expected[i].x(), vectors[i].x(), 1E-5);
+        EXPECT_NEAR(expected[i].y(), vectors[i].y(), 1E-5);
+        EXPECT_NEAR(expected[i].z(), vectors[i].z(), 1E-5);
+    }
+}
+
+TEST(Transform, applyToPositions_matches_apply_each_position)
+{
+    // Given
+    Transform transform(1.0, -2.0, 0.5, M_SQRT2, -1.0, M_2_PI);
+    // x-components, then y-components, then z-components
+    float positions[3 * 3] = {1.0, -4.0, 0.0, 2.0, 0.5, 7.0, 3.0, 0.0, -1.0};
+    float out[3 * 3];
+
+    // When
+    transform.applyToPositions(positions, out, 3);
+
+    // Then
+    for (int i = 0; i < 3; i++)
+    {
+        Position expected =
+            transform.apply(Position(positions[i], positions[3 + i], positions[6 + i]));
+        EXPECT_NEAR(expected.x(), out[i], 1E-5);
+        EXPECT_NEAR(expected.y(), out[3 + i], 1E-5);
+        EXPECT_NEAR(expected.z(), out[6 + i], 1E-5);
+    }
+}
+
+TEST(Transform, applyToVectors_matches_apply_each_vector)
+{
+    // Given
+    Transform transform(1.0, -2.0, 0.5, M_SQRT2, -1.0, M_2_PI);
+    float vectors[3 * 2] = {1.0, -4.0, 2.0, 0.5, 3.0, 0.0};
+    float out[3 * 2];
+
+    // When
+    transform.applyToVectors(vectors, out, 2);
+
+    // Then
+    for (int i = 0; i < 2; i++)
+    {
+        Vector expected = transform.apply(Vector(vectors[i], vectors[2 + i], vectors[4 + i]));
+        EXPECT_NEAR(expected.x(), out[i], 1E-5);
+        EXPECT_NEAR(expected.y(), out[2 + i], 1E-5);
+        EXPECT_NEAR(expected.z(), out[4 + i], 1E-5);
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/transforms/transform_tree.hpp"
+
+using namespace tap::algorithms::transforms;
+
+static void expectSamePosition(const Position &expected, const Position &actual)
+{
+    EXPECT_NEAR(expected.x(), actual.x(), 1E-5);
+    EXPECT_NEAR(expected.y(), actual.y(), 1E-5);
+    EXPECT_NEAR(expected.z(), actual.z(), 1E-5);
+}
+
+class TransformTreeTest : public testing::Test
+{
+protected:
+    TransformTreeTest()
+        : tree("world"),
+          chassis(tree.addFrame("chassis", TransformTree<8>::ROOT, Transform(1, 2, 0, 0, 0, 0.5f))),
+          turretYaw(tree.addFrame("turret yaw", chassis, Transform(0.1f, 0, 0.3f, 0, 0, 0.2f))),
+          turretPitch(tree.addFrame("turret pitch", turretYaw, Transform(0, 0, 0.1f, 0, -0.3f, 0))),
+          camera(tree.addFrame("camera", turretPitch, Transform(0.05f, 0, 0.02f, 0, 0, 0)))
+    {
+    }
+
+    /// The transform from the world to the camera, composed edge by edge.
+    Transform composeWorldToCamera()
+    {
+        return tree.getParentTransform(chassis)
+            .compose(tree.getParentTransform(turretYaw))
+            .compose(tree.getParentTransform(turretPitch))
+            .compose(tree.getParentTransform(camera));
+    }
+
+    TransformTree<8> tree;
+    int chassis;
+    int turretYaw;
+    int turretPitch;
+    int camera;
+};
+
+TEST_F(TransformTreeTest, addFrame_returns_consecutive_indices)
+{
+    EXPECT_EQ(1, chassis);
+    EXPECT_EQ(2, turretYaw);
+    EXPECT_EQ(3, turretPitch);
+    EXPECT_EQ(4, camera);
+    EXPECT_EQ(5, tree.size());
+}
+
+TEST_F(TransformTreeTest, addFrame_with_missing_parent_fails)
+{
+    EXPECT_EQ(-1, tree.addFrame("orphan", 7, Transform::identity()));
+    EXPECT_EQ(-1, tree.addFrame("orphan", -1, Transform::identity()));
+}
+
+TEST(TransformTree, addFrame_when_full_fails)
+{
+    TransformTree<2> tree("world");
+
+    EXPECT_EQ(1, tree.addFrame("chassis", 0, Transform::identity()));
+    EXPECT_EQ(-1, tree.addFrame("turret", 1, Transform::identity()));
+}
+
+TEST_F(TransformTreeTest, findFrame_by_name)
+{
+    EXPECT_EQ(0, tree.findFrame("world"));
+    EXPECT_EQ(camera, tree.findFrame("camera"));
+    EXPECT_EQ(-1, tree.findFrame("gimbal"));
+    EXPECT_STREQ("turret yaw", tree.getName(turretYaw));
+}
+
+TEST_F(TransformTreeTest, transform_from_root_matches_composed_edges)
+{
+    Position point(3, -1, 0.5f);
+
+    expectSamePosition(
+        composeWorldToCamera().apply(point),
+        tree.getTransformFromRoot(camera).apply(point));
+}
+
+TEST_F(TransformTreeTest, transform_to_root_inverts_transform_from_root)
+{
+    Position point(3, -1, 0.5f);
+
+    Position inCamera = tree.getTransformFromRoot(camera).apply(point);
+
+    expectSamePosition(point, tree.getTransformToRoot(camera).apply(inCamera));
+}
+
+TEST_F(TransformTreeTest, updating_edge_updates_frames_below)
+{
+    Position point(3, -1, 0.5f);
+    tree.getTransformFromRoot(camera);
+
+    tree.updateRotation(turretYaw, 0, 0, 1.2f);
+    tree.updateTranslation(chassis, 4, 5, 0);
+
+    expectSamePosition(
+        composeWorldToCamera().apply(point),
+        tree.getTransformFromRoot(camera).apply(point));
+    expectSamePosition(
+        composeWorldToCamera().getInverse().apply(point),
+        tree.getTransformToRoot(camera).apply(point));
+}
+
+TEST_F(TransformTreeTest, updating_edge_below_frame_leaves_frame_unchanged)
+{
+    Position point(3, -1, 0.5f);
+    Position before = tree.getTransformFromRoot(turretYaw).apply(point);
+
+    tree.updateRotation(camera, 0.5f, 0, 0);
+
+    expectSamePosition(before, tree.getTransformFromRoot(turretYaw).apply(point));
+}
+
+TEST_F(TransformTreeTest, repeated_queries_return_cached_transform)
+{
+    const Transform &first = tree.getTransformFromRoot(camera);
+    const Transform &second = tree.getTransformFromRoot(camera);
+
+    EXPECT_EQ(&first, &second);
+}
+
+TEST_F(TransformTreeTest, transform_between_frames_maps_positions)
+{
+    int gun = tree.addFrame("gun", turretPitch, Transform(0.2f, 0, 0, 0, 0, 0));
+    Position point(3, -1, 0.5f);
+
+    Position inCamera = tree.getTransformFromRoot(camera).apply(point);
+    Position inGun = tree.getTransformFromRoot(gun).apply(point);
+
+    expectSamePosition(inGun, tree.getTransform(camera, gun).apply(inCamera));
+    expectSamePosition(inCamera, tree.getTransform(gun, camera).apply(inGun));
+    expectSamePosition(inCamera, tree.getTransform(TransformTree<8>::ROOT, camera).apply(point));
+    expectSamePosition(point, tree.getTransform(camera, TransformTree<8>::ROOT).apply(inCamera));
+}
+
+TEST_F(TransformTreeTest, updating_root_ignored)
+{
+    tree.updateTranslation(TransformTree<8>::ROOT, 1, 1, 1);
+
+    expectSamePosition(
+        Position(1, 2, 3),
+        tree.getTransformFromRoot(TransformTree<8>::ROOT).apply(Position(1, 2, 3)));
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/kalman_filter.hpp"
+#include "tap/algorithms/unscented_kalman_filter.hpp"
+
+using namespace tap::algorithms;
+
+// Constant velocity model, measuring position and velocity
+static constexpr float A[] = {1, 0.01f, 0, 1};
+static constexpr float C[] = {1, 0, 0, 1};
+static constexpr float Q[] = {1E-4f, 0, 0, 1E-3f};
+static constexpr float R[] = {0.5f, 0, 0, 2};
+static constexpr float P0[] = {1, 0, 0, 1};
+
+static void constantVelocity(const float (&x)[2], float dt, float (&out)[2])
+{
+    out[0] = x[0] + dt * x[1];
+    out[1] = x[1];
+}
+
+static void measureBoth(const float (&x)[2], float (&out)[2])
+{
+    out[0] = x[0];
+    out[1] = x[1];
+}
+
+TEST(UnscentedKalmanFilter, update_before_init_does_nothing)
+{
+    UnscentedKalmanFilter<2, 2> ukf(constantVelocity, measureBoth, Q, R, P0);
+
+    ukf.performUpdate(0.01f, CMSISMat<2, 1>({10, 10}));
+
+    EXPECT_FLOAT_EQ(0, ukf.getStateVectorAsMatrix()[0]);
+    EXPECT_FLOAT_EQ(0, ukf.getStateVectorAsMatrix()[1]);
+}
+
+TEST(UnscentedKalmanFilter, linear_model_matches_kalman_filter)
+{
+    KalmanFilter<2, 2> kf(A, C, Q, R, P0);
+    UnscentedKalmanFilter<2, 2> ukf(constantVelocity, measureBoth, Q, R, P0);
+    kf.init({0, 0});
+    ukf.init({0, 0});
+
+    for (int i = 0; i < 100; i++)
+    {
+        CMSISMat<2, 1> y({i * 0.01f, 1.0f + (i % 3) * 0.1f});
+        kf.performUpdate(y);
+        ukf.performUpdate(0.01f, y);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_NEAR(kf.getStateVectorAsMatrix()[i], ukf.getStateVectorAsMatrix()[i], 1E-4);
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(kf.getErrorCovariance()[i], ukf.getErrorCovariance()[i], 1E-5);
+    }
+}
+
+/// Stationary target at (x, y), measured as range and bearing from the origin.
+static void stationary(const float (&x)[2], float, float (&out)[2])
+{
+    out[0] = x[0];
+    out[1] = x[1];
+}
+
+static void rangeBearing(const float (&x)[2], float (&out)[2])
+{
+    out[0] = hypotf(x[0], x[1]);
+    out[1] = atan2f(x[1], x[0]);
+}
+
+TEST(UnscentedKalmanFilter, nonlinear_measurement_converges)
+{
+    static constexpr float noQ[] = {0, 0, 0, 0};
+    static constexpr float rangeBearingR[] = {0.01f, 0, 0, 1E-3f};
+    static constexpr float wideP0[] = {4, 0, 0, 4};
+    UnscentedKalmanFilter<2, 2> ukf(stationary, rangeBearing, noQ, rangeBearingR, wideP0);
+    ukf.setAngularMeasurements(0b10);
+    ukf.init({1, 1});
+
+    for (int i = 0; i < 50; i++)
+    {
+        ukf.performUpdate(0.01f, CMSISMat<2, 1>({5, atan2f(4, 3)}));
+    }
+
+    EXPECT_NEAR(3, ukf.getStateVectorAsMatrix()[0], 0.05f);
+    EXPECT_NEAR(4, ukf.getStateVectorAsMatrix()[1], 0.05f);
+}
+
+static void measureYaw(const float (&x)[2], float (&out)[1]) { out[0] = x[0]; }
+
+TEST(UnscentedKalmanFilter, angular_state_wraps_across_pi)
+{
+    static constexpr float yawR[] = {1E-3f};
+    UnscentedKalmanFilter<2, 1> ukf(constantVelocity, measureYaw, Q, yawR, P0);
+    ukf.setAngularStates(0b01);
+    ukf.setAngularMeasurements(0b1);
+    ukf.init({3.0f, 1.0f});
+
+    // Spin at 1 rad/s through pi for 0.5 s
+    float yaw = 3.0f;
+    for (int i = 0; i < 50; i++)
+    {
+        yaw += 0.01f;
+        ukf.performUpdate(0.01f, CMSISMat<1, 1>({yaw > M_PI ? yaw - 2 * float(M_PI) : yaw}));
+    }
+
+    EXPECT_NEAR(3.5f - 2 * M_PI, ukf.getStateVectorAsMatrix()[0], 0.01f);
+    EXPECT_NEAR(1, ukf.getStateVectorAsMatrix()[1], 0.05f);
+}
+
+TEST(UnscentedKalmanFilter, repeated_correct_keeps_shrinking_covariance)
+{
+    UnscentedKalmanFilter<2, 2> ukf(constantVelocity, measureBoth, Q, R, P0);
+    ukf.init({0, 0});
+
+    ukf.predict(0.01f);
+    ukf.correct(CMSISMat<2, 1>({1, 1}));
+    const float afterOne = ukf.getErrorCovariance()[0];
+    ukf.correct(CMSISMat<2, 1>({1, 1}));
+
+    EXPECT_LT(ukf.getErrorCovariance()[0], afterOne);
+    EXPECT_GT(ukf.getStateVectorAsMatrix()[0], 0);
+}
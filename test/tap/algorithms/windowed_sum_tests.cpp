@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/windowed_sum.hpp"
+
+using namespace tap::algorithms;
+
+TEST(WindowedSum, sum_of_values_added_within_window)
+{
+    WindowedSum<int, 8> sum(1000);
+
+    sum.add(10, 0);
+    sum.add(5, 400);
+    sum.add(20, 1000);
+
+    EXPECT_EQ(35, sum.getSum());
+    EXPECT_EQ(3u, sum.getSize());
+}
+
+TEST(WindowedSum, values_expire_after_window)
+{
+    WindowedSum<int, 8> sum(1000);
+    sum.add(10, 0);
+    sum.add(5, 400);
+
+    EXPECT_FALSE(sum.update(1000));
+    EXPECT_EQ(15, sum.getSum());
+
+    EXPECT_TRUE(sum.update(1001));
+    EXPECT_EQ(5, sum.getSum());
+
+    sum.update(1401);
+    EXPECT_EQ(0, sum.getSum());
+    EXPECT_TRUE(sum.isEmpty());
+}
+
+TEST(WindowedSum, add_expires_old_values)
+{
+    WindowedSum<int, 8> sum(100);
+    sum.add(10, 0);
+
+    sum.add(3, 500);
+
+    EXPECT_EQ(3, sum.getSum());
+    EXPECT_EQ(1u, sum.getSize());
+}
+
+TEST(WindowedSum, full_ring_merges_into_newest_sample)
+{
+    WindowedSum<int, 2> sum(1000);
+    sum.add(1, 0);
+    sum.add(2, 100);
+
+    sum.add(4, 200);
+
+    EXPECT_EQ(7, sum.getSum());
+    EXPECT_EQ(2u, sum.getSize());
+
+    // The merged sample expires with the newest value
+    sum.update(1001);
+    EXPECT_EQ(6, sum.getSum());
+    sum.update(1201);
+    EXPECT_EQ(0, sum.getSum());
+}
+
+TEST(WindowedSum, ring_wraps_around)
+{
+    WindowedSum<int, 4> sum(10);
+
+    for (int i = 0; i < 100; i++)
+    {
+        sum.add(1, i * 5);
+    }
+
+    // values added at 485, 490 and 495 are within 10 ms of 495
+    EXPECT_EQ(3, sum.getSum());
+}
+
+TEST(WindowedSum, works_across_time_wrap)
+{
+    WindowedSum<int, 4> sum(100);
+    sum.add(1, UINT32_MAX - 10);
+
+    sum.add(2, 50);
+    EXPECT_EQ(3, sum.getSum());
+
+    sum.update(90);
+    EXPECT_EQ(2, sum.getSum());
+}
+
+TEST(WindowedSum, getRatePerSecond_scales_sum_by_window)
+{
+    WindowedSum<float, 4> sum(500);
+
+    sum.add(2.5f, 0);
+    sum.add(2.5f, 100);
+
+    EXPECT_FLOAT_EQ(10.0f, sum.getRatePerSecond());
+}
+
+TEST(WindowedSum, clear_removes_all_values)
+{
+    WindowedSum<int, 4> sum(100);
+    sum.add(1, 0);
+
+    sum.clear();
+
+    EXPECT_EQ(0, sum.getSum());
+    EXPECT_TRUE(sum.isEmpty());
+}
@@ -17,6 +17,9 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "tap/algorithms/wrapped_float.hpp"
@@ -251,3 +254,71 @@ TEST(WrappedFloat, rangeOverlap)
             WrappedFloat(30, 0, 100),
             WrappedFloat(60, 0, 100)));
 }
+
+/// The wrapping WrappedFloat did before its fast paths, for comparison.
+static void referenceWrap(float value, float lower, float upper, float *wrapped, int *revolutions)
+{
+    *wrapped = value;
+    *revolutions = 0;
+    if (value < lower)
+    {
+        *wrapped = upper + fmodf(value - upper, upper - lower);
+    }
+    else if (value >= upper)
+    {
+        *wrapped = lower + fmodf(value - lower, upper - lower);
+    }
+    *revolutions += floor((value - lower) / (upper - lower));
+}
+
+static void expectWrapsLikeReference(float value, float lower, float upper)
+{
+    float expectedWrapped;
+    int expectedRevolutions;
+    referenceWrap(value, lower, upper, &expectedWrapped, &expectedRevolutions);
+
+    WrappedFloat actual(value, lower, upper);
+    const float actualWrapped = actual.getWrappedValue();
+
+    // Bitwise, so the fast paths can't even differ in the sign of a zero
+    EXPECT_EQ(0, memcmp(&expectedWrapped, &actualWrapped, sizeof(float)))
+        << value << " in [" << lower << ", " << upper << ")";
+    EXPECT_EQ(expectedRevolutions, actual.getRevolutions())
+        << value << " in [" << lower << ", " << upper << ")";
+}
+
+TEST(WrappedFloat, wrapping_is_identical_to_fmodf)
+{
+    const float bounds[][2] = {
+        {0, 10},
+        {0, static_cast<float>(M_TWOPI)},
+        {static_cast<float>(-M_PI), static_cast<float>(M_PI)},
+        {-180, 180},
+        {0.1f, 0.3f},
+        {1000, 1000.5f},
+    };
+    std::mt19937 gen(49);
+
+    for (const auto &b : bounds)
+    {
+        const float lower = b[0];
+        const float upper = b[1];
+        const float interval = upper - lower;
+
+        // Around every multiple of the interval that the fast paths and fmodf treat differently
+        for (int k = -3; k <= 4; k++)
+        {
+            float value = lower + k * interval;
+            for (float v : {value, nextafterf(value, -INFINITY), nextafterf(value, INFINITY)})
+            {
+                expectWrapsLikeReference(v, lower, upper);
+            }
+        }
+
+        std::uniform_real_distribution<float> dist(lower - 5 * interval, upper + 5 * interval);
+        for (int i = 0; i < 10'000; i++)
+        {
+            expectWrapsLikeReference(dist(gen), lower, upper);
+        }
+    }
+}
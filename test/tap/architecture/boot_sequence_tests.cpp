@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/boot_sequence.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::arch;
+using namespace testing;
+
+/// A step that waits for `duration` ms from when it is first called, like a peripheral reset.
+struct WaitStep
+{
+    uint32_t duration;
+    bool waiting = false;
+    uint32_t doneTime = 0;
+
+    static bool run(void *context)
+    {
+        auto *step = static_cast<WaitStep *>(context);
+        if (!step->waiting)
+        {
+            step->waiting = true;
+            step->doneTime = clock::getTimeMilliseconds() + step->duration;
+        }
+        return clock::getTimeMilliseconds() >= step->doneTime;
+    }
+};
+
+class BootSequenceTest : public Test
+{
+protected:
+    BootSequenceTest() : terminalDevice(nullptr), stream(terminalDevice) {}
+
+    /// Updates the sequence once per ms until it is done, returning the time it took.
+    uint32_t runToCompletion()
+    {
+        uint32_t start = clock.time;
+        while (!boot.update())
+        {
+            clock.time++;
+        }
+        return clock.time - start;
+    }
+
+    static void order(void *context) { calls.push_back(static_cast<const char *>(context)); }
+
+    static void noop(void *) {}
+
+    static inline std::vector<std::string> calls;
+
+    void SetUp() override { calls.clear(); }
+
+    clock::ClockStub clock;
+    BootSequence boot;
+    tap::stub::TerminalDeviceStub terminalDevice;
+    modm::IOStream stream;
+};
+
+TEST_F(BootSequenceTest, independent_steps_run_concurrently)
+{
+    WaitStep imu{100}, display{20}, fs{50};
+    boot.addStep("imu", WaitStep::run, &imu);
+    boot.addStep("display", WaitStep::run, &display);
+    boot.addStep("fs", WaitStep::run, &fs);
+
+    EXPECT_EQ(100u, runToCompletion());
+    EXPECT_EQ(20u, boot.getStepStats(1).endTime);
+    EXPECT_EQ(50u, boot.getStepStats(2).endTime);
+    EXPECT_EQ(100u, boot.getElapsedTime());
+}
+
+TEST_F(BootSequenceTest, step_starts_after_dependencies_are_done)
+{
+    WaitStep reset{30}, configure{10}, other{5};
+    int resetId = boot.addStep("reset", WaitStep::run, &reset);
+    boot.addStep("configure", WaitStep::run, &configure, {resetId});
+    boot.addStep("other", WaitStep::run, &other);
+
+    EXPECT_EQ(40u, runToCompletion());
+    EXPECT_EQ(30u, boot.getStepStats(1).startTime);
+    EXPECT_EQ(40u, boot.getStepStats(1).endTime);
+    EXPECT_EQ(0u, boot.getStepStats(2).startTime);
+}
+
+TEST_F(BootSequenceTest, blocking_steps_are_called_once_in_dependency_order)
+{
+    int can = boot.addBlockingStep("can", order, const_cast<char *>("can"));
+    int motors = boot.addBlockingStep("motors", order, const_cast<char *>("motors"), {can});
+    boot.addBlockingStep("scheduler", order, const_cast<char *>("scheduler"), {motors, can});
+
+    // A step is run in the same update its dependencies finish in if it comes after them
+    EXPECT_TRUE(boot.update());
+    EXPECT_THAT(calls, ElementsAre("can", "motors", "scheduler"));
+    EXPECT_EQ(1u, boot.getStepStats(0).calls);
+}
+
+TEST_F(BootSequenceTest, invalid_steps_are_not_added)
+{
+    int first = boot.addBlockingStep("first", noop, nullptr);
+
+    EXPECT_EQ(BootSequence::INVALID_STEP_ID, boot.addBlockingStep("a", noop, nullptr, {1}));
+    EXPECT_EQ(BootSequence::INVALID_STEP_ID, boot.addBlockingStep("b", noop, nullptr, {-1}));
+
+    boot.update();
+    EXPECT_EQ(BootSequence::INVALID_STEP_ID, boot.addBlockingStep("c", noop, nullptr, {first}));
+    EXPECT_EQ(1, boot.getNumSteps());
+}
+
+TEST_F(BootSequenceTest, max_steps)
+{
+    for (int i = 0; i < BootSequence::MAX_STEPS; i++)
+    {
+        EXPECT_EQ(i, boot.addBlockingStep("step", noop, nullptr));
+    }
+    EXPECT_EQ(BootSequence::INVALID_STEP_ID, boot.addBlockingStep("step", noop, nullptr));
+}
+
+TEST_F(BootSequenceTest, empty_sequence_is_done)
+{
+    EXPECT_TRUE(boot.update());
+    EXPECT_EQ(0u, boot.getElapsedTime());
+}
+
+TEST_F(BootSequenceTest, busy_time_counts_time_in_step)
+{
+    boot.addBlockingStep(
+        "slow",
+        [](void *context) { static_cast<clock::ClockStub *>(context)->time += 7; },
+        &clock);
+
+    boot.update();
+
+    EXPECT_EQ(7'000u, boot.getStepStats(0).busyTime);
+    EXPECT_EQ(7u, boot.getStepStats(0).endTime);
+}
+
+TEST_F(BootSequenceTest, printReport_marks_unfinished_steps)
+{
+    WaitStep done{0}, stuck{1'000};
+    int doneId = boot.addStep("done", WaitStep::run, &done);
+    boot.addStep("stuck", WaitStep::run, &stuck);
+    boot.addStep("blocked", WaitStep::run, &done, {doneId + 1});
+    boot.update();
+    clock.time = 12;
+
+    boot.printReport(stream);
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("Boot not done in 12 ms"));
+    EXPECT_THAT(output, HasSubstr(" done: 0-0, 0, 1\n"));
+    EXPECT_THAT(output, HasSubstr(" stuck: 0-?, 0, 1\n"));
+    EXPECT_THAT(output, HasSubstr(" blocked: not started\n"));
+}
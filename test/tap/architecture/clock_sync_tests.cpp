@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/clock_sync.hpp"
+
+using namespace tap::arch;
+
+class ClockSyncTest : public testing::Test
+{
+protected:
+    static constexpr int64_t HOST_OFFSET_US = 5'000'000'000;
+    static constexpr double HOST_DRIFT = -50e-6;
+
+    static uint64_t hostTimeUs(uint64_t localTimeUs)
+    {
+        return HOST_OFFSET_US + static_cast<uint64_t>(localTimeUs * (1 + HOST_DRIFT));
+    }
+
+    /// Exchanges at `clock.time`, with the request taking `requestUs` and the reply `replyUs`.
+    bool exchange(ClockSync &sync, uint32_t requestUs, uint32_t replyUs)
+    {
+        const uint64_t localSend = clock.time * 1'000ull;
+        const uint64_t hostTime = hostTimeUs(localSend + requestUs);
+        return sync.addExchange(localSend, hostTime, hostTime, localSend + requestUs + replyUs);
+    }
+
+    clock::ClockStub clock;
+};
+
+TEST_F(ClockSyncTest, not_synced_before_two_exchanges)
+{
+    ClockSync sync;
+    EXPECT_FALSE(sync.isSynced());
+
+    clock.time = 100;
+    exchange(sync, 200, 200);
+    EXPECT_FALSE(sync.isSynced());
+
+    clock.time = 200;
+    exchange(sync, 200, 200);
+    EXPECT_TRUE(sync.isSynced());
+}
+
+TEST_F(ClockSyncTest, tracks_host_offset_and_drift)
+{
+    ClockSync sync;
+
+    for (int i = 1; i <= 200; i++)
+    {
+        clock.time = 100 * i;
+        EXPECT_TRUE(exchange(sync, 300, 300));
+    }
+
+    EXPECT_EQ(600u, sync.getRoundTripTimeUs());
+    EXPECT_NEAR(-50, sync.getDriftPpm(), 1);
+
+    // Extrapolated half a second past the last exchange
+    const uint64_t later = clock.time * 1'000ull + 500'000;
+    EXPECT_NEAR(0, static_cast<int64_t>(sync.localToHostUs(later) - hostTimeUs(later)), 5);
+    EXPECT_NEAR(0, static_cast<int64_t>(sync.hostToLocalUs(hostTimeUs(later)) - later), 5);
+}
+
+TEST_F(ClockSyncTest, asymmetric_trip_error_within_half_round_trip)
+{
+    ClockSync sync;
+
+    for (int i = 1; i <= 50; i++)
+    {
+        clock.time = 100 * i;
+        exchange(sync, 100, 700);
+    }
+
+    const uint64_t now = clock.time * 1'000ull;
+    const int64_t error = static_cast<int64_t>(sync.localToHostUs(now) - hostTimeUs(now));
+    EXPECT_LE(std::abs(error), 400);
+}
+
+TEST_F(ClockSyncTest, exchange_with_long_round_trip_rejected)
+{
+    ClockSyncConfig config;
+    config.maxRoundTripUs = 1'000;
+    ClockSync sync(config);
+
+    clock.time = 100;
+    EXPECT_FALSE(exchange(sync, 600, 600));
+
+    EXPECT_EQ(1u, sync.getNumRejectedExchanges());
+    EXPECT_EQ(0, sync.getOffsetUs());
+}
+
+TEST_F(ClockSyncTest, not_synced_after_timeout_or_reset)
+{
+    ClockSyncConfig config;
+    config.syncTimeoutMs = 500;
+    ClockSync sync(config);
+    for (int i = 1; i <= 2; i++)
+    {
+        clock.time = 100 * i;
+        exchange(sync, 200, 200);
+    }
+    EXPECT_TRUE(sync.isSynced());
+
+    clock.time += 501;
+    EXPECT_FALSE(sync.isSynced());
+
+    clock.time = 1'000;
+    exchange(sync, 200, 200);
+    EXPECT_TRUE(sync.isSynced());
+
+    sync.reset();
+    EXPECT_FALSE(sync.isSynced());
+}
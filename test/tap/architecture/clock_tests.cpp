@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/periodic_timer.hpp"
+#include "tap/architecture/timeout.hpp"
+
+using namespace tap::arch;
+
+class VirtualClockTest : public testing::Test
+{
+protected:
+    void TearDown() override { clock::disableVirtualTime(); }
+};
+
+TEST_F(VirtualClockTest, time_is_zero_when_virtual_time_disabled)
+{
+    clock::advance(1'000);
+
+    EXPECT_FALSE(clock::isVirtualTimeEnabled());
+    EXPECT_EQ(0u, clock::getTimeMicroseconds());
+    EXPECT_EQ(0u, clock::getTimeMilliseconds());
+}
+
+TEST_F(VirtualClockTest, advance_moves_virtual_time_forward)
+{
+    clock::enableVirtualTime(500);
+
+    EXPECT_TRUE(clock::isVirtualTimeEnabled());
+    EXPECT_EQ(500u, clock::getTimeMicroseconds());
+    EXPECT_EQ(0u, clock::getTimeMilliseconds());
+
+    clock::advance(1'500);
+
+    EXPECT_EQ(2'000u, clock::getTimeMicroseconds());
+    EXPECT_EQ(2u, clock::getTimeMilliseconds());
+    EXPECT_EQ(2'000u, clock::getVirtualTimeMicroseconds());
+}
+
+TEST_F(VirtualClockTest, virtual_time_does_not_wrap)
+{
+    clock::enableVirtualTime(UINT32_MAX);
+    clock::advance(1);
+
+    EXPECT_EQ(static_cast<uint64_t>(UINT32_MAX) + 1, clock::getVirtualTimeMicroseconds());
+    EXPECT_EQ(0u, clock::getTimeMicroseconds());
+}
+
+TEST_F(VirtualClockTest, clock_stub_takes_precedence_over_virtual_time)
+{
+    clock::enableVirtualTime(10'000);
+
+    {
+        clock::ClockStub clock;
+        clock.time = 3;
+
+        EXPECT_EQ(3u, clock::getTimeMilliseconds());
+        EXPECT_EQ(3'000u, clock::getTimeMicroseconds());
+    }
+
+    EXPECT_EQ(10u, clock::getTimeMilliseconds());
+}
+
+TEST_F(VirtualClockTest, timeout_expires_after_virtual_time_advanced)
+{
+    clock::enableVirtualTime();
+    MilliTimeout timeout(10);
+
+    clock::advance(9'999);
+    EXPECT_FALSE(timeout.isExpired());
+
+    clock::advance(1);
+    EXPECT_TRUE(timeout.isExpired());
+}
+
+static void countCall(void *context) { (*static_cast<int *>(context))++; }
+
+TEST_F(VirtualClockTest, runAsFastAsPossible_calls_function_each_period)
+{
+    int calls = 0;
+
+    EXPECT_EQ(1'000u, clock::runAsFastAsPossible(countCall, &calls, 1'000, 1'000'000));
+
+    EXPECT_TRUE(clock::isVirtualTimeEnabled());
+    EXPECT_EQ(1'000, calls);
+    EXPECT_EQ(1'000'000u, clock::getVirtualTimeMicroseconds());
+}
+
+TEST_F(VirtualClockTest, runAsFastAsPossible_continues_from_current_virtual_time)
+{
+    int calls = 0;
+    clock::enableVirtualTime(5'000);
+
+    EXPECT_EQ(3u, clock::runAsFastAsPossible(countCall, &calls, 1'000, 2'500));
+
+    EXPECT_EQ(8'000u, clock::getVirtualTimeMicroseconds());
+}
+
+struct PeriodicTimerContext
+{
+    PeriodicMilliTimer timer{10};
+    int expirations = 0;
+};
+
+static void checkTimer(void *context)
+{
+    auto *ctx = static_cast<PeriodicTimerContext *>(context);
+    if (ctx->timer.execute())
+    {
+        ctx->expirations++;
+    }
+}
+
+TEST_F(VirtualClockTest, runAsFastAsPossible_drives_periodic_timer)
+{
+    clock::enableVirtualTime();
+    PeriodicTimerContext context;
+
+    // 180 s match with a 1 kHz main loop
+    clock::runAsFastAsPossible(checkTimer, &context, 1'000, 180'000'000);
+
+    EXPECT_EQ(17'999, context.expirations);
+}
+
+TEST(Clock, extendTime_returns_time_closest_to_estimate)
+{
+    const uint64_t wrap = static_cast<uint64_t>(UINT32_MAX) + 1;
+
+    EXPECT_EQ(3 * wrap + 5, clock::extendTime(3 * wrap + 1'000, 5));
+    // Estimate before the wrap, time after it
+    EXPECT_EQ(3 * wrap + 5, clock::extendTime(3 * wrap - 1'000, 5));
+    // Estimate after the wrap, time before it
+    EXPECT_EQ(3 * wrap - 5, clock::extendTime(3 * wrap + 1'000, UINT32_MAX - 4));
+}
+
+TEST_F(VirtualClockTest, getTimeMicroseconds64_does_not_wrap)
+{
+    clock::enableVirtualTime(UINT32_MAX);
+    clock::advance(10);
+
+    EXPECT_EQ(static_cast<uint64_t>(UINT32_MAX) + 10, clock::getTimeMicroseconds64());
+    EXPECT_EQ(9u, clock::getTimeMicroseconds());
+}
+
+TEST(Clock, getTimeMicroseconds64_follows_clock_stub_past_wrap)
+{
+    clock::ClockStub clock;
+    clock.time = 5'000'000;
+
+    EXPECT_EQ(5'000'000'000u, clock::getTimeMicroseconds64());
+    EXPECT_EQ(
+        5'000'000'000u * (Board::SystemClock::Frequency / 1'000'000),
+        clock::getCycleCount64());
+}
+
+TEST(Clock, timeout_started_before_time_wraps_expires_after_timeout)
+{
+    clock::ClockStub clock;
+    clock.time = UINT32_MAX - 5;
+    MilliTimeout timeout(10);
+
+    EXPECT_FALSE(timeout.isExpired());
+    EXPECT_EQ(10u, timeout.timeRemaining());
+
+    clock.time += 9;
+    EXPECT_FALSE(timeout.isExpired());
+    EXPECT_EQ(1u, timeout.timeRemaining());
+
+    clock.time += 1;
+    EXPECT_TRUE(timeout.isExpired());
+    EXPECT_EQ(0u, timeout.timeRemaining());
+}
+
+TEST(Clock, periodic_timer_keeps_period_when_time_wraps)
+{
+    clock::ClockStub clock;
+    clock.time = UINT32_MAX - 15;
+    PeriodicMilliTimer timer(10);
+
+    clock.time += 10;
+    EXPECT_TRUE(timer.execute());
+
+    clock.time += 9;
+    EXPECT_FALSE(timer.execute());
+
+    clock.time += 1;
+    EXPECT_TRUE(timer.execute());
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/flat_map.hpp"
+
+using namespace tap::arch;
+
+TEST(FlatMap, find_returns_inserted_value)
+{
+    FlatMap<uint16_t, int, 4> map;
+
+    EXPECT_TRUE(map.insert(0x203, 3));
+    EXPECT_TRUE(map.insert(0x201, 1));
+
+    ASSERT_NE(nullptr, map.find(0x201));
+    EXPECT_EQ(1, *map.find(0x201));
+    EXPECT_EQ(3, *map.find(0x203));
+    EXPECT_EQ(nullptr, map.find(0x202));
+    EXPECT_TRUE(map.contains(0x203));
+    EXPECT_FALSE(map.contains(0x204));
+}
+
+TEST(FlatMap, insert_fails_for_existing_key_or_when_full)
+{
+    FlatMap<int, int, 2> map;
+    map.insert(1, 10);
+
+    EXPECT_FALSE(map.insert(1, 20));
+    EXPECT_EQ(10, *map.find(1));
+
+    EXPECT_TRUE(map.insert(2, 20));
+    EXPECT_FALSE(map.insert(3, 30));
+    EXPECT_EQ(2u, map.size());
+}
+
+TEST(FlatMap, iterates_in_key_order)
+{
+    FlatMap<int, char, 8> map;
+    for (int key : {5, 1, 7, 3, 2})
+    {
+        map.insert(key, 'a' + key);
+    }
+
+    int previous = 0;
+    for (const auto &entry : map)
+    {
+        EXPECT_LT(previous, entry.key);
+        EXPECT_EQ('a' + entry.key, entry.value);
+        previous = entry.key;
+    }
+}
+
+TEST(FlatMap, erase_removes_key)
+{
+    FlatMap<int, int, 4> map;
+    map.insert(1, 10);
+    map.insert(2, 20);
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+
+    EXPECT_EQ(nullptr, map.find(1));
+    EXPECT_EQ(20, *map.find(2));
+    EXPECT_EQ(1u, map.size());
+}
+
+TEST(FlatMap, pointer_keys_compare_by_address)
+{
+    static const char a[] = "same";
+    static const char b[] = "same";
+    FlatMap<const char *, int, 4> map;
+
+    map.insert(a, 1);
+
+    EXPECT_EQ(1, *map.find(a));
+    EXPECT_EQ(nullptr, map.find(b));
+}
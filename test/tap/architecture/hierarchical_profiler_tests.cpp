@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/hierarchical_profiler.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::arch;
+using namespace testing;
+
+class HierarchicalProfilerTest : public Test
+{
+protected:
+    HierarchicalProfilerTest() : terminalDevice(nullptr), stream(terminalDevice) {}
+
+    void SetUp() override
+    {
+        clock.time = 1;
+        cyclesPerMs = clock::getCycleCount();
+        clock.time = 0;
+    }
+
+    /// Runs a tick of "a" for 3 ms, in which "b" runs for 1 ms after 1 ms.
+    void runTick()
+    {
+        uint32_t start = clock.time;
+        profiler.beginTick();
+        profiler.enter(A);
+        clock.time = start + 1;
+        profiler.enter(B);
+        clock.time = start + 2;
+        profiler.exit();
+        clock.time = start + 3;
+        profiler.exit();
+        clock.time = start + 4;
+        profiler.endTick();
+    }
+
+    static constexpr const char* A = "a";
+    static constexpr const char* B = "b";
+
+    clock::ClockStub clock;
+    uint32_t cyclesPerMs = 0;
+    HierarchicalProfiler profiler;
+    tap::stub::TerminalDeviceStub terminalDevice;
+    modm::IOStream stream;
+};
+
+TEST_F(HierarchicalProfilerTest, nested_scopes_create_child_nodes)
+{
+    runTick();
+
+    ASSERT_EQ(2, profiler.getNumNodes());
+    int16_t a = profiler.findNode(A);
+    int16_t b = profiler.findNode(B, a);
+    ASSERT_NE(HierarchicalProfiler::NO_NODE, a);
+    ASSERT_NE(HierarchicalProfiler::NO_NODE, b);
+    EXPECT_EQ(HierarchicalProfiler::NO_NODE, profiler.findNode(B));
+    EXPECT_EQ(a, profiler.getNode(b).parent);
+    EXPECT_EQ(1, profiler.getNode(b).depth);
+}
+
+TEST_F(HierarchicalProfilerTest, same_name_in_different_parents_is_different_node)
+{
+    profiler.enter(B);
+    profiler.exit();
+    runTick();
+
+    EXPECT_EQ(3, profiler.getNumNodes());
+    EXPECT_NE(profiler.findNode(B), profiler.findNode(B, profiler.findNode(A)));
+}
+
+TEST_F(HierarchicalProfilerTest, exit_accumulates_self_and_inclusive_cycles)
+{
+    runTick();
+    runTick();
+
+    const HierarchicalProfiler::Node& a = profiler.getNode(profiler.findNode(A));
+    const HierarchicalProfiler::Node& b = profiler.getNode(profiler.findNode(B, 0));
+
+    EXPECT_EQ(2, a.calls);
+    EXPECT_EQ(6 * cyclesPerMs, a.inclusiveCycles);
+    EXPECT_EQ(4 * cyclesPerMs, a.selfCycles);
+    EXPECT_EQ(3 * cyclesPerMs, a.maxInclusiveCycles);
+    EXPECT_EQ(2, b.calls);
+    EXPECT_EQ(2 * cyclesPerMs, b.inclusiveCycles);
+    EXPECT_EQ(2 * cyclesPerMs, b.selfCycles);
+}
+
+TEST_F(HierarchicalProfilerTest, endTick_publishes_last_tick_cycles_and_trace)
+{
+    runTick();
+
+    EXPECT_EQ(1, profiler.getTickCount());
+    EXPECT_EQ(4 * cyclesPerMs, profiler.getLastTickCycles());
+    EXPECT_EQ(3 * cyclesPerMs, profiler.getNode(profiler.findNode(A)).lastTickCycles);
+
+    // Events are recorded as scopes exit
+    ASSERT_EQ(2, profiler.getLastTickNumEvents());
+    EXPECT_EQ(profiler.findNode(B, 0), profiler.getLastTickEvent(0).node);
+    EXPECT_EQ(cyclesPerMs, profiler.getLastTickEvent(0).startCycles);
+    EXPECT_EQ(cyclesPerMs, profiler.getLastTickEvent(0).durationCycles);
+    EXPECT_EQ(profiler.findNode(A), profiler.getLastTickEvent(1).node);
+    EXPECT_EQ(0, profiler.getLastTickEvent(1).startCycles);
+    EXPECT_EQ(3 * cyclesPerMs, profiler.getLastTickEvent(1).durationCycles);
+
+    // The published trace is unaffected by the next tick until it ends
+    profiler.beginTick();
+    profiler.enter(A);
+    profiler.exit();
+    EXPECT_EQ(2, profiler.getLastTickNumEvents());
+    profiler.endTick();
+    EXPECT_EQ(1, profiler.getLastTickNumEvents());
+    EXPECT_EQ(0, profiler.getNode(profiler.findNode(B, 0)).lastTickCycles);
+}
+
+TEST_F(HierarchicalProfilerTest, scopes_nested_too_deep_dropped_with_their_children)
+{
+    const char* names[HierarchicalProfiler::MAX_DEPTH + 1];
+    std::string strs[HierarchicalProfiler::MAX_DEPTH + 1];
+    for (int i = 0; i <= HierarchicalProfiler::MAX_DEPTH; i++)
+    {
+        strs[i] = std::to_string(i);
+        names[i] = strs[i].c_str();
+        profiler.enter(names[i]);
+    }
+    profiler.enter(A);
+    profiler.exit();
+    for (int i = 0; i <= HierarchicalProfiler::MAX_DEPTH; i++)
+    {
+        profiler.exit();
+    }
+
+    EXPECT_EQ(HierarchicalProfiler::MAX_DEPTH, profiler.getNumNodes());
+    EXPECT_EQ(2, profiler.getDroppedScopes());
+    EXPECT_EQ(1, profiler.getNode(0).calls);
+}
+
+TEST_F(HierarchicalProfilerTest, scope_exits_on_destruction)
+{
+    {
+        HierarchicalProfiler::Scope scope(profiler, A);
+        clock.time = 2;
+    }
+
+    EXPECT_EQ(2 * cyclesPerMs, profiler.getNode(0).inclusiveCycles);
+}
+
+TEST_F(HierarchicalProfilerTest, printFolded_prints_path_and_self_cycles)
+{
+    runTick();
+
+    profiler.printFolded(stream);
+
+    std::string expected = "a " + std::to_string(2 * cyclesPerMs) + "\na;b " +
+                           std::to_string(cyclesPerMs) + "\n";
+    EXPECT_EQ(expected, terminalDevice.readAllItemsFromWriteBufferToString());
+}
+
+TEST_F(HierarchicalProfilerTest, printTrace_prints_last_tick)
+{
+    runTick();
+
+    profiler.printTrace(stream);
+
+    std::string expected = "tick 0 " + std::to_string(4 * cyclesPerMs) + "\n1 b " +
+                           std::to_string(cyclesPerMs) + " " + std::to_string(cyclesPerMs) +
+                           "\n0 a 0 " + std::to_string(3 * cyclesPerMs) + "\nend\n";
+    EXPECT_EQ(expected, terminalDevice.readAllItemsFromWriteBufferToString());
+}
+
+TEST_F(HierarchicalProfilerTest, reset_clears_nodes_and_trace)
+{
+    runTick();
+
+    profiler.reset();
+
+    EXPECT_EQ(0, profiler.getNumNodes());
+    EXPECT_EQ(0, profiler.getLastTickNumEvents());
+    EXPECT_EQ(0, profiler.getTickCount());
+}
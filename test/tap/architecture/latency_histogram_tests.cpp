@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/latency_histogram.hpp"
+
+using namespace tap::arch;
+
+TEST(LatencyHistogram, small_values_have_own_bucket)
+{
+    for (uint32_t i = 0; i < 2 * LatencyHistogram::SUB_BUCKETS; i++)
+    {
+        EXPECT_EQ(i, LatencyHistogram::bucketOf(i));
+        EXPECT_EQ(i, LatencyHistogram::bucketUpperBound(i));
+    }
+}
+
+TEST(LatencyHistogram, buckets_contiguous_and_within_precision)
+{
+    int prevBucket = 0;
+    for (uint32_t value = 1; value < (1U << LatencyHistogram::MAX_VALUE_BITS);
+         value += value / 64 + 1)
+    {
+        int bucket = LatencyHistogram::bucketOf(value);
+        EXPECT_LE(bucket - prevBucket, 1);
+        EXPECT_GE(LatencyHistogram::bucketUpperBound(bucket), value);
+        EXPECT_LE(
+            LatencyHistogram::bucketUpperBound(bucket) - value,
+            value / LatencyHistogram::SUB_BUCKETS);
+        prevBucket = bucket;
+    }
+}
+
+TEST(LatencyHistogram, large_values_counted_in_last_bucket)
+{
+    EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::bucketOf(UINT32_MAX));
+    EXPECT_EQ(
+        LatencyHistogram::NUM_BUCKETS - 1,
+        LatencyHistogram::bucketOf(1U << LatencyHistogram::MAX_VALUE_BITS));
+}
+
+TEST(LatencyHistogram, getPercentile_no_values_returns_0)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(0, histogram.getPercentile(0.5f));
+}
+
+TEST(LatencyHistogram, getSummary_finds_rare_outlier)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 997; i++)
+    {
+        histogram.record(100);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        histogram.record(400);
+    }
+
+    LatencyHistogram::Summary summary = histogram.getSummary();
+
+    EXPECT_EQ(1000, summary.count);
+    EXPECT_NEAR(100, summary.p50, 100 / LatencyHistogram::SUB_BUCKETS);
+    EXPECT_NEAR(100, summary.p99, 100 / LatencyHistogram::SUB_BUCKETS);
+    EXPECT_EQ(400, summary.p999);
+    EXPECT_EQ(400, summary.max);
+}
+
+TEST(LatencyHistogram, clear_removes_values)
+{
+    LatencyHistogram histogram;
+    histogram.record(10);
+
+    histogram.clear();
+
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getMax());
+    EXPECT_EQ(0, histogram.getBucketCount(10));
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/memory_monitor.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace testing;
+using namespace tap::arch;
+
+class MemoryMonitorTest : public Test
+{
+protected:
+    static constexpr uint32_t STACK_WORDS = 64;
+
+    MemoryMonitorTest() : monitor(&drivers), terminalDevice(&drivers), stream(terminalDevice) {}
+
+    tap::Drivers drivers;
+    MemoryMonitor monitor;
+    tap::stub::TerminalDeviceStub terminalDevice;
+    modm::IOStream stream;
+    uint32_t stack[STACK_WORDS] = {};
+};
+
+TEST_F(MemoryMonitorTest, init__adds_itself_to_terminal_serial)
+{
+    EXPECT_CALL(drivers.terminalSerial, addHeader(StrEq("memory"), &monitor));
+
+    monitor.init();
+}
+
+TEST_F(MemoryMonitorTest, lockHeap__locks_heap)
+{
+    monitor.lockHeap();
+
+    EXPECT_TRUE(monitor.isHeapLocked());
+}
+
+TEST_F(MemoryMonitorTest, no_main_stack_on_hosted_platform)
+{
+    EXPECT_EQ(0, monitor.getNumStacks());
+    EXPECT_EQ(0u, monitor.getStackUsage(MemoryMonitor::MAIN_STACK_ID).size);
+}
+
+TEST_F(MemoryMonitorTest, addStack__paints_stack_and_reports_no_usage)
+{
+    int id = monitor.addStack("stack", stack, sizeof(stack));
+
+    ASSERT_NE(MemoryMonitor::INVALID_STACK_ID, id);
+    for (uint32_t word : stack)
+    {
+        EXPECT_EQ(MemoryMonitor::STACK_PAINT, word);
+    }
+    MemoryMonitor::StackUsage usage = monitor.getStackUsage(id);
+    EXPECT_STREQ("stack", usage.name);
+    EXPECT_EQ(sizeof(stack), usage.size);
+    EXPECT_EQ(0u, usage.maxUsed);
+    EXPECT_FALSE(usage.overflowed);
+}
+
+TEST_F(MemoryMonitorTest, getStackUsage__reports_deepest_word_written_from_top)
+{
+    int id = monitor.addStack("stack", stack, sizeof(stack));
+
+    // Stacks grow down, so using 10 words writes the top 10
+    for (uint32_t i = STACK_WORDS - 10; i < STACK_WORDS; i++)
+    {
+        stack[i] = i;
+    }
+    // A value that happens to match the pattern below the deepest word doesn't count as unused
+    stack[STACK_WORDS - 5] = MemoryMonitor::STACK_PAINT;
+
+    EXPECT_EQ(10 * sizeof(uint32_t), monitor.getStackUsage(id).maxUsed);
+}
+
+TEST_F(MemoryMonitorTest, getStackUsage__bottom_word_overwritten_reports_overflow)
+{
+    int id = monitor.addStack("stack", stack, sizeof(stack));
+
+    stack[0] = 0;
+
+    MemoryMonitor::StackUsage usage = monitor.getStackUsage(id);
+    EXPECT_TRUE(usage.overflowed);
+    EXPECT_EQ(sizeof(stack), usage.maxUsed);
+}
+
+TEST_F(MemoryMonitorTest, addStack__size_rounded_down_to_whole_words)
+{
+    int id = monitor.addStack("stack", stack, 4 * sizeof(uint32_t) + 3);
+
+    EXPECT_EQ(4 * sizeof(uint32_t), monitor.getStackUsage(id).size);
+    EXPECT_NE(MemoryMonitor::STACK_PAINT, stack[4]);
+}
+
+TEST_F(MemoryMonitorTest, addStack__more_than_max_stacks_fails)
+{
+    for (int i = 0; i < MemoryMonitor::MAX_STACKS; i++)
+    {
+        EXPECT_EQ(i, monitor.addStack("stack", stack, sizeof(stack)));
+    }
+
+    EXPECT_EQ(MemoryMonitor::INVALID_STACK_ID, monitor.addStack("stack", stack, sizeof(stack)));
+    EXPECT_EQ(MemoryMonitor::MAX_STACKS, monitor.getNumStacks());
+}
+
+TEST_F(MemoryMonitorTest, getStackUsage__invalid_id_returns_empty_usage)
+{
+    EXPECT_EQ(nullptr, monitor.getStackUsage(-1).name);
+    EXPECT_EQ(nullptr, monitor.getStackUsage(0).name);
+}
+
+TEST_F(MemoryMonitorTest, terminalSerialCallback__stacks_prints_each_stack)
+{
+    char input[] = "stacks";
+    monitor.addStack("imu", stack, sizeof(stack));
+    stack[STACK_WORDS - 1] = 0;
+
+    EXPECT_TRUE(monitor.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("imu: 4/256, 1%"));
+}
+
+TEST_F(MemoryMonitorTest, terminalSerialCallback__drivers_prints_each_driver)
+{
+    char input[] = "drivers";
+
+    EXPECT_TRUE(monitor.terminalSerialCallback(input, stream, false));
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("memoryMonitor: "));
+    EXPECT_THAT(output, HasSubstr("commandScheduler: "));
+}
+
+TEST_F(MemoryMonitorTest, terminalSerialCallback__no_arguments_prints_stacks_and_drivers)
+{
+    char input[] = "";
+
+    EXPECT_TRUE(monitor.terminalSerialCallback(input, stream, false));
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("Stacks"));
+    EXPECT_THAT(output, HasSubstr("Drivers"));
+}
+
+TEST_F(MemoryMonitorTest, terminalSerialCallback__invalid_input_prints_usage)
+{
+    char input[] = "asdf";
+
+    EXPECT_FALSE(monitor.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
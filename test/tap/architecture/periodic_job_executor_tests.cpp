@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/periodic_job_executor.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap;
+using namespace testing;
+using namespace tap::arch;
+
+/**
+ * Context passed to jobs in tests, records the jobs that run and advances the clock by
+ * `runTime` milliseconds each time a job runs.
+ */
+struct TestJobContext
+{
+    clock::ClockStub *clock;
+    std::vector<int> *runOrder;
+    int id;
+    uint32_t runTime;
+};
+
+static void testJob(void *context)
+{
+    auto ctx = static_cast<TestJobContext *>(context);
+    ctx->runOrder->push_back(ctx->id);
+    ctx->clock->time += ctx->runTime;
+}
+
+class PeriodicJobExecutorTest : public Test
+{
+protected:
+    PeriodicJobExecutorTest() : executor(&drivers) {}
+
+    TestJobContext makeContext(int id, uint32_t runTime = 0)
+    {
+        return TestJobContext{&clock, &runOrder, id, runTime};
+    }
+
+    clock::ClockStub clock;
+    Drivers drivers;
+    PeriodicJobExecutor executor;
+    std::vector<int> runOrder;
+};
+
+TEST_F(PeriodicJobExecutorTest, addJob_nullptr_function_raises_error)
+{
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    EXPECT_EQ(PeriodicJobExecutor::INVALID_JOB_ID, executor.addJob("job", nullptr, nullptr, 1000));
+    EXPECT_EQ(0, executor.getJobCount());
+}
+
+TEST_F(PeriodicJobExecutorTest, addJob_too_many_jobs_raises_error)
+{
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    auto ctx = makeContext(0);
+    for (int i = 0; i < PeriodicJobExecutor::MAX_JOBS; i++)
+    {
+        EXPECT_EQ(i, executor.addJob("job", testJob, &ctx, 1000));
+    }
+
+    EXPECT_EQ(PeriodicJobExecutor::INVALID_JOB_ID, executor.addJob("job", testJob, &ctx, 1000));
+}
+
+TEST_F(PeriodicJobExecutorTest, addJob_auto_priority_is_rate_monotonic)
+{
+    auto ctx = makeContext(0);
+    int slow = executor.addJob("slow", testJob, &ctx, 10'000);
+    int fast = executor.addJob("fast", testJob, &ctx, 1'000);
+    int medium = executor.addJob("medium", testJob, &ctx, 5'000);
+    int pinned = executor.addJob("pinned", testJob, &ctx, 20'000, 0, 100);
+
+    EXPECT_GT(executor.getJobPriority(fast), executor.getJobPriority(medium));
+    EXPECT_GT(executor.getJobPriority(medium), executor.getJobPriority(slow));
+    EXPECT_EQ(100, executor.getJobPriority(pinned));
+}
+
+TEST_F(PeriodicJobExecutorTest, update_runs_released_jobs_in_priority_order)
+{
+    auto slowCtx = makeContext(0);
+    auto fastCtx = makeContext(1);
+    auto pinnedCtx = makeContext(2);
+    executor.addJob("slow", testJob, &slowCtx, 10'000);
+    executor.addJob("fast", testJob, &fastCtx, 1'000);
+    executor.addJob("pinned", testJob, &pinnedCtx, 20'000, 0, 100);
+
+    executor.update();
+
+    EXPECT_EQ(std::vector<int>({2, 1, 0}), runOrder);
+}
+
+TEST_F(PeriodicJobExecutorTest, update_runs_jobs_once_per_period)
+{
+    auto fastCtx = makeContext(0);
+    auto slowCtx = makeContext(1);
+    int fast = executor.addJob("fast", testJob, &fastCtx, 2'000);
+    int slow = executor.addJob("slow", testJob, &slowCtx, 10'000);
+
+    for (clock.time = 0; clock.time < 20; clock.time++)
+    {
+        executor.update();
+    }
+
+    EXPECT_EQ(10, executor.getJobStats(fast).runs);
+    EXPECT_EQ(2, executor.getJobStats(slow).runs);
+    EXPECT_EQ(0, executor.getJobStats(fast).deadlineMisses);
+    EXPECT_EQ(0, executor.getJobStats(slow).deadlineMisses);
+    EXPECT_EQ(10, executor.getJobStats(fast).jitterHistogram[0]);
+}
+
+TEST_F(PeriodicJobExecutorTest, update_zero_period_job_runs_every_update)
+{
+    auto ctx = makeContext(0);
+    int job = executor.addJob("job", testJob, &ctx, 0);
+
+    for (int i = 0; i < 5; i++)
+    {
+        executor.update();
+    }
+
+    EXPECT_EQ(5, executor.getJobStats(job).runs);
+    EXPECT_EQ(0, executor.getJobStats(job).deadlineMisses);
+}
+
+TEST_F(PeriodicJobExecutorTest, update_job_blocked_by_higher_priority_job_records_jitter_and_miss)
+{
+    // The high priority job takes 3 ms, which delays the low priority job past its 2 ms deadline
+    auto highCtx = makeContext(0, 3);
+    auto lowCtx = makeContext(1);
+    executor.addJob("high", testJob, &highCtx, 10'000, 0, 10);
+    int low = executor.addJob("low", testJob, &lowCtx, 10'000, 2'000, 1);
+
+    executor.update();
+
+    auto stats = executor.getJobStats(low);
+    EXPECT_EQ(1, stats.runs);
+    EXPECT_EQ(1, stats.deadlineMisses);
+    EXPECT_EQ(3'000, stats.maxJitter);
+    EXPECT_EQ(1, stats.jitterHistogram[PeriodicJobExecutor::jitterToBucket(3'000)]);
+}
+
+TEST_F(PeriodicJobExecutorTest, update_skipped_releases_counted_as_deadline_misses)
+{
+    auto ctx = makeContext(0);
+    int job = executor.addJob("job", testJob, &ctx, 1'000);
+
+    executor.update();
+    clock.time = 5;
+    executor.update();
+
+    auto stats = executor.getJobStats(job);
+    EXPECT_EQ(2, stats.runs);
+    EXPECT_EQ(6, stats.releases);
+    EXPECT_EQ(4, stats.deadlineMisses);
+}
+
+TEST_F(PeriodicJobExecutorTest, resetJobStats_clears_stats)
+{
+    auto ctx = makeContext(0);
+    int job = executor.addJob("job", testJob, &ctx, 1'000);
+
+    executor.update();
+    executor.resetJobStats();
+
+    EXPECT_EQ(0, executor.getJobStats(job).runs);
+    EXPECT_EQ(0, executor.getJobStats(job).releases);
+}
+
+TEST(PeriodicJobExecutor, jitterToBucket_log2_buckets)
+{
+    EXPECT_EQ(0, PeriodicJobExecutor::jitterToBucket(0));
+    EXPECT_EQ(1, PeriodicJobExecutor::jitterToBucket(1));
+    EXPECT_EQ(2, PeriodicJobExecutor::jitterToBucket(2));
+    EXPECT_EQ(2, PeriodicJobExecutor::jitterToBucket(3));
+    EXPECT_EQ(3, PeriodicJobExecutor::jitterToBucket(4));
+    EXPECT_EQ(
+        PeriodicJobExecutor::JITTER_HISTOGRAM_BUCKETS - 1,
+        PeriodicJobExecutor::jitterToBucket(UINT32_MAX));
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/profiler_terminal_serial_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace testing;
+using namespace tap::arch;
+
+class ProfilerTerminalSerialHandlerTest : public Test
+{
+protected:
+    ProfilerTerminalSerialHandlerTest()
+        : handler(&drivers, &profiler),
+          terminalDevice(&drivers),
+          stream(terminalDevice)
+    {
+    }
+
+    void runTick()
+    {
+        profiler.beginTick();
+        profiler.enter("scheduler");
+        profiler.exit();
+        profiler.endTick();
+    }
+
+    clock::ClockStub clock;
+    tap::Drivers drivers;
+    HierarchicalProfiler profiler;
+    ProfilerTerminalSerialHandler handler;
+    tap::stub::TerminalDeviceStub terminalDevice;
+    modm::IOStream stream;
+};
+
+TEST_F(ProfilerTerminalSerialHandlerTest, init__adds_itself_to_terminal_serial)
+{
+    EXPECT_CALL(drivers.terminalSerial, addHeader(StrEq("profile"), &handler));
+
+    handler.init();
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialCallback__invalid_input_prints_usage)
+{
+    char input[] = "asdf";
+
+    EXPECT_FALSE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialCallback__tree_prints_scopes)
+{
+    char input[] = "tree";
+    runTick();
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("scheduler"));
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialStreamCallback__trace_printed_once_per_tick)
+{
+    char input[] = "trace";
+    runTick();
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, true));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("tick 0"));
+
+    handler.terminalSerialStreamCallback(stream);
+    EXPECT_EQ("", terminalDevice.readAllItemsFromWriteBufferToString());
+
+    runTick();
+    handler.terminalSerialStreamCallback(stream);
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("tick 1"));
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialCallback__telemetry_adds_scope_signals)
+{
+    char input[] = "telemetry";
+    runTick();
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_EQ(1, drivers.terminalSerial.getTelemetryStream().getNumSignals());
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialCallback__reset_clears_profiler)
+{
+    char input[] = "reset";
+    runTick();
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_EQ(0, profiler.getNumNodes());
+}
+
+TEST_F(ProfilerTerminalSerialHandlerTest, terminalSerialCallback__hist_prints_histogram_profiles)
+{
+    char input[] = "hist";
+    std::size_t key = drivers.profiler.push("imu");
+    drivers.profiler.enableHistogram(key);
+    drivers.profiler.push("can");
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("imu"));
+    EXPECT_THAT(output, Not(HasSubstr("can")));
+}
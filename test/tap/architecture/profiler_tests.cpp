@@ -154,3 +154,153 @@ TEST_F(ProfilerTest, profile_macro)
     EXPECT_EQ(1000, data.min);
     EXPECT_EQ(1000, data.max);
 }
+
+TEST_F(ProfilerTest, registerProfile_returns_same_key_as_push)
+{
+    const char* hi = "hi";
+
+    std::size_t key = profiler.registerProfile(hi);
+
+    EXPECT_EQ(key, profiler.push(hi));
+    EXPECT_TRUE(profiler.getData(key).cycles);
+}
+
+TEST_F(ProfilerTest, pushCycles_popCycles_populates_min_max_avg_in_cycles)
+{
+    std::size_t key = profiler.registerProfile("hi");
+    uint32_t start = clock::getCycleCount();
+
+    profiler.pushCycles(key);
+    clock.time = 2;
+    profiler.popCycles(key);
+
+    uint32_t cycles = clock::getCycleCount() - start;
+    Profiler::ProfilerData data = profiler.getData(key);
+
+    EXPECT_EQ(cycles, data.min);
+    EXPECT_EQ(cycles, data.max);
+    EXPECT_EQ(algorithms::lowPassFilter(0, cycles, Profiler::AVG_LOW_PASS_ALPHA), data.avg);
+}
+
+TEST_F(ProfilerTest, pushCycles_popCycles_invalid_key_ignored)
+{
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    profiler.pushCycles(0);
+    profiler.popCycles(0);
+
+    EXPECT_EQ(nullptr, profiler.getData(0).name);
+}
+
+// redeclare profile macro s.t. we can test it even if profiling is turned off
+#undef PROFILE_CYCLES
+#define PROFILE_CYCLES(profiler, func, params)                                 \
+    do                                                                         \
+    {                                                                          \
+        static const std::size_t profileKey = profiler.registerProfile(#func); \
+        profiler.pushCycles(profileKey);                                       \
+        func params;                                                           \
+        profiler.popCycles(profileKey);                                        \
+    } while (0);
+
+TEST_F(ProfilerTest, profile_cycles_macro_registers_call_site_once)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        PROFILE_CYCLES(profiler, testFunc, (clock));
+    }
+
+    Profiler::ProfilerData data = profiler.getData(0);
+
+    EXPECT_EQ(std::string("testFunc"), data.name);
+    EXPECT_TRUE(data.cycles);
+    EXPECT_EQ(clock::getCycleCount() / 3, data.min);
+    EXPECT_EQ(clock::getCycleCount() / 3, data.max);
+    EXPECT_EQ(nullptr, profiler.getData(1).name);
+}
+
+TEST_F(ProfilerTest, enableHistogram_invalid_key_fails)
+{
+    EXPECT_FALSE(profiler.enableHistogram(0));
+    EXPECT_EQ(nullptr, profiler.getHistogram(0));
+}
+
+TEST_F(ProfilerTest, enableHistogram_limited_to_max_histograms)
+{
+    std::string strs[Profiler::MAX_HISTOGRAMS + 1];
+    for (int i = 0; i <= Profiler::MAX_HISTOGRAMS; i++)
+    {
+        strs[i] = std::to_string(i);
+        EXPECT_EQ(
+            i < Profiler::MAX_HISTOGRAMS,
+            profiler.enableHistogram(profiler.push(strs[i].c_str())));
+    }
+
+    // Enabling a histogram again doesn't use another one
+    EXPECT_TRUE(profiler.enableHistogram(0));
+}
+
+TEST_F(ProfilerTest, pop_records_histogram)
+{
+    std::size_t key = profiler.push("hi");
+    profiler.pop(key);
+    ASSERT_TRUE(profiler.enableHistogram(key));
+
+    key = profiler.push("hi");
+    clock.time = 2;
+    profiler.pop(key);
+
+    LatencyHistogram::Summary summary;
+    ASSERT_TRUE(profiler.getHistogramSummary(key, &summary));
+    EXPECT_EQ(1, summary.count);
+    EXPECT_EQ(2000, summary.max);
+}
+
+TEST_F(ProfilerTest, popCycles_records_histogram)
+{
+    std::size_t key = profiler.registerProfile("hi");
+    ASSERT_TRUE(profiler.enableHistogram(key));
+
+    profiler.pushCycles(key);
+    profiler.popCycles(key);
+
+    EXPECT_EQ(1, profiler.getHistogram(key)->getCount());
+}
+
+TEST_F(ProfilerTest, windowed_histogram_summary_is_last_complete_window)
+{
+    std::size_t key = profiler.push("hi");
+    ASSERT_TRUE(profiler.enableHistogram(key, 100));
+
+    for (int i = 0; i < 3; i++)
+    {
+        key = profiler.push("hi");
+        clock.time += 1;
+        profiler.pop(key);
+    }
+
+    LatencyHistogram::Summary summary;
+    ASSERT_TRUE(profiler.getHistogramSummary(key, &summary));
+    EXPECT_EQ(0, summary.count);
+
+    clock.time = 100;
+    key = profiler.push("hi");
+    clock.time += 5;
+    profiler.pop(key);
+
+    ASSERT_TRUE(profiler.getHistogramSummary(key, &summary));
+    EXPECT_EQ(3, summary.count);
+    EXPECT_EQ(1000, summary.max);
+    EXPECT_EQ(1, profiler.getHistogram(key)->getCount());
+}
+
+TEST_F(ProfilerTest, reset_clears_histogram)
+{
+    std::size_t key = profiler.push("hi");
+    ASSERT_TRUE(profiler.enableHistogram(key));
+    profiler.pop(key);
+
+    profiler.reset(key);
+
+    EXPECT_EQ(0, profiler.getHistogram(key)->getCount());
+}
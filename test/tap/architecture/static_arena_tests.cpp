@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/static_arena.hpp"
+
+using namespace tap::arch;
+
+namespace
+{
+struct Counter
+{
+    Counter() = default;
+    Counter(int start, int step) : value(start), step(step) {}
+    int value = 0;
+    int step = 1;
+};
+
+struct alignas(16) Aligned
+{
+    uint8_t data[16];
+};
+}  // namespace
+
+// Constant initialization, so objects can be created from any global constructor
+static StaticArena<64> globalArena;
+
+TEST(StaticArena, create_constructs_object_with_arguments)
+{
+    StaticArena<64> arena;
+
+    Counter *counter = arena.create<Counter>(5, 2);
+
+    EXPECT_EQ(5, counter->value);
+    EXPECT_EQ(2, counter->step);
+    EXPECT_EQ(sizeof(Counter), arena.getUsed());
+}
+
+TEST(StaticArena, objects_do_not_overlap)
+{
+    StaticArena<64> arena;
+
+    Counter *first = arena.create<Counter>(1, 1);
+    Counter *second = arena.create<Counter>(2, 2);
+
+    EXPECT_LE(reinterpret_cast<uint8_t *>(first + 1), reinterpret_cast<uint8_t *>(second));
+    EXPECT_EQ(1, first->value);
+    EXPECT_EQ(2, second->value);
+}
+
+TEST(StaticArena, allocations_are_aligned)
+{
+    StaticArena<128> arena;
+
+    arena.allocate(1, 1);
+    Aligned *aligned = arena.create<Aligned>();
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(aligned) % 16);
+    EXPECT_EQ(32u, arena.getUsed());
+}
+
+TEST(StaticArena, createArray_default_constructs_each_element)
+{
+    StaticArena<64> arena;
+
+    Counter *counters = arena.createArray<Counter>(3);
+
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(0, counters[i].value);
+        EXPECT_EQ(1, counters[i].step);
+    }
+    EXPECT_EQ(3 * sizeof(Counter), arena.getUsed());
+}
+
+TEST(StaticArena, allocate_returns_nullptr_when_full)
+{
+    StaticArena<16> arena;
+
+    EXPECT_NE(nullptr, arena.allocate(12, 4));
+    EXPECT_EQ(nullptr, arena.allocate(8, 4));
+    EXPECT_NE(nullptr, arena.allocate(4, 4));
+    EXPECT_EQ(0u, arena.getRemaining());
+    EXPECT_EQ(nullptr, arena.allocate(1, 1));
+}
+
+TEST(StaticArena, global_arena_is_usable)
+{
+    EXPECT_EQ(64u, globalArena.getRemaining());
+    EXPECT_EQ(64u, StaticArena<64>::getSize());
+}
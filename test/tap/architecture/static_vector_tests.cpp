@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/static_vector.hpp"
+
+using namespace tap::arch;
+
+TEST(StaticVector, push_back_fails_when_full)
+{
+    StaticVector<int, 3> vector;
+
+    EXPECT_TRUE(vector.push_back(1));
+    EXPECT_TRUE(vector.push_back(2));
+    EXPECT_TRUE(vector.push_back(3));
+    EXPECT_FALSE(vector.push_back(4));
+
+    EXPECT_TRUE(vector.full());
+    EXPECT_EQ(3u, vector.size());
+    EXPECT_EQ(3, vector.back());
+}
+
+TEST(StaticVector, initializer_list_keeps_first_elements_that_fit)
+{
+    StaticVector<int, 2> vector{5, 6, 7};
+
+    ASSERT_EQ(2u, vector.size());
+    EXPECT_EQ(5, vector[0]);
+    EXPECT_EQ(6, vector[1]);
+}
+
+TEST(StaticVector, insert_and_erase_preserve_order)
+{
+    StaticVector<int, 5> vector{1, 3, 4};
+
+    EXPECT_EQ(2, *vector.insert(vector.begin() + 1, 2));
+    EXPECT_EQ(4, *vector.erase(vector.begin() + 2));
+
+    int expected[] = {1, 2, 4};
+    ASSERT_EQ(3u, vector.size());
+    for (size_t i = 0; i < vector.size(); i++)
+    {
+        EXPECT_EQ(expected[i], vector[i]);
+    }
+}
+
+TEST(StaticVector, insert_fails_when_full)
+{
+    StaticVector<int, 2> vector{1, 2};
+
+    EXPECT_EQ(nullptr, vector.insert(vector.begin(), 0));
+    EXPECT_EQ(1, vector.front());
+}
+
+TEST(StaticVector, resize_fills_new_elements)
+{
+    StaticVector<int, 4> vector{1};
+
+    EXPECT_TRUE(vector.resize(3, 7));
+    EXPECT_EQ(7, vector[2]);
+    EXPECT_FALSE(vector.resize(5));
+    EXPECT_EQ(3u, vector.size());
+
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.begin(), vector.end());
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/timer_wheel.hpp"
+
+using namespace tap::arch;
+
+/// Updates the wheel every tick from `start` to `end` and returns the tick `timer` first expired.
+static uint32_t findExpiration(
+    TimerWheel &wheel,
+    TimerWheel::Timer &timer,
+    uint32_t start,
+    uint32_t end)
+{
+    for (uint32_t tick = start; tick != end; tick++)
+    {
+        wheel.update(tick);
+        if (timer.execute())
+        {
+            return tick;
+        }
+    }
+    return end;
+}
+
+static void countCall(void *context) { (*static_cast<int *>(context))++; }
+
+TEST(TimerWheel, timer_expires_after_timeout)
+{
+    TimerWheel wheel(100);
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 10);
+
+    EXPECT_TRUE(timer.isScheduled());
+    EXPECT_EQ(10u, wheel.timeRemaining(timer));
+    EXPECT_EQ(110u, findExpiration(wheel, timer, 101, 1'000));
+    EXPECT_FALSE(timer.isScheduled());
+    EXPECT_EQ(0, wheel.getNumScheduled());
+}
+
+TEST(TimerWheel, long_timeouts_expire_exactly_on_time)
+{
+    for (uint32_t timeout : {63u, 64u, 65u, 4'095u, 4'096u, 100'000u, TimerWheel::RANGE + 5})
+    {
+        TimerWheel wheel(37);
+        TimerWheel::Timer timer;
+
+        wheel.schedule(timer, timeout);
+
+        EXPECT_EQ(37 + timeout, findExpiration(wheel, timer, 38, 37 + timeout + 10)) << timeout;
+    }
+}
+
+TEST(TimerWheel, timer_expires_across_time_wrap)
+{
+    TimerWheel wheel(UINT32_MAX - 100);
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 200);
+
+    EXPECT_EQ(99u, findExpiration(wheel, timer, UINT32_MAX - 99, 1'000));
+}
+
+TEST(TimerWheel, zero_timeout_expires_on_next_update)
+{
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 0);
+    wheel.update(1);
+
+    EXPECT_TRUE(timer.isExpired());
+}
+
+TEST(TimerWheel, late_update_expires_all_due_timers)
+{
+    TimerWheel wheel(0);
+    TimerWheel::Timer timers[3];
+    wheel.schedule(timers[0], 5);
+    wheel.schedule(timers[1], 500);
+    wheel.schedule(timers[2], 5'000);
+
+    wheel.update(1'000);
+
+    EXPECT_TRUE(timers[0].isExpired());
+    EXPECT_TRUE(timers[1].isExpired());
+    EXPECT_FALSE(timers[2].isExpired());
+    EXPECT_EQ(4'000u, wheel.timeRemaining(timers[2]));
+}
+
+TEST(TimerWheel, callback_called_on_expiration)
+{
+    int calls = 0;
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer(countCall, &calls);
+
+    wheel.schedule(timer, 3);
+    wheel.update(2);
+    EXPECT_EQ(0, calls);
+
+    wheel.update(3);
+    EXPECT_EQ(1, calls);
+}
+
+TEST(TimerWheel, cancelled_timer_does_not_expire)
+{
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 3);
+    wheel.cancel(timer);
+    wheel.update(10);
+
+    EXPECT_FALSE(timer.isExpired());
+    EXPECT_FALSE(timer.isScheduled());
+}
+
+TEST(TimerWheel, rescheduling_replaces_timeout)
+{
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 3);
+    wheel.schedule(timer, 20);
+
+    EXPECT_EQ(1, wheel.getNumScheduled());
+    EXPECT_EQ(20u, findExpiration(wheel, timer, 1, 100));
+}
+
+TEST(TimerWheel, destroyed_timer_is_cancelled)
+{
+    TimerWheel wheel(0);
+    {
+        TimerWheel::Timer timer;
+        wheel.schedule(timer, 3);
+    }
+
+    EXPECT_EQ(0, wheel.getNumScheduled());
+    wheel.update(10);
+}
+
+TEST(TimerWheel, periodic_timer_expires_every_period)
+{
+    int calls = 0;
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer(countCall, &calls);
+
+    wheel.schedulePeriodic(timer, 10);
+    for (uint32_t tick = 1; tick <= 1'000; tick++)
+    {
+        wheel.update(tick);
+    }
+
+    EXPECT_EQ(100, calls);
+    EXPECT_TRUE(timer.isScheduled());
+}
+
+TEST(TimerWheel, periodic_timer_skips_missed_periods_and_stays_aligned)
+{
+    int calls = 0;
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer(countCall, &calls);
+    wheel.schedulePeriodic(timer, 10);
+
+    wheel.update(35);
+
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(5u, wheel.timeRemaining(timer));
+}
+
+struct CancelContext
+{
+    TimerWheel *wheel;
+    TimerWheel::Timer *other;
+};
+
+static void cancelOther(void *context)
+{
+    auto *ctx = static_cast<CancelContext *>(context);
+    ctx->wheel->cancel(*ctx->other);
+}
+
+TEST(TimerWheel, callback_may_cancel_timer_due_same_tick)
+{
+    TimerWheel wheel(0);
+    TimerWheel::Timer first;
+    CancelContext context{&wheel, &first};
+    TimerWheel::Timer second(cancelOther, &context);
+
+    // Timers in a slot are expired most recently scheduled first
+    wheel.schedule(first, 5);
+    wheel.schedule(second, 5);
+    wheel.update(5);
+
+    EXPECT_TRUE(second.isExpired());
+    EXPECT_FALSE(first.isExpired());
+    EXPECT_EQ(0, wheel.getNumScheduled());
+}
+
+TEST(TimerWheel, default_constructor_starts_at_current_time)
+{
+    clock::ClockStub clock;
+    clock.time = 1'000;
+    TimerWheel wheel;
+    TimerWheel::Timer timer;
+
+    wheel.schedule(timer, 10);
+    clock.time = 1'009;
+    wheel.update();
+    EXPECT_FALSE(timer.isExpired());
+
+    clock.time = 1'010;
+    wheel.update();
+    EXPECT_TRUE(timer.isExpired());
+}
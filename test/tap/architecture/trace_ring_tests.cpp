@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/trace_ring.hpp"
+
+using namespace tap::arch;
+
+TEST(TraceRing, pop_returns_events_in_recorded_order)
+{
+    clock::ClockStub clock;
+    TraceRing ring;
+
+    clock.time = 10;
+    ring.record(1, 100);
+    const uint32_t firstTimestamp = clock::getCycleCount();
+    clock.time = 20;
+    ring.record(2, 200);
+
+    EXPECT_EQ(2u, ring.size());
+    TraceEvent event;
+    ASSERT_TRUE(ring.pop(event));
+    EXPECT_EQ(1, event.id);
+    EXPECT_EQ(firstTimestamp, event.timestamp);
+    EXPECT_EQ(100u, event.arg);
+    ASSERT_TRUE(ring.pop(event));
+    EXPECT_EQ(2, event.id);
+    EXPECT_EQ(clock::getCycleCount(), event.timestamp);
+    EXPECT_EQ(200u, event.arg);
+    EXPECT_FALSE(ring.pop(event));
+}
+
+TEST(TraceRing, full_ring_drops_new_events)
+{
+    TraceRing ring;
+
+    for (uint32_t i = 0; i < TraceRing::CAPACITY + 5; i++)
+    {
+        ring.record(1, i);
+    }
+
+    EXPECT_EQ(TraceRing::CAPACITY, ring.size());
+    EXPECT_EQ(5u, ring.getNumDropped());
+    TraceEvent event;
+    ASSERT_TRUE(ring.pop(event));
+    EXPECT_EQ(0u, event.arg);
+
+    // Popping makes room for new events
+    ring.record(2, 0);
+    EXPECT_EQ(5u, ring.getNumDropped());
+    EXPECT_EQ(TraceRing::CAPACITY, ring.size());
+}
+
+TEST(TraceRing, events_wrap_around_ring)
+{
+    TraceRing ring;
+    TraceEvent event;
+
+    for (uint32_t i = 0; i < 3 * TraceRing::CAPACITY; i++)
+    {
+        ring.record(1, i);
+        ASSERT_TRUE(ring.pop(event));
+        EXPECT_EQ(i, event.arg);
+    }
+    EXPECT_EQ(0u, ring.size());
+}
+
+TEST(TraceRing, clear_removes_events_and_drop_count)
+{
+    TraceRing ring;
+    for (uint32_t i = 0; i < TraceRing::CAPACITY + 1; i++)
+    {
+        ring.record(1, i);
+    }
+
+    ring.clear();
+
+    TraceEvent event;
+    EXPECT_FALSE(ring.pop(event));
+    EXPECT_EQ(0u, ring.getNumDropped());
+}
+
+TEST(TraceRing, recordToActive_records_only_to_active_ring)
+{
+    TraceRing ring;
+
+    TraceRing::recordToActive(1, 0);
+    EXPECT_EQ(0u, ring.size());
+
+    TraceRing::setActive(&ring);
+    TraceRing::recordToActive(static_cast<uint16_t>(TraceEventId::CAN_RX), 0x200);
+    TraceRing::setActive(nullptr);
+
+    TraceEvent event;
+    ASSERT_TRUE(ring.pop(event));
+    EXPECT_EQ(static_cast<uint16_t>(TraceEventId::CAN_RX), event.id);
+    EXPECT_EQ(0x200u, event.arg);
+}
+
+TEST(TraceRing, destroyed_ring_is_no_longer_active)
+{
+    {
+        TraceRing ring;
+        TraceRing::setActive(&ring);
+    }
+
+    EXPECT_EQ(nullptr, TraceRing::getActive());
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/wire_layout.hpp"
+
+using namespace tap::arch;
+
+using TestLayout = WireLayout<
+    WireField<uint16_t, 0, Endianness::BIG>,
+    WireField<int32_t, 2>,
+    WireField<float, 6>,
+    WireField<int8_t, 11>>;
+
+static_assert(TestLayout::SIZE == 12);
+
+// Integer fields are decoded at compile time
+static constexpr uint8_t CONSTANT_BYTES[] = {0x12, 0x34, 0xfe, 0xff, 0xff, 0xff};
+static_assert(WireField<uint16_t, 0, Endianness::BIG>::read(CONSTANT_BYTES) == 0x1234);
+static_assert(WireField<int32_t, 2>::read(CONSTANT_BYTES) == -2);
+
+TEST(WireLayout, decode_reads_each_field_in_its_byte_order)
+{
+    uint8_t bytes[] = {0x12, 0x34, 0x78, 0x56, 0x34, 0x12, 0, 0, 0xc0, 0x3f, 0xaa, 0xfd};
+
+    auto [a, b, c, d] = TestLayout::decode(bytes);
+
+    EXPECT_EQ(0x1234, a);
+    EXPECT_EQ(0x12345678, b);
+    EXPECT_EQ(1.5f, c);
+    EXPECT_EQ(-3, d);
+}
+
+TEST(WireLayout, encode_writes_only_field_bytes)
+{
+    uint8_t bytes[TestLayout::SIZE];
+    memset(bytes, 0xaa, sizeof(bytes));
+
+    TestLayout::encode(bytes, 0x1234, -2, -2.0f, 5);
+
+    uint8_t expected[] = {0x12, 0x34, 0xfe, 0xff, 0xff, 0xff, 0, 0, 0, 0xc0, 0xaa, 5};
+    for (size_t i = 0; i < sizeof(bytes); i++)
+    {
+        EXPECT_EQ(expected[i], bytes[i]) << i;
+    }
+}
+
+TEST(WireLayout, encode_then_decode_round_trips_at_unaligned_offset)
+{
+    using Layout = WireLayout<WireField<double, 1, Endianness::BIG>, WireField<uint64_t, 9>>;
+    uint8_t bytes[Layout::SIZE] = {};
+
+    Layout::encode(bytes, -123.456, 0x0123456789abcdef);
+
+    EXPECT_EQ(std::make_tuple(-123.456, uint64_t(0x0123456789abcdef)), Layout::decode(bytes));
+    EXPECT_EQ(0x01, bytes[16]);
+}
+
+TEST(WireLayout, enum_fields)
+{
+    enum class Mode : uint16_t
+    {
+        OFF = 0,
+        ON = 0x0102,
+    };
+    uint8_t bytes[2] = {};
+
+    WireField<Mode, 0, Endianness::BIG>::write(bytes, Mode::ON);
+
+    EXPECT_EQ(0x01, bytes[0]);
+    EXPECT_EQ(Mode::ON, (WireField<Mode, 0, Endianness::BIG>::read(bytes)));
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_bridge.hpp"
+#include "tap/drivers.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::can;
+using namespace tap::algorithms::transforms;
+using namespace testing;
+
+struct TestState
+{
+    int16_t setpoint;
+    uint8_t mode;
+    uint8_t flags;
+} modm_packed;
+
+class CanBridgeTest : public Test
+{
+protected:
+    CanBridgeTest() : bridge(&drivers, CanBus::CAN_BUS2) {}
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+        ON_CALL(drivers.can, sendMessage)
+            .WillByDefault(
+                [this](CanBus, const modm::can::Message &message)
+                {
+                    sentIds.push_back(message.getIdentifier());
+                    return true;
+                });
+    }
+
+    /// Calls `update` `ticks` times and returns the ids of the frames sent.
+    std::vector<uint32_t> runTicks(int ticks)
+    {
+        sentIds.clear();
+        for (int i = 0; i < ticks; i++)
+        {
+            bridge.update();
+        }
+        return sentIds;
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    CanBridge bridge;
+    std::vector<uint32_t> sentIds;
+};
+
+TEST_F(CanBridgeTest, published_channel_sent_every_tick)
+{
+    CanBridgeTx<TestState> tx(0x300);
+    ASSERT_TRUE(bridge.addTxChannel(&tx));
+
+    modm::can::Message sent;
+    EXPECT_CALL(drivers.can, sendMessage(CanBus::CAN_BUS2, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SaveArg<1>(&sent), Return(true)));
+
+    tx.publish({-1234, 3, 0x81});
+    bridge.update();
+    bridge.update();
+
+    EXPECT_EQ(0x300u, sent.getIdentifier());
+    EXPECT_FALSE(sent.isExtended());
+    ASSERT_EQ(sizeof(TestState), sent.getLength());
+    TestState decoded;
+    memcpy(&decoded, sent.data, sizeof(decoded));
+    EXPECT_EQ(-1234, decoded.setpoint);
+    EXPECT_EQ(3, decoded.mode);
+    EXPECT_EQ(0x81, decoded.flags);
+    EXPECT_EQ(2u, tx.getNumSent());
+}
+
+TEST_F(CanBridgeTest, nothing_sent_before_first_publish)
+{
+    CanBridgeTx<TestState> tx(0x300);
+    bridge.addTxChannel(&tx);
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    bridge.update();
+}
+
+TEST_F(CanBridgeTest, addTxChannel_rejects_invalid_channels)
+{
+    CanBridgeTx<TestState> tx(0x300);
+    CanBridgeTx<TestState> badPeriod(0x301, 3);
+    CanBridgeTx<TestState> longPeriod(0x302, 32);
+
+    EXPECT_FALSE(bridge.addTxChannel(nullptr));
+    EXPECT_TRUE(bridge.addTxChannel(&tx));
+    EXPECT_FALSE(bridge.addTxChannel(&tx));
+    EXPECT_FALSE(bridge.addTxChannel(&badPeriod));
+    EXPECT_FALSE(bridge.addTxChannel(&longPeriod));
+    EXPECT_EQ(1, bridge.getTxChannelCount());
+}
+
+TEST_F(CanBridgeTest, channels_sent_at_their_period)
+{
+    CanBridgeTx<TestState> fast(0x300, 1);
+    CanBridgeTx<TestState> slow(0x301, 4);
+    bridge.addTxChannel(&fast);
+    bridge.addTxChannel(&slow);
+    fast.publish({});
+    slow.publish({});
+
+    std::vector<uint32_t> sent = runTicks(16);
+
+    EXPECT_EQ(16, std::count(sent.begin(), sent.end(), 0x300));
+    EXPECT_EQ(4, std::count(sent.begin(), sent.end(), 0x301));
+}
+
+TEST_F(CanBridgeTest, phases_spread_channels_across_ticks)
+{
+    CanBridgeTx<TestState> channels[3] = {
+        CanBridgeTx<TestState>(0x300, 2),
+        CanBridgeTx<TestState>(0x301, 4),
+        CanBridgeTx<TestState>(0x302, 4),
+    };
+    for (auto &channel : channels)
+    {
+        ASSERT_TRUE(bridge.addTxChannel(&channel));
+        channel.publish({});
+    }
+
+    EXPECT_EQ(0, channels[0].getPhase());
+    EXPECT_EQ(1, channels[1].getPhase());
+    EXPECT_EQ(3, channels[2].getPhase());
+    EXPECT_EQ(1, bridge.getMaxFramesPerTick());
+
+    for (int tick = 0; tick < 16; tick++)
+    {
+        EXPECT_EQ(1u, runTicks(1).size()) << tick;
+    }
+}
+
+TEST_F(CanBridgeTest, peak_load_is_deterministic)
+{
+    CanBridgeTx<TestState> every(0x300, 1);
+    CanBridgeTx<TestState> half[3] = {
+        CanBridgeTx<TestState>(0x301, 2),
+        CanBridgeTx<TestState>(0x302, 2),
+        CanBridgeTx<TestState>(0x303, 2),
+    };
+    bridge.addTxChannel(&every);
+    every.publish({});
+    for (auto &channel : half)
+    {
+        bridge.addTxChannel(&channel);
+        channel.publish({});
+    }
+
+    EXPECT_EQ(3, bridge.getMaxFramesPerTick());
+
+    size_t peak = 0;
+    for (int tick = 0; tick < 32; tick++)
+    {
+        peak = std::max(peak, runTicks(1).size());
+    }
+    EXPECT_EQ(3u, peak);
+}
+
+TEST_F(CanBridgeTest, busy_bus_drops_frame_and_records_drop)
+{
+    CanBridgeTx<TestState> tx(0x300);
+    bridge.addTxChannel(&tx);
+    tx.publish({});
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    bridge.update();
+    bridge.update();
+
+    EXPECT_EQ(2u, tx.getNumDropped());
+    EXPECT_EQ(2u, drivers.can.getBusStats(CanBus::CAN_BUS2).txDrops);
+}
+
+TEST_F(CanBridgeTest, send_failure_raises_error)
+{
+    CanBridgeTx<TestState> tx(0x300);
+    bridge.addTxChannel(&tx);
+    tx.publish({});
+    ON_CALL(drivers.can, sendMessage).WillByDefault(Return(false));
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    bridge.update();
+}
+
+class CanBridgeRxTest : public Test
+{
+protected:
+    CanBridgeRxTest() : rx(&drivers, 0x300, CanBus::CAN_BUS2, 3'000) {}
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.canRxHandler, getRxTimestamp)
+            .WillByDefault([this]() { return rxTimestamp; });
+    }
+
+    void receive(const TestState &state, uint8_t length = sizeof(TestState))
+    {
+        modm::can::Message message(0x300, length);
+        memcpy(message.data, &state, sizeof(state));
+        rxTimestamp = clock.time * 1'000;
+        rx.processMessage(message);
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    uint32_t rxTimestamp = 0;
+    CanBridgeRx<TestState> rx;
+};
+
+TEST_F(CanBridgeRxTest, not_fresh_before_first_frame)
+{
+    EXPECT_FALSE(rx.isFresh());
+    EXPECT_EQ(UINT32_MAX, rx.getAgeUs());
+    EXPECT_EQ(0, rx.get().setpoint);
+}
+
+TEST_F(CanBridgeRxTest, received_value_fresh_until_timeout)
+{
+    clock.time = 100;
+    receive({500, 2, 1});
+
+    EXPECT_TRUE(rx.isFresh());
+    EXPECT_EQ(500, rx.get().setpoint);
+    EXPECT_EQ(2, rx.get().mode);
+
+    clock.time = 102;
+    EXPECT_EQ(2'000u, rx.getAgeUs());
+    EXPECT_TRUE(rx.isFresh());
+
+    clock.time = 103;
+    EXPECT_FALSE(rx.isFresh());
+}
+
+TEST_F(CanBridgeRxTest, wrong_length_frame_ignored)
+{
+    receive({500, 2, 1});
+    receive({-7, 0, 0}, 2);
+
+    EXPECT_EQ(500, rx.get().setpoint);
+    EXPECT_EQ(1u, rx.getNumReceived());
+    EXPECT_EQ(1u, rx.getNumLengthErrors());
+}
+
+TEST(CanBridgeQuaternion, pack_fits_one_frame_and_round_trips)
+{
+    static_assert(sizeof(CanBridgeQuaternion) == 8);
+    Quaternion q = Quaternion::fromEulerAngles(0.3f, -1.2f, 2.5f);
+
+    Quaternion unpacked = CanBridgeQuaternion::pack(q).unpack();
+
+    EXPECT_NEAR(q.w, unpacked.w, 1e-4f);
+    EXPECT_NEAR(q.x, unpacked.x, 1e-4f);
+    EXPECT_NEAR(q.y, unpacked.y, 1e-4f);
+    EXPECT_NEAR(q.z, unpacked.z, 1e-4f);
+}
+
+TEST(CanBridgeQuaternion, default_is_identity)
+{
+    Quaternion q = CanBridgeQuaternion().unpack();
+
+    EXPECT_FLOAT_EQ(1, q.w);
+    EXPECT_FLOAT_EQ(0, q.x);
+}
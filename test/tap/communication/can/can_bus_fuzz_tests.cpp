@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can.hpp"
+#include "tap/communication/can/can_rx_handler.hpp"
+#include "tap/communication/capture/capture_recorder.hpp"
+#include "tap/communication/capture/capture_replayer.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+using namespace tap::can;
+using namespace tap::communication::capture;
+using namespace tap::motor;
+using tap::arch::clock::ClockStub;
+
+static constexpr int NUM_MOTORS = 8;
+static constexpr CanBus BUSES[] = {CanBus::CAN_BUS1, CanBus::CAN_BUS2};
+
+/**
+ * Pushes frames through the real hosted `Can`, `CanRxHandler` and `DjiMotor`s on both buses, as
+ * opposed to `can_rx_handler_tests.cpp` and `dji_motor_tests.cpp`, which test each on its own.
+ */
+class CanBusFuzzTest : public testing::Test
+{
+protected:
+    CanBusFuzzTest() : handler(&drivers)
+    {
+        for (CanBus bus : BUSES)
+        {
+            for (int i = 0; i < NUM_MOTORS; i++)
+            {
+                motors.push_back(std::make_unique<DjiMotor>(
+                    &drivers,
+                    static_cast<MotorId>(MOTOR1 + i),
+                    bus,
+                    i % 2 == 1,
+                    "motor"));
+                handler.attachReceiveHandler(motors.back().get());
+            }
+        }
+    }
+
+    ~CanBusFuzzTest()
+    {
+        CaptureReplayer::setActive(nullptr);
+        for (auto &motor : motors)
+        {
+            handler.removeReceiveHandler(*motor);
+        }
+    }
+
+    DjiMotor &getMotor(CanBus bus, int index)
+    {
+        return *motors[(bus == CanBus::CAN_BUS1 ? 0 : NUM_MOTORS) + index];
+    }
+
+    /// Dispatches every frame `can` has received, like `CanRxHandler::pollCanData`.
+    int drainCan()
+    {
+        int numFrames = 0;
+        for (CanBus bus : BUSES)
+        {
+            while (const modm::can::Message *message = can.peekMessage(bus))
+            {
+                handler.processReceivedCanData(bus, *message);
+                can.popMessage(bus);
+                numFrames++;
+            }
+        }
+        return numFrames;
+    }
+
+    ClockStub clock;
+    tap::Drivers drivers;
+    Can can;
+    CanRxHandler handler;
+    std::vector<std::unique_ptr<DjiMotor>> motors;
+};
+
+TEST_F(CanBusFuzzTest, replayed_feedback_reaches_each_motor)
+{
+    static constexpr int NUM_ROUNDS = 100;
+    CaptureRecorder recorder;
+    std::vector<uint8_t> stream;
+    auto drainRecorder = [&]()
+    {
+        std::size_t offset = stream.size();
+        stream.resize(offset + recorder.getNumBuffered());
+        recorder.read(stream.data() + offset, stream.size() - offset);
+    };
+
+    recorder.start();
+    for (int round = 0; round < NUM_ROUNDS; round++)
+    {
+        for (CanBus bus : BUSES)
+        {
+            for (int i = 0; i < NUM_MOTORS; i++)
+            {
+                // The encoder advances by a quarter revolution per round
+                uint16_t encoder = (round * DjiMotor::ENC_RESOLUTION / 4 + i) %
+                                   DjiMotor::ENC_RESOLUTION;
+                modm::can::Message message(MOTOR1 + i, DjiMotor::FEEDBACK_MESSAGE_LENGTH);
+                message.setExtended(false);
+                message.data[0] = encoder >> 8;
+                message.data[1] = encoder & 0xff;
+                message.data[6] = round;
+                recorder.recordCan(CaptureSource::CAN_RX, bus, message);
+                drainRecorder();
+            }
+        }
+    }
+    ASSERT_EQ(0u, recorder.getNumDropped());
+
+    CaptureReplayer replayer;
+    ASSERT_TRUE(replayer.load(stream.data(), stream.size()));
+    CaptureReplayer::setActive(&replayer);
+
+    EXPECT_EQ(NUM_ROUNDS * NUM_MOTORS * 2, drainCan());
+
+    for (CanBus bus : BUSES)
+    {
+        for (int i = 0; i < NUM_MOTORS; i++)
+        {
+            const DjiMotor &motor = getMotor(bus, i);
+            int64_t encoder = (NUM_ROUNDS - 1) * DjiMotor::ENC_RESOLUTION / 4 + i;
+            EXPECT_TRUE(motor.isMotorOnline());
+            EXPECT_EQ(NUM_ROUNDS - 1, motor.getTemperature());
+            if (motor.isMotorInverted())
+            {
+                EXPECT_EQ(DjiMotor::ENC_RESOLUTION - 1 - encoder, motor.getEncoderUnwrapped());
+            }
+            else
+            {
+                EXPECT_EQ(encoder, motor.getEncoderUnwrapped());
+            }
+        }
+    }
+}
+
+TEST_F(CanBusFuzzTest, random_frames_keep_motor_feedback_consistent)
+{
+    static constexpr int NUM_FRAMES = 200'000;
+    std::mt19937 random(87);
+    std::uniform_int_distribution<uint32_t> byte(0, 0xff);
+
+    for (int frame = 0; frame < NUM_FRAMES; frame++)
+    {
+        // Half of the frames are for a motor, the rest have any standard or extended id
+        uint32_t id;
+        switch (byte(random) % 4)
+        {
+            case 0:
+            case 1:
+                id = MOTOR1 + byte(random) % NUM_MOTORS;
+                break;
+            case 2:
+                id = byte(random) << 3 | byte(random) % 8;
+                break;
+            default:
+                id = (byte(random) << 24 | byte(random) << 16 | byte(random) << 8 | byte(random)) &
+                     0x1fffffff;
+                break;
+        }
+        // Mostly full length frames, so that the encoder range check is reached
+        uint8_t length = byte(random) % 4 == 0 ? byte(random) % 9 : 8;
+        modm::can::Message message(id, length);
+        message.setExtended(id > 0x7ff);
+        for (uint8_t &data : message.data)
+        {
+            data = byte(random);
+        }
+        CanBus bus = BUSES[byte(random) % 2];
+
+        DjiMotor *target = id >= MOTOR1 && id < MOTOR1 + NUM_MOTORS
+                               ? &getMotor(bus, id - MOTOR1)
+                               : nullptr;
+        int64_t encoderBefore = target != nullptr ? target->getEncoderUnwrapped() : 0;
+        int8_t temperatureBefore = target != nullptr ? target->getTemperature() : 0;
+
+        handler.processReceivedCanData(bus, message);
+
+        if (target == nullptr)
+        {
+            continue;
+        }
+        uint16_t encoder = message.data[0] << 8 | message.data[1];
+        ASSERT_LT(target->getEncoderWrapped(), DjiMotor::ENC_RESOLUTION) << "frame " << frame;
+        ASSERT_LE(
+            std::abs(target->getEncoderUnwrapped() - encoderBefore),
+            DjiMotor::ENC_RESOLUTION / 2)
+            << "frame " << frame;
+        if (length == DjiMotor::FEEDBACK_MESSAGE_LENGTH && encoder < DjiMotor::ENC_RESOLUTION)
+        {
+            uint16_t expectedEncoder =
+                target->isMotorInverted() ? DjiMotor::ENC_RESOLUTION - 1 - encoder : encoder;
+            ASSERT_EQ(expectedEncoder, target->getEncoderWrapped()) << "frame " << frame;
+            ASSERT_EQ(static_cast<int8_t>(message.data[6]), target->getTemperature())
+                << "frame " << frame;
+        }
+        else
+        {
+            ASSERT_EQ(encoderBefore, target->getEncoderUnwrapped()) << "frame " << frame;
+            ASSERT_EQ(temperatureBefore, target->getTemperature()) << "frame " << frame;
+        }
+    }
+}
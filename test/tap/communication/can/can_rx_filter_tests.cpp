@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_rx_filter.hpp"
+
+using tap::can::CanRxFilter;
+using tap::can::CanRxFilterBuilder;
+
+static bool filtersAccept(const CanRxFilterBuilder &builder, uint16_t canId)
+{
+    for (int i = 0; i < builder.getFilterCount(); i++)
+    {
+        if (builder.getFilters()[i].accepts(canId))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int countAcceptedIds(const CanRxFilterBuilder &builder)
+{
+    int count = 0;
+    for (uint16_t id = 0; id <= CanRxFilter::STANDARD_ID_MASK; id++)
+    {
+        count += filtersAccept(builder, id);
+    }
+    return count;
+}
+
+TEST(CanRxFilter, accepts_matches_masked_bits)
+{
+    CanRxFilter filter{0x200, 0x7F8};
+
+    EXPECT_EQ(8, filter.getAcceptedIdCount());
+    EXPECT_TRUE(filter.accepts(0x200));
+    EXPECT_TRUE(filter.accepts(0x207));
+    EXPECT_FALSE(filter.accepts(0x208));
+    EXPECT_FALSE(filter.accepts(0x1FF));
+}
+
+TEST(CanRxFilterBuilder, no_ids_no_filters)
+{
+    CanRxFilterBuilder builder;
+
+    EXPECT_EQ(0, builder.getFilterCount());
+}
+
+TEST(CanRxFilterBuilder, single_id_exact_filter)
+{
+    CanRxFilterBuilder builder;
+
+    builder.addId(0x123);
+
+    ASSERT_EQ(1, builder.getFilterCount());
+    EXPECT_EQ(0x123, builder.getFilters()[0].id);
+    EXPECT_EQ(CanRxFilter::STANDARD_ID_MASK, builder.getFilters()[0].mask);
+}
+
+TEST(CanRxFilterBuilder, aligned_range_merged_into_one_mask_filter)
+{
+    CanRxFilterBuilder builder;
+
+    // DJI motor feedback ids for motors 8 through 15 would be 0x208 - 0x20F
+    for (uint16_t id = 0x208; id <= 0x20F; id++)
+    {
+        builder.addId(id);
+    }
+
+    ASSERT_EQ(1, builder.getFilterCount());
+    EXPECT_EQ(0x208, builder.getFilters()[0].id);
+    EXPECT_EQ(0x7F8, builder.getFilters()[0].mask);
+}
+
+TEST(CanRxFilterBuilder, unaligned_range_accepts_exactly_range)
+{
+    CanRxFilterBuilder builder;
+
+    for (uint16_t id = 0x201; id <= 0x208; id++)
+    {
+        builder.addId(id);
+    }
+
+    EXPECT_LE(builder.getFilterCount(), 4);
+    EXPECT_EQ(8, countAcceptedIds(builder));
+
+    for (uint16_t id = 0x201; id <= 0x208; id++)
+    {
+        EXPECT_TRUE(filtersAccept(builder, id));
+    }
+}
+
+TEST(CanRxFilterBuilder, duplicate_and_invalid_ids_ignored)
+{
+    CanRxFilterBuilder builder;
+
+    builder.addId(0x100);
+    builder.addId(0x100);
+    builder.addId(0x800);
+
+    EXPECT_EQ(1, builder.getFilterCount());
+    EXPECT_EQ(1, countAcceptedIds(builder));
+}
+
+TEST(CanRxFilterBuilder, too_many_ids_merged_to_max_filters_accepting_all_ids)
+{
+    CanRxFilterBuilder builder;
+    std::vector<uint16_t> ids;
+
+    // ids spaced out so no merge is free
+    for (uint16_t id = 0; id < 3 * CanRxFilterBuilder::MAX_FILTERS; id++)
+    {
+        ids.push_back(id * 7);
+        builder.addId(id * 7);
+    }
+
+    EXPECT_EQ(CanRxFilterBuilder::MAX_FILTERS, builder.getFilterCount());
+
+    for (uint16_t id : ids)
+    {
+        EXPECT_TRUE(filtersAccept(builder, id));
+    }
+
+    EXPECT_LT(countAcceptedIds(builder), CanRxFilter::STANDARD_ID_MASK + 1);
+}
@@ -21,6 +21,7 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/communication/can/can_rx_ring.hpp"
 #include "tap/drivers.hpp"
 #include "tap/mock/can_rx_handler_mock.hpp"
 #include "tap/mock/can_rx_listener_mock.hpp"
@@ -43,9 +44,35 @@ class CanRxHandlerTest : public Test
         }
     }
 
+    /// Makes the CAN mock read messages from `rxRings`.
+    void useRxRings()
+    {
+        ON_CALL(drivers.can, peekMessage)
+            .WillByDefault([&](tap::can::CanBus bus) { return ringFor(bus).front(); });
+        ON_CALL(drivers.can, popMessage)
+            .WillByDefault([&](tap::can::CanBus bus) { ringFor(bus).pop(); });
+        ON_CALL(drivers.can, getMessageTimestamp)
+            .WillByDefault([&](tap::can::CanBus bus) { return ringFor(bus).frontTimestamp(); });
+    }
+
+    void pushMessage(
+        tap::can::CanBus bus,
+        const modm::can::Message &message,
+        uint32_t rxTimestamp = 0)
+    {
+        *ringFor(bus).beginPush() = message;
+        ringFor(bus).endPush(rxTimestamp);
+    }
+
+    tap::can::CanRxRing<8> &ringFor(tap::can::CanBus bus)
+    {
+        return rxRings[bus == tap::can::CanBus::CAN_BUS1 ? 0 : 1];
+    }
+
     tap::Drivers drivers;
     tap::can::CanRxHandler handler;
     vector<unique_ptr<CanRxListenerMock>> listeners;
+    tap::can::CanRxRing<8> rxRings[2];
 };
 
 TEST(CanRxHandler, ListenerAttachesSelf)
@@ -111,25 +138,23 @@ TEST_F(CanRxHandlerTest, MessageIsProcessedByCorrectListener)
 
         const modm::can::Message rxMessage(listener->canIdentifier);
 
-        handler.processReceivedCanData(
-            rxMessage,
-            handler.getHandlerStore(tap::can::CanBus::CAN_BUS1));
+        handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, rxMessage);
     }
 }
 
 TEST_F(CanRxHandlerTest, ErrorIsThrownWithOOBMessageID)
 {
-    const modm::can::Message rxMessage(9);
+    const modm::can::Message rxMessage(tap::can::CanRxHandler::MAX_STANDARD_CAN_ID + 1);
 
     EXPECT_CALL(drivers.errorController, addToErrorList);
 
-    handler.processReceivedCanData(rxMessage, handler.getHandlerStore(tap::can::CanBus::CAN_BUS1));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, rxMessage);
 }
 
 TEST_F(CanRxHandlerTest, removeReceiveHandler__error_logged_with_oob_can_rx_listener_id)
 {
     CanRxListenerMock canRxListenerHi(&drivers, 0xffff, tap::can::CanBus::CAN_BUS1);
-    CanRxListenerMock canRxListenerLo(&drivers, 0x0, tap::can::CanBus::CAN_BUS1);
+    CanRxListenerMock canRxListenerLo(&drivers, 0x800, tap::can::CanBus::CAN_BUS1);
 
     EXPECT_CALL(drivers.errorController, addToErrorList).Times(2);
 
@@ -137,48 +162,269 @@ TEST_F(CanRxHandlerTest, removeReceiveHandler__error_logged_with_oob_can_rx_list
     handler.removeReceiveHandler(canRxListenerLo);
 }
 
+TEST_F(CanRxHandlerTest, processReceivedCanData_id_outside_dense_range_processed_by_listener)
+{
+    CanRxListenerMock listenerLo(&drivers, 0x0, tap::can::CanBus::CAN_BUS1);
+    CanRxListenerMock listenerHi(&drivers, 0x7ff, tap::can::CanBus::CAN_BUS1);
+
+    handler.attachReceiveHandler(&listenerLo);
+    handler.attachReceiveHandler(&listenerHi);
+
+    EXPECT_EQ(&listenerLo, handler.getListener(tap::can::CanBus::CAN_BUS1, 0x0));
+    EXPECT_EQ(&listenerHi, handler.getListener(tap::can::CanBus::CAN_BUS1, 0x7ff));
+    EXPECT_EQ(nullptr, handler.getListener(tap::can::CanBus::CAN_BUS1, 0x7fe));
+    EXPECT_EQ(nullptr, handler.getListener(tap::can::CanBus::CAN_BUS2, 0x7ff));
+
+    EXPECT_CALL(listenerLo, processMessage);
+    EXPECT_CALL(listenerHi, processMessage);
+
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, modm::can::Message(0x0));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, modm::can::Message(0x7ff));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS2, modm::can::Message(0x7ff));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, modm::can::Message(0x7fe));
+
+    handler.removeReceiveHandler(listenerLo);
+    handler.removeReceiveHandler(listenerHi);
+}
+
+TEST_F(CanRxHandlerTest, processReceivedCanData_message_without_listener_recorded_as_unmatched)
+{
+    CanRxListenerMock listener(&drivers, 0x100, tap::can::CanBus::CAN_BUS1);
+
+    handler.attachReceiveHandler(&listener);
+
+    EXPECT_CALL(listener, processMessage);
+
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, modm::can::Message(0x100));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS1, modm::can::Message(0x101));
+    handler.processReceivedCanData(tap::can::CanBus::CAN_BUS2, modm::can::Message(0x100));
+
+    EXPECT_EQ(1u, drivers.can.getBusStats(tap::can::CanBus::CAN_BUS1).unmatchedRxFrames);
+    EXPECT_EQ(1u, drivers.can.getBusStats(tap::can::CanBus::CAN_BUS2).unmatchedRxFrames);
+
+    handler.removeReceiveHandler(listener);
+}
+
+TEST_F(CanRxHandlerTest, attach_and_remove_update_rx_filters_of_listener_bus)
+{
+    vector<tap::can::CanRxFilter> can1Filters;
+    ON_CALL(drivers.can, setRxFilters(tap::can::CanBus::CAN_BUS1, _, _))
+        .WillByDefault(
+            [&](tap::can::CanBus, const tap::can::CanRxFilter *filters, int count)
+            { can1Filters.assign(filters, filters + count); });
+    EXPECT_CALL(drivers.can, setRxFilters(tap::can::CanBus::CAN_BUS1, _, _)).Times(6);
+    EXPECT_CALL(drivers.can, setRxFilters(tap::can::CanBus::CAN_BUS2, _, _)).Times(0);
+
+    constructListeners();
+
+    for (int i = 0; i < 3; i++)
+    {
+        handler.attachReceiveHandler(listeners[i].get());
+    }
+
+    // MOTOR1 through MOTOR3, filters for 0x201 and {0x202, 0x203}
+    ASSERT_EQ(2, can1Filters.size());
+    EXPECT_EQ(0x201, can1Filters[0].id);
+    EXPECT_EQ(0x7ff, can1Filters[0].mask);
+    EXPECT_EQ(0x202, can1Filters[1].id);
+    EXPECT_EQ(0x7fe, can1Filters[1].mask);
+
+    for (int i = 0; i < 3; i++)
+    {
+        handler.removeReceiveHandler(*listeners[i]);
+    }
+
+    EXPECT_TRUE(can1Filters.empty());
+}
+
+TEST_F(CanRxHandlerTest, removing_all_listeners_sets_no_rx_filters)
+{
+    CanRxListenerMock listener(&drivers, 0x100, tap::can::CanBus::CAN_BUS2);
+
+    handler.attachReceiveHandler(&listener);
+
+    EXPECT_CALL(drivers.can, setRxFilters(tap::can::CanBus::CAN_BUS2, _, 0));
+
+    handler.removeReceiveHandler(listener);
+}
+
+TEST_F(CanRxHandlerTest, attachReceiveHandler_same_id_on_both_buses_uses_separate_listeners)
+{
+    CanRxListenerMock listenerCan1(&drivers, 0x100, tap::can::CanBus::CAN_BUS1);
+    CanRxListenerMock listenerCan2(&drivers, 0x100, tap::can::CanBus::CAN_BUS2);
+
+    handler.attachReceiveHandler(&listenerCan1);
+    handler.attachReceiveHandler(&listenerCan2);
+
+    EXPECT_EQ(&listenerCan1, handler.getListener(tap::can::CanBus::CAN_BUS1, 0x100));
+    EXPECT_EQ(&listenerCan2, handler.getListener(tap::can::CanBus::CAN_BUS2, 0x100));
+
+    handler.removeReceiveHandler(listenerCan1);
+
+    EXPECT_EQ(nullptr, handler.getListener(tap::can::CanBus::CAN_BUS1, 0x100));
+    EXPECT_EQ(&listenerCan2, handler.getListener(tap::can::CanBus::CAN_BUS2, 0x100));
+
+    handler.removeReceiveHandler(listenerCan2);
+}
+
+TEST_F(CanRxHandlerTest, sparse_pages_shared_by_ids_in_block_and_freed_when_empty)
+{
+    CanRxListenerMock listener1(&drivers, 0x100, tap::can::CanBus::CAN_BUS1);
+    CanRxListenerMock listener2(&drivers, 0x10f, tap::can::CanBus::CAN_BUS1);
+    CanRxListenerMock listener3(&drivers, 0x110, tap::can::CanBus::CAN_BUS1);
+
+    const int freePages = tap::can::CanRxHandler::NUM_SPARSE_PAGES;
+
+    EXPECT_EQ(freePages, handler.getFreeSparsePageCount());
+
+    handler.attachReceiveHandler(&listener1);
+    handler.attachReceiveHandler(&listener2);
+    EXPECT_EQ(freePages - 1, handler.getFreeSparsePageCount());
+
+    handler.attachReceiveHandler(&listener3);
+    EXPECT_EQ(freePages - 2, handler.getFreeSparsePageCount());
+
+    handler.removeReceiveHandler(listener1);
+    EXPECT_EQ(freePages - 2, handler.getFreeSparsePageCount());
+
+    handler.removeReceiveHandler(listener2);
+    handler.removeReceiveHandler(listener3);
+    EXPECT_EQ(freePages, handler.getFreeSparsePageCount());
+}
+
+TEST_F(CanRxHandlerTest, attachReceiveHandler_dense_range_ids_do_not_use_sparse_pages)
+{
+    constructListeners();
+
+    for (auto &listener : listeners)
+    {
+        handler.attachReceiveHandler(listener.get());
+    }
+
+    EXPECT_EQ(tap::can::CanRxHandler::NUM_SPARSE_PAGES, handler.getFreeSparsePageCount());
+
+    for (auto &listener : listeners)
+    {
+        handler.removeReceiveHandler(*listener);
+    }
+}
+
+TEST_F(CanRxHandlerTest, attachReceiveHandler_error_when_no_free_sparse_pages)
+{
+    for (int i = 0; i <= tap::can::CanRxHandler::NUM_SPARSE_PAGES; i++)
+    {
+        listeners.push_back(make_unique<CanRxListenerMock>(
+            &drivers,
+            i * tap::can::CanRxHandler::SPARSE_PAGE_SIZE,
+            tap::can::CanBus::CAN_BUS1));
+    }
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    for (auto &listener : listeners)
+    {
+        handler.attachReceiveHandler(listener.get());
+    }
+
+    EXPECT_EQ(
+        nullptr,
+        handler.getListener(tap::can::CanBus::CAN_BUS1, listeners.back()->canIdentifier));
+
+    for (auto &listener : listeners)
+    {
+        handler.removeReceiveHandler(*listener);
+    }
+}
+
 TEST_F(CanRxHandlerTest, pollCanData_can1_calls_process_message_passing_msg_to_correct_listener)
 {
     constructListeners();
+    useRxRings();
 
     handler.attachReceiveHandler(listeners[0].get());
 
-    modm::can::Message msg(tap::motor::MOTOR1, 8, 0xffff'ffff'ffff'ffff, false);
-
-    ON_CALL(drivers.can, getMessage(tap::can::CanBus::CAN_BUS1, _))
-        .WillByDefault(
-            [&](tap::can::CanBus, modm::can::Message *message)
-            {
-                *message = msg;
-                return true;
-            });
-    ON_CALL(drivers.can, getMessage(tap::can::CanBus::CAN_BUS2, _))
-        .WillByDefault([&](tap::can::CanBus, modm::can::Message *) { return false; });
+    pushMessage(
+        tap::can::CanBus::CAN_BUS1,
+        modm::can::Message(tap::motor::MOTOR1, 8, 0xffff'ffff'ffff'ffff, false));
 
     EXPECT_CALL(*listeners[0], processMessage);
 
     handler.pollCanData();
+
+    EXPECT_TRUE(rxRings[0].isEmpty());
 }
 
 TEST_F(CanRxHandlerTest, pollCanData_can2_calls_process_message_passing_msg_to_correct_listener)
 {
     constructListeners(tap::can::CanBus::CAN_BUS2);
+    useRxRings();
 
     handler.attachReceiveHandler(listeners[0].get());
 
-    modm::can::Message msg(tap::motor::MOTOR1, 8, 0xffff'ffff'ffff'ffff, false);
-
-    ON_CALL(drivers.can, getMessage(tap::can::CanBus::CAN_BUS1, _))
-        .WillByDefault([&](tap::can::CanBus, modm::can::Message *) { return false; });
-    ON_CALL(drivers.can, getMessage(tap::can::CanBus::CAN_BUS2, _))
-        .WillByDefault(
-            [&](tap::can::CanBus, modm::can::Message *message)
-            {
-                *message = msg;
-                return true;
-            });
+    pushMessage(
+        tap::can::CanBus::CAN_BUS2,
+        modm::can::Message(tap::motor::MOTOR1, 8, 0xffff'ffff'ffff'ffff, false));
 
     EXPECT_CALL(*listeners[0], processMessage);
 
     handler.pollCanData();
+
+    EXPECT_TRUE(rxRings[1].isEmpty());
+}
+
+TEST_F(CanRxHandlerTest, pollCanData_dispatches_at_most_max_frames_per_bus)
+{
+    constructListeners();
+    useRxRings();
+
+    handler.attachReceiveHandler(listeners[0].get());
+
+    for (int i = 0; i < 5; i++)
+    {
+        pushMessage(tap::can::CanBus::CAN_BUS1, modm::can::Message(tap::motor::MOTOR1));
+    }
+
+    EXPECT_CALL(*listeners[0], processMessage).Times(5);
+
+    handler.pollCanData(3);
+    EXPECT_EQ(2, rxRings[0].size());
+
+    handler.pollCanData(3);
+    EXPECT_TRUE(rxRings[0].isEmpty());
+}
+
+TEST_F(CanRxHandlerTest, pollCanData_passes_message_to_listener_in_place)
+{
+    constructListeners();
+    useRxRings();
+
+    handler.attachReceiveHandler(listeners[0].get());
+
+    pushMessage(tap::can::CanBus::CAN_BUS1, modm::can::Message(tap::motor::MOTOR1));
+
+    const modm::can::Message *ringMessage = rxRings[0].front();
+
+    EXPECT_CALL(*listeners[0], processMessage)
+        .WillOnce([&](const modm::can::Message &message) { EXPECT_EQ(ringMessage, &message); });
+
+    handler.pollCanData(1);
+}
+
+TEST_F(CanRxHandlerTest, pollCanData_rx_timestamp_of_message_available_to_listener)
+{
+    constructListeners();
+    useRxRings();
+
+    handler.attachReceiveHandler(listeners[0].get());
+    handler.attachReceiveHandler(listeners[1].get());
+
+    pushMessage(tap::can::CanBus::CAN_BUS1, modm::can::Message(tap::motor::MOTOR1), 1'000);
+    pushMessage(tap::can::CanBus::CAN_BUS1, modm::can::Message(tap::motor::MOTOR2), 1'250);
+
+    EXPECT_CALL(*listeners[0], processMessage)
+        .WillOnce([&](const modm::can::Message &) { EXPECT_EQ(1'000u, handler.getRxTimestamp()); });
+    EXPECT_CALL(*listeners[1], processMessage)
+        .WillOnce([&](const modm::can::Message &) { EXPECT_EQ(1'250u, handler.getRxTimestamp()); });
+
+    handler.pollCanData(2);
 }
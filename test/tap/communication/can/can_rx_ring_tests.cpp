@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_rx_ring.hpp"
+
+using tap::can::CanRxRing;
+
+TEST(CanRxRing, new_ring_is_empty)
+{
+    CanRxRing<4> ring;
+
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_EQ(0, ring.size());
+    EXPECT_EQ(nullptr, ring.front());
+    EXPECT_EQ(0u, ring.getOverflowCount());
+}
+
+TEST(CanRxRing, frames_read_in_order_pushed)
+{
+    CanRxRing<4> ring;
+
+    for (uint32_t id = 1; id <= 3; id++)
+    {
+        ring.beginPush()->setIdentifier(id);
+        ring.endPush();
+    }
+
+    EXPECT_EQ(3, ring.size());
+
+    for (uint32_t id = 1; id <= 3; id++)
+    {
+        ASSERT_NE(nullptr, ring.front());
+        EXPECT_EQ(id, ring.front()->getIdentifier());
+        ring.pop();
+    }
+
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(CanRxRing, frame_not_visible_until_end_push)
+{
+    CanRxRing<4> ring;
+
+    ring.beginPush()->setIdentifier(0x201);
+
+    EXPECT_EQ(nullptr, ring.front());
+
+    ring.endPush();
+
+    EXPECT_EQ(0x201u, ring.front()->getIdentifier());
+}
+
+TEST(CanRxRing, front_returns_slot_written_by_producer)
+{
+    CanRxRing<4> ring;
+
+    modm::can::Message *slot = ring.beginPush();
+    ring.endPush();
+
+    EXPECT_EQ(slot, ring.front());
+}
+
+TEST(CanRxRing, front_timestamp_matches_front_frame)
+{
+    CanRxRing<4> ring;
+
+    EXPECT_EQ(0u, ring.frontTimestamp());
+
+    ring.beginPush();
+    ring.endPush(100);
+    ring.beginPush();
+    ring.endPush(200);
+
+    EXPECT_EQ(100u, ring.frontTimestamp());
+    ring.pop();
+    EXPECT_EQ(200u, ring.frontTimestamp());
+    ring.pop();
+    EXPECT_EQ(0u, ring.frontTimestamp());
+}
+
+TEST(CanRxRing, full_ring_drops_frames_and_counts_overflow)
+{
+    CanRxRing<2> ring;
+
+    ASSERT_NE(nullptr, ring.beginPush());
+    ring.endPush();
+    ASSERT_NE(nullptr, ring.beginPush());
+    ring.endPush();
+
+    EXPECT_EQ(nullptr, ring.beginPush());
+    EXPECT_EQ(nullptr, ring.beginPush());
+    EXPECT_EQ(2u, ring.getOverflowCount());
+    EXPECT_EQ(2, ring.size());
+
+    ring.pop();
+
+    EXPECT_NE(nullptr, ring.beginPush());
+}
+
+TEST(CanRxRing, indices_wrap_around_capacity)
+{
+    CanRxRing<2> ring;
+
+    for (uint32_t id = 0; id < 10; id++)
+    {
+        ring.beginPush()->setIdentifier(id);
+        ring.endPush();
+
+        ASSERT_EQ(1, ring.size());
+        EXPECT_EQ(id, ring.front()->getIdentifier());
+        ring.pop();
+    }
+
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(CanRxRing, pop_on_empty_ring_does_nothing)
+{
+    CanRxRing<2> ring;
+
+    ring.pop();
+
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_NE(nullptr, ring.beginPush());
+}
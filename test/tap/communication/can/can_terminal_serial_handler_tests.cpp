@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_terminal_serial_handler.hpp"
+#include "tap/drivers.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace testing;
+using tap::can::CanBus;
+using tap::can::CanTerminalSerialHandler;
+
+class CanTerminalSerialHandlerTest : public Test
+{
+protected:
+    CanTerminalSerialHandlerTest()
+        : handler(&drivers),
+          terminalDevice(&drivers),
+          stream(terminalDevice)
+    {
+    }
+
+    tap::Drivers drivers;
+    CanTerminalSerialHandler handler;
+    tap::stub::TerminalDeviceStub terminalDevice;
+    modm::IOStream stream;
+};
+
+TEST_F(CanTerminalSerialHandlerTest, init__adds_itself_to_terminal_serial)
+{
+    EXPECT_CALL(drivers.terminalSerial, addHeader(StrEq("can"), &handler));
+
+    handler.init();
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__invalid_input_prints_usage)
+{
+    char input[] = "asdf";
+
+    EXPECT_FALSE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__no_input_prints_usage)
+{
+    char input[] = "";
+
+    EXPECT_FALSE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__multiple_arguments_prints_usage)
+{
+    char input[] = "stats reset";
+
+    EXPECT_FALSE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__H_prints_usage)
+{
+    char input[] = "-H";
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__stats_prints_each_bus)
+{
+    drivers.can.recordRxFrame(CanBus::CAN_BUS1, modm::can::Message(0x201, 8));
+    drivers.can.recordRxFrame(CanBus::CAN_BUS1, modm::can::Message(0x201, 8));
+    drivers.can.recordTxDrops(CanBus::CAN_BUS2, 7);
+
+    char input[] = "stats";
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, true));
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("load%"));
+    EXPECT_THAT(output, HasSubstr("1\t2\t0\t0\t0\t0\t0\t0\t0\t0.0"));
+    EXPECT_THAT(output, HasSubstr("2\t0\t0\t0\t7\t0\t0\t0\t0\t0.0"));
+}
+
+TEST_F(CanTerminalSerialHandlerTest, terminalSerialCallback__reset_resets_stats)
+{
+    drivers.can.recordTxDrops(CanBus::CAN_BUS1, 7);
+
+    char input[] = "reset";
+
+    EXPECT_TRUE(handler.terminalSerialCallback(input, stream, false));
+    EXPECT_EQ(0u, drivers.can.getBusStats(CanBus::CAN_BUS1).txDrops);
+}
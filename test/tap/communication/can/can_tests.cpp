@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using tap::can::Can;
+using tap::can::CanBus;
+
+static modm::can::Message standardMessage(uint8_t length)
+{
+    modm::can::Message message(0x200, length);
+    message.setExtended(false);
+    return message;
+}
+
+TEST(Can, getFrameBits_standard_frame_includes_worst_case_stuffing)
+{
+    // 47 + 8 * 8 nominal bits, (34 + 64 - 1) / 4 stuff bits
+    EXPECT_EQ(135u, Can::getFrameBits(standardMessage(8)));
+    // 47 nominal bits, (34 - 1) / 4 stuff bits
+    EXPECT_EQ(55u, Can::getFrameBits(standardMessage(0)));
+}
+
+TEST(Can, getFrameBits_extended_frame_larger_than_standard)
+{
+    modm::can::Message extended(0x200, 8);
+    extended.setExtended(true);
+
+    // 67 + 8 * 8 nominal bits, (54 + 64 - 1) / 4 stuff bits
+    EXPECT_EQ(160u, Can::getFrameBits(extended));
+}
+
+TEST(Can, getFrameBits_remote_frame_has_no_data)
+{
+    modm::can::Message remote = standardMessage(8);
+    remote.setRemoteTransmitRequest(true);
+
+    EXPECT_EQ(Can::getFrameBits(standardMessage(0)), Can::getFrameBits(remote));
+}
+
+TEST(Can, new_can_has_no_stats)
+{
+    Can can;
+
+    const Can::BusStats &stats = can.getBusStats(CanBus::CAN_BUS1);
+
+    EXPECT_EQ(0u, stats.rxFrames);
+    EXPECT_EQ(0u, stats.txFrames);
+    EXPECT_EQ(0u, stats.txFailures);
+    EXPECT_EQ(0u, stats.txDrops);
+    EXPECT_EQ(0u, stats.unmatchedRxFrames);
+    EXPECT_EQ(0u, stats.errorPassiveEvents);
+    EXPECT_EQ(0u, stats.busOffEvents);
+    EXPECT_EQ(0, stats.busLoad);
+}
+
+TEST(Can, record_functions_count_per_bus)
+{
+    Can can;
+
+    can.recordRxFrame(CanBus::CAN_BUS1, standardMessage(8));
+    can.recordRxFrame(CanBus::CAN_BUS1, standardMessage(8));
+    can.recordTxFrame(CanBus::CAN_BUS1, standardMessage(8), true);
+    can.recordTxFrame(CanBus::CAN_BUS1, standardMessage(8), false);
+    can.recordTxDrops(CanBus::CAN_BUS1, 3);
+    can.recordUnmatchedRxFrame(CanBus::CAN_BUS1);
+    can.recordTxFrame(CanBus::CAN_BUS2, standardMessage(8), true);
+
+    const Can::BusStats &can1 = can.getBusStats(CanBus::CAN_BUS1);
+    EXPECT_EQ(2u, can1.rxFrames);
+    EXPECT_EQ(1u, can1.txFrames);
+    EXPECT_EQ(1u, can1.txFailures);
+    EXPECT_EQ(3u, can1.txDrops);
+    EXPECT_EQ(1u, can1.unmatchedRxFrames);
+
+    const Can::BusStats &can2 = can.getBusStats(CanBus::CAN_BUS2);
+    EXPECT_EQ(0u, can2.rxFrames);
+    EXPECT_EQ(1u, can2.txFrames);
+    EXPECT_EQ(0u, can2.txDrops);
+}
+
+TEST(Can, recordErrorState_counts_entering_each_state_once)
+{
+    Can can;
+
+    can.recordErrorState(CanBus::CAN_BUS1, true, false);
+    can.recordErrorState(CanBus::CAN_BUS1, true, false);
+    can.recordErrorState(CanBus::CAN_BUS1, true, true);
+    can.recordErrorState(CanBus::CAN_BUS1, false, false);
+    can.recordErrorState(CanBus::CAN_BUS1, true, false);
+
+    const Can::BusStats &stats = can.getBusStats(CanBus::CAN_BUS1);
+    EXPECT_EQ(2u, stats.errorPassiveEvents);
+    EXPECT_EQ(1u, stats.busOffEvents);
+    EXPECT_EQ(0u, can.getBusStats(CanBus::CAN_BUS2).errorPassiveEvents);
+}
+
+TEST(Can, getBusStats_bus_load_computed_over_sample_period)
+{
+    tap::arch::clock::ClockStub clock;
+    Can can;
+
+    // start the sample period
+    can.getBusStats(CanBus::CAN_BUS1);
+
+    // 6 motors sending feedback at 1 kHz for one sample period
+    const int frames = 6 * Can::BUS_LOAD_SAMPLE_PERIOD_US / 1000;
+    for (int i = 0; i < frames; i++)
+    {
+        can.recordRxFrame(CanBus::CAN_BUS1, standardMessage(8));
+    }
+
+    clock.time = Can::BUS_LOAD_SAMPLE_PERIOD_US / 1000;
+
+    const float expectedLoad = 100.0f * frames * Can::getFrameBits(standardMessage(8)) /
+                               (Can::BIT_RATE * (Can::BUS_LOAD_SAMPLE_PERIOD_US / 1e6f));
+
+    EXPECT_NEAR(expectedLoad, can.getBusStats(CanBus::CAN_BUS1).busLoad, 1e-3);
+    EXPECT_EQ(0, can.getBusStats(CanBus::CAN_BUS2).busLoad);
+}
+
+TEST(Can, getBusStats_bus_load_not_updated_before_sample_period_elapses)
+{
+    tap::arch::clock::ClockStub clock;
+    Can can;
+
+    can.getBusStats(CanBus::CAN_BUS1);
+    can.recordTxFrame(CanBus::CAN_BUS1, standardMessage(8), true);
+
+    clock.time = Can::BUS_LOAD_SAMPLE_PERIOD_US / 1000 - 1;
+
+    EXPECT_EQ(0, can.getBusStats(CanBus::CAN_BUS1).busLoad);
+
+    clock.time++;
+
+    EXPECT_LT(0, can.getBusStats(CanBus::CAN_BUS1).busLoad);
+}
+
+TEST(Can, resetBusStats_clears_all_buses)
+{
+    Can can;
+
+    can.recordRxFrame(CanBus::CAN_BUS1, standardMessage(8));
+    can.recordTxDrops(CanBus::CAN_BUS2, 1);
+
+    can.resetBusStats();
+
+    EXPECT_EQ(0u, can.getBusStats(CanBus::CAN_BUS1).rxFrames);
+    EXPECT_EQ(0u, can.getBusStats(CanBus::CAN_BUS2).txDrops);
+}
+
+TEST(Can, setRxFilters_stores_filters)
+{
+    Can can;
+    tap::can::CanRxFilter filters[2] = {{0x200, 0x7f8}, {0x100, 0x7ff}};
+
+    EXPECT_EQ(0, can.getRxFilterCount(CanBus::CAN_BUS1));
+
+    can.setRxFilters(CanBus::CAN_BUS1, filters, 2);
+
+    ASSERT_EQ(2, can.getRxFilterCount(CanBus::CAN_BUS1));
+    EXPECT_EQ(filters[0], can.getRxFilters(CanBus::CAN_BUS1)[0]);
+    EXPECT_EQ(filters[1], can.getRxFilters(CanBus::CAN_BUS1)[1]);
+    EXPECT_EQ(0, can.getRxFilterCount(CanBus::CAN_BUS2));
+}
+
+TEST(Can, setRxFilters_too_many_filters_accepts_all)
+{
+    Can can;
+    tap::can::CanRxFilter filters[tap::can::CanRxFilterBuilder::MAX_FILTERS + 1];
+
+    can.setRxFilters(CanBus::CAN_BUS1, filters, tap::can::CanRxFilterBuilder::MAX_FILTERS + 1);
+
+    EXPECT_EQ(0, can.getRxFilterCount(CanBus::CAN_BUS1));
+}
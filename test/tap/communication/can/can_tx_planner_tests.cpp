@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/can/can_tx_planner.hpp"
+
+using tap::can::CanTxPlanner;
+
+/// Time to send an 8 byte frame at 1 Mbps.
+static constexpr uint32_t FRAME_TIME = 135;
+
+/// Adds the feedback of four DJI motors, sent at the same time every millisecond.
+static void addFeedbackBurst(CanTxPlanner &planner, uint32_t offset)
+{
+    for (uint16_t id = 0x201; id <= 0x204; id++)
+    {
+        ASSERT_TRUE(planner.addFixedFrame(id, 8, 1'000, offset));
+    }
+}
+
+TEST(CanTxPlanner, getTransmitTime_includes_worst_case_stuffing)
+{
+    CanTxPlanner planner;
+    CanTxPlanner slowPlanner(500'000);
+
+    EXPECT_EQ(FRAME_TIME, planner.getTransmitTime(8));
+    EXPECT_EQ(55u, planner.getTransmitTime(0));
+    EXPECT_EQ(2 * FRAME_TIME, slowPlanner.getTransmitTime(8));
+}
+
+TEST(CanTxPlanner, command_frame_placed_after_feedback_burst)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_TRUE(planner.plan());
+
+    EXPECT_EQ(4 * FRAME_TIME, planner.getOffset(0x200));
+    EXPECT_EQ(0u, planner.getOffset(0x201));
+    // Each frame may be blocked by a lower priority frame that started just before it
+    EXPECT_EQ(2 * FRAME_TIME, planner.getWorstCaseLatency(0x200));
+    EXPECT_EQ(2 * FRAME_TIME, planner.getWorstCaseLatency(0x201));
+    EXPECT_EQ(4 * FRAME_TIME, planner.getWorstCaseLatency(0x204));
+}
+
+TEST(CanTxPlanner, tx_frames_do_not_arbitrate_against_each_other)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    planner.addTxFrame(0x200, 8, 1'000);
+    planner.addTxFrame(0x1FF, 8, 1'000);
+
+    EXPECT_TRUE(planner.plan());
+
+    // The higher priority frame is placed first, the other at the next resolution step after it
+    EXPECT_EQ(4 * FRAME_TIME, planner.getOffset(0x1FF));
+    EXPECT_EQ(680u, planner.getOffset(0x200));
+}
+
+TEST(CanTxPlanner, command_frame_placed_after_burst_that_wraps_around_period)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 700);
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_TRUE(planner.plan());
+
+    EXPECT_EQ(700 + 4 * FRAME_TIME - 1'000, planner.getOffset(0x200));
+}
+
+TEST(CanTxPlanner, frames_with_different_periods_sent_within_period)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    planner.addTxFrame(0x200, 8, 1'000);
+    planner.addTxFrame(0x1FF, 8, 2'000);
+    planner.addTxFrame(0x301, 4, 10'000);
+
+    EXPECT_TRUE(planner.plan());
+
+    EXPECT_EQ(10'000u, planner.getHyperperiod());
+    EXPECT_LT(planner.getOffset(0x301), 10'000u);
+    for (uint16_t id : {0x1FF, 0x200, 0x201, 0x204})
+    {
+        EXPECT_LE(planner.getWorstCaseLatency(id), 1'000u) << id;
+    }
+    EXPECT_LE(planner.getWorstCaseLatency(0x301), 10'000u);
+}
+
+TEST(CanTxPlanner, overloaded_bus_is_unschedulable)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    for (uint16_t id = 0x205; id <= 0x208; id++)
+    {
+        planner.addFixedFrame(id, 8, 1'000, 0);
+    }
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_GT(planner.getBusLoad(), 100.0f);
+    EXPECT_FALSE(planner.plan());
+    EXPECT_GT(planner.getWorstCaseLatency(0x208), 1'000u);
+}
+
+TEST(CanTxPlanner, invalid_frames_not_added)
+{
+    CanTxPlanner planner;
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_FALSE(planner.addTxFrame(0x200, 8, 1'000));
+    EXPECT_FALSE(planner.addTxFrame(0x800, 8, 1'000));
+    EXPECT_FALSE(planner.addTxFrame(0x201, 9, 1'000));
+    EXPECT_FALSE(planner.addTxFrame(0x201, 8, 0));
+    EXPECT_FALSE(planner.addFixedFrame(0x201, 8, 1'000, 1'000));
+    // The hyperperiod would be 1'000 * 997
+    EXPECT_FALSE(planner.addTxFrame(0x201, 8, 997));
+
+    EXPECT_EQ(1, planner.getFrameCount());
+    EXPECT_EQ(1'000u, planner.getHyperperiod());
+}
+
+TEST(CanTxPlanner, latencies_invalid_until_planned)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_EQ(CanTxPlanner::INVALID_TIME, planner.getOffset(0x200));
+    EXPECT_EQ(CanTxPlanner::INVALID_TIME, planner.getWorstCaseLatency(0x201));
+    EXPECT_EQ(CanTxPlanner::INVALID_TIME, planner.getOffset(0x300));
+
+    planner.plan();
+    planner.addTxFrame(0x1FF, 8, 1'000);
+
+    EXPECT_EQ(CanTxPlanner::INVALID_TIME, planner.getWorstCaseLatency(0x200));
+}
+
+TEST(CanTxPlanner, isReleased_from_offset_or_if_not_planned)
+{
+    CanTxPlanner planner;
+    addFeedbackBurst(planner, 0);
+    planner.addTxFrame(0x200, 8, 1'000);
+
+    EXPECT_TRUE(planner.isReleased(0x200, 0));
+
+    ASSERT_TRUE(planner.plan());
+
+    EXPECT_FALSE(planner.isReleased(0x200, 4 * FRAME_TIME - 1));
+    EXPECT_TRUE(planner.isReleased(0x200, 4 * FRAME_TIME));
+    EXPECT_TRUE(planner.isReleased(0x300, 0));
+}
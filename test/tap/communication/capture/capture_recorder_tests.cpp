@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/capture/capture_recorder.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::communication::capture;
+using namespace tap::arch;
+
+class CaptureRecorderTest : public testing::Test
+{
+protected:
+    void SetUp() override { recorder.start(); }
+
+    /// Reads the buffered stream, skipping the stream header.
+    std::vector<uint8_t> readRecords()
+    {
+        std::vector<uint8_t> data(recorder.getNumBuffered());
+        data.resize(recorder.read(data.data(), data.size()));
+        data.erase(data.begin(), data.begin() + CAPTURE_HEADER_SIZE);
+        return data;
+    }
+
+    clock::ClockStub clock;
+    CaptureRecorder recorder;
+};
+
+TEST_F(CaptureRecorderTest, start_writes_stream_header)
+{
+    uint8_t header[CAPTURE_HEADER_SIZE];
+
+    ASSERT_EQ(CAPTURE_HEADER_SIZE, recorder.read(header, sizeof(header)));
+
+    uint32_t magic;
+    uint16_t version;
+    convertFromLittleEndian(&magic, header);
+    convertFromLittleEndian(&version, header + 4);
+    EXPECT_EQ(CAPTURE_MAGIC, magic);
+    EXPECT_EQ(CAPTURE_VERSION, version);
+}
+
+TEST_F(CaptureRecorderTest, record_writes_header_and_payload)
+{
+    const uint8_t payload[] = {1, 2, 3};
+    clock.time = 1;
+
+    recorder.record(CaptureSource::UART_RX, 3, payload, sizeof(payload));
+
+    std::vector<uint8_t> expected = {0xe8, 0x03, 0, 0, 3, 3, 3, 0, 1, 2, 3};
+    EXPECT_EQ(expected, readRecords());
+}
+
+TEST_F(CaptureRecorderTest, recordCan_writes_identifier_and_data)
+{
+    modm::can::Message message(0x201, 2);
+    message.setExtended(false);
+    message.data[0] = 0xab;
+    message.data[1] = 0xcd;
+
+    recorder.recordCan(CaptureSource::CAN_RX, tap::can::CanBus::CAN_BUS2, message);
+
+    std::vector<uint8_t> expected = {0, 0, 0, 0, 1, 1, 6, 0, 0x01, 0x02, 0, 0, 0xab, 0xcd};
+    EXPECT_EQ(expected, readRecords());
+}
+
+TEST_F(CaptureRecorderTest, uart_bytes_at_same_time_share_a_record)
+{
+    const uint8_t byte = 7;
+
+    recorder.record(CaptureSource::UART_RX, 1, &byte, 1);
+    recorder.record(CaptureSource::UART_RX, 1, &byte, 1);
+    recorder.record(CaptureSource::UART_RX, 2, &byte, 1);
+
+    std::vector<uint8_t> expected = {0, 0, 0, 0, 3, 1, 2, 0, 7, 7, 0, 0, 0, 0, 3, 2, 1, 0, 7};
+    EXPECT_EQ(expected, readRecords());
+}
+
+TEST_F(CaptureRecorderTest, uart_bytes_not_appended_to_record_already_read)
+{
+    const uint8_t byte = 7;
+    uint8_t data[64];
+
+    recorder.record(CaptureSource::UART_RX, 1, &byte, 1);
+    recorder.read(data, sizeof(data));
+    recorder.record(CaptureSource::UART_RX, 1, &byte, 1);
+
+    EXPECT_EQ(CAPTURE_RECORD_HEADER_SIZE + 1, recorder.read(data, sizeof(data)));
+}
+
+TEST_F(CaptureRecorderTest, record_that_does_not_fit_is_dropped_whole)
+{
+    uint8_t payload[1'000] = {};
+    const uint32_t recordSize = CAPTURE_RECORD_HEADER_SIZE + sizeof(payload);
+    const uint32_t fits = (CaptureRecorder::BUFFER_SIZE - CAPTURE_HEADER_SIZE) / recordSize;
+
+    for (uint32_t i = 0; i <= fits; i++)
+    {
+        recorder.record(CaptureSource::IMU, 0, payload, sizeof(payload));
+    }
+
+    EXPECT_EQ(1u, recorder.getNumDropped());
+    EXPECT_EQ(CAPTURE_HEADER_SIZE + fits * recordSize, recorder.getNumBuffered());
+}
+
+TEST_F(CaptureRecorderTest, buffer_wraps_around)
+{
+    uint8_t payload[100];
+    uint8_t data[CAPTURE_RECORD_HEADER_SIZE + sizeof(payload)];
+    recorder.read(data, CAPTURE_HEADER_SIZE);
+
+    for (int i = 0; i < 200; i++)
+    {
+        memset(payload, i, sizeof(payload));
+        clock.time = i;
+        recorder.record(CaptureSource::IMU, 0, payload, sizeof(payload));
+
+        ASSERT_EQ(sizeof(data), recorder.read(data, sizeof(data)));
+        EXPECT_EQ(CaptureSource::IMU, static_cast<CaptureSource>(data[4]));
+        EXPECT_EQ(i, data[sizeof(data) - 1]);
+    }
+    EXPECT_EQ(0u, recorder.getNumDropped());
+}
+
+TEST_F(CaptureRecorderTest, nothing_recorded_when_stopped)
+{
+    const uint8_t byte = 7;
+    recorder.stop();
+
+    recorder.record(CaptureSource::UART_RX, 1, &byte, 1);
+
+    EXPECT_EQ(CAPTURE_HEADER_SIZE, recorder.getNumBuffered());
+}
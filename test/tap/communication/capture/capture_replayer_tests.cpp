@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/capture/capture_recorder.hpp"
+#include "tap/communication/capture/capture_replayer.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::communication::capture;
+using namespace tap::arch;
+using tap::can::CanBus;
+
+class CaptureReplayerTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        recorder.start();
+        clock.time = 10'000;
+    }
+
+    /// Loads everything recorded so far into the replayer.
+    void loadRecorded()
+    {
+        std::vector<uint8_t> data(recorder.getNumBuffered());
+        recorder.read(data.data(), data.size());
+        ASSERT_TRUE(replayer.load(data.data(), data.size()));
+    }
+
+    clock::ClockStub clock;
+    CaptureRecorder recorder;
+    CaptureReplayer replayer;
+};
+
+TEST_F(CaptureReplayerTest, load_rejects_stream_without_header)
+{
+    const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    EXPECT_FALSE(replayer.load(data, sizeof(data)));
+}
+
+TEST_F(CaptureReplayerTest, replays_can_frames_on_recorded_bus)
+{
+    modm::can::Message sent(0x1fffffff, 3);
+    sent.setExtended(true);
+    sent.data[2] = 0x42;
+    recorder.recordCan(CaptureSource::CAN_RX, CanBus::CAN_BUS2, sent);
+    loadRecorded();
+    modm::can::Message received;
+
+    replayer.update(0);
+
+    EXPECT_FALSE(replayer.receiveCan(CanBus::CAN_BUS1, received));
+    ASSERT_TRUE(replayer.receiveCan(CanBus::CAN_BUS2, received));
+    EXPECT_EQ(0x1fffffffu, received.getIdentifier());
+    EXPECT_TRUE(received.isExtended());
+    EXPECT_EQ(3, received.getLength());
+    EXPECT_EQ(0x42, received.data[2]);
+    EXPECT_TRUE(replayer.isFinished());
+}
+
+TEST_F(CaptureReplayerTest, records_delivered_at_recorded_time_relative_to_first_update)
+{
+    const uint8_t bytes[] = {1, 2, 3};
+    recorder.record(CaptureSource::UART_RX, 2, bytes, 1);
+    clock.time += 1;
+    recorder.record(CaptureSource::UART_RX, 2, bytes + 1, 2);
+    loadRecorded();
+    uint8_t data[4];
+
+    replayer.update(500'000);
+    EXPECT_EQ(1u, replayer.readUart(2, data, sizeof(data)));
+    EXPECT_EQ(1, data[0]);
+
+    replayer.update(500'999);
+    EXPECT_EQ(0u, replayer.readUart(2, data, sizeof(data)));
+    EXPECT_FALSE(replayer.isFinished());
+
+    replayer.update(501'000);
+    EXPECT_EQ(2u, replayer.readUart(2, data, sizeof(data)));
+    EXPECT_EQ(3, data[1]);
+    EXPECT_TRUE(replayer.isFinished());
+}
+
+TEST_F(CaptureReplayerTest, imu_sample_read_once)
+{
+    uint8_t sample[CAPTURE_IMU_SAMPLE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    recorder.record(CaptureSource::IMU, 0, sample, sizeof(sample));
+    loadRecorded();
+    uint8_t received[CAPTURE_IMU_SAMPLE_SIZE];
+
+    replayer.update(0);
+
+    ASSERT_TRUE(replayer.readImu(0, received));
+    EXPECT_EQ(12, received[11]);
+    EXPECT_FALSE(replayer.readImu(0, received));
+}
+
+TEST_F(CaptureReplayerTest, can_tx_records_are_not_received)
+{
+    modm::can::Message sent(0x200, 8);
+    recorder.recordCan(CaptureSource::CAN_TX, CanBus::CAN_BUS1, sent);
+    loadRecorded();
+    modm::can::Message received;
+
+    replayer.update(0);
+
+    EXPECT_FALSE(replayer.receiveCan(CanBus::CAN_BUS1, received));
+    EXPECT_EQ(0u, replayer.getNumSkipped());
+}
+
+TEST_F(CaptureReplayerTest, truncated_record_is_skipped)
+{
+    const uint8_t bytes[] = {1, 2, 3};
+    recorder.record(CaptureSource::UART_RX, 0, bytes, sizeof(bytes));
+    std::vector<uint8_t> data(recorder.getNumBuffered());
+    recorder.read(data.data(), data.size());
+    ASSERT_TRUE(replayer.load(data.data(), data.size() - 1));
+
+    replayer.update(0);
+
+    EXPECT_EQ(1u, replayer.getNumSkipped());
+    EXPECT_TRUE(replayer.isFinished());
+}
+
+TEST_F(CaptureReplayerTest, update_uses_clock)
+{
+    const uint8_t byte = 5;
+    recorder.record(CaptureSource::UART_RX, 0, &byte, 1);
+    clock.time += 2;
+    recorder.record(CaptureSource::UART_RX, 0, &byte, 1);
+    loadRecorded();
+    uint8_t data[2];
+
+    clock.time = 0;
+    replayer.update();
+    EXPECT_EQ(1u, replayer.readUart(0, data, sizeof(data)));
+
+    clock.time = 2;
+    replayer.update();
+    EXPECT_EQ(1u, replayer.readUart(0, data, sizeof(data)));
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/gpio/input_capture.hpp"
+
+using tap::gpio::InputCapture;
+using namespace testing;
+
+// The first input capture pin, whichever board the tests are built for
+static constexpr InputCapture::Pin PIN = static_cast<InputCapture::Pin>(0);
+
+class InputCaptureTest : public Test
+{
+protected:
+    void SetUp() override { inputCapture.enable(PIN, InputCapture::Edge::RISING); }
+
+    /**
+     * Simulates the interrupt reading an edge that happened at `time` microseconds with the
+     * counter having kept running for `latency` ticks since.
+     */
+    void edge(uint32_t time, uint16_t latency = 0, bool edgesMissed = false)
+    {
+        const uint16_t captureValue = time % InputCapture::COUNTER_PERIOD;
+        inputCapture.onCapture(
+            PIN,
+            captureValue,
+            captureValue + latency,
+            time + latency,
+            edgesMissed);
+    }
+
+    InputCapture::Capture getCapture()
+    {
+        InputCapture::Capture capture;
+        inputCapture.getCapture(PIN, &capture);
+        return capture;
+    }
+
+    tap::arch::clock::ClockStub clock;
+    InputCapture inputCapture;
+};
+
+TEST_F(InputCaptureTest, first_edge_has_no_period)
+{
+    edge(1'000);
+
+    InputCapture::Capture capture = getCapture();
+    EXPECT_EQ(1'000u, capture.time);
+    EXPECT_EQ(0u, capture.period);
+    EXPECT_EQ(1u, capture.count);
+}
+
+TEST_F(InputCaptureTest, edge_time_excludes_interrupt_latency)
+{
+    edge(1'000, 25);
+    edge(3'000, 3);
+
+    InputCapture::Capture capture = getCapture();
+    EXPECT_EQ(3'000u, capture.time);
+    EXPECT_EQ(2'000u, capture.period);
+}
+
+TEST_F(InputCaptureTest, period_measured_across_counter_wrap)
+{
+    edge(65'000);
+    edge(67'000);
+
+    EXPECT_EQ(2'000u, getCapture().period);
+}
+
+TEST_F(InputCaptureTest, period_longer_than_counter_period_measured_exactly)
+{
+    edge(65'000);
+    edge(65'000 + 3 * InputCapture::COUNTER_PERIOD + 123);
+
+    EXPECT_EQ(3 * InputCapture::COUNTER_PERIOD + 123, getCapture().period);
+}
+
+TEST_F(InputCaptureTest, period_measured_from_counter_when_clock_is_off_by_a_tick)
+{
+    edge(10'000);
+    // The microsecond clock read a tick late, the counter still gives the exact period
+    inputCapture.onCapture(PIN, 10'000 + 40'000, 10'000 + 40'000, 10'000 + 40'001);
+
+    EXPECT_EQ(40'000u, getCapture().period);
+}
+
+TEST_F(InputCaptureTest, period_measured_across_microsecond_clock_wrap)
+{
+    edge(UINT32_MAX - 499);
+    edge(500);
+
+    EXPECT_EQ(1'000u, getCapture().period);
+}
+
+TEST_F(InputCaptureTest, edges_missed_keeps_previous_period)
+{
+    edge(1'000);
+    edge(2'000);
+    edge(10'000, 0, true);
+
+    InputCapture::Capture capture = getCapture();
+    EXPECT_EQ(10'000u, capture.time);
+    EXPECT_EQ(1'000u, capture.period);
+    EXPECT_EQ(3u, capture.count);
+
+    edge(11'500);
+
+    EXPECT_EQ(1'500u, getCapture().period);
+}
+
+TEST_F(InputCaptureTest, getFrequency_zero_until_period_known)
+{
+    clock.time = 1;
+    edge(1'000);
+
+    EXPECT_EQ(0, inputCapture.getFrequency(PIN));
+}
+
+TEST_F(InputCaptureTest, getFrequency_from_period)
+{
+    edge(1'000);
+    edge(3'000);
+    clock.time = 3;
+
+    EXPECT_FLOAT_EQ(500, inputCapture.getFrequency(PIN));
+}
+
+TEST_F(InputCaptureTest, getFrequency_decays_once_edges_stop)
+{
+    edge(1'000);
+    edge(3'000);
+
+    clock.time = 7;
+    EXPECT_FLOAT_EQ(250, inputCapture.getFrequency(PIN));
+
+    clock.time = 1'003;
+    EXPECT_FLOAT_EQ(1, inputCapture.getFrequency(PIN));
+}
+
+TEST_F(InputCaptureTest, getCapture_returns_true_once_per_edge)
+{
+    InputCapture::Capture capture;
+    capture.time = 42;
+    EXPECT_FALSE(inputCapture.getCapture(PIN, &capture));
+    EXPECT_EQ(42u, capture.time);
+
+    edge(1'000);
+    edge(2'000);
+
+    EXPECT_TRUE(inputCapture.getCapture(PIN, &capture));
+    EXPECT_EQ(2'000u, capture.time);
+    EXPECT_FALSE(inputCapture.getCapture(PIN, &capture));
+    EXPECT_EQ(2'000u, capture.time);
+}
+
+TEST_F(InputCaptureTest, callback_called_with_each_edge)
+{
+    struct Edges
+    {
+        int count = 0;
+        InputCapture::Pin pin;
+        InputCapture::Capture capture;
+    } edges;
+    inputCapture.enable(
+        PIN,
+        InputCapture::Edge::BOTH,
+        [](void *context, InputCapture::Pin pin, const InputCapture::Capture &capture) {
+            Edges *edges = static_cast<Edges *>(context);
+            edges->count++;
+            edges->pin = pin;
+            edges->capture = capture;
+        },
+        &edges);
+
+    edge(1'000);
+    edge(1'800);
+
+    EXPECT_EQ(2, edges.count);
+    EXPECT_EQ(PIN, edges.pin);
+    EXPECT_EQ(1'800u, edges.capture.time);
+    EXPECT_EQ(800u, edges.capture.period);
+    EXPECT_EQ(2u, edges.capture.count);
+}
+
+TEST_F(InputCaptureTest, disabled_pin_ignores_edges_and_keeps_last_capture)
+{
+    edge(1'000);
+    inputCapture.disable(PIN);
+    edge(2'000);
+
+    InputCapture::Capture capture;
+    EXPECT_TRUE(inputCapture.getCapture(PIN, &capture));
+    EXPECT_EQ(1'000u, capture.time);
+    EXPECT_EQ(1u, capture.count);
+}
+
+TEST_F(InputCaptureTest, enable_clears_previous_captures)
+{
+    edge(1'000);
+    edge(2'000);
+
+    inputCapture.enable(PIN, InputCapture::Edge::FALLING);
+
+    InputCapture::Capture capture;
+    EXPECT_FALSE(inputCapture.getCapture(PIN, &capture));
+    edge(2'500);
+    EXPECT_TRUE(inputCapture.getCapture(PIN, &capture));
+    EXPECT_EQ(0u, capture.period);
+    EXPECT_EQ(1u, capture.count);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/referee/encoded_graphic.hpp"
+#include "tap/communication/serial/ref_serial_transmitter.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::communication::referee;
+using namespace tap::communication::serial;
+using namespace tap;
+using namespace testing;
+
+using Tx = RefSerialData::Tx;
+using RobotId = RefSerialData::RobotId;
+
+class EncodedGraphicTest : public Test
+{
+protected:
+    EncodedGraphicTest() : refSerialTransmitter(&drivers) {}
+
+    void SetUp() override
+    {
+        robotData.robotId = RobotId::BLUE_HERO;
+        ON_CALL(drivers.refSerial, getRobotData).WillByDefault(ReturnRef(robotData));
+        RefSerialTransmitter::configGraphicGenerics(
+            &graphic,
+            reinterpret_cast<const uint8_t *>("\x00\x00\x02"),
+            Tx::GRAPHIC_ADD,
+            1,
+            Tx::GraphicColor::GREEN);
+    }
+
+    /// @return `true` if `message` is encoded the same as by `RefSerialTransmitter::sendGraphic`.
+    template <typename MESSAGE>
+    bool encodedLikeTransmitter(const MESSAGE *message)
+    {
+        MESSAGE expected = *message;
+        refSerialTransmitter.sendGraphic(&expected, true, false);
+        return memcmp(&expected, message, sizeof(MESSAGE)) == 0;
+    }
+
+    Drivers drivers;
+    RefSerialTransmitter refSerialTransmitter;
+    RefSerialData::Rx::RobotData robotData = {};
+    Tx::GraphicData graphic = {};
+};
+
+TEST_F(EncodedGraphicTest, number_encoded_like_transmitter)
+{
+    RefSerialTransmitter::configInteger(20, 2, 100, 700, 42, &graphic);
+    EncodedNumberGraphic number(graphic);
+
+    EXPECT_FALSE(number.isEncoded());
+    number.encode(RobotId::BLUE_HERO);
+
+    EXPECT_TRUE(number.isEncoded());
+    EXPECT_EQ(42, number.getValue());
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, setInteger_updates_value_and_crc)
+{
+    RefSerialTransmitter::configInteger(20, 2, 100, 700, 0, &graphic);
+    EncodedNumberGraphic number(graphic);
+    number.encode(RobotId::BLUE_HERO);
+
+    EXPECT_TRUE(number.setInteger(-123'456));
+    EXPECT_FALSE(number.setInteger(-123'456));
+
+    EXPECT_EQ(-123'456, number.getMessage()->graphicData.value);
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, setFloat_stores_fixed_point_like_configFloatingNumber)
+{
+    RefSerialTransmitter::configFloatingNumber(20, 2, 2, 100, 700, 0, &graphic);
+    EncodedNumberGraphic number(graphic);
+    number.encode(RobotId::BLUE_HERO);
+    Tx::GraphicData expected = graphic;
+    RefSerialTransmitter::configFloatingNumber(20, 2, 2, 100, 700, 12.5f, &expected);
+
+    number.setFloat(12.5f);
+
+    EXPECT_EQ(expected.value, number.getValue());
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, number_value_set_before_encode_is_encoded)
+{
+    RefSerialTransmitter::configInteger(20, 2, 100, 700, 0, &graphic);
+    EncodedNumberGraphic number(graphic);
+
+    number.setInteger(7);
+    number.encode(RobotId::BLUE_HERO);
+
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, setOperation_updates_crc)
+{
+    RefSerialTransmitter::configInteger(20, 2, 100, 700, 0, &graphic);
+    EncodedNumberGraphic number(graphic);
+    number.encode(RobotId::BLUE_HERO);
+
+    number.setOperation(Tx::GRAPHIC_MODIFY);
+    number.setInteger(3);
+
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, number.getMessage()->graphicData.operation);
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, encode_for_new_robot_reencodes_headers)
+{
+    RefSerialTransmitter::configInteger(20, 2, 100, 700, 0, &graphic);
+    EncodedNumberGraphic number(graphic);
+    number.encode(RobotId::BLUE_HERO);
+
+    robotData.robotId = RobotId::RED_SOLDIER_1;
+    number.encode(RobotId::RED_SOLDIER_1);
+
+    EXPECT_EQ(
+        static_cast<uint16_t>(RobotId::RED_SOLDIER_1),
+        number.getMessage()->interactiveHeader.senderId);
+    EXPECT_TRUE(encodedLikeTransmitter(number.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, text_encoded_like_transmitter)
+{
+    EncodedTextGraphic text(graphic, 20, 2, 100, 800);
+    text.encode(RobotId::BLUE_HERO);
+
+    EXPECT_TRUE(text.setText("MODE: AIM"));
+    EXPECT_FALSE(text.setText("MODE: AIM"));
+
+    EXPECT_STREQ("MODE: AIM", text.getText());
+    EXPECT_EQ(9u, text.getMessage()->graphicData.endAngle);
+    EXPECT_TRUE(encodedLikeTransmitter(text.getMessage()));
+}
+
+TEST_F(EncodedGraphicTest, setText_same_and_different_length_update_crc)
+{
+    EncodedTextGraphic text(graphic, 20, 2, 100, 800);
+    text.encode(RobotId::BLUE_HERO);
+    text.setText("MODE: AIM");
+
+    text.setText("MODE: RUN");
+    EXPECT_TRUE(encodedLikeTransmitter(text.getMessage()));
+
+    text.setText("IDLE");
+    EXPECT_TRUE(encodedLikeTransmitter(text.getMessage()));
+    EXPECT_EQ(0, text.getMessage()->msg[5]);
+}
+
+TEST_F(EncodedGraphicTest, setText_truncates_long_text)
+{
+    EncodedTextGraphic text(graphic, 20, 2, 100, 800);
+    text.encode(RobotId::BLUE_HERO);
+
+    text.setText("0123456789012345678901234567890123456789");
+
+    EXPECT_EQ(29u, strlen(text.getText()));
+    EXPECT_TRUE(encodedLikeTransmitter(text.getMessage()));
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/referee/hud_compositor.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::communication::referee;
+using namespace tap::communication::serial;
+using namespace tap;
+using namespace testing;
+
+using Tx = RefSerialData::Tx;
+
+class HudCompositorTest : public Test
+{
+protected:
+    HudCompositorTest() : refSerialTransmitter(&drivers), compositor(&drivers, refSerialTransmitter)
+    {
+    }
+
+    void SetUp() override
+    {
+        for (int i = 0; i < NUM_GRAPHICS; i++)
+        {
+            uint8_t name[] = {0, 0, static_cast<uint8_t>(i)};
+            RefSerialTransmitter::configGraphicGenerics(
+                &graphics[i],
+                name,
+                Tx::GRAPHIC_ADD,
+                0,
+                Tx::GraphicColor::GREEN);
+            RefSerialTransmitter::configLine(2, 0, 0, 10 * i, 10 * i, &graphics[i]);
+        }
+    }
+
+    void addGraphics(int num)
+    {
+        for (int i = 0; i < num; i++)
+        {
+            ASSERT_TRUE(compositor.addGraphic(&graphics[i]));
+        }
+    }
+
+    static constexpr int NUM_GRAPHICS = 10;
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerialTransmitter refSerialTransmitter;
+    HudCompositor compositor;
+    Tx::GraphicData graphics[NUM_GRAPHICS];
+    Tx::GraphicData batch[HudCompositor::MAX_GRAPHICS_PER_MESSAGE];
+};
+
+TEST_F(HudCompositorTest, addGraphic_fails_with_duplicate_name)
+{
+    EXPECT_TRUE(compositor.addGraphic(&graphics[0]));
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    EXPECT_FALSE(compositor.addGraphic(&graphics[0]));
+}
+
+TEST_F(HudCompositorTest, packNextBatch_nothing_sent_when_no_graphics)
+{
+    EXPECT_EQ(0, compositor.packNextBatch(batch));
+}
+
+TEST_F(HudCompositorTest, packNextBatch_picks_smallest_message_all_changes_fit_in)
+{
+    addGraphics(1);
+    EXPECT_EQ(1, compositor.packNextBatch(batch));
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[0].operation);
+    EXPECT_EQ(0, compositor.packNextBatch(batch));
+}
+
+TEST_F(HudCompositorTest, packNextBatch_unused_slots_are_no_ops_when_few_graphics)
+{
+    addGraphics(3);
+
+    EXPECT_EQ(5, compositor.packNextBatch(batch));
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(Tx::GRAPHIC_ADD, batch[i].operation);
+    }
+    EXPECT_EQ(Tx::GRAPHIC_NO_OP, batch[3].operation);
+    EXPECT_EQ(Tx::GRAPHIC_NO_OP, batch[4].operation);
+    EXPECT_EQ(0, compositor.getNumChangedGraphics());
+}
+
+TEST_F(HudCompositorTest, packNextBatch_only_modified_graphics_resent)
+{
+    addGraphics(NUM_GRAPHICS);
+
+    EXPECT_EQ(7, compositor.packNextBatch(batch));
+    EXPECT_EQ(5, compositor.packNextBatch(batch));
+    EXPECT_EQ(0, compositor.getNumChangedGraphics());
+
+    clock.time = 100;
+    graphics[4].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    graphics[8].endX = 500;
+    // the operation field is owned by the compositor
+    graphics[9].operation = Tx::GRAPHIC_DELETE;
+
+    EXPECT_EQ(2, compositor.getNumChangedGraphics());
+    ASSERT_EQ(2, compositor.packNextBatch(batch));
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[0].operation);
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[1].operation);
+    EXPECT_EQ(static_cast<uint8_t>(Tx::GraphicColor::PINK), batch[0].color);
+    EXPECT_EQ(500, batch[1].endX);
+}
+
+TEST_F(HudCompositorTest, packNextBatch_higher_priority_changes_sent_first)
+{
+    for (int i = 0; i < NUM_GRAPHICS; i++)
+    {
+        compositor.addGraphic(&graphics[i], i == 8 ? 1 : 0);
+    }
+
+    ASSERT_EQ(7, compositor.packNextBatch(batch));
+    EXPECT_EQ(8, batch[0].name[2]);
+    for (int i = 1; i < 7; i++)
+    {
+        EXPECT_EQ(i - 1, batch[i].name[2]);
+    }
+}
+
+TEST_F(HudCompositorTest, packNextBatch_free_slots_resend_least_recently_sent_graphics)
+{
+    addGraphics(5);
+
+    clock.time = 0;
+    compositor.packNextBatch(batch);
+
+    clock.time = 100;
+    graphics[0].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    graphics[1].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    graphics[2].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    ASSERT_EQ(5, compositor.packNextBatch(batch));
+
+    clock.time = 200;
+    graphics[0].color = static_cast<uint8_t>(Tx::GraphicColor::BLACK);
+    ASSERT_EQ(1, compositor.packNextBatch(batch));
+
+    clock.time = 300;
+    graphics[1].color = static_cast<uint8_t>(Tx::GraphicColor::BLACK);
+    graphics[2].color = static_cast<uint8_t>(Tx::GraphicColor::BLACK);
+    graphics[3].color = static_cast<uint8_t>(Tx::GraphicColor::BLACK);
+
+    // 3 changed graphics go in a 5 graphic message, filled with the 2 least recently sent
+    ASSERT_EQ(5, compositor.packNextBatch(batch));
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[0].operation);
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[1].operation);
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[2].operation);
+    EXPECT_EQ(4, batch[3].name[2]);
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[3].operation);
+    EXPECT_EQ(0, batch[4].name[2]);
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[4].operation);
+}
+
+TEST_F(HudCompositorTest, resendAll_adds_all_graphics_again)
+{
+    addGraphics(2);
+    compositor.packNextBatch(batch);
+
+    compositor.resendAll();
+
+    EXPECT_EQ(2, compositor.getNumChangedGraphics());
+    ASSERT_EQ(2, compositor.packNextBatch(batch));
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[0].operation);
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[1].operation);
+}
+
+TEST_F(HudCompositorTest, markLayerDeleted_restores_graphics_on_layer_only)
+{
+    graphics[1].layer = 1;
+    graphics[2].layer = 1;
+    addGraphics(3);
+    compositor.packNextBatch(batch);
+
+    compositor.markLayerDeleted(1);
+
+    EXPECT_EQ(2, compositor.getNumRestoringGraphics());
+    ASSERT_EQ(2, compositor.packNextBatch(batch));
+    EXPECT_EQ(1, batch[0].name[2]);
+    EXPECT_EQ(2, batch[1].name[2]);
+    EXPECT_EQ(0, compositor.getNumRestoringGraphics());
+}
+
+TEST_F(HudCompositorTest, packNextBatch_restores_rate_limited_behind_owner_changes)
+{
+    addGraphics(NUM_GRAPHICS);
+    compositor.packNextBatch(batch);
+    compositor.packNextBatch(batch);
+
+    clock.time = 1'000;
+    compositor.resendAll();
+    ASSERT_EQ(7, compositor.packNextBatch(batch));
+    EXPECT_EQ(3, compositor.getNumRestoringGraphics());
+
+    // Restores wait for the restore interval, owner changes don't
+    clock.time = 1'000 + HudCompositor::DEFAULT_RESTORE_INTERVAL_MS - 1;
+    EXPECT_EQ(0, compositor.packNextBatch(batch));
+    graphics[0].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    ASSERT_EQ(1, compositor.packNextBatch(batch));
+    EXPECT_EQ(0, batch[0].name[2]);
+    EXPECT_EQ(Tx::GRAPHIC_MODIFY, batch[0].operation);
+
+    clock.time = 1'000 + HudCompositor::DEFAULT_RESTORE_INTERVAL_MS;
+    ASSERT_EQ(5, compositor.packNextBatch(batch));
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(7 + i, batch[i].name[2]);
+        EXPECT_EQ(Tx::GRAPHIC_ADD, batch[i].operation);
+    }
+    EXPECT_EQ(0, compositor.getNumRestoringGraphics());
+}
+
+TEST_F(HudCompositorTest, packNextBatch_free_slots_restore_before_resending)
+{
+    addGraphics(NUM_GRAPHICS);
+    compositor.packNextBatch(batch);
+    compositor.packNextBatch(batch);
+    clock.time = 1'000;
+    compositor.resendAll();
+    compositor.packNextBatch(batch);
+
+    // The restore isn't due, but restored graphics fill the free slots of owner changes
+    clock.time = 1'001;
+    for (int i = 0; i < 3; i++)
+    {
+        graphics[i].color = static_cast<uint8_t>(Tx::GraphicColor::PINK);
+    }
+    ASSERT_EQ(5, compositor.packNextBatch(batch));
+    EXPECT_EQ(7, batch[3].name[2]);
+    EXPECT_EQ(8, batch[4].name[2]);
+    EXPECT_EQ(Tx::GRAPHIC_ADD, batch[4].operation);
+    EXPECT_EQ(1, compositor.getNumRestoringGraphics());
+}
+
+TEST_F(HudCompositorTest, detectReconnect_restores_when_ref_serial_reconnects_or_robot_changes)
+{
+    bool receivingData = false;
+    RefSerialData::Rx::RobotData robotData = {};
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData)
+        .WillByDefault(ReturnPointee(&receivingData));
+    ON_CALL(drivers.refSerial, getRobotData).WillByDefault(ReturnRef(robotData));
+    addGraphics(2);
+    compositor.packNextBatch(batch);
+
+    EXPECT_FALSE(compositor.detectReconnect());
+    EXPECT_EQ(0, compositor.getNumRestoringGraphics());
+
+    receivingData = true;
+    robotData.robotId = RefSerialData::RobotId::RED_HERO;
+    EXPECT_TRUE(compositor.detectReconnect());
+    EXPECT_EQ(2, compositor.getNumRestoringGraphics());
+    compositor.packNextBatch(batch);
+    EXPECT_FALSE(compositor.detectReconnect());
+
+    receivingData = false;
+    EXPECT_FALSE(compositor.detectReconnect());
+    receivingData = true;
+    EXPECT_TRUE(compositor.detectReconnect());
+
+    robotData.robotId = RefSerialData::RobotId::BLUE_HERO;
+    EXPECT_TRUE(compositor.detectReconnect());
+}
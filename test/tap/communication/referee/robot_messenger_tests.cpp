@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/referee/robot_messenger.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::communication::referee;
+using namespace tap::communication::serial;
+using namespace tap;
+using namespace testing;
+
+using RobotId = RefSerialData::RobotId;
+using Tx = RefSerialData::Tx;
+
+struct Position
+{
+    float x;
+    float y;
+    uint32_t time;
+} modm_packed;
+
+class PositionHandler : public RobotMessenger::TypedTopicHandler<Position>
+{
+public:
+    int numValues = 0;
+    Position last = {};
+    RobotId lastSender = RobotId::INVALID;
+
+protected:
+    void onValue(const Position &value, RobotId sender) override
+    {
+        numValues++;
+        last = value;
+        lastSender = sender;
+    }
+};
+
+class BytesHandler : public RobotMessenger::TopicHandler
+{
+public:
+    void operator()(const uint8_t *data, uint16_t length, RobotId) override
+    {
+        numValues++;
+        value.assign(data, data + length);
+    }
+
+    int numValues = 0;
+    std::vector<uint8_t> value;
+};
+
+static constexpr uint8_t POSITION_TOPIC = 1;
+static constexpr uint8_t TARGETS_TOPIC = 2;
+static constexpr uint8_t MAP_TOPIC = 3;
+
+class RobotMessengerTest : public Test
+{
+protected:
+    RobotMessengerTest()
+        : refSerialTransmitter(&drivers),
+          sender(&drivers, refSerialTransmitter),
+          receiver(&drivers, refSerialTransmitter)
+    {
+    }
+
+    static RobotMessengerTopicConfig toHero()
+    {
+        RobotMessengerTopicConfig config;
+        config.receiver = RobotId::RED_HERO;
+        return config;
+    }
+
+    /// Packs the sender's next message. @return Its payload length.
+    uint16_t pack() { return sender.packNextMessage(payload, packedReceiver, packedPriority); }
+
+    /// Passes the payload last packed to the receiver, as sent by the sentry.
+    void deliver(uint16_t length)
+    {
+        Tx::InteractiveHeader header{0x200, static_cast<uint16_t>(RobotId::RED_SENTINEL), 1};
+        memcpy(received.data, &header, sizeof(header));
+        memcpy(received.data + sizeof(header), payload, length);
+        received.header.dataLength = sizeof(header) + length;
+        receiver(received);
+    }
+
+    void packAndDeliver() { deliver(pack()); }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerialTransmitter refSerialTransmitter;
+    RobotMessenger sender;
+    RobotMessenger receiver;
+    uint8_t payload[RobotMessenger::MAX_PAYLOAD_SIZE];
+    RobotId packedReceiver = RobotId::INVALID;
+    Tx::TransmissionPriority packedPriority = Tx::TransmissionPriority::LOW;
+    DJISerial::ReceivedSerialMessage received;
+};
+
+TEST_F(RobotMessengerTest, typed_value_received_by_subscriber)
+{
+    PositionHandler handler;
+    sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero());
+    receiver.subscribe(POSITION_TOPIC, sizeof(Position), &handler);
+
+    EXPECT_TRUE(sender.publish(POSITION_TOPIC, Position{1.5f, -2.0f, 1234}));
+    packAndDeliver();
+
+    EXPECT_EQ(RobotId::RED_HERO, packedReceiver);
+    EXPECT_EQ(Tx::TransmissionPriority::NORMAL, packedPriority);
+    ASSERT_EQ(1, handler.numValues);
+    EXPECT_EQ(1.5f, handler.last.x);
+    EXPECT_EQ(1234u, handler.last.time);
+    EXPECT_EQ(RobotId::RED_SENTINEL, handler.lastSender);
+    EXPECT_EQ(0, pack());
+}
+
+TEST_F(RobotMessengerTest, publish_rejects_unknown_topic_and_wrong_size)
+{
+    sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero());
+
+    EXPECT_FALSE(sender.publish(TARGETS_TOPIC, Position{}));
+    EXPECT_FALSE(sender.publish(POSITION_TOPIC, uint32_t(0)));
+}
+
+TEST_F(RobotMessengerTest, addTopic_rejects_duplicate_and_oversized_topics)
+{
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(3);
+
+    EXPECT_TRUE(sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero()));
+    EXPECT_FALSE(sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero()));
+    EXPECT_FALSE(sender.addTopic(TARGETS_TOPIC, RobotMessenger::MAX_TOPIC_SIZE + 1, toHero()));
+    EXPECT_FALSE(sender.addTopic(RobotMessenger::MAX_TOPIC_ID, 4, toHero()));
+}
+
+TEST_F(RobotMessengerTest, topics_for_same_receiver_share_a_message)
+{
+    RobotMessengerTopicConfig toEngineer;
+    toEngineer.receiver = RobotId::RED_ENGINEER;
+    sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero());
+    sender.addTopic(TARGETS_TOPIC, 8, toHero());
+    sender.addTopic(MAP_TOPIC, 8, toEngineer);
+    uint8_t targets[8] = {};
+    sender.publish(POSITION_TOPIC, Position{});
+    sender.publish(TARGETS_TOPIC, targets);
+    sender.publish(MAP_TOPIC, targets);
+
+    EXPECT_EQ(2 * sizeof(RobotMessenger::ChunkHeader) + sizeof(Position) + 8, pack());
+    EXPECT_EQ(RobotId::RED_HERO, packedReceiver);
+    EXPECT_EQ(1, sender.getNumPendingTopics());
+
+    EXPECT_EQ(sizeof(RobotMessenger::ChunkHeader) + 8, pack());
+    EXPECT_EQ(RobotId::RED_ENGINEER, packedReceiver);
+}
+
+TEST_F(RobotMessengerTest, higher_priority_topic_sent_first_at_its_priority)
+{
+    RobotMessengerTopicConfig urgent = toHero();
+    urgent.priority = Tx::TransmissionPriority::HIGH;
+    urgent.receiver = RobotId::RED_ENGINEER;
+    sender.addTopic(POSITION_TOPIC, sizeof(Position), toHero());
+    sender.addTopic(TARGETS_TOPIC, 8, urgent);
+    uint8_t targets[8] = {};
+    sender.publish(POSITION_TOPIC, Position{});
+    sender.publish(TARGETS_TOPIC, targets);
+
+    pack();
+
+    EXPECT_EQ(RobotId::RED_ENGINEER, packedReceiver);
+    EXPECT_EQ(Tx::TransmissionPriority::HIGH, packedPriority);
+}
+
+TEST_F(RobotMessengerTest, only_latest_value_sent_and_stale_values_dropped)
+{
+    RobotMessengerTopicConfig config = toHero();
+    config.maxAgeMs = 100;
+    PositionHandler handler;
+    sender.addTopic(POSITION_TOPIC, sizeof(Position), config);
+    receiver.subscribe(POSITION_TOPIC, sizeof(Position), &handler);
+
+    sender.publish(POSITION_TOPIC, Position{1, 0, 0});
+    sender.publish(POSITION_TOPIC, Position{2, 0, 0});
+    packAndDeliver();
+    EXPECT_EQ(1u, sender.getNumSupersededValues());
+    EXPECT_EQ(1, handler.numValues);
+    EXPECT_EQ(2, handler.last.x);
+
+    sender.publish(POSITION_TOPIC, Position{3, 0, 0});
+    clock.time = 101;
+    EXPECT_EQ(0, pack());
+    EXPECT_EQ(1u, sender.getNumStaleDrops());
+}
+
+TEST_F(RobotMessengerTest, large_value_fragmented_and_reassembled)
+{
+    BytesHandler handler;
+    sender.addTopic(MAP_TOPIC, RobotMessenger::MAX_TOPIC_SIZE, toHero());
+    receiver.subscribe(MAP_TOPIC, RobotMessenger::MAX_TOPIC_SIZE, &handler);
+    uint8_t map[RobotMessenger::MAX_TOPIC_SIZE];
+    for (int i = 0; i < RobotMessenger::MAX_TOPIC_SIZE; i++)
+    {
+        map[i] = i;
+    }
+    sender.publish(MAP_TOPIC, map);
+
+    EXPECT_EQ(RobotMessenger::MAX_PAYLOAD_SIZE, pack());
+    deliver(RobotMessenger::MAX_PAYLOAD_SIZE);
+    EXPECT_EQ(0, handler.numValues);
+
+    packAndDeliver();
+    ASSERT_EQ(1, handler.numValues);
+    EXPECT_EQ(std::vector<uint8_t>(map, map + sizeof(map)), handler.value);
+}
+
+TEST_F(RobotMessengerTest, value_with_lost_fragment_not_received)
+{
+    BytesHandler handler;
+    sender.addTopic(MAP_TOPIC, RobotMessenger::MAX_TOPIC_SIZE, toHero());
+    receiver.subscribe(MAP_TOPIC, RobotMessenger::MAX_TOPIC_SIZE, &handler);
+    uint8_t map[RobotMessenger::MAX_TOPIC_SIZE] = {};
+
+    sender.publish(MAP_TOPIC, map);
+    pack();  // First fragment lost
+    packAndDeliver();
+
+    // The first fragment of a newer value doesn't complete the older value
+    sender.publish(MAP_TOPIC, map);
+    packAndDeliver();
+
+    EXPECT_EQ(0, handler.numValues);
+}
+
+TEST_F(RobotMessengerTest, delta_sends_changed_bytes_and_recovers_at_keyframe)
+{
+    RobotMessengerTopicConfig config = toHero();
+    config.keyframeInterval = 4;
+    BytesHandler handler;
+    sender.addTopic(TARGETS_TOPIC, 32, config);
+    receiver.subscribe(TARGETS_TOPIC, 32, &handler);
+    uint8_t targets[32] = {};
+
+    sender.publish(TARGETS_TOPIC, targets);
+    EXPECT_EQ(sizeof(RobotMessenger::ChunkHeader) + 32, pack());
+    deliver(sizeof(RobotMessenger::ChunkHeader) + 32);
+
+    // One changed byte: base sequence, 4 mask bytes and the byte
+    targets[10] = 7;
+    sender.publish(TARGETS_TOPIC, targets);
+    packAndDeliver();
+    EXPECT_EQ(1u, sender.getNumDeltasSent());
+    ASSERT_EQ(2, handler.numValues);
+    EXPECT_EQ(7, handler.value[10]);
+
+    // Lost delta, the next delta can't be applied
+    targets[11] = 8;
+    sender.publish(TARGETS_TOPIC, targets);
+    EXPECT_EQ(sizeof(RobotMessenger::ChunkHeader) + 6, pack());
+    targets[12] = 9;
+    sender.publish(TARGETS_TOPIC, targets);
+    packAndDeliver();
+    EXPECT_EQ(2, handler.numValues);
+    EXPECT_EQ(1u, receiver.getNumRxDrops());
+
+    // Keyframe
+    targets[13] = 10;
+    sender.publish(TARGETS_TOPIC, targets);
+    packAndDeliver();
+    ASSERT_EQ(3, handler.numValues);
+    EXPECT_EQ(std::vector<uint8_t>(targets, targets + sizeof(targets)), handler.value);
+}
+
+TEST_F(RobotMessengerTest, unsubscribed_and_malformed_chunks_dropped)
+{
+    PositionHandler handler;
+    receiver.subscribe(POSITION_TOPIC, sizeof(Position), &handler);
+    sender.addTopic(TARGETS_TOPIC, 8, toHero());
+    uint8_t targets[8] = {};
+    sender.publish(TARGETS_TOPIC, targets);
+
+    packAndDeliver();
+
+    EXPECT_EQ(1u, receiver.getNumRxDrops());
+    EXPECT_EQ(0, handler.numValues);
+}
+
+TEST_F(RobotMessengerTest, resendAll_sends_whole_values_again)
+{
+    RobotMessengerTopicConfig config = toHero();
+    config.keyframeInterval = 5;
+    sender.addTopic(TARGETS_TOPIC, 32, config);
+    uint8_t targets[32] = {};
+    sender.publish(TARGETS_TOPIC, targets);
+    pack();
+
+    sender.resendAll();
+
+    EXPECT_EQ(1, sender.getNumPendingTopics());
+    EXPECT_EQ(sizeof(RobotMessenger::ChunkHeader) + 32, pack());
+}
+
+TEST_F(RobotMessengerTest, headroom_measured_from_ref_serial_bytes_sent)
+{
+    Tx::TransmissionQueueStats stats[Tx::NUM_TRANSMISSION_PRIORITIES] = {};
+    for (int i = 0; i < Tx::NUM_TRANSMISSION_PRIORITIES; i++)
+    {
+        ON_CALL(
+            drivers.refSerial,
+            getTransmissionQueueStats(static_cast<Tx::TransmissionPriority>(i)))
+            .WillByDefault(ReturnRef(stats[i]));
+    }
+    RefSerialData::Rx::RobotData robotData = {};
+    ON_CALL(drivers.refSerial, getRobotData).WillByDefault(ReturnRef(robotData));
+
+    sender.update();
+    stats[0].bytesSent = 300;
+    stats[2].bytesSent = 100;
+    clock.time = 1'000;
+    sender.update();
+
+    EXPECT_EQ(Tx::MAX_TRANSMIT_SPEED_BYTES_PER_S - 400, sender.getHeadroomBytesPerSecond());
+
+    stats[2].bytesSent = 2'000;
+    clock.time = 2'000;
+    sender.update();
+
+    EXPECT_EQ(0u, sender.getHeadroomBytesPerSecond());
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+
+#include "tap/communication/sensors/buzzer/buzzer_sequencer.hpp"
+#include "tap/mock/pwm_mock.hpp"
+
+using namespace tap::buzzer;
+using namespace testing;
+
+class BuzzerSequencerTest : public Test
+{
+protected:
+    BuzzerSequencerTest() : sequencer(&pwm) {}
+
+    // Tests set expectations on the writes that silence the buzzer where they matter
+    void SetUp() override { EXPECT_CALL(pwm, write).Times(AnyNumber()); }
+
+    NiceMock<tap::mock::PwmMock> pwm;
+    BuzzerSequencer sequencer;
+};
+
+TEST_F(BuzzerSequencerTest, update_without_notes_does_nothing)
+{
+    EXPECT_CALL(pwm, write(0, _)).Times(0);
+    EXPECT_CALL(pwm, setTimerFrequency).Times(0);
+
+    sequencer.update(100);
+
+    EXPECT_FALSE(sequencer.isPlaying());
+}
+
+TEST_F(BuzzerSequencerTest, notes_play_in_order_for_their_durations)
+{
+    static constexpr BuzzerSequencer::Note NOTES[] = {{1000, 50}, {2000, 20}};
+    ASSERT_TRUE(sequencer.queue(NOTES));
+
+    {
+        InSequence s;
+        EXPECT_CALL(pwm, setTimerFrequency(_, 1000));
+        EXPECT_CALL(pwm, setTimerFrequency(_, 2000));
+        EXPECT_CALL(pwm, write(0, _));
+    }
+
+    for (uint32_t time = 100; time < 169; time++)
+    {
+        sequencer.update(time);
+    }
+    EXPECT_TRUE(sequencer.isPlaying());
+
+    sequencer.update(170);
+    EXPECT_FALSE(sequencer.isPlaying());
+}
+
+TEST_F(BuzzerSequencerTest, rest_silences_buzzer)
+{
+    sequencer.queueNote(1000, 10);
+    sequencer.queueNote(0, 10);
+    sequencer.update(0);
+
+    EXPECT_CALL(pwm, write(0, _));
+    sequencer.update(10);
+}
+
+TEST_F(BuzzerSequencerTest, late_update_keeps_rhythm)
+{
+    sequencer.queueNote(1000, 10);
+    sequencer.queueNote(2000, 10);
+    sequencer.queueNote(3000, 10);
+    sequencer.update(0);
+    sequencer.update(12);
+
+    // The second note started at 10, so the third note starts at 20
+    EXPECT_CALL(pwm, setTimerFrequency).Times(0);
+    sequencer.update(19);
+    EXPECT_CALL(pwm, setTimerFrequency(_, 3000));
+    sequencer.update(20);
+}
+
+TEST_F(BuzzerSequencerTest, very_late_update_restarts_rhythm)
+{
+    sequencer.queueNote(1000, 10);
+    sequencer.queueNote(2000, 10);
+    sequencer.update(0);
+    sequencer.update(50);
+
+    sequencer.update(59);
+    EXPECT_TRUE(sequencer.isPlaying());
+    sequencer.update(60);
+    EXPECT_FALSE(sequencer.isPlaying());
+}
+
+TEST_F(BuzzerSequencerTest, queue_rejects_notes_that_do_not_fit)
+{
+    for (int i = 0; i < BuzzerSequencer::MAX_NOTES - 1; i++)
+    {
+        ASSERT_TRUE(sequencer.queueNote(1000, 10));
+    }
+
+    const BuzzerSequencer::Note notes[2] = {{1000, 10}, {2000, 10}};
+    EXPECT_FALSE(sequencer.queue(notes));
+    EXPECT_EQ(BuzzerSequencer::MAX_NOTES - 1, sequencer.getNumQueued());
+    EXPECT_TRUE(sequencer.queue(notes, 1));
+}
+
+TEST_F(BuzzerSequencerTest, stop_clears_queue_and_silences_buzzer)
+{
+    sequencer.queueNote(1000, 10);
+    sequencer.queueNote(2000, 10);
+    sequencer.update(0);
+
+    EXPECT_CALL(pwm, write(0, _));
+    sequencer.stop();
+
+    EXPECT_FALSE(sequencer.isPlaying());
+    EXPECT_CALL(pwm, setTimerFrequency).Times(0);
+    sequencer.update(10);
+}
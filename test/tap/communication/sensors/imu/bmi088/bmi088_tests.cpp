@@ -19,7 +19,9 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/algorithms/attitude_eskf.hpp"
 #include "tap/communication/sensors/imu/bmi088/bmi088.hpp"
+#include "tap/communication/sensors/imu/bmi088/bmi088_data_ready_dma.hpp"
 #include "tap/communication/sensors/imu/bmi088/bmi088_hal.hpp"
 #include "tap/drivers.hpp"
 
@@ -75,6 +77,24 @@ TEST(Bmi088, periodicIMUUpdate_initialize_called_no_errors)
     EXPECT_EQ(Bmi088::ImuState::IMU_NOT_CALIBRATED, bmi088.getImuState());
 }
 
+TEST(Bmi088, setAttitudeEstimator_replaces_mahony_until_reset_with_nullptr)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+    tap::algorithms::AttitudeEskf eskf;
+
+    bmi088.setAttitudeEstimator(&eskf);
+    EXPECT_EQ(&eskf, &bmi088.getAttitudeEstimator());
+
+    initializeBmi088(bmi088);
+    bmi088.read();
+    bmi088.periodicIMUUpdate();
+    EXPECT_EQ(eskf.getRoll(), bmi088.getRoll());
+
+    bmi088.setAttitudeEstimator(nullptr);
+    EXPECT_NE(&eskf, &bmi088.getAttitudeEstimator());
+}
+
 TEST(Bmi088, periodicIMUUpdate_gyro_acc_temp_data_parsed_properly)
 {
     tap::Drivers drivers;
@@ -178,3 +198,529 @@ TEST(Bmi088, requestRecalibration__calibration_adds_offset_to_acc_gyro_data)
 
     EXPECT_EQ(Bmi088::ImuState::IMU_CALIBRATED, bmi088.getImuState());
 }
+
+TEST(Bmi088, online_gyro_calibration_calibrates_while_stationary)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    bmi088.setOnlineGyroCalibration(true);
+    initializeBmi088(bmi088);
+
+    struct
+    {
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t z = tap::algorithms::ACCELERATION_GRAVITY / Bmi088::ACC_G_PER_ACC_COUNT;
+    } modm_packed accData;
+
+    struct
+    {
+        int16_t x = -14;
+        int16_t y = 3;
+        int16_t z = 8;
+    } modm_packed gyroData;
+
+    for (int i = 0; i < tap::algorithms::GyroBiasEstimator::Config().windowSamples; i++)
+    {
+        EXPECT_EQ(Bmi088::ImuState::IMU_NOT_CALIBRATED, bmi088.getImuState());
+        Bmi088Hal::expectAccMultiRead(reinterpret_cast<uint8_t *>(&accData), sizeof(accData));
+        Bmi088Hal::expectGyroMultiRead(reinterpret_cast<uint8_t *>(&gyroData), sizeof(gyroData));
+        bmi088.read();
+        bmi088.periodicIMUUpdate();
+    }
+
+    EXPECT_EQ(Bmi088::ImuState::IMU_CALIBRATED, bmi088.getImuState());
+    EXPECT_NEAR(0, bmi088.getGx(), 1E-3);
+    EXPECT_NEAR(0, bmi088.getGy(), 1E-3);
+    EXPECT_NEAR(0, bmi088.getGz(), 1E-3);
+    EXPECT_EQ(1u, bmi088.getGyroBiasEstimator().getNumUpdates());
+}
+
+TEST(Bmi088, setGyroCalibration_restores_calibration)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    tap::algorithms::GyroCalibration calibration;
+    calibration.bias[0] = 1.0f;
+    EXPECT_FALSE(bmi088.setGyroCalibration(calibration));
+
+    calibration.seal();
+    EXPECT_TRUE(bmi088.setGyroCalibration(calibration));
+    EXPECT_EQ(Bmi088::ImuState::IMU_NOT_CONNECTED, bmi088.getImuState());
+
+    initializeBmi088(bmi088);
+    EXPECT_EQ(Bmi088::ImuState::IMU_CALIBRATED, bmi088.getImuState());
+
+    uint8_t zeros[6] = {};
+    Bmi088Hal::expectAccMultiRead(zeros, sizeof(zeros));
+    Bmi088Hal::expectGyroMultiRead(zeros, sizeof(zeros));
+    bmi088.read();
+    bmi088.periodicIMUUpdate();
+    EXPECT_NEAR(-1.0f, bmi088.getGx(), 1E-3);
+}
+
+TEST(Bmi088, getAttitudeAt_returns_attitude_of_past_sample)
+{
+    tap::Drivers drivers;
+    tap::arch::clock::ClockStub clock;
+    Bmi088 bmi088(&drivers);
+
+    initializeBmi088(bmi088);
+
+    struct
+    {
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t z = tap::algorithms::ACCELERATION_GRAVITY / Bmi088::ACC_G_PER_ACC_COUNT;
+    } modm_packed accData;
+
+    struct
+    {
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t z = 0;
+    } modm_packed gyroData;
+
+    for (int i = 0; i < 100; i++)
+    {
+        // Yaws from the 50th sample on
+        gyroData.z = i < 50 ? 0 : 10'000;
+        clock.time = i + 1;
+        Bmi088Hal::expectAccMultiRead(reinterpret_cast<uint8_t *>(&accData), sizeof(accData));
+        Bmi088Hal::expectGyroMultiRead(reinterpret_cast<uint8_t *>(&gyroData), sizeof(gyroData));
+        bmi088.read();
+        bmi088.periodicIMUUpdate();
+    }
+
+    float q[4];
+    ASSERT_TRUE(bmi088.getAttitudeAt(40'000, q));
+    EXPECT_NEAR(1, q[0], 1E-6);
+    EXPECT_NE(0, bmi088.getYaw());
+    EXPECT_EQ(100, bmi088.getAttitudeHistory().size());
+    EXPECT_FALSE(bmi088.getAttitudeAt(0, q));
+}
+
+static void initializeBmi088DataReadyDma(Bmi088 &bmi088)
+{
+    Bmi088DataReadyDma::reset();
+    bmi088.setReadMode(Bmi088::ReadMode::DATA_READY_DMA);
+
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(171);  // acc config
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0);  // acc range
+
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(Bmi088Data::Gyro::GYRO_CHIP_ID_VALUE);
+    Bmi088Hal::expectGyroReadSingleReg(Bmi088Data::Gyro::GYRO_CHIP_ID_VALUE);
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0);  // gyro range
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(130);  // gyro bandwidth
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0);  // gyro powermode
+
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0x0a);  // int1 io conf
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0x04);  // int map data
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0x01);  // int3 int4 io conf
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0x01);  // int3 int4 io map
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0x80);  // gyro int ctrl
+
+    bmi088.initialize(1000, 0, 0);
+
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088, read_records_diagnostics)
+{
+    tap::Drivers drivers;
+    tap::arch::clock::ClockStub clock;
+    Bmi088 bmi088(&drivers);
+
+    initializeBmi088(bmi088);
+
+    uint8_t accData[6] = {0, 0, 0, 0, 0x40, 0x05};
+    uint8_t zeros[6] = {};
+
+    clock.time = 1;
+    Bmi088Hal::expectAccMultiRead(accData, sizeof(accData));
+    Bmi088Hal::expectGyroMultiRead(zeros, sizeof(zeros));
+    bmi088.read();
+
+    // Two samples missed, and the sensor returns nothing but zeros.
+    clock.time = 4;
+    Bmi088Hal::expectAccMultiRead(zeros, sizeof(zeros));
+    Bmi088Hal::expectGyroMultiRead(zeros, sizeof(zeros));
+    bmi088.read();
+
+    const auto *diagnostics = bmi088.getDiagnostics();
+    EXPECT_EQ(2u, diagnostics->getSampleCount());
+    EXPECT_EQ(2u, diagnostics->getDroppedSampleCount());
+    EXPECT_EQ(1u, diagnostics->getSpiErrorCount());
+    EXPECT_EQ(4000u, diagnostics->getLastSampleTime());
+    EXPECT_EQ(1000u, diagnostics->getLastSampleAge(5000));
+}
+
+static constexpr Bmi088::RateProfile STILL_PROFILE = {
+    Bmi088Data::Acc::AccBandwidth::NORMAL,
+    Bmi088Data::Acc::AccOutputRate::Hz100,
+    Bmi088Data::Gyro::GyroBandwidth::ODR100_BANDWIDTH12,
+    0.1f,
+    0,
+};
+
+// Matches the rates initializeBmi088 reads back
+static constexpr Bmi088::RateProfile MOVING_PROFILE = {
+    Bmi088Data::Acc::AccBandwidth::NORMAL,
+    Bmi088Data::Acc::AccOutputRate::Hz800,
+    Bmi088Data::Gyro::GyroBandwidth::ODR1000_BANDWIDTH116,
+    0.5f,
+    0,
+};
+
+/// Reads and updates the bmi088 with the same angular speed, in gyro counts, about the z axis.
+static void updateWithGyroZ(Bmi088 &bmi088, int16_t gyroZ)
+{
+    int16_t gyroData[3] = {0, 0, gyroZ};
+    uint8_t accData[6] = {};
+    Bmi088Hal::expectAccMultiRead(accData, sizeof(accData));
+    Bmi088Hal::expectGyroMultiRead(reinterpret_cast<uint8_t *>(gyroData), sizeof(gyroData));
+    bmi088.read();
+    bmi088.periodicIMUUpdate();
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088, setAdaptiveRate_switches_to_still_profile_after_still_time)
+{
+    tap::Drivers drivers;
+    tap::arch::clock::ClockStub clock;
+    Bmi088 bmi088(&drivers);
+
+    bmi088.setAdaptiveRate(STILL_PROFILE, MOVING_PROFILE, 30, 5, 1000);
+    initializeBmi088(bmi088);
+    EXPECT_TRUE(bmi088.isMoving());
+
+    updateWithGyroZ(bmi088, 0);
+    clock.time = 999;
+    updateWithGyroZ(bmi088, 0);
+    EXPECT_TRUE(bmi088.isMoving());
+
+    clock.time = 1000;
+    updateWithGyroZ(bmi088, 0);
+    EXPECT_FALSE(bmi088.isMoving());
+}
+
+TEST(Bmi088, setAdaptiveRate_switches_to_moving_profile_above_moving_threshold)
+{
+    tap::Drivers drivers;
+    tap::arch::clock::ClockStub clock;
+    Bmi088 bmi088(&drivers);
+
+    bmi088.setAdaptiveRate(STILL_PROFILE, MOVING_PROFILE, 30, 5, 1000);
+    initializeBmi088(bmi088);
+    updateWithGyroZ(bmi088, 0);
+    clock.time = 1000;
+    updateWithGyroZ(bmi088, 0);
+    ASSERT_FALSE(bmi088.isMoving());
+
+    // Between the thresholds, the profile doesn't change
+    updateWithGyroZ(bmi088, 20 / Bmi088::GYRO_DS_PER_GYRO_COUNT);
+    EXPECT_FALSE(bmi088.isMoving());
+
+    updateWithGyroZ(bmi088, -40 / Bmi088::GYRO_DS_PER_GYRO_COUNT);
+    EXPECT_TRUE(bmi088.isMoving());
+}
+
+TEST(Bmi088, setAdaptiveRate_speed_above_still_threshold_restarts_still_time)
+{
+    tap::Drivers drivers;
+    tap::arch::clock::ClockStub clock;
+    Bmi088 bmi088(&drivers);
+
+    bmi088.setAdaptiveRate(STILL_PROFILE, MOVING_PROFILE, 30, 5, 1000);
+    initializeBmi088(bmi088);
+
+    updateWithGyroZ(bmi088, 0);
+    clock.time = 800;
+    updateWithGyroZ(bmi088, 10 / Bmi088::GYRO_DS_PER_GYRO_COUNT);
+    clock.time = 900;
+    updateWithGyroZ(bmi088, 0);
+    clock.time = 1500;
+    updateWithGyroZ(bmi088, 0);
+    EXPECT_TRUE(bmi088.isMoving());
+
+    clock.time = 1900;
+    updateWithGyroZ(bmi088, 0);
+    EXPECT_FALSE(bmi088.isMoving());
+
+    bmi088.disableAdaptiveRate();
+    EXPECT_TRUE(bmi088.isMoving());
+}
+
+TEST(Bmi088, initialize_data_ready_dma_configures_interrupts_without_errors)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    initializeBmi088DataReadyDma(bmi088);
+
+    EXPECT_EQ(Bmi088::ImuState::IMU_NOT_CALIBRATED, bmi088.getImuState());
+}
+
+TEST(Bmi088, read_data_ready_dma_parses_latest_sample)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    initializeBmi088DataReadyDma(bmi088);
+
+    uint8_t accData[Bmi088DataReadyDma::ACC_DATA_LENGTH] = {0x34, 0x12, 0x21, 0x43, 0x14, 0x32};
+    accData[Bmi088Data::Acc::TEMP_MSB - Bmi088Data::Acc::ACC_X_LSB] = 0x10;
+    accData[Bmi088Data::Acc::TEMP_LSB - Bmi088Data::Acc::ACC_X_LSB] = 0x20;
+    uint8_t gyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {0x89, 0x67, 0x76, 0x98, 0x69, 0x87};
+
+    Bmi088Hal::expectGyroMultiRead(gyroData, sizeof(gyroData));
+    Bmi088DataReadyDma::onGyroDataReady(1000);
+    Bmi088Hal::expectAccMultiRead(accData, sizeof(accData));
+    Bmi088DataReadyDma::onAccDataReady(1200);
+
+    bmi088.read();
+    bmi088.periodicIMUUpdate();
+
+    static constexpr float ALPHA = 1E-3;
+    EXPECT_NEAR(int16_t(0x1234) * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAx(), ALPHA);
+    EXPECT_NEAR(int16_t(0x4321) * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAy(), ALPHA);
+    EXPECT_NEAR(int16_t(0x3214) * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAz(), ALPHA);
+    EXPECT_NEAR(int16_t(0x6789) * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGx(), ALPHA);
+    EXPECT_NEAR(int16_t(0x9876) * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGy(), ALPHA);
+    EXPECT_NEAR(int16_t(0x8769) * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGz(), ALPHA);
+    // raw temperature 0x10 * 8 + 0x20 / 32 = 129
+    EXPECT_NEAR(
+        129 * Bmi088::BMI088_TEMP_FACTOR + Bmi088::BMI088_TEMP_OFFSET,
+        bmi088.getTemp(),
+        ALPHA);
+    EXPECT_EQ(1000, bmi088.getPrevIMUDataReceivedTime());
+}
+
+TEST(Bmi088DataReadyDma, getLatestSample_returns_false_until_new_data_ready)
+{
+    Bmi088DataReadyDma::reset();
+    Bmi088DataReadyDma::Sample sample;
+
+    EXPECT_FALSE(Bmi088DataReadyDma::getLatestSample(&sample));
+
+    uint8_t gyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {1, 2, 3, 4, 5, 6};
+    Bmi088Hal::expectGyroMultiRead(gyroData, sizeof(gyroData));
+    Bmi088DataReadyDma::onGyroDataReady(500);
+
+    EXPECT_TRUE(Bmi088DataReadyDma::getLatestSample(&sample));
+    EXPECT_EQ(500, sample.gyroTime);
+    EXPECT_EQ(0, memcmp(gyroData, sample.gyroData, sizeof(gyroData)));
+
+    EXPECT_FALSE(Bmi088DataReadyDma::getLatestSample(&sample));
+    EXPECT_EQ(500, sample.gyroTime);
+    EXPECT_EQ(0, memcmp(gyroData, sample.gyroData, sizeof(gyroData)));
+
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088DataReadyDma, getLatestSample_keeps_newest_of_each_sensor)
+{
+    Bmi088DataReadyDma::reset();
+    Bmi088DataReadyDma::Sample sample;
+
+    uint8_t oldGyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {1, 2, 3, 4, 5, 6};
+    uint8_t newGyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {7, 8, 9, 10, 11, 12};
+    uint8_t accData[Bmi088DataReadyDma::ACC_DATA_LENGTH] = {13, 14, 15, 16, 17, 18};
+
+    Bmi088Hal::expectGyroMultiRead(oldGyroData, sizeof(oldGyroData));
+    Bmi088DataReadyDma::onGyroDataReady(100);
+    Bmi088Hal::expectAccMultiRead(accData, sizeof(accData));
+    Bmi088DataReadyDma::onAccDataReady(150);
+    Bmi088Hal::expectGyroMultiRead(newGyroData, sizeof(newGyroData));
+    Bmi088DataReadyDma::onGyroDataReady(600);
+
+    EXPECT_TRUE(Bmi088DataReadyDma::getLatestSample(&sample));
+    EXPECT_EQ(600, sample.gyroTime);
+    EXPECT_EQ(150, sample.accTime);
+    EXPECT_EQ(0, memcmp(newGyroData, sample.gyroData, sizeof(newGyroData)));
+    EXPECT_EQ(0, memcmp(accData, sample.accData, sizeof(accData)));
+
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088DataReadyDma, pauseTransfers_defers_transfers_until_resumeTransfers)
+{
+    Bmi088DataReadyDma::reset();
+    Bmi088DataReadyDma::Sample sample;
+
+    Bmi088DataReadyDma::pauseTransfers();
+
+    uint8_t gyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {1, 2, 3, 4, 5, 6};
+    Bmi088Hal::expectGyroMultiRead(gyroData, sizeof(gyroData));
+    Bmi088DataReadyDma::onGyroDataReady(500);
+
+    EXPECT_FALSE(Bmi088DataReadyDma::getLatestSample(&sample));
+
+    Bmi088DataReadyDma::resumeTransfers();
+
+    EXPECT_TRUE(Bmi088DataReadyDma::getLatestSample(&sample));
+    EXPECT_EQ(500, sample.gyroTime);
+    EXPECT_EQ(0, memcmp(gyroData, sample.gyroData, sizeof(gyroData)));
+
+    Bmi088Hal::clearData();
+}
+
+static void initializeBmi088Fifo(Bmi088 &bmi088)
+{
+    bmi088.setReadMode(Bmi088::ReadMode::FIFO);
+
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccReadSingleReg(Bmi088Data::Acc::ACC_CHIP_ID_VALUE);
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(171);  // acc config
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0);  // acc range
+
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(Bmi088Data::Gyro::GYRO_CHIP_ID_VALUE);
+    Bmi088Hal::expectGyroReadSingleReg(Bmi088Data::Gyro::GYRO_CHIP_ID_VALUE);
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0);  // gyro range
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(130);  // gyro bandwidth
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0);  // gyro powermode
+
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0);  // gyro fifo config 0
+    Bmi088Hal::expectGyroWriteSingleReg();
+    Bmi088Hal::expectGyroReadSingleReg(0x80);  // gyro fifo config 1
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0x02);  // acc fifo config 0
+    Bmi088Hal::expectAccWriteSingleReg();
+    Bmi088Hal::expectAccReadSingleReg(0x50);  // acc fifo config 1
+
+    bmi088.initialize(1000, 0, 0);
+
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088, initialize_fifo_configures_fifos_without_errors)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    initializeBmi088Fifo(bmi088);
+
+    EXPECT_EQ(Bmi088::ImuState::IMU_NOT_CALIBRATED, bmi088.getImuState());
+}
+
+TEST(Bmi088, configureFifoFilters_fails_with_too_many_taps)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    EXPECT_TRUE(bmi088.configureFifoFilters(4, 2, 3));
+    EXPECT_FALSE(bmi088.configureFifoFilters(20, 2, 3));
+    EXPECT_FALSE(bmi088.configureFifoFilters(0, 2, 1));
+}
+
+TEST(Bmi088, read_fifo_decimates_all_buffered_samples)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    ASSERT_TRUE(bmi088.configureFifoFilters(2, 2));
+    initializeBmi088Fifo(bmi088);
+
+    // Two acc frames, then a frame cut off by the end of the read that is ignored
+    uint8_t accFifo[] = {
+        0x84, 10, 0, 20, 0, 30, 0,  // acc frame
+        0x44, 1,  2, 3,             // sensor time frame
+        0x84, 30, 0, 40, 0, 50, 0,  // acc frame
+        0x84, 1,  2,                // partial acc frame
+    };
+    uint8_t accFifoLength[] = {sizeof(accFifo), 0};
+    // Four gyro frames, decimated into two
+    uint8_t gyroFifo[] = {
+        100, 0, 0, 0, 0xf6, 0xff,  // (100, 0, -10)
+        200, 0, 0, 0, 0xe2, 0xff,  // (200, 0, -30)
+        0,   0, 0, 0, 0,    0,     // (0, 0, 0)
+        50,  0, 4, 0, 0,    0,     // (50, 4, 0)
+    };
+
+    Bmi088Hal::expectAccMultiRead(accFifoLength, sizeof(accFifoLength));
+    Bmi088Hal::expectAccMultiRead(accFifo, sizeof(accFifo));
+    Bmi088Hal::expectGyroReadSingleReg(4);
+    Bmi088Hal::expectGyroMultiRead(gyroFifo, sizeof(gyroFifo));
+    uint8_t temp[] = {0, 0};
+    Bmi088Hal::expectAccMultiRead(temp, sizeof(temp));
+
+    bmi088.read();
+
+    static constexpr float ALPHA = 1E-3;
+    EXPECT_NEAR(20 * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAx(), ALPHA);
+    EXPECT_NEAR(30 * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAy(), ALPHA);
+    EXPECT_NEAR(40 * Bmi088::ACC_G_PER_ACC_COUNT, bmi088.getAz(), ALPHA);
+    EXPECT_NEAR(25 * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGx(), ALPHA);
+    EXPECT_NEAR(2 * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGy(), ALPHA);
+    EXPECT_NEAR(0, bmi088.getGz(), ALPHA);
+
+    Bmi088Hal::clearData();
+}
+
+/// Reads the given gyro frames out of the bmi088's FIFO, with the acc FIFO empty.
+static void readGyroFifo(Bmi088 &bmi088, uint8_t *gyroFifo, uint8_t numFrames)
+{
+    uint8_t accFifoLength[] = {0, 0};
+    Bmi088Hal::expectAccMultiRead(accFifoLength, sizeof(accFifoLength));
+    Bmi088Hal::expectGyroReadSingleReg(numFrames);
+    Bmi088Hal::expectGyroMultiRead(gyroFifo, numFrames * Bmi088Data::Gyro::FIFO_FRAME_LENGTH);
+    uint8_t temp[] = {0, 0};
+    Bmi088Hal::expectAccMultiRead(temp, sizeof(temp));
+    bmi088.read();
+    Bmi088Hal::clearData();
+}
+
+TEST(Bmi088, setAdaptiveRate_fifo_discards_samples_taken_at_previous_rate)
+{
+    tap::Drivers drivers;
+    Bmi088 bmi088(&drivers);
+
+    ASSERT_TRUE(bmi088.configureFifoFilters(2, 2));
+    initializeBmi088Fifo(bmi088);
+
+    // Leaves one sample in the decimator's history
+    uint8_t oldRateFifo[] = {100, 0, 0, 0, 0, 0};
+    readGyroFifo(bmi088, oldRateFifo, 1);
+
+    bmi088.setAdaptiveRate(STILL_PROFILE, MOVING_PROFILE, 30, 5, 1000);
+
+    uint8_t newRateFifo[] = {
+        10, 0, 0, 0, 0, 0,  // (10, 0, 0)
+        30, 0, 0, 0, 0, 0,  // (30, 0, 0)
+    };
+    readGyroFifo(bmi088, newRateFifo, 2);
+
+    EXPECT_NEAR(20 * Bmi088::GYRO_DS_PER_GYRO_COUNT, bmi088.getGx(), 1E-3);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/imu/bmi088/bmi088_hal.hpp"
+#include "tap/communication/sensors/imu/bmi088/bmi088_triggered_loop.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+
+using namespace tap::communication::sensors::imu::bmi088;
+using namespace tap::motor;
+using namespace testing;
+using tap::can::CanBus;
+
+/// Sets the motor's output to the first gyroscope register of the sample.
+static void setOutputFromGyro(const Bmi088DataReadyDma::Sample &sample, void *context)
+{
+    static_cast<DjiMotor *>(context)->setDesiredOutput(sample.gyroData[0]);
+}
+
+class Bmi088TriggeredLoopTest : public Test
+{
+protected:
+    Bmi088TriggeredLoopTest()
+        : txHandler(&drivers),
+          motor(&drivers, MOTOR5, CanBus::CAN_BUS1, false, "yaw"),
+          loop(
+              txHandler,
+              CanBus::CAN_BUS1,
+              DjiMotorTxHandler::TX_GROUP_HIGH,
+              setOutputFromGyro,
+              &motor)
+    {
+    }
+
+    void SetUp() override
+    {
+        Bmi088DataReadyDma::reset();
+        ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+        ON_CALL(drivers.can, sendMessage).WillByDefault(Return(true));
+        txHandler.addMotorToManager(&motor);
+    }
+
+    void TearDown() override { Bmi088Hal::clearData(); }
+
+    /// Transfers a gyroscope sample whose first register is `value`, as the interrupts would.
+    void sampleGyro(uint8_t value, uint32_t time)
+    {
+        uint8_t gyroData[Bmi088DataReadyDma::GYRO_DATA_LENGTH] = {value};
+        Bmi088Hal::expectGyroMultiRead(gyroData, sizeof(gyroData));
+        Bmi088DataReadyDma::onGyroDataReady(time);
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    DjiMotorTxHandler txHandler;
+    DjiMotor motor;
+    Bmi088TriggeredLoop loop;
+};
+
+static auto frameWithOutput(uint32_t identifier, uint8_t output)
+{
+    return AllOf(
+        Property(&modm::can::Message::getIdentifier, identifier),
+        Field(&modm::can::Message::data, ElementsAre(0, output, 0, 0, 0, 0, 0, 0)));
+}
+
+TEST_F(Bmi088TriggeredLoopTest, stopped_loop_does_not_run)
+{
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    sampleGyro(7, 1'000);
+
+    EXPECT_FALSE(loop.isRunning());
+    EXPECT_EQ(0u, loop.getRunCount());
+}
+
+TEST_F(Bmi088TriggeredLoopTest, gyro_sample_runs_loop_and_sends_frame)
+{
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            CanBus::CAN_BUS1,
+            frameWithOutput(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER, 7)));
+
+    loop.start();
+    clock.time = 2;
+    sampleGyro(7, 1'500);
+
+    EXPECT_TRUE(loop.isRunning());
+    EXPECT_EQ(1u, loop.getRunCount());
+    EXPECT_EQ(500u, loop.getLatency());
+    EXPECT_EQ(1u, loop.getLatencyHistogram().getCount());
+    EXPECT_EQ(0, txHandler.getPendingTxGroups(CanBus::CAN_BUS1));
+}
+
+TEST_F(Bmi088TriggeredLoopTest, sample_is_still_fresh_for_main_loop)
+{
+    loop.start();
+    sampleGyro(7, 1'000);
+
+    Bmi088DataReadyDma::Sample sample;
+    EXPECT_TRUE(Bmi088DataReadyDma::getLatestSample(&sample));
+    EXPECT_EQ(7, sample.gyroData[0]);
+}
+
+TEST_F(Bmi088TriggeredLoopTest, main_loop_does_not_send_group_while_running)
+{
+    loop.start();
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+    txHandler.encodeAndSendCanData();
+
+    loop.stop();
+
+    EXPECT_CALL(drivers.can, sendMessage(CanBus::CAN_BUS1, _));
+    txHandler.encodeAndSendCanData();
+    EXPECT_FALSE(loop.isRunning());
+}
+
+TEST_F(Bmi088TriggeredLoopTest, busy_bus_leaves_frame_for_main_loop)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    loop.start();
+    sampleGyro(7, 1'000);
+
+    EXPECT_EQ(1u, loop.getFlushFailures());
+    EXPECT_EQ(0u, loop.getLatencyHistogram().getCount());
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            CanBus::CAN_BUS1,
+            frameWithOutput(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER, 7)));
+    txHandler.sendPendingFrames();
+}
+
+TEST_F(Bmi088TriggeredLoopTest, starting_another_loop_stops_the_first)
+{
+    DjiMotor pitch(&drivers, MOTOR1, CanBus::CAN_BUS1, false, "pitch");
+    txHandler.addMotorToManager(&pitch);
+    Bmi088TriggeredLoop other(
+        txHandler,
+        CanBus::CAN_BUS1,
+        DjiMotorTxHandler::TX_GROUP_LOW,
+        setOutputFromGyro,
+        &pitch);
+
+    loop.start();
+    other.start();
+
+    EXPECT_FALSE(loop.isRunning());
+    EXPECT_FALSE(txHandler.isTxGroupReserved(CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_TRUE(txHandler.isTxGroupReserved(CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_LOW));
+
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            CanBus::CAN_BUS1,
+            frameWithOutput(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER, 9)));
+    sampleGyro(9, 1'000);
+
+    EXPECT_EQ(0u, loop.getRunCount());
+    EXPECT_EQ(1u, other.getRunCount());
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/sensors/imu/imu_diagnostics.hpp"
+
+using namespace tap::communication::sensors::imu;
+
+TEST(ImuDiagnostics, recordSamples_counts_samples)
+{
+    ImuDiagnostics diagnostics;
+
+    diagnostics.recordSamples(1000);
+    diagnostics.recordSamples(2000, 5);
+
+    EXPECT_EQ(6u, diagnostics.getSampleCount());
+    EXPECT_EQ(2000u, diagnostics.getLastSampleTime());
+    EXPECT_EQ(500u, diagnostics.getLastSampleAge(2500));
+}
+
+TEST(ImuDiagnostics, getLastSampleAge_without_samples_is_max)
+{
+    ImuDiagnostics diagnostics;
+
+    EXPECT_EQ(UINT32_MAX, diagnostics.getLastSampleAge(1000));
+}
+
+TEST(ImuDiagnostics, recordSamples_counts_gaps_as_dropped_samples)
+{
+    ImuDiagnostics diagnostics;
+    diagnostics.setExpectedSampleFrequency(1000);
+
+    diagnostics.recordSamples(1000);
+    // A little late, not a drop
+    diagnostics.recordSamples(2400);
+    // Two samples missed
+    diagnostics.recordSamples(5400);
+
+    EXPECT_EQ(2u, diagnostics.getDroppedSampleCount());
+}
+
+TEST(ImuDiagnostics, recordSamples_doesnt_count_gaps_without_expected_frequency)
+{
+    ImuDiagnostics diagnostics;
+
+    diagnostics.recordSamples(1000);
+    diagnostics.recordSamples(100'000);
+
+    EXPECT_EQ(0u, diagnostics.getDroppedSampleCount());
+}
+
+TEST(ImuDiagnostics, getSampleFrequency_measures_rate_over_window)
+{
+    ImuDiagnostics diagnostics;
+
+    for (uint32_t time = 0; time <= ImuDiagnostics::SAMPLE_RATE_WINDOW; time += 2000)
+    {
+        diagnostics.recordSamples(time);
+    }
+
+    EXPECT_FLOAT_EQ(500, diagnostics.getSampleFrequency());
+}
+
+TEST(ImuDiagnostics, recordReadTime_keeps_max)
+{
+    ImuDiagnostics diagnostics;
+
+    diagnostics.recordReadTime(50);
+    diagnostics.recordReadTime(200);
+    diagnostics.recordReadTime(100);
+
+    EXPECT_EQ(200u, diagnostics.getMaxReadTime());
+    EXPECT_EQ(100u, diagnostics.getLastReadTime());
+
+    diagnostics.resetMaxReadTime();
+    EXPECT_EQ(0u, diagnostics.getMaxReadTime());
+}
+
+TEST(ImuDiagnostics, reset_keeps_expected_frequency)
+{
+    ImuDiagnostics diagnostics;
+    diagnostics.setExpectedSampleFrequency(1000);
+    diagnostics.recordSamples(1000);
+    diagnostics.recordSpiError();
+
+    diagnostics.reset();
+    diagnostics.recordSamples(10'000);
+    diagnostics.recordSamples(13'000);
+
+    EXPECT_EQ(0u, diagnostics.getSpiErrorCount());
+    EXPECT_EQ(2u, diagnostics.getSampleCount());
+    EXPECT_EQ(2u, diagnostics.getDroppedSampleCount());
+}
+
+TEST(ImuDiagnostics, looksLikeBusFault_detects_constant_data)
+{
+    const uint8_t zeros[6] = {};
+    const uint8_t ones[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    const uint8_t data[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x40};
+    const uint8_t constant[6] = {0x12, 0x12, 0x12, 0x12, 0x12, 0x12};
+
+    EXPECT_TRUE(ImuDiagnostics::looksLikeBusFault(zeros, 6));
+    EXPECT_TRUE(ImuDiagnostics::looksLikeBusFault(ones, 6));
+    EXPECT_FALSE(ImuDiagnostics::looksLikeBusFault(data, 6));
+    EXPECT_FALSE(ImuDiagnostics::looksLikeBusFault(constant, 6));
+}
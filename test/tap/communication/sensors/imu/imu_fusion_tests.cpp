@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/imu/imu_fusion.hpp"
+#include "tap/mock/imu_interface_mock.hpp"
+
+using namespace tap::algorithms::transforms;
+using namespace tap::communication::sensors::imu;
+using namespace tap::mock;
+using namespace testing;
+
+static constexpr float G = 9.80665f;
+
+class ImuFusionTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        setSample(chassisImu, 0, {0, 0, 0}, {0, 0, G});
+        setSample(turretImu, 0, {0, 0, 0}, {0, 0, G});
+        fusion.initialize(1000, 0.1f, 0);
+    }
+
+    /// Makes `imu` report a sample received at `time` microseconds.
+    static void setSample(
+        NiceMock<ImuInterfaceMock> &imu,
+        uint32_t time,
+        const float (&gyro)[3],
+        const float (&acc)[3])
+    {
+        ON_CALL(imu, getPrevIMUDataReceivedTime).WillByDefault(Return(time));
+        ON_CALL(imu, getGx).WillByDefault(Return(gyro[0]));
+        ON_CALL(imu, getGy).WillByDefault(Return(gyro[1]));
+        ON_CALL(imu, getGz).WillByDefault(Return(gyro[2]));
+        ON_CALL(imu, getAx).WillByDefault(Return(acc[0]));
+        ON_CALL(imu, getAy).WillByDefault(Return(acc[1]));
+        ON_CALL(imu, getAz).WillByDefault(Return(acc[2]));
+    }
+
+    tap::arch::clock::ClockStub clock;
+    NiceMock<ImuInterfaceMock> chassisImu;
+    NiceMock<ImuInterfaceMock> turretImu;
+    ImuFusion fusion;
+};
+
+TEST_F(ImuFusionTest, update_without_sources_does_nothing)
+{
+    EXPECT_FALSE(fusion.update());
+    EXPECT_EQ(0, fusion.getNumActiveSources());
+}
+
+TEST_F(ImuFusionTest, addSource_fails_when_full)
+{
+    for (int i = 0; i < ImuFusion::MAX_SOURCES; i++)
+    {
+        EXPECT_EQ(i, fusion.addSource(&chassisImu, Transform::identity()));
+    }
+
+    EXPECT_EQ(-1, fusion.addSource(&turretImu, Transform::identity()));
+    EXPECT_EQ(ImuFusion::MAX_SOURCES, fusion.getNumSources());
+}
+
+TEST_F(ImuFusionTest, update_single_source_passes_samples_through)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    setSample(chassisImu, 0, {1, 2, 3}, {0, 0, G});
+
+    EXPECT_TRUE(fusion.update());
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_FLOAT_EQ(1, gyro[0]);
+    EXPECT_FLOAT_EQ(2, gyro[1]);
+    EXPECT_FLOAT_EQ(3, gyro[2]);
+    EXPECT_EQ(1, fusion.getNumActiveSources());
+}
+
+TEST_F(ImuFusionTest, update_rotates_sources_into_fusion_frame)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    // Mounted yawed 90 degrees, so the chassis x axis is the IMU's -y axis.
+    fusion.addSource(&turretImu, Transform(0, 0, 0, 0, 0, M_PI_2));
+    setSample(chassisImu, 0, {10, 0, 0}, {0, 0, G});
+    setSample(turretImu, 0, {0, -10, 0}, {0, 0, G});
+
+    fusion.update();
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_NEAR(10, gyro[0], 1E-4);
+    EXPECT_NEAR(0, gyro[1], 1E-4);
+    EXPECT_NEAR(0, gyro[2], 1E-4);
+    EXPECT_EQ(2, fusion.getNumActiveSources());
+}
+
+TEST_F(ImuFusionTest, update_weights_sources)
+{
+    fusion.addSource(&chassisImu, Transform::identity(), 3);
+    fusion.addSource(&turretImu, Transform::identity(), 1);
+    setSample(chassisImu, 0, {0, 0, 4}, {0, 0, G});
+    setSample(turretImu, 0, {0, 0, 8}, {0, 0, G});
+
+    fusion.update();
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_FLOAT_EQ(5, gyro[2]);
+}
+
+TEST_F(ImuFusionTest, update_interpolates_sources_to_common_time)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    fusion.addSource(&turretImu, Transform::identity());
+    fusion.update();
+
+    // A yaw rate ramping up 10 deg/s per ms. The turret IMU's sample is half a ms older.
+    clock.time = 1;
+    setSample(chassisImu, 1000, {0, 0, 10}, {0, 0, G});
+    setSample(turretImu, 500, {0, 0, 5}, {0, 0, G});
+    fusion.update();
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_FLOAT_EQ(5, gyro[2]);
+}
+
+TEST_F(ImuFusionTest, update_leaves_out_stale_sources)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    fusion.addSource(&turretImu, Transform::identity());
+
+    clock.time = 100;
+    setSample(chassisImu, 100'000, {0, 0, 1}, {0, 0, G});
+    setSample(turretImu, 0, {0, 0, 50}, {0, 0, G});
+    fusion.update();
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_FLOAT_EQ(1, gyro[2]);
+    EXPECT_EQ(1, fusion.getNumActiveSources());
+}
+
+TEST_F(ImuFusionTest, update_returns_false_when_all_sources_stale)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+
+    clock.time = 100;
+
+    EXPECT_FALSE(fusion.update());
+}
+
+TEST_F(ImuFusionTest, updateMount_removes_relative_rate_of_moving_source)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    const int turret = fusion.addSource(&turretImu, Transform::identity());
+
+    // The chassis is still while the turret yaws at 90 deg/s.
+    setSample(turretImu, 0, {0, 0, 90}, {0, 0, G});
+    fusion.updateMount(turret, Orientation(0, 0, M_PI_2), {0, 0, 90});
+    fusion.update();
+
+    float gyro[3];
+    fusion.getGyro(gyro);
+    EXPECT_NEAR(0, gyro[2], 1E-4);
+}
+
+TEST_F(ImuFusionTest, getOrientation_composes_fusion_attitude_and_mount)
+{
+    fusion.addSource(&chassisImu, Transform::identity());
+    const int turret = fusion.addSource(&turretImu, Transform(0, 0, 0, 0, 0, M_PI_2));
+
+    // 0.5 s of the chassis yawing at 90 deg/s.
+    setSample(chassisImu, 0, {0, 0, 90}, {0, 0, G});
+    setSample(turretImu, 0, {0, 0, 90}, {0, 0, G});
+    for (int i = 0; i < 500; i++)
+    {
+        fusion.update();
+    }
+
+    EXPECT_NEAR(M_PI_4, fusion.getOrientation(0).yaw(), 0.01f);
+    EXPECT_NEAR(M_PI_4 + M_PI_2, fusion.getOrientation(turret).yaw(), 0.01f);
+}
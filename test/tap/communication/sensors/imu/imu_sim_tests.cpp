@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/math_user_utils.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/imu/imu_sim.hpp"
+
+using namespace tap::communication::sensors::imu;
+using namespace tap::motor::motorsim;
+using tap::algorithms::ACCELERATION_GRAVITY;
+
+static constexpr float DT = 0.001f;
+static constexpr float RAD_TO_DEG = 180.0f / static_cast<float>(M_PI);
+
+static constexpr RigidBodySim::Config BODY_CONFIG = {
+    .inertia = {0.1f, 0.1f, 0.1f},
+    .damping = {},
+};
+
+class ImuSimTest : public testing::Test
+{
+protected:
+    ImuSimTest() : body(engine, BODY_CONFIG) {}
+
+    void run(ImuSim &imu, int steps)
+    {
+        for (int i = 0; i < steps; i++)
+        {
+            body.step(DT);
+            imu.update();
+        }
+    }
+
+    tap::arch::clock::ClockStub clock;
+    MotorSimEngine engine;
+    RigidBodySim body;
+};
+
+TEST_F(ImuSimTest, ideal_imu_reads_body_in_degrees)
+{
+    ImuSim imu(body, ImuSim::IDEAL_CONFIG);
+    body.setExternalTorque(RigidBodySim::Z, 0.1f);
+    body.setExternalTorque(RigidBodySim::Y, 0.01f);
+
+    run(imu, 500);
+
+    EXPECT_FLOAT_EQ(body.getAngularVelocity(RigidBodySim::Z) * RAD_TO_DEG, imu.getGz());
+    EXPECT_FLOAT_EQ(body.getAngularVelocity(RigidBodySim::Y) * RAD_TO_DEG, imu.getGy());
+    EXPECT_FLOAT_EQ(body.getYaw() * RAD_TO_DEG, imu.getYaw());
+    EXPECT_FLOAT_EQ(body.getPitch() * RAD_TO_DEG, imu.getPitch());
+    EXPECT_FLOAT_EQ(body.getSpecificForce(RigidBodySim::X), imu.getAx());
+    EXPECT_FLOAT_EQ(body.getSpecificForce(RigidBodySim::Z), imu.getAz());
+}
+
+TEST_F(ImuSimTest, yaw_wrapped_to_positive_degrees)
+{
+    ImuSim imu(body, ImuSim::IDEAL_CONFIG);
+    body.setExternalTorque(RigidBodySim::Z, -0.1f);
+
+    run(imu, 1'000);
+
+    ASSERT_LT(body.getYaw(), 0);
+    EXPECT_NEAR(360 + body.getYaw() * RAD_TO_DEG, imu.getYaw(), 1e-3f);
+}
+
+TEST_F(ImuSimTest, gyro_bias_added_to_readings)
+{
+    ImuSim::Config config = ImuSim::IDEAL_CONFIG;
+    config.gyroBias[RigidBodySim::X] = 0.5f;
+    ImuSim imu(body, config);
+
+    run(imu, 1);
+
+    EXPECT_FLOAT_EQ(0.5f, imu.getGx());
+    EXPECT_FLOAT_EQ(0, imu.getGy());
+}
+
+TEST_F(ImuSimTest, noise_has_configured_deviation)
+{
+    ImuSim imu(body, ImuSim::BMI088_CONFIG);
+    float sumSquares = 0;
+    float sum = 0;
+    static constexpr int SAMPLES = 10'000;
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        imu.update();
+        sum += imu.getAz() - ACCELERATION_GRAVITY;
+        sumSquares += (imu.getAz() - ACCELERATION_GRAVITY) * (imu.getAz() - ACCELERATION_GRAVITY);
+    }
+
+    EXPECT_NEAR(0, sum / SAMPLES, 0.002f);
+    EXPECT_NEAR(ImuSim::BMI088_CONFIG.accelNoise, sqrtf(sumSquares / SAMPLES), 0.002f);
+}
+
+TEST_F(ImuSimTest, same_seed_gives_same_readings)
+{
+    ImuSim first(body, ImuSim::BMI088_CONFIG);
+    ImuSim second(body, ImuSim::BMI088_CONFIG);
+
+    for (int i = 0; i < 10; i++)
+    {
+        first.update();
+        second.update();
+        EXPECT_EQ(first.getGx(), second.getGx());
+        EXPECT_EQ(first.getAy(), second.getAy());
+    }
+}
+
+TEST_F(ImuSimTest, update_records_sample_time_in_microseconds)
+{
+    ImuSim imu(body);
+    clock.time = 1'234;
+
+    imu.update();
+
+    EXPECT_EQ(1'234'000u, imu.getPrevIMUDataReceivedTime());
+}
@@ -19,6 +19,8 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/imu/imu_diagnostics.hpp"
 #include "tap/communication/sensors/imu/imu_terminal_serial_handler.hpp"
 #include "tap/drivers.hpp"
 #include "tap/mock/imu_interface_mock.hpp"
@@ -235,3 +237,30 @@ TEST_F(
     EXPECT_THAT(output, Not(HasSubstr("temp")));
     EXPECT_THAT(output, HasSubstr("54.42"));
 }
+
+TEST_F(ImuTerminalSerialHandlerTest, terminalSerialCallback__diag_input_returns_diagnostics)
+{
+    tap::arch::clock::ClockStub clock;
+    ImuDiagnostics diagnostics;
+    diagnostics.recordSamples(1000);
+    diagnostics.recordSamples(2000);
+    diagnostics.recordSpiError();
+    diagnostics.recordReadTime(123);
+    clock.time = 3;
+    ON_CALL(imu, getDiagnostics).WillByDefault(Return(&diagnostics));
+
+    char input[] = "diag";
+    EXPECT_TRUE(serialHandler.terminalSerialCallback(input, stream, false));
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("samples\tdrops\tspiErr\tmaxRead\todr\tage"));
+    EXPECT_THAT(output, HasSubstr("2\t0\t1\t123\t0.0\t1000"));
+}
+
+TEST_F(ImuTerminalSerialHandlerTest, terminalSerialCallback__diag_without_diagnostics_returns_false)
+{
+    char input[] = "diag";
+    EXPECT_FALSE(serialHandler.terminalSerialCallback(input, stream, false));
+
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/imu/mpu6500/mpu6500_interrupt_spi.hpp"
+
+using namespace tap::communication::sensors::imu::mpu6500;
+
+class Mpu6500InterruptSpiTest : public testing::Test
+{
+protected:
+    void SetUp() override { Mpu6500InterruptSpi::reset(); }
+
+    tap::arch::clock::ClockStub clock;
+};
+
+TEST_F(Mpu6500InterruptSpiTest, startRead_fails_while_busy_or_empty)
+{
+    uint8_t buffer[2];
+
+    EXPECT_FALSE(Mpu6500InterruptSpi::startRead(0x3b, buffer, 0));
+    EXPECT_TRUE(Mpu6500InterruptSpi::startRead(0x3b, buffer, 2));
+    EXPECT_FALSE(Mpu6500InterruptSpi::startRead(0x3b, buffer, 2));
+}
+
+TEST_F(Mpu6500InterruptSpiTest, read_skips_address_byte_and_finishes_after_length_bytes)
+{
+    uint8_t buffer[3] = {};
+    clock.time = 5;
+    Mpu6500InterruptSpi::startRead(0x3b, buffer, 3);
+
+    Mpu6500InterruptSpi::onByteReceived(0xAA);
+    Mpu6500InterruptSpi::onByteReceived(1);
+    Mpu6500InterruptSpi::onByteReceived(2);
+    EXPECT_TRUE(Mpu6500InterruptSpi::isBusy());
+    Mpu6500InterruptSpi::onByteReceived(3);
+
+    EXPECT_FALSE(Mpu6500InterruptSpi::isBusy());
+    EXPECT_EQ(1, buffer[0]);
+    EXPECT_EQ(2, buffer[1]);
+    EXPECT_EQ(3, buffer[2]);
+    EXPECT_EQ(5000u, Mpu6500InterruptSpi::getCompletionTime());
+}
+
+TEST_F(Mpu6500InterruptSpiTest, bytes_received_when_idle_are_ignored)
+{
+    uint8_t buffer[1] = {};
+    Mpu6500InterruptSpi::startRead(0x3b, buffer, 1);
+    Mpu6500InterruptSpi::onByteReceived(0);
+    Mpu6500InterruptSpi::onByteReceived(7);
+
+    Mpu6500InterruptSpi::onByteReceived(9);
+
+    EXPECT_EQ(7, buffer[0]);
+    EXPECT_FALSE(Mpu6500InterruptSpi::isBusy());
+}
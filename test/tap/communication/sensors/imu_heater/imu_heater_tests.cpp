@@ -17,8 +17,11 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/communication/sensors/imu_heater/imu_heater.hpp"
 #include "tap/communication/sensors/imu_heater/imu_heater_constants.hpp"
 #include "tap/drivers.hpp"
@@ -110,3 +113,91 @@ TEST_F(ImuHeaterTest, runTemperatureController_output_changes_with_temperature_c
 
     EXPECT_NEAR(0, imuHeaterOutput, 1E-3);
 }
+
+/**
+ * Simulated board, the sensor lags the heated die by `SENSOR_LAG` and quantizes like the
+ * bmi088's temperature sensor.
+ */
+struct ThermalPlant
+{
+    static constexpr float AMBIENT = 25;
+    static constexpr float TIME_CONSTANT = 40;
+    static constexpr float FULL_DUTY_RISE = 45;
+    static constexpr float SENSOR_LAG = 0.5f;
+
+    float dieTemperature = AMBIENT;
+    float sensorTemperature = AMBIENT;
+
+    void step(float duty, float dt)
+    {
+        dieTemperature +=
+            dt * (FULL_DUTY_RISE * duty - (dieTemperature - AMBIENT)) / TIME_CONSTANT;
+        sensorTemperature += dt * (dieTemperature - sensorTemperature) / SENSOR_LAG;
+    }
+
+    float measure() const { return std::round(sensorTemperature * 8) / 8; }
+};
+
+class ImuHeaterSimulationTest : public ImuHeaterTest
+{
+protected:
+    /// Runs the heater at 1 kHz for `seconds`, returns the highest measured temperature.
+    float run(float seconds)
+    {
+        float maxTemperature = 0;
+        for (int i = 0; i < seconds * 1000; i++)
+        {
+            clock.time++;
+            float temperature = plant.measure();
+            maxTemperature = std::max(maxTemperature, temperature);
+            heater.runTemperatureController(temperature);
+            plant.step(imuHeaterOutput, 1E-3f);
+        }
+        return maxTemperature;
+    }
+
+    tap::arch::clock::ClockStub clock;
+    ThermalPlant plant;
+};
+
+TEST_F(ImuHeaterSimulationTest, identifies_thermal_model_while_warming_up)
+{
+    run(60);
+
+    EXPECT_TRUE(heater.isModelIdentified());
+    EXPECT_NEAR(ThermalPlant::TIME_CONSTANT, heater.getTimeConstant(), 8);
+    EXPECT_NEAR(ThermalPlant::FULL_DUTY_RISE, heater.getFullDutyTemperatureRise(), 9);
+}
+
+TEST_F(ImuHeaterSimulationTest, warm_up_reaches_setpoint_without_overshoot_and_reports_stable)
+{
+    float maxTemperature = run(90);
+
+    EXPECT_TRUE(heater.isTemperatureStable());
+    EXPECT_LT(maxTemperature, IMU_DESIRED_TEMPERATURE + 0.5f);
+    EXPECT_NEAR(IMU_DESIRED_TEMPERATURE, plant.sensorTemperature, 0.25f);
+    float holdingDuty = (IMU_DESIRED_TEMPERATURE - ThermalPlant::AMBIENT) /
+                        ThermalPlant::FULL_DUTY_RISE;
+    EXPECT_NEAR(holdingDuty, heater.getFeedForwardDuty(), 0.1f);
+}
+
+TEST_F(ImuHeaterSimulationTest, not_stable_until_temperature_held)
+{
+    run(1);
+    EXPECT_FALSE(heater.isTemperatureStable());
+
+    heater.setDesiredTemperature(plant.measure());
+    run(1);
+    EXPECT_FALSE(heater.isTemperatureStable());
+}
+
+TEST_F(ImuHeaterSimulationTest, setpoint_change_clears_stable)
+{
+    run(90);
+    ASSERT_TRUE(heater.isTemperatureStable());
+
+    heater.setDesiredTemperature(IMU_DESIRED_TEMPERATURE + 5);
+    run(0.01f);
+
+    EXPECT_FALSE(heater.isTemperatureStable());
+}
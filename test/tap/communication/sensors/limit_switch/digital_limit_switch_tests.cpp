@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/sensors/limit_switch/digital_limit_switch.hpp"
+#include "tap/mock/digital_mock.hpp"
+
+using namespace tap::communication::sensors::limit_switch;
+using tap::gpio::Digital;
+using namespace testing;
+
+// The first input pin, whichever board the tests are built for
+static constexpr Digital::InputPin PIN = static_cast<Digital::InputPin>(0);
+
+class DigitalLimitSwitchTest : public Test
+{
+protected:
+    DigitalLimitSwitchTest() : limitSwitch(&digital, PIN, true, 1'000) {}
+
+    void SetUp() override
+    {
+        ON_CALL(digital, read(PIN)).WillByDefault(Return(false));
+        ON_CALL(digital, enableInputInterrupt(PIN, Digital::InputTrigger::BothEdges, _, _))
+            .WillByDefault(DoAll(SaveArg<2>(&callback), SaveArg<3>(&context), Return(true)));
+        ASSERT_TRUE(limitSwitch.initialize());
+    }
+
+    /// Simulates the pin's interrupt capturing an edge at `time` microseconds.
+    void edge(bool level, uint32_t time) { callback(context, PIN, level, time); }
+
+    tap::arch::clock::ClockStub clock;
+    NiceMock<tap::mock::DigitalMock> digital;
+    Digital::InputEdgeCallback callback = nullptr;
+    void *context = nullptr;
+    DigitalLimitSwitch limitSwitch;
+};
+
+TEST_F(DigitalLimitSwitchTest, initialize_fails_without_pin_interrupt)
+{
+    ON_CALL(digital, enableInputInterrupt).WillByDefault(Return(false));
+
+    EXPECT_FALSE(limitSwitch.initialize());
+}
+
+TEST_F(DigitalLimitSwitchTest, initial_state_read_from_pin)
+{
+    ON_CALL(digital, read(PIN)).WillByDefault(Return(true));
+
+    limitSwitch.initialize();
+
+    EXPECT_TRUE(limitSwitch.getLimitSwitchDepressed());
+    EXPECT_FALSE(limitSwitch.getPressEvent());
+}
+
+TEST_F(DigitalLimitSwitchTest, press_captured_with_edge_time)
+{
+    edge(true, 12'345);
+
+    EXPECT_TRUE(limitSwitch.getLimitSwitchDepressed());
+    uint32_t time = 0;
+    EXPECT_TRUE(limitSwitch.getPressEvent(&time));
+    EXPECT_EQ(12'345u, time);
+    EXPECT_FALSE(limitSwitch.getPressEvent());
+    EXPECT_EQ(1u, limitSwitch.getNumPresses());
+
+    edge(false, 20'000);
+
+    EXPECT_FALSE(limitSwitch.getLimitSwitchDepressed());
+    EXPECT_EQ(12'345u, limitSwitch.getLastPressTime());
+}
+
+TEST_F(DigitalLimitSwitchTest, active_low_switch_pressed_on_falling_edge)
+{
+    ON_CALL(digital, read(PIN)).WillByDefault(Return(true));
+    DigitalLimitSwitch activeLow(&digital, PIN, false);
+    ASSERT_TRUE(activeLow.initialize());
+    EXPECT_FALSE(activeLow.getLimitSwitchDepressed());
+
+    edge(false, 5'000);
+
+    EXPECT_TRUE(activeLow.getLimitSwitchDepressed());
+    EXPECT_TRUE(activeLow.getPressEvent());
+}
+
+TEST_F(DigitalLimitSwitchTest, bounces_ignored_until_switch_settles)
+{
+    clock.time = 10;
+    edge(true, 10'000);
+    edge(false, 10'200);
+    edge(true, 10'400);
+
+    EXPECT_EQ(1u, limitSwitch.getNumPresses());
+    EXPECT_TRUE(limitSwitch.getLimitSwitchDepressed());
+
+    // Once settled, the state is read from the pin in case the last edge ignored was a release
+    clock.time = 12;
+    EXPECT_CALL(digital, read(PIN)).WillOnce(Return(false));
+    EXPECT_FALSE(limitSwitch.getLimitSwitchDepressed());
+}
+
+TEST_F(DigitalLimitSwitchTest, short_pulses_each_counted_as_press)
+{
+    // Pulses shorter than the debounce time, the release of each is ignored
+    edge(true, 10'000);
+    edge(false, 10'100);
+    edge(true, 15'000);
+    edge(false, 15'100);
+
+    EXPECT_EQ(2u, limitSwitch.getNumPresses());
+    EXPECT_EQ(15'000u, limitSwitch.getLastPressTime());
+}
+
+TEST_F(DigitalLimitSwitchTest, interrupt_disabled_when_destroyed)
+{
+    {
+        DigitalLimitSwitch other(&digital, PIN);
+        other.initialize();
+
+        EXPECT_CALL(digital, disableInputInterrupt(PIN));
+    }
+    Mock::VerifyAndClearExpectations(&digital);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/sensors/sensor_pipeline.hpp"
+
+using namespace tap::communication::sensors;
+
+TEST(SensorPipeline, stages_run_in_order)
+{
+    SensorPipeline<LinearCalibration, Reciprocal> pipeline(
+        LinearCalibration(2.0f, 1.0f),
+        Reciprocal(0.5f));
+
+    EXPECT_FLOAT_EQ(0.7f, pipeline.update(2.0f));
+    EXPECT_FLOAT_EQ(0.7f, pipeline.getValue());
+    EXPECT_TRUE(pipeline.isValid());
+}
+
+TEST(SensorPipeline, range_gate_marks_sample_invalid_but_keeps_value)
+{
+    SensorPipeline<RangeGate, LinearCalibration> pipeline(
+        RangeGate(0.0f, 10.0f),
+        LinearCalibration(1.0f, 1.0f));
+
+    EXPECT_FLOAT_EQ(11.0f, pipeline.update(10.0f));
+    EXPECT_FALSE(pipeline.isValid());
+
+    pipeline.update(5.0f);
+    EXPECT_TRUE(pipeline.isValid());
+}
+
+TEST(SensorPipeline, median_filter_removes_spike)
+{
+    SensorPipeline<MedianFilter<3>> pipeline{MedianFilter<3>()};
+
+    pipeline.update(1.0f);
+    EXPECT_FLOAT_EQ(2.0f, pipeline.update(2.0f));
+    EXPECT_FLOAT_EQ(2.0f, pipeline.update(100.0f));
+    EXPECT_FLOAT_EQ(3.0f, pipeline.update(3.0f));
+    EXPECT_FLOAT_EQ(4.0f, pipeline.update(4.0f));
+}
+
+TEST(SensorPipeline, exponential_filter_matches_low_pass_filter)
+{
+    SensorPipeline<ExponentialFilter> pipeline{ExponentialFilter(0.25f)};
+
+    EXPECT_FLOAT_EQ(1.0f, pipeline.update(4.0f));
+    EXPECT_FLOAT_EQ(1.75f, pipeline.update(4.0f));
+}
+
+TEST(SensorPipeline, batch_update_filters_every_sample)
+{
+    SensorPipeline<ExponentialFilter> batched{ExponentialFilter(0.5f)};
+    SensorPipeline<ExponentialFilter> single{ExponentialFilter(0.5f)};
+    const uint16_t samples[] = {100, 200, 300, 400};
+
+    for (uint16_t sample : samples)
+    {
+        single.update(sample);
+    }
+
+    EXPECT_FLOAT_EQ(single.getValue(), batched.update(samples, 4));
+}
+
+TEST(SensorPipeline, getStage_allows_changing_parameters)
+{
+    SensorPipeline<ExponentialFilter> pipeline{ExponentialFilter(0.5f)};
+
+    pipeline.getStage<0>().setAlpha(1.0f);
+
+    EXPECT_FLOAT_EQ(4.0f, pipeline.update(4.0f));
+}
+
+TEST(SensorPipeline, absolute_value_rectifies_sample)
+{
+    SensorPipeline<LinearCalibration, AbsoluteValue> pipeline(
+        LinearCalibration(1.0f, -10.0f),
+        AbsoluteValue());
+
+    EXPECT_FLOAT_EQ(4.0f, pipeline.update(6.0f));
+}
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/serial/coprocessor_link.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::communication::serial;
+using namespace testing;
+using namespace tap;
+
+struct AimMessage
+{
+    float yaw;
+    float pitch;
+    uint64_t timeUs;
+} modm_packed;
+
+class AimHandler : public CoprocessorLink::TypedMessageHandler<AimMessage>
+{
+public:
+    int numMessages = 0;
+    AimMessage last = {};
+
+protected:
+    void onMessage(const AimMessage &data, uint64_t) override
+    {
+        numMessages++;
+        last = data;
+    }
+};
+
+static constexpr uint16_t AIM_MESSAGE_TYPE = 5;
+
+/**
+ * Connects two links on Uart1 and Uart6 of the same drivers, so whatever one link writes the
+ * other reads.
+ */
+class CoprocessorLinkTest : public Test
+{
+protected:
+    CoprocessorLinkTest()
+        : mcu(&drivers, Uart::Uart1, noPingConfig()),
+          coprocessor(&drivers, Uart::Uart6, noPingConfig())
+    {
+    }
+
+    static CoprocessorLinkConfig noPingConfig()
+    {
+        CoprocessorLinkConfig config;
+        config.pingPeriodMs = 0;
+        return config;
+    }
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.uart, write(_, _, _))
+            .WillByDefault(
+                [&](Uart::UartPort port, const uint8_t *data, std::size_t length)
+                {
+                    written[port == Uart::Uart1 ? 0 : 1].insert(
+                        written[port == Uart::Uart1 ? 0 : 1].end(),
+                        data,
+                        data + length);
+                    return length;
+                });
+        ON_CALL(drivers.uart, read(_, _, _))
+            .WillByDefault(
+                [&](Uart::UartPort port, uint8_t *data, std::size_t length)
+                {
+                    std::deque<uint8_t> &bytes = written[port == Uart::Uart1 ? 1 : 0];
+                    std::size_t numRead = std::min(length, bytes.size());
+                    std::copy_n(bytes.begin(), numRead, data);
+                    bytes.erase(bytes.begin(), bytes.begin() + numRead);
+                    return numRead;
+                });
+        coprocessor.registerHandler(AIM_MESSAGE_TYPE, &aimHandler);
+    }
+
+    /// Discards what the link on `port` wrote that hasn't been read yet.
+    void dropWritten(Uart::UartPort port) { written[port == Uart::Uart1 ? 0 : 1].clear(); }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    std::deque<uint8_t> written[2];
+    CoprocessorLink mcu;
+    CoprocessorLink coprocessor;
+    AimHandler aimHandler;
+};
+
+TEST_F(CoprocessorLinkTest, typed_message_received_by_registered_handler)
+{
+    EXPECT_TRUE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{1.5f, -0.5f, 1234}));
+
+    coprocessor.update();
+
+    EXPECT_EQ(1, aimHandler.numMessages);
+    EXPECT_EQ(1.5f, aimHandler.last.yaw);
+    EXPECT_EQ(-0.5f, aimHandler.last.pitch);
+    EXPECT_EQ(1234u, aimHandler.last.timeUs);
+}
+
+TEST_F(CoprocessorLinkTest, message_of_wrong_size_not_passed_to_typed_handler)
+{
+    mcu.send(AIM_MESSAGE_TYPE, uint32_t(0));
+
+    coprocessor.update();
+
+    EXPECT_EQ(0, aimHandler.numMessages);
+    EXPECT_EQ(1u, aimHandler.getNumWrongSizeMessages());
+}
+
+TEST_F(CoprocessorLinkTest, registerHandler_rejects_reserved_and_duplicate_types)
+{
+    AimHandler other;
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(3);
+
+    EXPECT_FALSE(coprocessor.registerHandler(AIM_MESSAGE_TYPE, &other));
+    EXPECT_FALSE(coprocessor.registerHandler(CoprocessorLink::MESSAGE_TYPE_PING, &other));
+    EXPECT_FALSE(coprocessor.registerHandler(CoprocessorLink::ACK_REQUESTED_FLAG | 1, &other));
+    EXPECT_TRUE(coprocessor.registerHandler(AIM_MESSAGE_TYPE + 1, &other));
+}
+
+TEST_F(CoprocessorLinkTest, acked_message_no_longer_pending_once_acked)
+{
+    EXPECT_TRUE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{}, true));
+    EXPECT_EQ(1, mcu.getNumPendingAcks());
+
+    coprocessor.update();
+    mcu.update();
+
+    EXPECT_EQ(1, aimHandler.numMessages);
+    EXPECT_EQ(0, mcu.getNumPendingAcks());
+    EXPECT_EQ(0u, mcu.getNumRetransmissions());
+}
+
+TEST_F(CoprocessorLinkTest, lost_ack_retransmits_without_handling_message_twice)
+{
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{}, true);
+    coprocessor.update();
+    dropWritten(Uart::Uart6);
+
+    clock.time = 5;
+    mcu.update();
+    coprocessor.update();
+    mcu.update();
+
+    EXPECT_EQ(1u, mcu.getNumRetransmissions());
+    EXPECT_EQ(1, aimHandler.numMessages);
+    EXPECT_EQ(0, mcu.getNumPendingAcks());
+    EXPECT_EQ(0u, coprocessor.getNumDroppedFrames());
+}
+
+TEST_F(CoprocessorLinkTest, unacked_message_given_up_after_max_retransmissions)
+{
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{}, true);
+
+    for (int i = 0; i < 5; i++)
+    {
+        dropWritten(Uart::Uart1);
+        clock.time += 5;
+        mcu.update();
+    }
+
+    EXPECT_EQ(3u, mcu.getNumRetransmissions());
+    EXPECT_EQ(1u, mcu.getNumAckFailures());
+    EXPECT_EQ(0, mcu.getNumPendingAcks());
+}
+
+TEST_F(CoprocessorLinkTest, sending_acked_message_fails_when_all_slots_pending)
+{
+    for (int i = 0; i < CoprocessorLink::MAX_PENDING_ACKS; i++)
+    {
+        EXPECT_TRUE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{}, true));
+    }
+
+    EXPECT_FALSE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{}, true));
+    EXPECT_TRUE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{}));
+}
+
+TEST_F(CoprocessorLinkTest, gaps_in_sequence_numbers_counted_as_dropped_frames)
+{
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{});
+    coprocessor.update();
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{});
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{});
+    dropWritten(Uart::Uart1);
+    mcu.send(AIM_MESSAGE_TYPE, AimMessage{});
+
+    coprocessor.update();
+
+    EXPECT_EQ(2, aimHandler.numMessages);
+    EXPECT_EQ(2u, coprocessor.getNumDroppedFrames());
+}
+
+TEST_F(CoprocessorLinkTest, ping_answered_with_pong)
+{
+    CoprocessorLinkConfig config;
+    config.pingPeriodMs = 10;
+    config.maxRoundTripUs = 10'000;
+    CoprocessorLink pinging(&drivers, Uart::Uart1, config);
+
+    for (int i = 0; i < 3; i++)
+    {
+        clock.time += 10;
+        pinging.update();
+        coprocessor.update();
+    }
+    pinging.update();
+
+    // Both links share a clock
+    EXPECT_TRUE(pinging.isClockSynced());
+    EXPECT_EQ(0, pinging.getClockOffsetUs());
+    EXPECT_EQ(clock.time * 1'000u, pinging.toRemoteTimeUs(clock.time * 1'000u));
+}
+
+/**
+ * Answers pings sent by a link on Uart1 as a coprocessor whose clock runs `drift` faster than
+ * the local clock and is `offsetUs` ahead of it, the ping and pong each taking `tripMs`.
+ */
+class CoprocessorClockSyncTest : public Test
+{
+protected:
+    static constexpr int64_t REMOTE_OFFSET_US = 5'000'000'000;
+    static constexpr double REMOTE_DRIFT = 100e-6;
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.uart, write(Uart::Uart1, _, _))
+            .WillByDefault(
+                [&](Uart::UartPort, const uint8_t *data, std::size_t length)
+                {
+                    written.insert(written.end(), data, data + length);
+                    return length;
+                });
+        ON_CALL(drivers.uart, read(Uart::Uart1, _, _))
+            .WillByDefault(
+                [&](Uart::UartPort, uint8_t *data, std::size_t length)
+                {
+                    std::size_t numRead = std::min(length, toRead.size());
+                    std::copy_n(toRead.begin(), numRead, data);
+                    toRead.erase(toRead.begin(), toRead.begin() + numRead);
+                    return numRead;
+                });
+    }
+
+    static uint64_t remoteTimeUs(uint64_t localTimeUs)
+    {
+        return REMOTE_OFFSET_US + static_cast<uint64_t>(localTimeUs * (1 + REMOTE_DRIFT));
+    }
+
+    /// Replies to the ping written by the link, `tripMs` after it was sent and taking `tripMs`.
+    void replyToPing(CoprocessorLink &link, uint32_t tripMs)
+    {
+        CoprocessorLink::PingMessage ping;
+        ASSERT_GE(written.size(), 7 + sizeof(ping));
+        memcpy(&ping, written.data() + 7, sizeof(ping));
+        written.clear();
+
+        clock.time += tripMs;
+        const uint64_t receiveTime = remoteTimeUs(clock.time * 1'000ull);
+        DJISerial::SerialMessage<sizeof(CoprocessorLink::PongMessage)> pong(pongSeq++);
+        pong.messageType = CoprocessorLink::MESSAGE_TYPE_PONG;
+        CoprocessorLink::PongMessage data{ping.sendTimeUs, receiveTime, receiveTime};
+        memcpy(pong.data, &data, sizeof(data));
+        pong.setCRC16();
+
+        clock.time += tripMs;
+        toRead.insert(
+            toRead.end(),
+            reinterpret_cast<uint8_t *>(&pong),
+            reinterpret_cast<uint8_t *>(&pong) + sizeof(pong));
+        link.update();
+        written.clear();
+    }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    std::vector<uint8_t> written;
+    std::vector<uint8_t> toRead;
+    uint8_t pongSeq = 0;
+};
+
+TEST_F(CoprocessorClockSyncTest, tracks_remote_clock_offset_and_drift)
+{
+    CoprocessorLinkConfig config;
+    config.pingPeriodMs = 100;
+    config.maxRoundTripUs = 10'000;
+    CoprocessorLink link(&drivers, Uart::Uart1, config);
+    EXPECT_FALSE(link.isClockSynced());
+
+    for (int i = 1; i <= 200; i++)
+    {
+        clock.time = 100 * i;
+        link.update();
+        replyToPing(link, 1);
+    }
+
+    EXPECT_TRUE(link.isClockSynced());
+    EXPECT_EQ(2'000u, link.getRoundTripTimeUs());
+    EXPECT_NEAR(100, link.getClockDriftPpm(), 1);
+
+    const uint64_t now = clock.time * 1'000ull;
+    EXPECT_NEAR(0, static_cast<int64_t>(link.toRemoteTimeUs(now) - remoteTimeUs(now)), 5);
+    EXPECT_NEAR(
+        0,
+        static_cast<int64_t>(link.toLocalTimeUs(remoteTimeUs(now + 50'000)) - (now + 50'000)),
+        5);
+}
+
+TEST_F(CoprocessorClockSyncTest, samples_with_long_round_trip_rejected)
+{
+    CoprocessorLinkConfig config;
+    config.pingPeriodMs = 100;
+    config.maxRoundTripUs = 3'000;
+    CoprocessorLink link(&drivers, Uart::Uart1, config);
+
+    clock.time = 100;
+    link.update();
+    replyToPing(link, 2);
+
+    EXPECT_EQ(1u, link.getNumRejectedSyncSamples());
+    EXPECT_FALSE(link.isClockSynced());
+}
+
+TEST_F(CoprocessorClockSyncTest, not_synced_after_sync_timeout)
+{
+    CoprocessorLinkConfig config;
+    config.pingPeriodMs = 100;
+    config.maxRoundTripUs = 10'000;
+    config.syncTimeoutMs = 500;
+    CoprocessorLink link(&drivers, Uart::Uart1, config);
+
+    for (int i = 1; i <= 2; i++)
+    {
+        clock.time = 100 * i;
+        link.update();
+        replyToPing(link, 1);
+    }
+    EXPECT_TRUE(link.isClockSynced());
+
+    clock.time += 501;
+    EXPECT_FALSE(link.isClockSynced());
+}
+
+/// Writes to one queue and reads from another, so two transports can be connected.
+class QueueTransport : public ByteTransport
+{
+public:
+    QueueTransport(std::deque<uint8_t> &rx, std::deque<uint8_t> &tx) : rx(rx), tx(tx) {}
+
+    void initialize() override { initialized = true; }
+
+    std::size_t read(uint8_t *data, std::size_t length) override
+    {
+        std::size_t numRead = std::min(length, rx.size());
+        std::copy_n(rx.begin(), numRead, data);
+        rx.erase(rx.begin(), rx.begin() + numRead);
+        return numRead;
+    }
+
+    std::size_t write(const uint8_t *data, std::size_t length) override
+    {
+        tx.insert(tx.end(), data, data + length);
+        return length;
+    }
+
+    bool initialized = false;
+
+private:
+    std::deque<uint8_t> &rx;
+    std::deque<uint8_t> &tx;
+};
+
+TEST(CoprocessorLinkTransport, link_runs_over_byte_transport_without_uart)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    std::deque<uint8_t> toCoprocessor, toMcu;
+    QueueTransport mcuTransport(toMcu, toCoprocessor);
+    QueueTransport coprocessorTransport(toCoprocessor, toMcu);
+    CoprocessorLink mcu(&drivers, &mcuTransport);
+    CoprocessorLink coprocessor(&drivers, &coprocessorTransport);
+    AimHandler aimHandler;
+    coprocessor.registerHandler(AIM_MESSAGE_TYPE, &aimHandler);
+
+    EXPECT_CALL(drivers.uart, read(_, _, _)).Times(0);
+    EXPECT_CALL(drivers.uart, write(_, _, _)).Times(0);
+
+    mcu.initialize();
+    EXPECT_TRUE(mcuTransport.initialized);
+
+    EXPECT_TRUE(mcu.send(AIM_MESSAGE_TYPE, AimMessage{1.5f, -0.5f, 1234}, true));
+    coprocessor.update();
+    mcu.update();
+
+    EXPECT_EQ(1, aimHandler.numMessages);
+    EXPECT_EQ(1234u, aimHandler.last.timeUs);
+    EXPECT_EQ(0, mcu.getNumPendingAcks());
+}
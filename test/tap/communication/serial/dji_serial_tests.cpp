@@ -17,6 +17,9 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include <gtest/gtest.h>
 
 #include "tap/algorithms/crc.hpp"
@@ -41,9 +44,11 @@ class DJISerialTester : public DJISerial
     void messageReceiveCallback(const ReceivedSerialMessage &completeMessage) override
     {
         lastMsg = completeMessage;
+        numMessagesReceived++;
     }
 
     ReceivedSerialMessage lastMsg;
+    int numMessagesReceived = 0;
 };
 
 TEST(DJISerial, updateSerial_parseMessage_single_byte_at_a_time_crcenforcement)
@@ -196,6 +201,8 @@ TEST(DJISerial, updateSerial_parseMessage_crc16_one_off)
     {
         serial.updateSerial();
     }
+
+    EXPECT_EQ(0u, serial.getRxMessageCount());
 }
 
 TEST(DJISerial, updateSerial_parseMessage_msg_length_0)
@@ -351,3 +358,159 @@ TEST(DJISerial, updateSerial_parseMessage_all_bytes_received_at_once_crcenforcem
 
     EXPECT_EQ(calculateCRC16(rawMessage, 17), serial.lastMsg.CRC16);
 }
+
+TEST(DJISerial, updateSerial_rejected_header_resyncs_on_buffered_head_byte)
+{
+    Drivers drivers;
+    DJISerialTester serial(&drivers, Uart::Uart1, true);
+
+    // the stray head byte is parsed as a frame header that fails the CRC8 check, and the real
+    // header that was read in the same chunk must not be discarded with it
+    EXPECT_CALL(drivers.errorController, addToErrorList)
+        .WillOnce([&](const tap::errors::SystemError &error)
+                  { EXPECT_TRUE(errorDescriptionContainsSubstr(error, "CRC8 failure")); });
+
+    uint8_t rawMessage[20];
+    std::size_t currByte = 0;
+
+    rawMessage[0] = 0xa5;
+    convertToLittleEndian(static_cast<uint8_t>(0xa5), rawMessage + 1);
+    convertToLittleEndian(static_cast<uint16_t>(10), rawMessage + 2);
+    convertToLittleEndian(static_cast<uint8_t>(123), rawMessage + 4);
+    convertToLittleEndian(calculateCRC8(rawMessage + 1, 4), rawMessage + 5);
+    convertToLittleEndian(static_cast<uint16_t>(2), rawMessage + 6);
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        rawMessage[i + 8] = i;
+    }
+    convertToLittleEndian(calculateCRC16(rawMessage + 1, 17), rawMessage + 18);
+
+    ON_CALL(drivers.uart, read(Uart::Uart1, _, _))
+        .WillByDefault(
+            [&](Uart::UartPort, uint8_t *data, std::size_t length)
+            {
+                std::size_t bytesRead = std::min(length, sizeof(rawMessage) - currByte);
+                memcpy(data, rawMessage + currByte, bytesRead);
+                currByte += bytesRead;
+                return bytesRead;
+            });
+
+    serial.updateSerial();
+
+    EXPECT_EQ(0xa5, serial.lastMsg.header.headByte);
+    EXPECT_EQ(10, serial.lastMsg.header.dataLength);
+    EXPECT_EQ(123, serial.lastMsg.header.seq);
+    EXPECT_EQ(2, serial.lastMsg.messageType);
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(i, serial.lastMsg.data[i]);
+    }
+}
+
+TEST(DJISerial, updateSerial_parses_every_message_in_a_single_read)
+{
+    Drivers drivers;
+    DJISerialTester serial(&drivers, Uart::Uart1, true);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    static constexpr int NUM_MESSAGES = 5;
+    static constexpr int MESSAGE_LENGTH = 19;
+
+    uint8_t rawMessages[NUM_MESSAGES * MESSAGE_LENGTH];
+    std::size_t currByte = 0;
+
+    for (int msg = 0; msg < NUM_MESSAGES; msg++)
+    {
+        uint8_t *rawMessage = rawMessages + msg * MESSAGE_LENGTH;
+        convertToLittleEndian(static_cast<uint8_t>(0xa5), rawMessage);
+        convertToLittleEndian(static_cast<uint16_t>(10), rawMessage + 1);
+        convertToLittleEndian(static_cast<uint8_t>(msg), rawMessage + 3);
+        convertToLittleEndian(calculateCRC8(rawMessage, 4), rawMessage + 4);
+        convertToLittleEndian(static_cast<uint16_t>(2), rawMessage + 5);
+        for (uint8_t i = 0; i < 10; i++)
+        {
+            rawMessage[i + 7] = i;
+        }
+        convertToLittleEndian(calculateCRC16(rawMessage, 17), rawMessage + 17);
+    }
+
+    ON_CALL(drivers.uart, read(Uart::Uart1, _, _))
+        .WillByDefault(
+            [&](Uart::UartPort, uint8_t *data, std::size_t length)
+            {
+                std::size_t bytesRead = std::min(length, sizeof(rawMessages) - currByte);
+                memcpy(data, rawMessages + currByte, bytesRead);
+                currByte += bytesRead;
+                return bytesRead;
+            });
+
+    serial.updateSerial();
+
+    EXPECT_EQ(NUM_MESSAGES, serial.numMessagesReceived);
+    EXPECT_EQ(static_cast<uint32_t>(NUM_MESSAGES), serial.getRxMessageCount());
+    EXPECT_EQ(NUM_MESSAGES - 1, serial.lastMsg.header.seq);
+}
+
+TEST(DJISerial, updateSerial_skips_junk_between_messages_split_across_reads)
+{
+    Drivers drivers;
+    DJISerialTester serial(&drivers, Uart::Uart1, true);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    static constexpr int NUM_MESSAGES = 20;
+    static constexpr int JUNK_LENGTH = 16;
+    static constexpr int MESSAGE_LENGTH = JUNK_LENGTH + 109;
+    // Smaller than a message, so reads end partway through headers and bodies
+    static constexpr std::size_t BURST_SIZE = 37;
+
+    uint8_t stream[NUM_MESSAGES * MESSAGE_LENGTH];
+
+    for (int msg = 0; msg < NUM_MESSAGES; msg++)
+    {
+        uint8_t *junk = stream + msg * MESSAGE_LENGTH;
+        for (int i = 0; i < JUNK_LENGTH; i++)
+        {
+            junk[i] = i;
+        }
+        uint8_t *rawMessage = junk + JUNK_LENGTH;
+        convertToLittleEndian(static_cast<uint8_t>(0xa5), rawMessage);
+        convertToLittleEndian(static_cast<uint16_t>(100), rawMessage + 1);
+        convertToLittleEndian(static_cast<uint8_t>(msg), rawMessage + 3);
+        convertToLittleEndian(calculateCRC8(rawMessage, 4), rawMessage + 4);
+        convertToLittleEndian(static_cast<uint16_t>(0x201), rawMessage + 5);
+        for (uint8_t i = 0; i < 100; i++)
+        {
+            rawMessage[i + 7] = i;
+        }
+        convertToLittleEndian(calculateCRC16(rawMessage, 107), rawMessage + 107);
+    }
+
+    std::size_t currByte = 0;
+    std::size_t burstEnd = 0;
+    ON_CALL(drivers.uart, read(Uart::Uart1, _, _))
+        .WillByDefault(
+            [&](Uart::UartPort, uint8_t *data, std::size_t length)
+            {
+                std::size_t bytesRead = std::min(length, burstEnd - currByte);
+                memcpy(data, stream + currByte, bytesRead);
+                currByte += bytesRead;
+                return bytesRead;
+            });
+
+    while (currByte < sizeof(stream))
+    {
+        burstEnd = std::min(sizeof(stream), burstEnd + BURST_SIZE);
+        while (currByte < burstEnd)
+        {
+            serial.updateSerial();
+        }
+    }
+    serial.updateSerial();
+
+    EXPECT_EQ(NUM_MESSAGES, serial.numMessagesReceived);
+    EXPECT_EQ(NUM_MESSAGES - 1, serial.lastMsg.header.seq);
+    EXPECT_EQ(99, serial.lastMsg.data[99]);
+}
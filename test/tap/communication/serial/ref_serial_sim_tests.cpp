@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/serial/ref_serial_sim.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap;
+using namespace tap::communication::serial;
+using namespace tap::motor::motorsim;
+
+static constexpr float DT = 0.001f;
+
+class RefSerialSimTest : public testing::Test
+{
+protected:
+    RefSerialSimTest() : refSerial(&drivers)
+    {
+        // a large inertia keeps the motor slow, so its current tracks its input
+        motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS, 100);
+        config.powerNoise = 0;
+    }
+
+    void run(RefSerialSim &sim, int steps)
+    {
+        for (int i = 0; i < steps; i++)
+        {
+            engine.step(DT);
+            sim.step(DT);
+        }
+    }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial;
+    MotorSimEngine engine;
+    int motor;
+    RefSerialSim::Config config = RefSerialSim::STANDARD_CONFIG;
+};
+
+TEST_F(RefSerialSimTest, first_step_sends_robot_status)
+{
+    RefSerialSim sim(refSerial, engine, config);
+
+    sim.step(DT);
+
+    const RefSerial::Rx::RobotData &robotData = refSerial.getRobotData();
+    EXPECT_EQ(config.robotId, robotData.robotId);
+    EXPECT_EQ(config.maxHp, robotData.currentHp);
+    EXPECT_EQ(config.chassisPowerLimit, robotData.chassis.powerConsumptionLimit);
+    EXPECT_EQ(config.heatLimit, robotData.turret.heatLimit);
+    EXPECT_EQ(config.coolingRate, robotData.turret.coolingRate);
+    EXPECT_EQ(config.maxPowerBuffer, robotData.chassis.powerBuffer);
+    EXPECT_EQ(24'000, robotData.chassis.volt);
+}
+
+TEST_F(RefSerialSimTest, messages_sent_at_configured_periods)
+{
+    RefSerialSim sim(refSerial, engine, config);
+
+    run(sim, 90);
+
+    // 5 power and heat messages and 1 robot status message in 90 ms
+    EXPECT_EQ(6u, refSerial.getRobotDataGeneration());
+}
+
+TEST_F(RefSerialSimTest, chassis_power_is_electrical_power_of_chassis_motors)
+{
+    RefSerialSim sim(refSerial, engine, config);
+    ASSERT_TRUE(sim.addChassisMotor(motor));
+
+    engine.setInput(motor, MotorSimEngine::M3508_PARAMETERS.maxInput / 2);
+    run(sim, 20);
+
+    EXPECT_GT(sim.getChassisPower(), 0);
+    EXPECT_FLOAT_EQ(engine.getVoltage(motor) * engine.getCurrent(motor), sim.getChassisPower());
+    EXPECT_NEAR(sim.getChassisPower(), refSerial.getRobotData().chassis.power, 1);
+}
+
+TEST_F(RefSerialSimTest, power_buffer_drains_above_limit_and_refills_below)
+{
+    config.chassisPowerLimit = 0;
+    RefSerialSim sim(refSerial, engine, config);
+    sim.addChassisMotor(motor);
+
+    engine.setInput(motor, MotorSimEngine::M3508_PARAMETERS.maxInput);
+    run(sim, 100);
+    const float drainedBuffer = sim.getPowerBuffer();
+
+    EXPECT_LT(drainedBuffer, config.maxPowerBuffer);
+
+    sim.setChassisPowerLimit(60);
+    engine.setInput(motor, 0);
+    run(sim, 100);
+
+    EXPECT_GT(sim.getPowerBuffer(), drainedBuffer);
+}
+
+TEST_F(RefSerialSimTest, braking_motor_draws_no_power)
+{
+    int wheel = engine.addMotor(MotorSimEngine::M3508_PARAMETERS);
+    RefSerialSim sim(refSerial, engine, config);
+    sim.addChassisMotor(wheel);
+    engine.setInput(wheel, MotorSimEngine::M3508_PARAMETERS.maxInput);
+    run(sim, 100);
+    ASSERT_GT(sim.getChassisPower(), 0);
+
+    engine.setInput(wheel, -MotorSimEngine::M3508_PARAMETERS.maxInput / 100);
+    run(sim, 1);
+
+    EXPECT_EQ(0, sim.getChassisPower());
+}
+
+TEST_F(RefSerialSimTest, launched_projectiles_heat_turret_and_cool)
+{
+    RefSerialSim sim(refSerial, engine, config);
+
+    sim.launchProjectile17mm();
+    sim.launchProjectile17mm();
+    run(sim, 20);
+
+    EXPECT_NEAR(20 - config.coolingRate * 0.02f, sim.getHeat(), 1e-3f);
+    EXPECT_EQ(19, refSerial.getRobotData().turret.heat17ID1);
+
+    run(sim, 2'000);
+
+    EXPECT_EQ(0, sim.getHeat());
+}
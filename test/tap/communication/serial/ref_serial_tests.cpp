@@ -19,14 +19,18 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/architecture/endianness_wrappers.hpp"
 #include "tap/communication/serial/ref_serial.hpp"
 #include "tap/drivers.hpp"
+#include "tap/mock/game_event_listener_mock.hpp"
 #include "tap/mock/robot_to_robot_message_handler_mock.hpp"
+#include "tap/mock/rx_message_handler_mock.hpp"
 
 using namespace tap;
 using namespace tap::communication::serial;
 using namespace tap::arch;
+using testing::InSequence;
 
 template <typename T>
 static DJISerial::ReceivedSerialMessage constructMsg(const T &data, int type)
@@ -507,6 +511,40 @@ TEST(RefSerial, messageReceiveCallback__robot_buffs)
     EXPECT_EQ(50, refSerial.getRobotData().robotBuffStatus.vulnerabilityBuff);
 }
 
+TEST(RefSerial, messageReceiveCallback__vtm_input)
+{
+    struct VtmInputData
+    {
+        int16_t mouseX;
+        int16_t mouseY;
+        int16_t mouseZ;
+        int8_t mouseL;
+        int8_t mouseR;
+        uint16_t key;
+        uint16_t reserved;
+    } modm_packed;
+
+    clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    RefSerial::Rx::VtmInputData input;
+
+    EXPECT_EQ(0u, refSerial.getVtmInput(&input));
+
+    clock.time = 1234;
+    VtmInputData testData = {-100, 200, 3, 1, 0, 0x8001, 0};
+    refSerial.messageReceiveCallback(constructMsg(testData, 0x0304));
+
+    EXPECT_EQ(1u, refSerial.getVtmInput(&input));
+    EXPECT_EQ(-100, input.mouseX);
+    EXPECT_EQ(200, input.mouseY);
+    EXPECT_EQ(3, input.mouseZ);
+    EXPECT_TRUE(input.mouseL);
+    EXPECT_FALSE(input.mouseR);
+    EXPECT_EQ(0x8001, input.key);
+    EXPECT_EQ(1234u, input.receiveTime);
+}
+
 TEST(RefSerial, messageReceiveCallback__air_support_data)
 {
     Drivers drivers;
@@ -748,3 +786,458 @@ TEST(RefSerial, messageReceiveCallback__robot_to_robot_data_simple_message)
 
     refSerial.messageReceiveCallback(msg);
 }
+
+TEST(RefSerial, attachRxMessageHandler__fails_to_add_if_commandId_invalid)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::RxMessageHandlerMock handler;
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(2);
+
+    EXPECT_FALSE(refSerial.attachRxMessageHandler(0x120, &handler));
+    EXPECT_FALSE(refSerial.attachRxMessageHandler(0x401, &handler));
+}
+
+TEST(RefSerial, attachRxMessageHandler__fails_to_add_if_commandId_already_added)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::RxMessageHandlerMock handler;
+
+    EXPECT_TRUE(refSerial.attachRxMessageHandler(0x202, &handler));
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(1);
+
+    EXPECT_FALSE(refSerial.attachRxMessageHandler(0x202, &handler));
+}
+
+TEST(RefSerial, messageReceiveCallback__rx_message_handler_called_with_received_message)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::RxMessageHandlerMock handler;
+    tap::mock::RxMessageHandlerMock otherHandler;
+
+    uint8_t data[3] = {1, 2, 3};
+    DJISerial::ReceivedSerialMessage msg = constructMsg(data, 0x20F);
+
+    refSerial.attachRxMessageHandler(0x20F, &handler);
+    refSerial.attachRxMessageHandler(0x10F, &otherHandler);
+
+    EXPECT_CALL(handler, functorOp)
+        .WillOnce(
+            [&](const DJISerial::ReceivedSerialMessage &message)
+            {
+                // the handler is passed the received message itself rather than a copy
+                EXPECT_EQ(&msg, &message);
+            });
+    EXPECT_CALL(otherHandler, functorOp).Times(0);
+
+    refSerial.messageReceiveCallback(msg);
+}
+
+TEST(RefSerial, messageReceiveCallback__rx_message_handler_called_after_decoding)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::RxMessageHandlerMock handler;
+
+    uint8_t gameResult = 2;
+    DJISerial::ReceivedSerialMessage msg =
+        constructMsg(gameResult, RefSerial::REF_MESSAGE_TYPE_GAME_RESULT);
+
+    refSerial.attachRxMessageHandler(RefSerial::REF_MESSAGE_TYPE_GAME_RESULT, &handler);
+
+    EXPECT_CALL(handler, functorOp)
+        .WillOnce(
+            [&](const DJISerial::ReceivedSerialMessage &)
+            {
+                EXPECT_EQ(RefSerial::Rx::GameWinner::BLUE, refSerial.getGameData().gameWinner);
+            });
+
+    refSerial.messageReceiveCallback(msg);
+}
+
+TEST(RefSerial, setRxMessageDecodingEnabled__disabled_messages_not_decoded)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::RxMessageHandlerMock handler;
+
+    uint16_t allRobotHp[16];
+    for (int i = 0; i < 16; i++)
+    {
+        allRobotHp[i] = 100 + i;
+    }
+    DJISerial::ReceivedSerialMessage msg =
+        constructMsg(allRobotHp, RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP);
+
+    refSerial.setRxMessageDecodingEnabled(RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP, false);
+    refSerial.attachRxMessageHandler(RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP, &handler);
+
+    EXPECT_CALL(handler, functorOp).Times(1);
+
+    refSerial.messageReceiveCallback(msg);
+
+    EXPECT_EQ(0, refSerial.getRobotData().allRobotHp.red.hero1);
+    EXPECT_TRUE(refSerial.getRefSerialReceivingData());
+
+    refSerial.setRxMessageDecodingEnabled(RefSerial::REF_MESSAGE_TYPE_ALL_ROBOT_HP, true);
+
+    EXPECT_CALL(handler, functorOp).Times(1);
+
+    refSerial.messageReceiveCallback(msg);
+
+    EXPECT_EQ(100, refSerial.getRobotData().allRobotHp.red.hero1);
+}
+
+TEST(RefSerial, acquireTransmissionSemaphore__waits_for_bandwidth_after_sending)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    using Priority = RefSerial::Tx::TransmissionPriority;
+
+    clock.time = 1000;
+
+    // the bucket starts full, so a message may be sent immediately
+    refSerial.queueTransmission(Priority::NORMAL);
+    ASSERT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 100));
+    refSerial.releaseTransmissionSemaphore(Priority::NORMAL, 100);
+
+    // 100 bytes take 100 ms to send at 1000 bytes/s
+    refSerial.queueTransmission(Priority::NORMAL);
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 100));
+    clock.time += 69;
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 100));
+    clock.time += 1;
+    EXPECT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 100));
+}
+
+TEST(RefSerial, acquireTransmissionSemaphore__only_one_message_sent_at_a_time)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    using Priority = RefSerial::Tx::TransmissionPriority;
+
+    refSerial.queueTransmission(Priority::LOW);
+    refSerial.queueTransmission(Priority::LOW);
+    EXPECT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+
+    refSerial.releaseTransmissionSemaphore(Priority::LOW, 10);
+
+    EXPECT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+}
+
+TEST(RefSerial, acquireTransmissionSemaphore__higher_priority_messages_sent_first)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    using Priority = RefSerial::Tx::TransmissionPriority;
+
+    refSerial.queueTransmission(Priority::LOW);
+    refSerial.queueTransmission(Priority::NORMAL);
+    refSerial.queueTransmission(Priority::HIGH);
+
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 10));
+    ASSERT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::HIGH, 10));
+    refSerial.releaseTransmissionSemaphore(Priority::HIGH, 10);
+
+    EXPECT_FALSE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+    ASSERT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::NORMAL, 10));
+    refSerial.releaseTransmissionSemaphore(Priority::NORMAL, 10);
+
+    EXPECT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 10));
+}
+
+TEST(RefSerial, getTransmissionQueueStats__tracks_queue_depth_and_bytes_sent)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    using Priority = RefSerial::Tx::TransmissionPriority;
+
+    refSerial.queueTransmission(Priority::LOW);
+    refSerial.queueTransmission(Priority::LOW);
+
+    const RefSerial::Tx::TransmissionQueueStats &stats =
+        refSerial.getTransmissionQueueStats(Priority::LOW);
+    EXPECT_EQ(2, stats.queueDepth);
+    EXPECT_EQ(2, stats.maxQueueDepth);
+
+    ASSERT_TRUE(refSerial.acquireTransmissionSemaphore(Priority::LOW, 30));
+    refSerial.releaseTransmissionSemaphore(Priority::LOW, 30);
+
+    EXPECT_EQ(1, stats.queueDepth);
+    EXPECT_EQ(2, stats.maxQueueDepth);
+    EXPECT_EQ(1u, stats.messagesSent);
+    EXPECT_EQ(30u, stats.bytesSent);
+    EXPECT_EQ(0u, refSerial.getTransmissionQueueStats(Priority::HIGH).messagesSent);
+}
+
+TEST(RefSerial, getRobotDataGeneration__incremented_only_by_robot_data_messages)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+
+    uint8_t gameResult = 1;
+    refSerial.messageReceiveCallback(
+        constructMsg(gameResult, RefSerial::REF_MESSAGE_TYPE_GAME_RESULT));
+
+    EXPECT_EQ(0u, refSerial.getRobotDataGeneration());
+    EXPECT_EQ(1u, refSerial.getGameDataGeneration());
+
+    uint8_t powerAndHeat[16] = {};
+    refSerial.messageReceiveCallback(
+        constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+
+    EXPECT_EQ(1u, refSerial.getRobotDataGeneration());
+    EXPECT_EQ(1u, refSerial.getGameDataGeneration());
+
+    // messages that aren't decoded don't change either struct
+    uint8_t unknown[4] = {};
+    refSerial.messageReceiveCallback(constructMsg(unknown, 0x20F));
+
+    EXPECT_EQ(1u, refSerial.getRobotDataGeneration());
+    EXPECT_EQ(1u, refSerial.getGameDataGeneration());
+}
+
+TEST(RefSerial, getRobotDataSnapshot__copies_decoded_data_and_generation)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+
+    uint8_t powerAndHeat[16] = {};
+    convertToLittleEndian<uint16_t>(24'000, powerAndHeat);
+    convertToLittleEndian<uint16_t>(57, powerAndHeat + 8);
+    refSerial.messageReceiveCallback(
+        constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+
+    RefSerial::Rx::RobotData snapshot;
+    EXPECT_EQ(1u, refSerial.getRobotDataSnapshot(&snapshot));
+    EXPECT_EQ(24'000, snapshot.chassis.volt);
+    EXPECT_EQ(57, snapshot.chassis.powerBuffer);
+
+    RefSerial::Rx::GameData gameSnapshot;
+    EXPECT_EQ(0u, refSerial.getGameDataSnapshot(&gameSnapshot));
+}
+
+TEST(RefSerial, getRobotDataAge__time_since_robot_data_decoded)
+{
+    clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+
+    EXPECT_EQ(UINT32_MAX, refSerial.getRobotDataAge());
+    EXPECT_EQ(UINT32_MAX, refSerial.getGameDataAge());
+
+    clock.time = 1'000;
+    uint8_t powerAndHeat[16] = {};
+    refSerial.messageReceiveCallback(
+        constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+    clock.time = 1'150;
+
+    EXPECT_EQ(150u, refSerial.getRobotDataAge());
+    EXPECT_EQ(UINT32_MAX, refSerial.getGameDataAge());
+
+    // messages that aren't decoded don't refresh the data
+    refSerial.setRxMessageDecodingEnabled(RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT, false);
+    refSerial.messageReceiveCallback(
+        constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+
+    EXPECT_EQ(150u, refSerial.getRobotDataAge());
+}
+
+TEST(RefSerial, getRxMessageTiming__tracks_intervals_per_command_id)
+{
+    clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    uint8_t powerAndHeat[16] = {};
+    uint8_t robotStatus[13] = {};
+
+    for (uint32_t time : {100, 150, 210, 250})
+    {
+        clock.time = time;
+        refSerial.messageReceiveCallback(
+            constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+    }
+    refSerial.messageReceiveCallback(
+        constructMsg(robotStatus, RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS));
+
+    const RefSerial::Rx::RxMessageTiming &timing =
+        refSerial.getRxMessageTiming(RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT);
+    EXPECT_EQ(4u, timing.numReceived);
+    EXPECT_EQ(250'000u, timing.lastReceiveTimeUs);
+    EXPECT_EQ(3u, timing.numIntervals);
+    EXPECT_EQ(40'000u, timing.lastIntervalUs);
+    EXPECT_EQ(40'000u, timing.minIntervalUs);
+    EXPECT_EQ(60'000u, timing.maxIntervalUs);
+    EXPECT_NEAR(50'000, timing.meanIntervalUs, 2'000);
+    EXPECT_GT(timing.jitterUs, 0u);
+
+    EXPECT_EQ(
+        1u,
+        refSerial.getRxMessageTiming(RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS).numReceived);
+    EXPECT_EQ(
+        0u,
+        refSerial.getRxMessageTiming(RefSerial::REF_MESSAGE_TYPE_GAME_STATUS).numReceived);
+    EXPECT_EQ(0u, refSerial.getRxMessageTiming(0xffff).numReceived);
+}
+
+TEST(RefSerial, resetRxMessageTiming__clears_interval_statistics_only)
+{
+    clock::ClockStub clock;
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    uint8_t powerAndHeat[16] = {};
+    for (uint32_t time : {100, 200})
+    {
+        clock.time = time;
+        refSerial.messageReceiveCallback(
+            constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+    }
+
+    refSerial.resetRxMessageTiming();
+    clock.time = 220;
+    refSerial.messageReceiveCallback(
+        constructMsg(powerAndHeat, RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT));
+
+    const RefSerial::Rx::RxMessageTiming &timing =
+        refSerial.getRxMessageTiming(RefSerial::REF_MESSAGE_TYPE_POWER_AND_HEAT);
+    EXPECT_EQ(3u, timing.numReceived);
+    EXPECT_EQ(1u, timing.numIntervals);
+    EXPECT_EQ(20'000u, timing.maxIntervalUs);
+    EXPECT_EQ(20'000u, timing.meanIntervalUs);
+}
+
+static DJISerial::ReceivedSerialMessage constructGameStatus(RefSerial::Rx::GameStage stage)
+{
+    uint8_t gameStatus[11] = {};
+    gameStatus[0] = static_cast<uint8_t>(stage) << 4;
+    return constructMsg(gameStatus, RefSerial::REF_MESSAGE_TYPE_GAME_STATUS);
+}
+
+static DJISerial::ReceivedSerialMessage constructRobotStatus(uint16_t hp, uint8_t level = 1)
+{
+    GameRobotStatus robotStatus = {};
+    robotStatus.robot_level = level;
+    robotStatus.remainHP = hp;
+    return constructMsg(robotStatus, RefSerial::REF_MESSAGE_TYPE_ROBOT_STATUS);
+}
+
+TEST(RefSerial, attachGameEventListener__match_start_and_end_dispatched_on_stage_change)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    testing::StrictMock<tap::mock::GameEventListenerMock> listener;
+    refSerial.attachGameEventListener(&listener);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::GAME_STAGE_CHANGED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::GAME_STAGE_CHANGED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::MATCH_STARTED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::GAME_STAGE_CHANGED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::MATCH_ENDED));
+    }
+
+    refSerial.messageReceiveCallback(constructGameStatus(RefSerial::Rx::GameStage::COUNTDOWN));
+    refSerial.messageReceiveCallback(constructGameStatus(RefSerial::Rx::GameStage::IN_GAME));
+    refSerial.messageReceiveCallback(constructGameStatus(RefSerial::Rx::GameStage::IN_GAME));
+    refSerial.messageReceiveCallback(constructGameStatus(RefSerial::Rx::GameStage::END_GAME));
+}
+
+TEST(RefSerial, attachGameEventListener__listener_sees_decoded_state)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::GameEventListenerMock listener;
+    refSerial.attachGameEventListener(&listener, RefSerial::Rx::MATCH_STARTED);
+
+    EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::MATCH_STARTED))
+        .WillOnce(
+            [&](RefSerial::Rx::GameEvent)
+            {
+                EXPECT_EQ(RefSerial::Rx::GameStage::IN_GAME, refSerial.getGameData().gameStage);
+            });
+
+    refSerial.messageReceiveCallback(constructGameStatus(RefSerial::Rx::GameStage::IN_GAME));
+}
+
+TEST(RefSerial, attachGameEventListener__robot_death_and_revival_detected_after_first_status)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    testing::StrictMock<tap::mock::GameEventListenerMock> listener;
+    refSerial.attachGameEventListener(
+        &listener,
+        RefSerial::Rx::ROBOT_DIED | RefSerial::Rx::ROBOT_REVIVED |
+            RefSerial::Rx::ROBOT_LEVEL_CHANGED);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::ROBOT_DIED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::ROBOT_REVIVED));
+        EXPECT_CALL(listener, onGameEvent(RefSerial::Rx::ROBOT_LEVEL_CHANGED));
+    }
+
+    refSerial.messageReceiveCallback(constructRobotStatus(200));
+    refSerial.messageReceiveCallback(constructRobotStatus(100));
+    refSerial.messageReceiveCallback(constructRobotStatus(0));
+    refSerial.messageReceiveCallback(constructRobotStatus(0));
+    refSerial.messageReceiveCallback(constructRobotStatus(200));
+    refSerial.messageReceiveCallback(constructRobotStatus(200, 2));
+}
+
+TEST(RefSerial, attachGameEventListener__listeners_called_only_for_events_in_mask)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    testing::StrictMock<tap::mock::GameEventListenerMock> projectileListener;
+    testing::StrictMock<tap::mock::GameEventListenerMock> buffListener;
+    refSerial.attachGameEventListener(
+        &projectileListener,
+        RefSerial::Rx::PROJECTILE_ALLOWANCE_CHANGED);
+    refSerial.attachGameEventListener(&buffListener, RefSerial::Rx::BUFFS_CHANGED);
+    uint16_t bulletsRemain[3] = {100, 0, 0};
+    uint8_t buffs[6] = {0, 5, 0, 0, 0, 0};
+
+    EXPECT_CALL(projectileListener, onGameEvent(RefSerial::Rx::PROJECTILE_ALLOWANCE_CHANGED))
+        .Times(2);
+    EXPECT_CALL(buffListener, onGameEvent(RefSerial::Rx::BUFFS_CHANGED));
+
+    refSerial.messageReceiveCallback(
+        constructMsg(bulletsRemain, RefSerial::REF_MESSAGE_TYPE_BULLETS_REMAIN));
+    refSerial.messageReceiveCallback(
+        constructMsg(bulletsRemain, RefSerial::REF_MESSAGE_TYPE_BULLETS_REMAIN));
+    bulletsRemain[0] = 90;
+    refSerial.messageReceiveCallback(
+        constructMsg(bulletsRemain, RefSerial::REF_MESSAGE_TYPE_BULLETS_REMAIN));
+    refSerial.messageReceiveCallback(
+        constructMsg(buffs, RefSerial::REF_MESSAGE_TYPE_ROBOT_BUFF_STATUS));
+    refSerial.messageReceiveCallback(
+        constructMsg(buffs, RefSerial::REF_MESSAGE_TYPE_ROBOT_BUFF_STATUS));
+}
+
+TEST(RefSerial, attachGameEventListener__fails_once_full)
+{
+    Drivers drivers;
+    RefSerial refSerial(&drivers);
+    tap::mock::GameEventListenerMock listeners[RefSerial::MAX_GAME_EVENT_LISTENERS + 1];
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(2);
+
+    for (int i = 0; i < RefSerial::MAX_GAME_EVENT_LISTENERS; i++)
+    {
+        EXPECT_TRUE(refSerial.attachGameEventListener(&listeners[i]));
+    }
+    EXPECT_FALSE(
+        refSerial.attachGameEventListener(&listeners[RefSerial::MAX_GAME_EVENT_LISTENERS]));
+    EXPECT_FALSE(refSerial.attachGameEventListener(nullptr));
+}
@@ -17,6 +17,8 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 #include "tap/communication/serial/remote.hpp"
@@ -38,6 +40,25 @@ class RemoteTest : public Test
     void SetUp() override
     {
         ON_CALL(drivers.uart, read(_, _)).WillByDefault(Invoke(this, &RemoteTest::handleRead));
+        ON_CALL(drivers.refSerial, getVtmInput)
+            .WillByDefault(
+                [&](RefSerialData::Rx::VtmInputData *input)
+                {
+                    if (vtmInputsReceived > 0)
+                    {
+                        *input = vtmInput;
+                    }
+                    return vtmInputsReceived;
+                });
+    }
+
+    /// Reports keyboard and mouse input as received over the video transmitter link now.
+    void receiveVtmInput(uint16_t key, bool mouseL = false)
+    {
+        vtmInput.key = key;
+        vtmInput.mouseL = mouseL;
+        vtmInput.receiveTime = clock.time;
+        vtmInputsReceived++;
     }
 
     void encodeRemoteData()
@@ -70,6 +91,26 @@ class RemoteTest : public Test
         encodedRemoteData.push_back(wheelE >> 8);
     }
 
+    /// Reports every byte in encodedRemoteData as received before the receive line went idle.
+    void enableRxDma()
+    {
+        ON_CALL(drivers.uart, isRxDmaEnabled).WillByDefault(Return(true));
+        ON_CALL(drivers.uart, getBytesUntilRxIdle)
+            .WillByDefault([&](Uart::UartPort) { return encodedRemoteData.size(); });
+        ON_CALL(drivers.uart, read(_, _, _))
+            .WillByDefault(
+                [&](Uart::UartPort, uint8_t *data, std::size_t length)
+                {
+                    std::size_t bytesRead = std::min(length, encodedRemoteData.size());
+                    for (std::size_t i = 0; i < bytesRead; i++)
+                    {
+                        data[i] = encodedRemoteData.front();
+                        encodedRemoteData.pop_front();
+                    }
+                    return bytesRead;
+                });
+    }
+
     bool handleRead(Uart::UartPort, uint8_t *data)
     {
         if (encodedRemoteData.size() == 0)
@@ -120,8 +161,12 @@ class RemoteTest : public Test
     Remote::SwitchState rss = Remote::SwitchState::UNKNOWN;
     bool lb = false;
     bool rb = false;
+    RefSerialData::Rx::VtmInputData vtmInput;
+    uint32_t vtmInputsReceived = 0;
 };
 
+static constexpr uint16_t keyBit(Remote::Key key) { return 1 << static_cast<int>(key); }
+
 TEST_F(RemoteTest, read_parses_18_bytes_received_all_at_once)
 {
     rh = 1;
@@ -221,3 +266,473 @@ TEST_F(RemoteTest, read_invalid_joystick_values_errors)
 
     remote.read();
 }
+
+TEST_F(RemoteTest, read_rx_dma_parses_frame_ending_at_idle_line)
+{
+    enableRxDma();
+
+    rh = 1;
+    rv = -2;
+    keys = 5;
+    wheel = 9;
+    lss = Remote::SwitchState::DOWN;
+    rss = Remote::SwitchState::UP;
+
+    encodeRemoteData();
+
+    remote.read();
+
+    evaluateRemoteInfo();
+
+    EXPECT_TRUE(remote.isConnected());
+}
+
+TEST_F(RemoteTest, read_rx_dma_waits_for_idle_line)
+{
+    enableRxDma();
+    ON_CALL(drivers.uart, getBytesUntilRxIdle).WillByDefault(Return(0));
+
+    encodeRemoteData();
+
+    remote.read();
+
+    EXPECT_FALSE(remote.isConnected());
+    EXPECT_EQ(18u, encodedRemoteData.size());
+}
+
+TEST_F(RemoteTest, read_rx_dma_burst_shorter_than_frame_discarded)
+{
+    enableRxDma();
+
+    encodeRemoteData();
+    encodedRemoteData.pop_front();
+
+    remote.read();
+
+    EXPECT_FALSE(remote.isConnected());
+    EXPECT_TRUE(encodedRemoteData.empty());
+
+    encodeRemoteData();
+
+    remote.read();
+
+    EXPECT_TRUE(remote.isConnected());
+}
+
+TEST_F(RemoteTest, read_rx_dma_multiple_frames_most_recent_parsed)
+{
+    enableRxDma();
+
+    wheel = 100;
+    encodeRemoteData();
+    wheel = 200;
+    encodeRemoteData();
+
+    remote.read();
+
+    EXPECT_TRUE(encodedRemoteData.empty());
+    evaluateRemoteInfo();
+}
+
+TEST_F(RemoteTest, popInputEvent_returns_false_when_no_inputs_changed)
+{
+    encodeRemoteData();
+    remote.read();
+
+    Remote::InputEvent event;
+    EXPECT_EQ(0, remote.getInputEventCount());
+    EXPECT_FALSE(remote.popInputEvent(&event));
+}
+
+TEST_F(RemoteTest, popInputEvent_reports_press_and_release_between_polls_with_timestamps)
+{
+    keys = 1 << static_cast<int>(Remote::Key::E);
+    clock.time = 10;
+    encodeRemoteData();
+    remote.read();
+
+    keys = 0;
+    clock.time = 24;
+    encodeRemoteData();
+    remote.read();
+
+    EXPECT_FALSE(remote.keyPressed(Remote::Key::E));
+    EXPECT_EQ(2, remote.getInputEventCount());
+
+    Remote::InputEvent event;
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_DOWN, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Key::E), event.input);
+    EXPECT_EQ(10'000u, event.timestamp);
+
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_UP, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Key::E), event.input);
+    EXPECT_EQ(24'000u, event.timestamp);
+
+    EXPECT_FALSE(remote.popInputEvent(&event));
+}
+
+TEST_F(RemoteTest, popInputEvent_orders_switches_then_mouse_then_keys)
+{
+    lss = Remote::SwitchState::UP;
+    rb = true;
+    keys = (1 << static_cast<int>(Remote::Key::W)) | (1 << static_cast<int>(Remote::Key::B));
+    encodeRemoteData();
+    remote.read();
+
+    Remote::InputEvent event;
+    ASSERT_EQ(4, remote.getInputEventCount());
+
+    remote.popInputEvent(&event);
+    EXPECT_EQ(Remote::InputEvent::Type::SWITCH_CHANGE, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Switch::LEFT_SWITCH), event.input);
+    EXPECT_EQ(Remote::SwitchState::UP, event.switchState);
+
+    remote.popInputEvent(&event);
+    EXPECT_EQ(Remote::InputEvent::Type::MOUSE_DOWN, event.type);
+    EXPECT_EQ(1, event.input);
+
+    remote.popInputEvent(&event);
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_DOWN, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Key::W), event.input);
+
+    remote.popInputEvent(&event);
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_DOWN, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Key::B), event.input);
+}
+
+TEST_F(RemoteTest, popInputEvent_reports_releases_on_disconnect)
+{
+    lb = true;
+    keys = 1 << static_cast<int>(Remote::Key::SHIFT);
+    encodeRemoteData();
+    remote.read();
+
+    Remote::InputEvent event;
+    while (remote.popInputEvent(&event))
+    {
+    }
+
+    clock.time += 1000;
+    remote.read();
+
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::MOUSE_UP, event.type);
+    EXPECT_EQ(0, event.input);
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_UP, event.type);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::Key::SHIFT), event.input);
+    EXPECT_FALSE(remote.popInputEvent(&event));
+}
+
+TEST_F(RemoteTest, full_input_event_queue_drops_oldest_events)
+{
+    const int frames = Remote::INPUT_EVENT_QUEUE_SIZE + 3;
+    for (int i = 0; i < frames; i++)
+    {
+        keys = i % 2 == 0 ? 1 << static_cast<int>(Remote::Key::Q) : 0;
+        clock.time = i;
+        encodeRemoteData();
+        remote.read();
+    }
+
+    EXPECT_EQ(Remote::INPUT_EVENT_QUEUE_SIZE, remote.getInputEventCount());
+    EXPECT_EQ(3u, remote.getDroppedInputEventCount());
+
+    Remote::InputEvent event;
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::KEY_UP, event.type);
+    EXPECT_EQ(3'000u, event.timestamp);
+}
+
+TEST_F(RemoteTest, getChannel_without_smoothing_steps_between_frames)
+{
+    lv = 330;
+    clock.time = 100;
+    encodeRemoteData();
+    remote.read();
+
+    clock.time = 107;
+    EXPECT_FLOAT_EQ(0.5f, remote.getChannel(Remote::Channel::LEFT_VERTICAL));
+    EXPECT_EQ(100u, remote.getLastFrameTime());
+}
+
+TEST_F(RemoteTest, getChannel_with_prediction_extrapolates_from_last_two_frames)
+{
+    Remote::ChannelSmoothing smoothing;
+    smoothing.predict = true;
+    remote.setChannelSmoothing(Remote::Channel::LEFT_VERTICAL, smoothing);
+
+    lv = 0;
+    clock.time = 100;
+    encodeRemoteData();
+    remote.read();
+
+    lv = 132;
+    clock.time = 114;
+    encodeRemoteData();
+    remote.read();
+
+    EXPECT_FLOAT_EQ(0.2f, remote.getChannel(Remote::Channel::LEFT_VERTICAL));
+    clock.time = 121;
+    EXPECT_FLOAT_EQ(0.3f, remote.getChannel(Remote::Channel::LEFT_VERTICAL));
+
+    // Held at the prediction horizon if the next frame is late
+    clock.time = 200;
+    EXPECT_FLOAT_EQ(0.4f, remote.getChannel(Remote::Channel::LEFT_VERTICAL));
+
+    // Other channels are unaffected
+    EXPECT_FLOAT_EQ(0.0f, remote.getChannel(Remote::Channel::RIGHT_VERTICAL));
+}
+
+TEST_F(RemoteTest, getChannel_with_prediction_starts_from_first_frame_after_disconnect)
+{
+    Remote::ChannelSmoothing smoothing;
+    smoothing.predict = true;
+    remote.setChannelSmoothing(Remote::Channel::WHEEL, smoothing);
+
+    wheel = 660;
+    clock.time = 1000;
+    encodeRemoteData();
+    remote.read();
+
+    clock.time = 2000;
+    remote.read();
+    EXPECT_FALSE(remote.isConnected());
+    EXPECT_FLOAT_EQ(0.0f, remote.getChannel(Remote::Channel::WHEEL));
+
+    wheel = -330;
+    clock.time = 2001;
+    encodeRemoteData();
+    remote.read();
+
+    clock.time = 2010;
+    EXPECT_FLOAT_EQ(-0.5f, remote.getChannel(Remote::Channel::WHEEL));
+}
+
+TEST_F(RemoteTest, getChannel_applies_deadband_and_curve)
+{
+    Remote::ChannelSmoothing smoothing;
+    smoothing.deadband = 0.2f;
+    smoothing.curveExponent = 2.0f;
+    remote.setChannelSmoothing(Remote::Channel::RIGHT_HORIZONTAL, smoothing);
+
+    rh = 66;
+    encodeRemoteData();
+    remote.read();
+    EXPECT_FLOAT_EQ(0.0f, remote.getChannel(Remote::Channel::RIGHT_HORIZONTAL));
+
+    rh = -396;
+    encodeRemoteData();
+    remote.read();
+    EXPECT_NEAR(-0.25f, remote.getChannel(Remote::Channel::RIGHT_HORIZONTAL), 1E-5);
+
+    rh = 660;
+    encodeRemoteData();
+    remote.read();
+    EXPECT_FLOAT_EQ(1.0f, remote.getChannel(Remote::Channel::RIGHT_HORIZONTAL));
+}
+
+TEST_F(RemoteTest, read_merges_vtm_input)
+{
+    receiveVtmInput(keyBit(Remote::Key::W), true);
+
+    EXPECT_CALL(
+        drivers.commandMapper,
+        handleKeyStateChange(keyBit(Remote::Key::W), _, _, true, false));
+
+    remote.read();
+
+    EXPECT_TRUE(remote.isVtmInputConnected());
+    EXPECT_FALSE(remote.isConnected());
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::W));
+    EXPECT_TRUE(remote.getMouseL());
+    Remote::InputEvent event;
+    ASSERT_TRUE(remote.popInputEvent(&event));
+    EXPECT_EQ(Remote::InputEvent::Type::MOUSE_DOWN, event.type);
+}
+
+TEST_F(RemoteTest, read_each_key_follows_source_that_most_recently_changed_it)
+{
+    receiveVtmInput(keyBit(Remote::Key::W));
+    remote.read();
+
+    // The DR16 reporting no keys doesn't release the key held over the video transmitter link
+    keys = keyBit(Remote::Key::E);
+    encodeRemoteData();
+    remote.read();
+
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::W));
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::E));
+
+    // The video transmitter link pressing E, then releasing both keys, releases E as well
+    clock.time += 10;
+    receiveVtmInput(keyBit(Remote::Key::W) | keyBit(Remote::Key::E));
+    remote.read();
+    clock.time += 10;
+    receiveVtmInput(0);
+    remote.read();
+
+    EXPECT_FALSE(remote.keyPressed(Remote::Key::W));
+    EXPECT_FALSE(remote.keyPressed(Remote::Key::E));
+
+    // Until the DR16 reports a change to E
+    clock.time += 10;
+    keys = 0;
+    encodeRemoteData();
+    remote.read();
+    clock.time += 10;
+    keys = keyBit(Remote::Key::E);
+    encodeRemoteData();
+    remote.read();
+
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::E));
+}
+
+TEST_F(RemoteTest, read_vtm_input_timeout_releases_only_vtm_input)
+{
+    keys = keyBit(Remote::Key::E);
+    encodeRemoteData();
+    receiveVtmInput(keyBit(Remote::Key::W));
+    remote.read();
+
+    clock.time += 90;
+    encodeRemoteData();
+    remote.read();
+    EXPECT_TRUE(remote.isVtmInputConnected());
+
+    clock.time += 60;
+    remote.read();
+
+    EXPECT_FALSE(remote.isVtmInputConnected());
+    EXPECT_TRUE(remote.isConnected());
+    EXPECT_FALSE(remote.keyPressed(Remote::Key::W));
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::E));
+}
+
+TEST_F(RemoteTest, read_remote_disconnect_keeps_vtm_input)
+{
+    keys = keyBit(Remote::Key::E);
+    encodeRemoteData();
+    receiveVtmInput(keyBit(Remote::Key::W));
+    remote.read();
+
+    clock.time += 1000;
+    receiveVtmInput(keyBit(Remote::Key::W));
+
+    EXPECT_CALL(
+        drivers.commandMapper,
+        handleKeyStateChange(
+            keyBit(Remote::Key::W),
+            Remote::SwitchState::UNKNOWN,
+            Remote::SwitchState::UNKNOWN,
+            false,
+            false))
+        .Times(AtLeast(1));
+
+    remote.read();
+
+    EXPECT_FALSE(remote.isConnected());
+    EXPECT_TRUE(remote.isVtmInputConnected());
+    EXPECT_TRUE(remote.keyPressed(Remote::Key::W));
+    EXPECT_FALSE(remote.keyPressed(Remote::Key::E));
+}
+
+TEST_F(RemoteTest, getConnectionQuality_learns_frame_period)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        encodeRemoteData();
+        remote.read();
+        clock.time += 14;
+    }
+
+    Remote::ConnectionQuality quality = remote.getConnectionQuality();
+    EXPECT_EQ(10u, quality.framesReceived);
+    EXPECT_EQ(14'000u, quality.framePeriodUs);
+    EXPECT_EQ(0u, quality.jitterUs);
+    EXPECT_NEAR(1e6f / 14'000, quality.frameRate, 1e-3f);
+    EXPECT_EQ(0u, quality.gaps);
+    EXPECT_EQ(14'000u, quality.longestGapUs);
+}
+
+TEST_F(RemoteTest, getMissedFrames_zero_until_frame_period_learned)
+{
+    encodeRemoteData();
+    remote.read();
+    clock.time += 14;
+    encodeRemoteData();
+    remote.read();
+
+    clock.time += 80;
+    remote.read();
+
+    EXPECT_EQ(0u, remote.getMissedFrames());
+    EXPECT_FALSE(remote.isMissingFrames());
+}
+
+TEST_F(RemoteTest, isMissingFrames_detects_stopped_frames_before_disconnect_timeout)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        encodeRemoteData();
+        remote.read();
+        clock.time += 14;
+    }
+    // The last frame was received 14 ms ago
+    clock.time += 26;
+    remote.read();
+
+    EXPECT_EQ(2u, remote.getMissedFrames());
+    EXPECT_FALSE(remote.isMissingFrames());
+
+    clock.time += 10;
+    remote.read();
+
+    EXPECT_EQ(3u, remote.getMissedFrames());
+    EXPECT_TRUE(remote.isMissingFrames());
+    EXPECT_TRUE(remote.isConnected());
+
+    remote.setMissedFrameLimit(4);
+
+    EXPECT_FALSE(remote.isMissingFrames());
+}
+
+TEST_F(RemoteTest, getConnectionQuality_counts_gaps_in_frames)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        encodeRemoteData();
+        remote.read();
+        clock.time += 14;
+    }
+    clock.time += 14;
+    encodeRemoteData();
+    remote.read();
+
+    Remote::ConnectionQuality quality = remote.getConnectionQuality();
+    EXPECT_EQ(1u, quality.gaps);
+    EXPECT_EQ(1u, quality.framesMissed);
+    EXPECT_EQ(28'000u, quality.longestGapUs);
+    EXPECT_EQ(14'000u, quality.framePeriodUs);
+    EXPECT_EQ(0u, remote.getMissedFrames());
+}
+
+TEST_F(RemoteTest, getConnectionQuality_counts_bad_frames)
+{
+    rh = 661;
+    encodeRemoteData();
+    remote.read();
+
+    // An incomplete frame is discarded after the read timeout
+    rh = 0;
+    encodeRemoteData();
+    encodedRemoteData.pop_back();
+    remote.read();
+    clock.time += 10;
+    remote.read();
+
+    EXPECT_EQ(2u, remote.getConnectionQuality().badFrames);
+    EXPECT_EQ(1u, remote.getConnectionQuality().framesReceived);
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/serial/telemetry_stream.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::communication::serial;
+using namespace tap::stub;
+using namespace testing;
+
+/**
+ * Splits everything written to `device` at zero bytes and COBS decodes each frame, as the host
+ * does. Frames that fail to decode or fail the CRC check are dropped.
+ */
+static std::vector<std::vector<uint8_t>> readPackets(TerminalDeviceStub &device)
+{
+    std::string written = device.readAllItemsFromWriteBufferToString();
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<uint8_t> frame;
+
+    for (std::size_t i = 0; i <= written.size(); i++)
+    {
+        if (i < written.size() && written[i] != 0)
+        {
+            frame.push_back(written[i]);
+            continue;
+        }
+        if (frame.empty())
+        {
+            continue;
+        }
+
+        std::vector<uint8_t> packet;
+        bool valid = true;
+        for (std::size_t j = 0; j < frame.size() && valid;)
+        {
+            uint8_t code = frame[j++];
+            valid = j + code - 1 <= frame.size();
+            for (int k = 1; k < code && valid; k++)
+            {
+                packet.push_back(frame[j++]);
+            }
+            if (code < 0xff && j < frame.size())
+            {
+                packet.push_back(0);
+            }
+        }
+        frame.clear();
+
+        if (valid && packet.size() > sizeof(uint16_t))
+        {
+            std::size_t length = packet.size() - sizeof(uint16_t);
+            uint16_t crc = packet[length] | (packet[length + 1] << 8);
+            if (crc == tap::algorithms::calculateCRC16(packet.data(), length))
+            {
+                packet.resize(length);
+                packets.push_back(packet);
+            }
+        }
+    }
+
+    return packets;
+}
+
+class TelemetryStreamTest : public Test
+{
+protected:
+    TelemetryStreamTest() : device(nullptr), telemetry(device) {}
+
+    tap::arch::clock::ClockStub clock;
+    TerminalDeviceStub device;
+    TelemetryStream telemetry;
+};
+
+TEST(TelemetryStream, cobsEncode_removes_zeros)
+{
+    uint8_t data[] = {0x11, 0x00, 0x00, 0x22, 0x33};
+    uint8_t encoded[sizeof(data) + 1];
+
+    ASSERT_EQ(6, TelemetryStream::cobsEncode(data, sizeof(data), encoded));
+
+    uint8_t expected[] = {0x02, 0x11, 0x01, 0x03, 0x22, 0x33};
+    EXPECT_EQ(0, memcmp(expected, encoded, sizeof(expected)));
+}
+
+TEST(TelemetryStream, cobsEncode_splits_long_runs_of_nonzero_bytes)
+{
+    uint8_t data[300];
+    memset(data, 0xaa, sizeof(data));
+    uint8_t encoded[sizeof(data) + sizeof(data) / 254 + 1];
+
+    ASSERT_EQ(302, TelemetryStream::cobsEncode(data, sizeof(data), encoded));
+
+    EXPECT_EQ(0xff, encoded[0]);
+    EXPECT_EQ(sizeof(data) - 254 + 1, encoded[255]);
+    EXPECT_EQ(nullptr, memchr(encoded, 0, sizeof(encoded)));
+}
+
+TEST_F(TelemetryStreamTest, start_fails_without_signals)
+{
+    EXPECT_FALSE(telemetry.start(1000));
+    EXPECT_FALSE(telemetry.isStreaming());
+}
+
+TEST_F(TelemetryStreamTest, addSignal_fails_while_streaming)
+{
+    float value = 0;
+    EXPECT_TRUE(telemetry.addSignal("a", &value));
+    EXPECT_TRUE(telemetry.start(1000));
+
+    EXPECT_FALSE(telemetry.addSignal("b", &value));
+    EXPECT_EQ(1, telemetry.getNumSignals());
+}
+
+TEST_F(TelemetryStreamTest, update_sends_descriptor_then_data)
+{
+    float pitch = 1.5f;
+    int16_t current = -1000;
+    uint8_t state = 3;
+    telemetry.addSignal("pitch", &pitch);
+    telemetry.addSignal("current", &current);
+    telemetry.addSignal("state", &state);
+
+    clock.time = 10;
+    telemetry.start(1000);
+
+    telemetry.update();
+    auto packets = readPackets(device);
+    ASSERT_EQ(1, packets.size());
+    std::vector<uint8_t> expectedDescriptor = {TelemetryStream::DESCRIPTOR_PACKET_TYPE, 3};
+    for (auto [type, name] :
+         {std::pair{TelemetryStream::SignalType::FLOAT, "pitch"},
+          std::pair{TelemetryStream::SignalType::INT16, "current"},
+          std::pair{TelemetryStream::SignalType::UINT8, "state"}})
+    {
+        expectedDescriptor.push_back(static_cast<uint8_t>(type));
+        expectedDescriptor.push_back(strlen(name));
+        expectedDescriptor.insert(expectedDescriptor.end(), name, name + strlen(name));
+    }
+    EXPECT_EQ(expectedDescriptor, packets[0]);
+
+    clock.time = 11;
+    telemetry.update();
+    packets = readPackets(device);
+    ASSERT_EQ(1, packets.size());
+    ASSERT_EQ(telemetry.getDataPacketLength() - sizeof(uint16_t), packets[0].size());
+    EXPECT_EQ(TelemetryStream::DATA_PACKET_TYPE, packets[0][0]);
+    EXPECT_EQ(0, packets[0][1]);
+    uint32_t time;
+    memcpy(&time, &packets[0][2], sizeof(time));
+    EXPECT_EQ(11'000, time);
+    float sentPitch;
+    memcpy(&sentPitch, &packets[0][6], sizeof(sentPitch));
+    EXPECT_EQ(pitch, sentPitch);
+    int16_t sentCurrent;
+    memcpy(&sentCurrent, &packets[0][10], sizeof(sentCurrent));
+    EXPECT_EQ(current, sentCurrent);
+    EXPECT_EQ(state, packets[0][12]);
+}
+
+TEST_F(TelemetryStreamTest, update_sends_data_at_rate)
+{
+    int32_t value = 0;
+    telemetry.addSignal("value", &value);
+    telemetry.start(100);
+    telemetry.update();
+    readPackets(device);
+
+    int numDataPackets = 0;
+    for (clock.time = 1; clock.time <= 100; clock.time++)
+    {
+        telemetry.update();
+        for (const auto &packet : readPackets(device))
+        {
+            if (packet[0] == TelemetryStream::DATA_PACKET_TYPE)
+            {
+                EXPECT_EQ(numDataPackets, packet[1]);
+                numDataPackets++;
+            }
+        }
+    }
+
+    EXPECT_EQ(10, numDataPackets);
+}
+
+TEST_F(TelemetryStreamTest, update_resends_descriptor_periodically)
+{
+    uint16_t value = 0;
+    telemetry.addSignal("value", &value);
+    telemetry.start(1000);
+
+    int numDescriptors = 0;
+    for (clock.time = 0; clock.time < 3 * TelemetryStream::DESCRIPTOR_PERIOD_MS; clock.time++)
+    {
+        telemetry.update();
+        for (const auto &packet : readPackets(device))
+        {
+            if (packet[0] == TelemetryStream::DESCRIPTOR_PACKET_TYPE)
+            {
+                numDescriptors++;
+            }
+        }
+    }
+
+    EXPECT_EQ(3, numDescriptors);
+}
+
+TEST_F(TelemetryStreamTest, update_sends_nothing_once_stopped)
+{
+    float value = 0;
+    telemetry.addSignal("value", &value);
+    telemetry.start(1000);
+    telemetry.update();
+    telemetry.stop();
+    device.readAllItemsFromWriteBufferToString();
+
+    clock.time = 100;
+    telemetry.update();
+
+    EXPECT_EQ(0, device.readAllItemsFromWriteBufferToString().size());
+}
+
+TEST_F(TelemetryStreamTest, sendBlock_sends_payload_without_streaming)
+{
+    uint8_t payload[TelemetryStream::MAX_BLOCK_LENGTH];
+    for (std::size_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = i;
+    }
+
+    ASSERT_TRUE(telemetry.sendBlock(7, payload, sizeof(payload)));
+
+    auto packets = readPackets(device);
+    ASSERT_EQ(1, packets.size());
+    ASSERT_EQ(2 + sizeof(payload), packets[0].size());
+    EXPECT_EQ(TelemetryStream::BLOCK_PACKET_TYPE, packets[0][0]);
+    EXPECT_EQ(7, packets[0][1]);
+    EXPECT_EQ(0, memcmp(payload, packets[0].data() + 2, sizeof(payload)));
+}
+
+TEST_F(TelemetryStreamTest, sendBlock_fails_if_payload_too_long)
+{
+    uint8_t payload[TelemetryStream::MAX_BLOCK_LENGTH + 1] = {};
+
+    EXPECT_FALSE(telemetry.sendBlock(7, payload, sizeof(payload)));
+    EXPECT_EQ(0, device.readAllItemsFromWriteBufferToString().size());
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/serial/terminal_output_buffer.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::communication::serial;
+using namespace tap::stub;
+
+TEST(TerminalOutputBuffer, drain_writes_everything_device_accepts)
+{
+    TerminalOutputBuffer<8> buffer;
+    TerminalDeviceStub device(nullptr);
+
+    buffer.write("hello");
+    EXPECT_EQ(3, buffer.getFreeSpace());
+
+    EXPECT_EQ(5, buffer.drain(device));
+    EXPECT_EQ(0, buffer.getSize());
+    EXPECT_EQ("hello", device.readAllItemsFromWriteBufferToString());
+}
+
+TEST(TerminalOutputBuffer, drain_keeps_bytes_device_does_not_accept)
+{
+    TerminalOutputBuffer<8> buffer;
+    TerminalDeviceStub device(nullptr);
+    device.setTryWriteLimit(2);
+
+    buffer.write("hello");
+
+    EXPECT_EQ(2, buffer.drain(device));
+    EXPECT_EQ(3, buffer.getSize());
+    EXPECT_EQ(2, buffer.drain(device));
+    EXPECT_EQ(1, buffer.drain(device));
+    EXPECT_EQ(0, buffer.drain(device));
+    EXPECT_EQ("hello", device.readAllItemsFromWriteBufferToString());
+}
+
+TEST(TerminalOutputBuffer, drain_handles_output_wrapping_around_end_of_buffer)
+{
+    TerminalOutputBuffer<8> buffer;
+    TerminalDeviceStub device(nullptr);
+
+    buffer.write("abcdef");
+    buffer.drain(device);
+    device.readAllItemsFromWriteBufferToString();
+
+    buffer.write("ghijklmn");
+    EXPECT_EQ(0, buffer.getFreeSpace());
+
+    EXPECT_EQ(8, buffer.drain(device));
+    EXPECT_EQ("ghijklmn", device.readAllItemsFromWriteBufferToString());
+}
+
+TEST(TerminalOutputBuffer, write_drops_bytes_when_full)
+{
+    TerminalOutputBuffer<4> buffer;
+    TerminalDeviceStub device(nullptr);
+
+    buffer.write("abcdef");
+
+    EXPECT_EQ(2, buffer.getNumDroppedBytes());
+    buffer.drain(device);
+    EXPECT_EQ("abcd", device.readAllItemsFromWriteBufferToString());
+}
@@ -226,3 +226,144 @@ TEST(TerminalSerial, update__with_some_header_doesnt_enter_streaming_mode_if_cal
     clock.time = TerminalSerial::STREAMING_PERIOD + 1;
     serial.update();
 }
+
+TEST(TerminalSerial, update__telemetry_header_starts_and_stops_telemetry_stream)
+{
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    TerminalSerial serial(&drivers);
+
+    float value = 0;
+    serial.getTelemetryStream().addSignal("value", &value);
+
+    char startInput[] = "telemetry start 500\n";
+    std::vector<char> inputVec(startInput, startInput + sizeof(startInput) - 1);
+    serial.device.emplaceItemsInReadBuffer(inputVec);
+
+    for (size_t i = 0; i < inputVec.size(); i++)
+    {
+        serial.update();
+    }
+
+    EXPECT_TRUE(serial.getTelemetryStream().isStreaming());
+
+    char stopInput[] = "telemetry stop\n";
+    inputVec = std::vector<char>(stopInput, stopInput + sizeof(stopInput) - 1);
+    serial.device.emplaceItemsInReadBuffer(inputVec);
+
+    for (size_t i = 0; i < inputVec.size(); i++)
+    {
+        serial.update();
+    }
+
+    EXPECT_FALSE(serial.getTelemetryStream().isStreaming());
+    EXPECT_THAT(serial.device.readAllItemsFromWriteBufferToString(), HasSubstr("stopped"));
+}
+
+TEST(TerminalSerial, addHeader__headers_found_regardless_of_order_added)
+{
+    tap::Drivers drivers;
+    TerminalSerial serial(&drivers);
+
+    const char *headers[] = {"motor", "alpha", "zeta", "imu", "can", "error"};
+    TerminalSerialCallbackInterfaceMock interfaces[6];
+    for (int i = 0; i < 6; i++)
+    {
+        serial.addHeader(headers[i], &interfaces[i]);
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        EXPECT_CALL(interfaces[i], terminalSerialCallback).WillOnce(Return(true));
+
+        std::string input = std::string(headers[i]) + "\n";
+        std::vector<char> inputVec(input.begin(), input.end());
+        serial.device.emplaceItemsInReadBuffer(inputVec);
+
+        for (size_t j = 0; j < inputVec.size(); j++)
+        {
+            serial.update();
+        }
+    }
+
+    EXPECT_THAT(serial.device.readAllItemsFromWriteBufferToString(), Not(HasSubstr("not found")));
+}
+
+TEST(TerminalSerial, addHeader__raises_error_when_table_full)
+{
+    tap::Drivers drivers;
+    TerminalSerial serial(&drivers);
+
+    TerminalSerialCallbackInterfaceMock interface;
+    // one header is taken by the telemetry stream
+    std::vector<std::string> headers;
+    for (int i = 0; i < TerminalSerial::MAX_HEADERS; i++)
+    {
+        headers.push_back("header" + std::to_string(i));
+    }
+
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    for (const auto &header : headers)
+    {
+        serial.addHeader(header.c_str(), &interface);
+    }
+
+    // replacing a header doesn't need space in the table
+    serial.addHeader(headers[0].c_str(), &interface);
+}
+
+TEST(TerminalSerial, update__input_not_processed_until_previous_output_sent)
+{
+    tap::Drivers drivers;
+    TerminalSerial serial(&drivers);
+
+    TerminalSerialCallbackInterfaceMock interface;
+    serial.addHeader("foo", &interface);
+
+    // output from the first callback leaves less than CALLBACK_MAX_OUTPUT bytes free, so the
+    // second line must wait
+    EXPECT_CALL(interface, terminalSerialCallback)
+        .WillOnce(
+            [](char *, modm::IOStream &outputStream, bool)
+            {
+                for (int i = 0; i < TerminalSerial::OUTPUT_BUFFER_SIZE / 2; i++)
+                {
+                    outputStream << 'a';
+                }
+                return true;
+            });
+
+    // the device accepts nothing, so output from the first callback stays buffered
+    serial.device.setTryWriteLimit(0);
+
+    char input[] = "foo\nfoo\n";
+    std::vector<char> inputVec(input, input + sizeof(input) - 1);
+    serial.device.emplaceItemsInReadBuffer(inputVec);
+
+    for (size_t i = 0; i < inputVec.size(); i++)
+    {
+        serial.update();
+    }
+
+    EXPECT_EQ(0, serial.device.readAllItemsFromWriteBufferToString().size());
+    Mock::VerifyAndClearExpectations(&interface);
+
+    serial.device.setTryWriteLimit(SIZE_MAX);
+    EXPECT_CALL(interface, terminalSerialCallback)
+        .WillOnce(
+            [](char *, modm::IOStream &outputStream, bool)
+            {
+                outputStream << 'b';
+                return true;
+            });
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        serial.update();
+    }
+
+    std::string output = serial.device.readAllItemsFromWriteBufferToString();
+    EXPECT_EQ(TerminalSerial::OUTPUT_BUFFER_SIZE / 2 + 1, output.size());
+    EXPECT_EQ('b', output.back());
+}
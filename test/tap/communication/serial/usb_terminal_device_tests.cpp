@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/communication/serial/usb_terminal_device.hpp"
+#include "tap/communication/serial/usb_transport.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::communication::serial;
+using namespace testing;
+using namespace tap;
+
+TEST(UsbTerminalDevice, reads_and_writes_terminal_interface)
+{
+    Drivers drivers;
+    UsbTerminalDevice device(&drivers);
+
+    EXPECT_CALL(drivers.usb, read(Usb::Interface::TERMINAL, _, 1))
+        .WillOnce(
+            [](Usb::Interface, uint8_t *data, std::size_t)
+            {
+                *data = 'a';
+                return 1;
+            })
+        .WillOnce(Return(0));
+    EXPECT_CALL(drivers.usb, write(Usb::Interface::TERMINAL, _, 3)).WillOnce(Return(2));
+    EXPECT_CALL(drivers.usb, flush(Usb::Interface::TERMINAL));
+
+    char c;
+    EXPECT_TRUE(device.read(c));
+    EXPECT_EQ('a', c);
+    EXPECT_FALSE(device.read(c));
+
+    const uint8_t data[] = {1, 2, 3};
+    EXPECT_EQ(2u, device.tryWrite(data, sizeof(data)));
+    device.flush();
+}
+
+TEST(UsbTransport, reads_and_writes_its_interface)
+{
+    Drivers drivers;
+    UsbTransport transport(&drivers, Usb::Interface::COPROCESSOR);
+    uint8_t data[4] = {};
+
+    EXPECT_CALL(drivers.usb, read(Usb::Interface::COPROCESSOR, data, 4)).WillOnce(Return(3));
+    EXPECT_CALL(drivers.usb, write(Usb::Interface::COPROCESSOR, data, 4)).WillOnce(Return(4));
+
+    EXPECT_EQ(3u, transport.read(data, 4));
+    EXPECT_EQ(4u, transport.write(data, 4));
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/tcp-server/json_messages.hpp"
+#include "tap/communication/tcp-server/sim_telemetry_frame.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/dji_motor_mock.hpp"
+#include "tap/mock/imu_interface_mock.hpp"
+
+using tap::Drivers;
+using tap::arch::convertFromLittleEndian;
+using tap::mock::DjiMotorMock;
+using namespace tap::can;
+using namespace tap::communication;
+using namespace tap::communication::serial;
+using namespace tap::motor;
+using namespace testing;
+
+class SimTelemetryFrameTest : public Test
+{
+protected:
+    SimTelemetryFrameTest()
+        : motor(&drivers, MotorId::MOTOR3, CanBus::CAN_BUS2, false, "motor")
+    {
+        ON_CALL(motor, getCanBus).WillByDefault(Return(CanBus::CAN_BUS2));
+        ON_CALL(motor, getMotorIdentifier).WillByDefault(Return(MotorId::MOTOR3));
+        ON_CALL(motor, getShaftRPM).WillByDefault(Return(-1'000));
+        ON_CALL(motor, getTorque).WillByDefault(Return(250));
+        ON_CALL(motor, getEncoderUnwrapped).WillByDefault(Return(-100'000));
+        EXPECT_CALL(drivers.canRxHandler, removeReceiveHandler).Times(AnyNumber());
+    }
+
+    template <typename T>
+    T read(const SimTelemetryFrame &frame, std::size_t offset)
+    {
+        T value;
+        convertFromLittleEndian(&value, frame.getData() + offset);
+        return value;
+    }
+
+    Drivers drivers;
+    NiceMock<DjiMotorMock> motor;
+};
+
+TEST_F(SimTelemetryFrameTest, empty_frame_has_header_only)
+{
+    SimTelemetryFrame frame;
+
+    frame.begin(1234);
+
+    ASSERT_EQ(SimTelemetryFrame::HEADER_SIZE, frame.getSize());
+    EXPECT_EQ(SimTelemetryFrame::HEADER_SIZE - 4, read<uint32_t>(frame, 0));
+    EXPECT_EQ(SimTelemetryFrame::SCHEMA_VERSION, read<uint16_t>(frame, 4));
+    EXPECT_EQ(1234u, read<uint32_t>(frame, 6));
+    EXPECT_EQ(0, read<uint16_t>(frame, 10));
+}
+
+TEST_F(SimTelemetryFrameTest, motor_record_encodes_motor_state)
+{
+    SimTelemetryFrame frame;
+    frame.begin(0);
+
+    ASSERT_TRUE(frame.addMotor(motor));
+
+    const std::size_t record = SimTelemetryFrame::HEADER_SIZE;
+    ASSERT_EQ(record + 2 + SimTelemetryFrame::MOTOR_PAYLOAD_SIZE, frame.getSize());
+    EXPECT_EQ(frame.getSize() - 4, read<uint32_t>(frame, 0));
+    EXPECT_EQ(1, read<uint16_t>(frame, 10));
+    EXPECT_EQ(static_cast<uint8_t>(SimTelemetryFrame::RecordType::MOTOR), frame.getData()[record]);
+    EXPECT_EQ(SimTelemetryFrame::MOTOR_PAYLOAD_SIZE, frame.getData()[record + 1]);
+    EXPECT_EQ(2, frame.getData()[record + 2]);
+    EXPECT_EQ(static_cast<uint16_t>(MotorId::MOTOR3), read<uint16_t>(frame, record + 3));
+    EXPECT_EQ(-1'000, read<int16_t>(frame, record + 5));
+    EXPECT_EQ(250, read<int16_t>(frame, record + 7));
+    EXPECT_EQ(-100'000, read<int64_t>(frame, record + 9));
+}
+
+TEST_F(SimTelemetryFrameTest, all_motors_batched_into_one_frame)
+{
+    SimTelemetryFrame frame;
+    frame.begin(0);
+
+    for (int i = 0; i < 16; i++)
+    {
+        ASSERT_TRUE(frame.addMotor(motor));
+    }
+
+    EXPECT_EQ(16, frame.getNumRecords());
+    EXPECT_EQ(16, read<uint16_t>(frame, 10));
+    EXPECT_EQ(
+        SimTelemetryFrame::HEADER_SIZE + 16 * (2 + SimTelemetryFrame::MOTOR_PAYLOAD_SIZE),
+        frame.getSize());
+}
+
+TEST_F(SimTelemetryFrameTest, begin_clears_previous_frame)
+{
+    SimTelemetryFrame frame;
+    frame.begin(0);
+    frame.addMotor(motor);
+
+    frame.begin(1);
+
+    EXPECT_EQ(SimTelemetryFrame::HEADER_SIZE, frame.getSize());
+    EXPECT_EQ(0, frame.getNumRecords());
+}
+
+TEST_F(SimTelemetryFrameTest, imu_record_encodes_readings)
+{
+    NiceMock<tap::mock::ImuInterfaceMock> imu;
+    ON_CALL(imu, getAx).WillByDefault(Return(1.5f));
+    ON_CALL(imu, getYaw).WillByDefault(Return(-90.0f));
+    SimTelemetryFrame frame;
+    frame.begin(0);
+
+    ASSERT_TRUE(frame.addImu(imu));
+
+    const std::size_t payload = SimTelemetryFrame::HEADER_SIZE + 2;
+    EXPECT_EQ(SimTelemetryFrame::IMU_PAYLOAD_SIZE, frame.getData()[payload - 1]);
+    EXPECT_EQ(1.5f, read<float>(frame, payload));
+    EXPECT_EQ(-90.0f, read<float>(frame, payload + 8 * sizeof(float)));
+}
+
+TEST_F(SimTelemetryFrameTest, ref_serial_record_encodes_robot_state)
+{
+    RefSerial::Rx::RobotData robotData{};
+    robotData.robotId = RefSerial::RobotId::BLUE_HERO;
+    robotData.currentHp = 150;
+    robotData.maxHp = 200;
+    RefSerial::Rx::GameData gameData{};
+    gameData.gameStage = RefSerial::Rx::GameStage::IN_GAME;
+    ON_CALL(drivers.refSerial, getRobotData).WillByDefault(ReturnRef(robotData));
+    ON_CALL(drivers.refSerial, getGameData).WillByDefault(ReturnRef(gameData));
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(true));
+    SimTelemetryFrame frame;
+    frame.begin(0);
+
+    ASSERT_TRUE(frame.addRefSerial(drivers.refSerial));
+
+    const std::size_t payload = SimTelemetryFrame::HEADER_SIZE + 2;
+    EXPECT_EQ(
+        static_cast<uint16_t>(RefSerial::RobotId::BLUE_HERO),
+        read<uint16_t>(frame, payload));
+    EXPECT_EQ(150, read<uint16_t>(frame, payload + 2));
+    EXPECT_EQ(200, read<uint16_t>(frame, payload + 4));
+    EXPECT_EQ(
+        static_cast<uint8_t>(RefSerial::Rx::GameStage::IN_GAME),
+        frame.getData()[payload + 6]);
+    EXPECT_EQ(1, frame.getData()[payload + 7]);
+}
+
+TEST_F(SimTelemetryFrameTest, add_returns_false_when_frame_full)
+{
+    SimTelemetryFrame frame;
+    frame.begin(0);
+
+    int added = 0;
+    while (frame.addMotor(motor))
+    {
+        added++;
+    }
+
+    EXPECT_EQ(
+        (SimTelemetryFrame::MAX_FRAME_SIZE - SimTelemetryFrame::HEADER_SIZE) /
+            (2 + SimTelemetryFrame::MOTOR_PAYLOAD_SIZE),
+        static_cast<std::size_t>(added));
+    EXPECT_EQ(added, frame.getNumRecords());
+}
+
+TEST_F(SimTelemetryFrameTest, json_format_writes_one_object_per_line)
+{
+    SimTelemetryFrame frame(SimTelemetryFrame::Format::JSON);
+    frame.begin(0);
+
+    ASSERT_TRUE(frame.addMotor(motor));
+    ASSERT_TRUE(frame.addMotor(motor));
+
+    std::string expected = json::makeMotorMessage(motor) + "\n";
+    EXPECT_EQ(
+        expected + expected,
+        std::string(reinterpret_cast<const char *>(frame.getData()), frame.getSize()));
+}
@@ -60,3 +60,71 @@ TEST(TCPServerTests, SendingCorrectMessages)
     while ((finished_child = wait(&status)) > 0);
     EXPECT_STREQ(response, "Test message 1 2 3");
 }
+
+TEST(TCPServerTests, update_accepts_clients_without_blocking)
+{
+    TCPServer tcpServer(8890);
+
+    tcpServer.update();
+    EXPECT_EQ(0, tcpServer.getNumClients());
+
+    TCPClient client1("localhost", tcpServer.getPortNumber());
+    TCPClient client2("localhost", tcpServer.getPortNumber());
+    for (int i = 0; i < 10 && tcpServer.getNumClients() < 2; i++)
+    {
+        tcpServer.update(100);
+    }
+
+    EXPECT_EQ(2, tcpServer.getNumClients());
+}
+
+TEST(TCPServerTests, writeToClient_sends_message_to_every_client)
+{
+    TCPServer tcpServer(8891);
+    TCPClient client1("localhost", tcpServer.getPortNumber());
+    TCPClient client2("localhost", tcpServer.getPortNumber());
+    while (tcpServer.getNumClients() < 2)
+    {
+        tcpServer.update(1'000);
+    }
+
+    tcpServer.writeToClient("hello", 5);
+
+    char response1[6] = {};
+    char response2[6] = {};
+    client1.Read(response1, 5);
+    client2.Read(response2, 5);
+    EXPECT_STREQ("hello", response1);
+    EXPECT_STREQ("hello", response2);
+}
+
+TEST(TCPServerTests, slow_client_drops_messages_instead_of_blocking)
+{
+    TCPServer tcpServer(8892);
+    TCPClient slowClient("localhost", tcpServer.getPortNumber());
+    tcpServer.getConnection();
+
+    // Far more than the socket buffers and send queue hold, since the client never reads
+    char message[1024] = {};
+    for (int i = 0; i < 32 * 1024; i++)
+    {
+        tcpServer.writeToClient(message, sizeof(message));
+        tcpServer.update();
+    }
+
+    EXPECT_GT(tcpServer.getNumDroppedMessages(), 0u);
+}
+
+TEST(TCPServerTests, disconnected_client_is_closed)
+{
+    TCPServer tcpServer(8893);
+    {
+        TCPClient client("localhost", tcpServer.getPortNumber());
+        tcpServer.getConnection();
+        EXPECT_EQ(1, tcpServer.getNumClients());
+    }
+
+    tcpServer.update(1'000);
+
+    EXPECT_EQ(0, tcpServer.getNumClients());
+}
@@ -69,6 +69,8 @@ TCPClient::TCPClient(const char *hostname, int portno) : portno(portno)
     // file descriptor to read whatever we want.
 }
 
+TCPClient::~TCPClient() { close(sockfd); }
+
 void TCPClient::Read(char *buffer, int length)
 {
     int n = read(sockfd, buffer, length);
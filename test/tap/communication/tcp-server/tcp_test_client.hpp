@@ -47,6 +47,11 @@ class TCPClient
      */
     TCPClient(const char* hostname, int portno);
 
+    /**
+     * Closes the connection.
+     */
+    ~TCPClient();
+
     /**
      * Reads "length" bytes from the socket into the given buffer.
      */
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/control/chassis/chassis_kinematics.hpp"
+
+using namespace tap::algorithms;
+using namespace tap::control::chassis;
+
+static constexpr float WHEEL_RADIUS = 0.076f;
+
+static CMSISMat<3, 1> velocity(float vx, float vy, float wz)
+{
+    return CMSISMat<3, 1>({vx, vy, wz});
+}
+
+template <uint16_t WHEELS>
+static void expectRoundTrip(
+    const LinearChassisKinematics<WHEELS> &kinematics,
+    const CMSISMat<3, 1> &chassisVelocity)
+{
+    CMSISMat<WHEELS, 1> wheelSpeeds;
+    CMSISMat<3, 1> result;
+    kinematics.toWheelSpeeds(chassisVelocity, wheelSpeeds);
+    kinematics.toChassisVelocity(wheelSpeeds, result);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_NEAR(chassisVelocity.data[i], result.data[i], 1E-4f);
+    }
+}
+
+TEST(ChassisKinematics, mecanum_wheel_speeds)
+{
+    const LinearChassisKinematics<4> kinematics = mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f);
+    CMSISMat<4, 1> wheelSpeeds;
+
+    // Forward, all wheels forward
+    kinematics.toWheelSpeeds(velocity(1, 0, 0), wheelSpeeds);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(1 / WHEEL_RADIUS, wheelSpeeds.data[i], 1E-4f);
+    }
+
+    // Left, front left and back right backwards
+    kinematics.toWheelSpeeds(velocity(0, 1, 0), wheelSpeeds);
+    EXPECT_NEAR(-1 / WHEEL_RADIUS, wheelSpeeds.data[0], 1E-4f);
+    EXPECT_NEAR(1 / WHEEL_RADIUS, wheelSpeeds.data[1], 1E-4f);
+    EXPECT_NEAR(1 / WHEEL_RADIUS, wheelSpeeds.data[2], 1E-4f);
+    EXPECT_NEAR(-1 / WHEEL_RADIUS, wheelSpeeds.data[3], 1E-4f);
+
+    // Counterclockwise, left side backwards
+    kinematics.toWheelSpeeds(velocity(0, 0, 1), wheelSpeeds);
+    EXPECT_NEAR(-0.45f / WHEEL_RADIUS, wheelSpeeds.data[0], 1E-4f);
+    EXPECT_NEAR(0.45f / WHEEL_RADIUS, wheelSpeeds.data[1], 1E-4f);
+    EXPECT_NEAR(-0.45f / WHEEL_RADIUS, wheelSpeeds.data[2], 1E-4f);
+    EXPECT_NEAR(0.45f / WHEEL_RADIUS, wheelSpeeds.data[3], 1E-4f);
+}
+
+TEST(ChassisKinematics, forward_kinematics_invert_inverse_kinematics)
+{
+    const float angles[4] = {M_PI / 4, 3 * M_PI / 4, -3 * M_PI / 4, -M_PI / 4};
+    const float threeWheelAngles[3] = {0, 2 * M_PI / 3, -2 * M_PI / 3};
+
+    expectRoundTrip(mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f), velocity(1.5f, -0.5f, 2));
+    expectRoundTrip(omniKinematics(WHEEL_RADIUS, 0.3f, angles), velocity(1.5f, -0.5f, 2));
+    expectRoundTrip(omniKinematics(WHEEL_RADIUS, 0.3f, threeWheelAngles), velocity(-1, 0.5f, 3));
+    expectRoundTrip(differentialKinematics(WHEEL_RADIUS, 0.25f), velocity(1.5f, 0, 2));
+}
+
+TEST(ChassisKinematics, pseudo_inverse_matches_mecanum_forward_matrix)
+{
+    // A mecanum chassis given only its inverse kinematics gets the same forward kinematics
+    const LinearChassisKinematics<4> mecanum = mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f);
+    float inverse[4 * 3];
+    for (int i = 0; i < 4 * 3; i++)
+    {
+        inverse[i] = mecanum.getInverseMatrix().data[i];
+    }
+    const LinearChassisKinematics<4> computed(inverse);
+
+    for (int i = 0; i < 3 * 4; i++)
+    {
+        EXPECT_NEAR(mecanum.getForwardMatrix().data[i], computed.getForwardMatrix().data[i], 1E-3f);
+    }
+}
+
+TEST(ChassisKinematics, desaturate_scales_all_wheels_equally)
+{
+    CMSISMat<4, 1> wheelSpeeds({10, -20, 5, 40});
+
+    EXPECT_FLOAT_EQ(0.5f, desaturate(wheelSpeeds, 20));
+
+    EXPECT_FLOAT_EQ(5, wheelSpeeds.data[0]);
+    EXPECT_FLOAT_EQ(-10, wheelSpeeds.data[1]);
+    EXPECT_FLOAT_EQ(2.5f, wheelSpeeds.data[2]);
+    EXPECT_FLOAT_EQ(20, wheelSpeeds.data[3]);
+    EXPECT_FLOAT_EQ(1, desaturate(wheelSpeeds, 20));
+}
+
+TEST(ChassisKinematics, desaturated_keeps_rotation_over_translation)
+{
+    const LinearChassisKinematics<4> kinematics = mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f);
+    const float maxWheelSpeed = 30;
+    CMSISMat<4, 1> wheelSpeeds;
+
+    const float scale =
+        kinematics.toWheelSpeedsDesaturated(velocity(3, 0, 3), maxWheelSpeed, wheelSpeeds);
+
+    CMSISMat<3, 1> result;
+    kinematics.toChassisVelocity(wheelSpeeds, result);
+    EXPECT_NEAR(3, result.data[2], 1E-4f);
+    EXPECT_NEAR(3 * scale, result.data[0], 1E-4f);
+    float maxSpeed = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        maxSpeed = fmaxf(maxSpeed, fabsf(wheelSpeeds.data[i]));
+    }
+    EXPECT_NEAR(maxWheelSpeed, maxSpeed, 1E-3f);
+}
+
+TEST(ChassisKinematics, desaturated_scales_rotation_if_rotation_alone_saturates)
+{
+    const LinearChassisKinematics<4> kinematics = mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f);
+    CMSISMat<4, 1> wheelSpeeds;
+
+    // 20 rad/s of rotation needs 118 rad/s of wheel speed
+    EXPECT_EQ(0, kinematics.toWheelSpeedsDesaturated(velocity(1, 0, 20), 50, wheelSpeeds));
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(50, fabsf(wheelSpeeds.data[i]), 1E-3f);
+    }
+}
+
+TEST(ChassisKinematics, desaturated_below_limit_is_unchanged)
+{
+    const LinearChassisKinematics<4> kinematics = mecanumKinematics(WHEEL_RADIUS, 0.2f, 0.25f);
+    CMSISMat<4, 1> expected, wheelSpeeds;
+    kinematics.toWheelSpeeds(velocity(0.5f, 0.5f, 1), expected);
+
+    EXPECT_EQ(1, kinematics.toWheelSpeedsDesaturated(velocity(0.5f, 0.5f, 1), 100, wheelSpeeds));
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_FLOAT_EQ(expected.data[i], wheelSpeeds.data[i]);
+    }
+}
+
+TEST(ChassisKinematics, swerve_module_states)
+{
+    const float positions[4][2] = {{0.2f, 0.2f}, {0.2f, -0.2f}, {-0.2f, 0.2f}, {-0.2f, -0.2f}};
+    const SwerveKinematics<4> swerve(WHEEL_RADIUS, positions);
+    SwerveKinematics<4>::ModuleState states[4];
+
+    swerve.toModuleStates(velocity(0, 1, 0), states);
+    for (const auto &state : states)
+    {
+        EXPECT_NEAR(M_PI / 2, state.angle, 1E-5f);
+        EXPECT_NEAR(1 / WHEEL_RADIUS, state.speed, 1E-4f);
+    }
+
+    // Rotating in place, each module is perpendicular to the line to the center
+    swerve.toModuleStates(velocity(0, 0, 1), states);
+    EXPECT_NEAR(3 * M_PI / 4, states[0].angle, 1E-5f);
+    EXPECT_NEAR(M_PI / 4, states[1].angle, 1E-5f);
+    EXPECT_NEAR(-3 * M_PI / 4, states[2].angle, 1E-5f);
+    EXPECT_NEAR(-M_PI / 4, states[3].angle, 1E-5f);
+
+    // Stopping keeps the module angles
+    swerve.toModuleStates(velocity(0, 0, 0), states);
+    EXPECT_NEAR(3 * M_PI / 4, states[0].angle, 1E-5f);
+    EXPECT_EQ(0, states[0].speed);
+
+    CMSISMat<3, 1> result;
+    swerve.toModuleStates(velocity(1.5f, -0.5f, 2), states);
+    swerve.toChassisVelocity(states, result);
+    EXPECT_NEAR(1.5f, result.data[0], 1E-4f);
+    EXPECT_NEAR(-0.5f, result.data[1], 1E-4f);
+    EXPECT_NEAR(2, result.data[2], 1E-4f);
+}
+
+TEST(ChassisKinematics, swerve_optimize_flips_module_instead_of_turning_around)
+{
+    using ModuleState = SwerveKinematics<4>::ModuleState;
+
+    ModuleState optimized = SwerveKinematics<4>::optimize({M_PI, 10}, 0.1f);
+    EXPECT_NEAR(0, optimized.angle, 1E-5f);
+    EXPECT_FLOAT_EQ(-10, optimized.speed);
+
+    // Within a quarter turn, taking the short way across +-pi
+    optimized = SwerveKinematics<4>::optimize({-3, 10}, 3);
+    EXPECT_NEAR(2 * M_PI - 3, optimized.angle, 1E-5f);
+    EXPECT_FLOAT_EQ(10, optimized.speed);
+}
+
+TEST(ChassisKinematics, displacement_observer_integrates_chassis_velocity)
+{
+    const LinearChassisKinematics<2> kinematics = differentialKinematics(WHEEL_RADIUS, 0.25f);
+    KinematicDisplacementObserver<2> observer(kinematics);
+    modm::Vector3f velocity, displacement;
+
+    EXPECT_FALSE(observer.getVelocityChassisDisplacement(&velocity, &displacement));
+
+    CMSISMat<2, 1> wheelSpeeds({2 / WHEEL_RADIUS, 2 / WHEEL_RADIUS});
+    for (int i = 0; i < 100; i++)
+    {
+        observer.update(wheelSpeeds, 0.01f);
+    }
+
+    ASSERT_TRUE(observer.getVelocityChassisDisplacement(&velocity, &displacement));
+    EXPECT_NEAR(2, velocity.x, 1E-4f);
+    EXPECT_NEAR(2, displacement.x, 1E-3f);
+    EXPECT_NEAR(0, displacement.y, 1E-6f);
+}
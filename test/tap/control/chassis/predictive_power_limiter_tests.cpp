@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/chassis/predictive_power_limiter.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/dji_motor_mock.hpp"
+
+using namespace tap::control::chassis;
+using namespace tap::communication::serial;
+using namespace tap::mock;
+using namespace tap::motor;
+using namespace testing;
+
+static constexpr auto CONFIG = PredictivePowerLimiter::M3508_CONFIG;
+
+class PredictivePowerLimiterTest : public Test
+{
+protected:
+    PredictivePowerLimiterTest()
+        : wheel(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "wheel"),
+          turret(&drivers, MOTOR2, tap::can::CanBus::CAN_BUS1, false, "turret"),
+          limiter(&drivers, CONFIG)
+    {
+    }
+
+    void SetUp() override
+    {
+        clock.time = 1;
+        ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(true));
+        ON_CALL(drivers.refSerial, getRobotDataGeneration)
+            .WillByDefault(ReturnPointee(&generation));
+        ON_CALL(drivers.refSerial, getRobotDataSnapshot)
+            .WillByDefault(
+                [&](RefSerialData::Rx::RobotData *snapshot)
+                {
+                    *snapshot = robotData;
+                    return generation;
+                });
+
+        setMotor(wheel, 0, 0, 0);
+        setMotor(turret, 0, 0, 0);
+    }
+
+    /// Reports a new referee power buffer and limit.
+    void refereeReport(uint16_t powerBuffer, uint16_t powerLimit)
+    {
+        robotData.chassis.powerBuffer = powerBuffer;
+        robotData.chassis.powerConsumptionLimit = powerLimit;
+        robotData.robotDataReceivedTimestamp = clock.time;
+        generation++;
+    }
+
+    /// Sets a motor's desired output and feedback, the output the limiter sets being stored.
+    void setMotor(DjiMotorMock &motor, int16_t output, int16_t torque, int16_t rpm)
+    {
+        desiredOutput[&motor] = output;
+        ON_CALL(motor, getOutputDesired).WillByDefault(ReturnPointee(&desiredOutput[&motor]));
+        ON_CALL(motor, getTorque).WillByDefault(Return(torque));
+        ON_CALL(motor, getShaftRPM).WillByDefault(Return(rpm));
+        ON_CALL(motor, setDesiredOutput)
+            .WillByDefault([this, &motor](int32_t limited) { desiredOutput[&motor] = limited; });
+    }
+
+    float predictedPower(DjiMotorMock &motor)
+    {
+        return limiter.predictMotorPower(
+            desiredOutput[&motor] * CONFIG.currentPerUnit,
+            motor.getShaftRPM());
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    NiceMock<DjiMotorMock> wheel;
+    NiceMock<DjiMotorMock> turret;
+    PredictivePowerLimiter limiter;
+    RefSerialData::Rx::RobotData robotData{};
+    uint32_t generation = 0;
+    std::map<DjiMotorMock *, int16_t> desiredOutput;
+};
+
+TEST_F(PredictivePowerLimiterTest, predictMotorPower_matches_dc_motor_model)
+{
+    EXPECT_FLOAT_EQ(10 * 10 * CONFIG.resistance, limiter.predictMotorPower(10, 0));
+    EXPECT_FLOAT_EQ(
+        10 * 10 * CONFIG.resistance + CONFIG.backEmfConstant * 100 * 10,
+        limiter.predictMotorPower(10, 3000 / M_PI));
+    EXPECT_LT(limiter.predictMotorPower(-2, 6000), 0);
+}
+
+TEST_F(PredictivePowerLimiterTest, outputs_not_limited_without_referee)
+{
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(false));
+    limiter.addMotor(&wheel);
+    setMotor(wheel, 16'000, 16'000, 8'000);
+
+    EXPECT_CALL(wheel, setDesiredOutput).Times(0);
+    limiter.limitMotorOutputs();
+
+    EXPECT_EQ(1, limiter.getOutputRatio(0));
+}
+
+TEST_F(PredictivePowerLimiterTest, outputs_within_budget_not_limited)
+{
+    limiter.addMotor(&wheel);
+    refereeReport(60, 80);
+    setMotor(wheel, 3'000, 3'000, 2'000);
+
+    EXPECT_CALL(wheel, setDesiredOutput).Times(0);
+    limiter.limitMotorOutputs();
+
+    EXPECT_FLOAT_EQ(
+        80 + (60 - CONFIG.energyBufferReserve) / CONFIG.bufferSpendTime,
+        limiter.getPowerBudget());
+}
+
+TEST_F(PredictivePowerLimiterTest, outputs_over_budget_scaled_to_budget)
+{
+    limiter.addMotor(&wheel);
+    limiter.addMotor(&turret);
+    refereeReport(CONFIG.energyBufferReserve, 40);
+    setMotor(wheel, 12'000, 12'000, 6'000);
+    setMotor(turret, 12'000, 12'000, 6'000);
+
+    limiter.limitMotorOutputs();
+
+    EXPECT_FLOAT_EQ(40, limiter.getPowerBudget());
+    EXPECT_LT(limiter.getOutputRatio(0), 1);
+    EXPECT_FLOAT_EQ(limiter.getOutputRatio(0), limiter.getOutputRatio(1));
+    EXPECT_NEAR(40 - CONFIG.staticPower, predictedPower(wheel) + predictedPower(turret), 0.5f);
+}
+
+TEST_F(PredictivePowerLimiterTest, lower_priority_motors_limited_first)
+{
+    limiter.addMotor(&wheel, 1);
+    limiter.addMotor(&turret, 0);
+    refereeReport(CONFIG.energyBufferReserve, 40);
+    setMotor(wheel, 3'000, 3'000, 3'000);
+    setMotor(turret, 12'000, 12'000, 6'000);
+
+    EXPECT_CALL(wheel, setDesiredOutput).Times(0);
+    limiter.limitMotorOutputs();
+
+    EXPECT_EQ(1, limiter.getOutputRatio(0));
+    EXPECT_LT(limiter.getOutputRatio(1), 1);
+    EXPECT_NEAR(40 - CONFIG.staticPower, predictedPower(wheel) + predictedPower(turret), 0.5f);
+}
+
+TEST_F(PredictivePowerLimiterTest, higher_priority_limited_once_lower_priority_at_zero)
+{
+    limiter.addMotor(&wheel, 1);
+    limiter.addMotor(&turret, 0);
+    refereeReport(0, 40);
+    setMotor(wheel, 16'000, 16'000, 8'000);
+    setMotor(turret, 8'000, 8'000, 6'000);
+
+    limiter.limitMotorOutputs();
+
+    EXPECT_EQ(0, limiter.getOutputRatio(1));
+    EXPECT_EQ(0, desiredOutput[&turret]);
+    EXPECT_GT(limiter.getOutputRatio(0), 0);
+    EXPECT_LT(limiter.getOutputRatio(0), 1);
+}
+
+TEST_F(PredictivePowerLimiterTest, energy_buffer_integrated_between_referee_reports)
+{
+    limiter.addMotor(&wheel);
+    refereeReport(60, 40);
+    // Draws about 150 W
+    setMotor(wheel, 8'000, 8'000, 8'000);
+    const float power = CONFIG.staticPower +
+                        limiter.predictMotorPower(8'000 * CONFIG.currentPerUnit, 8'000);
+
+    limiter.limitMotorOutputs();
+    EXPECT_FLOAT_EQ(60, limiter.getEnergyBuffer());
+    EXPECT_FLOAT_EQ(power, limiter.getMeasuredPower());
+
+    for (int i = 0; i < 100; i++)
+    {
+        clock.time += 1;
+        limiter.limitMotorOutputs();
+    }
+    EXPECT_NEAR(60 - (power - 40) * 0.1f, limiter.getEnergyBuffer(), 0.01f);
+
+    refereeReport(50, 40);
+    limiter.limitMotorOutputs();
+    EXPECT_FLOAT_EQ(50, limiter.getEnergyBuffer());
+}
+
+TEST_F(PredictivePowerLimiterTest, auxiliary_source_added_to_budget_and_not_integrated)
+{
+    limiter.addMotor(&wheel);
+    refereeReport(60, 40);
+    setMotor(wheel, 8'000, 8'000, 8'000);
+    limiter.setAuxiliarySource(100, 50);
+
+    limiter.limitMotorOutputs();
+    EXPECT_FLOAT_EQ(
+        40 + (60 - CONFIG.energyBufferReserve) / CONFIG.bufferSpendTime + 100,
+        limiter.getPowerBudget());
+
+    for (int i = 0; i < 100; i++)
+    {
+        clock.time += 1;
+        limiter.limitMotorOutputs();
+    }
+    EXPECT_NEAR(
+        60 - (limiter.getMeasuredPower() - 50 - 40) * 0.1f,
+        limiter.getEnergyBuffer(),
+        0.01f);
+}
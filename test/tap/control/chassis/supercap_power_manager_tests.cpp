@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/chassis/supercap_power_manager.hpp"
+#include "tap/drivers.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::control::chassis;
+using namespace tap::communication::serial;
+using namespace testing;
+
+static constexpr SupercapPowerManager::Config CONFIG = {
+    .canBus = tap::can::CanBus::CAN_BUS1,
+    .rxId = 0x211,
+    .txId = 0x210,
+    .capacitance = 5.0f,
+    .minVoltage = 10.0f,
+    .maxVoltage = 24.0f,
+    .maxChargePower = 60.0f,
+    .maxDischargePower = 250.0f,
+    .dischargeTime = 2.0f,
+    .chargeMargin = 5.0f,
+};
+
+class SupercapPowerManagerTest : public Test
+{
+protected:
+    SupercapPowerManagerTest() : supercap(&drivers, CONFIG) {}
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(true));
+        ON_CALL(drivers.refSerial, getRobotDataGeneration).WillByDefault(Return(1));
+        ON_CALL(drivers.refSerial, getRobotDataSnapshot)
+            .WillByDefault(
+                [](RefSerialData::Rx::RobotData *snapshot)
+                {
+                    snapshot->chassis.powerConsumptionLimit = 80;
+                    return 1;
+                });
+    }
+
+    void receiveStatus(float voltage, float current)
+    {
+        modm::can::Message message(CONFIG.rxId, 8);
+        const uint16_t millivolts = voltage * 1000;
+        const int16_t milliamps = current * 1000;
+        message.data[0] = millivolts >> 8;
+        message.data[1] = millivolts & 0xFF;
+        message.data[2] = static_cast<uint16_t>(milliamps) >> 8;
+        message.data[3] = milliamps & 0xFF;
+        supercap.processMessage(message);
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    SupercapPowerManager supercap;
+};
+
+TEST_F(SupercapPowerManagerTest, processMessage_decodes_voltage_and_current)
+{
+    EXPECT_FALSE(supercap.isOnline());
+
+    receiveStatus(20, -3.5f);
+
+    EXPECT_TRUE(supercap.isOnline());
+    EXPECT_FLOAT_EQ(20, supercap.getCapacitorVoltage());
+    EXPECT_FLOAT_EQ(-3.5f, supercap.getCapacitorCurrent());
+    EXPECT_FLOAT_EQ(70, supercap.getCapacitorPower());
+
+    clock.time += SupercapPowerManager::DISCONNECT_TIME;
+    EXPECT_FALSE(supercap.isOnline());
+    EXPECT_EQ(0, supercap.getCapacitorPower());
+}
+
+TEST_F(SupercapPowerManagerTest, stored_energy_counted_above_min_voltage)
+{
+    receiveStatus(20, 0);
+    EXPECT_FLOAT_EQ(0.5f * 5 * (20 * 20 - 10 * 10), supercap.getStoredEnergy());
+    EXPECT_FLOAT_EQ((20.0f * 20 - 10 * 10) / (24 * 24 - 10 * 10), supercap.getStateOfCharge());
+
+    receiveStatus(8, 0);
+    EXPECT_EQ(0, supercap.getStoredEnergy());
+    EXPECT_EQ(0, supercap.getStateOfCharge());
+}
+
+TEST_F(SupercapPowerManagerTest, burst_power_only_while_enabled_and_limited)
+{
+    receiveStatus(24, 0);
+    supercap.update(0);
+    EXPECT_EQ(0, supercap.getBurstPower());
+
+    supercap.setBurstEnabled(true);
+    supercap.update(0);
+    EXPECT_FLOAT_EQ(CONFIG.maxDischargePower, supercap.getBurstPower());
+
+    // 250 J left, spent over no less than 2 s
+    receiveStatus(sqrtf(10 * 10 + 2 * 250 / 5.0f), 0);
+    supercap.update(0);
+    EXPECT_NEAR(125, supercap.getBurstPower(), 0.1f);
+}
+
+TEST_F(SupercapPowerManagerTest, charges_with_power_chassis_leaves_unused)
+{
+    receiveStatus(20, 0);
+
+    supercap.update(30);
+    EXPECT_FLOAT_EQ(80 - CONFIG.chargeMargin - 30, supercap.getChargePower());
+
+    supercap.update(0);
+    EXPECT_FLOAT_EQ(CONFIG.maxChargePower, supercap.getChargePower());
+
+    supercap.update(100);
+    EXPECT_EQ(0, supercap.getChargePower());
+}
+
+TEST_F(SupercapPowerManagerTest, power_drawn_from_capacitor_not_counted_against_meter)
+{
+    // Chassis draws 120 W, 70 W of it from the capacitor
+    receiveStatus(20, -3.5f);
+    supercap.update(120);
+    EXPECT_FLOAT_EQ(80 - CONFIG.chargeMargin - 50, supercap.getChargePower());
+}
+
+TEST_F(SupercapPowerManagerTest, no_charge_when_full_offline_or_without_referee)
+{
+    receiveStatus(24, 0);
+    supercap.update(0);
+    EXPECT_EQ(0, supercap.getChargePower());
+
+    receiveStatus(20, 0);
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(false));
+    supercap.setBurstEnabled(true);
+    supercap.update(0);
+    EXPECT_EQ(0, supercap.getChargePower());
+    EXPECT_EQ(0, supercap.getBurstPower());
+
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(true));
+    clock.time += SupercapPowerManager::DISCONNECT_TIME;
+    supercap.update(0);
+    EXPECT_EQ(0, supercap.getChargePower());
+    EXPECT_EQ(0, supercap.getBurstPower());
+}
+
+TEST_F(SupercapPowerManagerTest, charge_power_sent_every_send_period)
+{
+    receiveStatus(20, 0);
+
+    modm::can::Message sent;
+    EXPECT_CALL(drivers.can, sendMessage(CONFIG.canBus, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SaveArg<1>(&sent), Return(true)));
+
+    for (uint32_t i = 0; i < 2 * SupercapPowerManager::SEND_PERIOD; i++)
+    {
+        clock.time++;
+        supercap.update(35);
+    }
+
+    EXPECT_EQ(CONFIG.txId, sent.getIdentifier());
+    EXPECT_EQ(2, sent.getLength());
+    EXPECT_EQ(4'000, sent.data[0] << 8 | sent.data[1]);
+}
@@ -17,6 +17,8 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include <gtest/gtest.h>
 
 #include "tap/control/command_mapper.hpp"
@@ -229,3 +231,105 @@ TEST(CommandMapperFormatGenerator, generateMappings_various_switch_mappings_with
     EXPECT_EQ(1, mappings.size());
     EXPECT_EQ("[left switch: mid]:\t[test command]", mappings[0]);
 }
+
+TEST(CommandMapperFormatGenerator, formatMapping_writes_same_text_as_generateMappings)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    CommandMapper cm(&drivers);
+    CommandMapperFormatGenerator formatGenerator(cm);
+    HoldCommandMapping hcm(
+        &drivers,
+        {&tc},
+        RemoteMapState({Remote::Key::A}, {Remote::Key::SHIFT}));
+    cm.addMap(&hcm);
+    char buffer[64];
+
+    std::size_t length = formatGenerator.formatMapping(0, buffer, sizeof(buffer));
+
+    EXPECT_STREQ("[keys: {A}, neg keys: {SHIFT}]:\t[test command]", buffer);
+    EXPECT_EQ(strlen(buffer), length);
+}
+
+TEST(CommandMapperFormatGenerator, formatMapping_small_buffer_truncated_and_terminated)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    CommandMapper cm(&drivers);
+    CommandMapperFormatGenerator formatGenerator(cm);
+    HoldCommandMapping hcm(
+        &drivers,
+        {&tc},
+        RemoteMapState(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN));
+    cm.addMap(&hcm);
+    char buffer[8];
+
+    std::size_t length = formatGenerator.formatMapping(0, buffer, sizeof(buffer));
+
+    EXPECT_STREQ("[left s", buffer);
+    EXPECT_EQ(strlen("[left switch: down]:\t[test command]"), length);
+}
+
+TEST(CommandMapperFormatGenerator, formatMapping_index_out_of_range_writes_empty_string)
+{
+    Drivers drivers;
+    CommandMapper cm(&drivers);
+    CommandMapperFormatGenerator formatGenerator(cm);
+    char buffer[8] = "garbage";
+
+    EXPECT_EQ(0u, formatGenerator.formatMapping(0, buffer, sizeof(buffer)));
+    EXPECT_STREQ("", buffer);
+}
+
+TEST(CommandMapperFormatGenerator, encodeMapping_encodes_remote_state_and_command_ids)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc1(&ts);
+    TestCommand tc2(&ts);
+    CommandMapper cm(&drivers);
+    CommandMapperFormatGenerator formatGenerator(cm);
+    HoldCommandMapping hcm(
+        &drivers,
+        {&tc1, &tc2},
+        RemoteMapState(
+            Remote::SwitchState::DOWN,
+            Remote::SwitchState::UP,
+            {Remote::Key::CTRL},
+            {},
+            true,
+            false));
+    cm.addMap(&hcm);
+    uint8_t buffer[32];
+
+    std::size_t length = formatGenerator.encodeMapping(0, buffer, sizeof(buffer));
+
+    ASSERT_EQ(CommandMapperFormatGenerator::DESCRIPTOR_HEADER_LENGTH + 4, length);
+    EXPECT_EQ(1 << static_cast<int>(Remote::Key::CTRL), buffer[0] | (buffer[1] << 8));
+    EXPECT_EQ(0, buffer[2] | (buffer[3] << 8));
+    EXPECT_EQ(0b01, buffer[4]);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::SwitchState::DOWN), buffer[5]);
+    EXPECT_EQ(static_cast<uint8_t>(Remote::SwitchState::UP), buffer[6]);
+    EXPECT_EQ(2, buffer[7]);
+    EXPECT_EQ(tc1.getGlobalIdentifier(), buffer[8] | (buffer[9] << 8));
+    EXPECT_EQ(tc2.getGlobalIdentifier(), buffer[10] | (buffer[11] << 8));
+}
+
+TEST(CommandMapperFormatGenerator, encodeMapping_buffer_too_small_writes_nothing)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    CommandMapper cm(&drivers);
+    CommandMapperFormatGenerator formatGenerator(cm);
+    HoldCommandMapping hcm(
+        &drivers,
+        {&tc},
+        RemoteMapState(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN));
+    cm.addMap(&hcm);
+    uint8_t buffer[CommandMapperFormatGenerator::DESCRIPTOR_HEADER_LENGTH + 1];
+
+    EXPECT_EQ(0u, formatGenerator.encodeMapping(0, buffer, sizeof(buffer)));
+}
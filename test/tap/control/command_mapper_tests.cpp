@@ -17,8 +17,12 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <memory>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/control/command_mapper.hpp"
 #include "tap/control/hold_command_mapping.hpp"
 #include "tap/control/hold_repeat_command_mapping.hpp"
@@ -34,6 +38,36 @@ using namespace tap::control;
 using tap::Drivers;
 using namespace tap::communication::serial;
 
+/**
+ * Records the order it's executed in, and optionally claims to react only to input changes so
+ * the CommandMapper may skip it.
+ */
+class RecordingCommandMapping : public CommandMapping
+{
+public:
+    RecordingCommandMapping(
+        Drivers *drivers,
+        const RemoteMapState &rms,
+        bool onlyInputChanges,
+        std::vector<int> *executions,
+        int id)
+        : CommandMapping(drivers, {}, rms),
+          onlyInputChanges(onlyInputChanges),
+          executions(executions),
+          id(id)
+    {
+    }
+
+    void executeCommandMapping(const RemoteMapState &) override { executions->push_back(id); }
+
+    bool reactsOnlyToInputChanges() const override { return onlyInputChanges; }
+
+private:
+    bool onlyInputChanges;
+    std::vector<int> *executions;
+    int id;
+};
+
 TEST(CommandMapper, getSize_returns_number_of_valid_maps_added)
 {
     Drivers drivers;
@@ -183,3 +217,182 @@ TEST(CommandMapper, addPressMapping_successfully_adds_mapping_normal_case)
     EXPECT_NE(nullptr, pressMappingPtr);
     EXPECT_EQ(mappingForCompare, *pressMappingPtr);
 }
+
+TEST(CommandMapper, handleKeyStateChange_executes_only_mappings_whose_inputs_changed)
+{
+    Drivers drivers;
+    CommandMapper cm(&drivers);
+    std::vector<int> executions;
+    RecordingCommandMapping keyW(&drivers, RemoteMapState({Remote::Key::W}), true, &executions, 0);
+    RecordingCommandMapping leftSwitch(
+        &drivers,
+        RemoteMapState(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::UP),
+        true,
+        &executions,
+        1);
+    RecordingCommandMapping rightMouse(
+        &drivers,
+        RemoteMapState(RemoteMapState::MouseButton::RIGHT),
+        true,
+        &executions,
+        2);
+    RecordingCommandMapping negKeyA(
+        &drivers,
+        RemoteMapState({Remote::Key::Q}, {Remote::Key::A}),
+        true,
+        &executions,
+        3);
+    cm.addMap(&keyW);
+    cm.addMap(&leftSwitch);
+    cm.addMap(&rightMouse);
+    cm.addMap(&negKeyA);
+
+    // Newly added mappings are all executed once
+    cm.handleKeyStateChange(0, Remote::SwitchState::MID, Remote::SwitchState::MID, false, false);
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), executions);
+
+    executions.clear();
+    cm.handleKeyStateChange(0, Remote::SwitchState::MID, Remote::SwitchState::MID, false, false);
+    EXPECT_TRUE(executions.empty());
+
+    // Neither the right switch nor the left mouse button are read by any mapping
+    cm.handleKeyStateChange(0, Remote::SwitchState::MID, Remote::SwitchState::UP, true, false);
+    EXPECT_TRUE(executions.empty());
+
+    cm.handleKeyStateChange(1, Remote::SwitchState::MID, Remote::SwitchState::UP, true, false);
+    EXPECT_EQ(std::vector<int>({0}), executions);
+
+    executions.clear();
+    cm.handleKeyStateChange(1, Remote::SwitchState::DOWN, Remote::SwitchState::UP, true, true);
+    EXPECT_EQ(std::vector<int>({1, 2}), executions);
+
+    executions.clear();
+    cm.handleKeyStateChange(
+        1 << static_cast<int>(Remote::Key::A),
+        Remote::SwitchState::DOWN,
+        Remote::SwitchState::UP,
+        true,
+        true);
+    EXPECT_EQ(std::vector<int>({0, 3}), executions);
+}
+
+TEST(CommandMapper, handleKeyStateChange_always_executes_mappings_not_only_reacting_to_inputs)
+{
+    Drivers drivers;
+    CommandMapper cm(&drivers);
+    std::vector<int> executions;
+    RecordingCommandMapping inputOnly(
+        &drivers,
+        RemoteMapState({Remote::Key::W}),
+        true,
+        &executions,
+        0);
+    RecordingCommandMapping always(
+        &drivers,
+        RemoteMapState({Remote::Key::S}),
+        false,
+        &executions,
+        1);
+    cm.addMap(&inputOnly);
+    cm.addMap(&always);
+
+    for (int i = 0; i < 3; i++)
+    {
+        cm.handleKeyStateChange(
+            0,
+            Remote::SwitchState::MID,
+            Remote::SwitchState::MID,
+            false,
+            false);
+    }
+
+    EXPECT_EQ(std::vector<int>({0, 1, 1, 1}), executions);
+}
+
+TEST(CommandMapper, update_updates_only_mappings_updated_each_tick)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    CommandMapper cm(&drivers);
+    TestSubsystem ts(&drivers);
+    TestCommand timed(&ts);
+    TestCommand untimed(&ts);
+    RemoteMapState ms({Remote::Key::W});
+    HoldRepeatCommandMapping timedMapping(&drivers, {&timed}, ms, false, -1, 10);
+    HoldRepeatCommandMapping untimedMapping(&drivers, {&untimed}, ms, false);
+    cm.addMap(&timedMapping);
+    cm.addMap(&untimedMapping);
+
+    ON_CALL(drivers.commandScheduler, isCommandScheduled).WillByDefault(testing::Return(false));
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&timed)).Times(2);
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&untimed)).Times(1);
+
+    cm.handleKeyStateChange(
+        1 << static_cast<int>(Remote::Key::W),
+        Remote::SwitchState::MID,
+        Remote::SwitchState::MID,
+        false,
+        false);
+    clock.time = 10;
+    cm.update();
+}
+
+TEST(CommandMapper, handleKeyStateChange_executes_many_mappings_in_order_added)
+{
+    Drivers drivers;
+    CommandMapper cm(&drivers);
+    std::vector<int> executions;
+    std::vector<std::unique_ptr<RecordingCommandMapping>> mappings;
+    for (int i = 0; i < 70; i++)
+    {
+        // Spread over more than two bitmap words, alternating between two keys
+        mappings.emplace_back(new RecordingCommandMapping(
+            &drivers,
+            RemoteMapState({i % 2 == 0 ? Remote::Key::W : Remote::Key::E}),
+            true,
+            &executions,
+            i));
+        cm.addMap(mappings.back().get());
+    }
+    cm.handleKeyStateChange(0, Remote::SwitchState::MID, Remote::SwitchState::MID, false, false);
+    executions.clear();
+
+    cm.handleKeyStateChange(
+        1 << static_cast<int>(Remote::Key::E),
+        Remote::SwitchState::MID,
+        Remote::SwitchState::MID,
+        false,
+        false);
+
+    std::vector<int> expected;
+    for (int i = 1; i < 70; i += 2)
+    {
+        expected.push_back(i);
+    }
+    EXPECT_EQ(expected, executions);
+}
+
+TEST(CommandMapper, handleKeyStateChange_hold_mapping_added_and_removed_once)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    CommandMapper cm(&drivers);
+    HoldCommandMapping hold(&drivers, {&tc}, RemoteMapState({Remote::Key::W}));
+    cm.addMap(&hold);
+
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(1);
+    EXPECT_CALL(drivers.commandScheduler, removeCommand(&tc, false)).Times(1);
+
+    const uint16_t w = 1 << static_cast<int>(Remote::Key::W);
+    const uint16_t frames[] = {0, w, w, w | 2, w, 0, 0};
+    for (uint16_t keys : frames)
+    {
+        cm.handleKeyStateChange(
+            keys,
+            Remote::SwitchState::MID,
+            Remote::SwitchState::MID,
+            false,
+            false);
+    }
+}
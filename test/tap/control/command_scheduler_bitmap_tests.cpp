@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/control/command_scheduler_bitmap.hpp"
+
+using namespace tap::control;
+
+using Bitmap = SchedulerBitmap<3>;
+
+TEST(SchedulerBitmap, default_constructed_bitmap_is_empty)
+{
+    Bitmap bitmap;
+
+    EXPECT_TRUE(bitmap.none());
+    EXPECT_FALSE(bitmap.any());
+    EXPECT_FALSE(static_cast<bool>(bitmap));
+    EXPECT_EQ(0, bitmap.count());
+    EXPECT_EQ(-1, bitmap.findNextSetBit(0));
+}
+
+TEST(SchedulerBitmap, uint64_constructor_sets_low_words)
+{
+    Bitmap bitmap(0x1'0000'0001ull);
+
+    EXPECT_TRUE(bitmap.test(0));
+    EXPECT_TRUE(bitmap.test(32));
+    EXPECT_EQ(2, bitmap.count());
+    EXPECT_EQ(0, bitmap.getWord(2));
+}
+
+TEST(SchedulerBitmap, set_test_reset_across_words)
+{
+    Bitmap bitmap;
+
+    for (int i : {0, 31, 32, 63, 64, 95})
+    {
+        bitmap.set(i);
+        EXPECT_TRUE(bitmap.test(i));
+    }
+    EXPECT_EQ(6, bitmap.count());
+    EXPECT_FALSE(bitmap.test(33));
+
+    bitmap.reset(64);
+    EXPECT_FALSE(bitmap.test(64));
+    EXPECT_EQ(5, bitmap.count());
+}
+
+TEST(SchedulerBitmap, findNextSetBit_skips_empty_words)
+{
+    Bitmap bitmap;
+    bitmap.set(3);
+    bitmap.set(70);
+    bitmap.set(95);
+
+    EXPECT_EQ(3, bitmap.findNextSetBit(0));
+    EXPECT_EQ(3, bitmap.findNextSetBit(3));
+    EXPECT_EQ(70, bitmap.findNextSetBit(4));
+    EXPECT_EQ(95, bitmap.findNextSetBit(71));
+    EXPECT_EQ(-1, bitmap.findNextSetBit(96));
+}
+
+TEST(SchedulerBitmap, bitwise_operators_match_single_bit_operations)
+{
+    Bitmap a = Bitmap::oneHot(10) | Bitmap::oneHot(80);
+    Bitmap b = Bitmap::oneHot(80) | Bitmap::oneHot(40);
+
+    EXPECT_EQ(Bitmap::oneHot(80), a & b);
+    EXPECT_EQ(Bitmap::oneHot(10) | Bitmap::oneHot(40), a ^ b);
+    EXPECT_EQ(3, (a | b).count());
+    EXPECT_EQ(Bitmap::oneHot(10), a & ~b);
+    EXPECT_EQ(Bitmap::SIZE - 2, (~a).count());
+    EXPECT_NE(a, b);
+}
+
+TEST(SchedulerBitmap, shift_left_carries_between_words)
+{
+    EXPECT_EQ(Bitmap::oneHot(33), Bitmap(1) << 33);
+    EXPECT_EQ(Bitmap::oneHot(95), Bitmap(1) << 95);
+    EXPECT_EQ(Bitmap::oneHot(64) | Bitmap::oneHot(65), Bitmap(3) << 64);
+    EXPECT_EQ(Bitmap::oneHot(31) | Bitmap::oneHot(32), Bitmap(3) << 31);
+    EXPECT_TRUE((Bitmap::oneHot(95) << 1).none());
+}
@@ -17,6 +17,8 @@
  * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <memory>
+
 #include <gtest/gtest.h>
 
 #include "tap/architecture/clock.hpp"
@@ -139,7 +141,7 @@ TEST(CommandScheduler, registerSubsystem_doesnt_register_nullptr_subsystem)
 TEST(CommandScheduler, registerSubsystem_big_batch_subsystem_assertion_succeeds)
 {
     constexpr int SUBS_TO_REGISTER =
-        std::min(sizeof(command_scheduler_bitmap_t), sizeof(subsystem_scheduler_bitmap_t)) * 8;
+        std::min(command_scheduler_bitmap_t::SIZE, subsystem_scheduler_bitmap_t::SIZE);
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
 
@@ -321,7 +323,7 @@ TEST(CommandScheduler, addCommand_successfully_removes_previously_added_command_
 
     set<Subsystem *> cmdMockRequirement{&s};
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(cmdMockRequirement)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
@@ -359,7 +361,7 @@ TEST(
     set<Subsystem *> subRequirementsC2{&s1, &s2, &s3};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
@@ -403,7 +405,7 @@ TEST(
     set<Subsystem *> subRequirementsC2{&s2, &s3};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
@@ -450,7 +452,7 @@ TEST(
     set<Subsystem *> subRequirementsC3{&s1};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
@@ -499,7 +501,7 @@ TEST(
     set<Subsystem *> subRequirementsC2{&s1, &s2};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
@@ -549,17 +551,17 @@ TEST(CommandScheduler, addCommand_add_multiple_commands_with_overlapping_sub_req
     set<Subsystem *> subRequirementsC4{&s2, &s3, &s5};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, end);
     EXPECT_CALL(c2, getRequirementsBitwise)
-        .Times(4)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC2)));
     EXPECT_CALL(c2, initialize);
     EXPECT_CALL(c2, end);
     EXPECT_CALL(c3, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC3)));
     EXPECT_CALL(c3, initialize);
     EXPECT_CALL(c3, end);
@@ -821,7 +823,7 @@ TEST(CommandScheduler, run_with_many_registered_subsystems_and_commands_calls_re
 {
     constexpr int RUN_TIMES = 100;
     constexpr int CMDS_AND_SUBS_TO_ADD =
-        std::min(sizeof(command_scheduler_bitmap_t), sizeof(subsystem_scheduler_bitmap_t)) * 8;
+        std::min(command_scheduler_bitmap_t::SIZE, subsystem_scheduler_bitmap_t::SIZE);
 
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
@@ -840,8 +842,7 @@ TEST(CommandScheduler, run_with_many_registered_subsystems_and_commands_calls_re
         EXPECT_CALL(*cmds[i], execute).Times(RUN_TIMES);
         EXPECT_CALL(*cmds[i], isFinished).Times(RUN_TIMES).WillRepeatedly(Return(false));
         EXPECT_CALL(*cmds[i], getRequirementsBitwise)
-            .Times(CMDS_AND_SUBS_TO_ADD - i)
-            .WillRepeatedly(Return(calcRequirementsBitwise(cmdRequirements[i])));
+            .WillOnce(Return(calcRequirementsBitwise(cmdRequirements[i])));
         EXPECT_CALL(*cmds[i], initialize);
 
         scheduler.registerSubsystem(subs[i]);
@@ -889,11 +890,11 @@ TEST(CommandScheduler, addCommand_disjoint_required_subsystems_successfully_adde
     set<Subsystem *> subRequirementsC3{&s4, &s6};
 
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(1)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c2, getRequirementsBitwise)
-        .Times(2)
+        .Times(1)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC2)));
     EXPECT_CALL(c2, initialize);
     EXPECT_CALL(c3, getRequirementsBitwise)
@@ -1048,7 +1049,7 @@ TEST(
 
     EXPECT_CALL(c1, initialize);
     EXPECT_CALL(c1, getRequirementsBitwise)
-        .Times(3)
+        .Times(2)
         .WillRepeatedly(Return(calcRequirementsBitwise(subRequirementsC1)));
     EXPECT_CALL(s2, getDefaultCommand).WillOnce(Return(&c2));
 
@@ -1294,6 +1295,50 @@ TEST(CommandScheduler, default_command_not_added_when_remote_disconnected)
     scheduler.run();
 }
 
+TEST(CommandScheduler, run_evaluates_safe_disconnect_function_once)
+{
+    Drivers drivers;
+    RemoteSafeDisconnectFunction func(&drivers);
+    CommandScheduler scheduler(&drivers, true, &func);
+
+    SubsystemMock s1(&drivers);
+    SubsystemMock s2(&drivers);
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+
+    NiceMock<CommandMock> c;
+    set<Subsystem *> subRequirements{&s1};
+    ON_CALL(c, getRequirementsBitwise)
+        .WillByDefault(Return(calcRequirementsBitwise(subRequirements)));
+    ON_CALL(s2, getDefaultCommand).WillByDefault(Return(&c));
+
+    EXPECT_CALL(drivers.remote, isConnected).WillOnce(Return(true));
+
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_uses_disconnected_state_latched_at_start_of_run)
+{
+    Drivers drivers;
+    RemoteSafeDisconnectFunction func(&drivers);
+    CommandScheduler scheduler(&drivers, true, &func);
+
+    SubsystemMock s1(&drivers);
+    SubsystemMock s2(&drivers);
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+
+    bool connected = true;
+    ON_CALL(drivers.remote, isConnected).WillByDefault([&]() { return connected; });
+    // The remote disconnecting partway through a run takes effect on the next run
+    EXPECT_CALL(s1, refresh).WillOnce([&]() { connected = false; });
+    EXPECT_CALL(s2, refresh).WillOnce([&]() { connected = false; });
+    EXPECT_CALL(s1, refreshSafeDisconnect).Times(0);
+    EXPECT_CALL(s2, refreshSafeDisconnect).Times(0);
+
+    scheduler.run();
+}
+
 TEST(CommandScheduler, removeCommand_nullptr_command_doesnt_crash)
 {
     Drivers drivers;
@@ -1327,7 +1372,7 @@ TEST(CommandScheduler, removeCommand_single_cmd_in_scheduler_removed_and_end_cal
 TEST(CommandScheduler, removeCommand_single_cmd_removed_from_big_batch)
 {
     static constexpr int SUBS_CMDS_TO_CREATE =
-        std::min(sizeof(command_scheduler_bitmap_t), sizeof(subsystem_scheduler_bitmap_t)) * 8;
+        std::min(command_scheduler_bitmap_t::SIZE, subsystem_scheduler_bitmap_t::SIZE);
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
 
@@ -1358,7 +1403,7 @@ TEST(CommandScheduler, removeCommand_single_cmd_removed_from_big_batch)
 TEST(CommandScheduler, subsystemListSize_commandListSize_returns_number_of_subs_cmds_in_scheduler)
 {
     static constexpr int SUBS_CMDS_TO_CREATE =
-        std::min(sizeof(command_scheduler_bitmap_t), sizeof(subsystem_scheduler_bitmap_t)) * 8;
+        std::min(command_scheduler_bitmap_t::SIZE, subsystem_scheduler_bitmap_t::SIZE);
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
 
@@ -1423,7 +1468,7 @@ TEST(CommandScheduler, iterators_couple_cmd_sub_iterated_through)
     EXPECT_CALL(cmd1, initialize);
     EXPECT_CALL(cmd2, initialize);
     EXPECT_CALL(cmd1, getRequirementsBitwise)
-        .Times(2)
+        .Times(1)
         .WillRepeatedly(Return(calcRequirementsBitwise({&sub1})));
     EXPECT_CALL(cmd2, getRequirementsBitwise).WillOnce(Return(calcRequirementsBitwise({&sub2})));
 
@@ -1448,7 +1493,7 @@ TEST(CommandScheduler, iterators_couple_cmd_sub_iterated_through)
 TEST(CommandScheduler, iterators_many_cmds_subs_iterated_through_using_foreach)
 {
     static constexpr int SUBS_CMDS_TO_CREATE =
-        std::min(sizeof(command_scheduler_bitmap_t), sizeof(subsystem_scheduler_bitmap_t)) * 8;
+        std::min(command_scheduler_bitmap_t::SIZE, subsystem_scheduler_bitmap_t::SIZE);
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
 
@@ -1496,7 +1541,7 @@ TEST(CommandScheduler, iterators_many_cmds_subs_iterated_through_using_foreach)
 TEST(CommandScheduler, iterators_work_properly_with_gaps_in_global_registrar)
 {
     static constexpr int SUBS_CMDS_TO_CREATE =
-        std::min(sizeof(subsystem_scheduler_bitmap_t), sizeof(command_scheduler_bitmap_t)) * 8;
+        std::min(subsystem_scheduler_bitmap_t::SIZE, command_scheduler_bitmap_t::SIZE);
 
     Drivers drivers;
     CommandScheduler scheduler(&drivers, true);
@@ -1655,3 +1700,753 @@ TEST(CommandScheduler, refreshSafeDisconnect_only_called_once)
 
     scheduler.run();
 }
+
+TEST(CommandScheduler, run_execution_time_accounting_disabled_by_default_records_nothing)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 1; });
+    ON_CALL(s, refresh).WillByDefault([&]() { clock.time += 1; });
+
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isExecutionTimeAccountingEnabled());
+    EXPECT_TRUE(CommandScheduler::getCommandExecutionTimeStats(&c).isEmpty());
+    EXPECT_TRUE(CommandScheduler::getSubsystemExecutionTimeStats(&s).isEmpty());
+    EXPECT_EQ(nullptr, scheduler.getWorstOffenderName());
+}
+
+TEST(CommandScheduler, run_execution_time_accounting_enabled_records_command_and_subsystem_stats)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    ON_CALL(s, refresh).WillByDefault([&]() { clock.time += 1; });
+
+    scheduler.setExecutionTimeAccountingEnabled(true);
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 2; });
+    scheduler.run();
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 4; });
+    scheduler.run();
+
+    auto cmdStats = CommandScheduler::getCommandExecutionTimeStats(&c);
+    EXPECT_EQ(2 * cyclesPerMs, cmdStats.minCycles);
+    EXPECT_EQ(4 * cyclesPerMs, cmdStats.maxCycles);
+    EXPECT_EQ(4 * cyclesPerMs, cmdStats.lastCycles);
+    EXPECT_LT(2.0f * cyclesPerMs, cmdStats.avgCycles);
+    EXPECT_GT(4.0f * cyclesPerMs, cmdStats.avgCycles);
+
+    auto subStats = CommandScheduler::getSubsystemExecutionTimeStats(&s);
+    EXPECT_EQ(cyclesPerMs, subStats.minCycles);
+    EXPECT_EQ(cyclesPerMs, subStats.maxCycles);
+
+    CommandScheduler::resetExecutionTimeStats();
+    EXPECT_TRUE(CommandScheduler::getCommandExecutionTimeStats(&c).isEmpty());
+    EXPECT_TRUE(CommandScheduler::getSubsystemExecutionTimeStats(&s).isEmpty());
+}
+
+TEST(CommandScheduler, run_execution_time_accounting_reports_worst_offender)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c, getName).WillByDefault(Return("fast command"));
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 1; });
+    ON_CALL(s1, getName).WillByDefault(Return("fast subsystem"));
+    ON_CALL(s2, getName).WillByDefault(Return("slow subsystem"));
+    ON_CALL(s2, refresh).WillByDefault([&]() { clock.time += 5; });
+
+    scheduler.setExecutionTimeAccountingEnabled(true);
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c);
+    scheduler.run();
+
+    EXPECT_STREQ("slow subsystem", scheduler.getWorstOffenderName());
+    EXPECT_EQ(
+        CommandScheduler::getSubsystemExecutionTimeStats(&s2).lastCycles,
+        scheduler.getWorstOffenderCycles());
+}
+
+TEST(CommandScheduler, run_command_over_time_budget_consecutive_ticks_degraded_and_reported)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 2; });
+    c.getTimeBudget().set(cyclesPerMs, 3);
+
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+
+    EXPECT_CALL(c, execute).Times(3);
+    EXPECT_CALL(c, executeDegraded).Times(2);
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(1);
+
+    for (int i = 0; i < 5; i++)
+    {
+        scheduler.run();
+    }
+
+    EXPECT_TRUE(c.getTimeBudget().isDegraded());
+}
+
+TEST(CommandScheduler, run_command_over_time_budget_execution_time_accounting_disabled_degraded)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 2; });
+    c.getTimeBudget().set(cyclesPerMs, 1);
+
+    scheduler.setExecutionTimeAccountingEnabled(false);
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+
+    EXPECT_CALL(c, execute).Times(1);
+    EXPECT_CALL(c, executeDegraded).Times(1);
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(1);
+
+    scheduler.run();
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isExecutionTimeAccountingEnabled());
+    EXPECT_TRUE(c.getTimeBudget().isDegraded());
+}
+
+TEST(CommandScheduler, run_command_under_time_budget_between_overruns_not_degraded)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    c.getTimeBudget().set(cyclesPerMs, 2);
+
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+
+    EXPECT_CALL(c, executeDegraded).Times(0);
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+
+    for (int i = 0; i < 10; i++)
+    {
+        // Alternate between over and under budget
+        const int ms = i % 2 == 0 ? 2 : 0;
+        ON_CALL(c, execute).WillByDefault([&clock, ms]() { clock.time += ms; });
+        scheduler.run();
+    }
+
+    EXPECT_FALSE(c.getTimeBudget().isDegraded());
+}
+
+TEST(CommandScheduler, addCommand_restores_degraded_command)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s})));
+    ON_CALL(c, execute).WillByDefault([&]() { clock.time += 2; });
+    c.getTimeBudget().set(cyclesPerMs, 1);
+
+    scheduler.registerSubsystem(&s);
+    scheduler.addCommand(&c);
+    scheduler.run();
+    ASSERT_TRUE(c.getTimeBudget().isDegraded());
+
+    scheduler.removeCommand(&c, true);
+    scheduler.addCommand(&c);
+
+    EXPECT_FALSE(c.getTimeBudget().isDegraded());
+    EXPECT_CALL(c, execute);
+    EXPECT_CALL(c, executeDegraded).Times(0);
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_subsystem_over_time_budget_refreshed_degraded)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    tap::arch::clock::ClockStub clock;
+    clock.time = 1;
+    const uint32_t cyclesPerMs = tap::arch::clock::getCycleCount();
+
+    NiceMock<SubsystemMock> s(&drivers);
+    ON_CALL(s, getName).WillByDefault(Return("vision"));
+    ON_CALL(s, refresh).WillByDefault([&]() { clock.time += 2; });
+    s.getTimeBudget().set(cyclesPerMs, 2);
+
+    scheduler.registerSubsystem(&s);
+
+    EXPECT_CALL(s, refresh).Times(2);
+    EXPECT_CALL(s, refreshDegraded).Times(3);
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(1);
+
+    for (int i = 0; i < 5; i++)
+    {
+        scheduler.run();
+    }
+
+    EXPECT_TRUE(s.getTimeBudget().isDegraded());
+
+    s.getTimeBudget().restore();
+    EXPECT_CALL(s, refresh);
+    scheduler.run();
+}
+
+TEST(CommandScheduler, registerSubsystem_with_refresh_policy_invalid_policy_raises_error)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s(&drivers);
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(2);
+
+    scheduler.registerSubsystem(&s, RefreshPolicy{0, 0, 0});
+    scheduler.registerSubsystem(&s, RefreshPolicy{0, 4, 4});
+
+    EXPECT_FALSE(scheduler.isSubsystemRegistered(&s));
+}
+
+TEST(CommandScheduler, run_refreshes_subsystems_in_priority_order)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> low(&drivers);
+    NiceMock<SubsystemMock> high(&drivers);
+    NiceMock<SubsystemMock> mid(&drivers);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(high, refresh);
+        EXPECT_CALL(mid, refresh);
+        EXPECT_CALL(low, refresh);
+    }
+
+    scheduler.registerSubsystem(&low);
+    scheduler.registerSubsystem(&high, RefreshPolicy{10, 1, 0});
+    scheduler.registerSubsystem(&mid, RefreshPolicy{5, 1, 0});
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_subsystem_registered_after_destroyed_subsystem_refreshed_once_per_tick)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+
+    int destroyedId;
+    {
+        NiceMock<SubsystemMock> destroyed(&drivers);
+        scheduler.registerSubsystem(&destroyed);
+        destroyedId = destroyed.getGlobalIdentifier();
+    }
+
+    NiceMock<SubsystemMock> s(&drivers);
+    ASSERT_EQ(destroyedId, s.getGlobalIdentifier());
+    EXPECT_FALSE(scheduler.isSubsystemRegistered(&s));
+
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+    EXPECT_CALL(s, refresh).Times(3);
+
+    scheduler.registerSubsystem(&s);
+    for (int i = 0; i < 3; i++)
+    {
+        scheduler.run();
+    }
+}
+
+TEST(CommandScheduler, run_rate_divided_subsystem_refreshed_on_matching_phase_only)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> fast(&drivers);
+    NiceMock<SubsystemMock> slow(&drivers);
+
+    int slowRefreshes = 0;
+    int lastSlowRefreshTick = -1;
+    int tick = 0;
+    ON_CALL(slow, refresh).WillByDefault([&]() {
+        slowRefreshes++;
+        lastSlowRefreshTick = tick;
+    });
+    EXPECT_CALL(fast, refresh).Times(20);
+
+    scheduler.registerSubsystem(&fast);
+    scheduler.registerSubsystem(&slow, RefreshPolicy{0, 10, 3});
+
+    for (tick = 0; tick < 20; tick++)
+    {
+        scheduler.run();
+    }
+
+    EXPECT_EQ(2, slowRefreshes);
+    EXPECT_EQ(13, lastSlowRefreshTick);
+}
+
+TEST(CommandScheduler, run_refreshes_sensors_before_commands_and_actuators_after)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c;
+    ON_CALL(c, getRequirementsBitwise)
+        .WillByDefault(Return(calcRequirementsBitwise({&s1})));
+
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(s1, refreshSensors);
+        EXPECT_CALL(s2, refreshSensors);
+        EXPECT_CALL(c, execute);
+        EXPECT_CALL(s1, refresh);
+        EXPECT_CALL(s1, refreshActuators);
+        EXPECT_CALL(s2, refresh);
+        EXPECT_CALL(s2, refreshActuators);
+    }
+
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_safe_disconnected_refreshes_sensors_but_not_actuators)
+{
+    Drivers drivers;
+    RemoteSafeDisconnectFunction func(&drivers);
+    CommandScheduler scheduler(&drivers, true, &func);
+    NiceMock<SubsystemMock> s(&drivers);
+    scheduler.registerSubsystem(&s);
+
+    EXPECT_CALL(s, refreshSensors);
+    EXPECT_CALL(s, refreshSafeDisconnect);
+    EXPECT_CALL(s, refreshActuators).Times(0);
+
+    ON_CALL(drivers.remote, isConnected).WillByDefault(Return(false));
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_degraded_subsystem_still_refreshes_actuators)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s(&drivers);
+    scheduler.registerSubsystem(&s);
+    s.getTimeBudget().set(1, 1);
+    s.getTimeBudget().update(2);
+
+    EXPECT_CALL(s, refreshDegraded);
+    EXPECT_CALL(s, refreshActuators);
+
+    scheduler.run();
+}
+
+TEST(CommandScheduler, run_rate_divided_subsystem_sensors_refreshed_on_matching_phase_only)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> slow(&drivers);
+
+    EXPECT_CALL(slow, refreshSensors).Times(2);
+    EXPECT_CALL(slow, refreshActuators).Times(2);
+
+    scheduler.registerSubsystem(&slow, RefreshPolicy{0, 10, 3});
+    for (int tick = 0; tick < 20; tick++)
+    {
+        scheduler.run();
+    }
+}
+
+TEST(CommandScheduler, registerSubsystem_auto_phase_staggers_rate_divided_subsystems)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<SubsystemMock> s3(&drivers);
+    NiceMock<SubsystemMock> s4(&drivers);
+
+    scheduler.registerSubsystem(&s1, RefreshPolicy{0, 2});
+    scheduler.registerSubsystem(&s2, RefreshPolicy{0, 2});
+    scheduler.registerSubsystem(&s3, RefreshPolicy{0, 4});
+    scheduler.registerSubsystem(&s4, RefreshPolicy{0, 4});
+
+    EXPECT_EQ(0, CommandScheduler::getSubsystemRefreshPolicy(&s1).phase);
+    EXPECT_EQ(1, CommandScheduler::getSubsystemRefreshPolicy(&s2).phase);
+
+    // s3 and s4 must each share ticks with one of s1 or s2, but should not share ticks with
+    // each other
+    uint8_t s3Phase = CommandScheduler::getSubsystemRefreshPolicy(&s3).phase;
+    uint8_t s4Phase = CommandScheduler::getSubsystemRefreshPolicy(&s4).phase;
+    EXPECT_NE(s3Phase % 2, s4Phase % 2);
+
+    // Count refreshes per tick, no more than two subsystems should be refreshed in a single tick
+    int refreshesThisTick = 0;
+    int totalRefreshes = 0;
+    auto countRefresh = [&]() {
+        refreshesThisTick++;
+        totalRefreshes++;
+    };
+    ON_CALL(s1, refresh).WillByDefault(countRefresh);
+    ON_CALL(s2, refresh).WillByDefault(countRefresh);
+    ON_CALL(s3, refresh).WillByDefault(countRefresh);
+    ON_CALL(s4, refresh).WillByDefault(countRefresh);
+
+    for (int i = 0; i < 8; i++)
+    {
+        refreshesThisTick = 0;
+        scheduler.run();
+        EXPECT_GE(2, refreshesThisTick);
+    }
+
+    EXPECT_EQ(12, totalRefreshes);
+}
+
+TEST(CommandScheduler, registerSubsystem_with_refresh_policy_non_master_ignores_policy)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers);
+    NiceMock<SubsystemMock> s(&drivers);
+
+    scheduler.registerSubsystem(&s, RefreshPolicy{3, 5, 2});
+
+    EXPECT_TRUE(scheduler.isSubsystemRegistered(&s));
+    EXPECT_EQ(1, CommandScheduler::getSubsystemRefreshPolicy(&s).divider);
+}
+
+TEST(CommandScheduler, addCommand_only_interrupts_commands_owning_required_subsystems)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<SubsystemMock> s3(&drivers);
+    NiceMock<SubsystemMock> s4(&drivers);
+
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    NiceMock<CommandMock> c3;
+    NiceMock<CommandMock> c4;
+
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s2})));
+    ON_CALL(c3, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s3})));
+    ON_CALL(c4, getRequirementsBitwise)
+        .WillByDefault(Return(calcRequirementsBitwise({&s1, &s3, &s4})));
+
+    EXPECT_CALL(c1, end(true));
+    EXPECT_CALL(c2, end).Times(0);
+    EXPECT_CALL(c3, end(true));
+
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.registerSubsystem(&s3);
+    scheduler.registerSubsystem(&s4);
+
+    scheduler.addCommand(&c1);
+    scheduler.addCommand(&c2);
+    scheduler.addCommand(&c3);
+    scheduler.addCommand(&c4);
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c2));
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c3));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c4));
+}
+
+/// A command mock that only finishes through `requestFinish`.
+class FinishOnRequestCommandMock : public CommandMock
+{
+public:
+    FinishOnRequestCommandMock() { setFinishesOnRequest(); }
+};
+
+TEST(CommandScheduler, run_command_finishing_on_request_is_not_polled)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<FinishOnRequestCommandMock> c1;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    scheduler.registerSubsystem(&s1);
+
+    EXPECT_CALL(c1, isFinished).Times(0);
+    EXPECT_CALL(c1, execute).Times(3);
+    EXPECT_CALL(c1, end(false));
+
+    scheduler.addCommand(&c1);
+    scheduler.run();
+    scheduler.run();
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+
+    c1.requestFinish();
+    scheduler.run();
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+}
+
+TEST(CommandScheduler, run_removes_polled_command_when_finish_requested)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<CommandMock> c1;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c1, isFinished).WillByDefault(Return(false));
+    scheduler.registerSubsystem(&s1);
+    scheduler.addCommand(&c1);
+
+    EXPECT_CALL(c1, end(false));
+
+    c1.requestFinish();
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+}
+
+TEST(CommandScheduler, addCommand_clears_earlier_finish_request)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<FinishOnRequestCommandMock> c1;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    scheduler.registerSubsystem(&s1);
+
+    c1.requestFinish();
+    scheduler.addCommand(&c1);
+    scheduler.run();
+
+    EXPECT_FALSE(c1.isFinishRequested());
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+}
+
+TEST(CommandScheduler, run_finished_command_ended_after_all_commands_execute)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s2})));
+    ON_CALL(c1, isFinished).WillByDefault(Return(true));
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c1);
+    scheduler.addCommand(&c2);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(c1, execute);
+        EXPECT_CALL(c2, execute);
+        EXPECT_CALL(c1, end(false));
+        EXPECT_CALL(s1, refresh);
+    }
+
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c2));
+}
+
+TEST(CommandScheduler, run_command_added_during_run_first_executes_next_run)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s2})));
+    ON_CALL(c1, execute).WillByDefault([&]() {
+        scheduler.addCommand(&c2);
+        EXPECT_FALSE(scheduler.isCommandScheduled(&c2));
+    });
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c1);
+
+    EXPECT_CALL(c2, initialize);
+    EXPECT_CALL(c2, execute).Times(0);
+
+    scheduler.run();
+
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c2));
+}
+
+TEST(CommandScheduler, run_command_removed_during_run_is_not_executed)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s2})));
+    ON_CALL(c1, execute).WillByDefault([&]() { scheduler.removeCommand(&c2, true); });
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c1);
+    scheduler.addCommand(&c2);
+
+    EXPECT_CALL(c2, execute).Times(0);
+    EXPECT_CALL(c2, end(true));
+
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c2));
+}
+
+TEST(CommandScheduler, run_removing_command_queued_during_run_cancels_addition)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s2})));
+    ON_CALL(c1, execute).WillByDefault([&]() {
+        scheduler.addCommand(&c2);
+        scheduler.removeCommand(&c2, true);
+    });
+    scheduler.registerSubsystem(&s1);
+    scheduler.registerSubsystem(&s2);
+    scheduler.addCommand(&c1);
+
+    EXPECT_CALL(c2, initialize).Times(0);
+    EXPECT_CALL(c2, end).Times(0);
+
+    scheduler.run();
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c2));
+}
+
+TEST(CommandScheduler, run_default_command_added_after_finished_command_ends)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> defaultCommand;
+    ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(defaultCommand, getRequirementsBitwise)
+        .WillByDefault(Return(calcRequirementsBitwise({&s1})));
+    ON_CALL(c1, isFinished).WillByDefault(Return(true));
+    ON_CALL(s1, getDefaultCommand).WillByDefault(Return(&defaultCommand));
+    scheduler.registerSubsystem(&s1);
+    scheduler.addCommand(&c1);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(c1, end(false));
+        EXPECT_CALL(s1, refresh);
+        EXPECT_CALL(defaultCommand, initialize);
+    }
+
+    scheduler.run();
+
+    EXPECT_TRUE(scheduler.isCommandScheduled(&defaultCommand));
+}
+
+TEST(CommandScheduler, run_only_master_scheduler_advances_tick_count)
+{
+    Drivers drivers;
+    CommandScheduler scheduler(&drivers, true);
+    CommandScheduler comprisedScheduler(&drivers);
+    const uint32_t tickCount = CommandScheduler::getTickCount();
+
+    scheduler.run();
+    comprisedScheduler.run();
+
+    EXPECT_EQ(tickCount + 1, CommandScheduler::getTickCount());
+}
+
+TEST(CommandScheduler, registries_isolate_the_schedulers_of_each_robot)
+{
+    Drivers drivers;
+    CommandScheduler::Registry registries[2];
+    std::unique_ptr<CommandScheduler> schedulers[2];
+    std::unique_ptr<NiceMock<SubsystemMock>> subsystems[2];
+
+    // Each robot has its own master scheduler
+    EXPECT_CALL(drivers.errorController, addToErrorList).Times(0);
+    for (int i = 0; i < 2; i++)
+    {
+        CommandScheduler::setActiveRegistry(&registries[i]);
+        schedulers[i] = std::make_unique<CommandScheduler>(&drivers, true);
+        subsystems[i] = std::make_unique<NiceMock<SubsystemMock>>(&drivers);
+        schedulers[i]->registerSubsystem(subsystems[i].get());
+    }
+    EXPECT_EQ(0, subsystems[0]->getGlobalIdentifier());
+    EXPECT_EQ(0, subsystems[1]->getGlobalIdentifier());
+
+    EXPECT_CALL(*subsystems[0], refresh).Times(2);
+    EXPECT_CALL(*subsystems[1], refresh).Times(1);
+
+    CommandScheduler::setActiveRegistry(&registries[0]);
+    schedulers[0]->run();
+    schedulers[0]->run();
+    EXPECT_EQ(2u, CommandScheduler::getTickCount());
+
+    CommandScheduler::setActiveRegistry(&registries[1]);
+    schedulers[1]->run();
+    EXPECT_EQ(1u, CommandScheduler::getTickCount());
+
+    for (int i = 0; i < 2; i++)
+    {
+        CommandScheduler::setActiveRegistry(&registries[i]);
+        subsystems[i].reset();
+        schedulers[i].reset();
+    }
+    CommandScheduler::setActiveRegistry(nullptr);
+    EXPECT_NE(&registries[1], CommandScheduler::getActiveRegistry());
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/control/concurrent_command.hpp"
+#include "tap/control/flattened_command.hpp"
+#include "tap/control/sequential_command.hpp"
+#include "tap/drivers.hpp"
+
+#include "test_subsystem.hpp"
+
+using namespace tap::control;
+using tap::Drivers;
+
+/// Logs its calls, and finishes after executing a set number of times.
+class RecordingCommand : public Command
+{
+public:
+    RecordingCommand(
+        Subsystem *subsystem,
+        const char *name,
+        std::vector<std::string> &log,
+        int executesToFinish)
+        : name(name),
+          log(log),
+          executesToFinish(executesToFinish)
+    {
+        addSubsystemRequirement(subsystem);
+    }
+
+    const char *getName() const override { return name; }
+    bool isReady() override { return ready; }
+    void initialize() override
+    {
+        executes = 0;
+        log.push_back(std::string(name) + " initialize");
+    }
+    void execute() override
+    {
+        executes++;
+        log.push_back(std::string(name) + " execute");
+    }
+    void end(bool interrupted) override
+    {
+        log.push_back(std::string(name) + (interrupted ? " interrupted" : " end"));
+    }
+    bool isFinished() const override { return executes >= executesToFinish; }
+
+    bool ready = true;
+
+private:
+    const char *name;
+    std::vector<std::string> &log;
+    int executesToFinish;
+    int executes = 0;
+};
+
+/**
+ * sequence(race(a, b), concurrent(c, sequence(d, e)), f), where a leaf named with a number
+ * finishes after executing that many times.
+ */
+class FlattenedCommandTest : public testing::Test
+{
+protected:
+    FlattenedCommandTest()
+        : scheduler(&drivers, true),
+          s{TestSubsystem(&drivers),
+            TestSubsystem(&drivers),
+            TestSubsystem(&drivers),
+            TestSubsystem(&drivers),
+            TestSubsystem(&drivers),
+            TestSubsystem(&drivers)},
+          a(&s[0], "a3", log, 3),
+          b(&s[1], "b5", log, 5),
+          c(&s[2], "c4", log, 4),
+          d(&s[3], "d1", log, 1),
+          e(&s[4], "e2", log, 2),
+          f(&s[5], "f2", log, 2),
+          race({&a, &b}, "race"),
+          innerSequence({&d, &e}),
+          concurrent({&c, &innerSequence}, "concurrent"),
+          sequence({&race, &concurrent, &f}),
+          flattened(&sequence, "flattened")
+    {
+        for (TestSubsystem &subsystem : s)
+        {
+            scheduler.registerSubsystem(&subsystem);
+        }
+    }
+
+    /**
+     * Adds the command, runs the scheduler `ticks` times, and returns the log.
+     *
+     * @param[in] interruptAfter Whether to remove the command after the last tick.
+     * @param[in] fReadyTick The tick before which `f` becomes ready, or -1 if it's always ready.
+     */
+    std::vector<std::string> run(
+        Command *command,
+        int ticks,
+        bool interruptAfter = false,
+        int fReadyTick = -1)
+    {
+        log.clear();
+        f.ready = fReadyTick < 0;
+        scheduler.addCommand(command);
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            f.ready |= tick == fReadyTick;
+            log.push_back("tick");
+            scheduler.run();
+        }
+        if (interruptAfter)
+        {
+            scheduler.removeCommand(command, true);
+        }
+        return log;
+    }
+
+    Drivers drivers;
+    CommandScheduler scheduler;
+    TestSubsystem s[6];
+    std::vector<std::string> log;
+    RecordingCommand a, b, c, d, e, f;
+    ConcurrentRaceCommand<2> race;
+    SequentialCommand<2> innerSequence;
+    ConcurrentCommand<2> concurrent;
+    SequentialCommand<3> sequence;
+    FlattenedCommand<16> flattened;
+};
+
+TEST_F(FlattenedCommandTest, tree_is_compiled_into_nodes)
+{
+    EXPECT_EQ(10, flattened.getNumNodes());
+    EXPECT_EQ(sequence.getRequirementsBitwise(), flattened.getRequirementsBitwise());
+    EXPECT_STREQ("flattened", flattened.getName());
+}
+
+TEST_F(FlattenedCommandTest, runs_leaves_like_composites)
+{
+    std::vector<std::string> expected = run(&sequence, 12);
+    EXPECT_FALSE(scheduler.isCommandScheduled(&sequence));
+
+    EXPECT_EQ(expected, run(&flattened, 12));
+    EXPECT_FALSE(scheduler.isCommandScheduled(&flattened));
+}
+
+TEST_F(FlattenedCommandTest, can_be_run_again)
+{
+    run(&flattened, 12);
+    std::vector<std::string> expected = run(&sequence, 12);
+
+    EXPECT_EQ(expected, run(&flattened, 12));
+}
+
+TEST_F(FlattenedCommandTest, sequence_waits_for_next_command_to_be_ready)
+{
+    std::vector<std::string> expected = run(&sequence, 14, false, 10);
+
+    EXPECT_EQ(expected, run(&flattened, 14, false, 10));
+}
+
+TEST_F(FlattenedCommandTest, interrupted_sequence_does_not_end_command_never_started)
+{
+    // After 4 ticks, d has finished and e is next in the inner sequence, but hasn't started yet
+    std::vector<std::string> expected = run(&sequence, 4, true);
+    auto neverStartedEnded = std::find(expected.begin(), expected.end(), "e2 interrupted");
+    ASSERT_NE(expected.end(), neverStartedEnded);
+    expected.erase(neverStartedEnded);
+
+    EXPECT_EQ(expected, run(&flattened, 4, true));
+}
+
+TEST_F(FlattenedCommandTest, interrupts_race_like_composites)
+{
+    std::vector<std::string> expected = run(&sequence, 2, true);
+
+    EXPECT_EQ(expected, run(&flattened, 2, true));
+    EXPECT_FALSE(scheduler.isCommandScheduled(&flattened));
+}
+
+TEST_F(FlattenedCommandTest, interrupts_concurrent_like_composites)
+{
+    std::vector<std::string> expected = run(&sequence, 5, true);
+
+    EXPECT_EQ(expected, run(&flattened, 5, true));
+}
+
+TEST_F(FlattenedCommandTest, interrupts_partly_finished_concurrent_like_composites)
+{
+    std::vector<std::string> expected = run(&sequence, 6, true);
+
+    EXPECT_EQ(expected, run(&flattened, 6, true));
+}
+
+TEST_F(FlattenedCommandTest, leaf_root_runs_like_the_leaf)
+{
+    FlattenedCommand<1> flattenedLeaf(&a, "a");
+
+    std::vector<std::string> log = run(&flattenedLeaf, 3);
+
+    EXPECT_EQ(
+        std::vector<std::string>(
+            {"a3 initialize", "tick", "a3 execute", "tick", "a3 execute", "tick", "a3 execute",
+             "a3 end"}),
+        log);
+    EXPECT_FALSE(scheduler.isCommandScheduled(&flattenedLeaf));
+}
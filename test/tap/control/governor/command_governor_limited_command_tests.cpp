@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/control/command_scheduler.hpp"
 #include "tap/control/governor/governor_limited_command.hpp"
 #include "tap/drivers.hpp"
 #include "tap/mock/command_governor_interface_mock.hpp"
@@ -183,3 +184,179 @@ TYPED_TEST(GovernorLimitedCommandTest, initialize_execute_end_runs_cmdToGovern)
     TestFixture::cmd->end(false);
     TestFixture::cmd->end(true);
 }
+
+/// A governor that notifies its commands to finish instead of being polled.
+class NotifyingGovernor : public CommandGovernorInterface
+{
+public:
+    NotifyingGovernor() { setNotifiesFinish(); }
+
+    bool isReady() override { return true; }
+    bool isFinished() override
+    {
+        numIsFinishedCalls++;
+        return false;
+    }
+
+    void finish() { notifyFinish(); }
+
+    int numIsFinishedCalls = 0;
+};
+
+/// A command mock that only finishes through `requestFinish`.
+class FinishOnRequestCommandMock : public CommandMock
+{
+public:
+    FinishOnRequestCommandMock() { setFinishesOnRequest(); }
+};
+
+class GovernorLimitedCommandNotifyTest : public Test
+{
+protected:
+    GovernorLimitedCommandNotifyTest() : sub(&drivers) {}
+
+    void SetUp() override
+    {
+        ON_CALL(cmdToGovern, getRequirementsBitwise)
+            .WillByDefault(Return(1UL << sub.getGlobalIdentifier()));
+        ON_CALL(onRequestCmdToGovern, getRequirementsBitwise)
+            .WillByDefault(Return(1UL << sub.getGlobalIdentifier()));
+    }
+
+    Drivers drivers;
+    NiceMock<SubsystemMock> sub;
+    NiceMock<CommandMock> cmdToGovern;
+    NiceMock<FinishOnRequestCommandMock> onRequestCmdToGovern;
+    NotifyingGovernor notifyingGovernor;
+    NiceMock<CommandGovernorInterfaceMock> polledGovernor;
+};
+
+TEST_F(GovernorLimitedCommandNotifyTest, notifying_governor_requests_finish_instead_of_being_polled)
+{
+    GovernorLimitedCommand<1> cmd({&sub}, cmdToGovern, {&notifyingGovernor});
+
+    cmd.initialize();
+    cmd.execute();
+    EXPECT_FALSE(cmd.isFinished());
+
+    notifyingGovernor.finish();
+    EXPECT_TRUE(cmd.isFinished());
+    EXPECT_EQ(0, notifyingGovernor.numIsFinishedCalls);
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, finishes_on_request_when_command_and_governors_do)
+{
+    GovernorLimitedCommand<1> cmd({&sub}, onRequestCmdToGovern, {&notifyingGovernor});
+
+    EXPECT_TRUE(cmd.finishesOnRequest());
+    EXPECT_CALL(onRequestCmdToGovern, isFinished).Times(0);
+
+    cmd.initialize();
+    cmd.execute();
+    EXPECT_FALSE(cmd.checkFinished());
+
+    onRequestCmdToGovern.requestFinish();
+    cmd.execute();
+    EXPECT_TRUE(cmd.checkFinished());
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, polled_governor_keeps_command_polled)
+{
+    GovernorLimitedCommand<2> cmd(
+        {&sub},
+        onRequestCmdToGovern,
+        {&notifyingGovernor, &polledGovernor});
+
+    EXPECT_FALSE(cmd.finishesOnRequest());
+
+    EXPECT_CALL(polledGovernor, isFinished).WillOnce(Return(true));
+    EXPECT_TRUE(cmd.checkFinished());
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, initialize_clears_governed_command_finish_request)
+{
+    GovernorLimitedCommand<1> cmd({&sub}, onRequestCmdToGovern, {&notifyingGovernor});
+    onRequestCmdToGovern.requestFinish();
+
+    cmd.initialize();
+
+    EXPECT_FALSE(onRequestCmdToGovern.isFinishRequested());
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, destroyed_command_is_no_longer_notified)
+{
+    GovernorLimitedCommand<1> cmd({&sub}, cmdToGovern, {&notifyingGovernor});
+    {
+        GovernorLimitedCommand<1> destroyed({&sub}, cmdToGovern, {&notifyingGovernor});
+    }
+
+    notifyingGovernor.finish();
+
+    EXPECT_TRUE(cmd.isFinishRequested());
+}
+
+/// A governor cached per tick that counts how often it is evaluated.
+class CachedGovernor : public CommandGovernorInterface
+{
+public:
+    CachedGovernor() { setCachedPerTick(); }
+
+    bool isReady() override
+    {
+        numIsReadyCalls++;
+        return true;
+    }
+    bool isFinished() override
+    {
+        numIsFinishedCalls++;
+        return false;
+    }
+
+    int numIsReadyCalls = 0;
+    int numIsFinishedCalls = 0;
+};
+
+TEST_F(GovernorLimitedCommandNotifyTest, cached_governor_evaluated_once_per_tick)
+{
+    tap::control::CommandScheduler scheduler(&drivers, true);
+    CachedGovernor governor;
+    GovernorLimitedCommand<1> cmd1({&sub}, cmdToGovern, {&governor});
+    GovernorLimitedCommand<1> cmd2({&sub}, cmdToGovern, {&governor});
+
+    EXPECT_TRUE(cmd1.isReady());
+    EXPECT_TRUE(cmd2.isReady());
+    EXPECT_FALSE(cmd1.isFinished());
+    EXPECT_FALSE(cmd2.isFinished());
+    EXPECT_EQ(1, governor.numIsReadyCalls);
+    EXPECT_EQ(1, governor.numIsFinishedCalls);
+
+    scheduler.run();
+
+    EXPECT_TRUE(cmd1.isReady());
+    EXPECT_TRUE(cmd2.isReady());
+    EXPECT_EQ(2, governor.numIsReadyCalls);
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, initialize_invalidates_cached_governor)
+{
+    CachedGovernor governor;
+    GovernorLimitedCommand<1> cmd({&sub}, cmdToGovern, {&governor});
+
+    cmd.isReady();
+    cmd.initialize();
+    cmd.isReady();
+
+    EXPECT_EQ(2, governor.numIsReadyCalls);
+}
+
+TEST_F(GovernorLimitedCommandNotifyTest, requirements_bitmap_constructor_matches_subsystem_list)
+{
+    GovernorLimitedCommand<1> fromList({&sub}, cmdToGovern, {&polledGovernor});
+    GovernorLimitedCommand<1> fromBitmap(
+        tap::control::Command::requirementsOf({&sub, nullptr}),
+        cmdToGovern,
+        {&polledGovernor});
+
+    EXPECT_EQ(1UL << sub.getGlobalIdentifier(), fromBitmap.getRequirementsBitwise());
+    EXPECT_EQ(fromList.getRequirementsBitwise(), fromBitmap.getRequirementsBitwise());
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/governor/heat_limit_governor.hpp"
+#include "tap/drivers.hpp"
+
+using namespace tap::control::governor;
+using namespace tap::communication::serial;
+using namespace testing;
+
+static constexpr HeatLimitGovernor::Config CONFIG = {
+    .mechanism = RefSerialData::Rx::TURRET_17MM_1,
+    .heatPerShot = 10,
+    .heatLimitMargin = 5,
+    .refereeLatency = 100,
+};
+
+class HeatLimitGovernorTest : public Test
+{
+protected:
+    HeatLimitGovernorTest() : governor(&drivers, CONFIG) {}
+
+    void SetUp() override
+    {
+        robotData.turret.heatLimit = 100;
+        robotData.turret.coolingRate = 20;
+
+        ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(true));
+        ON_CALL(drivers.refSerial, getRobotDataGeneration)
+            .WillByDefault(ReturnPointee(&generation));
+        ON_CALL(drivers.refSerial, getRobotDataSnapshot)
+            .WillByDefault(
+                [&](RefSerialData::Rx::RobotData *snapshot)
+                {
+                    *snapshot = robotData;
+                    return generation;
+                });
+        generation++;
+    }
+
+    void refereeReportsHeat(uint16_t heat)
+    {
+        robotData.turret.heat17ID1 = heat;
+        generation++;
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    HeatLimitGovernor governor;
+    RefSerialData::Rx::RobotData robotData{};
+    uint32_t generation = 0;
+};
+
+TEST_F(HeatLimitGovernorTest, not_limited_without_referee)
+{
+    ON_CALL(drivers.refSerial, getRefSerialReceivingData).WillByDefault(Return(false));
+
+    for (int i = 0; i < 20; i++)
+    {
+        governor.onGovernedCommandInitialized();
+    }
+
+    EXPECT_TRUE(governor.isReady());
+    EXPECT_FALSE(governor.isFinished());
+}
+
+TEST_F(HeatLimitGovernorTest, burst_fires_up_to_limit_without_waiting_for_referee)
+{
+    int shots = 0;
+    while (governor.isReady() && shots < 100)
+    {
+        governor.onGovernedCommandInitialized();
+        EXPECT_FALSE(governor.isFinished());
+        shots++;
+    }
+
+    // (100 - 5) / 10 shots fit below the limit less the margin
+    EXPECT_EQ(9, shots);
+    EXPECT_EQ(0, governor.getShotsAvailable());
+    EXPECT_FLOAT_EQ(90, governor.getEstimatedHeat());
+}
+
+TEST_F(HeatLimitGovernorTest, heat_cools_at_referee_cooling_rate)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        governor.onGovernedCommandInitialized();
+    }
+    EXPECT_FALSE(governor.isReady());
+
+    clock.time += 100;
+    EXPECT_FLOAT_EQ(88, governor.getEstimatedHeat());
+    EXPECT_FALSE(governor.isReady());
+
+    clock.time += 150;
+    EXPECT_FLOAT_EQ(85, governor.getEstimatedHeat());
+    EXPECT_TRUE(governor.isReady());
+    EXPECT_EQ(1, governor.getShotsAvailable());
+}
+
+TEST_F(HeatLimitGovernorTest, referee_report_reconciled_with_shots_it_cannot_include)
+{
+    governor.onGovernedCommandInitialized();
+    clock.time += 200;
+    governor.onGovernedCommandInitialized();
+    clock.time += 50;
+
+    // The report includes the first shot but not the second, fired 50 ms ago, and the referee
+    // counted twice the heat for the first
+    refereeReportsHeat(20);
+    EXPECT_FLOAT_EQ(30, governor.getEstimatedHeat());
+}
+
+TEST_F(HeatLimitGovernorTest, referee_report_corrects_shots_that_did_not_fire)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        governor.onGovernedCommandInitialized();
+    }
+    clock.time += 200;
+
+    // Only three projectiles actually launched
+    refereeReportsHeat(26);
+    EXPECT_FLOAT_EQ(26, governor.getEstimatedHeat());
+}
+
+TEST_F(HeatLimitGovernorTest, unchanged_referee_heat_does_not_reset_model)
+{
+    refereeReportsHeat(40);
+    EXPECT_FLOAT_EQ(40, governor.getEstimatedHeat());
+
+    clock.time += 500;
+    governor.recordShot();
+    clock.time += 500;
+
+    // Other robot data arrives while heat still reads the old value
+    generation++;
+    EXPECT_FLOAT_EQ(40 - 10 + 10 - 10, governor.getEstimatedHeat());
+}
+
+TEST_F(HeatLimitGovernorTest, isFinished_once_over_limit)
+{
+    refereeReportsHeat(99);
+    EXPECT_FALSE(governor.isReady());
+    EXPECT_TRUE(governor.isFinished());
+}
+
+TEST_F(HeatLimitGovernorTest, shots_not_counted_from_commands_when_disabled)
+{
+    HeatLimitGovernor::Config config = CONFIG;
+    config.countGovernedCommands = false;
+    HeatLimitGovernor beamBreakGovernor(&drivers, config);
+
+    beamBreakGovernor.onGovernedCommandInitialized();
+    EXPECT_EQ(0, beamBreakGovernor.getEstimatedHeat());
+
+    beamBreakGovernor.recordShot();
+    EXPECT_EQ(10, beamBreakGovernor.getEstimatedHeat());
+}
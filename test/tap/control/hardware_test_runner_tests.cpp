@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <set>
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/hardware_test_runner.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/command_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::control;
+using namespace tap::mock;
+using namespace testing;
+using tap::Drivers;
+using Status = HardwareTestRunner::Status;
+
+class HardwareTestRunnerTest : public Test
+{
+protected:
+    HardwareTestRunnerTest()
+        : runner(&drivers),
+          s1(&drivers),
+          s2(&drivers),
+          s3(&drivers)
+    {
+    }
+
+    void SetUp() override
+    {
+        // c1 and c2 both require s1, c3 only requires s3
+        setUpTest(s1, c1, {&s1});
+        setUpTest(s2, c2, {&s1, &s2});
+        setUpTest(s3, c3, {&s3});
+
+        ON_CALL(drivers.commandScheduler, runHardwareTest)
+            .WillByDefault([&](const Subsystem* sub) { running.insert(sub); });
+        ON_CALL(drivers.commandScheduler, stopHardwareTest)
+            .WillByDefault([&](const Subsystem* sub) { running.erase(sub); });
+        ON_CALL(drivers.commandScheduler, isRunningTest)
+            .WillByDefault([&](const Subsystem* sub) { return running.count(sub) != 0; });
+        ON_CALL(drivers.commandScheduler, hasPassedTest)
+            .WillByDefault([&](const Subsystem* sub) { return passed.count(sub) != 0; });
+    }
+
+    void setUpTest(
+        NiceMock<SubsystemMock>& sub,
+        NiceMock<CommandMock>& cmd,
+        std::initializer_list<Subsystem*> requirements)
+    {
+        ON_CALL(sub, getTestCommand).WillByDefault(Return(&cmd));
+        subsystem_scheduler_bitmap_t requirementsBitwise;
+        for (Subsystem* requirement : requirements)
+        {
+            requirementsBitwise.set(requirement->getGlobalIdentifier());
+        }
+        ON_CALL(cmd, getRequirementsBitwise).WillByDefault(Return(requirementsBitwise));
+    }
+
+    /// Finishes the test of `sub` the way the scheduler does.
+    void pass(const Subsystem* sub)
+    {
+        running.erase(sub);
+        passed.insert(sub);
+    }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    HardwareTestRunner runner;
+    NiceMock<SubsystemMock> s1;
+    NiceMock<SubsystemMock> s2;
+    NiceMock<SubsystemMock> s3;
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    NiceMock<CommandMock> c3;
+    std::set<const Subsystem*> running;
+    std::set<const Subsystem*> passed;
+};
+
+TEST_F(HardwareTestRunnerTest, addTest_without_test_command_fails)
+{
+    ON_CALL(s1, getTestCommand).WillByDefault(Return(nullptr));
+
+    EXPECT_FALSE(runner.addTest(&s1));
+    EXPECT_EQ(0, runner.getNumTests());
+}
+
+TEST_F(HardwareTestRunnerTest, addTest_twice_updates_timeout)
+{
+    EXPECT_TRUE(runner.addTest(&s1, 100));
+    EXPECT_TRUE(runner.addTest(&s1, 200));
+
+    EXPECT_EQ(1, runner.getNumTests());
+    EXPECT_EQ(200u, runner.getResult(&s1)->timeoutMs);
+}
+
+TEST_F(HardwareTestRunnerTest, update_runs_tests_without_shared_requirements_concurrently)
+{
+    runner.addTest(&s1);
+    runner.addTest(&s2);
+    runner.addTest(&s3);
+
+    runner.start();
+    runner.update();
+
+    EXPECT_EQ(Status::RUNNING, runner.getResult(&s1)->status);
+    EXPECT_EQ(Status::PENDING, runner.getResult(&s2)->status);
+    EXPECT_EQ(Status::RUNNING, runner.getResult(&s3)->status);
+
+    clock.time = 30;
+    pass(&s1);
+    runner.update();
+
+    EXPECT_EQ(Status::PASSED, runner.getResult(&s1)->status);
+    EXPECT_EQ(30u, runner.getResult(&s1)->durationMs);
+    EXPECT_EQ(Status::RUNNING, runner.getResult(&s2)->status);
+    EXPECT_EQ(30u, runner.getResult(&s2)->startTime);
+
+    clock.time = 50;
+    pass(&s2);
+    pass(&s3);
+    runner.update();
+
+    EXPECT_FALSE(runner.isRunning());
+    EXPECT_EQ(3, runner.getNumPassed());
+    EXPECT_EQ(20u, runner.getResult(&s2)->durationMs);
+    EXPECT_EQ(50u, runner.getRunDurationMs());
+}
+
+TEST_F(HardwareTestRunnerTest, update_test_over_timeout_stopped_and_timed_out)
+{
+    runner.addTest(&s1, 100);
+    runner.start();
+    runner.update();
+
+    clock.time = 99;
+    runner.update();
+    EXPECT_EQ(Status::RUNNING, runner.getResult(&s1)->status);
+
+    EXPECT_CALL(drivers.commandScheduler, stopHardwareTest(&s1));
+    clock.time = 100;
+    runner.update();
+
+    EXPECT_EQ(Status::TIMED_OUT, runner.getResult(&s1)->status);
+    EXPECT_EQ(1, runner.getNumTimedOut());
+    EXPECT_EQ(1, runner.getResult(&s1)->numFailures);
+    EXPECT_FALSE(runner.isRunning());
+}
+
+TEST_F(HardwareTestRunnerTest, update_test_ended_without_passing_failed)
+{
+    runner.addTest(&s1);
+    runner.start();
+    runner.update();
+
+    running.erase(&s1);
+    runner.update();
+
+    EXPECT_EQ(Status::FAILED, runner.getResult(&s1)->status);
+    EXPECT_EQ(1, runner.getNumFailed());
+}
+
+TEST_F(HardwareTestRunnerTest, update_test_not_scheduled_failed)
+{
+    ON_CALL(drivers.commandScheduler, runHardwareTest).WillByDefault([](const Subsystem*) {});
+    runner.addTest(&s1);
+    runner.start();
+    runner.update();
+
+    EXPECT_EQ(Status::FAILED, runner.getResult(&s1)->status);
+    EXPECT_FALSE(runner.isRunning());
+}
+
+TEST_F(HardwareTestRunnerTest, start_clears_last_run_but_keeps_failure_count)
+{
+    runner.addTest(&s1, 10);
+    runner.start();
+    runner.update();
+    clock.time = 10;
+    runner.update();
+    ASSERT_EQ(Status::TIMED_OUT, runner.getResult(&s1)->status);
+
+    running.clear();
+    runner.start();
+
+    EXPECT_EQ(Status::PENDING, runner.getResult(&s1)->status);
+    EXPECT_EQ(0, runner.getNumTimedOut());
+    EXPECT_EQ(1, runner.getResult(&s1)->numFailures);
+}
+
+TEST_F(HardwareTestRunnerTest, stop_stops_running_tests)
+{
+    runner.addTest(&s1);
+    runner.addTest(&s2);
+    runner.start();
+    runner.update();
+
+    EXPECT_CALL(drivers.commandScheduler, stopHardwareTest(&s1));
+    runner.stop();
+
+    EXPECT_EQ(Status::STOPPED, runner.getResult(&s1)->status);
+    EXPECT_EQ(Status::STOPPED, runner.getResult(&s2)->status);
+    EXPECT_FALSE(runner.isRunning());
+}
+
+TEST_F(HardwareTestRunnerTest, terminalSerialCallback_report_prints_each_test)
+{
+    ON_CALL(s1, getName).WillByDefault(Return("chassis"));
+    runner.addTest(&s1);
+    runner.start();
+    runner.update();
+    clock.time = 42;
+    pass(&s1);
+    runner.update();
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    char input[] = "report";
+    EXPECT_TRUE(runner.terminalSerialCallback(input, stream, false));
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("1 passed"));
+    EXPECT_THAT(output, HasSubstr("passed\t42\t0\tchassis"));
+}
+
+TEST_F(HardwareTestRunnerTest, terminalSerialCallback_invalid_input_prints_usage)
+{
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    char input[] = "bogus";
+    EXPECT_FALSE(runner.terminalSerialCallback(input, stream, false));
+
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("Usage"));
+}
@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/control/hold_repeat_command_mapping.hpp"
 #include "tap/control/remote_map_state.hpp"
 #include "tap/drivers.hpp"
@@ -443,3 +444,127 @@ TEST(
     commandMapping.executeCommandMapping(ms);
     commandMapping.executeCommandMapping(ms);
 }
+
+// Repeating with a repeat period
+
+TEST(HoldRepeatCommandMapping, repeat_period_command_added_on_press_then_every_period)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false, -1, 100);
+
+    EXPECT_TRUE(commandMapping.isUpdatedEachTick());
+    EXPECT_TRUE(commandMapping.reactsOnlyToInputChanges());
+    ON_CALL(drivers.commandScheduler, isCommandScheduled).WillByDefault(Return(false));
+
+    clock.time = 1'000;
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(1);
+    commandMapping.executeCommandMapping(ms);
+    commandMapping.executeCommandMapping(ms);
+    clock.time = 1'099;
+    commandMapping.update();
+    Mock::VerifyAndClearExpectations(&drivers.commandScheduler);
+
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(2);
+    clock.time = 1'100;
+    commandMapping.update();
+    commandMapping.update();
+    clock.time = 1'200;
+    commandMapping.update();
+}
+
+TEST(HoldRepeatCommandMapping, repeat_period_late_update_skips_missed_periods)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false, -1, 100);
+
+    ON_CALL(drivers.commandScheduler, isCommandScheduled).WillByDefault(Return(false));
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(3);
+
+    commandMapping.executeCommandMapping(ms);
+    clock.time = 350;
+    commandMapping.update();
+    // Repeats stay aligned to when the mapping started being held
+    clock.time = 399;
+    commandMapping.update();
+    clock.time = 400;
+    commandMapping.update();
+}
+
+TEST(HoldRepeatCommandMapping, repeat_period_no_repeats_after_release)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false, -1, 100);
+
+    ON_CALL(drivers.commandScheduler, isCommandScheduled).WillByDefault(Return(false));
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(1);
+
+    commandMapping.executeCommandMapping(ms);
+    commandMapping.executeCommandMapping(RemoteMapState());
+    clock.time = 1'000;
+    commandMapping.update();
+}
+
+TEST(HoldRepeatCommandMapping, repeat_period_scheduled_command_skips_repeat)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false, -1, 100);
+
+    EXPECT_CALL(drivers.commandScheduler, isCommandScheduled)
+        .WillOnce(Return(false))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(2);
+
+    commandMapping.executeCommandMapping(ms);
+    clock.time = 100;
+    commandMapping.update();
+    clock.time = 200;
+    commandMapping.update();
+}
+
+TEST(HoldRepeatCommandMapping, repeat_period_maxTimesToSchedule_limits_repeats)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false, 3, 50);
+
+    ON_CALL(drivers.commandScheduler, isCommandScheduled).WillByDefault(Return(false));
+    EXPECT_CALL(drivers.commandScheduler, addCommand(&tc)).Times(3);
+
+    commandMapping.executeCommandMapping(ms);
+    for (clock.time = 1; clock.time < 500; clock.time++)
+    {
+        commandMapping.update();
+    }
+}
+
+TEST(HoldRepeatCommandMapping, no_repeat_period_not_updated_each_tick)
+{
+    Drivers drivers;
+    TestSubsystem ts(&drivers);
+    TestCommand tc(&ts);
+    RemoteMapState ms(Remote::Switch::LEFT_SWITCH, Remote::SwitchState::DOWN);
+    HoldRepeatCommandMapping commandMapping(&drivers, {&tc}, ms, false);
+
+    EXPECT_FALSE(commandMapping.isUpdatedEachTick());
+    EXPECT_FALSE(commandMapping.reactsOnlyToInputChanges());
+}
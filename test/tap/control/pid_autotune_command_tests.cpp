@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <deque>
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/pid_autotune_command.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/motor_interface_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::algorithms;
+using namespace tap::control;
+using namespace tap::mock;
+using namespace testing;
+using tap::arch::clock::ClockStub;
+
+class PidAutotuneCommandTest : public Test
+{
+protected:
+    PidAutotuneCommandTest() : subsystem(&drivers) {}
+
+    void SetUp() override
+    {
+        ON_CALL(subsystem, getGlobalIdentifier).WillByDefault(Return(2));
+        ON_CALL(motor, isMotorOnline).WillByDefault(Return(true));
+        ON_CALL(motor, getShaftRPM).WillByDefault([&] { return static_cast<int16_t>(rpm); });
+        ON_CALL(motor, setDesiredOutput).WillByDefault([&](int32_t out) { output = out; });
+        config.outputBias = 1'000;
+        config.relayAmplitude = 500;
+    }
+
+    static void storeGains(const PidGains &gains, void *context)
+    {
+        *static_cast<PidGains *>(context) = gains;
+    }
+
+    /// Runs the command on a motor whose rpm integrates its output, with a 20 ms delay.
+    void runToCompletion(PidAutotuneCommand &command)
+    {
+        std::deque<int32_t> delayed(20, 0);
+        command.initialize();
+        for (int i = 0; i < 10'000 && !command.isFinished(); i++)
+        {
+            clock.time++;
+            delayed.push_back(output);
+            rpm += (delayed.front() - 1'000) * 0.01f;
+            delayed.pop_front();
+            command.execute();
+        }
+        command.end(false);
+    }
+
+    ClockStub clock;
+    tap::Drivers drivers;
+    NiceMock<SubsystemMock> subsystem;
+    NiceMock<MotorInterfaceMock> motor;
+    RelayAutotunerConfig config;
+    float rpm = 0;
+    int32_t output = 0;
+};
+
+TEST_F(PidAutotuneCommandTest, requires_subsystem)
+{
+    PidAutotuneCommand command(
+        &subsystem,
+        &motor,
+        PidAutotuneCommand::Measurement::SHAFT_RPM,
+        0,
+        config,
+        TuningRule::SIMC_PI,
+        nullptr);
+
+    EXPECT_EQ(1u << 2, command.getRequirementsBitwise());
+}
+
+TEST_F(PidAutotuneCommandTest, not_ready_when_motor_offline)
+{
+    ON_CALL(motor, isMotorOnline).WillByDefault(Return(false));
+    PidAutotuneCommand command(
+        &subsystem,
+        &motor,
+        PidAutotuneCommand::Measurement::SHAFT_RPM,
+        0,
+        config,
+        TuningRule::SIMC_PI,
+        nullptr);
+
+    EXPECT_FALSE(command.isReady());
+}
+
+TEST_F(PidAutotuneCommandTest, relay_tunes_motor_and_passes_gains_to_callback)
+{
+    PidGains gains;
+    PidAutotuneCommand command(
+        &subsystem,
+        &motor,
+        PidAutotuneCommand::Measurement::SHAFT_RPM,
+        100,
+        config,
+        TuningRule::SIMC_PI,
+        storeGains,
+        &gains);
+
+    runToCompletion(command);
+
+    ASSERT_EQ(RelayAutotuner::State::DONE, command.getAutotuner().getState());
+    EXPECT_NEAR(0.08f, command.getAutotuner().getUltimatePeriod(), 0.005f);
+    EXPECT_GT(gains.kp, 0);
+    EXPECT_FLOAT_EQ(command.getAutotuner().computeGains(TuningRule::SIMC_PI).kp, gains.kp);
+    EXPECT_EQ(0, output);
+}
+
+TEST_F(PidAutotuneCommandTest, callback_not_called_when_motor_disconnects)
+{
+    PidGains gains;
+    gains.kp = -1;
+    PidAutotuneCommand command(
+        &subsystem,
+        &motor,
+        PidAutotuneCommand::Measurement::SHAFT_RPM,
+        100,
+        config,
+        TuningRule::SIMC_PI,
+        storeGains,
+        &gains);
+
+    command.initialize();
+    command.execute();
+    ON_CALL(motor, isMotorOnline).WillByDefault(Return(false));
+
+    EXPECT_TRUE(command.isFinished());
+    command.end(false);
+    EXPECT_FLOAT_EQ(-1, gains.kp);
+}
@@ -381,3 +381,27 @@ TEST(RemoteMapState, stateSubsetOf_false_right_switches_different)
     EXPECT_FALSE(ms1.stateSubsetOf(ms2));
     EXPECT_FALSE(ms2.stateSubsetOf(ms1));
 }
+
+TEST(RemoteMapState, constructors_are_constexpr)
+{
+    static constexpr RemoteMapState keys({Remote::Key::W, Remote::Key::SHIFT}, {Remote::Key::CTRL});
+    static constexpr RemoteMapState mouse(RemoteMapState::MouseButton::RIGHT, {Remote::Key::E});
+    static constexpr RemoteMapState all(
+        Remote::SwitchState::UP,
+        Remote::SwitchState::DOWN,
+        {Remote::Key::Q},
+        {Remote::Key::Q, Remote::Key::B},
+        true,
+        false);
+
+    static_assert(keys.getKeys() == 0b10001);
+    static_assert(keys.getNegKeys() == 0b100000);
+    static_assert(mouse.getRMouseButton() && !mouse.getLMouseButton());
+    static_assert(mouse.getKeys() == RemoteMapState::keysToBitmask({Remote::Key::E}));
+    // Neg keys overlapping the keys aren't initialized, as at runtime
+    static_assert(all.getKeys() == 1 << static_cast<int>(Remote::Key::Q));
+    static_assert(!all.getNegKeysUsed());
+    static_assert(all.getLSwitch() == Remote::SwitchState::UP);
+
+    EXPECT_EQ(RemoteMapState({Remote::Key::W, Remote::Key::SHIFT}, {Remote::Key::CTRL}), keys);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include "tap/control/command_scheduler.hpp"
+#include "tap/control/scheduler_partition.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/command_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::control;
+using namespace tap::mock;
+using namespace testing;
+using tap::Drivers;
+
+static subsystem_scheduler_bitmap_t requirementsOf(Subsystem *sub)
+{
+    subsystem_scheduler_bitmap_t requirements;
+    requirements.set(sub->getGlobalIdentifier());
+    return requirements;
+}
+
+class SchedulerPartitionTest : public Test
+{
+protected:
+    SchedulerPartitionTest() : partition(&drivers, "turret"), turret(&drivers) {}
+
+    void SetUp() override
+    {
+        ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(requirementsOf(&turret)));
+        ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(requirementsOf(&turret)));
+        partition.registerSubsystem(&turret);
+    }
+
+    Drivers drivers;
+    SchedulerPartition partition;
+    NiceMock<SubsystemMock> turret;
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+};
+
+TEST_F(SchedulerPartitionTest, run_refreshes_registered_subsystems)
+{
+    EXPECT_CALL(turret, refresh).Times(2);
+
+    partition.run();
+    partition.run();
+}
+
+TEST_F(SchedulerPartitionTest, master_scheduler_run_does_not_refresh_partition_subsystems)
+{
+    CommandScheduler master(&drivers, true);
+
+    EXPECT_CALL(turret, refresh).Times(0);
+
+    master.run();
+}
+
+TEST_F(SchedulerPartitionTest, run_adds_default_command_of_partition_subsystem)
+{
+    ON_CALL(turret, getDefaultCommand).WillByDefault(Return(&c1));
+
+    EXPECT_CALL(c1, initialize);
+
+    partition.run();
+
+    EXPECT_TRUE(partition.getScheduler().isCommandScheduled(&c1));
+}
+
+TEST_F(SchedulerPartitionTest, requestAddCommand_handled_on_next_run)
+{
+    partition.requestAddCommand(&c1);
+
+    EXPECT_TRUE(partition.hasPendingRequests());
+    EXPECT_FALSE(partition.getScheduler().isCommandScheduled(&c1));
+
+    EXPECT_CALL(c1, initialize);
+    EXPECT_CALL(c1, execute);
+
+    partition.run();
+
+    EXPECT_FALSE(partition.hasPendingRequests());
+    EXPECT_TRUE(partition.getScheduler().isCommandScheduled(&c1));
+}
+
+TEST_F(SchedulerPartitionTest, repeated_requests_handled_once)
+{
+    EXPECT_CALL(c1, initialize).Times(1);
+
+    partition.requestAddCommand(&c1);
+    partition.requestAddCommand(&c1);
+    partition.run();
+}
+
+TEST_F(SchedulerPartitionTest, requestRemoveCommand_handled_before_additions)
+{
+    partition.requestAddCommand(&c1);
+    partition.run();
+
+    {
+        InSequence seq;
+        EXPECT_CALL(c1, end(true));
+        EXPECT_CALL(c2, initialize);
+    }
+
+    partition.requestAddCommand(&c2);
+    partition.requestRemoveCommand(&c1);
+    partition.run();
+
+    EXPECT_FALSE(partition.getScheduler().isCommandScheduled(&c1));
+    EXPECT_TRUE(partition.getScheduler().isCommandScheduled(&c2));
+}
+
+TEST_F(SchedulerPartitionTest, add_then_remove_request_before_run_leaves_command_removed)
+{
+    EXPECT_CALL(c1, initialize).Times(0);
+
+    partition.requestAddCommand(&c1);
+    partition.requestRemoveCommand(&c1);
+    partition.run();
+
+    EXPECT_FALSE(partition.getScheduler().isCommandScheduled(&c1));
+}
+
+TEST_F(SchedulerPartitionTest, remove_then_add_request_before_run_leaves_command_added)
+{
+    partition.requestAddCommand(&c1);
+    partition.run();
+
+    partition.requestRemoveCommand(&c1);
+    partition.requestAddCommand(&c1);
+    partition.run();
+
+    EXPECT_TRUE(partition.getScheduler().isCommandScheduled(&c1));
+}
+
+TEST_F(SchedulerPartitionTest, requests_from_other_thread_not_lost)
+{
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<SubsystemMock> s2(&drivers);
+    NiceMock<SubsystemMock> s3(&drivers);
+    NiceMock<SubsystemMock> s4(&drivers);
+    Subsystem *subs[] = {&s1, &s2, &s3, &s4};
+    NiceMock<CommandMock> commands[4];
+    for (int i = 0; i < 4; i++)
+    {
+        ON_CALL(commands[i], getRequirementsBitwise)
+            .WillByDefault(Return(requirementsOf(subs[i])));
+        partition.registerSubsystem(subs[i]);
+    }
+
+    std::thread requester(
+        [&]()
+        {
+            for (NiceMock<CommandMock> &command : commands)
+            {
+                partition.requestAddCommand(&command);
+            }
+        });
+    while (partition.getScheduler().commandListSize() < 4)
+    {
+        partition.run();
+    }
+    requester.join();
+
+    for (NiceMock<CommandMock> &command : commands)
+    {
+        EXPECT_TRUE(partition.getScheduler().isCommandScheduled(&command));
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gmock/gmock.h>
+
+#include "tap/control/command_scheduler.hpp"
+#include "tap/control/scheduler_profile.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/command_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::control;
+using namespace tap::mock;
+using namespace testing;
+using tap::Drivers;
+
+static subsystem_scheduler_bitmap_t requirementsOf(std::initializer_list<Subsystem *> subsystems)
+{
+    subsystem_scheduler_bitmap_t requirements;
+    for (Subsystem *sub : subsystems)
+    {
+        requirements.set(sub->getGlobalIdentifier());
+    }
+    return requirements;
+}
+
+class SchedulerProfileTest : public Test
+{
+protected:
+    SchedulerProfileTest() : scheduler(&drivers, true), s1(&drivers), s2(&drivers), s3(&drivers)
+    {
+    }
+
+    void SetUp() override
+    {
+        ON_CALL(c1, getRequirementsBitwise).WillByDefault(Return(requirementsOf({&s1})));
+        ON_CALL(c2, getRequirementsBitwise).WillByDefault(Return(requirementsOf({&s2})));
+        ON_CALL(c3, getRequirementsBitwise).WillByDefault(Return(requirementsOf({&s1, &s3})));
+
+        scheduler.registerSubsystem(&s1);
+        scheduler.registerSubsystem(&s2);
+        scheduler.registerSubsystem(&s3);
+    }
+
+    Drivers drivers;
+    CommandScheduler scheduler;
+    NiceMock<SubsystemMock> s1;
+    NiceMock<SubsystemMock> s2;
+    NiceMock<SubsystemMock> s3;
+    NiceMock<CommandMock> c1;
+    NiceMock<CommandMock> c2;
+    NiceMock<CommandMock> c3;
+    NiceMock<CommandMock> defaultCommand;
+};
+
+TEST_F(SchedulerProfileTest, addCommand_with_conflicting_requirements_rejected)
+{
+    SchedulerProfile profile("profile");
+
+    EXPECT_TRUE(profile.addCommand(&c1));
+    EXPECT_FALSE(profile.addCommand(&c3));
+    EXPECT_FALSE(profile.addCommand(nullptr));
+
+    EXPECT_TRUE(profile.containsCommand(&c1));
+    EXPECT_FALSE(profile.containsCommand(&c3));
+    EXPECT_EQ(requirementsOf({&s1}), profile.getRequirementsBitwise());
+}
+
+TEST_F(SchedulerProfileTest, switchToProfile_adds_profile_commands)
+{
+    SchedulerProfile profile("match");
+    profile.addCommand(&c1);
+    profile.addCommand(&c2);
+
+    EXPECT_CALL(c1, initialize);
+    EXPECT_CALL(c2, initialize);
+
+    scheduler.switchToProfile(profile);
+
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c2));
+    EXPECT_EQ(&profile, scheduler.getActiveProfile());
+}
+
+TEST_F(SchedulerProfileTest, switchToProfile_shared_commands_not_ended_or_initialized_again)
+{
+    SchedulerProfile match("match");
+    match.addCommand(&c1);
+    match.addCommand(&c2);
+    SchedulerProfile test("test");
+    test.addCommand(&c2);
+    scheduler.switchToProfile(match);
+
+    EXPECT_CALL(c1, end(true));
+    EXPECT_CALL(c2, end).Times(0);
+    EXPECT_CALL(c2, initialize).Times(0);
+
+    scheduler.switchToProfile(test);
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c2));
+}
+
+TEST_F(SchedulerProfileTest, switchToProfile_ends_commands_not_in_profile_before_adding)
+{
+    SchedulerProfile first("first");
+    first.addCommand(&c1);
+    SchedulerProfile second("second");
+    second.addCommand(&c3);
+    scheduler.switchToProfile(first);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(c1, end(true));
+        EXPECT_CALL(c3, initialize);
+    }
+
+    scheduler.switchToProfile(second);
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c1));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c3));
+}
+
+TEST_F(SchedulerProfileTest, switchToProfile_keeps_default_command_of_unaffected_subsystem)
+{
+    ON_CALL(defaultCommand, getRequirementsBitwise).WillByDefault(Return(requirementsOf({&s2})));
+    ON_CALL(s2, getDefaultCommand).WillByDefault(Return(&defaultCommand));
+    scheduler.addCommand(&defaultCommand);
+    SchedulerProfile profile("profile");
+    profile.addCommand(&c1);
+
+    EXPECT_CALL(defaultCommand, end).Times(0);
+
+    scheduler.switchToProfile(profile);
+
+    EXPECT_TRUE(scheduler.isCommandScheduled(&defaultCommand));
+    EXPECT_TRUE(scheduler.isCommandScheduled(&c1));
+}
+
+TEST_F(SchedulerProfileTest, switchToProfile_ends_non_default_command_of_unaffected_subsystem)
+{
+    scheduler.addCommand(&c2);
+    SchedulerProfile profile("profile");
+    profile.addCommand(&c1);
+
+    EXPECT_CALL(c2, end(true));
+
+    scheduler.switchToProfile(profile);
+
+    EXPECT_FALSE(scheduler.isCommandScheduled(&c2));
+}
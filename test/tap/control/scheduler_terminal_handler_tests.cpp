@@ -221,3 +221,62 @@ TEST(SchedulerTerminalHandler, terminalSerialStreamCallback__repeatedly_prints_c
     EXPECT_THAT(output, HasSubstr("s1"));
     EXPECT_THAT(output, HasSubstr("s2"));
 }
+
+TEST(SchedulerTerminalHandler, terminalSerialCallback__timing_reports_accounting_disabled)
+{
+    Drivers drivers;
+    SchedulerTerminalHandler serialHandler(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    ON_CALL(drivers.commandScheduler, isExecutionTimeAccountingEnabled)
+        .WillByDefault(Return(false));
+
+    char input[] = "timing";
+    EXPECT_TRUE(serialHandler.terminalSerialCallback(input, stream, false));
+
+    EXPECT_THAT(
+        terminalDevice.readAllItemsFromWriteBufferToString(),
+        HasSubstr("Execution time accounting disabled"));
+}
+
+TEST(SchedulerTerminalHandler, terminalSerialCallback__timing_prints_subsystem_and_command_stats)
+{
+    Drivers drivers;
+    SchedulerTerminalHandler serialHandler(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    NiceMock<SubsystemMock> s1(&drivers);
+    NiceMock<CommandMock> c1;
+    ON_CALL(s1, getName).WillByDefault(Return("sub1"));
+    ON_CALL(c1, getName).WillByDefault(Return("cmd1"));
+
+    CommandScheduler::resetExecutionTimeStats();
+
+    ON_CALL(drivers.commandScheduler, isExecutionTimeAccountingEnabled)
+        .WillByDefault(Return(true));
+    ON_CALL(drivers.commandScheduler, cmdMapBegin).WillByDefault([&]() {
+        return drivers.commandScheduler.CommandScheduler::cmdMapBegin();
+    });
+    ON_CALL(drivers.commandScheduler, cmdMapEnd).WillByDefault([&]() {
+        return drivers.commandScheduler.CommandScheduler::cmdMapEnd();
+    });
+    ON_CALL(drivers.commandScheduler, subMapBegin).WillByDefault([&]() {
+        return drivers.commandScheduler.CommandScheduler::subMapBegin();
+    });
+    ON_CALL(drivers.commandScheduler, subMapEnd).WillByDefault([&]() {
+        return drivers.commandScheduler.CommandScheduler::subMapEnd();
+    });
+    ON_CALL(c1, getRequirementsBitwise)
+        .WillByDefault(Return(1UL << s1.getGlobalIdentifier()));
+    drivers.commandScheduler.CommandScheduler::registerSubsystem(&s1);
+    drivers.commandScheduler.CommandScheduler::addCommand(&c1);
+
+    char input[] = "timing";
+    EXPECT_TRUE(serialHandler.terminalSerialCallback(input, stream, false));
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("sub1: no data"));
+    EXPECT_THAT(output, HasSubstr("cmd1: no data"));
+}
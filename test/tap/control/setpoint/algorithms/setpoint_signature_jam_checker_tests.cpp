@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/setpoint/algorithms/setpoint_signature_jam_checker.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/setpoint_subsystem_mock.hpp"
+
+using namespace tap::arch::clock;
+using namespace tap::control::setpoint;
+using tap::Drivers;
+using namespace tap::mock;
+using namespace testing;
+
+static constexpr SetpointSignatureJamChecker::Config CONFIG = {
+    .distanceTolerance = 0.5f,
+    .temporalTolerance = 200,
+    .torqueThreshold = 5000,
+    .velocityThreshold = 0.1f,
+    .signatureTime = 5,
+};
+
+class SetpointSignatureJamCheckerTest : public Test
+{
+protected:
+    SetpointSignatureJamCheckerTest() : subsystem(&drivers), jamChecker(&subsystem, CONFIG) {}
+
+    void SetUp() override
+    {
+        ON_CALL(subsystem, getSetpoint).WillByDefault(ReturnPointee(&setpoint));
+        ON_CALL(subsystem, getCurrentValue).WillByDefault(Return(0));
+        ON_CALL(subsystem, getTorque).WillByDefault(ReturnPointee(&torque));
+        ON_CALL(subsystem, getVelocity).WillByDefault(ReturnPointee(&velocity));
+
+        jamChecker.restart();
+    }
+
+    /// @return Whether `jamChecker` reported a jam on any check every ms for `time` ms.
+    bool checkFor(uint32_t time)
+    {
+        bool jammed = false;
+        for (uint32_t i = 0; i < time; i++)
+        {
+            clock.time++;
+            jammed |= jamChecker.check();
+        }
+        return jammed;
+    }
+
+    ClockStub clock;
+    Drivers drivers;
+    NiceMock<SetpointSubsystemMock> subsystem;
+    SetpointSignatureJamChecker jamChecker;
+    float setpoint = 0;
+    float torque = 0;
+    float velocity = 0;
+};
+
+TEST_F(SetpointSignatureJamCheckerTest, stall_towards_setpoint_detected_within_signature_time)
+{
+    setpoint = 2;
+    torque = 8000;
+
+    EXPECT_FALSE(checkFor(4));
+    EXPECT_TRUE(checkFor(1));
+}
+
+TEST_F(SetpointSignatureJamCheckerTest, brief_spike_when_starting_not_a_jam)
+{
+    setpoint = 2;
+    torque = 8000;
+    EXPECT_FALSE(checkFor(3));
+
+    velocity = 1;
+    EXPECT_FALSE(checkFor(100));
+}
+
+TEST_F(SetpointSignatureJamCheckerTest, torque_away_from_setpoint_not_a_jam)
+{
+    setpoint = -2;
+    torque = 8000;
+
+    EXPECT_FALSE(checkFor(100));
+}
+
+TEST_F(SetpointSignatureJamCheckerTest, holding_within_tolerance_not_a_jam)
+{
+    setpoint = 0.4f;
+    torque = 8000;
+
+    EXPECT_FALSE(checkFor(500));
+}
+
+TEST_F(SetpointSignatureJamCheckerTest, low_torque_stall_detected_after_temporal_tolerance)
+{
+    setpoint = 2;
+    torque = 1000;
+
+    EXPECT_FALSE(checkFor(199));
+    EXPECT_TRUE(checkFor(1));
+}
+
+TEST_F(SetpointSignatureJamCheckerTest, getJamSetpointTolerance_returns_distance_tolerance)
+{
+    EXPECT_EQ(CONFIG.distanceTolerance, jamChecker.getJamSetpointTolerance());
+}
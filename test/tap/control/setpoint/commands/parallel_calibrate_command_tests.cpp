@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/setpoint/commands/parallel_calibrate_command.hpp"
+#include "tap/control/setpoint/interfaces/calibration_cache.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/setpoint_subsystem_mock.hpp"
+
+using namespace tap::control::setpoint;
+using tap::Drivers;
+using tap::control::subsystem_scheduler_bitmap_t;
+using namespace tap::mock;
+using namespace testing;
+
+using AxisState = ParallelCalibrateCommand::AxisState;
+
+class CalibrationCacheStub : public CalibrationCache
+{
+public:
+    bool load(const char *key, float *calibration) override
+    {
+        auto entry = calibrations.find(key);
+        if (entry == calibrations.end())
+        {
+            return false;
+        }
+        *calibration = entry->second;
+        return true;
+    }
+
+    void save(const char *key, float calibration) override { calibrations[key] = calibration; }
+
+    std::map<std::string, float> calibrations;
+};
+
+class ParallelCalibrateCommandTest : public Test
+{
+protected:
+    static constexpr int NUM_AXES = 3;
+
+    ParallelCalibrateCommandTest()
+        : subsystems{
+              NiceMock<SetpointSubsystemMock>(&drivers),
+              NiceMock<SetpointSubsystemMock>(&drivers),
+              NiceMock<SetpointSubsystemMock>(&drivers)}
+    {
+        for (int i = 0; i < NUM_AXES; i++)
+        {
+            ON_CALL(subsystems[i], getGlobalIdentifier).WillByDefault(Return(i));
+            ON_CALL(subsystems[i], getCurrentValue).WillByDefault(ReturnPointee(&values[i]));
+            ON_CALL(subsystems[i], getVelocity).WillByDefault(ReturnPointee(&velocities[i]));
+            ON_CALL(subsystems[i], calibrateHere).WillByDefault(Return(true));
+            axes[i] = {
+                .subsystem = &subsystems[i],
+                .cacheKey = nullptr,
+                .conflicts = {},
+                .homingVelocity = -1,
+                .maxLead = 0.1f,
+                .stallVelocity = 0.05f,
+                .stallTorque = 0,
+                .stallTime = 100,
+                .timeout = 1'000,
+            };
+        }
+    }
+
+    /// Executes the command once a millisecond for `ms` milliseconds.
+    void run(ParallelCalibrateCommand &command, uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; i++)
+        {
+            clock.time++;
+            command.execute();
+        }
+    }
+
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    NiceMock<SetpointSubsystemMock> subsystems[NUM_AXES];
+    float values[NUM_AXES] = {};
+    float velocities[NUM_AXES] = {-1, -1, -1};
+    ParallelCalibrateCommand::Axis axes[NUM_AXES];
+    CalibrationCacheStub cache;
+};
+
+TEST_F(ParallelCalibrateCommandTest, requires_axes_and_their_conflicts)
+{
+    axes[0].conflicts = subsystem_scheduler_bitmap_t::oneHot(5);
+
+    ParallelCalibrateCommand command(axes, 2);
+
+    EXPECT_EQ(subsystem_scheduler_bitmap_t(0b100011), command.getRequirementsBitwise());
+}
+
+TEST_F(ParallelCalibrateCommandTest, not_ready_if_any_subsystem_offline)
+{
+    ParallelCalibrateCommand command(axes, NUM_AXES);
+    EXPECT_TRUE(command.isReady());
+
+    ON_CALL(subsystems[2], isOnline).WillByDefault(Return(false));
+
+    EXPECT_FALSE(command.isReady());
+}
+
+TEST_F(ParallelCalibrateCommandTest, non_conflicting_axes_home_at_once)
+{
+    ParallelCalibrateCommand command(axes, NUM_AXES);
+
+    command.initialize();
+
+    for (int i = 0; i < NUM_AXES; i++)
+    {
+        EXPECT_EQ(AxisState::HOMING, command.getAxisState(i));
+    }
+}
+
+TEST_F(ParallelCalibrateCommandTest, conflicting_axis_waits_for_axis_being_homed)
+{
+    axes[1].conflicts = subsystem_scheduler_bitmap_t::oneHot(0);
+    ParallelCalibrateCommand command(axes, NUM_AXES);
+    command.initialize();
+
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(0));
+    EXPECT_EQ(AxisState::WAITING, command.getAxisState(1));
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(2));
+
+    velocities[0] = 0;
+    run(command, 100);
+
+    EXPECT_EQ(AxisState::CALIBRATED, command.getAxisState(0));
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(1));
+    EXPECT_FALSE(command.isFinished());
+}
+
+TEST_F(ParallelCalibrateCommandTest, setpoint_moves_towards_stop_limited_by_max_lead)
+{
+    ParallelCalibrateCommand command(axes, 1);
+    values[0] = 2;
+    command.initialize();
+
+    EXPECT_CALL(subsystems[0], setSetpoint).Times(AnyNumber());
+    EXPECT_CALL(subsystems[0], setSetpoint(FloatNear(1.999f, 1e-5f)));
+    run(command, 1);
+
+    EXPECT_CALL(subsystems[0], setSetpoint(FloatNear(1.9f, 1e-5f))).Times(AtLeast(1));
+    run(command, 200);
+}
+
+TEST_F(ParallelCalibrateCommandTest, stalled_axis_calibrated_after_stall_time)
+{
+    ParallelCalibrateCommand command(axes, 1);
+    command.initialize();
+    run(command, 50);
+
+    velocities[0] = 0;
+    EXPECT_CALL(subsystems[0], calibrateHere).Times(0);
+    run(command, 100);
+    Mock::VerifyAndClearExpectations(&subsystems[0]);
+
+    EXPECT_CALL(subsystems[0], calibrateHere).WillOnce(Return(true));
+    run(command, 1);
+
+    EXPECT_EQ(AxisState::CALIBRATED, command.getAxisState(0));
+    EXPECT_TRUE(command.isFinished());
+    EXPECT_TRUE(command.allCalibrated());
+}
+
+TEST_F(ParallelCalibrateCommandTest, stall_requires_torque_above_threshold)
+{
+    axes[0].stallTorque = 1;
+    ParallelCalibrateCommand command(axes, 1);
+    velocities[0] = 0;
+    command.initialize();
+
+    run(command, 200);
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(0));
+
+    ON_CALL(subsystems[0], getTorque).WillByDefault(Return(-2));
+    run(command, 101);
+    EXPECT_EQ(AxisState::CALIBRATED, command.getAxisState(0));
+}
+
+TEST_F(ParallelCalibrateCommandTest, axis_fails_if_not_stalled_before_timeout)
+{
+    ParallelCalibrateCommand command(axes, 1);
+    command.initialize();
+
+    run(command, 999);
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(0));
+
+    run(command, 1);
+    EXPECT_EQ(AxisState::FAILED, command.getAxisState(0));
+    EXPECT_TRUE(command.isFinished());
+    EXPECT_FALSE(command.allCalibrated());
+}
+
+TEST_F(ParallelCalibrateCommandTest, homed_axis_saves_calibration_to_cache)
+{
+    axes[0].cacheKey = "pitch.home";
+    ON_CALL(subsystems[0], getCalibration).WillByDefault(DoAll(SetArgPointee<0>(42), Return(true)));
+    ParallelCalibrateCommand command(axes, 1, &cache);
+    velocities[0] = 0;
+    command.initialize();
+
+    run(command, 100);
+
+    EXPECT_EQ(42, cache.calibrations["pitch.home"]);
+}
+
+TEST_F(ParallelCalibrateCommandTest, trusted_axis_restored_from_cache_without_homing)
+{
+    axes[0].cacheKey = "pitch.home";
+    axes[1].cacheKey = "yaw.home";
+    cache.calibrations["pitch.home"] = 42;
+    cache.calibrations["yaw.home"] = 7;
+    ON_CALL(subsystems[0], isAbsolutePositionTrusted).WillByDefault(Return(true));
+    ParallelCalibrateCommand command(axes, 2, &cache);
+
+    EXPECT_CALL(subsystems[0], restoreCalibration(42)).WillOnce(Return(true));
+    EXPECT_CALL(subsystems[1], restoreCalibration).Times(0);
+    command.initialize();
+
+    EXPECT_EQ(AxisState::RESTORED, command.getAxisState(0));
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(1));
+}
+
+TEST_F(ParallelCalibrateCommandTest, axis_homed_if_cached_calibration_not_restored)
+{
+    axes[0].cacheKey = "pitch.home";
+    cache.calibrations["pitch.home"] = 42;
+    ON_CALL(subsystems[0], isAbsolutePositionTrusted).WillByDefault(Return(true));
+    ON_CALL(subsystems[0], restoreCalibration).WillByDefault(Return(false));
+    ParallelCalibrateCommand command(axes, 1, &cache);
+
+    command.initialize();
+
+    EXPECT_EQ(AxisState::HOMING, command.getAxisState(0));
+}
+
+TEST_F(ParallelCalibrateCommandTest, end_stops_axes_being_homed)
+{
+    ParallelCalibrateCommand command(axes, 1);
+    values[0] = 3;
+    command.initialize();
+    run(command, 10);
+
+    EXPECT_CALL(subsystems[0], setSetpoint(3));
+    command.end(true);
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/setpoint/commands/profiled_move_command.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/setpoint_subsystem_mock.hpp"
+
+using namespace tap::arch::clock;
+using namespace tap::control::setpoint;
+using tap::Drivers;
+using namespace tap::mock;
+using namespace testing;
+
+#define CREATE_COMMON_TEST_OBJECTS() \
+    ClockStub clock;                 \
+    Drivers drivers;                 \
+    NiceMock<SetpointSubsystemMock> subsystem(&drivers);
+
+// Trapezoid that takes 2 s to accelerate, 3 s to cruise and 2 s to decelerate over 10 units
+static constexpr ProfiledMoveCommand::Config RELATIVE_CONFIG = {
+    .target = 10,
+    .relative = true,
+    .constraints = {.maxVelocity = 2, .maxAcceleration = 1},
+    .setpointTolerance = 0.1f,
+    .pauseAfterMoveTime = 50,
+    .setSetpointToTargetOnEnd = true,
+};
+
+TEST(ProfiledMoveCommand, command_registers_subsystem_requirements)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    EXPECT_CALL(subsystem, getGlobalIdentifier).Times(AtLeast(1)).WillRepeatedly(Return(3));
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+
+    EXPECT_EQ(command.getRequirementsBitwise(), (1U << 3));
+}
+
+TEST(ProfiledMoveCommand, command_not_ready_when_subsystem_jammed_or_offline)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+
+    EXPECT_TRUE(command.isReady());
+
+    ON_CALL(subsystem, isJammed).WillByDefault(Return(true));
+    EXPECT_FALSE(command.isReady());
+
+    ON_CALL(subsystem, isJammed).WillByDefault(Return(false));
+    ON_CALL(subsystem, isOnline).WillByDefault(Return(false));
+    EXPECT_FALSE(command.isReady());
+}
+
+TEST(ProfiledMoveCommand, relative_command_follows_profile_from_current_setpoint)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+    ON_CALL(subsystem, getSetpoint).WillByDefault(Return(1));
+
+    command.initialize();
+
+    EXPECT_CALL(subsystem, setSetpoint(FloatEq(1.5f)));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(FloatEq(1), FloatEq(1)));
+    clock.time = 1000;
+    command.execute();
+
+    EXPECT_CALL(subsystem, setSetpoint(FloatEq(6)));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(FloatEq(2), FloatEq(0)));
+    clock.time = 3500;
+    command.execute();
+
+    EXPECT_CALL(subsystem, setSetpoint(FloatEq(11)));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(0, 0));
+    clock.time = 7000;
+    command.execute();
+}
+
+TEST(ProfiledMoveCommand, absolute_command_moves_to_target)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand::Config config = RELATIVE_CONFIG;
+    config.relative = false;
+    ProfiledMoveCommand command(&subsystem, config);
+    ON_CALL(subsystem, getSetpoint).WillByDefault(Return(20));
+
+    command.initialize();
+
+    EXPECT_FLOAT_EQ(20, command.getProfile().getStart());
+    EXPECT_FLOAT_EQ(10, command.getProfile().getEnd());
+    EXPECT_FLOAT_EQ(7, command.getProfile().getDuration());
+}
+
+TEST(ProfiledMoveCommand, profile_paused_while_subsystem_jammed)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+    ON_CALL(subsystem, getCurrentValue).WillByDefault(Return(0.3f));
+
+    command.initialize();
+
+    ON_CALL(subsystem, isJammed).WillByDefault(Return(true));
+    EXPECT_CALL(subsystem, setSetpoint(FloatEq(0.3f)));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(0, 0));
+    clock.time = 5000;
+    command.execute();
+    EXPECT_TRUE(command.isFinished());
+
+    ON_CALL(subsystem, isJammed).WillByDefault(Return(false));
+    EXPECT_CALL(subsystem, setSetpoint(FloatEq(0.5f)));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(FloatEq(1), FloatEq(1)));
+    clock.time = 6000;
+    command.execute();
+}
+
+TEST(ProfiledMoveCommand, finished_after_profile_ends_within_tolerance_and_pause)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+    float currentValue = 0;
+    ON_CALL(subsystem, getCurrentValue).WillByDefault(ReturnPointee(&currentValue));
+
+    command.initialize();
+
+    // Within tolerance of the end before the profile is complete
+    currentValue = 9.95f;
+    clock.time = 6900;
+    command.execute();
+    EXPECT_FALSE(command.isFinished());
+
+    // Profile complete but subsystem lagging
+    currentValue = 9.5f;
+    clock.time = 7000;
+    command.execute();
+    EXPECT_FALSE(command.isFinished());
+
+    currentValue = 10;
+    clock.time = 7010;
+    command.execute();
+    EXPECT_FALSE(command.isFinished());
+
+    clock.time = 7060;
+    command.execute();
+    EXPECT_TRUE(command.isFinished());
+}
+
+TEST(ProfiledMoveCommand, end_sets_setpoint_and_clears_feed_forward)
+{
+    CREATE_COMMON_TEST_OBJECTS();
+    ProfiledMoveCommand command(&subsystem, RELATIVE_CONFIG);
+    ON_CALL(subsystem, getCurrentValue).WillByDefault(Return(4));
+    command.initialize();
+
+    EXPECT_CALL(subsystem, setSetpoint(10));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(0, 0));
+    command.end(false);
+
+    EXPECT_CALL(subsystem, setSetpoint(4));
+    EXPECT_CALL(subsystem, setSetpointFeedForward(0, 0));
+    command.end(true);
+}
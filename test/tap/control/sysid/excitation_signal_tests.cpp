@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/control/sysid/excitation_signal.hpp"
+
+using namespace tap::control::sysid;
+
+/// @return The amplitude of the signal's component at `frequency` over `[start, end)` seconds.
+static float toneAmplitude(const ExcitationSignal &signal, float frequency, float start, float end)
+{
+    double re = 0, im = 0;
+    int n = 0;
+    for (float t = start; t < end; t += 1E-4f, n++)
+    {
+        re += signal.sample(t) * cos(2 * M_PI * frequency * t);
+        im += signal.sample(t) * sin(2 * M_PI * frequency * t);
+    }
+    return 2 * sqrt(re * re + im * im) / n;
+}
+
+TEST(ExcitationSignal, chirp_sweeps_frequency_exponentially)
+{
+    ExcitationSignal chirp({ExcitationConfig::Type::CHIRP, 2, 1, 16, 4});
+
+    EXPECT_FLOAT_EQ(0, chirp.sample(0));
+    // 1 Hz at the start, twice the frequency every second, so the phase is 2 pi (2^t - 1) / ln 2
+    for (float t : {0.5f, 1.3f, 2.7f})
+    {
+        EXPECT_NEAR(2 * sinf(2 * M_PI * (exp2f(t) - 1) / logf(2)), chirp.sample(t), 1E-2f) << t;
+    }
+    EXPECT_FLOAT_EQ(0, chirp.sample(4.1f));
+}
+
+TEST(ExcitationSignal, chirp_with_equal_frequencies_is_sine)
+{
+    ExcitationSignal chirp({ExcitationConfig::Type::CHIRP, 1, 5, 5, 4});
+
+    EXPECT_NEAR(sinf(2 * M_PI * 5 * 0.33f), chirp.sample(0.33f), 1E-5f);
+}
+
+TEST(ExcitationSignal, multisine_has_every_harmonic_with_equal_amplitude)
+{
+    ExcitationSignal multisine({ExcitationConfig::Type::MULTISINE, 1, 2, 10});
+
+    ASSERT_EQ(5, multisine.getNumTones());
+    float amplitude = toneAmplitude(multisine, 2, 0, 0.5f);
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_FLOAT_EQ(2 * (i + 1), multisine.getToneFrequency(i));
+        EXPECT_NEAR(amplitude, toneAmplitude(multisine, 2 * (i + 1), 0, 0.5f), 1E-3f);
+    }
+    EXPECT_NEAR(0, toneAmplitude(multisine, 3, 0, 1), 1E-3f);
+}
+
+TEST(ExcitationSignal, multisine_peak_is_amplitude_and_periodic)
+{
+    ExcitationSignal multisine({ExcitationConfig::Type::MULTISINE, 3, 1, 20});
+
+    float peak = 0;
+    for (float t = 0; t < 1; t += 1E-4f)
+    {
+        peak = std::max(peak, fabsf(multisine.sample(t)));
+        EXPECT_NEAR(multisine.sample(t), multisine.sample(t + 7), 1E-3f);
+    }
+    EXPECT_NEAR(3, peak, 0.05f);
+}
+
+TEST(ExcitationSignal, multisine_spaces_tones_logarithmically_when_too_many_harmonics)
+{
+    ExcitationSignal multisine({ExcitationConfig::Type::MULTISINE, 1, 0.1f, 100});
+
+    ASSERT_LE(multisine.getNumTones(), ExcitationSignal::MAX_TONES);
+    EXPECT_FLOAT_EQ(0.1f, multisine.getToneFrequency(0));
+    EXPECT_NEAR(100, multisine.getToneFrequency(multisine.getNumTones() - 1), 1E-3f);
+    for (int i = 1; i < multisine.getNumTones(); i++)
+    {
+        EXPECT_GT(multisine.getToneFrequency(i), multisine.getToneFrequency(i - 1));
+    }
+}
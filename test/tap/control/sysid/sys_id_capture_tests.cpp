@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/crc.hpp"
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/serial/telemetry_stream.hpp"
+#include "tap/control/sysid/sys_id_capture.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using namespace tap::control::sysid;
+using tap::communication::serial::TelemetryStream;
+
+struct DecodedBlock
+{
+    uint32_t firstIndex;
+    std::vector<SysIdCapture::Sample> samples;
+};
+
+/// Decodes the sample blocks written to `device`, checking their framing.
+static std::vector<DecodedBlock> readBlocks(tap::stub::TerminalDeviceStub &device)
+{
+    std::string written = device.readAllItemsFromWriteBufferToString();
+    std::vector<DecodedBlock> blocks;
+    std::vector<uint8_t> frame;
+    for (char c : written)
+    {
+        if (c != 0)
+        {
+            frame.push_back(c);
+            continue;
+        }
+        if (frame.empty())
+        {
+            continue;
+        }
+
+        // COBS decode, then check the CRC
+        std::vector<uint8_t> packet;
+        for (std::size_t i = 0; i < frame.size();)
+        {
+            uint8_t code = frame[i++];
+            for (int k = 1; k < code; k++)
+            {
+                packet.push_back(frame[i++]);
+            }
+            if (code < 0xff && i < frame.size())
+            {
+                packet.push_back(0);
+            }
+        }
+        frame.clear();
+        std::size_t length = packet.size() - sizeof(uint16_t);
+        EXPECT_EQ(
+            packet[length] | (packet[length + 1] << 8),
+            tap::algorithms::calculateCRC16(packet.data(), length));
+        EXPECT_EQ(TelemetryStream::BLOCK_PACKET_TYPE, packet[0]);
+        EXPECT_EQ(SysIdCapture::BLOCK_TYPE, packet[1]);
+
+        DecodedBlock block;
+        memcpy(&block.firstIndex, &packet[2], sizeof(uint32_t));
+        const uint8_t *data = &packet[2 + SysIdCapture::BLOCK_HEADER_LENGTH];
+        for (int i = 0; i < packet[6]; i++, data += SysIdCapture::SAMPLE_LENGTH)
+        {
+            SysIdCapture::Sample sample{block.firstIndex + i};
+            memcpy(&sample.time, data, sizeof(uint32_t));
+            memcpy(&sample.input, data + 4, sizeof(float));
+            memcpy(&sample.output, data + 8, sizeof(float));
+            block.samples.push_back(sample);
+        }
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+class SysIdCaptureTest : public testing::Test
+{
+protected:
+    SysIdCaptureTest() : device(nullptr), stream(device), capture(&stream) {}
+
+    tap::arch::clock::ClockStub clock;
+    tap::stub::TerminalDeviceStub device;
+    TelemetryStream stream;
+    SysIdCapture capture;
+};
+
+TEST_F(SysIdCaptureTest, update_waits_for_full_block)
+{
+    for (int i = 0; i < SysIdCapture::SAMPLES_PER_BLOCK - 1; i++)
+    {
+        capture.push(i, i, -i);
+    }
+
+    capture.update();
+
+    EXPECT_TRUE(readBlocks(device).empty());
+    EXPECT_EQ(SysIdCapture::SAMPLES_PER_BLOCK - 1, capture.getSize());
+}
+
+TEST_F(SysIdCaptureTest, update_sends_one_block_per_call)
+{
+    for (int i = 0; i < 3 * SysIdCapture::SAMPLES_PER_BLOCK; i++)
+    {
+        capture.push(1000 * i, i, -2.0f * i);
+    }
+
+    capture.update();
+    capture.update();
+
+    auto blocks = readBlocks(device);
+    ASSERT_EQ(2, blocks.size());
+    EXPECT_EQ(0, blocks[0].firstIndex);
+    EXPECT_EQ(SysIdCapture::SAMPLES_PER_BLOCK, blocks[1].firstIndex);
+    ASSERT_EQ(SysIdCapture::SAMPLES_PER_BLOCK, blocks[1].samples.size());
+    const SysIdCapture::Sample &sample = blocks[1].samples[3];
+    EXPECT_EQ(23'000u, sample.time);
+    EXPECT_FLOAT_EQ(23, sample.input);
+    EXPECT_FLOAT_EQ(-46, sample.output);
+    EXPECT_EQ(SysIdCapture::SAMPLES_PER_BLOCK, capture.getSize());
+}
+
+TEST_F(SysIdCaptureTest, flush_sends_partial_block)
+{
+    capture.push(1, 2, 3);
+    capture.push(4, 5, 6);
+
+    capture.flush();
+    capture.update();
+
+    auto blocks = readBlocks(device);
+    ASSERT_EQ(1, blocks.size());
+    ASSERT_EQ(2, blocks[0].samples.size());
+    EXPECT_EQ(4u, blocks[0].samples[1].time);
+    EXPECT_EQ(0, capture.getSize());
+}
+
+TEST_F(SysIdCaptureTest, full_buffer_drops_samples_and_leaves_index_gap)
+{
+    for (int i = 0; i < SysIdCapture::CAPACITY + 5; i++)
+    {
+        capture.push(i, 0, 0);
+    }
+    EXPECT_EQ(5u, capture.getNumDropped());
+
+    capture.pop(SysIdCapture::CAPACITY - 2);
+    capture.push(0, 0, 0);
+    capture.flush();
+    capture.update();
+    capture.update();
+
+    // The block ends at the gap
+    auto blocks = readBlocks(device);
+    ASSERT_EQ(2, blocks.size());
+    EXPECT_EQ(SysIdCapture::CAPACITY - 2, blocks[0].firstIndex);
+    EXPECT_EQ(2, blocks[0].samples.size());
+    EXPECT_EQ(SysIdCapture::CAPACITY + 5, blocks[1].firstIndex);
+}
+
+TEST_F(SysIdCaptureTest, reset_clears_samples_and_index)
+{
+    capture.push(0, 0, 0);
+    capture.reset();
+    capture.push(7, 0, 0);
+
+    EXPECT_EQ(1, capture.getSize());
+    EXPECT_EQ(0u, capture.getSample(0).index);
+    EXPECT_EQ(7u, capture.getSample(0).time);
+}
+
+TEST(SysIdCapture, capture_without_stream_keeps_samples)
+{
+    SysIdCapture capture(nullptr);
+    for (int i = 0; i < 2 * SysIdCapture::SAMPLES_PER_BLOCK; i++)
+    {
+        capture.push(i, 0, 0);
+    }
+
+    capture.update();
+
+    EXPECT_EQ(2 * SysIdCapture::SAMPLES_PER_BLOCK, capture.getSize());
+}
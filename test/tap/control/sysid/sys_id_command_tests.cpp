@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/control/sysid/sys_id_command.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/motor_interface_mock.hpp"
+#include "tap/mock/subsystem_mock.hpp"
+
+using namespace tap::control::sysid;
+using namespace tap::mock;
+using namespace testing;
+
+class SysIdCommandTest : public Test
+{
+protected:
+    SysIdCommandTest()
+        : subsystem(&drivers),
+          capture(nullptr),
+          command(
+              &subsystem,
+              &motor,
+              SysIdCommand::Measurement::SHAFT_RPM,
+              100,
+              {ExcitationConfig::Type::CHIRP, 50, 1, 10, 1},
+              1,
+              &capture)
+    {
+    }
+
+    void SetUp() override
+    {
+        ON_CALL(motor, isMotorOnline).WillByDefault(Return(true));
+        // The motor's speed is twice its output
+        ON_CALL(motor, getShaftRPM).WillByDefault([&] { return 2 * output; });
+        ON_CALL(motor, setDesiredOutput).WillByDefault([&](int32_t out) { output = out; });
+    }
+
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    NiceMock<SubsystemMock> subsystem;
+    NiceMock<MotorInterfaceMock> motor;
+    SysIdCapture capture;
+    SysIdCommand command;
+    int16_t output = 0;
+};
+
+TEST_F(SysIdCommandTest, not_ready_when_motor_offline)
+{
+    ON_CALL(motor, isMotorOnline).WillByDefault(Return(false));
+
+    EXPECT_FALSE(command.isReady());
+}
+
+TEST_F(SysIdCommandTest, records_output_with_its_response_every_execute)
+{
+    command.initialize();
+    for (int i = 0; i < 500 && !command.isFinished(); i++)
+    {
+        clock.time++;
+        command.execute();
+    }
+
+    ASSERT_EQ(500, capture.getSize());
+    for (int i = 1; i < capture.getSize(); i++)
+    {
+        const SysIdCapture::Sample &sample = capture.getSample(i);
+        EXPECT_EQ(1000u * (i + 1), sample.time);
+        EXPECT_FLOAT_EQ(2 * sample.input, sample.output);
+        EXPECT_NEAR(100, sample.input, 50);
+    }
+}
+
+TEST_F(SysIdCommandTest, finishes_after_duration_and_stops_motor)
+{
+    command.initialize();
+    int executions = 0;
+    while (!command.isFinished())
+    {
+        clock.time++;
+        command.execute();
+        executions++;
+    }
+    command.end(false);
+
+    EXPECT_EQ(1000, executions);
+    EXPECT_EQ(0, output);
+}
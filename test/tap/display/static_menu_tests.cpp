@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include "tap/display/sh1106.hpp"
+#include "tap/display/static_menu.hpp"
+
+using namespace tap::display;
+
+static void renderInt(void *context, char *text, size_t size)
+{
+    snprintf(text, size, "%d", *static_cast<int *>(context));
+}
+
+static void increment(void *context) { (*static_cast<int *>(context))++; }
+
+static int value = 0;
+static int selections = 0;
+
+static const StaticMenuItem CHILD_ITEMS[] = {
+    {"Value", renderInt, &value},
+};
+static const StaticMenuPage CHILD_PAGE("Child", CHILD_ITEMS);
+
+static const StaticMenuItem LONG_ITEMS[] = {
+    {"0"},
+    {"1"},
+    {"2"},
+    {"3"},
+    {"4"},
+    {"5"},
+    {"6"},
+    {"7"},
+    {"8"},
+};
+static const StaticMenuPage LONG_PAGE("Long", LONG_ITEMS);
+
+static const StaticMenuItem ROOT_ITEMS[] = {
+    {"Child", nullptr, nullptr, &CHILD_PAGE},
+    {"Select", renderInt, &selections, nullptr, increment},
+    {"Long", nullptr, nullptr, &LONG_PAGE},
+};
+static const StaticMenuPage ROOT_PAGE("Root", ROOT_ITEMS);
+
+class StaticMenuTest : public testing::Test
+{
+protected:
+    StaticMenuTest() : menu(display, ROOT_PAGE)
+    {
+        value = 0;
+        selections = 0;
+    }
+
+    /// Updates the menu until every row has been refreshed once.
+    bool updateAllRows()
+    {
+        bool changed = false;
+        for (int i = 0; i < StaticMenu::NUM_ROWS / StaticMenu::ROWS_PER_UPDATE; i++)
+        {
+            changed |= menu.update();
+        }
+        return changed;
+    }
+
+    Sh1106<128, 64, false> display;
+    StaticMenu menu;
+};
+
+TEST_F(StaticMenuTest, first_update_draws_page)
+{
+    EXPECT_TRUE(menu.update());
+}
+
+TEST_F(StaticMenuTest, unchanged_rows_are_not_redrawn)
+{
+    updateAllRows();
+
+    EXPECT_FALSE(updateAllRows());
+}
+
+TEST_F(StaticMenuTest, row_is_redrawn_when_rendered_value_changes)
+{
+    menu.shortButtonPress(modm::MenuButtons::RIGHT);
+    updateAllRows();
+
+    value = 42;
+
+    EXPECT_TRUE(updateAllRows());
+    EXPECT_FALSE(updateAllRows());
+}
+
+TEST_F(StaticMenuTest, cursor_stays_within_page)
+{
+    menu.shortButtonPress(modm::MenuButtons::UP);
+    EXPECT_EQ(0, menu.getCursorIndex());
+
+    for (int i = 0; i < 5; i++)
+    {
+        menu.shortButtonPress(modm::MenuButtons::DOWN);
+    }
+    EXPECT_EQ(2, menu.getCursorIndex());
+}
+
+TEST_F(StaticMenuTest, right_opens_child_and_left_returns_to_parent_cursor)
+{
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::RIGHT);
+
+    EXPECT_EQ(&LONG_PAGE, &menu.getPage());
+    EXPECT_EQ(0, menu.getCursorIndex());
+
+    menu.shortButtonPress(modm::MenuButtons::LEFT);
+
+    EXPECT_EQ(&ROOT_PAGE, &menu.getPage());
+    EXPECT_EQ(2, menu.getCursorIndex());
+
+    menu.shortButtonPress(modm::MenuButtons::LEFT);
+
+    EXPECT_EQ(&ROOT_PAGE, &menu.getPage());
+}
+
+TEST_F(StaticMenuTest, right_on_item_without_child_does_nothing)
+{
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::RIGHT);
+
+    EXPECT_EQ(&ROOT_PAGE, &menu.getPage());
+}
+
+TEST_F(StaticMenuTest, ok_selects_item)
+{
+    menu.shortButtonPress(modm::MenuButtons::OK);
+    EXPECT_EQ(0, selections);
+
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::OK);
+    EXPECT_EQ(1, selections);
+}
+
+TEST_F(StaticMenuTest, scrolling_past_last_row_redraws_rows)
+{
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::DOWN);
+    menu.shortButtonPress(modm::MenuButtons::RIGHT);
+    updateAllRows();
+
+    for (int i = 0; i < StaticMenu::NUM_ROWS; i++)
+    {
+        menu.shortButtonPress(modm::MenuButtons::DOWN);
+    }
+
+    EXPECT_EQ(8, menu.getCursorIndex());
+    EXPECT_TRUE(updateAllRows());
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <gmock/gmock.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/errors/crash_recorder.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+using tap::Drivers;
+using namespace tap::errors;
+using namespace tap::arch::clock;
+using namespace testing;
+
+class CrashRecorderTest : public Test
+{
+protected:
+    CrashRecorderTest() : recorder(&drivers, record) {}
+
+    void SetUp() override { record.invalidate(); }
+
+    /// Adds an error to the drivers' error controller, bypassing the mock.
+    void raiseError(const char* description, int line, const char* file = "file.cpp")
+    {
+        drivers.errorController.ErrorController::addToErrorList(
+            SystemError(description, line, file));
+    }
+
+    ClockStub clock;
+    Drivers drivers;
+    CrashRecord record;
+    CrashRecorder recorder;
+};
+
+TEST_F(CrashRecorderTest, no_record_before_capture)
+{
+    EXPECT_FALSE(recorder.hasRecord());
+}
+
+TEST_F(CrashRecorderTest, captureFault_records_frame_and_stack)
+{
+    uint32_t stack[8 + CrashRecord::STACK_WORDS + 4];
+    for (uint32_t i = 0; i < sizeof(stack) / sizeof(stack[0]); i++)
+    {
+        stack[i] = i;
+    }
+    clock.time = 1234;
+
+    recorder.captureFault(stack, CrashRecord::STACK_WORDS + 4);
+
+    ASSERT_TRUE(recorder.hasRecord());
+    EXPECT_EQ(CrashRecord::Cause::HARD_FAULT, record.cause);
+    EXPECT_EQ(1234u, record.time);
+    EXPECT_EQ(0u, record.frame.r0);
+    EXPECT_EQ(5u, record.frame.lr);
+    EXPECT_EQ(6u, record.frame.pc);
+    EXPECT_EQ(7u, record.frame.xpsr);
+    EXPECT_EQ(CrashRecord::STACK_WORDS, record.numStackWords);
+    for (uint32_t i = 0; i < CrashRecord::STACK_WORDS; i++)
+    {
+        EXPECT_EQ(8 + i, record.stack[i]);
+    }
+}
+
+TEST_F(CrashRecorderTest, captureFault_near_top_of_stack_records_readable_words_only)
+{
+    uint32_t stack[8 + 3] = {};
+
+    recorder.captureFault(stack, 3);
+
+    EXPECT_EQ(3u, record.numStackWords);
+}
+
+TEST_F(CrashRecorderTest, captureAssertion_truncates_long_strings)
+{
+    recorder.captureAssertion(
+        "can.rx",
+        "a description that is much too long to fit in the record",
+        0x42);
+
+    ASSERT_TRUE(recorder.hasRecord());
+    EXPECT_EQ(CrashRecord::Cause::ASSERTION, record.cause);
+    EXPECT_STREQ("can.rx", record.assertionName);
+    EXPECT_EQ(CrashRecord::TEXT_LENGTH - 1, strlen(record.assertionDescription));
+    EXPECT_EQ(0x42u, record.assertionContext);
+}
+
+TEST_F(CrashRecorderTest, captureAssertion_without_description_records_empty_string)
+{
+    recorder.captureAssertion("can.rx", nullptr, 0);
+
+    EXPECT_STREQ("", record.assertionDescription);
+}
+
+TEST_F(CrashRecorderTest, second_crash_does_not_overwrite_first)
+{
+    recorder.captureAssertion("first", nullptr, 0);
+    recorder.captureAssertion("second", nullptr, 0);
+    recorder.captureWatchdogReset();
+
+    EXPECT_STREQ("first", record.assertionName);
+    EXPECT_EQ(CrashRecord::Cause::ASSERTION, record.cause);
+}
+
+TEST_F(CrashRecorderTest, captures_most_recently_seen_errors_first)
+{
+    for (int i = 0; i < static_cast<int>(CrashRecord::MAX_ERRORS) + 2; i++)
+    {
+        clock.time = 100 + i;
+        raiseError("error", i);
+    }
+    // Raising the first error again makes it the most recent
+    clock.time = 200;
+    raiseError("error", 0);
+
+    recorder.captureAssertion("assert", nullptr, 0);
+
+    ASSERT_EQ(CrashRecord::MAX_ERRORS, record.numErrors);
+    EXPECT_EQ(0, record.errors[0].lineNumber);
+    EXPECT_EQ(2u, record.errors[0].count);
+    EXPECT_EQ(200u, record.errors[0].lastSeen);
+    for (int i = 1; i < static_cast<int>(CrashRecord::MAX_ERRORS); i++)
+    {
+        EXPECT_EQ(static_cast<int>(CrashRecord::MAX_ERRORS) + 2 - i, record.errors[i].lineNumber);
+    }
+}
+
+TEST_F(CrashRecorderTest, long_filename_keeps_end_of_path)
+{
+    raiseError("error", 1, "src/tap/communication/sensors/imu/bmi088/bmi088.cpp");
+
+    recorder.captureAssertion("assert", nullptr, 0);
+
+    ASSERT_EQ(1, record.numErrors);
+    EXPECT_EQ(CrashRecord::TEXT_LENGTH - 1, strlen(record.errors[0].filename));
+    EXPECT_STREQ("imu/bmi088/bmi088.cpp", strstr(record.errors[0].filename, "imu/"));
+}
+
+TEST_F(CrashRecorderTest, captures_scheduler_bitmaps)
+{
+    ON_CALL(drivers.commandScheduler, getAddedCommandBitmap)
+        .WillByDefault(Return(tap::control::command_scheduler_bitmap_t(0b101)));
+    ON_CALL(drivers.commandScheduler, getRegisteredSubsystemBitmap)
+        .WillByDefault(Return(tap::control::subsystem_scheduler_bitmap_t(0b11)));
+
+    recorder.captureAssertion("assert", nullptr, 0);
+
+    EXPECT_EQ(0b101u, record.addedCommands[0]);
+    EXPECT_EQ(0b11u, record.registeredSubsystems[0]);
+}
+
+TEST_F(CrashRecorderTest, watchdog_reset_records_cause_only)
+{
+    raiseError("error", 1);
+
+    recorder.captureWatchdogReset();
+
+    ASSERT_TRUE(recorder.hasRecord());
+    EXPECT_EQ(CrashRecord::Cause::WATCHDOG, record.cause);
+    EXPECT_EQ(0, record.numErrors);
+}
+
+TEST_F(CrashRecorderTest, corrupted_record_is_invalid)
+{
+    recorder.captureAssertion("assert", nullptr, 0);
+
+    record.time++;
+
+    EXPECT_FALSE(record.isValid());
+    EXPECT_FALSE(recorder.hasRecord());
+}
+
+TEST_F(CrashRecorderTest, invalidate_clears_record)
+{
+    recorder.captureAssertion("assert", nullptr, 0);
+
+    record.invalidate();
+
+    EXPECT_FALSE(recorder.hasRecord());
+}
+
+TEST_F(CrashRecorderTest, print_includes_assertion_and_errors)
+{
+    raiseError("motor offline", 12);
+    recorder.captureAssertion("can.rx", "queue full", 0);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+
+    record.print(stream);
+
+    std::string output = terminalDevice.readAllItemsFromWriteBufferToString();
+    EXPECT_THAT(output, HasSubstr("assertion"));
+    EXPECT_THAT(output, HasSubstr("assert can.rx: queue full"));
+    EXPECT_THAT(output, HasSubstr("error \"motor offline\" file.cpp:12 x1"));
+}
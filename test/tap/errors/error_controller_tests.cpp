@@ -19,6 +19,7 @@
 
 #include <gmock/gmock.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/drivers.hpp"
 #include "tap/errors/error_controller.hpp"
 #include "tap/stub/terminal_device_stub.hpp"
@@ -350,3 +351,104 @@ TEST(ErrorController, terminalSerialCallback__removeall_removes_all_errors)
     EXPECT_THAT(output, Not(HasSubstr("error3")));
     EXPECT_EQ(0, ec.getErrorListSize());
 }
+
+TEST(ErrorController, addToErrorList__same_site_counted_once_with_timestamps)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    ErrorControllerTester ec(&drivers);
+    SystemError se1("error1", __LINE__, __FILE__);
+    SystemError se2("error2", __LINE__, __FILE__);
+
+    clock.time = 10;
+    ec.errorController.addToErrorList(se1);
+    ec.errorController.addToErrorList(se2);
+    clock.time = 20;
+    ec.errorController.addToErrorList(se1);
+    clock.time = 30;
+    ec.errorController.addToErrorList(se1);
+
+    ASSERT_EQ(2, ec.errorController.getNumErrors());
+    const ErrorController::ErrorEntry& entry = ec.errorController.getError(0);
+    EXPECT_STREQ("error1", entry.error.getDescription());
+    EXPECT_EQ(3, entry.count);
+    EXPECT_EQ(10, entry.firstSeen);
+    EXPECT_EQ(30, entry.lastSeen);
+    EXPECT_EQ(1, ec.errorController.getError(1).count);
+}
+
+TEST(ErrorController, addToErrorList__same_site_different_description_is_same_error)
+{
+    Drivers drivers;
+    ErrorControllerTester ec(&drivers);
+
+    ec.errorController.addToErrorList(SystemError("error1", 1, __FILE__));
+    ec.errorController.addToErrorList(SystemError("error2", 1, __FILE__));
+
+    ASSERT_EQ(1, ec.errorController.getNumErrors());
+    EXPECT_EQ(2, ec.errorController.getError(0).count);
+}
+
+TEST(ErrorController, addToErrorList__full_list_replaces_least_recently_seen_error)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    ErrorControllerTester ec(&drivers);
+
+    for (std::size_t i = 0; i < ErrorController::ERROR_LIST_MAX_SIZE; i++)
+    {
+        clock.time = i;
+        ec.errorController.addToErrorList(SystemError("error", i, __FILE__));
+    }
+    // Error 0 keeps occurring, so error 1 is the least recently seen
+    clock.time = ErrorController::EVICTION_HOLDOFF_MS + 1;
+    ec.errorController.addToErrorList(SystemError("error", 0, __FILE__));
+
+    ec.errorController.addToErrorList(SystemError("new error", 100, __FILE__));
+
+    ASSERT_EQ(ErrorController::ERROR_LIST_MAX_SIZE, ec.errorController.getNumErrors());
+    EXPECT_EQ(0, ec.errorController.getError(0).error.getLineNumber());
+    EXPECT_EQ(2, ec.errorController.getError(1).error.getLineNumber());
+    EXPECT_STREQ(
+        "new error",
+        ec.errorController.getError(ErrorController::ERROR_LIST_MAX_SIZE - 1)
+            .error.getDescription());
+}
+
+TEST(ErrorController, addToErrorList__full_list_of_recent_errors_drops_new_error)
+{
+    tap::arch::clock::ClockStub clock;
+    Drivers drivers;
+    ErrorControllerTester ec(&drivers);
+
+    for (std::size_t i = 0; i < ErrorController::ERROR_LIST_MAX_SIZE; i++)
+    {
+        ec.errorController.addToErrorList(SystemError("error", i, __FILE__));
+    }
+    clock.time = ErrorController::EVICTION_HOLDOFF_MS - 1;
+
+    ec.errorController.addToErrorList(SystemError("new error", 100, __FILE__));
+
+    EXPECT_EQ(ErrorController::ERROR_LIST_MAX_SIZE, ec.errorController.getNumErrors());
+    EXPECT_EQ(1, ec.errorController.getDroppedErrors());
+    for (std::size_t i = 0; i < ErrorController::ERROR_LIST_MAX_SIZE; i++)
+    {
+        EXPECT_STREQ("error", ec.errorController.getError(i).error.getDescription());
+    }
+}
+
+TEST(ErrorController, displayAllErrors__contains_count)
+{
+    Drivers drivers;
+    ErrorControllerTester ec(&drivers);
+    tap::stub::TerminalDeviceStub terminalDevice(&drivers);
+    modm::IOStream stream(terminalDevice);
+    SystemError se("error1", __LINE__, __FILE__);
+
+    ec.errorController.addToErrorList(se);
+    ec.errorController.addToErrorList(se);
+
+    ec.displayAllErrors(stream);
+
+    EXPECT_THAT(terminalDevice.readAllItemsFromWriteBufferToString(), HasSubstr("x2"));
+}
@@ -39,6 +39,14 @@ class CanMock : public tap::can::Can
     MOCK_METHOD(void, initialize, (), (override));
     MOCK_METHOD(bool, isMessageAvailable, (tap::can::CanBus bus), (const override));
     MOCK_METHOD(bool, getMessage, (tap::can::CanBus bus, modm::can::Message *message), (override));
+    MOCK_METHOD(const modm::can::Message *, peekMessage, (tap::can::CanBus bus), (override));
+    MOCK_METHOD(void, popMessage, (tap::can::CanBus bus), (override));
+    MOCK_METHOD(uint32_t, getMessageTimestamp, (tap::can::CanBus bus), (override));
+    MOCK_METHOD(
+        void,
+        setRxFilters,
+        (tap::can::CanBus bus, const tap::can::CanRxFilter *filters, int count),
+        (override));
     MOCK_METHOD(bool, isReadyToSend, (tap::can::CanBus bus), (const override));
     MOCK_METHOD(
         bool,
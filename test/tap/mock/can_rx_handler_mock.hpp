@@ -39,11 +39,13 @@ class CanRxHandlerMock : public tap::can::CanRxHandler
 
     MOCK_METHOD(void, attachReceiveHandler, (tap::can::CanRxListener* const listener), (override));
     MOCK_METHOD(void, pollCanData, (), (override));
+    MOCK_METHOD(void, pollCanData, (int maxFrames), (override));
     MOCK_METHOD(
         void,
         removeReceiveHandler,
         (const tap::can::CanRxListener& rxListener),
         (override));
+    MOCK_METHOD(uint32_t, getRxTimestamp, (), (const override));
 };  // class CanRxHandlerMock
 }  // namespace mock
 }  // namespace tap
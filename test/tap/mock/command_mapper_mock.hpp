@@ -44,6 +44,7 @@ class CommandMapperMock : public tap::control::CommandMapper
          bool,
          bool),
         (override));
+    MOCK_METHOD(void, update, (), (override));
     MOCK_METHOD(void, addMap, (tap::control::CommandMapping *), (override));
     MOCK_METHOD(std::size_t, getSize, (), (const override));
 };  // class CommandMapperMock
@@ -44,6 +44,7 @@ class CommandMock : public control::Command
     MOCK_METHOD(bool, isReady, (), (override));
     MOCK_METHOD(void, initialize, (), (override));
     MOCK_METHOD(void, execute, (), (override));
+    MOCK_METHOD(void, executeDegraded, (), (override));
     MOCK_METHOD(void, end, (bool interrupted), (override));
     MOCK_METHOD(bool, isFinished, (), (const override));
 };  // class CommandMock
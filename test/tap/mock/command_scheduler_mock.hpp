@@ -40,7 +40,14 @@ class CommandSchedulerMock : public control::CommandScheduler
     MOCK_METHOD(void, addCommand, (control::Command *), (override));
     MOCK_METHOD(void, removeCommand, (control::Command *, bool), (override));
     MOCK_METHOD(bool, isCommandScheduled, (const control::Command *), (const override));
+    MOCK_METHOD(void, switchToProfile, (const control::SchedulerProfile &), (override));
+    MOCK_METHOD(const control::SchedulerProfile *, getActiveProfile, (), (const override));
     MOCK_METHOD(void, registerSubsystem, (control::Subsystem *), (override));
+    MOCK_METHOD(
+        void,
+        registerSubsystem,
+        (control::Subsystem *, control::RefreshPolicy),
+        (override));
     MOCK_METHOD(bool, isSubsystemRegistered, (const control::Subsystem *), (const override));
 
     MOCK_METHOD(void, runAllHardwareTests, (), (override));
@@ -63,6 +70,8 @@ class CommandSchedulerMock : public control::CommandScheduler
         (),
         (const override));
     MOCK_METHOD(control::command_scheduler_bitmap_t, getAddedCommandBitmap, (), (const override));
+    MOCK_METHOD(void, setExecutionTimeAccountingEnabled, (bool), (override));
+    MOCK_METHOD(bool, isExecutionTimeAccountingEnabled, (), (const override));
 };  // class CommandSchedulerMock
 }  // namespace mock
 }  // namespace tap
@@ -42,6 +42,20 @@ class DigitalMock : public tap::gpio::Digital
         (override));
     MOCK_METHOD(void, set, (tap::gpio::Digital::OutputPin pin, bool isSet), (override));
     MOCK_METHOD(bool, read, (tap::gpio::Digital::InputPin pin), (const override));
+    MOCK_METHOD(
+        bool,
+        enableInputInterrupt,
+        (tap::gpio::Digital::InputPin pin,
+         tap::gpio::Digital::InputTrigger trigger,
+         tap::gpio::Digital::InputEdgeCallback callback,
+         void *context),
+        (override));
+    MOCK_METHOD(void, disableInputInterrupt, (tap::gpio::Digital::InputPin pin), (override));
+    MOCK_METHOD(
+        bool,
+        getInputEdge,
+        (tap::gpio::Digital::InputPin pin, tap::gpio::Digital::InputEdge *edge),
+        (override));
 };  // class DigitalMock
 }  // namespace mock
 }  // namespace tap
@@ -38,6 +38,7 @@ class DjiMotorTxHandlerMock : public tap::motor::DjiMotorTxHandler
 
     MOCK_METHOD(void, addMotorToManager, (tap::motor::DjiMotor * motor), (override));
     MOCK_METHOD(void, encodeAndSendCanData, (), (override));
+    MOCK_METHOD(void, sendPendingFrames, (), (override));
     MOCK_METHOD(void, removeFromMotorManager, (const tap::motor::DjiMotor &motor), (override));
     MOCK_METHOD(
         const tap::motor::DjiMotor *,
@@ -49,6 +50,16 @@ class DjiMotorTxHandlerMock : public tap::motor::DjiMotorTxHandler
         getCan2Motor,
         (tap::motor::MotorId motorId),
         (override));
+    MOCK_METHOD(
+        void,
+        snapshotAll,
+        (tap::can::CanBus bus, tap::motor::MotorStateSnapshot *out),
+        (const override));
+    MOCK_METHOD(
+        bool,
+        flushTxGroup,
+        (tap::can::CanBus bus, tap::motor::DjiMotorTxHandler::TxGroup group),
+        (override));
 };  // class DjiMotorTxHandlerMock
 }  // namespace mock
 }  // namespace tap
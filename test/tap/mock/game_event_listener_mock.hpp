@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_GAME_EVENT_LISTENER_MOCK_HPP_
+#define TAPROOT_GAME_EVENT_LISTENER_MOCK_HPP_
+
+#include <gmock/gmock.h>
+
+#include "tap/communication/serial/ref_serial.hpp"
+
+namespace tap::mock
+{
+class GameEventListenerMock : public tap::communication::serial::RefSerial::GameEventListener
+{
+public:
+    GameEventListenerMock();
+    MOCK_METHOD(
+        void,
+        onGameEvent,
+        (tap::communication::serial::RefSerial::Rx::GameEvent),
+        (override));
+};
+}  // namespace tap::mock
+
+#endif  // TAPROOT_GAME_EVENT_LISTENER_MOCK_HPP_
@@ -22,6 +22,7 @@
 
 #include <gmock/gmock.h>
 
+#include "tap/communication/sensors/imu/imu_diagnostics.hpp"
 #include "tap/communication/sensors/imu/imu_interface.hpp"
 
 namespace tap::mock
@@ -40,6 +41,12 @@ class ImuInterfaceMock : public tap::communication::sensors::imu::ImuInterface
     MOCK_METHOD(float, getGy, (), (override));
     MOCK_METHOD(float, getGz, (), (override));
     MOCK_METHOD(float, getTemp, (), (override));
+    MOCK_METHOD(uint32_t, getPrevIMUDataReceivedTime, (), (const override));
+    MOCK_METHOD(
+        const tap::communication::sensors::imu::ImuDiagnostics *,
+        getDiagnostics,
+        (),
+        (const override));
     MOCK_METHOD(float, getYaw, (), (override));
     MOCK_METHOD(float, getPitch, (), (override));
     MOCK_METHOD(float, getRoll, (), (override));
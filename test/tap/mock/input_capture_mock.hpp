@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_INPUT_CAPTURE_MOCK_HPP_
+#define TAPROOT_INPUT_CAPTURE_MOCK_HPP_
+
+#include <gmock/gmock.h>
+
+#include "tap/communication/gpio/input_capture.hpp"
+
+namespace tap
+{
+namespace mock
+{
+class InputCaptureMock : public tap::gpio::InputCapture
+{
+public:
+    InputCaptureMock();
+    virtual ~InputCaptureMock();
+
+    MOCK_METHOD(void, init, (), (override));
+    MOCK_METHOD(
+        void,
+        enable,
+        (tap::gpio::InputCapture::Pin pin,
+         tap::gpio::InputCapture::Edge edge,
+         tap::gpio::InputCapture::CaptureCallback callback,
+         void *context),
+        (override));
+    MOCK_METHOD(void, disable, (tap::gpio::InputCapture::Pin pin), (override));
+    MOCK_METHOD(
+        bool,
+        getCapture,
+        (tap::gpio::InputCapture::Pin pin, tap::gpio::InputCapture::Capture *capture),
+        (override));
+    MOCK_METHOD(float, getFrequency, (tap::gpio::InputCapture::Pin pin), (const override));
+};  // class InputCaptureMock
+}  // namespace mock
+}  // namespace tap
+
+#endif  // TAPROOT_INPUT_CAPTURE_MOCK_HPP_
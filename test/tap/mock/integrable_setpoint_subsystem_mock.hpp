@@ -38,6 +38,7 @@ class IntegrableSetpointSubsystemMock : public control::setpoint::IntegrableSetp
 
     MOCK_METHOD(float, getSetpoint, (), (const override));
     MOCK_METHOD(void, setSetpoint, (float), (override));
+    MOCK_METHOD(void, setSetpointFeedForward, (float, float), (override));
     MOCK_METHOD(float, getCurrentValue, (), (const override));
     MOCK_METHOD(float, getJamSetpointTolerance, (), (const override));
     MOCK_METHOD(bool, calibrateHere, (), (override));
@@ -46,6 +47,7 @@ class IntegrableSetpointSubsystemMock : public control::setpoint::IntegrableSetp
     MOCK_METHOD(bool, isCalibrated, (), (override));
     MOCK_METHOD(bool, isOnline, (), (override));
     MOCK_METHOD(float, getVelocity, (), (override));
+    MOCK_METHOD(float, getTorque, (), (override));
     MOCK_METHOD(float, getCurrentValueIntegral, (), (const override));
     MOCK_METHOD(void, refreshSafeDisconnect, (), (override));
 };
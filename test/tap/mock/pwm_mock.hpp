@@ -37,6 +37,8 @@ class PwmMock : public tap::gpio::Pwm
     MOCK_METHOD(void, init, (), (override));
     MOCK_METHOD(void, writeAllZeros, (), (override));
     MOCK_METHOD(void, write, (float duty, tap::gpio::Pwm::Pin), (override));
+    MOCK_METHOD(void, stage, (float duty, tap::gpio::Pwm::Pin), (override));
+    MOCK_METHOD(void, commit, (), (override));
     MOCK_METHOD(void, setTimerFrequency, (tap::gpio::Pwm::Timer, uint32_t), (override));
     MOCK_METHOD(void, pause, (tap::gpio::Pwm::Timer), (override));
     MOCK_METHOD(void, start, (tap::gpio::Pwm::Timer), (override));
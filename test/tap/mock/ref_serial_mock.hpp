@@ -43,14 +43,40 @@ class RefSerialMock : public tap::communication::serial::RefSerial
     MOCK_METHOD(bool, getRefSerialReceivingData, (), (const override));
     MOCK_METHOD(const Rx::RobotData&, getRobotData, (), (const override));
     MOCK_METHOD(const Rx::GameData&, getGameData, (), (const override));
+    MOCK_METHOD(uint32_t, getRobotDataSnapshot, (Rx::RobotData*), (const override));
+    MOCK_METHOD(uint32_t, getGameDataSnapshot, (Rx::GameData*), (const override));
+    MOCK_METHOD(uint32_t, getRobotDataGeneration, (), (const override));
+    MOCK_METHOD(uint32_t, getGameDataGeneration, (), (const override));
+    MOCK_METHOD(uint32_t, getRobotDataAge, (), (const override));
+    MOCK_METHOD(uint32_t, getGameDataAge, (), (const override));
+    MOCK_METHOD(const Rx::RxMessageTiming&, getRxMessageTiming, (uint16_t), (const override));
+    MOCK_METHOD(uint32_t, getVtmInput, (Rx::VtmInputData*), (const override));
+    MOCK_METHOD(void, resetRxMessageTiming, (), (override));
     MOCK_METHOD(
         void,
         attachRobotToRobotMessageHandler,
         (uint16_t, RobotToRobotMessageHandler*),
         (override));
+    MOCK_METHOD(bool, attachRxMessageHandler, (uint16_t, RxMessageHandler*), (override));
+    MOCK_METHOD(bool, attachGameEventListener, (GameEventListener*, uint16_t), (override));
+    MOCK_METHOD(void, setRxMessageDecodingEnabled, (uint16_t, bool), (override));
     MOCK_METHOD(RobotId, getRobotIdBasedOnCurrentRobotTeam, (RobotId), (override));
-    MOCK_METHOD(bool, acquireTransmissionSemaphore, (), (override));
-    MOCK_METHOD(void, releaseTransmissionSemaphore, (uint32_t), (override));
+    MOCK_METHOD(void, queueTransmission, (Tx::TransmissionPriority), (override));
+    MOCK_METHOD(
+        bool,
+        acquireTransmissionSemaphore,
+        (Tx::TransmissionPriority, uint32_t),
+        (override));
+    MOCK_METHOD(
+        void,
+        releaseTransmissionSemaphore,
+        (Tx::TransmissionPriority, uint32_t),
+        (override));
+    MOCK_METHOD(
+        const Tx::TransmissionQueueStats&,
+        getTransmissionQueueStats,
+        (Tx::TransmissionPriority),
+        (const override));
 };  // class RefSerialMock
 }  // namespace mock
 }  // namespace tap
@@ -82,7 +82,7 @@ class RefSerialTransmitterMock : public tap::communication::serial::RefSerialTra
     MOCK_METHOD(
         modm::ResumableResult<void>,
         sendRobotToRobotMsg,
-        (Tx::RobotToRobotMessage*, uint16_t, RobotId, uint16_t),
+        (Tx::RobotToRobotMessage*, uint16_t, RobotId, uint16_t, Tx::TransmissionPriority),
         (override));
 };
 }  // namespace tap::mock
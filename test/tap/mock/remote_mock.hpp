@@ -37,11 +37,27 @@ class RemoteMock : public tap::communication::serial::Remote
     MOCK_METHOD(void, initialize, (), (override));
     MOCK_METHOD(void, read, (), (override));
     MOCK_METHOD(bool, isConnected, (), (const override));
+    MOCK_METHOD(uint32_t, getMissedFrames, (), (const override));
+    MOCK_METHOD(bool, isMissingFrames, (), (const override));
+    MOCK_METHOD(void, setMissedFrameLimit, (uint32_t frames), (override));
+    MOCK_METHOD(
+        tap::communication::serial::Remote::ConnectionQuality,
+        getConnectionQuality,
+        (),
+        (const override));
+    MOCK_METHOD(bool, isVtmInputConnected, (), (const override));
     MOCK_METHOD(
         float,
         getChannel,
         (tap::communication::serial::Remote::Channel ch),
         (const override));
+    MOCK_METHOD(
+        void,
+        setChannelSmoothing,
+        (tap::communication::serial::Remote::Channel ch,
+         const tap::communication::serial::Remote::ChannelSmoothing &smoothing),
+        (override));
+    MOCK_METHOD(uint32_t, getLastFrameTime, (), (const override));
     MOCK_METHOD(
         tap::communication::serial::Remote::SwitchState,
         getSwitch,
@@ -54,6 +70,13 @@ class RemoteMock : public tap::communication::serial::Remote
     MOCK_METHOD(bool, getMouseR, (), (const override));
     MOCK_METHOD(bool, keyPressed, (tap::communication::serial::Remote::Key key), (const override));
     MOCK_METHOD(uint32_t, getUpdateCounter, (), (const override));
+    MOCK_METHOD(
+        bool,
+        popInputEvent,
+        (tap::communication::serial::Remote::InputEvent *),
+        (override));
+    MOCK_METHOD(int, getInputEventCount, (), (const override));
+    MOCK_METHOD(uint32_t, getDroppedInputEventCount, (), (const override));
 };  // class RemoteMock
 }  // namespace mock
 }  // namespace tap
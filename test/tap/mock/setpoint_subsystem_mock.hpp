@@ -43,6 +43,7 @@ class SetpointSubsystemMock : public control::setpoint::SetpointSubsystem
 
     MOCK_METHOD(float, getSetpoint, (), (const override));
     MOCK_METHOD(void, setSetpoint, (float), (override));
+    MOCK_METHOD(void, setSetpointFeedForward, (float, float), (override));
     MOCK_METHOD(float, getCurrentValue, (), (const override));
     MOCK_METHOD(float, getJamSetpointTolerance, (), (const override));
     MOCK_METHOD(bool, calibrateHere, (), (override));
@@ -51,6 +52,10 @@ class SetpointSubsystemMock : public control::setpoint::SetpointSubsystem
     MOCK_METHOD(bool, isCalibrated, (), (override));
     MOCK_METHOD(bool, isOnline, (), (override));
     MOCK_METHOD(float, getVelocity, (), (override));
+    MOCK_METHOD(float, getTorque, (), (override));
+    MOCK_METHOD(bool, isAbsolutePositionTrusted, (), (const override));
+    MOCK_METHOD(bool, getCalibration, (float *), (const override));
+    MOCK_METHOD(bool, restoreCalibration, (float), (override));
     MOCK_METHOD(void, refreshSafeDisconnect, (), ());
 };
 
@@ -38,6 +38,9 @@ class SubsystemMock : public control::Subsystem
     MOCK_METHOD(void, setDefaultCommand, (control::Command * defaultCommand), (override));
     MOCK_METHOD(control::Command *, getDefaultCommand, (), (const override));
     MOCK_METHOD(void, refresh, (), (override));
+    MOCK_METHOD(void, refreshDegraded, (), (override));
+    MOCK_METHOD(void, refreshSensors, (), (override));
+    MOCK_METHOD(void, refreshActuators, (), (override));
     MOCK_METHOD(void, refreshSafeDisconnect, (), ());
     MOCK_METHOD(void, setTestCommand, (control::Command * testCommand), (override));
     MOCK_METHOD(control::Command *, getTestCommand, (), (const override));
@@ -69,6 +69,27 @@ class UartMock : public tap::communication::serial::Uart
         flushWriteBuffer,
         (tap::communication::serial::Uart::UartPort port),
         (override));
+    MOCK_METHOD(
+        bool,
+        writeFrame,
+        (tap::communication::serial::Uart::UartPort port,
+         tap::communication::serial::Uart::TxFrame &frame),
+        (override));
+    MOCK_METHOD(
+        bool,
+        isRxDmaEnabled,
+        (tap::communication::serial::Uart::UartPort port),
+        (const override));
+    MOCK_METHOD(
+        bool,
+        isTxDmaEnabled,
+        (tap::communication::serial::Uart::UartPort port),
+        (const override));
+    MOCK_METHOD(
+        std::size_t,
+        getBytesUntilRxIdle,
+        (tap::communication::serial::Uart::UartPort port),
+        (const override));
 };  // class UartMock
 }  // namespace mock
 }  // namespace tap
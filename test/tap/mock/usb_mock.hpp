@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAPROOT_USB_MOCK_HPP_
+#define TAPROOT_USB_MOCK_HPP_
+
+#include <gmock/gmock.h>
+
+#include "tap/communication/serial/usb.hpp"
+
+namespace tap
+{
+namespace mock
+{
+class UsbMock : public tap::communication::serial::Usb
+{
+public:
+    UsbMock();
+    virtual ~UsbMock();
+
+    MOCK_METHOD(void, initialize, (), (override));
+    MOCK_METHOD(void, update, (), (override));
+    MOCK_METHOD(bool, isConnected, (Interface interface), (const override));
+    MOCK_METHOD(
+        std::size_t,
+        read,
+        (Interface interface, uint8_t *data, std::size_t length),
+        (override));
+    MOCK_METHOD(
+        std::size_t,
+        write,
+        (Interface interface, const uint8_t *data, std::size_t length),
+        (override));
+    MOCK_METHOD(void, flush, (Interface interface), (override));
+};  // class UsbMock
+}  // namespace mock
+}  // namespace tap
+
+#endif  // TAPROOT_USB_MOCK_HPP_
@@ -70,10 +70,33 @@ TEST(DjiMotor, parseCanRxData_valid_motor_id_motor_online)
     EXPECT_TRUE(motor.isMotorOnline());
 
     clock.time += 100'000;
+    drivers.djiMotorTxHandler.updateOnlineMotors();
 
     EXPECT_FALSE(motor.isMotorOnline());
 }
 
+TEST(DjiMotor, isMotorOnline_until_disconnect_time_passes_without_feedback)
+{
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR3, tap::can::CanBus::CAN_BUS2, false, "cool motor");
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault(testing::Return(5'000));
+
+    modm::can::Message msg(MOTOR3, 8);
+    msg.setExtended(false);
+    motor.processMessage(msg);
+
+    clock.time = 5 + DjiMotor::MOTOR_DISCONNECT_TIME - 1;
+    drivers.djiMotorTxHandler.updateOnlineMotors();
+    EXPECT_TRUE(motor.isMotorOnline());
+    EXPECT_EQ(0b100, drivers.djiMotorTxHandler.getOnlineMotors(tap::can::CanBus::CAN_BUS2));
+    EXPECT_EQ(0, drivers.djiMotorTxHandler.getOnlineMotors(tap::can::CanBus::CAN_BUS1));
+
+    clock.time = 5 + DjiMotor::MOTOR_DISCONNECT_TIME;
+    drivers.djiMotorTxHandler.updateOnlineMotors();
+    EXPECT_FALSE(motor.isMotorOnline());
+}
+
 struct MotorData
 {
     uint16_t encoder;
@@ -147,6 +170,44 @@ TEST(DjiMotor, parseCanRxData_motor_info_interpreted_correctly_motor_inverted)
     EXPECT_EQ(motorData.temperature, motor.getTemperature());
 }
 
+TEST(DjiMotor, parseCanRxData_short_message_ignored)
+{
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+
+    modm::can::Message msg(MOTOR1, 6);
+    msg.setExtended(false);
+
+    MotorData motorData{1000, -100, 100, 43};
+    motorData.encode(msg.data);
+
+    motor.processMessage(msg);
+
+    EXPECT_FALSE(motor.isMotorOnline());
+    EXPECT_EQ(DjiMotor::ENC_RESOLUTION / 2, motor.getEncoderWrapped());
+    EXPECT_EQ(0, motor.getTemperature());
+}
+
+TEST(DjiMotor, parseCanRxData_encoder_out_of_range_ignored)
+{
+    tap::arch::clock::ClockStub clock;
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, true, "cool motor");
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    MotorData motorData{DjiMotor::ENC_RESOLUTION, -100, 100, 43};
+    motorData.encode(msg.data);
+
+    motor.processMessage(msg);
+
+    EXPECT_FALSE(motor.isMotorOnline());
+    EXPECT_EQ(DjiMotor::ENC_RESOLUTION / 2, motor.getEncoderWrapped());
+    EXPECT_EQ(0, motor.getShaftRPM());
+}
+
 TEST(DjiMotor, setDesiredOutput_limits_output)
 {
     tap::Drivers drivers;
@@ -306,3 +367,194 @@ TEST(DjiMotor, inverted_moving_relative_to_home_after_zeroed_ok)
     EXPECT_EQ(500, motor.getEncoderUnwrapped());
     EXPECT_EQ(500, motor.getEncoderWrapped());
 }
+
+TEST(DjiMotor, processMessage_stores_rx_timestamp)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    EXPECT_EQ(0u, motor.getFeedbackTimestamp());
+
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault(testing::Return(12'345));
+
+    motor.processMessage(msg);
+
+    EXPECT_EQ(12'345u, motor.getFeedbackTimestamp());
+}
+
+TEST(DjiMotor, getEstimatedVelocity_estimator_disabled_uses_shaft_rpm)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    MotorData motorData{};
+    motorData.shaftRPM = 60;
+    motorData.encode(msg.data);
+
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(M_TWOPI, motor.getEstimatedVelocity(), 1e-4f);
+}
+
+TEST(DjiMotor, getEstimatedVelocity_differentiates_encoder_using_rx_timestamps)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+    motor.setVelocityEstimatorAlpha(1);
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    uint32_t rxTimestamp = 1'000;
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault([&]() { return rxTimestamp; });
+
+    MotorData motorData{};
+    motorData.encoder = 1'000;
+    motorData.shaftRPM = 1;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    // the first sample seeds the estimate with the shaft RPM
+    EXPECT_NEAR(M_TWOPI / 60, motor.getEstimatedVelocity(), 1e-4f);
+
+    // a quarter revolution of the encoder in 1 ms
+    rxTimestamp += 1'000;
+    motorData.encoder += DjiMotor::ENC_RESOLUTION / 4;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(M_TWOPI / 4 * 1'000, motor.getEstimatedVelocity(), 1e-1f);
+
+    // a message with the same timestamp does not change the estimate
+    motorData.encoder += DjiMotor::ENC_RESOLUTION / 4;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(M_TWOPI / 4 * 1'000, motor.getEstimatedVelocity(), 1e-1f);
+}
+
+TEST(DjiMotor, getEstimatedVelocity_smooths_estimate_and_handles_encoder_wrap)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+    motor.setVelocityEstimatorAlpha(0.5f);
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    uint32_t rxTimestamp = 1'000;
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault([&]() { return rxTimestamp; });
+
+    MotorData motorData{};
+    motorData.encoder = DjiMotor::ENC_RESOLUTION - 10;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(0, motor.getEstimatedVelocity(), 1e-4f);
+
+    // wrap around the encoder by 20 ticks in 1 ms, half of which is applied by the filter
+    rxTimestamp += 1'000;
+    motorData.encoder = 10;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(
+        0.5f * 20 * M_TWOPI / DjiMotor::ENC_RESOLUTION * 1'000,
+        motor.getEstimatedVelocity(),
+        1e-2f);
+}
+
+TEST(DjiMotor, getEstimatedVelocity_reseeds_after_gap_in_feedback)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+    motor.setVelocityEstimatorAlpha(1);
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    uint32_t rxTimestamp = 1'000;
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault([&]() { return rxTimestamp; });
+
+    MotorData motorData{};
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    rxTimestamp += 1'000'000;
+    motorData.encoder = 4'000;
+    motorData.shaftRPM = 60;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_NEAR(M_TWOPI, motor.getEstimatedVelocity(), 1e-4f);
+}
+
+TEST(DjiMotor, getPositionUnwrappedFixed_stays_exact_after_many_revolutions)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(
+        &drivers,
+        MOTOR1,
+        tap::can::CanBus::CAN_BUS1,
+        false,
+        "cool motor",
+        DjiMotor::ENC_RESOLUTION / 2,
+        10'000'000);
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    MotorData motorData{};
+    motorData.encoder = DjiMotor::ENC_RESOLUTION / 2 + 1;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    // a single encoder tick is still visible after ten million revolutions
+    EXPECT_EQ(
+        10'000'000ll * DjiMotor::FIXED_POINT_ONE + DjiMotor::FIXED_POINT_ONE / 2 +
+            DjiMotor::ENCODER_TO_FIXED_POINT,
+        motor.getPositionUnwrappedFixed());
+    EXPECT_EQ(
+        DjiMotor::FIXED_POINT_ONE / 2 + DjiMotor::ENCODER_TO_FIXED_POINT,
+        motor.getPositionWrappedFixed());
+}
+
+TEST(DjiMotor, getEstimatedVelocityFixed_is_in_revolutions_per_second)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "cool motor");
+    motor.setVelocityEstimatorAlpha(1);
+
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+
+    uint32_t rxTimestamp = 1'000;
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault([&]() { return rxTimestamp; });
+
+    MotorData motorData{};
+    motorData.shaftRPM = 120;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_EQ(2 * DjiMotor::FIXED_POINT_ONE, motor.getEstimatedVelocityFixed());
+
+    // half a revolution in 2 ms
+    rxTimestamp += 2'000;
+    motorData.encoder = DjiMotor::ENC_RESOLUTION / 2 - 1;
+    motorData.encode(msg.data);
+    motor.processMessage(msg);
+
+    EXPECT_EQ(
+        (DjiMotor::ENC_RESOLUTION / 2 - 1) * DjiMotor::ENCODER_TO_FIXED_POINT * 500,
+        motor.getEstimatedVelocityFixed());
+    EXPECT_NEAR(
+        motor.getEstimatedVelocityFixed() * M_TWOPI / DjiMotor::FIXED_POINT_ONE,
+        motor.getEstimatedVelocity(),
+        1e-2f);
+}
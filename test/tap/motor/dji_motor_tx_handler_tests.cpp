@@ -19,7 +19,10 @@
 
 #include <gtest/gtest.h>
 
+#include "tap/architecture/clock.hpp"
 #include "tap/architecture/endianness_wrappers.hpp"
+#include "tap/communication/can/can_tx_planner.hpp"
+#include "tap/control/command_scheduler.hpp"
 #include "tap/drivers.hpp"
 #include "tap/mock/dji_motor_mock.hpp"
 #include "tap/motor/dji_motor_tx_handler.hpp"
@@ -30,6 +33,14 @@ using namespace tap::motor;
 using namespace tap::mock;
 using namespace tap::arch;
 
+class FlagSafeDisconnectFunction : public tap::control::SafeDisconnectFunction
+{
+public:
+    bool operator()() override { return disconnected; }
+
+    bool disconnected = false;
+};
+
 class DjiMotorTxHandlerTest : public Test
 {
 protected:
@@ -208,6 +219,377 @@ TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_does_not_send_if_can_bus_busy
     djiMotorTxHandler.encodeAndSendCanData();
 }
 
+TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_queues_frames_if_can_bus_busy)
+{
+    ON_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS1)).WillByDefault(Return(false));
+    ON_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS2)).WillByDefault(Return(true));
+
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, _)).Times(0);
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS2, _)).Times(3);
+
+    addAllMotors();
+
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    EXPECT_EQ(0b111, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS2));
+    EXPECT_EQ(0u, drivers.can.getBusStats(can::CanBus::CAN_BUS1).txDrops);
+}
+
+TEST_F(DjiMotorTxHandlerTest, sendPendingFrames_sends_queued_frames_once_can_bus_ready)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    addAllMotors();
+
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    EXPECT_CALL(drivers.can, sendMessage).Times(6);
+
+    djiMotorTxHandler.sendPendingFrames();
+
+    EXPECT_EQ(0, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS2));
+
+    // Nothing is pending, so no frames are resent
+    djiMotorTxHandler.sendPendingFrames();
+}
+
+TEST_F(DjiMotorTxHandlerTest, sendPendingFrames_stops_when_mailboxes_full)
+{
+    EXPECT_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS1))
+        .WillOnce(Return(true))
+        .WillRepeatedly(Return(false));
+    EXPECT_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS2))
+        .WillRepeatedly(Return(false));
+
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            can::CanBus::CAN_BUS1,
+            Property(
+                &modm::can::Message::getIdentifier,
+                DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER)));
+
+    addAllMotors();
+
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    EXPECT_EQ(0b110, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_records_tx_drops_when_pending_frames_superseded)
+{
+    ON_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS1)).WillByDefault(Return(false));
+    ON_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS2)).WillByDefault(Return(true));
+
+    addAllMotors();
+
+    djiMotorTxHandler.encodeAndSendCanData();
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    EXPECT_EQ(3u, drivers.can.getBusStats(can::CanBus::CAN_BUS1).txDrops);
+    EXPECT_EQ(0u, drivers.can.getBusStats(can::CanBus::CAN_BUS2).txDrops);
+    EXPECT_EQ(0b111, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, sendPendingFrames_sends_latest_setpoint_of_superseded_frame)
+{
+    ON_CALL(*motors[0], serializeCanSendData)
+        .WillByDefault([&](modm::can::Message *txMessage)
+                       { motors[0]->DjiMotor::serializeCanSendData(txMessage); });
+    ON_CALL(*motors[0], getOutputDesired)
+        .WillByDefault([&]() { return motors[0]->DjiMotor::getOutputDesired(); });
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    const uint8_t expectedData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH] = {0, 2};
+    modm::can::Message expectedMessage(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH,
+        expectedData,
+        false);
+
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+
+    motors[0]->DjiMotor::setDesiredOutput(1);
+    djiMotorTxHandler.encodeAndSendCanData();
+    motors[0]->DjiMotor::setDesiredOutput(2);
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, expectedMessage)).Times(1);
+
+    djiMotorTxHandler.sendPendingFrames();
+}
+
+TEST_F(DjiMotorTxHandlerTest, sendPendingFrames_retries_frame_that_failed_to_send)
+{
+    EXPECT_CALL(drivers.can, sendMessage).WillOnce(Return(false)).WillOnce(Return(true));
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_EQ(0b001, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+
+    djiMotorTxHandler.sendPendingFrames();
+    EXPECT_EQ(0, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, removeFromMotorManager_clears_pending_frame_of_empty_group)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    djiMotorTxHandler.addMotorToManager(motors[4]);
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    djiMotorTxHandler.removeFromMotorManager(*motors[0]);
+
+    EXPECT_EQ(0b010, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_does_not_send_reserved_group)
+{
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, _)).Times(2);
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS2, _)).Times(3);
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            can::CanBus::CAN_BUS1,
+            Property(
+                &modm::can::Message::getIdentifier,
+                DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER)))
+        .Times(0);
+
+    addAllMotors();
+    djiMotorTxHandler.setTxGroupReserved(
+        can::CanBus::CAN_BUS1,
+        DjiMotorTxHandler::TX_GROUP_HIGH,
+        true);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    EXPECT_TRUE(djiMotorTxHandler.isTxGroupReserved(
+        can::CanBus::CAN_BUS1,
+        DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_EQ(
+        nullptr,
+        djiMotorTxHandler.getTxFrame(can::CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_HIGH));
+}
+
+TEST_F(DjiMotorTxHandlerTest, flushTxGroup_sends_only_the_specified_group)
+{
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            can::CanBus::CAN_BUS2,
+            Property(
+                &modm::can::Message::getIdentifier,
+                DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER)));
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+    addAllMotors();
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    ON_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS2)).WillByDefault(Return(true));
+
+    EXPECT_TRUE(
+        djiMotorTxHandler.flushTxGroup(can::CanBus::CAN_BUS2, DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_EQ(0b111, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0b101, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS2));
+}
+
+TEST_F(DjiMotorTxHandlerTest, flushTxGroup_empty_group_sends_nothing)
+{
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    EXPECT_FALSE(
+        djiMotorTxHandler.flushTxGroup(can::CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_LOW));
+}
+
+TEST_F(DjiMotorTxHandlerTest, flushTxGroup_leaves_frame_pending_if_can_bus_busy)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    djiMotorTxHandler.addMotorToManager(motors[4]);
+    djiMotorTxHandler.setTxGroupReserved(
+        can::CanBus::CAN_BUS1,
+        DjiMotorTxHandler::TX_GROUP_HIGH,
+        true);
+
+    EXPECT_FALSE(
+        djiMotorTxHandler.flushTxGroup(can::CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_FALSE(
+        djiMotorTxHandler.flushTxGroup(can::CanBus::CAN_BUS1, DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_EQ(0b010, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(1u, drivers.can.getBusStats(can::CanBus::CAN_BUS1).txDrops);
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, _));
+
+    djiMotorTxHandler.sendPendingFrames();
+    EXPECT_EQ(0, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, failsafe_sends_zero_frames_while_engaged)
+{
+    ON_CALL(*motors[0], serializeCanSendData)
+        .WillByDefault([&](modm::can::Message *txMessage)
+                       { motors[0]->DjiMotor::serializeCanSendData(txMessage); });
+    ON_CALL(*motors[0], getOutputDesired)
+        .WillByDefault([&]() { return motors[0]->DjiMotor::getOutputDesired(); });
+    FlagSafeDisconnectFunction disconnect;
+    djiMotorTxHandler.setFailsafeFunction(&disconnect);
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    motors[0]->DjiMotor::setDesiredOutput(1000);
+
+    const uint8_t outputData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH] = {0x03, 0xe8};
+    const uint8_t zeroData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH] = {};
+    modm::can::Message outputMessage(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH,
+        outputData,
+        false);
+    modm::can::Message zeroMessage(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH,
+        zeroData,
+        false);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, outputMessage));
+        EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, zeroMessage));
+        EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, outputMessage));
+    }
+
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    disconnect.disconnected = true;
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_TRUE(djiMotorTxHandler.isFailsafeEngaged());
+
+    disconnect.disconnected = false;
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_FALSE(djiMotorTxHandler.isFailsafeEngaged());
+}
+
+TEST_F(DjiMotorTxHandlerTest, failsafe_sends_reserved_groups)
+{
+    FlagSafeDisconnectFunction disconnect;
+    disconnect.disconnected = true;
+    djiMotorTxHandler.setFailsafeFunction(&disconnect);
+    addAllMotors();
+    djiMotorTxHandler.setTxGroupReserved(
+        can::CanBus::CAN_BUS1,
+        DjiMotorTxHandler::TX_GROUP_HIGH,
+        true);
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(6);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+}
+
+TEST_F(DjiMotorTxHandlerTest, failsafe_latency_measured_from_last_clear_until_frames_sent)
+{
+    clock::ClockStub clock;
+    FlagSafeDisconnectFunction disconnect;
+    djiMotorTxHandler.setFailsafeFunction(&disconnect);
+    addAllMotors();
+
+    clock.time = 10;
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    disconnect.disconnected = true;
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+    clock.time = 12;
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_EQ(0u, djiMotorTxHandler.getFailsafeLatencyHistogram().getCount());
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    clock.time = 13;
+    djiMotorTxHandler.sendPendingFrames();
+
+    EXPECT_EQ(3'000u, djiMotorTxHandler.getFailsafeLatency());
+    EXPECT_EQ(1u, djiMotorTxHandler.getFailsafeLatencyHistogram().getCount());
+
+    // Staying disconnected doesn't measure the latency again
+    clock.time = 14;
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_EQ(1u, djiMotorTxHandler.getFailsafeLatencyHistogram().getCount());
+}
+
+TEST_F(DjiMotorTxHandlerTest, setTxPlan_holds_each_group_until_its_planned_offset)
+{
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    djiMotorTxHandler.addMotorToManager(motors[4]);
+
+    // The feedback of both motors arrives at the start of the tick
+    can::CanTxPlanner planner;
+    planner.addFixedFrame(0x201, 8, 1'000, 0);
+    planner.addFixedFrame(0x205, 8, 1'000, 0);
+    planner.addTxFrame(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER, 8, 1'000);
+    planner.addTxFrame(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER, 8, 1'000);
+    ASSERT_TRUE(planner.plan());
+    const uint32_t lowOffset = planner.getOffset(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER);
+    const uint32_t highOffset = planner.getOffset(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER);
+    ASSERT_GT(lowOffset, 0u);
+    ASSERT_GT(highOffset, 0u);
+
+    djiMotorTxHandler.setTxPlan(can::CanBus::CAN_BUS1, &planner);
+
+    clock::enableVirtualTime(5'000);
+    uint32_t lowSent = 0;
+    uint32_t highSent = 0;
+    ON_CALL(drivers.can, sendMessage)
+        .WillByDefault([&](can::CanBus, const modm::can::Message &message) {
+            const uint32_t elapsed = clock::getVirtualTimeMicroseconds() - 5'000;
+            if (message.getIdentifier() == DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER)
+            {
+                lowSent = elapsed;
+            }
+            else
+            {
+                highSent = elapsed;
+            }
+            return true;
+        });
+    EXPECT_CALL(drivers.can, sendMessage).Times(2);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+    EXPECT_EQ(0b11, djiMotorTxHandler.getPendingTxGroups(can::CanBus::CAN_BUS1));
+    for (int i = 0; i < 100; i++)
+    {
+        clock::advance(10);
+        djiMotorTxHandler.sendPendingFrames();
+    }
+    clock::disableVirtualTime();
+
+    EXPECT_EQ(lowOffset, lowSent);
+    EXPECT_EQ(highOffset, highSent);
+}
+
+TEST_F(DjiMotorTxHandlerTest, setTxPlan_failsafe_frames_not_held)
+{
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    FlagSafeDisconnectFunction disconnect;
+    disconnect.disconnected = true;
+    djiMotorTxHandler.setFailsafeFunction(&disconnect);
+
+    can::CanTxPlanner planner;
+    planner.addFixedFrame(0x201, 8, 1'000, 0);
+    planner.addTxFrame(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER, 8, 1'000);
+    ASSERT_TRUE(planner.plan());
+    ASSERT_GT(planner.getOffset(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER), 0u);
+    djiMotorTxHandler.setTxPlan(can::CanBus::CAN_BUS1, &planner);
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(1);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+}
+
 TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_valid_encoding)
 {
     uint8_t inData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH]{};
@@ -290,6 +672,231 @@ TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_valid_encoding)
     djiMotorTxHandler.encodeAndSendCanData();
 }
 
+TEST_F(DjiMotorTxHandlerTest, addMotorToManager_updates_tx_group_members)
+{
+    addAllMotors();
+
+    EXPECT_EQ(
+        0x0f,
+        djiMotorTxHandler.getTxGroupMembers(
+            can::CanBus::CAN_BUS1,
+            DjiMotorTxHandler::TX_GROUP_LOW));
+    EXPECT_EQ(
+        0x30,
+        djiMotorTxHandler.getTxGroupMembers(
+            can::CanBus::CAN_BUS1,
+            DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_EQ(
+        0xc0,
+        djiMotorTxHandler.getTxGroupMembers(
+            can::CanBus::CAN_BUS2,
+            DjiMotorTxHandler::TX_GROUP_6020_CURRENT));
+
+    djiMotorTxHandler.removeFromMotorManager(*motors[5]);
+
+    EXPECT_EQ(
+        0x10,
+        djiMotorTxHandler.getTxGroupMembers(
+            can::CanBus::CAN_BUS1,
+            DjiMotorTxHandler::TX_GROUP_HIGH));
+    EXPECT_EQ(
+        0x30,
+        djiMotorTxHandler.getTxGroupMembers(
+            can::CanBus::CAN_BUS2,
+            DjiMotorTxHandler::TX_GROUP_HIGH));
+}
+
+TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_sends_output_set_after_motor_added)
+{
+    ON_CALL(*motors[1], serializeCanSendData)
+        .WillByDefault([&](modm::can::Message *txMessage)
+                       { motors[1]->DjiMotor::serializeCanSendData(txMessage); });
+    ON_CALL(*motors[1], getOutputDesired)
+        .WillByDefault([&]() { return motors[1]->DjiMotor::getOutputDesired(); });
+
+    const uint8_t expectedData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH] =
+        {0, 0, 0x03, 0xe8, 0, 0, 0, 0};
+    modm::can::Message expectedMessage(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH,
+        expectedData,
+        false);
+
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, expectedMessage));
+
+    djiMotorTxHandler.addMotorToManager(motors[1]);
+    motors[1]->DjiMotor::setDesiredOutput(1000);
+
+    djiMotorTxHandler.encodeAndSendCanData();
+}
+
+TEST_F(DjiMotorTxHandlerTest, removeFromMotorManager_clears_output_and_stops_sending)
+{
+    ON_CALL(*motors[0], serializeCanSendData)
+        .WillByDefault([](modm::can::Message *txMessage)
+                       { convertToLittleEndian<int16_t>(1, txMessage->data); });
+
+    const uint8_t expectedData[DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH] = {};
+    modm::can::Message expectedMessage(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        DjiMotorTxHandler::CAN_DJI_MESSAGE_SEND_LENGTH,
+        expectedData,
+        false);
+
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    djiMotorTxHandler.removeFromMotorManager(*motors[0]);
+
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    // Re-adding a motor that does not serialize anything sends a cleared frame
+    ON_CALL(*motors[0], serializeCanSendData).WillByDefault(Return());
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, expectedMessage));
+    djiMotorTxHandler.addMotorToManager(motors[0]);
+    djiMotorTxHandler.encodeAndSendCanData();
+}
+
+TEST_F(DjiMotorTxHandlerTest, recordFeedback_marks_motor_online)
+{
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS2, 5, 0);
+
+    EXPECT_EQ(0b00100000, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS2));
+    EXPECT_EQ(0, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, recordFeedback_invalid_normalized_id_ignored)
+{
+    djiMotorTxHandler.recordFeedback(
+        can::CanBus::CAN_BUS1,
+        DjiMotorTxHandler::DJI_MOTORS_PER_CAN,
+        0);
+
+    EXPECT_EQ(0, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, updateOnlineMotors_marks_motors_without_recent_feedback_offline)
+{
+    static constexpr uint32_t DISCONNECT_TIME_US = DjiMotor::MOTOR_DISCONNECT_TIME * 1'000;
+
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 0, 1'000);
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 1, 2'000);
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS2, 0, 1'000);
+
+    djiMotorTxHandler.updateOnlineMotors(1'000 + DISCONNECT_TIME_US - 1);
+    EXPECT_EQ(0b11, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0b1, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS2));
+
+    djiMotorTxHandler.updateOnlineMotors(1'000 + DISCONNECT_TIME_US);
+    EXPECT_EQ(0b10, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS2));
+}
+
+TEST_F(DjiMotorTxHandlerTest, updateOnlineMotors_feedback_newer_than_now_stays_online)
+{
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 3, 10'000);
+
+    djiMotorTxHandler.updateOnlineMotors(9'990);
+
+    EXPECT_EQ(0b1000, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, updateOnlineMotors_handles_timestamp_wraparound)
+{
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 0, UINT32_MAX - 10);
+
+    djiMotorTxHandler.updateOnlineMotors(10);
+    EXPECT_EQ(0b1, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+
+    djiMotorTxHandler.updateOnlineMotors(DjiMotor::MOTOR_DISCONNECT_TIME * 1'000);
+    EXPECT_EQ(0, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, encodeAndSendCanData_updates_online_motors)
+{
+    clock::ClockStub clock;
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 0, 0);
+
+    clock.time = DjiMotor::MOTOR_DISCONNECT_TIME;
+    djiMotorTxHandler.encodeAndSendCanData();
+
+    EXPECT_EQ(0, djiMotorTxHandler.getOnlineMotors(can::CanBus::CAN_BUS1));
+}
+
+TEST_F(DjiMotorTxHandlerTest, areMotorsOnline_true_only_if_all_motors_in_mask_online)
+{
+    static constexpr uint8_t CHASSIS_MOTORS =
+        DjiMotorTxHandler::getMotorMask(MOTOR1) | DjiMotorTxHandler::getMotorMask(MOTOR2) |
+        DjiMotorTxHandler::getMotorMask(MOTOR3) | DjiMotorTxHandler::getMotorMask(MOTOR4);
+    static_assert(CHASSIS_MOTORS == 0b1111);
+
+    for (uint32_t id = 0; id < 3; id++)
+    {
+        djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, id, 0);
+    }
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 5, 0);
+    EXPECT_FALSE(djiMotorTxHandler.areMotorsOnline(can::CanBus::CAN_BUS1, CHASSIS_MOTORS));
+
+    djiMotorTxHandler.recordFeedback(can::CanBus::CAN_BUS1, 3, 0);
+    EXPECT_TRUE(djiMotorTxHandler.areMotorsOnline(can::CanBus::CAN_BUS1, CHASSIS_MOTORS));
+    EXPECT_FALSE(djiMotorTxHandler.areMotorsOnline(can::CanBus::CAN_BUS2, CHASSIS_MOTORS));
+}
+
+TEST_F(DjiMotorTxHandlerTest, snapshotAll_no_motors_empty_snapshot)
+{
+    MotorStateSnapshot snapshot;
+    snapshot.motorMask = 0xff;
+    snapshot.shaftRPM[0] = 10;
+
+    djiMotorTxHandler.snapshotAll(can::CanBus::CAN_BUS1, &snapshot);
+
+    EXPECT_EQ(0, snapshot.motorMask);
+    EXPECT_EQ(0, snapshot.shaftRPM[0]);
+}
+
+TEST_F(DjiMotorTxHandlerTest, snapshotAll_copies_state_of_motors_on_bus)
+{
+    tap::arch::clock::ClockStub clock;
+
+    modm::can::Message feedback(MOTOR3, 8);
+    feedback.setExtended(false);
+    feedback.data[0] = 0x01;  // encoder 0x0102
+    feedback.data[1] = 0x02;
+    feedback.data[2] = 0x00;  // shaft RPM 60
+    feedback.data[3] = 60;
+    feedback.data[4] = 0xff;  // torque -1
+    feedback.data[5] = 0xff;
+    feedback.data[6] = 40;  // temperature
+
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault(Return(1'234));
+
+    motors[2]->DjiMotor::processMessage(feedback);
+    motors[2]->DjiMotor::setDesiredOutput(-500);
+
+    djiMotorTxHandler.addMotorToManager(motors[2]);
+    djiMotorTxHandler.addMotorToManager(motors[5]);
+    djiMotorTxHandler.addMotorToManager(motors[8]);
+
+    MotorStateSnapshot snapshot;
+    djiMotorTxHandler.snapshotAll(can::CanBus::CAN_BUS1, &snapshot);
+
+    EXPECT_EQ(0b00100100, snapshot.motorMask);
+    EXPECT_TRUE(snapshot.contains(2));
+    EXPECT_FALSE(snapshot.contains(0));
+
+    EXPECT_EQ(0x0102, snapshot.encoderWrapped[2]);
+    EXPECT_EQ(0x0102, snapshot.encoderUnwrapped[2]);
+    EXPECT_EQ(60, snapshot.shaftRPM[2]);
+    EXPECT_EQ(-1, snapshot.torque[2]);
+    EXPECT_EQ(40, snapshot.temperature[2]);
+    EXPECT_EQ(-500, snapshot.outputDesired[2]);
+    EXPECT_NEAR(M_TWOPI, snapshot.estimatedVelocity[2], 1e-4f);
+    EXPECT_EQ(1'234u, snapshot.feedbackTimestamp[2]);
+    EXPECT_TRUE(snapshot.online[2]);
+
+    EXPECT_FALSE(snapshot.online[5]);
+    EXPECT_EQ(0, snapshot.shaftRPM[5]);
+}
+
 #define TEST_getCanNMotor(n)                                                              \
     TEST_F(DjiMotorTxHandlerTest, getCan##n##Motor_returns_nullptr_when_invalid_motorid)  \
     {                                                                                     \
@@ -314,3 +314,109 @@ TEST(DjiMotor, double_moving_relative_to_home_after_zeroed_ok)
     motorTwoEncoderRelToHome = getRelativeToHome(motorTwoEncoderReceive, motorTwoHome);
     EXPECT_EQ(ENC_RESOLUTION - 500, motor.getEncoderWrapped());
 }
+
+TEST(DoubleDjiMotor, setDesiredOutput__feed_forward_added_to_both_motors)
+{
+    SETUP_TEST();
+
+    motor.setFeedForward(500);
+
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(1500));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(1500));
+
+    motor.setDesiredOutput(1000);
+}
+
+TEST(DoubleDjiMotor, setDesiredOutput__load_sharing_balanced_motors_applies_per_motor_gains)
+{
+    SETUP_TEST();
+
+    ON_CALL(motor.motorOne, getTorque).WillByDefault(Return(1000));
+    ON_CALL(motor.motorTwo, getTorque).WillByDefault(Return(1000));
+    ON_CALL(motor.motorOne, getTemperature).WillByDefault(Return(40));
+    ON_CALL(motor.motorTwo, getTemperature).WillByDefault(Return(40));
+
+    motor.setLoadSharingConfig({
+        .gainOne = 1.0f,
+        .gainTwo = 1.5f,
+        .torqueBalanceGain = 0.5f,
+        .temperatureBalanceGain = 0.01f,
+    });
+    EXPECT_TRUE(motor.isLoadSharingEnabled());
+
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(2000));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(3000));
+
+    motor.setDesiredOutput(2000);
+
+    EXPECT_EQ(0, motor.getBalance());
+}
+
+TEST(DoubleDjiMotor, setDesiredOutput__load_sharing_shifts_output_away_from_loaded_motor)
+{
+    SETUP_TEST();
+
+    // motor one carries 3x the torque of motor two
+    ON_CALL(motor.motorOne, getTorque).WillByDefault(Return(-3000));
+    ON_CALL(motor.motorTwo, getTorque).WillByDefault(Return(-1000));
+
+    motor.setLoadSharingConfig({.torqueBalanceGain = 0.2f, .maxBalance = 0.5f});
+
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(-9000));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(-11000));
+
+    motor.setDesiredOutput(-10000);
+
+    EXPECT_NEAR(0.1f, motor.getBalance(), 1e-6f);
+}
+
+TEST(DoubleDjiMotor, setDesiredOutput__load_sharing_shifts_output_away_from_hot_motor)
+{
+    SETUP_TEST();
+
+    ON_CALL(motor.motorOne, getTemperature).WillByDefault(Return(40));
+    ON_CALL(motor.motorTwo, getTemperature).WillByDefault(Return(60));
+
+    motor.setLoadSharingConfig({.temperatureBalanceGain = 0.01f});
+
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(12000));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(8000));
+
+    motor.setDesiredOutput(10000);
+
+    EXPECT_NEAR(-0.2f, motor.getBalance(), 1e-6f);
+}
+
+TEST(DoubleDjiMotor, setDesiredOutput__load_sharing_balance_limited)
+{
+    SETUP_TEST();
+
+    ON_CALL(motor.motorOne, getTemperature).WillByDefault(Return(80));
+    ON_CALL(motor.motorTwo, getTemperature).WillByDefault(Return(20));
+
+    motor.setLoadSharingConfig({.temperatureBalanceGain = 0.1f, .maxBalance = 0.25f});
+
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(750));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(1250));
+
+    motor.setDesiredOutput(1000);
+
+    EXPECT_EQ(0.25f, motor.getBalance());
+}
+
+TEST(DoubleDjiMotor, disableLoadSharing__output_mirrored_again)
+{
+    SETUP_TEST();
+
+    ON_CALL(motor.motorOne, getTemperature).WillByDefault(Return(80));
+    motor.setLoadSharingConfig({.temperatureBalanceGain = 0.1f});
+    motor.disableLoadSharing();
+
+    EXPECT_FALSE(motor.isLoadSharingEnabled());
+    EXPECT_CALL(motor.motorOne, setDesiredOutput(1000));
+    EXPECT_CALL(motor.motorTwo, setDesiredOutput(1000));
+
+    motor.setDesiredOutput(1000);
+
+    EXPECT_EQ(0, motor.getBalance());
+}
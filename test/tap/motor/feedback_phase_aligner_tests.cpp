@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor_tx_handler.hpp"
+#include "tap/motor/feedback_phase_aligner.hpp"
+
+using namespace tap::motor;
+using tap::can::CanBus;
+
+class FeedbackPhaseAlignerTest : public testing::Test
+{
+protected:
+    FeedbackPhaseAlignerTest() : txHandler(&drivers), aligner(txHandler, CanBus::CAN_BUS1) {}
+
+    tap::Drivers drivers;
+    DjiMotorTxHandler txHandler;
+    FeedbackPhaseAligner aligner;
+};
+
+TEST_F(FeedbackPhaseAlignerTest, first_update_ticks)
+{
+    EXPECT_TRUE(aligner.update(100));
+    EXPECT_FALSE(aligner.update(200));
+}
+
+TEST_F(FeedbackPhaseAlignerTest, ticks_when_every_online_motor_on_aligned_bus_has_reported)
+{
+    aligner.update(0);
+
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 0, 1'300);
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 1, 1'310);
+    EXPECT_TRUE(aligner.update(1'320));
+    EXPECT_EQ(310u, aligner.getBurstPhase(CanBus::CAN_BUS1));
+
+    // the burst isn't complete until both motors report again
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 0, 2'300);
+    EXPECT_FALSE(aligner.update(2'305));
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 1, 2'310);
+    EXPECT_TRUE(aligner.update(2'312));
+    EXPECT_FALSE(aligner.update(2'400));
+
+    EXPECT_EQ(2u, aligner.getBurstCount(CanBus::CAN_BUS1));
+    EXPECT_EQ(0u, aligner.getMissedBursts());
+}
+
+TEST_F(FeedbackPhaseAlignerTest, bursts_on_other_bus_do_not_tick_but_are_measured)
+{
+    aligner.update(0);
+
+    txHandler.recordFeedback(CanBus::CAN_BUS2, 0, 450);
+    EXPECT_FALSE(aligner.update(460));
+
+    EXPECT_TRUE(aligner.isBurstPhaseValid(CanBus::CAN_BUS2));
+    EXPECT_FALSE(aligner.isBurstPhaseValid(CanBus::CAN_BUS1));
+    EXPECT_EQ(450u, aligner.getBurstPhase(CanBus::CAN_BUS2));
+}
+
+TEST_F(FeedbackPhaseAlignerTest, ticks_without_burst_after_period_and_guard_time)
+{
+    aligner.update(0);
+
+    EXPECT_FALSE(aligner.update(FeedbackPhaseAligner::FEEDBACK_PERIOD));
+    EXPECT_TRUE(aligner.update(
+        FeedbackPhaseAligner::FEEDBACK_PERIOD + FeedbackPhaseAligner::DEFAULT_GUARD_TIME));
+    EXPECT_EQ(1u, aligner.getMissedBursts());
+}
+
+TEST_F(FeedbackPhaseAlignerTest, phase_tracks_drifting_feedback_smoothly)
+{
+    // feedback arrives 1 us later every period, and the phase wraps around the period
+    uint32_t time = 990;
+    for (int i = 0; i < 200; i++)
+    {
+        txHandler.recordFeedback(CanBus::CAN_BUS1, 0, time);
+        aligner.update(time + 5);
+        time += 1'001;
+    }
+
+    const uint32_t lastPhase = (time - 1'001) % FeedbackPhaseAligner::FEEDBACK_PERIOD;
+    const int32_t error = static_cast<int32_t>(aligner.getBurstPhase(CanBus::CAN_BUS1)) -
+                          static_cast<int32_t>(lastPhase);
+    EXPECT_LE(std::abs(error), 10);
+}
+
+TEST_F(FeedbackPhaseAlignerTest, markCommandsSent_measures_latency_from_end_of_burst)
+{
+    aligner.update(0);
+    aligner.markCommandsSent(10);
+
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 0, 1'000);
+    txHandler.recordFeedback(CanBus::CAN_BUS1, 1, 1'040);
+    ASSERT_TRUE(aligner.update(1'050));
+    aligner.markCommandsSent(1'240);
+
+    EXPECT_EQ(200u, aligner.getLatency());
+    EXPECT_EQ(2u, aligner.getLatencyHistogram().getCount());
+
+    // without a new tick, nothing is recorded
+    aligner.markCommandsSent(1'500);
+    EXPECT_EQ(2u, aligner.getLatencyHistogram().getCount());
+}
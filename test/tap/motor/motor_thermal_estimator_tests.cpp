@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+#include "tap/motor/motor_thermal_estimator.hpp"
+
+using namespace tap::motor;
+using namespace testing;
+
+static constexpr auto CONFIG = MotorThermalEstimator::M3508_CONFIG;
+static constexpr float DT = 0.001f;
+
+/**
+ * Runs the estimator at a constant current for the given time, reporting the estimated case
+ * temperature as the measured temperature so that the estimate is not corrected.
+ */
+static void runAtCurrent(MotorThermalEstimator &estimator, float current, float time)
+{
+    for (float t = 0; t < time; t += DT)
+    {
+        estimator.update(current, estimator.getCaseTemperature(), 0, DT);
+    }
+}
+
+TEST(MotorThermalEstimator, at_rest_never_reaches_limit_and_is_not_derated)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    runAtCurrent(estimator, 0, 1);
+
+    EXPECT_FLOAT_EQ(CONFIG.ambientTemperature, estimator.getWindingTemperature());
+    EXPECT_EQ(MotorThermalEstimator::NEVER, estimator.getTimeToLimit());
+    EXPECT_EQ(1, estimator.getDeratingFactor());
+    EXPECT_FALSE(estimator.isStalled());
+}
+
+TEST(MotorThermalEstimator, low_current_never_reaches_limit)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    runAtCurrent(estimator, 5, 10);
+
+    EXPECT_GT(estimator.getWindingTemperature(), estimator.getCaseTemperature());
+    EXPECT_EQ(MotorThermalEstimator::NEVER, estimator.getTimeToLimit());
+    EXPECT_EQ(1, estimator.getDeratingFactor());
+}
+
+TEST(MotorThermalEstimator, high_current_predicted_time_to_limit_matches_simulated_time)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    estimator.update(20, CONFIG.ambientTemperature, 0, 0);
+    const float predicted = estimator.getTimeToLimit();
+    ASSERT_GT(predicted, 0);
+
+    float elapsed = 0;
+    while (estimator.getWindingTemperature() < CONFIG.temperatureLimit && elapsed < 1'000)
+    {
+        runAtCurrent(estimator, 20, 0.1f);
+        elapsed += 0.1f;
+    }
+
+    // the prediction holds the case temperature fixed, so it is slightly optimistic
+    EXPECT_NEAR(predicted, elapsed, 0.15f * elapsed);
+    EXPECT_EQ(0, estimator.getTimeToLimit());
+}
+
+TEST(MotorThermalEstimator, derating_factor_decreases_as_limit_approaches)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    float prevFactor = 1;
+    bool derated = false;
+    for (int i = 0; i < 100; i++)
+    {
+        runAtCurrent(estimator, 20, 0.5f);
+        EXPECT_LE(estimator.getDeratingFactor(), prevFactor);
+        prevFactor = estimator.getDeratingFactor();
+        derated |= prevFactor < 1;
+    }
+
+    EXPECT_TRUE(derated);
+    EXPECT_LE(prevFactor, estimator.getContinuousCurrent() / 20);
+}
+
+TEST(MotorThermalEstimator, holding_derated_output_keeps_winding_below_limit)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    float maxWindingTemperature = 0;
+    for (int i = 0; i < 600'000; i++)
+    {
+        float current = 20 * estimator.getDeratingFactor();
+        estimator.update(current, estimator.getCaseTemperature(), 0, DT);
+        maxWindingTemperature = std::max(maxWindingTemperature, estimator.getWindingTemperature());
+    }
+
+    EXPECT_LT(maxWindingTemperature, CONFIG.temperatureLimit + 1);
+    EXPECT_GT(estimator.getWindingTemperature(), CONFIG.temperatureLimit - 10);
+}
+
+TEST(MotorThermalEstimator, case_temperature_corrected_towards_measurement)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    for (int i = 0; i < 10'000; i++)
+    {
+        estimator.update(0, 60, 0, DT);
+    }
+
+    EXPECT_NEAR(60, estimator.getCaseTemperature(), 1);
+}
+
+TEST(MotorThermalEstimator, stalled_after_stall_time_at_high_current_and_low_speed)
+{
+    MotorThermalEstimator estimator(CONFIG);
+
+    for (int i = 0; i < 400; i++)
+    {
+        estimator.update(15, 25, 0, DT);
+    }
+    EXPECT_FALSE(estimator.isStalled());
+
+    for (int i = 0; i < 200; i++)
+    {
+        estimator.update(-15, 25, 5, DT);
+    }
+    EXPECT_TRUE(estimator.isStalled());
+
+    estimator.update(15, 25, 100, DT);
+    EXPECT_FALSE(estimator.isStalled());
+}
+
+TEST(MotorThermalEstimator, update_from_dji_motor_uses_feedback_timestamps)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, MOTOR1, tap::can::CanBus::CAN_BUS1, false, "motor");
+    MotorThermalEstimator estimator(CONFIG);
+
+    uint32_t rxTimestamp = 0;
+    ON_CALL(drivers.canRxHandler, getRxTimestamp).WillByDefault([&]() { return rxTimestamp; });
+
+    // 20 A at 40 degrees C
+    modm::can::Message msg(MOTOR1, 8);
+    msg.setExtended(false);
+    msg.data[4] = 0x40;
+    msg.data[5] = 0x00;
+    msg.data[6] = 40;
+    motor.processMessage(msg);
+
+    estimator.update(motor);
+    EXPECT_FLOAT_EQ(40, estimator.getWindingTemperature());
+
+    // no new feedback, estimate unchanged
+    estimator.update(motor);
+    EXPECT_FLOAT_EQ(40, estimator.getWindingTemperature());
+
+    rxTimestamp += 100'000;
+    motor.processMessage(msg);
+    estimator.update(motor);
+
+    EXPECT_GT(estimator.getWindingTemperature(), 40);
+    EXPECT_GT(estimator.getTimeToLimit(), 0);
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/motor/motor_tx_handler.hpp"
+#include "tap/motor/motor_tx_protocols.hpp"
+
+using namespace tap;
+using namespace tap::motor;
+
+using DjiHandler = MotorTxHandler<DjiMotorTxProtocol, 3>;
+using MitHandler = MotorTxHandler<MitMotorTxProtocol<>, 4>;
+
+TEST(MotorTxHandler, new_handler_has_no_frames)
+{
+    DjiHandler handler;
+
+    EXPECT_EQ(0, handler.getTxFrameCount(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(nullptr, handler.getTxFrame(can::CanBus::CAN_BUS1, 0));
+}
+
+TEST(MotorTxHandler, dji_motors_in_same_group_share_frame)
+{
+    DjiHandler handler;
+
+    auto m1 = handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR1});
+    auto m4 = handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR4});
+    auto m5 = handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR5});
+    auto m7 = handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR7, true});
+
+    ASSERT_TRUE(m1.isValid() && m4.isValid() && m5.isValid() && m7.isValid());
+    EXPECT_EQ(m1.frame, m4.frame);
+    EXPECT_NE(m1.frame, m5.frame);
+    EXPECT_NE(m5.frame, m7.frame);
+    EXPECT_EQ(3, handler.getTxFrameCount(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(0, handler.getTxFrameCount(can::CanBus::CAN_BUS2));
+
+    EXPECT_EQ(
+        DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER,
+        handler.getTxFrame(can::CanBus::CAN_BUS1, m1.frame)->getIdentifier());
+    EXPECT_EQ(
+        DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER,
+        handler.getTxFrame(can::CanBus::CAN_BUS1, m5.frame)->getIdentifier());
+    EXPECT_EQ(
+        DjiMotorTxHandler::CAN_DJI_6020_CURRENT_IDENTIFIER,
+        handler.getTxFrame(can::CanBus::CAN_BUS1, m7.frame)->getIdentifier());
+}
+
+TEST(MotorTxHandler, dji_setCommand_packs_command_into_slot)
+{
+    DjiHandler handler;
+
+    auto m2 = handler.addMotor(can::CanBus::CAN_BUS2, {MOTOR2});
+    auto m3 = handler.addMotor(can::CanBus::CAN_BUS2, {MOTOR3});
+
+    handler.setCommand(m2, 0x1234);
+    handler.setCommand(m3, -2);
+
+    const modm::can::Message *frame = handler.getTxFrame(can::CanBus::CAN_BUS2, m2.frame);
+
+    ASSERT_NE(nullptr, frame);
+    EXPECT_FALSE(frame->isExtended());
+    EXPECT_EQ(8, frame->getLength());
+
+    const uint8_t expected[8] = {0, 0, 0x12, 0x34, 0xff, 0xfe, 0, 0};
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(expected[i], frame->data[i]);
+    }
+}
+
+TEST(MotorTxHandler, addMotor_duplicate_or_invalid_motor_returns_invalid_handle)
+{
+    DjiHandler handler;
+
+    EXPECT_TRUE(handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR1}).isValid());
+    EXPECT_FALSE(handler.addMotor(can::CanBus::CAN_BUS1, {MOTOR1}).isValid());
+    EXPECT_FALSE(handler.addMotor(can::CanBus::CAN_BUS1, {static_cast<MotorId>(MOTOR8 + 1)})
+                     .isValid());
+
+    // same id on the other bus is a different motor
+    EXPECT_TRUE(handler.addMotor(can::CanBus::CAN_BUS2, {MOTOR1}).isValid());
+}
+
+TEST(MotorTxHandler, addMotor_no_free_frames_returns_invalid_handle)
+{
+    MitHandler handler;
+
+    for (uint32_t id = 1; id <= 4; id++)
+    {
+        EXPECT_TRUE(handler.addMotor(can::CanBus::CAN_BUS1, id).isValid());
+    }
+
+    EXPECT_FALSE(handler.addMotor(can::CanBus::CAN_BUS1, 5).isValid());
+}
+
+TEST(MotorTxHandler, removeMotor_frame_without_motors_not_sent_and_reused)
+{
+    MitHandler handler;
+
+    auto m1 = handler.addMotor(can::CanBus::CAN_BUS1, 1);
+    auto m2 = handler.addMotor(can::CanBus::CAN_BUS1, 2);
+
+    EXPECT_TRUE(handler.removeMotor(m1));
+    EXPECT_FALSE(handler.removeMotor(m1));
+    EXPECT_FALSE(handler.contains(m1));
+    EXPECT_TRUE(handler.contains(m2));
+
+    EXPECT_EQ(nullptr, handler.getTxFrame(can::CanBus::CAN_BUS1, m1.frame));
+
+    auto m3 = handler.addMotor(can::CanBus::CAN_BUS1, 3);
+
+    EXPECT_EQ(m1.frame, m3.frame);
+    EXPECT_EQ(2, handler.getTxFrameCount(can::CanBus::CAN_BUS1));
+    EXPECT_EQ(3u, handler.getTxFrame(can::CanBus::CAN_BUS1, m3.frame)->getIdentifier());
+}
+
+TEST(MotorTxHandler, mit_one_frame_per_motor_with_motor_id)
+{
+    MitHandler handler;
+
+    auto m1 = handler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    auto m2 = handler.addMotor(can::CanBus::CAN_BUS1, 0x02);
+
+    EXPECT_NE(m1.frame, m2.frame);
+    EXPECT_EQ(0x01u, handler.getTxFrame(can::CanBus::CAN_BUS1, m1.frame)->getIdentifier());
+    EXPECT_EQ(0x02u, handler.getTxFrame(can::CanBus::CAN_BUS1, m2.frame)->getIdentifier());
+}
+
+TEST(MotorTxHandler, mit_zero_command_packed_at_center_of_symmetric_ranges)
+{
+    MitHandler handler;
+
+    auto m = handler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    const modm::can::Message *frame = handler.getTxFrame(can::CanBus::CAN_BUS1, m.frame);
+
+    // position 0x7fff, velocity 0x7ff, kp 0, kd 0, torque 0x7ff
+    const uint8_t expected[8] = {0x7f, 0xff, 0x7f, 0xf0, 0x00, 0x00, 0x07, 0xff};
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(expected[i], frame->data[i]);
+    }
+}
+
+TEST(MotorTxHandler, mit_command_limited_and_packed)
+{
+    MitHandler handler;
+
+    auto m = handler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+
+    MitMotorTxProtocol<>::Command command;
+    command.position = 100;
+    command.velocity = -100;
+    command.kp = MitMotorLimits::KP_MAX;
+    command.kd = MitMotorLimits::KD_MAX;
+    command.torque = -MitMotorLimits::TORQUE_MAX;
+    handler.setCommand(m, command);
+
+    const modm::can::Message *frame = handler.getTxFrame(can::CanBus::CAN_BUS1, m.frame);
+
+    // position 0xffff, velocity 0, kp 0xfff, kd 0xfff, torque 0
+    const uint8_t expected[8] = {0xff, 0xff, 0x00, 0x0f, 0xff, 0xff, 0xf0, 0x00};
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(expected[i], frame->data[i]);
+    }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/communication/can/can_tx_planner.hpp"
+#include "tap/drivers.hpp"
+#include "tap/mock/dji_motor_mock.hpp"
+#include "tap/motor/motor_tx_handler.hpp"
+#include "tap/motor/motor_tx_protocols.hpp"
+#include "tap/motor/motor_tx_scheduler.hpp"
+
+using namespace testing;
+using namespace tap;
+using namespace tap::motor;
+
+using MitHandler = MotorTxHandler<MitMotorTxProtocol<>, 4>;
+
+class MotorTxSchedulerTest : public Test
+{
+protected:
+    MotorTxSchedulerTest() : scheduler(&drivers) {}
+
+    void SetUp() override
+    {
+        ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+        ON_CALL(drivers.can, sendMessage).WillByDefault(Return(true));
+    }
+
+    static auto hasIdentifier(uint32_t identifier)
+    {
+        return Property(&modm::can::Message::getIdentifier, identifier);
+    }
+
+    Drivers drivers;
+    MotorTxScheduler scheduler;
+    MitHandler mitHandler;
+};
+
+TEST_F(MotorTxSchedulerTest, addSource_rejects_null_duplicate_and_excess_sources)
+{
+    MitHandler handlers[MotorTxScheduler::MAX_SOURCES];
+
+    EXPECT_FALSE(scheduler.addSource(nullptr));
+
+    for (auto &handler : handlers)
+    {
+        EXPECT_TRUE(scheduler.addSource(&handler));
+    }
+
+    EXPECT_FALSE(scheduler.addSource(&handlers[0]));
+    EXPECT_FALSE(scheduler.addSource(&mitHandler));
+    EXPECT_EQ(MotorTxScheduler::MAX_SOURCES, scheduler.getSourceCount());
+}
+
+TEST_F(MotorTxSchedulerTest, encodeAndSendCanData_no_sources_sends_nothing)
+{
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    scheduler.encodeAndSendCanData();
+}
+
+TEST_F(MotorTxSchedulerTest, encodeAndSendCanData_sends_frames_with_motors_in_order)
+{
+    auto m1 = mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x02);
+    mitHandler.addMotor(can::CanBus::CAN_BUS2, 0x03);
+    mitHandler.removeMotor(m1);
+
+    scheduler.addSource(&mitHandler);
+
+    InSequence seq;
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, hasIdentifier(0x02)));
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS2, hasIdentifier(0x03)));
+
+    scheduler.encodeAndSendCanData();
+}
+
+TEST_F(MotorTxSchedulerTest, encodeAndSendCanData_dji_and_mit_motors_share_bus)
+{
+    NiceMock<mock::DjiMotorMock> djiMotor(&drivers, MOTOR1, can::CanBus::CAN_BUS1, false, "dji");
+    ON_CALL(djiMotor, getMotorIdentifier).WillByDefault(Return(MOTOR1));
+    ON_CALL(djiMotor, getCanBus).WillByDefault(Return(can::CanBus::CAN_BUS1));
+
+    DjiMotorTxHandler djiMotorTxHandler(&drivers);
+    djiMotorTxHandler.addMotorToManager(&djiMotor);
+
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+
+    scheduler.addSource(&djiMotorTxHandler);
+    scheduler.addSource(&mitHandler);
+
+    InSequence seq;
+    EXPECT_CALL(
+        drivers.can,
+        sendMessage(
+            can::CanBus::CAN_BUS1,
+            hasIdentifier(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER)));
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, hasIdentifier(0x01)));
+
+    scheduler.encodeAndSendCanData();
+
+    djiMotorTxHandler.removeFromMotorManager(djiMotor);
+}
+
+TEST_F(MotorTxSchedulerTest, sendPendingFrames_sends_frames_queued_while_bus_busy)
+{
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x02);
+    scheduler.addSource(&mitHandler);
+
+    EXPECT_CALL(drivers.can, isReadyToSend(can::CanBus::CAN_BUS1))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, hasIdentifier(0x01)));
+
+    scheduler.encodeAndSendCanData();
+
+    EXPECT_EQ(0b10u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+
+    EXPECT_CALL(drivers.can, sendMessage(can::CanBus::CAN_BUS1, hasIdentifier(0x02)));
+
+    scheduler.sendPendingFrames();
+
+    EXPECT_EQ(0u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+}
+
+TEST_F(MotorTxSchedulerTest, setTxPlan_holds_each_frame_until_its_planned_offset)
+{
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x02);
+    scheduler.addSource(&mitHandler);
+
+    // A burst of feedback from other nodes at the start of the tick
+    can::CanTxPlanner planner;
+    for (uint16_t id = 0x201; id <= 0x204; id++)
+    {
+        planner.addFixedFrame(id, 8, 1'000, 0);
+    }
+    planner.addTxFrame(0x01, 8, 1'000);
+    planner.addTxFrame(0x02, 8, 1'000);
+    ASSERT_TRUE(planner.plan());
+    ASSERT_GT(planner.getOffset(0x01), 0u);
+    ASSERT_GT(planner.getOffset(0x02), 0u);
+
+    scheduler.setTxPlan(can::CanBus::CAN_BUS1, &planner);
+
+    arch::clock::enableVirtualTime();
+    uint32_t sendTimes[3] = {};
+    ON_CALL(drivers.can, sendMessage)
+        .WillByDefault([&](can::CanBus, const modm::can::Message &message) {
+            sendTimes[message.getIdentifier()] = arch::clock::getVirtualTimeMicroseconds();
+            return true;
+        });
+    EXPECT_CALL(drivers.can, sendMessage).Times(2);
+
+    scheduler.encodeAndSendCanData();
+    EXPECT_EQ(0b11u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+    for (int i = 0; i < 100; i++)
+    {
+        arch::clock::advance(10);
+        scheduler.sendPendingFrames();
+    }
+    arch::clock::disableVirtualTime();
+
+    EXPECT_EQ(planner.getOffset(0x01), sendTimes[0x01]);
+    EXPECT_EQ(planner.getOffset(0x02), sendTimes[0x02]);
+}
+
+TEST_F(MotorTxSchedulerTest, encodeAndSendCanData_superseded_frames_recorded_as_drops)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    mitHandler.addMotor(can::CanBus::CAN_BUS2, 0x01);
+    mitHandler.addMotor(can::CanBus::CAN_BUS2, 0x02);
+    scheduler.addSource(&mitHandler);
+
+    scheduler.encodeAndSendCanData();
+    scheduler.encodeAndSendCanData();
+
+    EXPECT_EQ(2u, drivers.can.getBusStats(can::CanBus::CAN_BUS2).txDrops);
+    EXPECT_EQ(0u, drivers.can.getBusStats(can::CanBus::CAN_BUS1).txDrops);
+}
+
+TEST_F(MotorTxSchedulerTest, sendPendingFrames_frame_of_removed_motor_not_sent)
+{
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(false));
+
+    auto m = mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    scheduler.addSource(&mitHandler);
+
+    scheduler.encodeAndSendCanData();
+    mitHandler.removeMotor(m);
+
+    ON_CALL(drivers.can, isReadyToSend).WillByDefault(Return(true));
+    EXPECT_CALL(drivers.can, sendMessage).Times(0);
+
+    scheduler.sendPendingFrames();
+
+    EXPECT_EQ(0u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+}
+
+TEST_F(MotorTxSchedulerTest, sendPendingFrames_error_and_frame_kept_if_send_fails)
+{
+    mitHandler.addMotor(can::CanBus::CAN_BUS1, 0x01);
+    scheduler.addSource(&mitHandler);
+
+    EXPECT_CALL(drivers.can, sendMessage).WillOnce(Return(false)).WillOnce(Return(true));
+    EXPECT_CALL(drivers.errorController, addToErrorList);
+
+    scheduler.encodeAndSendCanData();
+    EXPECT_EQ(0b1u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+
+    scheduler.sendPendingFrames();
+    EXPECT_EQ(0u, scheduler.getPendingFrames(0, can::CanBus::CAN_BUS1));
+}
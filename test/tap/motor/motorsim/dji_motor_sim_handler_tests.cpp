@@ -38,19 +38,19 @@ class DjiMotorSimHandlerTest : public Test
 
 TEST_F(DjiMotorSimHandlerTest, registering_sims_then_resetting)
 {
-    std::shared_ptr<MotorSim> sim1(new MotorSim(MotorSim::M3508_CONFIG));
-    std::shared_ptr<MotorSim> sim2(new MotorSim(MotorSim::M3508_CONFIG));
+    MotorSim sim1(MotorSim::M3508_CONFIG);
+    MotorSim sim2(MotorSim::M3508_CONFIG);
 
-    sim1->setMotorInput(MotorSim::M3508_CONFIG.maxInputMag);
-    sim2->setMotorInput(-MotorSim::M3508_CONFIG.maxInputMag);
+    sim1.setMotorInput(MotorSim::M3508_CONFIG.maxInputMag);
+    sim2.setMotorInput(-MotorSim::M3508_CONFIG.maxInputMag);
 
-    handler.registerSim(sim1, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS1, MOTOR2));
-    handler.registerSim(sim2, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS2, MOTOR5));
+    handler.registerSim(&sim1, CanBus::CAN_BUS1, MOTOR2);
+    handler.registerSim(&sim2, CanBus::CAN_BUS2, MOTOR5);
 
     handler.resetMotorSims();
 
-    EXPECT_EQ(0, sim1->getCurrent());
-    EXPECT_EQ(0, sim2->getCurrent());
+    EXPECT_EQ(0, sim1.getCurrent());
+    EXPECT_EQ(0, sim2.getCurrent());
 }
 
 TEST_F(DjiMotorSimHandlerTest, parseMotorMessage_no_sims_registered)
@@ -66,16 +66,16 @@ TEST_F(DjiMotorSimHandlerTest, parseMotorMessage_single_sim_registered_low_mid)
     uint8_t inData[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
     modm::can::Message msgLow(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER, 8, inData, false);
     modm::can::Message msgHigh(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER, 8, inData, false);
-    std::shared_ptr<MotorSim> sim(new MotorSim(MotorSim::M3508_CONFIG));
-    handler.registerSim(sim, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS1, MOTOR1));
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS1, MOTOR1);
 
-    EXPECT_EQ(0, sim->getCurrent());
+    EXPECT_EQ(0, sim.getCurrent());
 
     EXPECT_FALSE(handler.parseMotorMessage(CanBus::CAN_BUS1, msgHigh));
-    EXPECT_EQ(0, sim->getCurrent());
+    EXPECT_EQ(0, sim.getCurrent());
 
     EXPECT_TRUE(handler.parseMotorMessage(CanBus::CAN_BUS1, msgLow));
-    EXPECT_NE(0, sim->getCurrent());
+    EXPECT_NE(0, sim.getCurrent());
 }
 
 TEST_F(DjiMotorSimHandlerTest, parseMotorMessage_single_sim_registered_high_mid_can2)
@@ -83,19 +83,19 @@ TEST_F(DjiMotorSimHandlerTest, parseMotorMessage_single_sim_registered_high_mid_
     uint8_t inData[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
     modm::can::Message msgLow(DjiMotorTxHandler::CAN_DJI_LOW_IDENTIFIER, 8, inData, false);
     modm::can::Message msgHigh(DjiMotorTxHandler::CAN_DJI_HIGH_IDENTIFIER, 8, inData, false);
-    std::shared_ptr<MotorSim> sim(new MotorSim(MotorSim::M3508_CONFIG));
-    handler.registerSim(sim, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS2, MOTOR8));
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS2, MOTOR8);
 
-    EXPECT_EQ(0, sim->getCurrent());
+    EXPECT_EQ(0, sim.getCurrent());
 
     EXPECT_FALSE(handler.parseMotorMessage(CanBus::CAN_BUS1, msgHigh));
-    EXPECT_EQ(0, sim->getCurrent());
+    EXPECT_EQ(0, sim.getCurrent());
 
     EXPECT_FALSE(handler.parseMotorMessage(CanBus::CAN_BUS2, msgLow));
-    EXPECT_EQ(0, sim->getCurrent());
+    EXPECT_EQ(0, sim.getCurrent());
 
     EXPECT_TRUE(handler.parseMotorMessage(CanBus::CAN_BUS2, msgHigh));
-    EXPECT_NE(0, sim->getCurrent());
+    EXPECT_NE(0, sim.getCurrent());
 }
 
 TEST_F(DjiMotorSimHandlerTest, encodeMessage_nullptr_msg_return_false)
@@ -116,8 +116,8 @@ TEST_F(DjiMotorSimHandlerTest, encodeMessage_can1_message_only_can2_motors_regis
     modm::can::Message msg(static_cast<uint32_t>(MOTOR1), 8);
     msg.setExtended(false);
 
-    std::shared_ptr<MotorSim> sim(new MotorSim(MotorSim::M3508_CONFIG));
-    handler.registerSim(sim, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS2, MOTOR1));
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS2, MOTOR1);
 
     EXPECT_FALSE(handler.encodeMessage(CanBus::CAN_BUS1, &msg));
 }
@@ -127,12 +127,12 @@ TEST_F(DjiMotorSimHandlerTest, encodeMessage_encodes_motor_data)
     modm::can::Message msg(0, 8);
     msg.setExtended(false);
 
-    std::shared_ptr<MotorSim> sim(new MotorSim(MotorSim::M3508_CONFIG));
-    sim->setMotorInput(1'000);
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    sim.setMotorInput(1'000);
     clock.time += 1'000;
-    sim->update();
+    sim.update();
 
-    handler.registerSim(sim, std::tuple<CanBus, MotorId>(CanBus::CAN_BUS1, MOTOR4));
+    handler.registerSim(&sim, CanBus::CAN_BUS1, MOTOR4);
 
     EXPECT_TRUE(handler.encodeMessage(CanBus::CAN_BUS1, &msg));
 
@@ -140,5 +140,104 @@ TEST_F(DjiMotorSimHandlerTest, encodeMessage_encodes_motor_data)
         (static_cast<int16_t>(msg.data[2]) << 8) | (static_cast<int16_t>(msg.data[3]) & 0xff);
 
     EXPECT_EQ(static_cast<uint32_t>(MOTOR4), msg.identifier);
-    EXPECT_EQ(sim->getRPM(), reportedRPM);
+    EXPECT_EQ(sim.getRPM(), reportedRPM);
+}
+
+TEST_F(DjiMotorSimHandlerTest, getSim_returns_registered_sim_until_unregistered)
+{
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS2, MOTOR3);
+
+    EXPECT_EQ(&sim, handler.getSim(CanBus::CAN_BUS2, MOTOR3));
+    EXPECT_EQ(nullptr, handler.getSim(CanBus::CAN_BUS1, MOTOR3));
+
+    handler.unregisterSim(CanBus::CAN_BUS2, MOTOR3);
+
+    EXPECT_EQ(nullptr, handler.getSim(CanBus::CAN_BUS2, MOTOR3));
+}
+
+TEST_F(DjiMotorSimHandlerTest, encodePendingFeedback_encodes_every_sim_on_bus_in_id_order)
+{
+    modm::can::Message msgs[DjiMotorTxHandler::DJI_MOTORS_PER_CAN];
+    MotorSim sims[3] = {
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG)};
+    handler.registerSim(&sims[0], CanBus::CAN_BUS1, MOTOR7);
+    handler.registerSim(&sims[1], CanBus::CAN_BUS1, MOTOR2);
+    handler.registerSim(&sims[2], CanBus::CAN_BUS2, MOTOR1);
+
+    EXPECT_EQ(2, handler.encodePendingFeedback(CanBus::CAN_BUS1, msgs, 8));
+
+    EXPECT_EQ(static_cast<uint32_t>(MOTOR2), msgs[0].identifier);
+    EXPECT_EQ(static_cast<uint32_t>(MOTOR7), msgs[1].identifier);
+}
+
+TEST_F(DjiMotorSimHandlerTest, encodePendingFeedback_leaves_frames_that_do_not_fit_pending)
+{
+    modm::can::Message msgs[DjiMotorTxHandler::DJI_MOTORS_PER_CAN];
+    MotorSim sim1(MotorSim::M3508_CONFIG);
+    MotorSim sim2(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim1, CanBus::CAN_BUS1, MOTOR1);
+    handler.registerSim(&sim2, CanBus::CAN_BUS1, MOTOR8);
+
+    EXPECT_EQ(1, handler.encodePendingFeedback(CanBus::CAN_BUS1, msgs, 1));
+    EXPECT_EQ(static_cast<uint32_t>(MOTOR1), msgs[0].identifier);
+
+    EXPECT_EQ(1, handler.encodePendingFeedback(CanBus::CAN_BUS1, msgs, 8));
+    EXPECT_EQ(static_cast<uint32_t>(MOTOR8), msgs[0].identifier);
+}
+
+TEST_F(DjiMotorSimHandlerTest, encodePendingFeedback_each_sim_reports_once_per_feedback_period)
+{
+    modm::can::Message msgs[DjiMotorTxHandler::DJI_MOTORS_PER_CAN];
+    MotorSim sims[DjiMotorTxHandler::DJI_MOTORS_PER_CAN] = {
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG),
+        MotorSim(MotorSim::M3508_CONFIG)};
+    for (int i = 0; i < DjiMotorTxHandler::DJI_MOTORS_PER_CAN; i++)
+    {
+        handler.registerSim(&sims[i], CanBus::CAN_BUS1, NORMALIZED_ID_TO_DJI_MOTOR(i));
+    }
+
+    int total = 0;
+    for (int ms = 0; ms < 100; ms++)
+    {
+        int encoded = handler.encodePendingFeedback(CanBus::CAN_BUS1, msgs, 8);
+        EXPECT_EQ(DjiMotorTxHandler::DJI_MOTORS_PER_CAN, encoded);
+        EXPECT_EQ(0, handler.encodePendingFeedback(CanBus::CAN_BUS1, msgs, 8));
+        total += encoded;
+        clock.time++;
+    }
+
+    EXPECT_EQ(100 * DjiMotorTxHandler::DJI_MOTORS_PER_CAN, total);
+}
+
+TEST_F(DjiMotorSimHandlerTest, resetMotorSims_makes_feedback_pending_again)
+{
+    modm::can::Message msg;
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS1, MOTOR1);
+
+    EXPECT_TRUE(handler.encodeMessage(CanBus::CAN_BUS1, &msg));
+    EXPECT_FALSE(handler.encodeMessage(CanBus::CAN_BUS1, &msg));
+
+    handler.resetMotorSims();
+
+    EXPECT_TRUE(handler.encodeMessage(CanBus::CAN_BUS1, &msg));
+}
+
+TEST_F(DjiMotorSimHandlerTest, parseMotorMessage_unknown_identifier_returns_false)
+{
+    uint8_t inData[8] = {};
+    modm::can::Message msg(0x123, 8, inData, false);
+    MotorSim sim(MotorSim::M3508_CONFIG);
+    handler.registerSim(&sim, CanBus::CAN_BUS1, MOTOR1);
+
+    EXPECT_FALSE(handler.parseMotorMessage(CanBus::CAN_BUS1, msg));
 }
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/motor/motorsim/motor_sim_engine.hpp"
+
+using namespace testing;
+using namespace tap::motor::motorsim;
+
+static constexpr float DT = 0.001f;
+
+TEST(MotorSimEngine, addMotor_returns_invalid_motor_when_full)
+{
+    MotorSimEngine engine;
+
+    for (int i = 0; i < MotorSimEngine::MAX_MOTORS; i++)
+    {
+        EXPECT_EQ(i, engine.addMotor(MotorSimEngine::M3508_PARAMETERS));
+    }
+
+    EXPECT_EQ(MotorSimEngine::INVALID_MOTOR, engine.addMotor(MotorSimEngine::M3508_PARAMETERS));
+    EXPECT_EQ(MotorSimEngine::MAX_MOTORS, engine.getMotorCount());
+}
+
+TEST(MotorSimEngine, no_input_motor_stays_at_rest)
+{
+    MotorSimEngine engine;
+    int motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS);
+
+    engine.run(DT, 1'000);
+
+    EXPECT_EQ(0, engine.getRotorVelocity(motor));
+    EXPECT_EQ(0, engine.getRotorPosition(motor));
+    EXPECT_EQ(0, engine.getCurrent(motor));
+    EXPECT_NEAR(1.0, engine.getTime(), 1e-6);
+}
+
+TEST(MotorSimEngine, step_non_positive_dt_does_nothing)
+{
+    MotorSimEngine engine;
+    int motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS);
+    engine.setInput(motor, 1'000);
+
+    engine.step(0);
+    engine.step(-DT);
+
+    EXPECT_EQ(0, engine.getCurrent(motor));
+    EXPECT_EQ(0, engine.getTime());
+}
+
+TEST(MotorSimEngine, setInput_limited_to_max_input)
+{
+    MotorSimEngine engine;
+    int motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS);
+
+    engine.setInput(motor, INT16_MAX);
+    EXPECT_EQ(MotorSimEngine::M3508_PARAMETERS.maxInput, engine.getInput(motor));
+
+    engine.setInput(motor, INT16_MIN);
+    EXPECT_EQ(-MotorSimEngine::M3508_PARAMETERS.maxInput, engine.getInput(motor));
+}
+
+TEST(MotorSimEngine, current_controlled_motor_tracks_desired_current)
+{
+    MotorSimEngine engine;
+    // a large inertia keeps the motor slow, so the supply voltage does not limit the current
+    int motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS, 100);
+
+    engine.setInput(motor, MotorSimEngine::M3508_PARAMETERS.maxInput / 4);
+    engine.run(DT, 10);
+
+    EXPECT_NEAR(MotorSimEngine::M3508_PARAMETERS.maxCurrent / 4, engine.getCurrent(motor), 0.05f);
+    EXPECT_GT(engine.getRotorVelocity(motor), 0);
+}
+
+TEST(MotorSimEngine, current_controlled_motor_no_load_speed_limited_by_back_emf)
+{
+    const auto &p = MotorSimEngine::M3508_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p);
+
+    engine.setInput(motor, p.maxInput);
+    engine.run(DT, 2'000);
+
+    const float noLoadSpeed = p.supplyVoltage / p.ke;
+    EXPECT_NEAR(noLoadSpeed, engine.getRotorVelocity(motor), 0.02f * noLoadSpeed);
+    EXPECT_NEAR(p.supplyVoltage, engine.getVoltage(motor), 1e-3f);
+    EXPECT_LT(engine.getCurrent(motor), 1);
+    EXPECT_GT(engine.getRPM(motor), 0);
+}
+
+TEST(MotorSimEngine, voltage_controlled_motor_no_load_speed_proportional_to_input)
+{
+    const auto &p = MotorSimEngine::GM6020_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p);
+
+    engine.setInput(motor, -p.maxInput / 2);
+    engine.run(DT, 3'000);
+
+    const float noLoadSpeed = -p.supplyVoltage / 2 / p.ke;
+    EXPECT_NEAR(noLoadSpeed, engine.getRotorVelocity(motor), 0.05f * -noLoadSpeed);
+    EXPECT_LT(engine.getRPM(motor), 0);
+}
+
+TEST(MotorSimEngine, load_torque_reduces_speed)
+{
+    const auto &p = MotorSimEngine::GM6020_PARAMETERS;
+    MotorSimEngine engine;
+    int unloaded = engine.addMotor(p);
+    int loaded = engine.addMotor(p);
+
+    engine.setInput(unloaded, p.maxInput / 2);
+    engine.setInput(loaded, p.maxInput / 2);
+    engine.setLoad(loaded, 0.5f);
+    engine.run(DT, 3'000);
+
+    EXPECT_GT(engine.getRotorVelocity(loaded), 0);
+    EXPECT_LT(engine.getRotorVelocity(loaded), engine.getRotorVelocity(unloaded));
+    EXPECT_GT(engine.getCurrent(loaded), engine.getCurrent(unloaded));
+}
+
+TEST(MotorSimEngine, load_back_drives_unpowered_motor)
+{
+    const auto &p = MotorSimEngine::GM6020_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p, 0.01f);
+
+    engine.setLoad(motor, 0.5f);
+    engine.run(DT, 100);
+
+    EXPECT_LT(engine.getRotorVelocity(motor), 0);
+    EXPECT_LT(engine.getOutputPosition(motor), 0);
+}
+
+TEST(MotorSimEngine, output_shaft_does_not_move_until_backlash_taken_up)
+{
+    const auto &p = MotorSimEngine::M3508_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p, 1e-3f);
+
+    EXPECT_FALSE(engine.isEngaged(motor));
+
+    engine.setInput(motor, p.maxInput / 100);
+
+    // the rotor must turn half the backlash times the gear ratio before engaging
+    while (engine.getRotorPosition(motor) < p.backlash / 2 * p.gearRatio)
+    {
+        EXPECT_FALSE(engine.isEngaged(motor));
+        EXPECT_EQ(0, engine.getOutputPosition(motor));
+        engine.step(DT / 10);
+    }
+
+    engine.run(DT, 100);
+
+    EXPECT_TRUE(engine.isEngaged(motor));
+    EXPECT_GT(engine.getOutputPosition(motor), 0);
+    EXPECT_NEAR(
+        engine.getRotorVelocity(motor) / p.gearRatio,
+        engine.getOutputVelocity(motor),
+        1e-5f);
+}
+
+TEST(MotorSimEngine, reversing_motor_crosses_backlash_before_output_reverses)
+{
+    const auto &p = MotorSimEngine::M3508_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p, 1e-3f);
+
+    engine.setInput(motor, p.maxInput / 10);
+    engine.run(DT, 200);
+    ASSERT_TRUE(engine.isEngaged(motor));
+
+    engine.setInput(motor, -p.maxInput / 10);
+
+    bool separated = false;
+    for (int i = 0; i < 1'000 && !separated; i++)
+    {
+        engine.step(DT / 10);
+        separated = !engine.isEngaged(motor);
+    }
+
+    EXPECT_TRUE(separated);
+
+    engine.run(DT, 500);
+
+    EXPECT_TRUE(engine.isEngaged(motor));
+    EXPECT_LT(engine.getOutputVelocity(motor), 0);
+}
+
+TEST(MotorSimEngine, getEncoder_wraps_rotor_position)
+{
+    const auto &p = MotorSimEngine::GM6020_PARAMETERS;
+    MotorSimEngine engine;
+    int motor = engine.addMotor(p);
+
+    engine.setInput(motor, -p.maxInput / 4);
+    engine.run(DT, 1'000);
+
+    ASSERT_LT(engine.getRotorPosition(motor), -2 * M_PI);
+
+    double revolutions = engine.getRotorPosition(motor) / (2 * M_PI);
+    double fraction = revolutions - std::floor(revolutions);
+    EXPECT_NEAR(fraction * MotorSimEngine::ENC_RESOLUTION, engine.getEncoder(motor), 1);
+}
+
+TEST(MotorSimEngine, runs_are_deterministic_and_reset_restores_initial_state)
+{
+    auto simulate = [](MotorSimEngine &engine)
+    {
+        int a = engine.addMotor(MotorSimEngine::M3508_PARAMETERS, 1e-3f);
+        int b = engine.addMotor(MotorSimEngine::GM6020_PARAMETERS, 1e-2f);
+
+        for (int i = 0; i < 1'000; i++)
+        {
+            engine.setInput(a, static_cast<int16_t>((i % 200) * 50 - 5'000));
+            engine.setInput(b, static_cast<int16_t>(10'000 - (i % 300) * 60));
+            engine.setLoad(b, 0.1f);
+            engine.step(DT);
+        }
+    };
+
+    MotorSimEngine engine1;
+    MotorSimEngine engine2;
+    simulate(engine1);
+    simulate(engine2);
+
+    for (int motor = 0; motor < 2; motor++)
+    {
+        EXPECT_EQ(engine1.getRotorPosition(motor), engine2.getRotorPosition(motor));
+        EXPECT_EQ(engine1.getRotorVelocity(motor), engine2.getRotorVelocity(motor));
+        EXPECT_EQ(engine1.getCurrent(motor), engine2.getCurrent(motor));
+        EXPECT_EQ(engine1.getOutputPosition(motor), engine2.getOutputPosition(motor));
+    }
+
+    engine1.reset();
+
+    EXPECT_EQ(0, engine1.getTime());
+    EXPECT_EQ(0, engine1.getRotorPosition(0));
+    EXPECT_EQ(0, engine1.getRotorVelocity(1));
+    EXPECT_EQ(0, engine1.getInput(1));
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/algorithms/math_user_utils.hpp"
+#include "tap/motor/motorsim/rigid_body_sim.hpp"
+
+using namespace testing;
+using namespace tap::motor::motorsim;
+using tap::algorithms::ACCELERATION_GRAVITY;
+
+static constexpr float DT = 0.001f;
+
+static constexpr RigidBodySim::Config BODY_CONFIG = {
+    .inertia = {0.1f, 0.2f, 0.4f},
+    .damping = {},
+};
+
+TEST(RigidBodySim, at_rest_reads_gravity_along_z)
+{
+    MotorSimEngine engine;
+    RigidBodySim body(engine, BODY_CONFIG);
+
+    for (int i = 0; i < 100; i++)
+    {
+        body.step(DT);
+    }
+
+    EXPECT_EQ(0, body.getAngularVelocity(RigidBodySim::Z));
+    EXPECT_EQ(0, body.getYaw());
+    EXPECT_NEAR(0, body.getSpecificForce(RigidBodySim::X), 1e-6f);
+    EXPECT_NEAR(0, body.getSpecificForce(RigidBodySim::Y), 1e-6f);
+    EXPECT_NEAR(ACCELERATION_GRAVITY, body.getSpecificForce(RigidBodySim::Z), 1e-6f);
+}
+
+TEST(RigidBodySim, external_torque_accelerates_body_about_axis)
+{
+    MotorSimEngine engine;
+    RigidBodySim body(engine, BODY_CONFIG);
+
+    body.setExternalTorque(RigidBodySim::Z, 0.4f);
+    for (int i = 0; i < 1'000; i++)
+    {
+        body.step(DT);
+    }
+
+    // 1 rad/s^2 for 1 second
+    EXPECT_NEAR(1, body.getAngularAcceleration(RigidBodySim::Z), 1e-6f);
+    EXPECT_NEAR(1, body.getAngularVelocity(RigidBodySim::Z), 1e-3f);
+    EXPECT_NEAR(0.5f, body.getYaw(), 2e-3f);
+    EXPECT_NEAR(0, body.getPitch(), 1e-6f);
+    EXPECT_NEAR(0, body.getRoll(), 1e-6f);
+}
+
+TEST(RigidBodySim, damping_limits_angular_velocity)
+{
+    MotorSimEngine engine;
+    RigidBodySim::Config config = BODY_CONFIG;
+    config.damping[RigidBodySim::Y] = 0.5f;
+    RigidBodySim body(engine, config);
+
+    body.setExternalTorque(RigidBodySim::Y, 0.1f);
+    for (int i = 0; i < 5'000; i++)
+    {
+        body.step(DT);
+    }
+
+    EXPECT_NEAR(0.2f, body.getAngularVelocity(RigidBodySim::Y), 1e-3f);
+}
+
+TEST(RigidBodySim, actuator_applies_scaled_motor_output_torque)
+{
+    MotorSimEngine engine;
+    int motor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS, 100);
+    RigidBodySim body(engine, BODY_CONFIG);
+    ASSERT_TRUE(body.addActuator(motor, RigidBodySim::Z, -0.5f));
+
+    engine.setInput(motor, MotorSimEngine::M3508_PARAMETERS.maxInput / 4);
+    engine.step(DT);
+    body.step(DT);
+
+    EXPECT_GT(engine.getOutputTorque(motor), 0);
+    EXPECT_NEAR(
+        -0.5f * engine.getOutputTorque(motor) / BODY_CONFIG.inertia[RigidBodySim::Z],
+        body.getAngularAcceleration(RigidBodySim::Z),
+        1e-4f);
+    EXPECT_LT(body.getAngularVelocity(RigidBodySim::Z), 0);
+}
+
+TEST(RigidBodySim, addActuator_fails_when_full)
+{
+    MotorSimEngine engine;
+    RigidBodySim body(engine, BODY_CONFIG);
+
+    for (int i = 0; i < RigidBodySim::MAX_ACTUATORS; i++)
+    {
+        EXPECT_TRUE(body.addActuator(0, RigidBodySim::X, 1));
+    }
+
+    EXPECT_FALSE(body.addActuator(0, RigidBodySim::X, 1));
+}
+
+TEST(RigidBodySim, pitched_body_reads_gravity_along_x)
+{
+    MotorSimEngine engine;
+    RigidBodySim body(engine, BODY_CONFIG);
+
+    body.setExternalTorque(RigidBodySim::Y, 0.2f);
+    for (int i = 0; i < 500; i++)
+    {
+        body.step(DT);
+    }
+
+    ASSERT_GT(body.getPitch(), 0.1f);
+    EXPECT_NEAR(
+        -ACCELERATION_GRAVITY * sinf(body.getPitch()),
+        body.getSpecificForce(RigidBodySim::X),
+        1e-5f);
+    EXPECT_NEAR(
+        ACCELERATION_GRAVITY * cosf(body.getPitch()),
+        body.getSpecificForce(RigidBodySim::Z),
+        1e-5f);
+}
+
+TEST(RigidBodySim, reset_puts_body_at_rest)
+{
+    MotorSimEngine engine;
+    RigidBodySim body(engine, BODY_CONFIG);
+    body.setExternalTorque(RigidBodySim::X, 1);
+    body.step(DT);
+
+    body.reset();
+    body.step(DT);
+
+    EXPECT_EQ(0, body.getAngularVelocity(RigidBodySim::X));
+    EXPECT_EQ(0, body.getRoll());
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/drivers.hpp"
+#include "tap/motor/dji_motor.hpp"
+#include "tap/motor/motorsim/scenario_runner.hpp"
+#include "tap/stub/terminal_device_stub.hpp"
+
+#include "modm/io/iostream.hpp"
+
+using namespace testing;
+using namespace tap::motor::motorsim;
+using tap::motor::DjiMotor;
+
+/// A measurement that moves towards its setpoint by 1 each control period.
+struct RateLimitedPlant
+{
+    float setpoint = 0;
+    float measured = 0;
+    int controlLoopCalls = 0;
+};
+
+static void runPlant(void *context)
+{
+    auto *plant = static_cast<RateLimitedPlant *>(context);
+    plant->controlLoopCalls++;
+    if (plant->measured < plant->setpoint)
+    {
+        plant->measured = std::min(plant->measured + 1, plant->setpoint);
+    }
+    else
+    {
+        plant->measured = std::max(plant->measured - 1, plant->setpoint);
+    }
+}
+
+static float getSetpoint(const void *context)
+{
+    return static_cast<const RateLimitedPlant *>(context)->setpoint;
+}
+
+static float getMeasured(const void *context)
+{
+    return static_cast<const RateLimitedPlant *>(context)->measured;
+}
+
+static void setSetpoint10(void *context)
+{
+    static_cast<RateLimitedPlant *>(context)->setpoint = 10;
+}
+
+static void doNothing(void *) {}
+
+TEST(ScenarioRunner, run_calls_control_loop_each_period_in_virtual_time)
+{
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    ScenarioRunner runner(engine, runPlant, &plant);
+
+    runner.run({"idle", 100, nullptr, 0});
+
+    EXPECT_EQ(100, plant.controlLoopCalls);
+    EXPECT_EQ(100u, runner.getControlLoopResult().calls);
+    EXPECT_FALSE(tap::arch::clock::isVirtualTimeEnabled());
+}
+
+TEST(ScenarioRunner, events_called_at_first_period_at_or_after_their_time)
+{
+    MotorSimEngine engine;
+    uint32_t eventTimes[2] = {};
+    auto recordTime = [](void *context) {
+        *static_cast<uint32_t *>(context) = tap::arch::clock::getTimeMicroseconds();
+    };
+    const ScenarioRunner::Event events[] = {
+        {0, recordTime, &eventTimes[0]},
+        {5, recordTime, &eventTimes[1]},
+    };
+    ScenarioRunner runner(engine, doNothing, nullptr, {.controlPeriod = 2'000, .physicsSteps = 1});
+
+    runner.run({"events", 10, events, 2});
+
+    EXPECT_EQ(0u, eventTimes[0]);
+    EXPECT_EQ(6'000u, eventTimes[1]);
+}
+
+TEST(ScenarioRunner, engine_and_backends_stepped_physics_steps_times_per_period)
+{
+    MotorSimEngine engine;
+    double backendTime = 0;
+    auto stepBackend = [](void *context, float dt) { *static_cast<double *>(context) += dt; };
+    ScenarioRunner runner(engine, doNothing, nullptr, {.controlPeriod = 1'000, .physicsSteps = 4});
+    runner.addBackend(stepBackend, &backendTime);
+
+    runner.run({"physics", 10, nullptr, 0});
+
+    EXPECT_NEAR(0.01, engine.getTime(), 1e-6);
+    EXPECT_NEAR(0.01, backendTime, 1e-6);
+}
+
+TEST(ScenarioRunner, tracking_metric_measures_error_and_settling_time)
+{
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    const ScenarioRunner::Event events[] = {{100, setSetpoint10, &plant}};
+    ScenarioRunner runner(engine, runPlant, &plant);
+    runner.addTrackingMetric("plant", getSetpoint, getMeasured, &plant, 0.5f);
+
+    runner.run({"step", 200, events, 1});
+
+    // Sampled errors of 9, 8, ..., 1 after the step, so settled 9 periods after it started
+    const ScenarioRunner::TrackingResult &result = runner.getTrackingResult(0);
+    EXPECT_EQ(1, result.steps);
+    EXPECT_EQ(0, result.unsettledSteps);
+    EXPECT_NEAR(0.009f, result.meanSettlingTime, 1e-6f);
+    EXPECT_NEAR(0.009f, result.maxSettlingTime, 1e-6f);
+    EXPECT_FLOAT_EQ(9, result.maxError);
+    EXPECT_NEAR(sqrtf(285.0f / 200), result.rmsError, 1e-5f);
+}
+
+TEST(ScenarioRunner, tracking_metric_counts_step_unsettled_at_end_of_scenario)
+{
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    const ScenarioRunner::Event events[] = {{0, setSetpoint10, &plant}};
+    ScenarioRunner runner(engine, runPlant, &plant);
+    runner.addTrackingMetric("plant", getSetpoint, getMeasured, &plant, 0.5f);
+
+    runner.run({"short", 5, events, 1});
+
+    EXPECT_EQ(1, runner.getTrackingResult(0).steps);
+    EXPECT_EQ(1, runner.getTrackingResult(0).unsettledSteps);
+    EXPECT_EQ(0, runner.getTrackingResult(0).meanSettlingTime);
+}
+
+TEST(ScenarioRunner, limit_metric_measures_time_over_limit)
+{
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    const ScenarioRunner::Event events[] = {{0, setSetpoint10, &plant}};
+    ScenarioRunner runner(engine, runPlant, &plant);
+    // The measurement is over a limit of 7.5 once it reaches 8, from the 8th period on
+    runner.addLimitMetric("plant", getMeasured, [](const void *) { return 7.5f; }, &plant);
+
+    runner.run({"limit", 20, events, 1});
+
+    const ScenarioRunner::LimitResult &result = runner.getLimitResult(0);
+    EXPECT_FLOAT_EQ(10, result.max);
+    EXPECT_FLOAT_EQ(7.5f, result.meanLimit);
+    EXPECT_FLOAT_EQ((55 + 10 * 10) / 20.0f, result.mean);
+    EXPECT_NEAR(0.013f, result.timeOverLimit, 1e-6f);
+    EXPECT_FLOAT_EQ(2.5f, result.maxExcess);
+}
+
+TEST(ScenarioRunner, attached_motor_drives_engine_and_receives_feedback)
+{
+    tap::Drivers drivers;
+    DjiMotor motor(&drivers, tap::motor::MOTOR1, tap::can::CanBus::CAN_BUS1, false, "motor");
+    MotorSimEngine engine;
+    const int engineMotor = engine.addMotor(MotorSimEngine::M3508_PARAMETERS);
+    auto spin = [](void *context) { static_cast<DjiMotor *>(context)->setDesiredOutput(4'000); };
+    ScenarioRunner runner(engine, spin, &motor);
+    runner.attachMotor(motor, engineMotor);
+
+    runner.run({"spin", 100, nullptr, 0});
+
+    EXPECT_EQ(4'000, engine.getInput(engineMotor));
+    EXPECT_GT(engine.getRPM(engineMotor), 0);
+    EXPECT_EQ(engine.getRPM(engineMotor), motor.getShaftRPM());
+}
+
+TEST(ScenarioRunner, printCsv_prints_row_per_result_field)
+{
+    tap::Drivers drivers;
+    tap::stub::TerminalDeviceStub device(&drivers);
+    modm::IOStream stream(device);
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    const ScenarioRunner::Event events[] = {{100, setSetpoint10, &plant}};
+    ScenarioRunner runner(engine, runPlant, &plant);
+    runner.addTrackingMetric("plant", getSetpoint, getMeasured, &plant, 0.5f);
+
+    runner.run({"step", 200, events, 1});
+    runner.printCsv(stream);
+
+    std::string csv = device.readAllItemsFromWriteBufferToString();
+    EXPECT_EQ(0u, csv.find("scenario,metric,field,value\n"));
+    EXPECT_NE(std::string::npos, csv.find("step,controlLoop,calls,200.000000\n"));
+    EXPECT_NE(std::string::npos, csv.find("step,plant,steps,1.000000\n"));
+    EXPECT_NE(std::string::npos, csv.find("step,plant,maxSettlingTime,0.009000\n"));
+}
+
+TEST(ScenarioRunner, printJson_prints_object_per_metric)
+{
+    tap::Drivers drivers;
+    tap::stub::TerminalDeviceStub device(&drivers);
+    modm::IOStream stream(device);
+    MotorSimEngine engine;
+    RateLimitedPlant plant;
+    ScenarioRunner runner(engine, runPlant, &plant);
+    runner.addTrackingMetric("plant", getSetpoint, getMeasured, &plant, 0.5f);
+    runner.addLimitMetric("limit", getMeasured, getSetpoint, &plant);
+
+    runner.run({"idle", 10, nullptr, 0});
+    runner.printJson(stream);
+
+    std::string json = device.readAllItemsFromWriteBufferToString();
+    EXPECT_EQ(0u, json.find("{\"scenario\": \"idle\", \"duration\": 0.010,"));
+    EXPECT_NE(std::string::npos, json.find("\"controlLoop\": {\"calls\": 10,"));
+    EXPECT_NE(std::string::npos, json.find("\"plant\": {\"rmsError\": 0.000000,"));
+    EXPECT_NE(std::string::npos, json.find("\"limit\": {\"mean\": 0.000000,"));
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+ *
+ * This file is part of Taproot.
+ *
+ * Taproot is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Taproot is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef __linux__
+
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "tap/architecture/clock.hpp"
+#include "tap/motor/motorsim/shared_memory_link.hpp"
+
+#include "modm/architecture/interface/can_message.hpp"
+
+using namespace tap::motor::motorsim;
+using namespace tap::can;
+using namespace tap::arch;
+
+static constexpr const char *SHM_NAME = "/taproot-shared-memory-link-test";
+
+class SharedMemoryLinkTest : public testing::Test
+{
+protected:
+    SharedMemoryLinkTest()
+        : firmware(SHM_NAME, SharedMemoryLink::Role::FIRMWARE),
+          simulator(SHM_NAME, SharedMemoryLink::Role::SIMULATOR)
+    {
+    }
+
+    void TearDown() override { clock::disableVirtualTime(); }
+
+    SharedMemoryLink firmware;
+    SharedMemoryLink simulator;
+};
+
+TEST(ShmRing, pop_returns_items_in_order_until_empty)
+{
+    ShmRing<int, 4> ring;
+    int item = -1;
+
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+
+    EXPECT_EQ(2u, ring.size());
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(1, item);
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(2, item);
+    EXPECT_FALSE(ring.pop(item));
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(ShmRing, push_fails_when_full_and_wraps_around)
+{
+    ShmRing<int, 4> ring;
+    int item;
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(4));
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(ring.pop(item));
+        EXPECT_EQ(i, item);
+        EXPECT_TRUE(ring.push(i + 4));
+    }
+}
+
+TEST_F(SharedMemoryLinkTest, can_frames_reach_the_other_side_on_the_same_bus)
+{
+    modm::can::Message sent(0x200, 8);
+    for (int i = 0; i < 8; i++)
+    {
+        sent.data[i] = i + 1;
+    }
+    modm::can::Message received;
+
+    ASSERT_TRUE(firmware.sendCan(CanBus::CAN_BUS2, sent));
+
+    EXPECT_FALSE(firmware.receiveCan(CanBus::CAN_BUS2, received));
+    EXPECT_FALSE(simulator.receiveCan(CanBus::CAN_BUS1, received));
+    ASSERT_TRUE(simulator.receiveCan(CanBus::CAN_BUS2, received));
+    EXPECT_EQ(0x200u, received.getIdentifier());
+    EXPECT_EQ(8, received.getLength());
+    EXPECT_EQ(0, memcmp(sent.data, received.data, 8));
+}
+
+TEST_F(SharedMemoryLinkTest, simulator_can_frames_reach_firmware)
+{
+    modm::can::Message sent(0x201, 8);
+    sent.data[7] = 0x42;
+    modm::can::Message received;
+
+    ASSERT_TRUE(simulator.sendCan(CanBus::CAN_BUS1, sent));
+
+    ASSERT_TRUE(firmware.receiveCan(CanBus::CAN_BUS1, received));
+    EXPECT_EQ(0x201u, received.getIdentifier());
+    EXPECT_EQ(0x42, received.data[7]);
+}
+
+TEST_F(SharedMemoryLinkTest, send_fails_when_ring_is_full)
+{
+    modm::can::Message message(0x200, 8);
+
+    for (uint32_t i = 0; i < SimSharedMemory::CAN_RING_SIZE; i++)
+    {
+        ASSERT_TRUE(firmware.sendCan(CanBus::CAN_BUS1, message));
+    }
+
+    EXPECT_FALSE(firmware.sendCan(CanBus::CAN_BUS1, message));
+}
+
+TEST_F(SharedMemoryLinkTest, sensor_frames_reach_firmware)
+{
+    SimSensorFrame sent = {};
+    sent.sensorId = 3;
+    sent.time = 1'000;
+    sent.values[2] = 9.81f;
+    SimSensorFrame received;
+
+    ASSERT_TRUE(simulator.sendSensor(sent));
+
+    ASSERT_TRUE(firmware.receiveSensor(received));
+    EXPECT_EQ(3u, received.sensorId);
+    EXPECT_EQ(1'000u, received.time);
+    EXPECT_FLOAT_EQ(9.81f, received.values[2]);
+    EXPECT_FALSE(firmware.receiveSensor(received));
+}
+
+TEST_F(SharedMemoryLinkTest, waitForSimulator_times_out_without_a_new_step)
+{
+    EXPECT_FALSE(firmware.waitForSimulator(1));
+
+    simulator.publishStep(1'000);
+    EXPECT_TRUE(firmware.waitForSimulator(1));
+    firmware.finishStep();
+
+    EXPECT_FALSE(firmware.waitForSimulator(1));
+}
+
+TEST_F(SharedMemoryLinkTest, waitForSimulator_advances_virtual_time_to_step)
+{
+    clock::enableVirtualTime();
+
+    simulator.publishStep(5'000'000'000);
+
+    ASSERT_TRUE(firmware.waitForSimulator(1));
+    EXPECT_EQ(5'000'000'000u, clock::getVirtualTimeMicroseconds());
+}
+
+TEST_F(SharedMemoryLinkTest, simulator_and_firmware_run_in_lockstep)
+{
+    constexpr int STEPS = 100;
+    int firmwareSteps = 0;
+    std::thread firmwareThread([&]() {
+        while (firmware.waitForSimulator(1'000))
+        {
+            modm::can::Message message;
+            while (firmware.receiveCan(CanBus::CAN_BUS1, message))
+            {
+                firmware.sendCan(CanBus::CAN_BUS1, message);
+            }
+            firmwareSteps++;
+            firmware.finishStep();
+            if (firmwareSteps == STEPS)
+            {
+                break;
+            }
+        }
+    });
+
+    int echoed = 0;
+    for (int step = 1; step <= STEPS; step++)
+    {
+        modm::can::Message message(0x200, 8);
+        simulator.sendCan(CanBus::CAN_BUS1, message);
+        simulator.publishStep(step * 1'000);
+        ASSERT_TRUE(simulator.waitForFirmware(1'000));
+        while (simulator.receiveCan(CanBus::CAN_BUS1, message))
+        {
+            echoed++;
+        }
+        // Every frame is answered within the step it was sent in
+        EXPECT_EQ(step, echoed);
+    }
+
+    firmwareThread.join();
+    EXPECT_EQ(STEPS, firmwareSteps);
+}
+
+TEST(SharedMemoryLink, opening_missing_object_throws)
+{
+    EXPECT_THROW(
+        SharedMemoryLink("/taproot-missing-link", SharedMemoryLink::Role::SIMULATOR),
+        std::runtime_error);
+}
+
+TEST(SharedMemoryLink, active_link_is_cleared_when_destroyed)
+{
+    {
+        SharedMemoryLink link(SHM_NAME, SharedMemoryLink::Role::FIRMWARE);
+        SharedMemoryLink::setActive(&link);
+        EXPECT_EQ(&link, SharedMemoryLink::getActive());
+    }
+
+    EXPECT_EQ(nullptr, SharedMemoryLink::getActive());
+}
+
+#endif  // __linux__
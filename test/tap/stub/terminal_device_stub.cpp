@@ -19,6 +19,8 @@
 
 #include "terminal_device_stub.hpp"
 
+#include <algorithm>
+
 #include "modm/io/iostream.hpp"
 
 namespace tap::stub
@@ -40,6 +42,13 @@ bool TerminalDeviceStub::read(char &c)
 
 void TerminalDeviceStub::write(char c) { writeBuffer.push_back(c); }
 
+std::size_t TerminalDeviceStub::tryWrite(const uint8_t *data, std::size_t length)
+{
+    length = std::min(length, tryWriteLimit);
+    writeBuffer.insert(writeBuffer.end(), data, data + length);
+    return length;
+}
+
 void TerminalDeviceStub::flush()
 {
     // pass
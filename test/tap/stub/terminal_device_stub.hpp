@@ -20,6 +20,7 @@
 #ifndef TAPROOT_TERMINAL_DEVICE_STUB_HPP_
 #define TAPROOT_TERMINAL_DEVICE_STUB_HPP_
 
+#include <cstdint>
 #include <queue>
 #include <string>
 
@@ -46,6 +47,19 @@ class TerminalDeviceStub : public modm::IODevice
 
     void flush() override;
 
+    /**
+     * Writes at most the write limit of the `length` bytes of `data` to the write buffer.
+     *
+     * @return The number of bytes written.
+     */
+    std::size_t tryWrite(const uint8_t *data, std::size_t length);
+
+    /**
+     * Testing function. Limits the number of bytes each call to `tryWrite` writes, emulating a
+     * device whose buffer is full.
+     */
+    void setTryWriteLimit(std::size_t limit) { tryWriteLimit = limit; }
+
     /**
      * Testing function. Allows you to fill up the buffer that will be read from
      * via the read function above.
@@ -69,6 +83,7 @@ class TerminalDeviceStub : public modm::IODevice
 private:
     std::deque<char> readBuffer;
     std::deque<char> writeBuffer;
+    std::size_t tryWriteLimit = SIZE_MAX;
 };
 }  // namespace tap::stub
 
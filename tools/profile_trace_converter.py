@@ -0,0 +1,89 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Converts tick traces printed by tap::arch::HierarchicalProfiler (`profile trace`, or
+`profile -S trace` to stream a trace per tick) into Chrome trace JSON, which can be opened in
+chrome://tracing or https://ui.perfetto.dev. Other terminal output mixed into the input is
+ignored.
+
+Usage:
+    python3 profile_trace_converter.py terminal_log.txt --cpu-mhz 180 --output trace.json
+
+Flame graphs don't need conversion: the output of `profile folded` is already in the folded
+stack format read by flamegraph.pl and speedscope.
+"""
+
+import argparse
+import json
+import sys
+
+
+def parse_traces(lines):
+    """Yields (tick, tick_cycles, [(depth, name, start_cycles, duration_cycles)]) per trace."""
+    trace = None
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 3 and fields[0] == "tick":
+            trace = (int(fields[1]), int(fields[2]), [])
+        elif trace is not None and fields == ["end"]:
+            yield trace
+            trace = None
+        elif trace is not None and len(fields) >= 4:
+            # Scope names may contain spaces
+            name = " ".join(fields[1:-2])
+            try:
+                trace[2].append((int(fields[0]), name, int(fields[-2]), int(fields[-1])))
+            except ValueError:
+                trace = None
+
+
+def to_chrome_trace(traces, cpu_mhz):
+    """Lays the ticks out one after another, since their absolute start times aren't printed."""
+    events = []
+    tick_start_us = 0.0
+    for tick, tick_cycles, scopes in traces:
+        tick_us = tick_cycles / cpu_mhz
+        events.append(
+            {"name": f"tick {tick}", "ph": "X", "pid": 0, "tid": 0, "ts": tick_start_us,
+             "dur": tick_us})
+        for depth, name, start, duration in scopes:
+            events.append(
+                {"name": name, "ph": "X", "pid": 0, "tid": 0,
+                 "ts": tick_start_us + start / cpu_mhz, "dur": duration / cpu_mhz,
+                 "args": {"depth": depth, "cycles": duration}})
+        tick_start_us += tick_us
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert HierarchicalProfiler traces.")
+    parser.add_argument("input", nargs="?", help="Captured terminal output, stdin if not specified")
+    parser.add_argument("--cpu-mhz", type=float, default=180.0, help="Core clock frequency")
+    parser.add_argument("--output", help="JSON file to write to, stdout if not specified")
+    args = parser.parse_args()
+
+    source = open(args.input) if args.input else sys.stdin
+    traces = list(parse_traces(source))
+    output = open(args.output, "w") if args.output else sys.stdout
+    json.dump(to_chrome_trace(traces, args.cpu_mhz), output)
+    output.flush()
+    sys.stderr.write(f"{len(traces)} ticks converted\n")
+
+
+if __name__ == "__main__":
+    main()
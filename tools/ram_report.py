@@ -0,0 +1,129 @@
+# Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Reports the static RAM (.data and .bss) used by a firmware image, per module and per symbol, from
+the symbols and debug information in the .elf. Each symbol is attributed to the directory of the
+source file that defines it, so for example all of ref serial's buffers are reported under
+tap/communication/serial. The drivers object is a single symbol, see `memory drivers` in the
+terminal (tap::arch::MemoryMonitor) for the size of each driver.
+
+Usage:
+    python3 ram_report.py build/hardware/scons-release/test-project.elf [--top 20] [--json out.json]
+
+Requires arm-none-eabi-nm (or the nm given by --nm) and an image built with debug information,
+i.e. with the debug or release profile. The fast profile strips it, so every symbol is reported
+as having no debug information.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+from collections import defaultdict
+
+# nm symbol types of objects in RAM: initialized data, zero-initialized data, and their small
+# data variants
+RAM_SYMBOL_TYPES = set("bBdDgGsS")
+
+UNKNOWN_MODULE = "(no debug information)"
+
+
+def read_symbols(elf, nm):
+    """Returns a list of (name, size, path) for each symbol in RAM, largest first."""
+    output = subprocess.run(
+        [nm, "--print-size", "--size-sort", "--reverse-sort", "--demangle", "--line-numbers", elf],
+        check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        location, _, path = line.partition("\t")
+        fields = location.split(maxsplit=3)
+        if len(fields) != 4 or fields[2] not in RAM_SYMBOL_TYPES:
+            continue
+        path = path.rsplit(":", 1)[0] if path else None
+        symbols.append((fields[3], int(fields[1], 16), path))
+    return symbols
+
+
+def module_of(path):
+    """Returns the module a source file belongs to, i.e. its directory below src/."""
+    if path is None:
+        return UNKNOWN_MODULE
+    parts = os.path.normpath(path).replace("\\", "/").split("/")[:-1]
+    # Taproot and modm sources are generated under <project>/taproot/src/tap and
+    # <project>/taproot/modm/src/modm
+    for root in ("tap", "modm"):
+        if root in parts:
+            index = len(parts) - 1 - parts[::-1].index(root)
+            return "/".join(parts[index:])
+    return "/".join(parts[-2:]) if parts else UNKNOWN_MODULE
+
+
+def summarize(symbols):
+    """Returns a list of (module, bytes, symbol count), largest first."""
+    sizes = defaultdict(int)
+    counts = defaultdict(int)
+    for _, size, path in symbols:
+        module = module_of(path)
+        sizes[module] += size
+        counts[module] += 1
+    return sorted(
+        ((module, sizes[module], counts[module]) for module in sizes), key=lambda m: -m[1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Report static RAM usage per module.")
+    parser.add_argument("elf", help="Firmware image to report on")
+    parser.add_argument("--nm", default="arm-none-eabi-nm", help="nm of the image's toolchain")
+    parser.add_argument("--top", type=int, default=20, help="Number of largest symbols to list")
+    parser.add_argument("--json", help="Also write the report to this JSON file")
+    args = parser.parse_args()
+
+    symbols = read_symbols(args.elf, args.nm)
+    modules = summarize(symbols)
+    total = sum(size for _, size, _ in symbols)
+
+    print(f"Static RAM: {total} bytes in {len(symbols)} symbols\n")
+    print(f"{'Module':<48} {'Bytes':>8} {'Symbols':>8}")
+    for module, size, count in modules:
+        print(f"{module:<48} {size:>8} {count:>8}")
+
+    print("\nLargest symbols:")
+    for name, size, path in symbols[:args.top]:
+        print(f"{size:>8}  {name}  ({module_of(path)})")
+
+    if args.json:
+        with open(args.json, "w") as output:
+            json.dump(
+                {
+                    "total": total,
+                    "modules": [
+                        {"module": module, "bytes": size, "symbols": count}
+                        for module, size, count in modules
+                    ],
+                    "symbols": [
+                        {"name": name, "bytes": size, "module": module_of(path)}
+                        for name, size, path in symbols
+                    ],
+                },
+                output,
+                indent=2)
+
+
+if __name__ == "__main__":
+    main()
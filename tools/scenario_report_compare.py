@@ -0,0 +1,131 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+"""
+Compares the scenario reports of two taproot versions, as printed by
+tap::motor::motorsim::ScenarioRunner::printJson, and flags the metrics that got worse. Each input
+file holds the reports of one version, one JSON object per scenario, concatenated.
+
+Usage:
+    python3 scenario_report_compare.py baseline.json candidate.json [--csv changes.csv]
+
+Exits with status 1 if a metric regressed by more than its threshold, so it can gate CI. The
+control loop times are measured on the host, so only compare reports from the same machine, and
+give them a looser threshold (--cpu-threshold) since they vary from run to run.
+"""
+
+import argparse
+import csv
+import json
+import sys
+
+# Fields compared for each kind of metric. Smaller is better for all of them.
+CONTROL_LOOP_FIELDS = ["mean", "p99", "max"]
+TRACKING_FIELDS = ["rmsError", "maxError", "unsettledSteps", "meanSettlingTime", "maxSettlingTime"]
+LIMIT_FIELDS = ["timeOverLimit", "maxExcess"]
+
+# Changes smaller than this are treated as none, so that metrics that are 0 in both versions, or
+# that differ only by printing precision, don't regress.
+ABSOLUTE_TOLERANCE = 1e-6
+
+
+def read_reports(path):
+    """Returns {scenario: report} for the concatenated JSON reports in the file."""
+    with open(path) as file:
+        text = file.read()
+    decoder = json.JSONDecoder()
+    reports = {}
+    index = 0
+    while True:
+        while index < len(text) and text[index].isspace():
+            index += 1
+        if index == len(text):
+            return reports
+        report, index = decoder.raw_decode(text, index)
+        reports[report["scenario"]] = report
+
+
+def compare_fields(baseline, candidate, fields):
+    """Yields (field, baseline value, candidate value) of the fields in both metrics."""
+    for field in fields:
+        if field in baseline and field in candidate:
+            yield field, baseline[field], candidate[field]
+
+
+def compare(baseline_reports, candidate_reports, threshold, cpu_threshold):
+    """Returns a list of (scenario, metric, field, baseline, candidate, regressed)."""
+    changes = []
+    for scenario, candidate in candidate_reports.items():
+        baseline = baseline_reports.get(scenario)
+        if baseline is None:
+            continue
+
+        def add(metric, baseline_metric, candidate_metric, fields, threshold):
+            for field, old, new in compare_fields(baseline_metric, candidate_metric, fields):
+                regressed = new - old > max(abs(old) * threshold, ABSOLUTE_TOLERANCE)
+                changes.append((scenario, metric, field, old, new, regressed))
+
+        add("controlLoop", baseline["controlLoop"], candidate["controlLoop"], CONTROL_LOOP_FIELDS,
+            cpu_threshold)
+        for kind, fields in (("tracking", TRACKING_FIELDS), ("limits", LIMIT_FIELDS)):
+            for metric, candidate_metric in candidate.get(kind, {}).items():
+                if metric in baseline.get(kind, {}):
+                    add(metric, baseline[kind][metric], candidate_metric, fields, threshold)
+    return changes
+
+
+def format_change(old, new):
+    if old == new:
+        return "="
+    if old == 0:
+        return "new"
+    return "{:+.1f}%".format((new - old) / abs(old) * 100)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare ScenarioRunner reports.")
+    parser.add_argument("baseline", help="Reports of the version compared against")
+    parser.add_argument("candidate", help="Reports of the version being checked")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="Relative increase of a control metric that is a regression")
+    parser.add_argument("--cpu-threshold", type=float, default=0.2,
+                        help="Relative increase of a control loop time that is a regression")
+    parser.add_argument("--csv", help="CSV file to write every compared field to")
+    args = parser.parse_args()
+
+    baseline_reports = read_reports(args.baseline)
+    candidate_reports = read_reports(args.candidate)
+    for scenario in sorted(set(baseline_reports) ^ set(candidate_reports)):
+        print("scenario {} is only in one version, skipped".format(scenario), file=sys.stderr)
+
+    changes = compare(baseline_reports, candidate_reports, args.threshold, args.cpu_threshold)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as file:
+            writer = csv.writer(file)
+            writer.writerow(["scenario", "metric", "field", "baseline", "candidate", "regressed"])
+            writer.writerows(changes)
+
+    regressions = [change for change in changes if change[5]]
+    for scenario, metric, field, old, new, _ in regressions:
+        print("{} {} {}: {:g} -> {:g} ({})".format(
+            scenario, metric, field, old, new, format_change(old, new)))
+    print("{} of {} fields regressed".format(len(regressions), len(changes)))
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,218 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+
+"""
+Collects the samples streamed by tap::control::sysid::SysIdCapture, estimates the plant's
+frequency response from them, and fits a continuous time transfer function to it.
+
+Usage:
+    python3 sysid_fit.py --port /dev/ttyUSB0 --baud 460800 --samples run.csv
+    python3 sysid_fit.py --input run.csv --num-order 0 --den-order 2 --response bode.csv --plot
+
+Reading from a serial port stops after --duration seconds or at Ctrl-C. The frequency response
+is Welch's H1 estimate, the cross spectrum of input and output over the input's spectrum,
+averaged over Hann windowed segments, along with the coherence, which is near 1 where the
+output is explained by the input. The transfer function is fit to the frequencies between
+--min-freq and --max-freq with coherence above --min-coherence, with Sanathanan-Koerner
+iterations of Levy's linear least squares. Requires numpy, pyserial to read from a serial port
+and matplotlib to plot.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+import numpy as np
+
+from telemetry_decoder import TelemetryDecoder, open_input
+
+# SysIdCapture::BLOCK_TYPE
+SYSID_BLOCK_TYPE = 1
+BLOCK_HEADER = struct.Struct("<IB")
+SAMPLE = struct.Struct("<Iff")
+
+
+def read_samples(args):
+    """Returns a list of (index, time_us, input, output) samples read from the stream."""
+    read = open_input(args)
+    decoder = TelemetryDecoder()
+    samples = []
+    start = time.monotonic()
+    try:
+        while args.port is None or time.monotonic() - start < args.duration:
+            data = read(4096)
+            if not data:
+                if args.port is None:
+                    break
+                continue
+            for kind, contents in decoder.feed(data):
+                if kind != "block" or contents[0] != SYSID_BLOCK_TYPE:
+                    continue
+                payload = contents[1]
+                first_index, count = BLOCK_HEADER.unpack_from(payload)
+                for i in range(count):
+                    t, u, y = SAMPLE.unpack_from(payload, BLOCK_HEADER.size + i * SAMPLE.size)
+                    samples.append((first_index + i, t, u, y))
+    except KeyboardInterrupt:
+        pass
+    return samples
+
+
+def load_samples(path):
+    with open(path) as f:
+        return [(int(r[0]), int(r[1]), float(r[2]), float(r[3])) for r in list(csv.reader(f))[1:]]
+
+
+def save_samples(path, samples):
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["index", "time_us", "input", "output"])
+        writer.writerows(samples)
+
+
+def frequency_response(samples, segment_length):
+    """Returns (frequencies, H, coherence) estimated from the longest gap-free run of samples."""
+    indices = np.array([s[0] for s in samples])
+    # split at dropped samples and use the longest run
+    breaks = np.flatnonzero(np.diff(indices) != 1) + 1
+    runs = np.split(np.arange(len(samples)), breaks)
+    run = max(runs, key=len)
+    if len(run) < len(samples):
+        sys.stderr.write(f"using {len(run)} of {len(samples)} samples, the rest have gaps\n")
+
+    times = np.array([samples[i][1] for i in run], dtype=np.int64)
+    u = np.array([samples[i][2] for i in run])
+    y = np.array([samples[i][3] for i in run])
+    period = np.median(np.diff(times)) / 1e6
+
+    segment_length = min(segment_length, len(u))
+    step = segment_length // 2
+    window = np.hanning(segment_length)
+    puu = pyy = pyu = 0
+    for start in range(0, len(u) - segment_length + 1, step):
+        us = np.fft.rfft(window * (u[start : start + segment_length] - u.mean()))
+        ys = np.fft.rfft(window * (y[start : start + segment_length] - y.mean()))
+        puu = puu + np.abs(us) ** 2
+        pyy = pyy + np.abs(ys) ** 2
+        pyu = pyu + ys * np.conj(us)
+
+    frequencies = np.fft.rfftfreq(segment_length, period)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        response = pyu / puu
+        coherence = np.abs(pyu) ** 2 / (puu * pyy)
+    return frequencies[1:], response[1:], np.nan_to_num(coherence[1:])
+
+
+def fit_transfer_function(frequencies, response, weights, num_order, den_order, iterations=10):
+    """Fits b(s) / a(s), with a monic, returns (b, a) highest power first."""
+    s = 2j * np.pi * frequencies
+    den_weights = np.ones_like(s)
+    for _ in range(iterations):
+        # b(s) - H * (a(s) - s^n) = H * s^n, linear in b and the lower coefficients of a
+        columns = [s**k for k in range(num_order, -1, -1)]
+        columns += [-response * s**k for k in range(den_order - 1, -1, -1)]
+        matrix = np.array(columns).T * (weights / np.abs(den_weights))[:, None]
+        target = response * s**den_order * weights / np.abs(den_weights)
+        real_matrix = np.vstack([matrix.real, matrix.imag])
+        real_target = np.concatenate([target.real, target.imag])
+        solution = np.linalg.lstsq(real_matrix, real_target, rcond=None)[0]
+        b = solution[: num_order + 1]
+        a = np.concatenate([[1.0], solution[num_order + 1 :]])
+        den_weights = np.polyval(a, s)
+    return b, a
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fit a transfer function to a SysIdCapture.")
+    parser.add_argument("--port", help="Serial port to read from, stdin if not specified")
+    parser.add_argument("--baud", type=int, default=115200, help="Baud rate of the port")
+    parser.add_argument("--duration", type=float, default=60, help="Seconds to read a port for")
+    parser.add_argument("--input", help="CSV of samples saved by --samples, instead of reading")
+    parser.add_argument("--samples", help="CSV file to save the samples to")
+    parser.add_argument("--segment", type=int, default=2048, help="Samples per Welch segment")
+    parser.add_argument("--num-order", type=int, default=0, help="Order of the numerator")
+    parser.add_argument("--den-order", type=int, default=1, help="Order of the denominator")
+    parser.add_argument("--min-freq", type=float, default=0.0, help="Lowest frequency to fit")
+    parser.add_argument("--max-freq", type=float, default=np.inf, help="Highest frequency to fit")
+    parser.add_argument("--min-coherence", type=float, default=0.8, help="Coherence to fit")
+    parser.add_argument("--response", help="CSV file to save the frequency response to")
+    parser.add_argument("--plot", action="store_true", help="Plot the Bode diagram")
+    args = parser.parse_args()
+
+    samples = load_samples(args.input) if args.input else read_samples(args)
+    if args.samples:
+        save_samples(args.samples, samples)
+    if len(samples) < 16:
+        sys.exit(f"only {len(samples)} samples received")
+
+    frequencies, response, coherence = frequency_response(samples, args.segment)
+    fit = (
+        (coherence >= args.min_coherence)
+        & (frequencies >= args.min_freq)
+        & (frequencies <= args.max_freq)
+    )
+    if fit.sum() < args.num_order + args.den_order + 1:
+        sys.exit("not enough coherent frequencies to fit, excite the plant more")
+
+    b, a = fit_transfer_function(
+        frequencies[fit], response[fit], coherence[fit], args.num_order, args.den_order
+    )
+    fitted = np.polyval(b, 2j * np.pi * frequencies) / np.polyval(a, 2j * np.pi * frequencies)
+
+    print("numerator:  ", " ".join(f"{c:.6g}" for c in b))
+    print("denominator:", " ".join(f"{c:.6g}" for c in a))
+    print(f"dc gain: {b[-1] / a[-1]:.6g}" if a[-1] != 0 else "integrating plant")
+    print("poles:", " ".join(f"{p:.4g}" for p in np.roots(a)))
+
+    if args.response:
+        with open(args.response, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(
+                ["freq_hz", "mag_db", "phase_deg", "coherence", "fit_mag_db", "fit_phase_deg"]
+            )
+            for row in zip(frequencies, response, coherence, fitted):
+                writer.writerow(
+                    [
+                        row[0],
+                        20 * np.log10(np.abs(row[1])),
+                        np.degrees(np.angle(row[1])),
+                        row[2],
+                        20 * np.log10(np.abs(row[3])),
+                        np.degrees(np.angle(row[3])),
+                    ]
+                )
+
+    if args.plot:
+        import matplotlib.pyplot as plt
+
+        figure, (magnitude, phase) = plt.subplots(2, sharex=True)
+        magnitude.semilogx(frequencies, 20 * np.log10(np.abs(response)), ".", label="measured")
+        magnitude.semilogx(frequencies, 20 * np.log10(np.abs(fitted)), label="fit")
+        magnitude.set_ylabel("magnitude (dB)")
+        magnitude.legend()
+        phase.semilogx(frequencies, np.degrees(np.unwrap(np.angle(response))), ".")
+        phase.semilogx(frequencies, np.degrees(np.unwrap(np.angle(fitted))))
+        phase.set_ylabel("phase (deg)")
+        phase.set_xlabel("frequency (Hz)")
+        plt.show()
+
+
+if __name__ == "__main__":
+    main()
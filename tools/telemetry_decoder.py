@@ -0,0 +1,214 @@
+# Copyright (c) 2020-2021 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Decodes the binary telemetry stream sent by tap::communication::serial::TelemetryStream and
+prints it as CSV, or plots it live.
+
+Usage:
+    python3 telemetry_decoder.py --port /dev/ttyUSB0 --baud 460800 [--plot] [--output log.csv]
+    ./hosted-program | python3 telemetry_decoder.py
+
+Start the stream by typing `telemetry start <rate_hz>` in the robot's terminal. Reading from a
+serial port requires pyserial, and plotting requires matplotlib.
+"""
+
+import argparse
+import struct
+import sys
+import time
+from collections import deque
+
+DATA_PACKET_TYPE = 0x01
+DESCRIPTOR_PACKET_TYPE = 0x02
+BLOCK_PACKET_TYPE = 0x03
+
+# Indexed by TelemetryStream::SignalType
+SIGNAL_FORMATS = ["<f", "<i", "<I", "<h", "<H", "<b", "<B"]
+
+DATA_HEADER = struct.Struct("<BBI")
+
+
+def crc16(data):
+    """CRC-16/MCRF4XX, as computed by tap::algorithms::calculateCRC16."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+def cobs_decode(frame):
+    """Returns the decoded frame, or None if the frame is malformed."""
+    decoded = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        decoded += frame[i + 1 : i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            decoded.append(0)
+    return bytes(decoded)
+
+
+class TelemetryDecoder:
+    def __init__(self):
+        self.names = None
+        self.formats = None
+        self.frame = bytearray()
+        self.prev_sequence = None
+        self.num_dropped = 0
+        self.num_corrupted = 0
+
+    def feed(self, data):
+        """Yields ("descriptor", names), ("data", (time_us, values)) and
+        ("block", (block_type, payload)) tuples for each packet completed by `data`."""
+        for byte in data:
+            if byte != 0:
+                self.frame.append(byte)
+                continue
+            if not self.frame:
+                continue
+            packet = cobs_decode(bytes(self.frame))
+            self.frame.clear()
+            if packet is None or len(packet) < 3:
+                self.num_corrupted += 1
+                continue
+            payload, crc = packet[:-2], struct.unpack("<H", packet[-2:])[0]
+            if crc16(payload) != crc:
+                # also drops text written to the terminal between packets
+                self.num_corrupted += 1
+                continue
+            decoded = self._decode_packet(payload)
+            if decoded is not None:
+                yield decoded
+
+    def _decode_packet(self, payload):
+        if payload[0] == DESCRIPTOR_PACKET_TYPE:
+            names, formats = [], []
+            i = 2
+            for _ in range(payload[1]):
+                signal_type, name_length = payload[i], payload[i + 1]
+                names.append(payload[i + 2 : i + 2 + name_length].decode(errors="replace"))
+                formats.append(SIGNAL_FORMATS[signal_type])
+                i += 2 + name_length
+            changed = names != self.names
+            self.names, self.formats = names, formats
+            return ("descriptor", names) if changed else None
+
+        if payload[0] == DATA_PACKET_TYPE and self.formats is not None:
+            _, sequence, time_us = DATA_HEADER.unpack_from(payload)
+            if self.prev_sequence is not None:
+                self.num_dropped += (sequence - self.prev_sequence - 1) % 256
+            self.prev_sequence = sequence
+            values = []
+            offset = DATA_HEADER.size
+            for fmt in self.formats:
+                if offset + struct.calcsize(fmt) > len(payload):
+                    # the signals changed and the new descriptor hasn't been received yet
+                    return None
+                values.append(struct.unpack_from(fmt, payload, offset)[0])
+                offset += struct.calcsize(fmt)
+            return ("data", (time_us, values))
+
+        if payload[0] == BLOCK_PACKET_TYPE and len(payload) >= 2:
+            return ("block", (payload[1], payload[2:]))
+
+        return None
+
+
+def open_input(args):
+    if args.port is None:
+        return sys.stdin.buffer.raw.read
+    import serial
+
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    return lambda size: port.read(size)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a TelemetryStream.")
+    parser.add_argument("--port", help="Serial port to read from, stdin if not specified")
+    parser.add_argument("--baud", type=int, default=115200, help="Baud rate of the port")
+    parser.add_argument("--output", help="CSV file to write to, stdout if not specified")
+    parser.add_argument("--plot", action="store_true", help="Plot the signals live")
+    parser.add_argument("--window", type=float, default=5.0, help="Seconds of data to plot")
+    args = parser.parse_args()
+
+    read = open_input(args)
+    output = open(args.output, "w") if args.output else sys.stdout
+    decoder = TelemetryDecoder()
+
+    if args.plot:
+        import matplotlib.pyplot as plt
+
+        plt.ion()
+        figure, axes = plt.subplots()
+        lines = []
+        times = deque()
+        values = []
+        last_draw = 0.0
+
+    while True:
+        data = read(4096)
+        if not data:
+            if args.port is None:
+                break
+            continue
+        for kind, contents in decoder.feed(data):
+            if kind == "block":
+                # buffered captures, decoded by their own tools such as sysid_fit.py
+                continue
+            if kind == "descriptor":
+                output.write("time_us," + ",".join(contents) + "\n")
+                if args.plot:
+                    axes.clear()
+                    lines = [axes.plot([], [], label=name)[0] for name in contents]
+                    axes.legend(loc="upper left")
+                    times.clear()
+                    values = [deque() for _ in contents]
+                continue
+
+            time_us, signal_values = contents
+            output.write(f"{time_us}," + ",".join(str(v) for v in signal_values) + "\n")
+            if args.plot:
+                times.append(time_us / 1e6)
+                for series, value in zip(values, signal_values):
+                    series.append(value)
+                while times and times[-1] - times[0] > args.window:
+                    times.popleft()
+                    for series in values:
+                        series.popleft()
+
+        if args.plot and lines and time.monotonic() - last_draw > 1 / 30:
+            last_draw = time.monotonic()
+            for line, series in zip(lines, values):
+                line.set_data(times, series)
+            axes.relim()
+            axes.autoscale_view()
+            plt.pause(0.001)
+
+    output.flush()
+    sys.stderr.write(
+        f"{decoder.num_dropped} packets dropped, {decoder.num_corrupted} corrupted frames\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,168 @@
+# Copyright (c) 2020-2022 Advanced Robotics at the University of Washington <robomstr@uw.edu>
+#
+# This file is part of Taproot.
+#
+# Taproot is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Taproot is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Taproot.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Decodes events drained by tap::arch::TraceRing from a raw SWO capture into text, or into Chrome
+trace JSON, which can be opened in chrome://tracing or https://ui.perfetto.dev. The capture
+must be the ITM stream with the TPIU formatter bypassed, as written by e.g. OpenOCD's
+`itm port 1 on` and `tpiu config internal swo.bin uart off <core clock> <swo baud rate>`.
+
+Usage:
+    python3 trace_decoder.py swo.bin --cpu-mhz 180
+    python3 trace_decoder.py swo.bin --cpu-mhz 180 --chrome --output trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# The stimulus port TraceRing::ITM_PORT events are written to
+ITM_PORT = 1
+
+# Keep in sync with tap::arch::TraceEventId
+EVENT_NAMES = {
+    1: "command_initialize",
+    2: "command_execute",
+    3: "command_end",
+    4: "can_rx",
+    5: "imu_sample",
+    6: "uart_frame",
+}
+USER_EVENT_ID = 0x100
+
+
+def event_name(event_id):
+    if event_id >= USER_EVENT_ID:
+        return f"user_{event_id - USER_EVENT_ID}"
+    return EVENT_NAMES.get(event_id, f"unknown_{event_id}")
+
+
+def parse_itm_packets(data):
+    """Yields (port, payload) for each software source packet, skipping all other packets."""
+    i = 0
+    while i < len(data):
+        header = data[i]
+        i += 1
+        size_code = header & 0x03
+        if size_code != 0:
+            size = {1: 1, 2: 2, 3: 4}[size_code]
+            payload = data[i:i + size]
+            i += size
+            # Bit 2 is set for hardware source (DWT) packets
+            if (header & 0x04) == 0 and len(payload) == size:
+                yield header >> 3, payload
+        elif header in (0x00, 0x70, 0x80):
+            # Synchronization (zeros ending with 0x80) and overflow packets
+            continue
+        elif (header & 0x80) != 0:
+            # Timestamp and extension packets are followed by bytes with the top bit set, and a
+            # final byte with it clear
+            while i < len(data) and (data[i] & 0x80) != 0:
+                i += 1
+            i += 1
+
+
+def parse_events(packets):
+    """
+    Yields (id, timestamp_cycles, arg) from the packets on ITM_PORT. Each event is a 2-byte id
+    followed by a 4-byte timestamp and a 4-byte arg, so packets lost to an ITM overflow are
+    resynchronized at the next 2-byte packet.
+    """
+    event = None
+    for port, payload in packets:
+        if port != ITM_PORT:
+            continue
+        if len(payload) == 2:
+            event = [struct.unpack("<H", payload)[0]]
+        elif len(payload) == 4 and event is not None:
+            event.append(struct.unpack("<I", payload)[0])
+            if len(event) == 3:
+                yield tuple(event)
+                event = None
+        else:
+            event = None
+
+
+def unwrap_timestamps(events):
+    """
+    Extends the 32-bit cycle counts, which wrap every ~24 s at 180 MHz, to 64 bits. Events
+    recorded from interrupts may be slightly out of order, so a step back of less than 2^31
+    cycles isn't a wrap.
+    """
+    previous = None
+    for event_id, timestamp, arg in events:
+        if previous is None:
+            unwrapped = timestamp
+        else:
+            delta = (timestamp - previous) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            unwrapped = previous_unwrapped + delta
+        previous = timestamp
+        previous_unwrapped = unwrapped
+        yield event_id, unwrapped, arg
+
+
+def to_text(events, cpu_mhz):
+    for event_id, timestamp, arg in events:
+        yield f"{timestamp / cpu_mhz:14.3f} us  {event_name(event_id):<20} 0x{arg:08x}"
+
+
+def to_chrome_trace(events, cpu_mhz):
+    """Command events become slices on one track per command, other events instant events."""
+    trace_events = []
+    for event_id, timestamp, arg in events:
+        ts = timestamp / cpu_mhz
+        name = event_name(event_id)
+        if event_id == 1:
+            trace_events.append(
+                {"name": f"command {arg}", "ph": "B", "pid": 0, "tid": f"command {arg}",
+                 "ts": ts})
+        elif event_id == 3:
+            trace_events.append(
+                {"name": f"command {arg}", "ph": "E", "pid": 0, "tid": f"command {arg}",
+                 "ts": ts})
+        else:
+            trace_events.append(
+                {"name": name, "ph": "i", "s": "t", "pid": 0, "tid": name, "ts": ts,
+                 "args": {"arg": arg}})
+    return {"traceEvents": trace_events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode TraceRing events from a SWO capture.")
+    parser.add_argument("input", nargs="?", help="Raw SWO capture, stdin if not specified")
+    parser.add_argument("--cpu-mhz", type=float, default=180.0, help="Core clock frequency")
+    parser.add_argument("--chrome", action="store_true", help="Output Chrome trace JSON")
+    parser.add_argument("--output", help="File to write to, stdout if not specified")
+    args = parser.parse_args()
+
+    data = open(args.input, "rb").read() if args.input else sys.stdin.buffer.read()
+    events = list(unwrap_timestamps(parse_events(parse_itm_packets(data))))
+    output = open(args.output, "w") if args.output else sys.stdout
+    if args.chrome:
+        json.dump(to_chrome_trace(events, args.cpu_mhz), output)
+    else:
+        for line in to_text(events, args.cpu_mhz):
+            output.write(line + "\n")
+    output.flush()
+    sys.stderr.write(f"{len(events)} events decoded\n")
+
+
+if __name__ == "__main__":
+    main()